@@ -24,13 +24,81 @@
 #include "skeletonTree.h"
 #include "skeletonTreeFactory.h"
 
+#include <QByteArray>
 #include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
-#include <QRegularExpression>
-#include <QTextStream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <opencv2/opencv.hpp>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+/// returns the line at pos without line break and moves pos to the next line
+std::string_view nextLine(const char *&pos, const char *end)
+{
+    const char *lineEnd = static_cast<const char *>(std::memchr(pos, '\n', static_cast<std::size_t>(end - pos)));
+    const char *next    = lineEnd ? lineEnd + 1 : end;
+    if(!lineEnd)
+    {
+        lineEnd = end;
+    }
+    std::string_view line(pos, static_cast<std::size_t>(lineEnd - pos));
+    pos = next;
+    return line;
+}
+
+/// number of lines of content, for reserving the entries read from it
+std::size_t estimateLines(std::string_view content)
+{
+    return static_cast<std::size_t>(std::count(content.begin(), content.end(), '\n')) + 1;
+}
+
+/// splits line at whitespace into tokens
+void splitAtSpaces(std::string_view line, std::vector<std::string_view> &tokens)
+{
+    tokens.clear();
+    auto tokenStart = std::find_if_not(line.begin(), line.end(), isSpace);
+    while(tokenStart != line.end())
+    {
+        const auto tokenEnd = std::find_if(tokenStart, line.end(), isSpace);
+        tokens.emplace_back(&*tokenStart, static_cast<std::size_t>(tokenEnd - tokenStart));
+        tokenStart = std::find_if_not(tokenEnd, line.end(), isSpace);
+    }
+}
+
+/// true, if token is exactly one number
+bool toNumber(std::string_view token, int &value)
+{
+    const char *end = token.data() + token.size();
+    auto [ptr, ec]  = std::from_chars(token.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+/// true, if token is exactly one number
+bool toNumber(std::string_view token, float &value)
+{
+#if defined(__cpp_lib_to_chars)
+    const char *end = token.data() + token.size();
+    auto [ptr, ec]  = std::from_chars(token.data(), end, value);
+    return ec == std::errc() && ptr == end;
+#else
+    // no floating point std::from_chars in this standard library; QByteArray does not depend on the locale either
+    bool ok = false;
+    value   = QByteArray::fromRawData(token.data(), static_cast<int>(token.size())).toFloat(&ok);
+    return ok;
+#endif
+}
+} // namespace
 
 /**
  * @brief Reads individual heights for markerIDs from file.
@@ -62,88 +130,90 @@ std::variant<std::unordered_map<int, float>, std::string> IO::readHeightFile(con
             {
                 return "Could not open " + heightFileName.toStdString();
             }
+            const QByteArray content = heightFile.readAll();
+            return parseHeights(std::string_view(content.constData(), static_cast<std::size_t>(content.size())));
+        }
 
-            std::unordered_map<int, float> markerHeights;
-
-            QTextStream in(&heightFile);
-            bool        readHeader           = false;
-            float       conversionFactorToCM = 1.0F;
+        return "Cannot load " + heightFileName.toStdString() +
+               " maybe because of wrong file extension. Needs to be .txt.";
+    }
+    return "No file provided.";
+}
 
-            while(!in.atEnd())
+/// parses the content of a height file, see readHeightFile()
+std::variant<std::unordered_map<int, float>, std::string> IO::parseHeights(std::string_view content)
+{
+    std::unordered_map<int, float> markerHeights;
+    markerHeights.reserve(estimateLines(content));
+
+    bool                          readHeader           = false;
+    float                         conversionFactorToCM = 1.0F;
+    std::vector<std::string_view> splitLine;
+    const char                   *pos = content.data();
+    const char                   *end = content.data() + content.size();
+    while(pos != end)
+    {
+        const std::string_view line = nextLine(pos, end);
+        // Process header/comment line
+        if(!line.empty() && line.front() == '#')
+        {
+            if(!readHeader)
             {
-                QString line = in.readLine();
-                // Process header/comment line
-                if(line.startsWith("#", Qt::CaseInsensitive))
-                {
-                    if(!readHeader)
-                    {
-                        const QString &headerline = line;
-                        if(headerline.contains("z/cm"))
-                        {
-                            conversionFactorToCM = 1.0F;
-                        }
-                        else if(headerline.contains("z/m"))
-                        {
-                            conversionFactorToCM = 100.0F;
-                        }
-                        readHeader = true;
-                    }
-                    continue;
-                }
-
-                // read line with format: [id height]
-                if(auto splitLine = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts); splitLine.size() == 2)
-                {
-                    bool markerConverted = true;
-                    int  markerID        = splitLine[0].toInt(&markerConverted);
-                    if(!markerConverted)
-                    {
-                        return "Marker needs to be an integer value, but is " + splitLine[0].toStdString();
-                    }
-                    bool  heightConverted = true;
-                    float height          = splitLine[1].toFloat(&heightConverted) * conversionFactorToCM;
-
-                    if(!heightConverted || height <= 0)
-                    {
-                        return "Height needs to be a positive numerical value, but is " + splitLine[1].toStdString();
-                    }
-
-                    if(auto inserted = markerHeights.insert(std::make_pair(markerID, height)); !inserted.second)
-                    {
-                        return "File contains two height-entries for markerID = " + std::to_string(markerID) + ".";
-                    }
-                }
-                else if(splitLine.empty())
+                if(line.find("z/cm") != std::string_view::npos)
                 {
-                    // just ignore empty lines
-                    continue;
+                    conversionFactorToCM = 1.0F;
                 }
-                else
+                else if(line.find("z/m") != std::string_view::npos)
                 {
-                    return "Line should contain exactly 2 values: id height. But it contains " +
-                           std::to_string(splitLine.size()) + " entries.";
+                    conversionFactorToCM = 100.0F;
                 }
+                readHeader = true;
             }
-            heightFile.close();
-            return markerHeights;
+            continue;
         }
 
-        return "Cannot load " + heightFileName.toStdString() +
-               " maybe because of wrong file extension. Needs to be .txt.";
+        // read line with format: [id height]
+        splitAtSpaces(line, splitLine);
+        if(splitLine.size() == 2)
+        {
+            int markerID;
+            if(!toNumber(splitLine[0], markerID))
+            {
+                return "Marker needs to be an integer value, but is " + std::string(splitLine[0]);
+            }
+            float height;
+            if(!toNumber(splitLine[1], height) || height * conversionFactorToCM <= 0)
+            {
+                return "Height needs to be a positive numerical value, but is " + std::string(splitLine[1]);
+            }
+
+            if(auto inserted = markerHeights.emplace(markerID, height * conversionFactorToCM); !inserted.second)
+            {
+                return "File contains two height-entries for markerID = " + std::to_string(markerID) + ".";
+            }
+        }
+        else if(!splitLine.empty())
+        {
+            return "Line should contain exactly 2 values: id height. But it contains " +
+                   std::to_string(splitLine.size()) + " entries.";
+        }
+        // just ignore empty lines
     }
-    return "No file provided.";
+    return markerHeights;
 }
 
 /**
- * @brief Delegates the input c3d to the correct method for given system.
+ * @brief Reads a MoCap person from a c3d file with the correct method for given system.
  *
  * This method calls the correct IO method for the MoCap system.
- * Currently only XSENS is supported.
+ * Currently only XSENS is supported. It does not interact with the GUI, so several
+ * files can be loaded in parallel.
  *
- * @param storage mMoCapStorage of petrack
- * @param metadata new MoCapPersonMetadata
+ * @param metadata metadata of the person to load
+ * @param videoDuration duration of the video in seconds; only the samples overlapping it are stored. -1 stores all.
+ * @return the person or an error message
  */
-void IO::readMoCapC3D(MoCapStorage &storage, const MoCapPersonMetadata &metadata)
+std::variant<MoCapPerson, std::string> IO::loadMoCapC3D(const MoCapPersonMetadata &metadata, double videoDuration)
 {
     MoCapPerson        person;
     const std::string &filename = metadata.getFilepath();
@@ -159,8 +229,7 @@ void IO::readMoCapC3D(MoCapStorage &storage, const MoCapPersonMetadata &metadata
     {
         std::stringstream ss;
         ss << "Error while reading C3D File " << filename << ": " << e.what() << '\n';
-        PCritical(nullptr, "Error: Cannot load C3D File", ss.str().c_str());
-        return;
+        return ss.str();
     }
 
     size_t firstFrame = c3d.header().firstFrame();
@@ -189,42 +258,80 @@ void IO::readMoCapC3D(MoCapStorage &storage, const MoCapPersonMetadata &metadata
                conversionFactor;
     };
 
-    switch(fp)
+    try
+    {
+        switch(fp)
+        {
+            case XSensC3D:
+                readSkeletonC3D_XSENS(c3d, person, c3dToPoint3f, videoDuration);
+                break;
+            case END:
+                break; // So clang doesn't say it isn't handled
+        }
+    }
+    catch(const std::invalid_argument &e)
     {
-        case XSensC3D:
-            readSkeletonC3D_XSENS(c3d, person, c3dToPoint3f);
-            break;
-        case END:
-            break; // So clang doesn't say it isn't handled
+        return "Error while reading C3D File " + filename + ": " + e.what();
     }
 
-    storage.addPerson(person);
+    return person;
+}
+
+/**
+ * @brief Reads a MoCap person from a c3d file and adds it to the storage
+ *
+ * Shows an error message, if the file cannot be read.
+ *
+ * @param storage mMoCapStorage of petrack
+ * @param metadata new MoCapPersonMetadata
+ * @param videoDuration duration of the video in seconds; only the samples overlapping it are stored. -1 stores all.
+ */
+void IO::readMoCapC3D(MoCapStorage &storage, const MoCapPersonMetadata &metadata, double videoDuration)
+{
+    auto person = loadMoCapC3D(metadata, videoDuration);
+    if(std::holds_alternative<std::string>(person))
+    {
+        PCritical(nullptr, "Error: Cannot load C3D File", std::get<std::string>(person).c_str());
+        return;
+    }
+    storage.addPerson(std::move(std::get<MoCapPerson>(person)));
 }
 
 /**
  * @brief Reads a XSens c3d and extracts the skeletons
  *
  * See the official MVN_User_Manual and/or the definition of XSensStruct for details
- * on which points are which.
+ * on which points are which. Only the frames overlapping the video are converted,
+ * if its duration is given; the metadata of person has to be set for that.
  *
  * @param c3d[in] c3d-oject corresponding to the XSens c3d-File
  * @param person[out] the person which the skeletons are added to
  * @param c3dToPoint3f[in] function which converts a c3d point to a cv::Point3f in cm
+ * @param videoDuration[in] duration of the video in seconds; -1 converts all frames
+ * @throw std::invalid_argument if the c3d does not contain the joints of the XSens skeleton
  */
 void IO::readSkeletonC3D_XSENS(
     const ezc3d::c3d                                                           &c3d,
     MoCapPerson                                                                &person,
-    const std::function<cv::Point3f(const ezc3d::DataNS::Points3dNS::Point &)> &c3dToPoint3f)
+    const std::function<cv::Point3f(const ezc3d::DataNS::Points3dNS::Point &)> &c3dToPoint3f,
+    double                                                                      videoDuration)
 {
     const auto &frames = c3d.data().frames();
 
-    for(const auto &frame : frames)
+    size_t first = 0;
+    size_t last  = frames.size();
+    if(videoDuration >= 0)
     {
-        const auto &points = frame.points().points();
+        std::tie(first, last) = person.getSampleRange(0, videoDuration, frames.size());
+    }
+    person.setStoredRange(first, frames.size());
+
+    for(size_t i = first; i < last; ++i)
+    {
+        const auto &points = frames[i].points().points();
         if(points.size() != 87)
         {
-            PCritical(nullptr, "Wrong C3D", "You need a C3D-File with joints for visualization in PeTrack.");
-            break;
+            throw std::invalid_argument("You need a C3D-File with joints for visualization in PeTrack.");
         }
 
         XSenseStruct skeletonStruct;
@@ -287,62 +394,62 @@ std::variant<std::unordered_map<int, int>, std::string> IO::readMarkerIDFile(con
             {
                 return "Could not open " + markerFileName.toStdString();
             }
+            const QByteArray content = markerFile.readAll();
+            return parseMarkerIDs(std::string_view(content.constData(), static_cast<std::size_t>(content.size())));
+        }
 
-            std::unordered_map<int, int> markerIDs;
+        return "Cannot load " + markerFileName.toStdString() +
+               " maybe because of wrong file extension. Needs to be .txt.";
+    }
+    return "No file provided.";
+}
 
-            QTextStream in(&markerFile);
+/// parses the content of a markerID file, see readMarkerIDFile()
+std::variant<std::unordered_map<int, int>, std::string> IO::parseMarkerIDs(std::string_view content)
+{
+    std::unordered_map<int, int> markerIDs;
+    markerIDs.reserve(estimateLines(content));
 
-            while(!in.atEnd())
-            {
-                QString line = in.readLine();
+    std::vector<std::string_view> splitLine;
+    const char                   *pos = content.data();
+    const char                   *end = content.data() + content.size();
+    while(pos != end)
+    {
+        const std::string_view line = nextLine(pos, end);
+        // Skip header/comment line
+        if(!line.empty() && line.front() == '#')
+        {
+            continue;
+        }
 
-                // Skip header/comment line
-                if(line.startsWith("#", Qt::CaseInsensitive))
-                {
-                    continue;
-                }
+        // read line with format: [personID markerID]
+        splitAtSpaces(line, splitLine);
+        if(splitLine.size() == 2)
+        {
+            int personID;
+            if(!toNumber(splitLine[0], personID))
+            {
+                return "PersonID needs to be an integer value, but is " + std::string(splitLine[0]);
+            }
+            int markerID;
+            if(!toNumber(splitLine[1], markerID))
+            {
+                return "MarkerID needs to be an integer value, but is " + std::string(splitLine[1]);
+            }
 
-                // read line with format: [personID markerID]
-                if(auto splitLine = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts); splitLine.size() == 2)
-                {
-                    bool personIDConverted = true;
-                    int  personID          = splitLine[0].toInt(&personIDConverted);
-                    if(!personIDConverted)
-                    {
-                        return "PersonID needs to be an integer value, but is " + splitLine[0].toStdString();
-                    }
-                    bool markerIDConverted = true;
-                    int  markerID          = splitLine[1].toInt(&markerIDConverted);
-
-                    if(!markerIDConverted)
-                    {
-                        return "MarkerID needs to be an integer value, but is " + splitLine[1].toStdString();
-                    }
-
-                    if(auto inserted = markerIDs.insert(std::make_pair(personID, markerID)); !inserted.second)
-                    {
-                        return "Duplicate entry for personID = " + std::to_string(personID) + ".";
-                    }
-                }
-                else if(splitLine.empty())
-                {
-                    // ignore empty lines
-                    continue;
-                }
-                else
-                {
-                    return "Line should contain exactly 2 values: personID markerID. But it contains " +
-                           std::to_string(splitLine.size()) + " entries.";
-                }
+            if(auto inserted = markerIDs.emplace(personID, markerID); !inserted.second)
+            {
+                return "Duplicate entry for personID = " + std::to_string(personID) + ".";
             }
-            markerFile.close();
-            return markerIDs;
         }
-
-        return "Cannot load " + markerFileName.toStdString() +
-               " maybe because of wrong file extension. Needs to be .txt.";
+        else if(!splitLine.empty())
+        {
+            return "Line should contain exactly 2 values: personID markerID. But it contains " +
+                   std::to_string(splitLine.size()) + " entries.";
+        }
+        // ignore empty lines
     }
-    return "No file provided.";
+    return markerIDs;
 }
 
 /**
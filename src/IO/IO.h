@@ -23,6 +23,7 @@
 #include <ezc3d_all.h>
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 class MoCapStorage;
@@ -33,14 +34,18 @@ class MoCapPersonMetadata;
 namespace IO
 {
 std::variant<std::unordered_map<int, float>, std::string> readHeightFile(const QString &heightFileName);
+std::variant<std::unordered_map<int, float>, std::string> parseHeights(std::string_view content);
 
-void readMoCapC3D(MoCapStorage &storage, const MoCapPersonMetadata &metadata);
+std::variant<MoCapPerson, std::string> loadMoCapC3D(const MoCapPersonMetadata &metadata, double videoDuration = -1);
+void readMoCapC3D(MoCapStorage &storage, const MoCapPersonMetadata &metadata, double videoDuration = -1);
 void readSkeletonC3D_XSENS(
     const ezc3d::c3d                                                           &c3d,
     MoCapPerson                                                                &person,
-    const std::function<cv::Point3f(const ezc3d::DataNS::Points3dNS::Point &)> &c3dToPoint3f);
+    const std::function<cv::Point3f(const ezc3d::DataNS::Points3dNS::Point &)> &c3dToPoint3f,
+    double                                                                      videoDuration = -1);
 
 std::variant<std::unordered_map<int, int>, std::string> readMarkerIDFile(const QString &markerFileName);
+std::variant<std::unordered_map<int, int>, std::string> parseMarkerIDs(std::string_view content);
 
 std::vector<std::string> readAuthors(const QString &authorsFile);
 } // namespace IO
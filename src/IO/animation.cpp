@@ -32,19 +32,24 @@ they can be represented in QT.
 #include "animation.h"
 
 #include "filter.h"
+#include "framePrefetcher.h"
 #include "helper.h"
+#include "imageSequenceIndex.h"
 #include "logger.h"
 #include "pMessageBox.h"
 #include "petrack.h"
+#include "trace.h"
+#include "videoDecoder.h"
 
 #include <QDir>
 #include <QFileInfo>
-#include <QRegExp>
 #include <QSize>
 #include <QStringList>
 #include <QTime>
 #include <QWidget>
+#include <QtConcurrent>
 #include <iomanip>
+#include <numeric>
 #include <opencv2/opencv.hpp>
 #include <sstream>
 
@@ -76,6 +81,7 @@ Animation::Animation(QWidget *wParent)
 
 Animation::~Animation()
 {
+    abortVideoIndex();
     if(mImgSeq)
     {
         freePhoto();
@@ -108,6 +114,8 @@ cv::Mat Animation::getPreviousFrame()
 /// Returns the frame at the index index
 cv::Mat Animation::getFrameAtIndex(int index)
 {
+    TRACE_ZONE("Animation::getFrameAtIndex");
+    StageTimer timer(mMainWindow->getPipelineStatistics().decode);
     if(mCameraLiveStream)
     {
         return getFrameVideo(index);
@@ -180,6 +188,19 @@ void Animation::skipFrame(int num)
             mMainWindow->updateShowFPS(true);
         }
     }
+    else if((mVideoCapture.isOpened() && (mPrefetcher || mCaptureOutOfSync)) || mSegments.isOpen())
+    {
+        // the prefetcher drops the skipped frames on the next fetch and
+        // grabbing makes no sense, if mVideoCapture is not at mCurrentFrame anyway;
+        // the decoders of video lists grab or seek on the next read themselves
+        int lastFrameNum = getSourceOutFrameNum();
+        for(int i = 0; i < num && mCurrentFrame < lastFrameNum; ++i)
+        {
+            mCurrentFrame += 1;
+            mMainWindow->updateShowFPS(true);
+        }
+        mCaptureOutOfSync = true;
+    }
     else if(mVideoCapture.isOpened())
     {
         int lastFrameNum = getSourceOutFrameNum();
@@ -205,9 +226,10 @@ bool Animation::openTimeFile(QString &timeFileName)
     int   lframe = -1, lcycSec = -1, lcycCount = -1; // fuer vorangegangenen frame
     int frame = -1, cycSec = -1, cycCount = -1, cycOffset = -1, sec = -1, microSec = -1, bufIndex = -1, bufSeqNum = -1,
         seqNum = -1;
-    int    dum, add = 0;
-    double fps, dif, difMin = 1000., difMax = -1000.;
-    int    minFrame = -1, maxFrame = -1;
+    int                 dum, add = 0;
+    double              fps, dif, difMin = 1000., difMax = -1000.;
+    int                 minFrame = -1, maxFrame = -1;
+    std::vector<double> times; // seconds since frame 0 by the clock of the bus
 
     SPDLOG_INFO("Found corresponding time file: {}", timeFileName);
 
@@ -257,6 +279,11 @@ bool Animation::openTimeFile(QString &timeFileName)
                     minFrame = lframe;
                 }
             }
+            if(frame >= 0)
+            {
+                times.resize(std::max(times.size(), static_cast<size_t>(frame) + 1));
+                times[frame] = (cycSec - fcycSec + add) + (cycCount - fcycCount) / 8000.;
+            }
             lframe    = frame;
             lcycSec   = cycSec;
             lcycCount = cycCount;
@@ -280,6 +307,8 @@ bool Animation::openTimeFile(QString &timeFileName)
             minFrame,
             minFrame + 1);
         setSequenceFPS(fps);
+        mFrameTimes.setTimes(std::move(times));
+        mFrameTimes.setStart(static_cast<qint64>(mFirstSec) * 1000000 + mFirstMicroSec);
         mStereo         = true;
         mSourceOutFrame = frame; // mNumFrames = frame+1;
 
@@ -310,21 +339,37 @@ QString Animation::getTimeString(int frame)
     {
         frame = getCurrentFrameNum();
     }
+    getVideoIndex(); // takes over the timestamps of the video, once they are read
+    return mFrameTimes.toString(frame);
+}
 
-    if(mFirstSec != -1) // stereo video from arena with 16 fps
+/**
+ * @brief Returns the time of frame in seconds since the first frame
+ *
+ * Without time file or variable frame rate this is frame / fps.
+ */
+double Animation::getFrameTime(int frame)
+{
+    getVideoIndex();
+    return mFrameTimes.seconds(frame);
+}
+
+/**
+ * @brief Returns the keyframes of the video
+ *
+ * @return the keyframes, empty if there is no keyframe index; std::nullopt while it is still built
+ */
+std::optional<std::vector<int>> Animation::getKeyFrames()
+{
+    if(const VideoIndex *index = getVideoIndex())
     {
-        QDateTime dt;
-        int       deziMilliSec = frame % 16 * 625 + mFirstMicroSec / 100; // 625 = 10000/16
-        dt.setTime_t(mFirstSec + frame / 16 + deziMilliSec / 10000);
-        return (dt.toString("dd.MM.yyyy hh:mm:ss") + ".%1").arg(deziMilliSec % 10000, 4, 10, QChar('0'));
+        return index->getKeyFrames();
     }
-    else
+    if(!mVideoIndexFuture.isFinished())
     {
-        int   sec = (int) (frame / mSequenceFps);
-        QTime t(0, 0, 0);
-        t = t.addSecs(sec);
-        return (t.toString("hh:mm:ss") + ".%1").arg(myRound(((frame / mSequenceFps) - sec) * 10000), 4, 10, QChar('0'));
+        return std::nullopt;
     }
+    return std::vector<int>();
 }
 
 /**
@@ -341,12 +386,20 @@ bool Animation::openAnimation(QString fileName)
         bool      openRet      = false;
         QString   timeFileName = fileName.left(fileName.lastIndexOf("cam") + 4) + ".time";
         QFileInfo fileTimeInfo(timeFileName);
+        mFrameTimes.clear();
         if(fileTimeInfo.exists())
         {
             mTimeFileLoaded = openTimeFile(timeFileName);
         }
-        // now all videos will be try to open with OpenCV
-        openRet = openAnimationPhoto(fileName);
+        if(fileInfo.suffix().compare("vlist", Qt::CaseInsensitive) == 0)
+        {
+            openRet = openAnimationSegments(fileName);
+        }
+        else
+        {
+            // now all videos will be try to open with OpenCV
+            openRet = openAnimationPhoto(fileName);
+        }
 
         // If it is not a video, then is a photo :-)
         if(openRet == false) // es konnte keine Bildsequenz geladen werden
@@ -390,6 +443,7 @@ bool Animation::openCameraStream(int camID)
         {
             return false;
         }
+        mLiveCapture.start(mVideoCapture, mGrayscale);
     }
     return true;
 }
@@ -479,9 +533,11 @@ double Animation::getPlaybackFPS()
 {
     if(mCameraLiveStream)
     {
-        if(mVideoCapture.get(cv::CAP_PROP_FPS))
+        // mVideoCapture belongs to the capture thread while it is running
+        const double fps = mLiveCapture.isRunning() ? mLiveCapture.getFps() : mVideoCapture.get(cv::CAP_PROP_FPS);
+        if(fps)
         {
-            setPlaybackFPS(mVideoCapture.get(cv::CAP_PROP_FPS));
+            setPlaybackFPS(fps);
         }
     }
     if(mVideo)
@@ -509,9 +565,11 @@ double Animation::getSequenceFPS()
 {
     if(mCameraLiveStream)
     {
-        if(mVideoCapture.get(cv::CAP_PROP_FPS))
+        // mVideoCapture belongs to the capture thread while it is running
+        const double fps = mLiveCapture.isRunning() ? mLiveCapture.getFps() : mVideoCapture.get(cv::CAP_PROP_FPS);
+        if(fps)
         {
-            setSequenceFPS(mVideoCapture.get(cv::CAP_PROP_FPS));
+            setSequenceFPS(fps);
         }
     }
     if(mVideo)
@@ -544,6 +602,7 @@ void Animation::setPlaybackFPS(double fps)
 void Animation::setSequenceFPS(double fps)
 {
     mSequenceFps = fps;
+    mFrameTimes.setFps(fps);
 }
 
 /// Returns the size of the original frames (could made bigger after filtering)
@@ -593,6 +652,7 @@ void Animation::reset()
     mFirstSec         = -1;
     mFirstMicroSec    = -1;
     mCaptureStereo    = nullptr;
+    mFrameTimes.clear();
 
 
     mTimeFileLoaded = false;
@@ -612,6 +672,12 @@ QFileInfo Animation::getFileInfo()
     return mFileInfo;
 }
 
+/// Returns the files of the image sequence (empty for other sequences)
+QStringList Animation::getImageFiles() const
+{
+    return mImgSeq ? mImgFilesList : QStringList();
+}
+
 bool Animation::isVideo() const
 {
     return mVideo;
@@ -632,6 +698,17 @@ bool Animation::isCameraLiveStream() const
     return mCameraLiveStream;
 }
 
+/// Returns if the sequence consists of the video files of a video list
+bool Animation::isVideoSegments() const
+{
+    return mSegments.isOpen();
+}
+
+VideoSegments &Animation::getVideoSegments()
+{
+    return mSegments;
+}
+
 enum Camera Animation::getCamera()
 {
     if(mCaptureStereo != nullptr)
@@ -654,21 +731,16 @@ void Animation::setCamera(enum Camera c)
 
 bool Animation::openAnimationPhoto(QString fileName)
 {
-    // check, if cv can open one animation file
-
-    cv::Mat tempMat;
-    tempMat =
-        cv::imread(fileName.toStdString(), cv::IMREAD_UNCHANGED); //, IMREAD_UNCHANGED);//CV_LOAD_IMAGE_UNCHANGED);
-
-    // Check for invalid input
-    if(!tempMat.data)
+    // the file list and the format of the images are cached next to the images, so even
+    // huge sequences on network shares are opened without decoding or querying every file
+    const ImageSequenceIndex index = ImageSequenceIndex::create(fileName);
+    if(index.isEmpty())
     {
         return false;
     }
-    if(tempMat.channels() == 4)
+    if(index.getChannels() == 4)
     {
         SPDLOG_WARN("PNG-Alpha channel will be ignored");
-        tempMat = cv::imread(fileName.toStdString(), cv::IMREAD_COLOR);
     }
 
     // Destroy anything that was before
@@ -680,44 +752,13 @@ bool Animation::openAnimationPhoto(QString fileName)
     mCameraLiveStream = false;
 
     // Accessing to file information and directory information
-    mFileInfo = QFileInfo(fileName);
-    QDir dir  = mFileInfo.dir();
-    // Get all files in the same directory
-    QList<QFileInfo> fileList = dir.entryInfoList(QDir::Files, QDir::Name);
-
-    // series1_0002-left => split into series1_|0002|-left
-    // regexp is greedy - from left to right try to get the most characters
-    QRegExp regExp("(?:[0-9]*)([^0-9]*)$"); //(?: ) zum ignorieren
-    QString front, back;
-    int     frontLen, frontLenList;
-    if((frontLen = regExp.indexIn(mFileInfo.completeBaseName())) > -1)
-    {
-        front = mFileInfo.completeBaseName().left(frontLen);
-        back  = regExp.cap(1);
-    }
-    else // does not match regExp at all
-    {
-        return false;
-    }
-    mFileBase = front + back; // completeBaseName to cut suffix and sequence number
-
-    // Create a new image files list
-    mImgFilesList.clear();
-    for(int i = 0; i < fileList.size(); i++)
-    {
-        if((frontLenList = regExp.indexIn(fileList.at(i).completeBaseName())) > -1)
-        {
-            // Is the file in the series?
-            if((fileList.at(i).completeBaseName().left(frontLenList) == front) && (regExp.cap(1) == back) &&
-               (fileList.at(i).suffix() == mFileInfo.suffix()))
-            {
-                mImgFilesList << fileList.at(i).filePath();
-            }
-        }
-    }
+    mFileInfo     = QFileInfo(fileName);
+    mFileBase     = index.getFileBase(); // completeBaseName to cut suffix and sequence number
+    mImgFilesList = index.getFiles();
+    mImageLoader.setFiles(mImgFilesList);
 
     // Get the information of the animation
-    if(!getInfoPhoto())
+    if(!getInfoPhoto(index))
     {
         return false;
     }
@@ -734,7 +775,8 @@ bool Animation::openAnimationPhoto(QString fileName)
  */
 cv::Mat Animation::getFramePhoto(int index)
 {
-    if((index != mCurrentFrame) || mImage.empty())
+    // a reduced frame is decoded again, if full resolution is needed now
+    if((index != mCurrentFrame) || mImage.empty() || (mProxyFrame && !mUseProxy))
     {
         // Check if the index is valid
         if(index < getSourceInFrameNum() || index > getSourceOutFrameNum())
@@ -742,7 +784,19 @@ cv::Mat Animation::getFramePhoto(int index)
             return cv::Mat();
         }
 
-        mImage = cv::imread(mImgFilesList.at(index).toStdString(), cv::IMREAD_UNCHANGED); // CV_LOAD_IMAGE_UNCHANGED);
+        // during playback the images are decoded at reduced size (JPEG scales while decoding) and
+        // enlarged again, so that all coordinates stay in full resolution
+        const bool proxy = mUseProxy && mSize.width() > 0 && mSize.height() > 0;
+        mImageLoader.setScale(proxy ? PROXY_SCALE : 1);
+
+        // reads ahead in playback direction, if enabled (images with alpha channel are read as BGR)
+        const int direction = index < mCurrentFrame ? -1 : 1;
+        mImage              = mImageLoader.load(index, direction, getSourceInFrameNum(), getSourceOutFrameNum());
+        mProxyFrame         = proxy && !mImage.empty();
+        if(mProxyFrame)
+        {
+            cv::resize(mImage, mImage, cv::Size(mSize.width(), mSize.height()), 0, 0, cv::INTER_LINEAR);
+        }
 
         // Check for invalid input
         if(mImage.empty()) // Check for invalid input
@@ -750,11 +804,6 @@ cv::Mat Animation::getFramePhoto(int index)
             SPDLOG_ERROR("Could not open or find the image.");
             return cv::Mat();
         }
-
-        if(mImage.channels() == 4)
-        {
-            mImage = imread(mImgFilesList.at(index).toStdString(), cv::IMREAD_COLOR);
-        }
         // Check image size of each frame
         if((mSize.width() > 0 && mSize.height() > 0) && (mImage.cols != mSize.width() || mImage.rows != mSize.height()))
         {
@@ -790,37 +839,32 @@ cv::Mat Animation::getFramePhoto(int index)
  * This methods gets size and length in frames of the current animation. It
  * should be called just once. Afterwards the saved values can be used.
  *
+ * The size is taken from the index, so no image is decoded; the size of every frame is
+ * checked when it is read (see getFramePhoto()).
+ *
+ * @param index index of the opened image sequence
  * @return If data could be succesfully read
  */
-bool Animation::getInfoPhoto()
+bool Animation::getInfoPhoto(const ImageSequenceIndex &index)
 {
-    bool    rc = false;
-    cv::Mat tempImg;
     // Set the number of frames
     mMaxFrames = mImgFilesList.size();
     setSourceInFrameNum(0);
     setSourceOutFrameNum(mMaxFrames - 1);
-    // Set the size of the frames
-    // For that we need to retrieve a frame!
-    tempImg = getFramePhoto(getSourceInFrameNum());
-    if(!tempImg.empty()) // if frame is loadable
+
+    // 1 or 3 channel (alpha channels are dropped on reading) and 8 bit per pixel
+    const int channels = index.getChannels();
+    if(!((channels == 1 || channels == 3 || channels == 4) && index.getDepth() == CV_8U))
     {
-        // 1 or 3 channel and 8 bit per pixel
-        if(!(((tempImg.channels() == 1) || (tempImg.channels() == 3)) && (tempImg.depth() == CV_8U)))
-        {
-            SPDLOG_ERROR(
-                "Only 1 or 3 channels (you are using {}) and 8 bpp (you are using {}) are supported!",
-                tempImg.channels(),
-                tempImg.depth());
-        }
-        else
-        {
-            mSize.setHeight(tempImg.rows);
-            mSize.setWidth(tempImg.cols);
-            rc = true;
-        }
+        SPDLOG_ERROR(
+            "Only 1 or 3 channels (you are using {}) and 8 bpp (you are using {}) are supported!",
+            channels,
+            index.getDepth());
+        return false;
     }
-    return rc;
+    mSize.setHeight(index.getSize().height);
+    mSize.setWidth(index.getSize().width);
+    return true;
 }
 
 
@@ -833,6 +877,7 @@ void Animation::freePhoto()
     }
     // Clear the list of filenames in the serie
     mImgFilesList.clear();
+    mImageLoader.setFiles(mImgFilesList);
     // Reset size
     mSize.setHeight(0);
     mSize.setWidth(0);
@@ -859,40 +904,151 @@ StereoAviFile *Animation::getCaptureStereo()
 // fileNumber indicates the number of the successive files splited while writing
 bool Animation::openAnimationStereoVideo(int fileNumber, cv::Mat &stereoImgLeft, cv::Mat &stereoImgRight)
 {
-#ifdef STEREO
-    PgrAviFile *captureStereo = new PgrAviFile;
-#else
-    StereoAviFile *captureStereo = new StereoAviFile;
-#endif
+    if(fileNumber < 0 || fileNumber >= mStereoVideoFilesList.length())
+    {
+        return false;
+    }
+    auto *captureStereo = openStereoFile(mStereoVideoFilesList[fileNumber], stereoImgLeft, stereoImgRight, -1);
+    if(!captureStereo)
+    {
+        return false;
+    }
+    releaseNeighborStereoFile();
+    if(mCaptureStereo)
+    {
+        captureStereo->setCamera(mCaptureStereo->getCamera());
+        mCaptureStereo->close();
+        delete mCaptureStereo;
+    }
+    mCurrentStereoFileNumber = fileNumber;
+    mCaptureStereo           = captureStereo;
+    return true;
+}
 
-    if((fileNumber < mStereoVideoFilesList.length()) &&
-       (captureStereo->open(mStereoVideoFilesList[fileNumber].toStdString().c_str(), stereoImgLeft, stereoImgRight)))
+/**
+ * @brief Opens one file of a stereo sequence (may be called from a background thread)
+ *
+ * @param fileName stereo video file
+ * @param stereoImgLeft buffer for the left image of the file
+ * @param stereoImgRight buffer for the right image of the file
+ * @param primeFrame frame (within the file) read right after opening; -1 to read none
+ * @return the opened file (owned by the caller) or nullptr on error
+ */
+Animation::StereoFile *Animation::openStereoFile(
+    const QString &fileName,
+    cv::Mat       &stereoImgLeft,
+    cv::Mat       &stereoImgRight,
+    int            primeFrame)
+{
+    auto *captureStereo = new StereoFile;
+    if(!captureStereo->open(fileName.toStdString().c_str(), stereoImgLeft, stereoImgRight))
     {
-        // wird nun schon vorher abgefragt: vor mTimeFileLoaded war mPlaybackFps == 16 because time file must be loaded
-        // before ;
-        // && (myRound(mPlaybackFps) == 16)
-        if(!((captureStereo->m_iRows == 960) && (captureStereo->m_iCols == 1280) && (captureStereo->m_iBPP == 16)))
-        {
-            SPDLOG_ERROR("Only stereo videos from Hermes experiments with 1280x960 pixel, 16 bits per pixel anf 16 "
-                         "frames per second are supported!");
-            delete captureStereo;
-            return false;
-        }
-        if(mCaptureStereo)
-        {
-            captureStereo->setCamera(mCaptureStereo->getCamera());
-            mCaptureStereo->close();
-            delete mCaptureStereo;
-        }
-        mCurrentStereoFileNumber = fileNumber;
-        mCaptureStereo           = captureStereo;
-        return true;
+        delete captureStereo;
+        return nullptr;
     }
-    else
+    // wird nun schon vorher abgefragt: vor mTimeFileLoaded war mPlaybackFps == 16 because time file must be loaded
+    // before ;
+    // && (myRound(mPlaybackFps) == 16)
+    if(!((captureStereo->m_iRows == 960) && (captureStereo->m_iCols == 1280) && (captureStereo->m_iBPP == 16)))
     {
+        SPDLOG_ERROR("Only stereo videos from Hermes experiments with 1280x960 pixel, 16 bits per pixel anf 16 "
+                     "frames per second are supported!");
         delete captureStereo;
-        return false;
+        return nullptr;
+    }
+    if(primeFrame >= 0)
+    {
+        captureStereo->readFrame(primeFrame);
+    }
+    return captureStereo;
+}
+
+/**
+ * @brief Makes fileNumber the current file of the stereo sequence
+ *
+ * Uses the neighboring file, if it is already opened (in the background),
+ * otherwise opens the file now. The former current file becomes the
+ * neighbor, so stepping back over the boundary needs no reopening.
+ */
+bool Animation::switchStereoFile(int fileNumber)
+{
+    collectNeighborStereoFile();
+    if(!mNeighborCaptureStereo || mNeighborStereoFileNumber != fileNumber)
+    {
+        return openAnimationStereoVideo(fileNumber, mStereoImgLeft, mStereoImgRight);
+    }
+    mNeighborCaptureStereo->setCamera(mCaptureStereo->getCamera());
+    std::swap(mCaptureStereo, mNeighborCaptureStereo);
+    std::swap(mCurrentStereoFileNumber, mNeighborStereoFileNumber);
+    std::swap(mStereoImgLeft, mNeighborStereoImgLeft);
+    std::swap(mStereoImgRight, mNeighborStereoImgRight);
+    return true;
+}
+
+/**
+ * @brief Starts opening the neighboring stereo file, if index is close to a file boundary
+ *
+ * Near the end of the current file the next one is opened, near the beginning
+ * the previous one. The first frame read after the switch is decoded ahead, too.
+ *
+ * @param index frame just read
+ */
+void Animation::prefetchStereoFile(int index)
+{
+    const int frameInFile = index - mCurrentStereoFileNumber * STEREO_FILE_FRAMES;
+    int       fileNumber  = -1;
+    if(frameInFile >= STEREO_FILE_FRAMES - STEREO_PREFETCH_MARGIN)
+    {
+        fileNumber = mCurrentStereoFileNumber + 1;
+    }
+    else if(frameInFile < STEREO_PREFETCH_MARGIN)
+    {
+        fileNumber = mCurrentStereoFileNumber - 1;
     }
+    if(fileNumber < 0 || fileNumber >= mStereoVideoFilesList.length() || fileNumber == mNeighborStereoFileNumber ||
+       mNeighborStereoImgLeft.empty())
+    {
+        return;
+    }
+
+    releaseNeighborStereoFile();
+    mNeighborStereoFileNumber = fileNumber;
+    const int primeFrame      = fileNumber > mCurrentStereoFileNumber ? 0 : STEREO_FILE_FRAMES - 1;
+    mNeighborStereoFuture     = QtConcurrent::run(
+        [fileName = mStereoVideoFilesList[fileNumber],
+         left     = mNeighborStereoImgLeft,
+         right    = mNeighborStereoImgRight,
+         primeFrame]() mutable { return openStereoFile(fileName, left, right, primeFrame); });
+}
+
+/**
+ * @brief Waits for a pending background open of the neighboring stereo file and takes its result
+ */
+void Animation::collectNeighborStereoFile()
+{
+    if(mNeighborStereoFuture.resultCount() == 0 && mNeighborStereoFuture.isFinished())
+    {
+        return;
+    }
+    mNeighborStereoFuture.waitForFinished();
+    mNeighborCaptureStereo = mNeighborStereoFuture.result();
+    if(!mNeighborCaptureStereo)
+    {
+        mNeighborStereoFileNumber = -1;
+    }
+    mNeighborStereoFuture = QFuture<StereoFile *>();
+}
+
+void Animation::releaseNeighborStereoFile()
+{
+    collectNeighborStereoFile();
+    if(mNeighborCaptureStereo)
+    {
+        mNeighborCaptureStereo->close();
+        delete mNeighborCaptureStereo;
+        mNeighborCaptureStereo = nullptr;
+    }
+    mNeighborStereoFileNumber = -1;
 }
 // like above for the first time with new filename
 bool Animation::openAnimationStereoVideo(QString fileName)
@@ -917,6 +1073,8 @@ bool Animation::openAnimationStereoVideo(QString fileName)
         size.height = 960;
         mStereoImgLeft.create(size, CV_8UC1);
         mStereoImgRight.create(size, CV_8UC1);
+        mNeighborStereoImgLeft.create(size, CV_8UC1);
+        mNeighborStereoImgRight.create(size, CV_8UC1);
 
         ret = openAnimationStereoVideo(0, mStereoImgLeft, mStereoImgRight);
     }
@@ -935,7 +1093,9 @@ bool Animation::openAnimationStereoVideo(QString fileName)
 /// Opens an animation from a video file
 bool Animation::openAnimationVideo(QString fileName)
 {
-    if(!mVideoCapture.open(fileName.toStdString().c_str()))
+    mFrameCache.clear();
+    mSegments.close();
+    if(!videoDecoder::open(mVideoCapture, fileName.toStdString(), mHwAcceleration))
     {
         return false;
     }
@@ -991,6 +1151,7 @@ bool Animation::openAnimationVideo(QString fileName)
     }
     else
     {
+        releaseNeighborStereoFile();
         if(mCaptureStereo)
         {
             mCaptureStereo->close();
@@ -1006,7 +1167,17 @@ bool Animation::openAnimationVideo(QString fileName)
         // Get the information of the animation
         if(!getInfoVideo(fileName))
         {
-            return false;
+            if(mHwAcceleration == cv::VIDEO_ACCELERATION_NONE ||
+               !videoDecoder::open(mVideoCapture, fileName.toStdString(), cv::VIDEO_ACCELERATION_NONE))
+            {
+                return false;
+            }
+            SPDLOG_WARN("Could not decode {} with hardware acceleration, falling back to CPU decoding.", fileName);
+            mCurrentFrame = -1;
+            if(!getInfoVideo(fileName))
+            {
+                return false;
+            }
         }
         // Set the current frame to -1 (shows, that no frame is already loaded)
     }
@@ -1016,6 +1187,13 @@ bool Animation::openAnimationVideo(QString fileName)
     mFileSuffix   = mFileInfo.suffix();
     mCurrentFrame = -1; // Set the current frame to -1 (shows, that no frame is already loaded)
 
+    initPrefetcher();
+    if(!mStereo)
+    {
+        startVideoIndex(fileName);
+        initProxy();
+    }
+
     return true;
 }
 
@@ -1025,12 +1203,21 @@ cv::Mat Animation::getFrameVideo(int index)
 {
     if(mCameraLiveStream)
     {
-        if(mVideoCapture.read(mImage /*tempMat*/))
+        // the capture thread is started after the first frame was read by getCameraInfo
+        if(!mLiveCapture.isRunning())
+        {
+            mLiveFrameTime = LiveCapture::Clock::now();
+        }
+        if(mLiveCapture.isRunning() ? mLiveCapture.read(mImage, mLiveFrameTime) : mVideoCapture.read(mImage))
         {
             if(mImage.empty()) // tempImg == NULL)
             {
                 return cv::Mat();
             }
+            if(mGrayscale)
+            {
+                videoDecoder::toGrayscale(mImage);
+            }
 
             mCurrentFrame++;
         }
@@ -1044,6 +1231,10 @@ cv::Mat Animation::getFrameVideo(int index)
         {
             return cv::Mat();
         }
+        if(mSegments.isOpen())
+        {
+            return getFrameSegments(index);
+        }
         if(mVideo && !mStereo)
         {
             // Check if we have a valid capture device
@@ -1051,16 +1242,83 @@ cv::Mat Animation::getFrameVideo(int index)
             {
                 return cv::Mat();
             }
+            const bool forward = mCurrentFrame + 1 == index;
+            mProxyFrame        = false;
+            if(mFrameCache.get(index, mImage))
+            {
+                mCurrentFrame     = index;
+                mCaptureOutOfSync = true;
+                return mImage;
+            }
+            cv::Mat proxyImg;
+            if(mUseProxy && mProxy.read(index, proxyImg, cv::Size(mSize.width(), mSize.height())))
+            {
+                if(mGrayscale)
+                {
+                    videoDecoder::toGrayscale(proxyImg);
+                }
+                // not cached, proxy frames must not be mixed up with full resolution frames
+                mImage            = proxyImg;
+                mCurrentFrame     = index;
+                mCaptureOutOfSync = true;
+                mProxyFrame       = true;
+                return mImage;
+            }
+            if(mUseMezzanine && mMezzanine.read(index, mImage, cv::Size(mSize.width(), mSize.height())))
+            {
+                if(mGrayscale)
+                {
+                    videoDecoder::toGrayscale(mImage);
+                }
+                mFrameCache.insert(index, mImage);
+                mCurrentFrame     = index;
+                mCaptureOutOfSync = true;
+                return mImage;
+            }
+            if(mPrefetcher && mPrefetcher->fetch(index, mImage))
+            {
+                mFrameCache.insert(index, mImage);
+                mCurrentFrame     = index;
+                mCaptureOutOfSync = true;
+                return mImage;
+            }
+            // stepping backwards: decode a whole block ending at index at once instead of seeking for every frame
+            if(mCurrentFrame - 1 == index && decodeVideoBlock(index) && mFrameCache.get(index, mImage))
+            {
+                mCurrentFrame = index;
+                if(mPrefetcher)
+                {
+                    // decode the frames before the cached block concurrently to the work on the cached ones
+                    int blockStart = index;
+                    while(blockStart > getSourceInFrameNum() && mFrameCache.contains(blockStart - 1))
+                    {
+                        --blockStart;
+                    }
+                    mPrefetcher->restart(blockStart - 1, getSourceInFrameNum(), true);
+                }
+                return mImage;
+            }
             // Now we need to see if it is necessary to seek for the frame or if we can use
             // directly the cvQueryFrame function
             // This is tested since the seek function takes a lot of time!
-            if(index == getSourceInFrameNum() || mCurrentFrame + 1 != index)
+            if(index == getSourceInFrameNum() || !forward || mCaptureOutOfSync)
             {
-                if(!mVideoCapture.set(cv::CAP_PROP_POS_FRAMES, index))
+                if(!seekVideo(index, !mCaptureOutOfSync && index != getSourceInFrameNum()))
                 {
                     SPDLOG_ERROR("video file does not support skipping");
                     return cv::Mat();
                 }
+                mCaptureOutOfSync = false;
+            }
+            if(mVirtualBorder.isEnabled() && !mGrayscale && !mSize.isEmpty())
+            {
+                // decode straight into the interior of a free buffer with border
+                mImage = mVirtualBorder.frame(cv::Size(mSize.width(), mSize.height()), CV_8UC3);
+            }
+            else if(mFrameCache.isEnabled())
+            {
+                // cached frames share their buffer with mImage, so read has to allocate a new one
+                mImage = cv::Mat();
             }
             // Query the frame
             if(mVideoCapture.read(mImage))
@@ -1069,6 +1327,16 @@ cv::Mat Animation::getFrameVideo(int index)
                 {
                     return cv::Mat();
                 }
+                if(mGrayscale)
+                {
+                    videoDecoder::toGrayscale(mImage);
+                }
+                mFrameCache.insert(index, mImage);
+                // backward playback restarts the prefetcher after decoding a block (see above)
+                if(mPrefetcher && forward)
+                {
+                    mPrefetcher->restart(index + 1, getSourceOutFrameNum());
+                }
             }
             else
             {
@@ -1084,21 +1352,123 @@ cv::Mat Animation::getFrameVideo(int index)
         }
         else if(mStereo && mCaptureStereo) // stereo video
         {
-            if(index / 640 != mCurrentStereoFileNumber) // 640 stereo frames in one file
+            if(index / STEREO_FILE_FRAMES != mCurrentStereoFileNumber)
             {
-                openAnimationStereoVideo(index / 640, mStereoImgLeft, mStereoImgRight);
+                switchStereoFile(index / STEREO_FILE_FRAMES);
             }
-            mImage = mCaptureStereo->readFrame(index - mCurrentStereoFileNumber * 640);
+            mImage = mCaptureStereo->readFrame(index - mCurrentStereoFileNumber * STEREO_FILE_FRAMES);
+            prefetchStereoFile(index);
         }
         // We set the current frame index
         mCurrentFrame = index;
     }
     else if(mStereo && (index == mCurrentFrame)) // da mgl anderes Bild rechte/links angefordert wird
-        mImage = mCaptureStereo->readFrame(index - mCurrentStereoFileNumber * 640);
+        mImage = mCaptureStereo->readFrame(index - mCurrentStereoFileNumber * STEREO_FILE_FRAMES);
     // Return the pointer to the IplImage :-)
     return mImage;
 }
 
+/**
+ * @brief Opens the video files listed in listFile as one sequence
+ *
+ * The frames of the files are numbered continuously. Files with different frame rates
+ * are joined in time by the table of frame times. Prefetching, the keyframe index and
+ * the proxy are only available for single video files.
+ */
+bool Animation::openAnimationSegments(const QString &listFile)
+{
+    const auto files = VideoSegments::readList(listFile);
+    if(!files)
+    {
+        return false;
+    }
+    // Destroy anything that was before
+    free();
+    if(!mSegments.open(*files, mHwAcceleration))
+    {
+        return false;
+    }
+    mStereo           = false;
+    mVideo            = true;
+    mImgSeq           = false;
+    mCameraLiveStream = false;
+
+    mSize      = QSize(mSegments.getSize().width, mSegments.getSize().height);
+    mMaxFrames = mSegments.getNumFrames();
+    setPlaybackFPS(mSegments.getSegments().front().fps);
+    setSequenceFPS(mSegments.getSegments().front().fps);
+    if(mSegments.hasVariableFps() && !mTimeFileLoaded)
+    {
+        mFrameTimes.setTimes(mSegments.frameTimes());
+    }
+    setSourceInFrameNum(0);
+    setSourceOutFrameNum(mMaxFrames - 1);
+
+    mFileInfo     = QFileInfo(listFile);
+    mFileBase     = mFileInfo.completeBaseName();
+    mFileSuffix   = mFileInfo.suffix();
+    mCurrentFrame = -1; // Set the current frame to -1 (shows, that no frame is already loaded)
+    SPDLOG_INFO("Opened {} video files with {} frames as one sequence.", files->size(), mMaxFrames);
+    return true;
+}
+
+/// Returns the frame at given index of a video list
+cv::Mat Animation::getFrameSegments(int index)
+{
+    if(mFrameCache.get(index, mImage))
+    {
+        mCurrentFrame = index;
+        return mImage;
+    }
+    // stepping backwards: decode a whole block ending at index at once instead of seeking for every frame
+    if(mCurrentFrame - 1 == index)
+    {
+        const int first = std::max(index - static_cast<int>(VIDEO_BLOCK_SIZE) + 1, getSourceInFrameNum());
+        std::vector<int> frames(index - first + 1);
+        std::iota(frames.begin(), frames.end(), first);
+        const auto images = mSegments.readFrames(frames);
+        for(std::size_t i = 0; i < frames.size(); ++i)
+        {
+            if(!images[i].empty())
+            {
+                cv::Mat img = images[i];
+                if(mGrayscale)
+                {
+                    videoDecoder::toGrayscale(img);
+                }
+                mFrameCache.insert(frames[i], img);
+            }
+        }
+        if(mFrameCache.get(index, mImage))
+        {
+            mCurrentFrame = index;
+            return mImage;
+        }
+    }
+    if(mVirtualBorder.isEnabled() && !mGrayscale && !mSize.isEmpty())
+    {
+        // decode straight into the interior of a free buffer with border
+        mImage = mVirtualBorder.frame(cv::Size(mSize.width(), mSize.height()), CV_8UC3);
+    }
+    else
+    {
+        // cached frames share their buffer with mImage, so read has to allocate a new one
+        mImage = cv::Mat();
+    }
+    if(!mSegments.read(index, mImage))
+    {
+        SPDLOG_WARN("Frame {} of the video list is not loadable!", index);
+        return cv::Mat();
+    }
+    if(mGrayscale)
+    {
+        videoDecoder::toGrayscale(mImage);
+    }
+    mFrameCache.insert(index, mImage);
+    mCurrentFrame = index;
+    return mImage;
+}
+
 /// Gets Size and Frame number information of the recently open animation
 /// It is thought to be called once just at the opening of an animation
 bool Animation::getInfoVideo(QString /*fileName*/)
@@ -1230,6 +1600,17 @@ bool Animation::getCameraInfo()
 /// Free's the video data
 void Animation::freeVideo()
 {
+    abortVideoIndex();
+    mLiveCapture.stop();
+    releaseNeighborStereoFile();
+    mProxy.stop();
+    mProxyFrame = false;
+    mMezzanine.stop();
+    mUseMezzanine = false;
+    mPrefetcher.reset();
+    mFrameCache.clear();
+    mSegments.close();
+    mCaptureOutOfSync = false;
     // Release the capture device
     if(mVideoCapture.isOpened())
     {
@@ -1241,3 +1622,444 @@ void Animation::freeVideo()
         mImage = cv::Mat();
     }
 }
+
+/**
+ * @brief Sets the number of frames decoded ahead in a background thread
+ *
+ * For (non-stereo) video files the decoded frames are kept in a ring buffer,
+ * so forward playback and tracking can overlap with decoding. For image
+ * sequences the next depth files are read in parallel by a thread pool.
+ * Memory usage grows by depth times the size of one frame.
+ *
+ * @param depth number of prefetched frames; 0 disables prefetching
+ */
+void Animation::setPrefetchDepth(int depth)
+{
+    depth = std::max(depth, 0);
+    if(depth == mPrefetchDepth)
+    {
+        return;
+    }
+    mPrefetchDepth = depth;
+    mImageLoader.setDepth(depth);
+    initPrefetcher();
+}
+
+int Animation::getPrefetchDepth() const
+{
+    return mPrefetchDepth;
+}
+
+void Animation::initPrefetcher()
+{
+    mPrefetcher.reset();
+    mCaptureOutOfSync = true; // position of mVideoCapture is unknown to the next read
+    if(mPrefetchDepth <= 0 || !mVideo || mStereo || mCameraLiveStream || !mVideoCapture.isOpened())
+    {
+        return;
+    }
+    // use the acceleration which actually works for mVideoCapture, fallback may have happened
+    const auto acceleration =
+        videoDecoder::toAcceleration(static_cast<int>(mVideoCapture.get(cv::CAP_PROP_HW_ACCELERATION)));
+    mPrefetcher = std::make_unique<FramePrefetcher>(
+        mFileInfo.absoluteFilePath().toStdString(), mPrefetchDepth, acceleration, mGrayscale);
+    if(!mPrefetcher->isOpened())
+    {
+        mPrefetcher.reset();
+    }
+}
+
+/**
+ * @brief Sets the memory limit of the cache for decoded video frames
+ *
+ * The cache is filled during playback and makes stepping backwards (e.g. backward
+ * tracking) cost one decode instead of one seek per frame.
+ *
+ * @param megaBytes memory limit in MB; 0 disables the cache
+ */
+void Animation::setFrameCacheSize(int megaBytes)
+{
+    mFrameCache.setMaxBytes(static_cast<std::size_t>(std::max(megaBytes, 0)) * 1024 * 1024);
+}
+
+int Animation::getFrameCacheSize() const
+{
+    return static_cast<int>(mFrameCache.getMaxBytes() / (1024 * 1024));
+}
+
+/// Returns the memory used by the cached frames in bytes
+std::size_t Animation::getFrameCacheBytes() const
+{
+    return mFrameCache.bytes();
+}
+
+/**
+ * @brief Returns the number of decoded frames waiting to be processed
+ *
+ * These are the frames captured by the thread of a camera live stream or the frames
+ * decoded ahead by the FramePrefetcher of a video.
+ */
+int Animation::getQueuedFrames()
+{
+    if(mCameraLiveStream)
+    {
+        return mLiveCapture.getQueuedFrames();
+    }
+    return mPrefetcher ? mPrefetcher->getQueuedFrames() : 0;
+}
+
+/**
+ * @brief Sets what the capture thread of a camera live stream does, if the processing cannot keep up
+ *
+ * See LiveCapture::DropPolicy.
+ */
+void Animation::setLiveDropPolicy(LiveCapture::DropPolicy policy)
+{
+    mLiveCapture.setDropPolicy(policy);
+}
+
+LiveCapture::DropPolicy Animation::getLiveDropPolicy() const
+{
+    return mLiveCapture.getDropPolicy();
+}
+
+/**
+ * @brief Returns the number of camera frames discarded since the live stream was opened
+ */
+int Animation::getDroppedLiveFrames() const
+{
+    return mLiveCapture.getDroppedFrames();
+}
+
+/**
+ * @brief Returns the time the current frame of the camera live stream was captured
+ */
+LiveCapture::Clock::time_point Animation::getLiveFrameTime() const
+{
+    return mLiveFrameTime;
+}
+
+/**
+ * @brief Enables playback from a low resolution proxy of the video
+ *
+ * The proxy (<video>.proxy.avi) is created in the background on first use.
+ * Image sequences need no proxy file, their images are decoded at reduced size.
+ * Whether frames are actually read from it is decided per frame via
+ * setUseProxy(), since tracking, recognition and export need the full
+ * resolution.
+ *
+ * @param enabled true, to create and use the proxy
+ */
+void Animation::setProxyPlayback(bool enabled)
+{
+    if(enabled == mProxyPlayback)
+    {
+        return;
+    }
+    mProxyPlayback = enabled;
+    initProxy();
+}
+
+bool Animation::isProxyPlayback() const
+{
+    return mProxyPlayback;
+}
+
+/**
+ * @brief Sets, if the next frames may be read from the proxy (if it is ready)
+ */
+void Animation::setUseProxy(bool useProxy)
+{
+    mUseProxy = useProxy && mProxyPlayback;
+}
+
+/**
+ * @brief Returns, if the current frame was read from the proxy and thus has reduced resolution
+ *
+ * This also holds for images of sequences decoded at reduced size. Such frames are only
+ * for viewing and must not be stored or used for any processing.
+ */
+bool Animation::isProxyFrame() const
+{
+    return mProxyFrame;
+}
+
+/**
+ * @brief Decodes the current frame again in full resolution, if it was read from the proxy
+ *
+ * @return the current frame in full resolution
+ */
+cv::Mat Animation::reloadFullResolution()
+{
+    if(!mProxyFrame)
+    {
+        return mImage;
+    }
+    const bool useProxy = mUseProxy;
+    mUseProxy           = false;
+    mImage              = cv::Mat();
+    if(mImgSeq)
+    {
+        getFramePhoto(mCurrentFrame);
+    }
+    else
+    {
+        getFrameVideo(mCurrentFrame);
+    }
+    mUseProxy = useProxy;
+    return mImage;
+}
+
+/**
+ * @brief Enables reading the frames from an all-intra copy of the working range of the video
+ *
+ * The copy is created in the background (see MezzanineVideo); until it is ready and for
+ * frames outside of it, the video itself is decoded. Opening another video discards it.
+ *
+ * @param enabled true, to create and use the copy
+ * @param firstFrame first frame of the working range
+ * @param lastFrame last frame of the working range
+ * @param crop part of the frames stored in the copy; empty for the whole frame
+ */
+void Animation::setMezzanine(bool enabled, int firstFrame, int lastFrame, const cv::Rect &crop)
+{
+    mUseMezzanine        = enabled;
+    mMezzanineFirstFrame = std::max(firstFrame, getSourceInFrameNum());
+    mMezzanineLastFrame  = std::min(lastFrame, getSourceOutFrameNum());
+    mMezzanineCrop       = crop;
+    initMezzanine();
+}
+
+bool Animation::isMezzanine() const
+{
+    return mUseMezzanine;
+}
+
+/**
+ * @brief Sets the border video frames are decoded with; 0 decodes them without border
+ *
+ * The frames themselves are still returned without border, but the BorderFilter can
+ * add a border of the same size and color without copying (see VirtualBorder). Grayscale
+ * frames are converted after decoding and thus always get the border by copying.
+ */
+void Animation::setVirtualBorder(int size, const cv::Scalar &color)
+{
+    mVirtualBorder.setBorder(size, color);
+}
+
+const VirtualBorder &Animation::getVirtualBorder() const
+{
+    return mVirtualBorder;
+}
+
+void Animation::initProxy()
+{
+    mProxy.stop();
+    mProxyFrame = false;
+    if(!mProxyPlayback || !mVideo || mStereo || mCameraLiveStream || !mVideoCapture.isOpened())
+    {
+        return;
+    }
+    mProxy.start(mFileInfo.absoluteFilePath(), mMaxFrames, PROXY_SCALE);
+}
+
+void Animation::initMezzanine()
+{
+    if(!mUseMezzanine || !mVideo || mStereo || mCameraLiveStream || !mVideoCapture.isOpened() ||
+       mMezzanineLastFrame < mMezzanineFirstFrame)
+    {
+        mMezzanine.stop();
+        return;
+    }
+    mMezzanine.start(
+        mFileInfo.absoluteFilePath(),
+        mMezzanineFirstFrame,
+        mMezzanineLastFrame,
+        mMezzanineCrop & cv::Rect(0, 0, mSize.width(), mSize.height()),
+        mHwAcceleration);
+}
+
+/**
+ * @brief Decodes the frames before lastFrame into the frame cache
+ *
+ * Seeks once before the block and decodes forward up to lastFrame. Afterwards
+ * mVideoCapture is positioned at lastFrame + 1. The block is limited by
+ * VIDEO_BLOCK_SIZE and the number of frames fitting into the frame cache.
+ *
+ * @param lastFrame last frame of the block (inclusive)
+ * @return true, if all frames of the block could be decoded
+ */
+bool Animation::decodeVideoBlock(int lastFrame)
+{
+    if(!mFrameCache.isEnabled() || mImage.empty())
+    {
+        return false;
+    }
+    const int capacity   = static_cast<int>(std::min<std::size_t>(mFrameCache.capacityFor(mImage), VIDEO_BLOCK_SIZE));
+    const int firstFrame = std::max(getSourceInFrameNum(), lastFrame - capacity + 1);
+    if(capacity < 2 || !seekVideo(firstFrame, false))
+    {
+        return false;
+    }
+
+    for(int frame = firstFrame; frame <= lastFrame; ++frame)
+    {
+        if(mFrameCache.contains(frame))
+        {
+            // has to be decoded anyway to get to the following frames
+            if(!mVideoCapture.grab())
+            {
+                mCaptureOutOfSync = true;
+                return false;
+            }
+            continue;
+        }
+        cv::Mat img;
+        if(!mVideoCapture.read(img) || img.empty())
+        {
+            mCaptureOutOfSync = true;
+            return false;
+        }
+        if(mGrayscale)
+        {
+            videoDecoder::toGrayscale(img);
+        }
+        mFrameCache.insert(frame, img);
+    }
+    mCaptureOutOfSync = false;
+    return true;
+}
+
+/**
+ * @brief Starts building (or loading) the keyframe index of the video in the background
+ */
+void Animation::startVideoIndex(const QString &fileName)
+{
+    abortVideoIndex();
+    mAbortVideoIndex  = false;
+    mVideoIndexFuture =
+        QtConcurrent::run([this, fileName]() { return VideoIndex::create(fileName, mAbortVideoIndex); });
+}
+
+void Animation::abortVideoIndex()
+{
+    mAbortVideoIndex = true;
+    mVideoIndexFuture.waitForFinished();
+    mVideoIndexFuture = QFuture<VideoIndex>();
+    mVideoIndex       = VideoIndex();
+}
+
+/**
+ * @brief Returns the keyframe index of the video
+ *
+ * @return the index or nullptr, if it is not (yet) available
+ */
+const VideoIndex *Animation::getVideoIndex()
+{
+    if(mVideoIndexFuture.isFinished() && mVideoIndexFuture.resultCount() > 0)
+    {
+        mVideoIndex       = mVideoIndexFuture.result();
+        mVideoIndexFuture = QFuture<VideoIndex>();
+        if(!mVideoIndex.isEmpty())
+        {
+            SPDLOG_INFO(
+                "Keyframe index with {} keyframes available for {}.",
+                mVideoIndex.getKeyFrames().size(),
+                mFileInfo.fileName());
+        }
+        // the time file is more precise than the timestamps of the container
+        if(!mFrameTimes.hasTimes() && FrameTimes::isVariable(mVideoIndex.getTimestamps()))
+        {
+            SPDLOG_INFO("{} has a variable frame rate, the timestamps of its frames are used.", mFileInfo.fileName());
+            mFrameTimes.setTimes(mVideoIndex.getTimestamps());
+        }
+    }
+    return mVideoIndex.isEmpty() ? nullptr : &mVideoIndex;
+}
+
+/**
+ * @brief Positions mVideoCapture, so that the next read returns the given frame
+ *
+ * If the keyframe index is available, the capture is set to the keyframe before
+ * index and decodes forward from there. If the capture is already between this
+ * keyframe and index, no seek is done at all.
+ *
+ * @param index frame to read next
+ * @param positionKnown true, if mVideoCapture is positioned at mCurrentFrame + 1
+ * @return true on success
+ */
+bool Animation::seekVideo(int index, bool positionKnown)
+{
+    const VideoIndex *videoIndex = getVideoIndex();
+    if(videoIndex == nullptr || index >= videoIndex->getNumFrames())
+    {
+        return mVideoCapture.set(cv::CAP_PROP_POS_FRAMES, index);
+    }
+
+    const int keyFrame = videoIndex->keyFrameBefore(index);
+    int       position = mCurrentFrame + 1;
+    if(!positionKnown || position < keyFrame || position > index)
+    {
+        if(!mVideoCapture.set(cv::CAP_PROP_POS_FRAMES, keyFrame))
+        {
+            return false;
+        }
+        position = keyFrame;
+    }
+    for(; position < index; ++position)
+    {
+        if(!mVideoCapture.grab())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Sets the requested hardware acceleration for decoding videos
+ *
+ * Takes effect when the next video is opened. If the acceleration is not
+ * available, videos are decoded on the CPU.
+ */
+void Animation::setHwAcceleration(cv::VideoAccelerationType acceleration)
+{
+    mHwAcceleration = acceleration;
+}
+
+cv::VideoAccelerationType Animation::getHwAcceleration() const
+{
+    return mHwAcceleration;
+}
+
+/**
+ * @brief Sets whether frames are delivered as single channel gray images
+ *
+ * Used for marker types which do not need color, so the whole filter chain
+ * and the tracking work on a third of the data. Image sequences are decoded
+ * as gray images directly, video frames are converted right after decoding
+ * (in the prefetch thread, if enabled). Stereo videos are not converted.
+ *
+ * Already decoded frames are discarded, so the next request decodes again.
+ */
+void Animation::setGrayscale(bool grayscale)
+{
+    if(grayscale == mGrayscale)
+    {
+        return;
+    }
+    mGrayscale = grayscale && !mStereo;
+    mImageLoader.setGrayscale(mGrayscale);
+    mFrameCache.clear();
+    mImage = cv::Mat();
+    initPrefetcher();
+    if(mLiveCapture.isRunning())
+    {
+        mLiveCapture.start(mVideoCapture, mGrayscale);
+    }
+}
+
+bool Animation::isGrayscale() const
+{
+    return mGrayscale;
+}
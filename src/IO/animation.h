@@ -19,7 +19,18 @@
 #ifndef ANIMATION_H
 #define ANIMATION_H
 
+#include "frameCache.h"
+#include "frameTimes.h"
+#include "imageSequenceLoader.h"
+#include "liveCapture.h"
+#include "mezzanineVideo.h"
+#include "proxyVideo.h"
+#include "videoIndex.h"
+#include "videoSegments.h"
+#include "virtualBorder.h"
+
 #include <QFileInfo>
+#include <QFuture>
 #include <QImage>
 #include <QPair>
 #include <QPixmap>
@@ -27,7 +38,10 @@
 #include <QStringList>
 #include <QTime>
 #include <QWidget>
+#include <atomic>
+#include <memory>
 #include <opencv2/opencv.hpp>
+#include <optional>
 
 #ifdef STEREO
 #include "pgrAviFile.h"
@@ -36,8 +50,12 @@
 #endif
 
 inline constexpr int DEFAULT_FPS = 25;
+// default memory limit (MB) of the cache for decoded video frames; the cache has to be enabled per project
+inline constexpr int DEFAULT_FRAME_CACHE_SIZE = 0;
 
 class Petrack;
+class FramePrefetcher;
+class ImageSequenceIndex;
 
 /**
  * @brief The Animation class manages the sequence
@@ -76,6 +94,12 @@ public:
     // Return String with current time
     QString getTimeString(int frame = -1);
 
+    // Returns the time of frame in seconds since the first frame
+    double getFrameTime(int frame);
+
+    // Returns the keyframes of the video; std::nullopt while the keyframe index is built
+    std::optional<std::vector<int>> getKeyFrames();
+
     // reads the .time file of bumblebee xb3 experiments
     // returns, if timefile could be read
     bool openTimeFile(QString &timeFileName);
@@ -126,14 +150,60 @@ public:
     bool isStereoVideo() const;
     bool isImageSequence() const;
     bool isCameraLiveStream() const;
+    bool isVideoSegments() const;
+
+    // Files of a sequence opened from a video list (*.vlist)
+    VideoSegments &getVideoSegments();
 
     enum Camera getCamera();
     void        setCamera(enum Camera);
     int         getFirstFrameSec() const;
     int         getFirstFrameMicroSec() const;
 
-    QString   getFileBase();
-    QFileInfo getFileInfo();
+    QString     getFileBase();
+    QFileInfo   getFileInfo();
+    QStringList getImageFiles() const;
+
+    // Number of frames decoded ahead in background threads; 0 disables prefetching
+    void setPrefetchDepth(int depth);
+    int  getPrefetchDepth() const;
+
+    // Requested hardware acceleration for decoding videos, used on next open
+    void                      setHwAcceleration(cv::VideoAccelerationType acceleration);
+    cv::VideoAccelerationType getHwAcceleration() const;
+
+    // Deliver frames as single channel gray images
+    void setGrayscale(bool grayscale);
+    bool isGrayscale() const;
+
+    // Memory limit (MB) of the cache for decoded video frames; 0 disables the cache
+    void        setFrameCacheSize(int megaBytes);
+    int         getFrameCacheSize() const;
+    std::size_t getFrameCacheBytes() const;
+
+    // Decoded frames waiting to be processed (prefetched or captured by the camera thread)
+    int getQueuedFrames();
+
+    // Handling of full queue of the capture thread of camera live streams
+    void                           setLiveDropPolicy(LiveCapture::DropPolicy policy);
+    LiveCapture::DropPolicy        getLiveDropPolicy() const;
+    int                            getDroppedLiveFrames() const;
+    LiveCapture::Clock::time_point getLiveFrameTime() const;
+
+    // Low resolution proxy of the video for interactive playback
+    void    setProxyPlayback(bool enabled);
+    bool    isProxyPlayback() const;
+    void    setUseProxy(bool useProxy);
+    bool    isProxyFrame() const;
+    cv::Mat reloadFullResolution();
+
+    // All-intra copy of the working range of the video for fast random access
+    void setMezzanine(bool enabled, int firstFrame, int lastFrame, const cv::Rect &crop);
+    bool isMezzanine() const;
+
+    // Border painted around decoded video frames, so the BorderFilter does not need to copy them
+    void                 setVirtualBorder(int size, const cv::Scalar &color);
+    const VirtualBorder &getVirtualBorder() const;
 
     // used to get access of both frames only with calibStereoFilter
 #ifdef STEREO
@@ -170,6 +240,9 @@ private:
     int mFirstSec;
     int mFirstMicroSec;
 
+    // time of every frame, from the time file or the timestamps of a video with variable frame rate
+    FrameTimes mFrameTimes;
+
     // Index of the current opened frame
     int mCurrentFrame;
 
@@ -199,7 +272,7 @@ private:
 
     // Gets Size and Frame number information of the recently open animation
     // It is thought to be called once just at the opening of an animation
-    bool getInfoPhoto();
+    bool getInfoPhoto(const ImageSequenceIndex &index);
 
     // Free's the photo series data
     void freePhoto();
@@ -213,6 +286,9 @@ private:
     // A list with all the filenames of the series
     QStringList mImgFilesList;
 
+    // reads the files of mImgFilesList (ahead)
+    ImageSequenceLoader mImageLoader;
+
     /******************************************/
     /***  Video implementation              ***/
     /******************************************/
@@ -243,21 +319,110 @@ private:
     // Free's the video data
     void freeVideo();
 
+    // Opens the video files listed in listFile as one sequence
+    bool openAnimationSegments(const QString &listFile);
+
+    // Implementation of getFrameVideo for video lists
+    cv::Mat getFrameSegments(int index);
+
+    // consecutive video files of a video list; not open for other sequences
+    VideoSegments mSegments;
+
 
     // Capture structure from OpenCV 3/4
     cv::VideoCapture mVideoCapture;
 
+    cv::VideoAccelerationType mHwAcceleration = cv::VIDEO_ACCELERATION_NONE;
+    bool                      mGrayscale      = false;
+
+    // (Re-)creates the prefetcher for the currently opened video according to mPrefetchDepth
+    void initPrefetcher();
+
+    // decodes frames ahead for forward and backward playback; nullptr if prefetching is disabled
+    std::unique_ptr<FramePrefetcher> mPrefetcher;
+    int                              mPrefetchDepth = 0;
+    // mVideoCapture is not positioned after mCurrentFrame, since the frame came from mPrefetcher or mFrameCache
+    bool mCaptureOutOfSync = false;
+
+    // Decodes the block of frames ending at lastFrame into mFrameCache (for backward playback)
+    bool decodeVideoBlock(int lastFrame);
+
+    // maximal number of frames decoded at once when stepping backwards
+    static constexpr std::size_t VIDEO_BLOCK_SIZE = 50;
+
+    // Seeks mVideoCapture to index using the keyframe index if available
+    bool seekVideo(int index, bool positionKnown);
+
+    void              startVideoIndex(const QString &fileName);
+    void              abortVideoIndex();
+    const VideoIndex *getVideoIndex();
+
+    // keyframe index of the video, built in the background on opening
+    VideoIndex          mVideoIndex;
+    QFuture<VideoIndex> mVideoIndexFuture;
+    std::atomic_bool    mAbortVideoIndex{false};
+
+    // recently decoded frames of the video
+    FrameCache mFrameCache{static_cast<std::size_t>(DEFAULT_FRAME_CACHE_SIZE) * 1024 * 1024};
+
+    // reads the frames of camera live streams
+    LiveCapture                    mLiveCapture;
+    LiveCapture::Clock::time_point mLiveFrameTime; ///< time the current live frame was captured
+
+    void initProxy();
+
+    // width and height of the proxy are 1/PROXY_SCALE of the video
+    static constexpr int PROXY_SCALE = 4;
+
+    ProxyVideo mProxy;
+    bool       mProxyPlayback = false; ///< proxy is created and may be used
+    bool       mUseProxy      = false; ///< next frames may be read from the proxy
+    bool       mProxyFrame    = false; ///< mImage was read from the proxy
+
+    void initMezzanine();
+
+    MezzanineVideo mMezzanine;
+    bool           mUseMezzanine        = false;
+    int            mMezzanineFirstFrame = 0;
+    int            mMezzanineLastFrame  = -1;
+    cv::Rect       mMezzanineCrop; ///< part of the frames stored in the mezzanine; empty for the whole frame
+
+    // buffers with border the frames of the video are decoded into
+    VirtualBorder mVirtualBorder;
+
 
     // Capture structure from pgrAviFile for Stereo Videos
 #ifdef STEREO
     PgrAviFile *mCaptureStereo;
+    using StereoFile = PgrAviFile;
 #else
     StereoAviFile *mCaptureStereo;
+    using StereoFile = StereoAviFile;
 #endif
     // stereo image allocated in animation to use space for a sequence of stereo files
     cv::Mat mStereoImgLeft;
     cv::Mat mStereoImgRight;
 
+    // number of stereo frames in one file of a stereo sequence
+    static constexpr int STEREO_FILE_FRAMES = 640;
+    // distance (in frames) to a file boundary at which the neighboring file is opened
+    static constexpr int STEREO_PREFETCH_MARGIN = 32;
+
+    static StereoFile *
+    openStereoFile(const QString &fileName, cv::Mat &stereoImgLeft, cv::Mat &stereoImgRight, int primeFrame);
+    bool switchStereoFile(int fileNumber);
+    void prefetchStereoFile(int index);
+    void collectNeighborStereoFile();
+    void releaseNeighborStereoFile();
+
+    // previous or next file of the stereo sequence, opened in the background near a file boundary;
+    // it has its own image buffers, so both files can be used alternately without decoding again
+    StereoFile           *mNeighborCaptureStereo    = nullptr;
+    int                   mNeighborStereoFileNumber = -1;
+    QFuture<StereoFile *> mNeighborStereoFuture;
+    cv::Mat               mNeighborStereoImgLeft;
+    cv::Mat               mNeighborStereoImgRight;
+
     // A list with all the filenames of the stereo video series
     QStringList mStereoVideoFilesList;
 };
@@ -18,9 +18,15 @@
 
 #include "autosave.h"
 
+#include "compressedFile.h"
+#include "logger.h"
 #include "petrack.h"
+#include "trcJournal.h"
+#include "trcReader.h"
 
+#include <QSaveFile>
 #include <QTimer>
+#include <QtConcurrent>
 
 Autosave::Autosave(Petrack &petrack) : mPetrack(petrack)
 {
@@ -29,6 +35,12 @@ Autosave::Autosave(Petrack &petrack) : mPetrack(petrack)
     startTimer();
 }
 
+Autosave::~Autosave()
+{
+    mPetSave.waitForFinished();
+    waitForSaveTrc();
+}
+
 // Autosave::~Autosave() = default;
 //{
 //  NOTE: Currently this would also delete on Keyboard Interrupt (Ctrl + C)
@@ -76,6 +88,9 @@ bool Autosave::autosaveExists(const QString &filename)
  */
 void Autosave::deleteAutosave()
 {
+    mPetSave.waitForFinished();
+    waitForSaveTrc();
+    resetJournal();
     const auto autosaves = getAutosave();
     if(!autosaves.empty())
     {
@@ -92,11 +107,17 @@ void Autosave::deleteAutosave()
  */
 void Autosave::loadAutosave()
 {
+    mPetSave.waitForFinished();
+    waitForSaveTrc();
+    resetJournal();
     const auto autosaveFiles = getAutosave();
     if(autosaveFiles.empty())
     {
         return;
     }
+    const auto projectPath = QFileInfo(mPetrack.getProFileName()).absoluteFilePath();
+    const auto trcNames    = autosaveNamesTrc(projectPath);
+    const auto journalName = autosaveNameJournal(projectPath);
 
     const auto petIndex = autosaveFiles.indexOf(QRegularExpression(R"(.*\.pet)"));
     if(petIndex != -1)
@@ -109,11 +130,15 @@ void Autosave::loadAutosave()
         mPetrack.openProject(mPetrack.getProFileName());
     }
 
-    const auto trcIndex = autosaveFiles.indexOf(QRegularExpression(R"(.*\.trc)"));
+    const auto trcIndex = autosaveFiles.indexOf(QRegularExpression(R"(.*\.trc(\.zst)?)"));
     if(trcIndex != -1)
     {
         const QString trcAutosaveName = autosaveFiles[trcIndex];
         const auto    trcFile         = mPetrack.getTrackFileName();
+        if(autosaveFiles.contains(journalName))
+        {
+            compactJournal(trcNames.final, journalName);
+        }
         mPetrack.deleteTrackPointAll(PersonStorage::TrajectorySegment::Whole);
         mPetrack.importTracker(trcAutosaveName);
         mPetrack.setTrackFileName(trcFile);
@@ -146,10 +171,12 @@ bool Autosave::isAutosave(const QString &file)
         return names;
     }();
 
+    const auto journalName = QFileInfo(autosaveNameJournal(projectName)).absoluteFilePath();
+
     QFileInfo      fileInfo{file};
     const QString &filePath = fileInfo.absoluteFilePath();
     return filePath == petAutosaveName || filePath == trcAutosaveName || filePath == petRunningAutosave ||
-           filePath == trcRunningAutosave;
+           filePath == trcRunningAutosave || filePath == journalName;
 }
 
 /**
@@ -186,9 +213,11 @@ QString Autosave::buildAutosaveName(const QString &projectFileName, const QStrin
     return projectFile.dir().filePath("." + projectFile.baseName() + "_autosave" + ending);
 }
 
+/// the trc-file is compressed, if PeTrack is built with zstd
 AutosaveFilenames Autosave::autosaveNamesTrc(const QString &projectFileName)
 {
-    return {buildAutosaveName(projectFileName, "_running.trc"), buildAutosaveName(projectFileName, ".trc")};
+    const QString ending = compression::isSupported() ? ".trc" + compression::SUFFIX : ".trc";
+    return {buildAutosaveName(projectFileName, "_running" + ending), buildAutosaveName(projectFileName, ending)};
 }
 
 AutosaveFilenames Autosave::autosaveNamesPet(const QString &projectFileName)
@@ -196,12 +225,20 @@ AutosaveFilenames Autosave::autosaveNamesPet(const QString &projectFileName)
     return {buildAutosaveName(projectFileName, "_running.pet"), buildAutosaveName(projectFileName, ".pet")};
 }
 
+QString Autosave::autosaveNameJournal(const QString &projectFileName)
+{
+    return buildAutosaveName(projectFileName, "_trc.journal");
+}
+
 /**
  * @brief Saves the .pet-file
  *
  * This method is called by the timeout signal of mTimer.
  * It saves the pet-file to a hidden file with a name derived from
- * the name of the currently loaded project
+ * the name of the currently loaded project.
+ *
+ * Only the snapshot of the project is taken in the GUI thread (it has to query the
+ * widgets), it is serialized and written to disk in the background.
  */
 void Autosave::savePet()
 {
@@ -212,24 +249,33 @@ void Autosave::savePet()
     {
         return;
     }
-    const auto &[autosaveName, finalAutosaveName] = autosaveNamesPet(projectName);
-    mPetrack.saveProject(autosaveName);
+    // a slow disk must not queue up saves; the next timeout saves the newer state anyway
+    if(mPetSave.isRunning())
+    {
+        return;
+    }
+    mPetSave = QtConcurrent::run(&Autosave::writePet, mPetrack.projectDocument(), autosaveNamesPet(projectName).final);
+}
 
-    // first save to temp file, so crash during saving doesn't corrupt old autosave
-    QFile tempAutosave{autosaveName};
-    QFile autosave{finalAutosaveName};
-    if(tempAutosave.exists())
+/**
+ * @brief Writes project to the .pet-file petName
+ *
+ * Runs in a worker thread, hence it does not access Petrack.
+ *
+ * @return false, if the file could not be written
+ */
+bool Autosave::writePet(const QDomDocument &project, const QString &petName)
+{
+    const QByteArray content = Petrack::projectXml(project);
+    // the old autosave is only replaced (atomically) once the new one is complete
+    QSaveFile autosave{petName};
+    if(!autosave.open(QIODevice::WriteOnly | QIODevice::Text) || autosave.write(content) != content.size() ||
+       !autosave.commit())
     {
-        if(autosave.exists())
-        {
-            autosave.remove();
-        }
-        if(tempAutosave.copy(finalAutosaveName))
-        {
-            // we don't currently use it for loading, so we could remove it even if the copying fails...
-            tempAutosave.remove();
-        }
+        SPDLOG_WARN("Could not write autosave {}: {}", petName, autosave.errorString());
+        return false;
     }
+    return true;
 }
 
 /**
@@ -237,33 +283,223 @@ void Autosave::savePet()
  *
  * This method is called by trackPersonModified after a set number of modifications.
  * It saves the trc-file to a hidden file with a name derived from
- * the name of the currently loaded project
+ * the name of the currently loaded project.
+ *
+ * Usually only the persons changed since the last save are appended to a journal next to
+ * the trc-file. Changed persons are those for which PersonStorage emitted changedPerson and
+ * all, which are no unmodified copy of the saved person at the same index anymore (the
+ * signals are not emitted for every change, e.g. not by undo). Deleted persons
+ * are taken from deletedPerson, which keeps the indices of the saved persons in sync. From
+ * time to time, the journal is compacted into a new full trc-file.
+ *
+ * The files are written in the background from a copy of the trajectories. The copy is
+ * cheap, since it shares the TrackPoints with the trajectories until they are modified.
  */
 void Autosave::saveTrc()
 {
-    const auto projectName                        = mPetrack.getProFileName();
-    const auto &[autosaveName, finalAutosaveName] = autosaveNamesTrc(projectName);
-    const auto trackFileName                      = mPetrack.getTrackFileName();
-    const auto lastTrackerExport                  = mPetrack.getLastTrackerExport();
-    mPetrack.exportTracker(autosaveName);
-    mPetrack.setTrackFileName(trackFileName);
-    mPetrack.setLastTrackerExport(lastTrackerExport);
-
-    // first save to temp file, so crash during saving doesn't corrupt old autosave
-    QFile tempAutosave{autosaveName};
-    QFile autosave{finalAutosaveName};
-    if(tempAutosave.exists())
+    waitForSaveTrc();
+    if(mTrcSave.resultCount() > 0 && !mTrcSave.result())
     {
-        if(autosave.exists())
-        {
-            autosave.remove();
-        }
-        if(tempAutosave.copy(finalAutosaveName))
+        // the files may not contain mSavedPersons
+        resetJournal();
+    }
+
+    const auto &projectName = mPetrack.getProFileName();
+    const auto  names       = autosaveNamesTrc(projectName);
+    const auto  journalName = autosaveNameJournal(projectName);
+    const auto &persons     = mPetrack.getPersonStorage().getPersons();
+    // as in Petrack::exportTracker; import waits for the save before changing it
+    Petrack::trcVersion = 4;
+
+    if(needsCompaction(names.final, journalName))
+    {
+        mTrcSave = QtConcurrent::run(&Autosave::writeTrc, persons, names.final, journalName);
+        resetJournal();
+        mSavedPersons = persons;
+        mSavedTrcName = names.final;
+        return;
+    }
+
+    IO::TrcJournalEntry entry;
+    entry.numPersons = persons.size();
+    entry.deleted    = std::move(mDeletedSinceSave);
+    for(size_t i = 0; i < persons.size(); ++i)
+    {
+        if(i >= mSavedPersons.size() || (i < mChangedSinceSave.size() && mChangedSinceSave[i]) ||
+           !persons[i].hasSameTrcData(mSavedPersons[i]))
         {
-            // we don't currently use it for loading, so we could remove it even if the copying fails...
-            tempAutosave.remove();
+            entry.changed.emplace_back(i, persons[i]);
         }
     }
+    mDeletedSinceSave.clear();
+    mChangedSinceSave.clear();
+    if(entry.deleted.empty() && entry.changed.empty() && persons.size() == mSavedPersons.size())
+    {
+        return;
+    }
+
+    mTrcSave      = QtConcurrent::run(&Autosave::appendJournal, std::move(entry), journalName);
+    mSavedPersons = persons;
+    ++mJournalEntries;
+}
+
+/**
+ * @brief Returns whether the next save of the trajectories has to write a full .trc-file
+ *
+ * This is the case if there is no trc-file of the saved trajectories yet, after
+ * MAX_JOURNAL_ENTRIES journal entries or if the journal got larger than the trc-file.
+ */
+bool Autosave::needsCompaction(const QString &trcName, const QString &journalName) const
+{
+    if(mSavedTrcName != trcName || mJournalEntries >= MAX_JOURNAL_ENTRIES)
+    {
+        return true;
+    }
+    const QFileInfo trc{trcName};
+    const QFileInfo journal{journalName};
+    return !trc.exists() || (journal.exists() && journal.size() > trc.size());
+}
+
+/**
+ * @brief Forgets the saved trajectories, so that the next save writes a full .trc-file
+ */
+void Autosave::resetJournal()
+{
+    mSavedPersons.clear();
+    mSavedTrcName.clear();
+    mJournalEntries = 0;
+    mDeletedSinceSave.clear();
+    mChangedSinceSave.clear();
+}
+
+/**
+ * @brief Keeps the saved trajectories in sync with the deletion of a person
+ *
+ * Connected to PersonStorage::deletedPerson.
+ */
+void Autosave::personDeleted(size_t index)
+{
+    if(index < mChangedSinceSave.size())
+    {
+        mChangedSinceSave.erase(mChangedSinceSave.begin() + index);
+    }
+    // persons behind the saved ones are not in the journal yet
+    if(index < mSavedPersons.size())
+    {
+        mSavedPersons.erase(mSavedPersons.begin() + index);
+        mDeletedSinceSave.push_back(index);
+    }
+}
+
+/**
+ * @brief Marks a person to be written with the next save
+ *
+ * Connected to PersonStorage::changedPerson.
+ */
+void Autosave::personChanged(size_t index)
+{
+    if(index >= mChangedSinceSave.size())
+    {
+        mChangedSinceSave.resize(index + 1, false);
+    }
+    mChangedSinceSave[index] = true;
+}
+
+/**
+ * @brief Blocks until a running autosave of the .trc-file is finished
+ */
+void Autosave::waitForSaveTrc()
+{
+    mTrcSave.waitForFinished();
+}
+
+/**
+ * @brief Writes persons to the .trc-file trcName
+ *
+ * The journal belongs to the replaced trc-file and is removed. Runs in a worker thread,
+ * hence it does not access Petrack.
+ *
+ * @return false, if the trc-file could not be written
+ */
+bool Autosave::writeTrc(const std::vector<TrackPerson> &persons, const QString &trcName, const QString &journalName)
+{
+    // the old autosave is only replaced (atomically) once the new one is complete
+    QSaveFile           autosave{trcName};
+    compression::Writer output{autosave, compression::isCompressed(trcName)};
+    if(!autosave.open(QIODevice::WriteOnly))
+    {
+        SPDLOG_WARN("Could not write autosave {}: {}", trcName, autosave.errorString());
+        return false;
+    }
+    if(!output.open(QIODevice::WriteOnly) || !::writeTrc(output, persons) || !output.finish())
+    {
+        SPDLOG_WARN("Could not write autosave {}: {}", trcName, output.errorString());
+        return false;
+    }
+    output.close();
+
+    // a crash from here on leaves the old trc-file without its journal, i.e. the state of an older save
+    QFile::remove(journalName);
+    if(!autosave.commit())
+    {
+        SPDLOG_WARN("Could not write autosave {}: {}", trcName, autosave.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Appends the changes since the last save to the journal
+ *
+ * Runs in a worker thread, hence it does not access Petrack.
+ *
+ * @return false, if the entry could not be written completely
+ */
+bool Autosave::appendJournal(const IO::TrcJournalEntry &entry, const QString &journalName)
+{
+    QFile journal{journalName};
+    if(!journal.open(QIODevice::WriteOnly | QIODevice::Append) || !IO::appendTrcJournal(journal, entry) ||
+       !journal.flush())
+    {
+        SPDLOG_WARN("Could not write autosave {}: {}", journalName, journal.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Applies the journal to the trc autosave and writes the result as new trc autosave
+ *
+ * If the journal cannot be applied, the trc autosave is kept as it is.
+ */
+void Autosave::compactJournal(const QString &trcName, const QString &journalName)
+{
+    auto trc = IO::readTrc(trcName);
+    if(std::holds_alternative<std::string>(trc))
+    {
+        SPDLOG_WARN("Could not read autosave {}: {}", trcName, std::get<std::string>(trc));
+        return;
+    }
+    auto &persons = std::get<IO::TrcData>(trc).persons;
+
+    QFile journal{journalName};
+    if(!journal.open(QIODevice::ReadOnly))
+    {
+        SPDLOG_WARN("Could not read autosave {}: {}", journalName, journal.errorString());
+        return;
+    }
+    const QByteArray content = journal.readAll();
+    journal.close();
+    const auto applied =
+        IO::applyTrcJournal(std::string_view(content.constData(), static_cast<size_t>(content.size())), persons);
+    if(std::holds_alternative<std::string>(applied))
+    {
+        SPDLOG_WARN("Could not read autosave {}: {}", journalName, std::get<std::string>(applied));
+        return;
+    }
+
+    Petrack::trcVersion = 4;
+    writeTrc(persons, trcName, journalName);
 }
 
 /**
@@ -298,6 +534,12 @@ QStringList Autosave::getAutosave(const QFileInfo &projectPath)
         {
             list.append(autosaveTrcName);
         }
+        const auto      journalName = autosaveNameJournal(projectPath.absoluteFilePath());
+        const QFileInfo journal{journalName};
+        if(journal.exists())
+        {
+            list.append(journalName);
+        }
         return list;
     }
 
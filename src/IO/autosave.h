@@ -19,13 +19,21 @@
 #ifndef AUTOSAVE_H
 #define AUTOSAVE_H
 
+#include <QFuture>
 #include <QObject>
 #include <QStringList>
 #include <memory>
+#include <vector>
 
 class Petrack;
+class TrackPerson;
+class QDomDocument;
 class QTimer;
 class QFileInfo;
+namespace IO
+{
+struct TrcJournalEntry;
+}
 
 struct AutosaveFilenames
 {
@@ -43,7 +51,7 @@ public:
     Autosave(const Autosave &&other)           = delete;
     Autosave &operator=(const Autosave &other) = delete;
     Autosave &operator=(Autosave &&other)      = delete;
-    ~Autosave() override                       = default;
+    ~Autosave() override;
 
     void        trackPersonModified();
     void        resetTrackPersonCounter();
@@ -51,22 +59,35 @@ public:
     void        deleteAutosave();
     void        loadAutosave();
     bool        isAutosave(const QString &file);
+    void        waitForSaveTrc();
 
     int  getPetSaveInterval() const;
     void setPetSaveInterval(int petSaveInterval);
     int  getChangesTillAutosave() const;
     void setChangesTillAutosave(int changesTillAutosave);
 
+public slots:
+    void personDeleted(size_t index);
+    void personChanged(size_t index);
+
 private:
     static QString           buildAutosaveName(const QString &projectFileName, const QString &ending);
     static AutosaveFilenames autosaveNamesTrc(const QString &projectFileName);
     static AutosaveFilenames autosaveNamesPet(const QString &projectFileName);
+    static QString           autosaveNameJournal(const QString &projectFileName);
     void                     saveTrc();
-    QStringList              getAutosave();
-    static QStringList       getAutosave(const QFileInfo &projectPath);
-    void                     startTimer();
-    void                     stopTimer();
-    void                     restartTimer();
+    bool                     needsCompaction(const QString &trcName, const QString &journalName) const;
+    void                     resetJournal();
+    static bool              writePet(const QDomDocument &project, const QString &petName);
+    static bool
+    writeTrc(const std::vector<TrackPerson> &persons, const QString &trcName, const QString &journalName);
+    static bool        appendJournal(const IO::TrcJournalEntry &entry, const QString &journalName);
+    static void        compactJournal(const QString &trcName, const QString &journalName);
+    QStringList        getAutosave();
+    static QStringList getAutosave(const QFileInfo &projectPath);
+    void               startTimer();
+    void               stopTimer();
+    void               restartTimer();
 
 private slots:
     void savePet();
@@ -86,6 +107,20 @@ private:
     Petrack &mPetrack;
     QTimer  *mTimer;
     int      mChangeCounter = 0;
+
+    QFuture<bool> mPetSave; ///< running autosave of the pet-file
+    QFuture<bool> mTrcSave; ///< running autosave of the trc-file; false if it failed
+
+    /// a full trc is written after this many journal entries, even if the journal is still small
+    static constexpr int MAX_JOURNAL_ENTRIES = 100;
+
+    // Between two full .trc-files, only the persons changed since the last save are
+    // appended to a journal (see IO::TrcJournalEntry).
+    std::vector<TrackPerson> mSavedPersons;     ///< trajectories as stored in the trc autosave and journal
+    QString                  mSavedTrcName;     ///< trc autosave of mSavedPersons; empty if none is written
+    int                      mJournalEntries = 0;
+    std::vector<size_t>      mDeletedSinceSave; ///< indices of deleted persons, in order of deletion
+    std::vector<bool>        mChangedSinceSave; ///< per person, if changedPerson was emitted for it
 };
 
 #endif // AUTOSAVE_H
@@ -22,6 +22,7 @@
 
 #include <cassert>
 #include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <opencv2/videoio/videoio_c.h>
 
@@ -48,7 +49,8 @@ AviFileWriter::AviFileWriter()
     m_iSplitFile   = 0;
     m_isColor      = true;
 
-    m_liBytesWritten = 0;
+    m_liBytesWritten      = 0;
+    m_liTotalBytesWritten = 0;
 }
 
 
@@ -120,9 +122,11 @@ bool AviFileWriter::open(const char *pszFilename, int iCols, int iRows, int ibpp
         return false;
     }
 
-    m_frameRate      = dFramerate;
-    m_iTimeIndex     = 0;
-    m_liBytesWritten = 0;
+    close();
+    m_frameRate           = dFramerate;
+    m_iTimeIndex          = 0;
+    m_liBytesWritten      = 0;
+    m_liTotalBytesWritten = 0;
     //
     // If these parameters change, set them and allocate the buffers
     //
@@ -162,7 +166,7 @@ bool AviFileWriter::open(const char *pszFilename, int iCols, int iRows, int ibpp
     //
     // If this function is called from openSizeLimitedAVI(), pszFilename
     // is the file to open. m_szAVIDestFile should not be changed because
-    // it is the base file name used in appendFrame() to generate the next
+    // it is the base file name used in openNextSplitFile() to generate the next
     // split file name.
     //
     // If this function is called directly (not by openSizeLimitedAVI()),
@@ -184,13 +188,26 @@ bool AviFileWriter::open(const char *pszFilename, int iCols, int iRows, int ibpp
    sprintf(szAVIFile, "%s.avi", m_szAVIDestFile);
 #endif
 
-    return m_vWriter.open(pszFilename, CV_FOURCC_DEFAULT /*PROMPT*/, dFramerate, cv::Size(iCols, iRows), m_isColor);
+    m_szCurrentFile = pszFilename;
+    if(!m_vWriter.open(pszFilename, CV_FOURCC_DEFAULT /*PROMPT*/, dFramerate, cv::Size(iCols, iRows), m_isColor))
+    {
+        return false;
+    }
+    startWriter();
+    return true;
 }
 
 
 bool AviFileWriter::open(const char *pszFilename, int iCols, int iRows, int /*ibpp*/, int iFramerate)
 {
-    return m_vWriter.open(pszFilename, CV_FOURCC_PROMPT, (double) iFramerate, cv::Size(iCols, iRows), m_isColor);
+    close();
+    m_szCurrentFile = pszFilename;
+    if(!m_vWriter.open(pszFilename, CV_FOURCC_PROMPT, (double) iFramerate, cv::Size(iCols, iRows), m_isColor))
+    {
+        return false;
+    }
+    startWriter();
+    return true;
 }
 
 long int AviFileWriter::bytesWritten() const
@@ -198,9 +215,114 @@ long int AviFileWriter::bytesWritten() const
     return m_liBytesWritten;
 }
 
+int AviFileWriter::queueDepth()
+{
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return static_cast<int>(m_queue.size());
+}
+
+int AviFileWriter::maxQueueDepth() const
+{
+    return m_maxQueueDepth;
+}
+
+double AviFileWriter::bytesPerSecond() const
+{
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_openTime;
+    return elapsed.count() > 0 ? m_liTotalBytesWritten / elapsed.count() : 0.;
+}
+
+int AviFileWriter::droppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+void AviFileWriter::startWriter()
+{
+    m_stopWriter    = false;
+    m_maxQueueDepth = 0;
+    m_droppedFrames = 0;
+    m_writeFailed   = false;
+    m_openTime      = std::chrono::steady_clock::now();
+    m_writerThread  = std::thread(&AviFileWriter::runWriter, this);
+}
+
+bool AviFileWriter::enqueue(cv::Mat frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if(m_queue.size() >= WRITE_QUEUE_SIZE)
+        {
+            ++m_droppedFrames;
+            return false;
+        }
+        m_queue.push_back(std::move(frame));
+        // only written under the lock, but read without it by maxQueueDepth()
+        m_maxQueueDepth = std::max(m_maxQueueDepth.load(), static_cast<int>(m_queue.size()));
+    }
+    m_queueChanged.notify_one();
+    return true;
+}
+
+void AviFileWriter::runWriter()
+{
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    while(true)
+    {
+        m_queueChanged.wait(lock, [this] { return !m_queue.empty() || m_stopWriter; });
+        if(m_queue.empty())
+        {
+            // stopped and everything is written
+            return;
+        }
+        cv::Mat frame = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+
+        m_vWriter.write(frame);
+
+        std::error_code error;
+        const auto      fileSize = std::filesystem::file_size(m_szCurrentFile, error);
+        if(!error)
+        {
+            m_liTotalBytesWritten += static_cast<long>(fileSize) - m_liBytesWritten;
+            m_liBytesWritten      = static_cast<long>(fileSize);
+        }
+
+        //
+        // If the AVI file is opened with openSizeLimitedAVI(), split it if necessory.
+        //
+        // if(bytesWritten() >= (__int64)(AVI_FILE_SPLIT_SIZE))
+        if(m_bSizeLimited && bytesWritten() >= (long int) (AVI_FILE_SPLIT_SIZE) && !openNextSplitFile())
+        {
+            m_writeFailed = true;
+        }
+
+        lock.lock();
+        if(m_writeFailed)
+        {
+            m_queue.clear();
+            return;
+        }
+    }
+}
+
+bool AviFileWriter::openNextSplitFile()
+{
+    std::stringstream stringStream;
+    m_vWriter.release();
+    m_iSplitFile++;
+    stringStream << m_szAVIDestFile << "_" << std::setfill('0') << std::setw(4) << m_iSplitFile << ".avi";
+    m_szCurrentFile  = stringStream.str();
+    m_liBytesWritten = 0;
+    return m_vWriter.open(
+        m_szCurrentFile, CV_FOURCC_DEFAULT /*PROMPT*/, m_frameRate, cv::Size(m_iCols, m_iRows), m_isColor);
+}
+
 bool AviFileWriter::appendFrame(const unsigned char *pBuffer, bool /*bInvert*/)
 {
-    if(!m_vWriter.isOpened())
+    // m_vWriter is owned by the writer thread while it is running
+    if(!m_writerThread.joinable())
     {
         assert(false);
         return false;
@@ -210,18 +332,24 @@ bool AviFileWriter::appendFrame(const unsigned char *pBuffer, bool /*bInvert*/)
     unsigned char *pWriteBuffer = (unsigned char *) pBuffer;
     cv::Mat        frame;
 
+    if(m_writeFailed)
+    {
+        SPDLOG_ERROR("writing video data to {} failed.", m_szCurrentFile);
+        return false;
+    }
+
     if((m_iRowInc / m_iCols) == 1)
     {
-        frame = cv::Mat(m_iRows, m_iCols, CV_8UC1, pWriteBuffer, m_iRowInc); // = imread(pszFilename);
+        frame = cv::Mat(m_iRows, m_iCols, CV_8UC1, pWriteBuffer, m_iRowInc).clone(); // = imread(pszFilename);
     }
     else if((m_iRowInc / m_iCols) == 3)
     {
-        frame = cv::Mat(m_iRows, m_iCols, CV_8UC3, pWriteBuffer, m_iRowInc); // = imread(pszFilename);
+        frame = cv::Mat(m_iRows, m_iCols, CV_8UC3, pWriteBuffer, m_iRowInc).clone(); // = imread(pszFilename);
     }
     else if((m_iRowInc / m_iCols) == 4)
     {
         frame = cv::Mat(m_iRows, m_iCols, CV_8UC4, pWriteBuffer, m_iRowInc); // = imread(pszFilename);
-        cv::cvtColor(frame, frame, cv::COLOR_RGBA2RGB);                      // need for right image interpretation
+        cv::cvtColor(frame, frame, cv::COLOR_RGBA2RGB); // need for right image interpretation, copies the buffer
     }
     else
     {
@@ -234,42 +362,17 @@ bool AviFileWriter::appendFrame(const unsigned char *pBuffer, bool /*bInvert*/)
         return false;
     }
 
-    m_vWriter.write(frame);
-
     /**
      * ToDo: invertieren
      *
      */
 
-    long lBytesWritten = 0;
-
-    //
-    // If the AVI file is opened with openSizeLimitedAVI(), split it if necessory.
-    //
-    if(m_bSizeLimited)
+    // the frame is encoded in the writer thread, splitting the file (openSizeLimitedAVI()) happens there, too
+    if(!enqueue(std::move(frame)))
     {
-        //
-        // Split the file if it is more than 'AVI_FILE_SPLIT_SIZE' bytes
-        //
-        // if(bytesWritten() >= (__int64)(AVI_FILE_SPLIT_SIZE))
-        if(bytesWritten() >= (long int) (AVI_FILE_SPLIT_SIZE))
-        {
-            std::string       szAVIFile;
-            std::stringstream stringStream;
-            close();
-            m_iSplitFile++;
-            stringStream << m_szAVIDestFile << "_" << std::setfill('0') << std::setw(4) << m_iSplitFile << ".avi";
-            szAVIFile = stringStream.str();
-
-            if(!open(szAVIFile.c_str(), m_iCols, m_iRows, m_iBPP, m_frameRate))
-            {
-                return false;
-            }
-        }
+        SPDLOG_WARN("video writer cannot keep up, frame {} dropped.", m_iTimeIndex);
     }
 
-    m_liBytesWritten += lBytesWritten;
-
     m_iTimeIndex++;
 
     return true;
@@ -277,8 +380,17 @@ bool AviFileWriter::appendFrame(const unsigned char *pBuffer, bool /*bInvert*/)
 
 bool AviFileWriter::close()
 {
+    if(m_writerThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_stopWriter = true;
+        }
+        m_queueChanged.notify_one();
+        m_writerThread.join();
+    }
     m_vWriter.release();
-    return true;
+    return !m_writeFailed;
 }
 
 
@@ -286,7 +398,10 @@ bool AviFileWriter::appendBMP(const char *pszFilename)
 {
     cv::Mat bmpFrame = cv::imread(pszFilename);
 
-    m_vWriter.write(bmpFrame);
+    if(!m_writerThread.joinable() || !enqueue(bmpFrame))
+    {
+        return false;
+    }
 
     m_iTimeIndex++;
 
@@ -21,7 +21,13 @@
 #ifndef AVIFILEWRITER_H
 #define AVIFILEWRITER_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <opencv2/opencv.hpp>
+#include <thread>
 
 // Byte Number (nicht alle Zahlen gehen?: 2*1280*960*32*20) enstehen avi mit einem bild
 // unter 2GB fuer reader und unter 4 GB fuer writer bleiben!!!
@@ -30,6 +36,10 @@ inline constexpr int AVI_FILE_SPLIT_SIZE = ((2 * 1280 * 960 * 32 * 20));
 
 /**
  * A simple wrapper for an .AVI file .
+ *
+ * Appended frames are copied into a bounded queue and encoded by a background
+ * thread, so appending never waits for the encoder. If the encoder cannot keep
+ * up and the queue is full, new frames are dropped and counted.
  */
 class AviFileWriter
 {
@@ -74,6 +84,18 @@ public:
     /** Get the the bytes written */
     long int bytesWritten() const;
 
+    /** Number of frames waiting to be encoded. */
+    int queueDepth();
+
+    /** Maximal number of frames waiting to be encoded since opening. */
+    int maxQueueDepth() const;
+
+    /** Average number of bytes written per second since opening. */
+    double bytesPerSecond() const;
+
+    /** Number of frames dropped since opening, because the queue was full. */
+    int droppedFrames() const;
+
     /**
      * Load a bitmap from a file and append it to the current open .avi.
      * Must be in the correct format.
@@ -85,7 +107,7 @@ public:
      */
     bool appendFrame(const unsigned char *pBuffer, bool bInvert = true);
 
-    /** Close the .avi file.  This is also done by the destructor. */
+    /** Encode all queued frames and close the .avi file.  This is also done by the destructor. */
     bool close();
 
 protected:
@@ -125,12 +147,18 @@ protected:
     /** Flag indicating if the size of the avi file is limited to AVI_FILE_SPLIT_SIZE bytes */
     bool m_bSizeLimited;
 
-    /** Total bytes written. */
-    long int m_liBytesWritten;
+    /** Bytes written to the current file. */
+    std::atomic_long m_liBytesWritten;
+
+    /** Bytes written to all files since opening. */
+    std::atomic_long m_liTotalBytesWritten;
 
     /** avi file name */
     std::string m_szAVIDestFile;
 
+    /** name of the file currently written */
+    std::string m_szCurrentFile;
+
     char *m_fourCC;
 
     /** Defines is color avi */
@@ -140,6 +168,32 @@ private:
     /** Read and verify the OpenCV version. */
     bool checkOpenCVVersion();
 
+    /** Start the thread encoding the queued frames. */
+    void startWriter();
+
+    /** Encode the queued frames (writer thread). */
+    void runWriter();
+
+    /** Queue frame for encoding; drops it, if the queue is full. */
+    bool enqueue(cv::Mat frame);
+
+    /** Close the current split file and open the next one (writer thread). */
+    bool openNextSplitFile();
+
+    /** Maximal number of frames waiting to be encoded. */
+    static constexpr std::size_t WRITE_QUEUE_SIZE = 64;
+
+    std::thread             m_writerThread;
+    std::mutex              m_queueMutex;
+    std::condition_variable m_queueChanged;
+    std::deque<cv::Mat>     m_queue;
+    bool                    m_stopWriter = false;
+    std::atomic_int         m_maxQueueDepth{0};
+    std::atomic_int         m_droppedFrames{0};
+    std::atomic_bool        m_writeFailed{false};
+
+    std::chrono::steady_clock::time_point m_openTime;
+
     /** Read the opened AVI-File */
     cv::VideoCapture m_vReader;
 
@@ -0,0 +1,297 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "compressedFile.h"
+
+#include "concurrency.h"
+
+#include <vector>
+
+#ifdef ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+/// trajectories compress well already with a fast level
+constexpr int COMPRESSION_LEVEL = 3;
+
+const QString NOT_SUPPORTED = "PeTrack was built without zstd support (-DZSTD=ON).";
+} // namespace
+
+namespace compression
+{
+bool isSupported()
+{
+#ifdef ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool isCompressed(const QString &fileName)
+{
+    return fileName.endsWith(SUFFIX, Qt::CaseInsensitive);
+}
+
+/// returns fileName without SUFFIX, e.g. to determine the format of the content
+QString uncompressedName(const QString &fileName)
+{
+    return isCompressed(fileName) ? fileName.chopped(SUFFIX.size()) : fileName;
+}
+
+#ifdef ZSTD
+struct Writer::Stream
+{
+    ZSTD_CCtx        *context = ZSTD_createCCtx();
+    std::vector<char> buffer  = std::vector<char>(ZSTD_CStreamOutSize());
+
+    ~Stream() { ZSTD_freeCCtx(context); }
+};
+
+struct Reader::Stream
+{
+    ZSTD_DCtx        *context = ZSTD_createDCtx();
+    std::vector<char> buffer  = std::vector<char>(ZSTD_DStreamInSize());
+    ZSTD_inBuffer     input{buffer.data(), 0, 0};
+    bool              frameComplete = true;
+
+    ~Stream() { ZSTD_freeDCtx(context); }
+};
+#else
+struct Writer::Stream
+{
+};
+
+struct Reader::Stream
+{
+};
+#endif
+
+Writer::Writer(QIODevice &target, bool compress) : mTarget(target), mCompress(compress) {}
+
+Writer::~Writer()
+{
+    close();
+}
+
+bool Writer::open(OpenMode mode)
+{
+    if(mode != WriteOnly)
+    {
+        setErrorString("The writer can only be opened with WriteOnly.");
+        return false;
+    }
+    mFailed = false;
+    if(mCompress)
+    {
+#ifdef ZSTD
+        mStream = std::make_unique<Stream>();
+        if(!mStream->context)
+        {
+            setErrorString("Could not create the zstd compression.");
+            return false;
+        }
+        ZSTD_CCtx_setParameter(mStream->context, ZSTD_c_compressionLevel, COMPRESSION_LEVEL);
+        // fails, if zstd is built without multithreading; it compresses in the calling thread then
+        ZSTD_CCtx_setParameter(mStream->context, ZSTD_c_nbWorkers, concurrency::threadCount());
+#else
+        setErrorString(NOT_SUPPORTED);
+        return false;
+#endif
+    }
+    return QIODevice::open(mode);
+}
+
+void Writer::close()
+{
+    if(isOpen())
+    {
+        finish();
+        QIODevice::close();
+    }
+}
+
+bool Writer::finish()
+{
+#ifdef ZSTD
+    if(mStream && !mFailed)
+    {
+        ZSTD_inBuffer input{nullptr, 0, 0};
+        std::size_t   remaining = 0;
+        do
+        {
+            ZSTD_outBuffer output{mStream->buffer.data(), mStream->buffer.size(), 0};
+            remaining = ZSTD_compressStream2(mStream->context, &output, &input, ZSTD_e_end);
+            if(ZSTD_isError(remaining))
+            {
+                setErrorString(ZSTD_getErrorName(remaining));
+                mFailed = true;
+            }
+            else if(
+                mTarget.write(mStream->buffer.data(), static_cast<qint64>(output.pos)) !=
+                static_cast<qint64>(output.pos))
+            {
+                setErrorString(mTarget.errorString());
+                mFailed = true;
+            }
+        } while(remaining != 0 && !mFailed);
+    }
+    mStream.reset();
+#endif
+    return !mFailed;
+}
+
+qint64 Writer::readData(char * /*data*/, qint64 /*maxSize*/)
+{
+    return -1;
+}
+
+qint64 Writer::writeData(const char *data, qint64 size)
+{
+    if(mFailed)
+    {
+        return -1;
+    }
+    if(!mCompress)
+    {
+        const qint64 written = mTarget.write(data, size);
+        if(written != size)
+        {
+            setErrorString(mTarget.errorString());
+            mFailed = true;
+        }
+        return written;
+    }
+
+#ifdef ZSTD
+    ZSTD_inBuffer input{data, static_cast<std::size_t>(size), 0};
+    while(input.pos < input.size)
+    {
+        ZSTD_outBuffer    output{mStream->buffer.data(), mStream->buffer.size(), 0};
+        const std::size_t result = ZSTD_compressStream2(mStream->context, &output, &input, ZSTD_e_continue);
+        if(ZSTD_isError(result))
+        {
+            setErrorString(ZSTD_getErrorName(result));
+            mFailed = true;
+            return -1;
+        }
+        if(output.pos > 0 &&
+           mTarget.write(mStream->buffer.data(), static_cast<qint64>(output.pos)) != static_cast<qint64>(output.pos))
+        {
+            setErrorString(mTarget.errorString());
+            mFailed = true;
+            return -1;
+        }
+    }
+    return size;
+#else
+    return -1;
+#endif
+}
+
+Reader::Reader(QIODevice &source, bool compressed) : mSource(source), mCompressed(compressed) {}
+
+Reader::~Reader()
+{
+    close();
+}
+
+bool Reader::open(OpenMode mode)
+{
+    if(mode != ReadOnly)
+    {
+        setErrorString("The reader can only be opened with ReadOnly.");
+        return false;
+    }
+    if(mCompressed)
+    {
+#ifdef ZSTD
+        mStream = std::make_unique<Stream>();
+        if(!mStream->context)
+        {
+            setErrorString("Could not create the zstd decompression.");
+            return false;
+        }
+#else
+        setErrorString(NOT_SUPPORTED);
+        return false;
+#endif
+    }
+    return QIODevice::open(mode);
+}
+
+void Reader::close()
+{
+    mStream.reset();
+    QIODevice::close();
+}
+
+qint64 Reader::readData(char *data, qint64 maxSize)
+{
+    if(!mCompressed)
+    {
+        return mSource.read(data, maxSize);
+    }
+
+#ifdef ZSTD
+    ZSTD_outBuffer output{data, static_cast<std::size_t>(maxSize), 0};
+    while(output.pos == 0 && output.size > 0)
+    {
+        auto &input = mStream->input;
+        if(input.pos == input.size)
+        {
+            const qint64 read = mSource.read(mStream->buffer.data(), static_cast<qint64>(mStream->buffer.size()));
+            if(read < 0)
+            {
+                setErrorString(mSource.errorString());
+                return -1;
+            }
+            if(read == 0)
+            {
+                if(!mStream->frameComplete)
+                {
+                    setErrorString("The compressed file is truncated.");
+                    return -1;
+                }
+                return 0;
+            }
+            input = {mStream->buffer.data(), static_cast<std::size_t>(read), 0};
+        }
+        const std::size_t result = ZSTD_decompressStream(mStream->context, &output, &input);
+        if(ZSTD_isError(result))
+        {
+            setErrorString(ZSTD_getErrorName(result));
+            return -1;
+        }
+        mStream->frameComplete = result == 0;
+    }
+    return static_cast<qint64>(output.pos);
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+#endif
+}
+
+qint64 Reader::writeData(const char * /*data*/, qint64 /*size*/)
+{
+    return -1;
+}
+} // namespace compression
@@ -0,0 +1,103 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPRESSEDFILE_H
+#define COMPRESSEDFILE_H
+
+#include <QIODevice>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief Transparent zstd compression of trajectory files, e.g. trajectories.trc.zst
+ *
+ * Files are compressed if their name ends with SUFFIX. The devices below write and read
+ * such files in streaming mode and pass the data through unchanged for other files, so
+ * that the exports and imports do not need to distinguish both cases. Compression
+ * needs PeTrack to be built with -DZSTD=ON; otherwise opening a device for a
+ * compressed file fails.
+ */
+namespace compression
+{
+inline const QString SUFFIX = ".zst";
+
+bool    isSupported();
+bool    isCompressed(const QString &fileName);
+QString uncompressedName(const QString &fileName);
+
+/**
+ * @brief Sequential device writing to target, compressed if requested
+ *
+ * The compression uses the worker threads of zstd. The compressed stream is completed by
+ * finish() or close(); target is neither opened nor closed by the writer.
+ */
+class Writer : public QIODevice
+{
+public:
+    Writer(QIODevice &target, bool compress);
+    ~Writer() override;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+
+    /// completes the compressed stream; returns false, if any write failed
+    bool finish();
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 size) override;
+
+private:
+    struct Stream;
+
+    QIODevice              &mTarget;
+    bool                    mCompress;
+    bool                    mFailed = false;
+    std::unique_ptr<Stream> mStream;
+};
+
+/**
+ * @brief Sequential device reading from source, decompressed if requested
+ *
+ * source has to be opened for reading before the reader.
+ */
+class Reader : public QIODevice
+{
+public:
+    Reader(QIODevice &source, bool compressed);
+    ~Reader() override;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 size) override;
+
+private:
+    struct Stream;
+
+    QIODevice              &mSource;
+    bool                    mCompressed;
+    std::unique_ptr<Stream> mStream;
+};
+} // namespace compression
+
+#endif // COMPRESSEDFILE_H
@@ -0,0 +1,197 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "filteredFrameStore.h"
+
+#include "logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr char   STORE_MAGIC[8] = {'P', 'E', 'T', 'F', 'R', 'A', 'M', 'E'};
+constexpr qint32 STORE_VERSION  = 1;
+constexpr qint64 PAGE_SIZE      = 4096;
+} // namespace
+
+FilteredFrameStore::~FilteredFrameStore()
+{
+    close();
+    mRetired.clear(); // unmaps all files
+}
+
+/// Offset of the first frame: header and valid flags, aligned to a page
+qint64 FilteredFrameStore::dataOffset(int numFrames)
+{
+    const qint64 headerBytes = static_cast<qint64>(sizeof(Header)) + numFrames;
+    return (headerBytes + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+/**
+ * @brief Opens (or creates) the store file for frames like sample
+ *
+ * An existing file is reused, if it was written for the same number of frames
+ * and the same size and type of images; otherwise it is emptied, unless the store
+ * is opened read-only.
+ *
+ * @param fileName name of the store file
+ * @param numFrames number of frames of the sequence
+ * @param sample filtered image with size and type of all frames
+ * @param readOnly never write to the file
+ * @return true, if the store could be opened and mapped
+ */
+bool FilteredFrameStore::open(const QString &fileName, int numFrames, const cv::Mat &sample, bool readOnly)
+{
+    close();
+    if(numFrames <= 0 || sample.empty() || !sample.isContinuous())
+    {
+        return false;
+    }
+
+    mFrameBytes = static_cast<qint64>(sample.total() * sample.elemSize());
+
+    const qint64 offset = dataOffset(numFrames);
+    const qint64 size   = offset + numFrames * mFrameBytes;
+    auto         file   = std::make_unique<QFile>(fileName);
+    Header       header{};
+    bool         isValid = false;
+
+    if(!file->open(readOnly ? QIODevice::ReadOnly : QIODevice::ReadWrite))
+    {
+        SPDLOG_WARN("Could not open filtered frame store {}: {}", fileName, file->errorString());
+        return false;
+    }
+    if(file->size() == size && file->read(reinterpret_cast<char *>(&header), sizeof(Header)) == sizeof(Header))
+    {
+        isValid = std::memcmp(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC)) == 0 &&
+                  header.version == STORE_VERSION && header.rows == sample.rows && header.cols == sample.cols &&
+                  header.type == sample.type() && header.numFrames == numFrames;
+    }
+
+    mValidAtOpen.assign(numFrames, 0);
+    if(isValid)
+    {
+        file->read(mValidAtOpen.data(), numFrames);
+    }
+    else if(readOnly)
+    {
+        SPDLOG_WARN("Filtered frame store {} does not fit the sequence.", fileName);
+        return false;
+    }
+    else
+    {
+        std::memcpy(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+        header.version   = STORE_VERSION;
+        header.rows      = sample.rows;
+        header.cols      = sample.cols;
+        header.type      = sample.type();
+        header.numFrames = numFrames;
+        header.reserved  = 0;
+        // file is sparse on most file systems, so only written frames take space
+        if(!file->resize(0) || !file->resize(size) || !file->seek(0) ||
+           file->write(reinterpret_cast<const char *>(&header), sizeof(Header)) != sizeof(Header) ||
+           file->write(mValidAtOpen.data(), numFrames) != numFrames)
+        {
+            SPDLOG_WARN("Could not create filtered frame store {}: {}", fileName, file->errorString());
+            return false;
+        }
+        file->flush();
+    }
+
+    mMap = file->map(0, size, QFileDevice::MapPrivateOption);
+    if(mMap == nullptr)
+    {
+        SPDLOG_WARN("Could not map filtered frame store {}: {}", fileName, file->errorString());
+        return false;
+    }
+
+    mHeader   = header;
+    mWritten  = mValidAtOpen;
+    mFile     = std::move(file);
+    mFileName = fileName;
+    mReadOnly = readOnly;
+    SPDLOG_INFO(
+        "Opened filtered frame store {} ({} of {} frames stored).",
+        fileName,
+        std::count(mValidAtOpen.begin(), mValidAtOpen.end(), 1),
+        numFrames);
+    return true;
+}
+
+/**
+ * @brief Closes the store; the file stays mapped until destruction, since returned images may still use it
+ */
+void FilteredFrameStore::close()
+{
+    if(mFile)
+    {
+        mFile->flush();
+        if(mMap != nullptr)
+        {
+            mRetired.push_back(std::move(mFile));
+        }
+    }
+    mFile.reset();
+    mMap = nullptr;
+    mFileName.clear();
+    mValidAtOpen.clear();
+    mWritten.clear();
+    mReadOnly = false;
+}
+
+/**
+ * @brief Returns the stored frame without copying it
+ *
+ * @param frame index of the frame
+ * @param img image pointing into the mapped file, only written on success
+ * @return true, if the frame was stored when the store was opened
+ */
+bool FilteredFrameStore::get(int frame, cv::Mat &img) const
+{
+    if(!isOpen() || frame < 0 || frame >= mHeader.numFrames || !mValidAtOpen[frame])
+    {
+        return false;
+    }
+    uchar *data = mMap + dataOffset(mHeader.numFrames) + frame * mFrameBytes;
+    img         = cv::Mat(mHeader.rows, mHeader.cols, mHeader.type, data);
+    return true;
+}
+
+/**
+ * @brief Writes the filtered frame into the store, if it is not stored yet and the store is not read-only
+ */
+void FilteredFrameStore::put(int frame, const cv::Mat &img)
+{
+    if(!isOpen() || mReadOnly || frame < 0 || frame >= mHeader.numFrames || mWritten[frame] ||
+       img.rows != mHeader.rows || img.cols != mHeader.cols || img.type() != mHeader.type)
+    {
+        return;
+    }
+
+    const cv::Mat continuous = img.isContinuous() ? img : img.clone();
+    const char    valid      = 1;
+    if(!mFile->seek(dataOffset(mHeader.numFrames) + frame * mFrameBytes) ||
+       mFile->write(reinterpret_cast<const char *>(continuous.data), mFrameBytes) != mFrameBytes ||
+       !mFile->seek(static_cast<qint64>(sizeof(Header)) + frame) || mFile->write(&valid, 1) != 1)
+    {
+        SPDLOG_WARN("Could not write frame {} to filtered frame store {}.", frame, mFileName);
+        return;
+    }
+    mWritten[frame] = 1;
+}
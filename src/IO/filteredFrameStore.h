@@ -0,0 +1,89 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILTEREDFRAMESTORE_H
+#define FILTEREDFRAMESTORE_H
+
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <vector>
+
+/**
+ * @brief On-disk store of filtered frames for repeated analysis runs
+ *
+ * The store is a raw, memory-mapped file with one fixed size slot per frame.
+ * Its name contains a hash of the filter parameters, so a store is only
+ * reused with exactly the filter settings it was written with.
+ *
+ * Frames which were already in the file when it was opened are returned
+ * without copying, pointing into a private (copy-on-write) mapping; writes into
+ * such an image do not change the file. Frames written in the current session
+ * are only returned after the next open.
+ *
+ * Since returned images do not own their memory, mappings are only released on
+ * destruction of the store, not when another store file is opened.
+ *
+ * A store opened read-only (e.g. shared by several processes) only returns the
+ * frames already in the file and never writes to it.
+ */
+class FilteredFrameStore
+{
+public:
+    FilteredFrameStore() = default;
+    ~FilteredFrameStore();
+
+    FilteredFrameStore(const FilteredFrameStore &)            = delete;
+    FilteredFrameStore &operator=(const FilteredFrameStore &) = delete;
+
+    bool open(const QString &fileName, int numFrames, const cv::Mat &sample, bool readOnly = false);
+    void close();
+
+    bool           isOpen() const { return mMap != nullptr; }
+    const QString &getFileName() const { return mFileName; }
+
+    bool get(int frame, cv::Mat &img) const;
+    void put(int frame, const cv::Mat &img);
+
+private:
+    struct Header
+    {
+        char   magic[8];
+        qint32 version;
+        qint32 rows;
+        qint32 cols;
+        qint32 type;
+        qint32 numFrames;
+        qint32 reserved;
+    };
+
+    static qint64 dataOffset(int numFrames);
+
+    QString                             mFileName;
+    std::unique_ptr<QFile>              mFile;
+    std::vector<std::unique_ptr<QFile>> mRetired; ///< closed, but still mapped files
+    uchar                              *mMap = nullptr;
+    Header                              mHeader{};
+    qint64                              mFrameBytes = 0;
+    std::vector<char>                   mValidAtOpen; ///< frames in the file when it was opened
+    std::vector<char>                   mWritten;     ///< frames in the file now
+    bool                                mReadOnly = false;
+};
+
+#endif // FILTEREDFRAMESTORE_H
@@ -0,0 +1,118 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameCache.h"
+
+namespace
+{
+std::size_t imageBytes(const cv::Mat &img)
+{
+    return img.total() * img.elemSize();
+}
+} // namespace
+
+FrameCache::FrameCache(std::size_t maxBytes) : mMaxBytes(maxBytes) {}
+
+/**
+ * @brief Sets the memory limit; 0 disables the cache
+ */
+void FrameCache::setMaxBytes(std::size_t maxBytes)
+{
+    mMaxBytes = maxBytes;
+    evict();
+}
+
+/**
+ * @brief Returns how many images of the size of img fit into the cache
+ */
+std::size_t FrameCache::capacityFor(const cv::Mat &img) const
+{
+    const std::size_t bytes = imageBytes(img);
+    return bytes == 0 ? 0 : mMaxBytes / bytes;
+}
+
+/**
+ * @brief Inserts (or replaces) the image of the given frame as most recently used one
+ *
+ * Images larger than the whole cache and empty images are ignored.
+ */
+void FrameCache::insert(int frame, const cv::Mat &img)
+{
+    const std::size_t bytes = imageBytes(img);
+    if(img.empty() || bytes > mMaxBytes)
+    {
+        return;
+    }
+
+    auto it = mFrames.find(frame);
+    if(it != mFrames.end())
+    {
+        mBytes -= imageBytes(it->second.img);
+        it->second.img = img;
+        mLru.splice(mLru.begin(), mLru, it->second.lruPos);
+    }
+    else
+    {
+        mLru.push_front(frame);
+        mFrames.emplace(frame, Entry{img, mLru.begin()});
+    }
+    mBytes += bytes;
+    evict();
+}
+
+/**
+ * @brief Looks up the given frame and marks it as most recently used
+ *
+ * @param frame index of the frame
+ * @param img the cached image, only written on success
+ * @return true, if the frame was cached
+ */
+bool FrameCache::get(int frame, cv::Mat &img)
+{
+    auto it = mFrames.find(frame);
+    if(it == mFrames.end())
+    {
+        return false;
+    }
+    mLru.splice(mLru.begin(), mLru, it->second.lruPos);
+    img = it->second.img;
+    return true;
+}
+
+bool FrameCache::contains(int frame) const
+{
+    return mFrames.find(frame) != mFrames.end();
+}
+
+void FrameCache::clear()
+{
+    mFrames.clear();
+    mLru.clear();
+    mBytes = 0;
+}
+
+void FrameCache::evict()
+{
+    while(mBytes > mMaxBytes && !mLru.empty())
+    {
+        auto it = mFrames.find(mLru.back());
+        mBytes -= imageBytes(it->second.img);
+        mFrames.erase(it);
+        mLru.pop_back();
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <cstddef>
+#include <list>
+#include <opencv2/core.hpp>
+#include <unordered_map>
+
+/**
+ * @brief Least recently used cache of decoded frames with a memory limit
+ *
+ * Used by Animation to make stepping backwards through a video cheap, since
+ * each backward step would otherwise need a (keyframe) seek and decoding
+ * forward to the requested frame.
+ *
+ * The cache stores the cv::Mat headers only, i.e. the buffers are shared with
+ * the inserted images. The caller must not write into an image after inserting it.
+ */
+class FrameCache
+{
+public:
+    explicit FrameCache(std::size_t maxBytes = 0);
+
+    void        setMaxBytes(std::size_t maxBytes);
+    std::size_t getMaxBytes() const { return mMaxBytes; }
+    bool        isEnabled() const { return mMaxBytes > 0; }
+
+    std::size_t capacityFor(const cv::Mat &img) const;
+
+    void insert(int frame, const cv::Mat &img);
+    bool get(int frame, cv::Mat &img);
+    bool contains(int frame) const;
+    void clear();
+
+    std::size_t size() const { return mFrames.size(); }
+    std::size_t bytes() const { return mBytes; }
+
+private:
+    struct Entry
+    {
+        cv::Mat                  img;
+        std::list<int>::iterator lruPos;
+    };
+
+    void evict();
+
+    std::size_t                    mMaxBytes;
+    std::size_t                    mBytes = 0;
+    std::list<int>                 mLru; ///< most recently used frame at the front
+    std::unordered_map<int, Entry> mFrames;
+};
+
+#endif // FRAMECACHE_H
@@ -0,0 +1,216 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "framePrefetcher.h"
+
+#include "logger.h"
+#include "videoDecoder.h"
+
+#include <algorithm>
+#include <vector>
+
+FramePrefetcher::FramePrefetcher(
+    std::string               fileName,
+    int                       depth,
+    cv::VideoAccelerationType acceleration,
+    bool                      grayscale) :
+    mFileName(std::move(fileName)), mDepth(depth), mGrayscale(grayscale)
+{
+    mOpened = mDepth > 0 && videoDecoder::open(mCapture, mFileName, acceleration);
+    if(!mOpened)
+    {
+        SPDLOG_WARN("Could not open {} for prefetching frames.", mFileName);
+        return;
+    }
+    mWorker = std::thread(&FramePrefetcher::run, this);
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+    stop();
+}
+
+/**
+ * @brief Discards all prefetched frames and lets the worker continue decoding at frame
+ *
+ * @param frame first frame to decode
+ * @param lastFrame last frame to decode (inclusive); the smallest frame if backward
+ * @param backward decode the frames in descending order
+ */
+void FramePrefetcher::restart(int frame, int lastFrame, bool backward)
+{
+    if(!mOpened)
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRing.clear();
+        mNextFrame = frame;
+        mLastFrame = lastFrame;
+        mSeek      = true;
+        mBackward  = backward;
+        mAtEnd     = backward ? frame < lastFrame : frame > lastFrame;
+        ++mGeneration;
+    }
+    mSpaceReady.notify_one();
+}
+
+/// Returns the number of decoded frames waiting in the ring
+int FramePrefetcher::getQueuedFrames()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<int>(mRing.size());
+}
+
+/**
+ * @brief Takes frame out of the ring buffer
+ *
+ * Prefetched frames before frame (after frame, if backward) are dropped. If frame
+ * is the one currently being decoded, the call blocks until the worker has finished it.
+ *
+ * @param frame index of the requested frame
+ * @param img the decoded frame, only written on success
+ * @return true, if the frame was prefetched; false, if the caller has to decode it itself
+ */
+{
+    if(!mOpened)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(!mRing.empty() && (mBackward ? mRing.front().index > frame : mRing.front().index < frame))
+    {
+        mRing.pop_front();
+    }
+    if(mRing.empty())
+    {
+        if(mAtEnd || mNextFrame != frame)
+        {
+            mSpaceReady.notify_one();
+            return false;
+        }
+        mSpaceReady.notify_one();
+        mFrameReady.wait(lock, [this] { return !mRing.empty() || mAtEnd || mStop; });
+        if(mRing.empty())
+        {
+            return false;
+        }
+    }
+    if(mRing.front().index != frame)
+    {
+        return false;
+    }
+
+    img = std::move(mRing.front().img);
+    mRing.pop_front();
+    lock.unlock();
+    mSpaceReady.notify_one();
+    return true;
+}
+
+/**
+ * @brief Stops the worker thread; afterwards fetch() always fails
+ */
+void FramePrefetcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+        mRing.clear();
+    }
+    mSpaceReady.notify_all();
+    mFrameReady.notify_all();
+    if(mWorker.joinable())
+    {
+        mWorker.join();
+    }
+    mOpened = false;
+}
+
+void FramePrefetcher::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(true)
+    {
+        mSpaceReady.wait(
+            lock, [this] { return mStop || (!mAtEnd && mRing.size() < static_cast<size_t>(mDepth)); });
+        if(mStop)
+        {
+            break;
+        }
+
+        const int  generation = mGeneration;
+        const bool backward   = mBackward;
+        // backwards a whole block ending at mNextFrame is decoded after one seek
+        const int  count = backward ? std::min(mDepth, mNextFrame - mLastFrame + 1) : 1;
+        const int  first = backward ? mNextFrame - count + 1 : mNextFrame;
+        const bool seek  = mSeek || backward;
+        mSeek            = false;
+        lock.unlock();
+
+        // decode without holding the lock, so the consumer can take already decoded frames meanwhile
+        if(seek)
+        {
+            mCapture.set(cv::CAP_PROP_POS_FRAMES, first);
+        }
+        std::vector<cv::Mat> imgs(count);
+        bool                 ok = true;
+        for(auto &img : imgs)
+        {
+            ok = mCapture.read(img) && !img.empty();
+            if(!ok)
+            {
+                break;
+            }
+            if(mGrayscale)
+            {
+                videoDecoder::toGrayscale(img);
+            }
+        }
+
+        lock.lock();
+        if(generation != mGeneration)
+        {
+            // restarted while decoding, frames are stale
+            continue;
+        }
+        if(ok && backward)
+        {
+            for(int k = count - 1; k >= 0; --k)
+            {
+                mRing.push_back({first + k, std::move(imgs[k])});
+            }
+            mNextFrame = first - 1;
+            mAtEnd     = mNextFrame < mLastFrame;
+        }
+        else if(ok)
+        {
+            mRing.push_back({first, std::move(imgs.front())});
+            ++mNextFrame;
+            mAtEnd = mNextFrame > mLastFrame;
+        }
+        else
+        {
+            mAtEnd = true;
+        }
+        mFrameReady.notify_one();
+    }
+    mCapture.release();
+}
@@ -0,0 +1,92 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEPREFETCHER_H
+#define FRAMEPREFETCHER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Decodes the frames of a video ahead of time in a worker thread
+ *
+ * The FramePrefetcher owns its own cv::VideoCapture, which is independent of the
+ * one used by Animation for random access. The worker decodes sequentially
+ * starting at a given frame into a bounded ring of depth frames. The consumer
+ * (Animation) takes the frames out in order via fetch(). If the requested frame
+ * is not the next one in the ring, fetch() fails and the caller has to decode the
+ * frame itself and may restart() the prefetcher at a new position.
+ *
+ * Backwards, the worker decodes blocks of depth frames (one seek per block) and
+ * adds each block in reverse order, so stepping backwards is served from the
+ * ring as well while the consumer works on the previous frames.
+ *
+ * All public methods are meant to be called from a single (GUI) thread.
+ */
+class FramePrefetcher
+{
+public:
+    FramePrefetcher(std::string fileName, int depth, cv::VideoAccelerationType acceleration, bool grayscale);
+    ~FramePrefetcher();
+
+    FramePrefetcher(const FramePrefetcher &)            = delete;
+    FramePrefetcher &operator=(const FramePrefetcher &) = delete;
+
+    bool isOpened() const { return mOpened; }
+    int  getDepth() const { return mDepth; }
+    int  getQueuedFrames();
+
+    void restart(int frame, int lastFrame, bool backward = false);
+    bool fetch(int frame, cv::Mat &img);
+    void stop();
+
+private:
+    struct PrefetchedFrame
+    {
+        int     index;
+        cv::Mat img;
+    };
+
+    void run();
+
+    const std::string mFileName;
+    const int         mDepth;
+    const bool        mGrayscale; ///< frames are converted to gray in the worker
+    bool              mOpened = false;
+
+    cv::VideoCapture mCapture;
+    std::thread      mWorker;
+
+    std::mutex                  mMutex;
+    std::condition_variable     mFrameReady; ///< signaled by the worker if a frame was added or the end was reached
+    std::condition_variable     mSpaceReady; ///< signaled by the consumer if a frame was taken or state changed
+    std::deque<PrefetchedFrame> mRing;
+    int                         mNextFrame  = -1;    ///< next frame the worker decodes
+    int                         mLastFrame  = -1;    ///< last frame the worker is allowed to decode
+    int                         mGeneration = 0;     ///< incremented on every restart to discard stale frames
+    bool                        mSeek       = false; ///< worker has to seek to mNextFrame before decoding
+    bool                        mBackward   = false; ///< frames are decoded in descending order
+    bool                        mAtEnd      = true;
+    bool                        mStop       = false;
+};
+
+#endif // FRAMEPREFETCHER_H
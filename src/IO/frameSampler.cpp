@@ -0,0 +1,143 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameSampler.h"
+
+#include "logger.h"
+#include "videoDecoder.h"
+
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+namespace frameSampler
+{
+/**
+ * @brief Returns count frames evenly spread over [firstFrame, lastFrame]
+ *
+ * Each frame is replaced by the last keyframe before it, if this keyframe is in the
+ * range and comes after the previous sample, so a seek decodes a single frame.
+ *
+ * @param keyFrames sorted keyframes of the video; empty, if unknown or for image sequences
+ * @return ascending frames; fewer than count, if the range is short
+ */
+std::vector<int> sampleFrames(int firstFrame, int lastFrame, int count, const std::vector<int> &keyFrames)
+{
+    std::vector<int> frames;
+    const int        numFrames = lastFrame - firstFrame + 1;
+    if(numFrames <= 0 || count <= 0)
+    {
+        return frames;
+    }
+    count = std::min(count, numFrames);
+    for(int i = 0; i < count; ++i)
+    {
+        // middle of the i-th of count equal parts of the range
+        const int  frame  = firstFrame + static_cast<int>((2LL * i + 1) * numFrames / (2LL * count));
+        int        sample = frame;
+        const auto key    = std::upper_bound(keyFrames.begin(), keyFrames.end(), frame);
+        if(key != keyFrames.begin() && *(key - 1) >= firstFrame && (frames.empty() || *(key - 1) > frames.back()))
+        {
+            sample = *(key - 1);
+        }
+        if(frames.empty() || sample > frames.back())
+        {
+            frames.push_back(sample);
+        }
+    }
+    return frames;
+}
+
+/**
+ * @brief Decodes the frames of videoFile on all cores
+ *
+ * @param frames ascending frames to decode
+ * @return decoded frames in the order of frames; frames which could not be decoded are empty
+ */
+std::vector<cv::Mat>
+decodeVideo(const QString &videoFile, const std::vector<int> &frames, cv::VideoAccelerationType acceleration)
+{
+    std::vector<cv::Mat> images(frames.size());
+    if(frames.empty())
+    {
+        return images;
+    }
+    const int            parts = std::clamp(QThread::idealThreadCount(), 1, static_cast<int>(frames.size()));
+    const std::string    file  = videoFile.toStdString();
+
+    std::vector<QFuture<void>> jobs;
+    for(int part = 0; part < parts; ++part)
+    {
+        const std::size_t begin = frames.size() * part / parts;
+        const std::size_t end   = frames.size() * (part + 1) / parts;
+        jobs.push_back(QtConcurrent::run(
+            [&, begin, end]()
+            {
+                cv::VideoCapture capture;
+                if(!videoDecoder::open(capture, file, acceleration))
+                {
+                    SPDLOG_WARN("Could not open {} for sampling frames.", file);
+                    return;
+                }
+                int nextFrame = 0; ///< frame read next by capture
+                for(std::size_t i = begin; i < end; ++i)
+                {
+                    if(frames[i] != nextFrame && !capture.set(cv::CAP_PROP_POS_FRAMES, frames[i]))
+                    {
+                        break;
+                    }
+                    if(!capture.read(images[i]))
+                    {
+                        break;
+                    }
+                    nextFrame = frames[i] + 1;
+                }
+            }));
+    }
+    for(auto &job : jobs)
+    {
+        job.waitForFinished();
+    }
+    return images;
+}
+
+/**
+ * @brief Reads the images of frames from imageFiles on all cores
+ *
+ * @return images in the order of frames; images which could not be read are empty
+ */
+std::vector<cv::Mat> readImages(const QStringList &imageFiles, const std::vector<int> &frames)
+{
+    std::vector<cv::Mat> images(frames.size());
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(frames.size())),
+        [&](const cv::Range &range)
+        {
+            for(int i = range.start; i < range.end; ++i)
+            {
+                if(frames[i] >= 0 && frames[i] < imageFiles.size())
+                {
+                    images[i] = cv::imread(imageFiles[frames[i]].toStdString());
+                }
+            }
+        });
+    return images;
+}
+} // namespace frameSampler
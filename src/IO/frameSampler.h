@@ -0,0 +1,42 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMESAMPLER_H
+#define FRAMESAMPLER_H
+
+#include <QStringList>
+#include <opencv2/videoio.hpp>
+#include <vector>
+
+/**
+ * @brief Decodes a few frames spread across a sequence in parallel
+ *
+ * Used to get an overview of a whole sequence before processing it, e.g. to build the
+ * background model (see BackgroundModel). Every thread decodes a contiguous part of
+ * the samples with its own cv::VideoCapture, independent of the one of Animation.
+ */
+namespace frameSampler
+{
+std::vector<int> sampleFrames(int firstFrame, int lastFrame, int count, const std::vector<int> &keyFrames);
+
+std::vector<cv::Mat>
+decodeVideo(const QString &videoFile, const std::vector<int> &frames, cv::VideoAccelerationType acceleration);
+std::vector<cv::Mat> readImages(const QStringList &imageFiles, const std::vector<int> &frames);
+} // namespace frameSampler
+
+#endif // FRAMESAMPLER_H
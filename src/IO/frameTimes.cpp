@@ -0,0 +1,101 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameTimes.h"
+
+#include <QDateTime>
+#include <QTime>
+#include <cmath>
+#include <utility>
+
+/**
+ * @brief Sets the times of the frames in seconds since the first frame
+ *
+ * @param times ascending time per frame starting at frame 0; empty for a constant frame rate
+ */
+void FrameTimes::setTimes(std::vector<double> times)
+{
+    mTimes = std::move(times);
+}
+
+/// Forgets the table and the start of the recording; the frame rate is kept
+void FrameTimes::clear()
+{
+    mTimes.clear();
+    mStart = -1;
+}
+
+/**
+ * @brief Returns the time of frame in seconds since the first frame
+ */
+double FrameTimes::seconds(int frame) const
+{
+    const int size = static_cast<int>(mTimes.size());
+    if(frame >= 0 && frame < size)
+    {
+        return mTimes[frame];
+    }
+    const double perFrame = mFps > 0 ? 1. / mFps : 0.;
+    if(frame >= size && size > 0)
+    {
+        return mTimes.back() + (frame - size + 1) * perFrame;
+    }
+    return frame * perFrame;
+}
+
+/**
+ * @brief Returns the time of frame for display with a precision of 1/10000 s
+ *
+ * With known start of the recording the date and time of day is returned
+ * (dd.MM.yyyy hh:mm:ss.zzzz), otherwise the time since the first frame (hh:mm:ss.zzzz).
+ */
+QString FrameTimes::toString(int frame) const
+{
+    const qint64 ticks = std::llround(seconds(frame) * 10000.); // in 1/10000 s
+    if(mStart >= 0)
+    {
+        const qint64    time     = mStart / 100 + ticks;
+        const QDateTime dateTime = QDateTime::fromSecsSinceEpoch(time / 10000);
+        return (dateTime.toString("dd.MM.yyyy hh:mm:ss") + ".%1").arg(time % 10000, 4, 10, QChar('0'));
+    }
+    const QTime t = QTime(0, 0, 0).addSecs(static_cast<int>(ticks / 10000));
+    return (t.toString("hh:mm:ss") + ".%1").arg(ticks % 10000, 4, 10, QChar('0'));
+}
+
+/**
+ * @brief Checks whether times differ from a constant frame rate by more than half a frame
+ *
+ * The frame rate is the average rate of times. Only for variable frame rates the table
+ * is worth keeping.
+ */
+bool FrameTimes::isVariable(const std::vector<double> &times)
+{
+    if(times.size() < 3)
+    {
+        return false;
+    }
+    const double perFrame = (times.back() - times.front()) / static_cast<double>(times.size() - 1);
+    for(size_t k = 0; k < times.size(); ++k)
+    {
+        if(std::abs(times[k] - times.front() - static_cast<double>(k) * perFrame) > perFrame / 2.)
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMETIMES_H
+#define FRAMETIMES_H
+
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief Time of every frame of a sequence
+ *
+ * By default the frames follow each other with the frame rate of the sequence. For
+ * recordings with a variable frame rate, the times of the frames can be set as table,
+ * e.g. from the .time file of a stereo recording or the presentation timestamps of a
+ * video. Frames after the end of the table continue with the frame rate.
+ *
+ * The times are looked up per frame (e.g. to synchronize MoCap recordings), only
+ * toString() formats them for display.
+ */
+class FrameTimes
+{
+public:
+    void   setFps(double fps) { mFps = fps; }
+    double getFps() const { return mFps; }
+
+    void                       setTimes(std::vector<double> times);
+    const std::vector<double> &getTimes() const { return mTimes; }
+    bool                       hasTimes() const { return !mTimes.empty(); }
+
+    void   setStart(qint64 microSecSinceEpoch) { mStart = microSecSinceEpoch; }
+    qint64 getStart() const { return mStart; }
+
+    void clear();
+
+    double  seconds(int frame) const;
+    QString toString(int frame) const;
+
+    static bool isVariable(const std::vector<double> &times);
+
+private:
+    double              mFps = -1;
+    std::vector<double> mTimes;      ///< seconds since the first frame per frame, ascending
+    qint64              mStart = -1; ///< recording time of the first frame in microseconds since epoch; -1 unknown
+};
+
+#endif // FRAMETIMES_H
@@ -0,0 +1,305 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "imageSequenceIndex.h"
+
+#include "logger.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRegExp>
+#include <QTextStream>
+#include <algorithm>
+#include <opencv2/imgcodecs.hpp>
+
+namespace
+{
+constexpr const char *SIDECAR_HEADER  = "PETRACK_IMAGE_SEQUENCE";
+constexpr int         SIDECAR_VERSION = 1;
+
+/// Channels of an image read with cv::IMREAD_UNCHANGED; 0, if it cannot be told from the format of Qt
+int headerChannels(QImage::Format format)
+{
+    switch(format)
+    {
+        case QImage::Format_Mono:
+        case QImage::Format_MonoLSB:
+        case QImage::Format_Grayscale8:
+            return 1;
+        case QImage::Format_RGB32:
+        case QImage::Format_RGB888:
+            return 3;
+        case QImage::Format_ARGB32:
+        case QImage::Format_ARGB32_Premultiplied:
+            return 4;
+        default:
+            // e.g. palettes or 16 bit per channel
+            return 0;
+    }
+}
+
+/// Returns fileName without its suffix, like QFileInfo::completeBaseName()
+QString completeBaseName(const QString &fileName, QString &suffix)
+{
+    const int dot = fileName.lastIndexOf('.');
+    if(dot < 0)
+    {
+        suffix.clear();
+        return fileName;
+    }
+    suffix = fileName.mid(dot + 1);
+    return fileName.left(dot);
+}
+} // namespace
+
+/**
+ * @brief Loads the index of the sequence fileName belongs to from its sidecar or scans (and saves) it
+ *
+ * @param fileName name of one image of the sequence
+ * @return the index, empty if the sequence could not be read
+ */
+ImageSequenceIndex ImageSequenceIndex::create(const QString &fileName)
+{
+    ImageSequenceIndex index;
+    if(index.load(fileName))
+    {
+        return index;
+    }
+    if(index.scan(fileName))
+    {
+        index.save(fileName);
+    }
+    return index;
+}
+
+QString ImageSequenceIndex::sidecarName(const QString &fileName)
+{
+    const QFileInfo file(fileName);
+    QString         front, back;
+    splitName(file.completeBaseName(), front, back);
+    return file.dir().filePath(front + back + "." + file.suffix() + ".pseq");
+}
+
+/**
+ * @brief Splits the name of an image at its sequence number
+ *
+ * series1_0002-left => series1_|0002|-left
+ *
+ * @param baseName name of the image without suffix
+ * @param front part in front of the sequence number
+ * @param back part behind the sequence number
+ * @return false, if the name cannot be split
+ */
+bool ImageSequenceIndex::splitName(const QString &baseName, QString &front, QString &back)
+{
+    // regexp is greedy - from left to right try to get the most characters
+    QRegExp regExp("(?:[0-9]*)([^0-9]*)$"); //(?: ) zum ignorieren
+    const int frontLen = regExp.indexIn(baseName);
+    if(frontLen < 0)
+    {
+        return false;
+    }
+    front = baseName.left(frontLen);
+    back  = regExp.cap(1);
+    return true;
+}
+
+/**
+ * @brief Reads size, channels and depth of an image as cv::imread() with cv::IMREAD_UNCHANGED would return it
+ *
+ * Only the header is read, if Qt knows the format of the image; otherwise the image is decoded.
+ *
+ * @return false, if the image cannot be read
+ */
+bool ImageSequenceIndex::readHeader(const QString &fileName, cv::Size &size, int &channels, int &depth)
+{
+    QImageReader reader(fileName);
+    const QSize  headerSize = reader.size();
+    channels                = headerChannels(reader.imageFormat());
+    if(headerSize.isValid() && channels > 0)
+    {
+        size  = cv::Size(headerSize.width(), headerSize.height());
+        depth = CV_8U;
+        return true;
+    }
+
+    const cv::Mat img = cv::imread(fileName.toStdString(), cv::IMREAD_UNCHANGED);
+    if(img.empty())
+    {
+        return false;
+    }
+    size     = img.size();
+    channels = img.channels();
+    depth    = img.depth();
+    return true;
+}
+
+/**
+ * @brief Lists the images of the sequence fileName belongs to and reads the format of the first one
+ *
+ * Only the names of the directory entries are read. The images are sorted by name, so
+ * the sequence numbers have to be padded with zeros.
+ *
+ * @return false, if there is no readable image
+ */
+bool ImageSequenceIndex::scan(const QString &fileName)
+{
+    clear();
+
+    const QFileInfo file(fileName);
+    QString         front, back;
+    if(!splitName(file.completeBaseName(), front, back))
+    {
+        return false;
+    }
+
+    const QDir  dir = file.dir();
+    QStringList names;
+    QString     suffix, entryFront, entryBack;
+    for(const QString &name : dir.entryList(QDir::Files, QDir::NoSort))
+    {
+        const QString baseName = completeBaseName(name, suffix);
+        if(suffix == file.suffix() && splitName(baseName, entryFront, entryBack) && entryFront == front &&
+           entryBack == back)
+        {
+            names << name;
+        }
+    }
+    // same order as QDir::Name
+    std::sort(names.begin(), names.end());
+    if(names.isEmpty() || !readHeader(dir.filePath(names.first()), mSize, mChannels, mDepth))
+    {
+        clear();
+        return false;
+    }
+
+    mFileBase = front + back;
+    mFiles.reserve(names.size());
+    for(const QString &name : names)
+    {
+        mFiles << dir.filePath(name);
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the sidecar of the sequence fileName belongs to
+ *
+ * @return true, if the sidecar exists, belongs to the current state of the directory
+ * and contains fileName
+ */
+bool ImageSequenceIndex::load(const QString &fileName)
+{
+    clear();
+
+    QFile file(sidecarName(fileName));
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return false;
+    }
+
+    const QFileInfo image(fileName);
+    const QFileInfo dir(image.absolutePath());
+    QTextStream     in(&file);
+    QString         header;
+    int             version       = -1;
+    qint64          dirModified   = -1;
+    qint64          firstSize     = -1;
+    qint64          firstModified = -1;
+    int             width = 0, height = 0, numFiles = 0;
+    in >> header >> version >> dirModified >> firstSize >> firstModified >> width >> height >> mChannels >> mDepth >>
+        numFiles;
+    in.readLine(); // rest of the line in front of the names
+    if(header != SIDECAR_HEADER || version != SIDECAR_VERSION ||
+       dirModified != dir.lastModified().toMSecsSinceEpoch() || numFiles <= 0)
+    {
+        SPDLOG_INFO("Image sequence index {} is outdated and will be rebuilt.", file.fileName());
+        clear();
+        return false;
+    }
+
+    QStringList names;
+    names.reserve(numFiles);
+    for(int i = 0; i < numFiles && !in.atEnd(); ++i)
+    {
+        names << in.readLine();
+    }
+    const QFileInfo first(image.dir().filePath(names.value(0)));
+    if(in.status() != QTextStream::Ok || names.size() != numFiles || !std::is_sorted(names.begin(), names.end()) ||
+       !std::binary_search(names.begin(), names.end(), image.fileName()) || first.size() != firstSize ||
+       first.lastModified().toMSecsSinceEpoch() != firstModified)
+    {
+        SPDLOG_INFO("Image sequence index {} is outdated and will be rebuilt.", file.fileName());
+        clear();
+        return false;
+    }
+
+    QString front, back;
+    splitName(image.completeBaseName(), front, back);
+    mFileBase = front + back;
+    mSize     = cv::Size(width, height);
+    mFiles.reserve(numFiles);
+    for(const QString &name : names)
+    {
+        mFiles << image.dir().filePath(name);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the index to the sidecar of the sequence fileName belongs to
+ *
+ * A failure (e.g. images on a read-only share) is not critical, the directory is
+ * just scanned again at the next open.
+ */
+bool ImageSequenceIndex::save(const QString &fileName) const
+{
+    QFile file(sidecarName(fileName));
+    if(mFiles.isEmpty() || !file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    {
+        SPDLOG_WARN("Could not write image sequence index {}: {}", file.fileName(), file.errorString());
+        return false;
+    }
+
+    // creating the sidecar changes the modification time of the directory, writing to it does not
+    const QFileInfo dir(QFileInfo(fileName).absolutePath());
+    const QFileInfo first(mFiles.first());
+    QTextStream     out(&file);
+    out << SIDECAR_HEADER << " " << SIDECAR_VERSION << "\n";
+    out << dir.lastModified().toMSecsSinceEpoch() << " " << first.size() << " "
+        << first.lastModified().toMSecsSinceEpoch() << "\n";
+    out << mSize.width << " " << mSize.height << " " << mChannels << " " << mDepth << "\n";
+    out << mFiles.size() << "\n";
+    for(const QString &name : mFiles)
+    {
+        out << QFileInfo(name).fileName() << "\n";
+    }
+    return true;
+}
+
+void ImageSequenceIndex::clear()
+{
+    mFiles.clear();
+    mFileBase.clear();
+    mSize     = cv::Size();
+    mChannels = 0;
+    mDepth    = -1;
+}
@@ -0,0 +1,70 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGESEQUENCEINDEX_H
+#define IMAGESEQUENCEINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <opencv2/core.hpp>
+
+/**
+ * @brief Sorted file list and image format of an image sequence
+ *
+ * Listing a directory with 100k files and querying every one of them takes minutes
+ * on network shares. The index only reads the names of the directory entries and is
+ * stored in a sidecar next to the images (<base>.<suffix>.pseq), so the next open
+ * just reads the sidecar. The sidecar contains the modification time of the
+ * directory, which changes whenever files are added, removed or renamed, and size and
+ * modification time of the first image; it is rebuilt if one of them changed.
+ *
+ * Size and channels of the images are read from the header of the first image
+ * without decoding it, if Qt knows its format.
+ */
+class ImageSequenceIndex
+{
+public:
+    ImageSequenceIndex() = default;
+
+    static ImageSequenceIndex create(const QString &fileName);
+    static QString            sidecarName(const QString &fileName);
+    static bool               splitName(const QString &baseName, QString &front, QString &back);
+    static bool               readHeader(const QString &fileName, cv::Size &size, int &channels, int &depth);
+
+    bool               isEmpty() const { return mFiles.isEmpty(); }
+    const QStringList &getFiles() const { return mFiles; }
+    const QString     &getFileBase() const { return mFileBase; }
+    const cv::Size    &getSize() const { return mSize; }
+    int                getChannels() const { return mChannels; }
+    int                getDepth() const { return mDepth; }
+
+    bool scan(const QString &fileName);
+    bool load(const QString &fileName);
+    bool save(const QString &fileName) const;
+
+private:
+    void clear();
+
+    QStringList mFiles;    ///< full paths in the order of the sequence
+    QString     mFileBase; ///< name of the files without sequence number and suffix
+    cv::Size    mSize;
+    int         mChannels = 0;
+    int         mDepth    = -1;
+};
+
+#endif // IMAGESEQUENCEINDEX_H
@@ -0,0 +1,192 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "imageSequenceLoader.h"
+
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <opencv2/imgcodecs.hpp>
+
+namespace
+{
+/// flag of cv::imread() for decoding at 1/scale of the size
+int reducedReadFlag(bool grayscale, int scale)
+{
+    switch(scale)
+    {
+        case 2:
+            return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+        case 4:
+            return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+        default:
+            return grayscale ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+    }
+}
+} // namespace
+
+ImageSequenceLoader::ImageSequenceLoader()
+{
+    mPool.setMaxThreadCount(1);
+}
+
+ImageSequenceLoader::~ImageSequenceLoader()
+{
+    clear();
+}
+
+/**
+ * @brief Sets the files of the image sequence and discards everything read ahead
+ */
+void ImageSequenceLoader::setFiles(const QStringList &files)
+{
+    clear();
+    mFiles = files;
+}
+
+/**
+ * @brief Sets the number of files read ahead; 0 reads all files synchronously
+ */
+void ImageSequenceLoader::setDepth(int depth)
+{
+    clear();
+    mDepth = std::max(depth, 0);
+    mPool.setMaxThreadCount(std::max(1, std::min(mDepth, QThread::idealThreadCount())));
+}
+
+/**
+ * @brief Sets whether images are read as single channel gray images
+ */
+void ImageSequenceLoader::setGrayscale(bool grayscale)
+{
+    clear();
+    mGrayscale = grayscale;
+}
+
+/**
+ * @brief Sets the factor, by which the images are reduced while decoding; 1, 2, 4 or 8
+ *
+ * Changing it discards everything read ahead, so it should only change, when switching
+ * between preview and processing.
+ */
+void ImageSequenceLoader::setScale(int scale)
+{
+    scale = scale >= 8 ? 8 : scale >= 4 ? 4 : scale >= 2 ? 2 : 1;
+    if(scale == mScale)
+    {
+        return;
+    }
+    clear();
+    mScale = scale;
+}
+
+/**
+ * @brief Returns the image of the given frame and starts reading ahead in playback direction
+ *
+ * @param index frame to load
+ * @param direction 1 for forward playback, -1 for backward playback
+ * @param firstIndex first frame which may be read ahead
+ * @param lastIndex last frame which may be read ahead
+ * @return the image as read by readImage()
+ */
+cv::Mat ImageSequenceLoader::load(int index, int direction, int firstIndex, int lastIndex)
+{
+    if(index < 0 || index >= mFiles.size())
+    {
+        return cv::Mat();
+    }
+    if(mDepth == 0)
+    {
+        return readImage(mFiles.at(index), mGrayscale, mScale);
+    }
+
+    direction            = direction < 0 ? -1 : 1;
+    const int lastFile   = std::min(lastIndex, static_cast<int>(mFiles.size()) - 1);
+    const int windowEnd  = index + direction * mDepth;
+    const int windowLow  = std::max(std::min(index, windowEnd), std::max(firstIndex, 0));
+    const int windowHigh = std::min(std::max(index, windowEnd), lastFile);
+
+    // frames outside of the window are not needed anymore; still running reads just finish unobserved
+    for(auto it = mPending.begin(); it != mPending.end();)
+    {
+        it = (it->first < windowLow || it->first > windowHigh) ? mPending.erase(it) : std::next(it);
+    }
+
+    schedule(index);
+    for(int frame = index + direction; frame >= windowLow && frame <= windowHigh; frame += direction)
+    {
+        schedule(frame);
+    }
+
+    auto    it  = mPending.find(index);
+    cv::Mat img = it->second.result();
+    mPending.erase(it);
+    return img;
+}
+
+/**
+ * @brief Discards everything read ahead and waits for running reads
+ */
+void ImageSequenceLoader::clear()
+{
+    mPool.clear();
+    mPool.waitForDone();
+    mPending.clear();
+}
+
+/**
+ * @brief Reads a single image of a sequence
+ *
+ * Images with alpha channel are read again as 3-channel BGR images. Gray
+ * images are decoded as such (e.g. only luma for JPEG).
+ *
+ * Reduced images (scale 2, 4 or 8) are always 8 bit gray or BGR images. JPEG files are
+ * decoded directly at the reduced size by scaling the DCT, which takes a fraction of the
+ * time of the full decoding; other formats are decoded fully and resized.
+ *
+ * @param fileName image file
+ * @param grayscale decode as single channel gray image
+ * @param scale factor, by which width and height of the image are reduced (1, 2, 4 or 8)
+ */
+cv::Mat ImageSequenceLoader::readImage(const QString &fileName, bool grayscale, int scale)
+{
+    if(scale > 1)
+    {
+        return cv::imread(fileName.toStdString(), reducedReadFlag(grayscale, scale));
+    }
+    if(grayscale)
+    {
+        return cv::imread(fileName.toStdString(), cv::IMREAD_GRAYSCALE);
+    }
+    cv::Mat img = cv::imread(fileName.toStdString(), cv::IMREAD_UNCHANGED);
+    if(img.channels() == 4)
+    {
+        img = cv::imread(fileName.toStdString(), cv::IMREAD_COLOR);
+    }
+    return img;
+}
+
+void ImageSequenceLoader::schedule(int index)
+{
+    if(mPending.find(index) != mPending.end())
+    {
+        return;
+    }
+    mPending.emplace(
+        index, QtConcurrent::run(&mPool, &ImageSequenceLoader::readImage, mFiles.at(index), mGrayscale, mScale));
+}
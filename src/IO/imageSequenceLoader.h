@@ -0,0 +1,71 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGESEQUENCELOADER_H
+#define IMAGESEQUENCELOADER_H
+
+#include <QFuture>
+#include <QStringList>
+#include <QThreadPool>
+#include <map>
+#include <opencv2/core.hpp>
+
+/**
+ * @brief Reads the files of an image sequence ahead in parallel
+ *
+ * For the requested frame the next depth files in playback direction are
+ * read and decoded by a thread pool. This hides the latency of single files
+ * (e.g. on network shares) and distributes the decoding of compressed
+ * formats (PNG, TIFF) over several cores. With depth 0 all files are read
+ * synchronously in the calling thread.
+ *
+ * For previews, the images can be decoded at a reduced size (see setScale()).
+ */
+class ImageSequenceLoader
+{
+public:
+    ImageSequenceLoader();
+    ~ImageSequenceLoader();
+
+    ImageSequenceLoader(const ImageSequenceLoader &)            = delete;
+    ImageSequenceLoader &operator=(const ImageSequenceLoader &) = delete;
+
+    void setFiles(const QStringList &files);
+    void setDepth(int depth);
+    int  getDepth() const { return mDepth; }
+    void setGrayscale(bool grayscale);
+    void setScale(int scale);
+    int  getScale() const { return mScale; }
+
+    cv::Mat load(int index, int direction, int firstIndex, int lastIndex);
+    void    clear();
+
+    static cv::Mat readImage(const QString &fileName, bool grayscale, int scale = 1);
+
+private:
+    void schedule(int index);
+
+    QThreadPool                     mPool;
+    QStringList                     mFiles;
+    int                             mDepth     = 0;
+    bool                            mGrayscale = false;
+    int                             mScale     = 1; ///< images are decoded at 1/mScale of their size
+    std::map<int, QFuture<cv::Mat>> mPending; ///< frames which are read or already have been read ahead
+};
+
+#endif // IMAGESEQUENCELOADER_H
@@ -0,0 +1,91 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "imageSequenceWriter.h"
+
+#include "concurrency.h"
+
+#include <QtConcurrent>
+
+/**
+ * @param numThreads number of images compressed at the same time; 0 for the configured number of threads
+ * @param quality compression quality passed to QImage::save (0..100, -1 for the default of the format)
+ */
+ImageSequenceWriter::ImageSequenceWriter(int numThreads, int quality) : mQuality(quality)
+{
+    mPool.setMaxThreadCount(numThreads > 0 ? numThreads : concurrency::threadCount());
+}
+
+ImageSequenceWriter::~ImageSequenceWriter()
+{
+    finish();
+}
+
+/**
+ * @brief Queues img to be saved as fileName
+ *
+ * Blocks while too many images are pending.
+ *
+ * @param img image to save
+ * @param fileName destination file
+ * @param format image format; if empty, it is deduced from the suffix of fileName
+ * @return false, if saving one of the former images failed (see getFailedFile())
+ */
+bool ImageSequenceWriter::write(const QImage &img, const QString &fileName, const QString &format)
+{
+    if(!collect(2 * static_cast<std::size_t>(mPool.maxThreadCount())))
+    {
+        return false;
+    }
+    const int quality = mQuality;
+    mPending.push_back(
+        {fileName,
+         QtConcurrent::run(
+             &mPool,
+             [img, fileName, format, quality]()
+             {
+                 return img.save(
+                     fileName, format.isEmpty() ? nullptr : format.toLatin1().constData(), quality);
+             })});
+    return true;
+}
+
+/**
+ * @brief Waits until all queued images are saved
+ *
+ * @return false, if any image could not be saved (see getFailedFile())
+ */
+bool ImageSequenceWriter::finish()
+{
+    return collect(0);
+}
+
+/// Waits for the oldest pending images until at most maxPending remain
+bool ImageSequenceWriter::collect(std::size_t maxPending)
+{
+    while(mPending.size() > maxPending)
+    {
+        mPending.front().saved.waitForFinished();
+        if(!mPending.front().saved.result() && mFailedFile.isEmpty())
+        {
+            mFailedFile = mPending.front().fileName;
+        }
+        mPending.pop_front();
+    }
+    return mFailedFile.isEmpty();
+}
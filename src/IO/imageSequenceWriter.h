@@ -0,0 +1,67 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGESEQUENCEWRITER_H
+#define IMAGESEQUENCEWRITER_H
+
+#include <QFuture>
+#include <QImage>
+#include <QString>
+#include <QThreadPool>
+#include <deque>
+
+/**
+ * @brief Compresses and writes the images of an exported image sequence in parallel
+ *
+ * The images are handed over in sequence order with their file names and
+ * are saved by a thread pool. QImage is implicitly shared, so rendering the
+ * next frame into the same QImage detaches it and does not alter images
+ * which are still waiting to be saved. The number of pending images is
+ * bounded to a few per thread.
+ */
+class ImageSequenceWriter
+{
+public:
+    ImageSequenceWriter(int numThreads, int quality);
+    ~ImageSequenceWriter();
+
+    ImageSequenceWriter(const ImageSequenceWriter &)            = delete;
+    ImageSequenceWriter &operator=(const ImageSequenceWriter &) = delete;
+
+    bool write(const QImage &img, const QString &fileName, const QString &format = QString());
+    bool finish();
+
+    /// name of the first file which could not be written
+    QString getFailedFile() const { return mFailedFile; }
+
+private:
+    struct PendingImage
+    {
+        QString       fileName;
+        QFuture<bool> saved;
+    };
+
+    bool collect(std::size_t maxPending);
+
+    QThreadPool              mPool;
+    int                      mQuality;
+    std::deque<PendingImage> mPending;
+    QString                  mFailedFile;
+};
+
+#endif // IMAGESEQUENCEWRITER_H
@@ -0,0 +1,149 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "liveCapture.h"
+
+#include "logger.h"
+#include "videoDecoder.h"
+
+LiveCapture::~LiveCapture()
+{
+    stop();
+}
+
+/**
+ * @brief Starts reading capture in the capture thread
+ *
+ * @param capture opened camera stream; must not be used by others until stop()
+ * @param grayscale convert the frames to gray in the capture thread
+ */
+void LiveCapture::start(cv::VideoCapture &capture, bool grayscale)
+{
+    stop();
+    mCapture       = &capture;
+    mGrayscale     = grayscale;
+    mFps           = capture.get(cv::CAP_PROP_FPS);
+    mDroppedFrames = 0;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueue.clear();
+        mStop  = false;
+        mAtEnd = false;
+    }
+    mWorker = std::thread(&LiveCapture::run, this);
+}
+
+void LiveCapture::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+        mQueue.clear();
+    }
+    mSpaceReady.notify_all();
+    mFrameReady.notify_all();
+    if(mWorker.joinable())
+    {
+        mWorker.join();
+    }
+    mCapture = nullptr;
+}
+
+/// Returns the number of captured frames waiting to be read
+int LiveCapture::getQueuedFrames()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return static_cast<int>(mQueue.size());
+}
+
+/**
+ * @brief Takes the oldest queued frame, waits for the camera if none is queued
+ *
+ * With DropPolicy::Latest, the newest queued frame is taken and the older ones are dropped.
+ *
+ * @param img the frame, only written on success
+ * @param timestamp time at which the frame was read from the camera
+ * @return false, if the camera stream ended or the capture was stopped
+ */
+bool LiveCapture::read(cv::Mat &img, Clock::time_point &timestamp)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mFrameReady.wait(lock, [this] { return !mQueue.empty() || mAtEnd || mStop; });
+    if(mQueue.empty())
+    {
+        return false;
+    }
+    if(mPolicy == DropPolicy::Latest)
+    {
+        mDroppedFrames += static_cast<int>(mQueue.size()) - 1;
+        mQueue.erase(mQueue.begin(), mQueue.end() - 1);
+    }
+    img       = std::move(mQueue.front().img);
+    timestamp = mQueue.front().timestamp;
+    mQueue.pop_front();
+    lock.unlock();
+    mSpaceReady.notify_one();
+    return true;
+}
+
+void LiveCapture::setDropPolicy(DropPolicy policy)
+{
+    mPolicy = policy;
+    // a blocked capture thread has to reconsider
+    mSpaceReady.notify_one();
+}
+
+void LiveCapture::run()
+{
+    while(true)
+    {
+        cv::Mat    img;
+        const bool ok        = mCapture->read(img) && !img.empty();
+        const auto timestamp = Clock::now();
+        if(ok && mGrayscale)
+        {
+            videoDecoder::toGrayscale(img);
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        if(!ok)
+        {
+            SPDLOG_WARN("Camera stream delivered no frame, stopping capture.");
+            mAtEnd = true;
+            mFrameReady.notify_all();
+            return;
+        }
+        mSpaceReady.wait(
+            lock, [this] { return mStop || mPolicy != DropPolicy::Block || mQueue.size() < QUEUE_SIZE; });
+        if(mStop)
+        {
+            return;
+        }
+        if(mQueue.size() >= QUEUE_SIZE)
+        {
+            ++mDroppedFrames;
+            if(mPolicy == DropPolicy::DropNewest)
+            {
+                continue;
+            }
+            mQueue.pop_front();
+        }
+        mQueue.push_back({std::move(img), timestamp});
+        mFrameReady.notify_one();
+    }
+}
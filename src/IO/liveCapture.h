@@ -0,0 +1,100 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIVECAPTURE_H
+#define LIVECAPTURE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <thread>
+
+/**
+ * @brief Reads the frames of a camera stream in a dedicated thread
+ *
+ * The frames are timestamped right after they are read and queued, so a slow
+ * processing of one frame does not stall the camera. If the queue is full,
+ * the DropPolicy decides whether the capture thread waits (the driver may
+ * then drop frames unnoticed), discards the oldest queued frame or discards
+ * the new frame. With Latest, reading skips all queued frames but the newest one,
+ * so the processing never lags behind the camera. Discarded frames are counted.
+ *
+ * While running, the capture thread is the only user of the cv::VideoCapture.
+ */
+class LiveCapture
+{
+public:
+    enum class DropPolicy
+    {
+        Block,
+        DropOldest,
+        DropNewest,
+        Latest
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    LiveCapture() = default;
+    ~LiveCapture();
+
+    LiveCapture(const LiveCapture &)            = delete;
+    LiveCapture &operator=(const LiveCapture &) = delete;
+
+    void start(cv::VideoCapture &capture, bool grayscale);
+    void stop();
+    bool isRunning() const { return mWorker.joinable(); }
+
+    bool read(cv::Mat &img, Clock::time_point &timestamp);
+
+    void       setDropPolicy(DropPolicy policy);
+    DropPolicy getDropPolicy() const { return mPolicy; }
+    int        getDroppedFrames() const { return mDroppedFrames; }
+    int        getQueuedFrames();
+    double     getFps() const { return mFps; }
+
+private:
+    struct LiveFrame
+    {
+        cv::Mat           img;
+        Clock::time_point timestamp;
+    };
+
+    void run();
+
+    // frames queued at most, enough to bridge a few slow frames
+    static constexpr std::size_t QUEUE_SIZE = 8;
+
+    cv::VideoCapture *mCapture   = nullptr;
+    bool              mGrayscale = false;
+    double            mFps       = 0; ///< read on start, the capture must not be queried while running
+    std::thread       mWorker;
+
+    std::mutex              mMutex;
+    std::condition_variable mFrameReady;
+    std::condition_variable mSpaceReady;
+    std::deque<LiveFrame>   mQueue;
+    std::atomic<DropPolicy> mPolicy{DropPolicy::DropOldest};
+    std::atomic_int         mDroppedFrames{0};
+    bool                    mStop  = false;
+    bool                    mAtEnd = false; ///< camera delivered no more frames
+};
+
+#endif // LIVECAPTURE_H
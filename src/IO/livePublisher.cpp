@@ -0,0 +1,125 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "livePublisher.h"
+
+#include "logger.h"
+
+#include <QHostInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+/**
+ * @brief Sets the receiver of the positions as host:port; an empty target stops publishing
+ *
+ * Host names are resolved once here, not per frame.
+ *
+ * @return false, if target is invalid or its host could not be resolved
+ */
+bool LivePublisher::setTarget(const QString &target)
+{
+    mTarget = target;
+    mPort   = 0;
+    if(target.isEmpty())
+    {
+        return true;
+    }
+
+    const auto hostPort = parseTarget(target);
+    if(!hostPort)
+    {
+        SPDLOG_ERROR("Invalid live publishing target {} (expected host:port).", target);
+        return false;
+    }
+    QHostAddress host(hostPort->first);
+    if(host.isNull())
+    {
+        const auto addresses = QHostInfo::fromName(hostPort->first).addresses();
+        if(addresses.isEmpty())
+        {
+            SPDLOG_ERROR("Could not resolve the live publishing host {}.", hostPort->first);
+            return false;
+        }
+        host = addresses.first();
+    }
+    mHost = host;
+    mPort = hostPort->second;
+    SPDLOG_INFO("Publishing live positions to {}:{}.", mHost.toString(), mPort);
+    return true;
+}
+
+/**
+ * @brief Sends the positions of frame, if a target is set
+ */
+void LivePublisher::publish(int frame, double latency, const std::vector<LivePosition> &positions)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+    if(mSocket.writeDatagram(datagram(frame, latency, positions), mHost, mPort) < 0)
+    {
+        SPDLOG_WARN("Could not publish the live positions of frame {}: {}", frame, mSocket.errorString());
+    }
+}
+
+/**
+ * @brief Splits target into host and port
+ *
+ * IPv6 addresses have to be put in brackets, e.g. [::1]:5000.
+ *
+ * @return std::nullopt, if there is no host or no valid port
+ */
+std::optional<std::pair<QString, quint16>> LivePublisher::parseTarget(const QString &target)
+{
+    const int colon = target.lastIndexOf(':');
+    if(colon <= 0)
+    {
+        return std::nullopt;
+    }
+    QString host = target.left(colon);
+    if(host.startsWith('[') && host.endsWith(']'))
+    {
+        host = host.mid(1, host.size() - 2);
+    }
+    bool          ok   = false;
+    const quint16 port = target.mid(colon + 1).toUShort(&ok);
+    if(host.isEmpty() || !ok || port == 0)
+    {
+        return std::nullopt;
+    }
+    return std::make_pair(host, port);
+}
+
+/// Returns the JSON object sent for frame
+QByteArray LivePublisher::datagram(int frame, double latency, const std::vector<LivePosition> &positions)
+{
+    QJsonArray persons;
+    for(const auto &position : positions)
+    {
+        persons.append(QJsonObject{
+            {"id", position.id},
+            {"x", position.world.x()},
+            {"y", position.world.y()},
+            {"px", position.pixel.x()},
+            {"py", position.pixel.y()}});
+    }
+    const QJsonObject json{{"frame", frame}, {"latency", latency}, {"persons", persons}};
+    return QJsonDocument(json).toJson(QJsonDocument::Compact);
+}
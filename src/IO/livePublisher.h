@@ -0,0 +1,69 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIVEPUBLISHER_H
+#define LIVEPUBLISHER_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QPointF>
+#include <QString>
+#include <QUdpSocket>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/// Position of a person in the current frame of a live stream
+struct LivePosition
+{
+    int     id; ///< number of the person as in the exported trajectories (starting at 1)
+    QPointF pixel;
+    QPointF world; ///< in cm
+};
+
+/**
+ * @brief Sends the positions of the persons in each frame of a live stream as UDP datagram
+ *
+ * Every processed frame is sent as one compact JSON object, without waiting for any
+ * receiver, so slow or missing receivers never delay the tracking:
+ *
+ *     {"frame": 42, "latency": 23.5, "persons": [{"id": 1, "x": 120.5, "y": -33.0, "px": 640.2, "py": 380.7}]}
+ *
+ * x and y are the world coordinates in cm, px and py the pixel coordinates and latency
+ * the time from the capture to the end of the processing of the frame in ms.
+ */
+class LivePublisher
+{
+public:
+    bool           setTarget(const QString &target);
+    const QString &getTarget() const { return mTarget; }
+    bool           isEnabled() const { return mPort != 0; }
+
+    void publish(int frame, double latency, const std::vector<LivePosition> &positions);
+
+    static std::optional<std::pair<QString, quint16>> parseTarget(const QString &target);
+    static QByteArray datagram(int frame, double latency, const std::vector<LivePosition> &positions);
+
+private:
+    QUdpSocket   mSocket;
+    QString      mTarget;
+    QHostAddress mHost;
+    quint16      mPort = 0; ///< 0 while no target is set
+};
+
+#endif // LIVEPUBLISHER_H
@@ -0,0 +1,218 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "liveSharedMemory.h"
+
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace
+{
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared counters need lock free atomics");
+static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t), "shared counters need plain layout");
+
+constexpr std::size_t VERSION_OFFSET     = 8;
+constexpr std::size_t SLOTS_OFFSET       = 12;
+constexpr std::size_t MAX_PERSONS_OFFSET = 16;
+constexpr std::size_t SLOT_SIZE_OFFSET   = 20;
+constexpr std::size_t WRITTEN_OFFSET     = 24;
+constexpr int         READ_ATTEMPTS      = 16; ///< a reader gives up, if the writer overtakes it this often
+
+std::atomic<std::uint64_t> &counterAt(uchar *memory, std::size_t offset)
+{
+    return *reinterpret_cast<std::atomic<std::uint64_t> *>(memory + offset);
+}
+
+const std::atomic<std::uint64_t> &counterAt(const uchar *memory, std::size_t offset)
+{
+    return *reinterpret_cast<const std::atomic<std::uint64_t> *>(memory + offset);
+}
+
+template <typename T>
+void put(uchar *memory, std::size_t offset, T value)
+{
+    std::memcpy(memory + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const uchar *memory, std::size_t offset)
+{
+    T value;
+    std::memcpy(&value, memory + offset, sizeof(T));
+    return value;
+}
+} // namespace
+
+LiveSharedMemory::~LiveSharedMemory()
+{
+    close();
+}
+
+/**
+ * @brief Creates the ring buffer in fileName (e.g. /dev/shm/petrack_live); an empty fileName stops publishing
+ *
+ * An existing file is overwritten.
+ *
+ * @return false, if the file could not be created or mapped
+ */
+bool LiveSharedMemory::open(const QString &fileName, int slots, int maxPersons)
+{
+    close();
+    mFileName = fileName;
+    if(fileName.isEmpty())
+    {
+        return true;
+    }
+
+    mSlots      = static_cast<std::uint32_t>(std::max(slots, 1));
+    mMaxPersons = static_cast<std::uint32_t>(std::max(maxPersons, 1));
+    // slots start at multiples of 8, so the sequence of every slot is aligned
+    mSlotSize         = static_cast<std::uint32_t>((SLOT_HEADER_SIZE + mMaxPersons * RECORD_SIZE + 7) / 8 * 8);
+    const qint64 size = static_cast<qint64>(HEADER_SIZE) + static_cast<qint64>(mSlots) * mSlotSize;
+
+    mFile.setFileName(fileName);
+    if(!mFile.open(QIODevice::ReadWrite | QIODevice::Truncate) || !mFile.resize(size))
+    {
+        SPDLOG_ERROR("Could not create the live shared memory {}: {}", fileName, mFile.errorString());
+        close();
+        return false;
+    }
+    mMemory = mFile.map(0, size);
+    if(!mMemory)
+    {
+        SPDLOG_ERROR("Could not map the live shared memory {}: {}", fileName, mFile.errorString());
+        close();
+        return false;
+    }
+
+    std::memset(mMemory, 0, static_cast<std::size_t>(size));
+    std::memcpy(mMemory, MAGIC, sizeof(MAGIC));
+    put(mMemory, VERSION_OFFSET, VERSION);
+    put(mMemory, SLOTS_OFFSET, mSlots);
+    put(mMemory, MAX_PERSONS_OFFSET, mMaxPersons);
+    put(mMemory, SLOT_SIZE_OFFSET, mSlotSize);
+    counterAt(mMemory, WRITTEN_OFFSET).store(0, std::memory_order_release);
+    SPDLOG_INFO("Publishing live positions to the shared memory {}.", fileName);
+    return true;
+}
+
+/// Unmaps the ring buffer; the file stays, so readers can still read the last frames
+void LiveSharedMemory::close()
+{
+    if(mMemory)
+    {
+        mFile.unmap(mMemory);
+        mMemory = nullptr;
+    }
+    mFile.close();
+    mFileName.clear();
+}
+
+/**
+ * @brief Writes the positions of frame into the next slot, if the ring buffer is open
+ *
+ * Never waits for readers; readers of the overwritten slot notice it by its sequence.
+ */
+void LiveSharedMemory::publish(int frame, double latency, const std::vector<LivePosition> &positions)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+    auto               &written = counterAt(mMemory, WRITTEN_OFFSET);
+    const std::uint64_t count   = written.load(std::memory_order_relaxed);
+    uchar              *slot    = mMemory + HEADER_SIZE + (count % mSlots) * mSlotSize;
+
+    auto               &sequence = counterAt(slot, 0);
+    const std::uint64_t before   = sequence.load(std::memory_order_relaxed);
+    sequence.store(before + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto persons = static_cast<std::uint32_t>(std::min<std::size_t>(positions.size(), mMaxPersons));
+    put(slot, 8, static_cast<std::int32_t>(frame));
+    put(slot, 12, static_cast<std::int32_t>(persons));
+    put(slot, 16, latency);
+    uchar *record = slot + SLOT_HEADER_SIZE;
+    for(std::uint32_t i = 0; i < persons; ++i, record += RECORD_SIZE)
+    {
+        const LivePosition &position = positions[i];
+        put(record, 0, static_cast<std::int32_t>(position.id));
+        put(record, 4, static_cast<float>(position.pixel.x()));
+        put(record, 8, static_cast<float>(position.pixel.y()));
+        put(record, 12, static_cast<float>(position.world.x()));
+        put(record, 16, static_cast<float>(position.world.y()));
+    }
+
+    sequence.store(before + 2, std::memory_order_release);
+    written.store(count + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Reads the newest frame from the mapped ring buffer memory like an external reader does
+ *
+ * @return std::nullopt, if memory is no ring buffer, nothing was written yet or the writer kept
+ * overtaking the reader
+ */
+std::optional<LiveFrame> LiveSharedMemory::readLatest(const uchar *memory)
+{
+    if(std::memcmp(memory, MAGIC, sizeof(MAGIC)) != 0 || get<std::uint32_t>(memory, VERSION_OFFSET) != VERSION)
+    {
+        return std::nullopt;
+    }
+    const auto slots      = get<std::uint32_t>(memory, SLOTS_OFFSET);
+    const auto maxPersons = get<std::uint32_t>(memory, MAX_PERSONS_OFFSET);
+    const auto slotSize   = get<std::uint32_t>(memory, SLOT_SIZE_OFFSET);
+
+    for(int attempt = 0; attempt < READ_ATTEMPTS; ++attempt)
+    {
+        const std::uint64_t count = counterAt(memory, WRITTEN_OFFSET).load(std::memory_order_acquire);
+        if(count == 0)
+        {
+            return std::nullopt;
+        }
+        const uchar        *slot     = memory + HEADER_SIZE + ((count - 1) % slots) * slotSize;
+        const auto         &sequence = counterAt(slot, 0);
+        const std::uint64_t before   = sequence.load(std::memory_order_acquire);
+        if(before % 2 != 0)
+        {
+            continue;
+        }
+
+        LiveFrame  result{get<std::int32_t>(slot, 8), get<double>(slot, 16), {}};
+        const auto persons = std::min(static_cast<std::uint32_t>(get<std::int32_t>(slot, 12)), maxPersons);
+        result.positions.reserve(persons);
+        const uchar *record = slot + SLOT_HEADER_SIZE;
+        for(std::uint32_t i = 0; i < persons; ++i, record += RECORD_SIZE)
+        {
+            result.positions.push_back(
+                {get<std::int32_t>(record, 0),
+                 QPointF(get<float>(record, 4), get<float>(record, 8)),
+                 QPointF(get<float>(record, 12), get<float>(record, 16))});
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(sequence.load(std::memory_order_relaxed) == before)
+        {
+            return result;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,98 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIVESHAREDMEMORY_H
+#define LIVESHAREDMEMORY_H
+
+#include "livePublisher.h"
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/// Frame as read back from the ring buffer of LiveSharedMemory
+struct LiveFrame
+{
+    int                       frame;
+    double                    latency; ///< in ms
+    std::vector<LivePosition> positions;
+};
+
+/**
+ * @brief Writes the positions of the persons in each frame of a live stream into a memory mapped ring buffer
+ *
+ * The buffer is a file mapped into memory; in /dev/shm (e.g. /dev/shm/petrack_live) it is POSIX shared
+ * memory without any disk access. Readers map the same file, e.g. with numpy.memmap or mmap, and never
+ * block PeTrack: there is exactly one writer and no lock.
+ *
+ * Layout (little endian, offsets in bytes):
+ *
+ *     header (64 bytes)
+ *         0  char[8]  magic "PETLIVE" (zero terminated)
+ *         8  uint32   version (1)
+ *        12  uint32   number of slots
+ *        16  uint32   maximum number of persons per slot
+ *        20  uint32   size of one slot
+ *        24  uint64   number of frames written so far; the newest frame is in slot (written - 1) % slots
+ *     slot i at 64 + i * slot size
+ *         0  uint64   sequence: odd while the slot is written, afterwards even
+ *         8  int32    frame
+ *        12  int32    number of persons n (at most the maximum, further persons are left out)
+ *        16  float64  latency in ms from the capture to the end of the processing
+ *        24  n records of 20 bytes: int32 id, float32 px, py (pixel), float32 x, y (cm)
+ *
+ * A reader copies a slot and accepts the copy only, if the sequence was even and did not change
+ * meanwhile (see readLatest()); otherwise the writer has overtaken it and it reads again.
+ */
+class LiveSharedMemory
+{
+public:
+    static constexpr char          MAGIC[8]         = "PETLIVE";
+    static constexpr std::uint32_t VERSION          = 1;
+    static constexpr std::size_t   HEADER_SIZE      = 64;
+    static constexpr std::size_t   SLOT_HEADER_SIZE = 24;
+    static constexpr std::size_t   RECORD_SIZE      = 20;
+    static constexpr int           DEFAULT_SLOTS    = 64;
+    static constexpr int           DEFAULT_PERSONS  = 1024;
+
+    LiveSharedMemory() = default;
+    ~LiveSharedMemory();
+    LiveSharedMemory(const LiveSharedMemory &)            = delete;
+    LiveSharedMemory &operator=(const LiveSharedMemory &) = delete;
+
+    bool open(const QString &fileName, int slots = DEFAULT_SLOTS, int maxPersons = DEFAULT_PERSONS);
+    void close();
+    const QString &getFileName() const { return mFileName; }
+    bool           isEnabled() const { return mMemory != nullptr; }
+
+    void publish(int frame, double latency, const std::vector<LivePosition> &positions);
+
+    static std::optional<LiveFrame> readLatest(const uchar *memory);
+
+private:
+    QString       mFileName;
+    QFile         mFile;
+    uchar        *mMemory     = nullptr;
+    std::uint32_t mSlots      = 0;
+    std::uint32_t mMaxPersons = 0;
+    std::uint32_t mSlotSize   = 0;
+};
+
+#endif // LIVESHAREDMEMORY_H
@@ -0,0 +1,300 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mezzanineVideo.h"
+
+#include "logger.h"
+#include "videoDecoder.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+MezzanineVideo::~MezzanineVideo()
+{
+    stop();
+}
+
+QString MezzanineVideo::listName(const QString &videoFile)
+{
+    return videoFile + ".mezzanine.vlist";
+}
+
+/**
+ * @brief Splits the frames from firstFrame to lastFrame into at most maxChunks ranges of about equal length
+ *
+ * @return first and last frame of every chunk
+ */
+std::vector<std::pair<int, int>> MezzanineVideo::chunks(int firstFrame, int lastFrame, int maxChunks)
+{
+    const int numFrames = lastFrame - firstFrame + 1;
+    if(numFrames <= 0)
+    {
+        return {};
+    }
+    const int numChunks = std::clamp(numFrames / MIN_CHUNK_FRAMES, 1, std::max(maxChunks, 1));
+
+    std::vector<std::pair<int, int>> ranges;
+    for(int i = 0; i < numChunks; ++i)
+    {
+        const int first = firstFrame + static_cast<int>(static_cast<long long>(numFrames) * i / numChunks);
+        const int last  = firstFrame + static_cast<int>(static_cast<long long>(numFrames) * (i + 1) / numChunks) - 1;
+        ranges.emplace_back(first, last);
+    }
+    return ranges;
+}
+
+/**
+ * @brief Uses an existing mezzanine of the video or starts creating it in the background
+ *
+ * Does nothing, if the mezzanine of the same frames and crop is already used or created.
+ *
+ * @param videoFile original video
+ * @param firstFrame first frame of the video copied into the mezzanine
+ * @param lastFrame last frame of the video copied into the mezzanine
+ * @param crop part of the frames stored in the mezzanine; empty for the whole frame
+ * @param acceleration hardware acceleration for decoding the original video
+ */
+void MezzanineVideo::start(
+    const QString            &videoFile,
+    int                       firstFrame,
+    int                       lastFrame,
+    const cv::Rect           &crop,
+    cv::VideoAccelerationType acceleration)
+{
+    if(videoFile == mVideoFile && firstFrame == mFirstFrame && lastFrame == mLastFrame && crop == mCrop)
+    {
+        return;
+    }
+    stop();
+    mVideoFile  = videoFile;
+    mFirstFrame = firstFrame;
+    mLastFrame  = lastFrame;
+    mCrop       = crop;
+    mAbort      = false;
+
+    const QFileInfo listInfo(listName(videoFile));
+    if(listInfo.exists() && listInfo.lastModified() >= QFileInfo(videoFile).lastModified() && openMezzanine())
+    {
+        return;
+    }
+    SPDLOG_INFO(
+        "Creating all-intra copy of frames {} to {} of {} in the background.", firstFrame, lastFrame, videoFile);
+    mCreation = QtConcurrent::run([this, videoFile, firstFrame, lastFrame, crop, acceleration]()
+                                  { return create(videoFile, firstFrame, lastFrame, crop, acceleration, mAbort); });
+}
+
+void MezzanineVideo::stop()
+{
+    mAbort = true;
+    mCreation.waitForFinished();
+    mCreation = QFuture<bool>();
+    mChunks.close();
+    mVideoFile.clear();
+}
+
+/**
+ * @brief Returns, if frames can be read from the mezzanine
+ */
+bool MezzanineVideo::isReady()
+{
+    if(mChunks.isOpen())
+    {
+        return true;
+    }
+    if(mVideoFile.isEmpty() || !mCreation.isFinished() || mCreation.resultCount() == 0)
+    {
+        return false;
+    }
+    const bool created = mCreation.result();
+    mCreation          = QFuture<bool>();
+    return created && openMezzanine();
+}
+
+/**
+ * @brief Reads frame of the original video from the mezzanine
+ *
+ * @param fullSize size of the frames of the original video
+ * @return false, if the mezzanine is not available (yet) or does not contain frame
+ */
+bool MezzanineVideo::read(int frame, cv::Mat &img, const cv::Size &fullSize)
+{
+    if(frame < mFirstFrame || frame > mLastFrame || !isReady())
+    {
+        return false;
+    }
+    if(mCrop.empty())
+    {
+        return mChunks.read(frame - mFirstFrame, img);
+    }
+    cv::Mat cropImg;
+    if(!mChunks.read(frame - mFirstFrame, cropImg))
+    {
+        return false;
+    }
+    img = cv::Mat::zeros(fullSize, cropImg.type());
+    cropImg.copyTo(img(mCrop));
+    return true;
+}
+
+/// First line of the list of chunks, identifying the frames and the crop they contain
+QString MezzanineVideo::header(int firstFrame, int lastFrame, const cv::Rect &crop)
+{
+    return QString("# mezzanine of frames %1 to %2, crop %3 %4 %5 %6")
+        .arg(firstFrame)
+        .arg(lastFrame)
+        .arg(crop.x)
+        .arg(crop.y)
+        .arg(crop.width)
+        .arg(crop.height);
+}
+
+bool MezzanineVideo::openMezzanine()
+{
+    const QString name = listName(mVideoFile);
+    QFile         file(name);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text) ||
+       QTextStream(&file).readLine() != header(mFirstFrame, mLastFrame, mCrop))
+    {
+        // made for other frames or another crop
+        return false;
+    }
+    file.close();
+
+    const auto chunkFiles = VideoSegments::readList(name);
+    if(!chunkFiles || !mChunks.open(*chunkFiles, cv::VIDEO_ACCELERATION_NONE))
+    {
+        return false;
+    }
+    if(mChunks.getNumFrames() != mLastFrame - mFirstFrame + 1)
+    {
+        SPDLOG_WARN("All-intra copy {} is incomplete and is not used.", name);
+        mChunks.close();
+        return false;
+    }
+    SPDLOG_INFO("Using all-intra copy {} of frames {} to {}.", name, mFirstFrame, mLastFrame);
+    return true;
+}
+
+/**
+ * @brief Writes the chunks and their list (run in a background thread)
+ *
+ * The chunks are written concurrently, each one by its own decoder. The list is only
+ * written, if all chunks are complete; otherwise the chunks are removed again.
+ */
+bool MezzanineVideo::create(
+    const QString            &videoFile,
+    int                       firstFrame,
+    int                       lastFrame,
+    const cv::Rect           &crop,
+    cv::VideoAccelerationType acceleration,
+    const std::atomic_bool   &abort)
+{
+    const auto  ranges = chunks(firstFrame, lastFrame, QThread::idealThreadCount());
+    QStringList chunkFiles;
+    for(std::size_t i = 0; i < ranges.size(); ++i)
+    {
+        chunkFiles << QString("%1.mezzanine.%2.avi").arg(videoFile).arg(i);
+    }
+    QFile::remove(listName(videoFile));
+
+    std::vector<QFuture<bool>> jobs;
+    for(std::size_t i = 0; i < ranges.size(); ++i)
+    {
+        jobs.push_back(QtConcurrent::run(
+            [&, i]() { return writeChunk(videoFile, chunkFiles[i], ranges[i], crop, acceleration, abort); }));
+    }
+    bool ok = true;
+    for(auto &job : jobs)
+    {
+        ok = job.result() && ok;
+    }
+
+    if(ok && !abort)
+    {
+        QFile list(listName(videoFile));
+        if(list.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            QTextStream stream(&list);
+            stream << header(firstFrame, lastFrame, crop) << '\n';
+            for(const auto &chunkFile : chunkFiles)
+            {
+                stream << QFileInfo(chunkFile).fileName() << '\n';
+            }
+            return true;
+        }
+        SPDLOG_WARN("Could not write {}.", listName(videoFile));
+    }
+    for(const auto &chunkFile : chunkFiles)
+    {
+        QFile::remove(chunkFile);
+    }
+    return false;
+}
+
+/// Copies the frames of range of videoFile into chunkFile
+bool MezzanineVideo::writeChunk(
+    const QString            &videoFile,
+    const QString            &chunkFile,
+    std::pair<int, int>       range,
+    const cv::Rect           &crop,
+    cv::VideoAccelerationType acceleration,
+    const std::atomic_bool   &abort)
+{
+    cv::VideoCapture capture;
+    if(!videoDecoder::open(capture, videoFile.toStdString(), acceleration) ||
+       !capture.set(cv::CAP_PROP_POS_FRAMES, range.first))
+    {
+        SPDLOG_WARN("Could not decode {} from frame {} on.", videoFile, range.first);
+        return false;
+    }
+    const double   fps = capture.get(cv::CAP_PROP_FPS) > 0 ? capture.get(cv::CAP_PROP_FPS) : 25.;
+    const cv::Size size =
+        crop.empty() ? cv::Size(
+                           static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+                           static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT))) :
+                       crop.size();
+
+    // lossless, so tracking on the mezzanine gives the same results as on the original
+    cv::VideoWriter writer(chunkFile.toStdString(), cv::VideoWriter::fourcc('F', 'F', 'V', '1'), fps, size);
+    if(!writer.isOpened())
+    {
+        writer.open(chunkFile.toStdString(), cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, size);
+        writer.set(cv::VIDEOWRITER_PROP_QUALITY, 100);
+    }
+    if(!writer.isOpened())
+    {
+        SPDLOG_WARN("Could not create {}.", chunkFile);
+        return false;
+    }
+
+    cv::Mat frame;
+    for(int i = range.first; i <= range.second; ++i)
+    {
+        if(abort || !capture.read(frame) || frame.empty())
+        {
+            return false;
+        }
+        writer.write(crop.empty() ? frame : frame(crop));
+    }
+    return true;
+}
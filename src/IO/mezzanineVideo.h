@@ -0,0 +1,102 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEZZANINEVIDEO_H
+#define MEZZANINEVIDEO_H
+
+#include "videoSegments.h"
+
+#include <QFuture>
+#include <QString>
+#include <atomic>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief All-intra copy of the working range of a video for fast random access
+ *
+ * Long-GOP videos (H.264, H.265) have to be decoded from the last keyframe for every
+ * seek, which makes backward tracking and jumping through the video slow. The mezzanine
+ * is a lossless copy (FFV1, MJPG if FFV1 is not available) of the frames from firstFrame
+ * to lastFrame in full resolution, in which every frame is decoded independently.
+ *
+ * It is written in the background in chunks of consecutive frames, one thread per chunk,
+ * next to the video (<video>.mezzanine.<n>.avi). The list of the chunks
+ * (<video>.mezzanine.vlist) is written last and marks the mezzanine as complete.
+ *
+ * Optionally only a crop of the frames is stored; read() then fills the rest of the frame
+ * with black, so all coordinates stay valid.
+ */
+class MezzanineVideo
+{
+public:
+    /// chunks are not made smaller than this, so the seeking at their start does not dominate
+    static constexpr int MIN_CHUNK_FRAMES = 250;
+
+    MezzanineVideo() = default;
+    ~MezzanineVideo();
+
+    MezzanineVideo(const MezzanineVideo &)            = delete;
+    MezzanineVideo &operator=(const MezzanineVideo &) = delete;
+
+    static QString listName(const QString &videoFile);
+    static std::vector<std::pair<int, int>> chunks(int firstFrame, int lastFrame, int maxChunks);
+
+    void start(
+        const QString            &videoFile,
+        int                       firstFrame,
+        int                       lastFrame,
+        const cv::Rect           &crop,
+        cv::VideoAccelerationType acceleration);
+    void stop();
+
+    bool isReady();
+    bool read(int frame, cv::Mat &img, const cv::Size &fullSize);
+
+private:
+    static QString header(int firstFrame, int lastFrame, const cv::Rect &crop);
+
+    static bool create(
+        const QString            &videoFile,
+        int                       firstFrame,
+        int                       lastFrame,
+        const cv::Rect           &crop,
+        cv::VideoAccelerationType acceleration,
+        const std::atomic_bool   &abort);
+    static bool writeChunk(
+        const QString            &videoFile,
+        const QString            &chunkFile,
+        std::pair<int, int>       range,
+        const cv::Rect           &crop,
+        cv::VideoAccelerationType acceleration,
+        const std::atomic_bool   &abort);
+
+    bool openMezzanine();
+
+    QString          mVideoFile;
+    int              mFirstFrame = 0;
+    int              mLastFrame  = -1;
+    cv::Rect         mCrop; ///< stored part of the frames; empty for the whole frame
+    VideoSegments    mChunks;
+    QFuture<bool>    mCreation;
+    std::atomic_bool mAbort{false};
+};
+
+#endif // MEZZANINEVIDEO_H
@@ -172,6 +172,11 @@ double MoCapPersonMetadata::getUserTimeOffset() const
     return mUserTimeOffset;
 }
 
+double MoCapPersonMetadata::getFileTimeOffset() const
+{
+    return mFileTimeOffset;
+}
+
 bool operator==(const MoCapPersonMetadata &lhs, const MoCapPersonMetadata &rhs)
 {
     return (
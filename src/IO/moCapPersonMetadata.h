@@ -70,6 +70,7 @@ public:
     double              getSamplerate() const;
     double              getOffset() const;
     double              getUserTimeOffset() const;
+    double              getFileTimeOffset() const;
     const std::string  &getFilepath() const;
     bool                isVisible() const;
     void                setVisible(bool newVisible);
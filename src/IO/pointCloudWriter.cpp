@@ -0,0 +1,205 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pointCloudWriter.h"
+
+#include "logger.h"
+
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr std::size_t POINT_BYTES = 3 * sizeof(float) + 1 + sizeof(qint32);
+
+char *appendFloat(char *out, float value)
+{
+    quint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian(bits, out);
+    return out + sizeof(bits);
+}
+} // namespace
+
+/**
+ * @param maxPendingFrames number of frames, which may wait for the worker, before write() blocks
+ */
+PointCloudWriter::PointCloudWriter(std::size_t maxPendingFrames) :
+    mMaxPendingFrames(std::max<std::size_t>(1, maxPendingFrames))
+{
+}
+
+PointCloudWriter::~PointCloudWriter()
+{
+    finish();
+}
+
+/**
+ * @brief Creates fileName, writes the PLY header and starts the worker
+ *
+ * @param fileName destination file, which is overwritten
+ * @return true, if the file could be created
+ */
+bool PointCloudWriter::open(const QString &fileName)
+{
+    finish();
+
+    mFile.setFileName(fileName);
+    if(!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        mError = mFile.errorString();
+        return false;
+    }
+
+    QByteArray header = "ply\n"
+                        "format binary_little_endian 1.0\n"
+                        "comment point clouds of a sequence exported by PeTrack\n"
+                        "element vertex ";
+
+    mVertexCountPos = header.size();
+    header += QByteArray(vertexCountWidth, '0');
+    header += "\n"
+              "property float x\n"
+              "property float y\n"
+              "property float z\n"
+              "property uchar intensity\n"
+              "property int frame\n"
+              "end_header\n";
+    if(mFile.write(header) != header.size())
+    {
+        mError = mFile.errorString();
+        mFile.close();
+        return false;
+    }
+
+    mPending.clear();
+    mNumPoints = 0;
+    mFinish    = false;
+    mError.clear();
+    mWorker = std::thread(&PointCloudWriter::run, this);
+    return true;
+}
+
+/**
+ * @brief Queues the cloud of frame to be written
+ *
+ * Blocks while too many frames are pending.
+ *
+ * @param frame frame number stored with every point
+ * @param points points of the frame in the coordinate system of the stereo camera
+ * @return false, if writing one of the former frames failed (see getErrorString())
+ */
+bool PointCloudWriter::write(int frame, std::vector<Point> points)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    if(!mWorker.joinable())
+    {
+        return false;
+    }
+    mSpaceReady.wait(lock, [this] { return mPending.size() < mMaxPendingFrames || !mError.isEmpty(); });
+    if(!mError.isEmpty())
+    {
+        return false;
+    }
+    mPending.push_back({frame, std::move(points)});
+    lock.unlock();
+    mFrameReady.notify_one();
+    return true;
+}
+
+/**
+ * @brief Waits until all queued frames are written, fills in the number of points and closes the file
+ *
+ * @return false, if any frame could not be written (see getErrorString())
+ */
+bool PointCloudWriter::finish()
+{
+    if(!mWorker.joinable())
+    {
+        return mError.isEmpty();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFinish = true;
+    }
+    mFrameReady.notify_one();
+    mWorker.join();
+
+    const QByteArray count = QByteArray::number(static_cast<qulonglong>(mNumPoints))
+                                 .rightJustified(vertexCountWidth, '0');
+    if(mError.isEmpty() && (!mFile.seek(mVertexCountPos) || mFile.write(count) != count.size() || !mFile.flush()))
+    {
+        mError = mFile.errorString();
+    }
+    mFile.close();
+    if(!mError.isEmpty())
+    {
+        SPDLOG_WARN("Could not write point cloud {}: {}", mFile.fileName(), mError);
+    }
+    return mError.isEmpty();
+}
+
+QString PointCloudWriter::getErrorString() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mError;
+}
+
+void PointCloudWriter::run()
+{
+    QByteArray buffer;
+    while(true)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mFrameReady.wait(lock, [this] { return !mPending.empty() || mFinish; });
+            if(mPending.empty())
+            {
+                break;
+            }
+            frame = std::move(mPending.front());
+            mPending.pop_front();
+        }
+        mSpaceReady.notify_one();
+
+        // encode without holding the lock, so the caller can queue the next frames meanwhile
+        buffer.resize(static_cast<int>(frame.points.size() * POINT_BYTES));
+        char *out = buffer.data();
+        for(const auto &point : frame.points)
+        {
+            out    = appendFloat(out, point.x);
+            out    = appendFloat(out, point.y);
+            out    = appendFloat(out, point.z);
+            *out++ = static_cast<char>(point.gray);
+            qToLittleEndian(static_cast<qint32>(frame.frame), out);
+            out += sizeof(qint32);
+        }
+
+        if(mFile.write(buffer) != buffer.size())
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mError = mFile.errorString();
+            mPending.clear();
+            mSpaceReady.notify_all();
+            break;
+        }
+        mNumPoints += frame.points.size();
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef POINTCLOUDWRITER_H
+#define POINTCLOUDWRITER_H
+
+#include <QFile>
+#include <QString>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Writes the point clouds of a whole sequence into one binary PLY file
+ *
+ * All frames are vertices of the same PLY element; the frame number is a
+ * property of each vertex, so any PLY reader can load the file and split it
+ * into frames. The number of vertices is only known at the end, so the header
+ * reserves a fixed width for it, which is filled in by finish().
+ *
+ * The point clouds are handed over in sequence order and are encoded and
+ * written by a worker thread. The number of pending frames is bounded, so
+ * write() blocks, if the disk is slower than the computation of the clouds.
+ */
+class PointCloudWriter
+{
+public:
+    struct Point
+    {
+        float         x;
+        float         y;
+        float         z;
+        unsigned char gray;
+    };
+
+    explicit PointCloudWriter(std::size_t maxPendingFrames = 8);
+    ~PointCloudWriter();
+
+    PointCloudWriter(const PointCloudWriter &)            = delete;
+    PointCloudWriter &operator=(const PointCloudWriter &) = delete;
+
+    bool open(const QString &fileName);
+    bool write(int frame, std::vector<Point> points);
+    bool finish();
+
+    bool          isOpen() const { return mFile.isOpen(); }
+    std::uint64_t getNumPoints() const { return mNumPoints; } ///< only valid after finish()
+    /// description of the first error, empty if writing succeeded so far
+    QString getErrorString() const;
+
+private:
+    struct Frame
+    {
+        int                frame;
+        std::vector<Point> points;
+    };
+
+    void run();
+
+    static constexpr int vertexCountWidth = 20; ///< digits reserved in the header for the number of vertices
+
+    const std::size_t mMaxPendingFrames;
+    QFile             mFile;
+    qint64            mVertexCountPos = 0; ///< position of the number of vertices in the header
+    std::uint64_t     mNumPoints      = 0; ///< points written by the worker
+    std::thread       mWorker;
+
+    mutable std::mutex      mMutex;
+    std::condition_variable mFrameReady; ///< signaled by the caller if a frame was added or writing finished
+    std::condition_variable mSpaceReady; ///< signaled by the worker if a frame was written
+    std::deque<Frame>       mPending;
+    bool                    mFinish = false;
+    QString                 mError;
+};
+
+#endif // POINTCLOUDWRITER_H
@@ -0,0 +1,178 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "proxyVideo.h"
+
+#include "logger.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+ProxyVideo::~ProxyVideo()
+{
+    stop();
+}
+
+QString ProxyVideo::proxyName(const QString &videoFile)
+{
+    return videoFile + ".proxy.avi";
+}
+
+/**
+ * @brief Uses an existing proxy of the video or starts creating it in the background
+ *
+ * @param videoFile original video
+ * @param numFrames number of frames of the original video
+ * @param scale the proxy has 1/scale of the width and height of the original
+ */
+void ProxyVideo::start(const QString &videoFile, int numFrames, int scale)
+{
+    stop();
+    mVideoFile = videoFile;
+    mNumFrames = numFrames;
+    mAbort     = false;
+
+    const QFileInfo proxyInfo(proxyName(videoFile));
+    if(proxyInfo.exists() && proxyInfo.lastModified() >= QFileInfo(videoFile).lastModified() && openProxy())
+    {
+        return;
+    }
+    SPDLOG_INFO("Creating proxy video {} in the background.", proxyInfo.filePath());
+    mCreation = QtConcurrent::run([this, videoFile, scale]() { return create(videoFile, scale, mAbort); });
+}
+
+void ProxyVideo::stop()
+{
+    mAbort = true;
+    mCreation.waitForFinished();
+    mCreation = QFuture<bool>();
+    mCapture.release();
+    mNextFrame = -1;
+    mVideoFile.clear();
+}
+
+/**
+ * @brief Returns, if frames can be read from the proxy
+ */
+bool ProxyVideo::isReady()
+{
+    if(mCapture.isOpened())
+    {
+        return true;
+    }
+    if(mVideoFile.isEmpty() || !mCreation.isFinished() || mCreation.resultCount() == 0)
+    {
+        return false;
+    }
+    const bool created = mCreation.result();
+    mCreation          = QFuture<bool>();
+    return created && openProxy();
+}
+
+/**
+ * @brief Reads the frame from the proxy and scales it to the size of the original video
+ *
+ * @return false, if the proxy is not available (yet) or the frame could not be read
+ */
+bool ProxyVideo::read(int frame, cv::Mat &img, const cv::Size &fullSize)
+{
+    if(!isReady() || frame < 0 || frame >= mNumFrames)
+    {
+        return false;
+    }
+    // every frame of the proxy is a keyframe, so seeking is cheap
+    if(frame != mNextFrame && !mCapture.set(cv::CAP_PROP_POS_FRAMES, frame))
+    {
+        return false;
+    }
+    cv::Mat small;
+    if(!mCapture.read(small) || small.empty())
+    {
+        mNextFrame = -1;
+        return false;
+    }
+    mNextFrame = frame + 1;
+    cv::resize(small, img, fullSize, 0, 0, cv::INTER_LINEAR);
+    return true;
+}
+
+bool ProxyVideo::openProxy()
+{
+    const QString name = proxyName(mVideoFile);
+    if(!mCapture.open(name.toStdString()))
+    {
+        return false;
+    }
+    if(static_cast<int>(mCapture.get(cv::CAP_PROP_FRAME_COUNT)) < mNumFrames)
+    {
+        SPDLOG_WARN("Proxy video {} is incomplete and is not used.", name);
+        mCapture.release();
+        return false;
+    }
+    mNextFrame = 0;
+    SPDLOG_INFO("Using proxy video {} for playback.", name);
+    return true;
+}
+
+/**
+ * @brief Writes the downscaled proxy of videoFile (run in a background thread)
+ *
+ * The proxy is written to a temporary file first, so an aborted creation does
+ * not leave a broken proxy.
+ */
+bool ProxyVideo::create(const QString &videoFile, int scale, const std::atomic_bool &abort)
+{
+    cv::VideoCapture capture(videoFile.toStdString());
+    if(!capture.isOpened())
+    {
+        return false;
+    }
+
+    const double   fps  = capture.get(cv::CAP_PROP_FPS) > 0 ? capture.get(cv::CAP_PROP_FPS) : 25.;
+    const cv::Size size = cv::Size(
+        std::max(1, static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH)) / scale) & -2,
+        std::max(1, static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT)) / scale) & -2);
+    const QString   partName = proxyName(videoFile) + ".part";
+    cv::VideoWriter writer(partName.toStdString(), cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, size);
+    if(!writer.isOpened())
+    {
+        SPDLOG_WARN("Could not create proxy video {}.", partName);
+        return false;
+    }
+
+    cv::Mat frame;
+    cv::Mat small;
+    while(!abort && capture.read(frame))
+    {
+        cv::resize(frame, small, size, 0, 0, cv::INTER_AREA);
+        writer.write(small);
+    }
+    writer.release();
+
+    if(abort)
+    {
+        QFile::remove(partName);
+        return false;
+    }
+    QFile::remove(proxyName(videoFile));
+    return QFile::rename(partName, proxyName(videoFile));
+}
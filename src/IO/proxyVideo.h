@@ -0,0 +1,65 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROXYVIDEO_H
+#define PROXYVIDEO_H
+
+#include <QFuture>
+#include <QString>
+#include <atomic>
+#include <opencv2/videoio.hpp>
+
+/**
+ * @brief Low resolution copy of a video for interactive playback
+ *
+ * The proxy is an intra-only (MJPG) video with a fraction of the resolution
+ * of the original video, stored next to it (<video>.proxy.avi). It is created
+ * once in the background. Frames read from the proxy are scaled up to the
+ * size of the original, so all coordinates stay valid; they are only meant to
+ * be viewed, not for tracking or recognition.
+ */
+class ProxyVideo
+{
+public:
+    ProxyVideo() = default;
+    ~ProxyVideo();
+
+    ProxyVideo(const ProxyVideo &)            = delete;
+    ProxyVideo &operator=(const ProxyVideo &) = delete;
+
+    static QString proxyName(const QString &videoFile);
+
+    void start(const QString &videoFile, int numFrames, int scale);
+    void stop();
+
+    bool isReady();
+    bool read(int frame, cv::Mat &img, const cv::Size &fullSize);
+
+private:
+    static bool create(const QString &videoFile, int scale, const std::atomic_bool &abort);
+    bool        openProxy();
+
+    QString          mVideoFile;
+    int              mNumFrames = 0;
+    cv::VideoCapture mCapture;
+    int              mNextFrame = -1; ///< frame read next by mCapture
+    QFuture<bool>    mCreation;
+    std::atomic_bool mAbort{false};
+};
+
+#endif // PROXYVIDEO_H
@@ -0,0 +1,202 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pythonBridge.h"
+
+#include "control.h"
+#include "logger.h"
+#include "personStorage.h"
+#include "petrack.h"
+#include "stereoWidget.h"
+#include "worldImageCorrespondence.h"
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <stdexcept>
+
+namespace py = pybind11;
+
+namespace
+{
+using Points = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+Petrack *gPetrack = nullptr; ///< main window accessed by the running script
+
+Petrack &currentPetrack()
+{
+    if(!gPetrack)
+    {
+        throw std::runtime_error("The module petrack is only available in scripts run by PeTrack.");
+    }
+    return *gPetrack;
+}
+
+template <typename T>
+void addColumn(py::dict &arrays, const char *name, const std::vector<T> &column, const py::capsule &owner)
+{
+    if(!column.empty())
+    {
+        arrays[name] = py::array_t<T>(static_cast<py::ssize_t>(column.size()), column.data(), owner);
+    }
+}
+
+/// applies map to every row of the (n, 2) array points in one pass
+template <typename Map>
+py::array_t<double> transformPoints(const Points &points, Map map)
+{
+    if(points.ndim() != 2 || points.shape(1) != 2)
+    {
+        throw std::invalid_argument("Expected an array of shape (n, 2).");
+    }
+    const auto          rows = points.shape(0);
+    py::array_t<double> result({rows, py::ssize_t{2}});
+    const auto          in  = points.unchecked<2>();
+    auto                out = result.mutable_unchecked<2>();
+    for(py::ssize_t i = 0; i < rows; ++i)
+    {
+        const QPointF mapped = map(QPointF(in(i, 0), in(i, 1)));
+        out(i, 0)            = mapped.x();
+        out(i, 1)            = mapped.y();
+    }
+    return result;
+}
+} // namespace
+
+PYBIND11_EMBEDDED_MODULE(petrack, module)
+{
+    module.doc() = "Trajectories and calibration of the running PeTrack";
+
+    module.def(
+        "trajectories",
+        []()
+        {
+            Petrack &petrack = currentPetrack();
+            petrack.calculateRealTracker();
+            auto columns = std::make_shared<TrajectoryColumns>(petrack.getTrackerReal()->exportColumns(
+                petrack.getControlWidget()->getTrackAlternateHeight(),
+                petrack.getStereoWidget()->stereoUseForExport->isChecked()));
+            return pythonBridge::toArrays(std::move(columns));
+        },
+        "Real world trajectories in cm as dict of numpy arrays (id, frame, x, y, z, ...)");
+    module.def(
+        "pixel_trajectories",
+        []()
+        {
+            auto columns =
+                std::make_shared<TrajectoryColumns>(pythonBridge::pixelColumns(currentPetrack().getPersonStorage()));
+            return pythonBridge::toArrays(std::move(columns));
+        },
+        "Tracked pixel positions as dict of numpy arrays (id, frame, x, y)");
+    module.def(
+        "image_to_world",
+        [](const Points &points, double height)
+        {
+            const auto &correspondence = currentPetrack().getWorldImageCorrespondence();
+            return transformPoints(points, [&](const QPointF &pos) { return correspondence.getPosReal(pos, height); });
+        },
+        "Maps pixel positions of shape (n, 2) at height (cm) to world coordinates in cm",
+        py::arg("points"),
+        py::arg("height") = 0.);
+    module.def(
+        "world_to_image",
+        [](const Points &points, float height)
+        {
+            const auto &correspondence = currentPetrack().getWorldImageCorrespondence();
+            return transformPoints(points, [&](const QPointF &pos) { return correspondence.getPosImage(pos, height); });
+        },
+        "Maps world coordinates of shape (n, 2) in cm at height (cm) to pixel positions",
+        py::arg("points"),
+        py::arg("height") = 0.f);
+}
+
+namespace pythonBridge
+{
+py::dict toArrays(std::shared_ptr<TrajectoryColumns> columns)
+{
+    // the capsule owns the columns until the last array viewing them is gone
+    auto *owned = new std::shared_ptr<TrajectoryColumns>(std::move(columns));
+    const py::capsule owner(owned, [](void *ptr) { delete static_cast<std::shared_ptr<TrajectoryColumns> *>(ptr); });
+
+    const TrajectoryColumns &data = **owned;
+    py::dict                 arrays;
+    addColumn(arrays, "id", data.id, owner);
+    addColumn(arrays, "frame", data.frame, owner);
+    addColumn(arrays, "x", data.x, owner);
+    addColumn(arrays, "y", data.y, owner);
+    addColumn(arrays, "z", data.z, owner);
+    addColumn(arrays, "markerID", data.markerID, owner);
+    addColumn(arrays, "viewDirX", data.viewDirX, owner);
+    addColumn(arrays, "viewDirY", data.viewDirY, owner);
+    return arrays;
+}
+
+TrajectoryColumns pixelColumns(const PersonStorage &personStorage)
+{
+    std::size_t rows = 0;
+    for(const auto &person : personStorage.getPersons())
+    {
+        rows += person.size();
+    }
+
+    TrajectoryColumns columns;
+    columns.id.reserve(rows);
+    columns.frame.reserve(rows);
+    columns.x.reserve(rows);
+    columns.y.reserve(rows);
+    for(std::size_t i = 0; i < personStorage.nbPersons(); ++i)
+    {
+        const TrackPerson &person = personStorage.at(i);
+        for(int j = 0; j < person.size(); ++j)
+        {
+            const TrackPoint point = person.at(j);
+            columns.id.push_back(static_cast<int>(i) + 1);
+            columns.frame.push_back(person.firstFrame() + j);
+            columns.x.push_back(static_cast<float>(point.x()));
+            columns.y.push_back(static_cast<float>(point.y()));
+        }
+    }
+    return columns;
+}
+
+bool runScript(Petrack &petrack, const QString &script)
+{
+    // numpy cannot be imported again after finalizing, so the interpreter lives until PeTrack ends
+    if(!Py_IsInitialized())
+    {
+        py::initialize_interpreter();
+    }
+
+    gPetrack = &petrack;
+    bool success = true;
+    try
+    {
+        py::dict scope;
+        scope["__builtins__"] = py::module_::import("builtins");
+        scope["__name__"]     = "__main__";
+        scope["__file__"]     = script.toStdString();
+        py::eval_file(script.toStdString(), scope);
+    }
+    catch(const py::error_already_set &error)
+    {
+        SPDLOG_ERROR("Python script {} failed: {}", script, error.what());
+        success = false;
+    }
+    gPetrack = nullptr;
+    return success;
+}
+} // namespace pythonBridge
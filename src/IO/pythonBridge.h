@@ -0,0 +1,58 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHONBRIDGE_H
+#define PYTHONBRIDGE_H
+
+#include "trackerReal.h"
+
+#include <QString>
+#include <memory>
+#include <pybind11/pybind11.h>
+
+class Petrack;
+class PersonStorage;
+
+/**
+ * @brief In-process access to the trajectories from Python (only available with the CMake option PYTHON)
+ *
+ * Scripts run in an interpreter embedded in PeTrack and import the module petrack:
+ *
+ *     import petrack
+ *     t = petrack.trajectories()               # dict of numpy arrays: id, frame, x, y, z, ...
+ *     p = petrack.pixel_trajectories()         # id, frame, x, y in pixel
+ *     w = petrack.image_to_world(xy, height)   # (n, 2) pixel -> (n, 2) cm
+ *     i = petrack.world_to_image(xy, height)   # (n, 2) cm -> (n, 2) pixel
+ *
+ * The columns are built once from the current tracking result as TrajectoryColumns; the
+ * numpy arrays are views on these vectors, which live as long as any of the arrays, so
+ * nothing is copied or formatted as text in between.
+ */
+namespace pythonBridge
+{
+/// one dimensional numpy arrays viewing the (non empty) columns, keeping columns alive
+pybind11::dict toArrays(std::shared_ptr<TrajectoryColumns> columns);
+
+/// tracked pixel positions of all persons; only id, frame, x and y are filled
+TrajectoryColumns pixelColumns(const PersonStorage &personStorage);
+
+/// runs the Python file script with the module petrack accessing petrack
+bool runScript(Petrack &petrack, const QString &script);
+} // namespace pythonBridge
+
+#endif // PYTHONBRIDGE_H
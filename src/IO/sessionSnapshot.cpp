@@ -0,0 +1,349 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sessionSnapshot.h"
+
+#include "logger.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+constexpr char          MAGIC[8]       = {'P', 'E', 'T', 'S', 'N', 'A', 'P', 'S'};
+constexpr std::uint32_t FORMAT_VERSION = 1;
+/// the snapshot is written in the byte order of the machine; a snapshot of another byte order is not used
+constexpr std::uint32_t BYTE_ORDER = 0x01020304;
+/// alignment of the arrays in the file; suffices for all value types of the arrays
+constexpr std::uint64_t ARRAY_ALIGNMENT = 16;
+
+/// arrays of a MoCapPerson in the order of MoCapRecord::arrayOffset
+enum MoCapArray
+{
+    NODE_IDS,
+    NODE_PARENTS,
+    NODES,
+    HEAD_DIRS,
+    ROTATION_CENTERS,
+    NUM_MOCAP_ARRAYS
+};
+
+struct SnapshotHeader
+{
+    char          magic[8];
+    std::uint32_t formatVersion;
+    std::uint32_t byteOrder;
+    std::int32_t  numMoCapPersons;
+    std::uint32_t unused;
+};
+
+struct MoCapRecord
+{
+    std::int64_t                                fileSize;
+    std::int64_t                                fileModified; ///< ms since epoch
+    std::uint64_t                               pathOffset;
+    std::uint32_t                               pathBytes;
+    std::int32_t                                system;
+    double                                      samplerate;
+    double                                      fileTimeOffset;
+    std::uint64_t                               firstSample;
+    std::uint64_t                               recordingLength;
+    std::uint64_t                               nodeCount;
+    std::uint64_t                               sampleCount;
+    std::array<std::uint64_t, NUM_MOCAP_ARRAYS> arrayOffset;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader> && std::is_trivially_copyable_v<MoCapRecord>);
+static_assert(sizeof(int) == sizeof(std::int32_t), "node parents are written as int32");
+static_assert(sizeof(cv::Point3f) == 3 * sizeof(float) && sizeof(cv::Vec3f) == 3 * sizeof(float));
+
+std::uint64_t aligned(std::uint64_t offset)
+{
+    return (offset + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+}
+
+/// data and size in bytes of the arrays of person in the order of MoCapArray
+std::array<std::pair<const char *, std::uint64_t>, NUM_MOCAP_ARRAYS> moCapArrays(const MoCapPerson &person)
+{
+    const auto bytes = [](const auto &values)
+    {
+        using T = typename std::decay_t<decltype(values)>::value_type;
+        return std::make_pair(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+    };
+    return {
+        bytes(person.getNodeIds()),
+        bytes(person.getNodeParents()),
+        bytes(person.getNodes()),
+        bytes(person.getHeadDirs()),
+        bytes(person.getRotationCenters())};
+}
+
+/// copies count values at offset of the mapped snapshot; false, if they are not inside of the snapshot
+template <typename T>
+bool copyArray(
+    const uchar    *base,
+    std::uint64_t   fileSize,
+    std::uint64_t   offset,
+    std::uint64_t   count,
+    std::vector<T> &values)
+{
+    if(offset % ARRAY_ALIGNMENT != 0 || offset > fileSize || count > (fileSize - offset) / sizeof(T))
+    {
+        return false;
+    }
+    values.resize(count);
+    std::memcpy(values.data(), base + offset, count * sizeof(T));
+    return true;
+}
+
+bool writeZeros(QSaveFile &file, std::uint64_t count)
+{
+    static const char zeros[ARRAY_ALIGNMENT] = {};
+    return file.write(zeros, static_cast<qint64>(count)) == static_cast<qint64>(count);
+}
+} // namespace
+
+namespace IO
+{
+QString sessionSnapshotName(const QString &projectFile)
+{
+    return projectFile + ".snapshot";
+}
+
+bool writeSessionSnapshot(const QString &projectFile, const std::vector<MoCapPerson> &moCapPersons)
+{
+    SnapshotHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.formatVersion   = FORMAT_VERSION;
+    header.byteOrder       = BYTE_ORDER;
+    header.numMoCapPersons = static_cast<std::int32_t>(moCapPersons.size());
+
+    std::vector<QByteArray>  paths;
+    std::vector<MoCapRecord> records(moCapPersons.size());
+    paths.reserve(moCapPersons.size());
+
+    std::uint64_t offset = sizeof(SnapshotHeader) + moCapPersons.size() * sizeof(MoCapRecord);
+    for(std::size_t i = 0; i < moCapPersons.size(); ++i)
+    {
+        const auto     &person   = moCapPersons[i];
+        const auto     &metadata = person.getMetadata();
+        const QString   path     = QString::fromStdString(person.getFilename());
+        const QFileInfo info(path);
+
+        MoCapRecord &record    = records[i];
+        record.fileSize        = info.exists() ? info.size() : -1;
+        record.fileModified    = info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+        record.system          = metadata.getSystem();
+        record.samplerate      = metadata.getSamplerate();
+        record.fileTimeOffset  = metadata.getFileTimeOffset();
+        record.firstSample     = person.getFirstSample();
+        record.recordingLength = person.getRecordingLength();
+        record.nodeCount       = person.getNodeIds().size();
+        record.sampleCount     = person.getHeadDirs().size();
+        paths.push_back(path.toUtf8());
+        record.pathOffset = offset;
+        record.pathBytes  = static_cast<std::uint32_t>(paths.back().size());
+        offset += record.pathBytes;
+    }
+    for(std::size_t i = 0; i < moCapPersons.size(); ++i)
+    {
+        const auto arrays = moCapArrays(moCapPersons[i]);
+        for(int array = 0; array < NUM_MOCAP_ARRAYS; ++array)
+        {
+            offset                        = aligned(offset);
+            records[i].arrayOffset[array] = offset;
+            offset += arrays[array].second;
+        }
+    }
+
+    QSaveFile file(sessionSnapshotName(projectFile));
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        SPDLOG_WARN(
+            "Could not write the session snapshot {}: {}", sessionSnapshotName(projectFile), file.errorString());
+        return false;
+    }
+    const auto  recordBytes = static_cast<qint64>(records.size() * sizeof(MoCapRecord));
+    const char *recordData  = reinterpret_cast<const char *>(records.data());
+    bool        ok          = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+    ok                      = ok && file.write(recordData, recordBytes) == recordBytes;
+    for(const auto &path : paths)
+    {
+        ok = ok && file.write(path) == path.size();
+    }
+    for(const auto &person : moCapPersons)
+    {
+        for(const auto &[data, bytes] : moCapArrays(person))
+        {
+            const auto padding = aligned(file.pos()) - file.pos();
+            const auto size    = static_cast<qint64>(bytes);
+            ok                 = ok && writeZeros(file, padding) && file.write(data, size) == size;
+        }
+    }
+    if(!ok || !file.commit())
+    {
+        SPDLOG_WARN(
+            "Could not write the session snapshot {}: {}", sessionSnapshotName(projectFile), file.errorString());
+        return false;
+    }
+    SPDLOG_INFO(
+        "Wrote the session snapshot {} with {} MoCap persons.", sessionSnapshotName(projectFile), moCapPersons.size());
+    return true;
+}
+
+/**
+ * @brief Reads the session snapshot of projectFile
+ *
+ * MoCap persons whose c3d file changed since writing the snapshot are skipped.
+ *
+ * @return nullptr, if there is no snapshot or it is broken
+ */
+std::shared_ptr<const SessionSnapshot> SessionSnapshot::read(const QString &projectFile)
+{
+    QFile file(sessionSnapshotName(projectFile));
+    if(!file.open(QIODevice::ReadOnly) || file.size() < static_cast<qint64>(sizeof(SnapshotHeader)))
+    {
+        return nullptr;
+    }
+    const auto   fileSize = static_cast<std::uint64_t>(file.size());
+    const uchar *base     = file.map(0, file.size());
+    if(!base)
+    {
+        return nullptr;
+    }
+    // the arrays are copied, so the snapshot is unmapped again, when file is closed
+
+    SnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.formatVersion != FORMAT_VERSION ||
+       header.byteOrder != BYTE_ORDER || header.numMoCapPersons < 0 ||
+       sizeof(SnapshotHeader) + static_cast<std::uint64_t>(header.numMoCapPersons) * sizeof(MoCapRecord) > fileSize)
+    {
+        SPDLOG_INFO("Ignoring the session snapshot {} of another version.", sessionSnapshotName(projectFile));
+        return nullptr;
+    }
+
+    auto snapshot = std::make_shared<SessionSnapshot>();
+    for(int i = 0; i < header.numMoCapPersons; ++i)
+    {
+        MoCapRecord record;
+        std::memcpy(&record, base + sizeof(SnapshotHeader) + i * sizeof(MoCapRecord), sizeof(record));
+        if(record.pathOffset + record.pathBytes > fileSize || record.system < 0 || record.system >= MoCapSystem::END)
+        {
+            SPDLOG_WARN("The session snapshot {} is broken.", sessionSnapshotName(projectFile));
+            return nullptr;
+        }
+        const QString path = QString::fromUtf8(
+            reinterpret_cast<const char *>(base + record.pathOffset), static_cast<int>(record.pathBytes));
+        const QFileInfo info(path);
+        if(!info.exists() || info.size() != record.fileSize ||
+           info.lastModified().toMSecsSinceEpoch() != record.fileModified)
+        {
+            SPDLOG_INFO("{} changed since writing the session snapshot; it is read again.", path);
+            continue;
+        }
+
+        std::vector<uint8_t>     nodeIds;
+        std::vector<int>         nodeParents;
+        std::vector<cv::Point3f> nodes;
+        std::vector<cv::Vec3f>   headDirs;
+        std::vector<cv::Point3f> rotationCenters;
+
+        const auto &offset = record.arrayOffset;
+        const bool  valid =
+            record.sampleCount > 0 &&
+            copyArray(base, fileSize, offset[NODE_IDS], record.nodeCount, nodeIds) &&
+            copyArray(base, fileSize, offset[NODE_PARENTS], record.nodeCount, nodeParents) &&
+            copyArray(base, fileSize, offset[HEAD_DIRS], record.sampleCount, headDirs) &&
+            copyArray(base, fileSize, offset[ROTATION_CENTERS], record.sampleCount, rotationCenters) &&
+            record.nodeCount * sizeof(cv::Point3f) <= fileSize / record.sampleCount &&
+            copyArray(base, fileSize, offset[NODES], record.nodeCount * record.sampleCount, nodes);
+
+        MoCapPerson person;
+        try
+        {
+            if(!valid)
+            {
+                throw std::invalid_argument("The arrays are not inside of the snapshot.");
+            }
+            person.setSamples(
+                std::move(nodeIds),
+                std::move(nodeParents),
+                std::move(nodes),
+                std::move(headDirs),
+                std::move(rotationCenters));
+        }
+        catch(const std::invalid_argument &e)
+        {
+            SPDLOG_WARN("The session snapshot {} is broken: {}", sessionSnapshotName(projectFile), e.what());
+            return nullptr;
+        }
+        MoCapPersonMetadata metadata;
+        metadata.setFilepath(path.toStdString(), static_cast<MoCapSystem>(record.system));
+        metadata.setSamplerate(record.samplerate);
+        metadata.setFileTimeOffset(record.fileTimeOffset);
+        person.setMetadata(metadata);
+        person.setStoredRange(record.firstSample, record.recordingLength);
+        snapshot->mMoCapPersons.push_back(std::move(person));
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Returns the MoCap person read with metadata from the snapshot
+ *
+ * @param metadata metadata of the person in the project
+ * @param videoDuration duration of the video in seconds; -1 to need all samples
+ * @return std::nullopt, if the snapshot does not contain the samples needed for the video
+ */
+std::optional<MoCapPerson> SessionSnapshot::findMoCapPerson(const MoCapPersonMetadata &metadata, double videoDuration)
+    const
+{
+    for(const MoCapPerson &stored : mMoCapPersons)
+    {
+        const auto &storedMetadata = stored.getMetadata();
+        if(storedMetadata.getFilepath() != metadata.getFilepath() ||
+           storedMetadata.getSystem() != metadata.getSystem() ||
+           std::abs(storedMetadata.getSamplerate() - metadata.getSamplerate()) >= 1e-4)
+        {
+            continue;
+        }
+
+        MoCapPerson         person = stored;
+        MoCapPersonMetadata projectMetadata(metadata);
+        projectMetadata.setFileTimeOffset(storedMetadata.getFileTimeOffset());
+        person.setMetadata(projectMetadata);
+
+        const bool complete = person.getFirstSample() == 0 &&
+                              person.getHeadDirs().size() == person.getRecordingLength();
+        if(videoDuration < 0 ? complete : person.storesSamplesFor(0, videoDuration))
+        {
+            return person;
+        }
+    }
+    return std::nullopt;
+}
+} // namespace IO
@@ -0,0 +1,63 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SESSIONSNAPSHOT_H
+#define SESSIONSNAPSHOT_H
+
+#include "moCapPerson.h"
+
+#include <QString>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace IO
+{
+QString sessionSnapshotName(const QString &projectFile);
+
+/**
+ * @brief Writes the binary snapshot of the data read for projectFile next to it (<projectFile>.snapshot)
+ *
+ * The snapshot contains the samples of the MoCap persons in their contiguous form (see
+ * MoCapPerson), together with size and modification time of their c3d files. Reopening
+ * the project maps the snapshot instead of parsing the c3d files again.
+ *
+ * The trajectories and the undistortion maps are not part of the snapshot; they have
+ * their own binary files (see readIndexedTrc() and CalibFilter::setMapDiskCache()).
+ */
+bool writeSessionSnapshot(const QString &projectFile, const std::vector<MoCapPerson> &moCapPersons);
+
+/**
+ * @brief Data of a project read from its session snapshot
+ *
+ * Only the parts whose source files are unchanged since writing the snapshot are read.
+ */
+class SessionSnapshot
+{
+public:
+    static std::shared_ptr<const SessionSnapshot> read(const QString &projectFile);
+
+    std::optional<MoCapPerson> findMoCapPerson(const MoCapPersonMetadata &metadata, double videoDuration) const;
+    size_t                     numMoCapPersons() const { return mMoCapPersons.size(); }
+
+private:
+    std::vector<MoCapPerson> mMoCapPersons; ///< with the metadata of the c3d files, not of the project
+};
+} // namespace IO
+
+#endif // SESSIONSNAPSHOT_H
@@ -99,13 +99,29 @@ void transformTree(SkeletonNode &node, const cv::Affine3f &transform)
     }
 }
 
+/**
+ * @brief Returns the transformation applied by transformed()
+ *
+ * @param rotationCenter center of the rotation (top of head)
+ * @param rotation rotation around rotationCenter
+ * @param translation translation after the rotation
+ * @return combined transformation
+ */
+cv::Affine3f SkeletonTree::transformation(
+    const cv::Point3f  &rotationCenter,
+    const cv::Affine3f &rotation,
+    const cv::Affine3f &translation)
+{
+    auto transFrom       = cv::Affine3f().translate(rotationCenter);
+    auto transTo         = cv::Affine3f().translate(-rotationCenter);
+    auto rot_around_head = transTo.concatenate(rotation.concatenate(transFrom));
+    return rot_around_head.concatenate(translation);
+}
+
 SkeletonTree SkeletonTree::transformed(cv::Affine3f rotation, cv::Affine3f translation) const
 {
     SkeletonTree transformed{*this};
-    auto         transFrom       = cv::Affine3f().translate(mRotationCenter);
-    auto         transTo         = cv::Affine3f().translate(-mRotationCenter);
-    auto         rot_around_head = transTo.concatenate(rotation.concatenate(transFrom));
-    auto         transform       = rot_around_head.concatenate(translation);
+    auto         transform = transformation(mRotationCenter, rotation, translation);
     transformTree(transformed.mRoot, transform);
     cv::Matx33f rot      = transform.rotation();
     transformed.mHeadDir = rot * mHeadDir;
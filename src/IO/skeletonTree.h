@@ -213,6 +213,13 @@ public:
      */
     inline const cv::Vec3f &getHeadDir() const { return mHeadDir; }
 
+    /**
+     * @brief Gets the center of rotation used by transformed().
+     *
+     * @return The center of rotation (top of head).
+     */
+    inline const cv::Point3f &getRotationCenter() const { return mRotationCenter; }
+
     /**
      * @brief Returns a copy translated by translation
      * @param translation vector to add to each skeleton point
@@ -220,6 +227,9 @@ public:
      */
     SkeletonTree transformed(cv::Affine3f rotation, cv::Affine3f translation) const;
 
+    static cv::Affine3f
+    transformation(const cv::Point3f &rotationCenter, const cv::Affine3f &rotation, const cv::Affine3f &translation);
+
 private:
     SkeletonNode mRoot;           /**< Root node of the skeleton. */
     cv::Vec3f    mHeadDir;        /**< Direction the head is facing to. This value is normalized. */
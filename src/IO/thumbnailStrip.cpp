@@ -0,0 +1,154 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "thumbnailStrip.h"
+
+#include "helper.h"
+#include "logger.h"
+
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+ThumbnailStrip::~ThumbnailStrip()
+{
+    stop();
+}
+
+/**
+ * @brief Starts decoding the thumbnails of videoFile in the background
+ *
+ * @param videoFile video to take the thumbnails from
+ * @param numFrames number of frames of the video
+ * @param keyFrames keyframes of the video; may be empty, if unknown
+ */
+void ThumbnailStrip::start(const QString &videoFile, int numFrames, const std::vector<int> &keyFrames)
+{
+    stop();
+    mVideoFile = videoFile;
+    mAbort     = false;
+
+    const auto frames = sampleFrames(numFrames, MAX_THUMBNAILS, keyFrames);
+    if(frames.empty())
+    {
+        return;
+    }
+    SPDLOG_INFO("Creating {} thumbnails of {} in the background.", frames.size(), videoFile);
+    mJob = QtConcurrent::run([this, frames]() { run(frames); });
+}
+
+void ThumbnailStrip::stop()
+{
+    mAbort = true;
+    mJob.waitForFinished();
+    mJob = QFuture<void>();
+    mVideoFile.clear();
+    std::lock_guard<std::mutex> lock(mMutex);
+    mThumbnails.clear();
+}
+
+/// Returns the thumbnails decoded so far (the images are shared, not copied)
+std::vector<Thumbnail> ThumbnailStrip::getThumbnails() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mThumbnails;
+}
+
+/**
+ * @brief Returns the frames to take thumbnails of
+ *
+ * Every n-th frame is taken, so that there are at most maxCount frames. Each frame is
+ * replaced by the last keyframe before it, if this keyframe comes after the previous
+ * sampled frame; otherwise the frame itself is taken.
+ *
+ * @param keyFrames sorted keyframes of the video; empty, if unknown
+ * @return ascending frames
+ */
+std::vector<int> ThumbnailStrip::sampleFrames(int numFrames, int maxCount, const std::vector<int> &keyFrames)
+{
+    std::vector<int> frames;
+    if(numFrames <= 0 || maxCount <= 0)
+    {
+        return frames;
+    }
+    const int step = (numFrames + maxCount - 1) / maxCount;
+    for(int frame = 0; frame < numFrames; frame += step)
+    {
+        int sample = frame;
+        // last keyframe <= frame
+        const auto key = std::upper_bound(keyFrames.begin(), keyFrames.end(), frame);
+        if(key != keyFrames.begin() && (frames.empty() || *(key - 1) > frames.back()))
+        {
+            sample = *(key - 1);
+        }
+        if(frames.empty() || sample > frames.back())
+        {
+            frames.push_back(sample);
+        }
+    }
+    return frames;
+}
+
+/**
+ * @brief Decodes the thumbnails of frames (run in a background thread)
+ */
+void ThumbnailStrip::run(const std::vector<int> &frames)
+{
+    QThread *const          thread   = QThread::currentThread();
+    const QThread::Priority priority = thread->priority();
+    thread->setPriority(QThread::LowestPriority);
+
+    cv::VideoCapture capture;
+    if(!capture.open(mVideoFile.toStdString(), cv::CAP_ANY, {cv::CAP_PROP_N_THREADS, 1}) &&
+       !capture.open(mVideoFile.toStdString()))
+    {
+        SPDLOG_WARN("Could not open {} for creating thumbnails.", mVideoFile);
+        thread->setPriority(priority);
+        return;
+    }
+
+    int     nextFrame = 0; ///< frame read next by capture
+    cv::Mat img;
+    cv::Mat small;
+    for(const int frame : frames)
+    {
+        if(mAbort)
+        {
+            break;
+        }
+        if(frame != nextFrame && !capture.set(cv::CAP_PROP_POS_FRAMES, frame))
+        {
+            break;
+        }
+        if(!capture.read(img) || img.empty())
+        {
+            break;
+        }
+        nextFrame       = frame + 1;
+        const int width = std::max(1, img.cols * HEIGHT / img.rows);
+        cv::resize(img, small, cv::Size(width, HEIGHT), 0, 0, cv::INTER_AREA);
+
+        Thumbnail thumbnail{frame, QImage()};
+        copyToQImage(thumbnail.image, small);
+        std::lock_guard<std::mutex> lock(mMutex);
+        mThumbnails.push_back(std::move(thumbnail));
+    }
+    thread->setPriority(priority);
+}
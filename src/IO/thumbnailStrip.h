@@ -0,0 +1,76 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef THUMBNAILSTRIP_H
+#define THUMBNAILSTRIP_H
+
+#include <QFuture>
+#include <QImage>
+#include <QString>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/// Small image of one frame for the timeline of the player
+struct Thumbnail
+{
+    int    frame;
+    QImage image;
+};
+
+/**
+ * @brief Decodes thumbnails of every n-th frame of a video in the background
+ *
+ * The thumbnails are used to find events in long videos without seeking and decoding
+ * full frames. Where possible the sampled frames are moved to the keyframes of the
+ * video (from VideoIndex), so each thumbnail costs a single decoded frame. The job runs
+ * with low priority and a single decoder thread, so it does not slow down playing or
+ * tracking. Thumbnails already decoded can be taken while the job is still running.
+ */
+class ThumbnailStrip
+{
+public:
+    static constexpr int HEIGHT         = 40;  ///< height of a thumbnail in pixels
+    static constexpr int MAX_THUMBNAILS = 250; ///< thumbnails of a whole video
+
+    ThumbnailStrip() = default;
+    ~ThumbnailStrip();
+
+    ThumbnailStrip(const ThumbnailStrip &)            = delete;
+    ThumbnailStrip &operator=(const ThumbnailStrip &) = delete;
+
+    void start(const QString &videoFile, int numFrames, const std::vector<int> &keyFrames);
+    void stop();
+
+    const QString         &getVideoFile() const { return mVideoFile; }
+    bool                   isRunning() const { return mJob.isRunning(); }
+    std::vector<Thumbnail> getThumbnails() const;
+
+    static std::vector<int> sampleFrames(int numFrames, int maxCount, const std::vector<int> &keyFrames);
+
+private:
+    void run(const std::vector<int> &frames);
+
+    QString                mVideoFile;
+    QFuture<void>          mJob;
+    std::atomic_bool       mAbort{false};
+    mutable std::mutex     mMutex;
+    std::vector<Thumbnail> mThumbnails; ///< ascending by frame, guarded by mMutex
+};
+
+#endif // THUMBNAILSTRIP_H
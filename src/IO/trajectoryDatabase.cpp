@@ -0,0 +1,279 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectoryDatabase.h"
+
+#include "logger.h"
+#include "trace.h"
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+/// opens a SQLite connection of its own and removes it when leaving the scope
+class Connection
+{
+public:
+    explicit Connection(const QString &fileName)
+    {
+        static QAtomicInt counter;
+        mName = QString("trajectoryDatabase%1").arg(counter.fetchAndAddRelaxed(1));
+        mDb   = QSqlDatabase::addDatabase("QSQLITE", mName);
+        mDb.setDatabaseName(fileName);
+        if(!mDb.open())
+        {
+            const std::string error = mDb.lastError().text().toStdString();
+            mDb                     = QSqlDatabase();
+            QSqlDatabase::removeDatabase(mName);
+            throw std::runtime_error("Could not open " + fileName.toStdString() + ": " + error);
+        }
+    }
+    ~Connection()
+    {
+        mDb.close();
+        mDb = QSqlDatabase();
+        QSqlDatabase::removeDatabase(mName);
+    }
+
+    Connection(const Connection &)            = delete;
+    Connection &operator=(const Connection &) = delete;
+
+    QSqlDatabase &db() { return mDb; }
+
+private:
+    QString      mName;
+    QSqlDatabase mDb;
+};
+
+void check(bool ok, const QSqlQuery &query, const std::string &what)
+{
+    if(!ok)
+    {
+        throw std::runtime_error(what + ": " + query.lastError().text().toStdString());
+    }
+}
+
+void exec(QSqlQuery &query, const QString &sql)
+{
+    check(query.exec(sql), query, "Could not execute " + sql.toStdString());
+}
+
+/// per person: markerID, first and last frame
+struct PersonRange
+{
+    int markerID;
+    int firstFrame;
+    int lastFrame;
+};
+
+void writeSchema(QSqlQuery &query)
+{
+    exec(query, "CREATE TABLE meta (key TEXT PRIMARY KEY, value TEXT)");
+    exec(query, "CREATE TABLE groups (id INTEGER PRIMARY KEY, name TEXT, type TEXT)");
+    exec(
+        query,
+        "CREATE TABLE persons (id INTEGER PRIMARY KEY, markerID INTEGER, first_frame INTEGER, last_frame INTEGER)");
+    exec(
+        query,
+        "CREATE TABLE points (id INTEGER PRIMARY KEY, person INTEGER REFERENCES persons(id), frame INTEGER, x REAL, "
+        "y REAL, z REAL, group_id INTEGER, viewDirX REAL, viewDirY REAL)");
+}
+
+void writeMeta(QSqlQuery &query, const QString &key, const QVariant &value)
+{
+    check(query.prepare("INSERT INTO meta (key, value) VALUES (?, ?)"), query, "Could not prepare meta data");
+    query.addBindValue(key);
+    query.addBindValue(value.toString());
+    check(query.exec(), query, "Could not write meta data " + key.toStdString());
+}
+} // namespace
+
+void trajectoryDatabase::write(
+    const QString                              &fileName,
+    const TrajectoryColumns                    &columns,
+    const std::vector<int>                     &groups,
+    const std::vector<annotationGroups::Group> &groupTable,
+    double                                      framerate)
+{
+    TRACE_ZONE("trajectoryDatabase::write");
+    if(groups.size() != columns.size())
+    {
+        throw std::runtime_error("The number of groups does not match the number of track points.");
+    }
+    if(QFile::exists(fileName) && !QFile::remove(fileName))
+    {
+        throw std::runtime_error("Could not replace " + fileName.toStdString() + ".");
+    }
+
+    Connection connection(fileName);
+    QSqlQuery  query(connection.db());
+    // the file is written at once and replaced on the next export, so no rollback journal is needed
+    exec(query, "PRAGMA journal_mode = OFF");
+    exec(query, "PRAGMA synchronous = OFF");
+    check(connection.db().transaction(), query, "Could not start transaction");
+
+    writeSchema(query);
+    writeMeta(query, "version", VERSION);
+    writeMeta(query, "unit", "cm");
+    writeMeta(query, "framerate", framerate);
+
+    check(query.prepare("INSERT INTO groups (id, name, type) VALUES (?, ?, ?)"), query, "Could not prepare groups");
+    for(const auto &group : groupTable)
+    {
+        query.addBindValue(group.id);
+        query.addBindValue(QString::fromStdString(group.name));
+        query.addBindValue(QString::fromStdString(group.type));
+        check(query.exec(), query, "Could not write group " + group.name);
+    }
+
+    std::map<int, PersonRange> persons;
+    check(
+        query.prepare("INSERT INTO points (id, person, frame, x, y, z, group_id, viewDirX, viewDirY) "
+                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)"),
+        query,
+        "Could not prepare track points");
+    for(std::size_t row = 0; row < columns.size(); ++row)
+    {
+        const int id    = columns.id[row];
+        const int frame = columns.frame[row];
+        query.addBindValue(static_cast<qlonglong>(row + 1));
+        query.addBindValue(id);
+        query.addBindValue(frame);
+        query.addBindValue(columns.x[row]);
+        query.addBindValue(columns.y[row]);
+        query.addBindValue(columns.z[row]);
+        query.addBindValue(groups[row]);
+        query.addBindValue(columns.viewDirX[row]);
+        query.addBindValue(columns.viewDirY[row]);
+        check(query.exec(), query, "Could not write track point " + std::to_string(row));
+
+        auto [person, inserted] = persons.try_emplace(id, PersonRange{columns.markerID[row], frame, frame});
+        if(!inserted)
+        {
+            person->second.firstFrame = std::min(person->second.firstFrame, frame);
+            person->second.lastFrame  = std::max(person->second.lastFrame, frame);
+        }
+    }
+
+    check(
+        query.prepare("INSERT INTO persons (id, markerID, first_frame, last_frame) VALUES (?, ?, ?, ?)"),
+        query,
+        "Could not prepare persons");
+    for(const auto &[id, person] : persons)
+    {
+        query.addBindValue(id);
+        query.addBindValue(person.markerID);
+        query.addBindValue(person.firstFrame);
+        query.addBindValue(person.lastFrame);
+        check(query.exec(), query, "Could not write person " + std::to_string(id));
+    }
+
+    // indexes are built after inserting all rows, which is faster than updating them per row
+    exec(query, "CREATE INDEX points_frame ON points (frame)");
+    exec(query, "CREATE INDEX points_person ON points (person, frame)");
+    const bool spatialIndex =
+        query.exec("CREATE VIRTUAL TABLE points_space USING rtree(id, min_frame, max_frame, min_x, max_x, min_y, "
+                   "max_y)");
+    if(spatialIndex)
+    {
+        exec(query, "INSERT INTO points_space SELECT id, frame, frame, x, x, y, y FROM points");
+    }
+    else
+    {
+        SPDLOG_WARN("SQLite without R-tree support, {} is only indexed by frame.", fileName);
+    }
+    writeMeta(query, "spatial_index", spatialIndex ? 1 : 0);
+
+    check(connection.db().commit(), query, "Could not write " + fileName.toStdString());
+}
+
+TrajectoryColumns
+trajectoryDatabase::query(const QString &fileName, const QRectF &area, int firstFrame, int lastFrame)
+{
+    TRACE_ZONE("trajectoryDatabase::query");
+    if(!QFile::exists(fileName))
+    {
+        throw std::runtime_error("Could not open " + fileName.toStdString() + ": file does not exist.");
+    }
+    Connection connection(fileName);
+    QSqlQuery  query(connection.db());
+    query.setForwardOnly(true);
+
+    exec(query, "SELECT value FROM meta WHERE key = 'spatial_index'");
+    const bool spatialIndex = query.next() && query.value(0).toInt() == 1;
+
+    // the R-tree stores 32 bit floats rounded outwards, so it only preselects the points for the exact test
+    const QString select = "SELECT p.person, p.frame, p.x, p.y, p.z, persons.markerID, p.viewDirX, p.viewDirY ";
+    const QString exact  = "p.frame BETWEEN ? AND ? AND p.x BETWEEN ? AND ? AND p.y BETWEEN ? AND ? "
+                           "ORDER BY p.person, p.frame";
+    if(spatialIndex)
+    {
+        check(
+            query.prepare(
+                select +
+                "FROM points_space s JOIN points p ON p.id = s.id JOIN persons ON persons.id = p.person "
+                "WHERE s.max_frame >= ? AND s.min_frame <= ? AND s.max_x >= ? AND s.min_x <= ? AND s.max_y >= ? "
+                "AND s.min_y <= ? AND " +
+                exact),
+            query,
+            "Could not prepare query");
+        query.addBindValue(firstFrame);
+        query.addBindValue(lastFrame);
+        query.addBindValue(area.left());
+        query.addBindValue(area.right());
+        query.addBindValue(area.top());
+        query.addBindValue(area.bottom());
+    }
+    else
+    {
+        check(
+            query.prepare(select + "FROM points p JOIN persons ON persons.id = p.person WHERE " + exact),
+            query,
+            "Could not prepare query");
+    }
+    query.addBindValue(firstFrame);
+    query.addBindValue(lastFrame);
+    query.addBindValue(area.left());
+    query.addBindValue(area.right());
+    query.addBindValue(area.top());
+    query.addBindValue(area.bottom());
+    check(query.exec(), query, "Could not query " + fileName.toStdString());
+
+    TrajectoryColumns columns;
+    while(query.next())
+    {
+        columns.id.push_back(query.value(0).toInt());
+        columns.frame.push_back(query.value(1).toInt());
+        columns.x.push_back(query.value(2).toFloat());
+        columns.y.push_back(query.value(3).toFloat());
+        columns.z.push_back(query.value(4).toFloat());
+        columns.markerID.push_back(query.value(5).toInt());
+        columns.viewDirX.push_back(query.value(6).toFloat());
+        columns.viewDirY.push_back(query.value(7).toFloat());
+    }
+    return columns;
+}
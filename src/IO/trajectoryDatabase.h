@@ -0,0 +1,64 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORYDATABASE_H
+#define TRAJECTORYDATABASE_H
+
+#include "annotationGrouping.h"
+#include "trackerReal.h"
+
+#include <QRectF>
+#include <QString>
+#include <vector>
+
+/**
+ * @brief Trajectories as indexed SQLite database (only available with the CMake option SQLITE)
+ *
+ * The database can be queried by frame and area without reading all trajectories, e.g. with
+ * the sqlite3 shell, Python or R:
+ *
+ *     meta(key, value)                         version, unit ("cm"), framerate, spatial_index
+ *     groups(id, name, type)                   annotation groups
+ *     persons(id, markerID, first_frame, last_frame)
+ *     points(id, person, frame, x, y, z, group_id, viewDirX, viewDirY)
+ *     points_space(id, min_frame, max_frame, min_x, max_x, min_y, max_y)
+ *
+ * persons.id is the id of the other exports, points.group_id is -1 for points without group.
+ * points is indexed by frame and by (person, frame); points_space is an R-tree over frame, x
+ * and y of the points with the same id. It only exists if the SQLite library supports R-trees
+ * (spatial_index is 1 then).
+ *
+ * Errors are reported by throwing std::runtime_error.
+ */
+namespace trajectoryDatabase
+{
+constexpr int VERSION = 1;
+
+/// groups has the annotation group of each row of columns; an existing file is replaced
+void write(
+    const QString                              &fileName,
+    const TrajectoryColumns                    &columns,
+    const std::vector<int>                     &groups,
+    const std::vector<annotationGroups::Group> &groupTable,
+    double                                      framerate);
+
+/// rows inside area (in cm) between firstFrame and lastFrame (both inclusive), sorted by id and frame
+TrajectoryColumns query(const QString &fileName, const QRectF &area, int firstFrame, int lastFrame);
+} // namespace trajectoryDatabase
+
+#endif // TRAJECTORYDATABASE_H
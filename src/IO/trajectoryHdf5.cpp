@@ -0,0 +1,236 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectoryHdf5.h"
+
+#include "trace.h"
+
+#include <QFile>
+#include <hdf5.h>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+/// closes an HDF5 identifier when leaving the scope
+class Hdf5Handle
+{
+public:
+    using Close = herr_t (*)(hid_t);
+
+    Hdf5Handle(hid_t id, Close close, const std::string &what) : mId(id), mClose(close)
+    {
+        if(mId < 0)
+        {
+            throw std::runtime_error(what);
+        }
+    }
+    ~Hdf5Handle() { mClose(mId); }
+
+    Hdf5Handle(const Hdf5Handle &)            = delete;
+    Hdf5Handle &operator=(const Hdf5Handle &) = delete;
+
+    operator hid_t() const { return mId; } // NOLINT (implicit use in HDF5 calls is intended)
+
+private:
+    hid_t mId;
+    Close mClose;
+};
+
+void check(herr_t status, const std::string &what)
+{
+    if(status < 0)
+    {
+        throw std::runtime_error(what);
+    }
+}
+
+template <typename T>
+void writeColumn(hid_t file, const char *name, hid_t fileType, hid_t memType, const std::vector<T> &data)
+{
+    const hsize_t dims[1]    = {data.size()};
+    const hsize_t maxDims[1] = {H5S_UNLIMITED};
+    const hsize_t chunk[1]   = {trajectoryHdf5::CHUNK_ROWS};
+
+    Hdf5Handle space(H5Screate_simple(1, dims, maxDims), H5Sclose, "Could not create dataspace.");
+    Hdf5Handle props(H5Pcreate(H5P_DATASET_CREATE), H5Pclose, "Could not create dataset properties.");
+    check(H5Pset_chunk(props, 1, chunk), "Could not set chunk size.");
+    Hdf5Handle set(
+        H5Dcreate2(file, name, fileType, space, H5P_DEFAULT, props, H5P_DEFAULT),
+        H5Dclose,
+        std::string("Could not create dataset ") + name + ".");
+    if(!data.empty())
+    {
+        check(
+            H5Dwrite(set, memType, H5S_ALL, H5S_ALL, H5P_DEFAULT, data.data()),
+            std::string("Could not write dataset ") + name + ".");
+    }
+}
+
+template <typename T>
+bool readColumn(hid_t file, const char *name, hid_t memType, std::vector<T> &data, bool required)
+{
+    if(H5Lexists(file, name, H5P_DEFAULT) <= 0)
+    {
+        if(required)
+        {
+            throw std::runtime_error(std::string("Missing dataset ") + name + ".");
+        }
+        return false;
+    }
+
+    Hdf5Handle set(H5Dopen2(file, name, H5P_DEFAULT), H5Dclose, std::string("Could not open dataset ") + name + ".");
+    Hdf5Handle space(H5Dget_space(set), H5Sclose, "Could not get dataspace.");
+    if(H5Sget_simple_extent_ndims(space) != 1)
+    {
+        throw std::runtime_error(std::string("Dataset ") + name + " is not one dimensional.");
+    }
+    hsize_t dims[1];
+    H5Sget_simple_extent_dims(space, dims, nullptr);
+    data.resize(dims[0]);
+    if(!data.empty())
+    {
+        check(
+            H5Dread(set, memType, H5S_ALL, H5S_ALL, H5P_DEFAULT, data.data()),
+            std::string("Could not read dataset ") + name + ".");
+    }
+    return true;
+}
+
+void writeAttribute(hid_t file, const char *name, hid_t type, const void *value)
+{
+    Hdf5Handle space(H5Screate(H5S_SCALAR), H5Sclose, "Could not create dataspace.");
+    Hdf5Handle attr(
+        H5Acreate2(file, name, type, space, H5P_DEFAULT, H5P_DEFAULT),
+        H5Aclose,
+        std::string("Could not create attribute ") + name + ".");
+    check(H5Awrite(attr, type, value), std::string("Could not write attribute ") + name + ".");
+}
+
+std::string readStringAttribute(hid_t file, const char *name)
+{
+    if(H5Aexists(file, name) <= 0)
+    {
+        return {};
+    }
+    Hdf5Handle attr(
+        H5Aopen(file, name, H5P_DEFAULT), H5Aclose, std::string("Could not open attribute ") + name + ".");
+    Hdf5Handle fileType(H5Aget_type(attr), H5Tclose, "Could not get attribute type.");
+    if(H5Tget_class(fileType) != H5T_STRING || H5Tis_variable_str(fileType) > 0)
+    {
+        return {};
+    }
+
+    std::string value(H5Tget_size(fileType), '\0');
+    Hdf5Handle  memType(H5Tcopy(H5T_C_S1), H5Tclose, "Could not create string type.");
+    check(H5Tset_size(memType, value.size()), "Could not set string size.");
+    check(H5Aread(attr, memType, value.data()), std::string("Could not read attribute ") + name + ".");
+    value.erase(value.find_last_not_of('\0') + 1);
+    return value;
+}
+} // namespace
+
+namespace trajectoryHdf5
+{
+/**
+ * @brief Writes the columns into a new HDF5 file
+ *
+ * @param fileName destination file, which is overwritten
+ * @param columns trajectories with positions in cm
+ * @param framerate frame rate of the sequence stored as attribute
+ */
+void writeColumns(const QString &fileName, const TrajectoryColumns &columns, double framerate)
+{
+    TRACE_ZONE("writeColumns");
+    Hdf5Handle file(
+        H5Fcreate(QFile::encodeName(fileName).constData(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT),
+        H5Fclose,
+        "Could not create " + fileName.toStdString() + ".");
+
+    writeColumn(file, "id", H5T_STD_I32LE, H5T_NATIVE_INT, columns.id);
+    writeColumn(file, "frame", H5T_STD_I32LE, H5T_NATIVE_INT, columns.frame);
+    writeColumn(file, "x", H5T_IEEE_F32LE, H5T_NATIVE_FLOAT, columns.x);
+    writeColumn(file, "y", H5T_IEEE_F32LE, H5T_NATIVE_FLOAT, columns.y);
+    writeColumn(file, "z", H5T_IEEE_F32LE, H5T_NATIVE_FLOAT, columns.z);
+    writeColumn(file, "markerID", H5T_STD_I32LE, H5T_NATIVE_INT, columns.markerID);
+    writeColumn(file, "viewDirX", H5T_IEEE_F32LE, H5T_NATIVE_FLOAT, columns.viewDirX);
+    writeColumn(file, "viewDirY", H5T_IEEE_F32LE, H5T_NATIVE_FLOAT, columns.viewDirY);
+
+    const int version = VERSION;
+    writeAttribute(file, "version", H5T_NATIVE_INT, &version);
+    writeAttribute(file, "framerate", H5T_NATIVE_DOUBLE, &framerate);
+
+    const char unit[] = "cm";
+    Hdf5Handle unitType(H5Tcopy(H5T_C_S1), H5Tclose, "Could not create string type.");
+    check(H5Tset_size(unitType, sizeof(unit) - 1), "Could not set string size.");
+    writeAttribute(file, "unit", unitType, unit);
+
+    check(H5Fflush(file, H5F_SCOPE_GLOBAL), "Could not write " + fileName.toStdString() + ".");
+}
+
+/**
+ * @brief Reads the columns written by writeColumns() or by other tools with the same layout
+ *
+ * id, frame, x, y and z are required and need the same length; markerID and
+ * viewDir are filled with -1 and 0 if the file does not contain them.
+ */
+TrajectoryColumns readColumns(const QString &fileName)
+{
+    Hdf5Handle file(
+        H5Fopen(QFile::encodeName(fileName).constData(), H5F_ACC_RDONLY, H5P_DEFAULT),
+        H5Fclose,
+        "Could not open " + fileName.toStdString() + ".");
+
+    TrajectoryColumns columns;
+    readColumn(file, "id", H5T_NATIVE_INT, columns.id, true);
+    readColumn(file, "frame", H5T_NATIVE_INT, columns.frame, true);
+    readColumn(file, "x", H5T_NATIVE_FLOAT, columns.x, true);
+    readColumn(file, "y", H5T_NATIVE_FLOAT, columns.y, true);
+    readColumn(file, "z", H5T_NATIVE_FLOAT, columns.z, true);
+
+    const std::size_t rows = columns.size();
+    if(columns.frame.size() != rows || columns.x.size() != rows || columns.y.size() != rows ||
+       columns.z.size() != rows)
+    {
+        throw std::runtime_error("The datasets of " + fileName.toStdString() + " differ in length.");
+    }
+
+    if(!readColumn(file, "markerID", H5T_NATIVE_INT, columns.markerID, false) || columns.markerID.size() != rows)
+    {
+        columns.markerID.assign(rows, -1);
+    }
+    if(!readColumn(file, "viewDirX", H5T_NATIVE_FLOAT, columns.viewDirX, false) ||
+       !readColumn(file, "viewDirY", H5T_NATIVE_FLOAT, columns.viewDirY, false) ||
+       columns.viewDirX.size() != rows || columns.viewDirY.size() != rows)
+    {
+        columns.viewDirX.assign(rows, 0.f);
+        columns.viewDirY.assign(rows, 0.f);
+    }
+
+    if(readStringAttribute(file, "unit") == "m")
+    {
+        for(std::size_t i = 0; i < rows; ++i)
+        {
+            columns.x[i] *= 100.f;
+            columns.y[i] *= 100.f;
+            columns.z[i] *= 100.f;
+        }
+    }
+    return columns;
+}
+} // namespace trajectoryHdf5
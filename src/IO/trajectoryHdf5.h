@@ -0,0 +1,47 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORYHDF5_H
+#define TRAJECTORYHDF5_H
+
+#include "trackerReal.h"
+
+#include <QString>
+
+/**
+ * @brief Columnar binary trajectory files (only available with the CMake option HDF5)
+ *
+ * Each column of TrajectoryColumns is a one dimensional, chunked dataset in the
+ * root group (id, frame, x, y, z, markerID, viewDirX, viewDirY), so e.g. h5py
+ * or pandas can read single columns without parsing the whole file. The root
+ * group has the attributes version, unit ("cm" or "m") and framerate.
+ *
+ * Errors are reported by throwing std::runtime_error.
+ */
+namespace trajectoryHdf5
+{
+constexpr int         VERSION    = 1;
+constexpr std::size_t CHUNK_ROWS = 1 << 16; ///< rows per chunk of each dataset
+
+void writeColumns(const QString &fileName, const TrajectoryColumns &columns, double framerate);
+
+/// positions of files written in m are converted to cm; markerID and viewDir are optional
+TrajectoryColumns readColumns(const QString &fileName);
+} // namespace trajectoryHdf5
+
+#endif // TRAJECTORYHDF5_H
@@ -0,0 +1,304 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trcIndex.h"
+
+#include "logger.h"
+#include "trackPointColumns.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace
+{
+constexpr char          MAGIC[8]       = {'P', 'E', 'T', 'R', 'C', 'I', 'D', 'X'};
+constexpr std::uint32_t FORMAT_VERSION = 1;
+/// the index is written in the byte order of the machine; an index of another byte order is not used
+constexpr std::uint32_t BYTE_ORDER = 0x01020304;
+/// number of columns visited by TrackPointColumns::forEachColumn()
+constexpr int NUM_COLUMNS = 8;
+/// alignment of the columns in the file; suffices for all value types of the columns
+constexpr std::uint64_t COLUMN_ALIGNMENT = 16;
+
+struct IndexHeader
+{
+    char          magic[8];
+    std::uint32_t formatVersion;
+    std::uint32_t byteOrder;
+    std::int64_t  trcSize;
+    std::int64_t  trcModified; ///< ms since epoch
+    std::int32_t  trcVersion;
+    std::int32_t  numPersons;
+};
+
+struct PersonRecord
+{
+    std::int32_t                           nr;
+    std::int32_t                           firstFrame;
+    std::int32_t                           size;
+    std::int32_t                           colorCount;
+    std::int32_t                           markerID;
+    std::uint32_t                          color; ///< QRgb; 0 for an invalid color
+    double                                 height;
+    std::uint64_t                          commentOffset;
+    std::uint32_t                          commentBytes;
+    std::uint32_t                          unused;
+    std::array<std::uint64_t, NUM_COLUMNS> columnOffset;
+    std::array<std::int32_t, NUM_COLUMNS>  columnSize; ///< 0 for unused columns
+};
+
+static_assert(std::is_trivially_copyable_v<IndexHeader> && std::is_trivially_copyable_v<PersonRecord>);
+
+std::uint64_t aligned(std::uint64_t offset)
+{
+    return (offset + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+}
+
+/// size and modification time of the trc file, which the index has to match
+bool describeTrc(const QString &trcFile, IndexHeader &header)
+{
+    const QFileInfo info(trcFile);
+    if(!info.exists())
+    {
+        return false;
+    }
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.formatVersion = FORMAT_VERSION;
+    header.byteOrder     = BYTE_ORDER;
+    header.trcSize       = info.size();
+    header.trcModified   = info.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+bool writeZeros(QSaveFile &file, std::uint64_t count)
+{
+    static const char zeros[COLUMN_ALIGNMENT] = {};
+    return file.write(zeros, static_cast<qint64>(count)) == static_cast<qint64>(count);
+}
+} // namespace
+
+namespace IO
+{
+QString trcIndexName(const QString &trcFile)
+{
+    return trcFile + ".idx";
+}
+
+bool writeTrcIndex(const QString &trcFile, int version, const std::vector<TrackPerson> &persons)
+{
+    IndexHeader header{};
+    if(!describeTrc(trcFile, header))
+    {
+        return false;
+    }
+    header.trcVersion = version;
+    header.numPersons = static_cast<std::int32_t>(persons.size());
+
+    // copies share the points with the persons
+    std::vector<TrackPointColumns> columns;
+    std::vector<QByteArray>        comments;
+    std::vector<PersonRecord>      records(persons.size());
+    columns.reserve(persons.size());
+    comments.reserve(persons.size());
+
+    std::uint64_t offset = sizeof(IndexHeader) + persons.size() * sizeof(PersonRecord);
+    for(std::size_t i = 0; i < persons.size(); ++i)
+    {
+        const auto   &person = persons[i];
+        PersonRecord &record = records[i];
+        record.nr            = person.nr();
+        record.firstFrame    = person.firstFrame();
+        record.size          = person.size();
+        record.colorCount    = person.colCount();
+        record.markerID      = person.getMarkerID();
+        record.color         = person.color().isValid() ? person.color().rgba() : 0;
+        record.height        = person.height();
+        comments.push_back(person.comment().toUtf8());
+        record.commentOffset = offset;
+        record.commentBytes  = static_cast<std::uint32_t>(comments.back().size());
+        offset += record.commentBytes;
+    }
+    for(std::size_t i = 0; i < persons.size(); ++i)
+    {
+        columns.push_back(persons[i].columns());
+        int column = 0;
+        columns.back().forEachColumn(
+            [&](auto &values)
+            {
+                using T = typename std::decay_t<decltype(values)>::value_type;
+                static_assert(std::is_trivially_copyable_v<T>, "columns are written in their binary form");
+                static_assert(alignof(T) <= COLUMN_ALIGNMENT);
+                offset                          = aligned(offset);
+                records[i].columnOffset[column] = offset;
+                records[i].columnSize[column]   = values.size();
+                offset += values.size() * sizeof(T);
+                ++column;
+            });
+    }
+
+    QSaveFile file(trcIndexName(trcFile));
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        SPDLOG_WARN("Could not write the index {}: {}", trcIndexName(trcFile), file.errorString());
+        return false;
+    }
+    const auto  recordBytes = static_cast<qint64>(records.size() * sizeof(PersonRecord));
+    const char *recordData  = reinterpret_cast<const char *>(records.data());
+    bool        ok          = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+    ok                      = ok && file.write(recordData, recordBytes) == recordBytes;
+    for(const auto &comment : comments)
+    {
+        ok = ok && file.write(comment) == comment.size();
+    }
+    for(auto &personColumns : columns)
+    {
+        personColumns.forEachColumn(
+            [&](auto &values)
+            {
+                using T = typename std::decay_t<decltype(values)>::value_type;
+
+                const auto  padding   = aligned(file.pos()) - file.pos();
+                const auto  bytes     = static_cast<qint64>(values.size() * sizeof(T));
+                const char *valueData = reinterpret_cast<const char *>(values.data());
+
+                ok = ok && writeZeros(file, padding) && file.write(valueData, bytes) == bytes;
+            });
+    }
+    if(!ok || !file.commit())
+    {
+        SPDLOG_WARN("Could not write the index {}: {}", trcIndexName(trcFile), file.errorString());
+        return false;
+    }
+    SPDLOG_INFO("Wrote the index {} of {} persons.", trcIndexName(trcFile), persons.size());
+    return true;
+}
+
+std::optional<TrcData> readTrcIndex(const QString &trcFile)
+{
+    IndexHeader expected{};
+    if(!describeTrc(trcFile, expected))
+    {
+        return std::nullopt;
+    }
+    auto file = std::make_shared<QFile>(trcIndexName(trcFile));
+    if(!file->open(QIODevice::ReadOnly) || file->size() < static_cast<qint64>(sizeof(IndexHeader)))
+    {
+        return std::nullopt;
+    }
+    const auto   fileSize = static_cast<std::uint64_t>(file->size());
+    const uchar *base     = file->map(0, file->size());
+    if(!base)
+    {
+        return std::nullopt;
+    }
+    const std::shared_ptr<const void> mapping(
+        base, [file](const void *data) { file->unmap(static_cast<uchar *>(const_cast<void *>(data))); });
+
+    IndexHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.formatVersion != FORMAT_VERSION ||
+       header.byteOrder != BYTE_ORDER || header.trcSize != expected.trcSize ||
+       header.trcModified != expected.trcModified || header.numPersons < 0 ||
+       sizeof(IndexHeader) + static_cast<std::uint64_t>(header.numPersons) * sizeof(PersonRecord) > fileSize)
+    {
+        SPDLOG_INFO("The index {} does not belong to the current {}.", trcIndexName(trcFile), trcFile);
+        return std::nullopt;
+    }
+
+    TrcData data;
+    data.version = header.trcVersion;
+    data.persons.reserve(header.numPersons);
+    for(int i = 0; i < header.numPersons; ++i)
+    {
+        PersonRecord record;
+        std::memcpy(&record, base + sizeof(IndexHeader) + i * sizeof(PersonRecord), sizeof(record));
+        if(record.size < 1 || record.commentOffset + record.commentBytes > fileSize)
+        {
+            SPDLOG_WARN("The index {} is broken.", trcIndexName(trcFile));
+            return std::nullopt;
+        }
+
+        TrackPointColumns columns;
+        int               column = 0;
+        bool              valid  = true;
+        columns.forEachColumn(
+            [&](auto &values)
+            {
+                using T               = typename std::decay_t<decltype(values)>::value_type;
+                const auto size       = record.columnSize[column];
+                const auto offset     = record.columnOffset[column];
+                const bool isOptional = column > 2; // x, y and quality are stored for every point
+                ++column;
+                if(size == 0 && isOptional)
+                {
+                    return;
+                }
+                if(size != record.size || offset % COLUMN_ALIGNMENT != 0 ||
+                   offset + static_cast<std::uint64_t>(size) * sizeof(T) > fileSize)
+                {
+                    valid = false;
+                    return;
+                }
+                values.setMapped(reinterpret_cast<const T *>(base + offset), size, mapping);
+            });
+        if(!valid)
+        {
+            SPDLOG_WARN("The index {} is broken.", trcIndexName(trcFile));
+            return std::nullopt;
+        }
+
+        TrackPerson person(record.nr, record.firstFrame, columns.first());
+        person.setColumns(columns);
+        person.setHeight(record.height);
+        person.setColCount(record.colorCount);
+        person.setColor(record.color == 0 ? QColor() : QColor::fromRgba(record.color));
+        person.setMarkerID(record.markerID);
+        person.setComment(QString::fromUtf8(
+            reinterpret_cast<const char *>(base + record.commentOffset), static_cast<int>(record.commentBytes)));
+        data.persons.push_back(std::move(person));
+    }
+    return data;
+}
+
+std::variant<TrcData, std::string> readIndexedTrc(const QString &trcFile, qint64 minIndexedSize)
+{
+    if(auto indexed = readTrcIndex(trcFile))
+    {
+        SPDLOG_INFO("Read {} from its index {}.", trcFile, trcIndexName(trcFile));
+        return std::move(*indexed);
+    }
+    auto trc = readTrc(trcFile);
+    if(const auto *data = std::get_if<TrcData>(&trc); data && QFileInfo(trcFile).size() >= minIndexedSize &&
+                                                       writeTrcIndex(trcFile, data->version, data->persons))
+    {
+        if(auto indexed = readTrcIndex(trcFile))
+        {
+            // the points are read from the index from now on instead of taking memory
+            return std::move(*indexed);
+        }
+    }
+    return trc;
+}
+} // namespace IO
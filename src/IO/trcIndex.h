@@ -0,0 +1,67 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRCINDEX_H
+#define TRCINDEX_H
+
+#include "trcReader.h"
+
+#include <QString>
+#include <QtGlobal>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace IO
+{
+/// trc files from this size on get an index when they are read by readIndexedTrc()
+constexpr qint64 MIN_INDEXED_TRC_SIZE = 64 * 1024 * 1024;
+
+QString trcIndexName(const QString &trcFile);
+
+/**
+ * @brief Writes the index of the persons read from trcFile next to it (<trcFile>.idx)
+ *
+ * The index contains the header data of every person (number, frame range, marker ID,
+ * height, color and comment) and the offset of its points, which are stored in their
+ * binary form (see TrackPointColumns). It is only valid as long as trcFile is not modified.
+ */
+bool writeTrcIndex(const QString &trcFile, int version, const std::vector<TrackPerson> &persons);
+
+/**
+ * @brief Reads the persons of trcFile from its index without reading trcFile itself
+ *
+ * Only the header data of the persons is read. Their points are mapped from the index,
+ * so the operating system reads them when they are displayed, edited or exported and can
+ * drop them again at any time. Editing a person copies its points into memory.
+ *
+ * @return std::nullopt, if there is no index or it does not belong to the current trcFile
+ */
+std::optional<TrcData> readTrcIndex(const QString &trcFile);
+
+/**
+ * @brief Reads a trc file from its index, if it is up to date; otherwise with readTrc()
+ *
+ * Files from minIndexedSize on get a new index after reading, and the persons are
+ * returned mapped from it, so the points do not stay in memory.
+ */
+std::variant<TrcData, std::string> readIndexedTrc(const QString &trcFile, qint64 minIndexedSize = MIN_INDEXED_TRC_SIZE);
+} // namespace IO
+
+#endif // TRCINDEX_H
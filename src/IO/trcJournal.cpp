@@ -0,0 +1,227 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trcJournal.h"
+
+#include "bufferedTextWriter.h"
+#include "logger.h"
+#include "trcReader.h"
+
+#include <QBuffer>
+#include <charconv>
+#include <cstring>
+#include <optional>
+
+namespace
+{
+constexpr std::string_view ENTRY_START = "entry ";
+constexpr std::string_view ENTRY_END   = "end";
+
+/// returns the line at pos without line break and moves pos to the next line; nullopt at the end of the content
+std::optional<std::string_view> nextLine(const char *&pos, const char *end)
+{
+    if(pos == end)
+    {
+        return std::nullopt;
+    }
+    const char *lineEnd = static_cast<const char *>(std::memchr(pos, '\n', static_cast<std::size_t>(end - pos)));
+    if(!lineEnd)
+    {
+        // a line without line break was not completely written
+        return std::nullopt;
+    }
+    std::string_view line(pos, static_cast<std::size_t>(lineEnd - pos));
+    pos = lineEnd + 1;
+    if(!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+/// reads the space separated numbers of line, which have to be exactly count
+std::optional<std::vector<std::size_t>> readNumbers(std::string_view line, std::size_t count)
+{
+    std::vector<std::size_t> numbers;
+    numbers.reserve(count);
+    const char *pos = line.data();
+    const char *end = line.data() + line.size();
+    while(true)
+    {
+        while(pos != end && *pos == ' ')
+        {
+            ++pos;
+        }
+        if(pos == end)
+        {
+            break;
+        }
+        std::size_t value;
+        auto [ptr, ec] = std::from_chars(pos, end, value);
+        if(ec != std::errc() || (ptr != end && *ptr != ' '))
+        {
+            return std::nullopt;
+        }
+        numbers.push_back(value);
+        pos = ptr;
+    }
+    if(numbers.size() != count)
+    {
+        return std::nullopt;
+    }
+    return numbers;
+}
+
+/// applies one entry to persons; returns false if it does not fit to them
+bool applyEntry(
+    std::vector<TrackPerson>       &persons,
+    std::size_t                     numPersons,
+    const std::vector<std::size_t> &deleted,
+    const std::vector<std::size_t> &changedIndices,
+    std::vector<TrackPerson>      &&changedPersons)
+{
+    for(std::size_t index : deleted)
+    {
+        if(index >= persons.size())
+        {
+            return false;
+        }
+        persons.erase(persons.begin() + index);
+    }
+    if(numPersons < persons.size())
+    {
+        persons.erase(persons.begin() + numPersons, persons.end());
+    }
+    for(std::size_t i = 0; i < changedIndices.size(); ++i)
+    {
+        const std::size_t index = changedIndices[i];
+        if(index < persons.size())
+        {
+            persons[index] = std::move(changedPersons[i]);
+        }
+        else if(index == persons.size() && index < numPersons)
+        {
+            persons.push_back(std::move(changedPersons[i]));
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return persons.size() == numPersons;
+}
+} // namespace
+
+namespace IO
+{
+bool appendTrcJournal(QIODevice &journal, const TrcJournalEntry &entry)
+{
+    std::vector<TrackPerson> changedPersons;
+    changedPersons.reserve(entry.changed.size());
+    for(const auto &[index, person] : entry.changed)
+    {
+        changedPersons.push_back(person);
+    }
+    QBuffer trc;
+    trc.open(QIODevice::WriteOnly);
+    writeTrc(trc, changedPersons);
+
+    // the whole entry is written at once, so that it is either complete or cut off
+    BufferedTextWriter out(journal);
+    out.print(
+        "{}{} {} {} {}\n",
+        ENTRY_START,
+        entry.numPersons,
+        entry.deleted.size(),
+        entry.changed.size(),
+        trc.data().size());
+    for(std::size_t i = 0; i < entry.deleted.size(); ++i)
+    {
+        out.print("{}{}", i == 0 ? "" : " ", entry.deleted[i]);
+    }
+    out.print("\n");
+    for(std::size_t i = 0; i < entry.changed.size(); ++i)
+    {
+        out.print("{}{}", i == 0 ? "" : " ", entry.changed[i].first);
+    }
+    out.print("\n{}{}\n", std::string_view(trc.data().constData(), trc.data().size()), ENTRY_END);
+    return out.flush();
+}
+
+std::variant<int, std::string> applyTrcJournal(std::string_view journal, std::vector<TrackPerson> &persons)
+{
+    const char *pos = journal.data();
+    const char *end = journal.data() + journal.size();
+
+    int numEntries = 0;
+    while(auto header = nextLine(pos, end))
+    {
+        if(header->substr(0, ENTRY_START.size()) != ENTRY_START)
+        {
+            if(numEntries == 0)
+            {
+                return std::string("The file is no trc journal.");
+            }
+            SPDLOG_WARN("Ignoring invalid entry {} of the trc journal.", numEntries + 1);
+            break;
+        }
+        const auto counts  = readNumbers(header->substr(ENTRY_START.size()), 4);
+        const auto deleted = nextLine(pos, end);
+        const auto changed = nextLine(pos, end);
+        if(!counts || !deleted || !changed)
+        {
+            break;
+        }
+        const auto numPersons     = (*counts)[0];
+        const auto deletedIndices = readNumbers(*deleted, (*counts)[1]);
+        const auto changedIndices = readNumbers(*changed, (*counts)[2]);
+        const auto trcSize        = (*counts)[3];
+        if(!deletedIndices || !changedIndices || trcSize > static_cast<std::size_t>(end - pos))
+        {
+            break;
+        }
+        const std::string_view trc(pos, trcSize);
+        pos += trcSize;
+        if(nextLine(pos, end) != std::optional<std::string_view>(ENTRY_END))
+        {
+            break;
+        }
+
+        auto result = parseTrc(trc, false);
+        if(std::holds_alternative<std::string>(result))
+        {
+            SPDLOG_WARN("Ignoring entry {} of the trc journal: {}", numEntries + 1, std::get<std::string>(result));
+            break;
+        }
+        auto &trcData = std::get<TrcData>(result);
+
+        // copies of the persons are cheap; the state before an invalid entry is kept
+        auto updated = persons;
+        if(trcData.persons.size() != changedIndices->size() ||
+           !applyEntry(updated, numPersons, *deletedIndices, *changedIndices, std::move(trcData.persons)))
+        {
+            SPDLOG_WARN(
+                "Ignoring entry {} of the trc journal, which does not fit to the trajectories.", numEntries + 1);
+            break;
+        }
+        persons = std::move(updated);
+        ++numEntries;
+    }
+    return numEntries;
+}
+} // namespace IO
@@ -0,0 +1,78 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRCJOURNAL_H
+#define TRCJOURNAL_H
+
+#include "tracker.h"
+
+#include <QIODevice>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace IO
+{
+/**
+ * @brief Changes of the trajectories between two autosaves
+ *
+ * Applied to the trajectories of the previous save, first the persons at the indices in
+ * deleted are removed one after another, then the number of persons is set to numPersons
+ * and the changed persons are set at their index. All persons behind the trajectories of
+ * the previous save have to be part of changed.
+ */
+struct TrcJournalEntry
+{
+    std::size_t                                      numPersons = 0;
+    std::vector<std::size_t>                         deleted; ///< in order of deletion
+    std::vector<std::pair<std::size_t, TrackPerson>> changed; ///< ascending indices
+};
+
+/**
+ * @brief Appends entry to a journal of changes of a trc file
+ *
+ * Every entry is a text record
+ *
+ *     entry <numPersons> <numDeleted> <numChanged> <bytes>
+ *     <deleted indices>
+ *     <changed indices>
+ *     <bytes of a trc file (Petrack::trcVersion) with the changed persons>
+ *     end
+ *
+ * Since entries are only appended, an interrupted write leaves an incomplete last
+ * record, which is ignored by applyTrcJournal().
+ *
+ * @return false, if writing to journal failed
+ */
+bool appendTrcJournal(QIODevice &journal, const TrcJournalEntry &entry);
+
+/**
+ * @brief Applies all complete entries of a journal to persons
+ *
+ * Reading stops at the first incomplete or invalid entry, e.g. after a crash while
+ * writing it; persons contains the state of the last complete entry then.
+ *
+ * @return number of applied entries or an error message, if the journal is no journal
+ */
+std::variant<int, std::string> applyTrcJournal(std::string_view journal, std::vector<TrackPerson> &persons);
+} // namespace IO
+
+#endif // TRCJOURNAL_H
@@ -0,0 +1,398 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trcReader.h"
+
+#include "compressedFile.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <opencv2/core.hpp>
+#include <optional>
+
+namespace
+{
+/// persons with fewer points are not worth a parallel parse
+constexpr std::size_t MIN_POINTS_PER_THREAD = 10000;
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+bool isBlank(std::string_view line)
+{
+    return std::all_of(line.begin(), line.end(), isSpace);
+}
+
+/// reads whitespace separated numbers from [begin, end)
+class NumberReader
+{
+public:
+    NumberReader(const char *begin, const char *end) : mPos(begin), mEnd(end) {}
+    explicit NumberReader(std::string_view text) : mPos(text.data()), mEnd(text.data() + text.size()) {}
+
+    bool read(int &value)
+    {
+        skipSpaces();
+        auto [ptr, ec] = std::from_chars(mPos, mEnd, value);
+        return advance(ptr, ec == std::errc());
+    }
+
+    bool read(double &value)
+    {
+        skipSpaces();
+#if defined(__cpp_lib_to_chars)
+        auto [ptr, ec] = std::from_chars(mPos, mEnd, value);
+        return advance(ptr, ec == std::errc());
+#else
+        // no floating point std::from_chars in this standard library; QByteArray does not depend on the locale either
+        const char *tokenEnd = mPos;
+        while(tokenEnd != mEnd && !isSpace(*tokenEnd))
+        {
+            ++tokenEnd;
+        }
+        bool ok = false;
+        value   = QByteArray::fromRawData(mPos, static_cast<int>(tokenEnd - mPos)).toDouble(&ok);
+        return advance(tokenEnd, ok);
+#endif
+    }
+
+    /// same format as operator>>(QTextStream &, QColor &): -1 -1 -1 is an invalid color
+    bool read(QColor &color)
+    {
+        int red, green, blue;
+        if(!read(red) || !read(green) || !read(blue))
+        {
+            return false;
+        }
+        color = (red == -1) ? QColor() : QColor(red, green, blue);
+        return true;
+    }
+
+    const char *pos() const { return mPos; }
+    /// true, if only whitespace is left
+    bool atEnd()
+    {
+        skipSpaces();
+        return mPos == mEnd;
+    }
+
+private:
+    void skipSpaces()
+    {
+        while(mPos != mEnd && isSpace(*mPos))
+        {
+            ++mPos;
+        }
+    }
+
+    /// accepts a number only if it covers the whole token
+    bool advance(const char *ptr, bool ok)
+    {
+        if(!ok || ptr == mPos || (ptr != mEnd && !isSpace(*ptr)))
+        {
+            return false;
+        }
+        mPos = ptr;
+        return true;
+    }
+
+    const char *mPos;
+    const char *mEnd;
+};
+
+/// returns the line at pos without line break and moves pos to the next line
+std::string_view nextLine(const char *&pos, const char *end)
+{
+    const char *lineEnd = static_cast<const char *>(std::memchr(pos, '\n', static_cast<std::size_t>(end - pos)));
+    const char *next    = lineEnd ? lineEnd + 1 : end;
+    if(!lineEnd)
+    {
+        lineEnd = end;
+    }
+    if(lineEnd != pos && *(lineEnd - 1) == '\r')
+    {
+        --lineEnd;
+    }
+    std::string_view line(pos, static_cast<std::size_t>(lineEnd - pos));
+    pos = next;
+    return line;
+}
+
+/// header line and position of the points of one person, as found by the index pass
+struct PersonBlock
+{
+    int              nr;
+    double           height;
+    int              firstFrame;
+    int              lastFrame;
+    int              colorCount;
+    QColor           color;
+    int              markerID = -1;
+    int              size;
+    std::string_view comment;
+    const char      *points;
+    const char      *end;
+};
+
+/// same format as operator>>(QTextStream &, TrackPoint &)
+bool readTrackPoint(NumberReader &reader, int version, TrackPoint &point)
+{
+    double x, y;
+    if(!reader.read(x) || !reader.read(y))
+    {
+        return false;
+    }
+    point = TrackPoint(Vec2F(x, y));
+
+    if(version > 1)
+    {
+        double spX, spY, spZ;
+        if(!reader.read(spX) || !reader.read(spY) || !reader.read(spZ))
+        {
+            return false;
+        }
+        point.setSp(Vec3F(spX, spY, spZ));
+    }
+
+    int    qual;
+    double colX, colY;
+    QColor color;
+    if(!reader.read(qual) || !reader.read(colX) || !reader.read(colY) || !reader.read(color))
+    {
+        return false;
+    }
+    point.setQual(qual);
+    point.setColPoint(Vec2F(colX, colY));
+    point.setCol(color);
+
+    if(version > 2)
+    {
+        int markerID;
+        if(!reader.read(markerID))
+        {
+            return false;
+        }
+        point.setMarkerID(markerID);
+    }
+    return true;
+}
+
+std::optional<TrackPerson> parsePerson(const PersonBlock &block, int version)
+{
+    NumberReader reader(block.points, block.end);
+    TrackPoint   point;
+    if(!readTrackPoint(reader, version, point))
+    {
+        return std::nullopt;
+    }
+
+    TrackPerson person(block.nr, block.firstFrame, point);
+    person.reserve(block.size);
+    person.setHeight(block.height);
+    person.setColCount(block.colorCount);
+    person.setColor(block.color);
+    person.setMarkerID(block.markerID);
+    if(!block.comment.empty())
+    {
+        person.setComment(QString::fromUtf8(block.comment.data(), static_cast<int>(block.comment.size()))
+                              .replace("<br>", "\n"));
+    }
+
+    for(int i = 1; i < block.size; ++i)
+    {
+        if(!readTrackPoint(reader, version, point))
+        {
+            return std::nullopt;
+        }
+        person.append(point);
+    }
+    return person;
+}
+} // namespace
+
+namespace IO
+{
+std::variant<TrcData, std::string> readTrc(const QString &fileName, bool parallel)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return "Could not open " + fileName.toStdString();
+    }
+    if(file.size() == 0)
+    {
+        return "The file " + fileName.toStdString() + " is empty.";
+    }
+
+    if(compression::isCompressed(fileName))
+    {
+        compression::Reader reader(file, true);
+        if(!reader.open(QIODevice::ReadOnly))
+        {
+            return "Could not read " + fileName.toStdString() + ": " + reader.errorString().toStdString();
+        }
+        QByteArray content;
+        QByteArray block(1 << 20, Qt::Uninitialized);
+        qint64     read = 0;
+        while((read = reader.read(block.data(), block.size())) > 0)
+        {
+            content.append(block.constData(), static_cast<int>(read));
+        }
+        if(read < 0)
+        {
+            return "Could not read " + fileName.toStdString() + ": " + reader.errorString().toStdString();
+        }
+        return parseTrc(std::string_view(content.constData(), static_cast<std::size_t>(content.size())), parallel);
+    }
+
+    // persons do not refer to the content, so it may be unmapped after parsing
+    if(const uchar *data = file.map(0, file.size()))
+    {
+        return parseTrc(
+            std::string_view(reinterpret_cast<const char *>(data), static_cast<std::size_t>(file.size())), parallel);
+    }
+    // e.g. on file systems without memory mapping
+    const QByteArray content = file.readAll();
+    return parseTrc(std::string_view(content.constData(), static_cast<std::size_t>(content.size())), parallel);
+}
+
+std::variant<TrcData, std::string> parseTrc(std::string_view content, bool parallel)
+{
+    if(content.empty())
+    {
+        return std::string("The file is empty.");
+    }
+    const char *pos = content.data();
+    const char *end = content.data() + content.size();
+
+    TrcData data;
+    int     numPersons = 0;
+
+    // the first version only has the number of persons in the first line
+    const std::string_view firstLine = nextLine(pos, end);
+    if(NumberReader firstReader(firstLine); firstReader.read(numPersons) && firstReader.atEnd())
+    {
+        data.version = 1;
+    }
+    else
+    {
+        const QString header = QString::fromUtf8(firstLine.data(), static_cast<int>(firstLine.size()));
+        for(int version = 4; version >= 2; --version)
+        {
+            if(header.contains(QString("version %1").arg(version), Qt::CaseInsensitive))
+            {
+                data.version = version;
+                break;
+            }
+        }
+        if(data.version == 0)
+        {
+            return std::string("Not supported trc version.");
+        }
+
+        NumberReader reader(pos, end);
+        if(!reader.read(numPersons))
+        {
+            return std::string("Missing number of persons.");
+        }
+        pos = reader.pos();
+    }
+    if(numPersons < 0)
+    {
+        return std::string("Invalid number of persons.");
+    }
+
+    // index pass: header of each person and the range of its points
+    std::vector<PersonBlock> blocks(static_cast<std::size_t>(numPersons));
+    std::size_t              numPoints = 0;
+    for(int i = 0; i < numPersons; ++i)
+    {
+        while(pos != end && isSpace(*pos))
+        {
+            ++pos;
+        }
+        if(pos == end)
+        {
+            return "The file contains only " + std::to_string(i) + " of " + std::to_string(numPersons) + " persons.";
+        }
+
+        PersonBlock &block = blocks[i];
+        NumberReader header(nextLine(pos, end));
+        if(!header.read(block.nr) || !header.read(block.height) || !header.read(block.firstFrame) ||
+           !header.read(block.lastFrame) || !header.read(block.colorCount) || !header.read(block.color) ||
+           (data.version > 3 && !header.read(block.markerID)) || !header.read(block.size) || block.size < 1)
+        {
+            return "Invalid header of person " + std::to_string(i + 1) + ".";
+        }
+        if(data.version > 2)
+        {
+            block.comment = nextLine(pos, end);
+        }
+
+        block.points = pos;
+        for(int point = 0; point < block.size;)
+        {
+            if(pos == end)
+            {
+                return "Missing points of person " + std::to_string(i + 1) + ".";
+            }
+            // blank lines are skipped like by the token wise reading of fromTrc
+            if(!isBlank(nextLine(pos, end)))
+            {
+                ++point;
+            }
+        }
+        block.end = pos;
+        numPoints += static_cast<std::size_t>(block.size);
+    }
+
+    std::vector<std::optional<TrackPerson>> persons(blocks.size());
+    auto parseRange = [&](const cv::Range &range)
+    {
+        for(int i = range.start; i < range.end; ++i)
+        {
+            persons[i] = parsePerson(blocks[i], data.version);
+        }
+    };
+    if(parallel && numPoints >= 2 * MIN_POINTS_PER_THREAD)
+    {
+        cv::parallel_for_(
+            cv::Range(0, numPersons), parseRange, static_cast<double>(numPoints) / MIN_POINTS_PER_THREAD);
+    }
+    else
+    {
+        parseRange(cv::Range(0, numPersons));
+    }
+
+    data.persons.reserve(persons.size());
+    for(std::size_t i = 0; i < persons.size(); ++i)
+    {
+        if(!persons[i])
+        {
+            return "Invalid track point of person " + std::to_string(i + 1) + ".";
+        }
+        data.persons.push_back(std::move(*persons[i]));
+    }
+    return data;
+}
+} // namespace IO
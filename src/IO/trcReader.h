@@ -0,0 +1,58 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRCREADER_H
+#define TRCREADER_H
+
+#include "tracker.h"
+
+#include <QString>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace IO
+{
+/// content of a trc file
+struct TrcData
+{
+    int                      version = 0; ///< file version 1..4
+    std::vector<TrackPerson> persons;
+};
+
+/**
+ * @brief Reads a trc file of version 1 to 4 without going through QTextStream
+ *
+ * The file is memory mapped. A first pass only reads the header line of each
+ * person and skips its points line by line, which gives the boundaries of the
+ * persons. The points are then parsed with std::from_chars, for many persons
+ * in parallel, into trajectories reserved for their number of points.
+ *
+ * In contrast to fromTrc, every point has to be on its own line, as written by
+ * PeTrack. Compressed files (*.trc.zst) are decompressed into memory first.
+ *
+ * @return the persons in file order or an error message
+ */
+std::variant<TrcData, std::string> readTrc(const QString &fileName, bool parallel = true);
+
+/// parses the content of a trc file, see readTrc()
+std::variant<TrcData, std::string> parseTrc(std::string_view content, bool parallel = true);
+} // namespace IO
+
+#endif // TRCREADER_H
@@ -0,0 +1,107 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "videoDecoder.h"
+
+#include "logger.h"
+
+#include <opencv2/imgproc.hpp>
+
+namespace videoDecoder
+{
+/**
+ * @brief Opens the video file with the requested decoding backend
+ *
+ * Hardware accelerated decoding is requested via the FFmpeg backend of OpenCV
+ * (VAAPI, D3D11, MFX, ...). If the video cannot be opened that way, it is
+ * opened with the default CPU decoder.
+ *
+ * @param capture capture to open
+ * @param fileName video file
+ * @param acceleration requested acceleration; VIDEO_ACCELERATION_NONE for CPU decoding
+ * @return true, if the video could be opened with any backend
+ */
+bool open(cv::VideoCapture &capture, const std::string &fileName, cv::VideoAccelerationType acceleration)
+{
+    if(acceleration != cv::VIDEO_ACCELERATION_NONE)
+    {
+        if(capture.open(fileName, cv::CAP_FFMPEG, {cv::CAP_PROP_HW_ACCELERATION, acceleration}))
+        {
+            const int used = static_cast<int>(capture.get(cv::CAP_PROP_HW_ACCELERATION));
+            if(used == cv::VIDEO_ACCELERATION_NONE)
+            {
+                SPDLOG_WARN("No hardware accelerated decoding available for {}, using CPU decoding.", fileName);
+            }
+            else
+            {
+                SPDLOG_INFO("Using hardware accelerated decoding ({}) for {}.", accelerationName(used), fileName);
+            }
+            return true;
+        }
+        SPDLOG_WARN("Could not open {} with hardware accelerated decoding, falling back to CPU decoding.", fileName);
+    }
+    return capture.open(fileName);
+}
+
+/// Converts a decoded BGR(A) frame to a single channel gray image (in place)
+void toGrayscale(cv::Mat &img)
+{
+    if(img.channels() == 3)
+    {
+        cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);
+    }
+    else if(img.channels() == 4)
+    {
+        cv::cvtColor(img, img, cv::COLOR_BGRA2GRAY);
+    }
+}
+
+/// Converts the value stored in the project file to an acceleration type (unknown values mean CPU decoding)
+cv::VideoAccelerationType toAcceleration(int value)
+{
+    switch(value)
+    {
+        case cv::VIDEO_ACCELERATION_ANY:
+        case cv::VIDEO_ACCELERATION_D3D11:
+        case cv::VIDEO_ACCELERATION_VAAPI:
+        case cv::VIDEO_ACCELERATION_MFX:
+            return static_cast<cv::VideoAccelerationType>(value);
+        default:
+            return cv::VIDEO_ACCELERATION_NONE;
+    }
+}
+
+std::string accelerationName(int acceleration)
+{
+    switch(acceleration)
+    {
+        case cv::VIDEO_ACCELERATION_NONE:
+            return "none";
+        case cv::VIDEO_ACCELERATION_ANY:
+            return "any";
+        case cv::VIDEO_ACCELERATION_D3D11:
+            return "D3D11";
+        case cv::VIDEO_ACCELERATION_VAAPI:
+            return "VAAPI";
+        case cv::VIDEO_ACCELERATION_MFX:
+            return "MFX";
+        default:
+            return "unknown";
+    }
+}
+} // namespace videoDecoder
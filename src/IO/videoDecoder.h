@@ -0,0 +1,35 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VIDEODECODER_H
+#define VIDEODECODER_H
+
+#include <opencv2/videoio.hpp>
+#include <string>
+
+namespace videoDecoder
+{
+bool open(cv::VideoCapture &capture, const std::string &fileName, cv::VideoAccelerationType acceleration);
+
+void toGrayscale(cv::Mat &img);
+
+cv::VideoAccelerationType toAcceleration(int value);
+std::string               accelerationName(int acceleration);
+} // namespace videoDecoder
+
+#endif // VIDEODECODER_H
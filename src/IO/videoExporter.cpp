@@ -0,0 +1,180 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "videoExporter.h"
+
+#include "logger.h"
+#include "videoDecoder.h"
+
+#include <opencv2/imgproc.hpp>
+
+VideoExporter::~VideoExporter()
+{
+    close();
+}
+
+/**
+ * @brief Opens the video file for writing and starts the encoder thread
+ *
+ * With an acceleration other than VIDEO_ACCELERATION_NONE, the video is
+ * encoded as H.264 by a hardware encoder (NVENC, QSV, VAAPI, ...) via the
+ * FFmpeg backend of OpenCV. If no such encoder is available, the video is
+ * encoded with fourcc on the CPU.
+ *
+ * @param fileName exported video file
+ * @param fourcc codec used for encoding on the CPU
+ * @param fps frame rate of the video
+ * @param size size of the frames
+ * @param colored true for 3 channel frames, false for gray frames
+ * @param acceleration requested hardware acceleration
+ * @return true, if the video could be opened
+ */
+bool VideoExporter::open(
+    const std::string        &fileName,
+    int                       fourcc,
+    double                    fps,
+    cv::Size                  size,
+    bool                      colored,
+    cv::VideoAccelerationType acceleration)
+{
+    close();
+    if(acceleration != cv::VIDEO_ACCELERATION_NONE)
+    {
+        mWriter.open(
+            fileName,
+            cv::CAP_FFMPEG,
+            cv::VideoWriter::fourcc('a', 'v', 'c', '1'),
+            fps,
+            size,
+            {cv::VIDEOWRITER_PROP_HW_ACCELERATION, acceleration, cv::VIDEOWRITER_PROP_IS_COLOR, colored});
+        if(mWriter.isOpened() &&
+           static_cast<int>(mWriter.get(cv::VIDEOWRITER_PROP_HW_ACCELERATION)) != cv::VIDEO_ACCELERATION_NONE)
+        {
+            SPDLOG_INFO(
+                "Using hardware accelerated encoding ({}) for {}.",
+                videoDecoder::accelerationName(static_cast<int>(mWriter.get(cv::VIDEOWRITER_PROP_HW_ACCELERATION))),
+                fileName);
+        }
+        else
+        {
+            SPDLOG_WARN("No hardware accelerated encoding available for {}, using CPU encoding.", fileName);
+            mWriter.release();
+        }
+    }
+    if(!mWriter.isOpened() && !mWriter.open(fileName, fourcc, fps, size, colored))
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueue.clear();
+        mClosing = false;
+    }
+    mWorker = std::thread(&VideoExporter::run, this);
+    return true;
+}
+
+/**
+ * @brief Queues frame for encoding; blocks while the queue is full
+ *
+ * @param frame frame to encode; must not be modified afterwards by the caller
+ * @return false, if the video is not opened
+ */
+bool VideoExporter::write(cv::Mat frame)
+{
+    return enqueue({std::move(frame), QImage()});
+}
+
+/**
+ * @brief Queues image (in QImage::Format_RGB32) for encoding; blocks while the queue is full
+ *
+ * image is implicitly shared, so the caller may render the next frame into a new image
+ * while this one is converted to a 3 channel frame by the encoder thread.
+ *
+ * @return false, if the video is not opened
+ */
+bool VideoExporter::write(const QImage &image)
+{
+    return enqueue({cv::Mat(), image});
+}
+
+bool VideoExporter::enqueue(Frame frame)
+{
+    if(!isOpened())
+    {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(mMutex);
+    mSpaceReady.wait(lock, [this] { return mQueue.size() < QUEUE_SIZE; });
+    mQueue.push_back(std::move(frame));
+    lock.unlock();
+    mFrameReady.notify_one();
+    return true;
+}
+
+/**
+ * @brief Encodes all queued frames and closes the video file
+ */
+void VideoExporter::close()
+{
+    if(!mWorker.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosing = true;
+    }
+    mFrameReady.notify_one();
+    mWorker.join();
+    mWriter.release();
+}
+
+void VideoExporter::run()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while(true)
+    {
+        mFrameReady.wait(lock, [this] { return !mQueue.empty() || mClosing; });
+        if(mQueue.empty())
+        {
+            // closing and everything is written
+            return;
+        }
+        Frame frame = std::move(mQueue.front());
+        mQueue.pop_front();
+        lock.unlock();
+        mSpaceReady.notify_one();
+
+        if(!frame.image.isNull())
+        {
+            const cv::Mat view(
+                frame.image.height(),
+                frame.image.width(),
+                CV_8UC4,
+                const_cast<uchar *>(frame.image.constBits()),
+                static_cast<std::size_t>(frame.image.bytesPerLine()));
+            cv::cvtColor(view, frame.mat, cv::COLOR_RGBA2RGB); // need for right image interpretation
+            frame.image = QImage(); // the exporting thread may render into it again
+        }
+        mWriter.write(frame.mat);
+
+        lock.lock();
+    }
+}
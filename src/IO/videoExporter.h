@@ -0,0 +1,84 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VIDEOEXPORTER_H
+#define VIDEOEXPORTER_H
+
+#include <QImage>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <opencv2/videoio.hpp>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Encodes exported frames in a dedicated thread
+ *
+ * The exporting (GUI) thread renders the frames and hands them over via
+ * write(); converting, encoding and writing the file overlap with rendering
+ * the next frames. The queue is bounded, so a slow encoder throttles the export
+ * instead of filling the memory.
+ */
+class VideoExporter
+{
+public:
+    VideoExporter() = default;
+    ~VideoExporter();
+
+    VideoExporter(const VideoExporter &)            = delete;
+    VideoExporter &operator=(const VideoExporter &) = delete;
+
+    bool open(
+        const std::string        &fileName,
+        int                       fourcc,
+        double                    fps,
+        cv::Size                  size,
+        bool                      colored,
+        cv::VideoAccelerationType acceleration);
+    bool isOpened() const { return mWorker.joinable(); }
+
+    bool write(cv::Mat frame);
+    bool write(const QImage &image);
+    void close();
+
+private:
+    /// frame waiting for the encoder; rendered views are converted to cv::Mat in the encoder thread
+    struct Frame
+    {
+        cv::Mat mat;
+        QImage  image;
+    };
+
+    bool enqueue(Frame frame);
+    void run();
+
+    // frames waiting for the encoder at most
+    static constexpr std::size_t QUEUE_SIZE = 16;
+
+    cv::VideoWriter mWriter;
+    std::thread     mWorker;
+
+    std::mutex              mMutex;
+    std::condition_variable mFrameReady;
+    std::condition_variable mSpaceReady;
+    std::deque<Frame>       mQueue;
+    bool                    mClosing = false;
+};
+
+#endif // VIDEOEXPORTER_H
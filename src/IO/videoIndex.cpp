@@ -0,0 +1,217 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "videoIndex.h"
+
+#include "logger.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <opencv2/opencv.hpp>
+
+namespace
+{
+constexpr const char *SIDECAR_HEADER  = "PETRACK_VIDEO_INDEX";
+constexpr int         SIDECAR_VERSION = 2;
+} // namespace
+
+/**
+ * @brief Loads the index of the video from its sidecar or builds (and saves) it
+ *
+ * Meant to be run in a background thread.
+ *
+ * @param videoFile name of the video file
+ * @param abort building is stopped and an empty index is returned, if set
+ * @return the index, empty if it could neither be loaded nor built
+ */
+VideoIndex VideoIndex::create(const QString &videoFile, const std::atomic_bool &abort)
+{
+    VideoIndex index;
+    if(index.load(videoFile))
+    {
+        return index;
+    }
+    if(index.build(videoFile, abort))
+    {
+        index.save(videoFile);
+    }
+    return index;
+}
+
+QString VideoIndex::sidecarName(const QString &videoFile)
+{
+    return videoFile + ".pidx";
+}
+
+/**
+ * @brief Returns the last keyframe at or before frame
+ *
+ * @return index of the keyframe; frame itself if the index is empty
+ */
+int VideoIndex::keyFrameBefore(int frame) const
+{
+    auto it = std::upper_bound(mKeyFrames.begin(), mKeyFrames.end(), frame);
+    if(it == mKeyFrames.begin())
+    {
+        return mKeyFrames.empty() ? frame : 0;
+    }
+    return *std::prev(it);
+}
+
+/**
+ * @brief Builds the index by reading all packets of the video stream without decoding them
+ *
+ * @return true, if the video supports reading raw packets and contains at least one keyframe
+ */
+bool VideoIndex::build(const QString &videoFile, const std::atomic_bool &abort)
+{
+    mKeyFrames.clear();
+    mTimestamps.clear();
+    mNumFrames = 0;
+
+    cv::VideoCapture capture;
+    if(!capture.open(videoFile.toStdString(), cv::CAP_FFMPEG, {cv::CAP_PROP_FORMAT, -1}))
+    {
+        SPDLOG_WARN("Could not open {} for building a keyframe index.", videoFile);
+        return false;
+    }
+
+    int frame = 0;
+    while(!abort && capture.grab())
+    {
+        if(capture.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0)
+        {
+            mKeyFrames.push_back(frame);
+        }
+        mTimestamps.push_back(capture.get(cv::CAP_PROP_POS_MSEC) / 1000.);
+        ++frame;
+    }
+    if(abort)
+    {
+        mKeyFrames.clear();
+        mTimestamps.clear();
+        return false;
+    }
+    mNumFrames = frame;
+
+    // packets are read in decoding order, the i-th smallest timestamp belongs to frame i
+    std::sort(mTimestamps.begin(), mTimestamps.end());
+    if(mTimestamps.empty() || !std::isfinite(mTimestamps.front()) || !std::isfinite(mTimestamps.back()) ||
+       std::adjacent_find(mTimestamps.begin(), mTimestamps.end()) != mTimestamps.end())
+    {
+        mTimestamps.clear();
+    }
+    else
+    {
+        const double first = mTimestamps.front();
+        for(double &timestamp : mTimestamps)
+        {
+            timestamp -= first;
+        }
+    }
+    return !mKeyFrames.empty();
+}
+
+/**
+ * @brief Reads the sidecar of videoFile
+ *
+ * @return true, if the sidecar exists and belongs to the current state of the video
+ */
+bool VideoIndex::load(const QString &videoFile)
+{
+    QFile file(sidecarName(videoFile));
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return false;
+    }
+
+    const QFileInfo videoInfo(videoFile);
+    QTextStream     in(&file);
+    QString         header;
+    int             version       = -1;
+    qint64          size          = -1;
+    qint64          modified      = -1;
+    int             numKeyFrames  = 0;
+    int             numTimestamps = 0;
+    in >> header >> version >> size >> modified >> mNumFrames >> numKeyFrames >> numTimestamps;
+    if(header != SIDECAR_HEADER || version != SIDECAR_VERSION || size != videoInfo.size() ||
+       modified != videoInfo.lastModified().toMSecsSinceEpoch() || numKeyFrames <= 0)
+    {
+        SPDLOG_INFO("Keyframe index {} is outdated and will be rebuilt.", file.fileName());
+        mNumFrames = 0;
+        return false;
+    }
+
+    mKeyFrames.resize(numKeyFrames);
+    for(int &keyFrame : mKeyFrames)
+    {
+        in >> keyFrame;
+    }
+    mTimestamps.resize(std::max(numTimestamps, 0));
+    for(double &timestamp : mTimestamps)
+    {
+        in >> timestamp;
+    }
+    if(in.status() != QTextStream::Ok || !std::is_sorted(mKeyFrames.begin(), mKeyFrames.end()) ||
+       !std::is_sorted(mTimestamps.begin(), mTimestamps.end()))
+    {
+        SPDLOG_WARN("Keyframe index {} is corrupt and will be rebuilt.", file.fileName());
+        mKeyFrames.clear();
+        mTimestamps.clear();
+        mNumFrames = 0;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the index to the sidecar of videoFile
+ *
+ * A failure (e.g. video on a read-only share) is not critical, the index is
+ * just built again at the next open.
+ */
+bool VideoIndex::save(const QString &videoFile) const
+{
+    QFile file(sidecarName(videoFile));
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_WARN("Could not write keyframe index {}: {}", file.fileName(), file.errorString());
+        return false;
+    }
+
+    const QFileInfo videoInfo(videoFile);
+    QTextStream     out(&file);
+    out << SIDECAR_HEADER << " " << SIDECAR_VERSION << "\n";
+    out << videoInfo.size() << " " << videoInfo.lastModified().toMSecsSinceEpoch() << "\n";
+    out << mNumFrames << " " << static_cast<int>(mKeyFrames.size()) << " " << static_cast<int>(mTimestamps.size())
+        << "\n";
+    for(int keyFrame : mKeyFrames)
+    {
+        out << keyFrame << "\n";
+    }
+    out.setRealNumberPrecision(10);
+    for(double timestamp : mTimestamps)
+    {
+        out << timestamp << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VIDEOINDEX_H
+#define VIDEOINDEX_H
+
+#include <QString>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Index of the keyframes of a video file
+ *
+ * The index is built by demuxing the video once without decoding it (raw packet
+ * mode of cv::VideoCapture) and is stored in a sidecar file next to the video
+ * (<video>.pidx), so it only has to be built on the first open. The sidecar
+ * contains size and modification time of the video and is rebuilt if the video
+ * changed.
+ *
+ * With the index a seek to frame n only has to go to the keyframe before n and
+ * decode forward, which bounds the cost of a seek by the length of a GOP.
+ *
+ * The index also holds the presentation timestamps of all frames, so videos with a
+ * variable frame rate show the time at which each frame was recorded.
+ */
+class VideoIndex
+{
+public:
+    VideoIndex() = default;
+
+    static VideoIndex create(const QString &videoFile, const std::atomic_bool &abort);
+    static QString    sidecarName(const QString &videoFile);
+
+    bool isEmpty() const { return mKeyFrames.empty(); }
+    int  getNumFrames() const { return mNumFrames; }
+
+    int keyFrameBefore(int frame) const;
+
+    const std::vector<int>    &getKeyFrames() const { return mKeyFrames; }
+    const std::vector<double> &getTimestamps() const { return mTimestamps; }
+
+    bool build(const QString &videoFile, const std::atomic_bool &abort);
+    bool load(const QString &videoFile);
+    bool save(const QString &videoFile) const;
+
+private:
+    std::vector<int>    mKeyFrames;  ///< sorted indices of all keyframes
+    std::vector<double> mTimestamps; ///< presentation time of every frame in s; empty, if unknown
+    int                 mNumFrames = 0;
+};
+
+#endif // VIDEOINDEX_H
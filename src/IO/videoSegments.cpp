@@ -0,0 +1,326 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "videoSegments.h"
+
+#include "logger.h"
+#include "videoDecoder.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+VideoSegments::~VideoSegments()
+{
+    close();
+}
+
+/**
+ * @brief Reads the video files listed in listFile
+ *
+ * Every line names one file, relative to the directory of listFile. Empty lines and
+ * lines starting with # are ignored.
+ *
+ * @return the absolute paths of the files in order; std::nullopt, if listFile cannot be read or lists no file
+ */
+std::optional<QStringList> VideoSegments::readList(const QString &listFile)
+{
+    QFile file(listFile);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not read the video list {}.", listFile);
+        return std::nullopt;
+    }
+    const QDir  dir = QFileInfo(listFile).dir();
+    QStringList files;
+    QTextStream stream(&file);
+    while(!stream.atEnd())
+    {
+        const QString line = stream.readLine().trimmed();
+        if(!line.isEmpty() && !line.startsWith('#'))
+        {
+            files << QDir::cleanPath(dir.absoluteFilePath(line));
+        }
+    }
+    if(files.isEmpty())
+    {
+        SPDLOG_ERROR("The video list {} contains no video file.", listFile);
+        return std::nullopt;
+    }
+    return files;
+}
+
+/**
+ * @brief Opens files as one sequence
+ *
+ * Every file is opened once to read its number of frames and frame rate, only the
+ * decoder of the first one is kept open. All files need the same frame size.
+ *
+ * @return false, if a file cannot be opened or does not fit the first one
+ */
+bool VideoSegments::open(const QStringList &files, cv::VideoAccelerationType acceleration)
+{
+    close();
+    mAcceleration = acceleration;
+
+    int    firstFrame = 0;
+    double startTime  = 0;
+    for(const auto &file : files)
+    {
+        auto decoder = std::make_unique<Decoder>();
+        if(!videoDecoder::open(decoder->capture, file.toStdString(), acceleration))
+        {
+            SPDLOG_ERROR("Could not open {} of the video list.", file);
+            close();
+            return false;
+        }
+        Segment segment;
+        segment.fileName   = file;
+        segment.firstFrame = firstFrame;
+        segment.numFrames  = static_cast<int>(decoder->capture.get(cv::CAP_PROP_FRAME_COUNT));
+        segment.fps        = decoder->capture.get(cv::CAP_PROP_FPS);
+        segment.startTime  = startTime;
+        const cv::Size size(
+            static_cast<int>(decoder->capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+            static_cast<int>(decoder->capture.get(cv::CAP_PROP_FRAME_HEIGHT)));
+        if(segment.numFrames <= 0 || segment.fps <= 0)
+        {
+            SPDLOG_ERROR("Could not read the number of frames and the frame rate of {}.", file);
+            close();
+            return false;
+        }
+        if(mSegments.empty())
+        {
+            mSize = size;
+        }
+        else if(size != mSize)
+        {
+            SPDLOG_ERROR(
+                "{} has {} x {} pixel instead of {} x {} like the first video of the list.",
+                file,
+                size.width,
+                size.height,
+                mSize.width,
+                mSize.height);
+            close();
+            return false;
+        }
+        if(!mDecoders.empty())
+        {
+            // opened again on first use
+            decoder->capture.release();
+        }
+        firstFrame += segment.numFrames;
+        startTime += segment.numFrames / segment.fps;
+        mSegments.push_back(segment);
+        mDecoders.push_back(std::move(decoder));
+    }
+    return isOpen();
+}
+
+/// Releases all decoders
+void VideoSegments::close()
+{
+    mOpenAhead.waitForFinished();
+    mOpenAheadSegment = -1;
+    mDecoders.clear();
+    mSegments.clear();
+    mSize = cv::Size();
+}
+
+/// Returns the number of frames of all files
+int VideoSegments::getNumFrames() const
+{
+    return mSegments.empty() ? 0 : mSegments.back().firstFrame + mSegments.back().numFrames;
+}
+
+/// Returns if the files have different frame rates, so the frames are not equidistant in time
+bool VideoSegments::hasVariableFps() const
+{
+    return std::any_of(
+        mSegments.begin(),
+        mSegments.end(),
+        [this](const Segment &segment) { return std::abs(segment.fps - mSegments.front().fps) > 1e-6; });
+}
+
+/// Returns the time of every frame in seconds since the first frame of the sequence
+std::vector<double> VideoSegments::frameTimes() const
+{
+    std::vector<double> times;
+    times.reserve(getNumFrames());
+    for(const auto &segment : mSegments)
+    {
+        for(int frame = 0; frame < segment.numFrames; ++frame)
+        {
+            times.push_back(segment.startTime + frame / segment.fps);
+        }
+    }
+    return times;
+}
+
+/// Returns the index of the file containing frame; -1, if frame is not part of the sequence
+int VideoSegments::segmentOf(int frame) const
+{
+    if(frame < 0 || frame >= getNumFrames())
+    {
+        return -1;
+    }
+    const auto next = std::upper_bound(
+        mSegments.begin(),
+        mSegments.end(),
+        frame,
+        [](int value, const Segment &segment) { return value < segment.firstFrame; });
+    return static_cast<int>(std::distance(mSegments.begin(), next)) - 1;
+}
+
+/**
+ * @brief Decodes frame of the sequence into img
+ *
+ * Near the end of a file, the next one is opened in the background.
+ *
+ * @return false, if frame is not part of the sequence or cannot be decoded
+ */
+bool VideoSegments::read(int frame, cv::Mat &img)
+{
+    const int segment = segmentOf(frame);
+    if(segment < 0)
+    {
+        return false;
+    }
+    const int localFrame = frame - mSegments[segment].firstFrame;
+    bool      ok         = false;
+    {
+        std::lock_guard<std::mutex> lock(mDecoders[segment]->mutex);
+        ok = readLocked(segment, localFrame, img);
+    }
+    if(localFrame >= mSegments[segment].numFrames - OPEN_AHEAD_FRAMES)
+    {
+        openAhead(segment + 1);
+    }
+    return ok;
+}
+
+/**
+ * @brief Decodes the given frames with one thread per file
+ *
+ * @param frames frames of the sequence, ascending within each file
+ * @return decoded frames in the order of frames; frames which could not be decoded are empty
+ */
+std::vector<cv::Mat> VideoSegments::readFrames(const std::vector<int> &frames)
+{
+    std::vector<cv::Mat>                  images(frames.size());
+    std::vector<std::vector<std::size_t>> framesOfSegment(mSegments.size());
+    for(std::size_t i = 0; i < frames.size(); ++i)
+    {
+        if(const int segment = segmentOf(frames[i]); segment >= 0)
+        {
+            framesOfSegment[segment].push_back(i);
+        }
+    }
+
+    std::vector<QFuture<void>> jobs;
+    for(std::size_t segment = 0; segment < mSegments.size(); ++segment)
+    {
+        if(framesOfSegment[segment].empty())
+        {
+            continue;
+        }
+        jobs.push_back(QtConcurrent::run(
+            [&, segment]()
+            {
+                std::lock_guard<std::mutex> lock(mDecoders[segment]->mutex);
+                for(std::size_t i : framesOfSegment[segment])
+                {
+                    readLocked(segment, frames[i] - mSegments[segment].firstFrame, images[i]);
+                }
+            }));
+    }
+    for(auto &job : jobs)
+    {
+        job.waitForFinished();
+    }
+    return images;
+}
+
+/// Opens the decoder of segment, if it is not open yet; its mutex has to be locked
+bool VideoSegments::openLocked(std::size_t segment)
+{
+    Decoder &decoder = *mDecoders[segment];
+    if(decoder.capture.isOpened())
+    {
+        return true;
+    }
+    if(decoder.failed)
+    {
+        return false;
+    }
+    if(!videoDecoder::open(decoder.capture, mSegments[segment].fileName.toStdString(), mAcceleration))
+    {
+        SPDLOG_ERROR("Could not open {} of the video list.", mSegments[segment].fileName);
+        decoder.failed = true;
+        return false;
+    }
+    decoder.nextFrame = 0;
+    return true;
+}
+
+/// Decodes localFrame of the file of segment into img; the mutex of its decoder has to be locked
+bool VideoSegments::readLocked(std::size_t segment, int localFrame, cv::Mat &img)
+{
+    if(!openLocked(segment))
+    {
+        return false;
+    }
+    Decoder  &decoder = *mDecoders[segment];
+    const int gap     = localFrame - decoder.nextFrame;
+    if(gap > 0 && gap <= MAX_GRAB_FRAMES)
+    {
+        for(int i = 0; i < gap; ++i)
+        {
+            decoder.capture.grab();
+        }
+    }
+    else if(gap != 0 && !decoder.capture.set(cv::CAP_PROP_POS_FRAMES, localFrame))
+    {
+        decoder.nextFrame = -1;
+        return false;
+    }
+    const bool ok     = decoder.capture.read(img) && !img.empty();
+    decoder.nextFrame = ok ? localFrame + 1 : -1; // -1 forces a seek on the next read
+    return ok;
+}
+
+/// Opens the decoder of segment in the background, so reading its first frame does not wait for it
+void VideoSegments::openAhead(std::size_t segment)
+{
+    if(segment >= mSegments.size() || static_cast<int>(segment) == mOpenAheadSegment || !mOpenAhead.isFinished())
+    {
+        return;
+    }
+    mOpenAheadSegment = static_cast<int>(segment);
+    mOpenAhead        = QtConcurrent::run(
+        [this, segment]()
+        {
+            std::lock_guard<std::mutex> lock(mDecoders[segment]->mutex);
+            openLocked(segment);
+        });
+}
@@ -0,0 +1,107 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VIDEOSEGMENTS_H
+#define VIDEOSEGMENTS_H
+
+#include <QFuture>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <mutex>
+#include <opencv2/videoio.hpp>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Consecutive video files played as one sequence
+ *
+ * Long recordings are often split into several files by the camera. The files are listed
+ * in a text file (*.vlist), one path per line, relative to the list. Their frames are
+ * numbered continuously: the first frame of a file follows the last frame of the previous
+ * one, also in time.
+ *
+ * Every file has its own decoder, which is opened on first use and keeps its position.
+ * So frames of different files can be decoded at the same time (e.g. by readFrames()),
+ * and a process tracking only a part of the sequence opens only the files of this part.
+ * Forward playback crosses a file boundary without seeking, as the next file is opened
+ * in the background shortly before the end of a file.
+ */
+class VideoSegments
+{
+public:
+    /// One file of the sequence
+    struct Segment
+    {
+        QString fileName;
+        int     firstFrame = 0; ///< number of the first frame in the whole sequence
+        int     numFrames  = 0;
+        double  fps        = 0;
+        double  startTime  = 0; ///< seconds from the first frame of the sequence to the first frame of the file
+    };
+
+    /// distance (in frames) to the end of a file at which the next file is opened
+    static constexpr int OPEN_AHEAD_FRAMES = 32;
+    /// gaps of up to this many frames are skipped by grabbing instead of seeking
+    static constexpr int MAX_GRAB_FRAMES = 16;
+
+    VideoSegments() = default;
+    ~VideoSegments();
+    VideoSegments(const VideoSegments &)            = delete;
+    VideoSegments &operator=(const VideoSegments &) = delete;
+
+    static std::optional<QStringList> readList(const QString &listFile);
+
+    bool open(const QStringList &files, cv::VideoAccelerationType acceleration);
+    void close();
+    bool isOpen() const { return !mSegments.empty(); }
+
+    const std::vector<Segment> &getSegments() const { return mSegments; }
+    int                         getNumFrames() const;
+    cv::Size                    getSize() const { return mSize; }
+    bool                        hasVariableFps() const;
+    std::vector<double>         frameTimes() const;
+
+    int segmentOf(int frame) const;
+
+    bool                 read(int frame, cv::Mat &img);
+    std::vector<cv::Mat> readFrames(const std::vector<int> &frames);
+
+private:
+    struct Decoder
+    {
+        std::mutex       mutex; ///< locked while the decoder is opened or reads
+        cv::VideoCapture capture;
+        int              nextFrame = 0; ///< frame of the file read next by capture
+        bool             failed    = false;
+    };
+
+    bool openLocked(std::size_t segment);
+    bool readLocked(std::size_t segment, int localFrame, cv::Mat &img);
+    void openAhead(std::size_t segment);
+
+    std::vector<Segment>                  mSegments;
+    std::vector<std::unique_ptr<Decoder>> mDecoders;
+    cv::Size                              mSize;
+    cv::VideoAccelerationType             mAcceleration = cv::VIDEO_ACCELERATION_NONE;
+
+    QFuture<void> mOpenAhead;             ///< opens the decoder of the next file
+    int           mOpenAheadSegment = -1; ///< segment opened by the last mOpenAhead
+};
+
+#endif // VIDEOSEGMENTS_H
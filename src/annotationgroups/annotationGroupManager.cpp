@@ -23,11 +23,32 @@
 #include "personStorage.h"
 #include "petrack.h"
 
+#include <algorithm>
+#include <limits>
+#include <tuple>
 #include <utility>
 
 using namespace std;
 using namespace annotationGroups;
 
+namespace
+{
+bool byTrajectoryAndFrame(const TrajectoryGroupEntry &lhs, const TrajectoryGroupEntry &rhs)
+{
+    return std::tie(lhs.trackPersonId, lhs.frameBegin) < std::tie(rhs.trackPersonId, rhs.frameBegin);
+}
+} // namespace
+
+AnnotationGroupManager::AnnotationGroupManager(Petrack &petrack, Animation &animation, PersonStorage &personStorage) :
+    mPetrack(petrack), mAnimation(animation), mPersonStorage(personStorage)
+{
+    initDefaultGroups();
+
+    // the indices of the trajectories (and their group lists) change
+    connect(&mPersonStorage, &PersonStorage::deletedPerson, this, &AnnotationGroupManager::invalidateGroupIndex);
+    connect(&mPersonStorage, &PersonStorage::splitPersonAtFrame, this, &AnnotationGroupManager::invalidateGroupIndex);
+    connect(&mPersonStorage, &PersonStorage::changedPerson, this, &AnnotationGroupManager::invalidateGroupIndex);
+}
 
 bool AnnotationGroupManager::addTrajectoryToGroup(size_t trajectory, int groupId, int frame)
 {
@@ -42,7 +63,9 @@ bool AnnotationGroupManager::addTrajectoryToGroup(size_t trajectory, int groupId
     auto &list  = mPersonStorage.getGroupList(trajectory);
     auto &group = mGroups.at(groupId);
 
+    unindexTrajectory(trajectory);
     list.insert(frame, group.id);
+    indexTrajectory(trajectory);
 
     emit trajectoryAssignmentChanged();
     return true;
@@ -68,7 +91,9 @@ bool AnnotationGroupManager::removeTrajectoryAssignment(size_t trajectory, int f
     }
 
     auto &list = mPersonStorage.getGroupList(trajectory);
+    unindexTrajectory(trajectory);
     list.insert(frame, NO_GROUP.id);
+    indexTrajectory(trajectory);
     emit trajectoryAssignmentChanged();
     return true;
 }
@@ -165,6 +190,7 @@ annotationGroups::GroupConfiguration AnnotationGroupManager::saveConfig() const
 void AnnotationGroupManager::loadConfig(const annotationGroups::GroupConfiguration &config)
 {
     blockSignals(true);
+    invalidateGroupIndex();
     mGroups.clear();
     mTopLevelGroups.clear();
     mNextGroupId = config.getNextGroupId();
@@ -199,20 +225,16 @@ void AnnotationGroupManager::loadConfig(const annotationGroups::GroupConfigurati
             trajectoryErrors.push_back(trajectoryId);
             continue;
         }
-        std::vector<std::tuple<int, int>> intervals = entry.second;
-
-        // sort ascending by startFrame to prevent accidental skipping entries due to IntervalList::insert.
-        std::sort(intervals.begin(), intervals.end(), [](auto a, auto b) { return std::get<0>(a) < std::get<0>(b); });
-
-        for(const auto &intervalEntry : intervals)
+        // all intervals of the trajectory at once, so the list is compacted only once
+        std::vector<IntervalList<int>::Entry> intervals;
+        intervals.reserve(entry.second.size());
+        for(const auto &intervalEntry : entry.second)
         {
             int groupId = std::get<1>(intervalEntry);
             int frame   = std::get<0>(intervalEntry);
-            if(!addTrajectoryToGroup(trajectoryId, groupId, frame))
-            {
-                removeTrajectoryAssignment(trajectoryId, frame);
-            }
+            intervals.push_back({frame, isValidGroupId(groupId) ? groupId : NO_GROUP.id});
         }
+        mPersonStorage.getGroupList(trajectoryId).assign(std::move(intervals));
     }
 
     if(!trajectoryErrors.empty())
@@ -229,11 +251,11 @@ void AnnotationGroupManager::loadConfig(const annotationGroups::GroupConfigurati
     emit groupsChanged();
 }
 
-std::vector<annotationGroups::Group> AnnotationGroupManager::getGroups()
+std::vector<annotationGroups::Group> AnnotationGroupManager::getGroups() const
 {
     std::vector<annotationGroups::Group> groups;
     groups.reserve(mGroups.size());
-    for(auto &pair : mGroups)
+    for(const auto &pair : mGroups)
     {
         groups.push_back(pair.second);
     }
@@ -331,31 +353,115 @@ void AnnotationGroupManager::initDefaultGroups()
 
 std::vector<annotationGroups::TrajectoryGroupEntry> AnnotationGroupManager::getTrajectoriesOfGroup(int groupId) const
 {
-    std::vector<annotationGroups::TrajectoryGroupEntry> trajectories;
+    const auto &index = groupIndex();
+    const auto  group = index.find(groupId);
+    if(group == index.end())
+    {
+        return {};
+    }
+    return group->second;
+}
 
-    for(size_t i = 0; i < mPersonStorage.nbPersons(); i++)
+std::vector<size_t> AnnotationGroupManager::getTrajectoriesOfGroupAtFrame(int groupId, int frame) const
+{
+    std::vector<size_t> trajectories;
+
+    const auto &index = groupIndex();
+    const auto  group = index.find(groupId);
+    if(group == index.end())
+    {
+        return trajectories;
+    }
+    for(const auto &entry : group->second)
     {
-        const auto &groupList = mPersonStorage.getGroupList(i);
-        const auto &entries   = groupList.getEntries();
+        if(entry.frameBegin <= frame && (entry.frameEnd == -1 || frame <= entry.frameEnd))
+        {
+            trajectories.push_back(entry.trackPersonId);
+        }
+    }
+    return trajectories;
+}
+
+std::vector<annotationGroups::TrajectoryGroupEntry>
+AnnotationGroupManager::getTrajectoriesOfTopLevelGroup(int tlgId) const
+{
+    std::vector<annotationGroups::TrajectoryGroupEntry> trajectories;
 
-        for(size_t k = 0; k < entries.size() - 1; ++k)
+    const auto &index = groupIndex();
+    for(const auto &[id, group] : mGroups)
+    {
+        const auto entries = index.find(id);
+        if(group.tlgId == tlgId && entries != index.end())
         {
-            const auto &entry = entries.at(k);
+            trajectories.insert(trajectories.end(), entries->second.begin(), entries->second.end());
+        }
+    }
+    return trajectories;
+}
 
-            if(entry.data == groupId)
-            {
-                const auto &next = entries.at(k + 1);
-                trajectories.push_back({groupId, (int) i, entry.start, next.start - 1});
-            }
+/// The index is stale, if it was never built or persons were added or removed without notification (e.g. by undo)
+bool AnnotationGroupManager::isGroupIndexValid() const
+{
+    return mGroupIndexValid && mIndexedPersons == mPersonStorage.nbPersons();
+}
+
+const std::map<int, std::vector<TrajectoryGroupEntry>> &AnnotationGroupManager::groupIndex() const
+{
+    if(!isGroupIndexValid())
+    {
+        mGroupIndex.clear();
+        mGroupIndexValid = true;
+        mIndexedPersons  = mPersonStorage.nbPersons();
+        // trajectories are added in ascending order, so each group stays sorted
+        for(size_t i = 0; i < mPersonStorage.nbPersons(); i++)
+        {
+            indexTrajectory(i);
         }
-        if(entries.back().data == groupId)
+    }
+    return mGroupIndex;
+}
+
+/// Adds all intervals of trajectory to the index; does nothing while the index is not built
+void AnnotationGroupManager::indexTrajectory(size_t trajectory) const
+{
+    if(!isGroupIndexValid())
+    {
+        return;
+    }
+
+    const auto &entries = mPersonStorage.getGroupList(trajectory).getEntries();
+    for(size_t k = 0; k < entries.size(); ++k)
+    {
+        TrajectoryGroupEntry entry{entries.at(k).data, (int) trajectory, entries.at(k).start, -1};
+        if(k + 1 < entries.size())
         {
-            trajectories.push_back({groupId, (int) i, entries.back().start, -1});
+            entry.frameEnd = entries.at(k + 1).start - 1;
         }
+
+        auto &group = mGroupIndex[entry.groupId];
+        group.insert(std::upper_bound(group.begin(), group.end(), entry, byTrajectoryAndFrame), entry);
     }
+}
 
-    return trajectories;
+/// Removes all intervals of trajectory from the index; has to be called before its group list changes
+void AnnotationGroupManager::unindexTrajectory(size_t trajectory)
+{
+    if(!isGroupIndexValid())
+    {
+        return;
+    }
+
+    const TrajectoryGroupEntry first{NO_GROUP.id, (int) trajectory, std::numeric_limits<int>::min(), -1};
+    const TrajectoryGroupEntry last{NO_GROUP.id, (int) trajectory, std::numeric_limits<int>::max(), -1};
+    for(const auto &interval : mPersonStorage.getGroupList(trajectory).getEntries())
+    {
+        auto &group = mGroupIndex[interval.data];
+        group.erase(
+            std::lower_bound(group.begin(), group.end(), first, byTrajectoryAndFrame),
+            std::upper_bound(group.begin(), group.end(), last, byTrajectoryAndFrame));
+    }
 }
+
 void AnnotationGroupManager::deleteGroup(int id)
 {
     // early return when group is not present to prevent calculation and signal
@@ -381,6 +487,7 @@ void AnnotationGroupManager::deleteGroup(int id)
     {
         mPersonStorage.getGroupList(p).compact();
     }
+    invalidateGroupIndex();
     emit groupsChanged();
 }
 std::vector<annotationGroups::Group> AnnotationGroupManager::getGroupsOfTlg(int tlgId)
@@ -54,12 +54,14 @@ private:
     bool         mVisualization       = false;
     unsigned int mVisualizationRadius = 50;
 
+    /// reverse index: assignments of each group, sorted by trajectory and frame; built on first use
+    mutable std::map<int, std::vector<annotationGroups::TrajectoryGroupEntry>> mGroupIndex;
+
+    mutable bool   mGroupIndexValid = false;
+    mutable size_t mIndexedPersons  = 0; ///< number of persons when mGroupIndex was built
+
 public:
-    AnnotationGroupManager(Petrack &petrack, Animation &animation, PersonStorage &personStorage) :
-        mPetrack(petrack), mAnimation(animation), mPersonStorage(personStorage)
-    {
-        initDefaultGroups();
-    }
+    AnnotationGroupManager(Petrack &petrack, Animation &animation, PersonStorage &personStorage);
 
     /**
      * Add a trajectory to a group at the current frame.
@@ -98,6 +100,22 @@ public:
      */
     std::vector<annotationGroups::TrajectoryGroupEntry> getTrajectoriesOfGroup(int groupId) const;
 
+    /**
+     * Get the trajectories assigned to a group at a frame, in ascending order.
+     */
+    std::vector<size_t> getTrajectoriesOfGroupAtFrame(int groupId, int frame) const;
+
+    /**
+     * Get a List of entries of assignments of all groups of a top level group, ordered by group.
+     */
+    std::vector<annotationGroups::TrajectoryGroupEntry> getTrajectoriesOfTopLevelGroup(int tlgId) const;
+
+    /**
+     * Discard the reverse index from groups to trajectories, e.g. after the group lists of the TrackPersons have
+     * been replaced by an undo. It is rebuilt on the next query.
+     */
+    void invalidateGroupIndex() { mGroupIndexValid = false; }
+
     bool isValidGroupId(int id) const;
 
     /**
@@ -132,7 +150,7 @@ public:
     void deleteGroup(int id);
 
     std::vector<annotationGroups::TopLevelGroup> getTopLevelGroups();
-    std::vector<annotationGroups::Group>         getGroups();
+    std::vector<annotationGroups::Group>         getGroups() const;
     std::vector<annotationGroups::Group>         getGroupsOfTlg(int tlgId);
 
     bool isValidTopLevelGroupId(int id) const;
@@ -183,6 +201,12 @@ private:
     annotationGroups::Group &createGroup(int id, const std::string &name, const std::string &type);
 
     void initDefaultGroups();
+
+    const std::map<int, std::vector<annotationGroups::TrajectoryGroupEntry>> &groupIndex() const;
+
+    bool isGroupIndexValid() const;
+    void indexTrajectory(size_t trajectory) const;
+    void unindexTrajectory(size_t trajectory);
 };
 
 
@@ -40,9 +40,29 @@ AnnotationGroupTreeItem::~AnnotationGroupTreeItem()
 void AnnotationGroupTreeItem::appendChild(std::unique_ptr<AnnotationGroupTreeItem> child)
 {
     child->setParent(this);
+    child->mRow = static_cast<int>(mChildren.size());
     mChildren.push_back(std::move(child));
 }
 
+void AnnotationGroupTreeItem::insertChild(int row, std::unique_ptr<AnnotationGroupTreeItem> child)
+{
+    child->setParent(this);
+    mChildren.insert(mChildren.begin() + row, std::move(child));
+    for(int i = row; i < childCount(); ++i)
+    {
+        mChildren[i]->mRow = i;
+    }
+}
+
+void AnnotationGroupTreeItem::removeChildren(int row, int count)
+{
+    mChildren.erase(mChildren.begin() + row, mChildren.begin() + row + count);
+    for(int i = row; i < childCount(); ++i)
+    {
+        mChildren[i]->mRow = i;
+    }
+}
+
 bool AnnotationGroupTreeItem::isChild(AnnotationGroupTreeItem *candidiate) const
 {
     for(const auto &child : mChildren)
@@ -61,7 +81,7 @@ bool AnnotationGroupTreeItem::isChild(AnnotationGroupTreeItem *candidiate) const
 
 AnnotationGroupTreeItem *AnnotationGroupTreeItem::getChildAt(int row)
 {
-    if(row < 0 || row > childCount())
+    if(row < 0 || row >= childCount())
     {
         return nullptr;
     }
@@ -113,17 +133,7 @@ int AnnotationGroupTreeItem::row() const
     {
         return 0;
     }
-    const auto it = std::find_if(
-        mParent->mChildren.cbegin(),
-        mParent->mChildren.cend(),
-        [this](const std::unique_ptr<AnnotationGroupTreeItem> &item) { return item.get() == this; });
-    if(it != mParent->mChildren.cend())
-    {
-        return std::distance(mParent->mChildren.cbegin(), it);
-    }
-    Q_ASSERT(false);
-    SPDLOG_ERROR("child not in children list of parent");
-    return -1;
+    return mRow;
 }
 
 
@@ -198,3 +208,23 @@ GroupEntryTreeItem::GroupEntryTreeItem(
     setData(0, QString::fromStdString(key));
     setData(1, QString::fromStdString(value));
 }
+
+GroupEntryTreeItem::GroupEntryTreeItem(
+    const annotationGroups::TrajectoryGroupEntry &entry,
+    AnnotationGroupTreeItem                      *group) :
+    AnnotationGroupTreeItem(group)
+{
+    setEntry(entry);
+}
+
+void GroupEntryTreeItem::setEntry(const annotationGroups::TrajectoryGroupEntry &entry)
+{
+    mEntry = entry;
+    // trajectories are numbered from 1 in the ui, as in the exported files
+    setData(0, QString("Trajectory %1").arg(entry.trackPersonId + 1));
+    setData(
+        1,
+        QString("%1 - %2")
+            .arg(entry.frameBegin)
+            .arg((entry.frameEnd >= 0) ? QString::number(entry.frameEnd) : QString("end")));
+}
@@ -18,6 +18,8 @@
 #ifndef PETRACK_ANNOTATIONGROUPTREEITEM_H
 #define PETRACK_ANNOTATIONGROUPTREEITEM_H
 
+#include "annotationGrouping.h"
+
 #include <QColor>
 #include <QString>
 #include <QVector>
@@ -41,6 +43,8 @@ public:
     AnnotationGroupTreeItem &operator=(AnnotationGroupTreeItem &&)      = delete;
 
     void appendChild(std::unique_ptr<AnnotationGroupTreeItem> child);
+    void insertChild(int row, std::unique_ptr<AnnotationGroupTreeItem> child);
+    void removeChildren(int row, int count);
 
     /**
      * Recursively check if the given pointer is a child of this object or
@@ -74,10 +78,15 @@ public:
     inline int  getChildCount() { return mChildCount; }
     inline void setChildCount(int count) { mChildCount = count; }
 
+    /// true for groups, whose trajectories are added as children on demand
+    virtual bool isGroup() const { return false; }
+
 private:
     std::vector<std::unique_ptr<AnnotationGroupTreeItem>> mChildren;
     AnnotationGroupTreeItem                              *mParent;
 
+    int mRow = 0; ///< position in the children of mParent, kept up to date by the parent
+
 
     QString mKey;
     QString mValue;
@@ -85,9 +94,9 @@ private:
 
 
 protected:
-    int  mGroupId;
-    bool mIsTLG;
-    int  mChildCount;
+    int  mGroupId    = -1;
+    bool mIsTLG      = false;
+    int  mChildCount = 0;
 };
 
 class TopLevelGroupTreeItem : public AnnotationGroupTreeItem
@@ -104,12 +113,20 @@ public:
     GroupTreeItem(int id, const std::string &name, const std::string &type, AnnotationGroupTreeItem *topLevelGroup);
 
     QString getData(int column) const override;
+    bool    isGroup() const override { return true; }
 };
 
 class GroupEntryTreeItem : public AnnotationGroupTreeItem
 {
 public:
     GroupEntryTreeItem(const std::string &key, const std::string &value, AnnotationGroupTreeItem *group);
+    GroupEntryTreeItem(const annotationGroups::TrajectoryGroupEntry &entry, AnnotationGroupTreeItem *group);
+
+    const annotationGroups::TrajectoryGroupEntry &getEntry() const { return mEntry; }
+    void                                          setEntry(const annotationGroups::TrajectoryGroupEntry &entry);
+
+private:
+    annotationGroups::TrajectoryGroupEntry mEntry{-1, -1, -1, -1};
 };
 
 
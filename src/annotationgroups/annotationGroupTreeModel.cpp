@@ -18,14 +18,33 @@
 
 #include "annotationGroupTreeModel.h"
 
+#include "annotationGroupManager.h"
 #include "logger.h"
 
 #include <QBrush>
+#include <algorithm>
 #include <memory>
+#include <tuple>
 #include <utility>
 
-AnnotationGroupTreeModel::AnnotationGroupTreeModel(QObject *parent) :
-    QAbstractItemModel(parent), rootItem(std::make_unique<AnnotationGroupTreeItem>())
+namespace
+{
+/// order of the entries of a group in the reverse index of the AnnotationGroupManager
+bool byTrajectoryAndFrame(
+    const annotationGroups::TrajectoryGroupEntry &lhs,
+    const annotationGroups::TrajectoryGroupEntry &rhs)
+{
+    return std::tie(lhs.trackPersonId, lhs.frameBegin) < std::tie(rhs.trackPersonId, rhs.frameBegin);
+}
+
+const annotationGroups::TrajectoryGroupEntry &entryAt(AnnotationGroupTreeItem *group, int row)
+{
+    return static_cast<GroupEntryTreeItem *>(group->getChildAt(row))->getEntry();
+}
+} // namespace
+
+AnnotationGroupTreeModel::AnnotationGroupTreeModel(AnnotationGroupManager &groupManager, QObject *parent) :
+    QAbstractItemModel(parent), mGroupManager(groupManager), rootItem(std::make_unique<AnnotationGroupTreeItem>())
 {
 }
 
@@ -74,8 +93,10 @@ QVariant AnnotationGroupTreeModel::data(const QModelIndex &index, int role) cons
     }
     if(role == Qt::ForegroundRole)
     {
-        QBrush brush;
-        brush.setColor(item->getChildCount() > 0 ? QColor("black") : QColor("gray"));
+        // empty (top level) groups are grayed out
+        const bool empty = (item->isTLG() || item->isGroup()) && item->getChildCount() == 0;
+        QBrush     brush;
+        brush.setColor(empty ? QColor("gray") : QColor("black"));
         return brush;
     }
     return {};
@@ -143,19 +164,212 @@ int AnnotationGroupTreeModel::columnCount(const QModelIndex &parent) const
     return rootItem->columnCount();
 }
 
-bool AnnotationGroupTreeModel::isIndexValid(const QModelIndex &idx) const
+bool AnnotationGroupTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if(parent.column() > 0)
+    {
+        return false;
+    }
+
+    AnnotationGroupTreeItem *parentItem = rootItem.get();
+    if(isIndexValid(parent))
+    {
+        parentItem = static_cast<AnnotationGroupTreeItem *>(parent.internalPointer());
+    }
+
+    // the trajectories of a group may not be fetched yet
+    if(parentItem->isGroup())
+    {
+        return parentItem->getChildCount() > 0;
+    }
+    return parentItem->childCount() > 0;
+}
+
+bool AnnotationGroupTreeModel::canFetchMore(const QModelIndex &parent) const
 {
-    if(!idx.isValid())
+    if(!isIndexValid(parent))
     {
         return false;
     }
 
-    auto *item = static_cast<AnnotationGroupTreeItem *>(idx.internalPointer());
-    return rootItem->isChild(item);
+    auto *item = static_cast<AnnotationGroupTreeItem *>(parent.internalPointer());
+    return item->isGroup() && item->childCount() < item->getChildCount();
+}
+
+/**
+ * Adds the next FETCH_BATCH_SIZE trajectories of the group at parent as children.
+ * The children of a group always are the first entries of the group in the reverse index of the manager.
+ */
+void AnnotationGroupTreeModel::fetchMore(const QModelIndex &parent)
+{
+    if(!canFetchMore(parent))
+    {
+        return;
+    }
+
+    auto      *group   = static_cast<AnnotationGroupTreeItem *>(parent.internalPointer());
+    const auto entries = mGroupManager.getTrajectoriesOfGroup(group->getId());
+    const int  first   = group->childCount();
+    const int  last    = std::min(first + FETCH_BATCH_SIZE, static_cast<int>(entries.size())) - 1;
+    if(last < first)
+    {
+        group->setChildCount(first);
+        return;
+    }
+
+    beginInsertRows(createIndex(group->row(), 0, group), first, last);
+    for(int i = first; i <= last; ++i)
+    {
+        group->appendChild(std::make_unique<GroupEntryTreeItem>(entries[i], group));
+    }
+    endInsertRows();
+}
+
+bool AnnotationGroupTreeModel::isIndexValid(const QModelIndex &idx) const
+{
+    // rows are removed with the according notifications, so views never keep indices of deleted items
+    return idx.isValid() && idx.model() == this && idx.internalPointer() != nullptr;
+}
+
+/**
+ * Rebuilds the top level groups and groups from the manager, e.g. after groups were created, changed or deleted.
+ * The trajectories of the groups are fetched again on demand.
+ */
+void AnnotationGroupTreeModel::rebuild()
+{
+    auto root = std::make_unique<AnnotationGroupTreeItem>();
+    root->setData(0, "key");
+    root->setData(1, "value");
+    for(const auto &tlg : mGroupManager.getTopLevelGroups())
+    {
+        auto tlgElem = std::make_unique<TopLevelGroupTreeItem>(tlg.id, tlg.name, root.get());
+
+        const std::vector<annotationGroups::Group> groups = mGroupManager.getGroupsOfTlg(tlg.id);
+
+        tlgElem->setChildCount((int) groups.size());
+        for(const auto &grp : groups)
+        {
+            auto grpElem = std::make_unique<GroupTreeItem>(grp.id, grp.name, grp.type, tlgElem.get());
+            grpElem->setColor(grp.color);
+            grpElem->setChildCount((int) mGroupManager.getTrajectoriesOfGroup(grp.id).size());
+            tlgElem->appendChild(std::move(grpElem));
+        }
+        root->appendChild(std::move(tlgElem));
+    }
+
+    beginResetModel();
+    rootItem = std::move(root);
+    endResetModel();
+}
+
+/**
+ * Updates the trajectories of all groups after assignments changed, without resetting the model.
+ */
+void AnnotationGroupTreeModel::updateAssignments()
+{
+    bool indicatorChanged = false;
+    for(int t = 0; t < rootItem->childCount(); ++t)
+    {
+        auto *tlg = rootItem->getChildAt(t);
+        for(int g = 0; g < tlg->childCount(); ++g)
+        {
+            updateGroup(tlg->getChildAt(g), indicatorChanged);
+        }
+    }
+
+    // views only ask again whether a group without fetched children has children on a layout change; empty groups
+    // are always complete, so newly assigned trajectories are inserted as rows
+    if(indicatorChanged)
+    {
+        emit layoutAboutToBeChanged();
+        emit layoutChanged();
+    }
 }
 
-void AnnotationGroupTreeModel::setRootItem(std::unique_ptr<AnnotationGroupTreeItem> newRoot)
+/**
+ * Updates the number of trajectories of group and inserts and removes its fetched children as needed.
+ *
+ * The fetched children stay the first entries of the group: Entries up to the last fetched one are fetched, all
+ * entries if the group was complete before.
+ *
+ * @param group group to update
+ * @param indicatorChanged set to true, if the group lost all trajectories without any fetched children
+ */
+void AnnotationGroupTreeModel::updateGroup(AnnotationGroupTreeItem *group, bool &indicatorChanged)
 {
-    rootItem = std::move(newRoot);
-    emit layoutChanged();
+    const auto entries  = mGroupManager.getTrajectoriesOfGroup(group->getId());
+    const int  oldCount = group->getChildCount();
+    const int  newCount = static_cast<int>(entries.size());
+    const int  fetched  = group->childCount();
+
+    int visible = newCount;
+    if(fetched == 0 && oldCount > 0)
+    {
+        visible = 0;
+    }
+    else if(fetched < oldCount)
+    {
+        visible = static_cast<int>(
+            std::upper_bound(entries.begin(), entries.end(), entryAt(group, fetched - 1), byTrajectoryAndFrame) -
+            entries.begin());
+    }
+
+    const QModelIndex parent = createIndex(group->row(), 0, group);
+    int               row    = 0;
+    int               next   = 0;
+    while(row < group->childCount() || next < visible)
+    {
+        if(row < group->childCount() &&
+           (next >= visible || byTrajectoryAndFrame(entryAt(group, row), entries[next])))
+        {
+            // run of children, which are no longer assigned to the group
+            int last = row;
+            while(last + 1 < group->childCount() &&
+                  (next >= visible || byTrajectoryAndFrame(entryAt(group, last + 1), entries[next])))
+            {
+                ++last;
+            }
+            beginRemoveRows(parent, row, last);
+            group->removeChildren(row, last - row + 1);
+            endRemoveRows();
+        }
+        else if(row >= group->childCount() || byTrajectoryAndFrame(entries[next], entryAt(group, row)))
+        {
+            // run of newly assigned entries
+            int end = next + 1;
+            while(end < visible &&
+                  (row >= group->childCount() || byTrajectoryAndFrame(entries[end], entryAt(group, row))))
+            {
+                ++end;
+            }
+            beginInsertRows(parent, row, row + end - next - 1);
+            for(; next < end; ++next, ++row)
+            {
+                group->insertChild(row, std::make_unique<GroupEntryTreeItem>(entries[next], group));
+            }
+            endInsertRows();
+        }
+        else
+        {
+            auto *child = static_cast<GroupEntryTreeItem *>(group->getChildAt(row));
+            if(child->getEntry().frameEnd != entries[next].frameEnd)
+            {
+                child->setEntry(entries[next]);
+                emit dataChanged(index(row, 0, parent), index(row, 1, parent));
+            }
+            ++row;
+            ++next;
+        }
+    }
+
+    group->setChildCount(newCount);
+    if(newCount != oldCount)
+    {
+        // the foreground of a group depends on the number of its trajectories
+        emit dataChanged(parent, createIndex(group->row(), 1, group));
+        if(fetched == 0 && newCount == 0)
+        {
+            indicatorChanged = true;
+        }
+    }
 }
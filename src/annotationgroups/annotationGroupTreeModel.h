@@ -24,16 +24,25 @@
 #include <QAbstractItemModel>
 #include <memory>
 
+class AnnotationGroupManager;
+
 /**
  * Custom TreeModel for the Tree view of the main grouping panel.
  * Uses GroupingItem instances as data model.
+ *
+ * The top level groups and groups are built from the AnnotationGroupManager. The trajectories of a group are only
+ * added as children, when the group is expanded, in batches of FETCH_BATCH_SIZE (see fetchMore()). Changed
+ * assignments update the counts and the already added trajectories row by row (see updateAssignments()).
  */
 class AnnotationGroupTreeModel : public QAbstractItemModel
 {
     Q_OBJECT
 
 public:
-    explicit AnnotationGroupTreeModel(QObject *parent = nullptr);
+    /// number of trajectories added to a group at once
+    static constexpr int FETCH_BATCH_SIZE = 200;
+
+    explicit AnnotationGroupTreeModel(AnnotationGroupManager &groupManager, QObject *parent = nullptr);
     ~AnnotationGroupTreeModel() override                                  = default;
     AnnotationGroupTreeModel(const AnnotationGroupTreeModel &)            = delete;
     AnnotationGroupTreeModel(AnnotationGroupTreeModel &&)                 = delete;
@@ -47,13 +56,20 @@ public:
     QModelIndex   parent(const QModelIndex &index) const override;
     int           rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int           columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool          hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool          canFetchMore(const QModelIndex &parent) const override;
+    void          fetchMore(const QModelIndex &parent) override;
 
     bool isIndexValid(const QModelIndex &idx) const;
 
-    void                     setRootItem(std::unique_ptr<AnnotationGroupTreeItem> newRoot);
+    void                     rebuild();
+    void                     updateAssignments();
     AnnotationGroupTreeItem *getRoot() { return rootItem.get(); }
 
 private:
+    void updateGroup(AnnotationGroupTreeItem *group, bool &layoutChanged);
+
+    AnnotationGroupManager                  &mGroupManager;
     std::unique_ptr<AnnotationGroupTreeItem> rootItem;
 };
 
@@ -18,20 +18,102 @@
 
 #include "autoCalib.h"
 
+#include "animation.h"
+#include "calibVideoSampler.h"
 #include "logger.h"
 #include "pMessageBox.h"
 #include "petrack.h"
+#include "videoDecoder.h"
 
 #include <QApplication>
+#include <QEventLoop>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QProgressDialog>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <deque>
 #include <opencv2/highgui.hpp>
 
 /// definieren, wenn das Schachbrett im Mainwindow und nicht separat angezeigt werden soll:
 /// fuehrt nach Calibration dazu dass play des originalvideos abstuerzt, insb wenn intr apply nicht ausgewaehlt war
 #define SHOW_CALIB_MAINWINDOW
 
+namespace
+{
+/// result of the chessboard search in one calibration image
+struct ChessboardDetection
+{
+    cv::Mat                  view; ///< loaded image with the drawn corners; empty, if it could not be loaded
+    bool                     found = false;
+    std::vector<cv::Point2f> corners;
+};
+
+/**
+ * @brief Detects the chessboard corners in view and refines them
+ *
+ * Runs on a worker thread, so it must not touch the GUI.
+ *
+ * @param view calibration image (BGR), the found corners are drawn into it
+ * @param boardSize number of inner corners of the chessboard
+ * @param flags flags for cv::findChessboardCorners
+ * @return the detection
+ */
+ChessboardDetection detectChessboard(cv::Mat view, cv::Size boardSize, int flags)
+{
+    ChessboardDetection detection;
+    detection.view = view;
+    if(detection.view.empty())
+    {
+        return detection;
+    }
+
+    // search for chessboard corners
+    detection.found = findChessboardCorners(detection.view, boardSize, detection.corners, flags);
+    if(detection.found)
+    {
+        // improve the found corners' coordinate accuracy
+        cv::Mat viewGray;
+        cv::cvtColor(detection.view, viewGray, cv::COLOR_BGR2GRAY);
+        cv::cornerSubPix(
+            viewGray,
+            detection.corners,
+            cv::Size(11, 11),
+            cv::Size(-1, -1),
+            cv::TermCriteria(CV_TERMCRIT_EPS + CV_TERMCRIT_ITER, 30, 0.1));
+        drawChessboardCorners(detection.view, boardSize, detection.corners, detection.found);
+    }
+    return detection;
+}
+
+/// Loads a calibration image and detects the chessboard in it, see detectChessboard()
+ChessboardDetection loadChessboard(const QString &file, cv::Size boardSize)
+{
+    return detectChessboard(cv::imread(file.toStdString(), cv::IMREAD_COLOR), boardSize, cv::CALIB_CB_ADAPTIVE_THRESH);
+}
+
+/**
+ * @brief Waits for a detection while the progress dialog stays responsive
+ *
+ * @return false, if the user canceled the progress dialog meanwhile
+ */
+bool waitForDetection(const QFuture<ChessboardDetection> &detection, QProgressDialog &progress)
+{
+    if(!detection.isFinished())
+    {
+        QEventLoop                          loop;
+        QFutureWatcher<ChessboardDetection> watcher;
+        QObject::connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+        QObject::connect(&progress, &QProgressDialog::canceled, &loop, &QEventLoop::quit);
+        watcher.setFuture(detection);
+        loop.exec();
+    }
+    return !progress.wasCanceled();
+}
+} // namespace
+
 AutoCalib::AutoCalib()
 {
     mMainWindow = nullptr;
@@ -93,7 +175,8 @@ bool AutoCalib::openCalibFiles()
                 mLastDir,
                 "All supported types (*.bmp *.dib *.jpeg *.jpg *.jpe *.png *.pbm *.pgm *.ppm *.sr *.ras *.tiff *.tif "
                 "*.exr "
-                "*.jp2);;All files (*.*)");
+                "*.jp2 *.avi *.mpg *.mts *.m2t *.m2ts *.wmv *.mp4 *.mov *.mxf);;Video (*.avi *.mpg *.mts *.m2t *.m2ts "
+                "*.wmv *.mp4 *.mov *.mxf);;All files (*.*)");
 
             if(!calibFiles.isEmpty())
             {
@@ -105,6 +188,104 @@ bool AutoCalib::openCalibFiles()
     return false;
 }
 
+/**
+ * @brief Checks whether the calibration is done with a single calibration video instead of images
+ */
+bool AutoCalib::isCalibVideo() const
+{
+    static const QStringList videoSuffixes{"avi", "mpg", "mts", "m2t", "m2ts", "wmv", "mp4", "mov", "mxf"};
+    return mCalibFiles.size() == 1 && videoSuffixes.contains(QFileInfo(mCalibFiles.first()).suffix().toLower());
+}
+
+/**
+ * @brief Detects the chessboard corners in selected frames of a calibration video
+ *
+ * The video is decoded sequentially. A CalibVideoSampler picks the still frames,
+ * which are searched for the chessboard in a thread pool, and accepts only boards
+ * whose pose differs from the ones accepted before. The detections are accepted
+ * in frame order, so the selection does not depend on the timing of the workers.
+ * Decoding stops as soon as enough boards are accepted.
+ *
+ * @param video calibration video
+ * @param boardSize number of inner corners of the chessboard
+ * @param progress dialog showing the progress and allowing to abort
+ * @param imagePoints[out] the corners of the accepted boards
+ * @param imgSize[out] size of the video frames
+ * @return false, if the video could not be opened
+ */
+bool AutoCalib::collectVideoCorners(
+    const QString                         &video,
+    cv::Size                               boardSize,
+    QProgressDialog                       &progress,
+    std::vector<std::vector<cv::Point2f>> &imagePoints,
+    cv::Size                              &imgSize)
+{
+    cv::VideoCapture capture;
+    if(!videoDecoder::open(capture, video.toStdString(), mMainWindow->getAnimation()->getHwAcceleration()))
+    {
+        return false;
+    }
+    const int numFrames = static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT));
+    progress.setMaximum(std::max(numFrames, 1));
+
+    CalibVideoSampler sampler;
+    QThreadPool       pool;
+    const auto        maxPending = 2 * static_cast<size_t>(std::max(1, pool.maxThreadCount()));
+    // most frames of a video do not show the whole board, so check quickly before the exhaustive search
+    const int flags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_FAST_CHECK;
+
+    std::deque<QFuture<ChessboardDetection>> pending;
+    bool                                     canceled = false;
+
+    // takes the oldest detections in frame order, until at most maxRemaining are pending
+    auto accept = [&](size_t maxRemaining)
+    {
+        while(!canceled && pending.size() > maxRemaining && !sampler.isFull())
+        {
+            if(!waitForDetection(pending.front(), progress))
+            {
+                canceled = true;
+                break;
+            }
+            ChessboardDetection detection = pending.front().result();
+            pending.pop_front();
+            if(detection.found && sampler.addDetection(detection.corners, boardSize, detection.view.size()))
+            {
+                imagePoints.push_back(std::move(detection.corners));
+#ifdef SHOW_CALIB_MAINWINDOW
+                // show image in view to show calculation
+                mMainWindow->updateImage(detection.view);
+#endif
+                qApp->processEvents(); // to allow events and update sceen for viewing new image
+            }
+        }
+    };
+
+    cv::Mat frame;
+    for(int i = 0; !canceled && !sampler.isFull() && capture.read(frame) && !frame.empty(); ++i)
+    {
+        imgSize = frame.size();
+        progress.setValue(std::min(i, progress.maximum()));
+        qApp->processEvents();
+        if(progress.wasCanceled())
+        {
+            break;
+        }
+        if(sampler.isCandidate(i, frame))
+        {
+            pending.push_back(QtConcurrent::run(&pool, detectChessboard, frame, boardSize, flags));
+            // the worker owns the frame now, the next frame has to be decoded into a new buffer
+            frame = cv::Mat();
+            accept(maxPending);
+        }
+    }
+    accept(0);
+    pool.clear();
+
+    SPDLOG_INFO("{} frames of the calibration video are used for the calibration.", imagePoints.size());
+    return true;
+}
+
 /**
  * @brief Loads CalibFiles, detects Chessboard corners and calibrates with these
  *
@@ -135,7 +316,6 @@ std::optional<IntrinsicModelsParameters> AutoCalib::autoCalib(bool quadAspectRat
         float square_size  = mSquareSize; // 5.25f; // 3.f;   // da 3x3cm hat Schachbrett, was ich ausgedruckt habe
         float aspect_ratio = 1.f;
         int   flags        = 0;
-        std::vector<cv::Point2f>              corners;
         std::vector<std::vector<cv::Point2f>> image_points;
         cv::Mat                               camera_matrix         = cv::Mat::eye(3, 3, CV_64F);
         cv::Mat                               distortion_coeffs     = cv::Mat::zeros(1, 14, CV_64F);
@@ -144,8 +324,6 @@ std::optional<IntrinsicModelsParameters> AutoCalib::autoCalib(bool quadAspectRat
         cv::Mat                               extr_params;
         double                                reproj_errs;
         double                                reproj_errs_ext;
-        cv::Mat                               view, view_gray;
-        bool                                  found = false;
         cv::Mat                               origImg;
         cv::Size                              imgSize;
 
@@ -166,74 +344,93 @@ std::optional<IntrinsicModelsParameters> AutoCalib::autoCalib(bool quadAspectRat
             board_size.height,
             square_size);
         bool min_one_pattern_found = false;
-        // search for chessbord corners in every image
-        for(int i = 0; i < mCalibFiles.size(); ++i)
+        if(isCalibVideo())
         {
-            progress.setValue(i);
-            qApp->processEvents();
-            if(progress.wasCanceled())
-            {
-                break;
-            }
-
-
-            // cannot load image
-            view = cv::imread(mCalibFiles.at(i).toStdString(), cv::IMREAD_COLOR);
-            if(view.empty())
+            if(!collectVideoCorners(mCalibFiles.first(), board_size, progress, image_points, imgSize))
             {
-                progress.setValue(mCalibFiles.size());
+                progress.setValue(progress.maximum());
                 PCritical(
                     mMainWindow,
                     Petrack::tr("Petrack"),
-                    Petrack::tr("Cannot load %1.\nTerminate Calibration.").arg(mCalibFiles.at(i)));
-#ifdef SHOW_CALIB_MAINWINDOW
-                // reset view to animation image
-                if(!origImg.empty())
-                {
-                    mMainWindow->updateImage(origImg); // now the last view will be deleted
-                }
-#endif
+                    Petrack::tr("Cannot open %1.\nTerminate Calibration.").arg(mCalibFiles.first()));
                 return std::nullopt;
             }
-
-            // muss nur bei einem bild gemacht werden
-            if(i == 0)
+            min_one_pattern_found = !image_points.empty();
+        }
+        else
+        {
+            // the images are loaded and searched in parallel, but consumed in file order; only a few detections are
+            // started ahead, so the loaded images do not pile up in memory
+            QThreadPool                               pool;
+            const int                                 ahead = 2 * std::max(1, pool.maxThreadCount());
+            std::vector<QFuture<ChessboardDetection>> detections(mCalibFiles.size());
+            int                                       started = 0;
+
+            // search for chessbord corners in every image
+            for(int i = 0; i < mCalibFiles.size(); ++i)
             {
-                imgSize = cv::Size(view.rows, view.cols);
-            }
-            // search for chessboard corners
-            found = findChessboardCorners(view, board_size, corners, cv::CALIB_CB_ADAPTIVE_THRESH);
+                progress.setValue(i);
+                qApp->processEvents();
+                if(progress.wasCanceled())
+                {
+                    break;
+                }
 
-            if(found)
-            {
-                // improve the found corners' coordinate accuracy
-                cv::cvtColor(view, view_gray, cv::COLOR_BGR2GRAY);
-                cv::cornerSubPix(
-                    view_gray,
-                    corners,
-                    cv::Size(11, 11),
-                    cv::Size(-1, -1),
-                    cv::TermCriteria(CV_TERMCRIT_EPS + CV_TERMCRIT_ITER, 30, 0.1));
-
-                image_points.push_back(corners);
-                drawChessboardCorners(view, board_size, corners, found);
+                for(; started < mCalibFiles.size() && started <= i + ahead; ++started)
+                {
+                    detections[started] = QtConcurrent::run(&pool, loadChessboard, mCalibFiles.at(started), board_size);
+                }
+
+                if(!waitForDetection(detections[i], progress))
+                {
+                    break;
+                }
+                ChessboardDetection detection = detections[i].result();
+                detections[i]                 = QFuture<ChessboardDetection>(); // release the image
+
+                // cannot load image
+                if(detection.view.empty())
+                {
+                    pool.clear();
+                    progress.setValue(progress.maximum());
+                    PCritical(
+                        mMainWindow,
+                        Petrack::tr("Petrack"),
+                        Petrack::tr("Cannot load %1.\nTerminate Calibration.").arg(mCalibFiles.at(i)));
+#ifdef SHOW_CALIB_MAINWINDOW
+                    // reset view to animation image
+                    if(!origImg.empty())
+                    {
+                        mMainWindow->updateImage(origImg); // now the last view will be deleted
+                    }
+#endif
+                    return std::nullopt;
+                }
+                imgSize = detection.view.size();
+
+                if(detection.found)
+                {
+                    image_points.push_back(std::move(detection.corners));
 
 #ifndef SHOW_CALIB_MAINWINDOW
-                namedWindow("img", CV_WINDOW_AUTOSIZE); // 0 wenn skalierbar sein soll
-                imShow("img", view);
-                // cvWaitKey( 0 ); // zahl statt null, wenn nach bestimmter zeit weitergegangen werden soll
+                    namedWindow("img", CV_WINDOW_AUTOSIZE); // 0 wenn skalierbar sein soll
+                    imShow("img", detection.view);
+                    // cvWaitKey( 0 ); // zahl statt null, wenn nach bestimmter zeit weitergegangen werden soll
 #endif
 #ifdef SHOW_CALIB_MAINWINDOW
-                // show image in view to show calculation
-                mMainWindow->updateImage(view);
+                    // show image in view to show calculation
+                    mMainWindow->updateImage(detection.view);
 #endif
-                qApp->processEvents(); // to allow events and update sceen for viewing new image
-                min_one_pattern_found = true;
-            }
-            else
-            {
-                SPDLOG_WARN("Calibration pattern not found in: {}", mCalibFiles.at(i));
+                    qApp->processEvents(); // to allow events and update sceen for viewing new image
+                    min_one_pattern_found = true;
+                }
+                else
+                {
+                    SPDLOG_WARN("Calibration pattern not found in: {}", mCalibFiles.at(i));
+                }
             }
+            // do not wait for the detections of images, which are not used anymore
+            pool.clear();
         }
 
         if(!min_one_pattern_found)
@@ -263,7 +460,7 @@ std::optional<IntrinsicModelsParameters> AutoCalib::autoCalib(bool quadAspectRat
 
         bool ok = runCalibration(
             image_points,
-            view.size(),
+            imgSize,
             board_size,
             square_size,
             aspect_ratio,
@@ -276,7 +473,7 @@ std::optional<IntrinsicModelsParameters> AutoCalib::autoCalib(bool quadAspectRat
         SPDLOG_INFO("{}", ok ? "Calibration succeeded." : "Calibration failed.");
         SPDLOG_INFO("Intrinsic reprojection error is: {:f}", reproj_errs);
 
-        progress.setValue(mCalibFiles.size());
+        progress.setValue(progress.maximum());
 
         SPDLOG_INFO("camera matrix:\n{}", camera_matrix);
 
@@ -306,7 +503,7 @@ std::optional<IntrinsicModelsParameters> AutoCalib::autoCalib(bool quadAspectRat
 
         bool ok_ext = runCalibration(
             image_points,
-            view.size(),
+            imgSize,
             board_size,
             square_size,
             aspect_ratio,
@@ -319,7 +516,7 @@ std::optional<IntrinsicModelsParameters> AutoCalib::autoCalib(bool quadAspectRat
         SPDLOG_INFO("{}", ok_ext ? "Calibration succeeded." : "Calibration failed.");
         SPDLOG_INFO("Intrinsic reprojection error is: {:f}", reproj_errs_ext);
 
-        progress.setValue(mCalibFiles.size());
+        progress.setValue(progress.maximum());
 
         SPDLOG_INFO("camera matrix:\n{}", camera_matrix_ext);
 
@@ -25,8 +25,10 @@
 #include <QStringList>
 #include <opencv2/core/types.hpp>
 #include <optional>
+#include <vector>
 
 class Petrack;
+class QProgressDialog;
 
 
 /**
@@ -56,6 +58,7 @@ public:
     QStringList getCalibFiles();
     void        setCalibFiles(const QStringList &fl);
     bool        openCalibFiles();    // return true if at least one file is selected
+    bool        isCalibVideo() const;
     inline void setBoardSizeX(int i) // 6
     {
         mBoardSizeX = i;
@@ -87,7 +90,13 @@ public:
     void                                             checkParamPlausibility(IntrinsicCameraParams &modelParams);
 
 private:
-    int runCalibration(
+    bool collectVideoCorners(
+        const QString                         &video,
+        cv::Size                               boardSize,
+        QProgressDialog                       &progress,
+        std::vector<std::vector<cv::Point2f>> &imagePoints,
+        cv::Size                              &imgSize);
+    int  runCalibration(
         std::vector<std::vector<cv::Point2f>> corners,
         cv::Size                              img_size,
         cv::Size                              board_size,
@@ -0,0 +1,137 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "calibVideoSampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+/// width of the downscaled frames the motion is measured on
+constexpr int MOTION_WIDTH = 160;
+} // namespace
+
+/**
+ * @brief Decides whether the chessboard should be searched in the frame
+ *
+ * Has to be called for every decoded frame in order, as the motion is measured
+ * against the previous frame.
+ *
+ * @param frame frame number
+ * @param img decoded frame (gray or BGR)
+ * @return true, if the frame is still and far enough from the last candidate
+ */
+bool CalibVideoSampler::isCandidate(int frame, const cv::Mat &img)
+{
+    if(img.empty())
+    {
+        return false;
+    }
+
+    cv::Mat gray;
+    if(img.channels() == 3)
+    {
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    }
+    else
+    {
+        gray = img;
+    }
+    cv::Mat   small;
+    const int height = std::max(1, gray.rows * MOTION_WIDTH / std::max(1, gray.cols));
+    cv::resize(gray, small, cv::Size(MOTION_WIDTH, height), 0, 0, cv::INTER_AREA);
+
+    bool candidate = false;
+    if(!mPrevious.empty() && mPrevious.size() == small.size() &&
+       static_cast<long long>(frame) - mLastCandidate >= mOptions.minFrameGap)
+    {
+        cv::Mat diff;
+        cv::absdiff(small, mPrevious, diff);
+        candidate = cv::mean(diff)[0] <= mOptions.maxMotion;
+    }
+    mPrevious = small;
+    if(candidate)
+    {
+        mLastCandidate = frame;
+    }
+    return candidate;
+}
+
+/**
+ * @brief Accepts the detected board, if its pose differs from all accepted ones
+ *
+ * @param corners detected inner corners of the board
+ * @param boardSize number of inner corners
+ * @param imageSize size of the frame
+ * @return true, if the board is used for the calibration
+ */
+bool CalibVideoSampler::addDetection(const std::vector<cv::Point2f> &corners, cv::Size boardSize, cv::Size imageSize)
+{
+    if(isFull() || corners.size() != static_cast<size_t>(boardSize.area()) || imageSize.empty())
+    {
+        return false;
+    }
+
+    const Pose pose    = toPose(corners, boardSize, imageSize);
+    const bool diverse = std::all_of(
+        mPoses.begin(),
+        mPoses.end(),
+        [&](const Pose &other) { return distance(pose, other) >= mOptions.minPoseDistance; });
+    if(diverse)
+    {
+        mPoses.push_back(pose);
+    }
+    return diverse;
+}
+
+/**
+ * @brief Describes the pose of the board by its four outer corners
+ *
+ * The corner positions are divided by the width and height of the image, so
+ * the descriptor covers the position, size and perspective distortion of the
+ * board independent of the resolution.
+ */
+CalibVideoSampler::Pose
+CalibVideoSampler::toPose(const std::vector<cv::Point2f> &corners, cv::Size boardSize, cv::Size imageSize)
+{
+    const size_t cols     = boardSize.width;
+    const size_t rows     = boardSize.height;
+    const size_t outer[4] = {0, cols - 1, (rows - 1) * cols, rows * cols - 1};
+
+    Pose pose;
+    for(size_t k = 0; k < 4; ++k)
+    {
+        pose[2 * k]     = corners[outer[k]].x / imageSize.width;
+        pose[2 * k + 1] = corners[outer[k]].y / imageSize.height;
+    }
+    return pose;
+}
+
+/**
+ * @brief Root mean square distance of the corresponding corners of two poses
+ */
+double CalibVideoSampler::distance(const Pose &lhs, const Pose &rhs)
+{
+    double sum = 0;
+    for(size_t k = 0; k < lhs.size(); ++k)
+    {
+        sum += (lhs[k] - rhs[k]) * (lhs[k] - rhs[k]);
+    }
+    return std::sqrt(sum / 4.);
+}
@@ -0,0 +1,77 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CALIBVIDEOSAMPLER_H
+#define CALIBVIDEOSAMPLER_H
+
+#include <array>
+#include <climits>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Selects the frames of a calibration video used for the intrinsic calibration
+ *
+ * Consecutive frames of a calibration video mostly show the board in the same
+ * pose, and frames with a moving board are blurred. Instead of taking every
+ * n-th frame, the sampler works in two stages:
+ *
+ * 1. isCandidate() lets only frames pass, in which the image barely changed
+ *    compared to the previous frame and which are a minimum number of frames
+ *    apart from the last candidate. Only these are searched for the board.
+ * 2. addDetection() accepts a detected board only, if its pose (position, size
+ *    and perspective of the outer corners in the image) differs enough from all
+ *    boards accepted before.
+ *
+ * So the calibration gets fewer, but sharp and diverse views.
+ */
+class CalibVideoSampler
+{
+public:
+    struct Options
+    {
+        int    maxFrames       = 40;   ///< number of accepted boards after which the sampling is finished
+        int    minFrameGap     = 5;    ///< minimal distance of two candidates in frames
+        double maxMotion       = 2.;   ///< maximal mean absolute gray value difference to the previous frame
+        double minPoseDistance = 0.05; ///< minimal distance of the pose descriptors, relative to the image size
+    };
+
+    /// outer corners of the board in the order of the detection, normalized by the image size
+    using Pose = std::array<float, 8>;
+
+    CalibVideoSampler() = default;
+    explicit CalibVideoSampler(const Options &options) : mOptions(options) {}
+
+    bool isCandidate(int frame, const cv::Mat &img);
+    bool addDetection(const std::vector<cv::Point2f> &corners, cv::Size boardSize, cv::Size imageSize);
+
+    bool           isFull() const { return static_cast<int>(mPoses.size()) >= mOptions.maxFrames; }
+    size_t         numAccepted() const { return mPoses.size(); }
+    const Options &getOptions() const { return mOptions; }
+
+    static Pose   toPose(const std::vector<cv::Point2f> &corners, cv::Size boardSize, cv::Size imageSize);
+    static double distance(const Pose &lhs, const Pose &rhs);
+
+private:
+    Options           mOptions;
+    cv::Mat           mPrevious;                ///< downscaled gray version of the previous frame
+    int               mLastCandidate = INT_MIN; ///< frame number of the last candidate
+    std::vector<Pose> mPoses;                   ///< poses of the accepted boards
+};
+
+#endif // CALIBVIDEOSAMPLER_H
@@ -0,0 +1,228 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "disparityStore.h"
+
+#include "logger.h"
+
+#include <QDataStream>
+#include <cstring>
+
+namespace
+{
+constexpr char   STORE_MAGIC[8]    = {'P', 'E', 'T', 'D', 'I', 'S', 'P', 'S'};
+constexpr qint32 STORE_VERSION     = 1;
+constexpr int    COMPRESSION_LEVEL = 1; ///< invalid disparities compress well even with the fastest level
+
+struct ChunkHeader
+{
+    qint32 frame = -1;
+    qint32 rows  = 0;
+    qint32 cols  = 0;
+    qint32 type  = 0;
+    qint32 bytes = 0; ///< size of the compressed data
+};
+
+QDataStream &operator>>(QDataStream &stream, ChunkHeader &header)
+{
+    return stream >> header.frame >> header.rows >> header.cols >> header.type >> header.bytes;
+}
+
+bool isValid(const ChunkHeader &header)
+{
+    return header.rows > 0 && header.cols > 0 && header.bytes >= 0 && CV_ELEM_SIZE(header.type) == 2 &&
+           CV_MAT_CN(header.type) == 1;
+}
+} // namespace
+
+DisparityStore::~DisparityStore()
+{
+    close();
+}
+
+/**
+ * @brief Opens (or creates) the store file and reads the positions of all chunks in it
+ *
+ * A file with another format is emptied, unless the store is opened read-only.
+ *
+ * @param fileName name of the store file
+ * @param readOnly never write to the file
+ * @return true, if the store could be opened
+ */
+bool DisparityStore::open(const QString &fileName, bool readOnly)
+{
+    close();
+
+    auto file = std::make_unique<QFile>(fileName);
+    if(!file->open(readOnly ? QIODevice::ReadOnly : QIODevice::ReadWrite))
+    {
+        SPDLOG_WARN("Could not open disparity store {}: {}", fileName, file->errorString());
+        return false;
+    }
+
+    QDataStream stream(file.get());
+    stream.setByteOrder(QDataStream::LittleEndian);
+    char   magic[sizeof(STORE_MAGIC)] = {};
+    qint32 version                    = 0;
+    qint64 validSize                  = 0;
+    if(stream.readRawData(magic, sizeof(magic)) == sizeof(magic) &&
+       std::memcmp(magic, STORE_MAGIC, sizeof(STORE_MAGIC)) == 0)
+    {
+        stream >> version;
+    }
+
+    if(stream.status() == QDataStream::Ok && version == STORE_VERSION)
+    {
+        validSize = file->pos();
+        while(!stream.atEnd())
+        {
+            const qint64 pos = file->pos();
+            ChunkHeader  header;
+            stream >> header;
+            // the data is only skipped, it is read in get()
+            if(stream.status() != QDataStream::Ok || !isValid(header) ||
+               stream.skipRawData(header.bytes) != header.bytes)
+            {
+                SPDLOG_WARN("Discarding incomplete chunk at the end of disparity store {}", fileName);
+                break;
+            }
+            mChunks[header.frame] = pos;
+            validSize             = file->pos();
+        }
+    }
+    else if(readOnly)
+    {
+        SPDLOG_WARN("Could not read disparity store {}", fileName);
+        return false;
+    }
+    else
+    {
+        // new file or other format
+        file->resize(0);
+        file->seek(0);
+        stream.resetStatus();
+        stream.writeRawData(STORE_MAGIC, sizeof(STORE_MAGIC));
+        stream << STORE_VERSION;
+        validSize = file->pos();
+    }
+
+    if(!readOnly)
+    {
+        file->resize(validSize);
+    }
+    mFile     = std::move(file);
+    mFileName = fileName;
+    mReadOnly = readOnly;
+    SPDLOG_INFO("Opened disparity store {} with {} frame(s)", fileName, mChunks.size());
+    return true;
+}
+
+void DisparityStore::close()
+{
+    if(mFile)
+    {
+        mFile->close();
+        mFile.reset();
+    }
+    mFileName.clear();
+    mChunks.clear();
+    mReadOnly = false;
+}
+
+/**
+ * @brief Reads and decompresses the stored disparity of frame
+ *
+ * @param frame frame number
+ * @param disparity 16 bit disparity of the frame, only written on success
+ * @return true, if the disparity of frame was computed with the parameters of this store
+ */
+bool DisparityStore::get(int frame, cv::Mat &disparity) const
+{
+    const auto it = mChunks.find(frame);
+    if(it == mChunks.end() || !mFile->seek(it->second))
+    {
+        return false;
+    }
+
+    QDataStream stream(mFile.get());
+    stream.setByteOrder(QDataStream::LittleEndian);
+    ChunkHeader header;
+    stream >> header;
+    QByteArray compressed(header.bytes, Qt::Uninitialized);
+    if(stream.status() != QDataStream::Ok || header.frame != frame ||
+       stream.readRawData(compressed.data(), header.bytes) != header.bytes)
+    {
+        SPDLOG_WARN("Could not read frame {} from disparity store {}", frame, mFileName);
+        return false;
+    }
+
+    const QByteArray raw = qUncompress(compressed);
+    cv::Mat          result(header.rows, header.cols, header.type);
+    if(static_cast<std::size_t>(raw.size()) != result.total() * result.elemSize())
+    {
+        SPDLOG_WARN("Corrupt frame {} in disparity store {}", frame, mFileName);
+        return false;
+    }
+    std::memcpy(result.data, raw.constData(), raw.size());
+    disparity = result;
+    return true;
+}
+
+/**
+ * @brief Compresses the disparity of frame and appends it to the file, if it is not read-only
+ *
+ * @param frame frame number
+ * @param disparity single channel 16 bit disparity of the frame
+ */
+void DisparityStore::put(int frame, const cv::Mat &disparity)
+{
+    if(!mFile || mReadOnly || disparity.empty())
+    {
+        return;
+    }
+    if(disparity.elemSize() != 2 || disparity.channels() != 1)
+    {
+        SPDLOG_WARN("Disparity store {} only takes 16 bit disparities", mFileName);
+        return;
+    }
+
+    const cv::Mat    continuous = disparity.isContinuous() ? disparity : disparity.clone();
+    const QByteArray compressed = qCompress(
+        reinterpret_cast<const uchar *>(continuous.data),
+        static_cast<int>(continuous.total() * continuous.elemSize()),
+        COMPRESSION_LEVEL);
+
+    // one write per chunk, so an interruption leaves at most one incomplete chunk
+    QByteArray  chunk;
+    QDataStream stream(&chunk, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << static_cast<qint32>(frame) << static_cast<qint32>(continuous.rows)
+           << static_cast<qint32>(continuous.cols) << static_cast<qint32>(continuous.type())
+           << static_cast<qint32>(compressed.size());
+    stream.writeRawData(compressed.constData(), compressed.size());
+
+    // get() moves the position of the file
+    const qint64 pos = mFile->size();
+    if(!mFile->seek(pos) || mFile->write(chunk) != chunk.size() || !mFile->flush())
+    {
+        SPDLOG_WARN("Could not write to disparity store {}: {}", mFileName, mFile->errorString());
+        mFile->resize(pos);
+        return;
+    }
+    mChunks[frame] = pos;
+}
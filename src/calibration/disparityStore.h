@@ -0,0 +1,72 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISPARITYSTORE_H
+#define DISPARITYSTORE_H
+
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <unordered_map>
+
+/**
+ * @brief Compressed on-disk store of the disparity maps of a stereo sequence
+ *
+ * Computing the disparity is the dominant cost of stereo projects, but it only
+ * depends on the frame and the parameters of the stereo widget. Like the
+ * DetectionCache, the name of the file contains a hash of these parameters, so a
+ * store is only reused with the settings it was written with.
+ *
+ * The file is a header followed by one chunk per frame (frame, size, type and the
+ * zlib compressed 16 bit disparities), which is appended whenever a disparity
+ * was computed. Only the positions of the chunks are read on opening; a chunk is
+ * read and decompressed in get(). A later chunk of a frame replaces an earlier
+ * one; an incomplete chunk at the end (e.g. after a crash) is discarded.
+ *
+ * A store opened read-only (e.g. shared by several processes) only returns the
+ * disparities already in the file and never writes to it.
+ */
+class DisparityStore
+{
+public:
+    DisparityStore() = default;
+    ~DisparityStore();
+
+    DisparityStore(const DisparityStore &)            = delete;
+    DisparityStore &operator=(const DisparityStore &) = delete;
+
+    bool open(const QString &fileName, bool readOnly = false);
+    void close();
+
+    bool           isOpen() const { return mFile != nullptr; }
+    const QString &getFileName() const { return mFileName; }
+    std::size_t    size() const { return mChunks.size(); }
+
+    bool contains(int frame) const { return mChunks.find(frame) != mChunks.end(); }
+    bool get(int frame, cv::Mat &disparity) const;
+    void put(int frame, const cv::Mat &disparity);
+
+private:
+    QString                         mFileName;
+    std::unique_ptr<QFile>          mFile;
+    std::unordered_map<int, qint64> mChunks; ///< file position of the chunk of each frame
+    bool                            mReadOnly = false;
+};
+
+#endif // DISPARITYSTORE_H
@@ -529,6 +529,7 @@ std::optional<ExtrinsicParameters> ExtrCalibration::calibExtrParams()
         results.trans3 = translation_vector2[2];
 
         reprojectionError = ReprojectionError{};
+        mReprojectionErrorInput.reset();
 
         PCritical(
             mMainWindow,
@@ -566,42 +567,74 @@ bool ExtrCalibration::calcReprojectionError(const ExtrinsicParameters &extrParam
     if(num_points == 0 || num_points != get3DList().size())
     {
         reprojectionError = ReprojectionError{};
+        mReprojectionErrorInput.reset();
         return false;
     }
 
-    for(size_t i = 0; i < num_points; i++)
+    const auto model         = getCameraModel(extrParams);
+    const auto defaultHeight = mControlWidget->getDefaultHeight();
+
+    ReprojectionErrorInput input{
+        model.extrParams,
+        {model.fx, model.fy, model.cx, model.cy, static_cast<double>(model.borderSize)},
+        model.swap,
+        model.coordTrans,
+        defaultHeight,
+        get2DList(),
+        get3DList()};
+    if(mReprojectionErrorInput && *mReprojectionErrorInput == input)
     {
-        cv::Point2f p2d   = get2DList().at(i);
-        cv::Point3f p3d   = get3DList().at(i);
-        auto        trans = mControlWidget->getCalibCoord3DTrans();
-        p3d -= trans.toCvPoint();
-        cv::Point2f p3dTo2d = getImagePoint(p3d, extrParams);
+        // nothing changed since the last call, e.g. while editing other parameters in the ExtrinsicBox
+        return !(reprojectionError.pointHeightAvg() > MAX_AV_ERROR);
+    }
+
+    // the errors of the points are independent; they are computed in parallel, but summed up in order below, so
+    // the result does not depend on the number of threads
+    std::vector<std::array<double, 3>> errors(num_points); ///< pointHeight, defaultHeight and pixel error
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(num_points)),
+        [&](const cv::Range &range)
+        {
+            for(int i = range.start; i < range.end; ++i)
+            {
+                const cv::Point2f p2d = input.points2D[i];
+                const cv::Point3f p3d = input.points3D[i] - model.coordTrans;
+
+                cv::Point2f p3dTo2d = getImagePoint(model, p3d);
 
-        // Error measurements metric (cm)
-        cv::Point3f p2dTo3d = get3DPoint(p2d, p3d.z, extrParams);
+                // Error measurements metric (cm)
+                cv::Point3f p2dTo3d = get3DPoint(model, p2d, p3d.z);
 
-        cv::Point3f p2dTo3dMapDefaultHeight = get3DPoint(p2d, mControlWidget->getDefaultHeight(), extrParams);
+                cv::Point3f p2dTo3dMapDefaultHeight = get3DPoint(model, p2d, defaultHeight);
 
-        cv::Point3f p3dTo2dTo3dMapDefaultHeight = get3DPoint(p3dTo2d, mControlWidget->getDefaultHeight(), extrParams);
+                cv::Point3f p3dTo2dTo3dMapDefaultHeight = get3DPoint(model, p3dTo2d, defaultHeight);
 
-        val = sqrt(pow(p3d.x - p2dTo3d.x, 2) + pow(p3d.y - p2dTo3d.y, 2));
+                errors[i][0] = sqrt(pow(p3d.x - p2dTo3d.x, 2) + pow(p3d.y - p2dTo3d.y, 2));
+                errors[i][1] = sqrt(
+                    pow(p3dTo2dTo3dMapDefaultHeight.x - p2dTo3dMapDefaultHeight.x, 2) +
+                    pow(p3dTo2dTo3dMapDefaultHeight.y - p2dTo3dMapDefaultHeight.y, 2));
+                // Error measurements pixel
+                errors[i][2] = sqrt(pow(p3dTo2d.x - p2d.x, 2) + pow(p3dTo2d.y - p2d.y, 2));
+            }
+        });
+
+    for(const auto &error : errors)
+    {
+        val = error[0];
         if(val > max_pH)
         {
             max_pH = val;
         }
         sum_pH += val;
 
-        val = sqrt(
-            pow(p3dTo2dTo3dMapDefaultHeight.x - p2dTo3dMapDefaultHeight.x, 2) +
-            pow(p3dTo2dTo3dMapDefaultHeight.y - p2dTo3dMapDefaultHeight.y, 2));
+        val = error[1];
         if(val > max_dH)
         {
             max_dH = val;
         }
         sum_dH += val;
 
-        // Error measurements pixel
-        val = sqrt(pow(p3dTo2d.x - p2d.x, 2) + pow(p3dTo2d.y - p2d.y, 2));
+        val = error[2];
         // Maximum
         if(val > max_px)
         {
@@ -609,35 +642,15 @@ bool ExtrCalibration::calcReprojectionError(const ExtrinsicParameters &extrParam
         }
         sum_px += val;
     }
-    for(size_t i = 0; i < num_points; i++)
+    for(const auto &error : errors)
     {
-        cv::Point2f p2d   = get2DList().at(i);
-        cv::Point3f p3d   = get3DList().at(i);
-        auto        trans = mControlWidget->getCalibCoord3DTrans();
-        p3d -= trans.toCvPoint();
-        cv::Point2f p3d_to_2d = getImagePoint(p3d, extrParams);
-
-        // Error measurements metric (cm)
-        cv::Point3f p2d_to_3d = get3DPoint(p2d, p3d.z, extrParams);
-
-        cv::Point3f p2d_to_3d_mapDefaultHeight =
-            get3DPoint(p2d, mControlWidget->getDefaultHeight(), extrParams); // mStatusPosRealHeight->value()); ?
-
-        cv::Point3f p3d_to2d_to3d_mapDefaultHeight =
-            get3DPoint(p3d_to_2d, mControlWidget->getDefaultHeight(), extrParams);
-
-        val = pow(sqrt(pow(p3d.x - p2d_to_3d.x, 2) + pow(p3d.y - p2d_to_3d.y, 2)) - (sum_pH / num_points), 2);
+        val = pow(error[0] - (sum_pH / num_points), 2);
         var_pH += val;
 
-        val =
-            pow(sqrt(
-                    pow(p3d_to2d_to3d_mapDefaultHeight.x - p2d_to_3d_mapDefaultHeight.x, 2) +
-                    pow(p3d_to2d_to3d_mapDefaultHeight.y - p2d_to_3d_mapDefaultHeight.y, 2)) -
-                    (sum_dH / num_points),
-                2);
+        val = pow(error[1] - (sum_dH / num_points), 2);
         var_dH += val;
 
-        val = pow(sqrt(pow(p3d_to_2d.x - p2d.x, 2) + pow(p3d_to_2d.y - p2d.y, 2)) - (sum_px / num_points), 2);
+        val = pow(error[2] - (sum_px / num_points), 2);
         var_px += val;
     }
 
@@ -690,9 +703,10 @@ bool ExtrCalibration::calcReprojectionError(const ExtrinsicParameters &extrParam
         max_px,
         mControlWidget->getDefaultHeight()};
 
-    return reprojectionError.pointHeightAvg() > MAX_AV_ERROR ?
-               false :
-               true; // Falls pixel fehler im schnitt > 20 ist das Ergebnis nicht akzeptabel
+    mReprojectionErrorInput = std::move(input);
+
+    // Falls pixel fehler im schnitt > 20 ist das Ergebnis nicht akzeptabel
+    return !(reprojectionError.pointHeightAvg() > MAX_AV_ERROR);
 }
 
 /**
@@ -713,67 +727,100 @@ cv::Point2f ExtrCalibration::getImagePoint(cv::Point3f p3d) const
 
 cv::Point2f ExtrCalibration::getImagePoint(cv::Point3f p3d, const ExtrinsicParameters &extrParams) const
 {
-    auto swap = mControlWidget->getCalibCoord3DSwap();
-    p3d.x *= swap.x ? -1 : 1;
-    p3d.y *= swap.y ? -1 : 1;
-    p3d.z *= swap.z ? -1 : 1;
-
-    // Adding the coordsystem translation from petrack window
-    auto trans = mControlWidget->getCalibCoord3DTrans();
-    p3d += trans.toCvPoint();
-
-    // ToDo: use projectPoints();
-    int bS = mMainWindow->getImage() ? mMainWindow->getImageBorderSize() : 0;
-
-    double rvec_array[3], translation_vector[3];
-
-    rvec_array[0] = extrParams.rot1;
-    rvec_array[1] = extrParams.rot2;
-    rvec_array[2] = extrParams.rot3;
-
-    cv::Mat rvec(3, 1, CV_64F, rvec_array), rot_inv;
-    cv::Mat rot_mat(3, 3, CV_64F), e(3, 3, CV_64F);
-    // Transform the rotation vector into a rotation matrix with opencvs rodrigues method
-    Rodrigues(rvec, rot_mat);
+    return getImagePoint(getCameraModel(extrParams), p3d);
+}
 
-    // use inverse Matrix to get translation_vector?
-    rot_inv = rot_mat.inv(cv::DECOMP_SVD);
+/**
+ * @brief Projects several 3D points onto the image plane
+ *
+ * Same as calling getImagePoint(cv::Point3f) for every point, but the camera
+ * parameters are only queried once.
+ *
+ * @param p3d 3D points to transform in cm
+ * @return calculated 2D projections in the order of p3d
+ */
+std::vector<cv::Point2f> ExtrCalibration::getImagePoint(const std::vector<cv::Point3f> &p3d) const
+{
+    const auto               model = getCameraModel(mControlWidget->getExtrinsicParameters());
+    std::vector<cv::Point2f> p2d;
+    p2d.reserve(p3d.size());
+    for(const auto &p : p3d)
+    {
+        p2d.push_back(getImagePoint(model, p));
+    }
+    return p2d;
+}
 
-    e = rot_inv * rot_mat;
+cv::Point2f ExtrCalibration::getImagePoint(const CameraModel &model, cv::Point3f p3d)
+{
+    p3d.x *= model.swap.x;
+    p3d.y *= model.swap.y;
+    p3d.z *= model.swap.z;
 
-    translation_vector[0] = rot_mat.at<double>(0, 0) * extrParams.trans1 +
-                            rot_mat.at<double>(0, 1) * extrParams.trans2 + rot_mat.at<double>(0, 2) * extrParams.trans3;
-    translation_vector[1] = rot_mat.at<double>(1, 0) * extrParams.trans1 +
-                            rot_mat.at<double>(1, 1) * extrParams.trans2 + rot_mat.at<double>(1, 2) * extrParams.trans3;
-    translation_vector[2] = rot_mat.at<double>(2, 0) * extrParams.trans1 +
-                            rot_mat.at<double>(2, 1) * extrParams.trans2 + rot_mat.at<double>(2, 2) * extrParams.trans3;
+    // Adding the coordsystem translation from petrack window
+    p3d += model.coordTrans;
 
+    // ToDo: use projectPoints();
+    const auto &rotMat = model.rotMat;
     cv::Point3f point3D;
 
-    point3D.x = rot_mat.at<double>(0, 0) * p3d.x + rot_mat.at<double>(0, 1) * p3d.y + rot_mat.at<double>(0, 2) * p3d.z +
-                translation_vector[0];
-    point3D.y = rot_mat.at<double>(1, 0) * p3d.x + rot_mat.at<double>(1, 1) * p3d.y + rot_mat.at<double>(1, 2) * p3d.z +
-                translation_vector[1];
-    point3D.z = rot_mat.at<double>(2, 0) * p3d.x + rot_mat.at<double>(2, 1) * p3d.y + rot_mat.at<double>(2, 2) * p3d.z +
-                translation_vector[2];
+    point3D.x = rotMat(0, 0) * p3d.x + rotMat(0, 1) * p3d.y + rotMat(0, 2) * p3d.z + model.translation[0];
+    point3D.y = rotMat(1, 0) * p3d.x + rotMat(1, 1) * p3d.y + rotMat(1, 2) * p3d.z + model.translation[1];
+    point3D.z = rotMat(2, 0) * p3d.x + rotMat(2, 1) * p3d.y + rotMat(2, 2) * p3d.z + model.translation[2];
 
     cv::Point2f point2D = cv::Point2f(0.0, 0.0);
     if(point3D.z != 0)
     {
-        const auto camMat = mControlWidget->getIntrinsicCameraParams();
-        const auto fx     = camMat.getFx();
-        const auto fy     = camMat.getFy();
-        const auto cx     = camMat.getCx();
-        const auto cy     = camMat.getCy();
-        point2D.x         = (fx * point3D.x) / point3D.z + (cx - bS);
-        point2D.y         = (fy * point3D.y) / point3D.z + (cy - bS);
+        point2D.x = (model.fx * point3D.x) / point3D.z + (model.cx - model.borderSize);
+        point2D.y = (model.fy * point3D.y) / point3D.z + (model.cy - model.borderSize);
     }
-    if(false && bS > 0)
+    return point2D;
+}
+
+/**
+ * @brief Collects the current camera parameters for projecting points
+ *
+ * Rodrigues and the inversion of the rotation matrix are only computed if
+ * extrParams differ from the ones of the last call. May be called from several
+ * threads.
+ *
+ * @param extrParams extrinsic parameters to use
+ * @return the camera model for extrParams and the current intrinsic parameters
+ */
+ExtrCalibration::CameraModel ExtrCalibration::getCameraModel(const ExtrinsicParameters &extrParams) const
+{
+    CameraModel model;
     {
-        point2D.x += bS;
-        point2D.y += bS;
+        std::lock_guard<std::mutex> lock(mCameraModelMutex);
+        if(mCameraModel && mCameraModel->extrParams == extrParams)
+        {
+            model = *mCameraModel;
+        }
+        else
+        {
+            model.extrParams = extrParams;
+            // Transform the rotation vector into a rotation matrix with opencvs rodrigues method
+            const cv::Vec3d rvec{extrParams.rot1, extrParams.rot2, extrParams.rot3};
+            Rodrigues(rvec, model.rotMat);
+            model.rotInv      = model.rotMat.inv(cv::DECOMP_LU);
+            model.translation = model.rotMat * cv::Vec3d{extrParams.trans1, extrParams.trans2, extrParams.trans3};
+            mCameraModel      = model;
+        }
     }
-    return point2D;
+
+    // the remaining parameters are cheap to query, so they are not cached
+    const auto camMat = mControlWidget->getIntrinsicCameraParams();
+    model.fx          = camMat.getFx();
+    model.fy          = camMat.getFy();
+    model.cx          = camMat.getCx();
+    model.cy          = camMat.getCy();
+    model.borderSize  = mMainWindow->getImage() ? mMainWindow->getImageBorderSize() : 0;
+
+    const auto swap  = mControlWidget->getCalibCoord3DSwap();
+    model.swap       = cv::Point3f(swap.x ? -1 : 1, swap.y ? -1 : 1, swap.z ? -1 : 1);
+    auto trans       = mControlWidget->getCalibCoord3DTrans();
+    model.coordTrans = trans.toCvPoint();
+    return model;
 }
 
 /**
@@ -787,17 +834,59 @@ cv::Point2f ExtrCalibration::getImagePoint(cv::Point3f p3d, const ExtrinsicParam
  */
 cv::Vec3d ExtrCalibration::camToWorldRotation(const cv::Vec3d &camVec) const
 {
-    // Transform the rotation vector into a rotation matrix with opencvs rodrigues method
-    cv::Matx<double, 3, 3> rotMat(3, 3, CV_64F);
-    const auto            &extrParams = mControlWidget->getExtrinsicParameters();
-    const auto             rvec       = cv::Vec3d(extrParams.rot1, extrParams.rot2, extrParams.rot3);
-    Rodrigues(rvec, rotMat);
-
-    auto      rotInv   = rotMat.inv(cv::DECOMP_LU);
-    cv::Vec3d worldVec = rotInv * camVec;
+    cv::Vec3d worldVec = getCamToWorldRotation() * camVec;
     return worldVec;
 }
 
+/**
+ * @brief Rotation matrix used by camToWorldRotation() for the current extrinsic parameters
+ *
+ * Meant for rotating many vectors without querying the parameters for each of them.
+ */
+cv::Matx<double, 3, 3> ExtrCalibration::getCamToWorldRotation() const
+{
+    return getCameraModel(mControlWidget->getExtrinsicParameters()).rotInv;
+}
+
+/**
+ * @brief Camera model for the current extrinsic and intrinsic parameters
+ *
+ * Queries the widgets, so it has to be called on the GUI thread.
+ */
+ExtrCalibration::CameraModel ExtrCalibration::getCameraModel() const
+{
+    return getCameraModel(mControlWidget->getExtrinsicParameters());
+}
+
+/**
+ * @brief Returns all parameters the projection between image and world coordinates depends on
+ *
+ * Overlays compare it to their last paint to find out whether they have to project their points again.
+ */
+std::array<double, 17> ExtrCalibration::getProjectionState() const
+{
+    const auto  model = getCameraModel(mControlWidget->getExtrinsicParameters());
+    const auto &extr  = model.extrParams;
+    return {
+        extr.trans1,
+        extr.trans2,
+        extr.trans3,
+        extr.rot1,
+        extr.rot2,
+        extr.rot3,
+        model.fx,
+        model.fy,
+        model.cx,
+        model.cy,
+        static_cast<double>(model.borderSize),
+        model.swap.x,
+        model.swap.y,
+        model.swap.z,
+        model.coordTrans.x,
+        model.coordTrans.y,
+        model.coordTrans.z};
+}
+
 /**
  * @brief Tranforms a 2D point into a 3D point with given height.
  *
@@ -813,30 +902,46 @@ cv::Point3f ExtrCalibration::get3DPoint(const cv::Point2f &p2d, double h) const
 
 cv::Point3f ExtrCalibration::get3DPoint(const cv::Point2f &p2d, double h, const ExtrinsicParameters &extrParams) const
 {
-    int bS = mMainWindow->getImage() ? mMainWindow->getImageBorderSize() : 0;
+    return get3DPoint(getCameraModel(extrParams), p2d, h);
+}
 
-    cv::Point3f resultPoint, tmpPoint;
+/**
+ * @brief Tranforms several 2D points into 3D points with the same height
+ *
+ * Same as calling get3DPoint(const cv::Point2f &, double) for every point, but
+ * the camera parameters are only queried once.
+ *
+ * @param p2d 2D pixel points (without border)
+ * @param h height i.e. distance to xy-plane in cm
+ * @return calculated 3D points in cm in the order of p2d
+ */
+std::vector<cv::Point3f> ExtrCalibration::get3DPoint(const std::vector<cv::Point2f> &p2d, double h) const
+{
+    const auto               model = getCameraModel(mControlWidget->getExtrinsicParameters());
+    std::vector<cv::Point3f> p3d;
+    p3d.reserve(p2d.size());
+    for(const auto &p : p2d)
+    {
+        p3d.push_back(get3DPoint(model, p, h));
+    }
+    return p3d;
+}
 
-    // Transform the rotation vector into a rotation matrix with opencvs rodrigues method
-    cv::Matx<double, 3, 3> rot_inv;
-    cv::Matx<double, 3, 3> rot_mat(3, 3, CV_64F);
-    const cv::Mat          rvec = (cv::Mat_<double>(3, 1) << extrParams.rot1, extrParams.rot2, extrParams.rot3);
-    Rodrigues(rvec, rot_mat);
-    rot_inv = rot_mat.inv(cv::DECOMP_LU, nullptr);
+cv::Point3f ExtrCalibration::get3DPoint(const CameraModel &model, const cv::Point2f &p2d, double h)
+{
+    const int   bS = model.borderSize;
+    const auto &fx = model.fx;
+    const auto &fy = model.fy;
+    const auto &cx = model.cx;
+    const auto &cy = model.cy;
 
-    // Create translation vector
-    cv::Vec3d translation{extrParams.trans1, extrParams.trans2, extrParams.trans3};
+    cv::Point3f resultPoint, tmpPoint;
 
-    const auto camMat = mControlWidget->getIntrinsicCameraParams();
-    const auto fx     = camMat.getFx();
-    const auto fy     = camMat.getFy();
-    const auto cx     = camMat.getCx();
-    const auto cy     = camMat.getCy();
+    const auto &rot_inv = model.rotInv;
 
     // Subtract principal point and border, so we can assume pinhole camera
     const cv::Vec2d centeredImagePoint{p2d.x - (cx - bS), p2d.y - (cy - bS)};
 
-
     /* Basic Idea:
      * All points projecting onto a point on the image plane lie on the same
      * line (cf. pinhole camera model). We can determine this line in the form:
@@ -871,7 +976,7 @@ cv::Point3f ExtrCalibration::get3DPoint(const cv::Point2f &p2d, double h, const
     const cv::Vec3d rotatedProj = rot_inv * pinholeProjectionXY1;
 
     // determine z via formula from comment above; using 3rd row
-    double z = (h + translation[2]) / rotatedProj[2];
+    double z = (h + model.extrParams.trans3) / rotatedProj[2];
 
     // Evaluate line at depth z; calc point in camera coords
     // written this way instead of z * pinholeProjectionXY1 (i.e. z * v) to not change test results due to floating
@@ -885,10 +990,10 @@ cv::Point3f ExtrCalibration::get3DPoint(const cv::Point2f &p2d, double h, const
 
     // We transform from cam coords to world coords with W = R * C - T
     // we now calc: W = R * (C - R^-1*T), which is equivalent
-    translation = rot_mat * translation;
-    tmpPoint.x  = resultPoint.x - translation[0];
-    tmpPoint.y  = resultPoint.y - translation[1];
-    tmpPoint.z  = resultPoint.z - translation[2];
+    const auto &translation = model.translation;
+    tmpPoint.x              = resultPoint.x - translation[0];
+    tmpPoint.y              = resultPoint.y - translation[1];
+    tmpPoint.z              = resultPoint.z - translation[2];
 
     resultPoint.x = rot_inv(0, 0) * (tmpPoint.x) + rot_inv(0, 1) * (tmpPoint.y) + rot_inv(0, 2) * (tmpPoint.z);
     resultPoint.y = rot_inv(1, 0) * (tmpPoint.x) + rot_inv(1, 1) * (tmpPoint.y) + rot_inv(1, 2) * (tmpPoint.z);
@@ -896,13 +1001,11 @@ cv::Point3f ExtrCalibration::get3DPoint(const cv::Point2f &p2d, double h, const
 
 
     // Coordinate Transformations
-    auto trans = mControlWidget->getCalibCoord3DTrans();
-    resultPoint -= trans.toCvPoint();
+    resultPoint -= model.coordTrans;
 
-    auto swap = mControlWidget->getCalibCoord3DSwap();
-    resultPoint.x *= swap.x ? -1 : 1;
-    resultPoint.y *= swap.y ? -1 : 1;
-    resultPoint.z *= swap.z ? -1 : 1;
+    resultPoint.x *= model.swap.x;
+    resultPoint.y *= model.swap.y;
+    resultPoint.z *= model.swap.z;
 
     return resultPoint;
 }
@@ -954,6 +1057,7 @@ void ExtrCalibration::getXml(QDomElement &elem)
         if(subElem.tagName() == "REPROJECTION_ERROR")
         {
             reprojectionError.getXml(subElem);
+            mReprojectionErrorInput.reset();
         }
     }
 }
@@ -25,6 +25,7 @@
 #include <QString>
 #include <array>
 #include <iostream>
+#include <mutex>
 #include <opencv2/opencv.hpp>
 #include <optional>
 #include <vector>
@@ -157,6 +158,59 @@ private:
     ReprojectionError reprojectionError;
     QString           mExtrCalibFile;
 
+public:
+    /**
+     * @brief Everything needed to project points between image and world coordinates
+     *
+     * The rotation is derived from the ExtrinsicParameters via Rodrigues and an
+     * inversion; it is cached and only recomputed if the extrinsic parameters change.
+     * As a copy does not access the widgets, it can be used by worker threads.
+     */
+    struct CameraModel
+    {
+        ExtrinsicParameters    extrParams;
+        cv::Matx<double, 3, 3> rotMat;
+        cv::Matx<double, 3, 3> rotInv;      ///< inverse of rotMat by LU decomposition
+        cv::Vec3d              translation; ///< rotMat * (trans1, trans2, trans3)
+        double                 fx         = 0;
+        double                 fy         = 0;
+        double                 cx         = 0;
+        double                 cy         = 0;
+        int                    borderSize = 0;
+        cv::Point3f            swap;       ///< -1 for swapped axes of the coordinate system, else 1
+        cv::Point3f            coordTrans; ///< translation of the coordinate system
+    };
+
+    static cv::Point2f getImagePoint(const CameraModel &model, cv::Point3f p3d);
+    static cv::Point3f get3DPoint(const CameraModel &model, const cv::Point2f &p2d, double h);
+
+private:
+    mutable std::mutex                 mCameraModelMutex;
+    mutable std::optional<CameraModel> mCameraModel; ///< cached rotation of the last used extrinsic parameters
+
+    /// everything the reprojection error depends on, to skip recomputing it for unchanged inputs
+    struct ReprojectionErrorInput
+    {
+        ExtrinsicParameters      extrParams;
+        std::array<double, 5>    camera; ///< fx, fy, cx, cy and border size
+        cv::Point3f              swap;
+        cv::Point3f              coordTrans;
+        double                   defaultHeight;
+        std::vector<cv::Point2f> points2D;
+        std::vector<cv::Point3f> points3D;
+
+        friend bool operator==(const ReprojectionErrorInput &lhs, const ReprojectionErrorInput &rhs)
+        {
+            return lhs.extrParams == rhs.extrParams && lhs.camera == rhs.camera && lhs.swap == rhs.swap &&
+                   lhs.coordTrans == rhs.coordTrans && lhs.defaultHeight == rhs.defaultHeight &&
+                   lhs.points2D == rhs.points2D && lhs.points3D == rhs.points3D;
+        }
+    };
+
+    std::optional<ReprojectionErrorInput> mReprojectionErrorInput; ///< inputs of the current reprojectionError
+
+    CameraModel getCameraModel(const ExtrinsicParameters &extrParams) const;
+
 public:
     ExtrCalibration(PersonStorage &storage);
     ~ExtrCalibration();
@@ -174,6 +228,12 @@ public:
     virtual cv::Point2f                getImagePoint(cv::Point3f p3d) const;
     virtual cv::Point2f                getImagePoint(cv::Point3f p3d, const ExtrinsicParameters &extrParams) const;
 
+    virtual std::vector<cv::Point2f>   getImagePoint(const std::vector<cv::Point3f> &p3d) const;
+    std::vector<cv::Point3f>           get3DPoint(const std::vector<cv::Point2f> &p2d, double h) const;
+    cv::Matx<double, 3, 3>             getCamToWorldRotation() const;
+    CameraModel                        getCameraModel() const;
+    std::array<double, 17>             getProjectionState() const;
+
     cv::Point3f get3DPoint(const cv::Point2f &p2d, double h) const;
     cv::Point3f get3DPoint(const cv::Point2f &p2d, double h, const ExtrinsicParameters &extrParams) const;
     cv::Point3f transformRT(cv::Point3f p);
@@ -0,0 +1,128 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pixelSizeMap.h"
+
+#include <algorithm>
+
+/**
+ * @brief Samples the map on a grid covering area
+ *
+ * The nodes are placed every cellSize pixel starting at the top left corner of
+ * area; the last row and column of nodes lie on or beyond the bottom right border.
+ *
+ * @param area image region the map is used for
+ * @param cellSize distance between two grid nodes in pixel
+ * @param sample computes the exact samples at the grid nodes
+ */
+void PixelSizeMap::build(const cv::Rect &area, int cellSize, const SampleFunction &sample)
+{
+    clear();
+    if(area.empty() || cellSize <= 0)
+    {
+        return;
+    }
+
+    const int cols = (area.width + cellSize - 1) / cellSize + 1;
+    const int rows = (area.height + cellSize - 1) / cellSize + 1;
+
+    std::vector<cv::Point2f> nodes;
+    nodes.reserve(static_cast<size_t>(cols) * rows);
+    for(int row = 0; row < rows; ++row)
+    {
+        for(int col = 0; col < cols; ++col)
+        {
+            nodes.emplace_back(
+                static_cast<float>(area.x + col * cellSize), static_cast<float>(area.y + row * cellSize));
+        }
+    }
+
+    auto samples = sample(nodes);
+    if(samples.size() != nodes.size())
+    {
+        return;
+    }
+
+    mArea     = area;
+    mCellSize = cellSize;
+    mCols     = cols;
+    mRows     = rows;
+    mSamples  = std::move(samples);
+}
+
+void PixelSizeMap::clear()
+{
+    mArea     = cv::Rect();
+    mCellSize = 0;
+    mCols     = 0;
+    mRows     = 0;
+    mSamples.clear();
+}
+
+/**
+ * @brief Checks whether p lies in the area the map was built for (border inclusive)
+ */
+bool PixelSizeMap::contains(const cv::Point2f &p) const
+{
+    return !isEmpty() && p.x >= mArea.x && p.y >= mArea.y && p.x <= mArea.x + mArea.width &&
+           p.y <= mArea.y + mArea.height;
+}
+
+/**
+ * @brief Bilinearly interpolated sample at p
+ *
+ * Points outside of the grid get the sample of the nearest point on the grid.
+ *
+ * @param p image point
+ * @return interpolated sample; all zero if the map is empty
+ */
+PixelSizeMap::Sample PixelSizeMap::at(const cv::Point2f &p) const
+{
+    if(isEmpty())
+    {
+        return {};
+    }
+
+    const float gx = std::clamp((p.x - mArea.x) / mCellSize, 0.f, static_cast<float>(mCols - 1));
+    const float gy = std::clamp((p.y - mArea.y) / mCellSize, 0.f, static_cast<float>(mRows - 1));
+    // a non-empty map has at least two nodes in each direction
+    const int   x0 = std::min(static_cast<int>(gx), mCols - 2);
+    const int   y0 = std::min(static_cast<int>(gy), mRows - 2);
+    const int   x1 = x0 + 1;
+    const int   y1 = y0 + 1;
+    const float fx = gx - x0;
+    const float fy = gy - y0;
+
+    const Sample &s00 = mSamples[y0 * mCols + x0];
+    const Sample &s01 = mSamples[y0 * mCols + x1];
+    const Sample &s10 = mSamples[y1 * mCols + x0];
+    const Sample &s11 = mSamples[y1 * mCols + x1];
+
+    auto interpolate = [fx, fy](float v00, float v01, float v10, float v11)
+    {
+        const float top    = v00 + fx * (v01 - v00);
+        const float bottom = v10 + fx * (v11 - v10);
+        return top + fy * (bottom - top);
+    };
+
+    Sample result;
+    result.headSize    = interpolate(s00.headSize, s01.headSize, s10.headSize, s11.headSize);
+    result.cmPerPixelX = interpolate(s00.cmPerPixelX, s01.cmPerPixelX, s10.cmPerPixelX, s11.cmPerPixelX);
+    result.cmPerPixelY = interpolate(s00.cmPerPixelY, s01.cmPerPixelY, s10.cmPerPixelY, s11.cmPerPixelY);
+    return result;
+}
@@ -0,0 +1,64 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PIXELSIZEMAP_H
+#define PIXELSIZEMAP_H
+
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Coarse lookup table of the head size and the cm per pixel over the image
+ *
+ * Both values only change slowly over the image, but computing them exactly
+ * needs several projections between image and world coordinates. The map
+ * samples them once on a regular grid with the given cell size and
+ * interpolates bilinearly between the grid nodes on lookup.
+ */
+class PixelSizeMap
+{
+public:
+    struct Sample
+    {
+        float headSize    = 0; ///< diameter of a head in pixel
+        float cmPerPixelX = 0;
+        float cmPerPixelY = 0;
+    };
+
+    /// computes the exact samples for all given image points
+    using SampleFunction = std::function<std::vector<Sample>(const std::vector<cv::Point2f> &)>;
+
+    void build(const cv::Rect &area, int cellSize, const SampleFunction &sample);
+    void clear();
+
+    bool            isEmpty() const { return mSamples.empty(); }
+    const cv::Rect &getArea() const { return mArea; }
+    int             getCellSize() const { return mCellSize; }
+    bool            contains(const cv::Point2f &p) const;
+    Sample          at(const cv::Point2f &p) const;
+
+private:
+    cv::Rect            mArea;
+    int                 mCellSize = 0;
+    int                 mCols     = 0; ///< number of grid nodes in x direction
+    int                 mRows     = 0; ///< number of grid nodes in y direction
+    std::vector<Sample> mSamples;      ///< grid nodes, row by row
+};
+
+#endif // PIXELSIZEMAP_H
@@ -0,0 +1,103 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pointUndistortion.h"
+
+#include <cmath>
+#include <opencv2/calib3d.hpp>
+
+void PointUndistortion::setCamera(const IntrinsicCameraParams &params)
+{
+    params.cameraMatrix.convertTo(mCamera, CV_64F);
+    params.distortionCoeffs.convertTo(mDist, CV_64F);
+}
+
+/**
+ * @brief Moves undistorted points to their position in the distorted frame
+ *
+ * This is the mapping cv::initUndistortRectifyMap computes for every pixel.
+ */
+void PointUndistortion::distort(std::vector<cv::Point2f> &points) const
+{
+    if(points.empty())
+    {
+        return;
+    }
+    const double fx = mCamera.at<double>(0, 0);
+    const double fy = mCamera.at<double>(1, 1);
+    const double cx = mCamera.at<double>(0, 2);
+    const double cy = mCamera.at<double>(1, 2);
+
+    // points on the plane z = 1 in front of the camera are projected with distortion
+    std::vector<cv::Point3f> rays;
+    rays.reserve(points.size());
+    for(const auto &point : points)
+    {
+        rays.emplace_back(static_cast<float>((point.x - cx) / fx), static_cast<float>((point.y - cy) / fy), 1.F);
+    }
+    const cv::Vec3d noRotation(0., 0., 0.);
+    const cv::Vec3d noTranslation(0., 0., 0.);
+    cv::projectPoints(rays, noRotation, noTranslation, mCamera, mDist, points);
+}
+
+/// Moves points of the distorted frame to their position in the undistorted image
+void PointUndistortion::undistort(std::vector<cv::Point2f> &points) const
+{
+    if(points.empty())
+    {
+        return;
+    }
+    // more iterations than the default, so undistort inverts distort up to a hundredth of a pixel
+    const cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 20, 1e-6);
+    std::vector<cv::Point2f> undistorted;
+    cv::undistortPoints(points, undistorted, mCamera, mDist, cv::noArray(), mCamera, criteria);
+    points.swap(undistorted);
+}
+
+cv::Point2f PointUndistortion::distort(const cv::Point2f &point) const
+{
+    std::vector<cv::Point2f> points{point};
+    distort(points);
+    return points.front();
+}
+
+cv::Point2f PointUndistortion::undistort(const cv::Point2f &point) const
+{
+    std::vector<cv::Point2f> points{point};
+    undistort(points);
+    return points.front();
+}
+
+/**
+ * @brief Size of a pixel of the undistorted image at point in the distorted frame
+ *
+ * Sizes measured in the undistorted image, like the head size and the tracking
+ * windows derived from it, are multiplied with the scale to be used in the
+ * distorted frame.
+ *
+ * @param point undistorted position
+ * @return square root of the determinant of the Jacobian of distort() at point
+ */
+double PointUndistortion::scale(const cv::Point2f &point) const
+{
+    std::vector<cv::Point2f> points{point, point + cv::Point2f(1.F, 0.F), point + cv::Point2f(0.F, 1.F)};
+    distort(points);
+    const cv::Point2f dx = points[1] - points[0];
+    const cv::Point2f dy = points[2] - points[0];
+    return std::sqrt(std::abs(static_cast<double>(dx.cross(dy))));
+}
@@ -0,0 +1,52 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef POINTUNDISTORTION_H
+#define POINTUNDISTORTION_H
+
+#include "intrinsicCameraParams.h"
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+/**
+ * @brief Maps points between the distorted frame and the image undistorted by the CalibFilter
+ *
+ * For marker types robust to mild distortion, tracking and recognition can run on the
+ * distorted frame, which saves the remap of every frame. Only the resulting points are
+ * undistorted, with the same model as the mapping of the CalibFilter. Both directions
+ * work on image coordinates of the bordered frame, as the CalibFilter does.
+ */
+class PointUndistortion
+{
+public:
+    void setCamera(const IntrinsicCameraParams &params);
+
+    void        distort(std::vector<cv::Point2f> &points) const;
+    void        undistort(std::vector<cv::Point2f> &points) const;
+    cv::Point2f distort(const cv::Point2f &point) const;
+    cv::Point2f undistort(const cv::Point2f &point) const;
+
+    double scale(const cv::Point2f &point) const;
+
+private:
+    cv::Mat mCamera = cv::Mat::eye(3, 3, CV_64F);
+    cv::Mat mDist   = cv::Mat::zeros(1, 14, CV_64F);
+};
+
+#endif // POINTUNDISTORTION_H
@@ -20,15 +20,22 @@
 
 #include "animation.h"
 #include "control.h"
+#include "disparityStore.h"
 #include "ellipse.h"
 #include "helper.h"
 #include "pMessageBox.h"
 #include "person.h"
 #include "petrack.h"
+#include "roiItem.h"
 #include "stereoItem.h"
 #include "stereoWidget.h"
+#include "trace.h"
 
 #include <QDir>
+#include <QtConcurrent>
+#include <algorithm>
+#include <array>
+#include <climits>
 
 #ifdef STEREO
 
@@ -56,7 +63,23 @@ pet::StereoContext::StereoContext(Petrack *main)
     mMain      = main;
     mAnimation = main->getAnimation();
     mStatus    = clean;
+    mMin       = USHRT_MAX;
+    mMax       = 0;
+    mBMState   = nullptr;
 
+#ifndef STEREO
+    // without Triclops the pair is rectified by OpenCV with the calibration stored next to the video
+    const QFileInfo video       = mAnimation->getFileInfo();
+    const QString   calibration = video.absolutePath() + "/" + video.completeBaseName() + "_stereo.yml";
+    if(mRectification.load(calibration))
+    {
+        SPDLOG_INFO("Using {} for the stereo rectification.", calibration);
+    }
+    else
+    {
+        SPDLOG_ERROR("No stereo calibration {} found, the stereo images cannot be rectified!", calibration);
+    }
+#else
     QString calFile, calFileInt;
     QDate   fileDate = mAnimation->getFileInfo().lastModified().date();
     QString version;
@@ -107,7 +130,6 @@ pet::StereoContext::StereoContext(Petrack *main)
         return;
     }
     SPDLOG_INFO("Using {} ({}) for calibration.", calFile.toStdString(), version.toStdString());
-#ifdef STEREO
     TriclopsError triclopsError;
     triclopsError =
         triclopsGetDefaultContextFromFile(&mTriclopsContext, static_cast<char *>(calFile.toLatin1().data()));
@@ -164,13 +186,11 @@ pet::StereoContext::StereoContext(Petrack *main)
     triclopsGetSurfaceValidationMapping(mTriclopsContext, &mSurfaceValue);
     triclopsGetBackForthValidationMapping(mTriclopsContext, &mBackForthValue);
 #endif
-    mMin     = USHRT_MAX;
-    mMax     = 0;
-    mBMState = nullptr;
 }
 
 pet::StereoContext::~StereoContext()
 {
+    waitForDisparity();
 #ifdef STEREO
     if(mTriclopsContext)
         triclopsDestroyContext(mTriclopsContext);
@@ -186,18 +206,21 @@ void pet::StereoContext::init(Mat &viewImg) //  = NULL
     //        viewImg = lastViewImg;
     //    lastViewImg = viewImg;
 
-    if(!viewImg.empty() && (viewImg.cols != 1280 || viewImg.rows != 960))
+#ifdef STEREO
+    const cv::Size stereoSize(1280, 960);
+#else
+    const cv::Size stereoSize = mRectification.getImageSize();
+#endif
+    if(!viewImg.empty() && viewImg.size() != stereoSize)
     {
-        SPDLOG_WARN("no images beside 1280x960!");
+        SPDLOG_WARN("no images beside {}x{}!", stereoSize.width, stereoSize.height);
         return;
     }
+    // a pending disparity belongs to the previous pair
+    waitForDisparity();
 
     cv::Mat leftImg, rightImg;
 
-#ifdef STEREO
-    TriclopsError triclopsError;
-
-
     if(!viewImg.empty() && (mAnimation->getCaptureStereo()->getCamera() == cameraLeft))
     {
         leftImg        = cv::Mat(viewImg.size(), viewImg.type());
@@ -215,6 +238,9 @@ void pet::StereoContext::init(Mat &viewImg) //  = NULL
     else
         rightImg = mAnimation->getCaptureStereo()->getFrame(cameraRight);
 
+#ifdef STEREO
+    TriclopsError triclopsError;
+
     // Background subtraction
     //        if (brightContrastChanged || borderChanged || calibChanged)
     //            mBackgroundFilter.reset(); // alle gesammelten hintergrundinfos werden verworfen und bg.changed auf
@@ -263,6 +289,16 @@ void pet::StereoContext::init(Mat &viewImg) //  = NULL
         &mTriclopsInput);
     if(triclopsError != TriclopsErrorOk)
         SPDLOG_ERROR(triclopsErrorToString(triclopsError));
+#else
+    if(mRectification.isValid() && leftImg.size() == stereoSize && rightImg.size() == stereoSize)
+    {
+        mRectification.rectify(leftImg, rightImg, mRectLeft, mRectRight);
+    }
+    else
+    {
+        mRectLeft.release();
+        mRectRight.release();
+    }
 #endif
     mDisparity = cv::Mat(leftImg.size(), CV_16FC1);
 
@@ -290,6 +326,12 @@ void pet::StereoContext::preprocess()
         if(triclopsError != TriclopsErrorOk)
             SPDLOG_ERROR(triclopsErrorToString(triclopsError));
         setStatus(preprocessed);
+#else
+        // already rectified in init()
+        if(!mRectLeft.empty())
+        {
+            setStatus(preprocessed);
+        }
 #endif
         //        TriclopsBool b;
         //        triclopsGetLowpass(mTriclopsContext, &b);
@@ -300,10 +342,7 @@ void pet::StereoContext::preprocess()
 // cameraRight is default, da disp mit diesem identisch
 cv::Mat pet::StereoContext::getRectified(enum Camera camera)
 {
-#ifdef TIME_MEASUREMENT
-    //        "==========: "
-    debout << "in rectify: " << getElapsedTime() << endl;
-#endif
+    TRACE_ZONE("StereoContext::getRectified");
 
     if((camera != cameraRight) && (camera != cameraLeft))
         camera = mAnimation->getCaptureStereo()->getCamera();
@@ -400,16 +439,13 @@ cv::Mat pet::StereoContext::getRectified(enum Camera camera)
 #endif
 
 
-#ifdef TIME_MEASUREMENT
-            //        "==========: "
-            debout << "ou rectify: " << getElapsedTime() << endl;
-#endif
-
-
             return mRectRight;
         }
         else
             return cv::Mat(); // NOTE fehlerbehandlung
+#else
+        addStatus(rectified);
+        return camera == cameraLeft ? mRectLeft : mRectRight;
 #endif
     }
     return cv::Mat();
@@ -455,10 +491,7 @@ cv::Mat pet::StereoContext::getRectified(enum Camera camera)
 
 cv::Mat pet::StereoContext::getDisparity(bool *dispNew)
 {
-#ifdef TIME_MEASUREMENT
-    //        "==========: "
-    debout << "in    disp: " << getElapsedTime() << std::endl;
-#endif
+    TRACE_ZONE("StereoContext::getDisparity");
 
     if(dispNew != NULL)
         *dispNew = false;
@@ -676,8 +709,17 @@ cv::Mat pet::StereoContext::getDisparity(bool *dispNew)
 
         //            //------------------------------------------------------------------------------------------------------------------------
 
-        if(mMain->getStereoWidget()->stereoDispAlgo->currentIndex() ==
-           0) // ptGrey -------------------------------------------------------
+        DisparityStore *store     = mMain->getDisparityStore();
+        const int       frame     = mAnimation->getCurrentFrameNum();
+        bool            fromStore = false;
+        if(store && store->get(frame, mBMdisparity16))
+        {
+            // computed with the same parameters before, a started computation is not needed anymore
+            waitForDisparity();
+            mDisparity = mBMdisparity16;
+            fromStore  = true;
+        }
+        else if(getDisparitySettings().algorithm == dispPtGrey)
         {
             //// Description: This structure is used for image output from the Triclops
             ////   system for image types that require 16-bits per pixel.  This is the format
@@ -732,213 +774,29 @@ cv::Mat pet::StereoContext::getDisparity(bool *dispNew)
             mDisparity.data = (uchar *) mTriDisparity.data;
 #endif
         }
-        else if(
-            mMain->getStereoWidget()->stereoDispAlgo->currentIndex() ==
-            1) // openCV Block Matching
-               // ----------------------------------------------------------------------------------------------------------------------------
+        else // openCV block matching and semi-global matching
         {
-            // Bestimmung CV_16S und Ausgabe der opencv disp
-
-            if(!mBMState) // noch =NULL
+            if(mDisparityPending)
             {
-                mBMState = cv::StereoBM::create(64); // durch 16 teilbar
-                if(mBMState == nullptr)
-                    SPDLOG_ERROR("setting up the block matching state!");
+                // already computed on a worker, see startDisparity()
+                mBMdisparity16    = mPendingDisparity.result();
+                mDisparityPending = false;
             }
-            //        int edgeMaskSize = mMain->getStereoWidget()->edgeMaskSize->value()*4+1; // +1 wg ungerade
-            //        mBMState->preFilterSize = (edgeMaskSize>255?255:(edgeMaskSize<5?5:edgeMaskSize));//19; 41
-            //        debout << mBMState->preFilterSize << endl;
-            //        mBMState->preFilterCap=19; 31
-
-
-            int blockSize = mMain->getStereoWidget()->stereoMaskSize->value();
-            blockSize     = myClip(blockSize, 5, 21);
-            mBMState->setBlockSize(
-                blockSize); // minimum 5 erlaubt, ab 21 wird zuviel als mindens und maxdens angezeigt!
-            //        mBMState->textureThreshold=d; 10
-            //        mBMState->uniquenessRatio=e; 15
-
-            // umkehrung der disparity, da links und rechts vertauscht werden musste, damit disp fuer rechtes bild
-            // berechnet wird
-            mBMState->setMinDisparity(
-                -(mMain->getStereoWidget()->maxDisparity->value()) +
-                1); // +1, weil es dann mit ptgrey fuer min besser passt
-            mBMState->setNumDisparities(
-                16 *
-                ((mMain->getStereoWidget()->maxDisparity->value() - mMain->getStereoWidget()->minDisparity->value()) /
-                 16));                             // muss durch 16 teilbar sein
-            if(mBMState->getNumDisparities() < 16) // mind 16 ist vorgeschrieben
-                mBMState->setNumDisparities(16);
-
-            if(mBMdisparity16.empty())
-            {
-                mBMdisparity16 = cv::Mat(
-                    mDisparity.size(),
-                    CV_16S); // mRectRight.height, mRectRight.width gehtz nicht da ggf noch nicht vorliegend
-            }
-
-            // folgendes kann nicht genutzt werden um rechenzeiut zu sparen, da rectified nach erstem durchlauf dieser
-            // fkt auch mit ptgrey gesetzt wird, dabei aber nicht mrectleft gesetzt wird
-            //            if (mStatus & rectified)
-            //                cvFindStereoCorrespondenceBM(&mRectRight, &mRectLeft, mBMdisparity16, mBMState);
-            //            else
-            //
-            //            cv::StereoBM::compute(getRectified(cameraRight),getRectified(cameraLeft),mBMdisparity16);
-
-            mBMState->compute(getRectified(cameraLeft), getRectified(cameraRight), mBMdisparity16);
-
-            //            cvMinMaxLoc(mBMdisparity16, &dMin, &dMax);
-            //            debout << (mBMState->minDisparity-1)*16 << " " << dMin << " " << dMax <<endl;
-
-            //            CvMat* BMdisparity_visual = cvCreateMat(mRectRight.height, mRectRight.width, CV_8U);
-            //            cvConvertScale(mBMdisparity16, BMdisparity_visual, 255/dMax);//,
-            //            255/((mBMState->minDisparity+mBMState->numberOfDisparities)*16));//, 255/dMax);
-            //            //255/(dMax-mBMState->minDisparity*16), -mBMState->minDisparity); // scale, shift
-            //            // weiss sind ausreisser nach oben
-            //            // mittlerer Grauwert zeigt an, dass nichts gefunden wurde
-            //            // schwarz ist 0 und liegt untzer minDisparity
-            //            cvMinMaxLoc(BMdisparity_visual, &dMin, &dMax);
-            //            debout << dMin << " " << dMax <<endl;
-            //            cvNamedWindow("CVdispBM16", CV_WINDOW_AUTOSIZE);
-            //            cvShowImage("CVdispBM16", BMdisparity_visual);
-
-            // exchange/replace value in mBMdisparity16 so that the error value is the same like in pointgrey
-            short *data16  = (short *) mBMdisparity16.data;
-            short *yData16 = data16;
-
-            //            int noDispAnz1 = 0, noDispAnz2 = 0, noDispAnz3 = 0;
-            //            double dMin, dMax;
-            //            cvMinMaxLoc(mBMdisparity16, &dMin, &dMax);
-            //            debout << endl << mBMState->minDisparity << " " <<
-            //            mBMState->minDisparity+mBMState->numberOfDisparities <<endl; debout << dMin << " " << dMax
-            //            <<endl;
-
-            for(int y = 0; y < mBMdisparity16.rows; ++y)
+            else
             {
-                for(int x = 0; x < mBMdisparity16.cols; ++x)
-                {
-                    // if ((*data16 < (mBMState->minDisparity)*16) || (*data16 >
-                    // (mBMState->minDisparity+mBMState->numberOfDisparities)*16)) // zeigt genau den Bereich, der auch
-                    // algo uebergeben wurde
-                    if((-*data16 < (mMain->getStereoWidget()->minDisparity->value()) * 16) ||
-                       (-*data16 > (mMain->getStereoWidget()->maxDisparity->value()) *
-                                       16) || // laesst nur den Teil ueber, der in gui eingestellt wurde
-                       (*data16 <= (mBMState->getMinDisparity()) *
-                                       16)) // enthaelt auch: (*data16 == (mBMState->minDisparity-1)*16)) // marker fuer
-                                            // nicht berechneten wert
-                    {
-                        //                        if (*data16 == (mBMState->minDisparity-1)*16)
-                        //                            ++noDispAnz1;
-                        //                        else
-                        //                            ++noDispAnz2;
-                        *data16 = static_cast<short>(0xFF00); // fehlercode gemaess ptgrey
-                    }
-                    //                    if (*data16 == (mBMState->minDisparity-1)*16) // eigentlicher fehler-wert,
-                    //                    wenn nichts erkannt wird; wird durch vorherige abfrage mit geloescht
-                    //                    {
-                    ////                        ++noDispAnz;
-                    //                        *data16 = 0xFF00;
-                    //                    }
-                    //                    else if (*data16 > 0) // passiert nicht mehr
-                    //                    {
-                    //                        *data16 = 0; //*data16+0x8000; // da signed <-> unsigned: zB bei char:
-                    //                        -127 und 255 gleiche bitrepraesentation
-                    ////                        ++noDispAnz3;
-                    //                    }
-                    else
-                        // vorzeichen umkehren und
-                        // disparityFloat = (float) disparity16 / 256.0; //16-bit in triclops umrechung
-                        *data16 = -*data16 *
-                                  16; // *16, da cv disp nur faktor 16 fuer subpixelgenauigkeit hat und triclops *256
-                    //                    else
-                    //                        *data16 = (unsigned int) *data16;
-                    ++data16;
-                }
-                data16 = (yData16 += (mBMdisparity16.step1())); // width);
+                mBMdisparity16 = computeDisparity(
+                    getRectified(cameraLeft), getRectified(cameraRight), getDisparitySettings());
             }
-
-            //            debout << noDispAnz1 << " " << noDispAnz2 << " " << noDispAnz3 << " " <<endl;
-            //            cvMinMaxLoc(mBMdisparity16, &dMin, &dMax);
-            //            debout << dMin << " " << dMax <<endl;
-
-            //            unsigned short int uu; short int ss;
-            //            uu = 0x8000; ss = 0x8000;
-            //            debout << uu << " " << ss << endl;
-
-            mDisparity.data = mBMdisparity16.data;
+            mDisparity = mBMdisparity16;
         }
-        else if(
-            mMain->getStereoWidget()->stereoDispAlgo->currentIndex() ==
-            2) // openCV semi-global block matching
-               // http://opencv.willowgarage.com/documentation/cpp/camera_calibration_and_3d_reconstruction.html#stereosgbm
-               // ----------------------------------------------------------------------------------------------------------------------------
+        if(store && !fromStore)
         {
-            int SADWindowSize = 11;
-            int nDisparities =
-                (mMain->getStereoWidget()->maxDisparity->value() - mMain->getStereoWidget()->minDisparity->value()) /
-                16;
-            // mSgbm = StereoSGBM::create(nDisparities, SADWindowSize);
-            mSgbm = StereoSGBM::create(
-                0,                                       // minDisparity
-                16 * nDisparities,                       // numDisparities
-                11,                                      // blockSize
-                8 * SADWindowSize * SADWindowSize,       // P1
-                4 * (8 * SADWindowSize * SADWindowSize), // P2
-                1,                                       // disp12MaxDiff
-                63,                                      // preFilterCap
-                15,                                      // uniquenessRatio
-                3,                                       // speckleWindowSize
-                3,                                       // speckleRange
-                StereoSGBM::MODE_SGBM                    // mode
-            );
-
-            if(mBMdisparity16.empty())
-            {
-                mBMdisparity16 = cv::Mat(mDisparity.size(), CV_16S);
-            }
-
-
-            cv::Mat MR(getRectified(cameraRight));
-            cv::Mat ML(getRectified(cameraLeft));
-            mSgbm->compute(ML, MR, mBMdisparity16);
-
-            // exchange/replace value in mBMdisparity16 so that the error value is the same like in pointgrey
-            short *data16  = (short *) mBMdisparity16.data;
-            short *yData16 = data16;
-
-            for(int y = 0; y < mBMdisparity16.rows; ++y)
-            {
-                for(int x = 0; x < mBMdisparity16.cols; ++x)
-                {
-                    if((*data16 < (mMain->getStereoWidget()->minDisparity->value()) * 16) ||
-                       (*data16 > (mMain->getStereoWidget()->maxDisparity->value()) *
-                                      16) || // laesst nur den Teil ueber, der in gui eingestellt wurde
-
-                       (*data16 <= (-(mMain->getStereoWidget()->maxDisparity->value()) + 1) * 16))
-                    {
-                        *data16 = static_cast<short>(0xFF00); // fehlercode gemaess ptgrey
-                    }
-                    else // vorzeichen umkehren und
-                    {
-                        if(*data16 * 16 > SHRT_MAX)
-                        {
-                            *data16 = SHRT_MAX;
-                            SPDLOG_WARN("Disparity set to SHRT_MAX for Pixel {}/{}", x, y);
-                        }
-                        else
-                            *data16 =
-                                *data16 *
-                                16; // *16, da cv disp nur faktor 16 fuer subpixelgenauigkeit hat und triclops *256
-                    }
-                    ++data16;
-                }
-                data16 = (yData16 += (mBMdisparity16.step1()));
-            }
-
-            mDisparity = mBMdisparity16;
+            store->put(frame, mDisparity);
         }
 
         setStatus(genDisparity);
+        // the point cloud of the former disparity is outdated
+        std::fill(mPointCloudTiles.begin(), mPointCloudTiles.end(), false);
 
         if(mMin == USHRT_MAX) // das allererste Mal
             calcMinMax();
@@ -1004,12 +862,6 @@ cv::Mat pet::StereoContext::getDisparity(bool *dispNew)
 #endif
 
 
-#ifdef TIME_MEASUREMENT
-        //        "==========: "
-        debout << "out   disp: " << getElapsedTime() << endl;
-#endif
-
-
         return mDisparity;
     }
     else if(mStatus & genDisparity)
@@ -1021,7 +873,241 @@ cv::Mat pet::StereoContext::getDisparity(bool *dispNew)
 }
 
 // gibt die cm pro pixel in der entfernung von z Metern von der Kamera zurueck
-double pet::StereoContext::getCmPerPixel([[maybe_unused]] float z)
+namespace
+{
+/**
+ * @brief Converts disparities of OpenCV to the convention of ptGrey
+ *
+ * OpenCV has a factor of 16 for subpixel precision, triclops a factor of 256. Values outside
+ * of [minDisparity, maxDisparity] and values OpenCV could not compute get the error code 0xFF00.
+ *
+ * @param disp16 CV_16S disparities, converted in place
+ * @param sign -1, if the sign of the disparities has to be inverted (block matching)
+ * @param minDisparity smallest disparity set in the StereoWidget
+ * @param maxDisparity largest disparity set in the StereoWidget
+ */
+void toPtGreyDisparity(cv::Mat &disp16, int sign, int minDisparity, int maxDisparity)
+{
+    // marker fuer nicht berechneten wert
+    const int lowest = (-maxDisparity + 1) * 16;
+    cv::parallel_for_(
+        cv::Range(0, disp16.rows),
+        [&](const cv::Range &range)
+        {
+            for(int y = range.start; y < range.end; ++y)
+            {
+                short *data16 = disp16.ptr<short>(y);
+                for(int x = 0; x < disp16.cols; ++x)
+                {
+                    const int disp = sign * data16[x];
+                    // laesst nur den Teil ueber, der in gui eingestellt wurde
+                    if(disp < minDisparity * 16 || disp > maxDisparity * 16 || data16[x] <= lowest)
+                    {
+                        data16[x] = static_cast<short>(0xFF00); // fehlercode gemaess ptgrey
+                    }
+                    else
+                    {
+                        data16[x] = static_cast<short>(std::min(disp * 16, SHRT_MAX));
+                    }
+                }
+            }
+        });
+}
+} // namespace
+
+/**
+ * @brief Reads the parameters of the disparity computation from the StereoWidget
+ *
+ * Has to be called on the GUI thread. If only the ROIs are used, the rows are limited to
+ * the union of the recognition and the tracking ROI and the reach of the matching windows.
+ */
+pet::DisparitySettings pet::StereoContext::getDisparitySettings() const
+{
+    const StereoWidget *widget = mMain->getStereoWidget();
+
+    DisparitySettings settings;
+    settings.algorithm    = widget->stereoDispAlgo->currentIndex();
+    settings.minDisparity = widget->minDisparity->value();
+    settings.maxDisparity = widget->maxDisparity->value();
+    settings.maskSize     = widget->stereoMaskSize->value();
+#ifndef STEREO
+    if(settings.algorithm == dispPtGrey)
+    {
+        // the matcher of ptGrey is part of Triclops
+        settings.algorithm = dispSemiGlobal3Way;
+    }
+#endif
+
+    if(mMain->isStereoRoiOnly() && !mDisparity.empty())
+    {
+        const QRectF roi    = mMain->getRecoRoiItem()->rect().united(mMain->getTrackRoiItem()->rect());
+        const int    border = mMain->getImageBorderSize();
+        const int    margin = std::max(settings.maskSize, semiGlobalBlockSize);
+        const int    first  = std::max(0, myRound(roi.top()) + border - margin);
+        const int    last   = std::min(mDisparity.rows, myRound(roi.bottom()) + border + margin);
+        if(first < last)
+        {
+            settings.rows = cv::Range(first, last);
+        }
+    }
+    return settings;
+}
+
+/**
+ * @brief Computes the disparity of a rectified pair with one of the OpenCV algorithms
+ *
+ * Only uses the matchers of this context, so it can run on a worker thread, as long as
+ * only one computation runs at a time.
+ *
+ * @param left rectified left image
+ * @param right rectified right image
+ * @param settings see getDisparitySettings()
+ * @return CV_16S disparity in the convention of ptGrey; rows outside of settings.rows are invalid
+ */
+cv::Mat
+pet::StereoContext::computeDisparity(const cv::Mat &left, const cv::Mat &right, const DisparitySettings &settings)
+{
+    const cv::Mat leftRows       = left.rowRange(settings.rows);
+    const cv::Mat rightRows      = right.rowRange(settings.rows);
+    const int     numDisparities = std::max(16, 16 * ((settings.maxDisparity - settings.minDisparity) / 16));
+
+    cv::Mat disp16;
+    int     sign      = 1;
+    int     algorithm = settings.algorithm;
+#ifndef HAVE_OPENCV_CUDASTEREO
+    if(algorithm == dispCudaSemiGlobal)
+    {
+        SPDLOG_WARN("OpenCV was built without CUDA stereo, using semi-global block matching on the CPU.");
+        algorithm = dispSemiGlobal3Way;
+    }
+#endif
+    switch(algorithm)
+    {
+        case dispBlockMatching:
+        {
+            if(!mBMState)
+            {
+                mBMState = cv::StereoBM::create(64); // durch 16 teilbar
+            }
+            // minimum 5 erlaubt, ab 21 wird zuviel als mindens und maxdens angezeigt!
+            mBMState->setBlockSize(myClip(settings.maskSize, 5, 21));
+            // umkehrung der disparity, da links und rechts vertauscht werden musste, damit disp fuer rechtes bild
+            // berechnet wird; +1, weil es dann mit ptgrey fuer min besser passt
+            mBMState->setMinDisparity(-settings.maxDisparity + 1);
+            mBMState->setNumDisparities(numDisparities); // muss durch 16 teilbar sein, mind 16
+            mBMState->compute(leftRows, rightRows, disp16);
+            sign = -1;
+            break;
+        }
+        case dispSemiGlobal:
+            [[fallthrough]];
+        case dispSemiGlobal3Way:
+        {
+            // http://opencv.willowgarage.com/documentation/cpp/camera_calibration_and_3d_reconstruction.html#stereosgbm
+            if(!mSgbm)
+            {
+                constexpr int P1 = 8 * semiGlobalBlockSize * semiGlobalBlockSize;
+                mSgbm            = StereoSGBM::create(
+                    0,                   // minDisparity
+                    numDisparities,      // numDisparities
+                    semiGlobalBlockSize, // blockSize
+                    P1,                  // P1
+                    4 * P1,              // P2
+                    1,                   // disp12MaxDiff
+                    63,                  // preFilterCap
+                    15,                  // uniquenessRatio
+                    3,                   // speckleWindowSize
+                    3                    // speckleRange
+                );
+            }
+            mSgbm->setNumDisparities(numDisparities);
+            // 3-way uses less memory and is much faster, but considers fewer paths
+            mSgbm->setMode(algorithm == dispSemiGlobal3Way ? StereoSGBM::MODE_SGBM_3WAY : StereoSGBM::MODE_SGBM);
+            mSgbm->compute(leftRows, rightRows, disp16);
+            break;
+        }
+#ifdef HAVE_OPENCV_CUDASTEREO
+        case dispCudaSemiGlobal:
+        {
+            // only 64, 128 and 256 disparities are supported
+            const int cudaDisparities = numDisparities <= 64 ? 64 : (numDisparities <= 128 ? 128 : 256);
+            if(!mCudaSgm || mCudaSgm->getNumDisparities() != cudaDisparities)
+            {
+                mCudaSgm = cv::cuda::createStereoSGM(0, cudaDisparities);
+            }
+            cv::cuda::GpuMat gpuLeft(leftRows);
+            cv::cuda::GpuMat gpuRight(rightRows);
+            cv::cuda::GpuMat gpuDisparity;
+            mCudaSgm->compute(gpuLeft, gpuRight, gpuDisparity);
+            gpuDisparity.download(disp16);
+            break;
+        }
+#endif
+        default:
+            SPDLOG_ERROR("Unknown disparity algorithm {}.", algorithm);
+            return cv::Mat();
+    }
+
+    toPtGreyDisparity(disp16, sign, settings.minDisparity, settings.maxDisparity);
+
+    cv::Mat disparity(left.size(), CV_16S, cv::Scalar::all(static_cast<short>(0xFF00)));
+    disp16.copyTo(disparity.rowRange(settings.rows));
+    return disparity;
+}
+
+/**
+ * @brief Starts computing the disparity of the current pair on a worker thread
+ *
+ * getDisparity() takes the result, so the computation overlaps with the work done on the
+ * GUI thread meanwhile, e.g. the tracking of the frame. Only the OpenCV algorithms run on a
+ * worker; ptGrey uses the Triclops context, which stays on the GUI thread.
+ */
+void pet::StereoContext::startDisparity()
+{
+    waitForDisparity();
+    if(!(mStatus & preprocessed) || (mStatus & genDisparity))
+    {
+        return;
+    }
+
+    const DisparityStore *store = mMain->getDisparityStore();
+    if(store && store->contains(mAnimation->getCurrentFrameNum()))
+    {
+        // getDisparity() reads it from the store
+        return;
+    }
+
+    const DisparitySettings settings = getDisparitySettings();
+    if(settings.algorithm == dispPtGrey || settings.minDisparity >= settings.maxDisparity)
+    {
+        return;
+    }
+    // the buffers of the rectified images are reused by the next pair
+    const cv::Mat left  = getRectified(cameraLeft).clone();
+    const cv::Mat right = getRectified(cameraRight).clone();
+    if(left.empty() || right.empty())
+    {
+        return;
+    }
+
+    mPendingDisparity =
+        QtConcurrent::run([this, left, right, settings]() { return computeDisparity(left, right, settings); });
+    mDisparityPending = true;
+}
+
+/**
+ * @brief Waits for a disparity started by startDisparity() and discards it
+ */
+void pet::StereoContext::waitForDisparity()
+{
+    if(mDisparityPending)
+    {
+        mPendingDisparity.waitForFinished();
+        mDisparityPending = false;
+    }
+}
+
+double pet::StereoContext::getCmPerPixel(float z)
 {
 #ifdef STEREO
 
@@ -1035,7 +1121,7 @@ double pet::StereoContext::getCmPerPixel([[maybe_unused]] float z)
     triclopsXYZToRCD(mTriclopsContext, 1., 2., z, &row2, &col, &disp);
     return 100. / (row2 - row1);
 #else
-    return -1;
+    return mRectification.isValid() ? 100. * z / mRectification.getFocalLength() : -1;
 #endif
 }
 
@@ -1071,6 +1157,8 @@ void pet::StereoContext::calcMinMax()
 
 void pet::StereoContext::indicateNewValues()
 {
+    // computed with the old values
+    waitForDisparity();
     setStatus(rectified);
     getDisparity();
     calcMinMax();
@@ -1086,9 +1174,7 @@ bool pet::StereoContext::getXYZ(int col, int row, float *x, float *y, float *z)
 
         if(dispValueValid(disp))
         {
-#ifdef STEREO
-            triclopsRCD16ToXYZ(mTriclopsContext, row, col, disp, x, y, z);
-#endif
+            toXYZ(row, col, disp, x, y, z);
             *x *= 100.;
             *y *= 100.;
             *z *= 100.;
@@ -1105,17 +1191,27 @@ bool pet::StereoContext::getXYZ(int col, int row, float *x, float *y, float *z)
 
 // liefert zu einer Disparit�t die Entfernung in cm
 // die Entfernung ist fuer jedes Pixel gleich (hier 0,0 genommen)
-float pet::StereoContext::getZfromDisp([[maybe_unused]] unsigned short int disp)
+float pet::StereoContext::getZfromDisp(unsigned short int disp)
 {
-#ifdef STEREO
     float x;
     float y;
     float z;
 
-    triclopsRCD16ToXYZ(mTriclopsContext, 0, 0, disp, &x, &y, &z);
+    toXYZ(0, 0, disp, &x, &y, &z);
     return z * 100.; // in cm
+}
+
+/**
+ * @brief Converts a pixel of the rectified right image and its 16 bit disparity to a 3D point in m
+ *
+ * Uses Triclops or, without STEREO, the rectification of OpenCV.
+ */
+void pet::StereoContext::toXYZ(int row, int col, unsigned short disp, float *x, float *y, float *z) const
+{
+#ifdef STEREO
+    triclopsRCD16ToXYZ(mTriclopsContext, row, col, disp, x, y, z);
 #else
-    return -1;
+    mRectification.toXYZ(row, col, disp, x, y, z);
 #endif
 }
 
@@ -1123,56 +1219,134 @@ float pet::StereoContext::getZfromDisp([[maybe_unused]] unsigned short int disp)
 // x, y, z in cm (median der aus disp-werten berechneten cm in 5x5 pixelumfeld)
 // return false, if no disparity information is found around col/row (x,y,z not set)
 // Achtung: COL ROW getauscht zu triclopsRCD16ToXYZ
-bool pet::StereoContext::getMedianXYZaround(int col, int row, float *x, float *y, float *z)
+/**
+ * @brief Median of the valid disparities in the 5x5 region around (col, row)
+ *
+ * Reentrant, so it can be used for several points in parallel.
+ *
+ * @param[in,out] col column of the point; moved inside the image, so that the region fits
+ * @param[in,out] row row of the point; moved inside the image, so that the region fits
+ * @param[out] disp median of the valid disparities
+ * @return false, if there is no valid disparity in the region
+ */
+bool pet::StereoContext::getMedianDispAround(int &col, int &row, unsigned short &disp) const
 {
-    if(mStatus & genDisparity)
+    constexpr int                           size = 5; // region scanned for median
+    std::array<unsigned short, size * size> values;
+
+    // umstellung von row und col von mitte des 5x5x auf ecke oben links und ueberpruefung auf rand
+    const int top  = ((row < 2) ? 0 : ((row > mDisparity.rows - 3) ? mDisparity.rows - 5 : row - 2));
+    const int left = ((col < 2) ? 0 : ((col > mDisparity.cols - 3) ? mDisparity.cols - 5 : col - 2));
+
+    int nr = 0; // nr zeigt anzahl der gefundenen disp an
+    for(int j = 0; j < size; ++j)
+    {
+        const unsigned short *data = mDisparity.ptr<unsigned short>(top + j) + left;
+        for(int i = 0; i < size; ++i)
+        {
+            if(dispValueValid(data[i]))
+            {
+                values[nr++] = data[i];
+            }
+        }
+    }
+    if(nr == 0)
     {
-        static int                     size = 5; // region scanned for median
-        static QVector<unsigned short> values(size * size);
+        return false;
+    }
 
-        values.fill(65280); // 65280 == 0xff00 ab wo angezeigt wird, dass es fehler sind
+    // only the median has to be at its sorted position
+    std::nth_element(values.begin(), values.begin() + nr / 2, values.begin() + nr);
+    disp = values[nr / 2];
+    row  = top + 2;
+    col  = left + 2;
+    return true;
+}
 
-        // umstellung von row und col von mitte des 5x5x auf ecke oben links und ueberpruefung auf rand
-        row = ((row < 2) ? 0 : ((row > mDisparity.rows - 3) ? mDisparity.rows - 5 : row - 2));
-        col = ((col < 2) ? 0 : ((col > mDisparity.cols - 3) ? mDisparity.cols - 5 : col - 2));
+bool pet::StereoContext::getMedianXYZaround(int col, int row, float *x, float *y, float *z)
+{
+    unsigned short disp;
+    if(!(mStatus & genDisparity) || !getMedianDispAround(col, row, disp))
+    {
+        return false;
+    }
 
-        unsigned short *data =
-            (unsigned short
-                 *) (((unsigned short *) mDisparity.data) + mDisparity.step1() * row + col); // mDisparity.imageData;
-        unsigned short *yData = data;
-        int             i, j, nr = 0; // nr zeigt anzahl der gefundenen disp an
+    toXYZ(row, col, disp, x, y, z);
+    *x *= 100.;
+    *y *= 100.;
+    *z *= 100.;
+    return true;
+}
 
-        for(j = 0; j < size; ++j)
+/**
+ * @brief getMedianXYZaround() for several points at once
+ *
+ * The medians of the points are searched in parallel.
+ *
+ * @param points image points (col, row)
+ * @return the 3D point in cm for each of points; empty, if there is no valid disparity around it
+ */
+std::vector<std::optional<cv::Point3f>> pet::StereoContext::getMedianXYZaround(const std::vector<cv::Point> &points)
+{
+    std::vector<std::optional<cv::Point3f>> xyz(points.size());
+    if(!(mStatus & genDisparity))
+    {
+        return xyz;
+    }
+
+    struct MedianDisp
+    {
+        int            col   = 0;
+        int            row   = 0;
+        unsigned short disp  = 0;
+        bool           valid = false;
+    };
+    std::vector<MedianDisp> medians(points.size());
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(points.size())),
+        [&](const cv::Range &range)
         {
-            for(i = 0; i < size; ++i)
+            for(int i = range.start; i < range.end; ++i)
             {
-                if(dispValueValid(*data))
-                {
-                    values[nr++] = *data;
-                }
-                ++data;
+                MedianDisp &median = medians[i];
+                median.col         = points[i].x;
+                median.row         = points[i].y;
+                median.valid       = getMedianDispAround(median.col, median.row, median.disp);
             }
-            data = (yData += mDisparity.step1());
-        }
+        });
 
-        if(nr != 0)
+    for(std::size_t i = 0; i < points.size(); ++i)
+    {
+        if(!medians[i].valid)
         {
-            std::sort(values.begin(), values.begin() + nr); // sort first nr elements in values
+            continue;
+        }
+        float x = 0, y = 0, z = 0;
+        toXYZ(medians[i].row, medians[i].col, medians[i].disp, &x, &y, &z);
+        xyz[i] = cv::Point3f(x * 100.f, y * 100.f, z * 100.f);
+    }
+    return xyz;
+}
 
-            // debout << row+2 << " " << col+2 << " " << nr << " "<< values[nr/2] << endl;
-#ifdef STEREO
-            triclopsRCD16ToXYZ(mTriclopsContext, row + 2, col + 2, values[nr / 2], x, y, z);
-#endif
-            *x *= 100.;
-            *y *= 100.;
-            *z *= 100.;
-            return true;
+/**
+ * @brief Returns a table of z (in meters) for every 16 bit disparity value
+ *
+ * For rectified images z only depends on the disparity, so looking z up is much
+ * cheaper than converting the point cloud, if only z is needed. Invalid disparities
+ * map to -1 like in getPointCloud().
+ */
+const std::vector<float> &pet::StereoContext::getZTable()
+{
+    if(mZTable.empty())
+    {
+        mZTable.assign(USHRT_MAX + 1, -1.f);
+        for(int disp = 0; disp <= USHRT_MAX; ++disp)
+        {
+            const float z = dispValueValid(static_cast<unsigned short>(disp)) ? getZfromDisp(disp) : -1.f;
+            mZTable[disp] = z < 0 ? -1.f : z / 100.f; // getZfromDisp is in cm
         }
-        else
-            return false;
     }
-    else
-        return false;
+    return mZTable;
 }
 
 bool pet::StereoContext::dispValueValid(unsigned short int disp)
@@ -1184,48 +1358,81 @@ bool pet::StereoContext::dispValueValid(unsigned short int disp)
         return false;
 }
 
+/**
+ * @brief Returns the complete point cloud of the current disparity
+ *
+ * See getPointCloud(cv::Rect); callers only reading a part of the cloud should use it.
+ */
 cv::Mat pet::StereoContext::getPointCloud()
+{
+    return getPointCloud(cv::Rect(0, 0, INT_MAX, INT_MAX));
+}
+
+/**
+ * @brief Returns the point cloud of the current disparity inside of region
+ *
+ * The cloud is computed lazily in tiles of pointCloudTileSize x pointCloudTileSize pixels:
+ * only tiles overlapping region, which were not converted since the last disparity was
+ * computed, are converted. The returned matrix is a view into the cloud of the whole
+ * frame, it has to be cloned before it is changed.
+ *
+ * @param region region of the disparity (including the border); clipped to the disparity
+ * @return CV_32FC3 cloud in meters; (-1, -1, -1) for invalid disparities
+ */
+cv::Mat pet::StereoContext::getPointCloud(cv::Rect region)
 {
     if(!(mStatus & genDisparity)) // falls disparity noch nicht berechnet wurde
         getDisparity();
 
     if(mStatus & genDisparity)
     {
-#ifdef STEREO
-
-        if(mPointCloud.empty()) // Speicherplatz anlegen
+        if(mPointCloud.size() != mDisparity.size()) // Speicherplatz anlegen
         {
             mPointCloud = cv::Mat(mDisparity.rows, mDisparity.cols, CV_32FC3);
-            // NOTE Speicherueberpruefung ggf. auch hier durchfuehren (Exception fangen)
+            mPointCloudTiles.clear();
         }
+        const int tilesX = (mPointCloud.cols + pointCloudTileSize - 1) / pointCloudTileSize;
+        const int tilesY = (mPointCloud.rows + pointCloudTileSize - 1) / pointCloudTileSize;
+        mPointCloudTiles.resize(static_cast<std::size_t>(tilesX) * tilesY, false);
 
-        unsigned short *data   = (unsigned short *) mDisparity.data;
-        float          *pcData = (float *) mPointCloud.data;
-        // float* pcyData = pcData;
-        // float x, y, z;
-        int i, j;
+        region &= cv::Rect(0, 0, mPointCloud.cols, mPointCloud.rows);
+        if(region.empty())
+        {
+            return cv::Mat();
+        }
 
-        for(i = 0; i < mDisparity.rows; ++i)
+        for(int tileY = region.y / pointCloudTileSize; tileY <= (region.br().y - 1) / pointCloudTileSize; ++tileY)
         {
-            data   = mDisparity.ptr<ushort>(i);
-            pcData = mPointCloud.ptr<float>(i);
-            for(j = 0; j < mDisparity.cols; ++j)
+            for(int tileX = region.x / pointCloudTileSize; tileX <= (region.br().x - 1) / pointCloudTileSize; ++tileX)
             {
-                if(dispValueValid(*data))
+                const std::size_t tile = static_cast<std::size_t>(tileY) * tilesX + tileX;
+                if(mPointCloudTiles[tile])
                 {
-                    // convert the 16 bit disparity value to floating point x,y,z
-                    triclopsRCD16ToXYZ(mTriclopsContext, i, j, *data, pcData, pcData + 1, pcData + 2);
+                    continue;
                 }
-                else
+                const int rowEnd = std::min((tileY + 1) * pointCloudTileSize, mPointCloud.rows);
+                const int colEnd = std::min((tileX + 1) * pointCloudTileSize, mPointCloud.cols);
+                for(int row = tileY * pointCloudTileSize; row < rowEnd; ++row)
                 {
-                    mPointCloud.at<cv::Vec3f>(i, j) = {-1, -1, -1};
+                    const auto *disp   = mDisparity.ptr<ushort>(row);
+                    auto       *pcData = mPointCloud.ptr<cv::Vec3f>(row);
+                    for(int col = tileX * pointCloudTileSize; col < colEnd; ++col)
+                    {
+                        if(dispValueValid(disp[col]))
+                        {
+                            // convert the 16 bit disparity value to floating point x,y,z
+                            cv::Vec3f &point = pcData[col];
+                            toXYZ(row, col, disp[col], &point[0], &point[1], &point[2]);
+                        }
+                        else
+                        {
+                            pcData[col] = {-1, -1, -1};
+                        }
+                    }
                 }
-                ++data;
-                pcData += 3;
+                mPointCloudTiles[tile] = true;
             }
         }
-        //        debout << mDisparity.width << " " << mDisparity.widthStep << endl;
-        //        debout << mPointCloud->width << " " << mPointCloud->step << endl;
 
 
 #ifdef TMP_STEREO_SEQ_DISP
@@ -1276,9 +1483,7 @@ cv::Mat pet::StereoContext::getPointCloud()
             pcData = (pcyData += mPointCloud->step / sizeof(float));
         }
 #endif // TMP_STEREO_SEQ_DISP
-#endif // STEREO
-
-        return mPointCloud;
+        return mPointCloud(region);
     }
     else
         return cv::Mat(); // NOTE Error Handling
@@ -1291,6 +1496,61 @@ cv::Mat pet::StereoContext::getPointCloud()
     //    }
 }
 
+/**
+ * @brief Returns the valid points of the current point cloud inside of roi
+ *
+ * Like exportPointCloud(), only foreground points are returned, if the background
+ * subtraction is enabled. The coordinates are in meters in the coordinate system of the
+ * stereo camera, the gray value is taken from the rectified right image.
+ *
+ * @param roi region of the disparity (including the border) the points are taken from
+ * @param decimation only every decimation-th row and column is used
+ * @return valid points in row major order
+ */
+std::vector<PointCloudWriter::Point>
+pet::StereoContext::getCloudPoints(cv::Rect roi, int decimation)
+{
+    std::vector<PointCloudWriter::Point> points;
+    if(!(mStatus & genDisparity))
+    {
+        getDisparity();
+    }
+    if(!(mStatus & genDisparity))
+    {
+        return points;
+    }
+
+    roi &= cv::Rect(0, 0, mDisparity.cols, mDisparity.rows);
+    decimation = std::max(1, decimation);
+
+    cv::Mat gray = getRectified(cameraRight);
+    if(gray.channels() > 1)
+    {
+        cv::cvtColor(gray, gray, cv::COLOR_BGR2GRAY);
+    }
+    BackgroundFilter *bgFilter = mMain->getBackgroundFilter();
+    const bool        fgOnly   = bgFilter->getEnabled();
+
+    points.reserve(static_cast<std::size_t>(roi.area() / (decimation * decimation)));
+    for(int row = roi.y; row < roi.br().y; row += decimation)
+    {
+        const auto *disp = mDisparity.ptr<ushort>(row);
+        for(int col = roi.x; col < roi.br().x; col += decimation)
+        {
+            if(!dispValueValid(disp[col]) || (fgOnly && !bgFilter->isForeground(col, row)))
+            {
+                continue;
+            }
+            PointCloudWriter::Point point;
+            // convert the 16 bit disparity value to floating point x,y,z
+            toXYZ(row, col, disp[col], &point.x, &point.y, &point.z);
+            point.gray = gray.at<uchar>(row, col);
+            points.push_back(point);
+        }
+    }
+    return points;
+}
+
 //// erzeugt ein aequidistantes xy-gitter
 //// von min bis max (dadurch koennten ausreisser das netz unnoetig auseinanderziehen und viele pkte fallen zusammen)
 // CvMat* StereoContext::getRectifiedPointCloud(float *xMin, float *xMax, float *yMin, float *yMax, float *zMin, float
@@ -1342,12 +1602,15 @@ cv::Mat pet::StereoContext::getPointCloud()
 
 
 // return shows, if export was sucessfull
-bool pet::StereoContext::exportPointCloud([[maybe_unused]] QString dest) // default = ""
+bool pet::StereoContext::exportPointCloud(QString dest) // default = ""
 {
 #ifndef STEREO
-    PCritical(nullptr, "No stereo support", "This version of PeTrack was compiled without stereo support.");
-    return false;
-#else
+    if(!mRectification.isValid())
+    {
+        PCritical(nullptr, "No stereo calibration", "The stereo images cannot be rectified without a calibration.");
+        return false;
+    }
+#endif
     static QString lastFile = "";
 
     if(mStatus & genDisparity)
@@ -1363,12 +1626,18 @@ bool pet::StereoContext::exportPointCloud([[maybe_unused]] QString dest) // defa
                 mMain,
                 QObject::tr("Select file for exporting point cloud"),
                 lastFile,
-                QObject::tr("Triclops points (*.pts);;All supported types (*.pts *.xxx);;All files (*.*)"));
+                QObject::tr("Triclops points (*.pts);;Binary PLY of the whole sequence (*.ply);;All supported types "
+                            "(*.pts *.ply);;All files (*.*)"));
         }
 
         if(!dest.isEmpty())
         {
-            if(dest.right(4) == ".pts")
+            if(dest.right(4).toLower() == ".ply")
+            {
+                lastFile = dest;
+                return mMain->exportPointCloudSequence(dest);
+            }
+            else if(dest.right(4) == ".pts")
             {
                 QFile file(dest);
 
@@ -1401,7 +1670,7 @@ bool pet::StereoContext::exportPointCloud([[maybe_unused]] QString dest) // defa
                                                      !mMain->getBackgroundFilter()->getEnabled()))
                         {
                             // convert the 16 bit disparity value to floating point x,y,z
-                            triclopsRCD16ToXYZ(mTriclopsContext, i, j, *data, &x, &y, &z);
+                            toXYZ(i, j, *data, &x, &y, &z);
                             // look at points within a range
                             // if ( z < 5.0 )
                             c = iD[k];
@@ -1464,5 +1733,4 @@ bool pet::StereoContext::exportPointCloud([[maybe_unused]] QString dest) // defa
             QObject::tr("Cannot export point cloud, because disparity has not been generated."));
         return false;
     }
-#endif // STEREO defined
 }
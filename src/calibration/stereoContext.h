@@ -19,7 +19,11 @@
 #ifndef STEREOCONTEXT_H
 #define STEREOCONTEXT_H
 
+#include <QFuture>
 #include <QString>
+#include <opencv2/opencv_modules.hpp>
+#include <optional>
+#include <vector>
 
 #ifdef STEREO
 #include <triclops.h>
@@ -34,6 +38,12 @@
 #endif
 #include "opencv2/calib3d.hpp"
 #include "opencv2/calib3d/calib3d_c.h"
+#include "pointCloudWriter.h"
+#include "stereoRectification.h"
+
+#ifdef HAVE_OPENCV_CUDASTEREO
+#include <opencv2/cudastereo.hpp>
+#endif
 
 class Petrack;
 class Animation;
@@ -51,6 +61,26 @@ enum stereoStatus
     genDisparity = 8
 };
 
+// index in StereoWidget::stereoDispAlgo
+enum disparityAlgorithm
+{
+    dispPtGrey         = 0,
+    dispBlockMatching  = 1,
+    dispSemiGlobal     = 2,
+    dispSemiGlobal3Way = 3,
+    dispCudaSemiGlobal = 4 ///< falls back to dispSemiGlobal3Way without CUDA stereo
+};
+
+/// Parameters of the disparity computation, read from the StereoWidget on the GUI thread
+struct DisparitySettings
+{
+    int       algorithm    = dispPtGrey;
+    int       minDisparity = 0;
+    int       maxDisparity = 0;
+    int       maskSize     = 7;
+    cv::Range rows         = cv::Range::all(); ///< rows of the rectified images the disparity is computed for
+};
+
 class StereoContext
 {
 public:
@@ -66,6 +96,7 @@ public:
     void    preprocess();
     cv::Mat getRectified(enum Camera camera = cameraRight);
     cv::Mat getDisparity(bool *dispNew = nullptr);
+    void    startDisparity();
 
     // von person.cpp benoetigt, um frame nummer zu erhalten
     inline Animation *getAnimation() { return mAnimation; }
@@ -83,9 +114,13 @@ public:
 
     bool getMedianXYZaround(int col, int row, float *x, float *y, float *z);
 
+    std::vector<std::optional<cv::Point3f>> getMedianXYZaround(const std::vector<cv::Point> &points);
+
     float getZfromDisp(unsigned short int disp);
 
-    bool dispValueValid(unsigned short int disp);
+    const std::vector<float> &getZTable();
+
+    static bool dispValueValid(unsigned short int disp);
 
     // ---------------------------------------------------
 #ifdef STEREO
@@ -126,10 +161,22 @@ public:
     }
 
     cv::Mat getPointCloud();
+    cv::Mat getPointCloud(cv::Rect region);
+
+    std::vector<PointCloudWriter::Point> getCloudPoints(cv::Rect roi, int decimation = 1);
 
     bool exportPointCloud(QString dest = "");
 
 protected:
+    static constexpr int semiGlobalBlockSize = 11;
+    static constexpr int pointCloudTileSize  = 64;
+
+    bool              getMedianDispAround(int &col, int &row, unsigned short &disp) const;
+    void              toXYZ(int row, int col, unsigned short disp, float *x, float *y, float *z) const;
+    DisparitySettings getDisparitySettings() const;
+    cv::Mat           computeDisparity(const cv::Mat &left, const cv::Mat &right, const DisparitySettings &settings);
+    void              waitForDisparity();
+
     Animation *mAnimation;
     Petrack   *mMain;
 #ifdef STEREO
@@ -138,6 +185,8 @@ protected:
     TriclopsImage   mTriRectLeft;
     TriclopsImage   mTriRectRight;
     TriclopsImage16 mTriDisparity;
+#else
+    StereoRectification mRectification; ///< replaces the rectification of Triclops
 #endif
     BackgroundFilter     *mBackgroundFilterLeft;
     BackgroundFilter     *mBackgroundFilterRight;
@@ -148,8 +197,15 @@ protected:
 
 
     cv::Ptr<cv::StereoSGBM> mSgbm;
+#ifdef HAVE_OPENCV_CUDASTEREO
+    cv::Ptr<cv::cuda::StereoSGM> mCudaSgm;
+#endif
+    QFuture<cv::Mat>        mPendingDisparity; ///< see startDisparity()
+    bool                    mDisparityPending = false;
     cv::Mat                 mBMdisparity16;
     cv::Mat                 mPointCloud;
+    std::vector<bool>       mPointCloudTiles; ///< tiles of mPointCloud converted from the current disparity
+    std::vector<float>      mZTable;          ///< see getZTable()
     unsigned char           mSurfaceValue;
     unsigned char           mBackForthValue;
     unsigned short int      mMin;
@@ -0,0 +1,208 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "stereoRectification.h"
+
+#include "logger.h"
+
+#include <QFile>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace
+{
+cv::Mat toGray(const cv::Mat &img)
+{
+    if(img.channels() == 1)
+    {
+        return img;
+    }
+    cv::Mat gray;
+    cv::cvtColor(img, gray, img.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    return gray;
+}
+} // namespace
+
+/**
+ * @brief Reads the calibration of the stereo pair from an OpenCV YAML or XML file
+ *
+ * The file has to contain image_size, the camera matrices M1 and M2, the distortion
+ * coefficients D1 and D2 of the left and right camera and the rotation R and the
+ * translation T (in m) from the left to the right camera, e.g. as written by the stereo
+ * calibration sample of OpenCV.
+ *
+ * @return false, if the file could not be read or is incomplete
+ */
+bool StereoRectification::load(const QString &fileName)
+{
+    reset();
+    if(!QFile::exists(fileName))
+    {
+        return false;
+    }
+
+    cv::Size imageSize;
+    cv::Mat  cameraMatrixLeft, distCoeffsLeft, cameraMatrixRight, distCoeffsRight, rotation, translation;
+    try
+    {
+        cv::FileStorage file(fileName.toStdString(), cv::FileStorage::READ);
+        file["image_size"] >> imageSize;
+        file["M1"] >> cameraMatrixLeft;
+        file["D1"] >> distCoeffsLeft;
+        file["M2"] >> cameraMatrixRight;
+        file["D2"] >> distCoeffsRight;
+        file["R"] >> rotation;
+        file["T"] >> translation;
+    }
+    catch(const cv::Exception &e)
+    {
+        SPDLOG_WARN("Could not read the stereo calibration {}: {}", fileName, e.what());
+        return false;
+    }
+    if(imageSize.empty() || cameraMatrixLeft.empty() || cameraMatrixRight.empty() || rotation.empty() ||
+       translation.empty())
+    {
+        SPDLOG_WARN("The stereo calibration {} has to contain image_size, M1, D1, M2, D2, R and T.", fileName);
+        return false;
+    }
+
+    setCalibration(
+        imageSize, cameraMatrixLeft, distCoeffsLeft, cameraMatrixRight, distCoeffsRight, rotation, translation);
+    return true;
+}
+
+/**
+ * @brief Computes the rectification maps of both cameras
+ *
+ * The rectified images only contain valid pixels and have the same principal point, so
+ * the disparity of a point at infinity is 0.
+ *
+ * @param rotation rotation from the left to the right camera
+ * @param translation translation from the left to the right camera in m
+ */
+void StereoRectification::setCalibration(
+    const cv::Size &imageSize,
+    const cv::Mat  &cameraMatrixLeft,
+    const cv::Mat  &distCoeffsLeft,
+    const cv::Mat  &cameraMatrixRight,
+    const cv::Mat  &distCoeffsRight,
+    const cv::Mat  &rotation,
+    const cv::Mat  &translation)
+{
+    cv::Mat rectLeft, rectRight, projLeft, projRight, q;
+    cv::stereoRectify(
+        cameraMatrixLeft,
+        distCoeffsLeft,
+        cameraMatrixRight,
+        distCoeffsRight,
+        imageSize,
+        rotation,
+        translation,
+        rectLeft,
+        rectRight,
+        projLeft,
+        projRight,
+        q,
+        cv::CALIB_ZERO_DISPARITY,
+        0);
+    cv::initUndistortRectifyMap(
+        cameraMatrixLeft, distCoeffsLeft, rectLeft, projLeft, imageSize, CV_16SC2, mMapLeft, mMapLeftInterpolation);
+    cv::initUndistortRectifyMap(
+        cameraMatrixRight,
+        distCoeffsRight,
+        rectRight,
+        projRight,
+        imageSize,
+        CV_16SC2,
+        mMapRight,
+        mMapRightInterpolation);
+
+    mImageSize    = imageSize;
+    mFocalLength  = projRight.at<double>(0, 0);
+    mPrincipalCol = projRight.at<double>(0, 2);
+    mPrincipalRow = projRight.at<double>(1, 2);
+    // after the rectification the cameras are only shifted along the rows
+    mBaseline = cv::norm(translation);
+}
+
+void StereoRectification::reset()
+{
+    mImageSize = cv::Size();
+    mMapLeft.release();
+    mMapLeftInterpolation.release();
+    mMapRight.release();
+    mMapRightInterpolation.release();
+    mFocalLength  = 0;
+    mBaseline     = 0;
+    mPrincipalCol = 0;
+    mPrincipalRow = 0;
+}
+
+/**
+ * @brief Rectifies both images of a pair
+ *
+ * Color images are converted to gray first, as the matchers only use gray images.
+ * cv::remap already distributes the rows over all cores, so the two images are
+ * rectified one after the other; nesting them in another parallel loop would make
+ * each remap run single threaded.
+ *
+ * @param left image of the left camera of the size of the calibration
+ * @param right image of the right camera of the size of the calibration
+ * @param rectLeft rectified gray left image; its buffer is reused, if the size fits
+ * @param rectRight rectified gray right image; its buffer is reused, if the size fits
+ */
+void StereoRectification::rectify(
+    const cv::Mat &left,
+    const cv::Mat &right,
+    cv::Mat       &rectLeft,
+    cv::Mat       &rectRight) const
+{
+    cv::remap(toGray(left), rectLeft, mMapLeft, mMapLeftInterpolation, cv::INTER_LINEAR);
+    cv::remap(toGray(right), rectRight, mMapRight, mMapRightInterpolation, cv::INTER_LINEAR);
+}
+
+/**
+ * @brief Returns the distance of a point with disparity disp from the cameras in m
+ *
+ * For rectified images the distance is the same for all pixels with the same disparity.
+ *
+ * @return -1 for disparities of points at infinity
+ */
+float StereoRectification::getZ(unsigned short disp) const
+{
+    const double pixel = disp / 256.; // 8 fractional bits
+    return pixel > 0 ? static_cast<float>(mFocalLength * mBaseline / pixel) : -1.f;
+}
+
+/**
+ * @brief Converts a pixel of the rectified right image and its disparity to a 3D point in m
+ *
+ * Same as triclopsRCD16ToXYZ(); x, y and z are -1 for points at infinity.
+ */
+void StereoRectification::toXYZ(int row, int col, unsigned short disp, float *x, float *y, float *z) const
+{
+    *z = getZ(disp);
+    if(*z < 0)
+    {
+        *x = -1.f;
+        *y = -1.f;
+        return;
+    }
+    *x = static_cast<float>((col - mPrincipalCol) * *z / mFocalLength);
+    *y = static_cast<float>((row - mPrincipalRow) * *z / mFocalLength);
+}
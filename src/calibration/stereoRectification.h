@@ -0,0 +1,73 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef STEREORECTIFICATION_H
+#define STEREORECTIFICATION_H
+
+#include <QString>
+#include <opencv2/core.hpp>
+
+/**
+ * @brief Rectification of a stereo pair with OpenCV, used instead of Triclops without STEREO
+ *
+ * The rectification maps of both cameras are computed once from the calibration of the
+ * pair and kept in the fixed-point format of cv::remap, so rectifying a frame is just
+ * one table lookup per pixel and camera.
+ *
+ * The disparities are expected in the convention of ptGrey used in the StereoContext:
+ * 16 bit with 8 fractional bits, referring to the rectified right image. The 3D points
+ * are in meters in the coordinate system of the rectified right camera, like the ones
+ * of Triclops.
+ */
+class StereoRectification
+{
+public:
+    bool load(const QString &fileName);
+    void setCalibration(
+        const cv::Size &imageSize,
+        const cv::Mat  &cameraMatrixLeft,
+        const cv::Mat  &distCoeffsLeft,
+        const cv::Mat  &cameraMatrixRight,
+        const cv::Mat  &distCoeffsRight,
+        const cv::Mat  &rotation,
+        const cv::Mat  &translation);
+    void reset();
+
+    bool            isValid() const { return !mMapLeft.empty(); }
+    const cv::Size &getImageSize() const { return mImageSize; }
+    double          getFocalLength() const { return mFocalLength; }
+    double          getBaseline() const { return mBaseline; }
+
+    void rectify(const cv::Mat &left, const cv::Mat &right, cv::Mat &rectLeft, cv::Mat &rectRight) const;
+
+    float getZ(unsigned short disp) const;
+    void  toXYZ(int row, int col, unsigned short disp, float *x, float *y, float *z) const;
+
+private:
+    cv::Size mImageSize;
+    cv::Mat  mMapLeft; ///< fixed-point pixel positions (CV_16SC2)
+    cv::Mat  mMapLeftInterpolation;
+    cv::Mat  mMapRight;
+    cv::Mat  mMapRightInterpolation;
+    double   mFocalLength  = 0; ///< of the rectified cameras in pixel
+    double   mBaseline     = 0; ///< in m
+    double   mPrincipalCol = 0; ///< of the rectified right camera
+    double   mPrincipalRow = 0;
+};
+
+#endif // STEREORECTIFICATION_H
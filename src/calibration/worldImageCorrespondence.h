@@ -19,6 +19,7 @@
 #ifndef WORLDIMAGECORRESPONDENCE_H
 
 #include <QPoint>
+#include <memory>
 
 class WorldImageCorrespondence
 {
@@ -71,6 +72,16 @@ public:
      */
     virtual QPointF getPosReal(QPointF pos, double height = 0.) const = 0;
 
+    /**
+     * @brief Copies all parameters of the correspondence
+     *
+     * Has to be called on the GUI thread. The copy does not access the widgets,
+     * so it can be used by worker threads.
+     *
+     * @return correspondence for the current calibration and coordinate system
+     */
+    virtual std::unique_ptr<WorldImageCorrespondence> snapshot() const = 0;
+
     virtual ~WorldImageCorrespondence() = default;
 };
 
@@ -0,0 +1,117 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "worldImageSnapshot.h"
+
+#include <cmath>
+
+// same conversions as in CoordinateSystemBox, but with the parameters of the snapshot
+
+double WorldImageSnapshot::getCmPerPixel() const
+{
+    const QPointF p1 = mParams.imgToWorld * QPointF(0, 0);
+    const QPointF p2 = mParams.imgToWorld * QPointF(1, 0);
+    return mParams.coordUnit * std::hypot(p1.x() - p2.x(), p1.y() - p2.y()) / 100.;
+}
+
+QPointF WorldImageSnapshot::getCmPerPixel(float px, float py, float h) const
+{
+    const auto &camera = mParams.camera;
+
+    const cv::Point3f p3x1 = ExtrCalibration::get3DPoint(camera, cv::Point2f(px - 0.5, py), h);
+    const cv::Point3f p3x2 = ExtrCalibration::get3DPoint(camera, cv::Point2f(px + 0.5, py), h);
+    const cv::Point3f p3y1 = ExtrCalibration::get3DPoint(camera, cv::Point2f(px, py - 0.5), h);
+    const cv::Point3f p3y2 = ExtrCalibration::get3DPoint(camera, cv::Point2f(px, py + 0.5), h);
+
+    return QPointF(cv::norm(p3x1 - p3x2), cv::norm(p3y1 - p3y2));
+}
+
+double WorldImageSnapshot::getAngleToGround(float px, float py, float h) const
+{
+    const int         bS         = mParams.borderSize;
+    const cv::Point3f posInImage = ExtrCalibration::get3DPoint(mParams.camera, cv::Point2f(px - bS, py - bS), h);
+    const cv::Point3f a          = mParams.cameraPosition - posInImage;
+
+    // angle between a and the z axis
+    const double pi = std::atan(1.0) * 4;
+    return std::asin(a.z / std::sqrt(a.x * a.x + a.y * a.y + a.z * a.z)) * 180 / pi;
+}
+
+QPointF WorldImageSnapshot::getPosImage(QPointF pos, float height) const
+{
+    if(mParams.imageRect == QRectF{0, 0, 0, 0})
+    {
+        return pos;
+    }
+    if(mParams.use3D)
+    {
+        const cv::Point2f p2d = ExtrCalibration::getImagePoint(mParams.camera, cv::Point3f(pos.x(), pos.y(), height));
+        return QPointF(p2d.x, p2d.y);
+    }
+
+    pos.setY(-pos.y());
+    pos /= mParams.coordUnit / 100.;
+    pos = mParams.imgToWorld.inverted() * pos;
+
+    const QPointF center = getCenter();
+    pos -= center;
+    pos = (mParams.altitude / (mParams.altitude - height)) * pos;
+    return pos + center;
+}
+
+QPointF WorldImageSnapshot::getPosReal(QPointF pos, double height) const
+{
+    if(mParams.imageRect == QRectF{0, 0, 0, 0})
+    {
+        return pos;
+    }
+    if(mParams.use3D)
+    {
+        const int         bS  = mParams.borderSize;
+        const cv::Point3f p3d =
+            ExtrCalibration::get3DPoint(mParams.camera, cv::Point2f(pos.x() - bS, pos.y() - bS), height);
+        return QPointF(p3d.x, p3d.y);
+    }
+
+    const QPointF center = getCenter();
+    pos -= center;
+    pos = ((mParams.altitude - height) / mParams.altitude) * pos;
+    pos += center;
+
+    pos = mParams.imgToWorld * pos;
+    pos *= mParams.coordUnit / 100.; // durch 100., da coordsys so gezeichnet, dass 1 bei 100 liegt
+    pos.setY(-pos.y());
+    return pos;
+}
+
+std::unique_ptr<WorldImageCorrespondence> WorldImageSnapshot::snapshot() const
+{
+    return std::make_unique<WorldImageSnapshot>(mParams);
+}
+
+/**
+ * @brief Center of the 2D mapping, the principal point or the center of the image
+ */
+QPointF WorldImageSnapshot::getCenter() const
+{
+    if(mParams.useIntrinsicCenter)
+    {
+        return mParams.principalPoint;
+    }
+    return QPointF(mParams.imageRect.width() / 2. - .5, mParams.imageRect.height() / 2. - .5);
+}
@@ -0,0 +1,70 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORLDIMAGESNAPSHOT_H
+#define WORLDIMAGESNAPSHOT_H
+
+#include "extrCalibration.h"
+#include "worldImageCorrespondence.h"
+
+#include <QRectF>
+#include <QTransform>
+#include <memory>
+
+/**
+ * @brief Copy of the correspondence between image and world coordinates at one point in time
+ *
+ * All parameters of the coordinate system and the calibration are taken on the
+ * GUI thread (see WorldImageCorrespondence::snapshot()), so the conversions do
+ * not access any widget and can be used by worker threads. Later changes of the
+ * calibration are not applied to the snapshot.
+ */
+class WorldImageSnapshot : public WorldImageCorrespondence
+{
+public:
+    struct Parameters
+    {
+        QRectF                       imageRect;      ///< bounding rect of the image item, empty without an image
+        QTransform                   imgToWorld;     ///< border and coordinate system of the 2D mapping
+        QPointF                      principalPoint; ///< of the intrinsic calibration
+        ExtrCalibration::CameraModel camera;         ///< for the 3D mapping
+        cv::Point3f                  cameraPosition; ///< in world coordinates, for getAngleToGround()
+        int                          borderSize         = 0;
+        bool                         use3D              = false; ///< 3D mapping with the extrinsic calibration
+        bool                         useIntrinsicCenter = false; ///< center of the 2D mapping is the principal point
+        double                       altitude           = 0;     ///< camera altitude of the 2D mapping in cm
+        double                       coordUnit          = 0;     ///< unit of the 2D coordinate system
+    };
+
+    explicit WorldImageSnapshot(Parameters params) : mParams(std::move(params)) {}
+
+    double  getCmPerPixel() const override;
+    QPointF getCmPerPixel(float px, float py, float h = 0.) const override;
+    double  getAngleToGround(float px, float py, float h = 0) const override;
+    QPointF getPosImage(QPointF pos, float height = 0.) const override;
+    QPointF getPosReal(QPointF pos, double height = 0.) const override;
+
+    std::unique_ptr<WorldImageCorrespondence> snapshot() const override;
+
+private:
+    QPointF getCenter() const;
+
+    Parameters mParams;
+};
+
+#endif // WORLDIMAGESNAPSHOT_H
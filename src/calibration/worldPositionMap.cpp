@@ -0,0 +1,128 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "worldPositionMap.h"
+
+#include <algorithm>
+
+/**
+ * @brief Samples the world positions on a grid covering area for all heights
+ *
+ * @param area image region the map is used for
+ * @param cellSize distance between two grid nodes in pixel
+ * @param heights reference heights in cm; at least two different heights are needed
+ * @param position computes the exact world position
+ */
+void WorldPositionMap::build(
+    const cv::Rect         &area,
+    int                     cellSize,
+    std::vector<double>     heights,
+    const PositionFunction &position)
+{
+    clear();
+    std::sort(heights.begin(), heights.end());
+    heights.erase(std::unique(heights.begin(), heights.end()), heights.end());
+    if(area.empty() || cellSize <= 0 || heights.size() < 2)
+    {
+        return;
+    }
+
+    mArea     = area;
+    mCellSize = cellSize;
+    mCols     = (area.width + cellSize - 1) / cellSize + 1;
+    mRows     = (area.height + cellSize - 1) / cellSize + 1;
+    mHeights  = std::move(heights);
+
+    mGrids.resize(mHeights.size());
+    for(size_t k = 0; k < mHeights.size(); ++k)
+    {
+        auto &grid = mGrids[k];
+        grid.reserve(static_cast<size_t>(mCols) * mRows);
+        for(int row = 0; row < mRows; ++row)
+        {
+            for(int col = 0; col < mCols; ++col)
+            {
+                const QPointF node(area.x + col * cellSize, area.y + row * cellSize);
+                const QPointF world = position(node, mHeights[k]);
+                grid.emplace_back(world.x(), world.y());
+            }
+        }
+    }
+}
+
+void WorldPositionMap::clear()
+{
+    mArea     = cv::Rect();
+    mCellSize = 0;
+    mCols     = 0;
+    mRows     = 0;
+    mHeights.clear();
+    mGrids.clear();
+}
+
+/**
+ * @brief Checks whether the map covers pos (border inclusive) at height
+ */
+bool WorldPositionMap::contains(const QPointF &pos, double height) const
+{
+    return !isEmpty() && pos.x() >= mArea.x && pos.y() >= mArea.y && pos.x() <= mArea.x + mArea.width &&
+           pos.y() <= mArea.y + mArea.height && height >= mHeights.front() && height <= mHeights.back();
+}
+
+/**
+ * @brief Interpolated world position of pos at height
+ *
+ * Only meaningful if contains(pos, height).
+ *
+ * @param pos image point
+ * @param height height in cm
+ * @return world position in cm
+ */
+QPointF WorldPositionMap::at(const QPointF &pos, double height) const
+{
+    // index of the first reference height above height, but at least 1 and at most the last one
+    const auto   upper = std::upper_bound(mHeights.begin(), mHeights.end(), height) - mHeights.begin();
+    const size_t k1    = std::clamp<size_t>(upper, 1, mHeights.size() - 1);
+    const size_t k0    = k1 - 1;
+    const double t     = (height - mHeights[k0]) / (mHeights[k1] - mHeights[k0]);
+
+    const QPointF p0 = atGrid(k0, pos);
+    const QPointF p1 = atGrid(k1, pos);
+    return p0 + t * (p1 - p0);
+}
+
+QPointF WorldPositionMap::atGrid(size_t grid, const QPointF &pos) const
+{
+    const double gx = std::clamp((pos.x() - mArea.x) / mCellSize, 0., static_cast<double>(mCols - 1));
+    const double gy = std::clamp((pos.y() - mArea.y) / mCellSize, 0., static_cast<double>(mRows - 1));
+    // a non-empty map has at least two nodes in each direction
+    const int    x0 = std::min(static_cast<int>(gx), mCols - 2);
+    const int    y0 = std::min(static_cast<int>(gy), mRows - 2);
+    const double fx = gx - x0;
+    const double fy = gy - y0;
+
+    const auto &nodes  = mGrids[grid];
+    const auto &p00    = nodes[y0 * mCols + x0];
+    const auto &p01    = nodes[y0 * mCols + x0 + 1];
+    const auto &p10    = nodes[(y0 + 1) * mCols + x0];
+    const auto &p11    = nodes[(y0 + 1) * mCols + x0 + 1];
+    const auto  top    = p00 + fx * (p01 - p00);
+    const auto  bottom = p10 + fx * (p11 - p10);
+    const auto  result = top + fy * (bottom - top);
+    return QPointF(result.x, result.y);
+}
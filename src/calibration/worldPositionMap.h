@@ -0,0 +1,63 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORLDPOSITIONMAP_H
+#define WORLDPOSITIONMAP_H
+
+#include <QPointF>
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief Lookup table of the world position of image points for a set of reference heights
+ *
+ * For every reference height, the world positions are sampled on a regular grid
+ * over the image and interpolated bilinearly on lookup. Between two reference
+ * heights, the positions are interpolated linearly; as all points on a viewing
+ * ray project onto the same pixel, the position is linear in the height for
+ * a pinhole camera, so this adds no further error.
+ *
+ * Lookups outside of the sampled area or height range are not handled by the
+ * map (see contains()), the caller has to compute them exactly.
+ */
+class WorldPositionMap
+{
+public:
+    /// exact world position (in cm) of image point pos at the given height
+    using PositionFunction = std::function<QPointF(const QPointF &pos, double height)>;
+
+    void build(const cv::Rect &area, int cellSize, std::vector<double> heights, const PositionFunction &position);
+    void clear();
+
+    bool    isEmpty() const { return mGrids.empty(); }
+    bool    contains(const QPointF &pos, double height) const;
+    QPointF at(const QPointF &pos, double height) const;
+
+private:
+    QPointF atGrid(size_t grid, const QPointF &pos) const;
+
+    cv::Rect                              mArea;
+    int                                   mCellSize = 0;
+    int                                   mCols     = 0; ///< number of grid nodes in x direction
+    int                                   mRows     = 0; ///< number of grid nodes in y direction
+    std::vector<double>                   mHeights;      ///< ascending reference heights in cm
+    std::vector<std::vector<cv::Point2d>> mGrids;        ///< grid nodes row by row, one grid per reference height
+};
+
+#endif // WORLDPOSITIONMAP_H
@@ -25,6 +25,7 @@
 #include "logger.h"
 
 #include <QFileDialog>
+#include <algorithm>
 #include <opencv2/highgui.hpp>
 
 
@@ -36,6 +37,63 @@
 /// Anzahl der Pixel, die ein Vordergrund aufweisen muss
 #define MIN_FOREGROUND_AREA -1000 // war:-400
 
+namespace
+{
+/**
+ * @brief Fills gaps (z == -1) in a row of the point cloud by linear interpolation of the z-values
+ *
+ * Gaps at the beginning of the row get the first valid value.
+ *
+ * @param row first element of a row of a CV_32FC3 point cloud
+ * @param cols number of points in the row
+ */
+void interpolateRowGaps(float *row, int cols)
+{
+    float *vorPtr  = nullptr; // zeigt auf den letzten gueltigen Wert vor ungueltigem wert in einer Zeile
+    float *nachPtr = nullptr; // zeigt auf den ersten gueltigen Wert nach ungueltigen in einer Zeile
+    float *data    = row;
+
+    // -1 da in zukunft getestet wird, dadurch letztes pixel ungeprueft
+    for(int x = 0; x < cols - 1; ++x, data += 3)
+    {
+        if(vorPtr == nullptr && data[2] != -1 && data[5] == -1) // eine unbestimmte gap beginnt
+        {
+            vorPtr = data;
+        }
+        else if(nachPtr == nullptr && data[2] == -1 && data[5] != -1) // eine unbestimmte gap endet
+        {
+            if(vorPtr != nullptr) // innenliegende gap
+            {
+                nachPtr = data + 3;
+            }
+            else // zeilenbeginn
+            {
+                for(float *fPtr = row; fPtr < data + 3; fPtr += 3)
+                {
+                    fPtr[2] = data[5];
+                }
+            }
+        }
+        if(vorPtr != nullptr && nachPtr != nullptr) // gap bestimmt, fuellung mit interpolerten werten
+        {
+            const float step = (nachPtr[2] - vorPtr[2]) / (nachPtr - vorPtr);
+            for(float *fPtr = vorPtr + 3; fPtr < nachPtr; fPtr += 3)
+            {
+                fPtr[2] = vorPtr[2] + (fPtr - vorPtr) * step;
+            }
+            vorPtr = nachPtr = nullptr;
+        }
+    }
+    if(vorPtr != nullptr) // gap am zeilenende
+    {
+        for(float *fPtr = vorPtr; fPtr < data; fPtr += 3)
+        {
+            fPtr[2] = vorPtr[-1];
+        }
+    }
+}
+} // namespace
+
 
 BackgroundFilter::BackgroundFilter() : Filter()
 {
@@ -50,15 +108,25 @@ BackgroundFilter::~BackgroundFilter() {}
 
 
 // nutzen, wenn ueber ganzes bild foreground benutzt wird; NULL, wenn keine background subtraction aktiviert
+// the foreground of a scaled model is scaled up to the size of the image once per frame
 cv::Mat BackgroundFilter::getForeground()
 {
-    return mForeground;
+    if(mForeground.empty() || mForeground.size() == mImageSize)
+    {
+        return mForeground;
+    }
+    if(mFullForeground.empty())
+    {
+        cv::resize(mForeground, mFullForeground, mImageSize, 0, 0, cv::INTER_NEAREST);
+    }
+    return mFullForeground;
 }
 
 /**
  * @brief Determines if pixel is in foreground. Use for single pixels.
  *
  * Does not check if pixel position is valid! (For efficiency)
+ * With a scaled model, the pixel of the model covering the pixel of the image is looked up.
  *
  * @param coloumn
  * @param row
@@ -66,19 +134,22 @@ cv::Mat BackgroundFilter::getForeground()
  */
 bool BackgroundFilter::isForeground(int coloumn, int row)
 {
-    if(!mForeground.empty())
+    if(mForeground.empty())
     {
-        return (bool) mForeground.data[row * mForeground.cols + coloumn]; // 0 background, 1 foreground
+        return false;
     }
-    else
+    if(mForeground.size() != mImageSize)
     {
-        return false;
+        coloumn = coloumn * mForeground.cols / mImageSize.width;
+        row     = row * mForeground.rows / mImageSize.height;
     }
+    return (bool) mForeground.data[row * mForeground.cols + coloumn]; // 0 background, 1 foreground
 }
 
 /**
  * Reset the filter.
  * This will set the changed()-value to true.
+ * With a sampled background model, the subtractor starts with it again.
  */
 void BackgroundFilter::reset()
 {
@@ -86,7 +157,12 @@ void BackgroundFilter::reset()
     {
         mForeground = cv::Scalar::all(0);
     }
-    if(!mBgModel.empty())
+    mFullForeground.release();
+    if(!mModel.isEmpty())
+    {
+        mBgModel.reset();
+    }
+    else if(!mBgModel.empty())
     {
         mBgModel->clear();
     }
@@ -208,9 +284,29 @@ bool BackgroundFilter::save([[maybe_unused]] QString dest) // default = ""
         else
             return false;
     }
-    else // nicht stereo
+    else if(!mModel.isEmpty()) // nicht stereo
     {
-        ;
+        if(dest.isEmpty())
+        {
+            dest = QFileDialog::getSaveFileName(
+                nullptr,
+                "Select file for the background model",
+                mLastFile,
+                QString("Background model (*%1);;All files (*.*)").arg(BackgroundModel::FILE_SUFFIX));
+        }
+        if(dest.isEmpty())
+        {
+            return false;
+        }
+        if(!BackgroundModel::isModelFile(dest))
+        {
+            dest += BackgroundModel::FILE_SUFFIX;
+        }
+        if(!mModel.save(dest))
+        {
+            return false;
+        }
+        mLastFile = dest;
     }
     return true;
 }
@@ -234,12 +330,23 @@ bool BackgroundFilter::load(QString dest) // default = ""
         {
             dest = QFileDialog::getOpenFileName(
                 nullptr,
-                "Select file for background subtraction in stereo mode",
+                "Select file for background subtraction",
                 mLastFile,
-                "Background picture (*.png);;All files (*.*)");
+                QString("Background picture (*.png);;Background model (*%1);;All files (*.*)")
+                    .arg(BackgroundModel::FILE_SUFFIX));
         }
 
-        if(!dest.isEmpty())
+        if(BackgroundModel::isModelFile(dest)) // sampled background without stereo
+        {
+            BackgroundModel model;
+            if(!model.load(dest))
+            {
+                return false;
+            }
+            setModel(model);
+            mLastFile = dest;
+        }
+        else if(!dest.isEmpty())
         {
             cv::Mat bgImg = cv::imread(dest.toStdString(), cv::IMREAD_GRAYSCALE);
             if(bgImg.empty())
@@ -329,6 +436,113 @@ void BackgroundFilter::setDefaultHeight(double h)
     mDefaultHeight = h;
 }
 
+/**
+ * @brief Selects the background subtractor; the model is built anew with the next image
+ */
+void BackgroundFilter::setMethod(Method method)
+{
+    if(method != mMethod)
+    {
+        mMethod = method;
+        mBgModel.reset();
+        setChanged(true);
+    }
+}
+
+BackgroundFilter::Method BackgroundFilter::getMethod() const
+{
+    return mMethod;
+}
+
+/**
+ * @brief Sets the resolution the background model works on relative to the image
+ *
+ * A scale below 1 speeds up the subtraction for large images by the square of the
+ * scale. The foreground stays at the resolution of the model, which is enough for
+ * decisions at the scale of heads; isForeground() and getForeground() look it up
+ * in the model. The model is built anew with the next image.
+ *
+ * @param scale factor in (0, 1]
+ */
+void BackgroundFilter::setModelScale(double scale)
+{
+    scale = std::clamp(scale, 0.1, 1.);
+    if(scale != mModelScale)
+    {
+        mModelScale = scale;
+        mBgModel.reset();
+        setChanged(true);
+    }
+}
+
+double BackgroundFilter::getModelScale() const
+{
+    return mModelScale;
+}
+
+/**
+ * @brief Sets the sampled background the subtractor starts with instead of the first image
+ *
+ * The subtractor is built anew with the next image. An empty model lets it learn the
+ * background from the images again.
+ */
+void BackgroundFilter::setModel(const BackgroundModel &model)
+{
+    mModel = model;
+    mBgModel.reset();
+    setChanged(true);
+}
+
+const BackgroundModel &BackgroundFilter::getModel() const
+{
+    return mModel;
+}
+
+/**
+ * @brief Starts the fresh subtractor with the sampled background
+ *
+ * For MOG2, the initial variance of the Gaussians is taken from the noise of the samples,
+ * so the subtractor does not have to learn it while the sequence is played.
+ *
+ * @return false, if there is no model or it does not fit img; then the subtractor has to start with img
+ */
+bool BackgroundFilter::seedModel(const cv::Mat &img)
+{
+    if(mModel.isEmpty())
+    {
+        return false;
+    }
+    const cv::Mat &median = mModel.getMedian();
+    if(median.size() != img.size() || median.type() != img.type())
+    {
+        SPDLOG_WARN("The background model does not fit the images, the background is learned from the images.");
+        mModel = BackgroundModel();
+        return false;
+    }
+    if(auto mog2 = mBgModel.dynamicCast<cv::BackgroundSubtractorMOG2>())
+    {
+        const double noise = mModel.getNoise();
+        mog2->setVarInit(std::clamp(noise * noise, mog2->getVarMin(), mog2->getVarMax()));
+    }
+    applyModel(median, 1);
+    return true;
+}
+
+/**
+ * @brief Updates the background model with img and computes mForeground (in the resolution of the model)
+ */
+void BackgroundFilter::applyModel(const cv::Mat &img, double learningRate)
+{
+    if(mModelScale >= 1.)
+    {
+        mBgModel->apply(img, mForeground, learningRate);
+        return;
+    }
+    cv::Mat small;
+    cv::resize(img, small, cv::Size(), mModelScale, mModelScale, cv::INTER_AREA);
+    mBgModel->apply(small, mForeground, learningRate);
+}
+
 void BackgroundFilter::setUpdate(bool b)
 {
     mUpdate = b;
@@ -355,9 +569,11 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
     imshow("BackgroundFilter", img);
     waitKey();
 #endif
+    mFullForeground.release();
     if((mBgPointCloud.empty() && mBgModel.empty()) || mForeground.empty() ||
-       mForeground.size != img.size) // initialisierung wenn entwerder stereo oder model
+       mImageSize != img.size()) // initialisierung wenn entwerder stereo oder model
     {
+        mImageSize = img.size();
         // For StereoImaging use heightfiled for foreground extraction
         // -------------------------------------------------------------------------------
         if(*stereoContext())
@@ -372,64 +588,16 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
             mBgPointCloud =
                 (*stereoContext())->getPointCloud().clone(); // = cvCloneMat((*stereoContext())->getPointCloud());
 
-            // interpolate z-values inbetween innerhalb zeile
-            int    x, y;
-            float *vorPtr;  // zeigt auf den letzten gueltigen Wert vor ungueltigem wert in einer Zeile
-            float *nachPtr; // zeigt auf den ersten gueltigen Wert nach ungueltigen in einer Zeile
-            float *fPtr;
-            float  step;
-
-            float *bgPcData  = (float *) mBgPointCloud.data;
-            float *bgyPcData = bgPcData;
-
-            for(y = 0; y < mBgPointCloud.rows; ++y)
-            {
-                vorPtr = nachPtr = NULL;
-                for(x = 0; x < (mBgPointCloud.cols) - 1;
-                    ++x) // -1 da in zukunft getestet wird, dadurch letztes pixel ungeprueft
+            // interpolate z-values inbetween innerhalb zeile; rows are independent
+            cv::parallel_for_(
+                cv::Range(0, mBgPointCloud.rows),
+                [this](const cv::Range &range)
                 {
-                    if(vorPtr == NULL && bgPcData[2] != -1 && bgPcData[5] == -1) // eine unbestimmte gap beginnt
-                        vorPtr = bgPcData;
-                    else if(nachPtr == NULL && bgPcData[2] == -1 && bgPcData[5] != -1) // eine unbestimmte gap endet
+                    for(int y = range.start; y < range.end; ++y)
                     {
-                        if(vorPtr != NULL) // innenliegende gap
-                            nachPtr = bgPcData + 3;
-                        else // zeilenbeginn
-                        {
-                            for(fPtr = bgyPcData; fPtr < bgPcData + 3; fPtr += 3)
-                            {
-                                fPtr[2] = bgPcData[5];
-                            }
-                        }
+                        interpolateRowGaps(mBgPointCloud.ptr<float>(y), mBgPointCloud.cols);
                     }
-                    if(vorPtr != NULL && nachPtr != NULL) // gap bestimmt, fuellung mit interpolerten werten
-                    {
-                        // debout << vorPtr[2] <<endl;
-                        // debout << nachPtr[2] <<endl;
-                        step =
-                            ((nachPtr[2] - vorPtr[2]) /
-                             (nachPtr - vorPtr)); // lange zeit war falsch: /9.; // /3 ein /3 durch (fPtr-vorPtr) und
-                                                  // nicht (fPtr-vorPtr)/3 in schleife
-                        for(fPtr = vorPtr + 3; fPtr < nachPtr; fPtr += 3)
-                        {
-                            // fPtr[0] = ; // x
-                            // fPtr[1] = ; // y
-                            fPtr[2] = vorPtr[2] + (fPtr - vorPtr) * step;
-                            // debout << fPtr[2] <<endl;
-                        }
-                        vorPtr = nachPtr = NULL;
-                    }
-                    bgPcData += 3;
-                }
-                if(vorPtr != NULL) // gap am zeilenende
-                {
-                    for(fPtr = vorPtr; fPtr < bgPcData; fPtr += 3)
-                    {
-                        fPtr[2] = vorPtr[-1];
-                    }
-                }
-                bgPcData = (bgyPcData += mBgPointCloud.step1());
-            }
+                });
 
             mForeground.create(cv::Size(img.cols, img.rows), CV_8UC1);
             //            mForeground = cvCreateImage(cvSize(img->width, img->height), IPL_DEPTH_8U, 1); // CV_8UC1 8, 1
@@ -446,11 +614,21 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
                 mBgModel->clear();
             }
 
-            mBgModel = cv::createBackgroundSubtractorMOG2();
-
-            mForeground.create(cv::Size(img.cols, img.rows), CV_8UC1);
+            if(mMethod == Method::KNN)
+            {
+                mBgModel = cv::createBackgroundSubtractorKNN();
+            }
+            else
+            {
+                mBgModel = cv::createBackgroundSubtractorMOG2();
+            }
 
-            mBgModel->apply(img, mForeground, 1);
+            if(seedModel(img))
+            {
+                // img is the first image compared to the sampled background
+                return act(img, res);
+            }
+            applyModel(img, 1);
 
 #ifdef SHOW_TMP_IMG
             namedWindow("BackgroundFilter");
@@ -506,39 +684,29 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
             // SteroBild beruecksichtigen z-wert
             // --------------------------------------------------------------------------------------------------------
 
-            int x, y;
-
-            float *bgPcData  = (float *) mBgPointCloud.data;
-            float *bgyPcData = bgPcData;
+            // only z is needed, so it is looked up from the disparity instead of converting the whole point cloud
+            const cv::Mat             disparity = (*stereoContext())->getDisparity();
+            const std::vector<float> &zTable    = (*stereoContext())->getZTable();
 
-            cv::Mat pointCloud = (*stereoContext())->getPointCloud();
-            float  *pcData     = (float *) pointCloud.data;
-            float  *yPcData    = pcData;
-
-            mForeground = cv::Scalar(0, 0, 0);
-            //                cvSet(mForeground, CV_RGB(0,0,0));
-            //                cvFillImage(mForeground, 0); //um vorherige foreground-berechungen zu vergessen
-
-            for(y = 0; y < pointCloud.rows; ++y)
-            {
-                for(x = 0; x < pointCloud.cols; ++x)
+            // z-Wert in m (nicht cm!) wenn z-wert 1m unter defaultgroesse
+            cv::parallel_for_(
+                cv::Range(0, disparity.rows),
+                [this, &disparity, &zTable](const cv::Range &range)
                 {
-                    if((bgPcData[2] != -1) && (pcData[2] != -1))
+                    for(int y = range.start; y < range.end; ++y)
                     {
-                        if((bgPcData[2] - pcData[2]) >
-                           FOREGROUND_DISTANCE) // z-Wert in m (nicht cm!) wenn z-wert 1m unter defaultgroesse
+                        const float  *bgPcData = mBgPointCloud.ptr<float>(y);
+                        const ushort *disp     = disparity.ptr<ushort>(y);
+                        uchar        *fgData   = mForeground.ptr<uchar>(y);
+                        for(int x = 0; x < disparity.cols; ++x, bgPcData += 3)
                         {
-                            mForeground.data[y * pointCloud.cols + x] = 1;
+                            const float bgZ = bgPcData[2];
+                            const float z   = zTable[disp[x]];
+
+                            fgData[x] = (bgZ != -1) && (z != -1) && (bgZ - z) > FOREGROUND_DISTANCE ? 1 : 0;
                         }
-                        // if (y == 488)
-                        //    debout << bgPcData[2] << " " << pcData[2] <<endl;
                     }
-                    pcData += 3;
-                    bgPcData += 3;
-                }
-                pcData   = (yPcData += pointCloud.step1());
-                bgPcData = (bgyPcData += mBgPointCloud.step1());
-            }
+                });
         }
         else // nicht stereo
         {
@@ -546,7 +714,7 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
             // ---------------------------------------------------------------------------------------------------------------------
 
 
-            mBgModel->apply(img, mForeground, update() ? -1 : 0);
+            applyModel(img, update() ? -1 : 0);
 
 #ifdef SHOW_TMP_IMG
             imshow("BackgroundFilter", img);
@@ -557,6 +725,10 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
         imshow("BackgroundFilter", mForeground);
         waitKey();
 #endif
+        // sizes below are in pixels of the image; the foreground of a scaled model is smaller
+        const double scale = static_cast<double>(mForeground.cols) / img.cols;
+        const int    blur  = std::max(3, static_cast<int>(11 * scale) | 1);
+
         // einfache methode, um kleine gebiete in maske zu eliminieren und ausfransungen zu entfernen
         // ---------------------------------------------------
 
@@ -572,7 +744,7 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
         imshow("BackgroundFilter", mForeground);
         waitKey();
 #endif
-        cv::GaussianBlur(mForeground, mForeground, cv::Size(11, 11), 3.5, 3.5);
+        cv::GaussianBlur(mForeground, mForeground, cv::Size(blur, blur), 3.5 * scale, 3.5 * scale);
 #ifdef SHOW_TMP_IMG
         imshow("BackgroundFilter", mForeground);
         waitKey();
@@ -597,7 +769,7 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
         {
             std::vector<cv::Point> contour = contours.back();
 
-            contourArea = cv::contourArea(contour, true);
+            contourArea = cv::contourArea(contour, true) / (scale * scale);
             if(contourArea > 0 && contourArea < 400) // kleine innere loecher schliessen
             {
                 // Get contour point set.
@@ -625,34 +797,28 @@ cv::Mat BackgroundFilter::act(cv::Mat &img, cv::Mat &res)
 // setzt in mat alle bg pixel auf val
 // bei mehreren Kanaelen nur den letzten Kanal
 // bisher nur fuer float
-void BackgroundFilter::maskBg(cv::Mat &mat, float val)
+// offset: position of mat in the image, if mat only covers a region of it
+void BackgroundFilter::maskBg(cv::Mat &mat, float val, cv::Point offset)
 {
     if(getEnabled() && !mForeground.empty())
     {
-        int x, y;
-
-        int    lineLen = mat.cols / sizeof(float);
-        int    ch      = lineLen / mat.cols;
-        float *pcData  = ((float *) mat.data) + ch - 1; // ch-1 um beim letzten element zu stehen (wie pcData[2])
-        float *yPcData = pcData;
-
-        unsigned char *fgData  = (unsigned char *) mForeground.data;
-        unsigned char *yFgData = fgData;
+        const int      ch     = mat.channels();
+        const cv::Rect region = cv::Rect(offset, mat.size()) & cv::Rect(cv::Point(), mImageSize);
+        const bool     scaled = mForeground.size() != mImageSize;
 
-        for(y = 0; y < mat.rows; ++y)
+        for(int y = region.y; y < region.br().y; ++y)
         {
-            for(x = 0; x < mat.cols; ++x)
+            // ch-1 um beim letzten element zu stehen (wie pcData[2])
+            float       *pcData = mat.ptr<float>(y - offset.y) + ch - 1;
+            const uchar *fgData = mForeground.ptr<uchar>(scaled ? y * mForeground.rows / mImageSize.height : y);
+            for(int x = region.x; x < region.br().x; ++x)
             {
                 // 0 background, 1 foreground
-                if(!*fgData)
+                if(!fgData[scaled ? x * mForeground.cols / mImageSize.width : x])
                 {
-                    *pcData = val;
+                    pcData[(x - offset.x) * ch] = val;
                 }
-                ++fgData;
-                pcData += ch;
             }
-            pcData = (yPcData += lineLen);
-            fgData = (yFgData += mForeground.step1());
         }
     }
 }
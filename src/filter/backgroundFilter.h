@@ -19,6 +19,7 @@
 #ifndef BACKGROUNDFILTER_H
 #define BACKGROUNDFILTER_H
 
+#include "backgroundModel.h"
 #include "filter.h"
 #include "stereoContext.h"
 
@@ -29,15 +30,31 @@
 
 class BackgroundFilter : public Filter
 {
+public:
+    /// background subtractor used without stereo information
+    enum class Method
+    {
+        MOG2,
+        KNN
+    };
+
 private:
-    cv::Ptr<cv::BackgroundSubtractorMOG2> mBgModel;
+    cv::Ptr<cv::BackgroundSubtractor> mBgModel;
 
     bool                 mUpdate;        // if 0, kein update des models, sonst schon
     pet::StereoContext **mStereoContext; ///< zeiger auf den zeiger in petrack mit stereocontext
     cv::Mat              mBgPointCloud;
-    cv::Mat              mForeground;
+    cv::Mat              mForeground;     ///< at the resolution of the model; may be smaller than the image
+    cv::Mat              mFullForeground; ///< mForeground scaled to mImageSize; built on demand
+    cv::Size             mImageSize;      ///< size of the filtered images
     QString              mLastFile;
     double               mDefaultHeight;
+    Method               mMethod     = Method::MOG2;
+    double               mModelScale = 1.; ///< resolution of the model relative to the image
+    BackgroundModel      mModel;           ///< sampled background the subtractor starts with; may be empty
+
+    void applyModel(const cv::Mat &img, double learningRate);
+    bool seedModel(const cv::Mat &img);
 
 public:
     BackgroundFilter();
@@ -45,6 +62,14 @@ public:
 
     void setDefaultHeight(double h);
 
+    void   setMethod(Method method);
+    Method getMethod() const;
+    void   setModelScale(double scale);
+    double getModelScale() const;
+
+    void                   setModel(const BackgroundModel &model);
+    const BackgroundModel &getModel() const;
+
     void setUpdate(bool b);
     bool update() const;
 
@@ -64,7 +89,7 @@ public:
 
     cv::Mat act(cv::Mat &img, cv::Mat &res);
 
-    void maskBg(cv::Mat &mat, float val);
+    void maskBg(cv::Mat &mat, float val, cv::Point offset = cv::Point());
 };
 
 #endif
@@ -0,0 +1,239 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backgroundModel.h"
+
+#include "logger.h"
+
+#include <QDataStream>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <opencv2/core/utility.hpp>
+
+namespace
+{
+constexpr char   MODEL_MAGIC[8] = {'P', 'E', 'T', 'B', 'G', 'M', 'D', 'L'};
+constexpr qint32 MODEL_VERSION  = 1;
+constexpr int    STRIP_ROWS     = 16; ///< rows of the samples sorted at once, so they stay in the cache
+
+/// 1.4826 * median absolute deviation estimates the standard deviation of normal distributed values
+constexpr double MAD_TO_SIGMA = 1.4826;
+
+/**
+ * @brief Sorts the values of every pixel over planes in place
+ *
+ * Odd-even transposition sort of the planes: each compare-exchange is a cv::min and a cv::max
+ * of two whole planes, which OpenCV computes with SIMD instructions.
+ *
+ * @param tmp buffer of the size of a plane
+ */
+void sortPlanes(std::vector<cv::Mat> &planes, cv::Mat &tmp)
+{
+    const std::size_t n = planes.size();
+    for(std::size_t round = 0; round < n; ++round)
+    {
+        for(std::size_t i = round % 2; i + 1 < n; i += 2)
+        {
+            cv::min(planes[i], planes[i + 1], tmp);
+            cv::max(planes[i], planes[i + 1], planes[i + 1]);
+            std::swap(planes[i], tmp);
+        }
+    }
+}
+
+bool writeMat(QDataStream &stream, const cv::Mat &mat)
+{
+    const cv::Mat cont  = mat.isContinuous() ? mat : mat.clone();
+    const auto    bytes = static_cast<int>(cont.total() * cont.elemSize());
+    return stream.writeRawData(reinterpret_cast<const char *>(cont.data), bytes) == bytes;
+}
+
+bool readMat(QDataStream &stream, cv::Mat &mat)
+{
+    const auto bytes = static_cast<int>(mat.total() * mat.elemSize());
+    return stream.readRawData(reinterpret_cast<char *>(mat.data), bytes) == bytes;
+}
+} // namespace
+
+/**
+ * @brief Computes median and spread of the frames
+ *
+ * The frames are processed in strips of rows in parallel. Empty frames (e.g. which could
+ * not be decoded) are skipped.
+ *
+ * @param frames 8 bit frames of the same size and type
+ * @return false, if there are no frames or they differ in size or type
+ */
+bool BackgroundModel::compute(const std::vector<cv::Mat> &frames)
+{
+    std::vector<cv::Mat> samples;
+    std::copy_if(frames.begin(), frames.end(), std::back_inserter(samples), [](const auto &f) { return !f.empty(); });
+    if(samples.empty())
+    {
+        SPDLOG_WARN("No frames to compute the background model from.");
+        return false;
+    }
+    const cv::Size size    = samples.front().size();
+    const int      type    = samples.front().type();
+    const auto     differs = [&](const cv::Mat &f) { return f.size() != size || f.type() != type; };
+    if(CV_MAT_DEPTH(type) != CV_8U || std::any_of(samples.begin(), samples.end(), differs))
+    {
+        SPDLOG_WARN("The frames for the background model differ in size or type.");
+        return false;
+    }
+
+    cv::Mat median(size, type);
+    cv::Mat spread(size, type);
+
+    const int strips = (size.height + STRIP_ROWS - 1) / STRIP_ROWS;
+    cv::parallel_for_(
+        cv::Range(0, strips),
+        [&](const cv::Range &range)
+        {
+            std::vector<cv::Mat> planes(samples.size());
+            cv::Mat              tmp;
+            for(int strip = range.start; strip < range.end; ++strip)
+            {
+                const cv::Range rows(strip * STRIP_ROWS, std::min((strip + 1) * STRIP_ROWS, size.height));
+                for(std::size_t i = 0; i < samples.size(); ++i)
+                {
+                    samples[i].rowRange(rows).copyTo(planes[i]);
+                }
+                sortPlanes(planes, tmp);
+                cv::Mat stripMedian = median.rowRange(rows);
+                planes[planes.size() / 2].copyTo(stripMedian);
+
+                for(std::size_t i = 0; i < samples.size(); ++i)
+                {
+                    cv::absdiff(planes[i], stripMedian, planes[i]);
+                }
+                sortPlanes(planes, tmp);
+                cv::Mat stripSpread = spread.rowRange(rows);
+                planes[planes.size() / 2].copyTo(stripSpread);
+            }
+        });
+
+    mMedian  = median;
+    mSpread  = spread;
+    mSamples = static_cast<int>(samples.size());
+    SPDLOG_INFO("Computed the background model from {} frames (noise {:.1f}).", mSamples, getNoise());
+    return true;
+}
+
+/**
+ * @brief Standard deviation of the background over all pixels and channels, estimated from the spread
+ */
+double BackgroundModel::getNoise() const
+{
+    if(mSpread.empty())
+    {
+        return 0.;
+    }
+    const cv::Scalar mean = cv::mean(mSpread);
+    double           sum  = 0.;
+    for(int c = 0; c < mSpread.channels(); ++c)
+    {
+        sum += mean[c];
+    }
+    return MAD_TO_SIGMA * sum / mSpread.channels();
+}
+
+/**
+ * @brief Writes median and spread without loss to fileName
+ */
+bool BackgroundModel::save(const QString &fileName) const
+{
+    if(isEmpty())
+    {
+        return false;
+    }
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        SPDLOG_ERROR("Could not write background model {}: {}", fileName, file.errorString());
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData(MODEL_MAGIC, sizeof(MODEL_MAGIC));
+    stream << MODEL_VERSION << static_cast<qint32>(mSamples) << static_cast<qint32>(mMedian.rows)
+           << static_cast<qint32>(mMedian.cols) << static_cast<qint32>(mMedian.type());
+    if(!writeMat(stream, mMedian) || !writeMat(stream, mSpread) || stream.status() != QDataStream::Ok)
+    {
+        SPDLOG_ERROR("Could not write background model {}.", fileName);
+        return false;
+    }
+    SPDLOG_INFO("Saved background model of {} frames to {}.", mSamples, fileName);
+    return true;
+}
+
+/**
+ * @brief Reads a model written by save(); the model is unchanged on failure
+ */
+bool BackgroundModel::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        SPDLOG_ERROR("Could not read background model {}: {}", fileName, file.errorString());
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    char magic[sizeof(MODEL_MAGIC)] = {};
+    if(stream.readRawData(magic, sizeof(magic)) != sizeof(magic) ||
+       std::memcmp(magic, MODEL_MAGIC, sizeof(MODEL_MAGIC)) != 0)
+    {
+        SPDLOG_ERROR("{} is no background model.", fileName);
+        return false;
+    }
+
+    qint32 version = 0;
+    qint32 samples = 0;
+    qint32 rows    = 0;
+    qint32 cols    = 0;
+    qint32 type    = 0;
+    stream >> version >> samples >> rows >> cols >> type;
+    if(stream.status() != QDataStream::Ok || version != MODEL_VERSION || rows <= 0 || cols <= 0 ||
+       CV_MAT_DEPTH(type) != CV_8U)
+    {
+        SPDLOG_ERROR("Unsupported background model {}.", fileName);
+        return false;
+    }
+
+    cv::Mat median(rows, cols, type);
+    cv::Mat spread(rows, cols, type);
+    if(!readMat(stream, median) || !readMat(stream, spread))
+    {
+        SPDLOG_ERROR("Background model {} is incomplete.", fileName);
+        return false;
+    }
+    mMedian  = median;
+    mSpread  = spread;
+    mSamples = samples;
+    SPDLOG_INFO("Loaded background model of {} frames from {}.", mSamples, fileName);
+    return true;
+}
+
+/// Returns, if fileName is named like a file written by save()
+bool BackgroundModel::isModelFile(const QString &fileName)
+{
+    return fileName.endsWith(FILE_SUFFIX, Qt::CaseInsensitive);
+}
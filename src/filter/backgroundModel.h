@@ -0,0 +1,61 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BACKGROUNDMODEL_H
+#define BACKGROUNDMODEL_H
+
+#include <QString>
+#include <opencv2/core.hpp>
+#include <vector>
+
+/**
+ * @brief Background of a sequence computed from frames sampled across it
+ *
+ * The background is the per-pixel temporal median of the samples, so persons passing
+ * by do not show up in it as long as every pixel shows the background in more than half
+ * of the samples. The median absolute deviation of the samples from the median is kept
+ * as spread of the background, e.g. to estimate the noise of the camera.
+ *
+ * The model is stored losslessly in a binary file (FILE_SUFFIX) with its statistics.
+ */
+class BackgroundModel
+{
+public:
+    static constexpr int  DEFAULT_SAMPLES = 25;
+    static constexpr char FILE_SUFFIX[]   = ".pbg";
+
+    bool           isEmpty() const { return mMedian.empty(); }
+    const cv::Mat &getMedian() const { return mMedian; }
+    const cv::Mat &getSpread() const { return mSpread; }
+    int            getSamples() const { return mSamples; }
+    double         getNoise() const;
+
+    bool compute(const std::vector<cv::Mat> &frames);
+
+    bool save(const QString &fileName) const;
+    bool load(const QString &fileName);
+
+    static bool isModelFile(const QString &fileName);
+
+private:
+    cv::Mat mMedian;      ///< per-pixel median of the samples, type of the samples
+    cv::Mat mSpread;      ///< per-pixel median absolute deviation from mMedian, type of the samples
+    int     mSamples = 0; ///< number of frames the model was computed from
+};
+
+#endif // BACKGROUNDMODEL_H
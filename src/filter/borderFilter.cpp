@@ -18,6 +18,8 @@
 
 #include "borderFilter.h"
 
+#include "virtualBorder.h"
+
 
 BorderFilter::BorderFilter() : Filter()
 {
@@ -49,11 +51,33 @@ cv::Mat BorderFilter::act(cv::Mat &img, cv::Mat &res)
     int g = mGreen.getValue();
     int b = mBlue.getValue();
 
+    const cv::Mat bordered = withVirtualBorder(img);
+    if(!bordered.empty())
+    {
+        res = bordered;
+        return res;
+    }
     cv::copyMakeBorder(img, res, s, s, s, s, cv::BORDER_CONSTANT, cv::Scalar(b, g, r));
 
     return res;
 }
 
+/**
+ * @brief Returns img with the border of this filter, if it was decoded into a buffer which already has it
+ *
+ * @return the bordered image sharing its data with img, or an empty matrix, if the border has to be copied
+ * @see VirtualBorder
+ */
+cv::Mat BorderFilter::withVirtualBorder(const cv::Mat &img) const
+{
+    if(mVirtualBorder == nullptr)
+    {
+        return cv::Mat();
+    }
+    const cv::Scalar color(mBlue.getValue(), mGreen.getValue(), mRed.getValue());
+    return mVirtualBorder->expand(img, mSize.getValue(), color);
+}
+
 Parameter<int> &BorderFilter::getBorderSize()
 {
     return mSize;
@@ -21,6 +21,8 @@
 
 #include "filter.h"
 
+class VirtualBorder;
+
 class BorderFilter : public Filter
 {
 private:
@@ -29,6 +31,8 @@ private:
     Parameter<int> mBlue{this};
     Parameter<int> mSize{this};
 
+    const VirtualBorder *mVirtualBorder = nullptr;
+
 public:
     BorderFilter();
 
@@ -38,6 +42,10 @@ public:
     Parameter<int> &getBorderColR();
     Parameter<int> &getBorderColG();
     Parameter<int> &getBorderColB();
+
+    /// frames decoded into the buffers of virtualBorder get the border without being copied
+    void    setVirtualBorder(const VirtualBorder *virtualBorder) { mVirtualBorder = virtualBorder; }
+    cv::Mat withVirtualBorder(const cv::Mat &img) const;
 };
 
 #endif
@@ -32,7 +32,50 @@ BrightContrastFilter::BrightContrastFilter() : Filter()
 
 cv::Mat BrightContrastFilter::act(cv::Mat &img, cv::Mat &res)
 {
-    double delta, a, b;
+    if(img.depth() != CV_8U)
+    {
+        double a, b;
+        getLinearTransform(a, b);
+        img.convertTo(res, -1, a, b);
+        return res;
+    }
+    cv::LUT(img, getLut(), res);
+    return res;
+}
+
+/**
+ * @brief Returns the lookup table (1x256, CV_8U) of the mapping of the pixel values
+ *
+ * The table is only rebuilt if brightness or contrast changed since the last call.
+ */
+const cv::Mat &BrightContrastFilter::getLut()
+{
+    const double brightness = mBrightness.getValue();
+    const double contrast   = mContrast.getValue();
+    if(!mLut.empty() && brightness == mLutBrightness && contrast == mLutContrast)
+    {
+        return mLut;
+    }
+
+    double a, b;
+    getLinearTransform(a, b);
+    mLut.create(1, 256, CV_8U);
+    for(int i = 0; i < 256; ++i)
+    {
+        // same rounding as cv::Mat::convertTo
+        mLut.at<uchar>(i) = cv::saturate_cast<uchar>(a * i + b);
+    }
+    mLutBrightness = brightness;
+    mLutContrast   = contrast;
+    return mLut;
+}
+
+/**
+ * @brief Returns the mapping res = a * img + b of the pixel values applied by this filter
+ */
+void BrightContrastFilter::getLinearTransform(double &a, double &b) const
+{
+    double delta;
     /*
      * The algorithm is by Werner D. Streidt
      * (http://visca.com/ffactory/archives/5-99/msg00021.html)
@@ -49,9 +92,6 @@ cv::Mat BrightContrastFilter::act(cv::Mat &img, cv::Mat &res)
         a     = (256. - delta * 2.) / 255.;
         b     = a * mBrightness.getValue() + delta;
     }
-
-    img.convertTo(res, -1, a, b);
-    return res;
 }
 
 Parameter<double> &BrightContrastFilter::getBrightness()
@@ -29,11 +29,18 @@ private:
     Parameter<double> mBrightness{this};
     Parameter<double> mContrast{this};
 
+    cv::Mat mLut;               ///< mapping of the pixel values for 8 bit images
+    double  mLutBrightness = 0; ///< brightness mLut was built for
+    double  mLutContrast   = 0; ///< contrast mLut was built for
+
 public:
     BrightContrastFilter();
 
     cv::Mat act(cv::Mat &img, cv::Mat &res);
 
+    void           getLinearTransform(double &a, double &b) const;
+    const cv::Mat &getLut();
+
     Parameter<double> &getBrightness();
     Parameter<double> &getContrast();
 };
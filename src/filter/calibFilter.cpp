@@ -18,9 +18,39 @@
 
 #include "calibFilter.h"
 
+#include "logger.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <algorithm>
+#include <deque>
+#include <mutex>
 #include <opencv2/calib3d.hpp>
 #include <opencv2/imgproc.hpp>
 
+namespace
+{
+struct CachedMaps
+{
+    QByteArray key;
+    cv::Mat    map1;
+    cv::Mat    map2;
+};
+
+// number of mappings kept in memory (e.g. for different cameras of an experiment)
+constexpr std::size_t MAP_CACHE_SIZE = 4;
+
+std::mutex             mapCacheMutex;
+std::deque<CachedMaps> mapCache; ///< most recently used first
+
+constexpr quint32 MAP_FILE_MAGIC   = 0x50434d50; // "PCMP"
+constexpr quint32 MAP_FILE_VERSION = 1;
+} // namespace
+
 
 Parameter<IntrinsicCameraParams> &CalibFilter::getCamParams()
 {
@@ -55,20 +85,183 @@ CalibFilter::CalibFilter() : Filter(), mCamParams(this)
  */
 cv::Mat CalibFilter::act(cv::Mat &img, cv::Mat &res)
 {
-    if(this->changed() || map1.size() != img.size())
-    {
-        cv::Mat camera;
-        // conversion to CV_32F such that regression tests don't fail
-        mCamParams.getValue().cameraMatrix.convertTo(camera, CV_32F);
-        const cv::Mat dist = mCamParams.getValue().distortionCoeffs;
+    updateMaps(img.size());
 
-        cv::initUndistortRectifyMap(
-            camera, dist, cv::Mat_<double>::eye(3, 3), camera, img.size(), CV_16SC2, map1, map2);
+    const cv::Rect roi = mRoi & cv::Rect(cv::Point(), img.size());
+    if(mRoi.empty() || roi.area() == img.size().area())
+    {
+        cv::remap(img, res, map1, map2, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+        return res;
     }
 
-    cv::remap(img, res, map1, map2, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+    // only undistort the region of interest, the source pixels may lie outside of it
+    res.create(img.size(), img.type());
+    res.setTo(cv::Scalar::all(0));
+    if(!roi.empty())
+    {
+        cv::Mat resRoi = res(roi);
+        cv::remap(img, resRoi, map1(roi), map2(roi), cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+    }
     return res;
 }
+
+/**
+ * @brief Restricts the undistortion to roi
+ *
+ * Pixels of the result outside of the roi are black. The changed()-flag is not
+ * set, so the caller has to apply the filter again if the roi changes.
+ *
+ * @param roi region in the (bordered) image; an empty rect undistorts the whole image
+ */
+void CalibFilter::setRoi(const cv::Rect &roi)
+{
+    mRoi = roi;
+}
+
+cv::Rect CalibFilter::getRoi() const
+{
+    return mRoi;
+}
+
+/**
+ * @brief Calculates the mapping for undistortion of images of the given size, if not up to date
+ *
+ * @param size size of the (bordered) image to undistort
+ */
+void CalibFilter::updateMaps(cv::Size size)
+{
+    if(!this->changed() && map1.size() == size)
+    {
+        return;
+    }
+
+    cv::Mat camera;
+    // conversion to CV_32F such that regression tests don't fail
+    mCamParams.getValue().cameraMatrix.convertTo(camera, CV_32F);
+    const cv::Mat dist = mCamParams.getValue().distortionCoeffs;
+
+    const QByteArray key = mapKey(camera, dist, size);
+    if(key == mMapKey && map1.size() == size)
+    {
+        // changed, but not the parameters of the mapping (e.g. enabled)
+        return;
+    }
+    mMapKey = key;
+
+    std::lock_guard<std::mutex> lock(mapCacheMutex);
+    auto cached = std::find_if(mapCache.begin(), mapCache.end(), [&key](const auto &maps) { return maps.key == key; });
+    if(cached != mapCache.end())
+    {
+        map1 = cached->map1;
+        map2 = cached->map2;
+        std::rotate(mapCache.begin(), cached, cached + 1);
+        return;
+    }
+
+    // the current maps may be shared with the cache and must not be overwritten in place
+    map1.release();
+    map2.release();
+    const QString fileName = mapCacheFile(key);
+    if(!mMapDiskCache || !loadMaps(fileName, map1, map2) || map1.size() != size)
+    {
+        cv::initUndistortRectifyMap(camera, dist, cv::Mat_<double>::eye(3, 3), camera, size, CV_16SC2, map1, map2);
+        if(mMapDiskCache && !saveMaps(fileName, map1, map2))
+        {
+            SPDLOG_WARN("Could not store undistortion maps in {}.", fileName);
+        }
+    }
+    mapCache.push_front({key, map1, map2});
+    if(mapCache.size() > MAP_CACHE_SIZE)
+    {
+        mapCache.pop_back();
+    }
+}
+
+/**
+ * @brief Sets, if the mappings are also stored on disk (in the cache directory of the user)
+ */
+void CalibFilter::setMapDiskCache(bool enabled)
+{
+    mMapDiskCache = enabled;
+}
+
+bool CalibFilter::getMapDiskCache() const
+{
+    return mMapDiskCache;
+}
+
+QByteArray CalibFilter::mapKey(const cv::Mat &camera, const cv::Mat &dist, cv::Size size)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for(const cv::Mat &mat : {camera, dist})
+    {
+        const cv::Mat cont = mat.isContinuous() ? mat : mat.clone();
+        hash.addData(reinterpret_cast<const char *>(cont.data), static_cast<int>(cont.total() * cont.elemSize()));
+    }
+    hash.addData(reinterpret_cast<const char *>(&size.width), sizeof(size.width));
+    hash.addData(reinterpret_cast<const char *>(&size.height), sizeof(size.height));
+    return hash.result().toHex();
+}
+
+QString CalibFilter::mapCacheFile(const QByteArray &key)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/undistortionMaps/" +
+           QString::fromLatin1(key) + ".map";
+}
+
+bool CalibFilter::loadMaps(const QString &fileName, cv::Mat &map1, cv::Mat &map2)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    QDataStream in(&file);
+    quint32     magic, version;
+    in >> magic >> version;
+    if(magic != MAP_FILE_MAGIC || version != MAP_FILE_VERSION)
+    {
+        return false;
+    }
+    for(cv::Mat *map : {&map1, &map2})
+    {
+        qint32 rows, cols, type;
+        in >> rows >> cols >> type;
+        if(in.status() != QDataStream::Ok || rows <= 0 || cols <= 0)
+        {
+            return false;
+        }
+        map->create(rows, cols, type);
+        const auto bytes = static_cast<int>(map->total() * map->elemSize());
+        if(in.readRawData(reinterpret_cast<char *>(map->data), bytes) != bytes)
+        {
+            return false;
+        }
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+bool CalibFilter::saveMaps(const QString &fileName, const cv::Mat &map1, const cv::Mat &map2)
+{
+    if(!QDir().mkpath(QFileInfo(fileName).path()))
+    {
+        return false;
+    }
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    QDataStream out(&file);
+    out << MAP_FILE_MAGIC << MAP_FILE_VERSION;
+    for(const cv::Mat *map : {&map1, &map2})
+    {
+        const cv::Mat cont = map->isContinuous() ? *map : map->clone();
+        out << static_cast<qint32>(cont.rows) << static_cast<qint32>(cont.cols) << static_cast<qint32>(cont.type());
+        out.writeRawData(reinterpret_cast<const char *>(cont.data), static_cast<int>(cont.total() * cont.elemSize()));
+    }
+    return out.status() == QDataStream::Ok;
+}
 /**
  * @brief Returns the first output map of function "initUndistortRectifyMap"
  *
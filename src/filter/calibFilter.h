@@ -22,25 +22,46 @@
 #include "filter.h"
 #include "intrinsicCameraParams.h"
 
+#include <QByteArray>
+#include <QString>
+
 /**
  * @brief Undistortion filter
  *
  * This class is a filter which undistorts the image using the camera matrix from intrinsic calibration.
- * It caches the mapping from distorted to undistorted image.
+ * It caches the mapping from distorted to undistorted image in fixed-point form (CV_16SC2). The last
+ * mappings are shared by all instances and keyed by the camera parameters and image size, so loading
+ * a project of a known camera again does not recompute them. Optionally they are also stored on disk.
  */
 class CalibFilter : public Filter
 {
 private:
     Parameter<IntrinsicCameraParams> mCamParams;
 
-    cv::Mat map1;
-    cv::Mat map2;
+    cv::Mat    map1;
+    cv::Mat    map2;
+    QByteArray mMapKey;               ///< key of the camera parameters and size map1/map2 belong to
+    bool       mMapDiskCache = false; ///< mappings are also stored in the cache directory
+    cv::Rect   mRoi;                  ///< only this region is undistorted, if not empty
+
+    static QByteArray mapKey(const cv::Mat &camera, const cv::Mat &dist, cv::Size size);
+    static QString    mapCacheFile(const QByteArray &key);
+    static bool       loadMaps(const QString &fileName, cv::Mat &map1, cv::Mat &map2);
+    static bool       saveMaps(const QString &fileName, const cv::Mat &map1, const cv::Mat &map2);
 
 public:
     CalibFilter();
 
     cv::Mat act(cv::Mat &img, cv::Mat &res);
 
+    void updateMaps(cv::Size size);
+
+    void setMapDiskCache(bool enabled);
+    bool getMapDiskCache() const;
+
+    void     setRoi(const cv::Rect &roi);
+    cv::Rect getRoi() const;
+
     Parameter<IntrinsicCameraParams> &getCamParams();
     cv::Mat                           getMap1();
     cv::Mat                           getMap2();
@@ -18,6 +18,7 @@
 
 #include "filter.h"
 
+#include <chrono>
 
 Filter::Filter()
 {
@@ -63,13 +64,33 @@ void Filter::setChanged(bool b)
  * @return if enabled the transformed image else just img without changes (still gets cached)
  */
 cv::Mat Filter::apply(cv::Mat &img)
+{
+    const auto start = std::chrono::steady_clock::now();
+    ++mStatistics.applied;
+    const cv::Mat res = applyFilter(img);
+    mStatistics.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return res;
+}
+
+cv::Mat Filter::applyFilter(cv::Mat &img)
 {
     if(getEnabled())
     {
         if(getOnCopy())
         {
-            cv::Mat res(cv::Size(img.cols, img.rows), CV_8UC(img.channels()));
-            mRes = act(img, res);
+            // results of inputs like the last one have the size and type of the last result (e.g. bordered)
+            const bool sameInput = img.size() == mInSize && img.type() == mInType;
+            cv::Mat    res       = sameInput ? takeBuffer(mOutSize, mOutType) :
+                                               takeBuffer(img.size(), CV_8UC(img.channels()));
+            mRes     = act(img, res);
+            mInSize  = img.size();
+            mInType  = img.type();
+            mOutSize = mRes.size();
+            mOutType = mRes.type();
+            if(mRes.data != img.data)
+            {
+                keepBuffer(mRes);
+            }
             mChg = false;
             return mRes;
         }
@@ -89,9 +110,76 @@ cv::Mat Filter::apply(cv::Mat &img)
 
 cv::Mat Filter::getLastResult()
 {
+    ++mStatistics.reused;
     return mRes;
 }
 
+const FilterStatistics &Filter::getStatistics() const
+{
+    return mStatistics;
+}
+
+void Filter::resetStatistics()
+{
+    mStatistics = FilterStatistics();
+}
+
+/**
+ * @brief Returns a buffer of the pool, which nobody else references, in the given size and type
+ *
+ * If there is no such buffer, one is allocated; it enters the pool after act() in keepBuffer().
+ */
+cv::Mat Filter::takeBuffer(cv::Size size, int type)
+{
+    const auto isFree = [](const cv::Mat &buffer) { return buffer.u != nullptr && buffer.u->refcount == 1; };
+    for(const auto &buffer : mPool)
+    {
+        if(isFree(buffer) && buffer.size() == size && buffer.type() == type)
+        {
+            return buffer;
+        }
+    }
+    for(auto &buffer : mPool)
+    {
+        if(isFree(buffer))
+        {
+            // wrong size or type, memory is given back
+            buffer.release();
+        }
+    }
+    ++mStatistics.allocations;
+    return cv::Mat(size, type);
+}
+
+/**
+ * @brief Puts res into the pool, if act() did not write into a pooled buffer
+ */
+void Filter::keepBuffer(const cv::Mat &res)
+{
+    if(res.u == nullptr)
+    {
+        return;
+    }
+    for(const auto &buffer : mPool)
+    {
+        if(buffer.u == res.u)
+        {
+            return;
+        }
+    }
+    for(auto &buffer : mPool)
+    {
+        if(buffer.empty())
+        {
+            buffer = res;
+            return;
+        }
+    }
+    // all buffers are in use elsewhere, the pool drops its reference to the oldest one
+    mPool[mNextSlot] = res;
+    mNextSlot        = (mNextSlot + 1) % POOL_SIZE;
+}
+
 void Filter::enable()
 {
     mChg    = true;
@@ -19,9 +19,21 @@
 #ifndef FILTER_H
 #define FILTER_H
 
+#include <array>
 #include <opencv2/core.hpp>
 
 
+/**
+ * @brief Counters of a filter, to see which filters ran and what they cost
+ */
+struct FilterStatistics
+{
+    long long applied     = 0;  ///< calls of apply()
+    long long reused      = 0;  ///< calls of getLastResult(), i.e. the result was reused instead of recomputed
+    long long allocations = 0;  ///< result buffers, which had to be allocated
+    double    seconds     = 0.; ///< wall time spent in apply()
+};
+
 /**
  * @brief Base class for every image filter
  *
@@ -31,15 +43,40 @@
  * to apply the different filters, caching of the results,
  * activation/deactivation as well as automated detection
  * of changed parameters.
+ *
+ * Filters working on a copy write their results into buffers of a small pool
+ * owned by the filter, so no frame sized buffer is allocated per frame.
+ * Ownership rules:
+ *  - A result belongs to everyone holding a cv::Mat of it; it is never
+ *    overwritten while anybody apart from the pool references it. Holding on to a
+ *    result (e.g. in a cache) is safe, but a new buffer is allocated instead.
+ *  - Results must not be modified by the receiver, take a clone() for that.
+ *  - act() gets the buffer to write into as res. It should write into it with
+ *    OpenCV functions (which reuse it when size and type fit) and must not keep references to it.
  */
 class Filter
 {
 private:
+    static constexpr std::size_t POOL_SIZE = 3;
+
     bool    mChg;    // if filter paramater were changed
     bool    mEnable; // if filter is actice
     bool    mOnCopy; // if filter works on a copy
     cv::Mat mRes;
 
+    std::array<cv::Mat, POOL_SIZE> mPool;         ///< result buffers, free if only referenced by the pool
+    std::size_t                    mNextSlot = 0; ///< slot replaced next, if no buffer is free
+    cv::Size                       mInSize;       ///< size of the last input
+    int                            mInType = -1;  ///< type of the last input
+    cv::Size                       mOutSize;      ///< size of the last result
+    int                            mOutType = -1; ///< type of the last result
+
+    FilterStatistics mStatistics;
+
+    cv::Mat applyFilter(cv::Mat &img);
+    cv::Mat takeBuffer(cv::Size size, int type);
+    void    keepBuffer(const cv::Mat &res);
+
     // pure virtual function, where to implement the filter conversion
     // returns the result over pointer res and as result
     virtual cv::Mat act(cv::Mat &img, cv::Mat &res) = 0;
@@ -58,6 +95,9 @@ public:
 
     cv::Mat getLastResult();
 
+    const FilterStatistics &getStatistics() const;
+    void                    resetStatistics();
+
     void enable();
     void disable();
     void setEnabled(bool b);
@@ -0,0 +1,80 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameContext.h"
+
+#include <opencv2/imgproc.hpp>
+
+/**
+ * @brief Converts the image with code into view, only inside of the region if one is set
+ */
+void FrameContext::convert(cv::Mat &view, int code) const
+{
+    const cv::Rect roi = mRoi & cv::Rect(cv::Point(), mImg.size());
+    if(mRoi.empty() || roi.area() == mImg.size().area())
+    {
+        cv::cvtColor(mImg, view, code);
+        return;
+    }
+
+    view.create(mImg.size(), CV_8UC(code == cv::COLOR_BGR2GRAY ? 1 : 3));
+    view.setTo(cv::Scalar::all(0));
+    if(!roi.empty())
+    {
+        cv::Mat viewRoi = view(roi);
+        cv::cvtColor(mImg(roi), viewRoi, code);
+    }
+}
+
+/**
+ * @brief Gray image (cv::COLOR_BGR2GRAY); the image itself, if it has only one channel
+ */
+const cv::Mat &FrameContext::gray() const
+{
+    std::call_once(
+        mGrayOnce,
+        [this]()
+        {
+            if(mImg.channels() == 3)
+            {
+                convert(mGray, cv::COLOR_BGR2GRAY);
+            }
+            else
+            {
+                mGray = mImg;
+            }
+        });
+    return mGray;
+}
+
+/**
+ * @brief HSV image (cv::COLOR_BGR2HSV); empty, if the image has no three channels
+ */
+const cv::Mat &FrameContext::hsv() const
+{
+    std::call_once(
+        mHsvOnce,
+        [this]()
+        {
+            if(mImg.channels() == 3)
+            {
+                convert(mHsv, cv::COLOR_BGR2HSV);
+            }
+        });
+    return mHsv;
+}
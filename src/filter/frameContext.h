@@ -0,0 +1,65 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMECONTEXT_H
+#define FRAMECONTEXT_H
+
+#include <mutex>
+#include <opencv2/core.hpp>
+
+/**
+ * @brief Filtered image of one frame with views derived from it, which are computed on first use
+ *
+ * Tracking and recognition work on the same filtered image and used to convert it
+ * on their own. They take the gray and the HSV image from the FrameContext instead,
+ * so each of them is computed at most once per frame.
+ *
+ * Petrack creates a new context whenever the filtered image was (re-)computed,
+ * i.e. for a new frame or changed filter parameters. As the filters may reuse their
+ * buffers, a context must not be used after the next frame was filtered.
+ *
+ * With a region, the views are only computed inside of it and black outside, e.g. when
+ * only the patches around some persons are tracked (see Retracking).
+ *
+ * The views can be requested from several threads at once.
+ */
+class FrameContext
+{
+public:
+    explicit FrameContext(cv::Mat img, const cv::Rect &roi = cv::Rect()) : mImg(std::move(img)), mRoi(roi) {}
+
+    FrameContext(const FrameContext &)            = delete;
+    FrameContext &operator=(const FrameContext &) = delete;
+
+    const cv::Mat &image() const { return mImg; }
+    const cv::Mat &gray() const;
+    const cv::Mat &hsv() const;
+
+private:
+    void convert(cv::Mat &view, int code) const;
+
+    const cv::Mat  mImg;
+    const cv::Rect mRoi; ///< region the views are computed for; empty for the whole image
+
+    mutable std::once_flag mGrayOnce;
+    mutable cv::Mat        mGray;
+    mutable std::once_flag mHsvOnce;
+    mutable cv::Mat        mHsv;
+};
+
+#endif // FRAMECONTEXT_H
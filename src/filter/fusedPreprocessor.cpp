@@ -0,0 +1,256 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fusedPreprocessor.h"
+
+#include "borderFilter.h"
+#include "brightContrastFilter.h"
+#include "calibFilter.h"
+#include "swapFilter.h"
+
+#include "logger.h"
+
+#include <opencv2/core/ocl.hpp>
+#include <opencv2/imgproc.hpp>
+
+/**
+ * @brief Returns, if the fused stage can handle img (8 bit with 1 or 3 channels)
+ */
+bool FusedPreprocessor::isApplicable(const cv::Mat &img)
+{
+    return !img.empty() && img.depth() == CV_8U && (img.channels() == 1 || img.channels() == 3);
+}
+
+/**
+ * @brief Applies the enabled filters to img and resets their changed flags
+ *
+ * @return the filtered image; a new buffer, unless no filter changes img
+ */
+cv::Mat FusedPreprocessor::apply(
+    const cv::Mat        &img,
+    SwapFilter           &swapFilter,
+    BrightContrastFilter &brightContrastFilter,
+    BorderFilter         &borderFilter,
+    CalibFilter          &calibFilter)
+{
+    const bool flipH      = swapFilter.getEnabled() && swapFilter.getSwapHorizontally().getValue();
+    const bool flipV      = swapFilter.getEnabled() && swapFilter.getSwapVertically().getValue();
+    const bool bordered   = borderFilter.getEnabled() && borderFilter.getBorderSize().getValue() > 0;
+    const int  borderSize = bordered ? borderFilter.getBorderSize().getValue() : 0;
+    const bool adjusted   = brightContrastFilter.getEnabled();
+    const bool remapped   = flipH || flipV || calibFilter.getEnabled();
+
+    const cv::Size   size(img.cols + 2 * borderSize, img.rows + 2 * borderSize);
+    const cv::Scalar color(
+        borderFilter.getBorderColB().getValue(),
+        borderFilter.getBorderColG().getValue(),
+        borderFilter.getBorderColR().getValue());
+    if(remapped)
+    {
+        updateMaps(size, flipH, flipV, calibFilter);
+    }
+
+    const cv::Mat lut = adjusted ? brightContrastFilter.getLut() : cv::Mat();
+    // frame decoded into a buffer whose border is already painted
+    const cv::Mat expanded = bordered && !adjusted ? borderFilter.withVirtualBorder(img) : cv::Mat();
+    if(!expanded.empty())
+    {
+        mRes = applyCpu(expanded, lut, 0, color, remapped);
+    }
+    else if(mUseOpenCL)
+    {
+        mRes = applyOpenCL(img, lut, borderSize, color, remapped);
+    }
+    else
+    {
+        mRes = applyCpu(img, lut, borderSize, color, remapped);
+    }
+
+    swapFilter.setChanged(false);
+    brightContrastFilter.setChanged(false);
+    borderFilter.setChanged(false);
+    calibFilter.setChanged(false);
+    return mRes;
+}
+
+cv::Mat FusedPreprocessor::applyCpu(
+    const cv::Mat    &img,
+    const cv::Mat    &lut,
+    int               borderSize,
+    const cv::Scalar &color,
+    bool              remapped)
+{
+    cv::Mat source = img;
+    if(!lut.empty() || borderSize > 0)
+    {
+        const cv::Size size(img.cols + 2 * borderSize, img.rows + 2 * borderSize);
+        if(mBordered.size() != size || mBordered.type() != img.type() || (borderSize > 0 && color != mBorderColor))
+        {
+            mBordered.create(size, img.type());
+            mBordered.setTo(color);
+            mBorderColor = color;
+        }
+        cv::Mat interior = mBordered(cv::Rect(borderSize, borderSize, img.cols, img.rows));
+        if(!lut.empty())
+        {
+            cv::LUT(img, lut, interior);
+        }
+        else
+        {
+            img.copyTo(interior);
+        }
+        // mBordered is reused for the next frame
+        source = remapped ? mBordered : mBordered.clone();
+    }
+
+    if(!remapped)
+    {
+        return source;
+    }
+    // new buffer, the result for the last frame may still be in use
+    cv::Mat res;
+    cv::remap(source, res, mMap1, mMap2, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+    return res;
+}
+
+/**
+ * @brief Lets the stage run on the GPU via OpenCL (cv::UMat), if available
+ *
+ * The frame is uploaded once and only the result is downloaded, the bordered
+ * buffer and the maps stay in GPU memory.
+ *
+ * @return true, if OpenCL is used
+ */
+bool FusedPreprocessor::setUseOpenCL(bool use)
+{
+    mOpenCLRequested = use;
+    mUseOpenCL       = use && cv::ocl::haveOpenCL();
+    if(use && !mUseOpenCL)
+    {
+        SPDLOG_WARN("OpenCL is not available, preprocessing runs on the CPU.");
+    }
+    return mUseOpenCL;
+}
+
+cv::Mat FusedPreprocessor::applyOpenCL(
+    const cv::Mat    &img,
+    const cv::Mat    &lut,
+    int               borderSize,
+    const cv::Scalar &color,
+    bool              remapped)
+{
+    cv::UMat source;
+    img.copyTo(source);
+    if(!lut.empty() || borderSize > 0)
+    {
+        const cv::Size size(img.cols + 2 * borderSize, img.rows + 2 * borderSize);
+        if(mBorderedGpu.size() != size || mBorderedGpu.type() != img.type() ||
+           (borderSize > 0 && color != mBorderColorGpu))
+        {
+            mBorderedGpu.create(size, img.type());
+            mBorderedGpu.setTo(color);
+            mBorderColorGpu = color;
+        }
+        cv::UMat interior = mBorderedGpu(cv::Rect(borderSize, borderSize, img.cols, img.rows));
+        if(!lut.empty())
+        {
+            cv::LUT(source, lut, interior);
+        }
+        else
+        {
+            source.copyTo(interior);
+        }
+        source = mBorderedGpu;
+    }
+
+    cv::Mat res;
+    if(remapped)
+    {
+        if(mMap1Gpu.size() != mMap1.size() || mMapsChanged)
+        {
+            mMap1.copyTo(mMap1Gpu);
+            mMap2.copyTo(mMap2Gpu);
+            mMapsChanged = false;
+        }
+        cv::UMat dst;
+        cv::remap(source, dst, mMap1Gpu, mMap2Gpu, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+        dst.copyTo(res);
+    }
+    else
+    {
+        source.copyTo(res);
+    }
+    return res;
+}
+
+/**
+ * @brief Calculates the maps from the result into the bordered image, if not up to date
+ *
+ * The undistortion map of calibFilter is used (and kept up to date for
+ * others using it). The flip of the SwapFilter is folded in by mirroring the
+ * source coordinates; this is equivalent, since the border is the same on
+ * all sides.
+ */
+void FusedPreprocessor::updateMaps(const cv::Size &size, bool flipH, bool flipV, CalibFilter &calibFilter)
+{
+    const bool undistorted = calibFilter.getEnabled();
+    if(undistorted)
+    {
+        calibFilter.updateMaps(size);
+    }
+    const IntrinsicCameraParams params = calibFilter.getCamParams().getValue();
+    if(!mMap1.empty() && size == mMapSize && flipH == mMapFlipH && flipV == mMapFlipV &&
+       undistorted == mMapUndistorted && (!undistorted || params == mMapParams))
+    {
+        return;
+    }
+
+    cv::Mat mapX(size, CV_32FC1);
+    cv::Mat mapY(size, CV_32FC1);
+    if(undistorted)
+    {
+        cv::convertMaps(calibFilter.getMap1(), calibFilter.getMap2(), mapX, mapY, CV_32FC1);
+    }
+    else
+    {
+        for(int y = 0; y < size.height; ++y)
+        {
+            for(int x = 0; x < size.width; ++x)
+            {
+                mapX.at<float>(y, x) = static_cast<float>(x);
+                mapY.at<float>(y, x) = static_cast<float>(y);
+            }
+        }
+    }
+    if(flipH)
+    {
+        mapX = static_cast<float>(size.width - 1) - mapX;
+    }
+    if(flipV)
+    {
+        mapY = static_cast<float>(size.height - 1) - mapY;
+    }
+    cv::convertMaps(mapX, mapY, mMap1, mMap2, CV_16SC2);
+    mMapsChanged = true;
+
+    mMapSize        = size;
+    mMapFlipH       = flipH;
+    mMapFlipV       = flipV;
+    mMapUndistorted = undistorted;
+    mMapParams      = params;
+}
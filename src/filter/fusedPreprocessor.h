@@ -0,0 +1,92 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FUSEDPREPROCESSOR_H
+#define FUSEDPREPROCESSOR_H
+
+#include "intrinsicCameraParams.h"
+
+#include <opencv2/core.hpp>
+
+class BorderFilter;
+class BrightContrastFilter;
+class CalibFilter;
+class SwapFilter;
+
+/**
+ * @brief Applies swap, brightness/contrast, border and undistortion filter at once
+ *
+ * Gives the same result as applying SwapFilter, BrightContrastFilter,
+ * BorderFilter and CalibFilter one after another, which stay the reference
+ * implementation. The brightness/contrast mapping is applied by a lookup
+ * table while copying the frame into a buffer whose border is only painted
+ * when the border changes. Flipping and the border offset are folded into
+ * the fixed-point undistortion maps, so a single remap produces the result.
+ * Thus a frame is read and written twice instead of four times.
+ * Without brightness/contrast adjustment, frames decoded into the buffers of a
+ * VirtualBorder are not copied at all before the remap.
+ * Optionally the stage runs on the GPU via OpenCL, then the frame is
+ * transferred once in each direction.
+ */
+class FusedPreprocessor
+{
+public:
+    static bool isApplicable(const cv::Mat &img);
+
+    cv::Mat apply(
+        const cv::Mat        &img,
+        SwapFilter           &swapFilter,
+        BrightContrastFilter &brightContrastFilter,
+        BorderFilter         &borderFilter,
+        CalibFilter          &calibFilter);
+
+    cv::Mat getLastResult() const { return mRes; }
+
+    bool setUseOpenCL(bool use);
+    bool isUsingOpenCL() const { return mUseOpenCL; }
+    bool isOpenCLRequested() const { return mOpenCLRequested; }
+
+private:
+    cv::Mat applyCpu(const cv::Mat &img, const cv::Mat &lut, int borderSize, const cv::Scalar &color, bool remapped);
+    cv::Mat applyOpenCL(const cv::Mat &img, const cv::Mat &lut, int borderSize, const cv::Scalar &color, bool remapped);
+    void updateMaps(const cv::Size &size, bool flipH, bool flipV, CalibFilter &calibFilter);
+
+    cv::Mat    mRes;
+    cv::Mat    mBordered;    ///< brightness/contrast corrected frame with border
+    cv::Scalar mBorderColor; ///< color mBordered's border is painted with
+
+    // maps of undistortion, flip and border, and the settings they were calculated for
+    cv::Mat               mMap1;
+    cv::Mat               mMap2;
+    cv::Size              mMapSize;
+    bool                  mMapFlipH       = false;
+    bool                  mMapFlipV       = false;
+    bool                  mMapUndistorted = false;
+    IntrinsicCameraParams mMapParams;
+    bool                  mMapsChanged = false; ///< maps are not uploaded to the GPU yet
+
+    // OpenCL path
+    bool       mUseOpenCL       = false;
+    bool       mOpenCLRequested = false; ///< OpenCL was selected, even if it is not available on this machine
+    cv::UMat   mBorderedGpu;
+    cv::Scalar mBorderColorGpu;
+    cv::UMat   mMap1Gpu;
+    cv::UMat   mMap2Gpu;
+};
+
+#endif // FUSEDPREPROCESSOR_H
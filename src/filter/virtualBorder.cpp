@@ -0,0 +1,102 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "virtualBorder.h"
+
+#include <algorithm>
+
+/**
+ * @brief Sets the border frames are decoded with; 0 disables the virtual border
+ *
+ * Buffers with another border are given up.
+ */
+void VirtualBorder::setBorder(int size, const cv::Scalar &color)
+{
+    size = std::max(size, 0);
+    if(size != mSize || color != mColor)
+    {
+        mBuffers.clear();
+    }
+    mSize  = size;
+    mColor = color;
+}
+
+/**
+ * @brief Returns the interior of a buffer with border for a frame of size and type
+ *
+ * OpenCV writes into the interior, if it gets the returned matrix as output of the
+ * same size and type, e.g. by cv::VideoCapture::read() or cv::Mat::copyTo().
+ *
+ * @return a matrix without border, if the virtual border is disabled
+ */
+cv::Mat VirtualBorder::frame(const cv::Size &size, int type)
+{
+    if(!isEnabled())
+    {
+        return cv::Mat(size, type);
+    }
+    const cv::Size bufferSize(size.width + 2 * mSize, size.height + 2 * mSize);
+    const cv::Rect interior(mSize, mSize, size.width, size.height);
+
+    const auto isFree = [](const cv::Mat &buffer) { return buffer.u->refcount == 1; };
+    for(const auto &buffer : mBuffers)
+    {
+        if(isFree(buffer) && buffer.size() == bufferSize && buffer.type() == type)
+        {
+            return buffer(interior);
+        }
+    }
+    // buffers of another size or type are not needed any more
+    mBuffers.erase(
+        std::remove_if(
+            mBuffers.begin(),
+            mBuffers.end(),
+            [&](const cv::Mat &buffer) { return buffer.size() != bufferSize || buffer.type() != type; }),
+        mBuffers.end());
+    if(static_cast<int>(mBuffers.size()) >= MAX_BUFFERS)
+    {
+        mBuffers.erase(mBuffers.begin());
+    }
+
+    cv::Mat buffer(bufferSize, type, mColor);
+    mBuffers.push_back(buffer);
+    return buffer(interior);
+}
+
+/**
+ * @brief Returns img with a border of size and color, if img is the interior of one of the buffers
+ *
+ * @return the whole buffer sharing its data with img; an empty matrix, if img has not been
+ * written into a buffer of frame() or the border differs
+ */
+cv::Mat VirtualBorder::expand(const cv::Mat &img, int size, const cv::Scalar &color) const
+{
+    if(!isEnabled() || size != mSize || color != mColor || img.empty())
+    {
+        return cv::Mat();
+    }
+    for(const auto &buffer : mBuffers)
+    {
+        if(img.u == buffer.u && img.type() == buffer.type() && img.data == buffer.ptr(mSize, mSize) &&
+           img.cols + 2 * mSize == buffer.cols && img.rows + 2 * mSize == buffer.rows)
+        {
+            return buffer;
+        }
+    }
+    return cv::Mat();
+}
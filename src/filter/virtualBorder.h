@@ -0,0 +1,55 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VIRTUALBORDER_H
+#define VIRTUALBORDER_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+/**
+ * @brief Frame buffers with a painted border, so the BorderFilter does not need to copy the frame
+ *
+ * The decoder writes a frame into the interior of a buffer returned by frame(). If the
+ * BorderFilter asks for the same border, expand() widens the region of interest to the
+ * whole buffer instead of copying the frame into a larger image.
+ *
+ * The buffers are kept and reused as soon as no one else refers to them any more, so the
+ * border is only painted when a buffer is allocated. Buffers still in use (e.g. by the
+ * frame cache) are given up when more than MAX_BUFFERS are needed; their frames are
+ * bordered by copying again.
+ */
+class VirtualBorder
+{
+public:
+    static constexpr int MAX_BUFFERS = 8;
+
+    void setBorder(int size, const cv::Scalar &color);
+    int  getSize() const { return mSize; }
+    bool isEnabled() const { return mSize > 0; }
+
+    cv::Mat frame(const cv::Size &size, int type);
+    cv::Mat expand(const cv::Mat &img, int size, const cv::Scalar &color) const;
+
+private:
+    int                  mSize = 0;
+    cv::Scalar           mColor;
+    std::vector<cv::Mat> mBuffers; ///< whole buffers, the oldest first
+};
+
+#endif // VIRTUALBORDER_H
@@ -17,19 +17,34 @@
  */
 
 #include "IO.h"
+#include "batchJobs.h"
 #include "compilerInformation.h"
+#include "compressedFile.h"
+#include "concurrency.h"
 #include "control.h"
 #include "helper.h"
+#include "jobServer.h"
 #include "logger.h"
+#include "multiCameraTracking.h"
+#include "parameterSweep.h"
 #include "petrack.h"
+#ifdef PYTHON
+#include "pythonBridge.h"
+#endif
+#include "segmentTracking.h"
+#include "trace.h"
 #include "tracker.h"
+#include "trackingEngine.h"
 
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QMessageBox>
 #include <QStyleFactory>
 #include <QtWidgets>
+#include <algorithm>
 #include <csignal>
 #include <cstdio>
+#include <optional>
 #include <sstream>
 #include <string>
 
@@ -42,12 +57,34 @@ void                 quit(int sig_number)
     gApp->quit();
 }
 
+/// -python: runs script with access to the trajectories (needs a build with the CMake option PYTHON)
+static bool runPythonScript(Petrack &petrack, const QString &script)
+{
+#ifdef PYTHON
+    return pythonBridge::runScript(petrack, script);
+#else
+    SPDLOG_ERROR("Cannot run {}: PeTrack was built without the CMake option PYTHON.", script);
+    return false;
+#endif
+}
+
 int main(int argc, char *argv[])
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     logger::setupLogger();
 
     Q_INIT_RESOURCE(icons);
 
+    // has to be known before the application is created; without a display, nothing can be shown anyway
+    const bool headless =
+        std::any_of(argv + 1, argv + argc, [](const char *option) { return std::string(option) == "-headless"; });
+    if(headless && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     QApplication app(argc, argv);
 
     // Reihenfolge beim Beenden von Petrack (signal abouttoquit() von qapplication nicht hinbekommen):
@@ -86,6 +123,31 @@ int main(int argc, char *argv[])
     bool        autoSaveTracker = false;
     bool        autoExportView  = false;
     QString     exportViewFile;
+    QString     filterStatisticsFile;
+    QString     stageStatisticsFile;
+    QString     traceFile;
+    QString     pythonScript;
+    int         segmentCount       = 1;
+    int         segmentOverlap     = 50;
+    int         rangeFirstFrame    = -1;
+    int         rangeLastFrame     = -1;
+    int         checkpointInterval = 1000;
+    bool        resume             = false;
+    QString     mergeDest;
+    QStringList mergeFiles;
+    QString     sweepFile;
+    QString     sweepReport;
+    QString     batchFile;
+    QString     batchReport;
+    QString     cameraFile;
+    QString     cameraTrajectories;
+    QString     serverName;
+    int         maxJobs        = QThread::idealThreadCount();
+    int         threads        = 0;
+    int         pinFirstCpu    = -1;
+    bool        readOnlyCaches = false;
+    bool        noTrajectories = false;
+    bool        profileStartup = false;
 
     for(int i = 1; i < arg.size(); ++i) // i=0 ist Programmname
     {
@@ -167,6 +229,99 @@ int main(int argc, char *argv[])
             autoExportView = true;
             exportViewFile = arg.at(++i);
         }
+        else if((arg.at(i) == "-filterStatistics") || (arg.at(i) == "-filterstatistics"))
+        {
+            filterStatisticsFile = arg.at(++i);
+        }
+        else if((arg.at(i) == "-stageStatistics") || (arg.at(i) == "-stagestatistics"))
+        {
+            stageStatisticsFile = arg.at(++i);
+        }
+        else if(arg.at(i) == "-segments")
+        {
+            segmentCount = arg.at(++i).toInt();
+        }
+        else if((arg.at(i) == "-segmentOverlap") || (arg.at(i) == "-segmentoverlap"))
+        {
+            segmentOverlap = arg.at(++i).toInt();
+        }
+        else if((arg.at(i) == "-frameRange") || (arg.at(i) == "-framerange"))
+        {
+            rangeFirstFrame = arg.at(++i).toInt();
+            rangeLastFrame  = arg.at(++i).toInt();
+        }
+        else if(arg.at(i) == "-checkpoint")
+        {
+            checkpointInterval = arg.at(++i).toInt();
+        }
+        else if(arg.at(i) == "-resume")
+        {
+            resume = true;
+        }
+        else if((arg.at(i) == "-merge") || (arg.at(i) == "--merge"))
+        {
+            // -merge followed by the merged trackerFile and the partial trc files up to the next option
+            mergeDest = arg.at(++i);
+            while(i + 1 < arg.size() && !arg.at(i + 1).startsWith("-"))
+            {
+                mergeFiles << arg.at(++i);
+            }
+        }
+        else if(arg.at(i) == "-sweep")
+        {
+            sweepFile   = arg.at(++i);
+            sweepReport = arg.at(++i);
+        }
+        else if(arg.at(i) == "-batch")
+        {
+            batchFile   = arg.at(++i);
+            batchReport = arg.at(++i);
+        }
+        else if(arg.at(i) == "-cameras")
+        {
+            cameraFile         = arg.at(++i);
+            cameraTrajectories = arg.at(++i);
+        }
+        else if(arg.at(i) == "-serve")
+        {
+            serverName = arg.at(++i);
+        }
+        else if(arg.at(i) == "-jobs")
+        {
+            maxJobs = arg.at(++i).toInt();
+        }
+        else if(arg.at(i) == "-threads")
+        {
+            threads = arg.at(++i).toInt();
+        }
+        else if(arg.at(i) == "-pin")
+        {
+            pinFirstCpu = arg.at(++i).toInt();
+        }
+        else if((arg.at(i) == "-readOnlyCaches") || (arg.at(i) == "-readonlycaches"))
+        {
+            readOnlyCaches = true;
+        }
+        else if(arg.at(i) == "-noTrajectories")
+        {
+            noTrajectories = true;
+        }
+        else if(arg.at(i) == "-trace")
+        {
+            traceFile = arg.at(++i);
+        }
+        else if(arg.at(i) == "-python")
+        {
+            pythonScript = arg.at(++i);
+        }
+        else if(arg.at(i) == "-profileStartup")
+        {
+            profileStartup = true;
+        }
+        else if(arg.at(i) == "-headless")
+        {
+            // already handled before the application was created
+        }
         else
         {
             // hier koennte je nach dateiendung *pet oder *avi oder *png angenommern werden
@@ -175,6 +330,32 @@ int main(int argc, char *argv[])
         }
     }
 
+    if(!batchFile.isEmpty())
+    {
+        // the jobs run in their own processes, so this one does not need a main window
+        BatchJobs batch;
+        const bool succeeded = batch.load(batchFile) && batch.run(batchReport, maxJobs, threads, pinFirstCpu);
+        return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if(!cameraFile.isEmpty())
+    {
+        // every camera view is tracked by its own process, so this one does not need a main window
+        MultiCameraTracking cameras;
+        return cameras.load(cameraFile) && cameras.run(cameraTrajectories) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if(!serverName.isEmpty())
+    {
+        JobServer server(maxJobs);
+        return server.listen(serverName) ? app.exec() : EXIT_FAILURE;
+    }
+
+    // -threads and -pin: one thread count for OpenCV, Qt and the pools of PeTrack, set before they start threads
+    if(pinFirstCpu >= 0)
+    {
+        concurrency::pin(pinFirstCpu, threads > 0 ? threads : std::max(1, concurrency::availableCores() - pinFirstCpu));
+    }
+    concurrency::setThreadCount(threads);
+
     SPDLOG_INFO("Starting PeTrack");
     SPDLOG_INFO("Version: {}", PETRACK_VERSION);
     SPDLOG_INFO("Commit id: {}", GIT_COMMIT_HASH);
@@ -183,11 +364,46 @@ int main(int argc, char *argv[])
     SPDLOG_INFO("Compile date: {}", COMPILE_TIMESTAMP);
     SPDLOG_INFO("Build with: {} ({})", COMPILER_ID, COMPILER_VERSION);
 
+    // -profileStartup: logs the time since the start of main and the duration of every step
+    qint64     lastStartupTime = 0;
+    const auto logStartupStep  = [&](const std::string &step)
+    {
+        if(profileStartup)
+        {
+            const qint64 now = startupTimer.elapsed();
+            SPDLOG_INFO("Startup: {:6} ms ({:5} ms) {}", now, now - lastStartupTime, step);
+            lastStartupTime = now;
+        }
+    };
+    logStartupStep("application and arguments");
+
+    // -trace: records the zones of the whole run, written when main returns
+    std::optional<trace::Session> traceSession;
+    if(!traceFile.isEmpty())
+    {
+        traceSession.emplace(traceFile);
+    }
+
     Petrack petrack(PETRACK_VERSION);
     petrack.setGitInformation(GIT_COMMIT_HASH, GIT_COMMIT_DATE, GIT_BRANCH);
     petrack.setCompileInformation(COMPILE_OS, COMPILE_TIMESTAMP, COMPILER_ID, COMPILER_VERSION);
+    petrack.setReadOnlyCaches(readOnlyCaches);
+    petrack.setLoadTrajectories(!noTrajectories);
+    petrack.setHeadless(headless);
+    if(profileStartup)
+    {
+        for(const auto &[part, duration] : petrack.getStartupTimes())
+        {
+            SPDLOG_INFO("Startup:           ({:5} ms) main window: {}", duration, part);
+        }
+    }
+    logStartupStep("main window");
 
-    petrack.show(); // damit bei reiner Hilfe nicht angezeigt wird, erst hier der aufruf
+    if(!headless)
+    {
+        petrack.show(); // damit bei reiner Hilfe nicht angezeigt wird, erst hier der aufruf
+        logStartupStep("showing the main window");
+    }
 
     // erst nachher ausfuehren, damit reihenfolge der command line argumente keine rolle spielt
     if(!project.isEmpty())
@@ -200,16 +416,20 @@ int main(int argc, char *argv[])
         {
             petrack.openProject(project, false);
         }
+        logStartupStep("opening the project");
     }
     if(!sequence.isEmpty()) // nach project so dass dies datei in project ueberschreibt
     {
         petrack.openSequence(sequence);
+        logStartupStep("opening the sequence");
     }
     if(autoSave && (!autoSaveDest.endsWith(".pet", Qt::CaseInsensitive)))
     {
-        if((autoSaveDest.endsWith(".txt", Qt::CaseInsensitive)) ||
-           (autoSaveDest.endsWith(".trav", Qt::CaseInsensitive)) ||
-           (autoSaveDest.endsWith(".dat", Qt::CaseInsensitive)))
+        // trajectories may be compressed, e.g. -autoSave result.txt.zst
+        const QString autoSaveFormat = compression::uncompressedName(autoSaveDest);
+        if((autoSaveFormat.endsWith(".txt", Qt::CaseInsensitive)) ||
+           (autoSaveFormat.endsWith(".trav", Qt::CaseInsensitive)) ||
+           (autoSaveFormat.endsWith(".dat", Qt::CaseInsensitive)))
         {
             petrack.exportTracker(autoSaveDest); // projekt wird geladen und nur Trajektoprien herausgeschrieben (zB
                                                  // wenn sich .pet (altitude) oder .trc aendert (delrec))
@@ -252,6 +472,12 @@ int main(int argc, char *argv[])
         petrack.getControlWidget()->loadExtrinsicCalibFile();
     }
 
+    if(!pythonScript.isEmpty() && !autoTrack)
+    {
+        // with -autoTrack, the script runs on the new trajectories before they are exported
+        return runPythonScript(petrack, pythonScript) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     if(autoExportView)
     {
         QFile outputFile{exportViewFile};
@@ -259,10 +485,78 @@ int main(int argc, char *argv[])
         return EXIT_SUCCESS;
     }
 
+    if(!mergeDest.isEmpty())
+    {
+        // stitches the partial results of -autoTrack -frameRange runs, e.g. from different machines
+        SegmentTracking segmentTracking(petrack, {});
+        if(!segmentTracking.merge(mergeFiles))
+        {
+            return EXIT_FAILURE;
+        }
+        petrack.exportTracker(mergeDest);
+        return EXIT_SUCCESS;
+    }
+
+    if(!sweepFile.isEmpty())
+    {
+        // every configuration is tracked by its own petrack process loading a modified copy of the project
+        QStringList arguments;
+        if(!sequence.isEmpty())
+        {
+            arguments << "-sequence" << sequence;
+        }
+        ParameterSweep sweep(petrack, project, arguments);
+        if(project.isEmpty() || !sweep.load(sweepFile) || !sweep.run(sweepReport, maxJobs))
+        {
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
     // hat tracker_file bestimmte Dateiendung txt oder trc, dann wird nur genau diese exportiert, sonst beide
     if(autoTrack)
     {
-        petrack.trackAll();
+        if(segmentCount > 1)
+        {
+            // every segment is tracked by its own petrack process loading the same project
+            QStringList projectArguments{project};
+            if(!sequence.isEmpty())
+            {
+                projectArguments << "-sequence" << sequence;
+            }
+            SegmentTracking segmentTracking(petrack, projectArguments);
+            if(!segmentTracking.run(segmentCount, segmentOverlap))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            // no need to show the frames while tracking
+            TrackingEngine engine(petrack);
+            if(rangeFirstFrame >= 0)
+            {
+                engine.setFrameRange(rangeFirstFrame, rangeLastFrame);
+            }
+            engine.setCheckpoint(autoTrackDest, checkpointInterval);
+            engine.setResume(resume);
+            engine.setProgressCallback(
+                [lastPercent = -1](int processed, int total) mutable
+                {
+                    const int percent = total > 0 ? 100 * processed / total : 100;
+                    if(percent / 10 != lastPercent / 10)
+                    {
+                        SPDLOG_INFO("Tracking: {}% ({} of {} frames)", percent, processed, total);
+                        lastPercent = percent;
+                    }
+                    return true;
+                });
+            engine.run();
+        }
+        if(!filterStatisticsFile.isEmpty())
+        {
+            petrack.exportFilterStatistics(filterStatisticsFile);
+        }
 
         if(autoReadMarkerID)
         {
@@ -295,7 +589,27 @@ int main(int argc, char *argv[])
             }
         }
 
-        petrack.exportTracker(autoTrackDest);
+        if(!pythonScript.isEmpty() && !runPythonScript(petrack, pythonScript))
+        {
+            return EXIT_FAILURE;
+        }
+
+        {
+            StageTimer timer(petrack.getPipelineStatistics().output);
+            petrack.exportTracker(autoTrackDest);
+        }
+        if(!stageStatisticsFile.isEmpty() && !petrack.getPipelineStatistics().write(stageStatisticsFile))
+        {
+            return EXIT_FAILURE;
+        }
+        if(rangeFirstFrame >= 0 && segmentCount <= 1)
+        {
+            // partial result, which can be stitched with the other segments by -merge
+            if(!SegmentTracking::writeSegmentInfo(autoTrackDest, {rangeFirstFrame, rangeLastFrame}))
+            {
+                return EXIT_FAILURE;
+            }
+        }
         if(autoSave && (autoSaveDest.endsWith(".pet", Qt::CaseInsensitive)))
         {
             petrack.saveProject(autoSaveDest);
@@ -307,6 +621,10 @@ int main(int argc, char *argv[])
     if(autoPlay)
     {
         petrack.playAll();
+        if(!filterStatisticsFile.isEmpty())
+        {
+            petrack.exportFilterStatistics(filterStatisticsFile);
+        }
         petrack.exportTracker(autoPlayDest);
         if(autoSave && (autoSaveDest.endsWith(".pet", Qt::CaseInsensitive)))
         {
@@ -356,5 +674,10 @@ int main(int argc, char *argv[])
         return EXIT_SUCCESS;
     }
 
+    if(headless)
+    {
+        // nobody could interact with the window
+        return EXIT_SUCCESS;
+    }
     return app.exec();
 }
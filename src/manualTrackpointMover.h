@@ -32,6 +32,7 @@ public:
         const FrameRange    &range);
     void moveTrackPoint(const QPointF &pos, PersonStorage &personStore) const;
     void setTrackPoint();
+    int  getSelectedPerson() const { return mSelectedPerson.personID; }
 
 private:
     PersonFrame mSelectedPerson = PersonFrame{-1, -1};
@@ -27,6 +27,37 @@
 #include "petrack.h"
 #include "roiItem.h"
 #include "stereoWidget.h"
+#include "trajectoryGeometry.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <opencv2/core/utility.hpp>
+
+namespace
+{
+/**
+ * @brief Calls process(i) for all persons in parallel on the threads of OpenCV
+ *
+ * process must only change the person i; the columns of the persons are detached from
+ * the undo snapshot independently, so this is safe after onManualAction.
+ */
+template <typename Process>
+void forEachPersonParallel(std::size_t count, Process &&process)
+{
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(count)),
+        [&process](const cv::Range &range)
+        {
+            for(int i = range.start; i < range.end; ++i)
+            {
+                process(static_cast<std::size_t>(i));
+            }
+        });
+}
+} // namespace
 
 /**
  * @brief split trajectorie pers before frame frame
@@ -35,13 +66,21 @@
  */
 void PersonStorage::splitPerson(size_t pers, int frame)
 {
-    onManualAction();
+    onManualAction({pers});
+    splitTrajectory(pers, frame);
+}
 
+/**
+ * @brief Splits the trajectory pers before frame without adding an undo step
+ */
+void PersonStorage::splitTrajectory(size_t pers, int frame)
+{
     {
         const QSignalBlocker blocker(this);
         if(mPersons.at(pers).firstFrame() < frame)
         {
             mPersons.push_back(mPersons.at(pers));
+            indexActivePerson(mPersons.size() - 1);
 
             // alte trj einkuerzen und ab aktuellem frame zukunft loeschen
             deletePersonFrameRange(pers, frame, mPersons[pers].lastFrame());
@@ -66,21 +105,13 @@ void PersonStorage::splitPerson(size_t pers, int frame)
  */
 bool PersonStorage::splitPersonAt(const Vec2F &point, int frame, const QSet<size_t> &onlyVisible)
 {
-    onManualAction();
-
-    for(size_t i = 0; i < mPersons.size(); ++i)
-    { // ueber TrackPerson
-        if(((onlyVisible.empty()) || (onlyVisible.contains(i))) &&
-           (mPersons.at(i).trackPointExist(frame) &&
-            (mPersons.at(i).trackPointAt(frame).distanceToPoint(point) <
-             mMainWindow.getHeadSize(nullptr, static_cast<int>(i), frame) / 2.)))
-        {
-            splitPerson(i, frame);
-
-            return true;
-        }
+    const auto hits = personsAt(point, frame, onlyVisible);
+    if(hits.empty())
+    {
+        return false;
     }
-    return false;
+    splitPerson(hits.front(), frame);
+    return true;
 }
 
 
@@ -93,7 +124,7 @@ bool PersonStorage::splitPersonAt(const Vec2F &point, int frame, const QSet<size
  */
 bool PersonStorage::delPointOf(int pers, TrajectorySegment direction, int frame)
 {
-    onManualAction();
+    onManualAction({static_cast<size_t>(pers)});
 
     if(direction == TrajectorySegment::Previous)
     {
@@ -111,6 +142,31 @@ bool PersonStorage::delPointOf(int pers, TrajectorySegment direction, int frame)
 }
 
 
+/**
+ * @brief Deletes the whole trajectories of persons at once
+ *
+ * @param persons indices of the persons; duplicates are ignored
+ */
+void PersonStorage::delPersons(const std::vector<size_t> &persons)
+{
+    if(persons.empty())
+    {
+        return;
+    }
+    onManualAction(persons);
+
+    std::vector<bool> toDelete(mPersons.size(), false);
+    for(size_t person : persons)
+    {
+        if(person < toDelete.size())
+        {
+            toDelete[person] = true;
+        }
+    }
+    deletePersons(toDelete);
+}
+
+
 /**
  * @brief Deletes points of a SINGLE person in onlyVisible
  * @param point point which need to be on the person (helpful if onlyVisible is not properly set)
@@ -125,19 +181,13 @@ bool PersonStorage::delPoint(
     int                 frame,
     const QSet<size_t> &onlyVisible)
 {
-    onManualAction();
-
-    for(int i = 0; i < static_cast<int>(mPersons.size()); ++i)
-    { // ueber TrackPerson
-        if(((onlyVisible.empty()) || (onlyVisible.contains(i))) &&
-           (mPersons.at(i).trackPointExist(frame) && (mPersons.at(i).trackPointAt(frame).distanceToPoint(point) <
-                                                      mMainWindow.getHeadSize(nullptr, i, frame) / 2.)))
-        {
-            delPointOf(i, direction, frame);
-            return true;
-        }
+    const auto hits = personsAt(point, frame, onlyVisible);
+    if(hits.empty())
+    {
+        return false;
     }
-    return false;
+    delPointOf(static_cast<int>(hits.front()), direction, frame);
+    return true;
 }
 
 
@@ -150,6 +200,7 @@ void PersonStorage::delPointAll(TrajectorySegment direction, int frame)
 {
     onManualAction();
 
+    std::vector<bool> toDelete(mPersons.size(), false);
     for(size_t i = 0; i < mPersons.size(); ++i) // ueber TrackPerson
     {
         if(mPersons.at(i).trackPointExist(frame))
@@ -160,7 +211,7 @@ void PersonStorage::delPointAll(TrajectorySegment direction, int frame)
                     deletePersonFrameRange(i, mPersons[i].firstFrame(), frame - 1);
                     break;
                 case TrajectorySegment::Whole:
-                    deletePerson(i--); // after deleting the person decrease i by one
+                    toDelete[i] = true;
                     break;
                 case TrajectorySegment::Following:
                     deletePersonFrameRange(i, frame + 1, mPersons[i].lastFrame());
@@ -172,9 +223,10 @@ void PersonStorage::delPointAll(TrajectorySegment direction, int frame)
             (direction == TrajectorySegment::Whole) ||
             ((direction == TrajectorySegment::Following) && (frame < mPersons.at(i).firstFrame())))
         {
-            deletePerson(i--); // after deleting the person decrease i by one
+            toDelete[i] = true;
         }
     }
+    deletePersons(toDelete);
 }
 
 
@@ -187,8 +239,9 @@ void PersonStorage::delPointInsideROI()
 {
     onManualAction();
 
-    QRectF rect = mMainWindow.getRecoRoiItem()->rect();
-    bool   inside;
+    QRectF            rect = mMainWindow.getRecoRoiItem()->rect();
+    bool              inside;
+    std::vector<bool> toDelete; // grows with the persons appended by splitting
 
     for(size_t i = 0; i < mPersons.size(); ++i) // ueber TrackPerson
     {
@@ -197,21 +250,18 @@ void PersonStorage::delPointInsideROI()
         {
             if(inside != rect.contains(mPersons.at(i).at(j).x(), mPersons.at(i).at(j).y())) // aenderung von inside
             {
-                splitPerson(i, mPersons.at(i).firstFrame() + j);
-                if(inside)
-                {
-                    deletePerson(i--); // after deleting the person decrease i by one
-                    inside = !inside;
-                }
+                // the second part is appended and checked on its own later on
+                splitTrajectory(i, mPersons.at(i).firstFrame() + j);
                 break;
             }
         }
         if(inside)
         {
-            // rest loeschen
-            deletePerson(i--); // after deleting the person decrease i by one
+            toDelete.resize(mPersons.size(), false);
+            toDelete[i] = true;
         }
     }
+    deletePersons(toDelete);
 }
 
 
@@ -222,8 +272,9 @@ void PersonStorage::delPointROI()
 {
     onManualAction();
 
-    int    anz  = 0;
-    QRectF rect = mMainWindow.getRecoRoiItem()->rect();
+    int               anz  = 0;
+    QRectF            rect = mMainWindow.getRecoRoiItem()->rect();
+    std::vector<bool> toDelete(mPersons.size(), false);
 
     for(size_t i = 0; i < mPersons.size(); ++i) // ueber TrackPerson
     {
@@ -232,11 +283,12 @@ void PersonStorage::delPointROI()
             if(rect.contains(mPersons.at(i).at(j).x(), mPersons.at(i).at(j).y()))
             {
                 anz++;
-                deletePerson(i--); // after deleting the person decrease i by one
+                toDelete[i] = true;
                 break;
             }
         }
     }
+    deletePersons(toDelete);
     SPDLOG_INFO("deleted {} trajectories!", anz);
 }
 
@@ -254,48 +306,41 @@ void PersonStorage::delPointROI()
  */
 bool PersonStorage::editTrackPersonComment(const Vec2F &point, int frame, const QSet<size_t> &onlyVisible)
 {
-    onManualAction();
-
-    for(int i = 0; i < static_cast<int>(mPersons.size()); ++i) // ueber TrackPerson
+    for(const size_t i : personsAt(point, frame, onlyVisible))
     {
-        if(((onlyVisible.empty()) || (onlyVisible.contains(i))) &&
-           (mPersons.at(i).trackPointExist(frame) &&
-            (mPersons.at(i).trackPointAt(frame).distanceToPoint(point) <
-             mMainWindow.getHeadSize(nullptr, i, frame) / 2.))) // war: MIN_DISTANCE)) // 30 ist abstand zwischen kopfen
-        {
-            QString displayedComment = mPersons.at(i).comment();
-            QString framePrefix      = "Frame " + QString::number(frame, 'g', 5) + ": ";
+        QString displayedComment = mPersons.at(i).comment();
+        QString framePrefix      = "Frame " + QString::number(frame, 'g', 5) + ": ";
 
-            if(displayedComment.isEmpty())
-            {
-                displayedComment.append(framePrefix);
-            }
-            else if(!displayedComment.contains(framePrefix))
-            {
-                displayedComment.append("\n" + framePrefix);
-            }
+        if(displayedComment.isEmpty())
+        {
+            displayedComment.append(framePrefix);
+        }
+        else if(!displayedComment.contains(framePrefix))
+        {
+            displayedComment.append("\n" + framePrefix);
+        }
 
-            bool    ok      = false;
-            QString comment = QInputDialog::getMultiLineText(
-                &mMainWindow, QObject::tr("Add Comment"), QObject::tr("Comment:"), displayedComment, &ok);
+        bool    ok      = false;
+        QString comment = QInputDialog::getMultiLineText(
+            &mMainWindow, QObject::tr("Add Comment"), QObject::tr("Comment:"), displayedComment, &ok);
 
-            if(ok)
+        if(ok)
+        {
+            if(comment.isEmpty())
             {
-                if(comment.isEmpty())
+                int ret = PWarning(
+                    &mMainWindow,
+                    QObject::tr("Empty comment"),
+                    QObject::tr("Are you sure you want to save an empty comment?"),
+                    PMessageBox::StandardButton::Save | PMessageBox::StandardButton::Cancel);
+                if(ret == PMessageBox::StandardButton::Cancel)
                 {
-                    int ret = PWarning(
-                        &mMainWindow,
-                        QObject::tr("Empty comment"),
-                        QObject::tr("Are you sure you want to save an empty comment?"),
-                        PMessageBox::StandardButton::Save | PMessageBox::StandardButton::Cancel);
-                    if(ret == PMessageBox::StandardButton::Cancel)
-                    {
-                        return false;
-                    }
+                    return false;
                 }
-                mPersons[i].setComment(comment);
-                return true;
             }
+            onManualAction({i});
+            mPersons[i].setComment(comment);
+            return true;
         }
     }
     return false;
@@ -310,58 +355,51 @@ bool PersonStorage::editTrackPersonComment(const Vec2F &point, int frame, const
  */
 bool PersonStorage::setTrackPersonHeight(const Vec2F &point, int frame, const QSet<size_t> &onlyVisible)
 {
-    onManualAction();
-
-    for(int i = 0; i < static_cast<int>(mPersons.size()); ++i) // ueber TrackPerson
+    for(const size_t i : personsAt(point, frame, onlyVisible))
     {
-        if(((onlyVisible.empty()) || (onlyVisible.contains(i))) &&
-           (mPersons.at(i).trackPointExist(frame) &&
-            (mPersons.at(i).trackPointAt(frame).distanceToPoint(point) <
-             mMainWindow.getHeadSize(nullptr, i, frame) / 2.))) // war: MIN_DISTANCE)) // 30 ist abstand zwischen kopfen
+        bool ok;
+
+        double col_height;
+        // col_height is negative, if height is determined through color and not yet set manually
+        if(mPersons.at(i).height() < MIN_HEIGHT + 1)
         {
-            bool ok;
+            col_height = mPersons.at(i).color().isValid() ?
+                             -mMainWindow.getControlWidget()->getColorPlot()->map(mPersons.at(i).color()) :
+                             -mMainWindow.getControlWidget()->getDefaultHeight();
+        }
+        else
+        {
+            col_height = mPersons.at(i).height();
+        }
 
-            double col_height;
-            // col_height is negative, if height is determined through color and not yet set manually
-            if(mPersons.at(i).height() < MIN_HEIGHT + 1)
+
+        double height = QInputDialog::getDouble(
+            &mMainWindow,
+            QObject::tr("Set person height"),
+            QObject::tr("Person height[cm]:"),
+            fabs(col_height),
+            -500,
+            500,
+            1,
+            &ok);
+        if(ok)
+        {
+            if(height < 0)
             {
-                col_height = mPersons.at(i).color().isValid() ?
-                                 -mMainWindow.getControlWidget()->getColorPlot()->map(mPersons.at(i).color()) :
-                                 -mMainWindow.getControlWidget()->getDefaultHeight();
+                SPDLOG_WARN("you entered a negative height!");
             }
-            else
+            // if previous value (col_height) is negative, height was determined thru color. If manually set value
+            // is the color-map value, we do not change anything
+            // @todo: @ar.graf: check if manually set values have side-effects (maybe do not show in statistics)
+            if(!(std::abs(col_height + height) < 0.01))
             {
-                col_height = mPersons.at(i).height();
+                onManualAction({i});
+                mPersons[i].setHeight(height);
+                return true;
             }
-
-
-            double height = QInputDialog::getDouble(
-                &mMainWindow,
-                QObject::tr("Set person height"),
-                QObject::tr("Person height[cm]:"),
-                fabs(col_height),
-                -500,
-                500,
-                1,
-                &ok);
-            if(ok)
+            else
             {
-                if(height < 0)
-                {
-                    SPDLOG_WARN("you entered a negative height!");
-                }
-                // if previous value (col_height) is negative, height was determined thru color. If manually set value
-                // is the color-map value, we do not change anything
-                // @todo: @ar.graf: check if manually set values have side-effects (maybe do not show in statistics)
-                if(!(std::abs(col_height + height) < 0.01))
-                {
-                    mPersons[i].setHeight(height);
-                    return true;
-                }
-                else
-                {
-                    SPDLOG_INFO("No height change detected. Color-mapped height will remain set.");
-                }
+                SPDLOG_INFO("No height change detected. Color-mapped height will remain set.");
             }
         }
     }
@@ -377,20 +415,14 @@ bool PersonStorage::setTrackPersonHeight(const Vec2F &point, int frame, const QS
  */
 bool PersonStorage::resetTrackPersonHeight(const Vec2F &point, int frame, const QSet<size_t> &onlyVisible)
 {
-    onManualAction();
-
-    for(int i = 0; i < static_cast<int>(mPersons.size()); ++i) // ueber TrackPerson
+    const auto hits = personsAt(point, frame, onlyVisible);
+    if(hits.empty())
     {
-        if(((onlyVisible.empty()) || (onlyVisible.contains(i))) &&
-           (mPersons.at(i).trackPointExist(frame) &&
-            (mPersons.at(i).trackPointAt(frame).distanceToPoint(point) <
-             mMainWindow.getHeadSize(nullptr, i, frame) / 2.))) // war: MIN_DISTANCE)) // 30 ist abstand zwischen kopfen
-        {
-            mPersons[i].setHeight(MIN_HEIGHT);
-            return true;
-        }
+        return false;
     }
-    return false;
+    onManualAction({hits.front()});
+    mPersons[hits.front()].setHeight(MIN_HEIGHT);
+    return true;
 }
 
 void PersonStorage::moveTrackPoint(int personID, int frame, const Vec2F &newPosition)
@@ -415,38 +447,37 @@ void PersonStorage::moveTrackPoint(int personID, int frame, const Vec2F &newPosi
 // returns number of found points or -1 if no stereoContext available (also points without disp found are counted)
 int PersonStorage::calcPosition(int frame)
 {
-    int                 anz = 0;
-    pet::StereoContext *sc  = mMainWindow.getStereoContext();
-    float               x, y, z;
+    pet::StereoContext *sc = mMainWindow.getStereoContext();
 
     if(sc)
     {
         // for every point of a person, which has already identified at this frame
-        for(auto &person : mPersons) // ueber TrackPerson
+        const auto             persons = activePersons(frame);
+        std::vector<cv::Point> points;
+        points.reserve(persons.size());
+        for(size_t i : persons) // ueber TrackPerson
+        {
+            //  ACHTUNG: BORDER NICHT BEACHTET bei p.x()...???
+            //  nicht myRound, da pixel 0 von 0..0.99 in double geht
+            const TrackPoint &point = mPersons[i].trackPointAt(frame);
+            points.emplace_back((int) point.x(), (int) point.y());
+        }
+
+        // calculate height with disparity map
+        const auto xyz = sc->getMedianXYZaround(points);
+        for(size_t k = 0; k < persons.size(); ++k)
         {
-            if(person.trackPointExist(frame))
+            // hier kommt man nur hinein, wenn x, y, z Wert berechnet werden konnten
+            if(xyz[k])
             {
-                ++anz;
-
-                // TrackPoint *point = &(at(i).trackPointAt(frame));
-                //  ACHTUNG: BORDER NICHT BEACHTET bei p.x()...???
-                //  calculate height with disparity map
-                if(sc->getMedianXYZaround(
-                       (int) person.trackPointAt(frame).x(),
-                       (int) person.trackPointAt(frame).y(),
-                       &x,
-                       &y,
-                       &z)) // nicht myRound, da pixel 0 von 0..0.99 in double geht
-                {
-                    // hier kommt man nur hinein, wenn x, y, z Wert berechnet werden konnten
-                    // statt altitude koennte hier irgendwann die berechnete Bodenhoehe einfliessen
-                    person.updateStereoPoint(frame, {x, y, z}); // setZdistanceToCam(z);
-                    person.setHeight(z, mMainWindow.getControlWidget()->getCameraAltitude());
-                }
+                auto &person = mPersons[persons[k]];
+                // statt altitude koennte hier irgendwann die berechnete Bodenhoehe einfliessen
+                person.updateStereoPoint(frame, {xyz[k]->x, xyz[k]->y, xyz[k]->z}); // setZdistanceToCam(z);
+                person.setHeight(xyz[k]->z, mMainWindow.getControlWidget()->getCameraAltitude());
             }
         }
 
-        return anz;
+        return static_cast<int>(persons.size());
     }
     else
         return -1;
@@ -472,6 +503,8 @@ int PersonStorage::calcPosition(int frame)
  * @param[in] frame current frame (frame in which point was detected)
  * @param[in] onlyVisible set of selected persons, see Petrack::getPedestriansToTrack()
  * @param[out] pers person the point was added to; undefined when new trajectory was created
+ * @param[in,out] grid optional grid of the track points in frame (see buildPointGrid()) limiting the
+ * persons which are tested; it is updated with the inserted point
  * @return true if new trajectory was created; false otherwise
  */
 bool PersonStorage::addPoint(
@@ -479,15 +512,13 @@ bool PersonStorage::addPoint(
     int                     frame,
     const QSet<size_t>     &onlyVisible,
     reco::RecognitionMethod method,
-    int                    *pers)
+    int                    *pers,
+    TrackPointGrid         *grid)
 {
-    if(point.qual() > 100)
-    {
-        // manually added point
-        onManualAction();
-    }
+    const bool manual = point.qual() > 100; // manually added point
+
     bool  found = false;
-    int   i, iNearest = 0.;
+    int   iNearest = 0.;
     float scaleHead;
     float dist, minDist = 1000000.;
     float z = -1;
@@ -525,8 +556,33 @@ bool PersonStorage::addPoint(
         scaleHead = 1.0f;
     }
 
-    for(i = 0; i < static_cast<int>(mPersons.size()); ++i) // !found &&  // ueber TrackPerson
+    // only persons near the point can fulfill the distance conditions below
+    std::vector<size_t> candidates;
+    if(grid)
+    {
+        candidates = grid->query(point, scaleHead * grid->maxHeadSize() / 2.);
+        if(multiColorWithDot && point.color().isValid())
+        {
+            const auto          colCandidates = grid->query(point.colPoint(), grid->maxHeadSize() / 2.);
+            std::vector<size_t> allCandidates;
+            std::set_union(
+                candidates.begin(),
+                candidates.end(),
+                colCandidates.begin(),
+                colCandidates.end(),
+                std::back_inserter(allCandidates));
+            candidates = std::move(allCandidates);
+        }
+    }
+    else
+    {
+        candidates.resize(mPersons.size());
+        std::iota(candidates.begin(), candidates.end(), 0);
+    }
+
+    for(size_t candidate : candidates) // !found &&  // ueber TrackPerson
     {
+        const int i = static_cast<int>(candidate);
         if(((onlyVisible.empty()) || (onlyVisible.contains(i))) && mPersons.at(i).trackPointExist(frame))
         {
             dist = mPersons.at(i).trackPointAt(frame).distanceToPoint(point);
@@ -540,10 +596,16 @@ bool PersonStorage::addPoint(
             {
                 if(found)
                 {
-                    SPDLOG_WARN("multiple possible TrackPoints for point");
-                    SPDLOG_WARN("         {} in frame {} with low distance:", point, frame);
-                    SPDLOG_WARN("         person {} (distance: {})", i + 1, dist);
-                    SPDLOG_WARN("         person {} (distance: {})", iNearest + 1, minDist);
+                    ++mAmbiguousMatches;
+                    LOG_WARN_LIMITED(
+                        "multiple possible TrackPoints for point {} in frame {} with low distance: person {} "
+                        "(distance: {}), person {} (distance: {})",
+                        point,
+                        frame,
+                        i + 1,
+                        dist,
+                        iNearest + 1,
+                        minDist);
                     if(minDist > dist)
                     {
                         minDist  = dist;
@@ -559,6 +621,16 @@ bool PersonStorage::addPoint(
             }
         }
     }
+    if(manual && found)
+    {
+        onManualAction({static_cast<size_t>(iNearest)});
+    }
+    else if(manual && onlyVisible.empty())
+    {
+        // only a new person is added
+        onManualAction(std::vector<size_t>{});
+    }
+
     if(found) // den naechstgelegenen nehmen
     {
         // test, if recognition point or tracked point is better is made in at(i).insertAtFrame
@@ -584,6 +656,8 @@ bool PersonStorage::addPoint(
             }
         }
 
+        indexActivePerson(iNearest);
+
         if(pers != nullptr)
         {
             *pers = iNearest;
@@ -602,11 +676,16 @@ bool PersonStorage::addPoint(
         }
         mPersons.push_back(TrackPerson(
             0, frame, point, point.getMarkerID())); // 0 is person number/markerID; newReco is set to true by default
+        indexActivePerson(iNearest);
     }
     if((z > 0) && ((onlyVisible.empty()) || found))
     {
         mPersons[iNearest].setHeight(z, mMainWindow.getControlWidget()->getCameraAltitude()); // , frame
     }
+    if(grid && ((onlyVisible.empty()) || found))
+    {
+        updatePointGrid(*grid, iNearest, frame);
+    }
     if((!onlyVisible.empty()) && !found)
     {
         QMessageBox::warning(
@@ -619,10 +698,8 @@ bool PersonStorage::addPoint(
         return false;
     }
 
-    if(found)
-    {
-        emit changedPerson(iNearest);
-    }
+    // also a new person, e.g. for the plausibility checks while tracking
+    emit changedPerson(iNearest);
     return !found;
 }
 
@@ -646,19 +723,219 @@ void PersonStorage::addPoints(QList<TrackPoint> &pL, int frame, reco::Recognitio
     }
 
     // ueberprufen ob identisch mit einem Punkt in liste
+    TrackPointGrid grid = buildPointGrid(frame);
+    mAmbiguousMatches   = 0;
     for(auto &point : pL) // ueber PointList
     {
-        addPoint(point, frame, QSet<size_t>(), method);
+        addPoint(point, frame, QSet<size_t>(), method, nullptr, &grid);
+    }
+    if(mAmbiguousMatches > 0)
+    {
+        SPDLOG_WARN(
+            "{} recognized points in frame {} were close to several trajectories and added to the nearest one.",
+            mAmbiguousMatches,
+            frame);
+    }
+}
+
+/**
+ * @brief Builds a grid of the track points of all persons in frame
+ *
+ * @see TrackPointGrid
+ * @param frame frame of the track points
+ * @return grid for nearest trajectory lookups in frame
+ */
+TrackPointGrid PersonStorage::buildPointGrid(int frame) const
+{
+    TrackPointGrid grid(mMainWindow.getHeadSize());
+    for(size_t i : activePersons(frame))
+    {
+        updatePointGrid(grid, i, frame);
+    }
+    return grid;
+}
+
+/**
+ * @brief Updates the entry of person in grid after its track point in frame changed
+ *
+ * @param grid grid of frame
+ * @param person index of the person
+ * @param frame frame of the grid
+ */
+void PersonStorage::updatePointGrid(TrackPointGrid &grid, size_t person, int frame) const
+{
+    const auto &trackPerson = mPersons.at(person);
+    if(trackPerson.trackPointExist(frame))
+    {
+        const double headSize = mMainWindow.getHeadSize(nullptr, static_cast<int>(person), frame);
+        grid.set(person, trackPerson.trackPointAt(frame), headSize);
+    }
+    else
+    {
+        grid.remove(person);
     }
 }
 
 /// Number of visible (TrackPoint exists in current frame) people
 int PersonStorage::visible(int frameNum) const
 {
-    return static_cast<int>(std::count_if(
-        mPersons.begin(),
-        mPersons.end(),
-        [frameNum](const TrackPerson &pers) { return pers.trackPointExist(frameNum); }));
+    return static_cast<int>(activePersons(frameNum).size());
+}
+
+void PersonStorage::addPerson(const TrackPerson &person)
+{
+    mPersons.push_back(person);
+    indexActivePerson(mPersons.size() - 1);
+}
+
+/**
+ * @brief Returns the persons having a TrackPoint in frame
+ *
+ * The persons are looked up in an index of blocks of frames, so per-frame operations
+ * scale with the number of persons around this frame instead of all persons. The
+ * index is kept in sync by all methods modifying the persons and rebuilt lazily
+ * after persons were deleted or replaced (not thread-safe).
+ *
+ * @param frame frame to get the persons for
+ * @return indices of the persons in ascending order
+ */
+std::vector<size_t> PersonStorage::activePersons(int frame) const
+{
+    std::vector<size_t> persons;
+    activePersons(frame, persons);
+    return persons;
+}
+
+/**
+ * @brief Like activePersons(int), but reuses the memory of persons, e.g. for each frame of the tracking
+ *
+ * @param frame frame to get the persons for
+ * @param persons[out] indices of the persons in ascending order
+ */
+void PersonStorage::activePersons(int frame, std::vector<size_t> &persons) const
+{
+    if(!mActivePersonsValid)
+    {
+        buildActivePersons();
+    }
+
+    persons.clear();
+    const size_t block = std::max(frame, 0) / ACTIVE_PERSONS_BLOCK_SIZE;
+    if(block < mActivePersons.size())
+    {
+        for(size_t person : mActivePersons[block])
+        {
+            if(mPersons[person].trackPointExist(frame))
+            {
+                persons.push_back(person);
+            }
+        }
+        // persons extended into the block later are appended
+        std::sort(persons.begin(), persons.end());
+    }
+}
+
+/**
+ * @brief Returns the persons having a TrackPoint in any frame from first to last
+ *
+ * Like activePersons(int), but only tests the frame range of the persons, not the
+ * single TrackPoints (a person may have no TrackPoint in a gap of its trajectory).
+ *
+ * @return indices of the persons in ascending order
+ */
+std::vector<size_t> PersonStorage::activePersons(int first, int last) const
+{
+    if(!mActivePersonsValid)
+    {
+        buildActivePersons();
+    }
+
+    std::vector<size_t> persons;
+    const size_t        firstBlock = std::max(first, 0) / ACTIVE_PERSONS_BLOCK_SIZE;
+    const size_t        lastBlock  = std::max(last, 0) / ACTIVE_PERSONS_BLOCK_SIZE;
+    for(size_t block = firstBlock; block <= lastBlock && block < mActivePersons.size(); ++block)
+    {
+        for(size_t person : mActivePersons[block])
+        {
+            const auto &trackPerson = mPersons[person];
+            if(!trackPerson.isEmpty() && trackPerson.firstFrame() <= last && trackPerson.lastFrame() >= first)
+            {
+                persons.push_back(person);
+            }
+        }
+    }
+    // persons spanning several blocks are listed in each of them
+    std::sort(persons.begin(), persons.end());
+    persons.erase(std::unique(persons.begin(), persons.end()), persons.end());
+    return persons;
+}
+
+void PersonStorage::buildActivePersons() const
+{
+    mActivePersons.clear();
+    mIndexedFrames.clear();
+    mActivePersonsValid = true;
+    for(size_t i = 0; i < mPersons.size(); ++i)
+    {
+        indexActivePerson(i);
+    }
+}
+
+/**
+ * @brief Adds the (new or extended) frame range of person to the index of active persons
+ *
+ * Shrinking frame ranges are not removed, activePersons() filters them. Deleting or
+ * reordering persons has to invalidate the index instead.
+ *
+ * @param person index of the person whose frame range was set or extended
+ */
+void PersonStorage::indexActivePerson(size_t person) const
+{
+    if(!mActivePersonsValid)
+    {
+        return;
+    }
+    if(person > mIndexedFrames.size())
+    {
+        mActivePersonsValid = false;
+        return;
+    }
+
+    const auto &trackPerson = mPersons[person];
+    const int   first       = std::max(trackPerson.firstFrame(), 0) / ACTIVE_PERSONS_BLOCK_SIZE;
+    const int   last        = std::max(trackPerson.lastFrame(), 0) / ACTIVE_PERSONS_BLOCK_SIZE;
+    if(static_cast<size_t>(last) >= mActivePersons.size())
+    {
+        mActivePersons.resize(last + 1);
+    }
+
+    if(person == mIndexedFrames.size())
+    {
+        mIndexedFrames.emplace_back(first, last);
+        for(int block = first; block <= last; ++block)
+        {
+            mActivePersons[block].push_back(person);
+        }
+        return;
+    }
+
+    auto &[indexedFirst, indexedLast] = mIndexedFrames[person];
+    if(first > indexedLast + 1 || last < indexedFirst - 1)
+    {
+        // the ranges would not be continuous anymore
+        mActivePersonsValid = false;
+        return;
+    }
+    for(int block = first; block < indexedFirst; ++block)
+    {
+        mActivePersons[block].push_back(person);
+    }
+    for(int block = indexedLast + 1; block <= last; ++block)
+    {
+        mActivePersons[block].push_back(person);
+    }
+    indexedFirst = std::min(indexedFirst, first);
+    indexedLast  = std::max(indexedLast, last);
 }
 
 /// Returns the largest first frame of **all** TrackPersons
@@ -714,38 +991,63 @@ std::vector<PersonFrame>
 PersonStorage::getProximalPersons(const QPointF &pos, QSet<size_t> selected, const FrameRange &frameRange) const
 {
     std::vector<PersonFrame> result;
-    for(int i = 0; i < static_cast<int>(mPersons.size()); ++i)
+
+    const int first = frameRange.current - frameRange.before;
+    const int last  = frameRange.current + frameRange.after;
+    for(size_t person : activePersons(first, last))
     {
-        if(!selected.empty() && !selected.contains(i))
+        if(!selected.empty() && !selected.contains(person))
         {
             continue;
         }
 
-        double minDist  = std::numeric_limits<double>::max();
-        int    minFrame = -1;
-        for(int f = frameRange.current - frameRange.before; f <= frameRange.current + frameRange.after; ++f)
-        {
-            if(!mPersons[i].trackPointExist(f))
-            {
-                continue;
-            }
-            auto dist = mPersons[i].trackPointAt(f).distanceToPoint(pos);
-            if(dist < minDist && dist < (mMainWindow.getHeadSize(nullptr, i, frameRange.current) / 2.))
-            {
-                minDist  = dist;
-                minFrame = f;
-            }
-        }
-        if(minFrame == -1)
+        const auto &trackPerson = mPersons[person];
+        const auto &columns     = trackPerson.columns();
+        const int   from        = std::max(first, trackPerson.firstFrame());
+        const int   offset      = from - trackPerson.firstFrame();
+        const int   count       = std::min(last, trackPerson.lastFrame()) - from + 1;
+
+        double    minDist = std::numeric_limits<double>::max();
+        const int nearest = geometry::nearest(columns.xData() + offset, columns.yData() + offset, count, pos, &minDist);
+
+        const int minFrame = nearest < 0 ? -1 : from + nearest;
+
+        // the head size does not depend on the frame, so it is only needed for the nearest point
+        const int i = static_cast<int>(person);
+        if(minFrame != -1 && minDist < mMainWindow.getHeadSize(nullptr, i, frameRange.current) / 2.)
         {
-            continue;
+            result.push_back({i, minFrame});
         }
-        result.push_back({i, minFrame});
     }
 
     return result;
 }
 
+/**
+ * @brief Returns the persons whose TrackPoint in frame is within half their head size of point
+ *
+ * Only the persons active in frame are tested, see activePersons().
+ *
+ * @param point position to test, e.g. the position of a click
+ * @param frame frame of the TrackPoints
+ * @param onlyVisible persons to test (empty means everyone)
+ * @return indices of the persons in ascending order
+ */
+std::vector<size_t> PersonStorage::personsAt(const Vec2F &point, int frame, const QSet<size_t> &onlyVisible) const
+{
+    std::vector<size_t> persons;
+    for(size_t i : activePersons(frame))
+    {
+        if((onlyVisible.empty() || onlyVisible.contains(i)) &&
+           mPersons[i].trackPointAt(frame).distanceToPoint(point) <
+               mMainWindow.getHeadSize(nullptr, static_cast<int>(i), frame) / 2.)
+        {
+            persons.push_back(i);
+        }
+    }
+    return persons;
+}
+
 
 /**
  * @brief Recalcs the height of all persons (used with stereo)
@@ -755,10 +1057,7 @@ void PersonStorage::recalcHeight(float altitude)
 {
     onManualAction();
 
-    for(auto &person : mPersons)
-    {
-        person.recalcHeight(altitude);
-    }
+    forEachPersonParallel(mPersons.size(), [this, altitude](std::size_t i) { mPersons[i].recalcHeight(altitude); });
 }
 
 /// optimize color for all persons
@@ -766,13 +1065,15 @@ void PersonStorage::optimizeColor()
 {
     onManualAction();
 
-    for(auto &person : mPersons)
-    {
-        if(person.color().isValid())
+    forEachPersonParallel(
+        mPersons.size(),
+        [this](std::size_t i)
         {
-            person.optimizeColor();
-        }
-    }
+            if(mPersons[i].color().isValid())
+            {
+                mPersons[i].optimizeColor();
+            }
+        });
 }
 
 /// reset the height of all persons, but not the pos of the trackpoints
@@ -780,10 +1081,7 @@ void PersonStorage::resetHeight()
 {
     onManualAction();
 
-    for(auto &person : mPersons)
-    {
-        person.resetHeight();
-    }
+    forEachPersonParallel(mPersons.size(), [this](std::size_t i) { mPersons[i].resetHeight(); });
 }
 
 /// reset the pos of the tzrackpoints, but not the heights
@@ -791,13 +1089,16 @@ void PersonStorage::resetPos()
 {
     onManualAction();
 
-    for(auto &person : mPersons)
-    {
-        for(int frame = person.firstFrame(); frame <= person.lastFrame(); ++frame)
+    forEachPersonParallel(
+        mPersons.size(),
+        [this](std::size_t i)
         {
-            person.updateStereoPoint(frame, {-1, -1, -1});
-        }
-    }
+            auto &person = mPersons[i];
+            for(int frame = person.firstFrame(); frame <= person.lastFrame(); ++frame)
+            {
+                person.updateStereoPoint(frame, {-1, -1, -1});
+            }
+        });
 }
 
 /**
@@ -864,26 +1165,42 @@ void PersonStorage::setMarkerHeights(const std::unordered_map<int, float> &heigh
 {
     onManualAction();
 
-    for(auto &person : mPersons) // over TrackPerson
-    {
-        for(const auto &point : person) // over TrackPoints
+    // per person the marker IDs missing in heights; logged afterwards in the order of the persons
+    std::vector<std::vector<int>> missing(mPersons.size());
+    forEachPersonParallel(
+        mPersons.size(),
+        [this, &heights, &missing](std::size_t i)
         {
-            // markerID of current person at current TrackPoint:
-            int markerID = point.getMarkerID();
-
-            if(markerID != -1) // when a real markerID is found (not -1)
+            auto &person     = mPersons[i];
+            int   lastMarker = -1;
+            for(int j = 0; j < person.size(); ++j) // over TrackPoints
             {
-                // find index of mID within List of MarkerIDs that were read from txt-file:
-                if(heights.find(markerID) != std::end(heights))
-                {
-                    person.setHeight(heights.at(markerID));
-                }
-                else
+                // markerID of current person at current TrackPoint:
+                int markerID = person.columns().markerID(j);
+
+                // a person mostly keeps its markerID, so it is only looked up when it changes
+                if(markerID != -1 && markerID != lastMarker) // when a real markerID is found (not -1)
                 {
-                    SPDLOG_WARN("The following markerID was not part of the height-file: {}", markerID);
-                    SPDLOG_WARN("No height set for personNR: {}", person.nr());
+                    lastMarker = markerID;
+                    // find index of mID within List of MarkerIDs that were read from txt-file:
+                    if(const auto height = heights.find(markerID); height != std::end(heights))
+                    {
+                        person.setHeight(height->second);
+                    }
+                    else
+                    {
+                        missing[i].push_back(markerID);
+                    }
                 }
             }
+        });
+
+    for(std::size_t i = 0; i < mPersons.size(); ++i)
+    {
+        for(int markerID : missing[i])
+        {
+            SPDLOG_WARN("The following markerID was not part of the height-file: {}", markerID);
+            SPDLOG_WARN("No height set for personNR: {}", mPersons[i].nr());
         }
     }
 }
@@ -897,7 +1214,7 @@ void PersonStorage::setMarkerID(size_t personIndex, int markerID, bool manual)
 {
     if(manual)
     {
-        onManualAction();
+        onManualAction({personIndex});
     }
     auto &person = mPersons.at(personIndex);
     person.setMarkerID(markerID);
@@ -916,18 +1233,23 @@ void PersonStorage::setMarkerIDs(const std::unordered_map<int, int> &markerIDs)
 {
     onManualAction();
 
+    forEachPersonParallel(
+        mPersons.size(),
+        [this, &markerIDs](std::size_t i)
+        {
+            // personID of current person
+            const int personID = static_cast<int>(i) + 1;
+            if(const auto markerID = markerIDs.find(personID); markerID != std::end(markerIDs))
+            {
+                setMarkerID(i, markerID->second);
+            }
+        });
+
     for(int i = 0; i < static_cast<int>(mPersons.size()); ++i) // over TrackPerson
     {
-        // personID of current person
-        int personID = i + 1;
-        if(markerIDs.find(personID) != std::end(markerIDs))
+        if(markerIDs.find(i + 1) == std::end(markerIDs))
         {
-            int markerID = markerIDs.at(personID);
-            setMarkerID(i, markerID);
-        }
-        else
-        {
-            SPDLOG_WARN("The following personID was not part of the markerID-file: {}", personID);
+            SPDLOG_WARN("The following personID was not part of the markerID-file: {}", i + 1);
         }
     }
 }
@@ -947,8 +1269,9 @@ void PersonStorage::purge(int frame)
 {
     onManualAction();
 
-    int   i, j;
-    float count; ///< number of trackpoints without recognition
+    int               i, j;
+    float             count; ///< number of trackpoints without recognition
+    std::vector<bool> toDelete(mPersons.size(), false);
 
     for(i = 0; i < static_cast<int>(mPersons.size()); ++i)
     {
@@ -964,115 +1287,430 @@ void PersonStorage::purge(int frame)
             }
             if(count / mPersons.at(i).size() > 0.8) // Achtung, wenn roi klein, dann viele tp nur getrackt
             {
-                deletePerson(i--); // after deleting the person decrease i by one
+                toDelete[i] = true;
             }
         }
     }
+    deletePersons(toDelete);
+}
+
+/**
+ * @brief Returns the memory used by the trajectories in bytes, without the undo history
+ */
+std::size_t PersonStorage::memoryUsage() const
+{
+    return std::accumulate(
+        mPersons.begin(),
+        mPersons.end(),
+        (mPersons.capacity() - mPersons.size()) * sizeof(TrackPerson),
+        [](std::size_t sum, const TrackPerson &person) { return sum + person.memoryUsage(); });
 }
 
 void PersonStorage::undo()
 {
-    if(!mUndo.empty())
+    finishManualAction();
+    if(mUndo.empty())
+    {
+        return;
+    }
+    UndoStep step = std::move(mUndo.back());
+    mUndo.pop_back();
+    mUndoBytes -= step.bytes;
+
+    UndoStep inverse;
+    if(applyUndoStep(std::move(step), inverse))
     {
-        mRedo.push(std::move(mPersons));
-        mPersons = mUndo.pop();
+        pushRedo(std::move(inverse));
     }
 }
 
 void PersonStorage::redo()
 {
-    if(!mRedo.empty())
+    finishManualAction();
+    if(mRedo.empty())
     {
-        mUndo.push(std::move(mPersons));
-        mPersons = mRedo.pop();
+        return;
+    }
+    UndoStep step = std::move(mRedo.back());
+    mRedo.pop_back();
+    mRedoBytes -= step.bytes;
+
+    UndoStep inverse;
+    if(applyUndoStep(std::move(step), inverse))
+    {
+        pushUndo(std::move(inverse));
     }
 }
 
 /**
  * @brief This function is called on manual actions, i.e. non-tracking changes of trajectories
+ *
+ * The action may change any person; all persons are stored for undoing it.
  */
 void PersonStorage::onManualAction()
 {
+    std::vector<size_t> persons(mPersons.size());
+    std::iota(persons.begin(), persons.end(), 0);
+    onManualAction(persons);
+}
+
+/**
+ * @brief This function is called on manual actions, which only change the given persons
+ *
+ * Besides changing the given persons, the action may delete some of them and append
+ * new persons. Only the given persons are stored for undoing it; the changed state is
+ * taken over into the undo step when the next action starts or on undo/redo.
+ *
+ * @param persons indices of the persons changed by the action
+ */
+void PersonStorage::onManualAction(const std::vector<size_t> &persons)
+{
+    finishManualAction();
     mAutosave.trackPersonModified();
-    mUndo.push(mPersons);
     mRedo.clear();
+    mRedoBytes = 0;
+
+    mPendingAction = true;
+    mPendingAffected.assign(mPersons.size(), false);
+    for(size_t person : persons)
+    {
+        if(person < mPersons.size() && !mPendingAffected[person])
+        {
+            mPendingAffected[person] = true;
+            mPendingPersons.emplace_back(person, mPersons[person]);
+        }
+    }
+    std::sort(
+        mPendingPersons.begin(),
+        mPendingPersons.end(),
+        [](const auto &a, const auto &b) { return a.first < b.first; });
 }
 
 /**
- * @brief Smooths the height of a stereo point of a person
- * @param i index of person whose heights/z-coordinates to smooth
- * @param j index of the stereo point whose height to smooth
+ * @brief Completes the undo step of the pending manual action with the current state
+ */
+void PersonStorage::finishManualAction()
+{
+    if(!mPendingAction)
+    {
+        return;
+    }
+    UndoStep step;
+    step.insert = std::move(mPendingPersons);
+    for(size_t i = 0; i < mPersons.size(); ++i)
+    {
+        // persons behind mPendingAffected were added by the action
+        if(i >= mPendingAffected.size() || mPendingAffected[i])
+        {
+            step.remove.push_back(i);
+        }
+    }
+
+    mPendingAction = false;
+    mPendingPersons.clear();
+    mPendingAffected.clear();
+    pushUndo(std::move(step));
+}
+
+namespace
+{
+template <typename Step>
+std::size_t stepBytes(const Step &step)
+{
+    std::size_t bytes = sizeof(Step) + step.remove.size() * sizeof(size_t);
+    for(const auto &[index, person] : step.insert)
+    {
+        bytes += sizeof(index) + person.memoryUsage();
+    }
+    return bytes;
+}
+} // namespace
+
+void PersonStorage::pushUndo(UndoStep &&step)
+{
+    step.bytes = stepBytes(step);
+    mUndoBytes += step.bytes;
+    mUndo.push_back(std::move(step));
+    trimUndo();
+}
+
+void PersonStorage::pushRedo(UndoStep &&step)
+{
+    step.bytes = stepBytes(step);
+    mRedoBytes += step.bytes;
+    mRedo.push_back(std::move(step));
+}
+
+/// Drops the oldest undo steps, while they use more memory than allowed (but always keeps one)
+void PersonStorage::trimUndo()
+{
+    while(mUndoBytes > mUndoMemoryLimit && mUndo.size() > 1)
+    {
+        mUndoBytes -= mUndo.front().bytes;
+        mUndo.pop_front();
+    }
+}
+
+/**
+ * @brief Sets the memory the undo steps may use in bytes; older steps are dropped right away
+ *
+ * The last step is always kept, even if it alone is larger than bytes.
  */
-void PersonStorage::smoothHeight(size_t i, int j)
+void PersonStorage::setUndoMemoryLimit(std::size_t bytes)
 {
-    // ACHTUNG: Aenderungen in Originaltrajektorie, so dass aenderungen auf folgeuntersuchungen einfluss
-    // haben: j auf j+1
-    int  tsize      = mPersons[i].size();
-    auto firstFrame = mPersons[i].firstFrame();
+    mUndoMemoryLimit = bytes;
+    trimUndo();
+}
 
-    if(mPersons[i].at(j).sp().z() != -1)
+/**
+ * @brief Moves the points of the trajectories far from frame into the TrajectorySpillStore
+ *
+ * Trajectories ending (or starting, for backward tracking) more than the spill distance
+ * before (or after) frame take no part in the tracking and merging anymore. Their points
+ * are read from the memory-mapped file afterwards and copied back into memory, if they
+ * are edited. As checking all trajectories costs time, this is only done, when frame moved
+ * by a quarter of the spill distance since the last time. A spill distance of 0 disables it.
+ *
+ * @param frame frame just tracked
+ */
+void PersonStorage::spillFinished(int frame)
+{
+    if(mSpillDistance <= 0 || std::abs(frame - mLastSpillFrame) < std::max(mSpillDistance / 4, 1))
     {
-        int nrFor = 1; // anzahl der ztrackpoint ohne hoeheninfo
-        int nrRew = 1;
+        return;
+    }
+    mLastSpillFrame = frame;
 
-        // nach && wird nur ausgefuehrt, wenn erstes true == size() also nicht
-        while((j + nrFor < tsize) && (mPersons[i].at(j + nrFor).sp().z() < 0))
+    std::vector<TrackPointColumns *> finished;
+    for(auto &person : mPersons)
+    {
+        const bool far = person.lastFrame() < frame - mSpillDistance || person.firstFrame() > frame + mSpillDistance;
+        if(far && !person.columns().isMapped())
         {
-            nrFor++;
+            finished.push_back(&person.spillableColumns());
         }
+    }
+    if(!finished.empty() && mSpillStore.spill(finished))
+    {
+        SPDLOG_DEBUG("Spilled {} trajectories at frame {}.", finished.size(), frame);
+    }
+}
+
+/**
+ * @brief Compresses the points of the trajectories far from frame in memory
+ *
+ * Complements spillFinished() for trajectories, which should stay in memory: trajectories
+ * ending (or starting) more than the compress distance before (or after) frame are compressed
+ * (see TrackPointColumns::compress()) and decoded again, when they are read, e.g. for display
+ * or export. Of the trajectories decoded since, only the HOT_TRAJECTORIES read last stay
+ * decoded. As for spilling, this is only done, when frame moved by a quarter of the compress
+ * distance since the last time. A compress distance of 0 disables it.
+ *
+ * @param frame frame just tracked
+ */
+void PersonStorage::compressFinished(int frame)
+{
+    if(mCompressDistance <= 0 || std::abs(frame - mLastCompressFrame) < std::max(mCompressDistance / 4, 1))
+    {
+        return;
+    }
+    mLastCompressFrame = frame;
 
-        // nach && wird nur ausgefuehrt, wenn erstes true == size() also nicht
-        while((j - nrRew >= 0) && (mPersons[i].at(j - nrRew).sp().z() < 0))
+    int                                                        compressed = 0;
+    std::vector<std::pair<std::uint64_t, TrackPointColumns *>> decoded;
+    for(auto &person : mPersons)
+    {
+        if(person.lastFrame() >= frame - mCompressDistance && person.firstFrame() <= frame + mCompressDistance)
+        {
+            continue;
+        }
+        auto &columns = person.spillableColumns();
+        if(!columns.isCompressed())
         {
-            nrRew++;
+            columns.compress();
+            ++compressed;
         }
+        else if(const auto lastUse = columns.lastUse(); lastUse > 0)
+        {
+            decoded.emplace_back(lastUse, &columns);
+        }
+    }
+
+    if(decoded.size() > HOT_TRAJECTORIES)
+    {
+        const auto cold = decoded.begin() + HOT_TRAJECTORIES;
+        std::nth_element(decoded.begin(), cold, decoded.end(), std::greater<>());
+        std::for_each(cold, decoded.end(), [](const auto &entry) { entry.second->releaseDecoded(); });
+    }
+    if(compressed > 0)
+    {
+        SPDLOG_DEBUG("Compressed {} trajectories at frame {}.", compressed, frame);
+    }
+}
+
+/**
+ * @brief Applies step to the trajectories
+ *
+ * @param step step to apply
+ * @param inverse step restoring the state before applying step
+ * @return false, if the step does not fit to the trajectories; the history is cleared then
+ */
+bool PersonStorage::applyUndoStep(UndoStep &&step, UndoStep &inverse)
+{
+    bool fits = step.remove.empty() || step.remove.back() < mPersons.size();
+    for(size_t k = 0; fits && k < step.insert.size(); ++k)
+    {
+        fits = step.insert[k].first <= mPersons.size() - step.remove.size() + k;
+    }
+    if(!fits)
+    {
+        SPDLOG_WARN("The undo history does not fit to the trajectories anymore and is discarded.");
+        clearUndoHistory();
+        return false;
+    }
 
-        // nur oder eher in Vergangenheit hoeheninfo gefunden
-        if(((j - nrRew >= 0) && (j + nrFor == tsize)) || ((j - nrRew >= 0) && (nrRew < nrFor)))
+    inverse = UndoStep{};
+    for(auto index = step.remove.rbegin(); index != step.remove.rend(); ++index)
+    {
+        inverse.insert.emplace_back(*index, std::move(mPersons[*index]));
+        mPersons.erase(mPersons.begin() + *index);
+    }
+    std::reverse(inverse.insert.begin(), inverse.insert.end());
+    for(auto &[index, person] : step.insert)
+    {
+        inverse.remove.push_back(index);
+        mPersons.insert(mPersons.begin() + index, std::move(person));
+    }
+    invalidateActivePersons();
+    return true;
+}
+
+void PersonStorage::clearUndoHistory()
+{
+    mUndo.clear();
+    mRedo.clear();
+    mUndoBytes     = 0;
+    mRedoBytes     = 0;
+    mPendingAction = false;
+    mPendingPersons.clear();
+    mPendingAffected.clear();
+}
+
+/**
+ * @brief Smooths the heights of the stereo points of all persons in parallel
+ *
+ * Changes the trajectories, but only the heights of the stereo points. Persons, which
+ * were not changed since they were smoothed the last time, are skipped; like in
+ * TrackerItem, this is detected by the snapshot of their points.
+ */
+void PersonStorage::smoothHeights()
+{
+    mSmoothedPoints.resize(mPersons.size());
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(mPersons.size())),
+        [this](const cv::Range &range)
         {
-            if(fabs(mPersons[i].at(j - nrRew).sp().z() - mPersons[i].at(j).sp().z()) > nrRew * 40.) // 40cm
+            for(int i = range.start; i < range.end; ++i)
             {
-                mPersons[i].updateStereoPoint(
-                    j + mPersons[i].firstFrame(),
-                    {mPersons[i].at(j).sp().x(), mPersons[i].at(j).sp().y(), mPersons[i].at(j - nrRew).sp().z()});
-                SPDLOG_WARN(
-                    "Trackpoint smoothed height at the end or next to unknown height in the future for trajectory {} "
-                    "in frame {}.",
-                    i + 1,
-                    j + firstFrame);
+                if(!mSmoothedPoints[i].isSharedWith(mPersons[i].columns()))
+                {
+                    smoothHeights(i);
+                    mSmoothedPoints[i] = mPersons[i].columns();
+                }
             }
+        });
+}
+
+/**
+ * @brief Smooths the heights/z-coordinates of the stereo points of a person
+ *
+ * Heights differing too much from the nearest points with height before and after are
+ * replaced. The points are smoothed from first to last, so the smoothed heights are used
+ * for the following points. The nearest points with height are found with one pass in
+ * each direction.
+ *
+ * @param i index of person whose heights/z-coordinates to smooth
+ */
+void PersonStorage::smoothHeights(size_t i)
+{
+    auto       &person     = mPersons[i];
+    const int   tsize      = person.size();
+    const int   firstFrame = person.firstFrame();
+    const auto &points     = person.columns();
+    if(tsize < 2)
+    {
+        return;
+    }
+
+    // index of the nearest point after each point with height; tsize if there is none
+    std::vector<int> next(tsize);
+    int              nextWithHeight = tsize;
+    for(int j = tsize - 1; j >= 0; --j)
+    {
+        next[j] = nextWithHeight;
+        if(points.sp(j).z() >= 0)
+        {
+            nextWithHeight = j;
         }
-        else if(
-            ((j + nrFor != tsize) && (j - nrRew < 0)) ||
-            ((j + nrFor != tsize) && (nrFor < nrRew))) // nur oder eher in der zukunft hoeheninfo gefunden
+    }
+
+    int prevWithHeight = -1; // index of the nearest point before j with (smoothed) height
+    for(int j = 0; j < tsize; ++j)
+    {
+        const Vec3F sp = points.sp(j);
+        if(sp.z() != -1)
         {
-            if(fabs(mPersons[i].at(j + nrFor).sp().z() - mPersons[i].at(j).sp().z()) > nrFor * 40.) // 40cm
+            const int nrFor = next[j] - j; // abstand zum naechsten trackpoint mit hoeheninfo
+            const int nrRew = j - prevWithHeight;
+
+            // nur oder eher in Vergangenheit hoeheninfo gefunden
+            if(((j - nrRew >= 0) && (j + nrFor == tsize)) || ((j - nrRew >= 0) && (nrRew < nrFor)))
             {
-                mPersons[i].updateStereoPoint(
-                    j + mPersons[i].firstFrame(),
-                    {mPersons[i].at(j).sp().x(), mPersons[i].at(j).sp().y(), mPersons[i].at(j + nrFor).sp().z()});
-                SPDLOG_WARN(
-                    "TrackPoint smoothed height at the beginning or next to unknown height in the past for trajectory "
-                    "{} in frame {}.",
-                    i + 1,
-                    j + firstFrame);
+                const float z = points.sp(j - nrRew).z();
+                if(fabs(z - sp.z()) > nrRew * 40.) // 40cm
+                {
+                    person.updateStereoPoint(j + firstFrame, {sp.x(), sp.y(), z});
+                    SPDLOG_WARN(
+                        "Trackpoint smoothed height at the end or next to unknown height in the future for trajectory "
+                        "{} in frame {}.",
+                        i + 1,
+                        j + firstFrame);
+                }
             }
-        }
-        else if((j + nrFor != tsize) && (j - nrRew >= 0)) // in beiden richtungen hoeheninfo gefunden
-                                                          // und nrFor==nrRew
-        {
-            // median genommen um zwei fehlmessungen nebeneinander nicht dazu fuehren zu lassen, dass
-            // bessere daten veraendert werden
-            auto zMedian = getMedianOf3(
-                mPersons[i].at(j).sp().z(), mPersons[i].at(j - nrRew).sp().z(), mPersons[i].at(j + nrFor).sp().z());
-            // lineare interpolation
-            if(fabs(zMedian - mPersons[i].at(j).sp().z()) > 20. * (nrFor + nrRew)) // 20cm
+            else if(
+                ((j + nrFor != tsize) && (j - nrRew < 0)) ||
+                ((j + nrFor != tsize) && (nrFor < nrRew))) // nur oder eher in der zukunft hoeheninfo gefunden
+            {
+                const float z = points.sp(j + nrFor).z();
+                if(fabs(z - sp.z()) > nrFor * 40.) // 40cm
+                {
+                    person.updateStereoPoint(j + firstFrame, {sp.x(), sp.y(), z});
+                    SPDLOG_WARN(
+                        "TrackPoint smoothed height at the beginning or next to unknown height in the past for "
+                        "trajectory {} in frame {}.",
+                        i + 1,
+                        j + firstFrame);
+                }
+            }
+            else if((j + nrFor != tsize) && (j - nrRew >= 0)) // in beiden richtungen hoeheninfo gefunden
+                                                              // und nrFor==nrRew
             {
-                mPersons[i].updateStereoPoint(
-                    j + mPersons[i].firstFrame(), {mPersons[i].at(j).sp().x(), mPersons[i].at(j).sp().y(), zMedian});
-                SPDLOG_WARN("Trackpoint smoothed height inside for trajectory {} in frame {}.", i + 1, j + firstFrame);
+                // median genommen um zwei fehlmessungen nebeneinander nicht dazu fuehren zu lassen, dass
+                // bessere daten veraendert werden
+                auto zMedian = getMedianOf3(sp.z(), points.sp(j - nrRew).z(), points.sp(j + nrFor).z());
+                // lineare interpolation
+                if(fabs(zMedian - sp.z()) > 20. * (nrFor + nrRew)) // 20cm
+                {
+                    person.updateStereoPoint(j + firstFrame, {sp.x(), sp.y(), zMedian});
+                    SPDLOG_WARN(
+                        "Trackpoint smoothed height inside for trajectory {} in frame {}.", i + 1, j + firstFrame);
+                }
             }
         }
+        if(points.sp(j).z() >= 0)
+        {
+            prevWithHeight = j;
+        }
     }
 }
 
@@ -1095,10 +1733,16 @@ void PersonStorage::insertFeaturePoint(
     float             z,
     float             height)
 {
-    if(mPersons.at(person).insertAtFrame(frame, point, persNr, extrapolate) && z > -1)
+    const bool inserted = mPersons.at(person).insertAtFrame(frame, point, persNr, extrapolate);
+    indexActivePerson(person);
+    if(inserted && z > -1)
     {
         mPersons[person].setHeight(z, height);
     }
+    if(inserted)
+    {
+        emit changedPerson(person);
+    }
 }
 
 /**
@@ -1109,8 +1753,148 @@ void PersonStorage::insertFeaturePoint(
  */
 int PersonStorage::merge(int pers1, int pers2)
 {
-    onManualAction();
+    onManualAction({static_cast<size_t>(pers1), static_cast<size_t>(pers2)});
+    return mergePersons(pers1, pers2);
+}
+
+/**
+ * @brief Joins the trajectories of a separately tracked segment with the existing ones
+ *
+ * The persons from index firstNew on were tracked independently of the ones before
+ * them; both were tracked in the frames [overlapFirst, overlapLast]. An old and a new
+ * trajectory are merged, if their mean distance in the common frames of the overlap
+ * is below maxDistance. The closest pairs are merged first and every trajectory is
+ * merged at most once. Unmatched new trajectories are kept as they are.
+ *
+ * @param firstNew index of the first person of the new segment
+ * @param overlapFirst first frame tracked in both segments
+ * @param overlapLast last frame tracked in both segments
+ * @param maxDistance maximal mean distance in pixel of trajectories of the same person
+ * @return number of merged trajectories
+ */
+int PersonStorage::stitch(size_t firstNew, int overlapFirst, int overlapLast, double maxDistance)
+{
+    struct Match
+    {
+        double distance;
+        size_t oldPerson;
+        size_t newPerson;
+    };
+    std::vector<Match> matches;
+    for(size_t j = firstNew; j < mPersons.size(); ++j)
+    {
+        const auto &newPerson = mPersons[j];
+        for(size_t i = 0; i < firstNew; ++i)
+        {
+            const auto &oldPerson = mPersons[i];
+            const int   first     = std::max({overlapFirst, oldPerson.firstFrame(), newPerson.firstFrame()});
+            const int   last      = std::min({overlapLast, oldPerson.lastFrame(), newPerson.lastFrame()});
+            if(first > last)
+            {
+                continue;
+            }
+            const auto &oldColumns = oldPerson.columns();
+            const auto &newColumns = newPerson.columns();
+            const int   oldOffset  = first - oldPerson.firstFrame();
+            const int   newOffset  = first - newPerson.firstFrame();
+
+            const auto distances = geometry::distances(
+                oldColumns.xData() + oldOffset,
+                oldColumns.yData() + oldOffset,
+                newColumns.xData() + newOffset,
+                newColumns.yData() + newOffset,
+                last - first + 1);
+
+            const double distance = std::accumulate(distances.begin(), distances.end(), 0.) / distances.size();
+            if(distance < maxDistance)
+            {
+                matches.push_back({distance, i, j});
+            }
+        }
+    }
+    std::stable_sort(
+        matches.begin(), matches.end(), [](const Match &a, const Match &b) { return a.distance < b.distance; });
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    pairs.reserve(matches.size());
+    for(const auto &match : matches)
+    {
+        pairs.emplace_back(match.oldPerson, match.newPerson);
+    }
+    return mergePairs(pairs);
+}
 
+/**
+ * @brief Merges duplicate trajectories, e.g. two IDs on one head, in one undo step
+ *
+ * Like in stitch(), every trajectory is merged at most once, i.e. a pair with a person
+ * of an earlier pair is skipped.
+ *
+ * @param pairs indices of the duplicate persons (see plausibility::findDuplicates())
+ * @return number of merged pairs
+ */
+int PersonStorage::mergeDuplicates(const std::vector<std::pair<size_t, size_t>> &pairs)
+{
+    if(pairs.empty())
+    {
+        return 0;
+    }
+    std::vector<size_t> persons;
+    for(const auto &[first, second] : pairs)
+    {
+        persons.push_back(first);
+        persons.push_back(second);
+    }
+    onManualAction(persons);
+    return mergePairs(pairs);
+}
+
+/**
+ * @brief Merges the given pairs of persons in their order without adding an undo step
+ *
+ * A pair with a person, which was already merged, is skipped.
+ *
+ * @return number of merged pairs
+ */
+int PersonStorage::mergePairs(const std::vector<std::pair<size_t, size_t>> &candidates)
+{
+    std::vector<bool>                      merged(mPersons.size(), false);
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for(const auto &[first, second] : candidates)
+    {
+        if(!merged[first] && !merged[second])
+        {
+            merged[first]  = true;
+            merged[second] = true;
+            pairs.emplace_back(first, second);
+        }
+    }
+
+    for(auto pair = pairs.begin(); pair != pairs.end(); ++pair)
+    {
+        const auto deleted = static_cast<size_t>(mergePersons(pair->first, pair->second));
+        // the indices behind the deleted person move forward
+        for(auto next = std::next(pair); next != pairs.end(); ++next)
+        {
+            for(size_t *index : {&next->first, &next->second})
+            {
+                if(*index > deleted)
+                {
+                    --*index;
+                }
+            }
+        }
+    }
+    return static_cast<int>(pairs.size());
+}
+
+/**
+ * @brief Merges the trajectories pers1 and pers2 without adding an undo step
+ *
+ * @return index of the deleted person
+ */
+int PersonStorage::mergePersons(int pers1, int pers2)
+{
     auto      &person      = mPersons.at(pers1);
     auto      &other       = mPersons.at(pers2);
     const bool extrapolate = mMainWindow.getControlWidget()->isTrackExtrapolationChecked();
@@ -1118,31 +1902,13 @@ int PersonStorage::merge(int pers1, int pers2)
     int        keepIndex;
     if(other.firstFrame() < person.firstFrame() && other.lastFrame() > person.lastFrame())
     {
-        for(int k = 0; k < person.size(); ++k)
-        {
-            // bei insertAtFrame wird qual beruecksichtigt, ob vorheriger besser
-            other.insertAtFrame(person.firstFrame() + k, person.at(k), pers2, extrapolate);
-        }
+        other.insertPointsOf(person, pers2, extrapolate);
         deleteIndex = pers1;
         keepIndex   = pers2;
     }
-    else if(other.firstFrame() < person.firstFrame())
-    {
-        for(int k = other.size() - 1; k > -1; --k)
-        {
-            // bei insertAtFrame wird qual beruecksichtigt, ob vorheriger besser
-            person.insertAtFrame(other.firstFrame() + k, other.at(k), pers1, extrapolate);
-        }
-        deleteIndex = pers2;
-        keepIndex   = pers1;
-    }
     else
     {
-        for(int k = 0; k < other.size(); ++k)
-        {
-            // bei insertAtFrame wird qual beruecksichtigt, ob vorheriger besser
-            person.insertAtFrame(other.firstFrame() + k, other.at(k), pers1, extrapolate);
-        }
+        person.insertPointsOf(other, pers1, extrapolate);
         deleteIndex = pers2;
         keepIndex   = pers1;
     }
@@ -1154,11 +1920,70 @@ int PersonStorage::merge(int pers1, int pers2)
 
 std::vector<TrackPerson>::iterator PersonStorage::deletePerson(size_t index)
 {
+    if(mPendingAction && index < mPendingAffected.size())
+    {
+        mPendingAffected.erase(mPendingAffected.begin() + index);
+    }
     auto retIt = mPersons.erase(mPersons.begin() + index);
+    invalidateActivePersons();
     emit deletedPerson(index);
     return retIt;
 }
 
+/**
+ * @brief Deletes all persons i with toDelete[i] in one pass
+ *
+ * deletedPerson is emitted for every deleted person from the highest to the lowest index,
+ * so receivers can apply the deletions one after the other as for deletePerson.
+ *
+ * @param toDelete marks of the persons to delete; persons behind its end are kept
+ */
+void PersonStorage::deletePersons(const std::vector<bool> &toDelete)
+{
+    const auto deleted = [&toDelete](size_t i) { return i < toDelete.size() && toDelete[i]; };
+
+    size_t kept = 0;
+    for(size_t i = 0; i < mPersons.size(); ++i)
+    {
+        if(!deleted(i))
+        {
+            if(kept != i)
+            {
+                mPersons[kept] = std::move(mPersons[i]);
+            }
+            ++kept;
+        }
+    }
+    if(kept == mPersons.size())
+    {
+        return;
+    }
+    const size_t count = mPersons.size();
+    mPersons.erase(mPersons.begin() + kept, mPersons.end());
+
+    if(mPendingAction)
+    {
+        size_t keptAffected = 0;
+        for(size_t i = 0; i < mPendingAffected.size(); ++i)
+        {
+            if(!deleted(i))
+            {
+                mPendingAffected[keptAffected++] = mPendingAffected[i];
+            }
+        }
+        mPendingAffected.resize(keptAffected);
+    }
+    invalidateActivePersons();
+
+    for(size_t i = count; i-- > 0;)
+    {
+        if(deleted(i))
+        {
+            emit deletedPerson(i);
+        }
+    }
+}
+
 void PersonStorage::deletePersonFrameRange(size_t index, int startFrame, int endFrame)
 {
     mPersons[index].removeFramesBetween(startFrame, endFrame);
@@ -19,10 +19,13 @@
 #ifndef PERSONSTORAGE_H
 #define PERSONSTORAGE_H
 
-#include "circularStack.h"
 #include "frameRange.h"
+#include "trackPointGrid.h"
 #include "tracker.h"
+#include "trajectorySpillStore.h"
 
+#include <algorithm>
+#include <deque>
 #include <vector>
 
 class Petrack;
@@ -51,6 +54,7 @@ public:
     void splitPerson(size_t pers, int frame);
     bool splitPersonAt(const Vec2F &p, int frame, const QSet<size_t> &onlyVisible);
     bool delPointOf(int pers, TrajectorySegment direction, int frame);
+    void delPersons(const std::vector<size_t> &persons);
     bool delPoint(const Vec2F &p, TrajectorySegment direction, int frame, const QSet<size_t> &onlyVisible);
     void delPointAll(TrajectorySegment direction, int frame);
     void delPointROI();
@@ -62,8 +66,11 @@ public:
 
     size_t                          nbPersons() const { return mPersons.size(); }
     const TrackPerson              &at(size_t i) const { return mPersons.at(i); }
-    void                            addPerson(const TrackPerson &person) { mPersons.push_back(person); }
+    void                            addPerson(const TrackPerson &person);
     const std::vector<TrackPerson> &getPersons() const { return mPersons; }
+    std::vector<size_t>             activePersons(int frame) const;
+    void                            activePersons(int frame, std::vector<size_t> &persons) const;
+    std::vector<size_t>             activePersons(int first, int last) const;
 
     IntervalList<int>       &getGroupList(size_t person) { return mPersons.at(person).getGroups(); }
     const IntervalList<int> &getGroupList(size_t person) const { return mPersons.at(person).getGroups(); }
@@ -80,7 +87,8 @@ public:
         int                     frame,
         const QSet<size_t>     &onlyVisible,
         reco::RecognitionMethod method,
-        int                    *pers = nullptr);
+        int                    *pers = nullptr,
+        TrackPointGrid         *grid = nullptr);
 
     // hier sollte direkt die farbe mit uebergeben werden
     void addPoints(QList<TrackPoint> &pL, int frame, reco::RecognitionMethod method);
@@ -91,11 +99,21 @@ public:
     std::vector<PersonFrame>
     getProximalPersons(const QPointF &pos, QSet<size_t> selected, const FrameRange &frameRange) const;
 
+    TrackPointGrid buildPointGrid(int frame) const;
+    void           updatePointGrid(TrackPointGrid &grid, size_t person, int frame) const;
+
     void recalcHeight(float altitude);
 
-    void clear() { mPersons.clear(); }
+    void clear()
+    {
+        mPersons.clear();
+        invalidateActivePersons();
+        clearUndoHistory();
+        mSpillStore.reset();
+        mSmoothedPoints.clear();
+    }
 
-    void smoothHeight(size_t i, int j);
+    void smoothHeights();
 
     void insertFeaturePoint(
         size_t            person,
@@ -106,6 +124,8 @@ public:
         float             z,
         float             height);
     int merge(int pers1, int pers2);
+    int stitch(size_t firstNew, int overlapFirst, int overlapLast, double maxDistance);
+    int mergeDuplicates(const std::vector<std::pair<size_t, size_t>> &pairs);
 
     void optimizeColor();
 
@@ -128,6 +148,27 @@ public:
     void undo();
     void redo();
     void onManualAction();
+    void onManualAction(const std::vector<size_t> &persons);
+
+    /// default of the memory used by the undo steps; older steps are dropped (but always one is kept)
+    static constexpr std::size_t DEFAULT_UNDO_MEMORY_LIMIT = 256 * 1024 * 1024;
+
+    std::size_t memoryUsage() const;
+    std::size_t undoMemoryUsage() const { return mUndoBytes + mRedoBytes; }
+    void        setUndoMemoryLimit(std::size_t bytes);
+    std::size_t getUndoMemoryLimit() const { return mUndoMemoryLimit; }
+
+    void        setSpillDistance(int frames) { mSpillDistance = std::max(frames, 0); }
+    int         getSpillDistance() const { return mSpillDistance; }
+    void        spillFinished(int frame);
+    std::size_t spilledBytes() const { return mSpillStore.bytes(); }
+
+    /// compressed trajectories, which stay decoded after being read, when the others are released
+    static constexpr std::size_t HOT_TRAJECTORIES = 64;
+
+    void setCompressDistance(int frames) { mCompressDistance = std::max(frames, 0); }
+    int  getCompressDistance() const { return mCompressDistance; }
+    void compressFinished(int frame);
 
 
 signals:
@@ -141,11 +182,71 @@ private:
     Petrack                 &mMainWindow;
     Autosave                &mAutosave;
 
-    CircularStack<std::vector<TrackPerson>, 10> mUndo;
-    CircularStack<std::vector<TrackPerson>, 10> mRedo;
+    /**
+     * @brief Change of the trajectories by one manual action (or its inverse)
+     *
+     * Applying the step removes the persons at the indices in remove and inserts the
+     * persons in insert afterwards. Only the persons changed by the action are stored.
+     */
+    struct UndoStep
+    {
+        std::vector<size_t>                         remove; ///< ascending indices of the persons to remove
+        std::vector<std::pair<size_t, TrackPerson>> insert; ///< persons to insert with their ascending final index
+        std::size_t                                 bytes = 0;
+    };
 
+    std::deque<UndoStep> mUndo;
+    std::deque<UndoStep> mRedo;
+    std::size_t          mUndoBytes       = 0;
+    std::size_t          mRedoBytes       = 0;
+    std::size_t          mUndoMemoryLimit = DEFAULT_UNDO_MEMORY_LIMIT;
+
+    TrajectorySpillStore mSpillStore;
+    int                  mSpillDistance  = 0; ///< frames to the tracked frame, after which a trajectory is spilled
+    int                  mLastSpillFrame = 0;
+
+    int mCompressDistance  = 0; ///< frames to the tracked frame, after which a trajectory is compressed
+    int mLastCompressFrame = 0;
+
+    // manual action in progress: its undo step is completed by the next action, undo or redo
+    bool                                        mPendingAction = false;
+    std::vector<std::pair<size_t, TrackPerson>> mPendingPersons;  ///< affected persons before the action
+    std::vector<bool>                           mPendingAffected; ///< per current person, if it is affected
+
+    /// points added to the nearest of several close trajectories by the last addPoints()
+    int mAmbiguousMatches = 0;
+
+    /// frames per bucket of mActivePersons
+    static constexpr int ACTIVE_PERSONS_BLOCK_SIZE = 64;
+    /// per block of frames the persons having track points in it (superset, lazily built)
+    mutable std::vector<std::vector<size_t>> mActivePersons;
+    /// per person the frame range it is listed for in mActivePersons
+    mutable std::vector<std::pair<int, int>> mIndexedFrames;
+    mutable bool                             mActivePersonsValid = false;
+
+    /// per person the points after the last smoothHeights(), to skip the persons unchanged since
+    std::vector<TrackPointColumns> mSmoothedPoints;
+
+    int                                mergePersons(int pers1, int pers2);
+    int                                mergePairs(const std::vector<std::pair<size_t, size_t>> &candidates);
+    void                               splitTrajectory(size_t pers, int frame);
     std::vector<TrackPerson>::iterator deletePerson(size_t index);
+    void                               deletePersons(const std::vector<bool> &toDelete);
     void                               deletePersonFrameRange(size_t index, int startFrame, int endFrame);
+    void                               smoothHeights(size_t i);
+
+    std::vector<size_t> personsAt(const Vec2F &point, int frame, const QSet<size_t> &onlyVisible) const;
+
+    void finishManualAction();
+    void pushUndo(UndoStep &&step);
+    void pushRedo(UndoStep &&step);
+    void trimUndo();
+    bool applyUndoStep(UndoStep &&step, UndoStep &inverse);
+    void clearUndoHistory();
+
+    void invalidateActivePersons() { mActivePersonsValid = false; }
+    void indexActivePerson(size_t person) const;
+    void buildActivePersons() const;
 };
 
 #endif // PERSONSTORAGE_H
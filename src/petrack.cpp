@@ -36,14 +36,18 @@
 #include "colorMarkerItem.h"
 #include "colorMarkerWidget.h"
 #include "colorRangeWidget.h"
+#include "compressedFile.h"
+#include "concurrency.h"
 #include "control.h"
 #include "coordItem.h"
 #include "coordinateSystemBox.h"
 #include "editMoCapDialog.h"
 #include "extrinsicBox.h"
 #include "filterBeforeBox.h"
+#include "frameSampler.h"
 #include "gridItem.h"
 #include "imageItem.h"
+#include "imageSequenceWriter.h"
 #include "importHelper.h"
 #include "intrinsicBox.h"
 #include "keybindingDialog.h"
@@ -56,25 +60,104 @@
 #include "pMessageBox.h"
 #include "person.h"
 #include "petrack.h"
+#include "plausibility.h"
 #include "player.h"
+#include "pointCloudWriter.h"
+#ifdef PYTHON
+#include "pythonBridge.h"
+#endif
 #include "recognition.h"
+#include "retracking.h"
 #include "roiItem.h"
+#include "sessionSnapshot.h"
+#include "statisticsPanel.h"
 #include "stereoItem.h"
 #include "stereoWidget.h"
+#include "trace.h"
 #include "tracker.h"
 #include "trackerItem.h"
 #include "trackerReal.h"
+#include "trcIndex.h"
+#include "trcReader.h"
+#ifdef HDF5
+#include "trajectoryHdf5.h"
+#endif
+#ifdef SQLITE
+#include "trajectoryDatabase.h"
+#endif
+#include "videoDecoder.h"
+#include "videoExporter.h"
 #include "view.h"
 #include "worldImageCorrespondence.h"
 
+#include <QEventLoop>
+#include <QFutureWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
 #include <QtPrintSupport/QPrintDialog>
+#include <QtConcurrent>
 #include <QtPrintSupport/QPrinter>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <ctime>
 #include <deque>
 #include <iomanip>
 #include <opencv2/opencv.hpp>
 
+namespace
+{
+/**
+ * @brief Runs an export on a worker thread, while a progress dialog shows its progress
+ *
+ * The export reports its progress through the callback from the worker thread; the
+ * dialog is updated from the local event loop meanwhile.
+ *
+ * @param parent parent of the (window modal) progress dialog
+ * @param title title of the progress dialog
+ * @param maximum maximum of the progress reported by the export
+ * @param exportData export, which must not access any widget; returns false, if writing failed
+ * @return result of exportData
+ */
+bool runExport(
+    QWidget                                                       *parent,
+    const QString                                                 &title,
+    int                                                            maximum,
+    const std::function<bool(const ThrottledProgress::Callback &)> &exportData)
+{
+    QProgressDialog progress(title, nullptr, 0, maximum, parent);
+    progress.setWindowTitle(title);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setVisible(true);
+    progress.setValue(0);
+    progress.setLabelText(QString("Export tracking data ..."));
+
+    std::atomic<int> done{0};
+    QFuture<bool>    future = QtConcurrent::run([&exportData, &done]()
+                                             { return exportData([&done](int value, int) { done = value; }); });
+
+    QEventLoop           loop;
+    QFutureWatcher<bool> watcher;
+    QTimer               timer;
+    QObject::connect(&watcher, &QFutureWatcherBase::finished, &loop, &QEventLoop::quit);
+    QObject::connect(&timer, &QTimer::timeout, &progress, [&progress, &done]() { progress.setValue(done); });
+    watcher.setFuture(future);
+    timer.start(100);
+    if(!future.isFinished())
+    {
+        loop.exec();
+    }
+    progress.setValue(maximum);
+    return future.result();
+}
+
+/// refreshes of the view per second at most, while all frames are played or tracked
+constexpr int MAX_DISPLAY_RATE = 25;
+/// time in ms without further parameter edits before requestUpdateImage() updates the image
+constexpr int UPDATE_DELAY = 40;
+} // namespace
 
 int Petrack::trcVersion = 0;
 
@@ -84,6 +167,10 @@ Petrack::Petrack(QString petrackVersion) :
     mPetrackVersion(std::move(petrackVersion)),
     mAuthors(IO::readAuthors(QCoreApplication::applicationDirPath() + "/.zenodo.json"))
 {
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+    const auto recordStartupTime = [&](const char *part) { mStartupTimes.emplace_back(part, startupTimer.restart()); };
+
     QIcon icon;
     icon.addFile(":/icon");          // about
     icon.addFile(":/icon_smallest"); // window title bar
@@ -94,6 +181,7 @@ Petrack::Petrack(QString petrackVersion) :
     mTracker             = nullptr;
     mTrackerReal         = nullptr; // damit beim zeichnen von control mit analysePlot nicht auf einen feheler laeuft
     mStatusLabelFPS      = nullptr;
+    mStatusLabelDropped  = nullptr;
     mStatusPosRealHeight = nullptr;
     mStatusLabelPosReal  = nullptr;
     mImageItem           = nullptr;
@@ -109,6 +197,7 @@ Petrack::Petrack(QString petrackVersion) :
 
     mBrightContrastFilter.disable();
     mBorderFilter.disable();
+    mBorderFilter.setVirtualBorder(&mAnimation.getVirtualBorder());
     mSwapFilter.disable();
     mBackgroundFilter.disable();
     mStereoContext = nullptr;
@@ -130,7 +219,7 @@ Petrack::Petrack(QString petrackVersion) :
     {
         if(!isLoading())
         {
-            updateImage();
+            requestUpdateImage();
         }
     };
 
@@ -145,6 +234,7 @@ Petrack::Petrack(QString petrackVersion) :
         *getBorderFilter(),
         *getSwapFilter(),
         updateImageCallback);
+    filterBeforeBox->setSampleBackgroundCallback([this]() { sampleBackground(); });
 
     auto *extrinsicBox = new ExtrinsicBox(this, *getExtrCalibration());
     auto *intrinsicBox = new IntrinsicBox(this, *getAutoCalib(), *getCalibFilter(), *extrinsicBox, updateImageCallback);
@@ -176,6 +266,7 @@ Petrack::Petrack(QString petrackVersion) :
     connect(mImageItem, &ImageItem::imageChanged, mControlWidget, &Control::imageSizeChanged);
 
     // end setup control
+    recordStartupTime("control widget");
 
     mWorldImageCorrespondence = &mControlWidget->getWorldImageCorrespondence();
 
@@ -225,17 +316,27 @@ Petrack::Petrack(QString petrackVersion) :
     connect(mView, &GraphicsView::altReleased, this, &Petrack::releaseTrackPoint);
     connect(mView, &GraphicsView::mouseAltReleased, this, &Petrack::releaseTrackPoint);
     connect(mView, &GraphicsView::mouseCtrlWheel, this, &Petrack::scrollShowOnly);
+    connect(
+        &mReco,
+        &reco::Recognizer::recoMethodChanged,
+        this,
+        [this]()
+        {
+            setRecognitionChanged(true); // flag changes of recognition parameters
+            updateGrayscalePipeline();
+        });
+
+    mUpdateTimer.setSingleShot(true);
+    mUpdateTimer.setInterval(UPDATE_DELAY);
+    connect(&mUpdateTimer, &QTimer::timeout, this, &Petrack::updateRequestedImage);
 
-    mLogWindow = new LogWindow(this, nullptr);
-    mLogWindow->setWindowFlags(Qt::Window);
-    mLogWindow->setWindowTitle("Log");
+    // the log window and the annotation groups are rarely used and only created when they are shown first
 
-    mGroupingWidget = new AnnotationGroupWidget(mGroupManager, mAnimation, this);
-    mGroupingWidget->setWindowFlags(Qt::Window);
-    mGroupingWidget->setWindowTitle("Annotation Groups");
     connect(&mGroupManager, &AnnotationGroupManager::trajectoryAssignmentChanged, [this]() { this->updateImage(); });
     connect(&mGroupManager, &AnnotationGroupManager::visualizationParameterChanged, [this]() { this->updateImage(); });
     connect(&mGroupManager, &AnnotationGroupManager::groupsChanged, [this]() { this->updateImage(); });
+    connect(&mPersonStorage, &PersonStorage::deletedPerson, &mAutosave, &Autosave::personDeleted);
+    connect(&mPersonStorage, &PersonStorage::changedPerson, &mAutosave, &Autosave::personChanged);
 
     mPlayerWidget = new Player(&mAnimation, this);
 
@@ -328,6 +429,7 @@ Petrack::Petrack(QString petrackVersion) :
     mSplitter->setStretchFactor(1, 0);
 
     mCentralLayout->addWidget(mSplitter);
+    recordStartupTime("widgets and scene");
 
 
     setWindowTitle(tr("PeTrack"));
@@ -339,6 +441,7 @@ Petrack::Petrack(QString petrackVersion) :
     createActions();
     createMenus();
     createStatusBar();
+    recordStartupTime("actions and menus");
 
     auto *exportShortCut = new QShortcut{QKeySequence("Shift+e"), this};
     connect(exportShortCut, &QShortcut::activated, this, [=]() { exportTracker(); });
@@ -353,14 +456,12 @@ Petrack::Petrack(QString petrackVersion) :
     auto *toggleShowOnly = new QShortcut{QKeySequence("Shift+a"), this};
     connect(toggleShowOnly, &QShortcut::activated, this, [=]() { mControlWidget->toggleShowOnly(); });
 
-    // TODO delete once we get Options to be value only (i.e. no Pointer/Ref anymore)
-    mReco.getCodeMarkerOptions().setControlWidget(mControlWidget);
-    mReco.getCodeMarkerOptions().setCodeMarkerItem(mCodeMarkerItem);
-
     mSeqFileName = QDir::currentPath(); // fuer allerersten Aufruf des Programms
     readSettings();
+    recordStartupTime("settings");
 
     saveXml(mDefaultSettings); // noch nicht noetig, da eh noch nicht fkt
+    recordStartupTime("default project");
 
     mShowFPS = 0;
 
@@ -461,8 +562,10 @@ void Petrack::updateSceneRect()
 void Petrack::openXml(QDomDocument &doc, bool openSeq)
 {
     mMissingFrames.reset();
+    mCrowdMetrics.reset();
     bool                      missingFramesExecuted = false;
     std::vector<MissingFrame> missingFrames{};
+    DisplacementCache         displacementCache;
 
     QDomElement root = doc.firstChildElement("PETRACK");
     QString     seq;
@@ -475,8 +578,18 @@ void Petrack::openXml(QDomDocument &doc, bool openSeq)
     int         zoom = 250, rotate = 0, hScroll = 0, vScroll = 0;
     enum Camera cam = cameraUnset;
     setLoading(true);
+    // every applied setting would process the frame again; it is processed once after all settings are applied
+    mDeferUpdates   = true;
+    mDeferredChange = false;
     auto petVersion = root.attribute("VERSION");
 
+    // decoding settings have to be known before the sequence in MAIN is opened
+    mAnimation.setHwAcceleration(
+        videoDecoder::toAcceleration(readInt(root.firstChildElement("PLAYER"), "HW_ACCELERATION", 0)));
+    // the snapshot has to be known before the MoCap files in MOCAP are read
+    mSessionSnapshot = readBool(root.firstChildElement("PLAYER"), "SESSION_SNAPSHOT", false);
+    mMoCapController.setSnapshot(mSessionSnapshot ? IO::SessionSnapshot::read(mProFileName) : nullptr);
+
     for(QDomElement elem = root.firstChildElement(); !elem.isNull(); elem = elem.nextSiblingElement())
     {
         if(elem.tagName() == "MAIN")
@@ -535,6 +648,10 @@ void Petrack::openXml(QDomDocument &doc, bool openSeq)
         {
             mMoCapController.getXml(elem);
         }
+        else if(elem.tagName() == "CROWD_METRICS")
+        {
+            mCrowdMetrics.getXml(elem);
+        }
         else if(elem.tagName() == "CONTROL")
         {
             mControlWidget->getXml(elem, petVersion);
@@ -556,6 +673,62 @@ void Petrack::openXml(QDomDocument &doc, bool openSeq)
             sourceFrameIn  = readInt(elem, "SOURCE_FRAME_IN", -1);
             sourceFrameOut = readInt(elem, "SOURCE_FRAME_OUT", -1);
             mPlayerWidget->setPlayerSpeedLimited(readBool(elem, "PLAYER_SPEED_FIXED", false));
+            mAnimation.setPrefetchDepth(readInt(elem, "PREFETCH_DEPTH", 0));
+            mAnimation.setFrameCacheSize(readInt(elem, "FRAME_CACHE_SIZE", DEFAULT_FRAME_CACHE_SIZE));
+            const int undoMemoryLimit = readInt(
+                elem, "UNDO_MEMORY_LIMIT", static_cast<int>(PersonStorage::DEFAULT_UNDO_MEMORY_LIMIT / (1024 * 1024)));
+            mPersonStorage.setUndoMemoryLimit(static_cast<std::size_t>(std::max(undoMemoryLimit, 0)) * 1024 * 1024);
+            mPersonStorage.setSpillDistance(readInt(elem, "TRAJECTORY_SPILL_DISTANCE", 0));
+            mPersonStorage.setCompressDistance(readInt(elem, "TRAJECTORY_COMPRESS_DISTANCE", 0));
+            mUseFilteredFrameStore = readBool(elem, "FILTERED_FRAME_STORE", false);
+            mUseDetectionCache     = readBool(elem, "DETECTION_CACHE", false);
+            mUseDisparityStore     = readBool(elem, "DISPARITY_STORE", false);
+            mFusedPreprocessing    = readBool(elem, "FUSED_PREPROCESSING", false);
+            mFusedPreprocessor.setUseOpenCL(readBool(elem, "OPENCL_PREPROCESSING", false));
+            mVirtualBorder = readBool(elem, "VIRTUAL_BORDER", false);
+            mTracker->setUseCuda(readBool(elem, "CUDA_TRACKING", false));
+            mTracker->setUseMotionPrediction(readBool(elem, "MOTION_PREDICTION", false));
+            mTracker->setCoarseToFine(readBool(elem, "COARSE_TO_FINE_TRACKING", false));
+            mReco.getCodeMarkerOptions().setTileSize(readInt(elem, "CODE_MARKER_TILE_SIZE", 0));
+            mReco.getCodeMarkerOptions().setUseAprilTag(readBool(elem, "CODE_MARKER_APRILTAG", false));
+            mGuidedRecognitionInterval = readInt(elem, "GUIDED_RECOGNITION_INTERVAL", 0);
+            mRecoSchedule.setEnabled(readBool(elem, "ADAPTIVE_RECOGNITION_STEP", false));
+            mFrameChange.setEnabled(readBool(elem, "SKIP_UNCHANGED_FRAMES", false));
+            mEntryZones.setEnabled(readBool(elem, "LEARNED_ENTRY_ZONES", false));
+            mMarkerHints.setEnabled(readBool(elem, "REJECTED_MARKER_HINTS", false));
+            mReco.getHeadDetectorOptions().setModelPath(readQString(elem, "HEAD_DETECTOR_MODEL", ""));
+            mReco.getHeadDetectorOptions().setInputSize(readInt(elem, "HEAD_DETECTOR_INPUT_SIZE", 640));
+            mReco.getHeadDetectorOptions().setMinScore(readDouble(elem, "HEAD_DETECTOR_MIN_SCORE", 0.5));
+            mCalibFilter.setMapDiskCache(readBool(elem, "CALIB_MAP_DISK_CACHE", false));
+            mRoiFiltering        = readBool(elem, "ROI_FILTERING", false);
+            mUndistortPointsOnly = readBool(elem, "POINT_UNDISTORTION", false);
+            mStereoRoiOnly       = readBool(elem, "STEREO_ROI_ONLY", false);
+            mGrayscalePipeline   = readBool(elem, "GRAYSCALE_PIPELINE", false);
+            updateGrayscalePipeline();
+            mAnimation.setProxyPlayback(readBool(elem, "PROXY_PLAYBACK", false));
+            mUseMezzanine     = readBool(elem, "MEZZANINE", false);
+            mMezzanineRoiOnly = readBool(elem, "MEZZANINE_ROI_ONLY", false);
+            mAnimation.setLiveDropPolicy(static_cast<LiveCapture::DropPolicy>(
+                readInt(elem, "LIVE_DROP_POLICY", static_cast<int>(LiveCapture::DropPolicy::DropOldest))));
+            mLiveBudget.setBudget(readDouble(elem, "LIVE_LATENCY_BUDGET", 0.));
+            if(mLiveBudget.isEnabled())
+            {
+                // with a latency budget, always the newest frame is processed
+                mAnimation.setLiveDropPolicy(LiveCapture::DropPolicy::Latest);
+            }
+            mLivePublisher.setTarget(readQString(elem, "LIVE_PUBLISH", ""));
+            mLiveSharedMemory.open(readQString(elem, "LIVE_SHARED_MEMORY", ""));
+            mExportHwAcceleration = videoDecoder::toAcceleration(readInt(elem, "EXPORT_HW_ACCELERATION", 0));
+            mExportThreads        = readInt(elem, "EXPORT_THREADS", 0);
+            mExportQuality        = readInt(elem, "EXPORT_QUALITY", -1);
+            mPointCloudDecimation = std::max(1, readInt(elem, "POINT_CLOUD_DECIMATION", 1));
+            mPointCloudRoiOnly    = readBool(elem, "POINT_CLOUD_ROI_ONLY", false);
+            mThreads              = readInt(elem, "THREADS", 0);
+            concurrency::setProjectThreadCount(mThreads);
+            mTrackerReal->setUseWorldPositionMap(readBool(elem, "WORLD_POSITION_MAP", false));
+            mDuplicateDistance = readDouble(elem, "EXPORT_DUPLICATE_DISTANCE", 0.);
+            mDuplicateShare    = readDouble(elem, "EXPORT_DUPLICATE_SHARE", 0.8);
+            mMergeDuplicates   = readBool(elem, "EXPORT_MERGE_DUPLICATES", false);
         }
         else if(elem.tagName() == "VIEW")
         {
@@ -587,6 +760,15 @@ void Petrack::openXml(QDomDocument &doc, bool openSeq)
                     missingFrames.push_back(MissingFrame{num, count});
                 }
             }
+            auto displacements = elem.firstChildElement("DISPLACEMENTS");
+            if(!displacements.isNull())
+            {
+                displacementCache.setKey(displacements.attribute("KEY").toLatin1());
+                if(!displacementCache.deserialize(QByteArray::fromBase64(displacements.text().toLatin1())))
+                {
+                    SPDLOG_WARN("Ignoring the invalid displacements of the missing frames in the project file.");
+                }
+            }
         }
         else
         {
@@ -594,8 +776,11 @@ void Petrack::openXml(QDomDocument &doc, bool openSeq)
         }
     }
 
+    mMoCapController.setSnapshot(nullptr);
+
     mMissingFrames.setExecuted(missingFramesExecuted);
     mMissingFrames.setMissingFrames(missingFrames);
+    mMissingFrames.getDisplacementCache() = std::move(displacementCache);
 
     mViewWidget->setZoomLevel(zoom);
     mViewWidget->setRotateLevel(rotate);
@@ -614,6 +799,8 @@ void Petrack::openXml(QDomDocument &doc, bool openSeq)
     mPlayerWidget->setFrameInNum(sourceFrameIn == -1 ? mAnimation.getSourceInFrameNum() : sourceFrameIn);
     mPlayerWidget->setFrameOutNum(sourceFrameOut == -1 ? mAnimation.getSourceOutFrameNum() : sourceFrameOut);
     mPlayerWidget->update();
+    mMezzanineAct->setChecked(mUseMezzanine);
+    updateMezzanine();
 
     if(frame != -1)
     {
@@ -632,7 +819,7 @@ void Petrack::openXml(QDomDocument &doc, bool openSeq)
     }
 
     // nicht schon in control, sonst loescht opensequence wieder tracker
-    if(mTrcFileName != "")
+    if(mTrcFileName != "" && mLoadTrajectories)
     {
         // vorher loeschen aller trajektorien, da sonst nach start im ersten bild
         // mgl zwei trackpoints
@@ -667,7 +854,8 @@ void Petrack::openXml(QDomDocument &doc, bool openSeq)
         mPlayerWidget->setPlaybackFPS(playbackFps);
         setSequenceFPS(sequenceFps); // set here to override the fps from the default fps of the sequence
     }
-    updateImage(); // needed to undistort, draw border, etc. for first display
+    mDeferUpdates = false;
+    updateImage(mDeferredChange); // needed to undistort, draw border, etc. for first display
     setLoading(false);
 }
 
@@ -824,6 +1012,11 @@ void Petrack::saveXml(QDomDocument &doc)
     mMoCapController.setXml(elem);
     root.appendChild(elem);
 
+    // measurements while tracking all frames
+    elem = doc.createElement("CROWD_METRICS");
+    mCrowdMetrics.setXml(elem);
+    root.appendChild(elem);
+
     // player settings (which frame, frame range)
     elem = doc.createElement("PLAYER");
     elem.setAttribute("FRAME", mPlayerWidget->getPos()); // == mAnimation.getCurrentFrameNum()
@@ -832,6 +1025,54 @@ void Petrack::saveXml(QDomDocument &doc)
     elem.setAttribute("SOURCE_FRAME_IN", mPlayerWidget->getFrameInNum());
     elem.setAttribute("SOURCE_FRAME_OUT", mPlayerWidget->getFrameOutNum());
     elem.setAttribute("PLAYER_SPEED_FIXED", mPlayerWidget->getPlayerSpeedLimited());
+    elem.setAttribute("PREFETCH_DEPTH", mAnimation.getPrefetchDepth());
+    elem.setAttribute("FRAME_CACHE_SIZE", mAnimation.getFrameCacheSize());
+    elem.setAttribute("UNDO_MEMORY_LIMIT", static_cast<int>(mPersonStorage.getUndoMemoryLimit() / (1024 * 1024)));
+    elem.setAttribute("TRAJECTORY_SPILL_DISTANCE", mPersonStorage.getSpillDistance());
+    elem.setAttribute("TRAJECTORY_COMPRESS_DISTANCE", mPersonStorage.getCompressDistance());
+    elem.setAttribute("HW_ACCELERATION", static_cast<int>(mAnimation.getHwAcceleration()));
+    elem.setAttribute("FILTERED_FRAME_STORE", mUseFilteredFrameStore);
+    elem.setAttribute("DETECTION_CACHE", mUseDetectionCache);
+    elem.setAttribute("DISPARITY_STORE", mUseDisparityStore);
+    elem.setAttribute("FUSED_PREPROCESSING", mFusedPreprocessing);
+    elem.setAttribute("OPENCL_PREPROCESSING", mFusedPreprocessor.isOpenCLRequested());
+    elem.setAttribute("VIRTUAL_BORDER", mVirtualBorder);
+    elem.setAttribute("CUDA_TRACKING", mTracker->isCudaRequested());
+    elem.setAttribute("MOTION_PREDICTION", mTracker->isUsingMotionPrediction());
+    elem.setAttribute("COARSE_TO_FINE_TRACKING", mTracker->isCoarseToFine());
+    elem.setAttribute("CODE_MARKER_TILE_SIZE", mReco.getCodeMarkerOptions().getTileSize());
+    elem.setAttribute("CODE_MARKER_APRILTAG", mReco.getCodeMarkerOptions().isUsingAprilTag());
+    elem.setAttribute("GUIDED_RECOGNITION_INTERVAL", mGuidedRecognitionInterval);
+    elem.setAttribute("ADAPTIVE_RECOGNITION_STEP", mRecoSchedule.isEnabled());
+    elem.setAttribute("SKIP_UNCHANGED_FRAMES", mFrameChange.isEnabled());
+    elem.setAttribute("LEARNED_ENTRY_ZONES", mEntryZones.isEnabled());
+    elem.setAttribute("REJECTED_MARKER_HINTS", mMarkerHints.isEnabled());
+    elem.setAttribute("HEAD_DETECTOR_MODEL", mReco.getHeadDetectorOptions().getModelPath());
+    elem.setAttribute("HEAD_DETECTOR_INPUT_SIZE", mReco.getHeadDetectorOptions().getInputSize());
+    elem.setAttribute("HEAD_DETECTOR_MIN_SCORE", mReco.getHeadDetectorOptions().getMinScore());
+    elem.setAttribute("CALIB_MAP_DISK_CACHE", mCalibFilter.getMapDiskCache());
+    elem.setAttribute("ROI_FILTERING", mRoiFiltering);
+    elem.setAttribute("SESSION_SNAPSHOT", mSessionSnapshot);
+    elem.setAttribute("POINT_UNDISTORTION", mUndistortPointsOnly);
+    elem.setAttribute("STEREO_ROI_ONLY", mStereoRoiOnly);
+    elem.setAttribute("GRAYSCALE_PIPELINE", mGrayscalePipeline);
+    elem.setAttribute("PROXY_PLAYBACK", mAnimation.isProxyPlayback());
+    elem.setAttribute("MEZZANINE", mUseMezzanine);
+    elem.setAttribute("MEZZANINE_ROI_ONLY", mMezzanineRoiOnly);
+    elem.setAttribute("LIVE_DROP_POLICY", static_cast<int>(mAnimation.getLiveDropPolicy()));
+    elem.setAttribute("LIVE_LATENCY_BUDGET", mLiveBudget.getBudget());
+    elem.setAttribute("LIVE_PUBLISH", mLivePublisher.getTarget());
+    elem.setAttribute("LIVE_SHARED_MEMORY", mLiveSharedMemory.getFileName());
+    elem.setAttribute("EXPORT_HW_ACCELERATION", static_cast<int>(mExportHwAcceleration));
+    elem.setAttribute("EXPORT_THREADS", mExportThreads);
+    elem.setAttribute("EXPORT_QUALITY", mExportQuality);
+    elem.setAttribute("POINT_CLOUD_DECIMATION", mPointCloudDecimation);
+    elem.setAttribute("POINT_CLOUD_ROI_ONLY", mPointCloudRoiOnly);
+    elem.setAttribute("THREADS", mThreads);
+    elem.setAttribute("WORLD_POSITION_MAP", mTrackerReal->isUsingWorldPositionMap());
+    elem.setAttribute("EXPORT_DUPLICATE_DISTANCE", mDuplicateDistance);
+    elem.setAttribute("EXPORT_DUPLICATE_SHARE", mDuplicateShare);
+    elem.setAttribute("EXPORT_MERGE_DUPLICATES", mMergeDuplicates);
 
     root.appendChild(elem);
 
@@ -866,6 +1107,15 @@ void Petrack::saveXml(QDomDocument &doc)
         frame.setAttribute("NUM_MISSING", missingFrame.mCount);
         elem.appendChild(frame);
     }
+    // the flows of the track points, so the missing frames are recomputed quickly after editing trajectories
+    auto &cache = mMissingFrames.getDisplacementCache();
+    if(!cache.isEmpty())
+    {
+        auto displacements = doc.createElement("DISPLACEMENTS");
+        displacements.setAttribute("KEY", QString::fromLatin1(cache.getKey()));
+        displacements.appendChild(doc.createTextNode(QString::fromLatin1(cache.serialize().toBase64())));
+        elem.appendChild(displacements);
+    }
     root.appendChild(elem);
 }
 
@@ -905,22 +1155,7 @@ bool Petrack::saveProject(QString fileName) // default fileName=""
     }
 
     setProFileName(fileName);
-    QDomDocument doc("PETRACK"); // eigentlich Pfad zu Beschreibungsdatei fuer Dateiaufbau
-    saveXml(doc);
-
-    // file output
-    QByteArray       byteArray;
-    QXmlStreamWriter xmlStream(&byteArray);
-    xmlStream.setAutoFormatting(true);
-    xmlStream.setAutoFormattingIndent(4);
-
-    xmlStream.writeStartDocument();
-    xmlStream.writeDTD("<!DOCTYPE PETRACK>");
-
-    QDomElement element = doc.documentElement();
-    writeXmlElement(xmlStream, element);
-
-    xmlStream.writeEndDocument();
+    const QByteArray byteArray = projectXml(projectDocument());
 
     QFile file(fileName);
     if(!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
@@ -932,6 +1167,11 @@ bool Petrack::saveProject(QString fileName) // default fileName=""
     file.write(byteArray);
     file.close(); // also flushes the file
 
+    if(mSessionSnapshot)
+    {
+        IO::writeSessionSnapshot(fileName, mMoCapStorage.getPersons());
+    }
+
     statusBar()->showMessage(tr("Saved project to %1.").arg(fileName), 5000);
     SPDLOG_INFO("save project to {}", fileName);
 
@@ -939,34 +1179,66 @@ bool Petrack::saveProject(QString fileName) // default fileName=""
     return true;
 }
 
-void Petrack::writeXmlElement(QXmlStreamWriter &xmlStream, QDomElement element)
+/**
+ * @brief Returns the project in its current state
+ *
+ * Queries the widgets, hence it has to be called from the GUI thread. The document is not
+ * shared with Petrack, so it may be serialized by projectXml() in any thread, as done by Autosave.
+ */
+QDomDocument Petrack::projectDocument()
+{
+    QDomDocument doc("PETRACK"); // eigentlich Pfad zu Beschreibungsdatei fuer Dateiaufbau
+    saveXml(doc);
+    return doc;
+}
+
+/// Returns the content of the project file for doc; does not access Petrack
+QByteArray Petrack::projectXml(const QDomDocument &doc)
+{
+    QByteArray       byteArray;
+    QXmlStreamWriter xmlStream(&byteArray);
+    xmlStream.setAutoFormatting(true);
+    xmlStream.setAutoFormattingIndent(4);
+
+    xmlStream.writeStartDocument();
+    xmlStream.writeDTD("<!DOCTYPE PETRACK>");
+    writeXmlElement(xmlStream, doc.documentElement());
+    xmlStream.writeEndDocument();
+    return byteArray;
+}
+
+void Petrack::writeXmlElement(QXmlStreamWriter &xmlStream, const QDomElement &element)
 {
     xmlStream.writeStartElement(element.tagName());
 
-    QVector<QString>       attribute_names;
-    const QDomNamedNodeMap attributes = element.attributes();
-    for(int i = 0; i < attributes.size(); ++i)
+    std::vector<QDomAttr>  attributes;
+    const QDomNamedNodeMap attributeMap = element.attributes();
+    attributes.reserve(attributeMap.size());
+    for(int i = 0; i < attributeMap.size(); ++i)
     {
-        attribute_names.push_back(attributes.item(i).toAttr().name());
+        attributes.push_back(attributeMap.item(i).toAttr());
     }
 
     // TODO: check if sorting of elements fits our needs
-    std::stable_sort(attribute_names.begin(), attribute_names.end()); // for a canonical XML
-
-    // Wants this macro instead of range-based for loop
-    foreach(QString name, attribute_names)
+    std::stable_sort( // for a canonical XML
+        attributes.begin(),
+        attributes.end(),
+        [](const QDomAttr &lhs, const QDomAttr &rhs) { return lhs.name() < rhs.name(); });
+    for(const auto &attribute : attributes)
     {
-        QDomAttr attr = element.attributeNode(name);
-        xmlStream.writeAttribute(attr.name(), attr.value());
+        xmlStream.writeAttribute(attribute.name(), attribute.value());
     }
 
     // order of child nodes is defined at creation
-    if(element.hasChildNodes())
+    for(QDomNode child = element.firstChild(); !child.isNull(); child = child.nextSibling())
     {
-        const QDomNodeList children = element.childNodes();
-        for(int i = 0; i < children.size(); ++i)
+        if(child.isElement())
         {
-            writeXmlElement(xmlStream, children.at(i).toElement());
+            writeXmlElement(xmlStream, child.toElement());
+        }
+        else if(child.isText())
+        {
+            xmlStream.writeCharacters(child.toText().data());
         }
     }
 
@@ -992,6 +1264,7 @@ void Petrack::openCameraLiveStream(int camID /* =-1*/)
         return;
     }
     mSeqFileName = "camera live stream";
+    mLiveBudget.reset();
     SPDLOG_INFO(
         "open {} ({} frames; {} fps; {} x {} pixel)",
         mSeqFileName,
@@ -1015,12 +1288,13 @@ void Petrack::openSequence(QString fileName) // default fileName = ""
             this,
             tr("Open video or image sequence"),
             QFileInfo(mSeqFileName).path(),
-            tr("All supported types (*.avi *.mpg *.mts *.m2t *.m2ts *.wmv *.mp4 *.mov *.mxf *.bmp *.dib *.jpeg *.jpg "
-               "*.jpe *.png *.pbm *.pgm *.ppm *.sr *.ras *.tiff *.tif *.exr *.jp2);;Video (*.avi *.mpg *.mts *.m2ts "
-               "*.m2t *.wmv *.mov *.mp4 *.mxf);;Images (*.bmp *.dib *.jpeg *.jpg *.jpe *.png *.pbm *.pgm *.ppm *.sr "
-               "*.ras *.tiff *.tif *.exr *.jp2);;Windows bitmaps (*.bmp *.dib);;JPEG (*.jpeg *.jpg *.jpe);;Portable "
-               "network graphics (*.png);;Portable image format (*.pbm *.pgm *.ppm);;Sun rasters (*.sr *.ras);;TIFF "
-               "(*.tiff *.tif);;OpenEXR HDR (*.exr);;JPEG 2000 (*.jp2);;All files (*.*)"));
+            tr("All supported types (*.avi *.mpg *.mts *.m2t *.m2ts *.wmv *.mp4 *.mov *.mxf *.vlist *.bmp *.dib *.jpeg "
+               "*.jpg *.jpe *.png *.pbm *.pgm *.ppm *.sr *.ras *.tiff *.tif *.exr *.jp2);;Video (*.avi *.mpg *.mts "
+               "*.m2ts *.m2t *.wmv *.mov *.mp4 *.mxf);;Video list (*.vlist);;Images (*.bmp *.dib *.jpeg *.jpg *.jpe "
+               "*.png *.pbm *.pgm *.ppm *.sr *.ras *.tiff *.tif *.exr *.jp2);;Windows bitmaps (*.bmp *.dib);;JPEG "
+               "(*.jpeg *.jpg *.jpe);;Portable network graphics (*.png);;Portable image format (*.pbm *.pgm "
+               "*.ppm);;Sun rasters (*.sr *.ras);;TIFF (*.tiff *.tif);;OpenEXR HDR (*.exr);;JPEG 2000 (*.jp2);;All "
+               "files (*.*)"));
     }
     if(!fileName.isEmpty())
     {
@@ -1054,6 +1328,12 @@ void Petrack::openSequence(QString fileName) // default fileName = ""
         setFPS(mAnimation.getSequenceFPS());
         mLogoItem->fadeOut();
         mMissingFrames.reset();
+        mMissingFrames.getDisplacementCache().clear();
+        if(!mDeferUpdates)
+        {
+            // a project prepares it after its working range is set
+            updateMezzanine();
+        }
     }
 }
 
@@ -1065,10 +1345,38 @@ void Petrack::openMoCapFile()
 
 void Petrack::editMoCapSettings()
 {
-    auto *dialog = new EditMoCapDialog(this, mMoCapStorage, [this]() { mScene->update(); });
+    auto *dialog = new EditMoCapDialog(
+        this,
+        mMoCapStorage,
+        [this]()
+        {
+            mMoCapController.reloadMissingSamples();
+            mScene->update();
+        });
     dialog->show();
 }
 
+/**
+ * @brief Runs a Python script, which accesses the current trajectories via the module petrack
+ *
+ * @see pythonBridge
+ */
+void Petrack::runPythonScript()
+{
+#ifdef PYTHON
+    const QString script = QFileDialog::getOpenFileName(
+        this, tr("Select Python script"), QFileInfo(mProFileName).path(), tr("Python script (*.py);;All files (*.*)"));
+    if(script.isEmpty())
+    {
+        return;
+    }
+    if(!pythonBridge::runScript(*this, script))
+    {
+        PCritical(this, tr("PeTrack"), tr("The Python script %1 failed, see the log for details.").arg(script));
+    }
+#endif
+}
+
 void Petrack::updateWindowTitle()
 {
     QString title;
@@ -1195,68 +1503,54 @@ void Petrack::exportSequence(bool exportVideo, bool exportView, QString dest) //
 
     if(!dest.isEmpty() && mImage)
     {
-        int       rest             = mAnimation.getNumFrames() - 1;
-        int       numLength        = 1;
-        int       memPos           = mPlayerWidget->getPos();
-        QString   fileName         = "";
-        bool      formatIsSaveAble = false;
-        bool      saveRet;
-        QImage   *viewImage = nullptr;
-        QPainter *painter   = nullptr;
-        int       progEnd   = mAnimation.getSourceOutFrameNum() -
+        // exported frames have to be in full resolution
+        mExportRunning = true;
+        updateImage(false);
+
+        int     rest             = mAnimation.getNumFrames() - 1;
+        int     numLength        = 1;
+        int     memPos           = mPlayerWidget->getPos();
+        QString fileName         = "";
+        bool    formatIsSaveAble = false;
+        bool    saveRet;
+        QImage  viewImage;
+        int     progEnd = mAnimation.getSourceOutFrameNum() -
                       mPlayerWidget->getPos(); // nur wenn nicht an anfang gesprungen wird:-mPlayerWidget->getPos()
-        cv::Mat         iplImgFilteredBGR;
-        bool            writeFrameRet = false;
-        cv::VideoWriter outputVideo;
+        cv::Mat             iplImgFilteredBGR;
+        bool                writeFrameRet = false;
+        VideoExporter       outputVideo;
+        ImageSequenceWriter imageWriter(mExportThreads, mExportQuality);
+        // hardware encoders are only used for H.264 in mp4 files
+        const auto acceleration = extension == ".mp4" ? mExportHwAcceleration : cv::VIDEO_ACCELERATION_NONE;
 
         if(exportVideo)
         {
             if(exportView)
             {
-                if(mCropZoomViewAct->isChecked())
-                {
-                    viewImage =
-                        new QImage(mView->viewport()->width(), mView->viewport()->height(), QImage::Format_RGB32);
-                }
-                else
-                {
-                    viewImage = new QImage((int) mScene->width(), (int) mScene->height(), QImage::Format_RGB32);
-                }
-                painter = new QPainter();
-            }
-
-            if(exportView)
-            {
-                outputVideo = cv::VideoWriter(
+                const QSize size = exportViewSize();
+                outputVideo.open(
                     dest.toStdString(),
                     fourcc,
                     mAnimation.getSequenceFPS(),
-                    cv::Size(viewImage->width(), viewImage->height()));
+                    cv::Size(size.width(), size.height()),
+                    true,
+                    acceleration);
             }
             else
             {
                 bool colored = (mImg.channels() > 1);
-                outputVideo  = cv::VideoWriter(
-                    dest.toStdString(), fourcc, mAnimation.getSequenceFPS(), cv::Size(mImg.cols, mImg.rows), colored);
+                outputVideo.open(
+                    dest.toStdString(),
+                    fourcc,
+                    mAnimation.getSequenceFPS(),
+                    cv::Size(mImg.cols, mImg.rows),
+                    colored,
+                    acceleration);
             }
         }
 
         if(!exportVideo)
         {
-            if(exportView)
-            {
-                if(mCropZoomViewAct->isChecked())
-                {
-                    viewImage =
-                        new QImage(mView->viewport()->width(), mView->viewport()->height(), QImage::Format_RGB32);
-                }
-                else
-                {
-                    viewImage = new QImage((int) mScene->width(), (int) mScene->height(), QImage::Format_RGB32);
-                }
-                painter = new QPainter();
-            }
-
             // test, if fileformat is supported
             if(mAnimation.isVideo())
             {
@@ -1275,26 +1569,14 @@ void Petrack::exportSequence(bool exportVideo, bool exportView, QString dest) //
 
             if(exportView)
             {
-                painter->begin(viewImage);
-                if(mCropZoomViewAct->isChecked())
-                {
-                    mView->render(painter);
-                }
-                else
-                {
-                    mScene->render(painter);
-                }
-                painter->end();
-
-                if(viewImage->save(fileName)) //, const char * format = 0 (format wird aus dateinamen geholt), int
-                                              // quality = -1 default normal (0..100)
+                renderExportView(viewImage);
+                if(viewImage.save(fileName, nullptr, mExportQuality))
                 {
                     formatIsSaveAble = true;
                     mPlayerWidget->frameForward();
                 }
             }
-            else if(mImage->save(fileName)) //, const char * format = 0 (format wird aus dateinamen geholt), int quality
-                                            //= -1 default normal (0..100)
+            else if(mImage->save(fileName, nullptr, mExportQuality)) // format is deduced from the file name
             {
                 formatIsSaveAble = true;
                 mPlayerWidget->frameForward();
@@ -1349,35 +1631,13 @@ void Petrack::exportSequence(bool exportVideo, bool exportView, QString dest) //
                 // video sequence
                 if(exportView)
                 {
-                    painter->begin(viewImage);
-                    if(mCropZoomViewAct->isChecked())
-                    {
-                        mView->render(painter);
-                    }
-                    else
-                    {
-                        mScene->render(painter);
-                    }
-                    painter->end();
-                }
-
-                if(exportView)
-                {
-                    cv::Mat frame(
-                        viewImage->height(),
-                        viewImage->width(),
-                        CV_8UC4,
-                        (unsigned char *) viewImage->bits(),
-                        viewImage->bytesPerLine());
-                    cv::cvtColor(frame, frame, cv::COLOR_RGBA2RGB); // need for right image interpretation
-                    outputVideo.write(frame);
-                    writeFrameRet = true;
+                    renderExportView(viewImage);
+                    // converted by the encoder thread, while the next frame is rendered into a new image
+                    writeFrameRet = outputVideo.write(viewImage);
                 }
                 else
                 {
-                    cv::Mat frame = mImg.clone();
-                    outputVideo.write(frame);
-                    writeFrameRet = true;
+                    writeFrameRet = outputVideo.write(mImg.clone());
                 }
 
                 if(!writeFrameRet)
@@ -1395,67 +1655,37 @@ void Petrack::exportSequence(bool exportVideo, bool exportView, QString dest) //
                 // single frame sequence
                 if(exportView)
                 {
-                    painter->begin(viewImage);
-                    if(mCropZoomViewAct->isChecked())
-                    {
-                        mView->render(painter);
-                    }
-                    else
-                    {
-                        mScene->render(painter);
-                    }
-                    painter->end();
+                    renderExportView(viewImage);
                 }
+                // the images are compressed and saved in parallel, a failure is reported after the loop
+                const QImage &exportImage = exportView ? viewImage : *mImage;
                 if(mAnimation.isVideo())
                 {
                     fileName = (dest + "/" + mAnimation.getFileBase() + "%1.png")
                                    .arg(mPlayerWidget->getPos(), numLength, 10, QChar('0'));
-                    if(exportView)
-                    {
-                        saveRet = viewImage->save(fileName);
-                    }
-                    else
-                    {
-                        saveRet = mImage->save(fileName);
-                    }
+                    saveRet = imageWriter.write(exportImage, fileName);
                 }
                 else if(formatIsSaveAble)
                 {
                     fileName = dest + "/" + mAnimation.getCurrentFileName();
-                    if(exportView)
-                    {
-                        saveRet = viewImage->save(fileName);
-                    }
-                    else
-                    {
-                        saveRet = mImage->save(fileName);
-                    }
+                    saveRet  = imageWriter.write(exportImage, fileName);
                 }
                 else
                 {
                     fileName = dest + "/" + QFileInfo(mAnimation.getCurrentFileName()).completeBaseName() + ".png";
-                    if(exportView)
-                    {
-                        saveRet = viewImage->save(fileName);
-                    }
-                    else
-                    {
-                        saveRet = mImage->save(fileName, "PNG"); //, int quality = -1 default normal (0..100)
-                    }
+                    saveRet  = imageWriter.write(exportImage, fileName, exportView ? QString() : QString("PNG"));
                 }
                 if(!saveRet)
                 {
-                    progress.setValue(progEnd);
-                    PCritical(this, tr("PeTrack"), tr("Cannot export %1.").arg(fileName));
                     break;
                 }
             }
         } while(mPlayerWidget->frameForward());
 
-        if(!exportVideo && exportView)
+        if(!exportVideo && !imageWriter.finish())
         {
-            delete viewImage;
-            delete painter;
+            progress.setValue(progEnd);
+            PCritical(this, tr("PeTrack"), tr("Cannot export %1.").arg(imageWriter.getFailedFile()));
         }
 
         // bei abbruch koennen es auch mPlayerWidget->getPos() frames sein, die bisher geschrieben wurden
@@ -1465,14 +1695,117 @@ void Petrack::exportSequence(bool exportVideo, bool exportView, QString dest) //
 
         if(exportVideo)
         {
-            outputVideo.release();
+            outputVideo.close();
         }
 
+        mExportRunning = false;
         mPlayerWidget->skipToFrame(memPos);
         lastDir = dest;
     }
 }
 
+/// Size of the frames of an exported view: the visible part of the scene or the whole scene
+QSize Petrack::exportViewSize() const
+{
+    if(mCropZoomViewAct->isChecked())
+    {
+        return mView->viewport()->size();
+    }
+    return QSize(static_cast<int>(mScene->width()), static_cast<int>(mScene->height()));
+}
+
+/**
+ * @brief Renders the view of the current frame as exported by exportSequence() into image
+ *
+ * The items of the scene can only be painted in the GUI thread, but the encoding of the
+ * images is done by other threads. If image is still shared with them, a new image is
+ * rendered instead of detaching (copying) the old one, which is overwritten completely anyway.
+ */
+void Petrack::renderExportView(QImage &image)
+{
+    if(!image.isDetached() || image.size() != exportViewSize())
+    {
+        image = QImage(exportViewSize(), QImage::Format_RGB32);
+        image.fill(Qt::black);
+    }
+    QPainter painter(&image);
+    if(mCropZoomViewAct->isChecked())
+    {
+        mView->render(&painter);
+    }
+    else
+    {
+        mScene->render(&painter);
+    }
+}
+
+/**
+ * @brief Exports the point clouds of the sequence from the current frame on into one binary PLY file
+ *
+ * The clouds are computed frame by frame and written by a PointCloudWriter in the
+ * background. Only every POINT_CLOUD_DECIMATION-th row and column is exported and, if
+ * POINT_CLOUD_ROI_ONLY is set, only the points inside of the tracking ROI.
+ *
+ * @param dest name of the PLY file
+ * @return true, if all frames up to the end or the cancellation were written
+ */
+bool Petrack::exportPointCloudSequence(const QString &dest)
+{
+    if(!mStereoContext)
+    {
+        return false;
+    }
+
+    PointCloudWriter writer;
+    if(!writer.open(dest))
+    {
+        PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest, writer.getErrorString()));
+        return false;
+    }
+    SPDLOG_INFO("export point clouds to {}...", dest);
+
+    const int memPos  = mPlayerWidget->getPos();
+    const int progEnd = mAnimation.getSourceOutFrameNum() - memPos;
+
+    QProgressDialog progress("Export point clouds...", "Abort export", 0, progEnd, this);
+    progress.setWindowModality(Qt::WindowModal); // blocks main window
+
+    bool ok = true;
+    do
+    {
+        progress.setValue(mPlayerWidget->getPos() - memPos);
+        qApp->processEvents();
+        if(progress.wasCanceled())
+        {
+            break;
+        }
+
+        cv::Rect roi(0, 0, mImgFiltered.cols, mImgFiltered.rows);
+        if(mPointCloudRoiOnly)
+        {
+            const QRectF rect = mTrackingRoiItem->rect();
+            roi               = cv::Rect(
+                myRound(rect.x() + getImageBorderSize()),
+                myRound(rect.y() + getImageBorderSize()),
+                myRound(rect.width()),
+                myRound(rect.height()));
+        }
+        // the writer encodes and writes the former frames meanwhile
+        ok = writer.write(mAnimation.getCurrentFrameNum(), mStereoContext->getCloudPoints(roi, mPointCloudDecimation));
+    } while(ok && mPlayerWidget->frameForward());
+
+    ok = writer.finish() && ok;
+    progress.setValue(progEnd);
+    if(!ok)
+    {
+        PCritical(this, tr("PeTrack"), tr("Cannot export %1:\n%2.").arg(dest, writer.getErrorString()));
+    }
+    SPDLOG_INFO("wrote {} points of {} frames.", writer.getNumPoints(), mPlayerWidget->getPos() + 1 - memPos);
+
+    mPlayerWidget->skipToFrame(memPos);
+    return ok;
+}
+
 /**
  * @brief Saves the current View, including visualizations, in a file (e.g. pdf)
  *
@@ -1652,12 +1985,22 @@ void Petrack::setFPS(double fps)
     mAnimation.setSequenceFPS(fps);
     mPlayerWidget->setPlaybackFPS(fps);
     updateWindowTitle();
+    updateMoCapVideoDuration();
 }
 
 void Petrack::setSequenceFPS(double fps)
 {
     mAnimation.setSequenceFPS(fps);
     updateWindowTitle();
+    updateMoCapVideoDuration();
+}
+
+/// passes the duration of the sequence to the MoCap visualization, which only stores the samples overlapping it
+void Petrack::updateMoCapVideoDuration()
+{
+    const int    numFrames = mAnimation.getNumFrames();
+    const double fps       = mAnimation.getSequenceFPS();
+    mMoCapController.setVideoDuration(numFrames > 0 && fps > 0 ? numFrames / fps : -1);
 }
 
 void Petrack::setSequenceFPSDialog()
@@ -1766,6 +2109,22 @@ void Petrack::antialias()
 {
     mView->setRenderHint(QPainter::Antialiasing, mAntialiasAct->isChecked());
 }
+/**
+ * @brief Runs PeTrack without showing the main window, e.g. on cluster nodes without a display
+ *
+ * The frames are processed as usual, but neither painted nor copied into the shown image,
+ * unless they are exported. The view does not use OpenGL, as offscreen platforms mostly
+ * provide no OpenGL context.
+ */
+void Petrack::setHeadless(bool headless)
+{
+    mHeadless = headless;
+    if(headless && mOpenGLAct->isChecked())
+    {
+        mView->setViewport(new QWidget);
+    }
+}
+
 void Petrack::opengl()
 {
     mView->setViewport(mOpenGLAct->isChecked() ? new QGLWidget(QGLFormat(QGL::SampleBuffers)) : new QWidget);
@@ -1805,12 +2164,38 @@ void Petrack::showHideControlWidget()
     // show | hide Control
     mViewWidget->hideControls(mHideControlsAct->isChecked());
 }
+LogWindow *Petrack::getLogWindow()
+{
+    if(!mLogWindow)
+    {
+        mLogWindow = new LogWindow(this, nullptr);
+        mLogWindow->setWindowFlags(Qt::Window);
+        mLogWindow->setWindowTitle("Log");
+    }
+    return mLogWindow;
+}
 void Petrack::showLogWindow()
 {
-    mLogWindow->show();
+    getLogWindow()->show();
+}
+void Petrack::showStatisticsPanel()
+{
+    if(!mStatisticsPanel)
+    {
+        mStatisticsPanel = new StatisticsPanel(*this, this);
+        addDockWidget(Qt::RightDockWidgetArea, mStatisticsPanel);
+    }
+    mStatisticsPanel->show();
+    mStatisticsPanel->raise();
 }
 void Petrack::showGroupAnnotationWindow()
 {
+    if(!mGroupingWidget)
+    {
+        mGroupingWidget = new AnnotationGroupWidget(mGroupManager, mAnimation, this);
+        mGroupingWidget->setWindowFlags(Qt::Window);
+        mGroupingWidget->setWindowTitle("Annotation Groups");
+    }
     mGroupingWidget->show();
 }
 
@@ -1863,6 +2248,11 @@ void Petrack::createActions()
     mEditMoCapAct = new QAction(tr("Edit MoCap Settings"), this);
     connect(mEditMoCapAct, &QAction::triggered, this, &Petrack::editMoCapSettings);
 
+#ifdef PYTHON
+    mRunPythonScriptAct = new QAction(tr("Run Python Script..."), this);
+    connect(mRunPythonScriptAct, &QAction::triggered, this, &Petrack::runPythonScript);
+#endif
+
     mExportSeqVidAct = new QAction(tr("Export Video"), this);
     mExportSeqVidAct->setEnabled(false);
     connect(mExportSeqVidAct, SIGNAL(triggered()), this, SLOT(exportVideo()));
@@ -1921,6 +2311,12 @@ void Petrack::createActions()
     mSetSequenceFPSAct->setToolTip(tr("Set native FPS of sequence/video (not playback speed)"));
     connect(mSetSequenceFPSAct, &QAction::triggered, this, &Petrack::setSequenceFPSDialog);
 
+    mMezzanineAct = new QAction(tr("Prepare All-Intra Copy"), this);
+    mMezzanineAct->setCheckable(true);
+    mMezzanineAct->setToolTip(
+        tr("Copy the working range of the video in the background, so every frame can be decoded on its own"));
+    connect(mMezzanineAct, &QAction::triggered, this, &Petrack::setMezzanine);
+
     mExitAct = new QAction(tr("Exit"), this);
     mExitAct->setShortcut(tr("Ctrl+Q"));
     connect(mExitAct, SIGNAL(triggered()), this, SLOT(close()));
@@ -1942,6 +2338,9 @@ void Petrack::createActions()
     mShowLogWindowAct = new QAction(tr("&Show log window"), this);
     connect(mShowLogWindowAct, &QAction::triggered, this, &Petrack::showLogWindow);
 
+    mShowStatisticsPanelAct = new QAction(tr("Show &statistics panel"), this);
+    connect(mShowStatisticsPanelAct, &QAction::triggered, this, &Petrack::showStatisticsPanel);
+
     mShowGroupAnnotationWindowAct = new QAction(tr("&Show Group Annotation Window"), this);
     connect(mShowGroupAnnotationWindowAct, &QAction::triggered, this, &Petrack::showGroupAnnotationWindow);
 
@@ -2023,6 +2422,7 @@ void Petrack::createActions()
         [&]()
         {
             mPersonStorage.undo();
+            mGroupManager.invalidateGroupIndex();
             updateControlWidget();
             getScene()->views().first()->viewport()->repaint();
         });
@@ -2037,6 +2437,7 @@ void Petrack::createActions()
         [&]()
         {
             mPersonStorage.redo();
+            mGroupManager.invalidateGroupIndex();
             updateControlWidget();
             getScene()->views().first()->viewport()->repaint();
         });
@@ -2059,6 +2460,8 @@ void Petrack::createActions()
     connect(mDelAllRoiAct, &QAction::triggered, this, &Petrack::deleteTrackPointROI);
     mDelPartRoiAct = new QAction(tr("Delete part of trj. inside &ROI"), this);
     connect(mDelPartRoiAct, &QAction::triggered, this, &Petrack::deleteTrackPointInsideROI);
+    mRetrackAct = new QAction(tr("Re&track selected trj. ..."), this);
+    connect(mRetrackAct, &QAction::triggered, this, &Petrack::retrackSelectedPersons);
 
     // -------------------------------------------------------------------------------------------------------
 
@@ -2090,8 +2493,12 @@ void Petrack::createMenus()
     mFileMenu->addAction(mOpenSeqAct);
     mFileMenu->addAction(mOpenCameraAct);
     mFileMenu->addAction(mSetSequenceFPSAct);
+    mFileMenu->addAction(mMezzanineAct);
     mFileMenu->addAction(mOpenMoCapAct);
     mFileMenu->addAction(mEditMoCapAct);
+#ifdef PYTHON
+    mFileMenu->addAction(mRunPythonScriptAct);
+#endif
     mFileMenu->addAction(mExportSeqVidAct);
     mFileMenu->addAction(mExportImageAct);
     mFileMenu->addAction(mExportSeqImgAct);
@@ -2112,6 +2519,8 @@ void Petrack::createMenus()
     mEditMenu->addAction(mDelFutureAct);
     mEditMenu->addAction(mDelAllRoiAct);
     mEditMenu->addAction(mDelPartRoiAct);
+    mEditMenu->addSeparator();
+    mEditMenu->addAction(mRetrackAct);
 
 
     mViewMenu = new QMenu(tr("&View"), this);
@@ -2143,6 +2552,7 @@ void Petrack::createMenus()
     mViewMenu->addAction(mHideControlsAct);
     mViewMenu->addSeparator();
     mViewMenu->addAction(mShowLogWindowAct);
+    mViewMenu->addAction(mShowStatisticsPanelAct);
     mViewMenu->addAction(mShowGroupAnnotationWindowAct);
 
 
@@ -2171,6 +2581,7 @@ void Petrack::createStatusBar()
     statusBar()->addPermanentWidget(mStatusLabelStereo = new QLabel(" "));
     statusBar()->addPermanentWidget(mStatusLabelTime = new QLabel(" "));
     statusBar()->addPermanentWidget(mStatusLabelFPS = new QLabel(" "));
+    statusBar()->addPermanentWidget(mStatusLabelDropped = new QLabel(" "));
     statusBar()->addPermanentWidget(mStatusPosRealHeight = new QDoubleSpinBox());
     connect(mStatusPosRealHeight, SIGNAL(valueChanged(double)), this, SLOT(setStatusPosReal()));
 
@@ -2185,6 +2596,9 @@ void Petrack::createStatusBar()
     mStatusLabelFPS->setMinimumWidth(80);
     mStatusLabelFPS->setAutoFillBackground(true);
     mStatusLabelFPS->setToolTip("Click to adapt play rate to fps rate");
+    mStatusLabelDropped->setFont(f);
+    mStatusLabelDropped->setToolTip("Camera frames dropped, because the processing could not keep up");
+    mStatusLabelDropped->hide();
     mStatusPosRealHeight->setRange(-999.9, 9999.9); // in cm
     mStatusPosRealHeight->setDecimals(1);
     mStatusPosRealHeight->setFont(f);
@@ -2262,6 +2676,16 @@ void Petrack::setStatusFPS()
 
         mStatusLabelFPS->setPalette(pal);
     }
+    if(mStatusLabelDropped)
+    {
+        mStatusLabelDropped->setVisible(mAnimation.isCameraLiveStream());
+        QString text = QString("%1 dropped  ").arg(mAnimation.getDroppedLiveFrames());
+        if(mLiveBudget.isEnabled())
+        {
+            text += QString("%1 ms (level %2)  ").arg(mLiveBudget.getLatency(), 0, 'f', 1).arg(mLiveBudget.getLevel());
+        }
+        mStatusLabelDropped->setText(text);
+    }
 }
 void Petrack::setShowFPS(double fps)
 {
@@ -2598,74 +3022,53 @@ void Petrack::importTracker(QString dest) // default = ""
     // if no destination file or folder is given
     if(dest.isEmpty())
     {
-        dest = QFileDialog::getOpenFileName(
-            this,
-            tr("Select file for importing tracking pathes"),
-            lastFile,
-            tr("PeTrack tracker (*.trc *.txt);;All files (*.*)"));
+        QString patterns = "*.trc *.txt";
+#ifdef HDF5
+        patterns += " *.h5 *.hdf5";
+#endif
+        if(compression::isSupported())
+        {
+            patterns += " *.trc.zst *.txt.zst";
+        }
+        const QString filter = tr("PeTrack tracker (%1);;All files (*.*)").arg(patterns);
+        dest = QFileDialog::getOpenFileName(this, tr("Select file for importing tracking pathes"), lastFile, filter);
     }
 
     if(!dest.isEmpty())
     {
-        if(dest.endsWith(".trc", Qt::CaseInsensitive))
+        // e.g. .trc for trajectories.trc.zst
+        const QString format     = compression::uncompressedName(dest);
+        const bool    compressed = compression::isCompressed(dest);
+        if(format.endsWith(".trc", Qt::CaseInsensitive))
         {
-            QFile file(dest);
-            int   i, sz;
-
-            if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+            // huge files are read from their index, which only maps the points into memory;
+            // with a session snapshot every trc file gets an index for reopening the project
+            auto trc = IO::readIndexedTrc(dest, mSessionSnapshot ? 0 : IO::MIN_INDEXED_TRC_SIZE);
+            if(const auto *error = std::get_if<std::string>(&trc))
             {
-                // errorstring ist je nach Betriebssystem in einer anderen Sprache!!!!
-                PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2").arg(dest).arg(file.errorString()));
+                SPDLOG_ERROR("could not read TRC file: {}", *error);
+                PCritical(
+                    this,
+                    tr("PeTrack"),
+                    tr("Could not import tracker %1:\n%2").arg(dest).arg(QString::fromStdString(*error)));
                 return;
             }
+            auto &trcData = std::get<IO::TrcData>(trc);
 
             setTrackChanged(true); // flag changes of track parameters
             mTracker->reset();
+            // a running autosave writes the trajectories with the current trcVersion
+            mAutosave.waitForSaveTrc();
+            trcVersion = trcData.version;
 
-            QTextStream in(&file);
-            QString     comment;
-
-            bool    ok; // shows if int stands in first line - that was in the first version of trc file
-            QString firstLine = in.readLine();
-            sz                = firstLine.toInt(&ok);
-            if(!ok)
+            const auto sz = trcData.persons.size();
+            if((sz > 0) && (mPersonStorage.nbPersons() != 0))
             {
-                if(firstLine.contains("version 4", Qt::CaseInsensitive))
-                {
-                    trcVersion = 4;
-                }
-                else if(firstLine.contains("version 3", Qt::CaseInsensitive))
-                {
-                    trcVersion = 3;
-                }
-                else if(firstLine.contains("version 2", Qt::CaseInsensitive))
-                {
-                    trcVersion = 2;
-                }
-                else
-                {
-                    SPDLOG_ERROR("wrong header while reading TRC file.");
-                    QMessageBox::critical(
-                        this,
-                        tr("PeTrack"),
-                        tr("Could not import tracker:\nNot supported trc version in file: %1.").arg(dest));
-                    return;
-                }
-                in >> sz;
+                SPDLOG_WARN("overlapping trajectories will be joined not until tracking adds new TrackPoints.");
             }
-            else
+            for(const auto &person : trcData.persons)
             {
-                trcVersion = 1;
-            }
-
-            if((sz > 0) && (mPersonStorage.nbPersons() != 0))
-            {
-                SPDLOG_WARN("overlapping trajectories will be joined not until tracking adds new TrackPoints.");
-            }
-            for(i = 0; i < sz; ++i)
-            {
-                TrackPerson tp = fromTrc(in);
-                mPersonStorage.addPerson(tp);
+                mPersonStorage.addPerson(person);
             }
 
             mControlWidget->setTrackNumberAll(QString("%1").arg(mPersonStorage.nbPersons()));
@@ -2673,13 +3076,12 @@ void Petrack::importTracker(QString dest) // default = ""
             mControlWidget->setTrackNumberVisible(
                 QString("%1").arg(mPersonStorage.visible(mAnimation.getCurrentFrameNum())));
             mControlWidget->replotColorplot();
-            file.close();
             SPDLOG_INFO("import {} ({} person(s), file version {})", dest, sz, trcVersion);
             mTrcFileName =
                 dest; // fuer Project-File, dann koennte track path direkt mitgeladen werden, wenn er noch da ist
         }
-        else if(dest.endsWith(".txt", Qt::CaseInsensitive)) // 3D Koordinaten als Tracking-Daten importieren
-                                                            // Zeilenformat: Personennr, Framenr, x, y, z
+        else if(format.endsWith(".txt", Qt::CaseInsensitive)) // 3D Koordinaten als Tracking-Daten importieren
+                                                              // Zeilenformat: Personennr, Framenr, x, y, z
         {
             PWarning(
                 this,
@@ -2688,21 +3090,33 @@ void Petrack::importTracker(QString dest) // default = ""
                    "coordinate "
                    "system now is exactly at the same position and orientation than at export time!"));
 
-            QFile file(dest);
+            QFile               file(dest);
+            compression::Reader reader(file, compressed);
 
             int numberImportedPersons = 0;
 
-            if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+            // QTextStream handles the line endings of the decompressed text
+            QIODevice::OpenMode mode = QIODevice::ReadOnly;
+            if(!compressed)
+            {
+                mode |= QIODevice::Text;
+            }
+            if(!file.open(mode))
             {
                 // errorstring ist je nach Betriebssystem in einer anderen Sprache!!!!
                 PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2").arg(dest).arg(file.errorString()));
                 return;
             }
+            if(!reader.open(QIODevice::ReadOnly))
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2").arg(dest).arg(reader.errorString()));
+                return;
+            }
 
             setTrackChanged(true); // flag changes of track parameters
             mTracker->reset();
 
-            QTextStream in(&file);
+            QTextStream in(&reader);
             TrackPoint  tPoint;
 
             QString line;
@@ -2760,58 +3174,69 @@ void Petrack::importTracker(QString dest) // default = ""
                 }
             }
 
-            for(auto &[persNr, frameData] : personData)
-            {
-                std::deque<TrackPoint> pixelPoints;
-                for(auto &[frameNr, realWorldCoordinates] : frameData)
-                {
-                    cv::Point2f p2d;
-
-                    if(mControlWidget->getCalibCoordDimension() == 0)
-                    {
-                        // compute image point from 3d calibration
-                        p2d = mExtrCalibration.getImagePoint(
-                            cv::Point3f(realWorldCoordinates.x(), realWorldCoordinates.y(), realWorldCoordinates.z()));
-                    }
-                    else
-                    {
-                        // compute image point from 2d calibration
-                        QPointF pos = mWorldImageCorrespondence->getPosImage(
-                            QPointF(realWorldCoordinates.x(), realWorldCoordinates.y()), realWorldCoordinates.z());
-                        p2d.x = pos.x();
-                        p2d.y = pos.y();
-                    }
+            numberImportedPersons = importWorldTrajectories(personData);
 
-                    TrackPoint trackPoint(Vec2F(p2d.x, p2d.y), 100);
-                    trackPoint.setSp(
-                        realWorldCoordinates.x(),
-                        realWorldCoordinates.y(),
-                        -mControlWidget->getExtrinsicParameters().trans3 -
-                            realWorldCoordinates.z()); // distance to camera as with stereo cameras
-                    pixelPoints.push_back(trackPoint);
-                }
+            mControlWidget->setTrackNumberAll(QString("%1").arg(mPersonStorage.nbPersons()));
+            mControlWidget->setTrackShowOnlyNr(static_cast<int>(MAX(mPersonStorage.nbPersons(), 1)));
+            mControlWidget->setTrackNumberVisible(
+                QString("%1").arg(mPersonStorage.visible(mAnimation.getCurrentFrameNum())));
+            mControlWidget->replotColorplot();
+            file.close();
+            SPDLOG_INFO("import {} ({} person(s))", dest, numberImportedPersons);
+            mTrcFileName = dest;
+        }
+#ifdef HDF5
+        else if(dest.endsWith(".h5", Qt::CaseInsensitive) || dest.endsWith(".hdf5", Qt::CaseInsensitive))
+        {
+            PWarning(
+                this,
+                tr("PeTrack"),
+                tr("Are you sure you want to import 3D data from HDF5-File? You have to make sure that the "
+                   "coordinate system now is exactly at the same position and orientation than at export time!"));
 
-                TrackPerson trackPerson(persNr, frameData.begin()->first, pixelPoints.front());
-                trackPerson.setHeight(frameData.begin()->second.z());
-                pixelPoints.pop_front();
+            TrajectoryColumns columns;
+            try
+            {
+                columns = trajectoryHdf5::readColumns(dest);
+            }
+            catch(const std::runtime_error &error)
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot import %1:\n%2").arg(dest).arg(error.what()));
+                return;
+            }
 
-                for(const auto &trackPoint : pixelPoints)
+            std::unordered_map<int, std::map<int, Vec3F>> personData;
+            for(std::size_t row = 0; row < columns.size(); ++row)
+            {
+                const int personNr = columns.id[row];
+                const int frameNr  = columns.frame[row];
+                if(!personData[personNr].emplace(frameNr, Vec3F(columns.x[row], columns.y[row], columns.z[row])).second)
                 {
-                    trackPerson.append(trackPoint);
+                    PCritical(
+                        this,
+                        "Error importing HDF5 file",
+                        tr("Could not import the data from the provided HDF5 file, as the data for person %1 in "
+                           "frame %2 is twice in the file.")
+                            .arg(personNr)
+                            .arg(frameNr));
+                    return;
                 }
-                mPersonStorage.addPerson(trackPerson);
-                numberImportedPersons++;
             }
 
+            setTrackChanged(true); // flag changes of track parameters
+            mTracker->reset();
+
+            int numberImportedPersons = importWorldTrajectories(personData);
+
             mControlWidget->setTrackNumberAll(QString("%1").arg(mPersonStorage.nbPersons()));
             mControlWidget->setTrackShowOnlyNr(static_cast<int>(MAX(mPersonStorage.nbPersons(), 1)));
             mControlWidget->setTrackNumberVisible(
                 QString("%1").arg(mPersonStorage.visible(mAnimation.getCurrentFrameNum())));
             mControlWidget->replotColorplot();
-            file.close();
             SPDLOG_INFO("import {} ({} person(s))", dest, numberImportedPersons);
             mTrcFileName = dest;
         }
+#endif
         else
         {
             PCritical(this, tr("PeTrack"), tr("Cannot load %1 maybe because of wrong file extension.").arg(dest));
@@ -2820,6 +3245,62 @@ void Petrack::importTracker(QString dest) // default = ""
     }
 }
 
+/**
+ * @brief Adds persons given in world coordinates (cm) to the person storage
+ *
+ * The image points are computed with the current calibration.
+ *
+ * @param personData world coordinates per frame for each person number
+ * @return number of added persons
+ */
+int Petrack::importWorldTrajectories(const std::unordered_map<int, std::map<int, Vec3F>> &personData)
+{
+    int numberImportedPersons = 0;
+    for(const auto &[persNr, frameData] : personData)
+    {
+        std::deque<TrackPoint> pixelPoints;
+        for(const auto &[frameNr, realWorldCoordinates] : frameData)
+        {
+            cv::Point2f p2d;
+
+            if(mControlWidget->getCalibCoordDimension() == 0)
+            {
+                // compute image point from 3d calibration
+                p2d = mExtrCalibration.getImagePoint(
+                    cv::Point3f(realWorldCoordinates.x(), realWorldCoordinates.y(), realWorldCoordinates.z()));
+            }
+            else
+            {
+                // compute image point from 2d calibration
+                QPointF pos = mWorldImageCorrespondence->getPosImage(
+                    QPointF(realWorldCoordinates.x(), realWorldCoordinates.y()), realWorldCoordinates.z());
+                p2d.x = pos.x();
+                p2d.y = pos.y();
+            }
+
+            TrackPoint trackPoint(Vec2F(p2d.x, p2d.y), 100);
+            trackPoint.setSp(
+                realWorldCoordinates.x(),
+                realWorldCoordinates.y(),
+                -mControlWidget->getExtrinsicParameters().trans3 -
+                    realWorldCoordinates.z()); // distance to camera as with stereo cameras
+            pixelPoints.push_back(trackPoint);
+        }
+
+        TrackPerson trackPerson(persNr, frameData.begin()->first, pixelPoints.front());
+        trackPerson.setHeight(frameData.begin()->second.z());
+        pixelPoints.pop_front();
+
+        for(const auto &trackPoint : pixelPoints)
+        {
+            trackPerson.append(trackPoint);
+        }
+        mPersonStorage.addPerson(trackPerson);
+        numberImportedPersons++;
+    }
+    return numberImportedPersons;
+}
+
 int Petrack::calculateRealTracker()
 {
     bool autoCorrectOnlyExport = (mReco.getRecoMethod() == reco::RecognitionMethod::MultiColor) && // multicolor
@@ -2850,8 +3331,47 @@ int Petrack::calculateRealTracker()
 }
 
 
+/**
+ * @brief Reports duplicate trajectories before an export and merges them, if enabled
+ *
+ * Two trajectories are duplicates, e.g. two IDs on one head, if their points are closer
+ * than mDuplicateDistance times the head size in at least mDuplicateShare of their
+ * common frames. Such pairs otherwise only show up in the equality check of the
+ * plausibility checks or as ambiguous matches while tracking.
+ */
+void Petrack::handleDuplicates()
+{
+    if(mDuplicateDistance <= 0)
+    {
+        return;
+    }
+    TRACE_ZONE("Petrack::handleDuplicates");
+    constexpr int minFrames = 5; // shorter overlaps are rather the end of one and the start of another trajectory
+
+    const auto duplicates =
+        plausibility::findDuplicates(mPersonStorage, *this, mDuplicateDistance, mDuplicateShare, minFrames);
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for(const auto &duplicate : duplicates)
+    {
+        SPDLOG_WARN(
+            "person {} and person {} are close in {} of their {} common frames and seem to be duplicates",
+            duplicate.pers1 + 1,
+            duplicate.pers2 + 1,
+            duplicate.closeFrames,
+            duplicate.commonFrames);
+        pairs.emplace_back(duplicate.pers1, duplicate.pers2);
+    }
+    if(mMergeDuplicates && !pairs.empty())
+    {
+        const int merged = mPersonStorage.mergeDuplicates(pairs);
+        SPDLOG_INFO("merged {} pair(s) of duplicate trajectories before the export.", merged);
+        updateControlWidget();
+    }
+}
+
 void Petrack::exportTracker(QString dest) // default = ""
 {
+    TRACE_ZONE("Petrack::exportTracker");
     try
     {
         if(!mTracker)
@@ -2863,12 +3383,24 @@ void Petrack::exportTracker(QString dest) // default = ""
         // if no destination file or folder is given
         if(dest.isEmpty())
         {
-            QFileDialog fileDialog(
-                this,
-                tr("Select file for exporting tracking paths"),
-                mLastTrackerExport,
-                tr("Tracker (*.*);;Petrack tracker (*.trc);;Text (*.txt);;Text for gnuplot(*.dat);;XML Travisto "
-                   "(*.trav);;All supported types (*.txt *.trc *.dat *.trav *.);;All files (*.*)"));
+            QString filter = tr("Tracker (*.*);;Petrack tracker (*.trc);;Text (*.txt);;Text for gnuplot(*.dat);;XML "
+                                "Travisto (*.trav)");
+            QString patterns = "*.txt *.trc *.dat *.trav";
+#ifdef HDF5
+            filter += tr(";;HDF5 (*.h5 *.hdf5)");
+            patterns += " *.h5 *.hdf5";
+#endif
+#ifdef SQLITE
+            filter += tr(";;SQLite (*.sqlite *.db)");
+            patterns += " *.sqlite *.db";
+#endif
+            if(compression::isSupported())
+            {
+                filter += tr(";;Compressed (*.trc.zst *.txt.zst *.dat.zst *.trav.zst)");
+                patterns += " *.trc.zst *.txt.zst *.dat.zst *.trav.zst";
+            }
+            filter += tr(";;All supported types (%1 *.);;All files (*.*)").arg(patterns);
+            QFileDialog fileDialog(this, tr("Select file for exporting tracking paths"), mLastTrackerExport, filter);
             fileDialog.setAcceptMode(QFileDialog::AcceptSave);
             fileDialog.setFileMode(QFileDialog::AnyFile);
             fileDialog.setDefaultSuffix("");
@@ -2884,30 +3416,32 @@ void Petrack::exportTracker(QString dest) // default = ""
             }
         }
 
+        // e.g. .trc for trajectories.trc.zst, which is compressed while writing
+        const QString format     = compression::uncompressedName(dest);
+        const bool    compressed = compression::isCompressed(dest);
+
         QList<int> pers, frame;
         bool autoCorrectOnlyExport = (mReco.getRecoMethod() == reco::RecognitionMethod::MultiColor) && // multicolor
                                      mMultiColorMarkerWidget->autoCorrect->isChecked() &&
                                      mMultiColorMarkerWidget->autoCorrectOnlyExport->isChecked();
 
-        if(dest.endsWith(".trc", Qt::CaseInsensitive))
+        handleDuplicates();
+
+        if(format.endsWith(".trc", Qt::CaseInsensitive))
         {
-            QTemporaryFile file;
+            QTemporaryFile      file;
+            compression::Writer output(file, compressed);
 
             if(!file.open() /*!file.open(QIODevice::WriteOnly | QIODevice::Text)*/)
             {
                 PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest).arg(file.errorString()));
                 return;
             }
-            QProgressDialog progress(
-                "Export TRC-File", nullptr, 0, static_cast<int>(mPersonStorage.nbPersons() + 1), this->window());
-            progress.setWindowTitle("Export .trc-File");
-            progress.setWindowModality(Qt::WindowModal);
-            progress.setVisible(true);
-            progress.setValue(0);
-            progress.setLabelText(QString("Export tracking data ..."));
-
-            qApp->processEvents();
-
+            if(!output.open(QIODevice::WriteOnly))
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest).arg(output.errorString()));
+                return;
+            }
             trcVersion = 4;
 
             SPDLOG_INFO(
@@ -2915,23 +3449,21 @@ void Petrack::exportTracker(QString dest) // default = ""
                 dest,
                 mPersonStorage.nbPersons(),
                 trcVersion);
-            QTextStream out(&file);
-
-            out << "version " << trcVersion << Qt::endl;
-            out << mPersonStorage.nbPersons() << Qt::endl;
-            const auto &persons = mPersonStorage.getPersons();
-            for(size_t i = 0; i < persons.size(); ++i)
+            // the copy shares the track points with the trajectories
+            const std::vector<TrackPerson> persons = mPersonStorage.getPersons();
+            const bool                     written = runExport(
+                this->window(),
+                "Export .trc-File",
+                static_cast<int>(persons.size()),
+                [&output, &persons](const ThrottledProgress::Callback &progress)
+                { return writeTrc(output, persons, progress) && output.finish(); });
+            output.close();
+            file.close();
+            if(!written)
             {
-                qApp->processEvents();
-                progress.setLabelText(QString("Export person %1 of %2 ...").arg(i + 1).arg(mPersonStorage.nbPersons()));
-                progress.setValue(static_cast<int>(i + 1));
-                out << persons[i] << Qt::endl;
+                PCritical(this, tr("PeTrack"), tr("Cannot write %1:\n%2.").arg(dest).arg(output.errorString()));
+                return;
             }
-            file.flush();
-            file.close();
-
-            progress.setLabelText(QString("Save file ..."));
-            qApp->processEvents();
 
             if(QFile::exists(dest))
             {
@@ -2951,23 +3483,27 @@ void Petrack::exportTracker(QString dest) // default = ""
                 statusBar()->showMessage(tr("Saved tracking data to %1.").arg(dest), 5000);
             }
 
-            progress.setValue(static_cast<int>(mPersonStorage.nbPersons() + 1));
-
             SPDLOG_INFO("finished.");
             mAutosave.resetTrackPersonCounter();
 
             mTrcFileName =
                 dest; // fuer Project-File, dann koennte track path direkt mitgeladen werden, wenn er// noch da ist
         }
-        else if(dest.endsWith(".txt", Qt::CaseInsensitive))
+        else if(format.endsWith(".txt", Qt::CaseInsensitive))
         {
-            QTemporaryFile file;
+            QTemporaryFile      file;
+            compression::Writer output(file, compressed);
 
             if(!file.open())
             {
                 PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest).arg(file.errorString()));
                 return;
             }
+            if(!output.open(QIODevice::WriteOnly))
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest).arg(output.errorString()));
+                return;
+            }
 
             SPDLOG_INFO("export tracking data to {} ({} person(s))...", dest, mPersonStorage.nbPersons());
 
@@ -3006,7 +3542,7 @@ void Petrack::exportTracker(QString dest) // default = ""
                 mControlWidget->isExportMarkerIDChecked(),
                 autoCorrectOnlyExport);
 
-            QTextStream out(&file);
+            QTextStream out(&output);
 
             out << "# PeTrack project: " << QFileInfo(getProFileName()).fileName() << Qt::endl;
             out << "# raw trajectory file: " << QFileInfo(getTrackFileName()).fileName() << Qt::endl;
@@ -3036,17 +3572,32 @@ void Petrack::exportTracker(QString dest) // default = ""
                     }
                 }
             }
-            mTrackerReal->exportTxt(
-                out,
-                mControlWidget->getTrackAlternateHeight(),
-                mStereoWidget->stereoUseForExport->isChecked(),
-                mControlWidget->isExportViewDirChecked(),
-                mControlWidget->isExportAngleOfViewChecked(),
-                mControlWidget->isExportUseMeterChecked(),
-                mControlWidget->isExportMarkerIDChecked());
-            // out << *mTrackerReal;
-            file.flush();
+            out.flush();
+
+            const bool alternateHeight = mControlWidget->getTrackAlternateHeight();
+            const bool useTrackpoints  = mStereoWidget->stereoUseForExport->isChecked();
+            const bool viewDir         = mControlWidget->isExportViewDirChecked();
+            const bool angleOfView     = mControlWidget->isExportAngleOfViewChecked();
+            const bool useMeter        = mControlWidget->isExportUseMeterChecked();
+            const bool markerID        = mControlWidget->isExportMarkerIDChecked();
+            const bool written         = runExport(
+                this->window(),
+                "Export .txt-File",
+                mTrackerReal->size(),
+                [&](const ThrottledProgress::Callback &progress)
+                {
+                    BufferedTextWriter writer(output);
+                    mTrackerReal->exportTxt(
+                        writer, alternateHeight, useTrackpoints, viewDir, angleOfView, useMeter, markerID, progress);
+                    return writer.flush() && output.finish();
+                });
+            output.close();
             file.close();
+            if(!written)
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot write %1:\n%2.").arg(dest).arg(output.errorString()));
+                return;
+            }
 
             if(QFile::exists(dest))
             {
@@ -3068,15 +3619,21 @@ void Petrack::exportTracker(QString dest) // default = ""
 
             SPDLOG_INFO("finished");
         }
-        else if(dest.endsWith(".dat", Qt::CaseInsensitive))
+        else if(format.endsWith(".dat", Qt::CaseInsensitive))
         {
-            QTemporaryFile fileDat;
+            QTemporaryFile      fileDat;
+            compression::Writer output(fileDat, compressed);
 
             if(!fileDat.open()) //! fileDat.open(QIODevice::WriteOnly | QIODevice::Text))
             {
                 PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest).arg(fileDat.errorString()));
                 return;
             }
+            if(!output.open(QIODevice::WriteOnly))
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest).arg(output.errorString()));
+                return;
+            }
             // recalcHeight true, wenn personenhoehe ueber trackpoints neu berechnet werden soll (z.b. um
             // waehrend play mehrfachberuecksichtigung von punkten auszuschliessen, aenderungen in altitude neu
             // in berechnung einfliessen zu lassen)
@@ -3105,11 +3662,25 @@ void Petrack::exportTracker(QString dest) // default = ""
                 autoCorrectOnlyExport);
 
             SPDLOG_INFO("export tracking data to {} ({} person(s))...", dest, mPersonStorage.nbPersons());
-            QTextStream outDat(&fileDat);
-            mTrackerReal->exportDat(
-                outDat, mControlWidget->getTrackAlternateHeight(), mStereoWidget->stereoUseForExport->isChecked());
-            fileDat.flush();
+            const bool alternateHeight = mControlWidget->getTrackAlternateHeight();
+            const bool useTrackpoints  = mStereoWidget->stereoUseForExport->isChecked();
+            const bool written         = runExport(
+                this->window(),
+                "Export .dat-File",
+                mTrackerReal->size(),
+                [&](const ThrottledProgress::Callback &progress)
+                {
+                    BufferedTextWriter writer(output);
+                    mTrackerReal->exportDat(writer, alternateHeight, useTrackpoints, progress);
+                    return writer.flush() && output.finish();
+                });
+            output.close();
             fileDat.close();
+            if(!written)
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot write %1:\n%2.").arg(dest).arg(output.errorString()));
+                return;
+            }
 
             if(QFile::exists(dest))
             {
@@ -3131,7 +3702,7 @@ void Petrack::exportTracker(QString dest) // default = ""
 
             SPDLOG_INFO("finished");
         }
-        else if(dest.endsWith(".trav", Qt::CaseInsensitive))
+        else if(format.endsWith(".trav", Qt::CaseInsensitive))
         {
             // recalcHeight true, wenn personenhoehe ueber trackpoints neu berechnet werden soll (z.b. um
             // waehrend play mehrfachberuecksichtigung von punkten auszuschliessen, aenderungen in altitude neu
@@ -3161,16 +3732,22 @@ void Petrack::exportTracker(QString dest) // default = ""
                 mControlWidget->isExportMarkerIDChecked(),
                 autoCorrectOnlyExport);
 
-            QTemporaryFile fileXml;
+            QTemporaryFile      fileXml;
+            compression::Writer output(fileXml, compressed);
             if(!fileXml.open()) //! fileXml.open(QIODevice::WriteOnly | QIODevice::Text))
             {
                 PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest).arg(fileXml.errorString()));
                 return;
             }
+            if(!output.open(QIODevice::WriteOnly))
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot open %1:\n%2.").arg(dest).arg(output.errorString()));
+                return;
+            }
             SPDLOG_INFO("export tracking data to {} ({} person(s))...", dest, mPersonStorage.nbPersons());
             // already done: mTrackerReal->calculate(mTracker, mImageItem, mControlWidget->getColorPlot(),
             // getImageBorderSize(), mControlWidget->trackMissingFrames->checkState());
-            QTextStream outXml(&fileXml);
+            QTextStream outXml(&output);
             outXml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << Qt::endl;
             outXml << "<trajectoriesDataset>" << Qt::endl;
             outXml << "    <header version=\"1.0\">" << Qt::endl;
@@ -3186,13 +3763,28 @@ void Petrack::exportTracker(QString dest) // default = ""
                    << mAnimation.getFirstFrameMicroSec() << "\"/> <!-- " << mAnimation.getTimeString(0) << " -->"
                    << Qt::endl;
             outXml << "    </header>" << Qt::endl << Qt::endl;
-
-            mTrackerReal->exportXml(
-                outXml, mControlWidget->getTrackAlternateHeight(), mStereoWidget->stereoUseForExport->isChecked());
-
-            outXml << "</trajectoriesDataset>" << Qt::endl;
-            fileXml.flush();
+            outXml.flush();
+
+            const bool alternateHeight = mControlWidget->getTrackAlternateHeight();
+            const bool useTrackpoints  = mStereoWidget->stereoUseForExport->isChecked();
+            const bool written         = runExport(
+                this->window(),
+                "Export .xml-File",
+                mTrackerReal->largestLastFrame(),
+                [&](const ThrottledProgress::Callback &progress)
+                {
+                    BufferedTextWriter writer(output);
+                    mTrackerReal->exportXml(writer, alternateHeight, useTrackpoints, progress);
+                    writer.print("</trajectoriesDataset>\n");
+                    return writer.flush() && output.finish();
+                });
+            output.close();
             fileXml.close();
+            if(!written)
+            {
+                PCritical(this, tr("PeTrack"), tr("Cannot write %1:\n%2.").arg(dest).arg(output.errorString()));
+                return;
+            }
 
             if(QFile::exists(dest))
             {
@@ -3214,6 +3806,88 @@ void Petrack::exportTracker(QString dest) // default = ""
 
             SPDLOG_INFO("finished");
         }
+#ifdef HDF5
+        else if(dest.endsWith(".h5", Qt::CaseInsensitive) || dest.endsWith(".hdf5", Qt::CaseInsensitive))
+        {
+            if(mControlWidget->isTrackRecalcHeightChecked() && mControlWidget->getCalibCoordDimension() != 0)
+            {
+                mPersonStorage.recalcHeight(mControlWidget->getCameraAltitude());
+            }
+
+            mTrackerReal->calculate(
+                this,
+                mTracker,
+                mWorldImageCorrespondence,
+                mControlWidget->getColorPlot(),
+                mMissingFrames,
+                getImageBorderSize(),
+                mControlWidget->isTrackMissingFramesChecked(),
+                mStereoWidget->stereoUseForExport->isChecked(),
+                mControlWidget->getTrackAlternateHeight(),
+                mControlWidget->getCameraAltitude(),
+                mStereoWidget->stereoUseCalibrationCenter->isChecked(),
+                mControlWidget->isExportElimTpChecked(),
+                mControlWidget->isExportElimTrjChecked(),
+                mControlWidget->isExportSmoothChecked(),
+                mControlWidget->isExportViewDirChecked(),
+                mControlWidget->isExportAngleOfViewChecked(),
+                mControlWidget->isExportMarkerIDChecked(),
+                autoCorrectOnlyExport);
+
+            SPDLOG_INFO("export tracking data to {} ({} person(s))...", dest, mPersonStorage.nbPersons());
+            // throws std::runtime_error, which is reported below
+            trajectoryHdf5::writeColumns(
+                dest,
+                mTrackerReal->exportColumns(
+                    mControlWidget->getTrackAlternateHeight(), mStereoWidget->stereoUseForExport->isChecked()),
+                mAnimation.getSequenceFPS());
+            statusBar()->showMessage(tr("Saved tracking data to %1.").arg(dest), 5000);
+
+            SPDLOG_INFO("finished");
+        }
+#endif
+#ifdef SQLITE
+        else if(dest.endsWith(".sqlite", Qt::CaseInsensitive) || dest.endsWith(".db", Qt::CaseInsensitive))
+        {
+            if(mControlWidget->isTrackRecalcHeightChecked() && mControlWidget->getCalibCoordDimension() != 0)
+            {
+                mPersonStorage.recalcHeight(mControlWidget->getCameraAltitude());
+            }
+
+            mTrackerReal->calculate(
+                this,
+                mTracker,
+                mWorldImageCorrespondence,
+                mControlWidget->getColorPlot(),
+                mMissingFrames,
+                getImageBorderSize(),
+                mControlWidget->isTrackMissingFramesChecked(),
+                mStereoWidget->stereoUseForExport->isChecked(),
+                mControlWidget->getTrackAlternateHeight(),
+                mControlWidget->getCameraAltitude(),
+                mStereoWidget->stereoUseCalibrationCenter->isChecked(),
+                mControlWidget->isExportElimTpChecked(),
+                mControlWidget->isExportElimTrjChecked(),
+                mControlWidget->isExportSmoothChecked(),
+                mControlWidget->isExportViewDirChecked(),
+                mControlWidget->isExportAngleOfViewChecked(),
+                mControlWidget->isExportMarkerIDChecked(),
+                autoCorrectOnlyExport);
+
+            SPDLOG_INFO("export tracking data to {} ({} person(s))...", dest, mPersonStorage.nbPersons());
+            // throws std::runtime_error, which is reported below
+            trajectoryDatabase::write(
+                dest,
+                mTrackerReal->exportColumns(
+                    mControlWidget->getTrackAlternateHeight(), mStereoWidget->stereoUseForExport->isChecked()),
+                mTrackerReal->exportGroups(),
+                mGroupManager.getGroups(),
+                mAnimation.getSequenceFPS());
+            statusBar()->showMessage(tr("Saved tracking data to %1.").arg(dest), 5000);
+
+            SPDLOG_INFO("finished");
+        }
+#endif
         else
         { // wenn keine Dateiendung, dann wird trc und txt herausgeschrieben
             exportTracker(dest + ".trc");
@@ -3236,6 +3910,9 @@ void Petrack::playAll()
     QProgressDialog progress("Playing whole sequence...", "Abort playing", 0, mAnimation.getNumFrames(), this);
     progress.setWindowModality(Qt::WindowModal); // blocks main window
 
+    mPlayingAll = true;
+    resetFilterStatistics();
+
     // vorwaertslaufen ab aktueller Stelle und trackOnlineCalc zum tracken nutzen
     do
     {
@@ -3247,7 +3924,13 @@ void Petrack::playAll()
         }
     } while(mPlayerWidget->frameForward());
 
-    mPlayerWidget->skipToFrame(memPos);
+    mPlayingAll = false;
+    logFilterStatistics();
+    // the last processed frame may not have been shown
+    if(!mPlayerWidget->skipToFrame(memPos))
+    {
+        updateImage();
+    }
 }
 
 /**
@@ -3268,6 +3951,10 @@ void Petrack::trackAll()
     bool memCheckState = mControlWidget->isOnlineTrackingChecked();
     bool memRecoState  = mControlWidget->isPerformRecognitionChecked();
 
+    mBatchProcessing = true;
+    resetFilterStatistics();
+    mCrowdMetrics.start();
+
     mControlWidget->setOnlineTrackingChecked(true);
     mControlWidget->setPerformRecognitionChecked(true);
 
@@ -3333,10 +4020,20 @@ void Petrack::trackAll()
         mPersonStorage.optimizeColor();
     }
 
+    // the view needs the whole filtered image again
+    mBatchProcessing = false;
+    logFilterStatistics();
+    mCrowdMetrics.finish();
+
     mControlWidget->setPerformRecognitionChecked(memRecoState);
     mControlWidget->setOnlineTrackingChecked(false);
-    mPlayerWidget->skipToFrame(memPos);
+    const bool skipped = mPlayerWidget->skipToFrame(memPos);
     mControlWidget->setOnlineTrackingChecked(memCheckState);
+    // the last processed frame may not have been shown or not undistorted
+    if(!skipped || !mCalibFilter.getRoi().empty() || mRawFrame)
+    {
+        updateImage();
+    }
 }
 
 // default: (QPointF *pos=NULL, int pers=-1, int frame=-1);
@@ -3346,9 +4043,29 @@ int Petrack::winSize(QPointF *pos, int pers, int frame, int level)
     // a factor of 1.6 of the headsize is used
     if(level == -1)
     {
-        level = mControlWidget->getTrackRegionLevels();
+        level = getTrackRegionLevels();
     }
-    return (int) ((getHeadSize(pos, pers, frame) / pow(2., level)) * (mControlWidget->getTrackRegionScale() / 10.));
+    return (int) ((getHeadSize(pos, pers, frame) / pow(2., level)) * (getTrackRegionScale() / 10.));
+}
+
+/// A camera live stream is processed with a latency budget
+bool Petrack::isLiveRealTime() const
+{
+    return mAnimation.isCameraLiveStream() && mLiveBudget.isEnabled();
+}
+
+/// Pyramid levels of the tracking, fewer under load in real-time live processing
+int Petrack::getTrackRegionLevels() const
+{
+    const int levels = mControlWidget->getTrackRegionLevels();
+    return isLiveRealTime() ? mLiveBudget.trackRegionLevels(levels) : levels;
+}
+
+/// Scale of the track region, smaller under load in real-time live processing
+int Petrack::getTrackRegionScale() const
+{
+    const int scale = mControlWidget->getTrackRegionScale();
+    return isLiveRealTime() ? mLiveBudget.trackRegionScale(scale) : scale;
 }
 
 /**
@@ -3366,92 +4083,739 @@ void Petrack::getFilteredImage(
 {
     mImgFiltered = mImg;
 
-    // When applying the filter, the order is important!
-    // Computation heavy filter should be applied early.
-
-    if(imageChanged || swapFilterChanged)
-    {
-        mImgFiltered = mSwapFilter.apply(mImgFiltered);
-    }
-    else
-    {
-        mImgFiltered = mSwapFilter.getLastResult();
+    // the next frames are decoded into buffers which already have the border
+    const bool virtualBorder = mVirtualBorder && mBorderFilter.getEnabled() && !mStereoContext;
+    mAnimation.setVirtualBorder(
+        virtualBorder ? mBorderFilter.getBorderSize().getValue() : 0,
+        cv::Scalar(
+            mBorderFilter.getBorderColB().getValue(),
+            mBorderFilter.getBorderColG().getValue(),
+            mBorderFilter.getBorderColR().getValue()));
+
+    const bool anyFilterChanged =
+        brightContrastFilterChanged || swapFilterChanged || borderFilterChanged || calibFilterChanged;
+    if(anyFilterChanged || mBackgroundFilter.changed())
+    {
+        // detections depend on the filtered image
+        mDetectionCacheName.clear();
     }
 
-    if(imageChanged || swapFilterChanged || brightContrastFilterChanged)
-    {
-        mImgFiltered = mBrightContrastFilter.apply(mImgFiltered);
-    }
-    else
-    {
-        mImgFiltered = mBrightContrastFilter.getLastResult();
-    }
+    const int frameNum = mAnimation.getCurrentFrameNum();
 
-    if(imageChanged || swapFilterChanged || brightContrastFilterChanged || borderFilterChanged)
-    {
-        mImgFiltered = mBorderFilter.apply(mImgFiltered);
-    }
-    else
+    // tracking and recognition on the distorted frame; only their points are undistorted
+    const bool rawFrame = mUndistortPointsOnly && mBatchProcessing && mCalibFilter.getEnabled() && !mStereoContext &&
+                          !mBackgroundFilter.getEnabled();
+    mRawFrame = rawFrame;
+    if(rawFrame)
     {
-        mImgFiltered = mBorderFilter.getLastResult();
+        mPointUndistortion.setCamera(mCalibFilter.getCamParams().getValue());
     }
 
-    if(borderFilterChanged)
+    const cv::Rect filterRoi = getFilterRoi();
+    const bool     roiOnly   = !filterRoi.empty();
+    if(filterRoi != mCalibFilter.getRoi())
     {
-        updateControlImage(mImgFiltered);
+        // last result of the calibration filter belongs to another region
+        mCalibFilter.setRoi(filterRoi);
+        imageChanged        = true;
+        mFilterChainSkipped = true;
     }
 
-    if(imageChanged || swapFilterChanged || brightContrastFilterChanged || borderFilterChanged || calibFilterChanged)
+    // frames of the low resolution proxy are only shown; they are neither stored nor learned as background,
+    // since tracking and recognition reload the frame in full resolution
+    const bool proxyFrame = mAnimation.isProxyFrame();
+
+    // unchanged filter parameters and a stored frame: skip swap, brightness/contrast, border and calibration
+    const bool fusedValid = mFusedPreprocessed;
+    mFusedPreprocessed    = false;
+
+    const auto storeStart = std::chrono::steady_clock::now();
+    if(imageChanged && !anyFilterChanged && !mStereoContext && !rawFrame && !proxyFrame &&
+       mFilteredFrameStore.get(frameNum, mImgFiltered))
     {
-        if(mStereoContext)
-            mStereoContext->init(mImgFiltered);
+        TRACE_ZONE("FilteredFrameStore");
+        mFilterChainSkipped = true;
+        ++mFrameStoreStatistics.reused;
+        mFrameStoreStatistics.seconds +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - storeStart).count();
     }
-
-    if(imageChanged || swapFilterChanged || brightContrastFilterChanged || borderFilterChanged || calibFilterChanged)
+    else if(
+        mFusedPreprocessing && !roiOnly && !rawFrame && !mStereoContext && !borderFilterChanged &&
+        FusedPreprocessor::isApplicable(mImgFiltered))
     {
-        if(mStereoContext)
+        // same result as the filter chain below in fewer passes over the frame;
+        // a changed border falls back to the chain, because the control image needs the bordered frame
+        if(imageChanged || anyFilterChanged || !fusedValid)
         {
-            // getRecified rectifies filtered image set in mStereoContext->init()
-            mImgFiltered = mStereoContext->getRectified(mAnimation.getCamera());
-            mCalibFilter.setChanged(false);
+            TRACE_ZONE("FusedPreprocessor");
+            const auto fusedStart = std::chrono::steady_clock::now();
+            mImgFiltered          = mFusedPreprocessor.apply(
+                mImgFiltered, mSwapFilter, mBrightContrastFilter, mBorderFilter, mCalibFilter);
+            ++mFusedStatistics.applied;
+            mFusedStatistics.seconds +=
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - fusedStart).count();
+            updateFilteredFrameStore(anyFilterChanged);
+            if(!proxyFrame)
+            {
+                mFilteredFrameStore.put(frameNum, mImgFiltered);
+            }
         }
         else
         {
-            mImgFiltered = mCalibFilter.apply(mImgFiltered);
+            mImgFiltered = mFusedPreprocessor.getLastResult();
+            ++mFusedStatistics.reused;
         }
+        mFilterChainSkipped = true;
+        mFusedPreprocessed  = true;
     }
     else
     {
-        // TODO: need to handle this for the stereo case??
-        mImgFiltered = mCalibFilter.getLastResult();
-    }
+        if(mFilterChainSkipped)
+        {
+            // last results of the filters belong to an older frame
+            imageChanged        = true;
+            mFilterChainSkipped = false;
+        }
 
-    if(brightContrastFilterChanged || swapFilterChanged || borderFilterChanged || calibFilterChanged)
-    {
-        // when loading a .pet file, a bg-file may be there.
-        // Only delete the bg-filter if no such file is present
-        if(mBackgroundFilter.getFilename().isEmpty())
+        // When applying the filter, the order is important!
+        // Computation heavy filter should be applied early.
+
+        if(imageChanged || swapFilterChanged)
         {
-            // delete all background information and set bg.changed() to true.
-            mBackgroundFilter.reset();
+            TRACE_ZONE("SwapFilter");
+            mImgFiltered = mSwapFilter.apply(mImgFiltered);
         }
         else
         {
-            SPDLOG_WARN("no background reset, because of explicit loaded background image!");
+            mImgFiltered = mSwapFilter.getLastResult();
         }
-    }
-
-    if(imageChanged || mBackgroundFilter.changed())
-    {
-        mImgFiltered = mBackgroundFilter.apply(mImgFiltered);
-    }
-    else
-    {
-        mImgFiltered = mBackgroundFilter.getLastResult();
-    }
-}
 
-void Petrack::resetExistingPoints()
+        if(imageChanged || swapFilterChanged || brightContrastFilterChanged)
+        {
+            TRACE_ZONE("BrightContrastFilter");
+            mImgFiltered = mBrightContrastFilter.apply(mImgFiltered);
+        }
+        else
+        {
+            mImgFiltered = mBrightContrastFilter.getLastResult();
+        }
+
+        if(imageChanged || swapFilterChanged || brightContrastFilterChanged || borderFilterChanged)
+        {
+            TRACE_ZONE("BorderFilter");
+            mImgFiltered = mBorderFilter.apply(mImgFiltered);
+        }
+        else
+        {
+            mImgFiltered = mBorderFilter.getLastResult();
+        }
+
+        if(borderFilterChanged)
+        {
+            updateControlImage(mImgFiltered);
+        }
+
+        if(imageChanged || anyFilterChanged)
+        {
+            if(mStereoContext)
+                mStereoContext->init(mImgFiltered);
+        }
+
+        if(rawFrame)
+        {
+            // last result of the calibration filter belongs to an older frame
+            mFilterChainSkipped = true;
+        }
+        else if(imageChanged || anyFilterChanged)
+        {
+            if(mStereoContext)
+            {
+                // getRecified rectifies filtered image set in mStereoContext->init()
+                mImgFiltered = mStereoContext->getRectified(mAnimation.getCamera());
+                mCalibFilter.setChanged(false);
+                if(mStereoWidget->stereoUseForHeight->isChecked() || mStereoWidget->stereoUseForReco->isChecked())
+                {
+                    // overlaps with the tracking and recognition of the frame
+                    mStereoContext->startDisparity();
+                }
+            }
+            else
+            {
+                TRACE_ZONE("CalibFilter");
+                mImgFiltered = mCalibFilter.apply(mImgFiltered);
+            }
+        }
+        else
+        {
+            // TODO: need to handle this for the stereo case??
+            mImgFiltered = mCalibFilter.getLastResult();
+        }
+
+        // frames filtered only inside the roi or not undistorted must not be reused for viewing
+        if((imageChanged || anyFilterChanged) && !roiOnly && !rawFrame && !proxyFrame)
+        {
+            updateFilteredFrameStore(anyFilterChanged);
+            mFilteredFrameStore.put(frameNum, mImgFiltered);
+        }
+    }
+
+    if(brightContrastFilterChanged || swapFilterChanged || borderFilterChanged || calibFilterChanged)
+    {
+        // when loading a .pet file, a bg-file may be there.
+        // Only delete the bg-filter if no such file is present
+        if(mBackgroundFilter.getFilename().isEmpty())
+        {
+            // delete all background information and set bg.changed() to true.
+            mBackgroundFilter.reset();
+        }
+        else
+        {
+            SPDLOG_WARN("no background reset, because of explicit loaded background image!");
+        }
+    }
+
+    if(proxyFrame)
+    {
+        // shown without background subtraction, as even a model without update is initialized with the first frame
+    }
+    else if(imageChanged || mBackgroundFilter.changed())
+    {
+        TRACE_ZONE("BackgroundFilter");
+        mImgFiltered = mBackgroundFilter.apply(mImgFiltered);
+    }
+    else
+    {
+        mImgFiltered = mBackgroundFilter.getLastResult();
+    }
+}
+
+/**
+ * @brief Region of the filtered image, which is needed by tracking and recognition
+ *
+ * While trackAll() is running and ROI filtering is enabled, only the union of the
+ * tracking and recognition ROI (plus a margin for the tracking window) is undistorted.
+ * Otherwise the whole image is needed for the view and an empty rect is returned.
+ * The full image is filtered again as soon as the batch processing ends.
+ *
+ * A running Retracking only needs the patch around its persons (see setRetracking()).
+ *
+ * @return ROI in coordinates of the bordered image or an empty rect for the whole image
+ */
+cv::Rect Petrack::getFilterRoi()
+{
+    if(!mRetrackPatch.empty())
+    {
+        return mRetrackPatch;
+    }
+    if(!mRoiFiltering || !mBatchProcessing || mStereoContext || mExportRunning)
+    {
+        return cv::Rect();
+    }
+
+    const int bS = getImageBorderSize();
+    QRectF    roi;
+    if(mControlWidget->isOnlineTrackingChecked())
+    {
+        // features are searched in a window around their last position
+        const int margin = winSize(nullptr, -1, -1, 0);
+        roi              = mTrackingRoiItem->rect().adjusted(-margin, -margin, margin, margin);
+    }
+    if(mControlWidget->isPerformRecognitionChecked())
+    {
+        roi = roi.united(mRecognitionRoiItem->rect());
+    }
+    if(roi.isEmpty())
+    {
+        return cv::Rect();
+    }
+    return cv::Rect(
+        myRound(roi.x() + bS) - 1, myRound(roi.y() + bS) - 1, myRound(roi.width()) + 2, myRound(roi.height()) + 2);
+}
+
+/**
+ * @brief Enables decoding the working range of videos from an all-intra copy
+ */
+void Petrack::setMezzanine(bool enabled)
+{
+    mUseMezzanine = enabled;
+    updateMezzanine();
+}
+
+/**
+ * @brief Prepares the all-intra copy of the working range of the video in the background
+ *
+ * Long-GOP videos (H.264, H.265) are decoded from the last keyframe for every jump, which
+ * makes backward tracking and reviewing slow; in the copy, every frame is decoded on its
+ * own (see MezzanineVideo). An existing copy of the same frames is used again.
+ *
+ * With mMezzanineRoiOnly only the united tracking and recognition ROI is copied, enlarged
+ * for the pixels the calibration moves into it. Swapped frames are always copied completely.
+ */
+void Petrack::updateMezzanine()
+{
+    cv::Rect crop;
+    if(mMezzanineRoiOnly && !mSwapFilter.getEnabled())
+    {
+        const QRectF roi = mTrackingRoiItem->rect().united(mRecognitionRoiItem->rect());
+        crop             = cv::Rect(
+            myRound(roi.x()) - MEZZANINE_CROP_MARGIN,
+            myRound(roi.y()) - MEZZANINE_CROP_MARGIN,
+            myRound(roi.width()) + 2 * MEZZANINE_CROP_MARGIN,
+            myRound(roi.height()) + 2 * MEZZANINE_CROP_MARGIN);
+    }
+    mAnimation.setMezzanine(mUseMezzanine, mPlayerWidget->getFrameInNum(), mPlayerWidget->getFrameOutNum(), crop);
+}
+
+/**
+ * @brief Computes the background model from count frames spread across the sequence
+ *
+ * The frames are decoded in parallel and filtered like the frames of the sequence, so the
+ * background subtraction starts with the background instead of learning it while the
+ * sequence is played. If the index of the video is built, the frames are moved onto its
+ * keyframes, so no frame has to be decoded from far away.
+ *
+ * @param count number of frames the median is computed from
+ * @return false, if no model could be computed (e.g. for stereo videos or cameras)
+ */
+bool Petrack::sampleBackground(int count)
+{
+    if(mStereoContext || mAnimation.isStereoVideo() || !(mAnimation.isVideo() || mAnimation.isImageSequence()))
+    {
+        SPDLOG_WARN("The background can only be sampled from videos and image sequences without stereo.");
+        return false;
+    }
+    TRACE_ZONE("SampleBackground");
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    const int            first = mAnimation.getSourceInFrameNum();
+    const int            last  = mAnimation.getSourceOutFrameNum();
+    std::vector<cv::Mat> samples;
+    if(mAnimation.isImageSequence())
+    {
+        const auto frames = frameSampler::sampleFrames(first, last, count, {});
+        samples           = frameSampler::readImages(mAnimation.getImageFiles(), frames);
+    }
+    else if(mAnimation.isVideoSegments())
+    {
+        const auto frames = frameSampler::sampleFrames(first, last, count, {});
+        samples           = mAnimation.getVideoSegments().readFrames(frames);
+    }
+    else
+    {
+        const auto keyFrames = mAnimation.getKeyFrames().value_or(std::vector<int>());
+        const auto frames    = frameSampler::sampleFrames(first, last, count, keyFrames);
+        samples              = frameSampler::decodeVideo(
+            mAnimation.getFileInfo().absoluteFilePath(), frames, mAnimation.getHwAcceleration());
+    }
+
+    // the changes of the filters still have to be applied to the next frame of the sequence
+    const bool swapChanged           = mSwapFilter.changed();
+    const bool brightContrastChanged = mBrightContrastFilter.changed();
+    const bool borderChanged         = mBorderFilter.changed();
+    const bool calibChanged          = mCalibFilter.changed();
+    mCalibFilter.setRoi(cv::Rect());
+    for(auto &sample : samples)
+    {
+        if(sample.empty())
+        {
+            continue;
+        }
+        if(mAnimation.isGrayscale())
+        {
+            videoDecoder::toGrayscale(sample);
+        }
+        sample = mSwapFilter.apply(sample);
+        sample = mBrightContrastFilter.apply(sample);
+        sample = mBorderFilter.apply(sample);
+        sample = mCalibFilter.apply(sample).clone(); // results of the filters are reused for the next sample
+    }
+    mSwapFilter.setChanged(swapChanged);
+    mBrightContrastFilter.setChanged(brightContrastChanged);
+    mBorderFilter.setChanged(borderChanged);
+    mCalibFilter.setChanged(calibChanged);
+    mFilterChainSkipped = true;
+
+    BackgroundModel model;
+    const bool      computed = model.compute(samples);
+    QApplication::restoreOverrideCursor();
+    if(!computed)
+    {
+        return false;
+    }
+    mBackgroundFilter.setModel(model);
+    mBackgroundFilter.setFilename("");
+    requestUpdateImage();
+    return true;
+}
+
+/**
+ * @brief Restricts tracking to persons and filtering, grey conversion and tracking to patch
+ *
+ * Used by Retracking for every frame. Empty persons end the restriction.
+ *
+ * @param patch region in coordinates of the bordered image
+ */
+void Petrack::setRetracking(const QSet<size_t> &persons, const cv::Rect &patch)
+{
+    mRetrackPersons = persons;
+    mRetrackPatch   = persons.isEmpty() ? cv::Rect() : patch;
+    mTracker->setPatch(mRetrackPatch);
+}
+
+/**
+ * @brief Counters of all stages of the filter pipeline, in the order they are applied
+ */
+std::vector<std::pair<QString, FilterStatistics>> Petrack::getFilterStatistics() const
+{
+    return {
+        {"FilteredFrameStore", mFrameStoreStatistics},
+        {"FusedPreprocessor", mFusedStatistics},
+        {"SwapFilter", mSwapFilter.getStatistics()},
+        {"BrightContrastFilter", mBrightContrastFilter.getStatistics()},
+        {"BorderFilter", mBorderFilter.getStatistics()},
+        {"CalibFilter", mCalibFilter.getStatistics()},
+        {"BackgroundFilter", mBackgroundFilter.getStatistics()}};
+}
+
+/**
+ * @brief Returns the memory used by the larger subsystems in bytes
+ *
+ * Only the data growing with the sequence or the number of persons is counted, not
+ * e.g. the current images of the filters. The spilled trajectories are listed as well,
+ * though they are only paged into memory while read.
+ */
+MemoryUsage Petrack::getMemoryUsage() const
+{
+    return {
+        {"Trajectories", mPersonStorage.memoryUsage()},
+        {"Undo history", mPersonStorage.undoMemoryUsage()},
+        {"Tracker", mTracker->memoryUsage()},
+        {"Frame cache", mAnimation.getFrameCacheBytes()},
+        {"Detection cache", mDetectionCache.memoryUsage()},
+        {"Spilled to disk", mPersonStorage.spilledBytes()}};
+}
+
+/**
+ * @brief Writes the counters of the filter pipeline to the log (window)
+ */
+void Petrack::logFilterStatistics() const
+{
+    SPDLOG_INFO("Filter pipeline: stage, applied, reused, allocations, total time [ms], time per apply [ms]");
+    for(const auto &[name, stats] : getFilterStatistics())
+    {
+        SPDLOG_INFO(
+            "{:<20} {:>8} {:>8} {:>8} {:>10.1f} {:>8.3f}",
+            name,
+            stats.applied,
+            stats.reused,
+            stats.allocations,
+            1000. * stats.seconds,
+            stats.applied > 0 ? 1000. * stats.seconds / stats.applied : 0.);
+    }
+}
+
+/**
+ * @brief Writes the counters of the filter pipeline to fileName
+ *
+ * The format is JSON, if fileName ends with .json, otherwise CSV.
+ *
+ * @return true, if the file could be written
+ */
+bool Petrack::exportFilterStatistics(const QString &fileName) const
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not write filter statistics to {}.", fileName);
+        return false;
+    }
+
+    QTextStream out(&file);
+    if(fileName.endsWith(".json", Qt::CaseInsensitive))
+    {
+        QJsonArray stages;
+        for(const auto &[name, stats] : getFilterStatistics())
+        {
+            stages.append(QJsonObject{
+                {"stage", name},
+                {"applied", stats.applied},
+                {"reused", stats.reused},
+                {"allocations", stats.allocations},
+                {"seconds", stats.seconds}});
+        }
+        out << QJsonDocument(stages).toJson();
+    }
+    else
+    {
+        out << "stage,applied,reused,allocations,seconds\n";
+        for(const auto &[name, stats] : getFilterStatistics())
+        {
+            out << name << "," << stats.applied << "," << stats.reused << "," << stats.allocations << ","
+                << stats.seconds << "\n";
+        }
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+void Petrack::resetFilterStatistics()
+{
+    mFrameStoreStatistics = FilterStatistics();
+    mFusedStatistics      = FilterStatistics();
+    for(Filter *filter : std::initializer_list<Filter *>{
+            &mSwapFilter, &mBrightContrastFilter, &mBorderFilter, &mCalibFilter, &mBackgroundFilter})
+    {
+        filter->resetStatistics();
+    }
+}
+
+/**
+ * @brief Name of the filtered frame store for the current sequence and filter parameters
+ *
+ * The name contains a hash of all parameters of the filters applied before the
+ * background subtraction, so changing any of them leads to another store.
+ */
+QString Petrack::getFilteredFrameStoreName()
+{
+    const QFileInfo seqInfo = mAnimation.getFileInfo();
+    const auto      camera  = mCalibFilter.getCamParams().getValue();
+
+    QByteArray  key;
+    QTextStream stream(&key);
+    stream.setRealNumberPrecision(17);
+    stream << seqInfo.absoluteFilePath() << " " << seqInfo.size() << " " << seqInfo.lastModified().toMSecsSinceEpoch();
+    stream << " " << mSwapFilter.getEnabled();
+    stream << " " << mSwapFilter.getSwapHorizontally().getValue() << " " << mSwapFilter.getSwapVertically().getValue();
+    stream << " " << mBrightContrastFilter.getEnabled();
+    stream << " " << mBrightContrastFilter.getBrightness().getValue();
+    stream << " " << mBrightContrastFilter.getContrast().getValue();
+    stream << " " << mBorderFilter.getEnabled() << " " << mBorderFilter.getBorderSize().getValue();
+    stream << " " << mBorderFilter.getBorderColR().getValue() << " " << mBorderFilter.getBorderColG().getValue();
+    stream << " " << mBorderFilter.getBorderColB().getValue();
+    stream << " " << mCalibFilter.getEnabled() << " " << mAnimation.isGrayscale();
+    stream.flush();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(key);
+    for(const cv::Mat &mat : {camera.cameraMatrix, camera.distortionCoeffs})
+    {
+        hash.addData(reinterpret_cast<const char *>(mat.data), static_cast<int>(mat.total() * mat.elemSize()));
+    }
+
+    return QString("%1.%2.pfs").arg(getSequenceCacheBase(), QString(hash.result().toHex().left(16)));
+}
+
+/**
+ * @brief Base name of the cache files next to the current sequence, named after the sequence
+ */
+QString Petrack::getSequenceCacheBase()
+{
+    const QFileInfo seqInfo = mAnimation.getFileInfo();
+    // image sequences: store next to the images, named after the sequence
+    if(mAnimation.isImageSequence())
+    {
+        return seqInfo.absolutePath() + "/" + mAnimation.getFileBase();
+    }
+    return seqInfo.absoluteFilePath();
+}
+
+/**
+ * @brief (Re-)opens the filtered frame store matching the current filter parameters
+ *
+ * @param filterChanged filter parameters changed, so another store is needed
+ */
+void Petrack::updateFilteredFrameStore(bool filterChanged)
+{
+    if(!mUseFilteredFrameStore || mStereoContext || mAnimation.isCameraLiveStream() || mImgFiltered.empty())
+    {
+        mFilteredFrameStore.close();
+        return;
+    }
+    if(mFilteredFrameStore.isOpen() && !filterChanged)
+    {
+        return;
+    }
+
+    const QString fileName = getFilteredFrameStoreName();
+    if(mReadOnlyCaches && !QFileInfo::exists(fileName))
+    {
+        mFilteredFrameStore.close();
+        return;
+    }
+    if(fileName != mFilteredFrameStore.getFileName())
+    {
+        mFilteredFrameStore.open(fileName, mAnimation.getMaxFrames(), mImgFiltered, mReadOnlyCaches);
+    }
+}
+
+/**
+ * @brief Name of the detection cache for the current sequence and recognition parameters
+ *
+ * The name contains a hash of everything the detections depend on: the sequence
+ * and the filters (see getFilteredFrameStoreName), the calibration and background
+ * subtraction, and the settings of the recognition and the marker widgets. Tracking
+ * parameters and the extrinsic calibration are not part of it, so tracking can be
+ * re-run with the same cache.
+ *
+ * The name is only rebuilt after changes of the recognition, the filters or the
+ * sequence, not for every recognized frame. Stereo parameters are not flagged as
+ * recognition changes, so with a stereo context it is rebuilt every time.
+ */
+QString Petrack::getDetectionCacheName()
+{
+    if(!mDetectionCacheName.isEmpty() && !recognitionChanged() && !mStereoContext)
+    {
+        return mDetectionCacheName;
+    }
+
+    QDomDocument doc;
+    QDomElement  control = doc.createElement("CONTROL");
+    mControlWidget->setXml(control);
+
+    QDomElement calibration = control.firstChildElement("CALIBRATION");
+    calibration.removeChild(calibration.firstChildElement("EXTRINSIC_PARAMETERS"));
+    calibration.removeChild(calibration.firstChildElement("ALIGNMENT_GRID"));
+
+    std::vector<QDomElement> elements{
+        calibration,
+        control.firstChildElement("RECOGNITION"),
+        doc.createElement("COLOR_MARKER"),
+        doc.createElement("CODE_MARKER"),
+        doc.createElement("MULTI_COLOR_MARKER"),
+        doc.createElement("STEREO")};
+    mColorMarkerWidget->setXml(elements[2]);
+    mCodeMarkerWidget->setXml(elements[3]);
+    mMultiColorMarkerWidget->setXml(elements[4]);
+    mStereoWidget->setXml(elements[5]);
+
+    QByteArray  key;
+    QTextStream stream(&key);
+    stream << getFilteredFrameStoreName();
+    for(const auto &elem : elements)
+    {
+        elem.save(stream, 0);
+    }
+    stream << getImageBorderSize();
+    stream.flush();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(key);
+    mDetectionCacheName = QString("%1.%2.pdc").arg(getSequenceCacheBase(), QString(hash.result().toHex().left(16)));
+    return mDetectionCacheName;
+}
+
+/**
+ * @brief (Re-)opens the detection cache matching the current recognition parameters
+ */
+void Petrack::updateDetectionCache()
+{
+    if(!mUseDetectionCache || mAnimation.isCameraLiveStream() || mImgFiltered.empty())
+    {
+        mDetectionCache.close();
+        return;
+    }
+
+    const QString fileName = getDetectionCacheName();
+    if(mReadOnlyCaches && !QFileInfo::exists(fileName))
+    {
+        mDetectionCache.close();
+        return;
+    }
+    if(fileName != mDetectionCache.getFileName())
+    {
+        mDetectionCache.open(fileName, mReadOnlyCaches);
+    }
+}
+
+/**
+ * @brief Name of the disparity store for the current sequence and stereo parameters
+ *
+ * The name contains a hash of everything the disparity depends on: the sequence and
+ * the filters (see getFilteredFrameStoreName) and the parameters of the disparity
+ * computation in the StereoWidget. Display settings of the disparity are not part of it.
+ * If only the ROIs are used, the ROIs are part of it as well.
+ */
+QString Petrack::getDisparityStoreName()
+{
+    QByteArray  key;
+    QTextStream stream(&key);
+    stream.setRealNumberPrecision(17);
+    stream << getFilteredFrameStoreName();
+    stream << " " << mStereoWidget->stereoDispAlgo->currentIndex();
+    stream << " " << mStereoWidget->minDisparity->value() << " " << mStereoWidget->maxDisparity->value();
+    stream << " " << mStereoWidget->stereoMaskSize->value() << " " << mStereoWidget->edgeMaskSize->value();
+    stream << " " << mStereoWidget->useEdge->isChecked() << " " << mStereoRoiOnly;
+    if(mStereoRoiOnly)
+    {
+        for(const QRectF &rect : {mRecognitionRoiItem->rect(), mTrackingRoiItem->rect()})
+        {
+            stream << " " << rect.top() << " " << rect.bottom();
+        }
+        stream << " " << getImageBorderSize();
+    }
+    stream.flush();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(key);
+    return QString("%1.%2.pds").arg(getSequenceCacheBase(), QString(hash.result().toHex().left(16)));
+}
+
+/**
+ * @brief Returns the disparity store matching the current stereo parameters
+ *
+ * The store is (re-)opened, if the parameters changed since the last call.
+ *
+ * @return the store; nullptr, if it is not enabled or could not be opened
+ */
+DisparityStore *Petrack::getDisparityStore()
+{
+    if(!mUseDisparityStore || !mStereoContext || mAnimation.isCameraLiveStream())
+    {
+        mDisparityStore.close();
+        return nullptr;
+    }
+
+    const QString fileName = getDisparityStoreName();
+    if(mReadOnlyCaches && !QFileInfo::exists(fileName))
+    {
+        mDisparityStore.close();
+        return nullptr;
+    }
+    if(fileName != mDisparityStore.getFileName())
+    {
+        mDisparityStore.open(fileName, mReadOnlyCaches);
+    }
+    return mDisparityStore.isOpen() ? &mDisparityStore : nullptr;
+}
+
+/**
+ * @brief Switches the animation to gray frames, if enabled and the recognition method does not need color
+ *
+ * Casern, Hermes, Japan and Code markers are detected on gray images anyway, so
+ * decoding, filtering and tracking can work on single channel images.
+ */
+void Petrack::updateGrayscalePipeline()
+{
+    const auto method      = mReco.getRecoMethod();
+    const bool colorNeeded = method == reco::RecognitionMethod::Color ||
+                             method == reco::RecognitionMethod::MultiColor ||
+                             method == reco::RecognitionMethod::Stereo || mStereoContext;
+    const bool grayscale   = mGrayscalePipeline && !colorNeeded;
+    if(grayscale == mAnimation.isGrayscale())
+    {
+        return;
+    }
+
+    mAnimation.setGrayscale(grayscale);
+    SPDLOG_INFO("Processing {} images.", grayscale ? "gray" : "color");
+    // background model was built with the other number of channels
+    mBackgroundFilter.reset();
+    if(!mImg.empty() && !isLoading())
+    {
+        updateImage(mAnimation.getFrameAtIndex(mAnimation.getCurrentFrameNum()));
+    }
+}
+
+void Petrack::resetExistingPoints()
 {
     mPersonStorage.clear();
     mTracker->reset();
@@ -3468,11 +4832,7 @@ void Petrack::resetExistingPoints()
 void Petrack::performTracking()
 {
     // Rect for tracking area
-    QRect roi(
-        myRound(mTrackingRoiItem->rect().x() + getImageBorderSize()),
-        myRound(mTrackingRoiItem->rect().y() + getImageBorderSize()),
-        myRound(mTrackingRoiItem->rect().width()),
-        myRound(mTrackingRoiItem->rect().height()));
+    QRect roi = getTrackingRoi();
 
     // build disparity picture if it should be used for height detection
     if(mStereoContext && mStereoWidget->stereoUseForHeight->isChecked())
@@ -3482,9 +4842,11 @@ void Petrack::performTracking()
 
     cv::Rect rect = qRectToCvRect(roi, mImgFiltered);
 
+    mTracker->setPointUndistortion(mRawFrame ? &mPointUndistortion : nullptr);
+
     cv::Mat map1 = mCalibFilter.getMap1();
     int     anz  = mTracker->track(
-        mImgFiltered,
+        *mFrameContext,
         rect,
         map1,
         mAnimation.getCurrentFrameNum(),
@@ -3492,19 +4854,252 @@ void Petrack::performTracking()
         mControlWidget->getTrackRepeatQual(),
         getImageBorderSize(),
         mReco.getRecoMethod(),
-        mControlWidget->getTrackRegionLevels(),
+        getTrackRegionLevels(),
         getPedestriansToTrack());
 
     mControlWidget->setTrackNumberNow(QString("%1").arg(anz));
+    mPipelineStatistics.tracked += std::max(anz, 0);
     mTrackChanged = false;
+
+    // a Retracking sees only some persons, which says nothing about the recognition
+    if(mRecoSchedule.isEnabled() && anz >= 0 && mRetrackPersons.isEmpty())
+    {
+        const int    frame   = mAnimation.getCurrentFrameNum();
+        const auto  &summary = mTracker->getSummary();
+        const QRectF recoRoi = mRecognitionRoiItem->rect();
+
+        RecoSchedule::Observation observation;
+        observation.frame     = frame;
+        observation.tracked   = summary.tracked;
+        observation.lost      = summary.lost;
+        observation.uncertain = summary.uncertain;
+        // persons within a head size of the border are about to leave or just entered
+        for(size_t i : mPersonStorage.activePersons(frame))
+        {
+            const auto &person = mPersonStorage.at(i);
+            if(!person.trackPointExist(frame))
+            {
+                continue;
+            }
+            const TrackPoint point  = person.trackPointAt(frame);
+            const double     margin = getHeadSize(nullptr, static_cast<int>(i), frame);
+            if(!recoRoi.adjusted(margin, margin, -margin, -margin).contains(point.x(), point.y()))
+            {
+                ++observation.nearBorder;
+            }
+        }
+        mRecoSchedule.addTracking(observation);
+    }
+
+    mPersonStorage.spillFinished(mAnimation.getCurrentFrameNum());
+    mPersonStorage.compressFinished(mAnimation.getCurrentFrameNum());
+}
+
+/**
+ * @brief Takes the persons of the previous frame for the current frame, which duplicates it
+ *
+ * Used instead of performTracking() for duplicate frames (see FrameChangeDetector).
+ *
+ * @return false, if the current frame does not follow the last tracked frame, so it has to be tracked
+ */
+bool Petrack::copyPreviousFrame()
+{
+    const int copied = mTracker->copyPreviousFrame(mAnimation.getCurrentFrameNum(), getPedestriansToTrack());
+    if(copied < 0)
+    {
+        return false;
+    }
+    mControlWidget->setTrackNumberNow(QString("%1").arg(copied));
+    mPipelineStatistics.tracked += copied;
+    mPersonStorage.spillFinished(mAnimation.getCurrentFrameNum());
+    mPersonStorage.compressFinished(mAnimation.getCurrentFrameNum());
+    return true;
+}
+
+/**
+ * @brief Compares the current frame with the previous one, if skipping unchanged frames is enabled
+ *
+ * Only the tracking and the recognition ROI are compared, as changes elsewhere are not processed.
+ *
+ * @return Changed, if the detection is disabled
+ */
+FrameChangeDetector::Change Petrack::detectFrameChange(int frameNum)
+{
+    if(!mFrameChange.isEnabled())
+    {
+        return FrameChangeDetector::Change::Changed;
+    }
+    const QRect roi = getTrackingRoi().united(getRecognitionRoi());
+    return mFrameChange.update(frameNum, mFrameContext->gray(), qRectToCvRect(roi, mImgFiltered));
+}
+
+/**
+ * @brief Tracking ROI in the coordinates of the filtered image (including the border)
+ */
+QRect Petrack::getTrackingRoi() const
+{
+    return QRect(
+        myRound(mTrackingRoiItem->rect().x() + getImageBorderSize()),
+        myRound(mTrackingRoiItem->rect().y() + getImageBorderSize()),
+        myRound(mTrackingRoiItem->rect().width()),
+        myRound(mTrackingRoiItem->rect().height()));
+}
+
+/**
+ * @brief Recognition ROI in the coordinates of the filtered image (including the border)
+ */
+QRect Petrack::getRecognitionRoi() const
+{
+    return QRect(
+        myRound(mRecognitionRoiItem->rect().x() + getImageBorderSize()),
+        myRound(mRecognitionRoiItem->rect().y() + getImageBorderSize()),
+        myRound(mRecognitionRoiItem->rect().width()),
+        myRound(mRecognitionRoiItem->rect().height()));
+}
+
+/**
+ * @brief Options for the recognition of frameNum
+ *
+ * With a guided recognition interval k, the whole recognition ROI is only searched
+ * every k frames and whenever the recognition parameters changed. In between, the
+ * markers are only searched in windows around the (predicted) positions of the
+ * persons and in strips along the border of the ROI, where new persons enter.
+ * With LEARNED_ENTRY_ZONES, the strips are replaced by the zones in which the
+ * trajectories started so far, once enough of them are known (see EntryZones).
+ *
+ * With REJECTED_MARKER_HINTS, the rejected code markers near the trajectories in the
+ * neighbouring frame are searched again at a higher resolution (see MarkerHints).
+ */
+reco::RecognitionOptions Petrack::getRecognitionOptions(int frameNum)
+{
+    const QRect roi     = getRecognitionRoi();
+    auto        options = mReco.getOptions(
+        mControlWidget, roi, getImageBorderSize(), mControlWidget->getIntrinsicCameraParams());
+
+    // a window is three heads wide, enlarged by the uncertainty of the prediction
+    const int border   = getImageBorderSize();
+    const int halfSize = myRound(1.5 * getHeadSize());
+
+    if(options.method == reco::RecognitionMethod::Code)
+    {
+        for(const auto &hint : mMarkerHints.getHints(frameNum))
+        {
+            cv::Point2f center = (hint + Vec2F(border, border)).toPoint2f();
+            if(mRawFrame)
+            {
+                center = mPointUndistortion.distort(center);
+            }
+            options.hintWindows.emplace_back(
+                myRound(center.x) - halfSize, myRound(center.y) - halfSize, 2 * halfSize, 2 * halfSize);
+        }
+    }
+    mHintedRecognition = !options.hintWindows.empty();
+
+    mGuidedRecognition = mGuidedRecognitionInterval > 0 && mLastFullRecognitionFrame >= 0 &&
+                         std::abs(frameNum - mLastFullRecognitionFrame) < mGuidedRecognitionInterval &&
+                         !recognitionChanged();
+    if(!mGuidedRecognition)
+    {
+        mLastFullRecognitionFrame = frameNum;
+        mEntryZones.learn(mPersonStorage.getPersons(), mAnimation.getSourceInFrameNum(), myRound(getHeadSize()));
+        return options;
+    }
+
+    for(const auto &person : mPersonStorage.getPersons())
+    {
+        std::optional<MotionPrediction> prediction;
+        if(person.trackPointExist(frameNum))
+        {
+            prediction = MotionPrediction{person.trackPointAt(frameNum), 0};
+        }
+        // forward or backward
+        for(int fromFrame : {frameNum - 1, frameNum + 1})
+        {
+            if(!prediction)
+            {
+                prediction = person.predictPosition(fromFrame, frameNum);
+            }
+            if(!prediction && person.trackPointExist(fromFrame))
+            {
+                prediction = MotionPrediction{person.trackPointAt(fromFrame), 0};
+            }
+        }
+        if(!prediction)
+        {
+            continue;
+        }
+        const int   half   = halfSize + myRound(prediction->uncertainty);
+        cv::Point2f center = (prediction->position + Vec2F(border, border)).toPoint2f();
+        if(mRawFrame)
+        {
+            // the markers are searched on the distorted frame
+            center = mPointUndistortion.distort(center);
+        }
+        options.searchWindows.emplace_back(myRound(center.x) - half, myRound(center.y) - half, 2 * half, 2 * half);
+    }
+
+    if(mEntryZones.isLearned())
+    {
+        for(const auto &zone : mEntryZones.getZones())
+        {
+            const QRect window = zone.translated(border, border) & roi;
+            if(!window.isEmpty())
+            {
+                options.searchWindows.push_back(window);
+            }
+        }
+        return options;
+    }
+
+    const int strip = 2 * halfSize;
+    options.searchWindows.emplace_back(roi.x(), roi.y(), roi.width(), strip);
+    options.searchWindows.emplace_back(roi.x(), roi.bottom() - strip + 1, roi.width(), strip);
+    options.searchWindows.emplace_back(roi.x(), roi.y(), strip, roi.height());
+    options.searchWindows.emplace_back(roi.right() - strip + 1, roi.y(), strip, roi.height());
+    return options;
+}
+
+/**
+ * @brief Starts the marker detection of the current frame on a worker thread
+ *
+ * The detection only depends on the filtered image, not on the tracking of the
+ * frame. So it runs while performTracking() works on the same frame and
+ * performRecognition() takes its result afterwards, before the new points are
+ * matched with the tracked ones.
+ *
+ * The options are taken here on the GUI thread. They hold copies of all parameters
+ * including the calibration (see reco::PerspectiveCorrection), so the worker does
+ * not read any widget, while the user may change them on the GUI thread. Nothing is
+ * started for stereo recognition and for frames in the detection cache.
+ */
+void Petrack::startRecognition()
+{
+    const auto recoMethod = mReco.getRecoMethod();
+    if(recoMethod == reco::RecognitionMethod::Stereo)
+    {
+        return;
+    }
+    const int frameNum = mAnimation.getCurrentFrameNum();
+    updateDetectionCache();
+    if(mDetectionCache.contains(frameNum))
+    {
+        return;
+    }
+
+    // owns everything the detection reads, the frame is shared and not modified
+    auto options             = getRecognitionOptions(frameNum);
+    mPendingRecognition      = QtConcurrent::run(
+        [frame = mFrameContext, options = std::move(options)]() { return reco::findMarkers(*frame, options); });
+    mPendingRecognitionFrame = frameNum;
 }
 
 /**
  * Perform the recognition (if enabled by the user) of markers in the current image.
  *
+ * If startRecognition() was called for this frame, its result is used.
  * All TrackPoints will be added to the personStorage.
  */
-void Petrack::performRecognition()
+void Petrack::performRecognition(bool recognize)
 {
     int  frameNum        = mAnimation.getCurrentFrameNum();
     bool isStereoContext = mStereoContext != nullptr;
@@ -3517,44 +5112,108 @@ void Petrack::performRecognition()
         mStereoContext->getDisparity();
     }
 
-    if(mControlWidget->isPerformRecognitionChecked())
+    // detection started by startRecognition(); outdated, if it was started for another frame
+    std::optional<reco::RecognitionResult> pendingResult;
+    if(mPendingRecognitionFrame == frameNum)
     {
-        QRect rect(
-            myRound(mRecognitionRoiItem->rect().x() + getImageBorderSize()),
-            myRound(mRecognitionRoiItem->rect().y() + getImageBorderSize()),
-            myRound(mRecognitionRoiItem->rect().width()),
-            myRound(mRecognitionRoiItem->rect().height()));
+        pendingResult = mPendingRecognition.result();
+    }
+    mPendingRecognition.waitForFinished();
+    mPendingRecognition      = QFuture<reco::RecognitionResult>();
+    mPendingRecognitionFrame = -1;
+
+    if(recognize)
+    {
+        QRect                 rect = getRecognitionRoi();
         QList<TrackPoint>     persList;
+        std::vector<Vec2F>    candidates; // rejected code markers
         [[maybe_unused]] bool markerLess = true;
         auto                  recoMethod = mReco.getRecoMethod();
 
-        if((recoMethod == reco::RecognitionMethod::Casern) || (recoMethod == reco::RecognitionMethod::Hermes) ||
-           (recoMethod == reco::RecognitionMethod::Color) || (recoMethod == reco::RecognitionMethod::Japan) ||
-           (recoMethod == reco::RecognitionMethod::MultiColor) || (recoMethod == reco::RecognitionMethod::Code))
+        // detections of a former run with the same recognition parameters are replayed
+        updateDetectionCache();
+        const bool cached = mDetectionCache.get(frameNum, persList);
+
+        if(!cached &&
+           ((recoMethod == reco::RecognitionMethod::Casern) || (recoMethod == reco::RecognitionMethod::Hermes) ||
+            (recoMethod == reco::RecognitionMethod::Color) || (recoMethod == reco::RecognitionMethod::Japan) ||
+            (recoMethod == reco::RecognitionMethod::MultiColor) || (recoMethod == reco::RecognitionMethod::Code)))
         {
-            persList = mReco.getMarkerPos(
-                mImgFiltered,
-                rect,
-                mControlWidget,
-                getImageBorderSize(),
-                getBackgroundFilter(),
-                mControlWidget->getIntrinsicCameraParams());
+            if(!pendingResult)
+            {
+                pendingResult = reco::findMarkers(*mFrameContext, getRecognitionOptions(frameNum));
+            }
+            persList = reco::Recognizer::acceptResult(*pendingResult, *this, getBackgroundFilter());
+            if(mMarkerHints.isEnabled())
+            {
+                candidates = MarkerHints::candidates(*pendingResult);
+            }
             markerLess = false;
         }
-        if(isStereoContext && mStereoWidget->stereoUseForReco->isChecked())
+        if(!cached && isStereoContext && mStereoWidget->stereoUseForReco->isChecked())
         {
             PersonList pl;
             pl.calcPersonPos(mImgFiltered, rect, persList, mStereoContext, getBackgroundFilter(), markerLess);
         }
+        if(!cached && mRawFrame)
+        {
+            // markers were found on the distorted frame; the cache holds undistorted detections
+            const Vec2F border(getImageBorderSize(), getImageBorderSize());
+            for(auto &point : persList)
+            {
+                point = Vec2F(mPointUndistortion.undistort((point + border).toPoint2f())) - border;
+                if(point.color().isValid())
+                {
+                    point.setColPoint(
+                        Vec2F(mPointUndistortion.undistort((point.colPoint() + border).toPoint2f())) - border);
+                }
+            }
+            for(auto &candidate : candidates)
+            {
+                candidate = Vec2F(mPointUndistortion.undistort((candidate + border).toPoint2f())) - border;
+            }
+        }
+        // detections near the persons depend on the tracking, they must not be replayed
+        if(!cached && !mGuidedRecognition && !mHintedRecognition)
+        {
+            mDetectionCache.put(frameNum, persList);
+        }
+
+        const size_t nbPersons = mPersonStorage.nbPersons();
+        mPersonStorage.addPoints(persList, frameNum, mReco.getRecoMethod());
+        mRecoSchedule.addRecognition(static_cast<int>(mPersonStorage.nbPersons() - nbPersons));
+
+        // lost trajectories are continued at rejected code markers, which are read again in the next frame
+        const auto anchors = mMarkerHints.update(frameNum, candidates, mPersonStorage.getPersons(), getHeadSize() / 2.);
+        for(const auto &anchor : anchors)
+        {
+            mPersonStorage.insertFeaturePoint(
+                anchor.person,
+                frameNum,
+                TrackPoint(anchor.position, MarkerHints::ANCHOR_QUAL),
+                static_cast<int>(anchor.person),
+                false,
+                -1,
+                0);
+        }
 
-        mPersonStorage.addPoints(persList, frameNum, mReco.getRecoMethod());
-
         if(isStereoContext && mStereoWidget->stereoUseForReco->isChecked())
         {
             mPersonStorage.purge(frameNum);
         }
 
+        if(!mFramePipeline.isEmpty())
+        {
+            std::vector<cv::Point2f> detections;
+            for(const auto &point : persList)
+            {
+                detections.push_back(point.toPoint2f());
+            }
+            mFramePipeline.provide(FramePipeline::DETECTIONS, std::move(detections));
+        }
+
         mControlWidget->setRecoNumberNow(QString("%1").arg(persList.size()));
+        mPipelineStatistics.recognized += persList.size();
         mRecognitionChanged = false;
     }
     else
@@ -3575,122 +5234,370 @@ void Petrack::performRecognition()
  */
 void Petrack::updateImage(bool imageChanged)
 {
-    mCodeMarkerItem->resetSavedMarkers();
-
-    static int  lastRecoFrame            = -10000;
-    static bool borderChangedForTracking = false;
+    if(mDeferUpdates)
+    {
+        mDeferredChange = mDeferredChange || imageChanged;
+        return;
+    }
 
     // need semaphore to guarantee that updateImage only called once
     // updateValue of control automatically calls updateImage!!!
     static QSemaphore semaphore(1);
     if(!mImg.empty() && mImage && semaphore.tryAcquire())
     {
+        TRACE_ZONE("Petrack::updateImage");
+        mUpdating = true;
         int frameNum = mAnimation.getCurrentFrameNum();
 
         setStatusTime();
 
         updateShowFPS();
 
+        const bool borderChanged = processFrame(
+            imageChanged, mControlWidget->isOnlineTrackingChecked(), mControlWidget->isPerformRecognitionChecked());
 
-        // have to store because evaluation sets the filter parameter to unchanged
-        bool brightContrastChanged = mBrightContrastFilter.changed();
-        bool swapChanged           = mSwapFilter.changed();
-        bool borderChanged         = mBorderFilter.changed();
-        bool calibChanged          = mCalibFilter.changed();
-
-        getFilteredImage(imageChanged, brightContrastChanged, swapChanged, borderChanged, calibChanged);
-
-        // delete track list, if intrinsic param have changed
-        if(calibChanged && mPersonStorage.nbPersons() > 0) // mCalibFilter.getEnabled() &&
-        {
-            resetExistingPoints();
-        }
-        else
-        {
-            // calculate position in 3D space and height of person for "old" trackPoints, if checked "even"
-            if(mStereoContext && mStereoWidget->stereoUseForHeightEver->isChecked() &&
-               mStereoWidget->stereoUseForHeight->isChecked())
-            {
-                // build disparity picture if it should be used for height detection
-                mStereoContext->getDisparity();
-
-                mPersonStorage.calcPosition(frameNum);
-            }
-        }
-        if(borderChanged)
+        if(imageChanged && mAnimation.isCameraLiveStream())
         {
-            borderChangedForTracking = true;
+            const double latency = std::chrono::duration<double, std::milli>(
+                                       LiveCapture::Clock::now() - mAnimation.getLiveFrameTime())
+                                       .count();
+            mLiveBudget.addLatency(latency);
+            publishLivePositions(frameNum, latency);
         }
-        // tracking before recognition, because new recognized points are checked to match with already tracked ones
-        if((trackChanged() || imageChanged) && (mControlWidget->isOnlineTrackingChecked()))
-        {
-            if(borderChangedForTracking)
-            {
-                cv::Size size;
-                size.width  = mImgFiltered.cols;
-                size.height = mImgFiltered.rows;
-                mTracker->resize(size);
 
-                mTrackingRoiItem->restoreSize();
-            }
-            borderChangedForTracking = false;
+        // these might change due to reco or tracking
+        mControlWidget->setTrackNumberAll(QString("%1").arg(mPersonStorage.nbPersons()));
+        mControlWidget->setTrackShowOnlyNrMaximum(static_cast<int>(MAX(mPersonStorage.nbPersons(), 1)));
+        mControlWidget->setTrackNumberVisible(QString("%1").arg(mPersonStorage.visible(frameNum)));
 
-            performTracking();
-        }
-        else
+        // while playing or tracking all frames, painting must not slow down the processing;
+        // frames between two refreshes are processed without being shown at all;
+        // without a window, frames are only shown for exports, which render the view or mImage
+        const bool throttled  = mHeadless || mBatchProcessing || mPlayingAll;
+        const bool displayDue = !mLastDisplay.isValid() || mLastDisplay.elapsed() >= 1000 / MAX_DISPLAY_RATE;
+        const bool showImage  = borderChanged || mExportRunning || !throttled || (displayDue && !mHeadless);
+        if(showImage)
         {
-            mControlWidget->setTrackNumberNow(QString("0"));
-        }
+            StageTimer timer(mPipelineStatistics.render);
+            mLastDisplay.start();
 
-        bool recoFrameCondition =
-            ((((lastRecoFrame + mControlWidget->getRecoStep()) <= frameNum) ||
-              ((lastRecoFrame - mControlWidget->getRecoStep()) >= frameNum)) &&
-             imageChanged);
+            // the shown image shares the data of the filtered frame instead of copying it every frame
+            shareToQImage(*mImage, mImgFiltered);
 
-        if(recoFrameCondition || mAnimation.isCameraLiveStream() || swapChanged || brightContrastChanged ||
-           borderChanged || calibChanged || recognitionChanged())
-        {
             if(borderChanged)
             {
-                mRecognitionRoiItem->restoreSize();
+                mImageItem->setImage(mImage);
+            }
+            else
+            {
+                getScene()->views().first()->viewport()->repaint();
+                qApp->processEvents();
+                // update pixel color (because image pixel moves)
+                setStatusColor();
             }
-            lastRecoFrame = frameNum;
 
-            performRecognition();
+#ifdef QWT
+            mControlWidget->getAnalysePlot()->setActFrame(frameNum);
+            if(mControlWidget->isAnaMarkActChecked())
+            {
+                mControlWidget->getAnalysePlot()->replot();
+            }
+#endif
         }
-        else
+
+        mUpdating = false;
+        semaphore.release();
+    }
+}
+
+/**
+ * @brief Updates the image shortly after the last of a series of parameter edits
+ *
+ * Parameter widgets call this instead of updateImage(), so dragging a slider or spinning a
+ * spin box filters, tracks and recognizes the frame once for the final value instead of
+ * for every value in between. Each request restarts the delay of UPDATE_DELAY ms, which
+ * drops the pending update. A request during the update skips its tracking and
+ * recognition (see isUpdateOutdated()).
+ */
+void Petrack::requestUpdateImage()
+{
+    mUpdateTimer.start();
+}
+
+/// Runs the update requested by requestUpdateImage()
+void Petrack::updateRequestedImage()
+{
+    if(mUpdating)
+    {
+        // try again after the running update, e.g. one of the player
+        mUpdateTimer.start();
+        return;
+    }
+    mRequestedUpdate = true;
+    updateImage();
+    mRequestedUpdate = false;
+}
+
+/**
+ * @brief Returns, if a newer parameter edit requested another update than the running one
+ *
+ * Only updates started by requestUpdateImage() are outdated. The edits made meanwhile
+ * are handled first, so their requests arrive.
+ */
+bool Petrack::isUpdateOutdated()
+{
+    if(!mRequestedUpdate)
+    {
+        return false;
+    }
+    qApp->processEvents();
+    return mUpdateTimer.isActive();
+}
+
+/**
+ * @brief Filters mImg and runs tracking and recognition on it, without showing it
+ *
+ * This is the processing part of updateImage(); it neither repaints the view nor
+ * processes events, so it can also be used for headless batch processing.
+ *
+ * @param imageChanged mImg is a new frame
+ * @param track run tracking (if the frame or the tracking parameters changed)
+ * @param recognize run recognition (if the frame or the recognition parameters changed)
+ * @return true, if the image border changed (the shown image has a new size)
+ */
+bool Petrack::processFrame(bool imageChanged, bool track, bool recognize)
+{
+    TRACE_ZONE("Petrack::processFrame");
+    mCodeMarkerItem->resetSavedMarkers();
+
+    static int  lastRecoFrame            = -10000;
+    static bool borderChangedForTracking = false;
+
+    int frameNum = mAnimation.getCurrentFrameNum();
+
+    // the proxy is only for viewing, processing needs the frames in full resolution
+    const bool fullResolution = track || recognize || mExportRunning;
+    mAnimation.setUseProxy(!fullResolution);
+    if(fullResolution && mAnimation.isProxyFrame())
+    {
+        mImg         = mAnimation.reloadFullResolution();
+        imageChanged = true;
+    }
+    mFramePipeline.begin(frameNum);
+    mFramePipeline.provide(FramePipeline::IMAGE, mImg);
+
+    // have to store because evaluation sets the filter parameter to unchanged
+    bool brightContrastChanged = mBrightContrastFilter.changed();
+    bool swapChanged           = mSwapFilter.changed();
+    bool borderChanged         = mBorderFilter.changed();
+    bool calibChanged          = mCalibFilter.changed();
+
+    ++mPipelineStatistics.frames;
+    {
+        StageTimer timer(mPipelineStatistics.filter);
+        getFilteredImage(imageChanged, brightContrastChanged, swapChanged, borderChanged, calibChanged);
+        // gray and HSV of the filtered image are computed at most once for tracking and recognition
+        mFrameContext = std::make_shared<const FrameContext>(mImgFiltered, mRetrackPatch);
+    }
+    mFramePipeline.provide(FramePipeline::FILTERED, mFrameContext);
+
+    // delete track list, if intrinsic param have changed
+    if(calibChanged && mPersonStorage.nbPersons() > 0) // mCalibFilter.getEnabled() &&
+    {
+        resetExistingPoints();
+    }
+    else
+    {
+        // calculate position in 3D space and height of person for "old" trackPoints, if checked "even"
+        if(mStereoContext && mStereoWidget->stereoUseForHeightEver->isChecked() &&
+           mStereoWidget->stereoUseForHeight->isChecked())
         {
-            mControlWidget->setRecoNumberNow(QString("0"));
+            // build disparity picture if it should be used for height detection
+            mStereoContext->getDisparity();
+
+            mPersonStorage.calcPosition(frameNum);
         }
+    }
+    if(borderChanged)
+    {
+        borderChangedForTracking = true;
+    }
 
-        // these might change due to reco or tracking
-        mControlWidget->setTrackNumberAll(QString("%1").arg(mPersonStorage.nbPersons()));
-        mControlWidget->setTrackShowOnlyNrMaximum(static_cast<int>(MAX(mPersonStorage.nbPersons(), 1)));
-        mControlWidget->setTrackNumberVisible(QString("%1").arg(mPersonStorage.visible(frameNum)));
+    // live streams are recognized every frame, unless the latency budget asks for a larger step;
+    // the observations of the neighbouring frame are all that is known before this frame is tracked
+    const bool liveRealTime = isLiveRealTime();
+    const int  step         = mRecoSchedule.recoStep(mControlWidget->getRecoStep(), frameNum);
+    const int  recoStep     = liveRealTime ? mLiveBudget.recoStep(step) : step;
+    bool recoFrameCondition =
+        ((((lastRecoFrame + recoStep) <= frameNum) || ((lastRecoFrame - recoStep) >= frameNum)) && imageChanged);
+
+    // a duplicate or static frame shows nothing new to recognize and a duplicate nothing to track
+    const bool parametersChanged = mOutdatedParametersChanged || swapChanged || brightContrastChanged ||
+                                   borderChanged || calibChanged || recognitionChanged();
+    mOutdatedParametersChanged = false;
+
+    if(isUpdateOutdated())
+    {
+        // the update of the newer edit tracks and recognizes with the final parameters
+        mOutdatedParametersChanged = parametersChanged;
+        mFramePipeline.finish();
+        return borderChanged;
+    }
+
+    const auto change    = imageChanged ? detectFrameChange(frameNum) : FrameChangeDetector::Change::Changed;
+    const bool unchanged = change != FrameChangeDetector::Change::Changed;
 
-        copyToQImage(*mImage, mImgFiltered);
+    const bool recoNow =
+        (!unchanged && (recoFrameCondition || (mAnimation.isCameraLiveStream() && !liveRealTime))) ||
+        parametersChanged;
+    const bool trackNow = (trackChanged() || imageChanged) && track;
+    const bool copyNow  = trackNow && !trackChanged() && !borderChangedForTracking &&
+                          change == FrameChangeDetector::Change::Duplicate;
 
-        if(borderChanged)
+    if(recoNow && borderChanged)
+    {
+        mRecognitionRoiItem->restoreSize();
+    }
+    // markers are detected on a worker while tracking the same frame
+    if(recoNow && recognize && trackNow && !copyNow)
+    {
+        StageTimer timer(mPipelineStatistics.recognize);
+        startRecognition();
+    }
+
+    // tracking before recognition, because new recognized points are checked to match with already tracked ones
+    // the persons of a duplicate frame stay where they were in the previous frame
+    const bool copied = copyNow && copyPreviousFrame();
+    if(trackNow && !copied)
+    {
+        if(borderChangedForTracking)
         {
-            mImageItem->setImage(mImage);
+            cv::Size size;
+            size.width  = mImgFiltered.cols;
+            size.height = mImgFiltered.rows;
+            mTracker->resize(size);
+
+            mTrackingRoiItem->restoreSize();
         }
-        else
+        borderChangedForTracking = false;
+
+        StageTimer timer(mPipelineStatistics.track);
+        performTracking();
+    }
+    else if(!copied)
+    {
+        mControlWidget->setTrackNumberNow(QString("0"));
+    }
+    if(trackNow && !mFramePipeline.isEmpty())
+    {
+        const auto                 &persons = mPersonStorage.getPersons();
+        std::vector<PersonPosition> positions;
+        for(size_t i = 0; i < persons.size(); ++i)
         {
-            getScene()->views().first()->viewport()->repaint();
-            qApp->processEvents();
-            // update pixel color (because image pixel moves)
-            setStatusColor();
+            if(persons[i].trackPointExist(frameNum))
+            {
+                positions.push_back({static_cast<int>(i) + 1, persons[i].trackPointAt(frameNum).toPoint2f()});
+            }
         }
+        mFramePipeline.provide(FramePipeline::TRAJECTORIES, std::move(positions));
+    }
 
-#ifdef QWT
-        mControlWidget->getAnalysePlot()->setActFrame(frameNum);
-        if(mControlWidget->isAnaMarkActChecked())
+    if(recoNow)
+    {
+        lastRecoFrame = frameNum;
+
+        StageTimer timer(mPipelineStatistics.recognize);
+        performRecognition(recognize);
+    }
+    else
+    {
+        mControlWidget->setRecoNumberNow(QString("0"));
+    }
+
+    if(mCrowdMetrics.isRunning() && (trackNow || recoNow))
+    {
+        updateCrowdMetrics(frameNum);
+    }
+
+    // the stages share the buffers of this frame, which are reused for the next one
+    mFramePipeline.finish();
+
+    return borderChanged;
+}
+
+/**
+ * @brief Processes img as the current frame of the animation without showing it
+ *
+ * @see processFrame(bool, bool, bool)
+ * @param img current frame of the animation
+ * @param track run tracking
+ * @param recognize run recognition
+ */
+void Petrack::processFrame(const cv::Mat &img, bool track, bool recognize)
+{
+    if(img.empty())
+    {
+        return;
+    }
+    mImg = img;
+    processFrame(true, track, recognize);
+}
+
+/**
+ * @brief Returns the positions of the persons in frameNum
+ *
+ * The world positions use the height of the person, if known, otherwise the default height.
+ */
+std::vector<LivePosition> Petrack::worldPositions(int frameNum)
+{
+    const auto                border  = static_cast<float>(getImageBorderSize());
+    const auto               &persons = mPersonStorage.getPersons();
+    std::vector<LivePosition> positions;
+    for(size_t i = 0; i < persons.size(); ++i)
+    {
+        if(!persons[i].trackPointExist(frameNum))
         {
-            mControlWidget->getAnalysePlot()->replot();
+            continue;
         }
-#endif
+        const QPointF pixel  = persons[i].trackPointAt(frameNum).toQPointF();
+        const double  height =
+            persons[i].height() > MIN_HEIGHT + 1 ? persons[i].height() : mControlWidget->getDefaultHeight();
+        const QPointF world  = mWorldImageCorrespondence->getPosReal(pixel + QPointF(border, border), height);
+        positions.push_back({static_cast<int>(i) + 1, pixel, world});
+    }
+    return positions;
+}
 
-        semaphore.release();
+/**
+ * @brief Publishes the positions of the persons in the current live frame, if a target or shared memory is set
+ *
+ * @param frameNum current frame
+ * @param latency time from the capture to the end of the processing of the frame in ms
+ */
+void Petrack::publishLivePositions(int frameNum, double latency)
+{
+    if(!mLivePublisher.isEnabled() && !mLiveSharedMemory.isEnabled())
+    {
+        return;
+    }
+    const auto positions = worldPositions(frameNum);
+    mLivePublisher.publish(frameNum, latency, positions);
+    mLiveSharedMemory.publish(frameNum, latency, positions);
+}
+
+/**
+ * @brief Measures the crowd in frameNum after it was tracked and recognized
+ *
+ * The backward pass of trackAll() adds points to frames before already measured ones,
+ * so the crossings of the following frame are measured again as well.
+ */
+void Petrack::updateCrowdMetrics(int frameNum)
+{
+    const auto positions = worldPositions(frameNum);
+    mCrowdMetrics.setFrame(frameNum, positions, worldPositions(frameNum - 1));
+    if(mCrowdMetrics.contains(frameNum + 1))
+    {
+        mCrowdMetrics.setFrame(frameNum + 1, worldPositions(frameNum + 1), positions);
     }
 }
 
@@ -3705,6 +5612,13 @@ void Petrack::updateSequence()
 {
     QImage *oldImage = mImage;
 
+    mFilteredFrameStore.close();
+    mDetectionCacheName.clear();
+    mFilterChainSkipped = false;
+    mFrameChange.reset();
+    mEntryZones.reset();
+    mMarkerHints.reset();
+
     QSize size = mAnimation.getSize();
     if(size != QSize{0, 0})
     {
@@ -3755,6 +5669,7 @@ void Petrack::updateSequence()
     mSetSequenceFPSAct->setEnabled(true);
     mPrintAct->setEnabled(true);
     mResetSettingsAct->setEnabled(true);
+    updateMoCapVideoDuration();
 }
 
 
@@ -3806,25 +5721,8 @@ double Petrack::getHeadSize(QPointF *pos, int pers, int frame)
     {
         if(mControlWidget->getCalibCoordDimension() == 0)
         {
-            int         diff;
-            cv::Point3f p3d = getExtrCalibration()->get3DPoint(
-                cv::Point2f(
-                    mPersonStorage.at(pers).trackPointAt(frame).x(), mPersonStorage.at(pers).trackPointAt(frame).y()),
-                mControlWidget->getDefaultHeight());
-
-            cv::Point2f p3d_x1 =
-                getExtrCalibration()->getImagePoint(cv::Point3f(p3d.x + HEAD_SIZE * 0.5, p3d.y, p3d.z));
-            cv::Point2f p3d_x2 =
-                getExtrCalibration()->getImagePoint(cv::Point3f(p3d.x - HEAD_SIZE * 0.5, p3d.y, p3d.z));
-            cv::Point2f p3d_y1 =
-                getExtrCalibration()->getImagePoint(cv::Point3f(p3d.x, p3d.y + HEAD_SIZE * 0.5, p3d.z));
-            cv::Point2f p3d_y2 =
-                getExtrCalibration()->getImagePoint(cv::Point3f(p3d.x, p3d.y - HEAD_SIZE * 0.5, p3d.z));
-
-            diff = (int) std::max(
-                sqrt(pow(p3d_x2.x - p3d_x1.x, 2) + pow(p3d_x2.y - p3d_x1.y, 2)),
-                sqrt(pow(p3d_y2.x - p3d_y1.x, 2) + pow(p3d_y2.y - p3d_y1.y, 2)));
-            return diff; // < 8 ? 8 : diff;
+            const auto &trackPoint = mPersonStorage.at(pers).trackPointAt(frame);
+            return getHeadSizeAt(cv::Point2f(trackPoint.x(), trackPoint.y()));
         }
         else
         {
@@ -3847,9 +5745,9 @@ double Petrack::getHeadSize(QPointF *pos, int pers, int frame)
         }
     }
 
-    if(pos != nullptr)
+    if(pos != nullptr && mControlWidget->getCalibCoordDimension() == 0)
     {
-        return mHeadSize; // muss noch aus density map gelesen werden!!!
+        return getHeadSizeAt(cv::Point2f(pos->x(), pos->y()));
     }
     else //(pos == NULL) && (pers == -1)
     {
@@ -3857,6 +5755,144 @@ double Petrack::getHeadSize(QPointF *pos, int pers, int frame)
     }
 }
 
+/**
+ * @brief Head size at the default height in pixel at pos, looked up in the pixel size map
+ *
+ * Falls back to the exact computation for positions outside of the image.
+ *
+ * @param pos image point (without border)
+ * @return head size in whole pixel
+ */
+double Petrack::getHeadSizeAt(const cv::Point2f &pos)
+{
+    const auto &map = getPixelSizeMap();
+    if(map.contains(pos))
+    {
+        return static_cast<int>(map.at(pos).headSize);
+    }
+    return static_cast<int>(computeHeadSize(pos));
+}
+
+/**
+ * @brief Computes the head size at the default height in pixel at pos
+ *
+ * The head is projected into the world at the default height and its extent
+ * in x and y direction is projected back into the image.
+ *
+ * @param pos image point (without border)
+ * @return head size in pixel
+ */
+double Petrack::computeHeadSize(const cv::Point2f &pos)
+{
+    cv::Point3f p3d = getExtrCalibration()->get3DPoint(pos, mControlWidget->getDefaultHeight());
+
+    const auto p2d = getExtrCalibration()->getImagePoint(std::vector<cv::Point3f>{
+        cv::Point3f(p3d.x + HEAD_SIZE * 0.5, p3d.y, p3d.z),
+        cv::Point3f(p3d.x - HEAD_SIZE * 0.5, p3d.y, p3d.z),
+        cv::Point3f(p3d.x, p3d.y + HEAD_SIZE * 0.5, p3d.z),
+        cv::Point3f(p3d.x, p3d.y - HEAD_SIZE * 0.5, p3d.z)});
+
+    return std::max(
+        sqrt(pow(p2d[1].x - p2d[0].x, 2) + pow(p2d[1].y - p2d[0].y, 2)),
+        sqrt(pow(p2d[3].x - p2d[2].x, 2) + pow(p2d[3].y - p2d[2].y, 2)));
+}
+
+/**
+ * @brief Side lengths of the pixel at pos in cm at the default height
+ *
+ * Same as WorldImageCorrespondence::getCmPerPixel(px, py, defaultHeight), but
+ * looked up in the pixel size map inside of the image.
+ *
+ * @param pos image point (without border)
+ * @return lengths of the sides of the pixel
+ */
+QPointF Petrack::getCmPerPixel(const cv::Point2f &pos)
+{
+    const auto &map = getPixelSizeMap();
+    if(map.contains(pos))
+    {
+        const auto sample = map.at(pos);
+        return QPointF(sample.cmPerPixelX, sample.cmPerPixelY);
+    }
+    return mWorldImageCorrespondence->getCmPerPixel(pos.x, pos.y, mControlWidget->getDefaultHeight());
+}
+
+/**
+ * @brief Map of the head size and cm per pixel at the default height over the image
+ *
+ * The map is rebuilt, if the calibration, the default height or the image size
+ * changed since the last call. Without an image, the map is empty.
+ *
+ * @return the map for the current calibration
+ */
+const PixelSizeMap &Petrack::getPixelSizeMap()
+{
+    // the values change slowly over the image, so a coarse grid is sufficient
+    constexpr int cellSize = 32;
+
+    if(!mImage)
+    {
+        mPixelSizeMap.clear();
+        mPixelSizeMapKey.reset();
+        return mPixelSizeMap;
+    }
+
+    PixelSizeMapKey key;
+    key.extrParams = mControlWidget->getExtrinsicParameters();
+    key.intrParams = mControlWidget->getIntrinsicCameraParams();
+    key.height     = mControlWidget->getDefaultHeight();
+    key.borderSize = getImageBorderSize();
+    key.imageSize  = cv::Size(mImage->width(), mImage->height());
+    if(mPixelSizeMapKey && *mPixelSizeMapKey == key)
+    {
+        return mPixelSizeMap;
+    }
+
+    const double height = key.height;
+    auto         sample = [this, height](const std::vector<cv::Point2f> &nodes)
+    {
+        const auto *calib = getExtrCalibration();
+        const auto  p3d   = calib->get3DPoint(nodes, height);
+
+        std::vector<cv::Point3f> headPoints;
+        std::vector<cv::Point2f> pixelPoints;
+        headPoints.reserve(4 * nodes.size());
+        pixelPoints.reserve(4 * nodes.size());
+        for(size_t i = 0; i < nodes.size(); ++i)
+        {
+            headPoints.emplace_back(p3d[i].x + HEAD_SIZE * 0.5, p3d[i].y, p3d[i].z);
+            headPoints.emplace_back(p3d[i].x - HEAD_SIZE * 0.5, p3d[i].y, p3d[i].z);
+            headPoints.emplace_back(p3d[i].x, p3d[i].y + HEAD_SIZE * 0.5, p3d[i].z);
+            headPoints.emplace_back(p3d[i].x, p3d[i].y - HEAD_SIZE * 0.5, p3d[i].z);
+
+            pixelPoints.emplace_back(nodes[i].x - 0.5, nodes[i].y);
+            pixelPoints.emplace_back(nodes[i].x + 0.5, nodes[i].y);
+            pixelPoints.emplace_back(nodes[i].x, nodes[i].y - 0.5);
+            pixelPoints.emplace_back(nodes[i].x, nodes[i].y + 0.5);
+        }
+        const auto head2D  = calib->getImagePoint(headPoints);
+        const auto pixel3D = calib->get3DPoint(pixelPoints, height);
+
+        std::vector<PixelSizeMap::Sample> samples(nodes.size());
+        for(size_t i = 0; i < nodes.size(); ++i)
+        {
+            const size_t k     = 4 * i;
+            const double headX = cv::norm(head2D[k + 1] - head2D[k]);
+            const double headY = cv::norm(head2D[k + 3] - head2D[k + 2]);
+
+            samples[i].headSize    = static_cast<float>(std::max(headX, headY));
+            samples[i].cmPerPixelX = static_cast<float>(cv::norm(pixel3D[k] - pixel3D[k + 1]));
+            samples[i].cmPerPixelY = static_cast<float>(cv::norm(pixel3D[k + 2] - pixel3D[k + 3]));
+        }
+        return samples;
+    };
+
+    const int bS = key.borderSize;
+    mPixelSizeMap.build(cv::Rect(-bS, -bS, key.imageSize.width, key.imageSize.height), cellSize, sample);
+    mPixelSizeMapKey = key;
+    return mPixelSizeMap;
+}
+
 void Petrack::setProFileName(const QString &fileName)
 {
     // don't change project Name to an autosave
@@ -3885,37 +5921,48 @@ const WorldImageCorrespondence &Petrack::getWorldImageCorrespondence()
  * Only people selected via "show only people" (single person) or "show only
  * people list"(multiple persons) are going to be selected.
  *
+ * The selection is parsed only if the input changed; it is asked for on every frame and paint.
+ *
  * @return All user selected pedestrian (empty for all pedestrians)
  */
-QSet<size_t> Petrack::getPedestrianUserSelection()
+const QSet<size_t> &Petrack::getPedestrianUserSelection()
 {
+    PedestrianSelectionKey key{
+        mControlWidget->isTrackShowOnlyChecked(),
+        mControlWidget->getTrackShowOnlyNr(),
+        mControlWidget->isTrackShowOnlyListChecked(),
+        mControlWidget->isTrackShowOnlyListChecked() ? mControlWidget->trackShowOnlyNrList()->text() : QString()};
+    if(mPedestrianSelectionKey && *mPedestrianSelectionKey == key)
+    {
+        return mPedestrianSelection;
+    }
+    mPedestrianSelectionKey = std::move(key);
+    mPedestrianSelection.clear();
+
     if(mControlWidget->isTrackShowOnlyChecked())
     {
-        QSet<size_t> onlyVisible;
         // subtraction needed as in UI ID start at 1 and internally at 0
-        onlyVisible.insert(mControlWidget->getTrackShowOnlyNr() - 1);
-        return onlyVisible;
+        mPedestrianSelection.insert(mControlWidget->getTrackShowOnlyNr() - 1);
+        return mPedestrianSelection;
     }
     if(mControlWidget->isTrackShowOnlyListChecked())
     {
         auto enteredIDs = util::splitStringToInt(mControlWidget->trackShowOnlyNrList()->text());
         if(enteredIDs.has_value())
         {
-            QSet<size_t> selectedIDs;
             for(auto id : enteredIDs.value())
             {
                 // subtraction needed as in UI ID start at 1 and internally at 0
-                selectedIDs.insert(id - 1);
+                mPedestrianSelection.insert(id - 1);
             }
             mControlWidget->trackShowOnlyNrList()->setStyleSheet("");
-            return selectedIDs;
         }
         else
         {
             mControlWidget->trackShowOnlyNrList()->setStyleSheet("border: 1px solid red");
         }
     }
-    return QSet<size_t>();
+    return mPedestrianSelection;
 }
 
 /**
@@ -3983,18 +6030,23 @@ std::optional<QSet<int>> util::splitStringToInt(const QString &input)
  *
  * If "only for selected" is checked, then only selected people (@see
  * Petrack::getPedestrianUserSelection()) are going to be tracked, all people
- * otherwise.
+ * otherwise. While a Retracking runs, only its persons are tracked.
  *
  * @return all trajectories which should be evaluated; empty when all should be evaluated
  */
-QSet<size_t> Petrack::getPedestriansToTrack()
+const QSet<size_t> &Petrack::getPedestriansToTrack()
 {
+    if(!mRetrackPersons.isEmpty())
+    {
+        return mRetrackPersons;
+    }
     if(mControlWidget->isTrackOnlySelectedChecked())
     {
         return getPedestrianUserSelection();
     }
 
-    return QSet<size_t>();
+    static const QSet<size_t> all;
+    return all;
 }
 
 void Petrack::addManualTrackPointOnlyVisible(const QPointF &pos)
@@ -4091,6 +6143,66 @@ void Petrack::deleteTrackPointInsideROI()
     mScene->update();
 }
 
+/**
+ * @brief Tracks the persons selected by "show only" again from the current frame on
+ *
+ * The frame to track to is asked for; a frame before the current one tracks backwards.
+ * Only the patches around the persons are processed (see Retracking).
+ */
+void Petrack::retrackSelectedPersons()
+{
+    const QSet<size_t> persons = getPedestrianUserSelection();
+    if(persons.isEmpty() || mAnimation.getNumFrames() == 0)
+    {
+        PWarning(this, tr("PeTrack"), tr("Select the trajectories to track again with \"show only\" first."));
+        return;
+    }
+
+    const int firstFrame = mPlayerWidget->getPos();
+    bool      ok         = false;
+    const int lastFrame  = QInputDialog::getInt(
+        this,
+        tr("Re-track selected trajectories"),
+        tr("Track the selected trajectories from frame %1 to frame:").arg(firstFrame),
+        mAnimation.getSourceOutFrameNum(),
+        mAnimation.getSourceInFrameNum(),
+        mAnimation.getSourceOutFrameNum(),
+        1,
+        &ok);
+    if(!ok || lastFrame == firstFrame)
+    {
+        return;
+    }
+
+    QProgressDialog progress(
+        tr("Tracking the selected trajectories..."), tr("Abort tracking"), 0, std::abs(lastFrame - firstFrame), this);
+    progress.setWindowModality(Qt::WindowModal);
+
+    Retracking retracking(*this);
+    retracking.setPersons(persons);
+    retracking.setFrameRange(firstFrame, lastFrame);
+    retracking.setProgressCallback(
+        [&progress](int processed, int)
+        {
+            progress.setValue(processed);
+            qApp->processEvents();
+            return !progress.wasCanceled();
+        });
+    retracking.run();
+    progress.setValue(progress.maximum());
+
+    // the view needs the whole filtered image of the frame the run started at again
+    const bool tracking = mControlWidget->isOnlineTrackingChecked();
+    mControlWidget->setOnlineTrackingChecked(false);
+    const bool skipped = mPlayerWidget->skipToFrame(firstFrame);
+    mControlWidget->setOnlineTrackingChecked(tracking);
+    if(!skipped)
+    {
+        updateImage();
+    }
+    updateControlWidget();
+}
+
 void Petrack::moveTrackPoint(QPointF pos)
 {
     mManualTrackPointMover.moveTrackPoint(pos, mPersonStorage);
@@ -4108,7 +6220,7 @@ void Petrack::selectPersonForMoveTrackPoint(QPointF pos)
 
     if(successfullySelected)
     {
-        mPersonStorage.onManualAction();
+        mPersonStorage.onManualAction({static_cast<size_t>(mManualTrackPointMover.getSelectedPerson())});
         setCursor(QCursor{Qt::CursorShape::DragMoveCursor});
     }
 }
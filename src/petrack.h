@@ -20,11 +20,16 @@
 #define PETRACK_H
 
 #include <QDomDocument>
+#include <QElapsedTimer>
+#include <QFuture>
 #include <QKeyEvent>
 #include <QMainWindow>
 #include <QMouseEvent>
+#include <QTimer>
+#include <map>
 #include <opencv2/opencv.hpp>
 #include <optional>
+#include <unordered_map>
 
 #ifdef STEREO
 #include "calibStereoFilter.h"
@@ -38,12 +43,30 @@
 #include "borderFilter.h"
 #include "brightContrastFilter.h"
 #include "calibFilter.h"
+#include "crowdMetrics.h"
+#include "detectionCache.h"
+#include "entryZones.h"
+#include "disparityStore.h"
 #include "extrCalibration.h"
+#include "filteredFrameStore.h"
+#include "frameContext.h"
+#include "frameChangeDetector.h"
+#include "framePipeline.h"
+#include "fusedPreprocessor.h"
+#include "liveBudget.h"
+#include "livePublisher.h"
+#include "liveSharedMemory.h"
 #include "logwindow.h"
 #include "manualTrackpointMover.h"
+#include "markerHints.h"
 #include "moCapController.h"
 #include "moCapPerson.h"
 #include "personStorage.h"
+#include "pipelineStatistics.h"
+#include "pixelSizeMap.h"
+#include "pointUndistortion.h"
+#include "recoSchedule.h"
+#include "recognitionResult.h"
 #include "swapFilter.h"
 #include "trackerReal.h"
 
@@ -84,6 +107,7 @@ class CodeMarkerWidget;
 class MultiColorMarkerWidget;
 class ViewWidget;
 class LogWindow;
+class StatisticsPanel;
 class Player;
 class TrackerItem;
 class StereoItem;
@@ -121,6 +145,7 @@ private slots:
     void setFPS(double fps);
     void setSequenceFPS(double fps);
     void setSequenceFPSDialog();
+    void setMezzanine(bool enabled);
     void antialias();
     void opengl();
     void reset();
@@ -129,6 +154,7 @@ private slots:
     void commandLineOptions();
     void keyBindings();
     void showLogWindow();
+    void showStatisticsPanel();
     void showGroupAnnotationWindow();
     void about();
     void onlineHelp();
@@ -141,14 +167,18 @@ public slots:
     bool saveSameProject();
     bool saveProjectAs();
     bool saveProject(QString fileName = "");
-    void writeXmlElement(QXmlStreamWriter &xmlStream, QDomElement element);
+    QDomDocument projectDocument();
+    static QByteArray projectXml(const QDomDocument &doc);
+    static void writeXmlElement(QXmlStreamWriter &xmlStream, const QDomElement &element);
     void openSequence(QString fileName = "");
     void openCameraLiveStream(int camID = -1);
     void openMoCapFile();
     void editMoCapSettings();
+    void runPythonScript();
     void exportSequence(bool saveVideo, bool saveView = false, QString dest = "");
     void exportView(QString dest = "");
     void exportImage(QString dest = "");
+    bool exportPointCloudSequence(const QString &dest);
     void setStatusPosReal();
     void addManualTrackPointOnlyVisible(const QPointF &pos);
     void splitTrackPerson(QPointF pos);
@@ -160,6 +190,7 @@ public slots:
     void deleteTrackPointAll(PersonStorage::TrajectorySegment direction);
     void deleteTrackPointROI();
     void deleteTrackPointInsideROI();
+    void retrackSelectedPersons();
     void moveTrackPoint(QPointF pos);
     void selectPersonForMoveTrackPoint(QPointF pos);
     void releaseTrackPoint();
@@ -193,13 +224,18 @@ public:
     int          winSize(QPointF *pos = nullptr, int pers = -1, int frame = -1, int level = -1);
     void         updateImage(bool imageChanged = false);
     void         updateImage(const cv::Mat &img);
+    void         requestUpdateImage();
+    void         processFrame(const cv::Mat &img, bool track, bool recognize);
     void         updateSequence();
-    QSet<size_t> getPedestrianUserSelection();
-    QSet<size_t> getPedestriansToTrack();
-    double       getCmPerPixel() const;
+    const QSet<size_t> &getPedestrianUserSelection();
+    const QSet<size_t> &getPedestriansToTrack();
+    double              getCmPerPixel() const;
     void         setHeadSize(double hS = -1);
     double       getHeadSize(QPointF *pos = nullptr, int pers = -1, int frame = -1);
 
+    QPointF             getCmPerPixel(const cv::Point2f &pos);
+    const PixelSizeMap &getPixelSizeMap();
+
     //------------------------------
     // inline function
     bool isLoading() const { return mLoading; }
@@ -210,6 +246,8 @@ public:
 
     void setProFileName(const QString &fileName);
 
+    DisparityStore *getDisparityStore();
+
 public:
     inline QString getTrackFileName() { return mTrcFileName; }
     inline void    setTrackFileName(const QString &fn) { mTrcFileName = fn; }
@@ -221,11 +259,12 @@ public:
     inline Control                *getControlWidget() { return mControlWidget; }
     inline reco::Recognizer       &getRecognizer() { return mReco; }
     inline StereoWidget           *getStereoWidget() { return mStereoWidget; }
+    inline bool                    isStereoRoiOnly() const { return mStereoRoiOnly; }
     inline ColorRangeWidget       *getColorRangeWidget() { return mColorRangeWidget; }
     inline ColorMarkerWidget      *getColorMarkerWidget() { return mColorMarkerWidget; }
     inline CodeMarkerWidget       *getCodeMarkerWidget() { return mCodeMarkerWidget; }
     inline MultiColorMarkerWidget *getMultiColorMarkerWidget() { return mMultiColorMarkerWidget; }
-    inline LogWindow              *getLogWindow() { return mLogWindow; }
+    LogWindow                     *getLogWindow();
     inline GraphicsView           *getView() { return mView; }
     inline QGraphicsScene         *getScene() { return mScene; }
     inline QImage                 *getImage() { return mImage; }
@@ -322,12 +361,49 @@ public:
         bool swapFilterChanged,
         bool borderFilterChanged,
         bool calibFilterChanged);
-    void resetExistingPoints();
-    void performTracking();
-    void performRecognition();
+    cv::Rect getFilterRoi();
+    void     updateMezzanine();
+    void     resetExistingPoints();
+    bool     sampleBackground(int count = BackgroundModel::DEFAULT_SAMPLES);
+
+    std::vector<std::pair<QString, FilterStatistics>> getFilterStatistics() const;
+    void                                              logFilterStatistics() const;
+    bool                                              exportFilterStatistics(const QString &fileName) const;
+    void                                              resetFilterStatistics();
+
+    PipelineStatistics &getPipelineStatistics() { return mPipelineStatistics; }
+    MemoryUsage         getMemoryUsage() const;
+    FramePipeline      &getFramePipeline() { return mFramePipeline; }
+
+    void                     performTracking();
+    QRect                    getTrackingRoi() const;
+    QRect                    getRecognitionRoi() const;
+    reco::RecognitionOptions getRecognitionOptions(int frameNum);
+    void                     startRecognition();
+    void                     performRecognition(bool recognize);
+    bool                     processFrame(bool imageChanged, bool track, bool recognize);
+
+    FrameChangeDetector::Change detectFrameChange(int frameNum);
+    bool                        copyPreviousFrame();
+
+    inline bool isAutoBackTrack() const { return mAutoBackTrack; }
+    inline bool isAutoTrackOptimizeColor() const { return mAutoTrackOptimizeColor; }
+    inline void setBatchProcessing(bool batchProcessing) { mBatchProcessing = batchProcessing; }
+    void        setRetracking(const QSet<size_t> &persons, const cv::Rect &patch);
+    /// filtered frame store and detection cache are only read, e.g. if several processes share them
+    inline void setReadOnlyCaches(bool readOnly) { mReadOnlyCaches = readOnly; }
+    /// projects are opened without their trajectories, e.g. by processes tracking only a part for a parent process
+    inline void setLoadTrajectories(bool load) { mLoadTrajectories = load; }
+    void        setHeadless(bool headless);
+    inline bool isHeadless() const { return mHeadless; }
+    /// duration of the parts of the construction in ms, e.g. to find out what slows down the startup
+    inline const std::vector<std::pair<std::string, qint64>> &getStartupTimes() const { return mStartupTimes; }
+    /// identifies the sequence and the filters applied before the background subtraction
+    QString getFilteredFrameStoreName();
 
 private slots:
     void openAutosaveSettings();
+    void updateRequestedImage();
 
 private:
     void createActions();
@@ -339,6 +415,29 @@ private:
 
     bool maybeSave();
 
+    QSize exportViewSize() const;
+    void  renderExportView(QImage &image);
+
+    QString getSequenceCacheBase();
+    void    updateFilteredFrameStore(bool filterChanged);
+    QString getDetectionCacheName();
+    void    updateDetectionCache();
+    QString getDisparityStoreName();
+    void    updateGrayscalePipeline();
+    void    handleDuplicates();
+    int     importWorldTrajectories(const std::unordered_map<int, std::map<int, Vec3F>> &personData);
+    double  computeHeadSize(const cv::Point2f &pos);
+    double  getHeadSizeAt(const cv::Point2f &pos);
+    void    updateMoCapVideoDuration();
+    bool    isLiveRealTime() const;
+    bool    isUpdateOutdated();
+    int     getTrackRegionLevels() const;
+    int     getTrackRegionScale() const;
+    void    publishLivePositions(int frameNum, double latency);
+    void    updateCrowdMetrics(int frameNum);
+
+    std::vector<LivePosition> worldPositions(int frameNum);
+
     void keyPressEvent(QKeyEvent *event);
     void mousePressEvent(QMouseEvent *event);
 
@@ -354,13 +453,15 @@ private:
     ColorMarkerWidget      *mColorMarkerWidget;
     CodeMarkerWidget       *mCodeMarkerWidget;
     MultiColorMarkerWidget *mMultiColorMarkerWidget;
-    LogWindow              *mLogWindow;
-    AnnotationGroupWidget  *mGroupingWidget;
+    LogWindow              *mLogWindow       = nullptr; ///< created when it is shown first
+    StatisticsPanel        *mStatisticsPanel = nullptr; ///< created when it is shown first
+    AnnotationGroupWidget  *mGroupingWidget  = nullptr; ///< created when it is shown first
 
     QAction      *mOpenSeqAct;
     QAction      *mOpenCameraAct;
     QAction      *mOpenMoCapAct;
     QAction      *mEditMoCapAct;
+    QAction      *mRunPythonScriptAct = nullptr; ///< only with the CMake option PYTHON
     QAction      *mExportSeqVidAct;
     QAction      *mExportSeqVidViewAct;
     QAction      *mExportSeqImgAct;
@@ -374,6 +475,7 @@ private:
     QAction      *mResetSettingsAct;
     QAction      *mExitAct;
     QAction      *mSetSequenceFPSAct;
+    QAction      *mMezzanineAct;
     QAction      *mFontAct;
     QAction      *mHideControlsAct;
     QAction      *mAntialiasAct;
@@ -401,9 +503,11 @@ private:
     QAction      *mDelFutureAct;
     QAction      *mDelAllRoiAct;
     QAction      *mDelPartRoiAct;
+    QAction      *mRetrackAct;
     QAction      *mCommandAct;
     QAction      *mKeyAct;
     QAction      *mShowLogWindowAct;
+    QAction      *mShowStatisticsPanelAct;
     QAction      *mShowGroupAnnotationWindowAct;
     QAction      *mAboutAct;
     QAction      *mOnlineHelpAct;
@@ -453,6 +557,7 @@ private:
     QLabel         *mStatusLabelStereo;
     QLabel         *mStatusLabelTime;
     QLabel         *mStatusLabelFPS;
+    QLabel         *mStatusLabelDropped;
     QLabel         *mStatusLabelPosReal;
     QLabel         *mStatusLabelPos;
     QLabel         *mStatusLabelColor;
@@ -465,6 +570,74 @@ private:
     SwapFilter           mSwapFilter;
     BackgroundFilter     mBackgroundFilter;
 
+    // filtered frames (before background subtraction) of former runs with the same filter parameters
+    FilteredFrameStore mFilteredFrameStore;
+    bool               mUseFilteredFrameStore = false;
+    bool               mFilterChainSkipped    = false; ///< filters did not see mImg (store or fused stage was used)
+    FilterStatistics   mFrameStoreStatistics;          ///< frames read from the store count as reused
+
+    // detections of former runs with the same recognition parameters
+    DetectionCache mDetectionCache;
+    QString        mDetectionCacheName; ///< empty, if the parameters changed since getDetectionCacheName()
+    bool           mUseDetectionCache = false;
+    bool           mReadOnlyCaches    = false; ///< applies to mFilteredFrameStore and mDisparityStore as well
+
+    // disparities of former runs with the same stereo parameters
+    DisparityStore mDisparityStore;
+    bool           mUseDisparityStore = false;
+
+    // swap, brightness/contrast, border and calibration filter in one stage
+    FusedPreprocessor mFusedPreprocessor;
+    bool              mFusedPreprocessing = false;
+    bool              mFusedPreprocessed  = false; ///< last preprocessing was done by mFusedPreprocessor
+    FilterStatistics  mFusedStatistics;
+
+    bool mVirtualBorder = false; ///< decode video frames into buffers with the border of mBorderFilter
+
+    PipelineStatistics mPipelineStatistics; ///< filter, track and recognize are timed by processFrame()
+
+    bool mGrayscalePipeline = false; ///< process gray frames, if the recognition method does not need color
+    bool mExportRunning     = false; ///< frames are exported, so no proxy frames may be shown
+    bool mRoiFiltering      = false; ///< in batch processing only filter the region used by tracking and recognition
+    bool mSessionSnapshot   = false; ///< write a binary snapshot of the read data on saving, see IO::SessionSnapshot
+    bool mUseMezzanine      = false; ///< decode the working range of videos from an all-intra copy
+    bool mMezzanineRoiOnly  = false; ///< the all-intra copy only contains the tracking and recognition ROI
+    bool mBatchProcessing   = false; ///< trackAll() or a TrackingEngine is running
+    bool mPlayingAll        = false; ///< playAll() is running
+    bool mHeadless          = false; ///< the main window is not shown, so frames are only shown for exports
+    bool mLoadTrajectories  = true;  ///< openXml() imports the trajectory file of the project
+    bool mStereoRoiOnly     = false; ///< only compute the disparity for the rows of tracking and recognition ROI
+    bool mDeferUpdates      = false; ///< openXml() applies settings, so updateImage() only remembers the update
+    bool mDeferredChange    = false; ///< a deferred update showed a new frame
+
+    PointUndistortion mPointUndistortion;           ///< undistorts the points found on raw frames
+    bool              mUndistortPointsOnly = false; ///< in batch processing track on the distorted frame
+    bool              mRawFrame            = false; ///< mImgFiltered is not undistorted, see mPointUndistortion
+
+    // pixels the all-intra copy extends beyond the ROI, since the calibration moves pixels into it
+    static constexpr int MEZZANINE_CROP_MARGIN = 64;
+
+    QSet<size_t> mRetrackPersons; ///< persons tracked by a running Retracking; empty otherwise
+    cv::Rect     mRetrackPatch;   ///< region around mRetrackPersons, which is filtered and tracked
+
+    // updates requested by parameter edits
+    QTimer mUpdateTimer;                       ///< runs until the edits pause for a moment
+    bool   mUpdating                  = false; ///< updateImage() is running
+    bool   mRequestedUpdate           = false; ///< the running update was requested by requestUpdateImage()
+    bool   mOutdatedParametersChanged = false; ///< an outdated update did not recognize with changed parameters
+
+    cv::VideoAccelerationType mExportHwAcceleration = cv::VIDEO_ACCELERATION_NONE; ///< encoder for exported mp4 videos
+    int                       mExportThreads        = 0;     ///< threads saving exported images; 0 for all cores
+    int                       mExportQuality        = -1;    ///< quality of exported images (0..100), -1 for default
+    int                       mPointCloudDecimation = 1;     ///< export every n-th row and column of point clouds
+    bool                      mPointCloudRoiOnly    = false; ///< crop exported point clouds to the tracking ROI
+    int                       mThreads              = 0;     ///< threads of the project (see concurrency); 0 for all
+
+    // duplicate trajectories (e.g. two IDs on one head) searched before exporting the trajectories
+    double mDuplicateDistance = 0;     ///< factor of the head size, below which two points are close; 0 disables
+    double mDuplicateShare    = 0.8;   ///< share of the common frames, in which duplicates are close
+    bool   mMergeDuplicates   = false; ///< merge the duplicates instead of only reporting them
+
     AutoCalib                       mAutoCalib;
     ExtrCalibration                 mExtrCalibration;
     const WorldImageCorrespondence *mWorldImageCorrespondence;
@@ -474,6 +647,31 @@ private:
 
     reco::Recognizer mReco;
 
+    QElapsedTimer mLastDisplay; ///< time since the view was refreshed by updateImage()
+
+    LiveBudget       mLiveBudget;       ///< adapts the processing of camera live streams to a latency budget, if set
+    LivePublisher    mLivePublisher;    ///< sends the positions of every processed live frame, if a target is set
+    LiveSharedMemory mLiveSharedMemory; ///< writes them into a shared ring buffer, if a file is set
+    RecoSchedule     mRecoSchedule;     ///< adapts the recognition step to the tracking, if enabled
+
+    FrameChangeDetector mFrameChange;  ///< skips the processing of duplicate and static frames, if enabled
+    EntryZones          mEntryZones;   ///< searched by guided recognitions instead of the ROI border, if enabled
+    CrowdMetrics        mCrowdMetrics; ///< measured on every frame processed by trackAll(), if enabled
+    MarkerHints         mMarkerHints;  ///< rejected code markers near trajectories used by the next frame, if enabled
+
+    std::shared_ptr<const FrameContext> mFrameContext;  ///< derived views of mImgFiltered, renewed by processFrame()
+    FramePipeline                       mFramePipeline; ///< custom stages run on each frame by processFrame()
+
+    // detection of the current frame, running on a worker thread while the frame is tracked
+    QFuture<reco::RecognitionResult> mPendingRecognition;
+    int                              mPendingRecognitionFrame = -1;
+
+    // between full scans of the recognition ROI every k frames only search near the persons; 0 for always full
+    int  mGuidedRecognitionInterval = 0;
+    int  mLastFullRecognitionFrame  = -1;
+    bool mGuidedRecognition         = false; ///< the last options were restricted to the surroundings of the persons
+    bool mHintedRecognition         = false; ///< the last options searched the hints of mMarkerHints again
+
     QDomDocument mDefaultSettings;
     Autosave     mAutosave{*this};
 
@@ -483,6 +681,41 @@ private:
     double        mHeadSize;
     double        mCmPerPixel;
 
+    /// calibration the pixel size map was built for
+    struct PixelSizeMapKey
+    {
+        ExtrinsicParameters   extrParams;
+        IntrinsicCameraParams intrParams;
+        double                height     = 0;
+        int                   borderSize = 0;
+        cv::Size              imageSize;
+
+        friend bool operator==(const PixelSizeMapKey &lhs, const PixelSizeMapKey &rhs)
+        {
+            return lhs.extrParams == rhs.extrParams && lhs.intrParams == rhs.intrParams && lhs.height == rhs.height &&
+                   lhs.borderSize == rhs.borderSize && lhs.imageSize == rhs.imageSize;
+        }
+    };
+    PixelSizeMap                   mPixelSizeMap; ///< head size and cm per pixel at the default height
+    std::optional<PixelSizeMapKey> mPixelSizeMapKey;
+
+    /// input of the pedestrian selection, to parse the list only after it was edited
+    struct PedestrianSelectionKey
+    {
+        bool    showOnly     = false;
+        int     showOnlyNr   = 0;
+        bool    showOnlyList = false;
+        QString list;
+
+        friend bool operator==(const PedestrianSelectionKey &lhs, const PedestrianSelectionKey &rhs)
+        {
+            return lhs.showOnly == rhs.showOnly && lhs.showOnlyNr == rhs.showOnlyNr &&
+                   lhs.showOnlyList == rhs.showOnlyList && lhs.list == rhs.list;
+        }
+    };
+    QSet<size_t>                          mPedestrianSelection; ///< see getPedestrianUserSelection()
+    std::optional<PedestrianSelectionKey> mPedestrianSelectionKey;
+
     ManualTrackpointMover mManualTrackPointMover;
 
     double mShowFPS;
@@ -508,6 +741,8 @@ private:
 
     std::vector<std::string> mAuthors;
 
+    std::vector<std::pair<std::string, qint64>> mStartupTimes;
+
     MissingFrames mMissingFrames{false, {}}; ///< Missing frame information
 };
 
@@ -19,12 +19,95 @@
 
 #include "personStorage.h"
 #include "petrack.h"
+#include "trackPointGrid.h"
+#include "trajectoryVelocity.h"
 
 #include <QApplication> // for qApp
 #include <QProgressDialog>
+#include <algorithm>
+#include <iterator>
+#include <map>
 
 namespace plausibility
 {
+namespace
+{
+void checkLengthOfPerson(
+    const PersonStorage      &personStorage,
+    size_t                    i,
+    int                       minLength,
+    std::vector<FailedCheck> &failedChecks)
+{
+    if(personStorage.at(i).size() < minLength)
+    {
+        failedChecks.push_back(
+            {i + 1,
+             personStorage.at(i).firstFrame(),
+             fmt::format("Has less than {} trackpoints!", minLength),
+             plausibility::CheckType::Length});
+    }
+}
+
+/// area of the image and the reco ROI in which no trajectory should start or end
+QRectF insideCheckRect(const cv::Size &sequenceSize, int imageBorderSize, QRectF rect, int margin)
+{
+    const int    imgWidth  = sequenceSize.width - 1 - 2 * imageBorderSize - margin;
+    const int    imgHeight = sequenceSize.height - 1 - 2 * imageBorderSize - margin;
+    const QRectF imgRect(margin, margin, imgWidth, imgHeight);
+    return imgRect.intersected(rect);
+}
+
+void checkInsideOfPerson(
+    const PersonStorage      &personStorage,
+    size_t                    i,
+    const QRectF             &checkRect,
+    int                       firstFrame,
+    int                       lastFrame,
+    std::vector<FailedCheck> &failedChecks)
+{
+    double x = personStorage.at(i).first().x();
+    double y = personStorage.at(i).first().y();
+
+    if(personStorage.at(i).firstFrame() != firstFrame && checkRect.contains(x, y))
+    {
+        failedChecks.push_back(
+            {i + 1,
+             personStorage.at(i).firstFrame(),
+             "Start of trajectory is inside picture and reco ROI!",
+             plausibility::CheckType::Inside});
+    }
+
+    x = personStorage.at(i).last().x();
+    y = personStorage.at(i).last().y();
+
+    if(personStorage.at(i).lastFrame() != lastFrame && checkRect.contains(x, y))
+    {
+        failedChecks.push_back(
+            {i + 1,
+             personStorage.at(i).lastFrame(),
+             "End of trajectory is inside picture and reco ROI!",
+             plausibility::CheckType::Inside});
+    }
+}
+
+void checkVelocityVariationOfPerson(
+    const PersonStorage      &personStorage,
+    size_t                    i,
+    std::vector<FailedCheck> &failedChecks)
+{
+    const auto &person    = personStorage.at(i);
+    const auto &columns   = person.columns();
+    const auto  distances = velocity::stepDistances(columns.xData(), columns.yData(), columns.size());
+    for(int j : velocity::findVariations(distances))
+    {
+        failedChecks.push_back(
+            {i + 1,
+             j + person.firstFrame(),
+             "Fast variation of velocity to following frame!",
+             plausibility::CheckType::Velocity});
+    }
+}
+} // namespace
 
 /**
  * Checks if the length for any trajectory is less than minLength frames.
@@ -44,14 +127,19 @@ std::vector<FailedCheck> checkLength(const PersonStorage &personStorage, QProgre
 
     for(size_t i = 0; i < personStorage.nbPersons(); ++i)
     {
-        if(personStorage.at(i).size() < minLength)
-        {
-            failedChecks.push_back(
-                {i + 1,
-                 personStorage.at(i).firstFrame(),
-                 fmt::format("Has less than {} trackpoints!", minLength),
-                 plausibility::CheckType::Length});
-        }
+        checkLengthOfPerson(personStorage, i, minLength, failedChecks);
+    }
+    return failedChecks;
+}
+
+/// checkLength for the given persons only
+std::vector<FailedCheck>
+checkLength(const PersonStorage &personStorage, const std::vector<size_t> &persons, int minLength)
+{
+    std::vector<FailedCheck> failedChecks;
+    for(size_t i : persons)
+    {
+        checkLengthOfPerson(personStorage, i, minLength, failedChecks);
     }
     return failedChecks;
 }
@@ -85,40 +173,35 @@ std::vector<FailedCheck> checkInside(
     progressDialog->setLabelText("Check if trajectories are inside image...");
     qApp->processEvents();
 
-    const int    imgWidth  = sequenceSize.width - 1 - 2 * imageBorderSize - margin;
-    const int    imgHeight = sequenceSize.height - 1 - 2 * imageBorderSize - margin;
-    const QRectF imgRect(margin, margin, imgWidth, imgHeight);
-    const QRectF checkRect = imgRect.intersected(rect);
+    const QRectF checkRect = insideCheckRect(sequenceSize, imageBorderSize, rect, margin);
 
     for(size_t i = 0; i < personStorage.nbPersons(); ++i)
     {
         qApp->processEvents();
         progressDialog->setValue(100 + i * 100. / personStorage.nbPersons());
-        double x = personStorage.at(i).first().x();
-        double y = personStorage.at(i).first().y();
-
-        if(personStorage.at(i).firstFrame() != firstFrame && checkRect.contains(x, y))
-        {
-            failedChecks.push_back(
-                {i + 1,
-                 personStorage.at(i).firstFrame(),
-                 "Start of trajectory is inside picture and reco ROI!",
-                 plausibility::CheckType::Inside});
-        }
+        checkInsideOfPerson(personStorage, i, checkRect, firstFrame, lastFrame, failedChecks);
+    }
 
-        x = personStorage.at(i).last().x();
-        y = personStorage.at(i).last().y();
+    return failedChecks;
+}
 
-        if(personStorage.at(i).lastFrame() != lastFrame && checkRect.contains(x, y))
-        {
-            failedChecks.push_back(
-                {i + 1,
-                 personStorage.at(i).lastFrame(),
-                 "End of trajectory is inside picture and reco ROI!",
-                 plausibility::CheckType::Inside});
-        }
+/// checkInside for the given persons only
+std::vector<FailedCheck> checkInside(
+    const PersonStorage       &personStorage,
+    const std::vector<size_t> &persons,
+    const cv::Size            &sequenceSize,
+    int                        imageBorderSize,
+    QRectF                     rect,
+    int                        firstFrame,
+    int                        lastFrame,
+    int                        margin)
+{
+    std::vector<FailedCheck> failedChecks;
+    const QRectF             checkRect = insideCheckRect(sequenceSize, imageBorderSize, rect, margin);
+    for(size_t i : persons)
+    {
+        checkInsideOfPerson(personStorage, i, checkRect, firstFrame, lastFrame, failedChecks);
     }
-
     return failedChecks;
 }
 
@@ -152,38 +235,146 @@ std::vector<FailedCheck> checkVelocityVariation(const PersonStorage &personStora
     progressDialog->setValue(200);
     progressDialog->setLabelText("Check velocity...");
 
-    for(size_t i = 0; i < personStorage.nbPersons(); ++i) // ueber TrackPerson
+    // the persons are only read, hence they are checked in parallel
+    std::vector<std::vector<FailedCheck>> personChecks(personStorage.nbPersons());
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(personStorage.nbPersons())),
+        [&](const cv::Range &range)
+        {
+            for(int i = range.start; i < range.end; ++i)
+            {
+                checkVelocityVariationOfPerson(personStorage, i, personChecks[i]);
+            }
+        });
+    for(auto &checks : personChecks)
     {
-        qApp->processEvents();
-        progressDialog->setValue(200 + i * 100. / personStorage.nbPersons());
+        failedChecks.insert(
+            failedChecks.end(), std::make_move_iterator(checks.begin()), std::make_move_iterator(checks.end()));
+    }
 
-        // ignore first and two last TrackPoints, as these points are needed as buffer
-        for(int j = 1; j < personStorage.at(i).size() - 2; ++j)
-        {
-            double d01 = personStorage.at(i).at(j).distanceToPoint(personStorage.at(i).at(j - 1));
-            double d12 = personStorage.at(i).at(j + 1).distanceToPoint(personStorage.at(i).at(j));
-            double d23 = personStorage.at(i).at(j + 2).distanceToPoint(personStorage.at(i).at(j + 1));
+    return failedChecks;
+}
 
-            const bool largeVariation = (1.8 * (d01 + d23) / 2.) < d12;
-            const bool moving         = (d12 > 6.) || ((d01 + d23) / 2. > 3.);
+/// checkVelocityVariation for the given persons only
+std::vector<FailedCheck> checkVelocityVariation(const PersonStorage &personStorage, const std::vector<size_t> &persons)
+{
+    std::vector<FailedCheck> failedChecks;
+    for(size_t i : persons)
+    {
+        checkVelocityVariationOfPerson(personStorage, i, failedChecks);
+    }
+    return failedChecks;
+}
 
-            if(largeVariation && moving)
+namespace
+{
+/// track points and head sizes of the persons in one frame
+struct FramePoints
+{
+    int                 frame;
+    std::vector<size_t> persons; ///< ascending
+    std::vector<Vec2F>  points;
+    std::vector<double> headSizes;
+};
+
+/// track points and head sizes of the persons with a point in frame
+FramePoints collectFramePoints(const PersonStorage &personStorage, Petrack &petrack, int frame)
+{
+    // only the persons with a point in this frame can be equal
+    FramePoints framePoints{frame, personStorage.activePersons(frame), {}, {}};
+    framePoints.points.reserve(framePoints.persons.size());
+    framePoints.headSizes.reserve(framePoints.persons.size());
+    for(size_t i : framePoints.persons)
+    {
+        framePoints.points.push_back(personStorage.at(i).trackPointAt(frame));
+        framePoints.headSizes.push_back(petrack.getHeadSize(nullptr, static_cast<int>(i), frame));
+    }
+    return framePoints;
+}
+
+/**
+ * Returns every pair of a person and a person with a larger index, which is closer than
+ * headSizeFactor times the head size of the first one, in the order of the persons and
+ * then of the other persons.
+ *
+ * The points are inserted into a grid whose cells are as large as the largest distance,
+ * so only the persons in neighboring cells are compared.
+ */
+std::vector<std::pair<size_t, size_t>> closePairsInFrame(const FramePoints &framePoints, double headSizeFactor)
+{
+    std::vector<std::pair<size_t, size_t>> pairs;
+    if(framePoints.persons.size() < 2)
+    {
+        return pairs;
+    }
+    const double maxHeadSize = *std::max_element(framePoints.headSizes.begin(), framePoints.headSizes.end());
+
+    TrackPointGrid grid(headSizeFactor * maxHeadSize);
+    for(size_t k = 0; k < framePoints.persons.size(); ++k)
+    {
+        grid.set(framePoints.persons[k], framePoints.points[k], framePoints.headSizes[k]);
+    }
+
+    for(size_t k = 0; k < framePoints.persons.size(); ++k)
+    {
+        const size_t i        = framePoints.persons[k];
+        const double distance = headSizeFactor * framePoints.headSizes[k];
+        for(size_t j : grid.query(framePoints.points[k], distance))
+        {
+            // the grid also returns points exactly at distance
+            const auto other = std::lower_bound(framePoints.persons.begin(), framePoints.persons.end(), j) -
+                               framePoints.persons.begin();
+            if(j > i && framePoints.points[k].distanceToPoint(framePoints.points[other]) < distance)
             {
-                failedChecks.push_back(
-                    {i + 1,
-                     j + personStorage.at(i).firstFrame(),
-                     "Fast variation of velocity to following frame!",
-                     plausibility::CheckType::Velocity});
+                pairs.emplace_back(i, j);
             }
         }
     }
+    return pairs;
+}
 
-    return failedChecks;
+/**
+ * Returns the close pairs (see closePairsInFrame) of each frame of [blockStart, blockEnd].
+ *
+ * The track points and head sizes of the block are collected in the calling thread
+ * (PersonStorage and Petrack are not thread-safe), then the frames are checked in parallel.
+ */
+std::vector<std::vector<std::pair<size_t, size_t>>> closePairsInBlock(
+    const PersonStorage &personStorage,
+    Petrack             &petrack,
+    int                  blockStart,
+    int                  blockEnd,
+    double               headSizeFactor)
+{
+    std::vector<FramePoints> block;
+    block.reserve(blockEnd - blockStart + 1);
+    for(int frame = blockStart; frame <= blockEnd; ++frame)
+    {
+        block.push_back(collectFramePoints(personStorage, petrack, frame));
+    }
+
+    std::vector<std::vector<std::pair<size_t, size_t>>> blockPairs(block.size());
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(block.size())),
+        [&](const cv::Range &range)
+        {
+            for(int k = range.start; k < range.end; ++k)
+            {
+                blockPairs[k] = closePairsInFrame(block[k], headSizeFactor);
+            }
+        });
+    return blockPairs;
 }
 
+constexpr int FRAME_BLOCK_SIZE = 256;
+} // namespace
+
 /**
  * Checks if two trajectories are close to each other in a specific frame.
  *
+ * The frames are processed in blocks, whose frames are checked in parallel (see
+ * closePairsInBlock); their results are appended in frame order.
+ *
  * @param personStorage data container for trajectories
  * @param progressDialog dialog for showing progress of all checks
  * @param petrack main window
@@ -202,32 +393,135 @@ std::vector<FailedCheck> checkEquality(
     progressDialog->setLabelText("Check if trajectories are equal...");
     qApp->processEvents();
 
-    int largestLastFrame = personStorage.largestLastFrame();
-    for(int frame = personStorage.smallestFirstFrame(); frame <= largestLastFrame; ++frame)
+    const int largestLastFrame = personStorage.largestLastFrame();
+    for(int blockStart = personStorage.smallestFirstFrame(); blockStart <= largestLastFrame;
+        blockStart += FRAME_BLOCK_SIZE)
     {
-        progressDialog->setValue(300 + frame * 100. / largestLastFrame);
+        progressDialog->setValue(300 + blockStart * 100. / largestLastFrame);
         qApp->processEvents();
 
-        for(size_t i = 0; i < personStorage.nbPersons(); ++i)
+        const int  blockEnd   = std::min(blockStart + FRAME_BLOCK_SIZE - 1, largestLastFrame);
+        const auto blockPairs = closePairsInBlock(personStorage, petrack, blockStart, blockEnd, headSizeFactor);
+        for(size_t k = 0; k < blockPairs.size(); ++k)
         {
-            for(size_t j = i + 1; j < personStorage.nbPersons(); ++j)
+            for(const auto &[i, j] : blockPairs[k])
             {
-                if(personStorage.at(i).trackPointExist(frame) && personStorage.at(j).trackPointExist(frame))
+                failedChecks.push_back(
+                    {i + 1,
+                     blockStart + static_cast<int>(k),
+                     fmt::format("Trajectory is very close to Person {}!", j + 1),
+                     plausibility::CheckType::Equality});
+            }
+        }
+    }
+
+    return failedChecks;
+}
+/**
+ * checkEquality for the given persons only, e.g. after they were changed.
+ *
+ * Reports the same checks as checkEquality in which one of the persons is involved,
+ * i.e. also the checks of other persons which mention one of them.
+ *
+ * @param personStorage data container for trajectories
+ * @param persons ascending indices of the persons to check
+ * @param petrack main window
+ * @param headSizeFactor factor used to determine the distance at which two traj are considered equal
+ *
+ * @return vector of all failed equality checks involving one of the persons
+ */
+std::vector<FailedCheck> checkEquality(
+    const PersonStorage       &personStorage,
+    const std::vector<size_t> &persons,
+    Petrack                   &petrack,
+    double                     headSizeFactor)
+{
+    std::vector<FailedCheck> failedChecks;
+    for(size_t p : persons)
+    {
+        const auto &person = personStorage.at(p);
+        for(int frame = person.firstFrame(); frame <= person.lastFrame(); ++frame)
+        {
+            if(!person.trackPointExist(frame))
+            {
+                continue;
+            }
+            const Vec2F  point    = person.trackPointAt(frame);
+            const double headSize = petrack.getHeadSize(nullptr, static_cast<int>(p), frame);
+            for(size_t q : personStorage.activePersons(frame))
+            {
+                // pairs of two checked persons are reported with the smaller one only
+                if(q == p || (q < p && std::binary_search(persons.begin(), persons.end(), q)))
+                {
+                    continue;
+                }
+                // like in checkEquality, the distance depends on the head of the smaller index
+                const double distance =
+                    headSizeFactor * (q < p ? petrack.getHeadSize(nullptr, static_cast<int>(q), frame) : headSize);
+                if(point.distanceToPoint(personStorage.at(q).trackPointAt(frame)) < distance)
                 {
-                    if(personStorage.at(i).trackPointAt(frame).distanceToPoint(personStorage.at(j).trackPointAt(
-                           frame)) < headSizeFactor * petrack.getHeadSize(nullptr, static_cast<int>(i), frame))
-                    {
-                        failedChecks.push_back(
-                            {i + 1,
-                             frame,
-                             fmt::format("Trajectory is very close to Person {}!", j + 1),
-                             plausibility::CheckType::Equality});
-                    }
+                    failedChecks.push_back(
+                        {std::min(p, q) + 1,
+                         frame,
+                         fmt::format("Trajectory is very close to Person {}!", std::max(p, q) + 1),
+                         plausibility::CheckType::Equality});
                 }
             }
         }
     }
-
     return failedChecks;
 }
+
+/**
+ * Finds duplicate trajectories, e.g. two IDs on one head.
+ *
+ * Two trajectories are duplicates, if they are close (see checkEquality) in at least
+ * minFrames and in at least minShare of the frames, in which both exist. The frames are
+ * checked in parallel blocks like in checkEquality, so the cost grows with the number of
+ * frames and the number of persons near each other, not with the square of all persons.
+ *
+ * @param personStorage data container for trajectories
+ * @param petrack main window
+ * @param headSizeFactor factor used to determine the distance at which two traj are considered equal
+ * @param minShare share of the common frames (0..1), in which two duplicates have to be close
+ * @param minFrames number of frames, in which two duplicates have to be close at least
+ *
+ * @return the duplicates ordered by their first and then their second person
+ */
+std::vector<Duplicate> findDuplicates(
+    const PersonStorage &personStorage,
+    Petrack             &petrack,
+    double               headSizeFactor,
+    double               minShare,
+    int                  minFrames)
+{
+    std::map<std::pair<size_t, size_t>, int> closeFrames;
+    const int                                largestLastFrame = personStorage.largestLastFrame();
+    for(int blockStart = personStorage.smallestFirstFrame(); blockStart <= largestLastFrame;
+        blockStart += FRAME_BLOCK_SIZE)
+    {
+        const int blockEnd = std::min(blockStart + FRAME_BLOCK_SIZE - 1, largestLastFrame);
+        for(const auto &pairs : closePairsInBlock(personStorage, petrack, blockStart, blockEnd, headSizeFactor))
+        {
+            for(const auto &pair : pairs)
+            {
+                ++closeFrames[pair];
+            }
+        }
+    }
+
+    std::vector<Duplicate> duplicates;
+    for(const auto &[pair, count] : closeFrames)
+    {
+        const auto &first  = personStorage.at(pair.first);
+        const auto &second = personStorage.at(pair.second);
+        const int   common = std::min(first.lastFrame(), second.lastFrame()) -
+                             std::max(first.firstFrame(), second.firstFrame()) + 1;
+        if(count >= minFrames && count >= minShare * common)
+        {
+            duplicates.push_back({pair.first, pair.second, count, common});
+        }
+    }
+    return duplicates;
+}
 } // namespace plausibility
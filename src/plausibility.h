@@ -53,6 +53,15 @@ struct FailedCheck
     CheckStatus status = CheckStatus::New; //< all checks are new when created
 };
 
+/// two trajectories, which are close in most of their common frames, e.g. two IDs on one head
+struct Duplicate
+{
+    size_t pers1{};        ///< smaller index of the two persons
+    size_t pers2{};        ///< larger index of the two persons
+    int    closeFrames{};  ///< frames in which both are close
+    int    commonFrames{}; ///< frames in which both exist
+};
+
 inline bool operator==(const FailedCheck &first, const FailedCheck &second)
 {
     return (first.pers == second.pers && first.frame == second.frame && first.type == second.type);
@@ -66,6 +75,8 @@ inline bool operator<(const FailedCheck &first, const FailedCheck &second)
 
 std::vector<FailedCheck>
 checkLength(const PersonStorage &personStorage, QProgressDialog *progressDialog, int minLength);
+std::vector<FailedCheck>
+checkLength(const PersonStorage &personStorage, const std::vector<size_t> &persons, int minLength);
 
 std::vector<FailedCheck> checkInside(
     const PersonStorage &personStorage,
@@ -76,14 +87,36 @@ std::vector<FailedCheck> checkInside(
     int                  firstFrame,
     int                  lastFrame,
     int                  margin);
+std::vector<FailedCheck> checkInside(
+    const PersonStorage       &personStorage,
+    const std::vector<size_t> &persons,
+    const cv::Size            &sequenceSize,
+    int                        imageBorderSize,
+    QRectF                     rect,
+    int                        firstFrame,
+    int                        lastFrame,
+    int                        margin);
 
 std::vector<FailedCheck> checkVelocityVariation(const PersonStorage &personStorage, QProgressDialog *progressDialog);
+std::vector<FailedCheck> checkVelocityVariation(const PersonStorage &personStorage, const std::vector<size_t> &persons);
 
 std::vector<FailedCheck> checkEquality(
     const PersonStorage &personStorage,
     QProgressDialog     *progressDialog,
     Petrack             &petrack,
     double               headSizeFactor);
+std::vector<FailedCheck> checkEquality(
+    const PersonStorage       &personStorage,
+    const std::vector<size_t> &persons,
+    Petrack                   &petrack,
+    double                     headSizeFactor);
+
+std::vector<Duplicate> findDuplicates(
+    const PersonStorage &personStorage,
+    Petrack             &petrack,
+    double               headSizeFactor,
+    double               minShare,
+    int                  minFrames = 1);
 
 } // namespace plausibility
 
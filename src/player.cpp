@@ -23,6 +23,7 @@
 #include "logger.h"
 #include "pMessageBox.h"
 #include "petrack.h"
+#include "timelineStrip.h"
 
 #include <QApplication>
 #include <QIntValidator>
@@ -33,6 +34,7 @@
 #include <QStyle>
 #include <QToolButton>
 #include <QVBoxLayout>
+#include <algorithm>
 
 Player::Player(Animation *anim, QWidget *parent) : QWidget(parent)
 {
@@ -88,6 +90,11 @@ Player::Player(Animation *anim, QWidget *parent) : QWidget(parent)
     mSlider->setMinimumWidth(100);
     connect(mSlider, SIGNAL(valueChanged(int)), this, SLOT(skipToFrame(int)));
 
+    // timeline with thumbnails, shown once thumbnails of a video are available
+    mTimeline = new TimelineStrip;
+    mTimeline->hide();
+    connect(mTimeline, &TimelineStrip::frameSelected, mSlider, &QSlider::setValue);
+
     // frame number
     QFont f("Courier", 12, QFont::Bold); // Times Helvetica, Normal
     mFrameNumValidator    = new QIntValidator(0, 999999, this);
@@ -166,7 +173,19 @@ Player::Player(Animation *anim, QWidget *parent) : QWidget(parent)
 
     mMainWindow = (class Petrack *) parent;
 
-    setLayout(mPlayerLayout);
+    auto *layout = new QVBoxLayout();
+    layout->addWidget(mTimeline);
+    layout->addLayout(mPlayerLayout);
+    layout->setMargin(0);
+    layout->setSpacing(2);
+    setLayout(layout);
+
+    mPlayTimer.setSingleShot(true);
+    mPlayTimer.setTimerType(Qt::PreciseTimer);
+    connect(&mPlayTimer, &QTimer::timeout, this, &Player::playStep);
+
+    connect(&mTimelineTimer, &QTimer::timeout, this, &Player::updateTimeline);
+    mTimelineTimer.start(500);
 
     setAnim(anim);
 }
@@ -260,11 +279,14 @@ bool Player::updateImage()
 
     if(mRec)
     {
-        mAviFile.appendFrame((const unsigned char *) mImg.data, true);
+        // frames decoded with a virtual border are not continuous
+        const cv::Mat frame = mImg.isContinuous() ? mImg : mImg.clone();
+        mAviFile.appendFrame((const unsigned char *) frame.data, true);
     }
     mSlider->setValue(
         mAnimation->getCurrentFrameNum()); //(1000*mAnimation->getCurrentFrameNum())/mAnimation->getNumFrames());
     mFrameNum->setText(QString().number(mAnimation->getCurrentFrameNum()));
+    mTimeline->setCurrentFrame(mAnimation->getCurrentFrameNum());
 
     return true;
 }
@@ -299,6 +321,9 @@ bool Player::backward()
 /**
  * @brief Sets the state of the video player
  *
+ * Starting to play does not block; the frames are processed by playStep()
+ * driven by the event loop.
+ *
  * @see PlayerState
  * @param state
  */
@@ -316,107 +341,115 @@ void Player::play(PlayerState state)
 }
 
 /**
- * @brief Quasi MainLoop: Plays video in accordance to set frame rate
+ * @brief Starts the playback clock and schedules the first frame
+ */
+void Player::playVideo()
+{
+    mPlayFrame    = mAnimation->getCurrentFrameNum();
+    mNextFrameDue = 0.;
+    mPlayClock.start();
+    mPlayTimer.start(0);
+}
+
+/**
+ * @brief Plays one frame in accordance to set frame rate and schedules the next one
  *
  * This method is (indirectly) initiating calls to Player::updateImage
  * and thus controls processing and display of video frames. The user has
  * the option to limit playback speed, which is enforced here as well.
  *
- * The method is left, when the video is paused and reentered, when playing
- * gets started again.
+ * Between two frames the event loop runs idle until the next frame is due
+ * (precise single shot timer), so no CPU is spent on waiting. With fixed
+ * playback speed, frames are skipped if the playback is more than one frame
+ * period behind its clock (latency budget of one frame).
  */
-void Player::playVideo()
+void Player::playStep()
 {
-    static QElapsedTimer timer;
-    int                  currentFrame = mAnimation->getCurrentFrameNum();
-    long long int        overtime     = 0;
-
-    while(mState != PlayerState::PAUSE)
+    if(mState == PlayerState::PAUSE)
     {
-        // slow down the player speed for extrem fast video sequences (Jiayue China or 16fps cam99 basigo grid video)
-        if(mPlayerSpeedLimited || mPlayerSpeedFixed)
-        {
-            auto supposedDiff = static_cast<long long int>(1'000 / mAnimation->getPlaybackFPS());
-
-            if(timer.isValid())
-            {
-                if(mPlayerSpeedFixed && mState == PlayerState::FORWARD)
-                {
-                    overtime = std::max(0LL, overtime + (timer.elapsed() - supposedDiff));
-                    if(overtime >= supposedDiff)
-                    {
-                        mAnimation->skipFrame(static_cast<int>(overtime / supposedDiff));
-                        overtime = overtime % supposedDiff;
-                        currentFrame =
-                            std::min(mAnimation->getCurrentFrameNum() + 1, mAnimation->getSourceOutFrameNum());
-                    }
-                }
+        return;
+    }
 
-                while(!timer.hasExpired(supposedDiff))
-                {
-                    qApp->processEvents();
-                }
-            }
-            timer.start();
-        }
-        else
+    const bool   paced  = mPlayerSpeedLimited || mPlayerSpeedFixed;
+    const double period = 1'000. / mAnimation->getPlaybackFPS(); // in ms
+    if(paced && mPlayerSpeedFixed && mState == PlayerState::FORWARD)
+    {
+        const double lateness = mPlayClock.nsecsElapsed() / 1e6 - mNextFrameDue;
+        if(lateness >= period)
         {
-            timer.invalidate();
+            const int skip = static_cast<int>(lateness / period);
+            mAnimation->skipFrame(skip);
+            mNextFrameDue += skip * period;
+            mPlayFrame = std::min(mAnimation->getCurrentFrameNum() + 1, mAnimation->getSourceOutFrameNum());
         }
+    }
 
+    switch(mState)
+    {
+        case PlayerState::FORWARD:
+            mImg = mAnimation->getFrameAtIndex(mPlayFrame);
+            mPlayFrame++;
+            break;
+        case PlayerState::BACKWARD:
+            mImg = mAnimation->getFrameAtIndex(mPlayFrame);
+            mPlayFrame--;
+            break;
+        case PlayerState::PAUSE:
+            break;
+    }
 
-        switch(mState)
+    if(!updateImage())
+    {
+        mState = PlayerState::PAUSE;
+        if(mAnimation->getCurrentFrameNum() != 0 &&
+           mAnimation->getCurrentFrameNum() != mAnimation->getSourceOutFrameNum())
         {
-            case PlayerState::FORWARD:
-                mImg = mAnimation->getFrameAtIndex(currentFrame);
-                currentFrame++;
-                break;
-            case PlayerState::BACKWARD:
-                mImg = mAnimation->getFrameAtIndex(currentFrame);
-                currentFrame--;
-                break;
-            case PlayerState::PAUSE:
-                break;
+            SPDLOG_WARN("video unexpectedly finished.");
         }
-
-        if(!updateImage())
+    }
+    else
+    {
+        if(mLooping && mMainWindow->getControlWidget()->isOnlineTrackingChecked())
         {
+            PWarning(
+                this,
+                "Error: No tracking while looping",
+                "Looping and tracking are incompatible. Please disable one first.");
             mState = PlayerState::PAUSE;
-            if(mAnimation->getCurrentFrameNum() != 0 &&
-               mAnimation->getCurrentFrameNum() != mAnimation->getSourceOutFrameNum())
-            {
-                SPDLOG_WARN("video unexpectedly finished.");
-            }
         }
-        else
+        else if(mLooping)
         {
-            if(mLooping && mMainWindow->getControlWidget()->isOnlineTrackingChecked())
+            if(mState == PlayerState::FORWARD && mAnimation->getCurrentFrameNum() == mAnimation->getSourceOutFrameNum())
             {
-                PWarning(
-                    this,
-                    "Error: No tracking while looping",
-                    "Looping and tracking are incompatible. Please disable one first.");
-                mState = PlayerState::PAUSE;
-                break;
+                mPlayFrame = mAnimation->getSourceInFrameNum();
             }
-            else if(mLooping)
+            else if(
+                mState == PlayerState::BACKWARD &&
+                mAnimation->getCurrentFrameNum() == mAnimation->getSourceInFrameNum())
             {
-                if(mState == PlayerState::FORWARD &&
-                   mAnimation->getCurrentFrameNum() == mAnimation->getSourceOutFrameNum())
-                {
-                    currentFrame = mAnimation->getSourceInFrameNum();
-                }
-                else if(
-                    mState == PlayerState::BACKWARD &&
-                    mAnimation->getCurrentFrameNum() == mAnimation->getSourceInFrameNum())
-                {
-                    currentFrame = mAnimation->getSourceOutFrameNum();
-                }
+                mPlayFrame = mAnimation->getSourceOutFrameNum();
             }
         }
     }
 
-    timer.invalidate();
+    if(mState == PlayerState::PAUSE)
+    {
+        return;
+    }
+    if(!paced)
+    {
+        // as fast as possible, but let the event loop handle pending events first
+        mPlayTimer.start(0);
+        return;
+    }
+    mNextFrameDue += period;
+    const double now = mPlayClock.nsecsElapsed() / 1e6;
+    if(!mPlayerSpeedFixed && mNextFrameDue < now)
+    {
+        // only limited: a slow frame delays the following ones instead of being caught up
+        mNextFrameDue = now;
+    }
+    mPlayTimer.start(static_cast<int>(std::max(0., mNextFrameDue - now)));
 }
 
 bool Player::frameForward()
@@ -433,6 +466,7 @@ bool Player::frameBackward()
 void Player::pause()
 {
     mState = PlayerState::PAUSE;
+    mPlayTimer.stop();
     mMainWindow->setShowFPS(0.);
 }
 
@@ -476,6 +510,13 @@ void Player::recStream()
             mRecButton->setIcon(QPixmap(":/record"));
 
             mAviFile.close();
+#ifndef AVI
+            SPDLOG_INFO(
+                "Recording written with {:.1f} MB/s, at most {} frames were queued, {} frames were dropped.",
+                mAviFile.bytesPerSecond() / (1024. * 1024.),
+                mAviFile.maxQueueDepth(),
+                mAviFile.droppedFrames());
+#endif
 
             QString dest;
 
@@ -593,6 +634,7 @@ void Player::update()
         }
         mSlider->setMinimum(getFrameInNum());
         mSlider->setMaximum(getFrameOutNum());
+        mTimeline->setRange(getFrameInNum(), getFrameOutNum());
 
         mFrameInNumValidator->setTop(getFrameOutNum() - 1);
         mFrameNumValidator->setBottom(getFrameInNum());
@@ -654,4 +696,54 @@ int Player::getPos()
     return mAnimation->getCurrentFrameNum();
 }
 
+/**
+ * @brief Starts the thumbnails of a newly opened video and updates the timeline
+ *
+ * The thumbnails are decoded once the keyframe index of the video is available. The
+ * persons per frame are only counted while paused, so playing is not slowed down.
+ */
+void Player::updateTimeline()
+{
+    const QString videoFile = mAnimation->isVideo() ? mAnimation->getFileInfo().absoluteFilePath() : QString();
+    if(videoFile != mThumbnails.getVideoFile())
+    {
+        const auto keyFrames = mAnimation->getKeyFrames();
+        if(!videoFile.isEmpty() && !keyFrames)
+        {
+            return;
+        }
+        mThumbnails.stop();
+        mTimeline->setThumbnails({});
+        mTimelineComplete = false;
+        if(videoFile.isEmpty())
+        {
+            mTimeline->hide();
+            return;
+        }
+        mThumbnails.start(videoFile, mAnimation->getMaxFrames(), *keyFrames);
+        mTimeline->setRange(getFrameInNum(), getFrameOutNum());
+        mTimeline->show();
+    }
+
+    const bool running = mThumbnails.isRunning();
+    if(running || !mTimelineComplete)
+    {
+        mTimeline->setThumbnails(mThumbnails.getThumbnails());
+        mTimelineComplete = !running;
+    }
+
+    if(getPaused() && mTimeline->isVisible())
+    {
+        const auto      &personStorage = mMainWindow->getPersonStorage();
+        const auto       frames        = mTimeline->countFrames();
+        std::vector<int> counts(frames.size());
+        std::transform(
+            frames.begin(),
+            frames.end(),
+            counts.begin(),
+            [&personStorage](int frame) { return personStorage.visible(frame); });
+        mTimeline->setCounts(std::move(counts));
+    }
+}
+
 #include "moc_player.cpp"
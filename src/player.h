@@ -19,7 +19,11 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include "thumbnailStrip.h"
+
+#include <QElapsedTimer>
 #include <QTemporaryFile>
+#include <QTimer>
 #include <QWidget>
 
 #ifdef AVI
@@ -40,6 +44,7 @@ class QDoubleValidator;
 
 class Animation;
 class Petrack;
+class TimelineStrip;
 
 enum class PlayerState
 {
@@ -67,6 +72,8 @@ public:
     bool getPaused();
     void setSpeedRelativeToRealtime(double factor);
 
+    PlayerState getState() const { return mState; }
+
 public slots:
     bool frameForward();
     bool frameBackward();
@@ -90,6 +97,8 @@ public slots:
     int  getPos();
     void play(PlayerState state);
 
+private slots:
+    void updateTimeline();
 
 private:
     void setSliderMax(int max);
@@ -97,6 +106,7 @@ private:
     bool forward();
     bool backward();
     void playVideo();
+    void playStep();
 
     Animation     *mAnimation;
     QTemporaryFile mTmpFile;
@@ -106,6 +116,17 @@ private:
     bool           mLooping          = false;
     bool           mRec;
 
+    // playback scheduling
+    QTimer        mPlayTimer;         ///< fires when the next frame is due
+    QElapsedTimer mPlayClock;         ///< time since playback started
+    double        mNextFrameDue = 0.; ///< time (ms on mPlayClock) the next frame should be shown
+    int           mPlayFrame    = -1; ///< frame played next
+
+    // timeline with thumbnails, decoded in the background
+    ThumbnailStrip mThumbnails;
+    QTimer         mTimelineTimer;
+    bool           mTimelineComplete = false; ///< all thumbnails were handed to mTimeline
+
 
 #ifdef AVI
     AviFile mAviFile;
@@ -120,6 +141,7 @@ private:
     QHBoxLayout   *mPlayerLayout;
     Petrack       *mMainWindow;
     QSlider       *mSlider;
+    TimelineStrip *mTimeline;
     QLineEdit     *mFrameNum;
     QLineEdit     *mFrameInNum;
     QLineEdit     *mFrameOutNum;
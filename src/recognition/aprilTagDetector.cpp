@@ -0,0 +1,168 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "aprilTagDetector.h"
+
+#include "concurrency.h"
+#include "logger.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <apriltag.h>
+#include <cmath>
+#include <limits>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+namespace reco
+{
+/**
+ * @brief Builds the AprilTag family of the dictionary and the detector
+ *
+ * ArucoCodeParams::getQuadDecimate() is used as decimation of AprilTag. The number of
+ * corrected bits follows ArucoCodeParams::getErrorCorrectionRate() like with ArUco,
+ * but at most 2 bits are corrected, as the table of AprilTag grows with every bit.
+ *
+ * @param params parameters of the CodeMarkerWidget
+ * @param indexOfMarkerDict index of the dictionary, has to be supported (see supports())
+ */
+AprilTagDetector::AprilTagDetector(const ArucoCodeParams &params, int indexOfMarkerDict)
+{
+    const cv::aruco::Dictionary dictionary =
+        (indexOfMarkerDict != 17) ?
+            cv::aruco::getPredefinedDictionary(cv::aruco::PredefinedDictionaryType(indexOfMarkerDict)) :
+            detail::getDictMip36h12();
+    const int markerSize = dictionary.markerSize;
+
+    for(int row = 0; row < markerSize; ++row)
+    {
+        for(int col = 0; col < markerSize; ++col)
+        {
+            mBitX.push_back(static_cast<uint32_t>(col + 1));
+            mBitY.push_back(static_cast<uint32_t>(row + 1));
+        }
+    }
+    for(int i = 0; i < dictionary.bytesList.rows; ++i)
+    {
+        const cv::Mat bits = cv::aruco::Dictionary::getBitsFromByteList(dictionary.bytesList.row(i), markerSize);
+        uint64_t      code = 0;
+        for(int cell = 0; cell < markerSize * markerSize; ++cell)
+        {
+            code = (code << 1) | (bits.at<uchar>(cell / markerSize, cell % markerSize) ? 1 : 0);
+        }
+        mCodes.push_back(code);
+    }
+    mName = "petrack" + std::to_string(indexOfMarkerDict);
+
+    mFamily                  = new apriltag_family_t{};
+    mFamily->ncodes          = static_cast<uint32_t>(mCodes.size());
+    mFamily->codes           = mCodes.data();
+    mFamily->width_at_border = markerSize + 2;
+    mFamily->total_width     = markerSize + 4;
+    mFamily->reversed_border = false;
+    mFamily->nbits           = static_cast<uint32_t>(mBitX.size());
+    mFamily->bit_x           = mBitX.data();
+    mFamily->bit_y           = mBitY.data();
+    mFamily->h               = static_cast<uint32_t>(2 * dictionary.maxCorrectionBits + 1);
+    mFamily->name            = mName.data();
+
+    const int correctedBits =
+        std::clamp(static_cast<int>(params.getErrorCorrectionRate() * dictionary.maxCorrectionBits), 0, 2);
+    mDetector                = apriltag_detector_create();
+    mDetector->quad_decimate = static_cast<float>(params.getQuadDecimate());
+    mDetector->quad_sigma    = 0;
+    mDetector->refine_edges  = true;
+    apriltag_detector_add_family_bits(mDetector, mFamily, correctedBits);
+}
+
+AprilTagDetector::~AprilTagDetector()
+{
+    apriltag_detector_destroy(mDetector);
+    delete mFamily;
+}
+
+/// Returns, if AprilTag is used for the dictionary with indexOfMarkerDict (see CodeMarkerWidget)
+bool AprilTagDetector::supports(int indexOfMarkerDict)
+{
+    return indexOfMarkerDict == 17 || indexOfMarkerDict == cv::aruco::DICT_APRILTAG_25h9 ||
+           indexOfMarkerDict == cv::aruco::DICT_APRILTAG_36h11;
+}
+
+/**
+ * @brief Detects the markers in img
+ *
+ * Markers with a perimeter outside of the rates (relative to the longer side of img) are
+ * dropped like by ArUco. AprilTag does not report rejected candidates.
+ *
+ * @param img 8 bit gray or BGR image
+ * @param corners corners of the detected markers in the order of ArUco (top left, top right, bottom right, bottom left)
+ * @param ids ids of the detected markers
+ */
+void AprilTagDetector::detect(
+    const cv::Mat                         &img,
+    double                                 minMarkerPerimeterRate,
+    double                                 maxMarkerPerimeterRate,
+    std::vector<std::vector<cv::Point2f>> &corners,
+    std::vector<int>                      &ids) const
+{
+    TRACE_ZONE("reco::AprilTagDetector::detect");
+    cv::Mat gray;
+    if(img.channels() == 3)
+    {
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    }
+    else
+    {
+        gray = img;
+    }
+    image_u8_t image{gray.cols, gray.rows, static_cast<int32_t>(gray.step), gray.data};
+
+    const int    imgLength    = std::max(img.cols, img.rows);
+    const double minPerimeter = std::isnan(minMarkerPerimeterRate) ? 0. : minMarkerPerimeterRate * imgLength;
+    const double maxPerimeter =
+        std::isnan(maxMarkerPerimeterRate) ? std::numeric_limits<double>::max() : maxMarkerPerimeterRate * imgLength;
+
+    corners.clear();
+    ids.clear();
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDetector->nthreads  = concurrency::threadCount();
+    zarray_t *detections = apriltag_detector_detect(mDetector, &image);
+    for(int i = 0; i < zarray_size(detections); ++i)
+    {
+        apriltag_detection_t *detection = nullptr;
+        zarray_get(detections, i, &detection);
+
+        // AprilTag starts at the bottom left corner and goes counter-clockwise
+        std::vector<cv::Point2f> marker;
+        for(int corner = 3; corner >= 0; --corner)
+        {
+            marker.emplace_back(
+                static_cast<float>(detection->p[corner][0]), static_cast<float>(detection->p[corner][1]));
+        }
+        const double perimeter = cv::arcLength(marker, true);
+        if(perimeter < minPerimeter || perimeter > maxPerimeter)
+        {
+            continue;
+        }
+        corners.push_back(std::move(marker));
+        ids.push_back(detection->id);
+    }
+    apriltag_detections_destroy(detections);
+}
+} // namespace reco
@@ -0,0 +1,78 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef APRILTAGDETECTOR_H
+#define APRILTAGDETECTOR_H
+
+#include "recognition.h"
+
+#include <cstdint>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <string>
+#include <vector>
+
+struct apriltag_detector;
+struct apriltag_family;
+
+namespace reco
+{
+/**
+ * @brief Detects code markers with the AprilTag 3 library instead of OpenCV's ArUco module
+ *
+ * AprilTag searches the quads multithreaded in a decimated image with a fast quad
+ * fitter and is much faster than ArUco for its tag families. It is available for
+ * DICT_APRILTAG_25h9, DICT_APRILTAG_36h11 and DICT_mip_36h12. The codes are taken
+ * from the dictionary of OpenCV and given to AprilTag as custom family, so the ids
+ * are the same as with ArUco. The corners are returned in the order of ArUco, so the
+ * results can be used like those of cv::aruco::ArucoDetector.
+ *
+ * Only built with -DAPRILTAG=ON. Can be used from several threads, but detects one
+ * image at a time, as the detector of AprilTag is not reentrant.
+ */
+class AprilTagDetector
+{
+public:
+    AprilTagDetector(const ArucoCodeParams &params, int indexOfMarkerDict);
+    AprilTagDetector(const AprilTagDetector &)            = delete;
+    AprilTagDetector &operator=(const AprilTagDetector &) = delete;
+    ~AprilTagDetector();
+
+    static bool supports(int indexOfMarkerDict);
+
+    void detect(
+        const cv::Mat                         &img,
+        double                                 minMarkerPerimeterRate,
+        double                                 maxMarkerPerimeterRate,
+        std::vector<std::vector<cv::Point2f>> &corners,
+        std::vector<int>                      &ids) const;
+
+private:
+    std::vector<uint64_t> mCodes; ///< codes of the dictionary, first bit in the top left cell
+    std::vector<uint32_t> mBitX;  ///< column of each bit, starting with 1 inside the black border
+    std::vector<uint32_t> mBitY;  ///< row of each bit
+    std::string           mName;
+
+    apriltag_family   *mFamily   = nullptr; ///< refers to the vectors above
+    apriltag_detector *mDetector = nullptr;
+
+    mutable std::mutex mMutex;
+};
+} // namespace reco
+
+#endif // APRILTAGDETECTOR_H
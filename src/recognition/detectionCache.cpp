@@ -0,0 +1,225 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "detectionCache.h"
+
+#include "logger.h"
+#include "tracker.h"
+
+#include <QDataStream>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr char   CACHE_MAGIC[8] = {'P', 'E', 'T', 'D', 'E', 'T', 'E', 'C'};
+constexpr qint32 CACHE_VERSION  = 1;
+
+void prepare(QDataStream &stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+void writePoint(QDataStream &stream, const TrackPoint &point)
+{
+    const QColor &color = point.color();
+    stream << point.x() << point.y() << static_cast<qint16>(std::clamp(point.qual(), -32768, 32767))
+           << static_cast<qint32>(point.getMarkerID()) << point.colPoint().x() << point.colPoint().y()
+           << static_cast<quint32>(color.isValid() ? color.rgba() : 0) << point.sp().x() << point.sp().y()
+           << point.sp().z() << point.getOrientation()[0] << point.getOrientation()[1] << point.getOrientation()[2];
+}
+
+TrackPoint readPoint(QDataStream &stream)
+{
+    double  x, y, colX, colY, spX, spY, spZ, orientationX, orientationY, orientationZ;
+    qint16  qual;
+    qint32  markerID;
+    quint32 rgba;
+    stream >> x >> y >> qual >> markerID >> colX >> colY >> rgba >> spX >> spY >> spZ >> orientationX >>
+        orientationY >> orientationZ;
+
+    TrackPoint point(Vec2F(x, y), qual, markerID);
+    point.setColPoint(Vec2F(colX, colY));
+    if(rgba != 0)
+    {
+        point.setCol(QColor::fromRgba(rgba));
+    }
+    point.setSp(Vec3F(spX, spY, spZ));
+    point.setOrientation({orientationX, orientationY, orientationZ});
+    return point;
+}
+} // namespace
+
+DetectionCache::~DetectionCache()
+{
+    close();
+}
+
+/**
+ * @brief Opens (or creates) the cache file and reads all detections stored in it
+ *
+ * A file with another format is emptied, unless the cache is opened read-only.
+ *
+ * @param fileName name of the cache file
+ * @param readOnly never write to the file
+ * @return true, if the cache could be opened
+ */
+bool DetectionCache::open(const QString &fileName, bool readOnly)
+{
+    close();
+
+    auto file = std::make_unique<QFile>(fileName);
+    if(!file->open(readOnly ? QIODevice::ReadOnly : QIODevice::ReadWrite))
+    {
+        SPDLOG_WARN("Could not open detection cache {}: {}", fileName, file->errorString());
+        return false;
+    }
+
+    QDataStream stream(file.get());
+    prepare(stream);
+    char   magic[sizeof(CACHE_MAGIC)] = {};
+    qint32 version                    = 0;
+    qint64 validSize                  = 0;
+    if(stream.readRawData(magic, sizeof(magic)) == sizeof(magic) &&
+       std::memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0)
+    {
+        stream >> version;
+    }
+
+    if(stream.status() == QDataStream::Ok && version == CACHE_VERSION)
+    {
+        validSize = file->pos();
+        while(!stream.atEnd())
+        {
+            qint32            frame, count;
+            QList<TrackPoint> points;
+            stream >> frame >> count;
+            for(qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+            {
+                points.append(readPoint(stream));
+            }
+            if(stream.status() != QDataStream::Ok || count < 0)
+            {
+                SPDLOG_WARN("Discarding incomplete record at the end of detection cache {}", fileName);
+                break;
+            }
+            mDetections[frame] = std::move(points);
+            validSize          = file->pos();
+        }
+    }
+    else if(readOnly)
+    {
+        SPDLOG_WARN("Could not read detection cache {}", fileName);
+        return false;
+    }
+    else
+    {
+        // new file or other format
+        file->resize(0);
+        file->seek(0);
+        stream.resetStatus();
+        stream.writeRawData(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        stream << CACHE_VERSION;
+        validSize = file->pos();
+    }
+
+    if(!readOnly)
+    {
+        file->resize(validSize);
+        file->seek(validSize);
+    }
+    mFile     = std::move(file);
+    mFileName = fileName;
+    mReadOnly = readOnly;
+    SPDLOG_INFO("Opened detection cache {} with {} frame(s)", fileName, mDetections.size());
+    return true;
+}
+
+void DetectionCache::close()
+{
+    if(mFile)
+    {
+        mFile->close();
+        mFile.reset();
+    }
+    mFileName.clear();
+    mDetections.clear();
+    mReadOnly = false;
+}
+
+/**
+ * @brief Returns the cached detections of frame
+ *
+ * @param frame frame number
+ * @param points detections of the frame, only written on success
+ * @return true, if frame was detected with the parameters of this cache
+ */
+bool DetectionCache::get(int frame, QList<TrackPoint> &points) const
+{
+    const auto it = mDetections.find(frame);
+    if(it == mDetections.end())
+    {
+        return false;
+    }
+    points = it->second;
+    return true;
+}
+
+/// Returns the memory used by the detections kept in memory in bytes (approximately)
+std::size_t DetectionCache::memoryUsage() const
+{
+    std::size_t bytes = mDetections.bucket_count() * sizeof(void *);
+    for(const auto &[frame, points] : mDetections)
+    {
+        bytes += sizeof(frame) + sizeof(points) + points.size() * (sizeof(TrackPoint) + sizeof(void *));
+    }
+    return bytes;
+}
+
+/**
+ * @brief Stores the detections of frame and appends them to the file, if it is not read-only
+ */
+void DetectionCache::put(int frame, const QList<TrackPoint> &points)
+{
+    if(!mFile)
+    {
+        return;
+    }
+    if(mReadOnly)
+    {
+        mDetections[frame] = points;
+        return;
+    }
+
+    // one write per record, so an interruption leaves at most one incomplete record
+    QByteArray  record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    prepare(stream);
+    stream << static_cast<qint32>(frame) << static_cast<qint32>(points.size());
+    for(const auto &point : points)
+    {
+        writePoint(stream, point);
+    }
+    if(mFile->write(record) != record.size() || !mFile->flush())
+    {
+        SPDLOG_WARN("Could not write to detection cache {}: {}", mFileName, mFile->errorString());
+        return;
+    }
+    mDetections[frame] = points;
+}
@@ -0,0 +1,75 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DETECTIONCACHE_H
+#define DETECTIONCACHE_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <memory>
+#include <unordered_map>
+
+class TrackPoint;
+
+/**
+ * @brief Sidecar file with the results of the recognition per frame
+ *
+ * Tracking parameters can be changed and the tracking re-run without detecting
+ * the markers again: the detections of a frame are replayed from the cache
+ * instead of calling Recognizer::getMarkerPos. Like the FilteredFrameStore, the
+ * name of the file contains a hash of all parameters the recognition depends on,
+ * so a cache is only reused with the settings it was written with.
+ *
+ * The file is a header followed by records (frame, number of points, points)
+ * in a compact binary form, which are appended whenever a frame was detected.
+ * A later record of a frame replaces an earlier one; an incomplete record at the
+ * end (e.g. after a crash) is discarded on opening.
+ *
+ * A cache opened read-only (e.g. shared by several processes) is never written;
+ * new detections are only kept in memory.
+ */
+class DetectionCache
+{
+public:
+    DetectionCache() = default;
+    ~DetectionCache();
+
+    DetectionCache(const DetectionCache &)            = delete;
+    DetectionCache &operator=(const DetectionCache &) = delete;
+
+    bool open(const QString &fileName, bool readOnly = false);
+    void close();
+
+    bool           isOpen() const { return mFile != nullptr; }
+    const QString &getFileName() const { return mFileName; }
+    std::size_t    size() const { return mDetections.size(); }
+    std::size_t    memoryUsage() const;
+
+    bool contains(int frame) const { return mDetections.find(frame) != mDetections.end(); }
+    bool get(int frame, QList<TrackPoint> &points) const;
+    void put(int frame, const QList<TrackPoint> &points);
+
+private:
+    QString                                    mFileName;
+    std::unique_ptr<QFile>                     mFile;
+    std::unordered_map<int, QList<TrackPoint>> mDetections;
+    bool                                       mReadOnly = false;
+};
+
+#endif // DETECTIONCACHE_H
@@ -0,0 +1,206 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "headDetector.h"
+
+#include "logger.h"
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+namespace reco
+{
+/**
+ * @brief Reads the network and selects the fastest available backend
+ *
+ * @param modelPath ONNX file of the network
+ * @param inputSize side length of the (square) input of the network
+ * @throws cv::Exception if the model cannot be read
+ */
+HeadDetector::HeadDetector(const std::string &modelPath, int inputSize) : mInputSize(inputSize)
+{
+    mNet = cv::dnn::readNetFromONNX(modelPath);
+
+    const auto backends = cv::dnn::getAvailableBackends();
+    const auto has      = [&backends](cv::dnn::Backend backend, cv::dnn::Target target)
+    { return std::find(backends.begin(), backends.end(), std::make_pair(backend, target)) != backends.end(); };
+    if(has(cv::dnn::DNN_BACKEND_CUDA, cv::dnn::DNN_TARGET_CUDA))
+    {
+        mNet.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
+        mNet.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
+        mBackendName = "CUDA";
+    }
+    else if(has(cv::dnn::DNN_BACKEND_INFERENCE_ENGINE, cv::dnn::DNN_TARGET_CPU))
+    {
+        mNet.setPreferableBackend(cv::dnn::DNN_BACKEND_INFERENCE_ENGINE);
+        mNet.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        mBackendName = "OpenVINO";
+    }
+    else
+    {
+        mNet.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        mNet.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        mBackendName = "OpenCV";
+    }
+    SPDLOG_INFO("Head detector {} runs on {}.", modelPath, mBackendName);
+}
+
+/**
+ * @brief Detects heads in img
+ *
+ * @param img BGR or gray image
+ * @param minScore detections with a lower score are dropped
+ * @param nmsThreshold overlapping detections with a higher intersection over union are merged
+ * @return detected heads in coordinates of img
+ */
+std::vector<HeadDetection> HeadDetector::detect(const cv::Mat &img, float minScore, float nmsThreshold) const
+{
+    cv::Mat bgr = img;
+    if(img.channels() == 1)
+    {
+        cv::cvtColor(img, bgr, cv::COLOR_GRAY2BGR);
+    }
+
+    // heads on the seam of two tiles are completely inside of at least one of them
+    const auto tiles = detail::headDetectionTiles(bgr.size(), mInputSize, mInputSize / 8);
+
+    std::vector<HeadDetection> detections;
+    for(std::size_t first = 0; first < tiles.size(); first += maxBatchSize)
+    {
+        const std::size_t    last = std::min(tiles.size(), first + maxBatchSize);
+        std::vector<cv::Mat> batch;
+        for(std::size_t i = first; i < last; ++i)
+        {
+            // tiles at the border are padded instead of scaled
+            cv::Mat tile;
+            cv::copyMakeBorder(
+                bgr(tiles[i]),
+                tile,
+                0,
+                mInputSize - tiles[i].height,
+                0,
+                mInputSize - tiles[i].width,
+                cv::BORDER_CONSTANT,
+                cv::Scalar::all(114));
+            batch.push_back(std::move(tile));
+        }
+        const cv::Mat blob = cv::dnn::blobFromImages(
+            batch, 1. / 255., cv::Size(mInputSize, mInputSize), cv::Scalar(), true, false, CV_32F);
+
+        cv::Mat output;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mNet.setInput(blob);
+            output = mNet.forward().clone();
+        }
+        if(output.dims != 3)
+        {
+            SPDLOG_ERROR("Output of the head detector has {} instead of 3 dimensions.", output.dims);
+            return {};
+        }
+
+        for(std::size_t i = first; i < last; ++i)
+        {
+            // output of one image of the batch
+            const int imgIdx = static_cast<int>(i - first);
+            cv::Mat   rows(output.size[1], output.size[2], CV_32F, output.ptr<float>(imgIdx));
+            detail::decodeHeadDetections(rows, cv::Point2f(tiles[i].tl()), minScore, detections);
+        }
+    }
+
+    std::vector<cv::Rect2d> boxes;
+    std::vector<float>      scores;
+    for(const auto &detection : detections)
+    {
+        boxes.emplace_back(detection.box);
+        scores.push_back(detection.score);
+    }
+    std::vector<int> kept;
+    cv::dnn::NMSBoxes(boxes, scores, minScore, nmsThreshold, kept);
+
+    std::vector<HeadDetection> heads;
+    heads.reserve(kept.size());
+    for(int idx : kept)
+    {
+        heads.push_back(detections[idx]);
+    }
+    return heads;
+}
+
+/**
+ * @brief Splits an image into tiles of at most tileSize pixels
+ *
+ * Neighbouring tiles overlap by overlap pixels; the last tile of a row or column
+ * ends at the border of the image.
+ */
+std::vector<cv::Rect> detail::headDetectionTiles(const cv::Size &imgSize, int tileSize, int overlap)
+{
+    const int             step = std::max(1, tileSize - overlap);
+    std::vector<cv::Rect> tiles;
+    for(int y = 0;; y += step)
+    {
+        for(int x = 0;; x += step)
+        {
+            tiles.emplace_back(x, y, std::min(tileSize, imgSize.width - x), std::min(tileSize, imgSize.height - y));
+            if(x + tileSize >= imgSize.width)
+            {
+                break;
+            }
+        }
+        if(y + tileSize >= imgSize.height)
+        {
+            break;
+        }
+    }
+    return tiles;
+}
+
+/**
+ * @brief Appends the detections of one image of the output of the network
+ *
+ * @param output 5 x anchors or anchors x 5 matrix with (center x, center y, width, height, score)
+ * @param offset position of the tile in the image
+ * @param minScore detections with a lower score are dropped
+ * @param detections the decoded detections are appended
+ */
+void detail::decodeHeadDetections(
+    const cv::Mat              &output,
+    const cv::Point2f          &offset,
+    float                       minScore,
+    std::vector<HeadDetection> &detections)
+{
+    // YOLOv8 returns the values of each anchor in a column
+    const cv::Mat rows = (output.rows == 5 && output.cols != 5) ? cv::Mat(output.t()) : output;
+    if(rows.cols < 5)
+    {
+        SPDLOG_ERROR("Output of the head detector has {} instead of 5 values per detection.", rows.cols);
+        return;
+    }
+    for(int i = 0; i < rows.rows; ++i)
+    {
+        const float *row   = rows.ptr<float>(i);
+        const float  score = row[4];
+        if(score < minScore)
+        {
+            continue;
+        }
+        const cv::Rect2f box(row[0] - row[2] / 2.f + offset.x, row[1] - row[3] / 2.f + offset.y, row[2], row[3]);
+        detections.push_back({box, score});
+    }
+}
+} // namespace reco
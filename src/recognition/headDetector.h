@@ -0,0 +1,84 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADDETECTOR_H
+#define HEADDETECTOR_H
+
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+#include <string>
+#include <vector>
+
+namespace reco
+{
+/// Head found by the HeadDetector
+struct HeadDetection
+{
+    cv::Rect2f box;   ///< bounding box in pixel of the searched image
+    float      score; ///< confidence of the network in 0..1
+};
+
+/**
+ * @brief Markerless detection of heads with a neural network loaded via OpenCV DNN
+ *
+ * The network is read from an ONNX file. It has to take a batch of square RGB
+ * images of inputSize pixels scaled to 0..1 and return, for every image, one row
+ * per anchor with (center x, center y, width, height, score) in pixels of the
+ * input, as single class YOLO models (e.g. YOLOv8) do. The rows may also be the
+ * columns of the output, as in the default export of YOLOv8.
+ *
+ * Images larger than inputSize are split into overlapping tiles; all tiles of an
+ * image are passed through the network in batches. The tiles are not scaled, so
+ * the heads keep their size in pixel.
+ *
+ * CUDA is used if OpenCV was built with it, OpenVINO otherwise, if available.
+ * The network can only run once at a time; detect() can be called from several
+ * threads, but calls are serialized.
+ */
+class HeadDetector
+{
+public:
+    explicit HeadDetector(const std::string &modelPath, int inputSize = 640);
+
+    std::vector<HeadDetection> detect(const cv::Mat &img, float minScore, float nmsThreshold = 0.45f) const;
+
+    int                getInputSize() const { return mInputSize; }
+    const std::string &getBackendName() const { return mBackendName; }
+
+private:
+    static constexpr int maxBatchSize = 8;
+
+    int                  mInputSize;
+    std::string          mBackendName;
+    mutable std::mutex   mMutex;
+    mutable cv::dnn::Net mNet;
+};
+
+namespace detail
+{
+    std::vector<cv::Rect> headDetectionTiles(const cv::Size &imgSize, int tileSize, int overlap);
+    void                  decodeHeadDetections(
+                         const cv::Mat              &output,
+                         const cv::Point2f          &offset,
+                         float                       minScore,
+                         std::vector<HeadDetection> &detections);
+} // namespace detail
+} // namespace reco
+
+#endif // HEADDETECTOR_H
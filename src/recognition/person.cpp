@@ -22,6 +22,8 @@
 #include "helper.h"
 #include "logger.h"
 
+#include <algorithm>
+
 //#define SHOWELLIPSES // gibt die einzelnen schritte der personen detektion pyramide graphisch aus
 //#define SAVEELLIPSES // ob alle ellips in datei geschrieben werden sollen
 //#define PRINT_ERASE_REASON // zeigt an, ob ausgegeben werden soll, aus welchem Grund eine ellipse geloescht wurde
@@ -30,6 +32,72 @@
 
 using namespace ::cv;
 
+namespace
+{
+/**
+ * @brief Fits ellipses to the contours of one height level of the height field
+ *
+ * @param gray height field scaled to [0, 254], 255 for invalid values
+ * @param threshold gray value of the level
+ * @param offset position of gray in the image
+ * @param minArea contours have to be larger (in pixels)
+ * @param maxArea contours have to be smaller (in pixels)
+ * @param roi contours crossing the border of roi are skipped
+ * @return ellipses of the contours of the level
+ */
+QList<MyEllipse> searchLevelEllipses(
+    const cv::Mat &gray,
+    float          threshold,
+    cv::Point      offset,
+    double         minArea,
+    double         maxArea,
+    const QRect   &roi)
+{
+    QList<MyEllipse>                    el;
+    cv::Mat                             binImg;
+    std::vector<std::vector<cv::Point>> contours;
+
+    cv::threshold(gray, binImg, threshold, 255, cv::THRESH_BINARY);
+    // find contours and store them all as a list; offset, so they are in coordinates of the whole image like roi
+    cv::findContours(binImg, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE, offset);
+
+    for(const auto &contour : contours)
+    {
+        if(contour.size() <= 5) // fuer ellips fit mind 6 pkte benoetigt
+        {
+            continue;
+        }
+        // with sign, so only one direction of the contours is used
+        // war: (contourArea>50 && contourArea<8000) // sollte abhaengig von untersuchten groessen gemacht werden
+        //      entspricht:
+        //  < 4.2cm x 4.2cm=18cm^2  = 50 Pixel in maximaler personengroesse
+        // in maximaler Entfernung zur Kamera
+        //(in ebenen Versuchen entspricht dies 40cm über Bodenhöhe)
+        // größer als 4500cm^2 = 8000 Pixel
+        const double contourArea = cv::contourArea(contour, true);
+        if(contourArea <= minArea || contourArea >= maxArea)
+        {
+            continue;
+        }
+        // contour geht ueber den rand der bounding box roi hinweg
+        const auto inRoi = [&roi](const cv::Point &point) { return roi.contains(point.x, point.y); };
+        if(!std::all_of(contour.begin(), contour.end(), inRoi))
+        {
+            continue;
+        }
+
+        const cv::RotatedRect box   = cv::fitEllipse(contour);
+        double                angle = (box.angle) / 180. * PI;
+        if(box.size.width < box.size.height) // da bei meiner ellipse r1 immer der groesste radius
+        {
+            angle -= PI / 2;
+        }
+        el.append(MyEllipse(box.center.x, box.center.y, box.size.width * 0.5, box.size.height * 0.5, angle));
+    }
+    return el;
+}
+} // namespace
+
 PersonList::PersonList()
 {
     mSc = nullptr;
@@ -40,18 +108,28 @@ void PersonList::searchEllipses(pet::StereoContext *sc, QRect &roi, BackgroundFi
 {
     mSc = sc;
 
-    cv::Mat  pointCloud = mSc->getPointCloud().clone();
-    cv::Mat  disp       = mSc->getDisparity();
-    cv::Size imgSize;
-    imgSize.width  = disp.cols;
-    imgSize.height = disp.rows;
+    const cv::Mat disp = mSc->getDisparity();
+    // only the region around roi is searched; the margin keeps contours crossing the border of roi recognizable
+    // as such and gaps near the border are filled as in the whole image
+    const int      margin = DISP_GAP_SIZE_TO_FILL + 1;
+    const cv::Rect region =
+        cv::Rect(roi.x() - margin, roi.y() - margin, roi.width() + 2 * margin, roi.height() + 2 * margin) &
+        cv::Rect(0, 0, disp.cols, disp.rows);
+    if(region.empty())
+    {
+        return;
+    }
+
+    // only the region is converted and copied
+    cv::Mat  pointCloud = mSc->getPointCloud(region).clone();
+    cv::Size imgSize    = region.size();
 
 
     int    x, y;
     float *pcData, *yPcData;
 
     // nicht Fordergrund auf ungueltig -1 setzen
-    bgFilter->maskBg(pointCloud, -1.);
+    bgFilter->maskBg(pointCloud, -1., region.tl());
 
     // Bestimmung von Minimum und Maximum von z in Meter
     float min = FLT_MAX;
@@ -138,28 +216,24 @@ void PersonList::searchEllipses(pet::StereoContext *sc, QRect &roi, BackgroundFi
     }
 
     // grauwertbild erstellen zwischen min und max - ungueltige werte auf 255 setzen
-    cv::Mat        gray{imgSize, CV_8UC1}; //     = cvCreateImage(imgSize, IPL_DEPTH_8U, 1);
-    unsigned char *grayData  = gray.data;
-    unsigned char *yGrayData = grayData;
-
-    pcData      = (float *) pointCloud.data;
-    yPcData     = pcData;
-    float scale = 254. / (max - min);
-
-    for(y = 0; y < pointCloud.rows; ++y)
-    {
-        for(x = 0; x < pointCloud.cols; ++x)
+    cv::Mat     gray{imgSize, CV_8UC1}; //     = cvCreateImage(imgSize, IPL_DEPTH_8U, 1);
+    const float scale = 254. / (max - min);
+    // rows are independent; the inner loop has no branches, so it can be vectorized
+    cv::parallel_for_(
+        cv::Range(0, pointCloud.rows),
+        [&](const cv::Range &range)
         {
-            if(pcData[2] == -1)
-                *grayData = 255;
-            else
-                *grayData = scale * (pcData[2] - min);
-            pcData += 3;
-            ++grayData;
-        }
-        pcData   = (yPcData += pointCloud.step1());
-        grayData = (yGrayData += gray.step1());
-    }
+            for(int row = range.start; row < range.end; ++row)
+            {
+                const auto *point    = pointCloud.ptr<cv::Vec3f>(row);
+                uchar      *grayData = gray.ptr<uchar>(row);
+                for(int col = 0; col < pointCloud.cols; ++col)
+                {
+                    const float z = point[col][2];
+                    grayData[col] = z == -1 ? 255 : static_cast<uchar>(scale * (z - min));
+                }
+            }
+        });
 
     //    // umkopieren der pointcloud auf matrix mit nur z-werten
     //    IplImage *zPointCloud = cvCreateImage(cvGetSize(pointCloud),32,1);
@@ -167,20 +241,6 @@ void PersonList::searchEllipses(pet::StereoContext *sc, QRect &roi, BackgroundFi
     //    // nun muesste noch -1 auf max gesetzt werden, damit isolinen richtig herum
     //    verlaufen!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 
-    int i, count;
-    // int threshold;
-    float                               threshold;
-    double                              angle;
-    std::vector<std::vector<cv::Point>> contours;
-    cv::Mat                             binImg{imgSize, CV_8UC1}; //= cvCreateImage(imgSize, IPL_DEPTH_8U, 1);
-
-    // CvPoint center;
-    // cv::Size sizeTmp;
-    // int expansion;
-    double contourArea;
-    // double contourLength;
-    float dist;
-    bool  contourInside; // gigt an, ob die contour ueber den rand der bounding box roi hinweggeht
 
 #ifdef SHOWELLIPSES
     IplImage *tmpAusgabe  = cvCreateImage(imgSize, IPL_DEPTH_8U, 3); // cvCloneImage(gray); // make a copy
@@ -200,159 +260,29 @@ void PersonList::searchEllipses(pet::StereoContext *sc, QRect &roi, BackgroundFi
 
 
     step = 2.55 / ((max - min) / STEP_SIZE); // STEP_SIZE cm Schritte, daher 2.55, da min und max in meter
-    for(threshold = step; threshold < 255 - step; threshold += step) // von kopf zum fuss = von klein nach gross
-    // for (threshold = 10; threshold < 250 ; threshold += 10) // von kopf zum fuss = von klein nach gross
-    // for (threshold = min+step; threshold < max-step ; threshold += step) // von kopf zum fuss = von klein nach gross
+    std::vector<float> thresholds;
+    for(float threshold = step; threshold < 255 - step; threshold += step) // von kopf zum fuss = von klein nach gross
     {
-        dist = min * 100 + STEP_SIZE * threshold / step;
-        QList<MyEllipse> el; // jeder level neu anlegen
-        cv::threshold(gray, binImg, threshold, 255, cv::THRESH_BINARY);
-        // cvThreshold(zPointCloud, binImg, threshold, 255, CV_THRESH_BINARY);
-
-        // find contours and store them all as a list
-        cv::findContours(binImg, contours, cv::RETR_LIST,
-                         cv::CHAIN_APPROX_SIMPLE); // binImg wird auch veraendert!!!
+        thresholds.push_back(threshold);
+    }
 
-        // test each contour
-        for(const auto &contour : contours)
+    // the levels are independent, their ellipses are inserted in the order of the levels afterwards
+    std::vector<QList<MyEllipse>> levelEllipses(thresholds.size());
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(thresholds.size())),
+        [&](const cv::Range &range)
         {
-            count = static_cast<int>(contours.size());
-
-            if(count > 5) // fuer ellips fit mind 6 pkte benoetigt
+            for(int level = range.start; level < range.end; ++level)
             {
-                // in rot contouren in eine drehrichtung, in gruen andere
-#ifdef SHOWELLIPSES
-                cvDrawContours(tmpAusgabe, contours, CV_RGB(255, 0, 0), CV_RGB(0, 255, 0), 0, 1, 8, cvPoint(0, 0));
-#endif
-
-                // IN OPENCV2.1 liefert cvContourArea KEIN VORZEICHEN ZUM ERKENNEN DER DREHRICHTUNG!!!! es ist ein
-                // optionaler paramter hinzugefuegt worden!!!!
-#if((CV_MAJOR_VERSION < 2) || ((CV_MAJOR_VERSION == 2) && (CV_MINOR_VERSION < 1)))
-                contourArea = cvContourArea(contours, CV_WHOLE_SEQ);
-#else
-                contourArea = cv::contourArea(contour, true);
-#endif
-                //                        if (contours->flags & CV_SEQ_FLAG_HOLE) == 0)
-                //                            debout << "Negative contourArea! If not using the absolute size, the flag
-                //                            shows already the direction!" << endl;
-
-                // war: (contourArea>50 && contourArea<8000) // sollte abhaengig von untersuchten groessen gemacht
-                // werden
-                //      entspricht:
-                //  < 4.2cm x 4.2cm=18cm^2  = 50 Pixel in maximaler personengroesse
-                // in maximaler Entfernung zur Kamera
-                //(in ebenen Versuchen entspricht dies 40cm über Bodenhöhe)
-                // größer als 4500cm^2 = 8000 Pixel
-
-                if(contourArea > l1 * l1 && contourArea < l2 * l2)
-                {
-                    // Convert CvPoint set to CvBox2D32f set.
-                    contourInside = true;
-                    for(i = 0; i < count; i++)
-                    {
-                        x = contour[i].x;
-                        y = contour[i].y;
-                        //                        // delete point at blob border
-                        //                        if (!((gray->imageData[x+y*gray->width-1]   == 255) ||
-                        //                              (gray->imageData[x+y*gray->width+1]   == 255) ||
-                        //                              (gray->imageData[x+(y-1)*gray->width] == 255) ||
-                        //                              (gray->imageData[x+(y+1)*gray->width] == 255))) // nicht am rand
-
-                        //                        }
-                        //                        else
-                        //                        {
-                        //                            --count;
-                        //                            debout << "del contour point " << x << " " << y << endl;
-                        //                        }
-                        if(x < roi.left() || x > roi.right() || y < roi.top() || y > roi.bottom())
-                            contourInside = false;
-                    }
-                    //                            contourLength = 0;
-                    //                            for(i=1; i<=count; i++)
-                    //                            {
-                    //                                contourLength+=sqrt((PointArray[i%count].x-PointArray[i-1].x)*(PointArray[i%count].x-PointArray[i-1].x)
-                    //                                +
-                    //                                (PointArray[i%count].y-PointArray[i-1].y)*(PointArray[i%count].y-PointArray[i-1].y));
-                    //                            }
-
-                    if(count > 5 && contourInside)
-                    {
-#ifdef SHOWELLIPSES
-                        cvDrawContours(
-                            tmpAusgabe,
-                            contours,
-                            CV_RGB(255, 0, 255),
-                            CV_RGB(0, 255, 255),
-                            0,
-                            1,
-                            8,
-                            cvPoint(
-                                0,
-                                0)); // um anzuzeigen welche wirklich genommen wurden
-#endif
-
-#if CV_MAJOR_VERSION == 2
-                                     // Fits ellipse to current contour.
-                                     // -------------------------------------------------------------------------------
-                        CvBox2D32f box;
-                        cvFitEllipse(PointArray2D32f, count, &box);
-#else
-                        // neuer:
-                        //// Fits ellipse to current contour.
-                        //                        CvBox2D box = cvFitEllipse2(PointArray2D32f);
-                        cv::Mat mat(count, 2, CV_32F);
-                        for(i = 0; i < count; i++)
-                        {
-                            mat.at<float>(i, 0) = (float) contour[i].x;
-                            mat.at<float>(i, 1) = (float) contour[i].y;
-                        }
-                        cv::RotatedRect box = cv::fitEllipse(mat);
-#endif
-                        // Convert ellipse data from float to integer representation.
-                        // center.x = myRound(box.center.x);
-                        // center.y = myRound(box.center.y);
-                        // box.angle = -box.angle;
-                        // sizeTmp.width = myRound(box.size.width*0.5);
-                        // sizeTmp.height = myRound(box.size.height*0.5);
-
-                        angle = (box.angle) / 180. * PI;
-                        if(box.size.width < box.size.height) // da bei meiner ellipse r1 immer der groesste radius
-                            angle -= PI / 2;
-
-                        MyEllipse elips(box.center.x, box.center.y, box.size.width * 0.5, box.size.height * 0.5, angle);
-                        //                            debout << elips.area() << " " << contourArea << " " <<
-                        //                            contourLength<< " " <<
-                        //                            contourLength*contourLength/contourArea<<endl;
-                        // if (elips.area()/contourArea < 1.2) // elips soll aehnliche flaechengroesse haben
-                        // if (contourLength/contourArea < 0.2) // elips soll aehnliche flaechengroesse haben
-                        // if (contourLength*contourLength/contourArea < 40.) // quadratisch, da in flaeche r
-                        // quadratisch eingeht
-                        //                        if (elips.r1() < 80) // wird nun beim einfuegen in person mit
-                        //                        beruecksichtigt, damit an einer stelle ellipse ueberprueft wird!! - r1
-                        //                        ist immer der groessere radius - um 2 Personen in einer ellipse zu
-                        //                        vermeiden
-                        //                        {
-                        el.append(elips);
-                        // cvEllipse(tmpAusgabe2, center, sizeTmp, box.angle, 0, 360, CV_RGB(255, 0, 0), 1, CV_AA, 0);
-                        // cvEllipseBox(tmpAusgabe3, box, CV_RGB(255, 0, 0));
-
-                        //                        }
-                        //                        else
-                        //                            debout << "del elips, because to big " << box.center.x <<" "<<
-                        //                            box.center.y <<endl; if (contourLength*contourLength/contourArea
-                        //                            >= 40.)
-                        //                                debout << "l*l/a: " <<box.center.x <<" "<< box.center.y
-                        //                                <<endl;
-                        //                            if (contourLength/contourArea >= 0.2)
-                        //                                debout << "l/a:   " <<box.center.x <<" "<< box.center.y
-                        //                                <<endl;
-                        //                            if (elips.area()/contourArea >= 1.2)
-                        //                                debout << "ea/ca: " <<box.center.x <<" "<< box.center.y
-                        //                                <<endl;
-                    }
-                }
+                levelEllipses[level] =
+                    searchLevelEllipses(gray, thresholds[level], region.tl(), l1 * l1, l2 * l2, roi);
             }
-        }
+        });
+
+    for(std::size_t level = 0; level < thresholds.size(); ++level)
+    {
+        const QList<MyEllipse> &el   = levelEllipses[level];
+        const float             dist = min * 100 + STEP_SIZE * thresholds[level] / step;
 
         insertEllipses(el, dist);
 
@@ -371,10 +301,6 @@ void PersonList::searchEllipses(pet::StereoContext *sc, QRect &roi, BackgroundFi
                       << el.at(i).angle() << " " << el.at(i).r1() << " " << el.at(i).r2() << " " << 0 << endl;
         }
 #endif
-
-        //  sprintf(outstr,"c:/%d.png",threshold);
-        // cvSaveImage(outstr, tmpAusgabe);
-        // cvWaitKey( 0 ); // zahl statt null, wenn nach bestimmter zeit weitergegangen werden soll
     }
 
 
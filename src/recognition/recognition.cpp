@@ -18,11 +18,17 @@
 
 #include "recognition.h"
 
+#ifdef APRILTAG
+#include "aprilTagDetector.h"
+#endif
 #include "codeMarkerItem.h"
 #include "codeMarkerWidget.h"
 #include "colorMarkerItem.h"
 #include "colorMarkerWidget.h"
+#include "concurrency.h"
 #include "control.h"
+#include "frameContext.h"
+#include "headDetector.h"
 #include "helper.h"
 #include "logger.h"
 #include "markerCasern.h"
@@ -31,73 +37,104 @@
 #include "multiColorMarkerItem.h"
 #include "multiColorMarkerWidget.h"
 #include "pMessageBox.h"
+#include "recognitionResult.h"
 #include "roiItem.h"
+#include "trace.h"
 #include "tracker.h"
 #include "worldImageCorrespondence.h"
 
 #include <QPointF>
 #include <QRect>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <array>
 #include <bitset>
+#include <cmath>
+#include <iterator>
 #include <opencv2/objdetect/aruco_detector.hpp>
 #include <opencv2/objdetect/aruco_dictionary.hpp>
 #include <opencv2/opencv.hpp>
+#include <optional>
+#include <utility>
 namespace reco
 {
 using namespace detail;
 
 #define ELLIPSE_DISTANCE_TO_BORDER 10
 
-struct ColorParameters
+namespace
 {
-    int  h_low     = 0;
-    int  h_high    = 359;
-    int  s_low     = 0;
-    int  s_high    = 255;
-    int  v_low     = 0;
-    int  v_high    = 255;
-    bool inversHue = false;
-};
+/// Range [low, high] of ints clamped to the values of uchar; empty ranges get low > high
+std::pair<uchar, uchar> clampToUchar(int low, int high)
+{
+    if(low > high || high < 0 || low > 255)
+    {
+        return {255, 0};
+    }
+    return {static_cast<uchar>(std::max(low, 0)), static_cast<uchar>(std::min(high, 255))};
+}
+
+/**
+ * @brief Classifies the pixels of the rows in range for thresholdHSV()
+ *
+ * The inversion of the hue range is a template parameter, so the inner loop only consists of
+ * comparisons and can be vectorized by the compiler.
+ */
+template <bool InverseHue>
+void thresholdHSVRows(const cv::Mat &hsv, cv::Mat &bin, const ColorParameters &param, const cv::Range &range)
+{
+    const auto [hLow, hHigh] = clampToUchar(param.h_low, param.h_high);
+    const auto [sLow, sHigh] = clampToUchar(param.s_low, param.s_high);
+    const auto [vLow, vHigh] = clampToUchar(param.v_low, param.v_high);
+    for(int y = range.start; y < range.end; ++y)
+    {
+        const uchar *src = hsv.ptr<uchar>(y);
+        uchar       *dst = bin.ptr<uchar>(y);
+        for(int x = 0; x < hsv.cols; ++x)
+        {
+            const uchar h = src[3 * x];
+            const uchar s = src[3 * x + 1];
+            const uchar v = src[3 * x + 2];
+            // an inverted hue range is the part of the hue circle outside of [h_low, h_high]
+            const bool hue    = (h >= hLow) & (h <= hHigh);
+            const bool inside = (hue != InverseHue) & (s >= sLow) & (s <= sHigh) & (v >= vLow) & (v <= vHigh);
+            dst[x]            = static_cast<uchar>(-static_cast<int>(inside));
+        }
+    }
+}
+} // namespace
 
 /*!
  *  \brief  Apply a color threshold to an image.
  *
- *  \param  src The color image.
- *  \param  dst The binarized image.
+ *  \param  hsv The color image converted to HSV (see cv::COLOR_BGR2HSV).
+ *  \param  bin The binarized image.
  *  \param  param The parameters.
  *
  *  Each component H, S and V must be in a given range, defined by the parameters.
+ *  The kernel for the (non-)inverted hue range is selected once, so every pixel is
+ *  classified by branch-free comparisons; the rows are processed in parallel.
  */
-
-void thresholdHSV(const cv::Mat &src, cv::Mat &bin, const ColorParameters &param)
+void detail::thresholdHSV(const cv::Mat &hsv, cv::Mat &bin, const ColorParameters &param)
 {
-    int h, s, v;
-    int x, y;
+    CV_Assert(hsv.type() == CV_8UC3);
 
-    cv::Mat hsv{src.size(), src.type()};
-    cv::cvtColor(src, hsv, cv::COLOR_BGR2HSV);
+    bin.create(hsv.rows, hsv.cols, CV_8UC1);
+    const auto rows = param.inversHue ? &thresholdHSVRows<true> : &thresholdHSVRows<false>;
+    cv::parallel_for_(cv::Range(0, hsv.rows), [&](const cv::Range &range) { rows(hsv, bin, param, range); });
+}
 
-    for(y = 0; y < bin.rows; ++y)
+/// img (BGR) converted to HSV, if hsv is empty
+cv::Mat toHsv(const cv::Mat &img, const cv::Mat &hsv = cv::Mat())
+{
+    if(!hsv.empty())
     {
-        for(x = 0; x < bin.cols; ++x)
-        {
-            cv::Vec3b intensity = hsv.at<cv::Vec3b>(cv::Point(x, y));
-            h                   = intensity.val[0];
-            s                   = intensity.val[1];
-            v                   = intensity.val[2];
-
-            // apply the thresholds
-            if((!param.inversHue && (h < param.h_low || param.h_high < h)) ||
-               (param.inversHue && (h >= param.h_low && param.h_high >= h)) || (s < param.s_low || param.s_high < s) ||
-               (v < param.v_low || param.v_high < v))
-            {
-                bin.at<uchar>(cv::Point(x, y)) = 0;
-            }
-            else
-            {
-                bin.at<uchar>(cv::Point(x, y)) = 255;
-            }
-        }
+        return hsv;
     }
+    cv::Mat converted;
+    cv::cvtColor(img, converted, cv::COLOR_BGR2HSV);
+    return converted;
 }
 
 
@@ -143,27 +180,43 @@ void setColorParameter(const QColor &fromColor, const QColor &toColor, bool inve
     param.inversHue = inversHue;
 }
 
+/**
+ * @brief Copies the calibration needed by autoCorrectColorMarker() from the Control
+ *
+ * Has to be called on the GUI thread; the result does not access the widgets.
+ */
+PerspectiveCorrection getPerspectiveCorrection(Control *controlWidget)
+{
+    Petrack *mainWindow = controlWidget->getMainWindow();
+    auto     extrParams = controlWidget->getExtrinsicParameters();
+    auto     trans      = controlWidget->getCalibCoord3DTrans();
+
+    PerspectiveCorrection correction;
+    correction.camera           = mainWindow->getExtrCalibration()->getCameraModel();
+    correction.worldImageCorr   = mainWindow->getWorldImageCorrespondence().snapshot();
+    correction.pointUnderCamera = cv::Point3f(-trans.x() - extrParams.trans1, -trans.y() - extrParams.trans2, 0);
+    correction.borderSize       = mainWindow->getImageBorderSize();
+    return correction;
+}
+
 /**
  * @brief calculates pixel-displacement due to oblique/angular view
  *
  * Relevant for Color Markers. boxImageCentre without border. More information: Dissertation Maik pp. 138
  *
  * @param boxImageCentre
- * @param controlWidget
+ * @param correction calibration, see getPerspectiveCorrection()
  * @return
  */
-Vec2F autoCorrectColorMarker(const Vec2F &boxImageCentre, Control *controlWidget)
+Vec2F autoCorrectColorMarker(const Vec2F &boxImageCentre, const PerspectiveCorrection &correction)
 {
-    Petrack    *mainWindow = controlWidget->getMainWindow();
-    auto        extrParams = controlWidget->getExtrinsicParameters();
-    auto        trans      = controlWidget->getCalibCoord3DTrans();
-    cv::Point2f tp         = mainWindow->getExtrCalibration()->getImagePoint(
-        cv::Point3f(-trans.x() - extrParams.trans1, -trans.y() - extrParams.trans2, 0));
-    Vec2F pixUnderCam(tp.x, tp.y); // CvPoint
-    Vec2F boxImageCentreWithBorder = boxImageCentre;
-    boxImageCentreWithBorder += Vec2F(mainWindow->getImageBorderSize(), mainWindow->getImageBorderSize());
-    pixUnderCam += Vec2F(mainWindow->getImageBorderSize(), mainWindow->getImageBorderSize());
-    float angle = 90 - mainWindow->getWorldImageCorrespondence().getAngleToGround(
+    const int   bS = correction.borderSize;
+    cv::Point2f tp = ExtrCalibration::getImagePoint(correction.camera, correction.pointUnderCamera);
+    Vec2F       pixUnderCam(tp.x, tp.y); // CvPoint
+    Vec2F       boxImageCentreWithBorder = boxImageCentre;
+    boxImageCentreWithBorder += Vec2F(bS, bS);
+    pixUnderCam += Vec2F(bS, bS);
+    float angle = 90 - correction.worldImageCorr->getAngleToGround(
                            boxImageCentreWithBorder.x(),
                            boxImageCentreWithBorder.y(),
                            175); // Hoehe 175 cm ist egal, da auf jeder Hoehe gleicher Winkel
@@ -172,15 +225,118 @@ Vec2F autoCorrectColorMarker(const Vec2F &boxImageCentre, Control *controlWidget
     moveDir.normalize();
 
     cv::Point3f p3x1, p3x2;
-    p3x1 = mainWindow->getExtrCalibration()->get3DPoint(cv::Point2f(boxImageCentre.x(), boxImageCentre.y()), 175);
-    p3x2 = mainWindow->getExtrCalibration()->get3DPoint(
-        cv::Point2f(boxImageCentre.x() + moveDir.x(), boxImageCentre.y() + moveDir.y()), 175);
+    p3x1 = ExtrCalibration::get3DPoint(correction.camera, cv::Point2f(boxImageCentre.x(), boxImageCentre.y()), 175);
+    p3x2 = ExtrCalibration::get3DPoint(
+        correction.camera, cv::Point2f(boxImageCentre.x() + moveDir.x(), boxImageCentre.y() + moveDir.y()), 175);
     p3x1 = p3x1 - p3x2;
     Vec2F cmPerPixel(p3x1.x, p3x1.y);
 
     return (0.12 * angle / cmPerPixel.length()) * moveDir; // Maik Dissertation Seite 138
 }
 
+Vec2F autoCorrectColorMarker(const Vec2F &boxImageCentre, Control *controlWidget)
+{
+    return autoCorrectColorMarker(boxImageCentre, getPerspectiveCorrection(controlWidget));
+}
+
+/**
+ * @brief Opens or closes binary with a disk of radius
+ *
+ * The cost of an elliptic structuring element grows with the number of its pixels. So only
+ * small disks are used as such; larger ones are approximated by an octagon: a square, which
+ * is filtered separably, followed by a diamond, which is filtered as repeated 3x3 cross. The
+ * octagon deviates from the disk by less than 8 % of the radius.
+ *
+ * @param binary mask to filter in place
+ * @param op cv::MORPH_OPEN or cv::MORPH_CLOSE
+ * @param radius radius of the disk
+ */
+void detail::morphologyDisk(cv::Mat &binary, int op, int radius)
+{
+    constexpr int maxEllipseRadius = 5;
+    if(radius <= maxEllipseRadius)
+    {
+        cv::morphologyEx(
+            binary, binary, op, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(2 * radius + 1, 2 * radius + 1)));
+        return;
+    }
+
+    // the corners of the octagon lie on the disk
+    const int squareRadius  = cvRound(radius * (std::sqrt(2.) - 1));
+    const int diamondRadius = radius - squareRadius;
+
+    const cv::Mat square =
+        cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2 * squareRadius + 1, 2 * squareRadius + 1));
+    const cv::Mat cross  = cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(3, 3));
+
+    const auto erode = [&]()
+    {
+        cv::erode(binary, binary, square);
+        cv::erode(binary, binary, cross, cv::Point(-1, -1), diamondRadius);
+    };
+    const auto dilate = [&]()
+    {
+        cv::dilate(binary, binary, square);
+        cv::dilate(binary, binary, cross, cv::Point(-1, -1), diamondRadius);
+    };
+    if(op == cv::MORPH_OPEN)
+    {
+        erode();
+        dilate();
+    }
+    else
+    {
+        dilate();
+        erode();
+    }
+}
+
+/**
+ * @brief Returns the outer contours of the blobs in binary, apart from those at its edge and small ones
+ *
+ * The blobs are labeled with cv::connectedComponentsWithStats, which is much cheaper than
+ * tracing the contours of all of them. Blobs within 2 pixels of the edge of binary and blobs
+ * whose bounding box cannot hold a contour of minArea are dropped by their statistics. Only the
+ * contours of the remaining blobs are traced, each inside its bounding box. Unlike
+ * cv::findContours() with cv::RETR_EXTERNAL, blobs inside holes of other blobs are returned as well.
+ *
+ * @param binary mask of the blobs
+ * @param minArea minimal area of the contours (as by cv::contourArea())
+ * @return contours in coordinates of binary
+ */
+std::vector<std::vector<cv::Point>> detail::findBlobContours(const cv::Mat &binary, double minArea)
+{
+    TRACE_ZONE("reco::findBlobContours");
+    cv::Mat   labels;
+    cv::Mat   stats;
+    cv::Mat   centroids;
+    const int count = cv::connectedComponentsWithStats(binary, labels, stats, centroids, 8, CV_32S);
+
+    std::vector<std::vector<cv::Point>> contours;
+    for(int label = 1; label < count; ++label)
+    {
+        const cv::Rect bounds(
+            stats.at<int>(label, cv::CC_STAT_LEFT),
+            stats.at<int>(label, cv::CC_STAT_TOP),
+            stats.at<int>(label, cv::CC_STAT_WIDTH),
+            stats.at<int>(label, cv::CC_STAT_HEIGHT));
+        const bool atEdge = bounds.x <= 1 || bounds.y <= 1 || bounds.br().x > binary.cols - 2 ||
+                            bounds.br().y > binary.rows - 2;
+        // the contour runs through the centers of the outermost pixels
+        if(atEdge || static_cast<double>(bounds.width - 1) * (bounds.height - 1) < minArea)
+        {
+            continue;
+        }
+
+        const cv::Mat                       blob = labels(bounds) == label;
+        std::vector<std::vector<cv::Point>> blobContours;
+        cv::findContours(blob, blobContours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, bounds.tl());
+        // a blob is connected, so it has one outer contour
+        contours.push_back(std::move(blobContours.front()));
+    }
+    return contours;
+}
+
 /**
  * @brief Detects and filters colorBlobs in the given image
  *
@@ -224,40 +380,22 @@ Vec2F autoCorrectColorMarker(const Vec2F &boxImageCentre, Control *controlWidget
     cv::Mat binary = options.binary;
 
     // color thresholding
-    thresholdHSV(img, binary, param);
+    thresholdHSV(toHsv(img, options.hsv), binary, param);
 
     // close small holes: radius ( hole ) < radius ( close )
     if(options.useClose)
     {
-        const int radiusClose = options.radiusClose;
-        cv::morphologyEx(
-            binary,
-            binary,
-            cv::MORPH_CLOSE,
-            getStructuringElement(
-                cv::MORPH_ELLIPSE,
-                cv::Size(2 * radiusClose + 1, 2 * radiusClose + 1),
-                cv::Point(radiusClose, radiusClose)));
+        morphologyDisk(binary, cv::MORPH_CLOSE, options.radiusClose);
     }
 
     // remove small blobs: radius ( blob ) < radius ( open )
     if(options.useOpen)
     {
-        const int radiusOpen = options.radiusOpen;
-        cv::morphologyEx(
-            binary,
-            binary,
-            cv::MORPH_OPEN,
-            getStructuringElement(
-                cv::MORPH_ELLIPSE,
-                cv::Size(2 * radiusOpen + 1, 2 * radiusOpen + 1),
-                cv::Point(radiusOpen, radiusOpen)));
+        morphologyDisk(binary, cv::MORPH_OPEN, options.radiusOpen);
     }
 
-    std::vector<std::vector<cv::Point>> contours;
-    cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-
-    for(const auto &contour : contours)
+    // blobs at the edge of the ROI are dropped, as their center moves while they leave it
+    for(auto &contour : findBlobContours(binary, options.minArea))
     {
         double area = cv::contourArea(contour);
 
@@ -276,17 +414,6 @@ Vec2F autoCorrectColorMarker(const Vec2F &boxImageCentre, Control *controlWidget
             maxExpansion = box.size.width;
         }
 
-        // contour at border of roi, than neglect because of object going out of region has moving center
-        bool atEdge = std::any_of(
-            contour.cbegin(),
-            contour.cend(),
-            [&](const cv::Point &p)
-            { return (p.x <= 1) || (p.x >= img.cols - 2) || (p.y <= 1) || (p.y >= img.rows - 2); });
-
-        if(atEdge)
-        {
-            continue;
-        }
         if(area < options.minArea || area > options.maxArea)
         {
             continue;
@@ -301,8 +428,7 @@ Vec2F autoCorrectColorMarker(const Vec2F &boxImageCentre, Control *controlWidget
         boxImageCentre.setX(boxImageCentre.x() + static_cast<double>(box.center.x));
         boxImageCentre.setY(boxImageCentre.y() + static_cast<double>(box.center.y));
 
-        // TODO maybe use move constructor to increase perf for contour(then not const anymore)
-        colorBlobs.push_back({box, boxImageCentre, markerColor, contour, static_cast<double>(maxExpansion)});
+        colorBlobs.push_back({box, boxImageCentre, markerColor, std::move(contour), static_cast<double>(maxExpansion)});
     }
     return colorBlobs;
 }
@@ -430,6 +556,41 @@ cv::Mat detail::customBgr2Gray(const cv::Mat &subImg, const QColor &midHue)
     return subGray;
 }
 
+namespace
+{
+/**
+ * @brief Calls work(i) for every i in [0, count) in parallel and waits for all calls
+ *
+ * The work must only write to its own (per index) results, so the caller can merge
+ * them in a deterministic order afterwards.
+ */
+template <typename Work>
+void runInParallel(std::size_t count, Work work)
+{
+    if(count < 2)
+    {
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            work(i);
+        }
+        return;
+    }
+
+    // own pool, as the caller may already run in the global one
+    QThreadPool               &recognitionPool = concurrency::pool(concurrency::Pool::Recognition);
+    std::vector<QFuture<void>> futures;
+    futures.reserve(count);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        futures.push_back(QtConcurrent::run(&recognitionPool, [&work, i]() { work(i); }));
+    }
+    for(auto &future : futures)
+    {
+        future.waitForFinished();
+    }
+}
+} // namespace
+
 /**
  * @brief Refines the detection of multicolor-markers with a black dot
  *
@@ -442,6 +603,8 @@ cv::Mat detail::customBgr2Gray(const cv::Mat &subImg, const QColor &midHue)
  * is not found, the ColorBlob might still count as detection, if the ignoreWithoutMarker
  * option is disabled.
  *
+ * The blobs are refined in parallel; the detections are appended in the order of the blobs.
+ *
  * @param blobs detected color blobs
  * @param img img in which the color blobs were detected
  * @param crossList list of all detected people
@@ -456,131 +619,156 @@ void detail::refineWithBlackDot(
     constexpr int                   border                = 4; // zusaetzlicher rand um subrects
     const int                       bS                    = options.borderSize;
     const bool                      restrictPosition      = options.restrictPosition;
-    const WorldImageCorrespondence *worldImageCorr        = options.worldImageCorr;
+    const WorldImageCorrespondence *worldImageCorr        = options.perspective.worldImageCorr.get();
     const QColor                    midHue                = options.midHue;
     const double                    dotSize               = options.dotSize;
     const bool                      ignoreWithoutMarker   = options.ignoreWithoutMarker;
     const bool                      autoCorrect           = options.autoCorrect;
     const bool                      autoCorrectOnlyExport = options.autoCorrectOnlyExport;
-    Control                        *controlWidget         = options.controlWidget;
-
-    for(ColorBlob &blob : blobs)
-    {
-        cv::Rect         cropRect;
-        cv::RotatedRect &box = blob.box;
-        cropRect.x           = std::max(1, myRound(box.center.x - box.size.width / 2 - border));
-        cropRect.y           = std::max(1, myRound(box.center.y - box.size.height / 2 - border));
-        // 1. rundet kaufmaennisch, 2. dann rundet zur naechst kleiner geraden zahl
-        // min wegen bildrand
-        cropRect.width  = std::min(img.cols - cropRect.x - 1, 2 * border + (myRound(blob.maxExpansion) & -2));
-        cropRect.height = std::min(
-            img.rows - cropRect.y - 1,
-            2 * border + (myRound(blob.maxExpansion) & -2)); // cropRect.height = cropRect.width;
-
-        if(restrictPosition)
-        {
-            restrictPositionBlackDot(blob, worldImageCorr, bS, cropRect);
-        }
+    const double                    defaultHeight         = options.defaultHeight;
 
-        // cvtColor results in really dark images, especially with red shades
-        // so using custom conversion weighted by midHue
-        cv::Mat subImg  = img(cropRect);
-        cv::Mat subGray = customBgr2Gray(subImg, midHue);
-        cv::Mat subBW;
-
-        double maxThreshold = std::max(
-            std::max(
-                getValue(subGray, subGray.cols / 2, subGray.rows / 2).value(),
-                getValue(subGray, subGray.cols / 4, subGray.rows / 2).value()),
-            getValue(subGray, 3 * subGray.cols / 4, subGray.rows / 2).value());
-        int   step    = static_cast<int>((maxThreshold - 5)) / 5;
-        int   minGrey = 300;
-        Vec2F subCenter;
-        for(int threshold = 5; threshold < maxThreshold; threshold += step)
+    std::vector<std::optional<TrackPoint>> refined(blobs.size());
+    runInParallel(
+        blobs.size(),
+        [&](std::size_t i)
         {
-            cv::threshold(subGray, subBW, threshold, 255, cv::THRESH_BINARY);
+            ColorBlob &blob = blobs[i];
+            cv::Rect         cropRect;
+            cv::RotatedRect &box = blob.box;
+            cropRect.x           = std::max(1, myRound(box.center.x - box.size.width / 2 - border));
+            cropRect.y           = std::max(1, myRound(box.center.y - box.size.height / 2 - border));
+            // 1. rundet kaufmaennisch, 2. dann rundet zur naechst kleiner geraden zahl
+            // min wegen bildrand
+            cropRect.width  = std::min(img.cols - cropRect.x - 1, 2 * border + (myRound(blob.maxExpansion) & -2));
+            cropRect.height = std::min(
+                img.rows - cropRect.y - 1,
+                2 * border + (myRound(blob.maxExpansion) & -2)); // cropRect.height = cropRect.width;
+
+            if(restrictPosition)
+            {
+                restrictPositionBlackDot(blob, worldImageCorr, bS, cropRect);
+            }
 
-            // find contours and store them all as a list
+            // cvtColor results in really dark images, especially with red shades
+            // so using custom conversion weighted by midHue
+            cv::Mat subImg  = img(cropRect);
+            cv::Mat subGray = customBgr2Gray(subImg, midHue);
+            cv::Mat subBW;
+
+            double maxThreshold = std::max(
+                std::max(
+                    getValue(subGray, subGray.cols / 2, subGray.rows / 2).value(),
+                    getValue(subGray, subGray.cols / 4, subGray.rows / 2).value()),
+                getValue(subGray, 3 * subGray.cols / 4, subGray.rows / 2).value());
+            int   step    = static_cast<int>((maxThreshold - 5)) / 5;
+            int   minGrey = 300;
+            Vec2F subCenter;
+            // below the darkest pixel, the thresholded image is white and contains no dot
+            double darkest;
+            cv::minMaxLoc(subGray, &darkest);
             std::vector<std::vector<cv::Point>> subContours;
-            cv::findContours(subBW, subContours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
-
-            // test each contour
-            for(auto &subContour : subContours)
+            for(int threshold = 5; threshold < maxThreshold; threshold += step)
             {
-                if(subContour.size() > 5) // This is number point in contour
+                if(threshold < darkest)
                 {
-                    cv::RotatedRect subBox = cv::minAreaRect(subContour);
-                    double          subRatio;
-                    double          subMaxExpansion;
-                    if(subBox.size.height > subBox.size.width)
-                    {
-                        subRatio        = subBox.size.height / subBox.size.width;
-                        subMaxExpansion = subBox.size.height;
-                    }
-                    else
-                    {
-                        subRatio        = subBox.size.width / subBox.size.height;
-                        subMaxExpansion = subBox.size.width;
-                    }
+                    continue;
+                }
+                cv::threshold(subGray, subBW, threshold, 255, cv::THRESH_BINARY);
 
-                    QPointF cmPerPixel = worldImageCorr->getCmPerPixel(
-                        cropRect.x + subBox.center.x, cropRect.y + subBox.center.y, controlWidget->getDefaultHeight());
-                    double cmPerPixelAvg = (cmPerPixel.x() + cmPerPixel.y()) / 2.;
-                    double markerSize =
-                        dotSize / cmPerPixelAvg; // war: 5cm// war WDG: = 16; war GymBay: = headSize / 4.5;
+                // find contours and store them all as a list
+                cv::findContours(subBW, subContours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
 
-                    // maximalseitenverhaeltnis && minimal und maximaldurchmesser
-                    if(subRatio < 1.8 && subMaxExpansion < markerSize * 1.5 && subMaxExpansion > markerSize / 2) // 1.5
+                // test each contour
+                for(auto &subContour : subContours)
+                {
+                    if(subContour.size() > 5) // This is number point in contour
                     {
-                        double subContourArea = cv::contourArea(subContour, true);
-                        int    cx             = myRound(subBox.center.x);
-                        int    cy             = myRound(subBox.center.y);
-
-                        // darker inside && dark inside &&  mittelpunkt in kopfkontur
-                        int xygrey = getValue(subGray, cx, cy).value();
-                        //                                    debout << "xygrey: " << xygrey << endl;
-                        if(subContourArea > 0 && xygrey < std::min(150., 2 * maxThreshold / 3) &&
-                           (0 < cv::pointPolygonTest(
-                                    blob.contour,
-                                    cv::Point2f(cropRect.x + subBox.center.x, cropRect.y + subBox.center.y),
-                                    false))) // dark inside
+                        cv::RotatedRect subBox = cv::minAreaRect(subContour);
+                        double          subRatio;
+                        double          subMaxExpansion;
+                        if(subBox.size.height > subBox.size.width)
                         {
-                            if(minGrey > xygrey)
+                            subRatio        = subBox.size.height / subBox.size.width;
+                            subMaxExpansion = subBox.size.height;
+                        }
+                        else
+                        {
+                            subRatio        = subBox.size.width / subBox.size.height;
+                            subMaxExpansion = subBox.size.width;
+                        }
+                        // maximalseitenverhaeltnis; tested first, as the pixel size needs the calibration
+                        if(!(subRatio < 1.8))
+                        {
+                            continue;
+                        }
+
+                        QPointF cmPerPixel = worldImageCorr->getCmPerPixel(
+                            cropRect.x + subBox.center.x, cropRect.y + subBox.center.y, defaultHeight);
+                        double cmPerPixelAvg = (cmPerPixel.x() + cmPerPixel.y()) / 2.;
+                        double markerSize =
+                            dotSize / cmPerPixelAvg; // war: 5cm// war WDG: = 16; war GymBay: = headSize / 4.5;
+
+                        // minimal und maximaldurchmesser
+                        if(subMaxExpansion < markerSize * 1.5 && subMaxExpansion > markerSize / 2) // 1.5
+                        {
+                            double subContourArea = cv::contourArea(subContour, true);
+                            int    cx             = myRound(subBox.center.x);
+                            int    cy             = myRound(subBox.center.y);
+
+                            // darker inside && dark inside &&  mittelpunkt in kopfkontur
+                            int xygrey = getValue(subGray, cx, cy).value();
+                            //                                    debout << "xygrey: " << xygrey << endl;
+                            if(subContourArea > 0 && xygrey < std::min(150., 2 * maxThreshold / 3) &&
+                               (0 < cv::pointPolygonTest(
+                                        blob.contour,
+                                        cv::Point2f(cropRect.x + subBox.center.x, cropRect.y + subBox.center.y),
+                                        false))) // dark inside
                             {
-                                minGrey = xygrey;
-                                subCenter.set(cropRect.x + subBox.center.x, cropRect.y + subBox.center.y);
+                                if(minGrey > xygrey)
+                                {
+                                    minGrey = xygrey;
+                                    subCenter.set(cropRect.x + subBox.center.x, cropRect.y + subBox.center.y);
+                                }
                             }
                         }
                     }
                 }
             }
-        }
 
-        if(minGrey < 260) // mit gefundenem schwarzem punkt
-        {
-            crossList.append(
-                TrackPoint(subCenter, 100, Vec2F(box.center.x, box.center.y), blob.color)); // 100 beste qualitaet
-        }
-        else if(!ignoreWithoutMarker)
-        {
-            if(autoCorrect && !autoCorrectOnlyExport)
+            if(minGrey < 260) // mit gefundenem schwarzem punkt
             {
-                Vec2F moveDir = autoCorrectColorMarker(blob.imageCenter, controlWidget);
-
-                crossList.append(TrackPoint(
-                    Vec2F(box.center.x, box.center.y) + moveDir,
-                    100,
-                    Vec2F(box.center.x, box.center.y),
-                    blob.color)); // 100 beste qualitaet
+                refined[i] =
+                    TrackPoint(subCenter, 100, Vec2F(box.center.x, box.center.y), blob.color); // 100 beste qualitaet
             }
-            else
+            else if(!ignoreWithoutMarker)
             {
-                crossList.append(TrackPoint(
-                    Vec2F(box.center.x, box.center.y),
-                    90,
-                    Vec2F(box.center.x, box.center.y),
-                    blob.color)); // 100 beste qualitaet
+                if(autoCorrect && !autoCorrectOnlyExport)
+                {
+                    Vec2F moveDir = autoCorrectColorMarker(blob.imageCenter, options.perspective);
+
+                    refined[i] = TrackPoint(
+                        Vec2F(box.center.x, box.center.y) + moveDir,
+                        100,
+                        Vec2F(box.center.x, box.center.y),
+                        blob.color); // 100 beste qualitaet
+                }
+                else
+                {
+                    refined[i] = TrackPoint(
+                        Vec2F(box.center.x, box.center.y),
+                        90,
+                        Vec2F(box.center.x, box.center.y),
+                        blob.color); // 100 beste qualitaet
+                }
             }
+        });
+
+    // appended in the order of the blobs, independent of the scheduling
+    for(const auto &point : refined)
+    {
+        if(point)
+        {
+            crossList.append(*point);
         }
     }
 }
@@ -637,6 +825,8 @@ TrackPoint detail::resolveMoreThanOneCandidateCode(QList<TrackPoint> &codes, con
  * if the ignoreWithoutMarker option is disabled. Missing frames where code is not
  * recognized are interpolated in trackerReal.cpp and Marker ID is set to -1
  *
+ * The blobs are refined in parallel; detections and overlays are appended in the order of the blobs.
+ *
  * @param blobs detected color blobs
  * @param img img in which the color blobs were detected
  * @param crossList list of all detected people
@@ -647,111 +837,123 @@ void detail::refineWithAruco(
     std::vector<ColorBlob>      &blobs,
     const cv::Mat               &img,
     QList<TrackPoint>           &crossList,
-    ArucoOptions                &options,
+    const ArucoOptions          &options,
     const IntrinsicCameraParams &intrinsicCameraParams)
 {
     constexpr int border = 4; // zusaetzlicher rand um subrects
 
-    Control *controlWidget         = options.controlWidget;
-    bool     ignoreWithoutMarker   = options.ignoreWithoutMarker;
-    bool     autoCorrect           = options.autoCorrect;
-    bool     autoCorrectOnlyExport = options.autoCorrectOnlyExport;
-
-    CodeMarkerOptions &codeOpt = options.codeOpt;
-    for(ColorBlob &blob : blobs)
-    {
-        // cropRect has coordinates of rechtangele around color blob with respect to lower left corner (as in the
-        // beginning of useBlackDot)
-        const cv::RotatedRect &box      = blob.box;
-        cv::Rect               cropRect = box.boundingRect();
+    bool ignoreWithoutMarker   = options.ignoreWithoutMarker;
+    bool autoCorrect           = options.autoCorrect;
+    bool autoCorrectOnlyExport = options.autoCorrectOnlyExport;
 
+    std::vector<std::vector<CodeMarkerOverlay>> blobOverlays(blobs.size());
+    std::vector<std::optional<TrackPoint>>      refined(blobs.size());
+    runInParallel(
+        blobs.size(),
+        [&](std::size_t i)
+        {
+            ColorBlob &blob = blobs[i];
+            // cropRect has coordinates of rechtangele around color blob with respect to lower left corner (as in the
+            // beginning of useBlackDot)
+            const cv::RotatedRect &box      = blob.box;
+            cv::Rect               cropRect = box.boundingRect();
 
-        int extendRect = myRound(
-            blob.maxExpansion *
-            2); // scalar to increase area of cropRect for better detection of codemarkers when marker appears to stick
-                // out of the colored head because of tilted heads; value of .3 chosen arbitrarily after discussion
-        const int sideLength = 2 * border + ((myRound(blob.maxExpansion) + extendRect) & -2);
 
-        const auto borderVec     = cv::Point(border, border);
-        const auto topLeftCorner = cropRect - borderVec;
-        cropRect.x               = std::max(1, topLeftCorner.x - sideLength / 2);
-        cropRect.y               = std::max(1, topLeftCorner.y - sideLength / 2);
+            // scalar to increase area of cropRect for better detection of codemarkers when marker appears to stick
+            // out of the colored head because of tilted heads; value of .3 chosen arbitrarily after discussion
+            int       extendRect = myRound(blob.maxExpansion * 2);
+            const int sideLength = 2 * border + ((myRound(blob.maxExpansion) + extendRect) & -2);
 
-        // (x&-2) == std::floor(x - x%2) | Ensures it's divisible by 2
-        const int maxWidth  = img.cols - cropRect.x - 1;
-        cropRect.width      = std::min(maxWidth, sideLength);
-        const int maxHeight = img.rows - cropRect.y - 1;
-        cropRect.height     = std::min(maxHeight, sideLength);
+            const auto borderVec     = cv::Point(border, border);
+            const auto topLeftCorner = cropRect - borderVec;
+            cropRect.x               = std::max(1, topLeftCorner.x - sideLength / 2);
+            cropRect.y               = std::max(1, topLeftCorner.y - sideLength / 2);
 
-        cv::Mat subImg = img(cropRect); // --> shallow copy (points to original data)
+            // (x&-2) == std::floor(x - x%2) | Ensures it's divisible by 2
+            const int maxWidth  = img.cols - cropRect.x - 1;
+            cropRect.width      = std::min(maxWidth, sideLength);
+            const int maxHeight = img.rows - cropRect.y - 1;
+            cropRect.height     = std::min(maxHeight, sideLength);
 
-        Vec2F offsetCropRect2Roi; // needed for drawing detected ArucoCode-Candidates correctly -> passed on to
-                                  // findCodeMarker()-Function
-        offsetCropRect2Roi.setX(cropRect.x);
-        offsetCropRect2Roi.setY(cropRect.y);
+            cv::Mat subImg = img(cropRect); // --> shallow copy (points to original data)
 
-        if(subImg.empty())
-        {
-            continue;
-        }
-        // TODO: Use Reference to actual codeMarkerOptions in MulticolorMarkerOptions
-        // NOTE: For now, add as parameter of findMulticolorMarker
-        codeOpt.setOffsetCropRect2Roi(offsetCropRect2Roi);
+            Vec2F offsetCropRect2Roi; // needed for drawing detected ArucoCode-Candidates correctly -> passed on to
+                                      // findCodeMarker()-Function
+            offsetCropRect2Roi.setX(cropRect.x);
+            offsetCropRect2Roi.setY(cropRect.y);
 
-        QList<TrackPoint> addedCodes = findCodeMarker(subImg, options.method, codeOpt, intrinsicCameraParams, true);
-        codeOpt.setOffsetCropRect2Roi({0, 0});
+            if(subImg.empty())
+            {
+                return;
+            }
+            QList<TrackPoint> addedCodes = findCodeMarker(
+                subImg,
+                options.method,
+                options.codeOpt,
+                intrinsicCameraParams,
+                blobOverlays[i],
+                offsetCropRect2Roi,
+                true);
+
+            // remove all detected codes in the image, that are not inside the bounding box of the color blob
+            addedCodes = filterCodesByBoundingRect(addedCodes, blob.box.boundingRect(), offsetCropRect2Roi);
+
+            // used for autocorrection (if enabled)
+            Vec2F moveDir(0, 0);
+            if(autoCorrect && !autoCorrectOnlyExport)
+            {
+                moveDir = autoCorrectColorMarker(blob.imageCenter, options.perspective);
+            }
 
-        // remove all detected codes in the image, that are not inside the bounding box of the color blob
-        addedCodes = filterCodesByBoundingRect(addedCodes, blob.box.boundingRect(), offsetCropRect2Roi);
+            // there are detected markers or candidates
+            if(!addedCodes.empty())
+            {
+                // the aruco detection first adds detected codes followed by candidates
+                bool isDetected = addedCodes.first().getMarkerID() >= 0;
 
-        // used for autocorrection (if enabled)
-        Vec2F moveDir(0, 0);
-        if(autoCorrect && !autoCorrectOnlyExport)
-        {
-            moveDir = autoCorrectColorMarker(blob.imageCenter, controlWidget);
-        }
+                if(isDetected)
+                {
+                    // codes are already filtered to be inside bounding rect, so just take the first
+                    auto code = addedCodes.at(0);
+
+                    code.setCol(blob.color);
+                    code = code + Vec2F(cropRect.x, cropRect.y) + moveDir;
+                    refined[i] = code;
+                    // if a code was fully detected we are done
+                    return;
+                }
 
-        // there are detected markers or candidates
-        if(!addedCodes.empty())
-        {
-            // the aruco detection first adds detected codes followed by candidates
-            bool isDetected = addedCodes.first().getMarkerID() >= 0;
+                // reference center point of blob
+                Vec2F      referencePosition(box.center.x, box.center.y);
+                TrackPoint trackPoint(referencePosition + moveDir, 90, Vec2F(box.center.x, box.center.y), blob.color);
 
-            if(isDetected)
-            {
-                // codes are already filtered to be inside bounding rect, so just take the first
-                auto code = addedCodes.at(0);
+                auto resolvedCode = resolveMoreThanOneCandidateCode(addedCodes, referencePosition - offsetCropRect2Roi);
 
-                code.setCol(blob.color);
-                code = code + Vec2F(cropRect.x, cropRect.y) + moveDir;
-                crossList.append(code);
-                // if a code was fully detected we are done
-                continue;
+                resolvedCode.setQual(TrackPoint::bestDetectionQual);
+                resolvedCode.setCol(blob.color);
+                resolvedCode = resolvedCode + Vec2F(cropRect.x, cropRect.y) + moveDir;
+                refined[i] = resolvedCode;
+                return;
             }
 
-            // reference center point of blob
-            Vec2F      referencePosition(box.center.x, box.center.y);
-            TrackPoint trackPoint(referencePosition + moveDir, 90, Vec2F(box.center.x, box.center.y), blob.color);
-
-            auto resolvedCode = resolveMoreThanOneCandidateCode(addedCodes, referencePosition - offsetCropRect2Roi);
-
-            resolvedCode.setQual(TrackPoint::bestDetectionQual);
-            resolvedCode.setCol(blob.color);
-            resolvedCode = resolvedCode + Vec2F(cropRect.x, cropRect.y) + moveDir;
-            crossList.append(resolvedCode);
-            continue;
-        }
+            // case not even candidates were detected
+            if(addedCodes.empty() && !ignoreWithoutMarker)
+            {
+                // set to zero as coordinates are directly used from cropRect
+                refined[i] = TrackPoint(
+                    Vec2F(box.center.x, box.center.y) + moveDir, 90, Vec2F(box.center.x, box.center.y), blob.color);
+            }
+        });
 
-        // case not even candidates were detected
-        if(addedCodes.empty() && !ignoreWithoutMarker)
+    // merged in the order of the blobs, independent of the scheduling
+    for(std::size_t i = 0; i < blobs.size(); ++i)
+    {
+        std::move(blobOverlays[i].begin(), blobOverlays[i].end(), std::back_inserter(options.overlays));
+        if(refined[i])
         {
-            // set to zero as coordinates are directly used from cropRect
-            crossList.append(TrackPoint(
-                Vec2F(box.center.x, box.center.y) + moveDir, 90, Vec2F(box.center.x, box.center.y), blob.color));
-            continue;
+            crossList.append(*refined[i]);
         }
-
-    } // end for
+    }
 }
 
 /**
@@ -762,85 +964,52 @@ void detail::refineWithAruco(
  * offset is corner of roi.
  *
  * @param img
+ * @param hsv img converted to HSV; img is converted, if it is empty
  * @param crossList
- * @param controlWidget
- * @param ignoreWithoutMarker (is ignored->overwritten by cmWidget->ignoreWithoutDot->isChecked())
+ * @param options the multicolor marker settings are used; options.ignoreWithoutMarker is overwritten by
+ * ignoreWithoutDot of the multicolor marker
  * @param offset
- * @param intrinsicCameraParams needed for aruco-refinement
+ * @param result gets the mask of the last color map and the detected code markers
  */
 void findMultiColorMarker(
-    cv::Mat                     &img,
-    QList<TrackPoint>           &crossList,
-    Control                     *controlWidget,
-    bool                         ignoreWithoutMarker,
-    Vec2F                       &offset,
-    RecognitionMethod            method,
-    CodeMarkerOptions           &codeOpt,
-    const IntrinsicCameraParams &intrinsicCameraParams)
+    const cv::Mat            &img,
+    const cv::Mat            &hsv,
+    QList<TrackPoint>        &crossList,
+    const RecognitionOptions &options,
+    const Vec2F              &offset,
+    RecognitionResult        &result)
 {
-    Petrack                *mainWindow = controlWidget->getMainWindow();
-    MultiColorMarkerItem   *cmItem     = mainWindow->getMultiColorMarkerItem();
-    MultiColorMarkerWidget *cmWidget   = mainWindow->getMultiColorMarkerWidget();
-    int                     bS         = mainWindow->getImageBorderSize();
-
-    RectPlotItem *rectPlotItem = controlWidget->getColorPlot()->getMapItem();
-    bool          useClose     = cmWidget->useClose->isChecked();
-    bool          useOpen      = cmWidget->useOpen->isChecked();
-    int           radiusClose  = cmWidget->closeRadius->value();
-    int           radiusOpen   = cmWidget->openRadius->value();
-    double        dotSize      = cmWidget->dotSize->value();
-    int           minArea = cmWidget->minArea->value(), maxArea = cmWidget->maxArea->value();
-    double        maxRatio         = cmWidget->maxRatio->value();
-    bool          useBlackDot      = cmWidget->useDot->isChecked();
-    bool          useCodeMarker    = cmWidget->useCodeMarker->isChecked();
-    bool          restrictPosition = cmWidget->restrictPosition->isChecked();
-    ignoreWithoutMarker =
-        cmWidget->ignoreWithoutDot->isChecked(); // ueberschreiben von uebergeordnetem ignoreWithoutMarker
-    bool autoCorrect           = cmWidget->autoCorrect->isChecked();
-    bool autoCorrectOnlyExport = cmWidget->autoCorrectOnlyExport->isChecked();
+    TRACE_ZONE("reco::findMultiColorMarker");
+    const MultiColorMarkerSettings &settings = options.multiColorMarker;
 
-    for(int j = 0; j < rectPlotItem->mapNum(); j++)
+    result.mask.create(img.rows, img.cols, CV_8UC1);
+    // converted once for all color maps
+    const cv::Mat hsvImg = toHsv(img, hsv);
+    for(const auto &map : settings.maps)
     {
-        int nr;
-        if(j == controlWidget->getMapNr())
-        {
-            nr = rectPlotItem->mapNum() - 1;
-        }
-        else if(j == rectPlotItem->mapNum() - 1)
-        {
-            nr = controlWidget->getMapNr();
-        }
-        else
-        {
-            nr = j;
-        }
-
         ColorBlobDetectionParams param;
-        param.fromColor   = rectPlotItem->getMap(nr).fromColor();
-        param.toColor     = rectPlotItem->getMap(nr).toColor();
-        param.invHue      = rectPlotItem->getMap(nr).invHue();
-        param.minArea     = minArea;
-        param.maxArea     = maxArea;
-        param.maxRatio    = maxRatio;
-        param.useClose    = useClose;
-        param.radiusClose = radiusClose;
-        param.useOpen     = useOpen;
-        param.radiusOpen  = radiusOpen;
+        param.fromColor   = map.fromColor;
+        param.toColor     = map.toColor;
+        param.invHue      = map.invHue;
+        param.minArea     = settings.minArea;
+        param.maxArea     = settings.maxArea;
+        param.maxRatio    = settings.maxRatio;
+        param.useClose    = settings.useClose;
+        param.radiusClose = settings.radiusClose;
+        param.useOpen     = settings.useOpen;
+        param.radiusOpen  = settings.radiusOpen;
         param.offset      = offset;
         param.img         = img;
-        param.binary      = cmItem->createMask(img.cols, img.rows);
+        param.hsv         = hsvImg;
+        param.binary      = result.mask;
 
         auto blobs = findColorBlob(param);
 
 
-        if(useBlackDot)
+        if(settings.useBlackDot)
         {
             ColorParameters colParam;
-            setColorParameter(
-                rectPlotItem->getMap(nr).fromColor(),
-                rectPlotItem->getMap(nr).toColor(),
-                rectPlotItem->getMap(nr).invHue(),
-                colParam);
+            setColorParameter(map.fromColor, map.toColor, map.invHue, colParam);
             // zentralen farbton heraussuchen
             QColor midHue;
             if(colParam.inversHue)
@@ -852,36 +1021,42 @@ void findMultiColorMarker(
                 midHue.setHsv(2 * (colParam.h_low + (colParam.h_high - colParam.h_low) / 2), 255, 255);
             }
 
-            BlackDotOptions options;
-            options.ignoreWithoutMarker   = ignoreWithoutMarker;
-            options.autoCorrect           = autoCorrect;
-            options.autoCorrectOnlyExport = autoCorrectOnlyExport;
-            options.restrictPosition      = restrictPosition;
-            options.borderSize            = bS;
-            options.midHue                = midHue;
-            options.dotSize               = dotSize;
-            options.controlWidget         = controlWidget;
-            options.worldImageCorr        = &mainWindow->getWorldImageCorrespondence();
+            BlackDotOptions dotOptions;
+            dotOptions.ignoreWithoutMarker   = settings.ignoreWithoutDot;
+            dotOptions.autoCorrect           = settings.autoCorrect;
+            dotOptions.autoCorrectOnlyExport = settings.autoCorrectOnlyExport;
+            dotOptions.restrictPosition      = settings.restrictPosition;
+            dotOptions.borderSize            = options.borderSize;
+            dotOptions.midHue                = midHue;
+            dotOptions.dotSize               = settings.dotSize;
+            dotOptions.defaultHeight         = options.defaultHeight;
+            dotOptions.perspective           = options.perspective;
 
             // adds to crosslist
-            refineWithBlackDot(blobs, img, crossList, options);
+            refineWithBlackDot(blobs, img, crossList, dotOptions);
         }
-        else if(useCodeMarker)
+        else if(settings.useCodeMarker)
         {
-            ArucoOptions options{
-                controlWidget, ignoreWithoutMarker, autoCorrect, autoCorrectOnlyExport, method, codeOpt};
+            ArucoOptions arucoOptions{
+                options.perspective,
+                settings.ignoreWithoutDot,
+                settings.autoCorrect,
+                settings.autoCorrectOnlyExport,
+                options.method,
+                options.codeMarker,
+                result.codeMarkers};
 
             // adds to crosslist
-            refineWithAruco(blobs, img, crossList, options, intrinsicCameraParams);
+            refineWithAruco(blobs, img, crossList, arucoOptions, options.intrinsicCameraParams);
         }
         else
         {
             Vec2F moveDir;
             for(ColorBlob &blob : blobs)
             {
-                if(autoCorrect && !autoCorrectOnlyExport)
+                if(settings.autoCorrect && !settings.autoCorrectOnlyExport)
                 {
-                    moveDir = autoCorrectColorMarker(blob.imageCenter, controlWidget);
+                    moveDir = autoCorrectColorMarker(blob.imageCenter, options.perspective);
 
                     crossList.append(TrackPoint(
                         Vec2F(blob.box.center.x, blob.box.center.y) + moveDir,
@@ -909,67 +1084,45 @@ void findMultiColorMarker(
  * The features are the center of gravity of each connected component.
  *
  * @param img
+ * @param hsv img converted to HSV; img is converted, if it is empty
  * @param crossList
- * @param controlWidget
+ * @param settings parameters of the ColorMarkerWidget
+ * @param binary gets the mask of the color
  */
-void findColorMarker(cv::Mat &img, QList<TrackPoint> &crossList, Control *controlWidget)
+void findColorMarker(
+    const cv::Mat             &img,
+    const cv::Mat             &hsv,
+    QList<TrackPoint>         &crossList,
+    const ColorMarkerSettings &settings,
+    cv::Mat                   &binary)
 {
-    ColorParameters    param;
-    ColorMarkerItem   *cmItem   = controlWidget->getMainWindow()->getColorMarkerItem();
-    ColorMarkerWidget *cmWidget = controlWidget->getMainWindow()->getColorMarkerWidget();
-
-    QColor fromColor = cmWidget->fromColor->palette().color(QPalette::Button);
-    QColor toColor   = cmWidget->toColor->palette().color(QPalette::Button);
-
-    setColorParameter(fromColor, toColor, cmWidget->inversHue->isChecked(), param);
+    TRACE_ZONE("reco::findColorMarker");
+    ColorParameters param;
+    setColorParameter(settings.range.fromColor, settings.range.toColor, settings.range.invHue, param);
 
     // run detection
-    cv::Mat binary;
-
-    // erzeuge speicherplatz fuer mask
-    // abfrage wird in createMask gemacht
-    // if (cmItem->getMask() == NULL || (cmItem->getMask() != NULL && (cmItem->getMask()->width != img->width ||
-    // cmItem->getMask()->height != img->height)))
-    binary = cmItem->createMask(img.cols, img.rows); // erzeugt binary mask mit groesse von img
+    binary.create(img.rows, img.cols, CV_8UC1); // erzeugt binary mask mit groesse von img
 
     // color thresholding
-    thresholdHSV(img, binary, param);
+    thresholdHSV(toHsv(img, hsv), binary, param);
 
     // close small holes: radius ( hole ) < radius ( close )
-    if(cmWidget->useClose->isChecked())
+    if(settings.useClose)
     {
-        int radius_close = cmWidget->closeRadius->value();
-        // siehe : http://opencv.willowgarage.com/documentation/c/image_filtering.html#createstructuringelementex
-        cv::morphologyEx(
-            binary,
-            binary,
-            cv::MORPH_OPEN,
-            getStructuringElement(
-                cv::MORPH_ELLIPSE,
-                cv::Size(2 * radius_close + 1, 2 * radius_close + 1),
-                cv::Point(radius_close, radius_close)));
+        detail::morphologyDisk(binary, cv::MORPH_OPEN, settings.radiusClose);
     }
     // remove small blobs: radius ( blob ) < radius ( open )
-    if(cmWidget->useOpen->isChecked())
+    if(settings.useOpen)
     {
-        int radius_open = cmWidget->openRadius->value();
-        cv::morphologyEx(
-            binary,
-            binary,
-            cv::MORPH_CLOSE,
-            getStructuringElement(
-                cv::MORPH_ELLIPSE, cv::Size(2 * radius_open + 1, 2 * radius_open + 1), cv::Point(radius_open)));
+        detail::morphologyDisk(binary, cv::MORPH_CLOSE, settings.radiusOpen);
     }
-    std::vector<std::vector<cv::Point>> contours;
-    double                              area;
-    QColor                              col;
-    cv::RotatedRect                     box;
-    double                              ratio;
-    bool                                atEdge;
-
-    cv::Mat clone = binary.clone(); //(cvarrToMat(binary),true);
+    double          area;
+    QColor          col;
+    cv::RotatedRect box;
+    double          ratio;
 
-    cv::findContours(clone, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    // blobs at the edge of the ROI are dropped, as their center moves while they leave it
+    std::vector<std::vector<cv::Point>> contours = detail::findBlobContours(binary, settings.minArea);
 
     // test each contour
     while(!contours.empty())
@@ -987,19 +1140,7 @@ void findColorMarker(cv::Mat &img, QList<TrackPoint> &crossList, Control *contro
             ratio = box.size.width / box.size.height;
         }
 
-        // contour at border of roi, than neglect because of object going out of region has moving center
-        atEdge = false;
-        for(size_t i = 0; i < contour.size(); i++)
-        {
-            if((contour.at(i).x <= 1) || (contour.at(i).x >= img.cols - 2) || (contour.at(i).y <= 1) ||
-               (contour.at(i).y >= img.rows - 2))
-            {
-                atEdge = true;
-            }
-        }
-
-        if(!atEdge && area >= cmWidget->minArea->value() && area <= cmWidget->maxArea->value() &&
-           ratio <= cmWidget->maxRatio->value())
+        if(area >= settings.minArea && area <= settings.maxArea && ratio <= settings.maxRatio)
         {
             // eine mittelung waere ggf sinnvoll, aber am rand aufpassen
             col.setRgb(getValue(img, myRound(box.center.x), myRound(box.center.y)).rgb());
@@ -1014,13 +1155,15 @@ void findColorMarker(cv::Mat &img, QList<TrackPoint> &crossList, Control *contro
 
 
 /**
- * @brief Estimates the pose of detected ArUco markers using the default solvePnP method.
+ * @brief Estimates the pose of detected ArUco markers using solvePnP with SOLVEPNP_IPPE_SQUARE.
  *
  * This function mimics the old `cv::aruco::estimatePoseSingleMarkers` method.
  * It calculates the rotation and translation vectors (pose) of each detected marker
  * given their 2D corner points in the image and the known 3D geometry of the markers.
  *
- * The method uses the `cv::solvePnP` function to estimate the pose of each marker.
+ * The markers are solved in parallel with the `cv::solvePnP` function; IPPE_SQUARE is
+ * the dedicated (and fast) solver for square markers. The model of the marker is built
+ * once for all markers. If the pose of a marker cannot be estimated, its vectors are zero.
  *
  * @param corners           A vector of vectors, where each inner vector contains
  *                          the 2D corner points of a detected marker in image coordinates.
@@ -1047,39 +1190,59 @@ void detail::estimatePoseSingleMarkers(
     std::vector<cv::Vec3d>                      &rotationVectors,
     std::vector<cv::Vec3d>                      &translationVectors)
 {
-    // Define the 3D points of a single square marker
-    std::vector<cv::Point3f> markerPoints = {
+    // 3D points of a single square marker, in the order required by SOLVEPNP_IPPE_SQUARE
+    const std::vector<cv::Point3f> markerPoints = {
         {-markerLength / 2.0f, markerLength / 2.0f, 0}, // Top-left
         {markerLength / 2.0f, markerLength / 2.0f, 0},  // Top-right
         {markerLength / 2.0f, -markerLength / 2.0f, 0}, // Bottom-right
         {-markerLength / 2.0f, -markerLength / 2.0f, 0} // Bottom-left
     };
 
-    // Clear the output vectors
-    rotationVectors.clear();
-    translationVectors.clear();
-
-    // Iterate over each detected marker
-    for(size_t i = 0; i < corners.size(); ++i)
-    {
-        cv::Vec3d rvec, tvec; // Variables to store rotation and translation vectors
-
-        bool success = cv::solvePnP(markerPoints, corners[i], cameraMatrix, distCoeff, rvec, tvec, false);
+    // one entry per marker, so the vectors stay aligned with corners
+    rotationVectors.assign(corners.size(), cv::Vec3d());
+    translationVectors.assign(corners.size(), cv::Vec3d());
 
-        if(success)
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(corners.size())),
+        [&](const cv::Range &range)
         {
-            // Append the rotation and translation vectors
-            rotationVectors.push_back(rvec);
-            translationVectors.push_back(tvec);
-        }
-    }
+            for(int i = range.start; i < range.end; ++i)
+            {
+                cv::Vec3d rvec, tvec; // Variables to store rotation and translation vectors
+                if(cv::solvePnP(
+                       markerPoints, corners[i], cameraMatrix, distCoeff, rvec, tvec, false, cv::SOLVEPNP_IPPE_SQUARE))
+                {
+                    rotationVectors[i]    = rvec;
+                    translationVectors[i] = tvec;
+                }
+            }
+        });
+}
+
+namespace
+{
+/// Only reached with -DAPRILTAG=ON, as CodeMarkerOptions does not build an AprilTagDetector otherwise
+void detectWithAprilTag(
+    [[maybe_unused]] const AprilTagDetector                &detector,
+    [[maybe_unused]] const cv::Mat                         &img,
+    [[maybe_unused]] double                                 minMarkerPerimeterRate,
+    [[maybe_unused]] double                                 maxMarkerPerimeterRate,
+    [[maybe_unused]] std::vector<std::vector<cv::Point2f>> &corners,
+    [[maybe_unused]] std::vector<int>                      &ids)
+{
+#ifdef APRILTAG
+    detector.detect(img, minMarkerPerimeterRate, maxMarkerPerimeterRate, corners, ids);
+#endif
 }
+} // namespace
 
 /**
  * @brief uses OpenCV libraries to detect Aruco CodeMarkers
  * @param img image to find codes in
  * @param opt arucomarker parameters used for detection
  * @param intrinsicCameraParams used for estimating arucomarker orientation
+ * @param overlays gets the detected and rejected codes for drawing
+ * @param offsetCropRect2Roi offset of img to the recognition ROI, needed for drawing the codes
  * @param appendRejectedCodes append trackpoints of rejected codes to the list of detected codes.
  *          OpenCV returns rejected code candidates. These are often the correct codes, but the information is
  *          unreadable. If this flag is set to true, these rejected candidates get added as trackpoint
@@ -1088,114 +1251,109 @@ void detail::estimatePoseSingleMarkers(
  * @return list of all detected codes in given image
  */
 QList<TrackPoint> detail::findCodeMarker(
-    cv::Mat                     &img,
-    RecognitionMethod            recoMethod,
-    const CodeMarkerOptions     &opt,
-    const IntrinsicCameraParams &intrinsicCameraParams,
-    bool                         appendRejectedCodes)
+    const cv::Mat                  &img,
+    RecognitionMethod               recoMethod,
+    const CodeMarkerSettings       &opt,
+    const IntrinsicCameraParams    &intrinsicCameraParams,
+    std::vector<CodeMarkerOverlay> &overlays,
+    Vec2F                           offsetCropRect2Roi,
+    bool                            appendRejectedCodes)
 {
-    CodeMarkerItem *codeMarkerItem = opt.getCodeMarkerItem();
-    Control        *controlWidget  = opt.getControlWidget();
-    const auto     &parameters     = opt.getDetectorParams();
-
-    auto dictionary =
-        (opt.getIndexOfMarkerDict() != 17) ?
-            cv::aruco::getPredefinedDictionary(cv::aruco::PredefinedDictionaryType(opt.getIndexOfMarkerDict())) :
-            detail::getDictMip36h12(); // for usage of DICT_mip_36h12 as it is not predifined in opencv
+    TRACE_ZONE("reco::findCodeMarker");
+    const auto &parameters = opt.detectorParams;
 
     double minMarkerPerimeterRate = std::numeric_limits<double>::quiet_NaN();
     double maxMarkerPerimeterRate = std::numeric_limits<double>::quiet_NaN();
-    double minCornerDistanceRate  = parameters.getMinCornerDistance();
-    double minMarkerDistanceRate  = parameters.getMinMarkerDistance();
-
-    Petrack *mainWindow = controlWidget->getMainWindow();
-
-    int borderSize = mainWindow->getImageBorderSize();
 
     // 3D - Case
-    if(controlWidget->getCalibCoordDimension() == 0)
+    if(opt.calibration3D)
     {
-        QRect rect(
-            myRound(mainWindow->getRecoRoiItem()->rect().x()),
-            myRound(mainWindow->getRecoRoiItem()->rect().y()),
-            myRound(mainWindow->getRecoRoiItem()->rect().width()),
-            myRound(mainWindow->getRecoRoiItem()->rect().height()));
-        QPointF p1 = mainWindow->getWorldImageCorrespondence().getCmPerPixel(
-            rect.x(), rect.y(), controlWidget->getDefaultHeight());
-        QPointF p2 = mainWindow->getWorldImageCorrespondence().getCmPerPixel(
-            rect.x() + rect.width(), rect.y(), controlWidget->getDefaultHeight());
-        QPointF p3 = mainWindow->getWorldImageCorrespondence().getCmPerPixel(
-            rect.x(), rect.y() + rect.height(), controlWidget->getDefaultHeight());
-        QPointF p4 = mainWindow->getWorldImageCorrespondence().getCmPerPixel(
-            rect.x() + rect.width(), rect.y() + rect.height(), controlWidget->getDefaultHeight());
-
-        double cmPerPixelMin = std::min({p1.x(), p1.y(), p2.x(), p2.y(), p3.x(), p3.y(), p4.x(), p4.y()});
-        double cmPerPixelMax = std::max({p1.x(), p1.y(), p2.x(), p2.y(), p3.x(), p3.y(), p4.x(), p4.y()});
-
         if(recoMethod ==
            RecognitionMethod::Code) // for usage of codemarker with CodeMarker-function (-> without MulticolorMarker)
         {
-            minMarkerPerimeterRate =
-                (parameters.getMinMarkerPerimeter() * 4. / cmPerPixelMax) / std::max(rect.width(), rect.height());
-            maxMarkerPerimeterRate =
-                (parameters.getMaxMarkerPerimeter() * 4. / cmPerPixelMin) / std::max(rect.width(), rect.height());
+            minMarkerPerimeterRate = (parameters.getMinMarkerPerimeter() * 4. / opt.cmPerPixelMax) / opt.roiLength;
+            maxMarkerPerimeterRate = (parameters.getMaxMarkerPerimeter() * 4. / opt.cmPerPixelMin) / opt.roiLength;
         }
         else if(recoMethod == RecognitionMethod::MultiColor) // for usage of codemarker with MulticolorMarker
         {
             minMarkerPerimeterRate =
-                (parameters.getMinMarkerPerimeter() * 4. / cmPerPixelMax) / std::max(img.cols, img.rows);
+                (parameters.getMinMarkerPerimeter() * 4. / opt.cmPerPixelMax) / std::max(img.cols, img.rows);
             maxMarkerPerimeterRate =
-                (parameters.getMaxMarkerPerimeter() * 4. / cmPerPixelMin) / std::max(img.cols, img.rows);
+                (parameters.getMaxMarkerPerimeter() * 4. / opt.cmPerPixelMin) / std::max(img.cols, img.rows);
         }
     }
     else // 2D
     {
-        double cmPerPixel = mainWindow->getWorldImageCorrespondence().getCmPerPixel();
-        minMarkerPerimeterRate =
-            (parameters.getMinMarkerPerimeter() * 4 / cmPerPixel) /
-            std::max(mainWindow->getImage()->width() - borderSize, mainWindow->getImage()->height() - borderSize);
-        maxMarkerPerimeterRate =
-            (parameters.getMaxMarkerPerimeter() * 4 / cmPerPixel) /
-            std::max(mainWindow->getImage()->width() - borderSize, mainWindow->getImage()->height() - borderSize);
-    }
-
-    cv::aruco::DetectorParameters detectorParams;
-
-    detectorParams.adaptiveThreshWinSizeMin    = parameters.getAdaptiveThreshWinSizeMin();
-    detectorParams.adaptiveThreshWinSizeMax    = parameters.getAdaptiveThreshWinSizeMax();
-    detectorParams.adaptiveThreshWinSizeStep   = parameters.getAdaptiveThreshWinSizeStep();
-    detectorParams.adaptiveThreshConstant      = parameters.getAdaptiveThreshConstant();
-    detectorParams.minMarkerPerimeterRate      = minMarkerPerimeterRate;
-    detectorParams.maxMarkerPerimeterRate      = maxMarkerPerimeterRate;
-    detectorParams.polygonalApproxAccuracyRate = parameters.getPolygonalApproxAccuracyRate();
-    detectorParams.minCornerDistanceRate       = minCornerDistanceRate;
-    detectorParams.minDistanceToBorder         = parameters.getMinDistanceToBorder();
-    detectorParams.minMarkerDistanceRate       = minMarkerDistanceRate;
-    // No refinement is default value
-    // TODO Check if this is the best method for our usecase
-    if(parameters.getDoCornerRefinement())
-    {
-        detectorParams.cornerRefinementMethod = cv::aruco::CornerRefineMethod::CORNER_REFINE_SUBPIX;
+        // the scale is the same everywhere
+        minMarkerPerimeterRate = (parameters.getMinMarkerPerimeter() * 4 / opt.cmPerPixelMin) / opt.imageLength;
+        maxMarkerPerimeterRate = (parameters.getMaxMarkerPerimeter() * 4 / opt.cmPerPixelMin) / opt.imageLength;
     }
-    detectorParams.cornerRefinementWinSize               = parameters.getCornerRefinementWinSize();
-    detectorParams.cornerRefinementMaxIterations         = parameters.getCornerRefinementMaxIterations();
-    detectorParams.cornerRefinementMinAccuracy           = parameters.getCornerRefinementMinAccuracy();
-    detectorParams.markerBorderBits                      = parameters.getMarkerBorderBits();
-    detectorParams.perspectiveRemovePixelPerCell         = parameters.getPerspectiveRemovePixelPerCell();
-    detectorParams.perspectiveRemoveIgnoredMarginPerCell = parameters.getPerspectiveRemoveIgnoredMarginPerCell();
-    detectorParams.maxErroneousBitsInBorderRate          = parameters.getMaxErroneousBitsInBorderRate();
-    detectorParams.minOtsuStdDev                         = parameters.getMinOtsuStdDev();
-    detectorParams.errorCorrectionRate                   = parameters.getErrorCorrectionRate();
 
     std::vector<int>                      ids;
     std::vector<std::vector<cv::Point2f>> corners;
     std::vector<std::vector<cv::Point2f>> rejected;
 
-    const cv::aruco::ArucoDetector arucoDetector(dictionary, detectorParams);
-    arucoDetector.detectMarkers(img, corners, ids, rejected);
+    // the perimeter rates are relative to the size of the image, so they stay valid for the enlarged image
+    cv::Mat detectionImg = img;
+    if(opt.upscale > 1)
+    {
+        cv::resize(img, detectionImg, cv::Size(), opt.upscale, opt.upscale, cv::INTER_CUBIC);
+    }
+
+    const auto detectors =
+        opt.detectors ? opt.detectors : std::make_shared<ArucoDetectorCache>(parameters, opt.indexOfMarkerDict);
+    if(opt.aprilTag)
+    {
+        detectWithAprilTag(*opt.aprilTag, detectionImg, minMarkerPerimeterRate, maxMarkerPerimeterRate, corners, ids);
+    }
+    else if(parameters.getQuadDecimate() > 1)
+    {
+        detail::detectMarkersDecimated(
+            detectionImg,
+            *detectors,
+            parameters.getQuadDecimate(),
+            opt.tileSize,
+            minMarkerPerimeterRate,
+            maxMarkerPerimeterRate,
+            corners,
+            ids,
+            rejected);
+    }
+    else if(opt.tileSize > 0 && std::max(detectionImg.cols, detectionImg.rows) > opt.tileSize)
+    {
+        detail::detectMarkersTiled(
+            detectionImg,
+            *detectors,
+            opt.tileSize,
+            minMarkerPerimeterRate,
+            maxMarkerPerimeterRate,
+            corners,
+            ids,
+            rejected);
+    }
+    else
+    {
+        detectors->get(minMarkerPerimeterRate, maxMarkerPerimeterRate)
+            ->detectMarkers(detectionImg, corners, ids, rejected);
+    }
+    detail::identifyExtraMarkers(detectionImg, *detectors, corners, ids, rejected);
+
+    if(opt.upscale > 1)
+    {
+        const float scale = 1.f / static_cast<float>(opt.upscale);
+        for(auto *markers : {&corners, &rejected})
+        {
+            for(auto &marker : *markers)
+            {
+                for(auto &corner : marker)
+                {
+                    corner *= scale;
+                }
+            }
+        }
+    }
 
-    codeMarkerItem->addDetectedMarkers(corners, ids, opt.getOffsetCropRect2Roi());
-    codeMarkerItem->addRejectedMarkers(rejected, opt.getOffsetCropRect2Roi());
+    overlays.push_back({corners, ids, rejected, offsetCropRect2Roi});
 
     if(appendRejectedCodes && !rejected.empty())
     {
@@ -1209,14 +1367,17 @@ QList<TrackPoint> detail::findCodeMarker(
         return {};
     }
 
-    // value only relevant for axis length when drawing axes
-    float                  markerLength = (float) opt.getDetectorParams().getMinCornerDistance();
     std::vector<cv::Vec3d> rotationVectors;
     std::vector<cv::Vec3d> translationVectors;
-    const cv::Mat         &cameraMatrix = intrinsicCameraParams.cameraMatrix;
-    const cv::Mat         &distCoeff    = cv::Mat::zeros(cv::Size(1, 5), CV_32F);
-    detail::estimatePoseSingleMarkers(
-        corners, markerLength, cameraMatrix, distCoeff, rotationVectors, translationVectors);
+    if(opt.estimateOrientation)
+    {
+        // value only relevant for axis length when drawing axes
+        float          markerLength = (float) parameters.getMinCornerDistance();
+        const cv::Mat &cameraMatrix = intrinsicCameraParams.cameraMatrix;
+        const cv::Mat &distCoeff    = cv::Mat::zeros(cv::Size(1, 5), CV_32F);
+        detail::estimatePoseSingleMarkers(
+            corners, markerLength, cameraMatrix, distCoeff, rotationVectors, translationVectors);
+    }
 
     // store all detected codes as TrackPoints in a list to return
     QList<TrackPoint> trackPoints;
@@ -1230,12 +1391,6 @@ QList<TrackPoint> detail::findCodeMarker(
         double codeX = (codeCorners.at(0).x + codeCorners.at(1).x + codeCorners.at(2).x + codeCorners.at(3).x) / 4.;
         double codeY = (codeCorners.at(0).y + codeCorners.at(1).y + codeCorners.at(2).y + codeCorners.at(3).y) / 4.;
 
-        cv::Matx<double, 3, 3> rotMat;
-        cv::Rodrigues(rotationVectors[i], rotMat);
-
-        cv::Vec3d orientation = cv::normalize(rotMat * cv::Vec3d(0, 1, 0));
-
-
         // use best quality for code markers, even for candidates
         TrackPoint trackPoint(Vec2F(codeX, codeY), TrackPoint::bestDetectionQual);
 
@@ -1245,7 +1400,16 @@ QList<TrackPoint> detail::findCodeMarker(
             // code marker should have the best possible quality i.e. 100
             trackPoint.setMarkerID(ids.at(i));
         }
-        trackPoint.setOrientation(orientation);
+
+        // a failed pose estimation leaves the translation at the camera center
+        if(i < translationVectors.size() && translationVectors[i] != cv::Vec3d())
+        {
+            cv::Matx<double, 3, 3> rotMat;
+            cv::Rodrigues(rotationVectors[i], rotMat);
+
+            cv::Vec3d orientation = cv::normalize(rotMat * cv::Vec3d(0, 1, 0));
+            trackPoint.setOrientation(orientation);
+        }
 
         trackPoints.append(trackPoint);
     }
@@ -1253,7 +1417,7 @@ QList<TrackPoint> detail::findCodeMarker(
 }
 
 void findContourMarker(
-    cv::Mat           &img,
+    const cv::Mat     &img,
     QList<TrackPoint> *crossList,
     int                markerBrightness,
     bool               ignoreWithoutMarker,
@@ -1261,77 +1425,80 @@ void findContourMarker(
     RecognitionMethod  recoMethod,
     float              headSize)
 {
-    int                                 threshold, plus;
-    size_t                              count;
-    double                              angle;
-    MarkerHermesList                    markerHermesList;
-    MarkerCasernList                    markerCasernList;
-    MarkerJapanList                     markerJapanList(headSize);
-    cv::Size                            sz   = cv::Size(img.cols & -2, img.rows & -2);
-    cv::Mat                             gray = cv::Mat(sz, CV_8UC1);
-    cv::Mat                             tgray;
-    cv::Mat                             grayFix;
-    std::vector<std::vector<cv::Point>> contours;
-
-    cv::RotatedRect box;
-    int             expansion;
-    double          contourArea;
+    TRACE_ZONE("reco::findContourMarker");
+    MarkerHermesList markerHermesList;
+    MarkerCasernList markerCasernList;
+    MarkerJapanList  markerJapanList(headSize);
+    cv::Size         sz = cv::Size(img.cols & -2, img.rows & -2);
+    cv::Mat          tgray;
 
     if(img.channels() == 3)
     {
         tgray = cv::Mat(sz, CV_8UC1); // cvCreateImage(sz, 8, 1);
         cv::cvtColor(img, tgray, cv::COLOR_RGB2GRAY);
     }
+    else if(img.channels() == 1)
+    {
+        tgray = img;
+    }
+    else
+    {
+        SPDLOG_ERROR("wrong number of channels: {}", img.channels());
+        return;
+    }
+
     // try several threshold levels
-    plus = (250 - 72) / 10;
     // andere richtung der schwellwertanpassung koennte andere ergebnisse leifern
     // cw->markerBrightness->value()==markerBrightness hat default 50
-    for(threshold = 60 + markerBrightness; threshold < 251; threshold += plus) // 70..255, 20 //155+cw->temp2->value()
+    const int        plus = (250 - 72) / 10;
+    std::vector<int> thresholds;
+    for(int threshold = 60 + markerBrightness; threshold < 251; threshold += plus) // 70..255, 20
     {
-        if(img.channels() == 3)
-        {
-            cv::threshold(tgray, gray, threshold, 255, cv::THRESH_BINARY);
-        }
-        else if(img.channels() == 1)
-        {
-            cv::threshold(
-                img,
-                gray,
-                threshold,
-                255,
-                cv::THRESH_BINARY); // cvThreshold(img, gray, threshold, 255, CV_THRESH_BINARY);
-        }
-        else
-        {
-            SPDLOG_ERROR("wrong number of channels: {}", img.channels());
-        }
-        grayFix = gray.clone();
-
+        thresholds.push_back(threshold);
+    }
 
-        // find contours and store them all as a list
-        findContours(gray, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
+    struct ThresholdLevel
+    {
+        cv::Mat                                 grayFix;  ///< binary image the ellipses were found in
+        std::vector<std::pair<MyEllipse, bool>> ellipses; ///< fitted ellipses and if they are black inside
+    };
+    std::vector<ThresholdLevel> levels(thresholds.size());
 
-        // test each contour
-        while(!contours.empty())
+    // the levels are independent; only adding the ellipses to the marker lists depends on their order
+    runInParallel(
+        thresholds.size(),
+        [&](std::size_t level)
         {
-            std::vector<cv::Point> contour = contours.back();
-            // koennten auch interessant sein:
-            // MinAreaRect2
-            // MinEnclosingCircle
-            //  um kreise zu suchen koennte auch cvHoughCircles genutzt werden
+            cv::Mat gray;
+            cv::threshold(tgray, gray, thresholds[level], 255, cv::THRESH_BINARY);
+            ThresholdLevel &result = levels[level];
+            result.grayFix         = gray.clone();
 
-            count = contour.size();
-
-            // man koennte das Seitenverhaeltnis, contour-gesamtlaenge vorher ueberpruefen, um cont rauszuwerfen
+            // find contours and store them all as a list
+            std::vector<std::vector<cv::Point>> contours;
+            cv::findContours(gray, contours, cv::RETR_LIST, cv::CHAIN_APPROX_SIMPLE);
 
-            if(count > 5)
+            // test each contour, beginning with the last one
+            for(auto it = contours.rbegin(); it != contours.rend(); ++it)
             {
+                const std::vector<cv::Point> &contour = *it;
+                // koennten auch interessant sein:
+                // MinAreaRect2
+                // MinEnclosingCircle
+                //  um kreise zu suchen koennte auch cvHoughCircles genutzt werden
+
+                // man koennte das Seitenverhaeltnis, contour-gesamtlaenge vorher ueberpruefen, um cont rauszuwerfen
+                if(contour.size() <= 5)
+                {
+                    continue;
+                }
+
                 // Fits ellipse to current contour.
                 cv::Mat pointsf;
                 cv::Mat(contour).convertTo(pointsf, CV_32F);
-                box = fitEllipse(pointsf);
+                const cv::RotatedRect box = cv::fitEllipse(pointsf);
 
-                expansion =
+                const int expansion =
                     box.size.width > box.size.height ? myRound(box.size.width * 0.5) : myRound(box.size.height * 0.5);
 
                 if(box.center.x - expansion > ELLIPSE_DISTANCE_TO_BORDER &&
@@ -1339,32 +1506,40 @@ void findContourMarker(
                    box.center.y - expansion > ELLIPSE_DISTANCE_TO_BORDER &&
                    box.center.y + expansion < gray.rows - ELLIPSE_DISTANCE_TO_BORDER)
                 {
-                    angle = (box.angle) / 180. * PI;
+                    double angle = (box.angle) / 180. * PI;
                     if(box.size.width < box.size.height)
                     {
                         angle -= PI / 2;
                     }
 
-                    contourArea = cv::contourArea(contour, true);
+                    const double contourArea = cv::contourArea(contour, true);
 
-                    // contourArea koennte mit MyEllipse.area() verglichen werden und bei grossen abweichungen verworfen
-                    // werden!!!
-                    MyEllipse e(box.center.x, box.center.y, box.size.width * 0.5, box.size.height * 0.5, angle);
-                    if(recoMethod == RecognitionMethod::Casern)
-                    {
-                        markerCasernList.mayAddEllipse(grayFix, e, (contourArea > 0));
-                    }
-                    else if(recoMethod == RecognitionMethod::Hermes)
-                    {
-                        markerHermesList.mayAddEllipse(grayFix, e, (contourArea > 0));
-                    }
-                    else if(recoMethod == RecognitionMethod::Japan)
-                    {
-                        markerJapanList.mayAddEllipse(grayFix, e, (contourArea > 0));
-                    }
+                    // contourArea koennte mit MyEllipse.area() verglichen werden und bei grossen abweichungen
+                    // verworfen werden!!!
+                    result.ellipses.emplace_back(
+                        MyEllipse(box.center.x, box.center.y, box.size.width * 0.5, box.size.height * 0.5, angle),
+                        contourArea > 0);
                 }
             }
-            contours.pop_back();
+        });
+
+    // merged in the same order as if the levels were processed one after another
+    for(const auto &level : levels)
+    {
+        for(const auto &[e, blackInside] : level.ellipses)
+        {
+            if(recoMethod == RecognitionMethod::Casern)
+            {
+                markerCasernList.mayAddEllipse(level.grayFix, e, blackInside);
+            }
+            else if(recoMethod == RecognitionMethod::Hermes)
+            {
+                markerHermesList.mayAddEllipse(level.grayFix, e, blackInside);
+            }
+            else if(recoMethod == RecognitionMethod::Japan)
+            {
+                markerJapanList.mayAddEllipse(level.grayFix, e, blackInside);
+            }
         }
     }
     if(recoMethod == RecognitionMethod::Casern) // Casern
@@ -1384,66 +1559,361 @@ void findContourMarker(
     }
 }
 
+/**
+ * @brief Detects heads without markers with the network of settings
+ *
+ * The quality of a detection is its score, scaled to the quality of color markers.
+ *
+ * @param img image to find heads in
+ * @param settings detector and minimal score
+ * @return centers of the detected heads; empty if no model is loaded
+ */
+QList<TrackPoint> findHeads(const cv::Mat &img, const HeadDetectorSettings &settings)
+{
+    TRACE_ZONE("reco::findHeads");
+    if(!settings.detector)
+    {
+        SPDLOG_WARN("No model for the head detection is loaded.");
+        return {};
+    }
+
+    QList<TrackPoint> crossList;
+    for(const auto &head : settings.detector->detect(img, static_cast<float>(settings.minScore)))
+    {
+        const Vec2F center(head.box.x + head.box.width / 2., head.box.y + head.box.height / 2.);
+        crossList.append(TrackPoint(center, myRound(90 * head.score)));
+    }
+    return crossList;
+}
 
 /**
- * @brief Detects position of markers from user-chosen type
+ * @brief Takes a snapshot of all parameters of the recognition from the widgets
+ *
+ * Has to be called on the GUI thread; the returned options can be used by
+ * findMarkers() on any thread.
  *
- * @param img
- * @param roi Region of interest for recognition
  * @param controlWidget
+ * @param roi Region of interest for recognition
  * @param borderSize
- * @param bgFilter
  * @param intrinsicCameraParams intrinsic parameters of the camera. Used for e.g. estimation of arucomarkers
- *
- * @return List of detected TrackPoints
  */
-QList<TrackPoint> Recognizer::getMarkerPos(
-    cv::Mat                     &img,
-    QRect                       &roi,
+RecognitionOptions Recognizer::getOptions(
     Control                     *controlWidget,
+    const QRect                 &roi,
     int                          borderSize,
-    BackgroundFilter            *bgFilter,
-    const IntrinsicCameraParams &intrinsicCameraParams)
+    const IntrinsicCameraParams &intrinsicCameraParams) const
 {
-    int  markerBrightness    = controlWidget->getMarkerBrightness();
-    bool ignoreWithoutMarker = controlWidget->isMarkerIgnoreWithoutChecked();
-    bool autoWB              = controlWidget->isRecoAutoWBChecked();
+    Petrack *mainWindow = controlWidget->getMainWindow();
 
-    auto rect = qRectToCvRect(
-        roi,
+    RecognitionOptions options;
+    options.method                = mRecoMethod;
+    options.roi                   = roi;
+    options.borderSize            = borderSize;
+    options.headSize              = mainWindow->getHeadSize();
+    options.defaultHeight         = controlWidget->getDefaultHeight();
+    options.markerBrightness      = controlWidget->getMarkerBrightness();
+    options.ignoreWithoutMarker   = controlWidget->isMarkerIgnoreWithoutChecked();
+    options.autoWB                = controlWidget->isRecoAutoWBChecked();
+    options.perspective           = getPerspectiveCorrection(controlWidget);
+    options.intrinsicCameraParams = intrinsicCameraParams;
+
+    ColorMarkerWidget   *cmWidget = mainWindow->getColorMarkerWidget();
+    ColorMarkerSettings &color    = options.colorMarker;
+    color.range       = {cmWidget->fromColor->palette().color(QPalette::Button),
+                         cmWidget->toColor->palette().color(QPalette::Button),
+                         cmWidget->inversHue->isChecked()};
+    color.useOpen     = cmWidget->useOpen->isChecked();
+    color.useClose    = cmWidget->useClose->isChecked();
+    color.radiusOpen  = cmWidget->openRadius->value();
+    color.radiusClose = cmWidget->closeRadius->value();
+    color.minArea     = cmWidget->minArea->value();
+    color.maxArea     = cmWidget->maxArea->value();
+    color.maxRatio    = cmWidget->maxRatio->value();
+
+    MultiColorMarkerWidget   *mcmWidget  = mainWindow->getMultiColorMarkerWidget();
+    MultiColorMarkerSettings &multiColor = options.multiColorMarker;
+    multiColor.useOpen               = mcmWidget->useOpen->isChecked();
+    multiColor.useClose              = mcmWidget->useClose->isChecked();
+    multiColor.radiusOpen            = mcmWidget->openRadius->value();
+    multiColor.radiusClose           = mcmWidget->closeRadius->value();
+    multiColor.minArea               = mcmWidget->minArea->value();
+    multiColor.maxArea               = mcmWidget->maxArea->value();
+    multiColor.maxRatio              = mcmWidget->maxRatio->value();
+    multiColor.dotSize               = mcmWidget->dotSize->value();
+    multiColor.useBlackDot           = mcmWidget->useDot->isChecked();
+    multiColor.useCodeMarker         = mcmWidget->useCodeMarker->isChecked();
+    multiColor.restrictPosition      = mcmWidget->restrictPosition->isChecked();
+    multiColor.ignoreWithoutDot      = mcmWidget->ignoreWithoutDot->isChecked();
+    multiColor.autoCorrect           = mcmWidget->autoCorrect->isChecked();
+    multiColor.autoCorrectOnlyExport = mcmWidget->autoCorrectOnlyExport->isChecked();
+
+    // the selected map is detected last, so its mask is the one shown
+    RectPlotItem *rectPlotItem = controlWidget->getColorPlot()->getMapItem();
+    for(int j = 0; j < rectPlotItem->mapNum(); j++)
+    {
+        int nr;
+        if(j == controlWidget->getMapNr())
+        {
+            nr = rectPlotItem->mapNum() - 1;
+        }
+        else if(j == rectPlotItem->mapNum() - 1)
+        {
+            nr = controlWidget->getMapNr();
+        }
+        else
+        {
+            nr = j;
+        }
+        const auto &map = rectPlotItem->getMap(nr);
+        multiColor.maps.push_back({map.fromColor(), map.toColor(), map.invHue()});
+    }
+
+    CodeMarkerSettings &code = options.codeMarker;
+    code.detectorParams      = mCodeMarkerOptions.getDetectorParams();
+    code.indexOfMarkerDict   = mCodeMarkerOptions.getIndexOfMarkerDict();
+    code.calibration3D       = controlWidget->getCalibCoordDimension() == 0;
+    code.detectors           = mCodeMarkerOptions.getDetectorCache();
+    code.tileSize            = mCodeMarkerOptions.getTileSize();
+    code.aprilTag            = mCodeMarkerOptions.getAprilTagDetector();
+    code.estimateOrientation = controlWidget->isExportViewDirChecked();
+
+    // same copy of the calibration as used for the perspective correction
+    const auto &worldImageCorr = *options.perspective.worldImageCorr;
+    if(code.calibration3D)
+    {
+        QRect rect(
+            myRound(mainWindow->getRecoRoiItem()->rect().x()),
+            myRound(mainWindow->getRecoRoiItem()->rect().y()),
+            myRound(mainWindow->getRecoRoiItem()->rect().width()),
+            myRound(mainWindow->getRecoRoiItem()->rect().height()));
+        QPointF p1 = worldImageCorr.getCmPerPixel(rect.x(), rect.y(), options.defaultHeight);
+        QPointF p2 = worldImageCorr.getCmPerPixel(rect.x() + rect.width(), rect.y(), options.defaultHeight);
+        QPointF p3 = worldImageCorr.getCmPerPixel(rect.x(), rect.y() + rect.height(), options.defaultHeight);
+        QPointF p4 =
+            worldImageCorr.getCmPerPixel(rect.x() + rect.width(), rect.y() + rect.height(), options.defaultHeight);
+
+        code.cmPerPixelMin = std::min({p1.x(), p1.y(), p2.x(), p2.y(), p3.x(), p3.y(), p4.x(), p4.y()});
+        code.cmPerPixelMax = std::max({p1.x(), p1.y(), p2.x(), p2.y(), p3.x(), p3.y(), p4.x(), p4.y()});
+        code.roiLength     = std::max(rect.width(), rect.height());
+    }
+    else
+    {
+        code.cmPerPixelMin = worldImageCorr.getCmPerPixel();
+        code.cmPerPixelMax = code.cmPerPixelMin;
+    }
+    if(const QImage *image = mainWindow->getImage())
+    {
+        code.imageLength = std::max(image->width() - borderSize, image->height() - borderSize);
+    }
+
+    // the model is only loaded if it is used
+    if(options.method == RecognitionMethod::Head)
+    {
+        options.headDetector.detector = mHeadDetectorOptions.getDetector();
+    }
+    options.headDetector.minScore = mHeadDetectorOptions.getMinScore();
+    return options;
+}
+
+namespace
+{
+/// options.roi trimmed to img
+cv::Rect recognitionRect(const cv::Mat &img, const RecognitionOptions &options)
+{
+    const RecognitionMethod method = options.method;
+    return qRectToCvRect(
+        options.roi,
         img,
-        (mRecoMethod != RecognitionMethod::Color) && (mRecoMethod != RecognitionMethod::MultiColor) &&
-            (mRecoMethod != RecognitionMethod::Code));
+        (method != RecognitionMethod::Color) && (method != RecognitionMethod::MultiColor) &&
+            (method != RecognitionMethod::Code) && (method != RecognitionMethod::Head));
+}
+
+/**
+ * @brief Runs findMarkers() in each of options.searchWindows and merges the results
+ *
+ * Points found in several overlapping windows are returned once. The masks of the
+ * windows are combined into one mask of the whole ROI, so the result looks like
+ * the one of a scan of the whole ROI.
+ */
+RecognitionResult findMarkersInWindows(const FrameContext &frame, const RecognitionOptions &options)
+{
+    TRACE_ZONE("reco::findMarkersInWindows");
+    const cv::Rect roiRect = recognitionRect(frame.image(), options);
 
-    auto tImg = img(rect);
+    RecognitionResult result;
+    result.method = options.method;
+    result.offset = Vec2F(roiRect.x - options.borderSize, roiRect.y - options.borderSize);
+    if(roiRect.empty())
+    {
+        return result;
+    }
 
-    if(tImg.empty())
+    // same marker if closer than half a head
+    const double minDistance = std::max(1., options.headSize / 2.);
+    const int    roiLength   = std::max(roiRect.width, roiRect.height);
+    for(const auto &window : options.searchWindows)
     {
-        return QList<TrackPoint>{};
+        RecognitionOptions windowOptions = options;
+        windowOptions.searchWindows.clear();
+        windowOptions.roi = window.intersected(options.roi);
+        if(windowOptions.roi.isEmpty())
+        {
+            continue;
+        }
+        // the perimeter rates of code markers are relative to the searched image, keep their size in pixel
+        const double scale = static_cast<double>(std::max(window.width(), window.height())) / roiLength;
+        windowOptions.codeMarker.roiLength   = myRound(options.codeMarker.roiLength * scale);
+        windowOptions.codeMarker.imageLength = myRound(options.codeMarker.imageLength * scale);
+        windowOptions.codeMarker.tileSize    = 0;
+
+        const RecognitionResult windowResult = findMarkers(frame, windowOptions);
+        const Vec2F             shift        = windowResult.offset - result.offset;
+
+        for(const auto &point : windowResult.points)
+        {
+            const bool known = std::any_of(
+                result.points.begin(),
+                result.points.end(),
+                [&](const TrackPoint &other) { return (other - point).length() < minDistance; });
+            if(!known)
+            {
+                result.points.append(point);
+            }
+        }
+
+        if(!windowResult.mask.empty())
+        {
+            if(result.mask.empty())
+            {
+                result.mask = cv::Mat::zeros(roiRect.size(), CV_8UC1);
+            }
+            const cv::Rect target =
+                cv::Rect(myRound(shift.x()), myRound(shift.y()), windowResult.mask.cols, windowResult.mask.rows) &
+                cv::Rect(0, 0, result.mask.cols, result.mask.rows);
+            cv::Mat maskRoi = result.mask(target);
+            cv::bitwise_or(maskRoi, windowResult.mask(cv::Rect(0, 0, target.width, target.height)), maskRoi);
+        }
+
+        for(auto overlay : windowResult.codeMarkers)
+        {
+            overlay.offset += shift;
+            result.codeMarkers.push_back(std::move(overlay));
+        }
     }
+    return result;
+}
 
-    QList<TrackPoint> crossList;
+/// factor, by which the hint windows are enlarged before code markers are searched in them
+constexpr int HINT_UPSCALE = 2;
+
+/**
+ * @brief Runs findMarkers() without options.hintWindows and searches code markers in them again
+ *
+ * The hint windows are searched at HINT_UPSCALE times the resolution, where the codes of
+ * small or blurred markers, which were only rejected candidates before, can often be read.
+ * A code read there replaces an unread point at the same position or is added.
+ */
+RecognitionResult findMarkersWithHints(const FrameContext &frame, const RecognitionOptions &options)
+{
+    TRACE_ZONE("reco::findMarkersWithHints");
+    RecognitionOptions mainOptions = options;
+    mainOptions.hintWindows.clear();
+    RecognitionResult result = findMarkers(frame, mainOptions);
+    if(options.method != RecognitionMethod::Code)
+    {
+        return result;
+    }
+
+    RecognitionOptions hintOptions = mainOptions;
+    hintOptions.searchWindows      = options.hintWindows;
+    hintOptions.codeMarker.upscale = HINT_UPSCALE;
+
+    const RecognitionResult hintResult  = findMarkersInWindows(frame, hintOptions);
+    const double            minDistance = std::max(1., options.headSize / 2.);
+    for(const auto &point : hintResult.points)
+    {
+        if(point.getMarkerID() < 0)
+        {
+            continue;
+        }
+        const auto same = std::find_if(
+            result.points.begin(),
+            result.points.end(),
+            [&](const TrackPoint &other) { return (other - point).length() < minDistance; });
+        if(same == result.points.end())
+        {
+            result.points.append(point);
+        }
+        else if(same->getMarkerID() < 0)
+        {
+            *same = point;
+        }
+    }
+
+    const Vec2F shift = hintResult.offset - result.offset;
+    for(auto overlay : hintResult.codeMarkers)
+    {
+        overlay.offset += shift;
+        result.codeMarkers.push_back(std::move(overlay));
+    }
+    return result;
+}
+} // namespace
+
+/**
+ * @brief Detects position of markers of the type options.method
+ *
+ * Only reads frame and options, so it can run on any thread; the debug overlays are
+ * returned in the result instead of being set to the marker items. Color markers are
+ * detected on the HSV image of frame, code markers on its gray image.
+ *
+ * @param frame filtered image of the frame and its derived views
+ * @param options snapshot of the parameters, see Recognizer::getOptions()
+ *
+ * @return detected TrackPoints (relative to the image without border) and overlays
+ */
+RecognitionResult findMarkers(const FrameContext &frame, const RecognitionOptions &options)
+{
+    TRACE_ZONE("reco::findMarkers");
+    if(!options.hintWindows.empty())
+    {
+        return findMarkersWithHints(frame, options);
+    }
+    if(!options.searchWindows.empty())
+    {
+        return findMarkersInWindows(frame, options);
+    }
+
+    const cv::Mat          &img    = frame.image();
+    const RecognitionMethod method = options.method;
+
+    auto rect = recognitionRect(img, options);
+
+    RecognitionResult result;
+    result.method = method;
     // offset of rect
-    Vec2F v(rect.x - borderSize, rect.y - borderSize);
+    result.offset = Vec2F(rect.x - options.borderSize, rect.y - options.borderSize);
+
+    const cv::Mat tImg = img(rect);
+    if(tImg.empty())
+    {
+        return result;
+    }
 
-    switch(mRecoMethod)
+    // derived views of the frame restricted to rect
+    const auto         crop      = [&rect](const cv::Mat &view) { return view.empty() ? cv::Mat() : view(rect); };
+    QList<TrackPoint> &crossList = result.points;
+    switch(method)
     {
         case RecognitionMethod::MultiColor:
-            findMultiColorMarker(
-                tImg,
-                crossList,
-                controlWidget,
-                ignoreWithoutMarker,
-                v,
-                mRecoMethod,
-                mCodeMarkerOptions,
-                intrinsicCameraParams);
+            findMultiColorMarker(tImg, crop(frame.hsv()), crossList, options, result.offset, result);
             break;
         case RecognitionMethod::Color:
-            findColorMarker(tImg, crossList, controlWidget);
+            findColorMarker(tImg, crop(frame.hsv()), crossList, options.colorMarker, result.mask);
             break;
         case RecognitionMethod::Code:
-            crossList = findCodeMarker(tImg, mRecoMethod, mCodeMarkerOptions, intrinsicCameraParams);
+            crossList = findCodeMarker(
+                crop(frame.gray()), method, options.codeMarker, options.intrinsicCameraParams, result.codeMarkers);
             break;
         case RecognitionMethod::Casern:
             [[fallthrough]];
@@ -1453,31 +1923,114 @@ QList<TrackPoint> Recognizer::getMarkerPos(
             findContourMarker(
                 tImg,
                 &crossList,
-                markerBrightness,
-                ignoreWithoutMarker,
-                autoWB,
-                mRecoMethod,
-                controlWidget->getMainWindow()->getHeadSize());
+                options.markerBrightness,
+                options.ignoreWithoutMarker,
+                options.autoWB,
+                method,
+                options.headSize);
+            break;
+        case RecognitionMethod::Head:
+            crossList = findHeads(tImg, options.headDetector);
             break;
         case RecognitionMethod::Stereo:
             throw std::invalid_argument(
                 "Stereo marker are not handled in getMarkerPos, but in PersonList::calcPersonPos");
     }
 
+    // set cross position relative to original image size
+    for(auto &point : crossList)
+    {
+        point += result.offset;
+        point.setColPoint(point.colPoint() + result.offset);
+    }
+    return result;
+}
+
+/**
+ * @brief Detects position of markers in img, see findMarkers(const FrameContext&, const RecognitionOptions&)
+ */
+RecognitionResult findMarkers(const cv::Mat &img, const RecognitionOptions &options)
+{
+    const FrameContext frame(img);
+    return findMarkers(frame, options);
+}
+
+/**
+ * @brief Hands the debug overlays of result to the marker items of mainWindow
+ *
+ * Has to be called on the GUI thread.
+ */
+void Recognizer::showOverlays(const RecognitionResult &result, Petrack &mainWindow)
+{
+    Vec2F offset = result.offset;
     // must be set because else hovermoveevent of recognitionRec moves also the colorMaskItem
-    controlWidget->getMainWindow()->getColorMarkerItem()->setRect(v);
+    mainWindow.getColorMarkerItem()->setRect(offset);
     // must be set because else hovermoveevent of recognitionRec moves also the colorMaskItem
-    controlWidget->getMainWindow()->getMultiColorMarkerItem()->setRect(v);
+    mainWindow.getMultiColorMarkerItem()->setRect(offset);
     // must be set because else hovermoveevent of recognitionRec moves also the colorMaskItem
-    controlWidget->getMainWindow()->getCodeMarkerItem()->setRect(v);
+    mainWindow.getCodeMarkerItem()->setRect(offset);
 
-    // set cross position relative to original image size
-    for(auto &point : crossList)
+    cv::Mat mask = result.mask;
+    if(!mask.empty() && result.method == RecognitionMethod::Color)
+    {
+        mainWindow.getColorMarkerItem()->setMask(mask);
+    }
+    else if(!mask.empty() && result.method == RecognitionMethod::MultiColor)
     {
-        point += v;
-        point.setColPoint(point.colPoint() + v);
+        mainWindow.getMultiColorMarkerItem()->setMask(mask);
     }
+    for(const auto &codes : result.codeMarkers)
+    {
+        mainWindow.getCodeMarkerItem()->addDetectedMarkers(codes.corners, codes.ids, codes.offset);
+        mainWindow.getCodeMarkerItem()->addRejectedMarkers(codes.rejected, codes.offset);
+    }
+}
+
+/**
+ * @brief Detects position of markers from user-chosen type
+ *
+ * Takes a snapshot of the options, runs findMarkers() and shows its overlays.
+ *
+ * @param img
+ * @param roi Region of interest for recognition
+ * @param controlWidget
+ * @param borderSize
+ * @param bgFilter
+ * @param intrinsicCameraParams intrinsic parameters of the camera. Used for e.g. estimation of arucomarkers
+ *
+ * @return List of detected TrackPoints
+ */
+QList<TrackPoint> Recognizer::getMarkerPos(
+    cv::Mat                     &img,
+    QRect                       &roi,
+    Control                     *controlWidget,
+    int                          borderSize,
+    BackgroundFilter            *bgFilter,
+    const IntrinsicCameraParams &intrinsicCameraParams)
+{
+    const RecognitionResult result =
+        findMarkers(img, getOptions(controlWidget, roi, borderSize, intrinsicCameraParams));
+    return acceptResult(result, *controlWidget->getMainWindow(), bgFilter);
+}
+
+/**
+ * @brief Shows the overlays of result and returns its points which are in the foreground
+ *
+ * Has to be called on the GUI thread, findMarkers() may have run on any thread.
+ *
+ * @param result result of findMarkers()
+ * @param mainWindow owner of the marker items the overlays are shown in
+ * @param bgFilter background filter, points in the background are dropped if it is enabled
+ * @return the detected points
+ */
+QList<TrackPoint> Recognizer::acceptResult(
+    const RecognitionResult &result,
+    Petrack                 &mainWindow,
+    BackgroundFilter        *bgFilter)
+{
+    showOverlays(result, mainWindow);
 
+    QList<TrackPoint> crossList = result.points;
     if(bgFilter->getEnabled()) // nur fuer den fall von bgSubtraction durchfuehren
     {
         crossList.erase(
@@ -1491,14 +2044,168 @@ QList<TrackPoint> Recognizer::getMarkerPos(
     return crossList;
 }
 
-const Vec2F &CodeMarkerOptions::getOffsetCropRect2Roi() const
+namespace
 {
-    return offsetCropRect2Roi;
+/// Returns the dictionary with the index of the dictList of the CodeMarkerWidget, 17 for DICT_mip_36h12
+cv::aruco::Dictionary markerDictionary(int indexOfMarkerDict)
+{
+    // DICT_mip_36h12 is not predefined in opencv and is only built once
+    static const cv::aruco::Dictionary dictMip36h12 = detail::getDictMip36h12();
+    return (indexOfMarkerDict != 17) ?
+               cv::aruco::getPredefinedDictionary(cv::aruco::PredefinedDictionaryType(indexOfMarkerDict)) :
+               dictMip36h12;
+}
+} // namespace
+
+/**
+ * @brief Builds the dictionaries and the detector parameters apart from the perimeter rates
+ *
+ * @param params parameters of the CodeMarkerWidget
+ * @param indexOfMarkerDict index of the dictionary, 17 for DICT_mip_36h12
+ * @param extraMarkerDicts indices of further dictionaries identified among the rejected candidates
+ */
+ArucoDetectorCache::ArucoDetectorCache(
+    const ArucoCodeParams  &params,
+    int                     indexOfMarkerDict,
+    const std::vector<int> &extraMarkerDicts) :
+    mDictionary(markerDictionary(indexOfMarkerDict))
+{
+    std::transform(
+        extraMarkerDicts.begin(), extraMarkerDicts.end(), std::back_inserter(mExtraDictionaries), markerDictionary);
+
+    mDetectorParams.adaptiveThreshWinSizeMin    = params.getAdaptiveThreshWinSizeMin();
+    mDetectorParams.adaptiveThreshWinSizeMax    = params.getAdaptiveThreshWinSizeMax();
+    mDetectorParams.adaptiveThreshWinSizeStep   = params.getAdaptiveThreshWinSizeStep();
+    mDetectorParams.adaptiveThreshConstant      = params.getAdaptiveThreshConstant();
+    mDetectorParams.polygonalApproxAccuracyRate = params.getPolygonalApproxAccuracyRate();
+    mDetectorParams.minCornerDistanceRate       = params.getMinCornerDistance();
+    mDetectorParams.minDistanceToBorder         = params.getMinDistanceToBorder();
+    mDetectorParams.minMarkerDistanceRate       = params.getMinMarkerDistance();
+    // No refinement is default value
+    // TODO Check if this is the best method for our usecase
+    if(params.getDoCornerRefinement())
+    {
+        mDetectorParams.cornerRefinementMethod = cv::aruco::CornerRefineMethod::CORNER_REFINE_SUBPIX;
+    }
+    mDetectorParams.cornerRefinementWinSize               = params.getCornerRefinementWinSize();
+    mDetectorParams.cornerRefinementMaxIterations         = params.getCornerRefinementMaxIterations();
+    mDetectorParams.cornerRefinementMinAccuracy           = params.getCornerRefinementMinAccuracy();
+    mDetectorParams.markerBorderBits                      = params.getMarkerBorderBits();
+    mDetectorParams.perspectiveRemovePixelPerCell         = params.getPerspectiveRemovePixelPerCell();
+    mDetectorParams.perspectiveRemoveIgnoredMarginPerCell = params.getPerspectiveRemoveIgnoredMarginPerCell();
+    mDetectorParams.maxErroneousBitsInBorderRate          = params.getMaxErroneousBitsInBorderRate();
+    mDetectorParams.minOtsuStdDev                         = params.getMinOtsuStdDev();
+    mDetectorParams.errorCorrectionRate                   = params.getErrorCorrectionRate();
+}
+
+/**
+ * @brief Returns the detector for the given perimeter rates, it is built on first use
+ */
+std::shared_ptr<const cv::aruco::ArucoDetector>
+ArucoDetectorCache::get(double minMarkerPerimeterRate, double maxMarkerPerimeterRate)
+{
+    auto params                   = mDetectorParams;
+    params.minMarkerPerimeterRate = minMarkerPerimeterRate;
+    params.maxMarkerPerimeterRate = maxMarkerPerimeterRate;
+    if(std::isnan(minMarkerPerimeterRate) || std::isnan(maxMarkerPerimeterRate))
+    {
+        // NaN cannot be used as a key
+        return std::make_shared<const cv::aruco::ArucoDetector>(mDictionary, params);
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto                  key = std::make_pair(minMarkerPerimeterRate, maxMarkerPerimeterRate);
+    if(auto it = mDetectors.find(key); it != mDetectors.end())
+    {
+        return it->second;
+    }
+    if(mDetectors.size() >= maxDetectors)
+    {
+        mDetectors.clear();
+    }
+    auto detector = std::make_shared<const cv::aruco::ArucoDetector>(mDictionary, params);
+    mDetectors.emplace(key, detector);
+    return detector;
 }
 
-void CodeMarkerOptions::setOffsetCropRect2Roi(const Vec2F &newOffsetCropRect2Roi)
+void HeadDetectorOptions::setModelPath(const QString &path)
 {
-    offsetCropRect2Roi = newOffsetCropRect2Roi;
+    if(path != modelPath)
+    {
+        modelPath = path;
+        detector.reset();
+        loadFailed = false;
+    }
+}
+
+void HeadDetectorOptions::setInputSize(int size)
+{
+    if(size > 0 && size != inputSize)
+    {
+        inputSize = size;
+        detector.reset();
+        loadFailed = false;
+    }
+}
+
+/**
+ * @brief Returns the detector for the model, which is loaded on the first call
+ *
+ * @return the detector; nullptr if no model is set or it cannot be loaded
+ */
+std::shared_ptr<const HeadDetector> HeadDetectorOptions::getDetector() const
+{
+    if(!detector && !loadFailed && !modelPath.isEmpty())
+    {
+        try
+        {
+            detector = std::make_shared<const HeadDetector>(modelPath.toStdString(), inputSize);
+        }
+        catch(const cv::Exception &e)
+        {
+            SPDLOG_ERROR("Could not load head detector {}: {}", modelPath, e.what());
+            loadFailed = true;
+        }
+    }
+    return detector;
+}
+
+std::shared_ptr<ArucoDetectorCache> CodeMarkerOptions::getDetectorCache() const
+{
+    if(!detectorCache)
+    {
+        detectorCache = std::make_shared<ArucoDetectorCache>(detectorParams, indexOfMarkerDict, extraMarkerDicts);
+    }
+    return detectorCache;
+}
+
+/**
+ * @brief Returns the AprilTag detector, if it is used for the current dictionary
+ *
+ * @return nullptr, if ArUco is used, because AprilTag is not chosen, not built (-DAPRILTAG=ON)
+ *         or does not support the dictionary
+ */
+std::shared_ptr<const AprilTagDetector> CodeMarkerOptions::getAprilTagDetector() const
+{
+#ifdef APRILTAG
+    if(useAprilTag && !aprilTagDetector && AprilTagDetector::supports(indexOfMarkerDict))
+    {
+        aprilTagDetector = std::make_shared<const AprilTagDetector>(detectorParams, indexOfMarkerDict);
+    }
+#endif
+    return aprilTagDetector;
+}
+
+void CodeMarkerOptions::setUseAprilTag(bool use)
+{
+#ifndef APRILTAG
+    if(use)
+    {
+        SPDLOG_WARN("PeTrack is built without AprilTag (-DAPRILTAG=ON), code markers are detected with ArUco.");
+    }
+#endif
+    useAprilTag = use;
+    aprilTagDetector.reset();
 }
 
 void CodeMarkerOptions::setDetectorParams(ArucoCodeParams params)
@@ -1506,6 +2213,8 @@ void CodeMarkerOptions::setDetectorParams(ArucoCodeParams params)
     if(params != detectorParams)
     {
         detectorParams = params;
+        detectorCache.reset();
+        aprilTagDetector.reset();
         emit detectorParamsChanged();
     }
 }
@@ -1515,10 +2224,473 @@ void CodeMarkerOptions::setIndexOfMarkerDict(int idx)
     if(idx != indexOfMarkerDict)
     {
         indexOfMarkerDict = idx;
+        detectorCache.reset();
+        aprilTagDetector.reset();
         emit indexOfMarkerDictChanged();
     }
 }
 
+/**
+ * @brief Sets the dictionaries detected in addition to the one of indexOfMarkerDict
+ *
+ * Their markers are identified among the candidates rejected for the first dictionary,
+ * which is much cheaper than another detection. The ids of the n-th of them (starting
+ * with 1) are offset by n * ArucoDetectorCache::ID_STRIDE. Duplicates are dropped.
+ */
+void CodeMarkerOptions::setExtraMarkerDicts(std::vector<int> dicts)
+{
+    std::vector<int> unique;
+    for(int dict : dicts)
+    {
+        if(dict != indexOfMarkerDict && std::find(unique.begin(), unique.end(), dict) == unique.end())
+        {
+            unique.push_back(dict);
+        }
+    }
+    if(unique != extraMarkerDicts)
+    {
+        extraMarkerDicts = std::move(unique);
+        detectorCache.reset();
+        emit indexOfMarkerDictChanged();
+    }
+}
+
+namespace
+{
+cv::Point2f markerCenter(const std::vector<cv::Point2f> &corners)
+{
+    return (corners.at(0) + corners.at(1) + corners.at(2) + corners.at(3)) / 4.f;
+}
+
+/// marker has the same center (up to a fraction of its size) as one of others
+bool isSameMarker(const std::vector<cv::Point2f> &marker, const std::vector<std::vector<cv::Point2f>> &others)
+{
+    const cv::Point2f center = markerCenter(marker);
+    const double      radius = cv::arcLength(marker, true) / 8.; // half of the side length
+    return std::any_of(
+        others.begin(),
+        others.end(),
+        [&](const std::vector<cv::Point2f> &other) { return cv::norm(markerCenter(other) - center) < radius; });
+}
+
+/// Markers detected in a region of an image, in coordinates of the image
+struct RegionDetection
+{
+    std::vector<std::vector<cv::Point2f>> corners;
+    std::vector<int>                      ids;
+    std::vector<std::vector<cv::Point2f>> rejected;
+};
+
+/**
+ * @brief Detects code markers in each of the regions of img in parallel
+ *
+ * The perimeter rates are given relative to imgLength and are converted for each region.
+ * They are computed from the copy of the calibration in the RecognitionOptions, so the
+ * regions only read img and the detectors, which are shared under the lock of the cache.
+ */
+std::vector<RegionDetection> detectInRegions(
+    const cv::Mat               &img,
+    ArucoDetectorCache          &detectors,
+    const std::vector<cv::Rect> &regions,
+    int                          imgLength,
+    double                       minMarkerPerimeterRate,
+    double                       maxMarkerPerimeterRate)
+{
+    std::vector<RegionDetection> detections(regions.size());
+
+    // own pool, as the caller may already run in the global one
+    QThreadPool               &tilePool = concurrency::pool(concurrency::Pool::Tiles);
+    std::vector<QFuture<void>> futures;
+    futures.reserve(regions.size());
+    for(std::size_t i = 0; i < regions.size(); ++i)
+    {
+        futures.push_back(QtConcurrent::run(
+            &tilePool,
+            [&, i]()
+            {
+                const cv::Rect  &region = regions[i];
+                const double     scale  = static_cast<double>(imgLength) / std::max(region.width, region.height);
+                RegionDetection &det    = detections[i];
+
+                detectors.get(minMarkerPerimeterRate * scale, maxMarkerPerimeterRate * scale)
+                    ->detectMarkers(img(region), det.corners, det.ids, det.rejected);
+
+                const cv::Point2f offset(region.x, region.y);
+                for(auto &marker : det.corners)
+                {
+                    std::for_each(marker.begin(), marker.end(), [&](cv::Point2f &p) { p += offset; });
+                }
+                for(auto &marker : det.rejected)
+                {
+                    std::for_each(marker.begin(), marker.end(), [&](cv::Point2f &p) { p += offset; });
+                }
+            }));
+    }
+    for(auto &future : futures)
+    {
+        future.waitForFinished();
+    }
+    return detections;
+}
+
+/// Appends the detections of overlapping regions, markers found in several regions only once
+void mergeDetections(
+    const std::vector<RegionDetection>    &detections,
+    std::vector<std::vector<cv::Point2f>> &corners,
+    std::vector<int>                      &ids,
+    std::vector<std::vector<cv::Point2f>> &rejected)
+{
+    for(const auto &det : detections)
+    {
+        for(std::size_t i = 0; i < det.corners.size(); ++i)
+        {
+            std::vector<std::vector<cv::Point2f>> sameId;
+            for(std::size_t j = 0; j < ids.size(); ++j)
+            {
+                if(ids[j] == det.ids[i])
+                {
+                    sameId.push_back(corners[j]);
+                }
+            }
+            if(!isSameMarker(det.corners[i], sameId))
+            {
+                corners.push_back(det.corners[i]);
+                ids.push_back(det.ids[i]);
+            }
+        }
+    }
+    // candidates cut by a seam may be rejected in one region but detected in another
+    for(const auto &det : detections)
+    {
+        for(const auto &candidate : det.rejected)
+        {
+            if(!isSameMarker(candidate, corners) && !isSameMarker(candidate, rejected))
+            {
+                rejected.push_back(candidate);
+            }
+        }
+    }
+}
+} // namespace
+
+/**
+ * @brief Detects code markers in overlapping tiles of img in parallel
+ *
+ * The tiles overlap by the diagonal of the largest allowed marker (plus the minimal
+ * distance to the border), so every marker lies completely inside at least one tile.
+ * The perimeter rates are given relative to img and are converted for each tile.
+ * Markers found in several tiles are returned only once.
+ *
+ * @param img image to find codes in
+ * @param detectors detectors for the parameters of the CodeMarkerWidget
+ * @param tileSize side of the tiles in pixel
+ * @param minMarkerPerimeterRate minimal perimeter of a marker relative to the longer side of img
+ * @param maxMarkerPerimeterRate maximal perimeter of a marker relative to the longer side of img
+ * @param corners corners of the detected markers in coordinates of img
+ * @param ids ids of the detected markers
+ * @param rejected corners of the rejected candidates in coordinates of img
+ */
+void detail::detectMarkersTiled(
+    const cv::Mat                         &img,
+    ArucoDetectorCache                    &detectors,
+    int                                    tileSize,
+    double                                 minMarkerPerimeterRate,
+    double                                 maxMarkerPerimeterRate,
+    std::vector<std::vector<cv::Point2f>> &corners,
+    std::vector<int>                      &ids,
+    std::vector<std::vector<cv::Point2f>> &rejected)
+{
+    const int    imgLength = std::max(img.cols, img.rows);
+    const double maxSide   = maxMarkerPerimeterRate * imgLength / 4.;
+    const int    overlap   = static_cast<int>(std::ceil(maxSide * std::sqrt(2.))) + 1 +
+                             2 * detectors.getDetectorParams().minDistanceToBorder;
+    if(std::isnan(maxSide) || overlap >= tileSize)
+    {
+        // the largest markers do not fit into a tile
+        detectors.get(minMarkerPerimeterRate, maxMarkerPerimeterRate)->detectMarkers(img, corners, ids, rejected);
+        return;
+    }
+
+    const int             step = tileSize - overlap;
+    std::vector<cv::Rect> tiles;
+    for(int y = 0; y < img.rows; y += step)
+    {
+        for(int x = 0; x < img.cols; x += step)
+        {
+            tiles.emplace_back(x, y, std::min(tileSize, img.cols - x), std::min(tileSize, img.rows - y));
+            if(x + tileSize >= img.cols)
+            {
+                break;
+            }
+        }
+        if(y + tileSize >= img.rows)
+        {
+            break;
+        }
+    }
+
+    const auto detections =
+        detectInRegions(img, detectors, tiles, imgLength, minMarkerPerimeterRate, maxMarkerPerimeterRate);
+    mergeDetections(detections, corners, ids, rejected);
+}
+
+/**
+ * @brief Detects code markers in a downscaled copy of img and decodes them in img
+ *
+ * The adaptive thresholding and the contour search of ArUco dominate its runtime and
+ * scale with the number of pixels. Large markers are still found as quads in img scaled
+ * down by decimate (like quad_decimate of AprilTag). Every candidate (detected or rejected)
+ * is then searched again in a patch of img around it, so the corners are refined and
+ * the code is decoded at full resolution. The patches have the size of a tile for the
+ * largest allowed marker, so all of them share one detector.
+ *
+ * Markers with a perimeter below about 4 * 4 * decimate pixels are lost, so decimate has
+ * to fit the smallest markers.
+ *
+ * @param img image to find codes in
+ * @param detectors detectors for the parameters of the CodeMarkerWidget
+ * @param decimate factor img is scaled down by for the search of candidates
+ * @param tileSize side of the tiles the downscaled image is split into (see detectMarkersTiled()); 0 for none
+ * @param minMarkerPerimeterRate minimal perimeter of a marker relative to the longer side of img
+ * @param maxMarkerPerimeterRate maximal perimeter of a marker relative to the longer side of img
+ * @param corners corners of the detected markers in coordinates of img
+ * @param ids ids of the detected markers
+ * @param rejected corners of the rejected candidates in coordinates of img
+ */
+void detail::detectMarkersDecimated(
+    const cv::Mat                         &img,
+    ArucoDetectorCache                    &detectors,
+    int                                    decimate,
+    int                                    tileSize,
+    double                                 minMarkerPerimeterRate,
+    double                                 maxMarkerPerimeterRate,
+    std::vector<std::vector<cv::Point2f>> &corners,
+    std::vector<int>                      &ids,
+    std::vector<std::vector<cv::Point2f>> &rejected)
+{
+    const int    imgLength = std::max(img.cols, img.rows);
+    const double maxSide   = maxMarkerPerimeterRate * imgLength / 4.;
+    // a marker lies completely inside the patch, even if its center is off by a pixel of the downscaled image
+    const int patchSize = static_cast<int>(std::ceil(maxSide * std::sqrt(2.))) + 2 * decimate + 1 +
+                          2 * detectors.getDetectorParams().minDistanceToBorder;
+    if(decimate <= 1 || std::isnan(maxSide) || patchSize >= std::min(img.cols, img.rows))
+    {
+        // the patches would cover the whole image
+        if(tileSize > 0 && imgLength > tileSize)
+        {
+            detectMarkersTiled(
+                img, detectors, tileSize, minMarkerPerimeterRate, maxMarkerPerimeterRate, corners, ids, rejected);
+        }
+        else
+        {
+            detectors.get(minMarkerPerimeterRate, maxMarkerPerimeterRate)->detectMarkers(img, corners, ids, rejected);
+        }
+        return;
+    }
+
+    cv::Mat small;
+    {
+        TRACE_ZONE("reco::decimate");
+        cv::resize(img, small, cv::Size(), 1. / decimate, 1. / decimate, cv::INTER_AREA);
+    }
+    // the perimeter rates are relative to the image, so they hold for small as well
+    std::vector<std::vector<cv::Point2f>> candidates;
+    std::vector<int>                      candidateIds;
+    std::vector<std::vector<cv::Point2f>> rejectedCandidates;
+    if(tileSize > 0 && std::max(small.cols, small.rows) > tileSize)
+    {
+        detectMarkersTiled(
+            small,
+            detectors,
+            tileSize,
+            minMarkerPerimeterRate,
+            maxMarkerPerimeterRate,
+            candidates,
+            candidateIds,
+            rejectedCandidates);
+    }
+    else
+    {
+        detectors.get(minMarkerPerimeterRate, maxMarkerPerimeterRate)
+            ->detectMarkers(small, candidates, candidateIds, rejectedCandidates);
+    }
+    candidates.insert(candidates.end(), rejectedCandidates.begin(), rejectedCandidates.end());
+
+    // one patch per candidate, candidates close to each other share it
+    std::vector<cv::Rect>    patches;
+    std::vector<cv::Point2f> patchCenters;
+    const float              minDistance = 0.25f * patchSize;
+    const cv::Point2f        half(0.5f, 0.5f);
+    for(const auto &candidate : candidates)
+    {
+        // pixel centers of small in coordinates of img
+        const cv::Point2f center = (markerCenter(candidate) + half) * decimate - half;
+        const bool        known  = std::any_of(
+            patchCenters.begin(),
+            patchCenters.end(),
+            [&](const cv::Point2f &other) { return cv::norm(other - center) < minDistance; });
+        if(known)
+        {
+            continue;
+        }
+        const int x = std::clamp(cvRound(center.x) - patchSize / 2, 0, img.cols - patchSize);
+        const int y = std::clamp(cvRound(center.y) - patchSize / 2, 0, img.rows - patchSize);
+        patches.emplace_back(x, y, patchSize, patchSize);
+        patchCenters.push_back(center);
+    }
+
+    const auto detections =
+        detectInRegions(img, detectors, patches, imgLength, minMarkerPerimeterRate, maxMarkerPerimeterRate);
+    mergeDetections(detections, corners, ids, rejected);
+}
+
+namespace
+{
+/**
+ * @brief Reads the cells of a candidate like ArUco does
+ *
+ * @return the cells including the border, 1 for white; empty, if the border has too many errors
+ */
+cv::Mat extractMarkerBits(
+    const cv::Mat                       &gray,
+    const std::vector<cv::Point2f>      &corners,
+    const cv::aruco::Dictionary         &dictionary,
+    const cv::aruco::DetectorParameters &params)
+{
+    const int cells    = dictionary.markerSize + 2 * params.markerBorderBits;
+    const int cellSize = params.perspectiveRemovePixelPerCell;
+    const int side     = cells * cellSize;
+
+    const std::vector<cv::Point2f> square{{0, 0}, {side - 1.f, 0}, {side - 1.f, side - 1.f}, {0, side - 1.f}};
+    cv::Mat                        warped;
+    cv::warpPerspective(
+        gray, warped, cv::getPerspectiveTransform(corners, square), cv::Size(side, side), cv::INTER_NEAREST);
+
+    cv::Mat    bits(cells, cells, CV_8UC1, cv::Scalar(0));
+    cv::Scalar mean;
+    cv::Scalar stdDev;
+    cv::meanStdDev(warped, mean, stdDev);
+    if(stdDev[0] < params.minOtsuStdDev)
+    {
+        // all cells have the same color
+        bits.setTo(mean[0] > 127 ? 1 : 0);
+    }
+    else
+    {
+        cv::threshold(warped, warped, 125, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        const int margin = cvRound(params.perspectiveRemoveIgnoredMarginPerCell * cellSize);
+        const int inner  = cellSize - 2 * margin;
+        for(int y = 0; y < cells; ++y)
+        {
+            for(int x = 0; x < cells; ++x)
+            {
+                const cv::Rect cell(x * cellSize + margin, y * cellSize + margin, inner, inner);
+                bits.at<uchar>(y, x) = cv::countNonZero(warped(cell)) > inner * inner / 2 ? 1 : 0;
+            }
+        }
+    }
+
+    // the border is black, so every white cell in it is an error; ArUco relates them to the size of the code
+    const int      size = dictionary.markerSize;
+    const cv::Rect code(params.markerBorderBits, params.markerBorderBits, size, size);
+    const int      errors = cv::countNonZero(bits) - cv::countNonZero(bits(code));
+    if(errors > static_cast<int>(size * size * params.maxErroneousBitsInBorderRate))
+    {
+        return {};
+    }
+    return bits;
+}
+} // namespace
+
+/**
+ * @brief Identifies markers of the extra dictionaries of detectors among the rejected candidates
+ *
+ * The thresholding and the quad detection of ArUco are done once for the first dictionary
+ * and its rejected candidates are all quads which did not decode. Only the cells of these
+ * are read again for each further dictionary. Identified candidates are moved from rejected
+ * to corners, with the ids of the n-th extra dictionary offset by n * ArucoDetectorCache::ID_STRIDE.
+ *
+ * @param img image the candidates were found in
+ * @param detectors detectors with the extra dictionaries and the parameters of the CodeMarkerWidget
+ * @param corners corners of the detected markers, identified ones are appended
+ * @param ids ids of the detected markers, identified ones are appended
+ * @param rejected corners of the rejected candidates, identified ones are removed
+ */
+void detail::identifyExtraMarkers(
+    const cv::Mat                         &img,
+    const ArucoDetectorCache              &detectors,
+    std::vector<std::vector<cv::Point2f>> &corners,
+    std::vector<int>                      &ids,
+    std::vector<std::vector<cv::Point2f>> &rejected)
+{
+    const auto &dictionaries = detectors.getExtraDictionaries();
+    if(dictionaries.empty() || rejected.empty())
+    {
+        return;
+    }
+    TRACE_ZONE("reco::identifyExtraMarkers");
+    cv::Mat gray;
+    if(img.channels() == 3)
+    {
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    }
+    else
+    {
+        gray = img;
+    }
+
+    const auto                           &params          = detectors.getDetectorParams();
+    const auto                            firstIdentified = corners.size();
+    std::vector<std::vector<cv::Point2f>> stillRejected;
+    for(auto &candidate : rejected)
+    {
+        bool identified = false;
+        for(std::size_t dict = 0; dict < dictionaries.size() && !identified; ++dict)
+        {
+            const cv::Mat bits = extractMarkerBits(gray, candidate, dictionaries[dict], params);
+            if(bits.empty())
+            {
+                continue;
+            }
+            const int border   = params.markerBorderBits;
+            const int size     = dictionaries[dict].markerSize;
+            int       id       = 0;
+            int       rotation = 0;
+            if(dictionaries[dict].identify(
+                   bits(cv::Rect(border, border, size, size)), id, rotation, params.errorCorrectionRate))
+            {
+                // rotate the corners like ArUco, so the first corner is the top left one of the code
+                std::rotate(candidate.begin(), candidate.begin() + 4 - rotation, candidate.end());
+                corners.push_back(std::move(candidate));
+                ids.push_back(static_cast<int>(dict + 1) * ArucoDetectorCache::ID_STRIDE + id);
+                identified = true;
+            }
+        }
+        if(!identified)
+        {
+            stillRejected.push_back(std::move(candidate));
+        }
+    }
+    rejected = std::move(stillRejected);
+
+    if(params.cornerRefinementMethod == cv::aruco::CORNER_REFINE_SUBPIX)
+    {
+        const cv::TermCriteria criteria(
+            cv::TermCriteria::MAX_ITER | cv::TermCriteria::EPS,
+            params.cornerRefinementMaxIterations,
+            params.cornerRefinementMinAccuracy);
+        for(auto it = corners.begin() + firstIdentified; it != corners.end(); ++it)
+        {
+            cv::cornerSubPix(
+                gray,
+                *it,
+                cv::Size(params.cornerRefinementWinSize, params.cornerRefinementWinSize),
+                cv::Size(-1, -1),
+                criteria);
+        }
+    }
+}
+
 /**
  * @brief getMip36h12Dict() overrides current dictionary with dictionary from 'aruco_mip_36h12_dict'
  *
@@ -1831,6 +3003,20 @@ void ArucoCodeParams::setErrorCorrectionRate(double newErrorCorrectionRate)
     errorCorrectionRate = newErrorCorrectionRate;
 }
 
+int ArucoCodeParams::getQuadDecimate() const
+{
+    return quadDecimate;
+}
+
+void ArucoCodeParams::setQuadDecimate(int newQuadDecimate)
+{
+    if(newQuadDecimate < 1)
+    {
+        throw std::invalid_argument("Quad decimate needs to be at least 1");
+    }
+    quadDecimate = newQuadDecimate;
+}
+
 double ArucoCodeParams::getMinMarkerPerimeter() const
 {
     return minMarkerPerimeter;
@@ -19,20 +19,28 @@
 #ifndef RECOGNITION_H
 #define RECOGNITION_H
 
+#include "extrCalibration.h"
+#include "intrinsicCameraParams.h"
 #include "vector.h"
 
 #include <QColor>
 #include <QList>
 #include <QObject>
+#include <QRect>
+#include <QString>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <opencv2/objdetect/aruco_detector.hpp>
+#include <vector>
 
 class TrackPoint;
-class QRect;
 class BackgroundFilter;
 class Control;
 class ImageItem;
-class CodeMarkerItem;
-struct IntrinsicCameraParams;
+class FrameContext;
+class Petrack;
 class WorldImageCorrespondence;
 
 namespace reco
@@ -51,6 +59,7 @@ enum class RecognitionMethod
     Japan      = 4,
     MultiColor = 5,
     Code       = 6,
+    Head       = 7, ///< markerless, see HeadDetector
 };
 
 class ArucoCodeParams
@@ -75,6 +84,7 @@ class ArucoCodeParams
     double maxErroneousBitsInBorderRate          = 0.35;
     double minOtsuStdDev                         = 5;
     double errorCorrectionRate                   = 0.6;
+    int    quadDecimate                          = 1; ///< candidates are searched in an image downscaled by this
 
 public:
     friend inline constexpr bool operator==(const ArucoCodeParams &lhs, const ArucoCodeParams &rhs) noexcept
@@ -99,7 +109,8 @@ public:
                                 rhs.perspectiveRemoveIgnoredMarginPerCell) &&
                                ((lhs.maxErroneousBitsInBorderRate == rhs.maxErroneousBitsInBorderRate) &&
                                 ((lhs.minOtsuStdDev == rhs.minOtsuStdDev) &&
-                                 (lhs.errorCorrectionRate == rhs.errorCorrectionRate)))))))))))))))))));
+                                 (lhs.errorCorrectionRate == rhs.errorCorrectionRate) &&
+                                 (lhs.quadDecimate == rhs.quadDecimate)))))))))))))))))));
     }
     friend inline constexpr bool operator!=(const ArucoCodeParams &lhs, const ArucoCodeParams &rhs)
     {
@@ -145,45 +156,233 @@ public:
     void   setMinOtsuStdDev(double newMinOtsuStdDev);
     double getErrorCorrectionRate() const;
     void   setErrorCorrectionRate(double newErrorCorrectionRate);
+    int    getQuadDecimate() const;
+    void   setQuadDecimate(int newQuadDecimate);
 };
 
 
+/**
+ * @brief ArUco detectors for one dictionary and one set of ArucoCodeParams
+ *
+ * Building the dictionary and the detector for each call of findCodeMarker() is
+ * expensive, e.g. for MultiColor markers with code, where it is called once per
+ * color blob. The perimeter rates depend on the scale and the size of the
+ * searched image, so a detector is kept for each pair of rates. Can be used from
+ * several threads.
+ *
+ * The markers of the extra dictionaries are identified among the candidates the
+ * detectors rejected, so thresholding and quad detection run once for all of them.
+ */
+class ArucoDetectorCache
+{
+public:
+    /// The ids of the n-th extra dictionary are offset by n * ID_STRIDE
+    static constexpr int ID_STRIDE = 10000;
+
+    ArucoDetectorCache(
+        const ArucoCodeParams  &params,
+        int                     indexOfMarkerDict,
+        const std::vector<int> &extraMarkerDicts = std::vector<int>());
+
+    std::shared_ptr<const cv::aruco::ArucoDetector> get(double minMarkerPerimeterRate, double maxMarkerPerimeterRate);
+    const cv::aruco::DetectorParameters           &getDetectorParams() const { return mDetectorParams; }
+    const std::vector<cv::aruco::Dictionary>      &getExtraDictionaries() const { return mExtraDictionaries; }
+
+private:
+    static constexpr std::size_t maxDetectors = 64;
+
+    cv::aruco::Dictionary              mDictionary;
+    std::vector<cv::aruco::Dictionary> mExtraDictionaries;
+    cv::aruco::DetectorParameters      mDetectorParams; ///< everything except the perimeter rates
+
+    std::mutex                                                                           mMutex;
+    std::map<std::pair<double, double>, std::shared_ptr<const cv::aruco::ArucoDetector>> mDetectors;
+};
+
+class AprilTagDetector; // see aprilTagDetector.h
+
 class CodeMarkerOptions : public QObject
 {
     Q_OBJECT
 
 private:
-    CodeMarkerItem *codeMarkerItem;
-    int             indexOfMarkerDict = 16;
+    int indexOfMarkerDict = 16;
+
+    std::vector<int> extraMarkerDicts; ///< detected in the same pass, with ids offset by ArucoDetectorCache::ID_STRIDE
 
     ArucoCodeParams detectorParams;
 
-    Control *controlWidget;
-    Vec2F    offsetCropRect2Roi = Vec2F{0, 0};
+    mutable std::shared_ptr<ArucoDetectorCache> detectorCache; ///< built on demand, reset if a parameter changes
+
+    int tileSize = 0; ///< side of the tiles a frame is split into for detection; 0 for no tiling
+
+    bool useAprilTag = false; ///< detect with AprilTag instead of ArUco, where possible
+
+    mutable std::shared_ptr<const AprilTagDetector> aprilTagDetector; ///< built on demand like detectorCache
 
 public:
-    // TODO: Remove getter and setter for pointers;
-    // cannot properly set these in constructor because of
-    // bidirectional dependecies
-    CodeMarkerItem *getCodeMarkerItem() const { return codeMarkerItem; }
-    Control        *getControlWidget() const { return controlWidget; }
-    ArucoCodeParams getDetectorParams() const { return detectorParams; }
-    int             getIndexOfMarkerDict() const { return indexOfMarkerDict; }
+    ArucoCodeParams         getDetectorParams() const { return detectorParams; }
+    int                     getIndexOfMarkerDict() const { return indexOfMarkerDict; }
+    const std::vector<int> &getExtraMarkerDicts() const { return extraMarkerDicts; }
+    int                     getTileSize() const { return tileSize; }
+    void                    setTileSize(int size) { tileSize = std::max(0, size); }
+    bool                    isUsingAprilTag() const { return useAprilTag; }
+    void                    setUseAprilTag(bool use);
+
+    std::shared_ptr<ArucoDetectorCache>     getDetectorCache() const;
+    std::shared_ptr<const AprilTagDetector> getAprilTagDetector() const;
 
 public:
-    void setCodeMarkerItem(CodeMarkerItem *item) { codeMarkerItem = item; }
-    void setControlWidget(Control *control) { controlWidget = control; }
     void setDetectorParams(ArucoCodeParams params);
     void setIndexOfMarkerDict(int idx);
-
-    const Vec2F &getOffsetCropRect2Roi() const;
-    void         setOffsetCropRect2Roi(const Vec2F &newOffsetCropRect2Roi);
+    void setExtraMarkerDicts(std::vector<int> dicts);
 
 signals:
     void detectorParamsChanged();
     void indexOfMarkerDictChanged();
 };
 
+class HeadDetector; // see headDetector.h
+
+/// Model and parameters of the markerless head detection
+class HeadDetectorOptions
+{
+private:
+    QString modelPath; ///< ONNX file of the network
+    double  minScore  = 0.5;
+    int     inputSize = 640; ///< side length of the input of the network
+
+    mutable std::shared_ptr<const HeadDetector> detector;          ///< loaded on demand, reset if the model changes
+    mutable bool                                loadFailed = false; ///< do not try to load a broken model every frame
+
+public:
+    const QString &getModelPath() const { return modelPath; }
+    void           setModelPath(const QString &path);
+    double         getMinScore() const { return minScore; }
+    void           setMinScore(double score) { minScore = std::clamp(score, 0., 1.); }
+    int            getInputSize() const { return inputSize; }
+    void           setInputSize(int size);
+
+    std::shared_ptr<const HeadDetector> getDetector() const;
+};
+
+/// Range of colors of one color map
+struct ColorRange
+{
+    QColor fromColor;
+    QColor toColor;
+    bool   invHue = false; ///< hue range is inverted (for red-ish colors)
+};
+
+/// Parameters of the ColorMarkerWidget
+struct ColorMarkerSettings
+{
+    ColorRange range;
+    bool       useOpen     = false;
+    bool       useClose    = false;
+    int        radiusOpen  = 5;
+    int        radiusClose = 5;
+    int        minArea     = 1000;
+    int        maxArea     = 5000;
+    double     maxRatio    = 2;
+};
+
+/// Parameters of the MultiColorMarkerWidget and the color maps of the Control
+struct MultiColorMarkerSettings
+{
+    std::vector<ColorRange> maps; ///< in order of detection, the selected map comes last
+    bool                    useOpen               = true;
+    bool                    useClose              = true;
+    int                     radiusOpen            = 5;
+    int                     radiusClose           = 5;
+    int                     minArea               = 1000;
+    int                     maxArea               = 5000;
+    double                  maxRatio              = 2;
+    double                  dotSize               = 5;
+    bool                    useBlackDot           = false;
+    bool                    useCodeMarker         = false;
+    bool                    restrictPosition      = false;
+    bool                    ignoreWithoutDot      = true;
+    bool                    autoCorrect           = false;
+    bool                    autoCorrectOnlyExport = false;
+};
+
+/// Parameters of the CodeMarkerOptions and the scale of the image the marker sizes depend on
+struct CodeMarkerSettings
+{
+    ArucoCodeParams detectorParams;
+    int             indexOfMarkerDict = 16;
+    bool            calibration3D     = false; ///< 3D calibration (the scale depends on the position)
+    double          cmPerPixelMin     = 1;     ///< smallest scale at the corners of the recognition ROI
+    double          cmPerPixelMax     = 1;     ///< largest scale at the corners of the recognition ROI
+    int             roiLength         = 0;     ///< longer side of the recognition ROI
+    int             imageLength       = 0;     ///< longer side of the image without border
+
+    std::shared_ptr<ArucoDetectorCache>     detectors;    ///< for the parameters above; nullptr builds them per call
+    int                                     tileSize = 0; ///< larger images are detected in parallel tiles; 0 for none
+    std::shared_ptr<const AprilTagDetector> aprilTag;     ///< used instead of the detectors, if set
+
+    bool estimateOrientation = true; ///< estimate the pose of the markers for the export of the viewing direction
+    int  upscale             = 1;    ///< the image is enlarged by this factor before the detection, to read small codes
+};
+
+/// Parameters of the HeadDetectorOptions
+struct HeadDetectorSettings
+{
+    std::shared_ptr<const HeadDetector> detector; ///< nullptr, if no model is loaded
+    double                              minScore = 0.5;
+};
+
+/// Everything autoCorrectColorMarker() needs; copies of the calibration, so it can be used by worker threads
+struct PerspectiveCorrection
+{
+    ExtrCalibration::CameraModel                    camera;           ///< extrinsic and intrinsic calibration
+    std::shared_ptr<const WorldImageCorrespondence> worldImageCorr;   ///< snapshot, see WorldImageCorrespondence
+    cv::Point3f                                     pointUnderCamera; ///< (world) point on the ground below the camera
+    int                                             borderSize = 0;
+};
+
+/**
+ * @brief Immutable snapshot of all parameters of the recognition of one frame
+ *
+ * Created on the GUI thread by Recognizer::getOptions(); findMarkers() only reads
+ * this snapshot and never the widgets. The calibration is copied as well (see
+ * PerspectiveCorrection), so changes during a running recognition do not affect it.
+ */
+struct RecognitionOptions
+{
+    RecognitionMethod        method = RecognitionMethod::MultiColor;
+    QRect                    roi; ///< recognition ROI (including border)
+    int                      borderSize          = 0;
+    double                   headSize            = 0;   ///< in pixel, used by the Japan marker
+    double                   defaultHeight       = 180; ///< default height of the persons in cm
+    int                      markerBrightness    = 0;
+    bool                     ignoreWithoutMarker = true;
+    bool                     autoWB              = false;
+    ColorMarkerSettings      colorMarker;
+    MultiColorMarkerSettings multiColorMarker;
+    CodeMarkerSettings       codeMarker;
+    HeadDetectorSettings     headDetector;
+    PerspectiveCorrection    perspective;
+    IntrinsicCameraParams    intrinsicCameraParams; ///< used for estimating the orientation of code markers
+    std::vector<QRect>       searchWindows; ///< if not empty, only these parts of roi are searched (same coordinates)
+    std::vector<QRect>       hintWindows;   ///< searched again for code markers at higher resolution (same coordinates)
+};
+
+/// Code markers found in one (sub-)image, drawn by the CodeMarkerItem
+struct CodeMarkerOverlay
+{
+    std::vector<std::vector<cv::Point2f>> corners;
+    std::vector<int>                      ids;
+    std::vector<std::vector<cv::Point2f>> rejected;
+    Vec2F                                 offset; ///< offset of the (sub-)image to the recognition ROI
+};
+
+struct RecognitionResult; // see recognitionResult.h
+
+RecognitionResult findMarkers(const FrameContext &frame, const RecognitionOptions &options);
+RecognitionResult findMarkers(const cv::Mat &img, const RecognitionOptions &options);
+
 
 class Recognizer : public QObject
 {
@@ -191,7 +390,8 @@ class Recognizer : public QObject
 
 private:
     // TODO add options for each marker type
-    CodeMarkerOptions mCodeMarkerOptions;
+    CodeMarkerOptions   mCodeMarkerOptions;
+    HeadDetectorOptions mHeadDetectorOptions;
 
     // default multicolor marker (until 11/2016 hermes marker)
     RecognitionMethod mRecoMethod = RecognitionMethod::MultiColor;
@@ -205,8 +405,20 @@ public:
         BackgroundFilter            *bgFilter,
         const IntrinsicCameraParams &intrinsicCameraParams);
 
-    RecognitionMethod  getRecoMethod() const { return mRecoMethod; }
-    CodeMarkerOptions &getCodeMarkerOptions() { return mCodeMarkerOptions; }
+    RecognitionOptions getOptions(
+        Control                     *controlWidget,
+        const QRect                 &roi,
+        int                          borderSize,
+        const IntrinsicCameraParams &intrinsicCameraParams) const;
+    static void showOverlays(const RecognitionResult &result, Petrack &mainWindow);
+    static QList<TrackPoint> acceptResult(
+        const RecognitionResult &result,
+        Petrack                 &mainWindow,
+        BackgroundFilter        *bgFilter);
+
+    RecognitionMethod    getRecoMethod() const { return mRecoMethod; }
+    CodeMarkerOptions   &getCodeMarkerOptions() { return mCodeMarkerOptions; }
+    HeadDetectorOptions &getHeadDetectorOptions() { return mHeadDetectorOptions; }
 
 public slots:
     void userChangedRecoMethod(RecognitionMethod method)
@@ -225,11 +437,27 @@ signals:
 // berechnet pixelverschiebung aufgrund von schraegsicht bei einem farbmarker
 // Maik Dissertation Seite 138
 // boxImageCentre ohne Border
-Vec2F autoCorrectColorMarker(const Vec2F &boxImageCentre, Control *controlWidget);
+Vec2F                 autoCorrectColorMarker(const Vec2F &boxImageCentre, const PerspectiveCorrection &correction);
+Vec2F                 autoCorrectColorMarker(const Vec2F &boxImageCentre, Control *controlWidget);
+PerspectiveCorrection getPerspectiveCorrection(Control *controlWidget);
 
 
 namespace detail
 {
+    /// ranges of H, S and V (in the value ranges of OpenCV) a pixel has to be in for thresholdHSV()
+    struct ColorParameters
+    {
+        int  h_low     = 0;
+        int  h_high    = 359;
+        int  s_low     = 0;
+        int  s_high    = 255;
+        int  v_low     = 0;
+        int  v_high    = 255;
+        bool inversHue = false;
+    };
+
+    void thresholdHSV(const cv::Mat &hsv, cv::Mat &bin, const ColorParameters &param);
+
     struct ColorBlob
     {
         cv::RotatedRect        box;          ///< bounding box
@@ -253,6 +481,7 @@ namespace detail
         Vec2F   offset;              ///< offset of ROI to image
         double  maxRatio = 2;        ///< maximum allowed ratio of sides for bounding rect
         cv::Mat img;                 ///< img in which to detect the blobs
+        cv::Mat hsv;                 ///< img converted to HSV; converted from img if empty
         cv::Mat binary;              ///< img for the binary mask
     };
 
@@ -265,25 +494,28 @@ namespace detail
         bool autoCorrect         = false; ///< should perspective correction be performed
         bool autoCorrectOnlyExport =
             false; ///< should perspective correction only be performed when exporting trajectories
-        const WorldImageCorrespondence *worldImageCorr = nullptr; ///< used for getAngleToGround and such
-        QColor                          midHue;                   ///< middle hue of the color map
-        double                          dotSize       = 5;        ///< size of the black dot
-        Control                        *controlWidget = nullptr;  ///< pointer to Control used for autoCorrect
+        QColor                midHue;              ///< middle hue of the color map
+        double                dotSize       = 5;   ///< size of the black dot
+        double                defaultHeight = 180; ///< height of the persons in cm
+        PerspectiveCorrection perspective;         ///< used for autoCorrect, getAngleToGround and such
     };
 
     struct ArucoOptions
     {
-        Control *controlWidget       = nullptr; ///< pointer to Control used for autoCorrect
-        bool     ignoreWithoutMarker = true;    ///< should a blob without valid arucoMarker be ignored
-        bool     autoCorrect         = false;   ///< should perspective correction be performed
-        bool     autoCorrectOnlyExport =
+        PerspectiveCorrection perspective;                 ///< used for autoCorrect
+        bool                  ignoreWithoutMarker = true;  ///< should a blob without valid arucoMarker be ignored
+        bool                  autoCorrect         = false; ///< should perspective correction be performed
+        bool                  autoCorrectOnlyExport =
             false; ///< should perspective correction only be performed when exporting trajectories
         RecognitionMethod method =
             RecognitionMethod::Code; ///< Used recognition method; could be called from findMulticolorMarker
-        CodeMarkerOptions &codeOpt;
+        const CodeMarkerSettings       &codeOpt;
+        std::vector<CodeMarkerOverlay> &overlays; ///< detected codes for drawing
     };
 
-    std::vector<ColorBlob> findColorBlob(const ColorBlobDetectionParams &options);
+    void                                morphologyDisk(cv::Mat &binary, int op, int radius);
+    std::vector<std::vector<cv::Point>> findBlobContours(const cv::Mat &binary, double minArea);
+    std::vector<ColorBlob>              findColorBlob(const ColorBlobDetectionParams &options);
     void
     restrictPositionBlackDot(ColorBlob &blob, const WorldImageCorrespondence *imageItem, int bS, cv::Rect &cropRect);
     cv::Mat customBgr2Gray(const cv::Mat &subImg, const QColor &midHue);
@@ -296,7 +528,7 @@ namespace detail
         std::vector<ColorBlob>      &blobs,
         const cv::Mat               &img,
         QList<TrackPoint>           &crossList,
-        ArucoOptions                &options,
+        const ArucoOptions          &options,
         const IntrinsicCameraParams &intrinsicCameraParams);
 
 
@@ -306,11 +538,13 @@ namespace detail
     TrackPoint resolveMoreThanOneCandidateCode(QList<TrackPoint> &codes, const Vec2F reference);
 
     QList<TrackPoint> findCodeMarker(
-        cv::Mat                     &img,
-        RecognitionMethod            recoMethod,
-        const CodeMarkerOptions     &opt,
-        const IntrinsicCameraParams &intrinsicCameraParams,
-        bool                         appendRejectedCodes = false);
+        const cv::Mat                  &img,
+        RecognitionMethod               recoMethod,
+        const CodeMarkerSettings       &opt,
+        const IntrinsicCameraParams    &intrinsicCameraParams,
+        std::vector<CodeMarkerOverlay> &overlays,
+        Vec2F                           offsetCropRect2Roi  = Vec2F(0, 0),
+        bool                            appendRejectedCodes = false);
     cv::aruco::Dictionary getDictMip36h12();
 
     void estimatePoseSingleMarkers(
@@ -321,6 +555,32 @@ namespace detail
         std::vector<cv::Vec3d>                      &rotationVectors,
         std::vector<cv::Vec3d>                      &translationVectors);
 
+    void detectMarkersTiled(
+        const cv::Mat                         &img,
+        ArucoDetectorCache                    &detectors,
+        int                                    tileSize,
+        double                                 minMarkerPerimeterRate,
+        double                                 maxMarkerPerimeterRate,
+        std::vector<std::vector<cv::Point2f>> &corners,
+        std::vector<int>                      &ids,
+        std::vector<std::vector<cv::Point2f>> &rejected);
+    void detectMarkersDecimated(
+        const cv::Mat                         &img,
+        ArucoDetectorCache                    &detectors,
+        int                                    decimate,
+        int                                    tileSize,
+        double                                 minMarkerPerimeterRate,
+        double                                 maxMarkerPerimeterRate,
+        std::vector<std::vector<cv::Point2f>> &corners,
+        std::vector<int>                      &ids,
+        std::vector<std::vector<cv::Point2f>> &rejected);
+    void identifyExtraMarkers(
+        const cv::Mat                         &img,
+        const ArucoDetectorCache              &detectors,
+        std::vector<std::vector<cv::Point2f>> &corners,
+        std::vector<int>                      &ids,
+        std::vector<std::vector<cv::Point2f>> &rejected);
+
 } // namespace detail
 } // namespace reco
 
@@ -0,0 +1,48 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECOGNITIONRESULT_H
+#define RECOGNITIONRESULT_H
+
+#include "recognition.h"
+#include "tracker.h"
+
+#include <QList>
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace reco
+{
+/**
+ * @brief Detections of one frame and the debug overlays of the detectors
+ *
+ * The overlays are handed to the marker items on the GUI thread, see
+ * Recognizer::showOverlays().
+ */
+struct RecognitionResult
+{
+    RecognitionMethod              method = RecognitionMethod::MultiColor;
+    QList<TrackPoint>              points; ///< relative to the image without border
+    Vec2F                          offset; ///< upper left corner of the recognition ROI (without border)
+    cv::Mat                        mask;   ///< binary mask of the (last) color map of color and multicolor markers
+    std::vector<CodeMarkerOverlay> codeMarkers;
+};
+
+} // namespace reco
+
+#endif // RECOGNITIONRESULT_H
@@ -0,0 +1,277 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "batchJobs.h"
+
+#include "concurrency.h"
+#include "logger.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+
+namespace
+{
+/// command line option running each action
+const std::map<QString, QString> ACTION_OPTIONS{
+    {"track", "-autoTrack"},
+    {"play", "-autoPlay"},
+    {"save", "-autoSave"},
+    {"exportView", "-autoExportView"}};
+} // namespace
+
+/**
+ * @brief Reads the jobs from the JSON file jobFile
+ *
+ * @return false, if the file could not be read or does not contain any job
+ */
+bool BatchJobs::load(const QString &jobFile)
+{
+    QFile file{jobFile};
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        SPDLOG_ERROR("Could not open the job file {}.", jobFile);
+        return false;
+    }
+    QJsonParseError   error;
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll(), &error).object();
+    if(error.error != QJsonParseError::NoError)
+    {
+        SPDLOG_ERROR("Could not parse the job file {}: {}", jobFile, error.errorString());
+        return false;
+    }
+
+    const auto jobs = parseJobs(json, QFileInfo(jobFile).absoluteDir());
+    if(!jobs || jobs->empty())
+    {
+        SPDLOG_ERROR("The job file {} does not contain valid jobs.", jobFile);
+        return false;
+    }
+    mJobs = *jobs;
+    return true;
+}
+
+/**
+ * @brief Reads the jobs from the array "jobs" of json
+ *
+ * @param baseDir directory relative paths of projects and outputs refer to
+ * @return the jobs in the order of the file; std::nullopt, if a job is invalid (see parseJob())
+ */
+std::optional<std::vector<BatchJob>> BatchJobs::parseJobs(const QJsonObject &json, const QDir &baseDir)
+{
+    std::vector<BatchJob> jobs;
+    for(const auto &value : json["jobs"].toArray())
+    {
+        auto job = parseJob(value.toObject(), baseDir);
+        if(!job)
+        {
+            SPDLOG_ERROR("Invalid job {}.", jobs.size());
+            return std::nullopt;
+        }
+        jobs.push_back(std::move(*job));
+    }
+    return jobs;
+}
+
+/**
+ * @brief Reads one job with the keys project, action, output and optionally arguments
+ *
+ * @param baseDir directory relative paths of the project and the output refer to
+ * @return the job; std::nullopt, if it has no project, no output or an unknown action
+ */
+std::optional<BatchJob> BatchJobs::parseJob(const QJsonObject &json, const QDir &baseDir)
+{
+    BatchJob job;
+    job.project = json["project"].toString();
+    job.action  = json["action"].toString();
+    job.output  = json["output"].toString();
+    for(const auto &argument : json["arguments"].toArray())
+    {
+        job.arguments << (argument.isString() ? argument.toString() : argument.toVariant().toString());
+    }
+    if(job.project.isEmpty() || !commandLine(job))
+    {
+        return std::nullopt;
+    }
+    job.project = baseDir.absoluteFilePath(job.project);
+    job.output  = baseDir.absoluteFilePath(job.output);
+    return job;
+}
+
+/**
+ * @brief Returns the arguments of the PeTrack process running job
+ *
+ * @return std::nullopt, if the action is unknown or has no output
+ */
+std::optional<QStringList> BatchJobs::commandLine(const BatchJob &job)
+{
+    const auto option = ACTION_OPTIONS.find(job.action);
+    if(option == ACTION_OPTIONS.end() || job.output.isEmpty())
+    {
+        return std::nullopt;
+    }
+    QStringList arguments{job.project};
+    arguments << job.arguments << option->second << job.output << "-headless";
+    return arguments;
+}
+
+/**
+ * @brief Returns the options limiting the process in slot to threads threads
+ *
+ * With firstCpu >= 0, the process in slot is pinned to the cores from firstCpu + slot * threads on.
+ */
+QStringList BatchJobs::resourceArguments(int slot, int threads, int firstCpu)
+{
+    QStringList arguments{"-threads", QString::number(threads)};
+    if(firstCpu >= 0)
+    {
+        arguments << "-pin" << QString::number(firstCpu + slot * threads);
+    }
+    return arguments;
+}
+
+/**
+ * @brief Runs all jobs and writes their results and durations to reportFile
+ *
+ * A job is started as soon as one of the running processes finishes, so the order of
+ * the jobs only matters if they do not fit into jobs processes at once.
+ *
+ * @param reportFile CSV file with one line per job
+ * @param jobs maximum number of child processes running at once
+ * @param jobThreads threads per process; 0 for an equal share of the cores
+ * @param firstCpu first core to pin the processes to; -1 to not pin them
+ * @return false, if a job failed or the report could not be written
+ */
+bool BatchJobs::run(const QString &reportFile, int jobs, int jobThreads, int firstCpu)
+{
+    const int slots   = std::max(jobs, 1);
+    const int threads = jobThreads > 0 ? jobThreads : std::max(1, concurrency::availableCores() / slots);
+
+    std::vector<BatchJobResult>            results(mJobs.size());
+    std::vector<std::unique_ptr<QProcess>> processes(mJobs.size());
+    std::vector<QElapsedTimer>             timers(mJobs.size());
+    std::vector<int>                       slotOfJob(mJobs.size(), -1);
+    std::vector<bool>                      usedSlots(slots, false);
+    size_t                                 next    = 0;
+    size_t                                 running = 0;
+    QEventLoop                             loop;
+
+    std::function<void()> startNext;
+    auto                  finish = [&](size_t k, bool succeeded)
+    {
+        results[k] = {succeeded, static_cast<double>(timers[k].elapsed()) / 1000.};
+        SPDLOG_INFO("Job {} {} after {:.1f} s.", k, succeeded ? "finished" : "failed", results[k].seconds);
+        usedSlots[slotOfJob[k]] = false;
+        --running;
+        startNext();
+    };
+    startNext = [&]()
+    {
+        while(next < mJobs.size() && running < static_cast<size_t>(slots))
+        {
+            const size_t k       = next++;
+            auto        &process = processes[k];
+            process              = std::make_unique<QProcess>();
+            process->setProcessChannelMode(QProcess::ForwardedChannels);
+            QObject::connect(
+                process.get(),
+                qOverload<int, QProcess::ExitStatus>(&QProcess::finished),
+                [&, k](int exitCode, QProcess::ExitStatus status)
+                { finish(k, status == QProcess::NormalExit && exitCode == 0); });
+            QObject::connect(
+                process.get(),
+                &QProcess::errorOccurred,
+                [&, k](QProcess::ProcessError error)
+                {
+                    // finished is not emitted, if the process could not be started
+                    if(error == QProcess::FailedToStart)
+                    {
+                        finish(k, false);
+                    }
+                });
+
+            const auto slot = std::find(usedSlots.begin(), usedSlots.end(), false);
+            *slot           = true;
+            slotOfJob[k]    = static_cast<int>(slot - usedSlots.begin());
+            // right after the project, so the options of the job itself take precedence
+            QStringList arguments = *commandLine(mJobs[k]);
+            arguments             = arguments.mid(0, 1) + resourceArguments(slotOfJob[k], threads, firstCpu) +
+                        arguments.mid(1);
+
+            SPDLOG_INFO("Starting job {} ({} in total): {} {}.", k, mJobs.size(), mJobs[k].action, mJobs[k].project);
+            ++running;
+            timers[k].start();
+            process->start(QCoreApplication::applicationFilePath(), arguments);
+        }
+        if(running == 0)
+        {
+            loop.quit();
+        }
+    };
+
+    startNext();
+    if(running > 0)
+    {
+        loop.exec();
+    }
+
+    const bool written = writeReport(reportFile, results);
+    return written && std::all_of(results.begin(), results.end(), [](const auto &result) { return result.succeeded; });
+}
+
+/**
+ * @brief Writes one line with the job, its result and its duration per job
+ */
+bool BatchJobs::writeReport(const QString &reportFile, const std::vector<BatchJobResult> &results) const
+{
+    QFile file(reportFile);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not write the batch report {}.", reportFile);
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "job,project,action,output,result,seconds\n";
+    double total = 0;
+    for(size_t k = 0; k < mJobs.size(); ++k)
+    {
+        out << k << "," << mJobs[k].project << "," << mJobs[k].action << "," << mJobs[k].output << ","
+            << (results[k].succeeded ? "succeeded" : "failed") << "," << QString::number(results[k].seconds, 'f', 3)
+            << "\n";
+        total += results[k].seconds;
+    }
+    SPDLOG_INFO(
+        "{} of {} jobs succeeded; {:.1f} s of processing in total.",
+        std::count_if(results.begin(), results.end(), [](const auto &result) { return result.succeeded; }),
+        mJobs.size(),
+        total);
+    return out.status() == QTextStream::Ok;
+}
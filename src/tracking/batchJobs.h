@@ -0,0 +1,87 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCHJOBS_H
+#define BATCHJOBS_H
+
+#include <QString>
+#include <QStringList>
+#include <optional>
+#include <vector>
+
+class QDir;
+class QJsonObject;
+
+/// One project processed by a PeTrack process
+struct BatchJob
+{
+    QString     project;
+    QString     action; ///< track, play, save or exportView; the -auto option run on the project
+    QString     output; ///< destination of the action, e.g. the trc file of track
+    QStringList arguments;
+};
+
+/// Outcome of one job
+struct BatchJobResult
+{
+    bool   succeeded = false;
+    double seconds   = 0; ///< wall clock time from starting to finishing the process
+};
+
+/**
+ * @brief Processes a list of projects with a limited number of PeTrack processes
+ *
+ * The job file (JSON) lists the project, the action and its output per job, and
+ * optionally further command line arguments. Relative paths are relative to the job file:
+ *
+ *     {
+ *         "jobs": [
+ *             {"project": "exp1.pet", "action": "track", "output": "exp1.trc"},
+ *             {"project": "exp2.pet", "action": "save", "output": "exp2.txt", "arguments": ["-frameRange", "0", "999"]}
+ *         ]
+ *     }
+ *
+ * Every job runs in its own headless PeTrack process, like the configurations of
+ * ParameterSweep, as the main window and its filters can only process one project at
+ * a time. At most jobs processes run at once. Processes of the same project share its
+ * calibration map disk cache, if enabled in the project. Afterwards the result and the
+ * duration of every job are written to a CSV report.
+ *
+ * Each process gets its share of the cores as thread count (-threads) and, if a first
+ * core is given, is pinned to its own consecutive cores (-pin), e.g. on one NUMA node.
+ */
+class BatchJobs
+{
+public:
+    bool load(const QString &jobFile);
+    bool run(const QString &reportFile, int jobs, int jobThreads = 0, int firstCpu = -1);
+
+    const std::vector<BatchJob> &getJobs() const { return mJobs; }
+
+    static std::optional<std::vector<BatchJob>> parseJobs(const QJsonObject &json, const QDir &baseDir);
+    static std::optional<BatchJob>              parseJob(const QJsonObject &json, const QDir &baseDir);
+    static std::optional<QStringList>           commandLine(const BatchJob &job);
+    static QStringList                          resourceArguments(int slot, int threads, int firstCpu);
+
+private:
+    bool writeReport(const QString &reportFile, const std::vector<BatchJobResult> &results) const;
+
+    std::vector<BatchJob> mJobs;
+};
+
+#endif // BATCHJOBS_H
@@ -0,0 +1,232 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "colorStatistics.h"
+
+/**
+ * @brief Adds color as the last color of the trajectory; invalid colors are ignored
+ * @param direction vector from the tracked point to the point of the color
+ */
+void ColorStatistics::pushBack(const QColor &color, const Vec2F &direction)
+{
+    if(!mValid || !color.isValid())
+    {
+        return;
+    }
+    const int n = mCount[0] + mCount[1];
+    const End end{direction, mLast ? mLast->side ^ int(isOtherSide(direction, mLast->direction)) : 0};
+    add(end.side, color, 1);
+
+    if(n == 0)
+    {
+        mFirst = end;
+    }
+    else if(n == 1)
+    {
+        mSecond = end;
+    }
+    mSecondLast = mLast;
+    mLast       = end;
+}
+
+/**
+ * @brief Adds color as the first color of the trajectory; invalid colors are ignored
+ * @param direction vector from the tracked point to the point of the color
+ */
+void ColorStatistics::pushFront(const QColor &color, const Vec2F &direction)
+{
+    if(!mValid || !color.isValid())
+    {
+        return;
+    }
+    const int n = mCount[0] + mCount[1];
+    const End end{direction, mFirst ? mFirst->side ^ int(isOtherSide(direction, mFirst->direction)) : 0};
+    add(end.side, color, 1);
+
+    if(n == 0)
+    {
+        mLast = end;
+    }
+    else if(n == 1)
+    {
+        mSecondLast = end;
+    }
+    mSecond = mFirst;
+    mFirst  = end;
+}
+
+/**
+ * @brief Removes the last color, which has to be color; invalid colors are ignored
+ *
+ * Only one color can be removed before another one is added at this end; the next
+ * removal invalidates the statistics, as the side of the new last color is not known.
+ */
+void ColorStatistics::popBack(const QColor &color)
+{
+    if(!mValid || !color.isValid())
+    {
+        return;
+    }
+    if(!mLast || (!mSecondLast && mCount[0] + mCount[1] > 1))
+    {
+        invalidate();
+        return;
+    }
+    add(mLast->side, color, -1);
+
+    if(mCount[0] + mCount[1] == 0)
+    {
+        clear();
+        return;
+    }
+    mLast       = mSecondLast;
+    mSecondLast = std::nullopt;
+    if(mCount[0] + mCount[1] == 1)
+    {
+        mFirst  = mLast;
+        mSecond = std::nullopt;
+    }
+}
+
+/**
+ * @brief Removes the first color, which has to be color; invalid colors are ignored
+ * @see popBack()
+ */
+void ColorStatistics::popFront(const QColor &color)
+{
+    if(!mValid || !color.isValid())
+    {
+        return;
+    }
+    if(!mFirst || (!mSecond && mCount[0] + mCount[1] > 1))
+    {
+        invalidate();
+        return;
+    }
+    add(mFirst->side, color, -1);
+
+    if(mCount[0] + mCount[1] == 0)
+    {
+        clear();
+        return;
+    }
+    mFirst  = mSecond;
+    mSecond = std::nullopt;
+    if(mCount[0] + mCount[1] == 1)
+    {
+        mLast       = mFirst;
+        mSecondLast = std::nullopt;
+    }
+}
+
+/// Removes all colors; afterwards the statistics are valid again
+void ColorStatistics::clear()
+{
+    *this = ColorStatistics();
+}
+
+/// Marks the statistics as outdated, e.g. after a color in the middle of the trajectory changed
+void ColorStatistics::invalidate()
+{
+    clear();
+    mValid = false;
+}
+
+/**
+ * @brief Number of colors on side
+ * @param side 0 for the side of the first color, 1 for the other side or BOTH_SIDES
+ */
+int ColorStatistics::count(int side) const
+{
+    if(side == BOTH_SIDES)
+    {
+        return mCount[0] + mCount[1];
+    }
+    return mFirst ? mCount[side ^ mFirst->side] : 0;
+}
+
+/**
+ * @brief Per channel median of the colors on side
+ *
+ * For an even number of colors the lower of the two middle values is taken.
+ *
+ * @param side 0 for the side of the first color, 1 for the other side or BOTH_SIDES
+ * @return invalid color, if there is no color on side
+ */
+QColor ColorStatistics::median(int side) const
+{
+    const int n = count(side);
+    if(n == 0)
+    {
+        return QColor();
+    }
+    const bool both = side == BOTH_SIDES;
+    const int  own  = both ? 0 : side ^ mFirst->side;
+
+    std::array<int, 3> median{};
+    for(int channel = 0; channel < 3; ++channel)
+    {
+        quint32 below = 0;
+        int     bin   = 0;
+        for(; bin < BINS - 1; ++bin)
+        {
+            for(int s = 0; s < 2; ++s)
+            {
+                if(both || s == own)
+                {
+                    below += (*mHistograms)[s][channel][bin];
+                }
+            }
+            if(below > quint32(n - 1) / 2)
+            {
+                break;
+            }
+        }
+        median[channel] = bin;
+    }
+    return QColor(median[0], median[1], median[2]);
+}
+
+/// Bytes of the histograms, which might be shared with copies
+std::size_t ColorStatistics::memoryUsage() const
+{
+    return mHistograms ? sizeof(*mHistograms) : 0;
+}
+
+/// Histograms for changing them, not shared with any copy
+std::array<ColorStatistics::Histogram, 2> &ColorStatistics::histograms()
+{
+    if(!mHistograms)
+    {
+        mHistograms = std::make_shared<std::array<Histogram, 2>>();
+    }
+    else if(mHistograms.use_count() > 1)
+    {
+        mHistograms = std::make_shared<std::array<Histogram, 2>>(*mHistograms);
+    }
+    return *mHistograms;
+}
+
+void ColorStatistics::add(int side, const QColor &color, int delta)
+{
+    auto &histogram = histograms()[side];
+    histogram[0][color.red()] += delta;
+    histogram[1][color.green()] += delta;
+    histogram[2][color.blue()] += delta;
+    mCount[side] += delta;
+}
@@ -0,0 +1,87 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef COLORSTATISTICS_H
+#define COLORSTATISTICS_H
+
+#include "vector.h"
+
+#include <QColor>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+/**
+ * @brief Histograms of the marker colors of a TrackPerson, kept up to date while tracking
+ *
+ * A color marker is seen on one side of the head, given by the direction from the
+ * tracked point to the color point. Along the trajectory, a color belongs to the other
+ * side than the previous color, if their directions point away from each other.
+ * TrackPerson::optimizeColor() drops the colors of the side seen less often and takes the
+ * per channel median of the others, which is read from the histograms of both sides
+ * instead of sorting the colors of all points.
+ *
+ * Colors are added and removed at both ends of the trajectory in constant time. Other
+ * changes invalidate the statistics, which then have to be rebuilt from the points.
+ * Copies of a person share the histograms until one of them changes.
+ */
+class ColorStatistics
+{
+public:
+    static constexpr int BINS       = 256;
+    static constexpr int BOTH_SIDES = -1;
+
+    void pushBack(const QColor &color, const Vec2F &direction);
+    void pushFront(const QColor &color, const Vec2F &direction);
+    void popBack(const QColor &color);
+    void popFront(const QColor &color);
+    void clear();
+    void invalidate();
+
+    bool        isValid() const { return mValid; }
+    int         count(int side) const;
+    QColor      median(int side) const;
+    std::size_t memoryUsage() const;
+
+    /// direction belongs to the other side than the direction of the previous color
+    static bool isOtherSide(const Vec2F &direction, const Vec2F &previous) { return (direction * previous) < 0; }
+
+private:
+    using Histogram = std::array<std::array<quint32, BINS>, 3>; ///< red, green and blue
+
+    /// color at one end of the trajectory
+    struct End
+    {
+        Vec2F direction;
+        int   side; ///< 0 or 1; 0 is the side of the first color ever added
+    };
+
+    std::array<Histogram, 2> &histograms();
+    void                      add(int side, const QColor &color, int delta);
+
+    std::shared_ptr<std::array<Histogram, 2>> mHistograms; ///< per side; nullptr without colors
+    std::array<int, 2>                        mCount{};
+    std::optional<End>                        mFirst;
+    std::optional<End>                        mSecond; ///< color after mFirst, if known
+    std::optional<End>                        mLast;
+    std::optional<End>                        mSecondLast; ///< color before mLast, if known
+    bool                                      mValid = true;
+};
+
+#endif // COLORSTATISTICS_H
@@ -0,0 +1,313 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "crowdMetrics.h"
+
+#include "importHelper.h"
+#include "logger.h"
+
+#include <QDir>
+#include <QDomElement>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+/// reads "x1 y1 x2 y2 ..."
+QVector<QPointF> readPoints(const QString &text)
+{
+    const QStringList values = text.split(' ', Qt::SkipEmptyParts);
+    QVector<QPointF>  points;
+    for(int i = 0; i + 1 < values.size(); i += 2)
+    {
+        points.append(QPointF(values[i].toDouble(), values[i + 1].toDouble()));
+    }
+    return points;
+}
+
+QString writePoints(const QVector<QPointF> &points)
+{
+    QStringList values;
+    for(const QPointF &point : points)
+    {
+        values << QString::number(point.x()) << QString::number(point.y());
+    }
+    return values.join(' ');
+}
+
+/// positive, if point is left of line seen from p1 to p2 (with the y-axis pointing up)
+double side(const QLineF &line, const QPointF &point)
+{
+    return line.dx() * (point.y() - line.y1()) - line.dy() * (point.x() - line.x1());
+}
+} // namespace
+
+/// Removes the measurement geometry and all measured frames
+void CrowdMetrics::reset()
+{
+    *this = CrowdMetrics();
+}
+
+void CrowdMetrics::setAreas(std::vector<Area> areas)
+{
+    mAreas = std::move(areas);
+}
+
+void CrowdMetrics::setLines(std::vector<Line> lines)
+{
+    mLines = std::move(lines);
+}
+
+void CrowdMetrics::setGridCellSize(double cellSize)
+{
+    mGridCellSize = std::max(cellSize, 0.);
+}
+
+/// Returns whether there is something to measure and a file to write it to
+bool CrowdMetrics::isEnabled() const
+{
+    return !mFileName.isEmpty() && (!mAreas.empty() || !mLines.empty() || mGridCellSize > 0);
+}
+
+/// Starts measuring the frames processed from now on, if enabled
+void CrowdMetrics::start()
+{
+    mFrames.clear();
+    mRunning = isEnabled();
+}
+
+/**
+ * @brief Stops measuring and writes the measured frames
+ *
+ * @return false, if the files could not be written
+ */
+bool CrowdMetrics::finish()
+{
+    if(!mRunning)
+    {
+        return true;
+    }
+    mRunning = false;
+    return write(mFileName);
+}
+
+/**
+ * @brief Measures frame, replacing former values of the frame
+ *
+ * @param frame measured frame
+ * @param positions positions of the persons in frame
+ * @param previous positions of the persons in the frame before, for the crossings of the lines
+ */
+void CrowdMetrics::setFrame(
+    int                              frame,
+    const std::vector<LivePosition> &positions,
+    const std::vector<LivePosition> &previous)
+{
+    FrameMetrics metrics;
+    metrics.persons = static_cast<int>(positions.size());
+
+    metrics.areaCounts.assign(mAreas.size(), 0);
+    for(const auto &position : positions)
+    {
+        for(size_t a = 0; a < mAreas.size(); ++a)
+        {
+            if(mAreas[a].polygon.containsPoint(position.world, Qt::OddEvenFill))
+            {
+                ++metrics.areaCounts[a];
+            }
+        }
+    }
+
+    metrics.forward.assign(mLines.size(), 0);
+    metrics.backward.assign(mLines.size(), 0);
+    if(!mLines.empty())
+    {
+        std::unordered_map<int, QPointF> before;
+        for(const auto &position : previous)
+        {
+            before[position.id] = position.world;
+        }
+        for(const auto &position : positions)
+        {
+            const auto from = before.find(position.id);
+            if(from == before.end())
+            {
+                continue;
+            }
+            const QLineF step(from->second, position.world);
+            for(size_t l = 0; l < mLines.size(); ++l)
+            {
+                if(step.intersects(mLines[l].line, nullptr) != QLineF::BoundedIntersection)
+                {
+                    continue;
+                }
+                auto &crossings = side(mLines[l].line, step.p1()) > 0 ? metrics.forward : metrics.backward;
+                ++crossings[l];
+            }
+        }
+    }
+
+    if(mGridCellSize > 0)
+    {
+        std::map<std::pair<int, int>, int> counts;
+        for(const auto &position : positions)
+        {
+            const int column = static_cast<int>(std::floor(position.world.x() / mGridCellSize));
+            const int row    = static_cast<int>(std::floor(position.world.y() / mGridCellSize));
+            ++counts[{column, row}];
+        }
+        metrics.cells.reserve(counts.size());
+        for(const auto &[cell, count] : counts)
+        {
+            metrics.cells.push_back({cell.first, cell.second, count});
+        }
+    }
+
+    mFrames[frame] = std::move(metrics);
+}
+
+/// File of the density maps written next to the time series fileName
+QString CrowdMetrics::gridFileName(const QString &fileName)
+{
+    const QFileInfo info(fileName);
+    return info.dir().filePath(info.completeBaseName() + "_grid.csv");
+}
+
+/**
+ * @brief Writes the time series of the measured frames
+ *
+ * fileName gets one line per frame with the number of persons, the counts of the areas
+ * and the forward and backward crossings of the lines. With a grid, the density of the
+ * occupied cells is written to gridFileName(), one line per frame and cell with the
+ * corner of the cell with the smallest coordinates in cm and the density in persons per m^2.
+ */
+bool CrowdMetrics::write(const QString &fileName) const
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not write the crowd metrics {}.", fileName);
+        return false;
+    }
+    QTextStream out(&file);
+    out << "frame,persons";
+    for(const auto &area : mAreas)
+    {
+        out << "," << area.name;
+    }
+    for(const auto &line : mLines)
+    {
+        out << "," << line.name << "_forward," << line.name << "_backward";
+    }
+    out << "\n";
+    for(const auto &[frame, metrics] : mFrames)
+    {
+        out << frame << "," << metrics.persons;
+        for(int count : metrics.areaCounts)
+        {
+            out << "," << count;
+        }
+        for(size_t l = 0; l < metrics.forward.size(); ++l)
+        {
+            out << "," << metrics.forward[l] << "," << metrics.backward[l];
+        }
+        out << "\n";
+    }
+    SPDLOG_INFO("Wrote the crowd metrics of {} frames to {}.", mFrames.size(), fileName);
+
+    if(mGridCellSize <= 0)
+    {
+        return true;
+    }
+    QFile gridFile(gridFileName(fileName));
+    if(!gridFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not write the density maps {}.", gridFileName(fileName));
+        return false;
+    }
+    const double cellArea = mGridCellSize * mGridCellSize / 10000.; // in m^2
+    QTextStream  gridOut(&gridFile);
+    gridOut << "frame,x,y,density\n";
+    for(const auto &[frame, metrics] : mFrames)
+    {
+        for(const auto &cell : metrics.cells)
+        {
+            gridOut << frame << "," << cell.column * mGridCellSize << "," << cell.row * mGridCellSize << ","
+                    << cell.count / cellArea << "\n";
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Saves the measurement geometry
+ *
+ * Results in the following structure:
+ *     <CROWD_METRICS FILE="metrics.csv" GRID_CELL_SIZE="100">
+ *         <AREA NAME="entrance" POINTS="0 0 200 0 200 200 0 200"/>
+ *         <LINE NAME="door" POINTS="0 0 0 300"/>
+ *     </CROWD_METRICS>
+ */
+void CrowdMetrics::setXml(QDomElement &elem) const
+{
+    elem.setAttribute("FILE", mFileName);
+    elem.setAttribute("GRID_CELL_SIZE", mGridCellSize);
+    for(const auto &area : mAreas)
+    {
+        auto subElem = elem.ownerDocument().createElement("AREA");
+        subElem.setAttribute("NAME", area.name);
+        subElem.setAttribute("POINTS", writePoints(area.polygon));
+        elem.appendChild(subElem);
+    }
+    for(const auto &line : mLines)
+    {
+        auto subElem = elem.ownerDocument().createElement("LINE");
+        subElem.setAttribute("NAME", line.name);
+        subElem.setAttribute("POINTS", writePoints({line.line.p1(), line.line.p2()}));
+        elem.appendChild(subElem);
+    }
+}
+
+void CrowdMetrics::getXml(const QDomElement &elem)
+{
+    reset();
+    setFileName(readQString(elem, "FILE", ""));
+    setGridCellSize(readDouble(elem, "GRID_CELL_SIZE", 0));
+    for(auto subElem = elem.firstChildElement(); !subElem.isNull(); subElem = subElem.nextSiblingElement())
+    {
+        const QString          name   = readQString(subElem, "NAME", "");
+        const QVector<QPointF> points = readPoints(readQString(subElem, "POINTS", ""));
+        if(subElem.tagName() == "AREA" && points.size() >= 3)
+        {
+            mAreas.push_back({name, QPolygonF(points)});
+        }
+        else if(subElem.tagName() == "LINE" && points.size() == 2)
+        {
+            mLines.push_back({name, QLineF(points[0], points[1])});
+        }
+        else
+        {
+            SPDLOG_WARN("Ignoring the invalid crowd measurement {} {}.", subElem.tagName(), name);
+        }
+    }
+}
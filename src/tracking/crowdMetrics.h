@@ -0,0 +1,114 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CROWDMETRICS_H
+#define CROWDMETRICS_H
+
+#include "livePublisher.h"
+
+#include <QLineF>
+#include <QPolygonF>
+#include <QString>
+#include <map>
+#include <vector>
+
+class QDomElement;
+
+/**
+ * @brief Crowd measures aggregated per frame while trackAll() runs
+ *
+ * Instead of exporting the trajectories and measuring them in another pass, every
+ * processed frame updates
+ * - the number of persons inside each measurement area,
+ * - the number of persons crossing each measurement line since the previous frame and
+ * - the number of persons in each cell of a grid, i.e. the density map.
+ *
+ * All geometry is on the ground plane in cm, like the exported world coordinates.
+ * Frames processed again (e.g. by the backward pass of trackAll()) replace their
+ * former values, so every frame is counted once.
+ */
+class CrowdMetrics
+{
+public:
+    struct Area
+    {
+        QString   name;
+        QPolygonF polygon;
+    };
+
+    /// crossings from the left to the right of the line seen from p1 to p2 are counted as forward
+    struct Line
+    {
+        QString name;
+        QLineF  line;
+    };
+
+    struct GridCell
+    {
+        int column;
+        int row;
+        int count;
+    };
+
+    struct FrameMetrics
+    {
+        int                   persons = 0;
+        std::vector<int>      areaCounts; ///< in the order of the areas
+        std::vector<int>      forward;    ///< crossings in the order of the lines
+        std::vector<int>      backward;
+        std::vector<GridCell> cells; ///< occupied cells only
+    };
+
+    void reset();
+
+    void                     setFileName(const QString &fileName) { mFileName = fileName; }
+    const QString           &getFileName() const { return mFileName; }
+    void                     setAreas(std::vector<Area> areas);
+    const std::vector<Area> &getAreas() const { return mAreas; }
+    void                     setLines(std::vector<Line> lines);
+    const std::vector<Line> &getLines() const { return mLines; }
+    void                     setGridCellSize(double cellSize);
+    double                   getGridCellSize() const { return mGridCellSize; }
+
+    bool isEnabled() const;
+    bool isRunning() const { return mRunning; }
+    void start();
+    bool finish();
+
+    void setFrame(int frame, const std::vector<LivePosition> &positions, const std::vector<LivePosition> &previous);
+
+    bool                contains(int frame) const { return mFrames.find(frame) != mFrames.end(); }
+    const FrameMetrics &at(int frame) const { return mFrames.at(frame); }
+
+    bool write(const QString &fileName) const;
+    static QString gridFileName(const QString &fileName);
+
+    void setXml(QDomElement &elem) const;
+    void getXml(const QDomElement &elem);
+
+private:
+    QString           mFileName; ///< time series of the areas and lines; the grid is written next to it
+    std::vector<Area> mAreas;
+    std::vector<Line> mLines;
+    double            mGridCellSize = 0; ///< in cm; 0 for no density map
+    bool              mRunning      = false;
+
+    std::map<int, FrameMetrics> mFrames;
+};
+
+#endif // CROWDMETRICS_H
@@ -0,0 +1,396 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "displacementFlow.h"
+
+#include "concurrency.h"
+#include "imageSequenceLoader.h"
+#include "videoDecoder.h"
+
+#include <QDataStream>
+#include <algorithm>
+#include <map>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+namespace
+{
+bool pointLess(const PointFlow &flow, const cv::Point2f &point)
+{
+    return flow.point.x < point.x || (flow.point.x == point.x && flow.point.y < point.y);
+}
+
+/**
+ * @brief Reads the frames of a FrameSource as gray images
+ *
+ * Videos are read sequentially; frames shortly ahead are skipped by grabbing them
+ * instead of seeking.
+ */
+class GrayFrameReader
+{
+public:
+    explicit GrayFrameReader(const FrameSource &source) : mSource(source)
+    {
+        if(!mSource.video.empty())
+        {
+            videoDecoder::open(mCapture, mSource.video, mSource.acceleration);
+        }
+    }
+
+    cv::Mat read(int index)
+    {
+        cv::Mat img;
+        if(!mSource.video.empty())
+        {
+            if(!mCapture.isOpened())
+            {
+                return img;
+            }
+            if(mNext < 0 || index < mNext || index - mNext > MAX_GRABBED_FRAMES)
+            {
+                mCapture.set(cv::CAP_PROP_POS_FRAMES, index);
+                mNext = index;
+            }
+            for(; mNext < index; ++mNext)
+            {
+                mCapture.grab();
+            }
+            if(mCapture.read(img))
+            {
+                ++mNext;
+            }
+            else
+            {
+                img.release();
+                mNext = -1;
+            }
+        }
+        else if(!mSource.images.isEmpty())
+        {
+            if(index >= 0 && index < mSource.images.size())
+            {
+                img = ImageSequenceLoader::readImage(mSource.images.at(index), true);
+            }
+        }
+        else if(mSource.readFrame)
+        {
+            img = mSource.readFrame(index).clone();
+        }
+        if(!img.empty())
+        {
+            videoDecoder::toGrayscale(img);
+        }
+        return img;
+    }
+
+private:
+    /// frames up to this distance are grabbed instead of seeking to them
+    static constexpr int MAX_GRABBED_FRAMES = 50;
+
+    const FrameSource &mSource;
+    cv::VideoCapture   mCapture;
+    int                mNext = -1; ///< index of the next frame read by mCapture; -1 if unknown
+};
+
+/**
+ * @brief Tracks the points from prev into current with Lucas-Kanade on a region around each point
+ *
+ * The region contains the window on the coarsest pyramid level, so the result is the
+ * same as for tracking in the whole filtered image (apart from the image border).
+ */
+std::vector<PointFlow> trackPoints(
+    const cv::Mat                  &prev,
+    const cv::Mat                  &current,
+    const std::vector<cv::Point2f> &points,
+    const FilterGeometry           &geometry,
+    cv::Size                        window,
+    int                             maxLevel)
+{
+    std::vector<PointFlow> flows(points.size());
+    const cv::Rect         bounds(cv::Point(0, 0), geometry.getFilteredSize());
+    const int              radius = (window.width / 2 + 1) << std::max(maxLevel, 0);
+    for(size_t i = 0; i < points.size(); ++i)
+    {
+        flows[i].point = points[i];
+        const cv::Point center(cvRound(points[i].x), cvRound(points[i].y));
+        const cv::Rect  region =
+            cv::Rect(center.x - radius, center.y - radius, 2 * radius + 1, 2 * radius + 1) & bounds;
+        if(prev.empty() || current.empty() || !region.contains(center))
+        {
+            continue;
+        }
+        const cv::Mat     prevPatch    = geometry.remapRegion(prev, region);
+        const cv::Mat     currentPatch = geometry.remapRegion(current, region);
+        const cv::Point2f offset(static_cast<float>(region.x), static_cast<float>(region.y));
+
+        std::vector<cv::Point2f> prevPoint{points[i] - offset};
+        std::vector<cv::Point2f> nextPoint;
+        std::vector<uchar>       status;
+        std::vector<float>       error;
+        cv::calcOpticalFlowPyrLK(prevPatch, currentPatch, prevPoint, nextPoint, status, error, window, maxLevel);
+        if(status[0] == 1)
+        {
+            flows[i].found = true;
+            flows[i].next  = nextPoint[0] + offset;
+        }
+    }
+    return flows;
+}
+} // namespace
+
+/**
+ * @brief Sets the key of the settings the flows belong to; a different key discards all flows
+ */
+void DisplacementCache::setKey(const QByteArray &key)
+{
+    if(key != mKey)
+    {
+        mFrames.clear();
+        mKey = key;
+    }
+}
+
+/// returns the flow of point into frame or nullptr, if it is not cached
+const PointFlow *DisplacementCache::find(int frame, const cv::Point2f &point) const
+{
+    const auto flows = mFrames.find(frame);
+    if(flows == mFrames.end())
+    {
+        return nullptr;
+    }
+    const auto it = std::lower_bound(flows->second.begin(), flows->second.end(), point, pointLess);
+    if(it == flows->second.end() || it->point != point)
+    {
+        return nullptr;
+    }
+    return &*it;
+}
+
+void DisplacementCache::insert(int frame, const PointFlow &flow)
+{
+    auto      &flows = mFrames[frame];
+    const auto it    = std::lower_bound(flows.begin(), flows.end(), flow.point, pointLess);
+    if(it != flows.end() && it->point == flow.point)
+    {
+        *it = flow;
+    }
+    else
+    {
+        flows.insert(it, flow);
+    }
+}
+
+void DisplacementCache::clear()
+{
+    mFrames.clear();
+}
+
+/// binary representation of the flows (without the key) for storing them in the project
+QByteArray DisplacementCache::serialize() const
+{
+    QByteArray  data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    // ordered by frame, so saving the same cache gives the same project file
+    const std::map<int, std::vector<PointFlow>> frames(mFrames.begin(), mFrames.end());
+    out << static_cast<quint32>(frames.size());
+    for(const auto &[frame, flows] : frames)
+    {
+        out << static_cast<qint32>(frame) << static_cast<quint32>(flows.size());
+        for(const auto &flow : flows)
+        {
+            out << flow.point.x << flow.point.y << flow.next.x << flow.next.y << flow.found;
+        }
+    }
+    return data;
+}
+
+/// reads the flows written by serialize(); the cache is empty, if data is invalid
+bool DisplacementCache::deserialize(const QByteArray &data)
+{
+    mFrames.clear();
+    QDataStream in(data);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 numFrames = 0;
+    in >> numFrames;
+    for(quint32 i = 0; i < numFrames && in.status() == QDataStream::Ok; ++i)
+    {
+        qint32  frame    = 0;
+        quint32 numFlows = 0;
+        in >> frame >> numFlows;
+        auto &flows = mFrames[frame];
+        for(quint32 j = 0; j < numFlows && in.status() == QDataStream::Ok; ++j)
+        {
+            PointFlow flow;
+            in >> flow.point.x >> flow.point.y >> flow.next.x >> flow.next.y >> flow.found;
+            flows.push_back(flow);
+        }
+    }
+    if(in.status() != QDataStream::Ok)
+    {
+        mFrames.clear();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @param frameSize size of the decoded frames
+ * @param borderSize border added by the BorderFilter (0 if disabled)
+ * @param flipH, flipV flips of the SwapFilter
+ * @param undistortMap1, undistortMap2 maps of the CalibFilter for the bordered image; empty if disabled
+ */
+FilterGeometry::FilterGeometry(
+    cv::Size       frameSize,
+    int            borderSize,
+    bool           flipH,
+    bool           flipV,
+    const cv::Mat &undistortMap1,
+    const cv::Mat &undistortMap2) :
+    mFilteredSize(frameSize.width + 2 * borderSize, frameSize.height + 2 * borderSize),
+    mBorderSize(borderSize),
+    mFlipH(flipH),
+    mFlipV(flipV)
+{
+    if(undistortMap1.empty())
+    {
+        return;
+    }
+    cv::convertMaps(undistortMap1, undistortMap2, mMapX, mMapY, CV_32FC1);
+    // positions in the flipped, bordered image are moved into the decoded frame
+    if(flipH)
+    {
+        mMapX = static_cast<float>(mFilteredSize.width - 1) - mMapX;
+    }
+    if(flipV)
+    {
+        mMapY = static_cast<float>(mFilteredSize.height - 1) - mMapY;
+    }
+    mMapX -= static_cast<float>(borderSize);
+    mMapY -= static_cast<float>(borderSize);
+}
+
+/**
+ * @brief Returns region of the filtered image computed from frame
+ *
+ * @param frame decoded frame
+ * @param region region inside the filtered image
+ */
+cv::Mat FilterGeometry::remapRegion(const cv::Mat &frame, const cv::Rect &region) const
+{
+    cv::Mat mapX;
+    cv::Mat mapY;
+    if(!mMapX.empty())
+    {
+        mapX = mMapX(region);
+        mapY = mMapY(region);
+    }
+    else
+    {
+        cv::Mat columns(1, region.width, CV_32FC1);
+        for(int x = 0; x < region.width; ++x)
+        {
+            const int filteredX     = region.x + x;
+            const int frameX        = (mFlipH ? mFilteredSize.width - 1 - filteredX : filteredX) - mBorderSize;
+            columns.at<float>(0, x) = static_cast<float>(frameX);
+        }
+        cv::Mat rows(region.height, 1, CV_32FC1);
+        for(int y = 0; y < region.height; ++y)
+        {
+            const int filteredY  = region.y + y;
+            const int frameY     = (mFlipV ? mFilteredSize.height - 1 - filteredY : filteredY) - mBorderSize;
+            rows.at<float>(y, 0) = static_cast<float>(frameY);
+        }
+        cv::repeat(columns, region.height, 1, mapX);
+        cv::repeat(rows, 1, region.width, mapY);
+    }
+    cv::Mat res;
+    cv::remap(frame, res, mapX, mapY, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+    return res;
+}
+
+/**
+ * @brief Computes the optical flow of the points of all jobs without using the Player
+ *
+ * The jobs are split into consecutive chunks, which are processed in parallel. Each
+ * chunk decodes its frames with its own decoder in gray and only filters the regions
+ * around the points. Sources only readable through FrameSource::readFrame are
+ * processed sequentially in the calling thread.
+ *
+ * @param source sequence to read the frames from
+ * @param geometry maps the filtered image, in which the points are given, onto the frames
+ * @param jobs points to track, ordered by frame
+ * @param window window size of Lucas-Kanade
+ * @param maxLevel number of pyramid levels of Lucas-Kanade
+ * @return flows of the points of each job
+ */
+std::vector<std::vector<PointFlow>> computePointFlows(
+    const FrameSource          &source,
+    const FilterGeometry       &geometry,
+    const std::vector<FlowJob> &jobs,
+    cv::Size                    window,
+    int                         maxLevel)
+{
+    std::vector<std::vector<PointFlow>> flows(jobs.size());
+    if(jobs.empty())
+    {
+        return flows;
+    }
+
+    const bool independent = !source.video.empty() || !source.images.isEmpty();
+    // more chunks than threads balance frames with different numbers of persons
+    const int numChunks = independent ? std::min(static_cast<int>(jobs.size()), 4 * concurrency::threadCount()) : 1;
+
+    auto processChunk = [&](int chunk)
+    {
+        const size_t    begin = jobs.size() * chunk / numChunks;
+        const size_t    end   = jobs.size() * (chunk + 1) / numChunks;
+        GrayFrameReader reader(source);
+        cv::Mat         current;
+        int             currentFrame = -1;
+        for(size_t i = begin; i < end; ++i)
+        {
+            const int     frame = jobs[i].frame;
+            const cv::Mat prev  = (currentFrame >= 0 && currentFrame == frame - 1) ? current : reader.read(frame - 1);
+            current             = reader.read(frame);
+            currentFrame        = frame;
+            flows[i]            = trackPoints(prev, current, jobs[i].points, geometry, window, maxLevel);
+        }
+    };
+
+    if(independent)
+    {
+        cv::parallel_for_(
+            cv::Range(0, numChunks),
+            [&](const cv::Range &range)
+            {
+                for(int chunk = range.start; chunk < range.end; ++chunk)
+                {
+                    processChunk(chunk);
+                }
+            },
+            numChunks);
+    }
+    else
+    {
+        processChunk(0);
+    }
+    return flows;
+}
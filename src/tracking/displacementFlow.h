@@ -0,0 +1,124 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISPLACEMENTFLOW_H
+#define DISPLACEMENTFLOW_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <functional>
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// optical flow of a track point from the previous frame into a frame
+struct PointFlow
+{
+    cv::Point2f point; ///< position in the previous frame (filtered image)
+    cv::Point2f next;  ///< tracked position in the frame; only valid if found
+    bool        found = false;
+};
+
+/**
+ * @brief Optical flows of the track points computed for the missing frame detection
+ *
+ * The flow of a point only depends on its position and the two frames, so it can be
+ * reused as long as the settings described by the key (sequence, filters, window
+ * size, pyramid levels) do not change, even if other trajectories are edited.
+ */
+class DisplacementCache
+{
+public:
+    void              setKey(const QByteArray &key);
+    const QByteArray &getKey() const { return mKey; }
+
+    const PointFlow *find(int frame, const cv::Point2f &point) const;
+    void             insert(int frame, const PointFlow &flow);
+    void             clear();
+    bool             isEmpty() const { return mFrames.empty(); }
+
+    QByteArray serialize() const;
+    bool       deserialize(const QByteArray &data);
+
+private:
+    QByteArray                                      mKey;
+    std::unordered_map<int, std::vector<PointFlow>> mFrames; ///< flows into a frame, ordered by point
+};
+
+/**
+ * @brief Maps regions of the filtered image onto the decoded frame
+ *
+ * Folds the swap, border and undistortion filter into one map, like FusedPreprocessor,
+ * so a region around a track point can be filtered without filtering the whole frame.
+ * Brightness/contrast and background subtraction are not applied; the optical flow
+ * does not need them.
+ */
+class FilterGeometry
+{
+public:
+    FilterGeometry(
+        cv::Size       frameSize,
+        int            borderSize,
+        bool           flipH,
+        bool           flipV,
+        const cv::Mat &undistortMap1 = cv::Mat(),
+        const cv::Mat &undistortMap2 = cv::Mat());
+
+    cv::Size getFilteredSize() const { return mFilteredSize; }
+    cv::Mat  remapRegion(const cv::Mat &frame, const cv::Rect &region) const;
+
+private:
+    cv::Size mFilteredSize;
+    int      mBorderSize;
+    bool     mFlipH;
+    bool     mFlipV;
+    cv::Mat  mMapX; ///< position in the frame for every pixel of the filtered image; empty without undistortion
+    cv::Mat  mMapY;
+};
+
+/**
+ * @brief Sequence the displacements are computed on
+ *
+ * Videos and image sequences are decoded by every worker on its own. Other sequences
+ * (e.g. stereo videos) are read through readFrame in the calling thread only.
+ */
+struct FrameSource
+{
+    std::string                 video;
+    cv::VideoAccelerationType   acceleration = cv::VIDEO_ACCELERATION_NONE;
+    QStringList                 images;
+    std::function<cv::Mat(int)> readFrame;
+};
+
+/// points of frame - 1, which are tracked into frame
+struct FlowJob
+{
+    int                      frame;
+    std::vector<cv::Point2f> points;
+};
+
+std::vector<std::vector<PointFlow>> computePointFlows(
+    const FrameSource          &source,
+    const FilterGeometry       &geometry,
+    const std::vector<FlowJob> &jobs,
+    cv::Size                    window,
+    int                         maxLevel);
+
+#endif // DISPLACEMENTFLOW_H
@@ -0,0 +1,105 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "entryZones.h"
+
+#include "tracker.h"
+
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+
+/**
+ * @brief Enables or disables the learning; disabled, no zones are learned
+ */
+void EntryZones::setEnabled(bool enabled)
+{
+    mEnabled = enabled;
+    reset();
+}
+
+/// Forgets the learned zones, e.g. for a new sequence
+void EntryZones::reset()
+{
+    mNumStarts = 0;
+    mZones.clear();
+}
+
+/**
+ * @brief Learns the zones anew from the first points of persons
+ *
+ * The zones are recomputed from all trajectories, so deleted or merged trajectories
+ * do not leave zones behind.
+ *
+ * @param persons all trajectories
+ * @param firstFrame first processed frame; trajectories starting there are ignored
+ * @param cellSize edge length of a cell in pixel, e.g. the size of a head
+ */
+void EntryZones::learn(const std::vector<TrackPerson> &persons, int firstFrame, int cellSize)
+{
+    reset();
+    if(!mEnabled || cellSize <= 0)
+    {
+        return;
+    }
+
+    // (row, column) -> number of starts; ordered, so cells of a row follow each other
+    std::map<std::pair<int, int>, int> starts;
+    for(const auto &person : persons)
+    {
+        if(person.firstFrame() <= firstFrame || person.size() == 0)
+        {
+            continue;
+        }
+        const TrackPoint point = person.at(0);
+        const int        row   = static_cast<int>(std::floor(point.y() / cellSize));
+        const int        col   = static_cast<int>(std::floor(point.x() / cellSize));
+        ++starts[{row, col}];
+        ++mNumStarts;
+    }
+
+    // cells of the zones, each entry cell dilated by its neighbours
+    std::set<std::pair<int, int>> cells;
+    for(const auto &[cell, count] : starts)
+    {
+        if(count < MIN_STARTS)
+        {
+            continue;
+        }
+        for(int row = cell.first - 1; row <= cell.first + 1; ++row)
+        {
+            for(int col = cell.second - 1; col <= cell.second + 1; ++col)
+            {
+                cells.emplace(row, col);
+            }
+        }
+    }
+
+    for(auto cell = cells.begin(); cell != cells.end();)
+    {
+        const int row      = cell->first;
+        const int firstCol = cell->second;
+        int       lastCol  = firstCol;
+        for(++cell; cell != cells.end() && *cell == std::make_pair(row, lastCol + 1); ++cell)
+        {
+            ++lastCol;
+        }
+        mZones.emplace_back(firstCol * cellSize, row * cellSize, (lastCol - firstCol + 1) * cellSize, cellSize);
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTRYZONES_H
+#define ENTRYZONES_H
+
+#include <QRect>
+#include <vector>
+
+class TrackPerson;
+
+/**
+ * @brief Learns where persons enter the image from the starts of the trajectories
+ *
+ * The image is divided into square cells. A cell, in which at least MIN_STARTS trajectories
+ * started, is an entry zone together with its neighbouring cells. Trajectories already
+ * present in the first processed frame did not enter, so they are ignored.
+ *
+ * The zones are only used after MIN_LEARNED_STARTS trajectories started anywhere; before,
+ * the whole border of the recognition ROI is searched for new persons.
+ */
+class EntryZones
+{
+public:
+    static constexpr int MIN_STARTS         = 2;
+    static constexpr int MIN_LEARNED_STARTS = 10;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return mEnabled; }
+
+    void reset();
+    void learn(const std::vector<TrackPerson> &persons, int firstFrame, int cellSize);
+
+    bool isLearned() const { return mEnabled && mNumStarts >= MIN_LEARNED_STARTS; }
+    /// entry zones in the coordinates of the TrackPoints; adjacent cells in a row are merged
+    const std::vector<QRect> &getZones() const { return mZones; }
+
+private:
+    bool               mEnabled   = false;
+    int                mNumStarts = 0; ///< trajectories started after the first frame
+    std::vector<QRect> mZones;
+};
+
+#endif // ENTRYZONES_H
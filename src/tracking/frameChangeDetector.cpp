@@ -0,0 +1,104 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameChangeDetector.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <opencv2/imgproc.hpp>
+
+/**
+ * @brief Enables or disables the detection; disabled, every frame is changed
+ */
+void FrameChangeDetector::setEnabled(bool enabled)
+{
+    mEnabled = enabled;
+    reset();
+}
+
+/// Forgets the last frame and the duplicates, e.g. for a new sequence
+void FrameChangeDetector::reset()
+{
+    mLastFrame = -1;
+    mLastSignature.release();
+    mDuplicateFrames.clear();
+}
+
+/**
+ * @brief Compares frame with the frame given before and keeps its signature for the next frame
+ *
+ * @param frame number of the frame
+ * @param grey grey image of the frame
+ * @param region processed part of grey; the part inside of grey is used
+ * @return how frame changed compared to its predecessor
+ */
+FrameChangeDetector::Change FrameChangeDetector::update(int frame, const cv::Mat &grey, const cv::Rect &region)
+{
+    if(!mEnabled)
+    {
+        return Change::Changed;
+    }
+
+    cv::Mat    sig    = signature(grey, region);
+    const bool follow = mLastFrame != -1 && std::abs(frame - mLastFrame) == 1;
+    const auto change = follow ? classify(sig, mLastSignature) : Change::Changed;
+    if(change == Change::Duplicate)
+    {
+        mDuplicateFrames.push_back(frame);
+    }
+    mLastFrame     = frame;
+    mLastSignature = std::move(sig);
+    return change;
+}
+
+/**
+ * @brief Returns region of grey reduced to at most SIGNATURE_SIZE x SIGNATURE_SIZE cells
+ *
+ * @return signature; empty, if region does not overlap grey
+ */
+cv::Mat FrameChangeDetector::signature(const cv::Mat &grey, const cv::Rect &region)
+{
+    const cv::Rect inside = region & cv::Rect(0, 0, grey.cols, grey.rows);
+    if(inside.empty())
+    {
+        return cv::Mat();
+    }
+    const cv::Size size(std::min(inside.width, SIGNATURE_SIZE), std::min(inside.height, SIGNATURE_SIZE));
+    cv::Mat        sig;
+    cv::resize(grey(inside), sig, size, 0, 0, cv::INTER_AREA);
+    return sig;
+}
+
+/**
+ * @brief Compares two signatures by the largest difference of a cell
+ *
+ * Signatures of different size (e.g. after changing the region) are changed.
+ */
+FrameChangeDetector::Change FrameChangeDetector::classify(const cv::Mat &signature, const cv::Mat &prevSignature)
+{
+    if(signature.empty() || signature.size() != prevSignature.size() || signature.type() != prevSignature.type())
+    {
+        return Change::Changed;
+    }
+    const double difference = cv::norm(signature, prevSignature, cv::NORM_INF);
+    if(difference == 0)
+    {
+        return Change::Duplicate;
+    }
+    return difference <= STATIC_DIFFERENCE ? Change::Static : Change::Changed;
+}
@@ -0,0 +1,69 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMECHANGEDETECTOR_H
+#define FRAMECHANGEDETECTOR_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+/**
+ * @brief Detects duplicate and static frames by a small signature of the processed region
+ *
+ * The signature is the region of the grey image reduced to at most SIGNATURE_SIZE x SIGNATURE_SIZE
+ * cells by averaging. A frame is compared with its predecessor by the largest difference of
+ * a cell, so a single moving person is not averaged away by the static rest of the region:
+ * - without any difference, the frame is a duplicate, e.g. a frame dropped by the camera
+ *   and re-emitted by the encoder,
+ * - with differences up to STATIC_DIFFERENCE grey levels, nothing moved noticeably.
+ *
+ * Frames not following their predecessor directly are always changed.
+ */
+class FrameChangeDetector
+{
+public:
+    enum class Change
+    {
+        Changed,
+        Static,
+        Duplicate
+    };
+
+    static constexpr int    SIGNATURE_SIZE    = 64;
+    static constexpr double STATIC_DIFFERENCE = 2.;
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return mEnabled; }
+
+    void   reset();
+    Change update(int frame, const cv::Mat &grey, const cv::Rect &region);
+
+    /// Duplicate frames found so far, in the order of their detection
+    const std::vector<int> &getDuplicateFrames() const { return mDuplicateFrames; }
+
+    static cv::Mat signature(const cv::Mat &grey, const cv::Rect &region);
+    static Change  classify(const cv::Mat &signature, const cv::Mat &prevSignature);
+
+private:
+    bool             mEnabled   = false;
+    int              mLastFrame = -1; ///< frame of mLastSignature; -1 if there is none
+    cv::Mat          mLastSignature;
+    std::vector<int> mDuplicateFrames;
+};
+
+#endif // FRAMECHANGEDETECTOR_H
@@ -0,0 +1,249 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "framePipeline.h"
+
+#include "logger.h"
+#include "trace.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace
+{
+/// stage given by a function
+class FunctionStage : public FrameStage
+{
+public:
+    FunctionStage(QString name, QStringList inputs, QStringList outputs, FramePipeline::Process process) :
+        mName(std::move(name)), mInputs(std::move(inputs)), mOutputs(std::move(outputs)), mProcess(std::move(process))
+    {
+    }
+
+    QString     name() const override { return mName; }
+    QStringList inputs() const override { return mInputs; }
+    QStringList outputs() const override { return mOutputs; }
+    void        process(FrameData &data) override { mProcess(data); }
+
+private:
+    QString                mName;
+    QStringList            mInputs;
+    QStringList            mOutputs;
+    FramePipeline::Process mProcess;
+};
+
+bool isProvided(const QString &key)
+{
+    return key == FramePipeline::IMAGE || key == FramePipeline::FILTERED || key == FramePipeline::TRAJECTORIES ||
+           key == FramePipeline::DETECTIONS;
+}
+} // namespace
+
+bool FrameData::has(const QString &key) const
+{
+    std::lock_guard lock(mMutex);
+    return mValues.count(key) > 0;
+}
+
+FramePipeline::~FramePipeline()
+{
+    finish();
+}
+
+/**
+ * @brief Appends stage to the pipeline
+ *
+ * The inputs have to be provided by Petrack or be outputs of stages added before, so
+ * the stages cannot depend on each other in a cycle. Names and outputs must be unique.
+ *
+ * @return false, if the stage does not meet these conditions and was not added
+ */
+bool FramePipeline::addStage(std::shared_ptr<FrameStage> stage)
+{
+    finish();
+
+    QStringList available{IMAGE, FILTERED, TRAJECTORIES, DETECTIONS};
+    for(const auto &other : mStages)
+    {
+        if(other.stage->name() == stage->name())
+        {
+            SPDLOG_ERROR("There already is a pipeline stage {}.", stage->name());
+            return false;
+        }
+        available += other.stage->outputs();
+    }
+    const QStringList inputs = stage->inputs();
+    for(const auto &input : inputs)
+    {
+        if(!available.contains(input))
+        {
+            SPDLOG_ERROR("Input {} of the pipeline stage {} is not provided before it.", input, stage->name());
+            return false;
+        }
+    }
+    for(const auto &output : stage->outputs())
+    {
+        if(available.contains(output))
+        {
+            SPDLOG_ERROR("Output {} of the pipeline stage {} is already provided.", output, stage->name());
+            return false;
+        }
+    }
+    mStages.push_back({std::move(stage), inputs});
+    return true;
+}
+
+bool FramePipeline::addStage(
+    const QString     &name,
+    const QStringList &inputs,
+    const QStringList &outputs,
+    Process            process)
+{
+    return addStage(std::make_shared<FunctionStage>(name, inputs, outputs, std::move(process)));
+}
+
+/**
+ * @brief Removes the stage with the given name
+ *
+ * @return false, if there is no such stage or a later stage uses one of its outputs
+ */
+bool FramePipeline::removeStage(const QString &name)
+{
+    finish();
+
+    auto stage = std::find_if(mStages.begin(), mStages.end(), [&](const Stage &s) { return s.stage->name() == name; });
+    if(stage == mStages.end())
+    {
+        return false;
+    }
+    const QStringList outputs = stage->stage->outputs();
+    for(auto later = std::next(stage); later != mStages.end(); ++later)
+    {
+        for(const auto &output : outputs)
+        {
+            if(later->inputs.contains(output))
+            {
+                SPDLOG_ERROR("Pipeline stage {} is needed by {}.", name, later->stage->name());
+                return false;
+            }
+        }
+    }
+    mStages.erase(stage);
+    return true;
+}
+
+bool FramePipeline::isEmpty() const
+{
+    return mStages.empty();
+}
+
+/**
+ * @brief Starts a new frame; waits for the stages of the previous one first
+ */
+void FramePipeline::begin(int frame)
+{
+    finish();
+    if(mStages.empty())
+    {
+        return;
+    }
+    std::lock_guard lock(mMutex);
+    mData = std::make_shared<FrameData>(frame);
+}
+
+/**
+ * @brief Sets a value provided by Petrack and starts the stages waiting for it
+ *
+ * Ignored without a frame in flight, e.g. if the pipeline has no stages.
+ */
+void FramePipeline::provide(const QString &key, std::any value)
+{
+    std::lock_guard lock(mMutex);
+    if(!mData)
+    {
+        return;
+    }
+    mData->set(key, std::move(value));
+    schedule();
+}
+
+/**
+ * @brief Waits for all running stages of the frame in flight and ends it
+ */
+void FramePipeline::finish()
+{
+    std::unique_lock lock(mMutex);
+    mFinished.wait(lock, [this] { return mRunning == 0; });
+    if(!mData)
+    {
+        return;
+    }
+    for(auto &stage : mStages)
+    {
+        if(!stage.started)
+        {
+            SPDLOG_DEBUG("Pipeline stage {} skipped frame {}.", stage.stage->name(), mData->frame());
+        }
+        stage.started = false;
+    }
+    mData.reset();
+}
+
+/// starts the stages whose inputs are available; mMutex has to be locked
+void FramePipeline::schedule()
+{
+    for(auto &stage : mStages)
+    {
+        if(stage.started ||
+           !std::all_of(
+               stage.inputs.begin(), stage.inputs.end(), [this](const QString &input) { return mData->has(input); }))
+        {
+            continue;
+        }
+        stage.started = true;
+        ++mRunning;
+        QtConcurrent::run(&mPool, [this, &stage, data = mData] { run(stage, data); });
+    }
+}
+
+/// processes data with stage on a thread of the pool
+void FramePipeline::run(Stage &stage, const std::shared_ptr<FrameData> &data)
+{
+    TRACE_ZONE("FramePipeline::run");
+    try
+    {
+        stage.stage->process(*data);
+    }
+    catch(const std::exception &error)
+    {
+        LOG_WARN_LIMITED("Pipeline stage {} failed in frame {}: {}", stage.stage->name(), data->frame(), error.what());
+    }
+
+    std::lock_guard lock(mMutex);
+    for(const auto &output : stage.stage->outputs())
+    {
+        if(!data->has(output))
+        {
+            LOG_WARN_LIMITED(
+                "Pipeline stage {} did not set {} in frame {}.", stage.stage->name(), output, data->frame());
+        }
+    }
+    schedule();
+    --mRunning;
+    mFinished.notify_all();
+}
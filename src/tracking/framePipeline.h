@@ -0,0 +1,170 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+
+#include "concurrency.h"
+
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <any>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <stdexcept>
+#include <vector>
+
+class FrameContext;
+
+/// Position of a tracked person in the frame of a FrameData
+struct PersonPosition
+{
+    int         id; ///< number of the person as in the exported trajectories (starting at 1)
+    cv::Point2f pixel;
+};
+
+/**
+ * @brief Data of one frame passed between the stages of a FramePipeline, stored by name
+ *
+ * Every value is set once and can then be read by all stages of the frame. The images
+ * are cv::Mat headers sharing the pixels of the frame processed by Petrack, nothing is
+ * copied. Stages must therefore not modify them.
+ *
+ * The values can be set and read from several threads at once.
+ */
+class FrameData
+{
+public:
+    explicit FrameData(int frame) : mFrame(frame) {}
+
+    int frame() const { return mFrame; }
+
+    bool has(const QString &key) const;
+
+    /// throws std::logic_error, if key was already set
+    template <typename T>
+    void set(const QString &key, T value)
+    {
+        std::lock_guard lock(mMutex);
+        if(!mValues.try_emplace(key, std::move(value)).second)
+        {
+            throw std::logic_error("The frame data " + key.toStdString() + " is set twice.");
+        }
+    }
+
+    /// throws std::out_of_range, if key is not set, and std::bad_any_cast, if it has another type
+    template <typename T>
+    const T &get(const QString &key) const
+    {
+        std::lock_guard lock(mMutex);
+        // the values are never removed, so the reference stays valid without the lock
+        return std::any_cast<const T &>(mValues.at(key));
+    }
+
+private:
+    int                         mFrame;
+    mutable std::mutex          mMutex;
+    std::map<QString, std::any> mValues;
+};
+
+/**
+ * @brief Step of a FramePipeline, which declares the FrameData it reads and writes
+ */
+class FrameStage
+{
+public:
+    virtual ~FrameStage() = default;
+
+    virtual QString     name() const    = 0;
+    virtual QStringList inputs() const  = 0;
+    virtual QStringList outputs() const = 0;
+
+    /// runs on a thread of the pipeline, sets all outputs() in data
+    virtual void process(FrameData &data) = 0;
+};
+
+/**
+ * @brief Runs custom stages on each frame processed by Petrack, on a thread pool
+ *
+ * Petrack keeps filtering, tracking and recognition in their fixed order, because
+ * each of them decides by the results of the others what has to be done for a frame.
+ * It provides their results as FrameData, in this order and only if they were computed:
+ *
+ *  - IMAGE (cv::Mat): the frame as read from the video or camera
+ *  - FILTERED (std::shared_ptr<const FrameContext>): the frame after the filters
+ *  - TRAJECTORIES (std::vector<PersonPosition>): the tracked persons in the frame
+ *  - DETECTIONS (std::vector<cv::Point2f>): the persons recognized in the frame
+ *
+ * As soon as all inputs of a stage are available, the stage is started on the thread
+ * pool, so e.g. a stage on FILTERED runs while the frame is tracked. The outputs of a
+ * stage are available to the stages added after it. finish() waits for all stages of
+ * the frame; stages whose inputs were not provided are skipped for this frame.
+ *
+ * Only one frame is in flight: Petrack calls finish() before it processes the next
+ * frame, because the filters and the decoder reuse the buffers of the shared images.
+ */
+class FramePipeline
+{
+public:
+    inline static const QString IMAGE        = "image";
+    inline static const QString FILTERED     = "filtered";
+    inline static const QString TRAJECTORIES = "trajectories";
+    inline static const QString DETECTIONS   = "detections";
+
+    using Process = std::function<void(FrameData &)>;
+
+    explicit FramePipeline(QThreadPool &pool = concurrency::pool(concurrency::Pool::Stages)) : mPool(pool) {}
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline &)            = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    bool addStage(std::shared_ptr<FrameStage> stage);
+    bool addStage(const QString &name, const QStringList &inputs, const QStringList &outputs, Process process);
+    bool removeStage(const QString &name);
+    bool isEmpty() const;
+
+    void begin(int frame);
+    void provide(const QString &key, std::any value);
+    void finish();
+
+private:
+    struct Stage
+    {
+        std::shared_ptr<FrameStage> stage;
+        QStringList                 inputs; ///< cached, as they are checked whenever new data is available
+        bool                        started = false;
+    };
+
+    void schedule();
+    void run(Stage &stage, const std::shared_ptr<FrameData> &data);
+
+    QThreadPool               &mPool;
+    mutable std::mutex         mMutex;
+    std::condition_variable    mFinished;
+    std::vector<Stage>         mStages;
+    std::shared_ptr<FrameData> mData;        ///< frame in flight; nullptr between finish() and begin()
+    int                        mRunning = 0; ///< stages of mData still running
+};
+
+#endif // FRAMEPIPELINE_H
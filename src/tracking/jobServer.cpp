@@ -0,0 +1,201 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "jobServer.h"
+
+#include "logger.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QProcess>
+#include <algorithm>
+#include <memory>
+
+JobServer::JobServer(int maxJobs, QObject *parent) : QObject(parent), mMaxJobs(std::max(maxJobs, 1))
+{
+    connect(&mServer, &QLocalServer::newConnection, this, &JobServer::acceptClients);
+}
+
+/**
+ * @brief Starts listening on the local socket name
+ *
+ * A socket left over by a server which was not shut down properly is removed.
+ *
+ * @return false, if the socket could not be created
+ */
+bool JobServer::listen(const QString &name)
+{
+    QLocalServer::removeServer(name);
+    if(!mServer.listen(name))
+    {
+        SPDLOG_ERROR("Could not listen on {}: {}", name, mServer.errorString());
+        return false;
+    }
+    SPDLOG_INFO("Waiting for jobs on {} ({} at once).", mServer.fullServerName(), mMaxJobs);
+    return true;
+}
+
+/**
+ * @brief Reads a job from one line of a client
+ *
+ * @param id id given to the job
+ * @return the job without client; std::nullopt, if line is no valid job
+ */
+std::optional<ServerJob> JobServer::parseRequest(const QByteArray &line, int id)
+{
+    QJsonParseError error;
+    const auto      doc = QJsonDocument::fromJson(line, &error);
+    if(error.error != QJsonParseError::NoError || !doc.isObject())
+    {
+        return std::nullopt;
+    }
+    auto job = BatchJobs::parseJob(doc.object(), QDir::current());
+    if(!job)
+    {
+        return std::nullopt;
+    }
+    return ServerJob{id, doc.object()["priority"].toInt(0), std::move(*job), nullptr};
+}
+
+/**
+ * @brief Returns the index of the job in queue to start next
+ *
+ * That is the job with the highest priority and of those the one submitted first.
+ */
+size_t JobServer::nextJob(const std::vector<ServerJob> &queue)
+{
+    const auto next = std::min_element(
+        queue.begin(),
+        queue.end(),
+        [](const ServerJob &lhs, const ServerJob &rhs)
+        { return lhs.priority > rhs.priority || (lhs.priority == rhs.priority && lhs.id < rhs.id); });
+    return static_cast<size_t>(std::distance(queue.begin(), next));
+}
+
+/**
+ * @brief Returns the line sent to a client for a new state of a job
+ */
+QByteArray JobServer::message(int id, const QString &state, QJsonObject details)
+{
+    details["id"]    = id;
+    details["state"] = state;
+    return QJsonDocument(details).toJson(QJsonDocument::Compact) + '\n';
+}
+
+void JobServer::acceptClients()
+{
+    while(QLocalSocket *client = mServer.nextPendingConnection())
+    {
+        connect(client, &QLocalSocket::readyRead, this, [this, client]() { readRequests(client); });
+        connect(client, &QLocalSocket::disconnected, client, &QLocalSocket::deleteLater);
+    }
+}
+
+void JobServer::readRequests(QLocalSocket *client)
+{
+    while(client->canReadLine())
+    {
+        const QByteArray line = client->readLine().trimmed();
+        if(line.isEmpty())
+        {
+            continue;
+        }
+        auto job = parseRequest(line, mNextId);
+        if(!job)
+        {
+            client->write(message(-1, "rejected", {{"request", QString::fromUtf8(line)}}));
+            continue;
+        }
+        ++mNextId;
+        job->client = client;
+        send(*job, "queued");
+        SPDLOG_INFO("Job {} queued: {} {}.", job->id, job->job.action, job->job.project);
+        mQueue.push_back(std::move(*job));
+    }
+    startJobs();
+}
+
+/// starts queued jobs, until maxJobs processes run
+void JobServer::startJobs()
+{
+    while(mRunning < mMaxJobs && !mQueue.empty())
+    {
+        const auto index = nextJob(mQueue);
+        ServerJob  job   = std::move(mQueue[index]);
+        mQueue.erase(mQueue.begin() + static_cast<std::ptrdiff_t>(index));
+
+        auto *process = new QProcess(this);
+        process->setProcessChannelMode(QProcess::MergedChannels);
+        auto timer = std::make_shared<QElapsedTimer>();
+
+        // the log of the child process is its progress, e.g. the percentage of tracked frames
+        connect(
+            process,
+            &QProcess::readyReadStandardOutput,
+            this,
+            [this, process, job]()
+            {
+                while(process->canReadLine())
+                {
+                    send(job, "running", {{"output", QString::fromLocal8Bit(process->readLine()).trimmed()}});
+                }
+            });
+        auto done = [this, process, job, timer](bool succeeded)
+        {
+            const double seconds = static_cast<double>(timer->elapsed()) / 1000.;
+            send(job, succeeded ? "succeeded" : "failed", {{"seconds", seconds}});
+            SPDLOG_INFO("Job {} {} after {:.1f} s.", job.id, succeeded ? "finished" : "failed", seconds);
+            --mRunning;
+            process->deleteLater();
+            startJobs();
+        };
+        connect(
+            process,
+            qOverload<int, QProcess::ExitStatus>(&QProcess::finished),
+            this,
+            [done](int exitCode, QProcess::ExitStatus status)
+            { done(status == QProcess::NormalExit && exitCode == 0); });
+        connect(
+            process,
+            &QProcess::errorOccurred,
+            this,
+            [done](QProcess::ProcessError error)
+            {
+                // finished is not emitted, if the process could not be started
+                if(error == QProcess::FailedToStart)
+                {
+                    done(false);
+                }
+            });
+
+        ++mRunning;
+        send(job, "started");
+        timer->start();
+        process->start(QCoreApplication::applicationFilePath(), *BatchJobs::commandLine(job.job));
+    }
+}
+
+void JobServer::send(const ServerJob &job, const QString &state, const QJsonObject &details) const
+{
+    if(job.client)
+    {
+        job.client->write(message(job.id, state, details));
+    }
+}
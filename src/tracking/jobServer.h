@@ -0,0 +1,89 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include "batchJobs.h"
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+#include <QPointer>
+#include <optional>
+#include <vector>
+
+/// Job submitted to the JobServer
+struct ServerJob
+{
+    int                    id       = 0;
+    int                    priority = 0; ///< higher priorities start first, equal ones in the order of submission
+    BatchJob               job;
+    QPointer<QLocalSocket> client; ///< receives the state of the job; null after it disconnected
+};
+
+/**
+ * @brief Runs jobs submitted over a local socket until PeTrack is terminated
+ *
+ * Clients connect to the local socket (a named pipe on Windows) and send one job per
+ * line as JSON object with the keys of a job of BatchJobs and optionally a priority:
+ *
+ *     {"project": "exp1.pet", "action": "track", "output": "exp1.trc", "priority": 1}
+ *
+ * Relative paths are relative to the working directory of the server. Every job runs
+ * in its own headless PeTrack process; at most maxJobs processes run at once. The server
+ * answers with one JSON object per line for every change of the state of a job:
+ *
+ *     {"id": 0, "state": "queued"}
+ *     {"id": 0, "state": "started"}
+ *     {"id": 0, "state": "running", "output": "Tracking: 10% (100 of 1000 frames)"}
+ *     {"id": 0, "state": "succeeded", "seconds": 12.5}
+ *
+ * Invalid requests are answered with the state rejected and id -1. Jobs of clients
+ * which disconnected still run. The on-disk caches of the projects (filtered frame
+ * store, detection cache, calibration maps) stay filled from one job to the next.
+ */
+class JobServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit JobServer(int maxJobs, QObject *parent = nullptr);
+
+    bool listen(const QString &name);
+
+    static std::optional<ServerJob> parseRequest(const QByteArray &line, int id);
+    static size_t                   nextJob(const std::vector<ServerJob> &queue);
+    static QByteArray               message(int id, const QString &state, QJsonObject details = {});
+
+private:
+    void acceptClients();
+    void readRequests(QLocalSocket *client);
+    void startJobs();
+    void send(const ServerJob &job, const QString &state, const QJsonObject &details = {}) const;
+
+    QLocalServer           mServer;
+    int                    mMaxJobs;
+    int                    mRunning = 0;
+    int                    mNextId  = 0;
+    std::vector<ServerJob> mQueue;
+};
+
+#endif // JOBSERVER_H
@@ -0,0 +1,94 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "liveBudget.h"
+
+#include "logger.h"
+
+#include <algorithm>
+
+/**
+ * @brief Sets the latency budget per frame in ms; 0 disables the adaption
+ */
+void LiveBudget::setBudget(double budget)
+{
+    mBudget = std::max(budget, 0.);
+    reset();
+}
+
+/// Returns to level 0 and forgets the measured latencies, e.g. for a new stream
+void LiveBudget::reset()
+{
+    mLatency         = 0;
+    mLevel           = 0;
+    mFramesSinceLast = 0;
+    mFirst           = true;
+}
+
+/**
+ * @brief Adds the latency of the last processed frame and adapts the level
+ *
+ * @param latency time from the capture to the end of the processing of the frame in ms
+ */
+void LiveBudget::addLatency(double latency)
+{
+    mLatency = mFirst ? latency : SMOOTHING * latency + (1. - SMOOTHING) * mLatency;
+    mFirst   = false;
+    if(!isEnabled() || ++mFramesSinceLast < SETTLE_FRAMES)
+    {
+        return;
+    }
+
+    int level = mLevel;
+    if(mLatency > mBudget)
+    {
+        level = std::min(mLevel + 1, MAX_LEVEL);
+    }
+    else if(mLatency < RECOVERY * mBudget)
+    {
+        level = std::max(mLevel - 1, 0);
+    }
+    if(level != mLevel)
+    {
+        SPDLOG_INFO("Live latency {:.1f} ms (budget {:.1f} ms): load level {}.", mLatency, mBudget, level);
+        mLevel           = level;
+        mFramesSinceLast = 0;
+    }
+}
+
+/**
+ * @brief Returns the recognition step to use instead of the step of the project
+ *
+ * Level 0 recognizes every frame, every further level doubles the step of the project.
+ */
+int LiveBudget::recoStep(int step) const
+{
+    return mLevel == 0 ? 1 : std::max(step, 2) << (mLevel - 1);
+}
+
+/// Returns the pyramid levels of the tracking; one less per level, but at least one, if levels > 0
+int LiveBudget::trackRegionLevels(int levels) const
+{
+    return std::max(std::min(levels, 1), levels - mLevel);
+}
+
+/// Returns the scale of the track region (in tenth of the head size); 10 % smaller per level
+int LiveBudget::trackRegionScale(int scale) const
+{
+    return std::max(1, scale * (10 - mLevel) / 10);
+}
@@ -0,0 +1,64 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIVEBUDGET_H
+#define LIVEBUDGET_H
+
+/**
+ * @brief Adapts the processing of a camera live stream to a latency budget per frame
+ *
+ * The latency of a frame is the time from its capture to the end of its processing.
+ * If the smoothed latency exceeds the budget, the load level rises and the processing
+ * gets cheaper: the recognition runs only every few frames, the tracking uses fewer
+ * pyramid levels and smaller track regions. Once the latency stays well below the
+ * budget, the level drops again. On level 0, every frame is recognized and tracked
+ * with the parameters of the project.
+ *
+ * The level changes at most every SETTLE_FRAMES frames, so the smoothed latency can
+ * follow the previous change first.
+ */
+class LiveBudget
+{
+public:
+    static constexpr int    MAX_LEVEL     = 3;
+    static constexpr int    SETTLE_FRAMES = 10;
+    static constexpr double SMOOTHING     = 0.2; ///< weight of the newest latency
+    static constexpr double RECOVERY      = 0.5; ///< fraction of the budget below which the level drops
+
+    void   setBudget(double budget);
+    double getBudget() const { return mBudget; }
+    bool   isEnabled() const { return mBudget > 0; }
+
+    void   reset();
+    void   addLatency(double latency);
+    double getLatency() const { return mLatency; }
+    int    getLevel() const { return mLevel; }
+
+    int recoStep(int step) const;
+    int trackRegionLevels(int levels) const;
+    int trackRegionScale(int scale) const;
+
+private:
+    double mBudget          = 0; ///< in ms; 0 disables the adaption
+    double mLatency         = 0; ///< smoothed latency in ms
+    int    mLevel           = 0;
+    int    mFramesSinceLast = 0; ///< frames since the last change of the level
+    bool   mFirst           = true;
+};
+
+#endif // LIVEBUDGET_H
@@ -0,0 +1,175 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "markerHints.h"
+
+#include "recognitionResult.h"
+#include "tracker.h"
+
+#include <cstdlib>
+#include <optional>
+
+namespace
+{
+/// index of the nearest unused candidate closer than maxDistance to position; -1, if there is none
+int nearestCandidate(
+    const std::vector<Vec2F> &candidates,
+    const std::vector<bool>  &used,
+    const Vec2F              &position,
+    double                    maxDistance)
+{
+    int nearest = -1;
+    for(std::size_t i = 0; i < candidates.size(); ++i)
+    {
+        const double distance = (candidates[i] - position).length();
+        if(!used[i] && distance < maxDistance)
+        {
+            maxDistance = distance;
+            nearest     = static_cast<int>(i);
+        }
+    }
+    return nearest;
+}
+} // namespace
+
+/**
+ * @brief Enables or disables the hints; disabled, neither anchors nor hints are returned
+ */
+void MarkerHints::setEnabled(bool enabled)
+{
+    mEnabled = enabled;
+    reset();
+}
+
+/// Forgets the hints, e.g. for a new sequence
+void MarkerHints::reset()
+{
+    mFrame = -1;
+    mHints.clear();
+}
+
+/**
+ * @brief Assigns the candidates of frame to the trajectories near them
+ *
+ * First, each trajectory, which ends (or starts) next to frame, gets the nearest candidate
+ * within radius around its predicted position as anchor. Then, each trajectory in frame
+ * without marker ID gets the nearest remaining candidate within radius. Both become the hints
+ * for the neighbouring frames; every candidate is used once at most.
+ *
+ * @param frame frame, in which the candidates were found; its tracking has to be finished
+ * @param candidates centers of the rejected candidates (see candidates())
+ * @param persons all trajectories
+ * @param radius largest distance of a candidate to a trajectory in pixel, e.g. half a head
+ * @return anchors to insert into frame
+ */
+std::vector<MarkerHints::Anchor> MarkerHints::update(
+    int                             frame,
+    const std::vector<Vec2F>       &candidates,
+    const std::vector<TrackPerson> &persons,
+    double                          radius)
+{
+    mFrame = frame;
+    mHints.clear();
+    std::vector<Anchor> anchors;
+    if(!mEnabled || candidates.empty())
+    {
+        return anchors;
+    }
+
+    std::vector<bool> used(candidates.size(), false);
+    for(std::size_t i = 0; i < persons.size(); ++i)
+    {
+        const auto &person = persons[i];
+        if(person.trackPointExist(frame))
+        {
+            continue;
+        }
+        // forward or backward
+        std::optional<MotionPrediction> prediction;
+        for(int fromFrame : {frame - 1, frame + 1})
+        {
+            if(!prediction)
+            {
+                prediction = person.predictPosition(fromFrame, frame);
+            }
+            if(!prediction && person.trackPointExist(fromFrame))
+            {
+                prediction = MotionPrediction{person.trackPointAt(fromFrame), 0};
+            }
+        }
+        if(!prediction)
+        {
+            continue;
+        }
+        const int nearest = nearestCandidate(candidates, used, prediction->position, radius + prediction->uncertainty);
+        if(nearest >= 0)
+        {
+            used[nearest] = true;
+            anchors.push_back({i, candidates[nearest]});
+            mHints.push_back(candidates[nearest]);
+        }
+    }
+
+    for(const auto &person : persons)
+    {
+        if(person.getMarkerID() >= 0 || !person.trackPointExist(frame))
+        {
+            continue;
+        }
+        const int nearest = nearestCandidate(candidates, used, person.trackPointAt(frame), radius);
+        if(nearest >= 0)
+        {
+            used[nearest] = true;
+            mHints.push_back(candidates[nearest]);
+        }
+    }
+    return anchors;
+}
+
+/**
+ * @brief Positions of the candidates near trajectories, if they were found next to frame
+ */
+std::vector<Vec2F> MarkerHints::getHints(int frame) const
+{
+    if(!mEnabled || std::abs(frame - mFrame) != 1)
+    {
+        return {};
+    }
+    return mHints;
+}
+
+/**
+ * @brief Centers of the rejected code marker candidates of result (relative to the image without border)
+ */
+std::vector<Vec2F> MarkerHints::candidates(const reco::RecognitionResult &result)
+{
+    std::vector<Vec2F> centers;
+    for(const auto &overlay : result.codeMarkers)
+    {
+        for(const auto &corners : overlay.rejected)
+        {
+            Vec2F center;
+            for(const auto &corner : corners)
+            {
+                center += Vec2F(corner);
+            }
+            centers.push_back(center / corners.size() + overlay.offset + result.offset);
+        }
+    }
+    return centers;
+}
@@ -0,0 +1,73 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MARKERHINTS_H
+#define MARKERHINTS_H
+
+#include "vector.h"
+
+#include <cstddef>
+#include <vector>
+
+class TrackPerson;
+namespace reco
+{
+struct RecognitionResult;
+}
+
+/**
+ * @brief Uses rejected code marker candidates near trajectories as hints for tracking and recognition
+ *
+ * OpenCV rejects many candidates of code markers, because their code could not be read,
+ * e.g. as the marker is small, blurred or partly covered. Near a trajectory, such a
+ * candidate is most likely the marker of that person, so
+ * - a trajectory, which could not be tracked into the frame, is continued by the nearest
+ *   candidate as anchor point of low quality (ANCHOR_QUAL), so the tracking goes on from
+ *   there instead of losing the person until a recognition finds it again,
+ * - the candidates near trajectories are returned as hints for the recognition of the
+ *   neighbouring frame, which reads them again at a higher resolution.
+ */
+class MarkerHints
+{
+public:
+    /// below the quality of tracked points, so any tracked or recognized point replaces an anchor
+    static constexpr int ANCHOR_QUAL = 30;
+
+    struct Anchor
+    {
+        std::size_t person; ///< index of the person
+        Vec2F       position;
+    };
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return mEnabled; }
+
+    void reset();
+    std::vector<Anchor>
+    update(int frame, const std::vector<Vec2F> &candidates, const std::vector<TrackPerson> &persons, double radius);
+    std::vector<Vec2F> getHints(int frame) const;
+
+    static std::vector<Vec2F> candidates(const reco::RecognitionResult &result);
+
+private:
+    bool               mEnabled = false;
+    int                mFrame   = -1; ///< frame of mHints
+    std::vector<Vec2F> mHints;
+};
+
+#endif // MARKERHINTS_H
@@ -0,0 +1,366 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "multiCameraTracking.h"
+
+#include "logger.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <set>
+
+/**
+ * @brief Reads the camera views and the association parameters from the JSON file cameraFile
+ *
+ * @return false, if the file could not be read or does not contain any camera view
+ */
+bool MultiCameraTracking::load(const QString &cameraFile)
+{
+    QFile file{cameraFile};
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        SPDLOG_ERROR("Could not open the camera file {}.", cameraFile);
+        return false;
+    }
+    QJsonParseError   error;
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll(), &error).object();
+    if(error.error != QJsonParseError::NoError)
+    {
+        SPDLOG_ERROR("Could not parse the camera file {}: {}", cameraFile, error.errorString());
+        return false;
+    }
+
+    const auto cameras = parseCameras(json, QFileInfo(cameraFile).absoluteDir());
+    if(!cameras || cameras->empty())
+    {
+        SPDLOG_ERROR("The camera file {} does not contain valid camera views.", cameraFile);
+        return false;
+    }
+    mCameras             = *cameras;
+    mAssociationDistance = json["associationDistance"].toDouble(DEFAULT_ASSOCIATION_DISTANCE);
+    mMinOverlap          = std::max(1, json["minOverlap"].toInt(DEFAULT_MIN_OVERLAP));
+    return true;
+}
+
+/**
+ * @brief Reads the camera views from the array "cameras" of json
+ *
+ * @param baseDir directory relative paths of the projects refer to
+ * @return the camera views in the order of the file; std::nullopt, if a view has no project
+ */
+std::optional<std::vector<CameraView>> MultiCameraTracking::parseCameras(const QJsonObject &json, const QDir &baseDir)
+{
+    std::vector<CameraView> cameras;
+    for(const auto &value : json["cameras"].toArray())
+    {
+        const QJsonObject camera = value.toObject();
+        if(camera["project"].toString().isEmpty())
+        {
+            SPDLOG_ERROR("Camera view {} has no project.", cameras.size());
+            return std::nullopt;
+        }
+        cameras.push_back({baseDir.absoluteFilePath(camera["project"].toString()), camera["frameOffset"].toInt(0)});
+    }
+    return cameras;
+}
+
+/**
+ * @brief Tracks all camera views at once and writes their merged trajectories to trajectoryFile
+ *
+ * @param trajectoryFile text file with one line per person and frame (like the txt export)
+ * @return false, if one of the processes failed or the file could not be written
+ */
+bool MultiCameraTracking::run(const QString &trajectoryFile)
+{
+    QTemporaryDir dir;
+    if(!dir.isValid())
+    {
+        SPDLOG_ERROR("Could not create a directory for the trajectories of the camera views.");
+        return false;
+    }
+    auto viewFile = [&dir](size_t k) { return dir.filePath(QString("camera%1.txt").arg(k)); };
+
+    std::vector<std::unique_ptr<QProcess>> processes;
+    for(size_t k = 0; k < mCameras.size(); ++k)
+    {
+        // the txt export writes world coordinates; trajectories of the view project are not imported,
+        // otherwise they would be exported and merged in addition to the tracked ones
+        const QStringList arguments{mCameras[k].project, "-noTrajectories", "-autoTrack", viewFile(k), "-headless"};
+
+        auto process = std::make_unique<QProcess>();
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(QCoreApplication::applicationFilePath(), arguments);
+        SPDLOG_INFO("Tracking camera view {} ({}) in process {}.", k, mCameras[k].project, k);
+        processes.push_back(std::move(process));
+    }
+
+    bool ok = true;
+    for(size_t k = 0; k < processes.size(); ++k)
+    {
+        QProcess &process = *processes[k];
+        if(!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+        {
+            SPDLOG_ERROR("Tracking camera view {} ({}) failed.", k, mCameras[k].project);
+            ok = false;
+        }
+    }
+    if(!ok)
+    {
+        return false;
+    }
+
+    std::vector<WorldTrajectory> trajectories;
+    for(size_t k = 0; k < mCameras.size(); ++k)
+    {
+        QFile file{viewFile(k)};
+        if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            SPDLOG_ERROR("Could not read the trajectories of camera view {}.", k);
+            return false;
+        }
+        QTextStream in(&file);
+        const auto  view = readTrajectories(in, static_cast<int>(k), mCameras[k].frameOffset);
+        SPDLOG_INFO("Camera view {}: {} trajectories.", k, view.size());
+        trajectories.insert(trajectories.end(), view.begin(), view.end());
+    }
+
+    const auto merged = associate(trajectories, mAssociationDistance, mMinOverlap);
+    SPDLOG_INFO(
+        "Merged {} trajectories of {} camera views into {}.", trajectories.size(), mCameras.size(), merged.size());
+
+    QFile file{trajectoryFile};
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not write the trajectories to {}.", trajectoryFile);
+        return false;
+    }
+    QTextStream out(&file);
+    writeTrajectories(out, merged);
+    return out.status() == QTextStream::Ok;
+}
+
+/**
+ * @brief Reads the trajectories of a camera view as written by the txt export
+ *
+ * Positions in m (see the header of the file) are converted to cm. Frames missing in
+ * the middle of a trajectory split it into several trajectories.
+ *
+ * @param camera index of the camera view
+ * @param frameOffset added to all frame numbers
+ */
+std::vector<WorldTrajectory> MultiCameraTracking::readTrajectories(QTextStream &in, int camera, int frameOffset)
+{
+    std::vector<WorldTrajectory> trajectories;
+    double                       scale = 1.;
+    while(!in.atEnd())
+    {
+        const QString line = in.readLine().trimmed();
+        if(line.startsWith('#'))
+        {
+            if(line.contains("x/m"))
+            {
+                scale = 100.;
+            }
+            continue;
+        }
+        const auto fields = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+        if(fields.size() < 5)
+        {
+            continue;
+        }
+        const int id    = fields[0].toInt();
+        const int frame = fields[1].toInt() + frameOffset;
+        if(trajectories.empty() || trajectories.back().id != id || trajectories.back().lastFrame() + 1 != frame)
+        {
+            trajectories.push_back({camera, id, frame, {}});
+        }
+        trajectories.back().points.emplace_back(
+            fields[2].toDouble() * scale, fields[3].toDouble() * scale, fields[4].toDouble() * scale);
+    }
+    return trajectories;
+}
+
+/**
+ * @brief Merges the trajectories of the same persons seen by different camera views
+ *
+ * The pairs of trajectories of different views with at least minOverlap common frames,
+ * in which they are on average at most maxDistance apart (on the ground plane), are
+ * associated in the order of their distance. A trajectory is never associated with two
+ * trajectories of the same view, so every merged trajectory contains at most one
+ * trajectory per view. The merged trajectory has the mean position of its trajectories
+ * in every frame.
+ *
+ * @return the merged trajectories followed by the trajectories seen by a single view only
+ */
+std::vector<WorldTrajectory> MultiCameraTracking::associate(
+    const std::vector<WorldTrajectory> &trajectories,
+    double                              maxDistance,
+    int                                 minOverlap)
+{
+    struct Candidate
+    {
+        double distance;
+        size_t a;
+        size_t b;
+    };
+    std::vector<Candidate> candidates;
+    for(size_t a = 0; a < trajectories.size(); ++a)
+    {
+        for(size_t b = a + 1; b < trajectories.size(); ++b)
+        {
+            const auto &ta    = trajectories[a];
+            const auto &tb    = trajectories[b];
+            const int   first = std::max(ta.firstFrame, tb.firstFrame);
+            const int   last  = std::min(ta.lastFrame(), tb.lastFrame());
+            if(ta.camera == tb.camera || last - first + 1 < std::max(minOverlap, 1))
+            {
+                continue;
+            }
+            double sum = 0;
+            for(int frame = first; frame <= last; ++frame)
+            {
+                const Vec3F &pa = ta.points[frame - ta.firstFrame];
+                const Vec3F &pb = tb.points[frame - tb.firstFrame];
+                sum += std::hypot(pa.x() - pb.x(), pa.y() - pb.y());
+            }
+            const double distance = sum / (last - first + 1);
+            if(distance <= maxDistance)
+            {
+                candidates.push_back({distance, a, b});
+            }
+        }
+    }
+    std::stable_sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const Candidate &c1, const Candidate &c2) { return c1.distance < c2.distance; });
+
+    // union-find over the trajectories with the camera views of every group
+    std::vector<size_t> group(trajectories.size());
+    std::iota(group.begin(), group.end(), 0);
+    std::vector<std::set<int>> views(trajectories.size());
+    for(size_t i = 0; i < trajectories.size(); ++i)
+    {
+        views[i].insert(trajectories[i].camera);
+    }
+    auto root = [&group](size_t i)
+    {
+        while(group[i] != i)
+        {
+            i = group[i] = group[group[i]];
+        }
+        return i;
+    };
+    for(const auto &candidate : candidates)
+    {
+        const size_t ra = root(candidate.a);
+        const size_t rb = root(candidate.b);
+        if(ra == rb || std::any_of(
+                           views[rb].begin(), views[rb].end(), [&](int view) { return views[ra].count(view) > 0; }))
+        {
+            continue;
+        }
+        group[rb] = ra;
+        views[ra].insert(views[rb].begin(), views[rb].end());
+    }
+
+    std::vector<std::vector<size_t>> members(trajectories.size());
+    for(size_t i = 0; i < trajectories.size(); ++i)
+    {
+        members[root(i)].push_back(i);
+    }
+
+    // every association needs common frames, so the frames of a group have no gaps
+    std::vector<WorldTrajectory> merged;
+    std::vector<WorldTrajectory> single;
+    for(const auto &indices : members)
+    {
+        if(indices.empty())
+        {
+            continue;
+        }
+        if(indices.size() == 1)
+        {
+            single.push_back(trajectories[indices.front()]);
+            continue;
+        }
+        int first = trajectories[indices.front()].firstFrame;
+        int last  = trajectories[indices.front()].lastFrame();
+        for(size_t i : indices)
+        {
+            first = std::min(first, trajectories[i].firstFrame);
+            last  = std::max(last, trajectories[i].lastFrame());
+        }
+        WorldTrajectory trajectory{-1, trajectories[indices.front()].id, first, {}};
+        trajectory.points.reserve(last - first + 1);
+        for(int frame = first; frame <= last; ++frame)
+        {
+            double x = 0, y = 0, z = 0;
+            int    count = 0;
+            for(size_t i : indices)
+            {
+                const auto &member = trajectories[i];
+                if(frame >= member.firstFrame && frame <= member.lastFrame())
+                {
+                    const Vec3F &point = member.points[frame - member.firstFrame];
+                    x += point.x();
+                    y += point.y();
+                    z += point.z();
+                    ++count;
+                }
+            }
+            trajectory.points.emplace_back(x / count, y / count, z / count);
+        }
+        merged.push_back(std::move(trajectory));
+    }
+    merged.insert(merged.end(), single.begin(), single.end());
+    return merged;
+}
+
+/**
+ * @brief Writes the trajectories in the format of the txt export with positions in cm
+ *
+ * The trajectories are numbered in the given order starting at 1.
+ */
+void MultiCameraTracking::writeTrajectories(QTextStream &out, const std::vector<WorldTrajectory> &trajectories)
+{
+    out << "# id frame x/cm y/cm z/cm\n";
+    for(size_t i = 0; i < trajectories.size(); ++i)
+    {
+        const auto &trajectory = trajectories[i];
+        for(size_t j = 0; j < trajectory.points.size(); ++j)
+        {
+            const Vec3F &point = trajectory.points[j];
+            out << i + 1 << " " << trajectory.firstFrame + static_cast<int>(j) << " " << point.x() << " " << point.y()
+                << " " << point.z() << "\n";
+        }
+    }
+}
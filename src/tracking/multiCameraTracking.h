@@ -0,0 +1,99 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MULTICAMERATRACKING_H
+#define MULTICAMERATRACKING_H
+
+#include "vector.h"
+
+#include <QString>
+#include <optional>
+#include <vector>
+
+class QDir;
+class QJsonObject;
+class QTextStream;
+
+/// One camera view of a multi-camera experiment, tracked with its own project
+struct CameraView
+{
+    QString project;
+    int     frameOffset = 0; ///< added to the frame numbers of the camera to get the common frame numbers
+};
+
+/// Trajectory of one person in world coordinates in cm, one point per frame
+struct WorldTrajectory
+{
+    int                camera     = 0; ///< index of the camera view; -1 for trajectories of several views
+    int                id         = 0; ///< number of the person in its camera view
+    int                firstFrame = 0;
+    std::vector<Vec3F> points;
+
+    int lastFrame() const { return firstFrame + static_cast<int>(points.size()) - 1; }
+};
+
+/**
+ * @brief Tracks several overlapping camera views of one experiment at once and merges them
+ *
+ * The camera file (JSON) lists the project of every camera view, optionally with the
+ * offset of its frame numbers, if the videos were not started at the same time:
+ *
+ *     {
+ *         "cameras": [{"project": "left.pet"}, {"project": "right.pet", "frameOffset": -12}],
+ *         "associationDistance": 40,
+ *         "minOverlap": 10
+ *     }
+ *
+ * Every view runs its own Animation, filters and Tracker in its own headless PeTrack
+ * process, like the segments of SegmentTracking, as the main window can only process one
+ * project at a time. All processes run at once and export the trajectories of their view
+ * in world coordinates via the WorldImageCorrespondence of their project. Hence all
+ * projects need an extrinsic calibration to the same world coordinate system. The
+ * trajectories already stored with the view projects are not loaded by the processes.
+ *
+ * Afterwards, trajectories of different views are associated, if they are on average at
+ * most associationDistance cm apart in at least minOverlap common frames. Associated
+ * trajectories are merged into one trajectory with the mean position of the views.
+ */
+class MultiCameraTracking
+{
+public:
+    static constexpr double DEFAULT_ASSOCIATION_DISTANCE = 40; ///< in cm
+    static constexpr int    DEFAULT_MIN_OVERLAP          = 10; ///< in frames
+
+    bool load(const QString &cameraFile);
+    bool run(const QString &trajectoryFile);
+
+    const std::vector<CameraView> &getCameras() const { return mCameras; }
+    double                         getAssociationDistance() const { return mAssociationDistance; }
+    int                            getMinOverlap() const { return mMinOverlap; }
+
+    static std::optional<std::vector<CameraView>> parseCameras(const QJsonObject &json, const QDir &baseDir);
+
+    static std::vector<WorldTrajectory> readTrajectories(QTextStream &in, int camera, int frameOffset);
+    static std::vector<WorldTrajectory>
+                associate(const std::vector<WorldTrajectory> &trajectories, double maxDistance, int minOverlap);
+    static void writeTrajectories(QTextStream &out, const std::vector<WorldTrajectory> &trajectories);
+
+private:
+    std::vector<CameraView> mCameras;
+    double                  mAssociationDistance = DEFAULT_ASSOCIATION_DISTANCE;
+    int                     mMinOverlap          = DEFAULT_MIN_OVERLAP;
+};
+
+#endif // MULTICAMERATRACKING_H
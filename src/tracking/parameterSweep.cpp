@@ -0,0 +1,354 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "parameterSweep.h"
+
+#include "logger.h"
+#include "personStorage.h"
+#include "petrack.h"
+#include "plausibility.h"
+#include "player.h"
+#include "roiItem.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QProgressDialog>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <memory>
+
+/**
+ * @brief Reads the parameters and thresholds of the sweep from the JSON file sweepFile
+ *
+ * @return false, if the file could not be read or does not contain any parameter
+ */
+bool ParameterSweep::load(const QString &sweepFile)
+{
+    QFile file{sweepFile};
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        SPDLOG_ERROR("Could not open the sweep file {}.", sweepFile);
+        return false;
+    }
+    QJsonParseError   error;
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll(), &error).object();
+    if(error.error != QJsonParseError::NoError)
+    {
+        SPDLOG_ERROR("Could not parse the sweep file {}: {}", sweepFile, error.errorString());
+        return false;
+    }
+
+    const auto parameters = parseParameters(json["parameters"].toObject());
+    if(!parameters || parameters->empty())
+    {
+        SPDLOG_ERROR("The sweep file {} does not contain valid parameters.", sweepFile);
+        return false;
+    }
+    mParameters = *parameters;
+
+    const QJsonObject plausibility = json["plausibility"].toObject();
+    mThresholds.minLength          = plausibility["minLength"].toInt(mThresholds.minLength);
+    mThresholds.insideMargin       = plausibility["insideMargin"].toInt(mThresholds.insideMargin);
+    mThresholds.equalityDistance   = plausibility["equalityDistance"].toDouble(mThresholds.equalityDistance);
+    return true;
+}
+
+/**
+ * @brief Reads the parameters from the object mapping the attribute paths to arrays of values
+ *
+ * @return the parameters in the order of their paths; std::nullopt, if a parameter has no values
+ */
+std::optional<std::vector<SweepParameter>> ParameterSweep::parseParameters(const QJsonObject &json)
+{
+    std::vector<SweepParameter> parameters;
+    for(auto it = json.begin(); it != json.end(); ++it)
+    {
+        SweepParameter parameter{it.key(), {}};
+        for(const auto &value : it.value().toArray())
+        {
+            // numbers keep the notation of the pet file, e.g. 3 instead of 3.0
+            parameter.values << (value.isString() ? value.toString() : value.toVariant().toString());
+        }
+        if(parameter.values.isEmpty() || !parameter.path.contains('/'))
+        {
+            SPDLOG_ERROR("Invalid sweep parameter {}.", parameter.path);
+            return std::nullopt;
+        }
+        parameters.push_back(std::move(parameter));
+    }
+    return parameters;
+}
+
+/**
+ * @brief Returns all combinations of the values of parameters
+ *
+ * The values of the last parameter change fastest.
+ */
+std::vector<SweepConfiguration> ParameterSweep::grid(const std::vector<SweepParameter> &parameters)
+{
+    std::vector<SweepConfiguration> configurations{{}};
+    for(const auto &parameter : parameters)
+    {
+        std::vector<SweepConfiguration> extended;
+        for(const auto &configuration : configurations)
+        {
+            for(const auto &value : parameter.values)
+            {
+                extended.push_back(configuration);
+                extended.back().emplace_back(parameter.path, value);
+            }
+        }
+        configurations = std::move(extended);
+    }
+    return configurations;
+}
+
+/**
+ * @brief Sets the attributes of configuration in the project doc
+ *
+ * @return false, if an element of a path does not exist in doc
+ */
+bool ParameterSweep::apply(QDomDocument &doc, const SweepConfiguration &configuration)
+{
+    for(const auto &[path, value] : configuration)
+    {
+        QStringList elements  = path.split('/');
+        const auto  attribute = elements.takeLast();
+
+        QDomElement elem = doc.firstChildElement("PETRACK");
+        for(const auto &name : elements)
+        {
+            elem = elem.firstChildElement(name);
+        }
+        if(elem.isNull())
+        {
+            SPDLOG_ERROR("The project does not contain the element of the sweep parameter {}.", path);
+            return false;
+        }
+        elem.setAttribute(attribute, value);
+    }
+    return true;
+}
+
+/**
+ * @brief Tracks the sequence with every configuration and writes the statistics to reportFile
+ *
+ * Every configuration is tracked starting without the trajectories of the project. Its
+ * trajectories are kept next to the report as <report>.config<k>.trc.
+ * Afterwards the trajectories of the last successful configuration are stored in this process.
+ *
+ * @param reportFile CSV file with one line per configuration
+ * @param jobs maximum number of child processes running at once
+ * @return false, if the project could not be read or the report could not be written
+ */
+bool ParameterSweep::run(const QString &reportFile, int jobs)
+{
+    QFile        projectFile{mProjectFile};
+    QDomDocument project;
+    if(!projectFile.open(QIODevice::ReadOnly) || !project.setContent(&projectFile))
+    {
+        SPDLOG_ERROR("Could not read the project {}.", mProjectFile);
+        return false;
+    }
+    projectFile.close();
+
+    const auto configurations = grid(mParameters);
+    const auto reportBase     = QFileInfo(reportFile).dir().filePath(QFileInfo(reportFile).completeBaseName());
+
+    // the modified projects are stored next to the original one, so relative paths stay valid
+    const QDir                                   projectDir = QFileInfo(mProjectFile).absoluteDir();
+    std::vector<std::unique_ptr<QTemporaryFile>> projects;
+    QStringList                                  trcFiles;
+    for(size_t k = 0; k < configurations.size(); ++k)
+    {
+        QDomDocument doc = project.cloneNode(true).toDocument();
+        if(!apply(doc, configurations[k]))
+        {
+            return false;
+        }
+        auto file = std::make_unique<QTemporaryFile>(projectDir.filePath(".sweepXXXXXX.pet"));
+        if(!file->open() || file->write(doc.toByteArray()) < 0 || !file->flush())
+        {
+            SPDLOG_ERROR("Could not write the project of configuration {}.", k);
+            return false;
+        }
+        projects.push_back(std::move(file));
+        trcFiles << QString("%1.config%2.trc").arg(reportBase).arg(k);
+    }
+
+    // the child processes do not need to show anything
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("QT_QPA_PLATFORM", "offscreen");
+
+    std::vector<bool> succeeded(configurations.size(), false);
+
+    auto start = [&](size_t k, bool readOnlyCaches)
+    {
+        // without the trajectories of the project, the statistics only cover the tracking of the configuration
+        QStringList arguments{projects[k]->fileName()};
+        arguments << mArguments << "-noTrajectories" << "-autoTrack" << trcFiles[k];
+        if(readOnlyCaches)
+        {
+            arguments << "-readOnlyCaches";
+        }
+        auto process = std::make_unique<QProcess>();
+        process->setProcessEnvironment(environment);
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(QCoreApplication::applicationFilePath(), arguments);
+        SPDLOG_INFO("Tracking configuration {} ({} in total).", k, configurations.size());
+        return process;
+    };
+
+    auto finish = [&](size_t k, QProcess &process)
+    {
+        succeeded[k] =
+            process.waitForFinished(-1) && process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0;
+        if(!succeeded[k])
+        {
+            SPDLOG_ERROR("Tracking configuration {} failed.", k);
+        }
+    };
+
+    // the first run fills the caches, all further runs only read them
+    finish(0, *start(0, false));
+    std::deque<std::pair<size_t, std::unique_ptr<QProcess>>> running;
+    for(size_t k = 1; k < configurations.size() || !running.empty();)
+    {
+        if(k < configurations.size() && running.size() < static_cast<size_t>(std::max(jobs, 1)))
+        {
+            running.emplace_back(k, start(k, true));
+            ++k;
+            continue;
+        }
+        finish(running.front().first, *running.front().second);
+        running.pop_front();
+    }
+
+    std::vector<std::optional<SweepStatistics>> results(configurations.size());
+    for(size_t k = 0; k < configurations.size(); ++k)
+    {
+        if(succeeded[k])
+        {
+            mPetrack.getPersonStorage().clear();
+            mPetrack.importTracker(trcFiles[k]);
+            results[k] = statistics();
+        }
+    }
+    return writeReport(reportFile, configurations, results);
+}
+
+/**
+ * @brief Summarizes the trajectories currently stored and checks their plausibility
+ */
+SweepStatistics ParameterSweep::statistics()
+{
+    const PersonStorage &storage = mPetrack.getPersonStorage();
+    SweepStatistics      stats;
+    stats.numTrajectories = storage.nbPersons();
+    for(size_t i = 0; i < storage.nbPersons(); ++i)
+    {
+        stats.averageLength += storage.at(i).size();
+    }
+    if(stats.numTrajectories > 0)
+    {
+        stats.averageLength /= static_cast<double>(stats.numTrajectories);
+    }
+
+    // the checks report their progress, but there is no need to show it
+    QProgressDialog progress("Check plausibility", nullptr, 0, 400);
+    progress.setMinimumDuration(std::numeric_limits<int>::max());
+
+    const auto failedInside = plausibility::checkInside(
+        storage,
+        &progress,
+        mPetrack.getImageFiltered().size(),
+        mPetrack.getImageBorderSize(),
+        mPetrack.getRecoRoiItem()->rect(),
+        mPetrack.getPlayer()->getFrameInNum(),
+        mPetrack.getPlayer()->getFrameOutNum(),
+        mThresholds.insideMargin);
+
+    stats.failedLength   = plausibility::checkLength(storage, &progress, mThresholds.minLength).size();
+    stats.failedInside   = failedInside.size();
+    stats.failedVelocity = plausibility::checkVelocityVariation(storage, &progress).size();
+    stats.failedEquality =
+        plausibility::checkEquality(storage, &progress, mPetrack, mThresholds.equalityDistance).size();
+    return stats;
+}
+
+/**
+ * @brief Writes one line with the parameter values and statistics per configuration
+ *
+ * The statistics of failed configurations are left empty.
+ */
+bool ParameterSweep::writeReport(
+    const QString                                     &reportFile,
+    const std::vector<SweepConfiguration>             &configurations,
+    const std::vector<std::optional<SweepStatistics>> &results) const
+{
+    QFile file(reportFile);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not write the sweep report {}.", reportFile);
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "configuration";
+    for(const auto &parameter : mParameters)
+    {
+        out << "," << parameter.path;
+    }
+    out << ",trajectories,averageLength,failedLength,failedInside,failedVelocity,failedEquality\n";
+
+    for(size_t k = 0; k < configurations.size(); ++k)
+    {
+        out << k;
+        for(const auto &[path, value] : configurations[k])
+        {
+            out << "," << value;
+        }
+        if(const auto &stats = results[k])
+        {
+            out << "," << stats->numTrajectories << "," << stats->averageLength << "," << stats->failedLength << ","
+                << stats->failedInside << "," << stats->failedVelocity << "," << stats->failedEquality;
+            SPDLOG_INFO(
+                "Configuration {}: {} trajectories, average length {:.1f}, {} failed plausibility checks.",
+                k,
+                stats->numTrajectories,
+                stats->averageLength,
+                stats->failedLength + stats->failedInside + stats->failedVelocity + stats->failedEquality);
+        }
+        else
+        {
+            out << ",,,,,,";
+        }
+        out << "\n";
+    }
+    return out.status() == QTextStream::Ok;
+}
@@ -0,0 +1,113 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <QString>
+#include <QStringList>
+#include <optional>
+#include <utility>
+#include <vector>
+
+class Petrack;
+class QDomDocument;
+class QJsonObject;
+
+/// Values tried for one attribute of the project file
+struct SweepParameter
+{
+    QString     path; ///< elements below PETRACK and the attribute, e.g. "CONTROL/TRACKING/SEARCH_REGION/LEVEL"
+    QStringList values;
+};
+
+/// One value per swept parameter; pairs of path and value
+using SweepConfiguration = std::vector<std::pair<QString, QString>>;
+
+/// Thresholds of the plausibility checks applied to the result of every configuration
+struct SweepThresholds
+{
+    int    minLength        = 10;  ///< trajectories with fewer points fail the length check
+    int    insideMargin     = 30;  ///< margin of the inside check in pixels
+    double equalityDistance = 0.5; ///< distance of the equality check in head sizes
+};
+
+/// Summary of the trajectories tracked with one configuration
+struct SweepStatistics
+{
+    size_t numTrajectories = 0;
+    double averageLength   = 0; ///< in frames
+    size_t failedLength    = 0; ///< number of failed plausibility checks by type
+    size_t failedInside    = 0;
+    size_t failedVelocity  = 0;
+    size_t failedEquality  = 0;
+};
+
+/**
+ * @brief Tracks a sequence with every combination of a grid of parameters
+ *
+ * The sweep file (JSON) lists the values of the parameters to try, given as path of
+ * an attribute in the project file, and optionally the thresholds of the plausibility
+ * checks:
+ *
+ *     {
+ *         "parameters": {"CONTROL/TRACKING/SEARCH_REGION/LEVEL": [2, 3, 4], ...},
+ *         "plausibility": {"minLength": 10, "insideMargin": 30, "equalityDistance": 0.5}
+ *     }
+ *
+ * For every configuration a modified copy of the project is tracked by its own
+ * PeTrack process running -autoTrack, like the segments of SegmentTracking. At most
+ * jobs processes run at once. The first configuration is tracked alone, so it can fill
+ * the filtered frame store and the detection cache (if enabled in the project); all
+ * other processes share them read-only. Afterwards the trajectories of every
+ * configuration are imported into this process and summarized in a CSV report.
+ */
+class ParameterSweep
+{
+public:
+    /// arguments: further command line arguments for the child processes, e.g. -sequence
+    ParameterSweep(Petrack &petrack, QString projectFile, QStringList arguments) :
+        mPetrack(petrack), mProjectFile(std::move(projectFile)), mArguments(std::move(arguments))
+    {
+    }
+
+    bool load(const QString &sweepFile);
+    bool run(const QString &reportFile, int jobs);
+
+    const std::vector<SweepParameter> &getParameters() const { return mParameters; }
+    const SweepThresholds             &getThresholds() const { return mThresholds; }
+
+    static std::optional<std::vector<SweepParameter>> parseParameters(const QJsonObject &json);
+    static std::vector<SweepConfiguration>            grid(const std::vector<SweepParameter> &parameters);
+    static bool                                       apply(QDomDocument &doc, const SweepConfiguration &configuration);
+
+private:
+    SweepStatistics statistics();
+    bool            writeReport(
+        const QString                                     &reportFile,
+        const std::vector<SweepConfiguration>             &configurations,
+        const std::vector<std::optional<SweepStatistics>> &results) const;
+
+    Petrack                    &mPetrack;
+    QString                     mProjectFile;
+    QStringList                 mArguments;
+    std::vector<SweepParameter> mParameters;
+    SweepThresholds             mThresholds;
+};
+
+#endif // PARAMETERSWEEP_H
@@ -0,0 +1,102 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "recoSchedule.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+/**
+ * @brief Enables or disables the adaption; disabled, the step of the project is used
+ */
+void RecoSchedule::setEnabled(bool enabled)
+{
+    mEnabled = enabled;
+    reset();
+}
+
+/// Forgets all observations, e.g. for a new sequence
+void RecoSchedule::reset()
+{
+    mLastFrame  = -1;
+    mUrgent     = 0;
+    mNearBorder = false;
+    mCalmFrames = 0;
+}
+
+/**
+ * @brief Adds the outcome of the tracking of a frame
+ */
+void RecoSchedule::addTracking(const Observation &observation)
+{
+    if(!continues(observation.frame))
+    {
+        reset();
+    }
+    mLastFrame  = observation.frame;
+    mNearBorder = observation.nearBorder > 0;
+
+    if(observation.lost > 0 || observation.uncertain > 0)
+    {
+        mUrgent     = URGENT_FRAMES;
+        mCalmFrames = 0;
+        return;
+    }
+    mUrgent = std::max(mUrgent - 1, 0);
+    // without tracked persons or with persons about to leave, there is nothing to rely on
+    mCalmFrames = (observation.tracked > 0 && !mNearBorder) ? mCalmFrames + 1 : 0;
+}
+
+/**
+ * @brief Adds the outcome of a recognition; new persons end a calm phase
+ *
+ * @param newPersons number of persons created by the recognition
+ */
+void RecoSchedule::addRecognition(int newPersons)
+{
+    if(newPersons > 0)
+    {
+        mCalmFrames = 0;
+    }
+}
+
+/**
+ * @brief Returns the recognition step to use for frame instead of the step of the project
+ */
+int RecoSchedule::recoStep(int step, int frame) const
+{
+    if(!mEnabled || !continues(frame))
+    {
+        return step;
+    }
+    if(mUrgent > 0)
+    {
+        return 1;
+    }
+    if(mNearBorder)
+    {
+        return std::max(1, step / 2);
+    }
+    return std::max(step, 1) << std::min(mCalmFrames / CALM_FRAMES, MAX_STRETCH);
+}
+
+/// Whether frame directly follows (or precedes, when playing backwards) the last observed frame
+bool RecoSchedule::continues(int frame) const
+{
+    return mLastFrame >= 0 && std::abs(frame - mLastFrame) == 1;
+}
@@ -0,0 +1,74 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECOSCHEDULE_H
+#define RECOSCHEDULE_H
+
+/**
+ * @brief Adapts the recognition step to the state of the tracking
+ *
+ * The recognition is the most expensive stage of the processing, but most frames only
+ * confirm persons, who are tracked well anyway. The schedule looks at the outcome of
+ * the tracking of each frame and recognizes
+ * - every frame for URGENT_FRAMES frames after a trajectory was lost or tracked with a
+ *   high error,
+ * - twice as often as the project says while a person is near the border of the
+ *   recognition ROI, where persons enter and leave,
+ * - with doubled step after every CALM_FRAMES frames, in which all persons were tracked
+ *   well and no recognition found a new person, up to MAX_STRETCH doublings.
+ *
+ * Without a jump in the sequence, the observations are only valid for the neighbouring
+ * frame; any other frame starts over with the step of the project.
+ */
+class RecoSchedule
+{
+public:
+    static constexpr int URGENT_FRAMES = 3;
+    static constexpr int CALM_FRAMES   = 25;
+    static constexpr int MAX_STRETCH   = 2; ///< the step grows at most by the factor 2^MAX_STRETCH
+
+    /// Outcome of the tracking of one frame
+    struct Observation
+    {
+        int frame      = 0;
+        int tracked    = 0; ///< number of persons tracked into the frame
+        int lost       = 0; ///< number of persons, which could not be tracked or were deleted
+        int uncertain  = 0; ///< number of persons tracked with an error above the tolerance of the tracker
+        int nearBorder = 0; ///< number of persons near the border of the recognition ROI
+    };
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return mEnabled; }
+
+    void reset();
+    void addTracking(const Observation &observation);
+    void addRecognition(int newPersons);
+
+    int recoStep(int step, int frame) const;
+
+private:
+    bool continues(int frame) const;
+
+    bool mEnabled    = false;
+    int  mLastFrame  = -1; ///< frame of the last observation; -1 if there is none
+    int  mUrgent     = 0;  ///< frames, which still have to be recognized each
+    bool mNearBorder = false;
+    int  mCalmFrames = 0; ///< consecutive frames without lost, uncertain or new persons
+};
+
+#endif // RECOSCHEDULE_H
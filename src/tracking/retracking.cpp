@@ -0,0 +1,148 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "retracking.h"
+
+#include "animation.h"
+#include "logger.h"
+#include "personStorage.h"
+#include "petrack.h"
+#include "tracker.h"
+
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Sets the frames to track; the persons are tracked from firstFrame towards lastFrame
+ *
+ * If lastFrame is smaller than firstFrame, the persons are tracked backwards.
+ */
+void Retracking::setFrameRange(int firstFrame, int lastFrame)
+{
+    mFirstFrame = firstFrame;
+    mLastFrame  = lastFrame;
+}
+
+/**
+ * @brief Tracks the persons from the first to the last frame of the range
+ *
+ * The persons must have a point in the first frame. Like tracking with "show only",
+ * existing points of the persons are only replaced by better ones. The change can be
+ * undone as one step.
+ *
+ * @return false, if nothing could be tracked or the run was aborted by the progress callback
+ */
+bool Retracking::run()
+{
+    if(mPersons.isEmpty())
+    {
+        SPDLOG_WARN("No persons selected for re-tracking.");
+        return false;
+    }
+    if(mPetrack.getStereoContext())
+    {
+        SPDLOG_WARN("Re-tracking single persons is not possible with stereo videos.");
+        return false;
+    }
+
+    Animation     &animation  = *mPetrack.getAnimation();
+    PersonStorage &storage    = mPetrack.getPersonStorage();
+    const int      borderSize = mPetrack.getImageBorderSize();
+    // the grey image of the previous frame has to cover the search window of the current one
+    const int margin = 2 * mPetrack.winSize(nullptr, -1, -1, 0);
+    const int step   = mLastFrame < mFirstFrame ? -1 : 1;
+
+    cv::Rect region = patch(storage, mPersons, mFirstFrame, margin, borderSize);
+    if(region.empty())
+    {
+        SPDLOG_WARN("None of the selected persons exists in frame {}.", mFirstFrame);
+        return false;
+    }
+
+    storage.onManualAction(std::vector<size_t>(mPersons.begin(), mPersons.end()));
+    mPetrack.setBatchProcessing(true);
+
+    // the first frame only provides the previous image to the tracker
+    mPetrack.getTracker()->reset();
+    mPetrack.setRetracking(mPersons, region);
+    mPetrack.processFrame(animation.getFrameAtIndex(mFirstFrame), true, false);
+
+    const int total     = std::abs(mLastFrame - mFirstFrame);
+    int       processed = 0;
+    bool      finished  = true;
+    for(int frame = mFirstFrame; frame != mLastFrame; frame += step)
+    {
+        region = patch(storage, mPersons, frame, margin, borderSize);
+        if(region.empty())
+        {
+            SPDLOG_INFO("All selected persons are lost after frame {}.", frame);
+            break;
+        }
+        mPetrack.setRetracking(mPersons, region);
+        const cv::Mat img = step > 0 ? animation.getNextFrame() : animation.getPreviousFrame();
+        if(img.empty())
+        {
+            break;
+        }
+        mPetrack.processFrame(img, true, false);
+        ++processed;
+        if(mProgressCallback && !mProgressCallback(processed, total))
+        {
+            finished = false;
+            break;
+        }
+    }
+
+    mPetrack.setRetracking({}, cv::Rect());
+    mPetrack.getTracker()->reset();
+    mPetrack.setBatchProcessing(false);
+
+    SPDLOG_INFO("Re-tracked {} person(s) in {} of {} frames.", mPersons.size(), processed, total);
+    return finished;
+}
+
+/**
+ * @brief Bounding box of the persons in frame, enlarged by margin
+ *
+ * @param borderSize size of the border of the filtered image
+ * @return region in the coordinates of the filtered image; empty, if none of the persons exists in frame
+ */
+cv::Rect Retracking::patch(
+    const PersonStorage &storage,
+    const QSet<size_t>  &persons,
+    int                  frame,
+    int                  margin,
+    int                  borderSize)
+{
+    cv::Rect region;
+    for(size_t i : persons)
+    {
+        if(i >= storage.nbPersons() || !storage.at(i).trackPointExist(frame))
+        {
+            continue;
+        }
+        const TrackPoint point = storage.at(i).trackPointAt(frame);
+        const cv::Rect   box(
+            static_cast<int>(std::floor(point.x())) + borderSize - margin,
+            static_cast<int>(std::floor(point.y())) + borderSize - margin,
+            2 * margin + 1,
+            2 * margin + 1);
+        region = region.empty() ? box : region | box;
+    }
+    return region;
+}
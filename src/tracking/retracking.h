@@ -0,0 +1,63 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RETRACKING_H
+#define RETRACKING_H
+
+#include <QSet>
+#include <functional>
+#include <opencv2/core.hpp>
+
+class Petrack;
+class PersonStorage;
+
+/**
+ * @brief Tracks some persons again over a frame range, e.g. to correct a lost trajectory
+ *
+ * Tracking all frames with "show only" set would still filter and convert the whole
+ * frames. Instead, the first frame is decoded with the keyframe index of the Animation
+ * and every following frame is only filtered, converted to grey and tracked inside a
+ * patch around the selected persons (see Petrack::setRetracking()). Neither recognition
+ * nor the view run. The run stops early, once none of the persons is left to track.
+ */
+class Retracking
+{
+public:
+    /// called after every tracked frame; return false to abort
+    using ProgressCallback = std::function<bool(int processed, int total)>;
+
+    explicit Retracking(Petrack &petrack) : mPetrack(petrack) {}
+
+    void setProgressCallback(ProgressCallback callback) { mProgressCallback = std::move(callback); }
+    void setPersons(const QSet<size_t> &persons) { mPersons = persons; }
+    void setFrameRange(int firstFrame, int lastFrame);
+
+    bool run();
+
+    static cv::Rect
+    patch(const PersonStorage &storage, const QSet<size_t> &persons, int frame, int margin, int borderSize);
+
+private:
+    Petrack         &mPetrack;
+    ProgressCallback mProgressCallback;
+    QSet<size_t>     mPersons;
+    int              mFirstFrame = 0;
+    int              mLastFrame  = 0; ///< smaller than mFirstFrame to track backwards
+};
+
+#endif // RETRACKING_H
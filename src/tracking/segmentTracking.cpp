@@ -0,0 +1,231 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "segmentTracking.h"
+
+#include "animation.h"
+#include "compressedFile.h"
+#include "logger.h"
+#include "personStorage.h"
+#include "petrack.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <memory>
+
+/**
+ * @brief Splits [firstFrame, lastFrame] into count segments of about the same length
+ *
+ * Every segment but the last one is extended by overlap frames into the following
+ * segment. count is reduced, if there are fewer frames than segments.
+ *
+ * @return segments in ascending order
+ */
+std::vector<TrackingSegment> SegmentTracking::split(int firstFrame, int lastFrame, int count, int overlap)
+{
+    const long long numFrames = lastFrame - firstFrame + 1;
+    count                     = static_cast<int>(std::clamp<long long>(count, 1, std::max(numFrames, 1LL)));
+
+    std::vector<TrackingSegment> segments;
+    for(int k = 0; k < count; ++k)
+    {
+        const int first = firstFrame + static_cast<int>(k * numFrames / count);
+        const int last  = firstFrame + static_cast<int>((k + 1) * numFrames / count) - 1;
+        segments.push_back({first, std::min(last + std::max(overlap, 0), lastFrame)});
+    }
+    return segments;
+}
+
+/**
+ * @brief Returns the name of the file holding the frame range of the partial result trcFile
+ */
+QString SegmentTracking::segmentInfoFile(const QString &trcFile)
+{
+    QString base = compression::uncompressedName(trcFile);
+    if(base.endsWith(".trc", Qt::CaseInsensitive))
+    {
+        base.chop(4);
+    }
+    return base + ".segment.json";
+}
+
+/**
+ * @brief Stores the frame range tracked for the partial result trcFile
+ *
+ * @return false, if the file could not be written
+ */
+bool SegmentTracking::writeSegmentInfo(const QString &trcFile, const TrackingSegment &segment)
+{
+    QJsonObject json;
+    json["firstFrame"] = segment.firstFrame;
+    json["lastFrame"]  = segment.lastFrame;
+
+    QFile file{segmentInfoFile(trcFile)};
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        SPDLOG_ERROR("Could not write the segment information {}.", file.fileName());
+        return false;
+    }
+    file.write(QJsonDocument(json).toJson());
+    return true;
+}
+
+/**
+ * @brief Reads the frame range tracked for the partial result trcFile
+ *
+ * @return the tracked frames; std::nullopt, if there is no valid segment information
+ */
+std::optional<TrackingSegment> SegmentTracking::readSegmentInfo(const QString &trcFile)
+{
+    QFile file{segmentInfoFile(trcFile)};
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        return std::nullopt;
+    }
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    if(!json.contains("firstFrame") || !json.contains("lastFrame"))
+    {
+        return std::nullopt;
+    }
+    return TrackingSegment{json["firstFrame"].toInt(), json["lastFrame"].toInt()};
+}
+
+/**
+ * @brief Tracks the sequence in count processes and stitches their trajectories
+ *
+ * The child processes open the project without its trajectories, so they only export
+ * the newly tracked ones, which are then stitched to the ones currently stored.
+ *
+ * @param count number of segments and processes
+ * @param overlap number of frames tracked by two neighboring segments
+ * @return false, if one of the processes failed
+ */
+bool SegmentTracking::run(int count, int overlap)
+{
+    const Animation &animation = *mPetrack.getAnimation();
+    const auto       segments  =
+        split(animation.getSourceInFrameNum(), animation.getSourceOutFrameNum(), count, overlap);
+
+    QTemporaryDir dir;
+    if(!dir.isValid())
+    {
+        SPDLOG_ERROR("Could not create a directory for the trajectories of the segments.");
+        return false;
+    }
+
+    // the child processes do not need to show anything
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("QT_QPA_PLATFORM", "offscreen");
+
+    std::vector<std::unique_ptr<QProcess>> processes;
+    for(size_t k = 0; k < segments.size(); ++k)
+    {
+        QStringList arguments = mProjectArguments;
+        arguments << "-noTrajectories" << "-autoTrack" << dir.filePath(QString("segment%1.trc").arg(k)) << "-frameRange"
+                  << QString::number(segments[k].firstFrame) << QString::number(segments[k].lastFrame);
+
+        auto process = std::make_unique<QProcess>();
+        process->setProcessEnvironment(environment);
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        process->start(QCoreApplication::applicationFilePath(), arguments);
+        SPDLOG_INFO("Tracking frames {} to {} in process {}.", segments[k].firstFrame, segments[k].lastFrame, k);
+        processes.push_back(std::move(process));
+    }
+
+    bool ok = true;
+    for(size_t k = 0; k < processes.size(); ++k)
+    {
+        QProcess &process = *processes[k];
+        if(!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+        {
+            SPDLOG_ERROR("Tracking frames {} to {} failed.", segments[k].firstFrame, segments[k].lastFrame);
+            ok = false;
+        }
+    }
+    if(!ok)
+    {
+        return false;
+    }
+
+    QStringList trcFiles;
+    for(size_t k = 0; k < segments.size(); ++k)
+    {
+        trcFiles << dir.filePath(QString("segment%1.trc").arg(k));
+    }
+    return merge(trcFiles);
+}
+
+/**
+ * @brief Stitches the partial results trcFiles of the segments of one sequence
+ *
+ * The frame ranges of the segments are read from their segment information; the
+ * files may be given in any order. The trajectories currently stored are kept; the
+ * ones of the segments are appended in the order of the segments. Only the persons of
+ * a segment are stitched, namely with the persons before them (of the earlier segments
+ * or already stored) in the frames of the segment. The persons of earlier segments end
+ * in the overlap with the segment, so only the overlap is compared for them.
+ *
+ * @return false, if a file misses its segment information
+ */
+bool SegmentTracking::merge(const QStringList &trcFiles)
+{
+    std::vector<std::pair<TrackingSegment, QString>> parts;
+    for(const auto &trcFile : trcFiles)
+    {
+        const auto segment = readSegmentInfo(trcFile);
+        if(!segment)
+        {
+            SPDLOG_ERROR("Missing segment information {} of {}.", segmentInfoFile(trcFile), trcFile);
+            return false;
+        }
+        parts.emplace_back(*segment, trcFile);
+    }
+    std::stable_sort(
+        parts.begin(),
+        parts.end(),
+        [](const auto &a, const auto &b) { return a.first.firstFrame < b.first.firstFrame; });
+
+    PersonStorage &storage = mPetrack.getPersonStorage();
+    for(size_t k = 0; k < parts.size(); ++k)
+    {
+        const TrackingSegment &segment  = parts[k].first;
+        const QString         &trcFile  = parts[k].second;
+        const size_t           firstNew = storage.nbPersons();
+        mPetrack.importTracker(trcFile);
+        if(k > 0 && segment.firstFrame > parts[k - 1].first.lastFrame)
+        {
+            SPDLOG_WARN(
+                "{} does not overlap with {}, its trajectories are not stitched with it.",
+                trcFile,
+                parts[k - 1].second);
+        }
+        if(firstNew == 0)
+        {
+            continue;
+        }
+        const int merged =
+            storage.stitch(firstNew, segment.firstFrame, segment.lastFrame, mPetrack.getHeadSize() / 2.);
+        SPDLOG_INFO("Stitched {} of {} trajectories of {}.", merged, storage.nbPersons() + merged - firstNew, trcFile);
+    }
+    return true;
+}
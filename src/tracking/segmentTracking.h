@@ -0,0 +1,71 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEGMENTTRACKING_H
+#define SEGMENTTRACKING_H
+
+#include <QStringList>
+#include <optional>
+#include <vector>
+
+class Petrack;
+
+struct TrackingSegment
+{
+    int firstFrame;
+    int lastFrame;
+};
+
+/**
+ * @brief Tracks a long sequence in several processes at once
+ *
+ * The frame range of the sequence is split into overlapping segments. Each segment
+ * is tracked by its own PeTrack process (with its own Animation, Tracker and
+ * PersonStorage) running -autoTrack with -frameRange and -noTrajectories, so it
+ * starts without the trajectories of the project. Afterwards the partial
+ * trajectories are imported into the PersonStorage of this process and stitched in
+ * the overlapping frames with PersonStorage::stitch().
+ *
+ * The segments can also be tracked on different machines: every -autoTrack run with
+ * -frameRange writes the tracked frame range next to its .trc file (see
+ * writeSegmentInfo()), so that merge() can stitch the partial results later on.
+ */
+class SegmentTracking
+{
+public:
+    /// projectArguments: command line arguments loading the project in the child processes
+    SegmentTracking(Petrack &petrack, QStringList projectArguments) :
+        mPetrack(petrack), mProjectArguments(std::move(projectArguments))
+    {
+    }
+
+    static std::vector<TrackingSegment> split(int firstFrame, int lastFrame, int count, int overlap);
+
+    static QString                        segmentInfoFile(const QString &trcFile);
+    static bool                           writeSegmentInfo(const QString &trcFile, const TrackingSegment &segment);
+    static std::optional<TrackingSegment> readSegmentInfo(const QString &trcFile);
+
+    bool run(int count, int overlap);
+    bool merge(const QStringList &trcFiles);
+
+private:
+    Petrack    &mPetrack;
+    QStringList mProjectArguments;
+};
+
+#endif // SEGMENTTRACKING_H
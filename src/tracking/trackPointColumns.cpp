@@ -0,0 +1,405 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackPointColumns.h"
+
+#include "tracker.h"
+
+#include <limits>
+#include <utility>
+
+namespace
+{
+std::int16_t toQual(int qual)
+{
+    return static_cast<std::int16_t>(
+        std::clamp<int>(qual, std::numeric_limits<std::int16_t>::min(), std::numeric_limits<std::int16_t>::max()));
+}
+
+// optional columns stay empty as long as all points have the unused value
+
+template <typename T>
+void appendOptional(TrackPointColumn<T> &column, int size, const T &value, const T &unused)
+{
+    if(column.empty())
+    {
+        if(value == unused)
+        {
+            return;
+        }
+        column.fill(size, unused);
+    }
+    column.append(value);
+}
+
+template <typename T>
+void prependOptional(TrackPointColumn<T> &column, int size, const T &value, const T &unused)
+{
+    if(column.empty())
+    {
+        if(value == unused)
+        {
+            return;
+        }
+        column.fill(size, unused);
+    }
+    column.prepend(value);
+}
+
+template <typename T>
+void appendOptional(
+    TrackPointColumn<T>       &column,
+    int                        size,
+    const TrackPointColumn<T> &values,
+    int                        count,
+    const T                   &unused)
+{
+    if(values.empty())
+    {
+        if(!column.empty())
+        {
+            column.append(count, unused);
+        }
+        return;
+    }
+    if(column.empty())
+    {
+        column.fill(size, unused);
+    }
+    column.append(values);
+}
+
+template <typename T>
+void prependOptional(
+    TrackPointColumn<T>       &column,
+    int                        size,
+    const TrackPointColumn<T> &values,
+    int                        count,
+    const T                   &unused)
+{
+    if(values.empty())
+    {
+        if(!column.empty())
+        {
+            column.prepend(count, unused);
+        }
+        return;
+    }
+    if(column.empty())
+    {
+        column.fill(size, unused);
+    }
+    column.prepend(values);
+}
+
+template <typename T>
+void sliceOptional(TrackPointColumn<T> &part, const TrackPointColumn<T> &column, int first, int last)
+{
+    if(!column.empty())
+    {
+        part = column.slice(first, last);
+    }
+}
+
+template <typename T>
+void setOptional(TrackPointColumn<T> &column, int size, int i, const T &value, const T &unused)
+{
+    if(column.empty())
+    {
+        if(value == unused)
+        {
+            return;
+        }
+        column.fill(size, unused);
+    }
+    // unchanged values do not unshare the column
+    if(std::as_const(column)[i] != value)
+    {
+        column[i] = value;
+    }
+}
+
+template <typename T>
+void removeOptional(TrackPointColumn<T> &column, int first, int last)
+{
+    if(!column.empty())
+    {
+        column.remove(first, last);
+    }
+}
+} // namespace
+
+const Vec3F TrackPointColumns::UNUSED_SP{-1., -1., -1.};
+
+TrackPoint TrackPointColumns::ConstIterator::operator*() const
+{
+    return mColumns->at(mIndex);
+}
+
+/**
+ * @brief Assembles the i-th TrackPoint from the columns
+ */
+TrackPoint TrackPointColumns::at(int i) const
+{
+    TrackPoint point(pos(i), qual(i), markerID(i));
+    if(!mColPoint.empty())
+    {
+        point.setColPoint(mColPoint[i]);
+    }
+    if(!mColor.empty())
+    {
+        point.setCol(toColor(mColor[i]));
+    }
+    if(!mSp.empty())
+    {
+        point.setSp(mSp[i]);
+    }
+    if(!mOrientation.empty())
+    {
+        point.setOrientation(mOrientation[i]);
+    }
+    return point;
+}
+
+/**
+ * @brief Number of bytes allocated by the columns
+ */
+std::size_t TrackPointColumns::memoryUsage() const
+{
+    return mX.memoryUsage() + mY.memoryUsage() + mQual.memoryUsage() + mMarkerID.memoryUsage() +
+           mColPoint.memoryUsage() + mColor.memoryUsage() + mSp.memoryUsage() + mOrientation.memoryUsage();
+}
+
+bool TrackPointColumns::isSharedWith(const TrackPointColumns &other) const
+{
+    return mX.isSharedWith(other.mX) && mY.isSharedWith(other.mY) && mQual.isSharedWith(other.mQual) &&
+           mMarkerID.isSharedWith(other.mMarkerID) && mColPoint.isSharedWith(other.mColPoint) &&
+           mColor.isSharedWith(other.mColor) && mSp.isSharedWith(other.mSp) &&
+           mOrientation.isSharedWith(other.mOrientation);
+}
+
+/**
+ * @brief Returns true, if all values are read from a mapped file, i.e. take no memory
+ */
+bool TrackPointColumns::isMapped() const
+{
+    const auto mapped = [](const auto &column) { return column.empty() || column.isMapped(); };
+    return !isEmpty() && mapped(mX) && mapped(mY) && mapped(mQual) && mapped(mMarkerID) && mapped(mColPoint) &&
+           mapped(mColor) && mapped(mSp) && mapped(mOrientation);
+}
+
+/**
+ * @brief Returns true, if no values are stored uncompressed in memory, i.e. all are compressed or mapped
+ */
+bool TrackPointColumns::isCompressed() const
+{
+    const auto compressed = [](const auto &column)
+    { return column.empty() || column.isCompressed() || column.isMapped(); };
+    return !isEmpty() && compressed(mX) && compressed(mY) && compressed(mQual) && compressed(mMarkerID) &&
+           compressed(mColPoint) && compressed(mColor) && compressed(mSp) && compressed(mOrientation);
+}
+
+/**
+ * @brief Compresses the columns in memory (see TrackPointColumn::compress())
+ *
+ * The points are decoded again on the next access; modifying them copies them back into memory.
+ */
+void TrackPointColumns::compress()
+{
+    forEachColumn([](auto &column) { column.compress(); });
+}
+
+/**
+ * @brief Frees the decoded values of the compressed columns, e.g. when the trajectory got cold again
+ */
+void TrackPointColumns::releaseDecoded()
+{
+    forEachColumn([](auto &column) { column.releaseDecoded(); });
+}
+
+/**
+ * @brief Returns the last access of any decoded column (see trackPointCompression::nextUse())
+ *
+ * @return 0, if no column is decoded
+ */
+std::uint64_t TrackPointColumns::lastUse() const
+{
+    return std::max(
+        {mX.lastUse(),
+         mY.lastUse(),
+         mQual.lastUse(),
+         mMarkerID.lastUse(),
+         mColPoint.lastUse(),
+         mColor.lastUse(),
+         mSp.lastUse(),
+         mOrientation.lastUse()});
+}
+
+TrackPoint TrackPointColumns::first() const
+{
+    return at(0);
+}
+
+TrackPoint TrackPointColumns::last() const
+{
+    return at(size() - 1);
+}
+
+void TrackPointColumns::reserve(int count)
+{
+    mX.reserve(count);
+    mY.reserve(count);
+    mQual.reserve(count);
+}
+
+void TrackPointColumns::append(const TrackPoint &point)
+{
+    const int n = size();
+    appendOptional(mMarkerID, n, point.getMarkerID(), -1);
+    appendOptional(mColPoint, n, point.colPoint(), Vec2F());
+    appendOptional(mColor, n, fromColor(point.color()), UNUSED_COLOR);
+    appendOptional(mSp, n, point.sp(), UNUSED_SP);
+    appendOptional(mOrientation, n, point.getOrientation(), cv::Vec3d());
+    mX.append(static_cast<float>(point.x()));
+    mY.append(static_cast<float>(point.y()));
+    mQual.append(toQual(point.qual()));
+}
+
+void TrackPointColumns::prepend(const TrackPoint &point)
+{
+    const int n = size();
+    prependOptional(mMarkerID, n, point.getMarkerID(), -1);
+    prependOptional(mColPoint, n, point.colPoint(), Vec2F());
+    prependOptional(mColor, n, fromColor(point.color()), UNUSED_COLOR);
+    prependOptional(mSp, n, point.sp(), UNUSED_SP);
+    prependOptional(mOrientation, n, point.getOrientation(), cv::Vec3d());
+    mX.prepend(static_cast<float>(point.x()));
+    mY.prepend(static_cast<float>(point.y()));
+    mQual.prepend(toQual(point.qual()));
+}
+
+/**
+ * @brief Appends all points of points at once
+ */
+void TrackPointColumns::append(const TrackPointColumns &points)
+{
+    const int n     = size();
+    const int count = points.size();
+    appendOptional(mMarkerID, n, points.mMarkerID, count, -1);
+    appendOptional(mColPoint, n, points.mColPoint, count, Vec2F());
+    appendOptional(mColor, n, points.mColor, count, UNUSED_COLOR);
+    appendOptional(mSp, n, points.mSp, count, UNUSED_SP);
+    appendOptional(mOrientation, n, points.mOrientation, count, cv::Vec3d());
+    mX.append(points.mX);
+    mY.append(points.mY);
+    mQual.append(points.mQual);
+}
+
+/**
+ * @brief Prepends all points of points at once
+ */
+void TrackPointColumns::prepend(const TrackPointColumns &points)
+{
+    const int n     = size();
+    const int count = points.size();
+    prependOptional(mMarkerID, n, points.mMarkerID, count, -1);
+    prependOptional(mColPoint, n, points.mColPoint, count, Vec2F());
+    prependOptional(mColor, n, points.mColor, count, UNUSED_COLOR);
+    prependOptional(mSp, n, points.mSp, count, UNUSED_SP);
+    prependOptional(mOrientation, n, points.mOrientation, count, cv::Vec3d());
+    mX.prepend(points.mX);
+    mY.prepend(points.mY);
+    mQual.prepend(points.mQual);
+}
+
+/**
+ * @brief Returns the points [first, last) without copying them (see TrackPointColumn::slice())
+ */
+TrackPointColumns TrackPointColumns::slice(int first, int last) const
+{
+    TrackPointColumns part;
+    sliceOptional(part.mMarkerID, mMarkerID, first, last);
+    sliceOptional(part.mColPoint, mColPoint, first, last);
+    sliceOptional(part.mColor, mColor, first, last);
+    sliceOptional(part.mSp, mSp, first, last);
+    sliceOptional(part.mOrientation, mOrientation, first, last);
+    part.mX    = mX.slice(first, last);
+    part.mY    = mY.slice(first, last);
+    part.mQual = mQual.slice(first, last);
+    return part;
+}
+
+void TrackPointColumns::replace(int i, const TrackPoint &point)
+{
+    const int n = size();
+    setOptional(mMarkerID, n, i, point.getMarkerID(), -1);
+    setOptional(mColPoint, n, i, point.colPoint(), Vec2F());
+    setOptional(mColor, n, i, fromColor(point.color()), UNUSED_COLOR);
+    setOptional(mSp, n, i, point.sp(), UNUSED_SP);
+    setOptional(mOrientation, n, i, point.getOrientation(), cv::Vec3d());
+    mX[i]    = static_cast<float>(point.x());
+    mY[i]    = static_cast<float>(point.y());
+    mQual[i] = toQual(point.qual());
+}
+
+/**
+ * @brief Removes the points [first, last)
+ */
+void TrackPointColumns::remove(int first, int last)
+{
+    removeOptional(mMarkerID, first, last);
+    removeOptional(mColPoint, first, last);
+    removeOptional(mColor, first, last);
+    removeOptional(mSp, first, last);
+    removeOptional(mOrientation, first, last);
+    mX.remove(first, last);
+    mY.remove(first, last);
+    mQual.remove(first, last);
+}
+
+void TrackPointColumns::clear()
+{
+    mMarkerID.clear();
+    mColPoint.clear();
+    mColor.clear();
+    mSp.clear();
+    mOrientation.clear();
+    mX.clear();
+    mY.clear();
+    mQual.clear();
+}
+
+void TrackPointColumns::setQual(int i, int qual)
+{
+    mQual[i] = toQual(qual);
+}
+
+void TrackPointColumns::setColor(int i, const QColor &color)
+{
+    setOptional(mColor, size(), i, fromColor(color), UNUSED_COLOR);
+}
+
+void TrackPointColumns::setSp(int i, const Vec3F &sp)
+{
+    setOptional(mSp, size(), i, sp, UNUSED_SP);
+}
+
+void TrackPointColumns::setMarkerID(int i, int markerID)
+{
+    setOptional(mMarkerID, size(), i, markerID, -1);
+}
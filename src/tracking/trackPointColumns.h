@@ -0,0 +1,461 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACKPOINTCOLUMNS_H
+#define TRACKPOINTCOLUMNS_H
+
+#include "trackPointCompression.h"
+#include "vector.h"
+
+#include <QColor>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <opencv2/core.hpp>
+#include <vector>
+
+class TrackPoint;
+
+/**
+ * @brief Contiguous column of values with amortized constant time insertion at both ends
+ *
+ * Free space is kept in front of the first value, so that prepending (as done by the
+ * backward tracking) does not move all values every time.
+ *
+ * The values are shared copy-on-write between copies of a column: copying is O(1) and
+ * the values are only copied when a shared column is modified. Hence snapshots of all
+ * trajectories (undo, autosave) are cheap and stay consistent while the original is
+ * edited. The values of a shared column are never modified, so a snapshot can be read
+ * by another thread. A column can also refer to a part of the shared values (see slice()),
+ * so splitting a trajectory or removing points from its ends does not copy any values.
+ *
+ * The values can also be read from a memory-mapped file (see TrajectorySpillStore and
+ * IO::readTrcIndex()) or be compressed (see compress()); they are copied back into memory
+ * on the first modification. Compressed values are decoded on the first read access and
+ * kept decoded, until releaseDecoded() is called. Reading a compressed column from several
+ * threads at once is safe, as all of them use the values decoded first.
+ */
+template <typename T>
+class TrackPointColumn
+{
+public:
+    using value_type = T;
+
+    int         size() const { return mMapped ? mMappedSize : mSize; }
+    bool        empty() const { return size() == 0; }
+    const T    *data() const { return mMapped ? mMapped : mCompressed ? decoded().data() : values().data() + mBegin; }
+    std::size_t memoryUsage() const
+    {
+        const auto decodedValues = std::atomic_load(&mDecoded);
+        return (mValues ? mValues->capacity() * sizeof(T) : 0) + (mCompressed ? mCompressed->bytes.capacity() : 0) +
+               (decodedValues ? decodedValues->capacity() * sizeof(T) : 0);
+    }
+    bool isShared() const { return mValues.use_count() > 1; }
+    bool isMapped() const { return mMapped != nullptr; }
+    bool isCompressed() const { return mCompressed != nullptr; }
+    bool isDecoded() const { return std::atomic_load(&mDecoded) != nullptr; }
+    /// access counter (see trackPointCompression::nextUse()) of the decoded values; 0, if not decoded
+    std::uint64_t lastUse() const { return isDecoded() ? mCompressed->lastUse.load(std::memory_order_relaxed) : 0; }
+    /// true, if both columns refer to the same, hence unmodified values
+    bool isSharedWith(const TrackPointColumn &other) const
+    {
+        return mValues == other.mValues && mBegin == other.mBegin && mMapped == other.mMapped &&
+               mCompressed == other.mCompressed && size() == other.size();
+    }
+    const T &operator[](int i) const
+    {
+        return mMapped ? mMapped[i] : mCompressed ? decoded()[i] : (*mValues)[mBegin + i];
+    }
+    T &operator[](int i) { return detach()[mBegin + i]; }
+
+    /// replaces the values in memory by their compressed form; mapped columns stay as they are
+    void compress()
+    {
+        if(mMapped || mCompressed || mSize == 0)
+        {
+            return;
+        }
+        auto compressed   = std::make_shared<CompressedValues>();
+        compressed->bytes = trackPointCompression::encode(data(), mSize);
+        mCompressed       = std::move(compressed);
+        mValues.reset();
+        mBegin = 0;
+    }
+    /// frees the decoded values of a compressed column; they are decoded again on the next access
+    void releaseDecoded() { std::atomic_store(&mDecoded, std::shared_ptr<std::vector<T>>()); }
+
+    /**
+     * @brief Reads the size() values from values from now on and frees the memory of the column
+     *
+     * @param values copy of the values, e.g. in a memory-mapped file
+     * @param mapping keeps values valid as long as any copy of the column reads them
+     */
+    void setMapped(const T *values, std::shared_ptr<const void> mapping)
+    {
+        mMappedSize = size();
+        mMapped     = values;
+        mMapping    = std::move(mapping);
+        mValues.reset();
+        uncompress();
+        mBegin = 0;
+        mSize  = 0;
+    }
+
+    /// replaces the column by size values read from values, e.g. from a memory-mapped trajectory index
+    void setMapped(const T *values, int size, std::shared_ptr<const void> mapping)
+    {
+        unmap();
+        mValues.reset();
+        mBegin = 0;
+        mSize  = size;
+        setMapped(values, std::move(mapping));
+    }
+
+    /// returns the values [first, last) in O(1), sharing them with this column
+    TrackPointColumn slice(int first, int last) const
+    {
+        TrackPointColumn part = *this;
+        part.removeEnds(first, last);
+        return part;
+    }
+
+    void append(const T &value)
+    {
+        detach().push_back(value);
+        ++mSize;
+    }
+    void append(int count, const T &value)
+    {
+        auto &values = detach();
+        values.insert(values.end(), count, value);
+        mSize += count;
+    }
+    void append(const TrackPointColumn &other)
+    {
+        auto &values = detach();
+        values.insert(values.end(), other.data(), other.data() + other.size());
+        mSize += other.size();
+    }
+    void reserve(int count) { detach().reserve(mBegin + count); }
+    void prepend(const T &value) { *growFront(1) = value; }
+    void prepend(int count, const T &value) { std::fill_n(growFront(count), count, value); }
+    void prepend(const TrackPointColumn &other)
+    {
+        const int count = other.size();
+        std::copy_n(other.data(), count, growFront(count));
+    }
+    /// replaces the content by count times value
+    void fill(int count, const T &value)
+    {
+        unmap();
+        uncompress();
+        mValues = std::make_shared<std::vector<T>>(count, value);
+        mBegin  = 0;
+        mSize   = count;
+    }
+    /// removes the values [first, last); at the ends without copying or moving any value
+    void remove(int first, int last)
+    {
+        if(first == 0)
+        {
+            removeEnds(last, size());
+        }
+        else if(last == size())
+        {
+            removeEnds(0, first);
+        }
+        else
+        {
+            auto &values = detach();
+            values.erase(values.begin() + mBegin + first, values.begin() + mBegin + last);
+            mSize -= last - first;
+        }
+    }
+    void clear()
+    {
+        unmap();
+        uncompress();
+        mValues.reset();
+        mBegin = 0;
+        mSize  = 0;
+    }
+
+private:
+    static constexpr std::size_t MIN_FRONT_SPACE = 16;
+
+    const std::vector<T> &values() const
+    {
+        static const std::vector<T> noValues;
+        return mValues ? *mValues : noValues;
+    }
+
+    void unmap()
+    {
+        mMapped     = nullptr;
+        mMappedSize = 0;
+        mMapping.reset();
+    }
+
+    void uncompress()
+    {
+        mCompressed.reset();
+        releaseDecoded();
+    }
+
+    /**
+     * @brief Returns the decoded values of a compressed column, decoding them on the first access
+     *
+     * If several threads decode at once, all use the values stored first, so the returned
+     * values stay valid until releaseDecoded() or a modification of the column.
+     */
+    std::vector<T> &decoded() const
+    {
+        auto decodedValues = std::atomic_load(&mDecoded);
+        if(!decodedValues)
+        {
+            auto values = std::make_shared<std::vector<T>>(trackPointCompression::decode<T>(mCompressed->bytes, mSize));
+            if(std::atomic_compare_exchange_strong(&mDecoded, &decodedValues, values))
+            {
+                decodedValues = std::move(values);
+            }
+        }
+        mCompressed->lastUse.store(trackPointCompression::nextUse(), std::memory_order_relaxed);
+        return *decodedValues;
+    }
+
+    /// keeps only the values [first, last); the values themselves stay untouched (and may stay shared)
+    void removeEnds(int first, int last)
+    {
+        if(mCompressed)
+        {
+            detach();
+        }
+        if(mMapped)
+        {
+            mMapped += first;
+            mMappedSize = last - first;
+        }
+        else
+        {
+            mBegin += first;
+            mSize = last - first;
+        }
+    }
+
+    /// makes room for count values in front of the first value and returns a pointer to them
+    T *growFront(int count)
+    {
+        auto &values = detach();
+        if(mBegin < static_cast<std::size_t>(count))
+        {
+            const std::size_t space =
+                std::max<std::size_t>({values.size(), MIN_FRONT_SPACE, static_cast<std::size_t>(count)});
+            values.insert(values.begin(), space, T{});
+            mBegin += space;
+        }
+        mBegin -= count;
+        mSize += count;
+        return values.data() + mBegin;
+    }
+
+    /**
+     * @brief Makes the values unshared (and copies mapped or compressed values into memory) before modifying them
+     *
+     * Only the values of this column are copied; values behind them, which only belonged to
+     * another slice of the same values, are dropped, so appending starts right after the last value.
+     */
+    std::vector<T> &detach()
+    {
+        if(mCompressed)
+        {
+            // the decoded values become the values of the column; they are copied below, if still shared
+            mValues = std::atomic_load(&mDecoded);
+            if(!mValues)
+            {
+                mValues = std::make_shared<std::vector<T>>(trackPointCompression::decode<T>(mCompressed->bytes, mSize));
+            }
+            mBegin = 0;
+            uncompress();
+        }
+        if(mMapped)
+        {
+            mValues = std::make_shared<std::vector<T>>(mMapped, mMapped + mMappedSize);
+            mBegin  = 0;
+            mSize   = mMappedSize;
+            unmap();
+        }
+        else if(!mValues)
+        {
+            mValues = std::make_shared<std::vector<T>>();
+        }
+        else if(mValues.use_count() > 1)
+        {
+            const auto first = mValues->begin() + mBegin;
+            mValues          = std::make_shared<std::vector<T>>(first, first + mSize);
+            mBegin           = 0;
+        }
+        else if(mValues->size() > mBegin + mSize)
+        {
+            mValues->resize(mBegin + mSize);
+        }
+        return *mValues;
+    }
+
+    std::shared_ptr<std::vector<T>> mValues;
+    std::size_t                     mBegin = 0; ///< index of the first value in *mValues
+    int                             mSize  = 0; ///< number of values in *mValues belonging to this column
+
+    const T                    *mMapped     = nullptr; ///< values, if read from a mapping instead of mValues
+    int                         mMappedSize = 0;
+    std::shared_ptr<const void> mMapping; ///< keeps mMapped valid
+
+    std::shared_ptr<const CompressedValues> mCompressed; ///< values, if compressed; mSize is kept
+    mutable std::shared_ptr<std::vector<T>> mDecoded;    ///< decoded mCompressed; only set once while compressed
+};
+
+/**
+ * @brief Column-wise (structure of arrays) storage of the TrackPoints of a TrackPerson
+ *
+ * Positions (as float) and qualities (as int16) are stored for every point in contiguous
+ * columns. The rarely used attributes (color marker, marker ID, stereo point and
+ * orientation) get their columns only if a point with a value different from the default
+ * of TrackPoint is stored; otherwise they take no memory at all. Colors are kept as QRgb
+ * with 8 bit per channel, as written to the trc file. The interface resembles the QList of
+ * TrackPoints used before, but points are returned by value.
+ *
+ * Copies share the columns (see TrackPointColumn); a modification only copies the
+ * columns it touches.
+ */
+class TrackPointColumns
+{
+public:
+    /// iterates over the points, which are assembled on dereferencing
+    class ConstIterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = TrackPoint;
+        using difference_type   = int;
+        using pointer           = void;
+        using reference         = TrackPoint;
+
+        ConstIterator(const TrackPointColumns *columns, int index) : mColumns(columns), mIndex(index) {}
+
+        TrackPoint     operator*() const;
+        ConstIterator &operator++()
+        {
+            ++mIndex;
+            return *this;
+        }
+        ConstIterator operator+(int n) const { return {mColumns, mIndex + n}; }
+        int           operator-(const ConstIterator &other) const { return mIndex - other.mIndex; }
+        bool          operator==(const ConstIterator &other) const { return mIndex == other.mIndex; }
+        bool          operator!=(const ConstIterator &other) const { return mIndex != other.mIndex; }
+
+    private:
+        const TrackPointColumns *mColumns;
+        int                      mIndex;
+    };
+
+    int         size() const { return mX.size(); }
+    bool        isEmpty() const { return mX.empty(); }
+    std::size_t memoryUsage() const;
+
+    /// true, if other is a copy of these columns and neither was modified since
+    bool isSharedWith(const TrackPointColumns &other) const;
+    bool isMapped() const;
+    bool isCompressed() const;
+
+    void          compress();
+    void          releaseDecoded();
+    std::uint64_t lastUse() const;
+
+    /// calls visit(column) for every column, e.g. to move the values into a TrajectorySpillStore
+    template <typename Visitor>
+    void forEachColumn(Visitor &&visit)
+    {
+        visit(mX);
+        visit(mY);
+        visit(mQual);
+        visit(mMarkerID);
+        visit(mColPoint);
+        visit(mColor);
+        visit(mSp);
+        visit(mOrientation);
+    }
+
+    TrackPoint at(int i) const;
+    TrackPoint first() const;
+    TrackPoint last() const;
+
+    TrackPointColumns slice(int first, int last) const;
+
+    ConstIterator cbegin() const { return {this, 0}; }
+    ConstIterator cend() const { return {this, size()}; }
+
+    // direct access to the single attributes of point i
+    double    x(int i) const { return mX[i]; }
+    double    y(int i) const { return mY[i]; }
+    Vec2F     pos(int i) const { return {mX[i], mY[i]}; }
+    int       qual(int i) const { return mQual[i]; }
+    int       markerID(int i) const { return mMarkerID.empty() ? -1 : mMarkerID[i]; }
+    Vec2F     colPoint(int i) const { return mColPoint.empty() ? Vec2F() : mColPoint[i]; }
+    QColor    color(int i) const { return mColor.empty() ? QColor() : toColor(mColor[i]); }
+    Vec3F     sp(int i) const { return mSp.empty() ? UNUSED_SP : mSp[i]; }
+    cv::Vec3d orientation(int i) const { return mOrientation.empty() ? cv::Vec3d() : mOrientation[i]; }
+
+    const float *xData() const { return mX.data(); }
+    const float *yData() const { return mY.data(); }
+
+    /// reserves the always used columns for count points, e.g. before reading a trajectory
+    void reserve(int count);
+    void append(const TrackPoint &point);
+    void append(const TrackPointColumns &points);
+    void prepend(const TrackPoint &point);
+    void prepend(const TrackPointColumns &points);
+    void replace(int i, const TrackPoint &point);
+    void remove(int first, int last);
+    void clear();
+
+    void setQual(int i, int qual);
+    void setColor(int i, const QColor &color);
+    void setSp(int i, const Vec3F &sp);
+    void setMarkerID(int i, int markerID);
+
+private:
+    static const Vec3F    UNUSED_SP;
+    static constexpr QRgb UNUSED_COLOR = 0; ///< stands for an invalid QColor
+
+    static QRgb   fromColor(const QColor &color) { return color.isValid() ? color.rgba() : UNUSED_COLOR; }
+    static QColor toColor(QRgb rgba) { return rgba == UNUSED_COLOR ? QColor() : QColor::fromRgba(rgba); }
+
+    // float is sufficient for pixel positions; the trc file is written with six significant digits
+    TrackPointColumn<float>        mX;
+    TrackPointColumn<float>        mY;
+    TrackPointColumn<std::int16_t> mQual;
+
+    // only allocated if used by any point
+    TrackPointColumn<int>       mMarkerID;
+    TrackPointColumn<Vec2F>     mColPoint;
+    TrackPointColumn<QRgb>      mColor;
+    TrackPointColumn<Vec3F>     mSp;
+    TrackPointColumn<cv::Vec3d> mOrientation;
+};
+
+#endif // TRACKPOINTCOLUMNS_H
@@ -0,0 +1,171 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackPointCompression.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+/// larger (or non-finite) positions are not quantized; their residual holds the whole value
+constexpr double MAX_QUANTIZED_POSITION = 1e9;
+
+void writeUnsigned(std::vector<std::uint8_t> &bytes, std::uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+/// zigzag encoding, so small negative values take few bytes as well
+void writeSigned(std::vector<std::uint8_t> &bytes, std::int64_t value)
+{
+    writeUnsigned(bytes, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+std::uint64_t readUnsigned(const std::uint8_t *&pos)
+{
+    std::uint64_t value = 0;
+    for(int shift = 0;; shift += 7)
+    {
+        const std::uint8_t byte = *pos++;
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if(!(byte & 0x80))
+        {
+            return value;
+        }
+    }
+}
+
+std::int64_t readSigned(const std::uint8_t *&pos)
+{
+    const std::uint64_t value = readUnsigned(pos);
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/// maps the bits of value to an integer with the same order as the floats (-0 before +0)
+std::int64_t ordered(float value)
+{
+    std::int32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits >= 0 ? bits : std::int64_t{std::numeric_limits<std::int32_t>::min()} - bits - 1;
+}
+
+float fromOrdered(std::int64_t value)
+{
+    const auto bits =
+        static_cast<std::int32_t>(value >= 0 ? value : std::numeric_limits<std::int32_t>::min() - value - 1);
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+float dequantize(std::int64_t quantized)
+{
+    return static_cast<float>(quantized / trackPointCompression::POSITION_SCALE);
+}
+} // namespace
+
+namespace trackPointCompression
+{
+/**
+ * @brief Stores each position as difference of its quantized value to the previous one and its residual
+ *
+ * The residual is the distance of the exact value to the quantized one in units in the
+ * last place, so decodePositions() restores every float exactly, including NaN and -0.
+ */
+std::vector<std::uint8_t> encodePositions(const float *values, int size)
+{
+    std::vector<std::uint8_t> bytes;
+    bytes.reserve(size * 3);
+    std::int64_t previous = 0;
+    for(int i = 0; i < size; ++i)
+    {
+        std::int64_t quantized = previous;
+        if(std::isfinite(values[i]) && std::abs(values[i]) < MAX_QUANTIZED_POSITION)
+        {
+            quantized = std::llround(values[i] * POSITION_SCALE);
+        }
+        writeSigned(bytes, quantized - previous);
+        writeSigned(bytes, ordered(values[i]) - ordered(dequantize(quantized)));
+        previous = quantized;
+    }
+    bytes.shrink_to_fit();
+    return bytes;
+}
+
+void decodePositions(const std::vector<std::uint8_t> &bytes, float *values, int size)
+{
+    const std::uint8_t *pos      = bytes.data();
+    std::int64_t        previous = 0;
+    for(int i = 0; i < size; ++i)
+    {
+        previous += readSigned(pos);
+        values[i] = fromOrdered(ordered(dequantize(previous)) + readSigned(pos));
+    }
+}
+
+/**
+ * @brief Stores the values as runs of bytewise equal values: length of the run, followed by the value
+ */
+std::vector<std::uint8_t> encodeRuns(const void *values, int size, std::size_t valueSize)
+{
+    const auto               *data = static_cast<const std::uint8_t *>(values);
+    std::vector<std::uint8_t> bytes;
+    for(int i = 0; i < size;)
+    {
+        const std::uint8_t *value = data + i * valueSize;
+        int                 run   = 1;
+        while(i + run < size && std::memcmp(value, value + run * valueSize, valueSize) == 0)
+        {
+            ++run;
+        }
+        writeUnsigned(bytes, run);
+        bytes.insert(bytes.end(), value, value + valueSize);
+        i += run;
+    }
+    bytes.shrink_to_fit();
+    return bytes;
+}
+
+void decodeRuns(const std::vector<std::uint8_t> &bytes, void *values, int size, std::size_t valueSize)
+{
+    auto               *data = static_cast<std::uint8_t *>(values);
+    const std::uint8_t *pos  = bytes.data();
+    for(int i = 0; i < size;)
+    {
+        const auto run = static_cast<int>(readUnsigned(pos));
+        for(int j = 0; j < run; ++j, ++i)
+        {
+            std::memcpy(data + i * valueSize, pos, valueSize);
+        }
+        pos += valueSize;
+    }
+}
+
+std::uint64_t nextUse()
+{
+    static std::atomic<std::uint64_t> uses{0};
+    return uses.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+} // namespace trackPointCompression
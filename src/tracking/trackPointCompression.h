@@ -0,0 +1,87 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACKPOINTCOMPRESSION_H
+#define TRACKPOINTCOMPRESSION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Losslessly compressed values of a TrackPointColumn
+ *
+ * Positions are quantized to 1/POSITION_SCALE pixel and stored as the differences of
+ * consecutive quantized positions, followed by the residual between the exact and the
+ * quantized value, so the decoded values are bit-identical. Both are small integers for
+ * smooth trajectories and are written as variable length integers. All other columns
+ * (quality, marker ID, color, ...) are mostly constant over long runs and are stored as
+ * runs of equal values.
+ */
+struct CompressedValues
+{
+    std::vector<std::uint8_t>          bytes;
+    mutable std::atomic<std::uint64_t> lastUse{0}; ///< value of nextUse() at the last access of the decoded values
+};
+
+namespace trackPointCompression
+{
+/// positions are quantized to 1/POSITION_SCALE pixel before the residual is added
+constexpr double POSITION_SCALE = 64;
+
+std::vector<std::uint8_t> encodePositions(const float *values, int size);
+void                      decodePositions(const std::vector<std::uint8_t> &bytes, float *values, int size);
+std::vector<std::uint8_t> encodeRuns(const void *values, int size, std::size_t valueSize);
+void decodeRuns(const std::vector<std::uint8_t> &bytes, void *values, int size, std::size_t valueSize);
+
+/// increasing counter ordering the accesses of compressed columns, e.g. for dropping the least recently used ones
+std::uint64_t nextUse();
+
+template <typename T>
+std::vector<std::uint8_t> encode(const T *values, int size)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "runs are compared and stored in their binary form");
+    if constexpr(std::is_same_v<T, float>)
+    {
+        return encodePositions(values, size);
+    }
+    else
+    {
+        return encodeRuns(values, size, sizeof(T));
+    }
+}
+
+template <typename T>
+std::vector<T> decode(const std::vector<std::uint8_t> &bytes, int size)
+{
+    std::vector<T> values(size);
+    if constexpr(std::is_same_v<T, float>)
+    {
+        decodePositions(bytes, values.data(), size);
+    }
+    else
+    {
+        decodeRuns(bytes, values.data(), size, sizeof(T));
+    }
+    return values;
+}
+} // namespace trackPointCompression
+
+#endif // TRACKPOINTCOMPRESSION_H
@@ -0,0 +1,109 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackPointGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @param cellSize edge length of the cells in pixel; about the head size works best
+ */
+TrackPointGrid::TrackPointGrid(double cellSize) : mCellSize(std::max(cellSize, 1.)) {}
+
+void TrackPointGrid::clear()
+{
+    mEntries.clear();
+    mCells.clear();
+    mMaxHeadSize = 0.;
+}
+
+/**
+ * @brief Sets (or moves) the track point of person
+ *
+ * @param person index of the person in the PersonStorage
+ * @param pos track point of the person in the frame of the grid
+ * @param headSize head size of the person at pos
+ */
+void TrackPointGrid::set(size_t person, const Vec2F &pos, double headSize)
+{
+    remove(person);
+    if(person >= mEntries.size())
+    {
+        mEntries.resize(person + 1);
+    }
+    const std::int64_t cell = cellKey(cellCoord(pos.x()), cellCoord(pos.y()));
+    mEntries[person]        = {pos, cell, true};
+    mCells[cell].push_back(person);
+    mMaxHeadSize = std::max(mMaxHeadSize, headSize);
+}
+
+/**
+ * @brief Removes the track point of person, e.g. if the person has none in the frame anymore
+ */
+void TrackPointGrid::remove(size_t person)
+{
+    if(person >= mEntries.size() || !mEntries[person].valid)
+    {
+        return;
+    }
+    auto &cell = mCells[mEntries[person].cell];
+    cell.erase(std::find(cell.begin(), cell.end(), person));
+    mEntries[person].valid = false;
+}
+
+/**
+ * @brief Returns all persons whose track point is at most radius away from pos
+ *
+ * @param pos center of the search
+ * @param radius search radius in pixel
+ * @return indices of the persons in ascending order
+ */
+std::vector<size_t> TrackPointGrid::query(const Vec2F &pos, double radius) const
+{
+    std::vector<size_t> persons;
+    const std::int64_t  xMin = cellCoord(pos.x() - radius);
+    const std::int64_t  xMax = cellCoord(pos.x() + radius);
+    const std::int64_t  yMin = cellCoord(pos.y() - radius);
+    const std::int64_t  yMax = cellCoord(pos.y() + radius);
+    for(std::int64_t cx = xMin; cx <= xMax; ++cx)
+    {
+        for(std::int64_t cy = yMin; cy <= yMax; ++cy)
+        {
+            auto cell = mCells.find(cellKey(cx, cy));
+            if(cell == mCells.end())
+            {
+                continue;
+            }
+            for(size_t person : cell->second)
+            {
+                if(mEntries[person].pos.distanceToPoint(pos) <= radius)
+                {
+                    persons.push_back(person);
+                }
+            }
+        }
+    }
+    std::sort(persons.begin(), persons.end());
+    return persons;
+}
+
+std::int64_t TrackPointGrid::cellCoord(double v) const
+{
+    return static_cast<std::int64_t>(std::floor(v / mCellSize));
+}
@@ -0,0 +1,70 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACKPOINTGRID_H
+#define TRACKPOINTGRID_H
+
+#include "vector.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Uniform grid of the track points of all persons in one frame
+ *
+ * Used as broad phase for nearest trajectory lookups, so they do not have to
+ * test every person. Every person has at most one entry (its track point in
+ * the frame) and the head size at this point. query() returns all persons whose
+ * point lies within a radius; the exact, head size dependent test is left to
+ * the caller. maxHeadSize() is an upper bound of the head sizes of all entries
+ * ever set, so a radius derived from it never misses a person.
+ *
+ * The grid does not observe the PersonStorage. The user has to keep it in sync
+ * via set()/remove() or rebuild it, if the indices of the persons change.
+ */
+class TrackPointGrid
+{
+public:
+    explicit TrackPointGrid(double cellSize);
+
+    void clear();
+    void set(size_t person, const Vec2F &pos, double headSize);
+    void remove(size_t person);
+
+    double              maxHeadSize() const { return mMaxHeadSize; }
+    std::vector<size_t> query(const Vec2F &pos, double radius) const;
+
+private:
+    struct Entry
+    {
+        Vec2F        pos;
+        std::int64_t cell;
+        bool         valid = false;
+    };
+
+    std::int64_t cellKey(std::int64_t cx, std::int64_t cy) const { return (cx << 32) ^ (cy & 0xFFFFFFFF); }
+    std::int64_t cellCoord(double v) const;
+
+    double                                                mCellSize;
+    double                                                mMaxHeadSize = 0.;
+    std::vector<Entry>                                    mEntries; ///< indexed by person
+    std::unordered_map<std::int64_t, std::vector<size_t>> mCells;
+};
+
+#endif // TRACKPOINTGRID_H
@@ -20,17 +20,23 @@
 
 #include "animation.h"
 #include "control.h"
+#include "frameContext.h"
 #include "helper.h"
 #include "logger.h"
 #include "multiColorMarkerWidget.h"
 #include "pMessageBox.h"
 #include "personStorage.h"
 #include "petrack.h"
+#include "pointUndistortion.h"
 #include "roiItem.h"
 #include "stereoWidget.h"
+#include "trace.h"
+#include "trajectoryGeometry.h"
 
+#include <algorithm>
 #include <ctime>
 #include <iomanip>
+#include <numeric>
 #include <opencv2/opencv.hpp>
 
 #define MIN_WIN_SIZE 3.
@@ -95,7 +101,7 @@ TrackPerson::TrackPerson(int nr, int frame, const TrackPoint &p) :
     mComment(),
     mColorCount(1)
 {
-    mData.append(p);
+    appendPoint(p);
 }
 
 TrackPerson::TrackPerson(int nr, int frame, const TrackPoint &p, int markerID) :
@@ -109,7 +115,7 @@ TrackPerson::TrackPerson(int nr, int frame, const TrackPoint &p, int markerID) :
     mComment(),
     mColorCount(1)
 {
-    mData.append(p);
+    appendPoint(p);
 }
 
 /**
@@ -127,109 +133,65 @@ void TrackPerson::addColor(const QColor &col)
 
 /**
  * @brief optimize average color
+ *
+ * The colors seen on the side of the head where the marker was seen less often are deleted
+ * as outliers and the median of the remaining colors becomes the color of the person. Both
+ * sides and medians come from mColorStatistics, which is only rebuilt from all points after
+ * changes in the middle of the trajectory.
  */
 void TrackPerson::optimizeColor()
 {
-    // ausreisser herausnehmen ueber die koordinate der farbe
-    int   i, j;
-    Vec2F v, vBefore;
-    int   anz1 = 0, anz2 = 0;
-    bool  swap = false;
-
-    // den ersten farbpunkt suchen und vBefore initial setzen
-    for(i = 0; i < mData.size(); ++i)
+    if(!mColorStatistics.isValid())
     {
-        if(mData.at(i).color().isValid())
+        for(int i = 0; i < mData.size(); ++i)
         {
-            vBefore = mData.at(i).colPoint() - mData.at(i);
-            break;
+            mColorStatistics.pushBack(mData.color(i), mData.colPoint(i) - mData.pos(i));
         }
     }
-    if(mData.at(i).color().isValid())
+    const int anz1 = mColorStatistics.count(0); // side of the first color
+    const int anz2 = mColorStatistics.count(1);
+    if(anz1 + anz2 == 0) // keine Farbe gefunden
     {
-        ++anz1;
+        return;
     }
-    // testen, auf welcher seit der farbmarker haeufiger gesehen wird
-    for(j = i + 1; j < mData.size(); ++j)
+    if(anz1 == anz2)
     {
-        if(mData.at(j).color().isValid())
-        {
-            v = mData.at(j).colPoint() - mData.at(j);
-            if((v * vBefore) < 0)
-            {
-                swap = !swap;
-            }
-
-            if(swap)
-            {
-                ++anz2;
-            }
-            else
-            {
-                ++anz1;
-            }
-            vBefore = v;
-        }
+        setColor(mColorStatistics.median(ColorStatistics::BOTH_SIDES));
+        return;
     }
-    swap = false;
-    if(mData.at(i).color().isValid())
+
+    // median statt mittelwert nehmen
+    const int outlierSide = anz1 > anz2 ? 1 : 0;
+    setColor(mColorStatistics.median(1 - outlierSide));
+    if(mColorStatistics.count(outlierSide) == 0)
     {
-        vBefore = mData.at(i).colPoint() - mData.at(i);
+        return;
     }
+
     // farben mit geringerer anzahl loeschen
+    int    side  = 0;
+    bool   first = true;
+    Vec2F  vBefore;
     QColor colInvalid;
-    if(anz2 > anz1)
-    {
-        mData[i].setColor(colInvalid);
-    }
-    for(j = i + 1; j < mData.size(); ++j)
+    for(int i = 0; i < mData.size(); ++i)
     {
-        if(mData.at(j).color().isValid())
+        if(mData.color(i).isValid())
         {
-            v = mData.at(j).colPoint() - mData.at(j);
-            if((v * vBefore) < 0)
+            const Vec2F v = mData.colPoint(i) - mData.pos(i);
+            if(!first && ColorStatistics::isOtherSide(v, vBefore))
             {
-                swap = !swap;
+                side = 1 - side;
             }
-
-            if(swap)
-            {
-                if(anz1 > anz2)
-                {
-                    mData[j].setColor(colInvalid);
-                }
-            }
-            else
+            if(side == outlierSide)
             {
-                if(anz2 > anz1)
-                {
-                    mData[j].setColor(colInvalid);
-                }
+                mData.setColor(i, colInvalid);
             }
+            first   = false;
             vBefore = v;
         }
     }
-
-    // median statt mittelwert nehmen
-    QList<int> r;
-    QList<int> g;
-    QList<int> b;
-    for(i = 0; i < mData.size(); ++i)
-    {
-        if(mData.at(i).color().isValid())
-        {
-            r.append(mData.at(i).color().red());
-            g.append(mData.at(i).color().green());
-            b.append(mData.at(i).color().blue());
-        }
-    }
-    std::sort(r.begin(), r.end());
-    std::sort(g.begin(), g.end());
-    std::sort(b.begin(), b.end());
-    if(r.size() > 0 && g.size() > 0 && b.size() > 0) // kann eigentlich nicht vorkommen
-    {
-        setColor(QColor(r[(r.size() - 1) / 2], g[(g.size() - 1) / 2], b[(b.size() - 1) / 2]));
-    }
+    // the sides of the remaining colors are only known after a rebuild
+    mColorStatistics.invalidate();
 }
 
 void TrackPerson::recalcHeight(float altitude)
@@ -242,7 +204,7 @@ void TrackPerson::recalcHeight(float altitude)
 
     for(int i = 0; i < mData.size(); ++i)
     {
-        z = mData.at(i).sp().z();
+        z = mData.sp(i).z();
         if(z >= 0)
         {
             ++mHeightCount;
@@ -267,21 +229,21 @@ double TrackPerson::getNearestZ(int i, int *extrapolated) const
     {
         return -1.;
     }
-    if(mData.at(i).sp().z() >= 0)
+    if(mData.sp(i).z() >= 0)
     {
-        return mData.at(i).sp().z();
+        return mData.sp(i).z();
     }
     else // -1 an aktueller hoehe
     {
         int nrFor = 1;
         int nrRew = 1;
         while((i + nrFor < mData.size()) &&
-              (mData.at(i + nrFor).sp().z() < 0)) // nach && wird nur ausgefuehrt, wenn erstes true == size() also nicht
+              (mData.sp(i + nrFor).z() < 0)) // nach && wird nur ausgefuehrt, wenn erstes true == size() also nicht
         {
             nrFor++;
         }
         while((i - nrRew >= 0) &&
-              (mData.at(i - nrRew).sp().z() < 0)) // nach && wird nur ausgefuehrt, wenn erstes true == size() also nicht
+              (mData.sp(i - nrRew).z() < 0)) // nach && wird nur ausgefuehrt, wenn erstes true == size() also nicht
         {
             nrRew++;
         }
@@ -292,18 +254,18 @@ double TrackPerson::getNearestZ(int i, int *extrapolated) const
         else if(i + nrFor == mData.size()) // nur in Vergangenheit hoeheninfo gefunden
         {
             *extrapolated = 2;
-            return mData.at(i - nrRew).sp().z();
+            return mData.sp(i - nrRew).z();
         }
         else if(i - nrRew < 0) // nur in der zukunft hoeheninfo gefunden
         {
             *extrapolated = 1;
-            return mData.at(i + nrFor).sp().z();
+            return mData.sp(i + nrFor).z();
         }
         else // in beiden richtungen hoeheninfo gefunden - INTERPOLATION, NICHT EXTRAPOLATION
         {
-            return mData.at(i - nrRew).sp().z() + nrRew *
-                                                      (mData.at(i + nrFor).sp().z() - mData.at(i - nrRew).sp().z()) /
-                                                      (nrFor + nrRew); // lineare interpolation
+            // lineare interpolation
+            return mData.sp(i - nrRew).z() +
+                   nrRew * (mData.sp(i + nrFor).z() - mData.sp(i - nrRew).z()) / (nrFor + nrRew);
         }
     }
 }
@@ -334,7 +296,7 @@ double TrackPerson::getNearestZ(int i, int *extrapolated) const
  */
 bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr, bool extrapolate)
 {
-    Vec2F      tmp; // ua. zur linearen Interpolation
+    Vec2F      tmp; // zur Extrapolation
     TrackPoint tp;  // default: 0 = ist schlechteste qualitaet
     double     distance;
 
@@ -343,14 +305,16 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
         // lineare interpolation, wenn frames uebersprungen wurden
         if(frame - lastFrame() - 1 > 0)
         {
-            tmp.setX((point.x() - mData.last().x()) / (frame - lastFrame()));
-            tmp.setY((point.y() - mData.last().y()) / (frame - lastFrame()));
+            const int          count = frame - lastFrame();
+            std::vector<float> x(count);
+            std::vector<float> y(count);
+            geometry::interpolate(mData.last(), point, count, x.data(), y.data());
             tp = mData.last();
             tp.setQual(0);
-            for(int i = lastFrame() + 1; i <= frame; ++i)
+            for(int i = 0; i < count; ++i)
             {
-                tp += tmp;
-                mData.append(tp);
+                tp.set(x[i], y[i]);
+                appendPoint(tp);
             }
         }
         else if(extrapolate && ((lastFrame() - mFirstFrame) > 0)) // mind. 2 trackpoints sind in liste!
@@ -364,11 +328,11 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
                (distance > 3))
             {
                 if(!((mData.last().qual() == 0) &&
-                     (mData.at(mData.size() - 2).qual() ==
+                     (mData.qual(mData.size() - 2) ==
                       0))) // das vorherige einfuegen ist 2x nicht auch schon schlecht gewesen
                 {
                     tp = point;
-                    SPDLOG_WARN(
+                    LOG_WARN_LIMITED(
                         "Extrapolation instead of tracking because of big difference from tracked point in speed and "
                         "direction of person {} between frame {} and {}!",
                         persNr + 1,
@@ -378,12 +342,12 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
                     tp.setQual(0);
                     // im anschluss koennte noch dunkelster pkt in umgebung gesucht werden!!!
                     // keine Extrapolation der Groesse
-                    mData.append(tp);
+                    appendPoint(tp);
                 }
 
                 else
                 {
-                    SPDLOG_WARN(
+                    LOG_WARN_LIMITED(
                         "Because of three big differences from tracked point in speed and direction between last three "
                         "frames the track point of person {} at {} was NOT inserted!",
                         persNr + 1,
@@ -394,26 +358,28 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
 
             else
             {
-                mData.append(point);
+                appendPoint(point);
             }
         }
         else
         {
-            mData.append(point);
+            appendPoint(point);
         }
     }
     else if(frame < mFirstFrame)
     {
         if(mFirstFrame - frame - 1 > 0)
         {
-            tmp.setX((point.x() - mData.first().x()) / (mFirstFrame - frame));
-            tmp.setY((point.y() - mData.first().y()) / (mFirstFrame - frame));
+            const int          count = mFirstFrame - frame;
+            std::vector<float> x(count);
+            std::vector<float> y(count);
+            geometry::interpolate(mData.first(), point, count, x.data(), y.data());
             tp = mData.first();
             tp.setQual(0);
-            for(int i = firstFrame() - 1; i >= frame; --i)
+            for(int i = 0; i < count; ++i)
             {
-                tp += tmp;
-                mData.prepend(tp);
+                tp.set(x[i], y[i]);
+                prependPoint(tp);
             }
         }
         else if(extrapolate && ((lastFrame() - mFirstFrame) > 0)) // mind. 2 trackpoints sind in liste!
@@ -426,11 +392,11 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
             if(((distance = (mData.at(0) + tmp).distanceToPoint(point)) > EXTRAPOLATE_FACTOR * tmp.length()) &&
                (distance > 3))
             {
-                if(!((mData.at(0).qual() == 0) &&
-                     (mData.at(1).qual() == 0))) // das vorherige einfuegen ist 2x nicht auch schon schlecht gewesen
+                if(!((mData.qual(0) == 0) &&
+                     (mData.qual(1) == 0))) // das vorherige einfuegen ist 2x nicht auch schon schlecht gewesen
                 {
                     tp = point;
-                    SPDLOG_WARN(
+                    LOG_WARN_LIMITED(
                         "Extrapolation instead of tracking because of big difference from tracked point in speed and "
                         "direction of person {} between frame {} and {}!",
                         persNr + 1,
@@ -438,11 +404,11 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
                         lastFrame() - 1);
                     tp = mData.at(0) + tmp; // nur vektor wird hier durch + geaendert
                     tp.setQual(0);
-                    mData.prepend(tp);
+                    prependPoint(tp);
                 }
                 else
                 {
-                    SPDLOG_WARN(
+                    LOG_WARN_LIMITED(
                         "Because of three big differences from tracked point in speed and direction between last three "
                         "frames the track point of person {} at {} was NOT inserted!",
                         persNr + 1,
@@ -452,12 +418,12 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
             }
             else
             {
-                mData.prepend(point);
+                prependPoint(point);
             }
         }
         else
         {
-            mData.prepend(point);
+            prependPoint(point);
         }
         mFirstFrame = frame;
     }
@@ -477,25 +443,29 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
                 tp.setQual(95);
                 tmp = point + (trackPointAt(frame - 1) - trackPointAt(frame - 1).colPoint());
                 tp.set(tmp.x(), tmp.y());
-                SPDLOG_WARN(
-                    "move TrackPoint according to last distance of structure marker and color marker of person {}:",
-                    persNr + 1);
-                SPDLOG_WARN("         {} -> {}", point, tp);
+                LOG_WARN_LIMITED(
+                    "move TrackPoint according to last distance of structure marker and color marker of person {}: "
+                    "{} -> {}",
+                    persNr + 1,
+                    point,
+                    tp);
             }
             else if(trackPointExist(frame + 1) && trackPointAt(frame + 1).qual() > 90)
             {
                 tp.setQual(95);
                 tmp = point + (trackPointAt(frame + 1) - trackPointAt(frame + 1).colPoint());
                 tp.set(tmp.x(), tmp.y());
-                SPDLOG_WARN(
-                    "move TrackPoint according to last distance of structure marker and color marker of person {}:",
-                    persNr + 1);
-                SPDLOG_WARN("         {} -> {}", point, tp);
+                LOG_WARN_LIMITED(
+                    "move TrackPoint according to last distance of structure marker and color marker of person {}: "
+                    "{} -> {}",
+                    persNr + 1,
+                    point,
+                    tp);
             }
         }
 
         // ueberprueft, welcher punkt besser
-        if(tp.qual() > mData.at(frame - mFirstFrame).qual())
+        if(tp.qual() > mData.qual(frame - mFirstFrame))
         {
             // warnung ausgeben, wenn replacement (fuer gewoehnlich von reco) den pfadverlauf abrupt aendert
             if(trackPointExist(frame - 1))
@@ -510,7 +480,7 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
                ((distance = (trackPointAt(frame).distanceToPoint(tp))) > 1.5 * tmp.length()) && (distance > 3))
             {
                 int anz;
-                SPDLOG_WARN(
+                LOG_WARN_LIMITED(
                     "Big difference in location between existing and replacing track point of person {} in frame {}!",
                     persNr + 1,
                     frame);
@@ -524,7 +494,7 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
                 for(int i = 1; i < (anz - 1);
                     ++i) // anz ist einer zu viel; zudem nur boie anz-1 , da sonst eh nur mit 1 multipliziert wuerde
                 {
-                    mData[frame - mFirstFrame - i].setQual((i * trackPointAt(frame - i).qual()) / anz);
+                    mData.setQual(frame - mFirstFrame - i, (i * trackPointAt(frame - i).qual()) / anz);
                 }
                 // vor
                 anz = 1;
@@ -535,15 +505,15 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
                 for(int i = 1; i < (anz - 1);
                     ++i) // anz ist einer zu viel; zudem nur boie anz-1 , da sonst eh nur mit 1 multipliziert wuerde
                 {
-                    mData[frame - mFirstFrame + i].setQual((i * trackPointAt(frame + i).qual()) / anz);
+                    mData.setQual(frame - mFirstFrame + i, (i * trackPointAt(frame + i).qual()) / anz);
                 }
             }
 
-            mData.replace(frame - mFirstFrame, tp);
+            replacePoint(frame - mFirstFrame, tp);
 
             if(tp.qual() > TrackPoint::bestDetectionQual) // manual add // after inserting, because point ist const
             {
-                mData[frame - mFirstFrame].setQual(TrackPoint::bestDetectionQual); // so moving of a point is possible
+                mData.setQual(frame - mFirstFrame, TrackPoint::bestDetectionQual); // so moving of a point is possible
             }
         }
         else
@@ -554,6 +524,73 @@ bool TrackPerson::insertAtFrame(int frame, const TrackPoint &point, int persNr,
     return true;
 }
 
+/**
+ * @brief Inserts all TrackPoints of other, e.g. when merging two trajectories
+ *
+ * The points in the frames of this person and the first point next to them are inserted
+ * with insertAtFrame(), i.e. the better quality wins and a gap in between is interpolated.
+ * The remaining points of other continue this trajectory and are taken over as they are
+ * in one go, instead of point by point.
+ *
+ * @param other trajectory to insert; must not extend this trajectory at both ends
+ * @param persNr number shown to the user, for more meaningful warnings
+ * @param extrapolate extrapolate with huge differences (only at the junction)
+ */
+void TrackPerson::insertPointsOf(const TrackPerson &other, int persNr, bool extrapolate)
+{
+    if(other.firstFrame() < mFirstFrame && other.lastFrame() > lastFrame())
+    {
+        throw std::invalid_argument("The trajectory to insert must not extend the trajectory at both ends.");
+    }
+
+    if(other.firstFrame() < mFirstFrame)
+    {
+        // backwards from the end of other, so the frames before mFirstFrame are prepended
+        const int first = mFirstFrame;
+        int       k     = other.size() - 1;
+        do
+        {
+            insertAtFrame(other.firstFrame() + k, other.at(k), persNr, extrapolate);
+            --k;
+        } while(k >= 0 && other.firstFrame() + k >= first - 1);
+
+        for(; k >= 0; --k)
+        {
+            if(other.firstFrame() + k == mFirstFrame - 1)
+            {
+                mData.prepend(other.mData.slice(0, k + 1));
+                mColorStatistics.invalidate();
+                mFirstFrame = other.firstFrame();
+                break;
+            }
+            // the junction was not inserted, continue as insertAtFrame would
+            insertAtFrame(other.firstFrame() + k, other.at(k), persNr, extrapolate);
+        }
+    }
+    else
+    {
+        const int last = lastFrame();
+        int       k    = 0;
+        do
+        {
+            insertAtFrame(other.firstFrame() + k, other.at(k), persNr, extrapolate);
+            ++k;
+        } while(k < other.size() && other.firstFrame() + k <= last + 1);
+
+        for(; k < other.size(); ++k)
+        {
+            if(other.firstFrame() + k == lastFrame() + 1)
+            {
+                mData.append(other.mData.slice(k, other.size()));
+                mColorStatistics.invalidate();
+                break;
+            }
+            // the junction was not inserted, continue as insertAtFrame would
+            insertAtFrame(other.firstFrame() + k, other.at(k), persNr, extrapolate);
+        }
+    }
+}
+
 /**
  * Checks, if a TrackPoint for the frame exist
  * @param frame frame to check
@@ -569,7 +606,7 @@ bool TrackPerson::trackPointExist(int frame) const
  * @param frame frame to get TrackPoint
  * @return TrackPoint at frame
  */
-const TrackPoint &TrackPerson::trackPointAt(int frame) const
+TrackPoint TrackPerson::trackPointAt(int frame) const
 {
     return mData.at(frame - mFirstFrame);
 }
@@ -582,9 +619,10 @@ const TrackPoint &TrackPerson::trackPointAt(int frame) const
  */
 double TrackPerson::distanceToNextFrame(int frame) const
 {
-    if(trackPointExist(frame))
+    if(trackPointExist(frame) && trackPointExist(frame + 1))
     {
-        return trackPointAt(frame).distanceToPoint(at(frame - mFirstFrame + 1));
+        const int i = frame - mFirstFrame;
+        return mData.pos(i).distanceToPoint(mData.pos(i + 1));
     }
     else
     {
@@ -592,6 +630,126 @@ double TrackPerson::distanceToNextFrame(int frame) const
     }
 }
 
+/**
+ * @brief Predicts the position in frame from the motion up to fromFrame with a constant velocity model
+ *
+ * The velocity is taken from the last step before fromFrame (in tracking direction). The change
+ * of the velocity to the step before is used as uncertainty, since it is the error a constant
+ * velocity prediction made in the last step. With only one known step, the velocity itself is
+ * the uncertainty. The uncertainty grows quadratically with the number of predicted frames.
+ *
+ * @param fromFrame last known frame
+ * @param frame frame to predict; before fromFrame for backward tracking
+ * @return prediction; std::nullopt, if the motion before fromFrame is unknown
+ */
+std::optional<MotionPrediction> TrackPerson::predictPosition(int fromFrame, int frame) const
+{
+    const int dir = frame > fromFrame ? 1 : -1;
+    if(frame == fromFrame || !trackPointExist(fromFrame) || !trackPointExist(fromFrame - dir))
+    {
+        return std::nullopt;
+    }
+
+    const int    i           = fromFrame - mFirstFrame;
+    const double step        = std::abs(frame - fromFrame);
+    const Vec2F  velocity    = mData.pos(i) - mData.pos(i - dir);
+    double       uncertainty = velocity.length();
+    if(trackPointExist(fromFrame - 2 * dir))
+    {
+        const Vec2F prevVelocity = mData.pos(i - dir) - mData.pos(i - 2 * dir);
+        uncertainty              = (velocity - prevVelocity).length();
+    }
+    return MotionPrediction{mData.pos(i) + velocity * step, uncertainty * step * step};
+}
+
+namespace
+{
+/**
+ * @brief Moves point to the darkest pixel nearby, if it is surrounded by brighter pixels (dark marker on white)
+ *
+ * Afterwards the point is shifted to subpixel precision by the gradient of its neighbours.
+ *
+ * @param grey grey image of the current frame
+ * @param point tracked point, inside of grey
+ * @param regionSize size of searched region around point: -regionSize to regionSize
+ * @return true, if the point was moved to the darkest pixel
+ */
+bool moveToNearDarkPoint(const cv::Mat &grey, cv::Point2f &point, int regionSize)
+{
+    const cv::Rect image(0, 0, grey.cols, grey.rows);
+    const auto     square = [regionSize](int x, int y)
+    { return cv::Rect(x - regionSize, y - regionSize, 2 * regionSize + 1, 2 * regionSize + 1); };
+
+    int            x       = myRound(point.x - .5);
+    int            y       = myRound(point.y - .5);
+    int            darkest = 255;
+    int            xDark   = x;
+    int            yDark   = y;
+    const cv::Rect region  = square(x, y) & image;
+    if(!region.empty())
+    {
+        double    minVal;
+        cv::Point minLoc;
+        // first darkest pixel in row-major order
+        cv::minMaxLoc(grey(region), &minVal, nullptr, &minLoc);
+        if(minVal < darkest)
+        {
+            darkest = static_cast<int>(minVal);
+            xDark   = region.x + minLoc.x;
+            yDark   = region.y + minLoc.y;
+        }
+    }
+
+    // suchbereich:
+    //  ###
+    // #   #
+    // #   #
+    // #   #
+    //  ###
+    const cv::Rect ring  = square(xDark, yDark) & image;
+    const int      xMin2 = ring.x;
+    const int      xMax2 = ring.x + ring.width;
+    const int      yMin2 = ring.y;
+    const int      yMax2 = ring.y + ring.height;
+
+    bool markerInsideWhite = true;
+    for(int k = yMin2 + 1; k < yMax2 - 1 && markerInsideWhite; ++k)
+    {
+        const uchar *row  = grey.ptr<uchar>(k);
+        markerInsideWhite = row[xMin2] > darkest && row[xMax2 - 1] > darkest;
+    }
+    if(markerInsideWhite && xMax2 - xMin2 > 2)
+    {
+        const uchar *top    = grey.ptr<uchar>(yMin2);
+        const uchar *bottom = grey.ptr<uchar>(yMax2 - 1);
+        for(int j = xMin2 + 1; j < xMax2 - 1 && markerInsideWhite; ++j)
+        {
+            markerInsideWhite = top[j] > darkest && bottom[j] > darkest;
+        }
+    }
+
+    if(markerInsideWhite)
+    {
+        point.x = xDark;
+        point.y = yDark;
+    }
+
+    // interpolation wg nachbargrauwerten:
+    x = myRound(point.x);
+    y = myRound(point.y);
+    if((x > 0) && (x < (grey.cols - 1)) && (y > 0) && (y < (grey.rows - 1)) && (darkest < 255))
+    {
+        const uchar *row = grey.ptr<uchar>(y);
+        point.x += .5 * (row[x + 1] - row[x - 1]) / static_cast<double>(255 - darkest);
+        point.y += .5 * (grey.at<uchar>(y + 1, x) - grey.at<uchar>(y - 1, x)) / static_cast<double>(255 - darkest);
+    }
+
+    point.x += .5F;
+    point.y += .5F; // da 1. pixel von 0..1, das 2. pixel von 1..2 etc geht
+    return markerInsideWhite;
+}
+} // namespace
+
 //----------------------------------------------------------------------------
 
 // using tracker:
@@ -629,7 +787,9 @@ void Tracker::init(cv::Size size)
 // damit neu aufgesetzt werden kann
 void Tracker::reset()
 {
-    mPrevFrame = -1; // das vorherige Bild ist zu ignorieren oder existiert nicht
+    mPrevFrame        = -1; // das vorherige Bild ist zu ignorieren oder existiert nicht
+    mPrevPyrValid     = false;
+    mPrevGreyGpuValid = false;
 }
 
 void Tracker::resize(cv::Size size)
@@ -637,6 +797,8 @@ void Tracker::resize(cv::Size size)
     if(!mGrey.empty() && ((size.width != mGrey.cols) || (size.height != mGrey.rows)))
     {
         mGrey.create(size, CV_8UC1);
+        mPrevPyrValid     = false;
+        mPrevGreyGpuValid = false;
 
         // umkopieren des alten Graubildes in groesseres oder auch kleineres bild (wg border)
         // aus borderFilter kopiert
@@ -656,6 +818,54 @@ void Tracker::resize(cv::Size size)
 }
 
 
+/**
+ * @brief Selects tracking with cv::cuda::SparsePyrLKOpticalFlow
+ *
+ * Falls back to tracking on the CPU, if OpenCV was built without the CUDA optical flow
+ * module or no CUDA device is available.
+ *
+ * @param use true to track with CUDA
+ * @return true, if CUDA is used
+ */
+bool Tracker::setUseCuda(bool use)
+{
+    mCudaRequested = use;
+#ifdef HAVE_OPENCV_CUDAOPTFLOW
+    mUseCuda = use && cv::cuda::getCudaEnabledDeviceCount() > 0;
+#else
+    mUseCuda = false;
+#endif
+    if(use && !mUseCuda)
+    {
+        SPDLOG_WARN("CUDA optical flow is not available, tracking on the CPU.");
+    }
+    mPrevGreyGpuValid = false;
+    return mUseCuda;
+}
+
+/**
+ * @brief Returns the memory used by the images and pyramids kept between frames in bytes
+ *
+ * The pyramids are views into padded images, so the whole allocation is counted.
+ */
+std::size_t Tracker::memoryUsage() const
+{
+    const auto matBytes = [](const cv::Mat &mat)
+    { return mat.datastart ? static_cast<std::size_t>(mat.datalimit - mat.datastart) : std::size_t{0}; };
+
+    std::size_t bytes = matBytes(mGrey) + matBytes(mPrevGrey);
+    for(const auto &level : mPrevPyr)
+    {
+        bytes += matBytes(level);
+    }
+    for(const auto &level : mCurrentPyr)
+    {
+        bytes += matBytes(level);
+    }
+    bytes += mGreyGpu.step * mGreyGpu.rows + mPrevGreyGpu.step * mPrevGreyGpu.rows;
+    return bytes;
+}
+
 /**
  * @brief Tracker::calcPrevFeaturePoints calculates all featurePoints(Persons) from the "previous" frame
  *
@@ -669,33 +879,35 @@ void Tracker::resize(cv::Size size)
  * @return number of feature points
  */
 size_t Tracker::calcPrevFeaturePoints(
-    int          prevFrame,
-    cv::Rect    &rect,
-    int          frame,
-    bool         reTrack,
-    int          reQual,
-    int          borderSize,
-    QSet<size_t> onlyVisible)
+    int                 prevFrame,
+    cv::Rect           &rect,
+    int                 frame,
+    bool                reTrack,
+    int                 reQual,
+    int                 borderSize,
+    const QSet<size_t> &onlyVisible)
 {
+    TRACE_ZONE("Tracker::calcPrevFeaturePoints");
     int j = -1;
 
     mPrevFeaturePoints.clear();
     mPrevFeaturePointsIdx.clear();
+    mPredictedFeaturePoints.clear();
+    mPredictionUncertainty.clear();
 
     if(prevFrame != -1)
     {
         const auto &persons = mPersonStorage.getPersons();
-        for(int i = 0; i < static_cast<int>(mPersonStorage.nbPersons()); ++i)
+        // only persons with a point in prevFrame can be tracked
+        mPersonStorage.activePersons(prevFrame, mScratch.persons);
+        for(size_t idx : mScratch.persons)
         {
+            const int   i      = static_cast<int>(idx);
             const auto &person = persons[i];
             if(!((onlyVisible.empty()) || (onlyVisible.contains(i))))
             {
                 continue;
             }
-            if(!person.trackPointExist(prevFrame))
-            {
-                continue;
-            }
 
             /*
              * For retracking to occur, every point in the path from the last
@@ -736,6 +948,13 @@ size_t Tracker::calcPrevFeaturePoints(
                 ++j;
 
                 mPrevFeaturePointsIdx.push_back(i);
+                if(mUseMotionPrediction)
+                {
+                    const auto prediction = person.predictPosition(prevFrame, frame);
+                    mPredictedFeaturePoints.push_back(
+                        prediction ? (prediction->position + Vec2F(borderSize, borderSize)).toPoint2f() : p2f);
+                    mPredictionUncertainty.push_back(prediction ? static_cast<float>(prediction->uncertainty) : -1.F);
+                }
                 if(j > MAX_COUNT - 2)
                 {
                     SPDLOG_WARN("reached maximal number of tracking point: {}", MAX_COUNT);
@@ -770,6 +989,7 @@ size_t Tracker::calcPrevFeaturePoints(
  */
 int Tracker::insertFeaturePoints(int frame, size_t count, cv::Mat &img, int borderSize, cv::Mat map1, float errorScale)
 {
+    TRACE_ZONE("Tracker::insertFeaturePoints");
     int        inserted = 0;
     TrackPoint v;
     int        qual;
@@ -782,6 +1002,10 @@ int Tracker::insertFeaturePoints(int frame, size_t count, cv::Mat &img, int bord
     //                                mMainWindow->getBorderFilter()->getBorderColG()->getValue(),
     //                                mMainWindow->getBorderFilter()->getBorderColB()->getValue());
 
+    // track points of all persons in frame, so merging only has to test the persons nearby
+    const bool     merge = mMainWindow->getControlWidget()->isTrackMergeChecked();
+    TrackPointGrid grid  = merge ? mPersonStorage.buildPointGrid(frame) : TrackPointGrid(1.);
+
     for(size_t i = 0; i < count; ++i)
     {
         if(mStatus[i] == TrackStatus::Tracked)
@@ -850,10 +1074,9 @@ int Tracker::insertFeaturePoints(int frame, size_t count, cv::Mat &img, int bord
                             // ueberpruefen, ob tracking ziel auf anderem tracking path landet, dann beide trackpaths
                             // verschmelzen lassen
                             found = false;
-                            if(mMainWindow->getControlWidget()
-                                   ->isTrackMergeChecked()) // wenn zusammengefuehrt=merge=verschmolzen werden soll
+                            if(merge) // wenn zusammengefuehrt=merge=verschmolzen werden soll
                             {
-                                found = tryMergeTrajectories(v, i, frame);
+                                found = tryMergeTrajectories(v, i, frame, grid);
                             }
 
                             // wenn keine verschmelzung erfolgte, versuchen trackpoint einzufuegen
@@ -875,6 +1098,10 @@ int Tracker::insertFeaturePoints(int frame, size_t count, cv::Mat &img, int bord
                                     (mMainWindow->getControlWidget()->isTrackExtrapolationChecked()),
                                     z,
                                     mMainWindow->getControlWidget()->getCameraAltitude());
+                                if(merge)
+                                {
+                                    mPersonStorage.updatePointGrid(grid, mPrevFeaturePointsIdx[i], frame);
+                                }
                             }
 
                             ++inserted;
@@ -904,16 +1131,19 @@ int Tracker::insertFeaturePoints(int frame, size_t count, cv::Mat &img, int bord
  * @param v TrackPoint to be inserted
  * @param i Index in mFeaturePointsIdx and rest of point/person to be inserted
  * @param frame frame in which the point v was tracked
+ * @param grid grid of the track points in frame; rebuilt after a merge, which changes the indices
  * @return true if a suitable trajectory to merge with was found
  */
-bool Tracker::tryMergeTrajectories(const TrackPoint &v, size_t i, int frame)
+bool Tracker::tryMergeTrajectories(const TrackPoint &v, size_t i, int frame, TrackPointGrid &grid)
 {
     bool        found   = false;
     const auto &persons = mPersonStorage.getPersons();
     const auto &person  = persons[mPrevFeaturePointsIdx[i]];
     // nach trajektorie suchen, mit der eine verschmelzung erfolgen koennte
-    for(int j = 0; !found && j < static_cast<int>(mPersonStorage.nbPersons()); ++j) // ueber TrackPerson
+    const std::vector<size_t> candidates = grid.query(v, grid.maxHeadSize() / 2.);
+    for(size_t c = 0; !found && c < candidates.size(); ++c) // ueber TrackPerson
     {
+        const int   j     = static_cast<int>(candidates[c]);
         const auto &other = persons[j];
         if(j != mPrevFeaturePointsIdx[i] && other.trackPointExist(frame) &&
            (other.trackPointAt(frame).distanceToPoint(v) < mMainWindow->getHeadSize(nullptr, j, frame) / 2.))
@@ -947,6 +1177,7 @@ bool Tracker::tryMergeTrajectories(const TrackPoint &v, size_t i, int frame)
                     // set status to 2, so the already merged person is ignored/skipped
                     mStatus[idxOtherMerged] = TrackStatus::Merged;
                 }
+                grid  = mPersonStorage.buildPointGrid(frame);
                 found = true;
             }
         }
@@ -962,7 +1193,7 @@ bool Tracker::tryMergeTrajectories(const TrackPoint &v, size_t i, int frame)
 /**
  * @brief Tracks points from the last frame in this (current) frame
  *
- * @param img Image of current frame
+ * @param frameContext filtered image of current frame and its gray image
  * @param rect ROI in which tracking is executed
  * @param frame frame-number of the current frame
  * @param reTrack boolean saying if people should be retracked, when tracking was of low quality
@@ -974,7 +1205,7 @@ bool Tracker::tryMergeTrajectories(const TrackPoint &v, size_t i, int frame)
  * @return Number of tracked points
  */
 int Tracker::track(
-    cv::Mat                &img,
+    const FrameContext     &frameContext,
     cv::Rect               &rect,
     cv::Mat                 map1,
     int                     frame,
@@ -983,11 +1214,17 @@ int Tracker::track(
     int                     borderSize,
     reco::RecognitionMethod recoMethod,
     int                     level,
-    QSet<size_t>            onlyVisible,
+    const QSet<size_t>     &onlyVisible,
     int                     errorScaleExponent)
 {
-    QList<int> trjToDel;
-    float      errorScale = pow(1.5, errorScaleExponent); // 0 waere neutral
+    TRACE_ZONE("Tracker::track");
+    auto   &trjToDel   = mScratch.trjToDel;
+    float   errorScale = pow(1.5, errorScaleExponent); // 0 waere neutral
+    cv::Mat img        = frameContext.image();
+
+    trjToDel.clear();
+
+    mSummary = TrackSummary();
 
     if(mGrey.empty())
     {
@@ -1014,7 +1251,8 @@ int Tracker::track(
 
     if(img.channels() == 3)
     {
-        cv::cvtColor(img, mGrey, cv::COLOR_BGR2GRAY);
+        // the gray image of the context is never written to, so it can be shared
+        mGrey = frameContext.gray();
     }
     else if(img.channels() == 1)
     {
@@ -1026,12 +1264,21 @@ int Tracker::track(
         return -1;
     }
 
+    mCurrentPyrValid = false;
     size_t numOfPeopleToTrack =
         calcPrevFeaturePoints(mPrevFrame, rect, frame, reTrack, reQual, borderSize, onlyVisible);
 
     if(numOfPeopleToTrack > 0)
     {
-        preCalculateImagePyramids(level);
+        toDistortedFrame();
+        if(mUseCuda)
+        {
+            uploadGreyImages();
+        }
+        else
+        {
+            preCalculateImagePyramids(level);
+        }
 
         if(mPrevFrame != -1)
         {
@@ -1041,7 +1288,7 @@ int Tracker::track(
             }
             else if(abs(frame - mPrevFrame) > 1)
             {
-                SPDLOG_WARN(
+                LOG_WARN_LIMITED(
                     "linear interpolation of skipped frames which are not already tracked({} to {}).",
                     mPrevFrame,
                     frame);
@@ -1073,10 +1320,21 @@ int Tracker::track(
             refineViaNearDarkPoint();
         }
 
+        if(mPointUndistortion)
+        {
+            mPointUndistortion->undistort(mFeaturePoints);
+        }
         insertFeaturePoints(frame, numOfPeopleToTrack, img, borderSize, map1, errorScale);
+        summarize(numOfPeopleToTrack, errorScale);
+        mSummary.lost += static_cast<int>(trjToDel.size());
     }
 
     cv::swap(mPrevGrey, mGrey);
+    // the pyramid of this frame is the one of the previous frame in the next call
+    std::swap(mPrevPyr, mCurrentPyr);
+    mPrevPyrValid = mCurrentPyrValid;
+    mPrevGreyGpu.swap(mGreyGpu);
+    mPrevGreyGpuValid = mUseCuda && numOfPeopleToTrack > 0;
 
     mPrevFrame = frame;
 
@@ -1084,10 +1342,8 @@ int Tracker::track(
     // ACHTUNG: einzige stelle in tracker, wo eine trj geloescht wird
     // trackNumberAll, trackShowOnlyNr werden nicht angepasst, dies wird aber am ende von petrack::updateimage
     // gemacht
-    for(int i = 0; i < trjToDel.size(); ++i) // ueber TrackPerson
-    {
-        mPersonStorage.delPointOf(trjToDel[i], PersonStorage::TrajectorySegment::Whole, -1);
-    }
+    // all at once, as the indices of the following persons change with each deletion
+    mPersonStorage.delPersons(trjToDel);
 
     // numOfPeopleToTrack kann trotz nicht retrack > 0 sein auch bei alten pfaden
     // da am bildrand pfade keinen nachfolger haben und somit dort immer neu bestimmt werden!
@@ -1095,31 +1351,394 @@ int Tracker::track(
 }
 
 
+/**
+ * @brief Takes the points of the previous frame for frame, which shows the same image
+ *
+ * Used instead of track() for a duplicate frame (see FrameChangeDetector). Points already
+ * in frame are kept. The next call of track() continues from frame with the grey image and
+ * the pyramids of the previous frame, which are the ones of frame as well.
+ *
+ * @param frame duplicate of the previous frame
+ * @param onlyVisible Set of trajectories which should be evaluated; @see Petrack::getPedestriansToTrack
+ * @return number of copied points; -1, if frame does not follow the previous frame
+ */
+int Tracker::copyPreviousFrame(int frame, const QSet<size_t> &onlyVisible)
+{
+    TRACE_ZONE("Tracker::copyPreviousFrame");
+    mSummary = TrackSummary();
+    if(mPrevFrame == -1 || abs(frame - mPrevFrame) != 1)
+    {
+        return -1;
+    }
+
+    int copied = 0;
+    mPersonStorage.activePersons(mPrevFrame, mScratch.persons);
+    for(size_t i : mScratch.persons)
+    {
+        const auto &person = mPersonStorage.at(i);
+        if((!onlyVisible.empty() && !onlyVisible.contains(i)) || person.trackPointExist(frame))
+        {
+            continue;
+        }
+        const int nr = static_cast<int>(i);
+        mPersonStorage.insertFeaturePoint(i, frame, person.trackPointAt(mPrevFrame), nr, false, -1, 0);
+        ++copied;
+    }
+    mSummary.tracked = copied;
+    mPrevFrame       = frame;
+    return copied;
+}
+
+/**
+ * @brief Counts the tracked, lost and uncertain persons of the current frame for getSummary()
+ *
+ * @param count number of tracked people
+ * @param errorScale
+ */
+void Tracker::summarize(size_t count, float errorScale)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(mStatus[i] == TrackStatus::NotTracked)
+        {
+            ++mSummary.lost;
+        }
+        else if(mStatus[i] == TrackStatus::Tracked)
+        {
+            ++mSummary.tracked;
+            if(mTrackError[i] > errorScale * MAX_TRACK_ERROR)
+            {
+                ++mSummary.uncertain;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Moves the points to track to their position in the distorted frame
+ *
+ * Only if the frames are not undistorted (see setPointUndistortion()). The sizes of the
+ * tracking windows are measured in the undistorted image, so the local scale of the
+ * distortion at every point is kept for winSize() and localScale().
+ */
+void Tracker::toDistortedFrame()
+{
+    if(!mPointUndistortion)
+    {
+        return;
+    }
+    mLocalScale.resize(mPrevFeaturePoints.size());
+    for(size_t i = 0; i < mPrevFeaturePoints.size(); ++i)
+    {
+        mLocalScale[i] = static_cast<float>(mPointUndistortion->scale(mPrevFeaturePoints[i]));
+    }
+    mPointUndistortion->distort(mPrevFeaturePoints);
+    mPointUndistortion->distort(mPredictedFeaturePoints);
+}
+
+/// Size of a pixel of the undistorted image at point i in the tracked frame
+double Tracker::localScale(size_t i) const
+{
+    return mPointUndistortion ? mLocalScale[i] : 1.;
+}
+
+/// Size of the tracking window of point i at level of the pyramid in the tracked frame
+int Tracker::winSize(size_t i, int level) const
+{
+    const int size = mMainWindow->winSize(nullptr, mPrevFeaturePointsIdx[i], mPrevFrame, level);
+    return mPointUndistortion ? myRound(size * mLocalScale[i]) : size;
+}
+
+
 /**
  * @brief Calculates the image pyramids for Lucas-Kanade
  *
  * This functions calculates image pyramids together with the gradients for the
  * consumption by Lucas-Kanade. They are precomputed with the biggest winsize
  * so they have enough padding calcOpticalFlowPyrLK can use them for all used
- * winsizes
+ * winsizes. The padding only grows, so the pyramid of the current frame can be
+ * reused as the pyramid of the previous frame in the next call. The previous
+ * pyramid is only built again, if it is missing (e.g. after reset), the level
+ * changed or a larger window size is needed.
+ *
+ * With a patch set (see setPatch()), the pyramids are only built for the patch.
  *
  * @param level Maximum used level for Lucas-Kanade
  * @param numOfPeopleToTrack Number of people who are going to be tracked
  */
 void Tracker::preCalculateImagePyramids(int level)
 {
+    TRACE_ZONE("Tracker::preCalculateImagePyramids");
     int maxWinSize = 3;
     for(size_t i = 0; i < mPrevFeaturePointsIdx.size(); ++i)
     {
-        int winSize = mMainWindow->winSize(nullptr, mPrevFeaturePointsIdx[i], mPrevFrame, 0);
+        int winSize = this->winSize(i, 0);
         if(winSize > maxWinSize)
         {
             maxWinSize = winSize;
         }
     }
 
-    cv::buildOpticalFlowPyramid(mPrevGrey, mPrevPyr, cv::Size(maxWinSize, maxWinSize), level);
-    cv::buildOpticalFlowPyramid(mGrey, mCurrentPyr, cv::Size(maxWinSize, maxWinSize), level);
+    // with a patch, the points are tracked in its coordinates (see calcOpticalFlow)
+    const cv::Rect image(cv::Point(), mGrey.size());
+    const cv::Rect patch = mPatch.empty() ? image : mPatch & image;
+    if(maxWinSize > mPyrWinSize || level != mPyrLevel || patch != mPyrPatch)
+    {
+        mPyrWinSize   = std::max(mPyrWinSize, maxWinSize);
+        mPyrLevel     = level;
+        mPyrPatch     = patch;
+        mPrevPyrValid = false;
+    }
+
+    // the pyramids must not share memory with the grey images, which are overwritten
+    const cv::Size winSize(mPyrWinSize, mPyrWinSize);
+    if(!mPrevPyrValid)
+    {
+        cv::buildOpticalFlowPyramid(
+            mPrevGrey(patch), mPrevPyr, winSize, level, true, cv::BORDER_REFLECT_101, cv::BORDER_CONSTANT, false);
+    }
+    cv::buildOpticalFlowPyramid(
+        mGrey(patch), mCurrentPyr, winSize, level, true, cv::BORDER_REFLECT_101, cv::BORDER_CONSTANT, false);
+    mCurrentPyrValid = true;
+}
+
+
+/**
+ * @brief Uploads the grey images for tracking with CUDA
+ *
+ * The grey image of the previous frame stays on the device from the last call,
+ * so normally only the current frame is uploaded.
+ */
+void Tracker::uploadGreyImages()
+{
+    TRACE_ZONE("Tracker::uploadGreyImages");
+    if(!mPrevGreyGpuValid)
+    {
+        mPrevGreyGpu.upload(mPrevGrey);
+    }
+    mGreyGpu.upload(mGrey);
+}
+
+
+/**
+ * @brief Tracks prevPoints with Lucas-Kanade from the previous to the current frame
+ *
+ * With mUseCuda all points are tracked in one launch of cv::cuda::SparsePyrLKOpticalFlow
+ * on the grey images resident on the device. Otherwise (or if CUDA fails, which switches
+ * back to the CPU permanently) cv::calcOpticalFlowPyrLK is used on the precomputed
+ * pyramids, optionally coarse-to-fine (see calcOpticalFlowCoarseToFine).
+ *
+ * @param prevPoints points in the previous frame
+ * @param nextPoints tracked points in the current frame; initial guesses with useInitialFlow
+ * @param status 1, if the point was tracked; 0 otherwise
+ * @param trackError error reported by Lucas-Kanade
+ * @param winSize size of the search window
+ * @param level maximum pyramid level
+ * @param useInitialFlow start the search at the given nextPoints instead of prevPoints
+ */
+void Tracker::calcOpticalFlow(
+    const std::vector<cv::Point2f> &prevPoints,
+    std::vector<cv::Point2f>       &nextPoints,
+    std::vector<uchar>             &status,
+    std::vector<float>             &trackError,
+    int                             winSize,
+    int                             level,
+    bool                            useInitialFlow)
+{
+#ifdef HAVE_OPENCV_CUDAOPTFLOW
+    if(mUseCuda)
+    {
+        try
+        {
+            if(!mCudaFlow)
+            {
+                mCudaFlow = cv::cuda::SparsePyrLKOpticalFlow::create();
+            }
+            mCudaFlow->setWinSize(cv::Size(winSize, winSize));
+            mCudaFlow->setMaxLevel(level);
+            mCudaFlow->setNumIters(mTermCriteria.maxCount);
+            mCudaFlow->setUseInitialFlow(useInitialFlow);
+
+            // the CUDA implementation expects the points as a single row
+            cv::cuda::GpuMat prevPointsGpu(cv::Mat(prevPoints).reshape(2, 1));
+            cv::cuda::GpuMat nextPointsGpu, statusGpu, trackErrorGpu;
+            if(useInitialFlow)
+            {
+                nextPointsGpu.upload(cv::Mat(nextPoints).reshape(2, 1));
+            }
+            mCudaFlow->calc(mPrevGreyGpu, mGreyGpu, prevPointsGpu, nextPointsGpu, statusGpu, trackErrorGpu);
+            nextPointsGpu.download(nextPoints);
+            statusGpu.download(status);
+            trackErrorGpu.download(trackError);
+            return;
+        }
+        catch(const cv::Exception &e)
+        {
+            SPDLOG_WARN("Tracking with CUDA failed, falling back to the CPU: {}", e.what());
+            mUseCuda          = false;
+            mPrevGreyGpuValid = false;
+        }
+    }
+#endif
+
+    // the precomputed pyramids cover only mPyrPatch
+    const cv::Point2f offset = mCurrentPyrValid ? cv::Point2f(mPyrPatch.tl()) : cv::Point2f();
+    if(offset != cv::Point2f())
+    {
+        auto &patchPoints = mScratch.patchPoints;
+        patchPoints.resize(prevPoints.size());
+        std::transform(
+            prevPoints.begin(), prevPoints.end(), patchPoints.begin(), [&](const auto &p) { return p - offset; });
+        if(useInitialFlow)
+        {
+            std::for_each(nextPoints.begin(), nextPoints.end(), [&](auto &p) { p -= offset; });
+        }
+        calcOpticalFlowOnPyramids(patchPoints, nextPoints, status, trackError, winSize, level, useInitialFlow);
+        std::for_each(nextPoints.begin(), nextPoints.end(), [&](auto &p) { p += offset; });
+        return;
+    }
+
+    if(mCurrentPyrValid)
+    {
+        calcOpticalFlowOnPyramids(prevPoints, nextPoints, status, trackError, winSize, level, useInitialFlow);
+    }
+    else
+    {
+        // no pyramids precomputed (CUDA was used for this frame), so they are built internally
+        cv::calcOpticalFlowPyrLK(
+            mPrevGrey,
+            mGrey,
+            prevPoints,
+            nextPoints,
+            status,
+            trackError,
+            cv::Size(winSize, winSize),
+            level,
+            mTermCriteria,
+            useInitialFlow ? cv::OPTFLOW_USE_INITIAL_FLOW : 0);
+    }
+}
+
+/**
+ * @brief Tracks prevPoints with Lucas-Kanade on the precomputed pyramids
+ *
+ * The points are given in the coordinates of mPyrPatch.
+ *
+ * @see calcOpticalFlow
+ */
+void Tracker::calcOpticalFlowOnPyramids(
+    const std::vector<cv::Point2f> &prevPoints,
+    std::vector<cv::Point2f>       &nextPoints,
+    std::vector<uchar>             &status,
+    std::vector<float>             &trackError,
+    int                             winSize,
+    int                             level,
+    bool                            useInitialFlow)
+{
+    // needs at least one level besides the full resolution
+    if(mCoarseToFine && level > 0 && mPrevPyr.size() > 2 && mCurrentPyr.size() > 2)
+    {
+        calcOpticalFlowCoarseToFine(prevPoints, nextPoints, status, trackError, winSize, level, useInitialFlow);
+        return;
+    }
+
+    // calcOpticalFlowPyrLK uses no more than level pyramid levels, even if more are precomputed
+    cv::calcOpticalFlowPyrLK(
+        mPrevPyr,
+        mCurrentPyr,
+        prevPoints,
+        nextPoints,
+        status,
+        trackError,
+        cv::Size(winSize, winSize),
+        level,
+        mTermCriteria,
+        useInitialFlow ? cv::OPTFLOW_USE_INITIAL_FLOW : 0);
+}
+
+
+/**
+ * @brief Tracks prevPoints at half resolution and refines the result at full resolution
+ *
+ * Lucas-Kanade runs on the precomputed pyramids without their full resolution level, i.e.
+ * on the levels 1 to level. Points and window size are halved, so the window covers the same
+ * part of the head as winSize at full resolution. Afterwards, only a few iterations at full
+ * resolution starting at the coarse result refine the points. For large heads (e.g. top-down
+ * 4K recordings) this is nearly as accurate as tracking on all levels.
+ *
+ * @param prevPoints points in the previous frame
+ * @param nextPoints tracked points in the current frame; initial guesses with useInitialFlow
+ * @param status 1, if the point was tracked on both resolutions; 0 otherwise
+ * @param trackError error of the refinement at full resolution
+ * @param winSize size of the search window at full resolution
+ * @param level maximum pyramid level, at least 1
+ * @param useInitialFlow start the search at the given nextPoints instead of prevPoints
+ */
+void Tracker::calcOpticalFlowCoarseToFine(
+    const std::vector<cv::Point2f> &prevPoints,
+    std::vector<cv::Point2f>       &nextPoints,
+    std::vector<uchar>             &status,
+    std::vector<float>             &trackError,
+    int                             winSize,
+    int                             level,
+    bool                            useInitialFlow)
+{
+    auto &coarsePrevPoints = mScratch.coarsePrevPoints;
+    auto &coarseNextPoints = mScratch.coarseNextPoints;
+    coarsePrevPoints.resize(prevPoints.size());
+    coarseNextPoints.resize(prevPoints.size());
+    for(size_t k = 0; k < prevPoints.size(); ++k)
+    {
+        coarsePrevPoints[k] = prevPoints[k] * 0.5F;
+        if(useInitialFlow)
+        {
+            coarseNextPoints[k] = nextPoints[k] * 0.5F;
+        }
+    }
+
+    // each level of the pyramids consists of the image and its derivatives
+    auto &coarsePrevPyr    = mScratch.coarsePrevPyr;
+    auto &coarseCurrentPyr = mScratch.coarseCurrentPyr;
+    coarsePrevPyr.assign(mPrevPyr.begin() + 2, mPrevPyr.end());
+    coarseCurrentPyr.assign(mCurrentPyr.begin() + 2, mCurrentPyr.end());
+    const int coarseWinSize    = std::max(static_cast<int>(MIN_WIN_SIZE), winSize / 2);
+    auto     &coarseStatus     = mScratch.coarseStatus;
+    auto     &coarseTrackError = mScratch.coarseTrackError;
+    cv::calcOpticalFlowPyrLK(
+        coarsePrevPyr,
+        coarseCurrentPyr,
+        coarsePrevPoints,
+        coarseNextPoints,
+        coarseStatus,
+        coarseTrackError,
+        cv::Size(coarseWinSize, coarseWinSize),
+        level - 1,
+        mTermCriteria,
+        useInitialFlow ? cv::OPTFLOW_USE_INITIAL_FLOW : 0);
+
+    nextPoints.resize(prevPoints.size());
+    for(size_t k = 0; k < prevPoints.size(); ++k)
+    {
+        nextPoints[k] = coarseNextPoints[k] * 2.F;
+    }
+    const cv::TermCriteria refineCriteria(
+        cv::TermCriteria::COUNT | cv::TermCriteria::EPS, COARSE_TO_FINE_REFINE_ITERATIONS, mTermCriteria.epsilon);
+    cv::calcOpticalFlowPyrLK(
+        mPrevPyr,
+        mCurrentPyr,
+        prevPoints,
+        nextPoints,
+        status,
+        trackError,
+        cv::Size(winSize, winSize),
+        0,
+        refineCriteria,
+        cv::OPTFLOW_USE_INITIAL_FLOW);
+
+    for(size_t k = 0; k < status.size(); ++k)
+    {
+        status[k] = status[k] && coarseStatus[k];
+    }
 }
 
 
@@ -1133,63 +1752,193 @@ void Tracker::preCalculateImagePyramids(int level)
  * where it should work. A suspicion: Happens when there is no unique point in the following
  * frame, because of every pixel having the exact same grey level in the smalles pyramid scale.
  *
+ * People with the same winSize are tracked in one call of calcOpticalFlowPyrLK, which tracks
+ * the points independently of each other in parallel on the shared pyramids. The results are
+ * written to the index of the person, so they do not depend on the grouping.
+ *
+ * With motion prediction, the people are tracked from their predicted positions first (see
+ * trackPredictedFeaturePointsLK); only those failing are tracked from the previous position.
+ *
  * @param level Maximum pyramid level to track with
  * @param adaptive indicates if pyramid level should be lowered after unsuccessful tracking attempt
  */
 void Tracker::trackFeaturePointsLK(int level, bool adaptive)
 {
+    TRACE_ZONE("Tracker::trackFeaturePointsLK");
     const size_t numOfPeople = mPrevFeaturePointsIdx.size();
     mFeaturePoints.resize(numOfPeople);
     mStatus.resize(numOfPeople);
     mTrackError.resize(numOfPeople);
-    std::vector<uchar> localStatus;
-    std::vector<float> localTrackError;
 
-    for(size_t i = 0; i < numOfPeople; ++i)
+    // indices of the people which still have to be tracked with pyramid level l
+    auto &pending = mScratch.pending;
+    if(mUseMotionPrediction)
     {
-        int l       = level;
-        int winSize = 0;
+        trackPredictedFeaturePointsLK(level);
+    }
+    else
+    {
+        pending.resize(numOfPeople);
+        std::iota(pending.begin(), pending.end(), 0);
+    }
 
-        do
+    auto &groups     = mScratch.groups;
+    auto &notTracked = mScratch.notTracked;
+    for(int l = level; l >= 0 && !pending.empty(); --l)
+    {
+        groups.clear();
+        for(size_t i : pending)
         {
             if(l < level)
             {
-                SPDLOG_WARN("try tracking person {} with pyramid level {}", mPrevFeaturePointsIdx[i], l);
+                LOG_WARN_LIMITED("try tracking person {} with pyramid level {}", mPrevFeaturePointsIdx[i], l);
             }
 
-            winSize = mMainWindow->winSize(nullptr, mPrevFeaturePointsIdx[i], mPrevFrame, l);
+            int winSize = this->winSize(i, l);
             if(winSize < MIN_WIN_SIZE)
             {
                 winSize = MIN_WIN_SIZE;
-                SPDLOG_WARN(
+                LOG_WARN_LIMITED(
                     "set search region to the minimum size of {} for person {}!",
                     MIN_WIN_SIZE,
                     mPrevFeaturePointsIdx[i] + 1);
             }
+            groups.push_back({winSize, l, i});
+        }
+        std::sort(groups.begin(), groups.end());
+
+        notTracked.clear();
+        for(size_t begin = 0, end = 0; begin < groups.size(); begin = end)
+        {
+            end                  = groupEnd(groups, begin);
+            const int winSize    = groups[begin].winSize;
+            auto     &prevPoints = mScratch.prevPoints;
+            prevPoints.clear();
+            for(size_t g = begin; g < end; ++g)
+            {
+                prevPoints.push_back(mPrevFeaturePoints[groups[g].idx]);
+            }
+            auto &nextPoints  = mScratch.nextPoints;
+            auto &localStatus = mScratch.status;
+            auto &localError  = mScratch.trackError;
+
+            calcOpticalFlow(prevPoints, nextPoints, localStatus, localError, winSize, l);
+
+            for(size_t g = begin; g < end; ++g)
+            {
+                const size_t i    = groups[g].idx;
+                const size_t k    = g - begin;
+                mFeaturePoints[i] = nextPoints[k];
+                mTrackError[i]    = localError[k] * 10.F / winSize;
+                // status from OpenCV: 0 -> not tracked, 1 -> tracked
+                mStatus[i] = localStatus[k] ? TrackStatus::Tracked : TrackStatus::NotTracked;
+                if(!localStatus[k])
+                {
+                    notTracked.push_back(i);
+                }
+            }
+        }
+
+        if(!adaptive)
+        {
+            break;
+        }
+        std::sort(notTracked.begin(), notTracked.end());
+        std::swap(pending, notTracked);
+    }
+}
+
+/**
+ * @brief Tracks the people with a motion prediction, starting Lucas-Kanade at the predicted positions
+ *
+ * The predicted positions are used as initial flow (cv::OPTFLOW_USE_INITIAL_FLOW). Lucas-Kanade
+ * with window size w and maximum pyramid level l captures displacements of about w/2 * 2^l, so
+ * the pyramid level is lowered as far as the uncertainty of the prediction allows. The window
+ * size stays the one of the given level, so an accurate prediction saves the iterations on
+ * the higher levels.
+ *
+ * The sorted indices of the people without a prediction or which could not be tracked are left
+ * in mScratch.pending.
+ *
+ * @param level maximum pyramid level to track with
+ */
+void Tracker::trackPredictedFeaturePointsLK(int level)
+{
+    auto &remaining = mScratch.pending;
+    auto &groups    = mScratch.groups;
+    remaining.clear();
+    groups.clear();
+    for(size_t i = 0; i < mPrevFeaturePointsIdx.size(); ++i)
+    {
+        if(mPredictionUncertainty[i] < 0)
+        {
+            remaining.push_back(i);
+            continue;
+        }
+        const int winSize = std::max(static_cast<int>(MIN_WIN_SIZE), this->winSize(i, level));
+        // lowest level capturing the uncertainty of the prediction
+        int predictedLevel = 0;
+        while(predictedLevel < level &&
+              winSize / 2. * (1 << predictedLevel) < PREDICTION_MARGIN * mPredictionUncertainty[i])
+        {
+            ++predictedLevel;
+        }
+        groups.push_back({winSize, predictedLevel, i});
+    }
+    std::sort(groups.begin(), groups.end());
+
+    for(size_t begin = 0, end = 0; begin < groups.size(); begin = end)
+    {
+        end                      = groupEnd(groups, begin);
+        const int winSize        = groups[begin].winSize;
+        const int predictedLevel = groups[begin].level;
+        auto     &prevPoints     = mScratch.prevPoints;
+        auto     &nextPoints     = mScratch.nextPoints;
+        prevPoints.clear();
+        nextPoints.clear();
+        for(size_t g = begin; g < end; ++g)
+        {
+            prevPoints.push_back(mPrevFeaturePoints[groups[g].idx]);
+            nextPoints.push_back(mPredictedFeaturePoints[groups[g].idx]);
+        }
+        auto &localStatus = mScratch.status;
+        auto &localError  = mScratch.trackError;
 
-            std::vector<cv::Point2f> prevFeaturePoint{mPrevFeaturePoints[i]};
-            std::vector<cv::Point2f> nextFeaturePoint{};
-            localStatus.clear();
-            localTrackError.clear();
+        calcOpticalFlow(prevPoints, nextPoints, localStatus, localError, winSize, predictedLevel, true);
 
-            cv::calcOpticalFlowPyrLK(
-                mPrevPyr,
-                mCurrentPyr,
-                prevFeaturePoint,
-                nextFeaturePoint,
-                localStatus,
-                localTrackError,
-                cv::Size(winSize, winSize),
-                l,
-                mTermCriteria);
+        for(size_t g = begin; g < end; ++g)
+        {
+            const size_t i = groups[g].idx;
+            const size_t k = g - begin;
+            if(!localStatus[k])
+            {
+                remaining.push_back(i);
+                continue;
+            }
+            mFeaturePoints[i] = nextPoints[k];
+            mTrackError[i]    = localError[k] * 10.F / winSize;
+            mStatus[i]        = TrackStatus::Tracked;
+        }
+    }
 
-            mFeaturePoints[i] = nextFeaturePoint[0];
-            mTrackError[i]    = localTrackError[0] * 10.F / winSize;
+    std::sort(remaining.begin(), remaining.end());
+}
 
-        } while(adaptive && localStatus[0] == 0 && (l--) > 0);
-        // status from OpenCV: 0 -> not tracked, 1 -> tracked
-        mStatus[i] = localStatus[0] ? TrackStatus::Tracked : TrackStatus::NotTracked;
+/**
+ * @brief Returns the end of the group of people starting at begin, i.e. tracked with the same parameters
+ *
+ * @param groups people sorted by their parameters
+ * @param begin index of the first person of the group in groups
+ */
+size_t Tracker::groupEnd(const std::vector<LKGroupEntry> &groups, size_t begin)
+{
+    size_t end = begin + 1;
+    while(end < groups.size() && groups[end].winSize == groups[begin].winSize &&
+          groups[end].level == groups[begin].level)
+    {
+        ++end;
     }
+    return end;
 }
 
 /**
@@ -1201,56 +1950,87 @@ void Tracker::trackFeaturePointsLK(int level, bool adaptive)
  */
 void Tracker::refineViaColorPointLK(int level, float errorScale)
 {
-    int                      winSize;
-    bool                     useColor = mMainWindow->getMultiColorMarkerWidget()->useColor->isChecked();
-    std::vector<cv::Point2f> prevColorFeaturePoint, colorFeaturePoint;
-    std::vector<uchar>       colorStatus;
-    std::vector<float>       colorTrackError;
+    TRACE_ZONE("Tracker::refineViaColorPointLK");
+    bool useColor = mMainWindow->getMultiColorMarkerWidget()->useColor->isChecked();
+    if(!useColor)
+    {
+        return;
+    }
 
-    for(size_t i = 0; i < mPrevFeaturePointsIdx.size(); ++i)
+    const size_t numOfPeople            = mPrevFeaturePointsIdx.size();
+    auto        &prevColorFeaturePoints = mScratch.prevColorPoints;
+    auto        &colorFeaturePoints     = mScratch.colorPoints;
+    auto        &colorTrackErrors       = mScratch.colorTrackErrors;
+    auto        &colorStatus            = mScratch.colorStatus;
+    prevColorFeaturePoints.assign(numOfPeople, cv::Point2f());
+    colorFeaturePoints.assign(numOfPeople, cv::Point2f());
+    colorTrackErrors.assign(numOfPeople, 0.F);
+    colorStatus.assign(numOfPeople, 0);
+
+    // all color points with the same winSize are tracked in one (internally parallel) call
+    auto &groups = mScratch.groups;
+    groups.clear();
+    for(size_t i = 0; i < numOfPeople; ++i)
     {
         const auto &person = mPersonStorage.at(mPrevFeaturePointsIdx[i]);
         // wenn fehler zu gross, dann Farbmarkerelement nehmen // fuer multicolor marker / farbiger hut mit
         // schwarzem punkt
-        if(useColor && mTrackError[i] > errorScale * 150.F &&
-           person.at(mPrevFrame - person.firstFrame()).color().isValid())
+        if(mTrackError[i] > errorScale * 150.F && person.at(mPrevFrame - person.firstFrame()).color().isValid())
         {
-            float prevPointX = static_cast<float>(person.at(mPrevFrame - person.firstFrame()).colPoint().x());
-            float prevPointY = static_cast<float>(person.at(mPrevFrame - person.firstFrame()).colPoint().y());
-            prevColorFeaturePoint.push_back(cv::Point2f(prevPointX, prevPointY));
-            winSize = mMainWindow->winSize(nullptr, mPrevFeaturePointsIdx[i], mPrevFrame, level);
-
-            cv::calcOpticalFlowPyrLK(
-                mPrevPyr,
-                mCurrentPyr,
-                prevColorFeaturePoint,
-                colorFeaturePoint,
-                colorStatus,
-                colorTrackError,
-                cv::Size(winSize, winSize),
-                level,
-                mTermCriteria);
-
-            colorTrackError[i] = colorTrackError[i] * 10.F / winSize;
-
-            if((colorStatus[i] == 1) && (colorTrackError[i] < errorScale * 50.F))
+            const QPointF colPoint    = person.at(mPrevFrame - person.firstFrame()).colPoint();
+            prevColorFeaturePoints[i] = cv::Point2f(static_cast<float>(colPoint.x()), static_cast<float>(colPoint.y()));
+            if(mPointUndistortion)
             {
-                SPDLOG_WARN(
-                    "tracking color marker instead of structural marker of person {} at {} x {} / error: {} / color "
-                    "error: {}",
-                    mPrevFeaturePointsIdx[i] + 1,
-                    mFeaturePoints[i].x,
-                    mFeaturePoints[i].y,
-                    mTrackError[i],
-                    colorTrackError[i]);
-
-
-                mFeaturePoints[i] = cv::Point2f(
-                    mPrevFeaturePoints[i].x + (colorFeaturePoint[i].x - prevColorFeaturePoint[i].x),
-                    mPrevFeaturePoints[i].x + (colorFeaturePoint[i].x - prevColorFeaturePoint[i].x));
-                SPDLOG_INFO("\tresulting point: {} x {}", mFeaturePoints[i].x, mFeaturePoints[i].y);
-                mTrackError[i] = colorTrackError[i];
+                prevColorFeaturePoints[i] = mPointUndistortion->distort(prevColorFeaturePoints[i]);
             }
+            groups.push_back({winSize(i, level), level, i});
+        }
+    }
+    std::sort(groups.begin(), groups.end());
+
+    for(size_t begin = 0, end = 0; begin < groups.size(); begin = end)
+    {
+        end                  = groupEnd(groups, begin);
+        const int winSize    = groups[begin].winSize;
+        auto     &prevPoints = mScratch.prevPoints;
+        prevPoints.clear();
+        for(size_t g = begin; g < end; ++g)
+        {
+            prevPoints.push_back(prevColorFeaturePoints[groups[g].idx]);
+        }
+        auto &nextPoints = mScratch.nextPoints;
+        auto &status     = mScratch.status;
+        auto &trackError = mScratch.trackError;
+
+        calcOpticalFlow(prevPoints, nextPoints, status, trackError, winSize, level);
+
+        for(size_t g = begin; g < end; ++g)
+        {
+            const size_t i        = groups[g].idx;
+            const size_t k        = g - begin;
+            colorFeaturePoints[i] = nextPoints[k];
+            colorTrackErrors[i]   = trackError[k] * 10.F / winSize;
+            colorStatus[i]        = status[k];
+        }
+    }
+
+    // apply in the order of the people
+    for(size_t i = 0; i < numOfPeople; ++i)
+    {
+        if((colorStatus[i] == 1) && (colorTrackErrors[i] < errorScale * 50.F))
+        {
+            LOG_WARN_LIMITED(
+                "tracking color marker instead of structural marker of person {} at {} x {} / error: {} / color "
+                "error: {}",
+                mPrevFeaturePointsIdx[i] + 1,
+                mFeaturePoints[i].x,
+                mFeaturePoints[i].y,
+                mTrackError[i],
+                colorTrackErrors[i]);
+
+            mFeaturePoints[i] = mPrevFeaturePoints[i] + (colorFeaturePoints[i] - prevColorFeaturePoints[i]);
+            LOG_INFO_LIMITED("\tresulting point: {} x {}", mFeaturePoints[i].x, mFeaturePoints[i].y);
+            mTrackError[i] = colorTrackErrors[i];
         }
     }
 }
@@ -1266,8 +2046,9 @@ void Tracker::refineViaColorPointLK(int level, float errorScale)
  * @param trjToDel[out] trajectories marked for deletion
  * @param bgFilter[in] backgroundFilter, which determines if a point is in the bg
  */
-void Tracker::useBackgroundFilter(QList<int> &trjToDel, BackgroundFilter *bgFilter)
+void Tracker::useBackgroundFilter(std::vector<size_t> &trjToDel, BackgroundFilter *bgFilter)
 {
+    TRACE_ZONE("Tracker::useBackgroundFilter");
     int        x, y;
     static int margin = 10; // rand am bild, ab dem trajectorie in den hintergrund laufen darf
     int        bS     = mMainWindow->getImageBorderSize();
@@ -1290,7 +2071,7 @@ void Tracker::useBackgroundFilter(QList<int> &trjToDel, BackgroundFilter *bgFilt
                    (person.nrInBg() >= mMainWindow->getControlWidget()->getFilterBgDeleteNumber()))
                 {
                     // nur zum loeschen vormerken und am ende der fkt loeschen, da sonst Seiteneffekte komplex
-                    trjToDel += mPrevFeaturePointsIdx[i];
+                    trjToDel.push_back(static_cast<size_t>(mPrevFeaturePointsIdx[i]));
                     SPDLOG_WARN(
                         "delete trajectory {} inside region of interest, because it laid outside foreground for {} "
                         "successive frames!",
@@ -1321,11 +2102,16 @@ void Tracker::useBackgroundFilter(QList<int> &trjToDel, BackgroundFilter *bgFilt
  */
 void Tracker::refineViaNearDarkPoint()
 {
-    int x, y;
+    TRACE_ZONE("Tracker::refineViaNearDarkPoint");
+    // the region sizes need the main window, so they are determined before the parallel search
+    auto &candidates  = mScratch.candidates;
+    auto &regionSizes = mScratch.regionSizes;
+    candidates.clear();
+    regionSizes.clear();
     for(size_t i = 0; i < mPrevFeaturePointsIdx.size(); ++i)
     {
-        x = myRound(mFeaturePoints[i].x - .5);
-        y = myRound(mFeaturePoints[i].y - .5);
+        const int x = myRound(mFeaturePoints[i].x - .5);
+        const int y = myRound(mFeaturePoints[i].y - .5);
         // der reine fehler ist leider kein alleinig gutes mass,
         // da in kontrastarmen regionen der angegebene fehler gering, aber das resultat haeufiger fehlerhaft ist
         // es waere daher schoen, wenn der fehler in abhaengigkeit von kontrast in umgebung skaliert wuerde
@@ -1333,87 +2119,32 @@ void Tracker::refineViaNearDarkPoint()
         if((mTrackError[i] > MAX_TRACK_ERROR) && (mStatus[i] == TrackStatus::Tracked) && x >= 0 && x < mGrey.cols &&
            y >= 0 && y < mGrey.rows)
         {
-            int regionSize = myRound(
-                mMainWindow->getHeadSize(nullptr, mPrevFeaturePointsIdx[i], mPrevFrame) /
-                10.); ///< size of searched region around point: -regionSize to regionSize
-            int  xMin, xMax, yMin, yMax, xMin2, xMax2, yMin2, yMax2, darkest;
-            bool markerInsideWhite = true;
-            int  xDark = x, yDark = y;
-
-            // trotz grau (img)->nChannels=3
-            xMin = ((0 > (x - regionSize)) ? 0 : (x - regionSize));
-            yMin = ((0 > (y - regionSize)) ? 0 : (y - regionSize));
-            xMax = ((mGrey.cols < (x + regionSize + 1)) ? mGrey.cols : (x + regionSize + 1));
-            yMax = ((mGrey.rows < (y + regionSize + 1)) ? mGrey.rows : (y + regionSize + 1));
-
-            darkest = 255;
-            for(int k = yMin; k < yMax; ++k)
-            {
-                for(int j = xMin; j < xMax; ++j)
-                {
-                    if(getValue(mGrey, j, k).value() < darkest)
-                    {
-                        darkest = getValue(mGrey, j, k).value();
-                        xDark   = j;
-                        yDark   = k;
-                    }
-                }
-            }
-
-            xMin2 = ((0 > (xDark - regionSize)) ? 0 : (xDark - regionSize));
-            yMin2 = ((0 > (yDark - regionSize)) ? 0 : (yDark - regionSize));
-            xMax2 = ((mGrey.cols < (xDark + regionSize + 1)) ? mGrey.cols : (xDark + regionSize + 1));
-            yMax2 = ((mGrey.rows < (yDark + regionSize + 1)) ? mGrey.rows : (yDark + regionSize + 1));
-
-            // suchbereich:
-            //  ###
-            // #   #
-            // #   #
-            // #   #
-            //  ###
-            for(int k = yMin2 + 1; k < yMax2 - 1; ++k)
-            {
-                if((getValue(mGrey, xMin2, k).value() <= darkest) || (getValue(mGrey, xMax2 - 1, k).value() <= darkest))
-                {
-                    markerInsideWhite = false;
-                    break;
-                }
-            }
-            if(markerInsideWhite)
-            {
-                for(int j = xMin2 + 1; j < xMax2 - 1; ++j)
-                {
-                    if((getValue(mGrey, j, yMin2).value() <= darkest) ||
-                       (getValue(mGrey, j, yMax2 - 1).value() <= darkest))
-                    {
-                        markerInsideWhite = false;
-                        break;
-                    }
-                }
-            }
-
-            if(markerInsideWhite)
-            {
-                mFeaturePoints[i].x = xDark;
-                mFeaturePoints[i].y = yDark;
-                SPDLOG_INFO("move TrackPoint to darker pixel for {}!", i + 1);
-            }
+            candidates.push_back(i);
+            // size of searched region around point: -regionSize to regionSize
+            const double headSize =
+                mMainWindow->getHeadSize(nullptr, mPrevFeaturePointsIdx[i], mPrevFrame) * localScale(i);
+            regionSizes.push_back(myRound(headSize / 10.));
+        }
+    }
 
-            // interpolation wg nachbargrauwerten:
-            x = myRound(mFeaturePoints[i].x);
-            y = myRound(mFeaturePoints[i].y);
-            if((x > 0) && (x < (mGrey.cols - 1)) && (y > 0) && (y < (mGrey.rows - 1)) && (darkest < 255))
+    // every point only reads mGrey and writes its own feature point
+    auto &moved = mScratch.moved;
+    moved.assign(candidates.size(), 0);
+    cv::parallel_for_(
+        cv::Range(0, static_cast<int>(candidates.size())),
+        [&](const cv::Range &range)
+        {
+            for(int c = range.start; c < range.end; ++c)
             {
-                mFeaturePoints[i].x +=
-                    .5 * ((double) (getValue(mGrey, x + 1, y).value() - getValue(mGrey, x - 1, y).value())) /
-                    ((double) (255 - darkest));
-                mFeaturePoints[i].y +=
-                    .5 * ((double) (getValue(mGrey, x, y + 1).value() - getValue(mGrey, x, y - 1).value())) /
-                    ((double) (255 - darkest));
+                moved[c] = moveToNearDarkPoint(mGrey, mFeaturePoints[candidates[c]], regionSizes[c]);
             }
+        });
 
-            mFeaturePoints[i].x += .5F;
-            mFeaturePoints[i].y += .5F; // da 1. pixel von 0..1, das 2. pixel von 1..2 etc geht
+    for(size_t c = 0; c < candidates.size(); ++c)
+    {
+        if(moved[c])
+        {
+            SPDLOG_INFO("move TrackPoint to darker pixel for {}!", candidates[c] + 1);
         }
     }
 }
@@ -1451,7 +2182,7 @@ void TrackPerson::syncTrackPersonMarkerID(int markerID)
  * @param i index of TrackPoint
  * @return i-th TrackPoint of the TrackPerson
  */
-const TrackPoint &TrackPerson::at(int i) const
+TrackPoint TrackPerson::at(int i) const
 {
     return mData.at(i);
 }
@@ -1466,59 +2197,145 @@ bool TrackPerson::isEmpty() const
     return mData.isEmpty();
 }
 
-const TrackPoint &TrackPerson::first() const
+/**
+ * @brief Approximate number of bytes used by the TrackPerson including its TrackPoints
+ */
+std::size_t TrackPerson::memoryUsage() const
+{
+    return sizeof(TrackPerson) + mData.memoryUsage() + mComment.capacity() * sizeof(QChar) +
+           mColorStatistics.memoryUsage();
+}
+
+/**
+ * @brief Checks in constant time, if other is an unmodified copy of this person
+ *
+ * Only attributes written to a trc file are compared. The track points are equal if
+ * they are still shared with the copy; a person with the same, but separately set
+ * points is regarded as different.
+ */
+bool TrackPerson::hasSameTrcData(const TrackPerson &other) const
+{
+    return mNr == other.mNr && mMarkerID == other.mMarkerID && mHeight == other.mHeight &&
+           mFirstFrame == other.mFirstFrame && mColor == other.mColor && mColorCount == other.mColorCount &&
+           mComment == other.mComment && mData.isSharedWith(other.mData);
+}
+
+TrackPoint TrackPerson::first() const
 {
     return mData.first();
 }
 
-const TrackPoint &TrackPerson::last() const
+TrackPoint TrackPerson::last() const
 {
     return mData.last();
 }
 
-QList<TrackPoint>::const_iterator TrackPerson::cbegin() const
+TrackPointColumns::ConstIterator TrackPerson::cbegin() const
 {
     return mData.cbegin();
 }
 
-QList<TrackPoint>::const_iterator TrackPerson::cend() const
+TrackPointColumns::ConstIterator TrackPerson::cend() const
 {
     return mData.cend();
 }
 
-QList<TrackPoint>::const_iterator TrackPerson::begin() const
+TrackPointColumns::ConstIterator TrackPerson::begin() const
 {
     return mData.cbegin();
 }
 
-QList<TrackPoint>::const_iterator TrackPerson::end() const
+TrackPointColumns::ConstIterator TrackPerson::end() const
 {
     return mData.cend();
 }
 
+void TrackPerson::reserve(int size)
+{
+    mData.reserve(size);
+}
+
 void TrackPerson::append(const TrackPoint &trackPoint)
 {
-    mData.append(trackPoint);
+    appendPoint(trackPoint);
+}
+
+/**
+ * @brief Replaces all points, e.g. by columns mapped from a trajectory index (see IO::readTrcIndex())
+ *
+ * The color statistics are rebuilt from the new points, when they are needed.
+ *
+ * @param columns points from firstFrame() on; must not be empty
+ */
+void TrackPerson::setColumns(const TrackPointColumns &columns)
+{
+    mData = columns;
+    mColorStatistics.invalidate();
+}
+
+/// Appends p to mData and its color to mColorStatistics
+void TrackPerson::appendPoint(const TrackPoint &p)
+{
+    mData.append(p);
+    mColorStatistics.pushBack(p.color(), p.colPoint() - p);
+}
+
+/// Prepends p to mData and its color to mColorStatistics
+void TrackPerson::prependPoint(const TrackPoint &p)
+{
+    mData.prepend(p);
+    mColorStatistics.pushFront(p.color(), p.colPoint() - p);
+}
+
+/**
+ * @brief Replaces the point at index and keeps mColorStatistics up to date
+ *
+ * Colors at the ends of the trajectory are exchanged in the statistics, a color in the
+ * middle invalidates them until the next optimizeColor().
+ */
+void TrackPerson::replacePoint(int index, const TrackPoint &p)
+{
+    const TrackPoint old = mData.at(index);
+    mData.replace(index, p);
+    if(!old.color().isValid() && !p.color().isValid())
+    {
+        return;
+    }
+    if(index == mData.size() - 1)
+    {
+        mColorStatistics.popBack(old.color());
+        mColorStatistics.pushBack(p.color(), p.colPoint() - p);
+    }
+    else if(index == 0)
+    {
+        mColorStatistics.popFront(old.color());
+        mColorStatistics.pushFront(p.color(), p.colPoint() - p);
+    }
+    else
+    {
+        mColorStatistics.invalidate();
+    }
 }
 
 void TrackPerson::clear()
 {
     mData.clear();
+    mColorStatistics.clear();
 }
 
 void TrackPerson::replaceTrackPoint(int frame, TrackPoint trackPoint)
 {
-    mData[frame - mFirstFrame] = trackPoint;
+    replacePoint(frame - mFirstFrame, trackPoint);
 }
 
 void TrackPerson::updateStereoPoint(int frame, Vec3F stereoPoint)
 {
-    mData[frame - mFirstFrame].setSp(stereoPoint);
+    mData.setSp(frame - mFirstFrame, stereoPoint);
 }
 
 void TrackPerson::updateMarkerID(int frame, int markerID)
 {
-    mData[frame - mFirstFrame].setMarkerID(markerID);
+    mData.setMarkerID(frame - mFirstFrame, markerID);
 }
 
 /**
@@ -1551,9 +2368,8 @@ void TrackPerson::removeFramesBetween(int startFrame, int endFrame)
     auto startIndex = startFrame - mFirstFrame;
     auto endIndex   = endFrame - mFirstFrame + 1; // +1 to also remove endFrame
 
-    auto startIt = mData.begin() + startIndex;
-    auto endIt   = mData.begin() + endIndex;
-    mData.erase(startIt, endIt);
+    mData.remove(startIndex, endIndex);
+    mColorStatistics.invalidate();
 
     if(startFrame == mFirstFrame)
     {
@@ -1741,3 +2557,56 @@ std::ostream &operator<<(std::ostream &s, const TrackPerson &tp)
     }
     return s;
 }
+
+void writeTrc(BufferedTextWriter &out, const TrackPerson &tp)
+{
+    out.print("{} {:g} {} {} {} ", tp.nr(), tp.height(), tp.firstFrame(), tp.lastFrame(), tp.colCount());
+    out.printColor(tp.color());
+    if(Petrack::trcVersion > 3)
+    {
+        out.print(" {}", tp.getMarkerID());
+    }
+    out.print(" {}\n{}\n", tp.size(), tp.serializeComment());
+
+    for(const TrackPoint &point : tp)
+    {
+        out.print("{:g} {:g} ", point.x(), point.y());
+        if(Petrack::trcVersion > 1)
+        {
+            out.print("{:g} {:g} {:g} ", point.sp().x(), point.sp().y(), point.sp().z());
+        }
+        out.print("{} {:g} {:g} ", point.qual(), point.colPoint().x(), point.colPoint().y());
+        out.printColor(point.color());
+        if(Petrack::trcVersion > 2)
+        {
+            out.print(" {}", point.getMarkerID());
+        }
+        out.print("\n");
+    }
+}
+
+/**
+ * @brief Writes a whole trc file with Petrack::trcVersion, as done by Petrack::exportTracker
+ *
+ * Does not touch any widget, so it may run on a worker thread.
+ *
+ * @return false, if writing to device failed
+ */
+bool writeTrc(
+    QIODevice                         &device,
+    const std::vector<TrackPerson>    &persons,
+    const ThrottledProgress::Callback &progressCallback)
+{
+    TRACE_ZONE("writeTrc");
+    BufferedTextWriter out(device);
+    out.print("version {}\n{}\n", Petrack::trcVersion, persons.size());
+
+    ThrottledProgress progress(progressCallback, static_cast<int>(persons.size()));
+    for(std::size_t i = 0; i < persons.size(); ++i)
+    {
+        writeTrc(out, persons[i]);
+        out.print("\n");
+        progress.update(static_cast<int>(i + 1));
+    }
+    return out.flush();
+}
@@ -20,8 +20,11 @@
 #define TRACKER_H
 
 #include "annotationGrouping.h"
+#include "bufferedTextWriter.h"
+#include "colorStatistics.h"
 #include "intervalList.h"
 #include "recognition.h"
+#include "trackPointColumns.h"
 #include "vector.h"
 
 #include <QColor>
@@ -29,10 +32,22 @@
 #include <QRegularExpression>
 #include <QSet>
 #include <QTextStream>
+#include <opencv2/core/cuda.hpp>
+#include <opencv2/opencv_modules.hpp>
+#include <optional>
 #include <spdlog/fmt/bundled/format.h>
+#include <tuple>
+#include <vector>
 
+#ifdef HAVE_OPENCV_CUDAOPTFLOW
+#include <opencv2/cudaoptflow.hpp>
+#endif
+
+class FrameContext;
 class PersonStorage;
 class Petrack;
+class PointUndistortion;
+class TrackPointGrid;
 
 // war 1.5, aber bei bildauslassungen kann es ungewollt zuschlagen (bei 3 ist ein ausgelassener frame mgl, bei 2 wieder
 // ein problem)
@@ -44,6 +59,12 @@ inline constexpr int MAX_COUNT = 1500;
 // maximale zahl an frames zwischen denen noch getrackt wird
 inline constexpr int MAX_STEP_TRACK = 5;
 
+// margin between the uncertainty of a motion prediction and the displacement Lucas-Kanade can capture
+inline constexpr double PREDICTION_MARGIN = 2.;
+
+// iterations of Lucas-Kanade at full resolution after tracking at half resolution in the coarse-to-fine mode
+inline constexpr int COARSE_TO_FINE_REFINE_ITERATIONS = 5;
+
 // maximaler fehler beim tracken, so das noch punkt hinzugefuegt wird
 // um am ende des tracking nicht am bildrand herumzukrakseln!
 inline constexpr float MAX_TRACK_ERROR = 200.F;
@@ -121,6 +142,15 @@ struct fmt::formatter<TrackPoint>
     }
 };
 
+/**
+ * @brief Position of a TrackPerson predicted by a constant velocity model
+ */
+struct MotionPrediction
+{
+    Vec2F  position;
+    double uncertainty; ///< expected deviation of the actual position in pixel
+};
+
 /**
  * @brief Stores all tracking information for a whole trajectory, as markerID, color, comment and also the
  * corresponding TrackPoints.
@@ -143,8 +173,13 @@ private:
     QString           mComment;       //< comment for person
     int               mNrInBg;        //< number of successive frames in the background
     int               mColorCount;    //< number of colors where mColor is average from
-    QList<TrackPoint> mData{};        //< TrackPoints from mFirstFrame to mLastFrame;;
+    TrackPointColumns mData{};        //< TrackPoints from mFirstFrame to mLastFrame;;
     IntervalList<int> mGroups{annotationGroups::NO_GROUP.id};
+    ColorStatistics   mColorStatistics; //< colors of mData for optimizeColor()
+
+    void appendPoint(const TrackPoint &p);
+    void prependPoint(const TrackPoint &p);
+    void replacePoint(int index, const TrackPoint &p);
 
 public:
     TrackPerson(int nr, int frame, const TrackPoint &p);
@@ -152,6 +187,7 @@ public:
     TrackPerson(int nr, int frame, const TrackPoint &p, int markerID);
 
     bool insertAtFrame(int frame, const TrackPoint &p, int persNr, bool extrapolate);
+    void insertPointsOf(const TrackPerson &other, int persNr, bool extrapolate);
 
     inline int  nrInBg() const { return mNrInBg; }
     inline void setNrInBg(int n) { mNrInBg = n; }
@@ -192,29 +228,39 @@ public:
      */
     inline QString serializeComment() const { return QString{mComment}.replace(QRegularExpression("\n"), "<br>"); }
 
-    inline void       setComment(QString s) { mComment = s; }
-    inline int        colCount() const { return mColorCount; }
-    inline void       setColCount(int c) { mColorCount = c; }
-    void              addColor(const QColor &col);
-    void              optimizeColor();
-    bool              trackPointExist(int frame) const;
-    const TrackPoint &trackPointAt(int frame) const;
+    inline void setComment(QString s) { mComment = s; }
+    inline int  colCount() const { return mColorCount; }
+    inline void setColCount(int c) { mColorCount = c; }
+    void        addColor(const QColor &col);
+    void        optimizeColor();
+    bool        trackPointExist(int frame) const;
+    TrackPoint  trackPointAt(int frame) const;
     // gibt -1 zurueck, wenn frame oder naechster frame nicht existiert
     // entfernung ist absolut
     double distanceToNextFrame(int frame) const;
     void   syncTrackPersonMarkerID(int markerID);
 
-    const TrackPoint &at(int i) const;
-
-    int                               size() const;
-    bool                              isEmpty() const;
-    const TrackPoint                 &first() const;
-    const TrackPoint                 &last() const;
-    QList<TrackPoint>::const_iterator begin() const;
-    QList<TrackPoint>::const_iterator end() const;
-    QList<TrackPoint>::const_iterator cbegin() const;
-    QList<TrackPoint>::const_iterator cend() const;
-
+    std::optional<MotionPrediction> predictPosition(int fromFrame, int frame) const;
+
+    TrackPoint at(int i) const;
+
+    int                              size() const;
+    bool                             isEmpty() const;
+    std::size_t                      memoryUsage() const;
+    bool                             hasSameTrcData(const TrackPerson &other) const;
+    TrackPoint                       first() const;
+    TrackPoint                       last() const;
+    TrackPointColumns::ConstIterator begin() const;
+    TrackPointColumns::ConstIterator end() const;
+    TrackPointColumns::ConstIterator cbegin() const;
+    TrackPointColumns::ConstIterator cend() const;
+    /// points as columns, e.g. for the vectorized kernels in trajectoryVelocity.h
+    inline const TrackPointColumns &columns() const { return mData; }
+    /// points for moving them into a TrajectorySpillStore or compressing them; must not be resized
+    inline TrackPointColumns &spillableColumns() { return mData; }
+    void                      setColumns(const TrackPointColumns &columns);
+
+    void reserve(int size);
     void append(const TrackPoint &trackPoint);
     void clear();
     void replaceTrackPoint(int frame, TrackPoint trackPoint);
@@ -233,10 +279,25 @@ QTextStream &operator<<(QTextStream &s, const TrackPerson &tp);
 
 std::ostream &operator<<(std::ostream &s, const TrackPerson &tp);
 
+// same text as operator<<(QTextStream &, const TrackPerson &), but formatted into a large buffer
+void writeTrc(BufferedTextWriter &out, const TrackPerson &tp);
+bool writeTrc(
+    QIODevice                         &device,
+    const std::vector<TrackPerson>    &persons,
+    const ThrottledProgress::Callback &progressCallback = {});
+
 TrackPerson fromTrc(QTextStream &stream);
 
 //----------------------------------------------------------------------------
 
+/// Outcome of Tracker::track() for one frame
+struct TrackSummary
+{
+    int tracked   = 0; ///< persons tracked into the frame
+    int lost      = 0; ///< persons, which could not be tracked or were deleted
+    int uncertain = 0; ///< tracked persons with an error above the tolerance of the tracker
+};
+
 /**
  * @brief Class orchestrating tracking and related stuff
  *
@@ -259,9 +320,47 @@ private:
         Merged
     };
 
+    /// Person with the parameters of its call of Lucas-Kanade; sorted, people tracked together are adjacent
+    struct LKGroupEntry
+    {
+        int    winSize;
+        int    level;
+        size_t idx; ///< index in mPrevFeaturePointsIdx
+
+        bool operator<(const LKGroupEntry &other) const
+        {
+            return std::tie(winSize, level, idx) < std::tie(other.winSize, other.level, other.idx);
+        }
+    };
+
+    /// Buffers of the steps of track(); cleared, but never freed, so the steady state allocates no memory
+    struct Scratch
+    {
+        std::vector<size_t>       persons; ///< active persons of the previous frame
+        std::vector<LKGroupEntry> groups;
+        std::vector<size_t>       pending, notTracked;
+        std::vector<cv::Point2f>  prevPoints, nextPoints, coarsePrevPoints, coarseNextPoints, patchPoints;
+        std::vector<uchar>        status, coarseStatus;
+        std::vector<float>        trackError, coarseTrackError;
+        std::vector<cv::Mat>      coarsePrevPyr, coarseCurrentPyr;
+        std::vector<cv::Point2f>  prevColorPoints, colorPoints;
+        std::vector<float>        colorTrackErrors;
+        std::vector<uchar>        colorStatus;
+        std::vector<size_t>       candidates;
+        std::vector<int>          regionSizes;
+        std::vector<uchar>        moved;
+        std::vector<size_t>       trjToDel;
+    };
+
     Petrack                 *mMainWindow;
     cv::Mat                  mGrey, mPrevGrey;
     std::vector<cv::Mat>     mPrevPyr, mCurrentPyr;
+    bool                     mPrevPyrValid    = false; ///< mPrevPyr belongs to mPrevGrey and can be reused
+    bool                     mCurrentPyrValid = false; ///< mCurrentPyr was built for mGrey in this frame
+    int                      mPyrWinSize      = 0;     ///< window size the padding of the pyramids suffices for
+    int                      mPyrLevel        = -1;    ///< maximum level of the pyramids
+    cv::Rect                 mPatch;                   ///< region to track in; empty for the whole image
+    cv::Rect                 mPyrPatch;                ///< region of the grey images the pyramids are built for
     std::vector<cv::Point2f> mPrevFeaturePoints, mFeaturePoints;
     std::vector<TrackStatus> mStatus;
     int                      mPrevFrame;
@@ -270,6 +369,25 @@ private:
     cv::TermCriteria         mTermCriteria;
     PersonStorage           &mPersonStorage;
 
+    bool                     mUseMotionPrediction = false; ///< start Lucas-Kanade at the predicted positions
+    bool                     mCoarseToFine        = false; ///< track at half resolution and refine at full resolution
+    std::vector<cv::Point2f> mPredictedFeaturePoints;      ///< predicted mPrevFeaturePoints in the current frame
+    std::vector<float>       mPredictionUncertainty;       ///< uncertainty in pixel; negative if no prediction
+    TrackSummary             mSummary;                     ///< outcome of the last call of track()
+    Scratch                  mScratch;
+
+    /// the frames are distorted, only the points are undistorted; nullptr, if the frames are undistorted
+    const PointUndistortion *mPointUndistortion = nullptr;
+    std::vector<float>       mLocalScale; ///< PointUndistortion::scale at mPrevFeaturePoints
+
+    bool             mUseCuda          = false; ///< track with cv::cuda::SparsePyrLKOpticalFlow instead of the CPU
+    bool             mCudaRequested    = false; ///< CUDA was selected, even if it is not available on this machine
+    bool             mPrevGreyGpuValid = false; ///< mPrevGreyGpu belongs to mPrevGrey and can be reused
+    cv::cuda::GpuMat mGreyGpu, mPrevGreyGpu;    ///< device copies of the grey images for mUseCuda
+#ifdef HAVE_OPENCV_CUDAOPTFLOW
+    cv::Ptr<cv::cuda::SparsePyrLKOpticalFlow> mCudaFlow;
+#endif
+
 public:
     Tracker(QWidget *wParent, PersonStorage &storage);
 
@@ -280,20 +398,36 @@ public:
 
     void resize(cv::Size size);
 
+    bool setUseCuda(bool use);
+    bool isUsingCuda() const { return mUseCuda; }
+    bool isCudaRequested() const { return mCudaRequested; }
+    void setUseMotionPrediction(bool use) { mUseMotionPrediction = use; }
+    bool isUsingMotionPrediction() const { return mUseMotionPrediction; }
+    void setCoarseToFine(bool coarseToFine) { mCoarseToFine = coarseToFine; }
+    bool isCoarseToFine() const { return mCoarseToFine; }
+    /// restricts the pyramids to patch (image coordinates); empty for the whole image
+    void setPatch(const cv::Rect &patch) { mPatch = patch; }
+    /// the next frames are not undistorted; nullptr, if they are
+    void setPointUndistortion(const PointUndistortion *undistortion) { mPointUndistortion = undistortion; }
+
+    const TrackSummary &getSummary() const { return mSummary; }
+
+    std::size_t memoryUsage() const;
+
     size_t calcPrevFeaturePoints(
-        int          prevFrame,
-        cv::Rect    &rect,
-        int          frame,
-        bool         reTrack,
-        int          reQual,
-        int          borderSize,
-        QSet<size_t> onlyVisible);
+        int                 prevFrame,
+        cv::Rect           &rect,
+        int                 frame,
+        bool                reTrack,
+        int                 reQual,
+        int                 borderSize,
+        const QSet<size_t> &onlyVisible);
 
     int insertFeaturePoints(int frame, size_t count, cv::Mat &img, int borderSize, cv::Mat map1, float errorScale);
 
     // frame ist frame fuer naechsten prev frame
     int track(
-        cv::Mat                &img,
+        const FrameContext     &frameContext,
         cv::Rect               &rect,
         cv::Mat                 map1,
         int                     frame,
@@ -302,9 +436,11 @@ public:
         int                     borderSize,
         reco::RecognitionMethod recoMethod,
         int                     level              = 3,
-        QSet<size_t>            onlyVisible        = QSet<size_t>(),
+        const QSet<size_t>     &onlyVisible        = QSet<size_t>(),
         int                     errorScaleExponent = 0);
 
+    int copyPreviousFrame(int frame, const QSet<size_t> &onlyVisible = QSet<size_t>());
+
     void checkPlausibility(
         QList<int> &pers,
         QList<int> &frame,
@@ -314,14 +450,48 @@ public:
         bool        testLength   = true);
 
 private:
-    bool tryMergeTrajectories(const TrackPoint &v, size_t i, int frame);
+    bool tryMergeTrajectories(const TrackPoint &v, size_t i, int frame, TrackPointGrid &grid);
+
+    int    winSize(size_t i, int level) const;
+    double localScale(size_t i) const;
+    void   toDistortedFrame();
 
     void trackFeaturePointsLK(int level);
     void trackFeaturePointsLK(int level, bool adaptive);
     void refineViaColorPointLK(int level, float errorScale);
-    void useBackgroundFilter(QList<int> &trjToDel, BackgroundFilter *bgFilter);
+    void useBackgroundFilter(std::vector<size_t> &trjToDel, BackgroundFilter *bgFilter);
     void refineViaNearDarkPoint();
+    void summarize(size_t count, float errorScale);
     void preCalculateImagePyramids(int level);
+    void uploadGreyImages();
+    void calcOpticalFlow(
+        const std::vector<cv::Point2f> &prevPoints,
+        std::vector<cv::Point2f>       &nextPoints,
+        std::vector<uchar>             &status,
+        std::vector<float>             &trackError,
+        int                             winSize,
+        int                             level,
+        bool                            useInitialFlow = false);
+    void calcOpticalFlowOnPyramids(
+        const std::vector<cv::Point2f> &prevPoints,
+        std::vector<cv::Point2f>       &nextPoints,
+        std::vector<uchar>             &status,
+        std::vector<float>             &trackError,
+        int                             winSize,
+        int                             level,
+        bool                            useInitialFlow);
+    void calcOpticalFlowCoarseToFine(
+        const std::vector<cv::Point2f> &prevPoints,
+        std::vector<cv::Point2f>       &nextPoints,
+        std::vector<uchar>             &status,
+        std::vector<float>             &trackError,
+        int                             winSize,
+        int                             level,
+        bool                            useInitialFlow);
+
+    void trackPredictedFeaturePointsLK(int level);
+
+    static size_t groupEnd(const std::vector<LKGroupEntry> &groups, size_t begin);
 };
 
 #endif
@@ -21,14 +21,20 @@
 #include "animation.h"
 #include "calibFilter.h"
 #include "control.h"
+#include "displacementFlow.h"
 #include "helper.h"
 #include "logger.h"
 #include "personStorage.h"
 #include "petrack.h"
 #include "player.h"
 #include "recognition.h"
+#include "swapFilter.h"
+#include "trace.h"
 #include "worldImageCorrespondence.h"
+#include "worldPositionMap.h"
 
+#include <QCryptographicHash>
+#include <algorithm>
 #include <fstream>
 #include <opencv2/highgui.hpp>
 
@@ -123,6 +129,59 @@ TrackerReal::TrackerReal(QWidget *wParent, PersonStorage &storage) :
     mMainWindow = (class Petrack *) wParent;
 }
 
+/**
+ * @brief Forgets the conversions of the last calculate(), so the next one converts all persons
+ */
+void TrackerReal::invalidate()
+{
+    mConvertedSettings.clear();
+    mConvertedPersons.clear();
+    mConvertedHeights.clear();
+    mConverted.clear();
+}
+
+/**
+ * @brief Finds the conversion of the last calculate() for each of persons
+ *
+ * The persons are compared in order, so deleted and inserted persons only shift the
+ * comparison. A person can be reused, if it was not modified since and is converted with
+ * the same height.
+ *
+ * @return index into mConverted for each person; -1 if the person has to be converted
+ */
+std::vector<int>
+TrackerReal::matchConverted(const std::vector<TrackPerson> &persons, const std::vector<double> &heights) const
+{
+    // at most this many persons are skipped as deleted, when looking for the next match
+    constexpr std::size_t maxSkip = 16;
+
+    std::vector<int> match(persons.size(), -1);
+    std::size_t      next = 0; // first converted person not matched yet
+    for(std::size_t i = 0; i < persons.size(); ++i)
+    {
+        const std::size_t end = std::min(mConvertedPersons.size(), next + maxSkip + 1);
+        for(std::size_t j = next; j < end; ++j)
+        {
+            if(persons[i].hasSameTrcData(mConvertedPersons[j]) && heights[i] == mConvertedHeights[j])
+            {
+                match[i] = static_cast<int>(j);
+                next     = j + 1;
+                break;
+            }
+        }
+    }
+    return match;
+}
+
+/**
+ * @brief Converts the trajectories of PersonStorage into world coordinates
+ *
+ * Only persons changed since the last call are converted again, as long as the options
+ * and the calibration are the same. Changes of the calibration are detected by sampling
+ * its back projection at a few image points.
+ *
+ * @return number of world trajectories; -1 without tracker and color plot
+ */
 // default: int imageBorderSize = 0, bool missingFramesInserted = true, bool useTrackpoints = false
 int TrackerReal::calculate(
     Petrack                        *petrack,
@@ -144,21 +203,22 @@ int TrackerReal::calculate(
     bool                            exportMarkerID,
     bool                            exportAutoCorrect)
 {
+    TRACE_ZONE("TrackerReal::calculate");
     if(tracker || colorPlot)
     {
         if(size() > 0)
         {
             clear();
+            mSourcePersons.clear();
         }
 
-        int        j, f;
         QList<int> missingList;    // frame nr wo ausgelassen; passend dazu:
         QList<int> missingListAnz; // anzahl ausgelassener frames
         if(missingFramesInserted)
         {
             if(!missingFrames.isExecuted())
             {
-                missingFrames.setMissingFrames(computeDroppedFrames(petrack));
+                missingFrames.setMissingFrames(computeDroppedFrames(petrack, missingFrames.getDisplacementCache()));
                 missingFrames.setExecuted(true);
             }
 
@@ -176,36 +236,118 @@ int TrackerReal::calculate(
 
         // fps ist nicht aussagekraeftig, da sie mgl von ausgelassenen herruehren - besser immer 25,01 fps annehmen
 
-        double          height; // groesse in cm
-        int             firstFrame, addFrames, anz;
-        Vec2F           br(imageBorderSize, imageBorderSize);
-        QPointF         pos, pos2;
-        QList<int>      tmpMissingList;    // frame nr
-        QList<int>      tmpMissingListAnz; // anzahl frames
-        TrackPersonReal trackPersonReal;
-        auto            imgRect = mMainWindow->getImage()->size();
-        QPointF         center  = worldImageCorr->getPosReal(QPointF(imgRect.width() / 2., imgRect.height() / 2.), 0.);
-        Vec3F           sp;
-        int             tsize;
-        int             extrapolated;
-        QPointF         colPos;
-        float           angle;
+        // everything read from the widgets is queried once here, so the workers do not access the GUI
+        const auto worldConversion = worldImageCorr->snapshot();
+
+        const Vec2F   br(imageBorderSize, imageBorderSize);
+        const auto    imgRect = mMainWindow->getImage()->size();
+        const QPointF center  = worldConversion->getPosReal(QPointF(imgRect.width() / 2., imgRect.height() / 2.), 0.);
+
+        // the world positions are sampled once, so the track points do not need an exact back projection each;
+        // other heights and points outside of the image are computed exactly; built only if a person is converted
+        WorldPositionMap positionMap;
+        auto             getPosReal = [&positionMap, &worldConversion](const QPointF &p, double h)
+        { return positionMap.contains(p, h) ? positionMap.at(p, h) : worldConversion->getPosReal(p, h); };
+
+        const auto perspectiveCorrection = reco::getPerspectiveCorrection(mMainWindow->getControlWidget());
+        const auto recoMethod            = petrack->getControlWidget()->getRecoMethod();
+        const auto camToWorld            = petrack->getExtrCalibration()->getCamToWorldRotation();
+
+        // ausreisser ausfindig machen (dies geschieht, bevor -1 elemente herausgenommen werden, um die
+        // glaettung beim eliminieren der -1 elemente hier nicht einfluss nehmen zu lassen),
+        // wenn direkt pointgrey hoehe oder eigene hoehenberechnung aber variierend ueber trj genommen werden soll
+        if(exportSmooth && (useTrackpoints || alternateHeight))
+        {
+            // changes Trajectories!
+            mPersonStorage.smoothHeights();
+        }
 
         const auto &persons = mPersonStorage.getPersons();
-        for(size_t i = 0; i < persons.size(); ++i) // ueber trajektorien
+
+        std::vector<double> settings{
+            static_cast<double>(imageBorderSize),
+            static_cast<double>(missingFramesInserted),
+            static_cast<double>(useTrackpoints),
+            static_cast<double>(alternateHeight),
+            altitude,
+            static_cast<double>(useCalibrationCenter),
+            static_cast<double>(exportElimTp),
+            static_cast<double>(exportElimTrj),
+            static_cast<double>(exportViewingDirection),
+            static_cast<double>(exportAngleOfView),
+            static_cast<double>(exportMarkerID),
+            static_cast<double>(exportAutoCorrect),
+            static_cast<double>(mUseWorldPositionMap),
+            static_cast<double>(static_cast<int>(recoMethod)),
+            center.x(),
+            center.y(),
+            perspectiveCorrection.pointUnderCamera.x,
+            perspectiveCorrection.pointUnderCamera.y,
+            perspectiveCorrection.pointUnderCamera.z};
+        settings.insert(settings.end(), camToWorld.val, camToWorld.val + 9);
+        for(int k = 0; k < missingList.size(); ++k)
+        {
+            settings.push_back(missingList[k]);
+            settings.push_back(missingListAnz[k]);
+        }
+        // samples of the calibration, a change of the intrinsic or extrinsic calibration moves them
+        for(const double fx : {0.1, 0.5, 0.9})
+        {
+            for(const double fy : {0.1, 0.5, 0.9})
+            {
+                const QPointF image(fx * imgRect.width(), fy * imgRect.height());
+                for(const double h : {0., 180.})
+                {
+                    const QPointF world = worldConversion->getPosReal(image, h);
+                    settings.push_back(world.x());
+                    settings.push_back(world.y());
+                }
+                settings.push_back(worldConversion->getAngleToGround(image.x(), image.y(), 180.));
+            }
+        }
+        if(settings != mConvertedSettings)
+        {
+            invalidate();
+            mConvertedSettings = std::move(settings);
+        }
+
+        std::vector<double> heights(persons.size());
+        for(size_t i = 0; i < persons.size(); ++i)
         {
+            const auto &person = persons[i];
+            heights[i]         = person.height() < MIN_HEIGHT + 1 ? colorPlot->map(person.color()) : person.height();
+        }
+        const std::vector<int> match = matchConverted(persons, heights);
+        if(mUseWorldPositionMap && !useTrackpoints && std::count(match.begin(), match.end(), -1) > 0)
+        {
+            constexpr int cellSize = 16; // in pixel
+            positionMap.build(
+                cv::Rect(0, 0, imgRect.width(), imgRect.height()),
+                cellSize,
+                {0., 50., 100., 150., 200., 250.}, // in cm
+                [&worldConversion](const QPointF &p, double h) { return worldConversion->getPosReal(p, h); });
+        }
+
+        // converts the trajectory of person i; only modifies this person, so the persons can be converted in parallel
+        auto convertPerson = [&](size_t i)
+        {
+            double          height; // groesse in cm
+            int             j, f;
+            int             firstFrame, addFrames, anz;
+            QPointF         pos, pos2;
+            QList<int>      tmpMissingList;    // frame nr
+            QList<int>      tmpMissingListAnz; // anzahl frames
+            TrackPersonReal trackPersonReal;
+            Vec3F           sp;
+            int             tsize;
+            int             extrapolated;
+            QPointF         colPos;
+            float           angle;
+
             const auto &person = persons[i];
             addFrames          = 0;
             firstFrame         = person.firstFrame();
-
-            if(person.height() < MIN_HEIGHT + 1)
-            {
-                height = colorPlot->map(person.color());
-            }
-            else
-            {
-                height = person.height();
-            }
+            height             = heights[i];
 
             if(missingList.size() > 0)
             {
@@ -226,15 +368,6 @@ int TrackerReal::calculate(
             for(j = 0; (j < tsize); ++j) // ueber trackpoints
             {
                 Vec2F moveDir(0, 0); // used for head direction
-                // ausreisser ausfindig machen (dies geschieht, bevor -1 elemente herausgenommen werden, um die
-                // glaettung beim eliminieren der -1 elemente hier nicht einfluss nehmen zu lassen):
-                if(exportSmooth && (useTrackpoints || alternateHeight) &&
-                   (tsize > 1)) // wenn direkt pointgrey hoehe oder eigene hoehenberechnung aber variierend ueber
-                                // trj genommen werden soll
-                {
-                    // changes Trajectories!
-                    mPersonStorage.smoothHeight(i, j + person.firstFrame());
-                }
                 if(useTrackpoints)
                 {
                     // border unberuecksichtigt
@@ -318,10 +451,10 @@ int TrackerReal::calculate(
                             }
                             if(exportAutoCorrect)
                             {
-                                moveDir += reco::autoCorrectColorMarker(person.at(j), mMainWindow->getControlWidget());
+                                moveDir += reco::autoCorrectColorMarker(person.at(j), perspectiveCorrection);
                             }
 
-                            pos = worldImageCorr->getPosReal((person.at(j) + moveDir + br).toQPointF(), bestZ);
+                            pos = getPosReal((person.at(j) + moveDir + br).toQPointF(), bestZ);
                             trackPersonReal.addEnd(Vec3F(pos.x(), pos.y(), bestZ), firstFrame + j);
                         }
                     }
@@ -329,14 +462,14 @@ int TrackerReal::calculate(
                     {
                         if(exportAutoCorrect)
                         {
-                            moveDir += reco::autoCorrectColorMarker(person.at(j), mMainWindow->getControlWidget());
+                            moveDir += reco::autoCorrectColorMarker(person.at(j), perspectiveCorrection);
                         }
 
-                        pos = worldImageCorr->getPosReal((person.at(j) + moveDir + br).toQPointF(), height);
+                        pos = getPosReal((person.at(j) + moveDir + br).toQPointF(), height);
                         trackPersonReal.addEnd(pos, firstFrame + j);
                         if(exportAngleOfView)
                         {
-                            angle = (90. - worldImageCorr->getAngleToGround(
+                            angle = (90. - worldConversion->getAngleToGround(
                                                (person.at(j) + br).x(), (person.at(j) + br).y(), height)) *
                                     PI / 180.;
                             trackPersonReal.last().setAngleOfView(angle);
@@ -350,13 +483,10 @@ int TrackerReal::calculate(
 
                 if(exportViewingDirection)
                 {
-                    auto method = petrack->getControlWidget()->getRecoMethod();
-
                     // multicolor markers can also be used together with code markers
-                    if(method == reco::RecognitionMethod::Code || method == reco::RecognitionMethod::MultiColor)
+                    if(recoMethod == reco::RecognitionMethod::Code || recoMethod == reco::RecognitionMethod::MultiColor)
                     {
-                        auto orientation = person.at(j).getOrientation();
-                        orientation      = petrack->getExtrCalibration()->camToWorldRotation(orientation);
+                        const cv::Vec3d orientation = camToWorld * person.at(j).getOrientation();
                         trackPersonReal.last().setViewDirection(Vec2F(orientation[0], orientation[1]).unit());
                     }
                     else
@@ -370,8 +500,7 @@ int TrackerReal::calculate(
                         if((exportViewingDirection) &&
                            (person.at(j).color().isValid())) // wenn blickrichtung mit ausgegeben werden soll
                         {
-                            colPos = worldImageCorr->getPosReal(
-                                (person.at(j).colPoint() + moveDir + br).toQPointF(), height);
+                            colPos = getPosReal((person.at(j).colPoint() + moveDir + br).toQPointF(), height);
                             trackPersonReal.last().setViewDirection(colPos - pos);
                         }
                     }
@@ -415,14 +544,11 @@ int TrackerReal::calculate(
                                 moveDir.set(0, 0);
                                 if(exportAutoCorrect)
                                 {
-                                    moveDir +=
-                                        reco::autoCorrectColorMarker(person.at(j), mMainWindow->getControlWidget());
+                                    moveDir += reco::autoCorrectColorMarker(person.at(j), perspectiveCorrection);
                                 }
 
-                                pos2 =
-                                    (worldImageCorr->getPosReal((person.at(j + 1) + moveDir + br).toQPointF(), height) -
-                                     pos) /
-                                    (anz + 1);
+                                pos2 = (getPosReal((person.at(j + 1) + moveDir + br).toQPointF(), height) - pos) /
+                                       (anz + 1);
                                 for(f = 1; f <= anz; ++f)
                                 {
                                     trackPersonReal.addEnd(pos + f * pos2, -1); // -1 zeigt an, dass nur interpoliert
@@ -476,13 +602,38 @@ int TrackerReal::calculate(
                     trackPersonReal.removeFirst();
                 }
             }
-            if(trackPersonReal.size() < 20)
+            return trackPersonReal;
+        };
+
+        // the workers only use the snapshot of the calibration taken above
+        std::vector<TrackPersonReal> converted(persons.size());
+        cv::parallel_for_(
+            cv::Range(0, static_cast<int>(persons.size())),
+            [&](const cv::Range &range)
             {
-                SPDLOG_WARN("person {} has only {} TrackPoints!", i + 1, trackPersonReal.size());
+                for(int i = range.start; i < range.end; ++i)
+                {
+                    converted[i] = match[i] >= 0 ? mConverted[match[i]] : convertPerson(i);
+                }
+            });
+        SPDLOG_DEBUG(
+            "converted {} of {} persons into world coordinates",
+            std::count(match.begin(), match.end(), -1),
+            persons.size());
+        mConvertedPersons = persons;
+        mConvertedHeights = std::move(heights);
+        mConverted        = converted;
+
+        for(size_t i = 0; i < converted.size(); ++i) // ueber trajektorien
+        {
+            if(converted[i].size() < 20)
+            {
+                SPDLOG_WARN("person {} has only {} TrackPoints!", i + 1, converted[i].size());
             }
-            if(trackPersonReal.size() > 0)
+            if(converted[i].size() > 0)
             {
-                append(trackPersonReal);
+                append(converted[i]);
+                mSourcePersons.push_back(static_cast<int>(i));
             }
             else // ggf weil keine calculated height vorlag (siehe exportElimTrj)
             {
@@ -527,7 +678,7 @@ void TrackerReal::calcMinMax()
     }
 }
 
-int TrackerReal::largestFirstFrame()
+int TrackerReal::largestFirstFrame() const
 {
     int max = -1, i;
     for(i = 0; i < size(); ++i)
@@ -539,7 +690,7 @@ int TrackerReal::largestFirstFrame()
     }
     return max;
 }
-int TrackerReal::largestLastFrame()
+int TrackerReal::largestLastFrame() const
 {
     int max = -1, i;
     for(i = 0; i < size(); ++i)
@@ -551,7 +702,7 @@ int TrackerReal::largestLastFrame()
     }
     return max;
 }
-int TrackerReal::smallestFirstFrame()
+int TrackerReal::smallestFirstFrame() const
 {
     int i, min = ((size() > 0) ? at(0).firstFrame() : -1);
     for(i = 1; i < size(); ++i)
@@ -563,7 +714,7 @@ int TrackerReal::smallestFirstFrame()
     }
     return min;
 }
-int TrackerReal::smallestLastFrame()
+int TrackerReal::smallestLastFrame() const
 {
     int i, min = ((size() > 0) ? at(0).lastFrame() : -1);
     for(i = 1; i < size(); ++i)
@@ -577,256 +728,275 @@ int TrackerReal::smallestLastFrame()
 }
 
 void TrackerReal::exportTxt(
-    QTextStream &out,
-    bool         alternateHeight,
-    bool         useTrackpoints,
-    bool         exportViewingDirection,
-    bool         exportAngleOfView,
-    bool         exportUseM,
-    bool         exportMarkerID)
+    BufferedTextWriter                &out,
+    bool                               alternateHeight,
+    bool                               useTrackpoints,
+    bool                               exportViewingDirection,
+    bool                               exportAngleOfView,
+    bool                               exportUseM,
+    bool                               exportMarkerID,
+    const ThrottledProgress::Callback &progressCallback) const
 {
-    float scale;
-
-    out << "# z: can be 3d position or height of person (alternating or not)" << Qt::endl;
+    TRACE_ZONE("TrackerReal::exportTxt");
+    out.print("# z: can be 3d position or height of person (alternating or not)\n");
     if(exportViewingDirection)
     {
-        out << "# viewDirX viewDirY: vector of direction of head of person" << Qt::endl;
+        out.print("# viewDirX viewDirY: vector of direction of head of person\n");
     }
     if(exportAngleOfView)
     {
-        out << "# viewAngle: angle of view of camera to person from perpendicular [0..Pi/2]" << Qt::endl;
+        out.print("# viewAngle: angle of view of camera to person from perpendicular [0..Pi/2]\n");
     }
     if(exportUseM)
     {
-        out << "# id frame x/m y/m z/m";
+        out.print("# id frame x/m y/m z/m");
     }
     else
     {
-        out << "# id frame x/cm y/cm z/cm";
+        out.print("# id frame x/cm y/cm z/cm");
     }
     if(exportViewingDirection)
     {
-        out << " viewDirX viewDirY";
+        out.print(" viewDirX viewDirY");
     }
     if(exportAngleOfView)
     {
-        out << " viewAngle";
+        out.print(" viewAngle");
     }
     if(exportMarkerID)
     {
-        out << " markerID";
+        out.print(" markerID");
     }
+    out.print("\n");
 
-    out << Qt::endl;
-
-
-    if(exportUseM)
-    {
-        scale = .01f;
-    }
-    else
-    {
-        scale = 1.f;
-    }
-
-    QProgressDialog progress("Export TXT-File", nullptr, 0, size(), mMainWindow->window());
-    progress.setWindowTitle("Export .txt-File");
-    progress.setWindowModality(Qt::WindowModal);
-    progress.setVisible(true);
-    progress.setValue(0);
-    progress.setLabelText(QString("Export tracking data ..."));
-    qApp->processEvents();
+    const float scale = exportUseM ? .01f : 1.f;
 
+    ThrottledProgress progress(progressCallback, size());
     for(int i = 0; i < size(); ++i)
     {
-        qApp->processEvents();
-        progress.setLabelText(QString("Export person %1 of %2 ...").arg(i + 1).arg(size()));
-        progress.setValue(i + 1);
-
-        for(int j = 0; j < at(i).size(); ++j)
+        const TrackPersonReal &person = at(i);
+        for(int j = 0; j < person.size(); ++j)
         {
-            out << i + 1 << " " << at(i).firstFrame() + j << " " << at(i).at(j).x() * scale << " "
-                << at(i).at(j).y() * scale << " ";
-
-            if(alternateHeight || useTrackpoints)
-            {
-                out << at(i).at(j).z() * scale;
-            }
-            else
-            {
-                out << at(i).height() * scale;
-            }
+            const TrackPointReal &point = person.at(j);
+            out.print(
+                "{} {} {:g} {:g} {:g}",
+                i + 1,
+                person.firstFrame() + j,
+                point.x() * scale,
+                point.y() * scale,
+                ((alternateHeight || useTrackpoints) ? point.z() : person.height()) * scale);
 
             if(exportViewingDirection) // && (at(i).at(j).viewDir() != Vec2F(0,0)) zeigt an, dass keine richtung
                                        // berechnet werden konnte
             {
-                out << " " << at(i).at(j).viewDir();
+                out.print(" {:g} {:g}", point.viewDir().x(), point.viewDir().y());
             }
 
             if(exportAngleOfView)
             {
-                out << " " << at(i).at(j).angleOfView();
+                out.print(" {:g}", point.angleOfView());
             }
 
             if(exportMarkerID)
             {
-                out << " " << at(i).getMarkerID();
+                out.print(" {}", person.getMarkerID());
             }
 
-            out << Qt::endl;
+            out.print("\n");
         }
+        progress.update(i + 1);
     }
 }
 
-// old - not all export options supported!!!!
-void TrackerReal::exportDat(QTextStream &out, bool alternateHeight, bool useTrackpoints) // fuer gnuplot
+void TrajectoryColumns::reserve(std::size_t rows)
 {
-    QProgressDialog progress("Export DAT-File", nullptr, 0, size(), mMainWindow->window());
-    progress.setWindowTitle("Export .dat-File");
-    progress.setWindowModality(Qt::WindowModal);
-    progress.setVisible(true);
-    progress.setValue(0);
-    progress.setLabelText(QString("Export tracking data ..."));
-    SPDLOG_INFO("size: {}", size());
-    if(useTrackpoints)
+    id.reserve(rows);
+    frame.reserve(rows);
+    x.reserve(rows);
+    y.reserve(rows);
+    z.reserve(rows);
+    markerID.reserve(rows);
+    viewDirX.reserve(rows);
+    viewDirY.reserve(rows);
+}
+
+/**
+ * @brief Collects the trajectories column by column for binary exports
+ *
+ * Ids, frames and z are the same as written by exportTxt(); all columns are
+ * always filled, positions are in cm.
+ */
+TrajectoryColumns TrackerReal::exportColumns(bool alternateHeight, bool useTrackpoints) const
+{
+    TRACE_ZONE("TrackerReal::exportColumns");
+    std::size_t rows = 0;
+    for(const auto &person : *this)
     {
-        for(int i = 0; i < size(); ++i)
-        {
-            progress.setLabelText(QString("Export person %1 of %2 ...").arg(i + 1).arg(size()));
-            qApp->processEvents();
-            progress.setValue(i + 1);
+        rows += person.size();
+    }
 
-            for(int j = 0; j < at(i).size(); ++j)
-            {
-                // Umrechnung in coordSystem fehlt, auch camera altitude unberuecksichtigt!!!
-                out << at(i).firstFrame() + j << " " << at(i).at(j) << " " << at(i).at(j).z()
-                    << Qt::endl; // z Koordinate ist Kopf
-            }
-            out << Qt::endl;
+    TrajectoryColumns columns;
+    columns.reserve(rows);
+    for(int i = 0; i < size(); ++i)
+    {
+        const TrackPersonReal &person = at(i);
+        for(int j = 0; j < person.size(); ++j)
+        {
+            const TrackPointReal &point = person.at(j);
+            columns.id.push_back(i + 1);
+            columns.frame.push_back(person.firstFrame() + j);
+            columns.x.push_back(static_cast<float>(point.x()));
+            columns.y.push_back(static_cast<float>(point.y()));
+            columns.z.push_back(
+                static_cast<float>((alternateHeight || useTrackpoints) ? point.z() : person.height()));
+            columns.markerID.push_back(person.getMarkerID());
+            columns.viewDirX.push_back(static_cast<float>(point.viewDir().x()));
+            columns.viewDirY.push_back(static_cast<float>(point.viewDir().y()));
         }
     }
-    else
+    return columns;
+}
+
+/**
+ * @brief Returns the annotation group of each row of exportColumns()
+ *
+ * The group is looked up in the person of the PersonStorage the trajectory was calculated from,
+ * at the frame of the row. With inserted missing frames, rows after a gap are looked up at their
+ * shifted frame. Rows without group get the id of NO_GROUP.
+ */
+std::vector<int> TrackerReal::exportGroups() const
+{
+    std::vector<int> groups;
+    for(int i = 0; i < size(); ++i)
     {
-        for(int i = 0; i < size(); ++i)
+        const TrackPersonReal   &person = at(i);
+        const IntervalList<int> &list   = mPersonStorage.getGroupList(mSourcePersons.at(i));
+        for(int j = 0; j < person.size(); ++j)
         {
-            progress.setLabelText(QString("Export person %1 of %2 ...").arg(i + 1).arg(size()));
-            qApp->processEvents();
-            progress.setValue(i + 1);
-            SPDLOG_INFO("person: {}", i);
+            groups.push_back(list.getValue(person.firstFrame() + j));
+        }
+    }
+    return groups;
+}
 
-            for(int j = 0; j < at(i).size(); ++j)
-            {
-                if(alternateHeight)
-                {
-                    out << at(i).firstFrame() + j << " " << at(i).at(j) << " " << at(i).at(j).z()
-                        << Qt::endl; // z Koordinate ist Kopf
-                }
-                else
-                {
-                    out << at(i).firstFrame() + j << " " << at(i).at(j) << " " << at(i).height()
-                        << Qt::endl; // z Koordinate ist Kopf
-                }
-            }
-            out << Qt::endl;
+// old - not all export options supported!!!!
+void TrackerReal::exportDat(
+    BufferedTextWriter                &out,
+    bool                               alternateHeight,
+    bool                               useTrackpoints,
+    const ThrottledProgress::Callback &progressCallback) const // fuer gnuplot
+{
+    TRACE_ZONE("TrackerReal::exportDat");
+    SPDLOG_INFO("size: {}", size());
+    ThrottledProgress progress(progressCallback, size());
+    for(int i = 0; i < size(); ++i)
+    {
+        const TrackPersonReal &person = at(i);
+        for(int j = 0; j < person.size(); ++j)
+        {
+            // Umrechnung in coordSystem fehlt, auch camera altitude unberuecksichtigt!!!
+            const TrackPointReal &point = person.at(j);
+            out.print(
+                "{} {:g} {:g} {:g}\n",
+                person.firstFrame() + j,
+                point.x(),
+                point.y(),
+                (useTrackpoints || alternateHeight) ? point.z() : person.height()); // z Koordinate ist Kopf
         }
+        out.print("\n");
+        progress.update(i + 1);
     }
 }
 
-void TrackerReal::exportXml(QTextStream &outXml, bool alternateHeight, bool useTrackpoints)
+void TrackerReal::exportXml(
+    BufferedTextWriter                &outXml,
+    bool                               alternateHeight,
+    bool                               useTrackpoints,
+    const ThrottledProgress::Callback &progressCallback) const
 {
-    int    i, j, largestLastFr = largestLastFrame();
-    double z;
-    int    defaultPersonHeight = 176;
-
-    QProgressDialog progress("Export XML-File", nullptr, 0, largestLastFr, mMainWindow->window());
-    progress.setWindowTitle("Export .xml-File");
-    progress.setWindowModality(Qt::WindowModal);
-    progress.setVisible(true);
-    progress.setValue(0);
-    progress.setLabelText(QString("Export tracking data ..."));
-    qApp->processEvents();
-
-    outXml << "    <shape>" << Qt::endl;
-    for(j = 0; j < size(); ++j)
+    TRACE_ZONE("TrackerReal::exportXml");
+    const int largestLastFr       = largestLastFrame();
+    const int defaultPersonHeight = 176;
+
+    outXml.print("    <shape>\n");
+    for(int j = 0; j < size(); ++j)
     {
         if(alternateHeight) // bei variierender groesse wird einfach durchschnittsgroesse genommen, da an treppen
                             // gar keine vernuempftige Groesse vorliegt
         {
-            outXml << "        <agentInfo ID=\"" << j + 1 << "\" color=\"100\" height=\"" << defaultPersonHeight
-                   << "\"/>" << Qt::endl;
+            outXml.print("        <agentInfo ID=\"{}\" color=\"100\" height=\"{}\"/>\n", j + 1, defaultPersonHeight);
         }
         else
         {
-            outXml << "        <agentInfo ID=\"" << j + 1 << "\" color=\"100\" height=\"" << at(j).height() << "\"/>"
-                   << Qt::endl;
+            outXml.print("        <agentInfo ID=\"{}\" color=\"100\" height=\"{:g}\"/>\n", j + 1, at(j).height());
         }
     }
-    outXml << "    </shape>" << Qt::endl << Qt::endl;
+    outXml.print("    </shape>\n\n");
 
     // i = frame; j = person
-    for(i = smallestFirstFrame(); i <= largestLastFr; ++i)
+    ThrottledProgress progress(progressCallback, largestLastFr);
+    for(int i = smallestFirstFrame(); i <= largestLastFr; ++i)
     {
-        progress.setLabelText(QString("Export data ..."));
-        qApp->processEvents();
-        progress.setValue(i);
-
-        outXml << "    <frame ID=\"" << i << "\">" << Qt::endl;
-        for(j = 0; j < size(); ++j)
+        outXml.print("    <frame ID=\"{}\">\n", i);
+        for(int j = 0; j < size(); ++j)
         {
             if(at(j).trackPointExist(i))
             {
+                const TrackPointReal &point = at(j).trackPointAt(i);
                 // z-wert ist hier ausnahmsweise nicht der kopf, sondern der boden, die prsonengroesse wird dem
                 // obigem person-datenentnommen personID, Frame ID(?) , X , Y , Z
+                double z;
                 if(useTrackpoints)
                 {
-                    z = at(j).trackPointAt(i).z() + defaultPersonHeight;
+                    z = point.z() + defaultPersonHeight;
                 }
                 else // war, wenn ebene versuche sinnvoll:z = at(j).trackPointAt(i).z()+at(j).height();
                 {
                     if(alternateHeight)
                     {
-                        z = at(j).trackPointAt(i).z() - defaultPersonHeight;
+                        z = point.z() - defaultPersonHeight;
                     }
                     else // war, wenn ebene versuche sinnvoll: z = at(j).trackPointAt(i).z()-at(j).height();
                     {
                         z = 0; // at(j).height();
                     }
                 }
-                outXml << "        <agent ID=\"" << j + 1 << "\" xPos=\"" << at(j).trackPointAt(i).x() << "\" yPos=\""
-                       << at(j).trackPointAt(i).y() << "\" zPos=\"" << z
-                       << "\" xVel=\"0\" yVel=\"0\" zVel=\"0\" radiusA=\"18\" radiusB=\"15\" "
-                          "ellipseOrientation=\"130\" ellipseColor=\"0\"/>"
-                       << Qt::endl; // z Koordinate ist Boden
+                outXml.print(
+                    "        <agent ID=\"{}\" xPos=\"{:g}\" yPos=\"{:g}\" zPos=\"{:g}\" xVel=\"0\" yVel=\"0\" "
+                    "zVel=\"0\" radiusA=\"18\" radiusB=\"15\" ellipseOrientation=\"130\" ellipseColor=\"0\"/>\n",
+                    j + 1,
+                    point.x(),
+                    point.y(),
+                    z); // z Koordinate ist Boden
             }
         }
-        outXml << "    </frame>" << Qt::endl;
+        outXml.print("    </frame>\n");
+        progress.update(i);
     }
 }
 
 /**
  * @brief Compute the dropped frames
  *
- * @note This function needs to "play" the video again to track each pedestrian, hence it is quite expensive!
+ * The optical flow of every track point is computed on the sequence decoded in the
+ * background (see computePointFlows), so neither the Player nor the control widgets are
+ * touched. Flows already in cache are reused.
  *
- * @param petrack handler for managing the player and getting the frame
+ * @param petrack handler for getting the sequence and the filter settings
+ * @param cache flows of the track points computed before
  * @return vector of all missing frame (frame number and number of frames missing)
  */
-std::vector<MissingFrame> TrackerReal::computeDroppedFrames(Petrack *petrack)
+std::vector<MissingFrame> TrackerReal::computeDroppedFrames(Petrack *petrack, DisplacementCache &cache)
 {
     if(petrack->getImageFiltered().empty())
     {
         throw std::runtime_error(
             "Can not compute missing frames with an empty video. Please load a video, and try again.");
     }
-
-    // Save current state
-    auto recognitionState = petrack->getControlWidget()->isPerformRecognitionChecked();
-    petrack->getControlWidget()->setPerformRecognitionChecked(false);
-
-    auto trackingState = petrack->getControlWidget()->isOnlineTrackingChecked();
-    petrack->getControlWidget()->setOnlineTrackingChecked(false);
-
-    int currentFrameNum = petrack->getPlayer()->getPos();
+    if(petrack->getAnimation()->isCameraLiveStream())
+    {
+        throw std::runtime_error("Can not compute missing frames of a camera live stream.");
+    }
 
     auto minFrame = std::max(0, petrack->getPlayer()->getFrameInNum());
     auto maxFrame = std::min(petrack->getAnimation()->getNumFrames(), petrack->getPlayer()->getFrameOutNum());
@@ -846,27 +1016,26 @@ std::vector<MissingFrame> TrackerReal::computeDroppedFrames(Petrack *petrack)
         }
     }
 
-    auto displacementsPerFrame = utils::computeDisplacement(minFrame, maxFrame, petrack, personsInFrame, idsInFrame);
+    auto displacementsPerFrame =
+        utils::computeDisplacement(minFrame, maxFrame, petrack, personsInFrame, idsInFrame, cache);
 
     // Detect missing frames
-    std::vector<MissingFrame> missingFrames = utils::detectMissingFrames(displacementsPerFrame);
-
-
-    petrack->getPlayer()->skipToFrame(currentFrameNum);
-    petrack->getControlWidget()->setPerformRecognitionChecked(recognitionState);
-    petrack->getControlWidget()->setOnlineTrackingChecked(trackingState);
-
-    return missingFrames;
+    return utils::detectMissingFrames(displacementsPerFrame);
 }
 
 /**
  * @brief Computes the displacement for each detected pedestrian in each frame
  *
+ * The flows of the points not in cache are computed in parallel on regions of the
+ * frames (see computePointFlows) and added to cache. Converting them into
+ * displacements depends on the previous frame and is done sequentially afterwards.
+ *
  * @param minFrameNum frame to start the computation
  * @param maxFrameNum frame to end the computation
- * @param petrack handler for managing the player and getting the frame
+ * @param petrack handler for getting the sequence and the filter settings
  * @param personsInFrame pixel coordinates where each pedestrian is located in a frame (same order as idsInFrame)
  * @param idsInFrame ids of pedestrians in a frame (same order as personsInFrame)
+ * @param cache flows computed before; reset, if the sequence, filters or tracking settings changed
  * @return displacement for each pedestrian in each frame
  */
 std::vector<std::unordered_map<int, double>> utils::computeDisplacement(
@@ -874,72 +1043,117 @@ std::vector<std::unordered_map<int, double>> utils::computeDisplacement(
     int                                          maxFrameNum,
     Petrack                                     *petrack,
     const std::vector<std::vector<cv::Point2f>> &personsInFrame,
-    const std::vector<std::vector<int>>         &idsInFrame)
+    const std::vector<std::vector<int>>         &idsInFrame,
+    DisplacementCache                           &cache)
 {
-    auto fps = petrack->getAnimation()->getSequenceFPS();
-
-    petrack->getPlayer()->skipToFrame(minFrameNum);
-
-    cv::Mat currentFrame;
-    cv::Mat prevFrame;
-
-    cv::Mat prevFrameColor = petrack->getImageFiltered();
-    cv::cvtColor(prevFrameColor, prevFrame, cv::COLOR_BGR2GRAY);
-
-    std::vector<std::unordered_map<int, double>> displacementsPerFrame(maxFrameNum + 1);
+    auto          *animation = petrack->getAnimation();
+    const auto     fps       = animation->getSequenceFPS();
+    const cv::Size filteredSize(petrack->getImageFiltered().cols, petrack->getImageFiltered().rows);
 
     // compute window size
     auto cmPerPixelXYMiddle = petrack->getWorldImageCorrespondence().getCmPerPixel(
-        static_cast<float>(prevFrame.cols / 2),
-        static_cast<float>(prevFrame.rows / 2),
+        static_cast<float>(filteredSize.width / 2),
+        static_cast<float>(filteredSize.height / 2),
         static_cast<float>(petrack->getControlWidget()->getDefaultHeight()));
     auto             cmPerPixelMiddle = (cmPerPixelXYMiddle.x() + cmPerPixelXYMiddle.y()) / 2.;
     constexpr double headFactor       = 1.25; //< factor around head size to ensure complete head is in window
     int              winsize          = static_cast<int>(headFactor * HEAD_SIZE / cmPerPixelMiddle);
     cv::Size         window{winsize, winsize};
+    const int        maxLevel = petrack->getControlWidget()->getTrackRegionLevels();
+
+    // the flows depend on the sequence, the filters and the settings of Lucas-Kanade
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(petrack->getFilteredFrameStoreName().toUtf8());
+    hash.addData(QByteArray::number(winsize) + " " + QByteArray::number(maxLevel));
+    cache.setKey(hash.result().toHex());
 
+    std::vector<FlowJob> jobs;
     for(int frame = minFrameNum + 1; frame <= maxFrameNum; frame++)
     {
-        // get the current frame and convert to gray scale image
-        petrack->getPlayer()->frameForward();
-        cv::Mat currentFrameColor = petrack->getImageFiltered();
-        cv::cvtColor(currentFrameColor, currentFrame, cv::COLOR_BGR2GRAY);
-
-        // track the current points in the image
-        std::vector<cv::Point2f> prevFeaturePoint{personsInFrame[frame - 1]};
-        if(prevFeaturePoint.empty())
+        FlowJob job{frame, {}};
+        for(const auto &point : personsInFrame[frame - 1])
         {
-            cv::swap(prevFrame, currentFrame);
-            continue;
+            if(!cache.find(frame, point))
+            {
+                job.points.push_back(point);
+            }
+        }
+        if(!job.points.empty())
+        {
+            jobs.push_back(std::move(job));
         }
+    }
 
-        std::vector<cv::Point2f> nextFeaturePoint{};
-        std::vector<uchar>       localStatus;
-        std::vector<float>       localTrackError;
+    if(!jobs.empty())
+    {
+        const int   borderSize  = petrack->getImageBorderSize();
+        auto       *swapFilter  = petrack->getSwapFilter();
+        const bool  flipH       = swapFilter->getEnabled() && swapFilter->getSwapHorizontally().getValue();
+        const bool  flipV       = swapFilter->getEnabled() && swapFilter->getSwapVertically().getValue();
+        auto       *calibFilter = petrack->getCalibFilter();
+        cv::Mat     map1;
+        cv::Mat     map2;
+        if(calibFilter->getEnabled())
+        {
+            calibFilter->updateMaps(filteredSize);
+            map1 = calibFilter->getMap1();
+            map2 = calibFilter->getMap2();
+        }
+        const FilterGeometry geometry(
+            cv::Size(filteredSize.width - 2 * borderSize, filteredSize.height - 2 * borderSize),
+            borderSize,
+            flipH,
+            flipV,
+            map1,
+            map2);
+
+        FrameSource source;
+        if(animation->isImageSequence())
+        {
+            source.images = animation->getImageFiles();
+        }
+        else if(animation->isVideo() && !animation->isStereoVideo())
+        {
+            source.video        = animation->getFileInfo().absoluteFilePath().toStdString();
+            source.acceleration = animation->getHwAcceleration();
+        }
+        else
+        {
+            source.readFrame = [animation](int index) { return animation->getFrameAtIndex(index); };
+        }
 
-        int maxLevel = petrack->getControlWidget()->getTrackRegionLevels();
+        const int  currentFrame = animation->getCurrentFrameNum();
+        const auto flows        = computePointFlows(source, geometry, jobs, window, maxLevel);
+        if(source.readFrame)
+        {
+            animation->getFrameAtIndex(currentFrame);
+        }
+        for(size_t i = 0; i < jobs.size(); ++i)
+        {
+            for(const auto &flow : flows[i])
+            {
+                cache.insert(jobs[i].frame, flow);
+            }
+        }
+    }
 
-        cv::calcOpticalFlowPyrLK(
-            prevFrame,
-            currentFrame,
-            prevFeaturePoint,
-            nextFeaturePoint,
-            localStatus,
-            localTrackError,
-            window,
-            maxLevel);
+    std::vector<std::unordered_map<int, double>> displacementsPerFrame(maxFrameNum + 1);
+    for(int frame = minFrameNum + 1; frame <= maxFrameNum; frame++)
+    {
+        const auto &prevFeaturePoint = personsInFrame[frame - 1];
 
         // compute the displacement for each pedestrian
         std::unordered_map<int, double> displacementsInFrame(prevFeaturePoint.size());
         for(size_t i = 0; i < prevFeaturePoint.size(); ++i)
         {
-            auto displacement = prevFeaturePoint[i] - nextFeaturePoint[i];
-            if(!idsInFrame[frame].empty() && localStatus[i] == 1)
+            const PointFlow *flow = cache.find(frame, prevFeaturePoint[i]);
+            if(!idsInFrame[frame].empty() && flow && flow->found)
             {
+                auto displacement = prevFeaturePoint[i] - flow->next;
+
                 auto id = idsInFrame[frame - 1][i];
 
-                auto cmPerPixelXY = petrack->getWorldImageCorrespondence().getCmPerPixel(
-                    nextFeaturePoint[i].x, nextFeaturePoint[i].y, petrack->getControlWidget()->getDefaultHeight());
+                auto cmPerPixelXY = petrack->getCmPerPixel(flow->next);
 
                 auto mPerPixel = (cmPerPixelXY.x() + cmPerPixelXY.y()) / 2. / 100.;
 
@@ -965,7 +1179,6 @@ std::vector<std::unordered_map<int, double>> utils::computeDisplacement(
             }
         }
 
-        cv::swap(prevFrame, currentFrame);
         displacementsPerFrame[frame] = displacementsInFrame;
     }
 
@@ -19,13 +19,16 @@
 #ifndef TRACKERREAL_H
 #define TRACKERREAL_H
 
+#include "bufferedTextWriter.h"
 #include "colorPlot.h"
+#include "displacementFlow.h"
 #include "imageItem.h"
 #include "tracker.h"
 #include "vector.h"
 
 #include <QList>
 #include <utility>
+#include <vector>
 
 class PersonStorage;
 class WorldImageCorrespondence;
@@ -43,6 +46,7 @@ class MissingFrames : public QObject
 private:
     bool                      mExecuted{false}; ///< already computed missing frames
     std::vector<MissingFrame> mMissingFrames{}; ///< vector of missing frames
+    DisplacementCache         mDisplacementCache; ///< flows of the track points, kept by reset()
 
 public:
     MissingFrames(bool executed, std::vector<MissingFrame> &&missingFrames) :
@@ -52,6 +56,7 @@ public:
 
     bool                       isExecuted() const { return mExecuted; }
     std::vector<MissingFrame> &getMissingFrames() { return mMissingFrames; }
+    DisplacementCache         &getDisplacementCache() { return mDisplacementCache; }
 
 public slots: // NOLINT (Qt needs the public slots, so the keyword public repeats)
     void reset()
@@ -147,6 +152,28 @@ inline QTextStream &operator<<(QTextStream &s, const TrackPersonReal &tp)
 
 //----------------------------------------------------------------------------
 
+/**
+ * @brief Real world trajectories as one column per quantity, one row per track point
+ *
+ * Positions are in cm; markerID is the one of the person, repeated for each of its points.
+ */
+struct TrajectoryColumns
+{
+    std::vector<int>   id;
+    std::vector<int>   frame;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<int>   markerID;
+    std::vector<float> viewDirX;
+    std::vector<float> viewDirY;
+
+    std::size_t size() const { return id.size(); }
+    void        reserve(std::size_t rows);
+};
+
+//----------------------------------------------------------------------------
+
 // using tracker:
 // 1. initial recognition
 // 2. next frame track existing track points
@@ -162,6 +189,7 @@ private:
     double         mXMin, mXMax, mYMin, mYMax;
     Petrack       *mMainWindow;
     PersonStorage &mPersonStorage;
+    bool           mUseWorldPositionMap = false; ///< look up the world positions in a precomputed WorldPositionMap
 
 public:
     inline double xMin() const { return mXMin; }
@@ -169,6 +197,9 @@ public:
     inline double yMin() const { return mYMin; }
     inline double yMax() const { return mYMax; }
 
+    inline void setUseWorldPositionMap(bool use) { mUseWorldPositionMap = use; }
+    inline bool isUsingWorldPositionMap() const { return mUseWorldPositionMap; }
+
     TrackerReal(QWidget *wParent, PersonStorage &storage);
 
 
@@ -201,23 +232,49 @@ public:
         bool                            exportAutoCorrect      = false);
 
     void calcMinMax();
-    int  largestFirstFrame();
-    int  largestLastFrame();
-    int  smallestFirstFrame();
-    int  smallestLastFrame();
+    int  largestFirstFrame() const;
+    int  largestLastFrame() const;
+    int  smallestFirstFrame() const;
+    int  smallestLastFrame() const;
 
     // alternateHeight true, wenn keine eindeutige personengroesse ausgegeben wird, sondern fuer jeden pounkt andere
+    // the text exports do not touch any widget and may run on a worker thread
     void exportTxt(
-        QTextStream &out,
-        bool         alternateHeight,
-        bool         useTrackpoints,
-        bool         exportViewingDirection,
-        bool         exportAngleOfView,
-        bool         exportUseM,
-        bool         exportMarkerID);
-    void                      exportDat(QTextStream &out, bool alternateHeight, bool useTrackpoints); // fuer gnuplot
-    void                      exportXml(QTextStream &outXml, bool alternateHeight, bool useTrackpoints);
-    std::vector<MissingFrame> computeDroppedFrames(Petrack *petrack);
+        BufferedTextWriter                &out,
+        bool                               alternateHeight,
+        bool                               useTrackpoints,
+        bool                               exportViewingDirection,
+        bool                               exportAngleOfView,
+        bool                               exportUseM,
+        bool                               exportMarkerID,
+        const ThrottledProgress::Callback &progressCallback = {}) const;
+    // fuer gnuplot
+    void exportDat(
+        BufferedTextWriter                &out,
+        bool                               alternateHeight,
+        bool                               useTrackpoints,
+        const ThrottledProgress::Callback &progressCallback = {}) const;
+    void exportXml(
+        BufferedTextWriter                &outXml,
+        bool                               alternateHeight,
+        bool                               useTrackpoints,
+        const ThrottledProgress::Callback &progressCallback = {}) const;
+    TrajectoryColumns         exportColumns(bool alternateHeight, bool useTrackpoints) const;
+    std::vector<int>          exportGroups() const;
+    std::vector<MissingFrame> computeDroppedFrames(Petrack *petrack, DisplacementCache &cache);
+
+    void invalidate();
+
+private:
+    std::vector<int> matchConverted(const std::vector<TrackPerson> &persons, const std::vector<double> &heights) const;
+
+    // Result of the last calculate(), so persons unchanged since then are not converted again.
+    // TrackPerson and TrackPersonReal share their points with the copies, so keeping them is cheap.
+    std::vector<double>          mConvertedSettings; ///< options and calibration samples of the conversion
+    std::vector<TrackPerson>     mConvertedPersons;  ///< persons as they were converted
+    std::vector<double>          mConvertedHeights;  ///< height used for each of mConvertedPersons
+    std::vector<TrackPersonReal> mConverted;         ///< conversion of each of mConvertedPersons, may be empty
+    std::vector<int>             mSourcePersons;     ///< index in mPersonStorage of each trajectory
 };
 
 namespace utils
@@ -230,7 +287,8 @@ std::vector<std::unordered_map<int, double>> computeDisplacement(
     int                                          maxFrameNum,
     Petrack                                     *petrack,
     const std::vector<std::vector<cv::Point2f>> &personsInFrame,
-    const std::vector<std::vector<int>>         &idsInFrame);
+    const std::vector<std::vector<int>>         &idsInFrame,
+    DisplacementCache                           &cache);
 } // namespace utils
 
 #endif
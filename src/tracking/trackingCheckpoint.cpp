@@ -0,0 +1,276 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackingCheckpoint.h"
+
+#include "logger.h"
+#include "personStorage.h"
+#include "petrack.h"
+#include "trcJournal.h"
+#include "trcReader.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <string_view>
+
+/**
+ * @brief Creates the checkpoints of a run writing its trajectories to trcFile
+ *
+ * Deleted and changed persons of personStorage are followed from now on.
+ */
+TrackingCheckpoint::TrackingCheckpoint(const QString &trcFile, PersonStorage &personStorage) : mTrcFile(trcFile)
+{
+    mDeletedConnection = QObject::connect(
+        &personStorage, &PersonStorage::deletedPerson, [this](size_t index) { personDeleted(index); });
+    mChangedConnection = QObject::connect(
+        &personStorage, &PersonStorage::changedPerson, [this](size_t index) { personChanged(index); });
+}
+
+TrackingCheckpoint::~TrackingCheckpoint()
+{
+    QObject::disconnect(mDeletedConnection);
+    QObject::disconnect(mChangedConnection);
+}
+
+/**
+ * @brief Writes a checkpoint of the run at state with the trajectories persons
+ *
+ * Usually only the persons changed since the last checkpoint are appended to the journal.
+ * From time to time, and the first time, all persons are written into a new trc file.
+ *
+ * @return false, if the checkpoint could not be written; the previous one is still valid then
+ */
+bool TrackingCheckpoint::write(const State &state, const std::vector<TrackPerson> &persons)
+{
+    // as in Petrack::exportTracker
+    Petrack::trcVersion = 4;
+
+    const QFileInfo trc{trcName(mGeneration)};
+    const bool      full = !mSaved || mJournalEntries >= MAX_JOURNAL_ENTRIES || mJournalSize > trc.size();
+    if(!(full ? writeFull(persons) : appendJournal(persons)) || !writeState(state))
+    {
+        // the next checkpoint starts a new generation
+        mSaved = false;
+        return false;
+    }
+    if(full)
+    {
+        QFile::remove(trcName(mGeneration - 1));
+        QFile::remove(journalName(mGeneration - 1));
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the last complete checkpoint
+ *
+ * The next call of write() starts a new generation of files.
+ *
+ * @param persons trajectories at the checkpoint
+ * @return std::nullopt, if there is no (valid) checkpoint
+ */
+std::optional<TrackingCheckpoint::State> TrackingCheckpoint::read(std::vector<TrackPerson> &persons)
+{
+    QFile stateFile{stateFileName(mTrcFile)};
+    if(!stateFile.open(QIODevice::ReadOnly))
+    {
+        return std::nullopt;
+    }
+    const QJsonObject json = QJsonDocument::fromJson(stateFile.readAll()).object();
+    if(json["version"].toInt() != VERSION)
+    {
+        SPDLOG_ERROR("The checkpoint {} is invalid.", stateFile.fileName());
+        return std::nullopt;
+    }
+    State state;
+    state.phase      = json["phase"].toString() == "backward" ? Phase::Backward : Phase::Forward;
+    state.frame      = json["frame"].toInt(-1);
+    state.startFrame = json["startFrame"].toInt(-1);
+    state.recognize  = json["recognize"].toBool();
+    state.processed  = json["processed"].toInt();
+    state.total      = json["total"].toInt();
+    const int    generation  = json["generation"].toInt();
+    const qint64 journalSize = json["journalSize"].toVariant().toLongLong();
+    if(state.frame < 0 || state.startFrame < 0)
+    {
+        SPDLOG_ERROR("The checkpoint {} is invalid.", stateFile.fileName());
+        return std::nullopt;
+    }
+
+    auto trc = IO::readTrc(trcName(generation));
+    if(const auto *error = std::get_if<std::string>(&trc))
+    {
+        SPDLOG_ERROR("Could not read the trajectories of the checkpoint: {}", *error);
+        return std::nullopt;
+    }
+    persons = std::move(std::get<IO::TrcData>(trc).persons);
+
+    if(journalSize > 0)
+    {
+        QFile journal{journalName(generation)};
+        if(!journal.open(QIODevice::ReadOnly) || journal.size() < journalSize)
+        {
+            SPDLOG_ERROR("The journal {} of the checkpoint is incomplete.", journal.fileName());
+            return std::nullopt;
+        }
+        // entries appended after the checkpoint belong to a later, incomplete one
+        const QByteArray content = journal.read(journalSize);
+        const auto       applied =
+            IO::applyTrcJournal(std::string_view(content.constData(), static_cast<size_t>(content.size())), persons);
+        if(const auto *error = std::get_if<std::string>(&applied))
+        {
+            SPDLOG_ERROR("Could not read the journal {} of the checkpoint: {}", journal.fileName(), *error);
+            return std::nullopt;
+        }
+    }
+
+    mGeneration = generation;
+    mSaved      = false;
+    return state;
+}
+
+/// Removes the files of the checkpoint, e.g. after the run finished
+void TrackingCheckpoint::remove()
+{
+    QFile::remove(stateFileName(mTrcFile));
+    QFile::remove(trcName(mGeneration));
+    QFile::remove(journalName(mGeneration));
+    mSaved = false;
+}
+
+QString TrackingCheckpoint::stateFileName(const QString &trcFile)
+{
+    return trcFile + ".checkpoint";
+}
+
+QString TrackingCheckpoint::trcName(int generation) const
+{
+    return QString("%1.checkpoint.%2.trc").arg(mTrcFile).arg(generation);
+}
+
+QString TrackingCheckpoint::journalName(int generation) const
+{
+    return QString("%1.checkpoint.%2.journal").arg(mTrcFile).arg(generation);
+}
+
+/// Writes persons into the trc file of a new generation
+bool TrackingCheckpoint::writeFull(const std::vector<TrackPerson> &persons)
+{
+    const int generation = mGeneration + 1;
+    QSaveFile trc{trcName(generation)};
+    if(!trc.open(QIODevice::WriteOnly) || !::writeTrc(trc, persons) || !trc.commit())
+    {
+        SPDLOG_WARN("Could not write the checkpoint {}: {}", trc.fileName(), trc.errorString());
+        return false;
+    }
+    QFile::remove(journalName(generation));
+
+    mGeneration     = generation;
+    mSaved          = true;
+    mSavedPersons   = persons;
+    mJournalEntries = 0;
+    mJournalSize    = 0;
+    mDeletedSinceSave.clear();
+    mChangedSinceSave.clear();
+    return true;
+}
+
+/// Appends the persons changed since the last checkpoint to the journal, as Autosave does
+bool TrackingCheckpoint::appendJournal(const std::vector<TrackPerson> &persons)
+{
+    IO::TrcJournalEntry entry;
+    entry.numPersons = persons.size();
+    entry.deleted    = std::move(mDeletedSinceSave);
+    for(size_t i = 0; i < persons.size(); ++i)
+    {
+        if(i >= mSavedPersons.size() || (i < mChangedSinceSave.size() && mChangedSinceSave[i]) ||
+           !persons[i].hasSameTrcData(mSavedPersons[i]))
+        {
+            entry.changed.emplace_back(i, persons[i]);
+        }
+    }
+    mDeletedSinceSave.clear();
+    mChangedSinceSave.clear();
+    const bool unchanged = entry.deleted.empty() && entry.changed.empty() && persons.size() == mSavedPersons.size();
+    mSavedPersons        = persons;
+    if(unchanged)
+    {
+        return true;
+    }
+
+    QFile journal{journalName(mGeneration)};
+    if(!journal.open(QIODevice::WriteOnly | QIODevice::Append) || !IO::appendTrcJournal(journal, entry) ||
+       !journal.flush())
+    {
+        SPDLOG_WARN("Could not write the checkpoint {}: {}", journal.fileName(), journal.errorString());
+        return false;
+    }
+    mJournalSize = journal.size();
+    ++mJournalEntries;
+    return true;
+}
+
+/// Replaces the JSON file with state, which refers to the current generation and journal
+bool TrackingCheckpoint::writeState(const State &state) const
+{
+    QJsonObject json;
+    json["version"]     = VERSION;
+    json["phase"]       = state.phase == Phase::Backward ? "backward" : "forward";
+    json["frame"]       = state.frame;
+    json["startFrame"]  = state.startFrame;
+    json["recognize"]   = state.recognize;
+    json["processed"]   = state.processed;
+    json["total"]       = state.total;
+    json["generation"]  = mGeneration;
+    json["journalSize"] = mJournalSize;
+
+    QSaveFile file{stateFileName(mTrcFile)};
+    if(!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(json).toJson()) < 0 || !file.commit())
+    {
+        SPDLOG_WARN("Could not write the checkpoint {}: {}", file.fileName(), file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/// Keeps the saved trajectories in sync with the deletion of a person, as Autosave::personDeleted()
+void TrackingCheckpoint::personDeleted(size_t index)
+{
+    if(index < mChangedSinceSave.size())
+    {
+        mChangedSinceSave.erase(mChangedSinceSave.begin() + index);
+    }
+    if(index < mSavedPersons.size())
+    {
+        mSavedPersons.erase(mSavedPersons.begin() + index);
+        mDeletedSinceSave.push_back(index);
+    }
+}
+
+/// Marks a person to be written with the next checkpoint
+void TrackingCheckpoint::personChanged(size_t index)
+{
+    if(index >= mChangedSinceSave.size())
+    {
+        mChangedSinceSave.resize(index + 1, false);
+    }
+    mChangedSinceSave[index] = true;
+}
@@ -0,0 +1,108 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACKINGCHECKPOINT_H
+#define TRACKINGCHECKPOINT_H
+
+#include "tracker.h"
+
+#include <QMetaObject>
+#include <QString>
+#include <optional>
+#include <vector>
+
+class PersonStorage;
+
+/**
+ * @brief Periodic checkpoints of a tracking run, from which an aborted run is resumed
+ *
+ * A checkpoint consists of the position of the run (State) and the trajectories at
+ * that moment. The trajectories are written incrementally like the autosave: a full
+ * trc file, to which only the persons changed since the previous checkpoint are
+ * appended as journal (see IO::TrcJournalEntry). All files are written next to the
+ * trajectories of the run:
+ *
+ *     <trcFile>.checkpoint                  position of the run as JSON
+ *     <trcFile>.checkpoint.<n>.trc          trajectories of generation n
+ *     <trcFile>.checkpoint.<n>.journal      changes since then
+ *
+ * The JSON file is replaced atomically after the trajectories are written and stores
+ * the length of the journal at the checkpoint. So a crash at any time leaves the last
+ * complete checkpoint; a new generation is only removed, once the JSON file refers to
+ * the next one.
+ *
+ * The tracker state itself does not need to be stored: it consists of the grey image
+ * of the last tracked frame and the trajectories in that frame, which are restored by
+ * tracking the frame of the checkpoint once more without any previous frame.
+ */
+class TrackingCheckpoint
+{
+public:
+    enum class Phase
+    {
+        Forward,
+        Backward
+    };
+
+    /// position of a TrackingEngine run
+    struct State
+    {
+        Phase phase      = Phase::Forward;
+        int   frame      = -1;    ///< last tracked frame
+        int   startFrame = -1;    ///< frame the run started at
+        bool  recognize  = false; ///< backward pass: recognition is on again
+        int   processed  = 0;
+        int   total      = 0;
+    };
+
+    static constexpr int VERSION             = 1;
+    static constexpr int MAX_JOURNAL_ENTRIES = 100; ///< a full trc is written after this many journal entries
+
+    TrackingCheckpoint(const QString &trcFile, PersonStorage &personStorage);
+    ~TrackingCheckpoint();
+    TrackingCheckpoint(const TrackingCheckpoint &)            = delete;
+    TrackingCheckpoint &operator=(const TrackingCheckpoint &) = delete;
+
+    bool                 write(const State &state, const std::vector<TrackPerson> &persons);
+    std::optional<State> read(std::vector<TrackPerson> &persons);
+    void                 remove();
+
+    static QString stateFileName(const QString &trcFile);
+
+private:
+    QString trcName(int generation) const;
+    QString journalName(int generation) const;
+    bool    writeFull(const std::vector<TrackPerson> &persons);
+    bool    appendJournal(const std::vector<TrackPerson> &persons);
+    bool    writeState(const State &state) const;
+    void    personDeleted(size_t index);
+    void    personChanged(size_t index);
+
+    QString                  mTrcFile;
+    QMetaObject::Connection  mDeletedConnection;
+    QMetaObject::Connection  mChangedConnection;
+    int                      mGeneration     = 0;     ///< generation of the trc file of the last checkpoint
+    bool                     mSaved          = false; ///< mSavedPersons are stored in the files of mGeneration
+    int                      mJournalEntries = 0;
+    qint64                   mJournalSize    = 0;
+    std::vector<TrackPerson> mSavedPersons;     ///< trajectories as stored in the trc file and journal
+    std::vector<size_t>      mDeletedSinceSave; ///< indices of deleted persons, in order of deletion
+    std::vector<bool>        mChangedSinceSave; ///< per person, if changedPerson was emitted for it
+};
+
+#endif // TRACKINGCHECKPOINT_H
@@ -0,0 +1,237 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackingEngine.h"
+
+#include "animation.h"
+#include "logger.h"
+#include "personStorage.h"
+#include "petrack.h"
+#include "tracker.h"
+
+#include <algorithm>
+#include <chrono>
+
+/**
+ * @brief Restricts the run to the frames [firstFrame, lastFrame]
+ *
+ * The first frame is recognized and then tracked forward up to lastFrame; the
+ * backward pass ends at firstFrame instead of the start of the sequence.
+ */
+void TrackingEngine::setFrameRange(int firstFrame, int lastFrame)
+{
+    mFirstFrame = firstFrame;
+    mLastFrame  = lastFrame;
+}
+
+/**
+ * @brief Writes a checkpoint to the files of trcFile every interval processed frames
+ *
+ * An interval of 0 disables the checkpoints.
+ */
+void TrackingEngine::setCheckpoint(const QString &trcFile, int interval)
+{
+    mCheckpointInterval = interval;
+    mCheckpoint.reset();
+    if(interval > 0 && !trcFile.isEmpty())
+    {
+        mCheckpoint = std::make_unique<TrackingCheckpoint>(trcFile, mPetrack.getPersonStorage());
+    }
+}
+
+/**
+ * @brief Tracks from the current frame to the end and optionally backwards to the start
+ *
+ * The frame the animation is at is not processed again; the backward pass starts
+ * recognizing again at the frame the run started at, as Petrack::trackAll() does.
+ * If a frame range is set, it is tracked instead. When resuming, the run continues
+ * after the frame of the last checkpoint in the pass it was in.
+ *
+ * @return false, if the run was aborted by the progress callback
+ */
+bool TrackingEngine::run()
+{
+    using Phase = TrackingCheckpoint::Phase;
+
+    Animation     &animation = *mPetrack.getAnimation();
+    PersonStorage &storage   = mPetrack.getPersonStorage();
+    const int      lastFrame = mLastFrame < 0 ? animation.getSourceOutFrameNum() : mLastFrame;
+    const int      endFrame  = mFirstFrame < 0 ? animation.getSourceInFrameNum() : mFirstFrame;
+
+    PipelineStatistics &statistics = mPetrack.getPipelineStatistics();
+    statistics                     = PipelineStatistics();
+    const auto start               = std::chrono::steady_clock::now();
+
+    mPetrack.setBatchProcessing(true);
+    mPetrack.resetFilterStatistics();
+
+    TrackingCheckpoint::State state;
+    if(!(mResume && restoreCheckpoint(state)))
+    {
+        if(mFirstFrame >= 0)
+        {
+            mPetrack.processFrame(animation.getFrameAtIndex(mFirstFrame), false, true);
+        }
+        state.startFrame = animation.getCurrentFrameNum();
+
+        mProcessed = 0;
+        mTotal     = lastFrame - state.startFrame;
+        if(mPetrack.isAutoBackTrack())
+        {
+            mTotal += lastFrame - endFrame + 1;
+        }
+    }
+    const int startFrame = state.startFrame;
+
+    bool finished = true;
+    if(state.phase == Phase::Forward)
+    {
+        while(animation.getCurrentFrameNum() < lastFrame)
+        {
+            cv::Mat img = animation.getNextFrame();
+            if(img.empty())
+            {
+                break;
+            }
+            mPetrack.processFrame(img, true, true);
+            finished = reportProgress();
+            saveCheckpoint({Phase::Forward, animation.getCurrentFrameNum(), startFrame}, !finished);
+            if(!finished)
+            {
+                break;
+            }
+        }
+
+        if(finished && mPetrack.isAutoBackTrack())
+        {
+            // etwas spaeter, da erste punkte in reco path meist nur ellipse ohne markererkennung
+            const int backTrackFrame = std::min(storage.largestFirstFrame() + 5, lastFrame);
+            if(backTrackFrame != animation.getCurrentFrameNum())
+            {
+                mPetrack.processFrame(animation.getFrameAtIndex(backTrackFrame), false, true);
+            }
+        }
+    }
+
+    if(finished && mPetrack.isAutoBackTrack())
+    {
+        // recognition only for the frames, which were not part of the forward pass
+        bool recognize = state.phase == Phase::Backward && state.recognize;
+        while(animation.getCurrentFrameNum() > endFrame)
+        {
+            if(animation.getCurrentFrameNum() == startFrame + 1)
+            {
+                recognize = true;
+            }
+            cv::Mat img = animation.getPreviousFrame();
+            if(img.empty())
+            {
+                break;
+            }
+            mPetrack.processFrame(img, true, recognize);
+            finished = reportProgress();
+            saveCheckpoint({Phase::Backward, animation.getCurrentFrameNum(), startFrame, recognize}, !finished);
+            if(!finished)
+            {
+                break;
+            }
+        }
+    }
+
+    if(mPetrack.isAutoTrackOptimizeColor())
+    {
+        storage.optimizeColor();
+    }
+
+    mPetrack.setBatchProcessing(false);
+    mPetrack.logFilterStatistics();
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    statistics.memory  = mPetrack.getMemoryUsage();
+    statistics.log();
+
+    if(!finished)
+    {
+        SPDLOG_WARN("Tracking aborted after {} of {} frames.", mProcessed, mTotal);
+    }
+    else if(mCheckpoint)
+    {
+        mCheckpoint->remove();
+    }
+    return finished;
+}
+
+/**
+ * @brief Restores the trajectories and the tracker at the last checkpoint
+ *
+ * The tracker gets the grey image of the frame of the checkpoint as previous image by
+ * tracking this frame without a previous frame, which changes no trajectory.
+ *
+ * @param state position of the run at the checkpoint
+ * @return false, if there is no checkpoint to resume from
+ */
+bool TrackingEngine::restoreCheckpoint(TrackingCheckpoint::State &state)
+{
+    std::vector<TrackPerson> persons;
+    const auto               checkpoint = mCheckpoint ? mCheckpoint->read(persons) : std::nullopt;
+    if(!checkpoint)
+    {
+        SPDLOG_WARN("No checkpoint to resume from, tracking from the start.");
+        return false;
+    }
+    state = *checkpoint;
+
+    PersonStorage &storage = mPetrack.getPersonStorage();
+    storage.clear();
+    for(const auto &person : persons)
+    {
+        storage.addPerson(person);
+    }
+    mPetrack.getTracker()->reset();
+    mPetrack.processFrame(mPetrack.getAnimation()->getFrameAtIndex(state.frame), true, false);
+
+    mProcessed = state.processed;
+    mTotal     = state.total;
+    SPDLOG_INFO(
+        "Resuming the tracking after frame {} in the {} pass ({} person(s), {} of {} frames done).",
+        state.frame,
+        state.phase == TrackingCheckpoint::Phase::Forward ? "forward" : "backward",
+        persons.size(),
+        mProcessed,
+        mTotal);
+    return true;
+}
+
+/**
+ * @brief Writes a checkpoint at state every mCheckpointInterval frames or if forced
+ */
+void TrackingEngine::saveCheckpoint(TrackingCheckpoint::State state, bool force)
+{
+    if(!mCheckpoint || (!force && mProcessed % mCheckpointInterval != 0))
+    {
+        return;
+    }
+    state.processed = mProcessed;
+    state.total     = mTotal;
+    mCheckpoint->write(state, mPetrack.getPersonStorage().getPersons());
+}
+
+bool TrackingEngine::reportProgress()
+{
+    ++mProcessed;
+    return !mProgressCallback || mProgressCallback(mProcessed, mTotal);
+}
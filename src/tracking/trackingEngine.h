@@ -0,0 +1,77 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACKINGENGINE_H
+#define TRACKINGENGINE_H
+
+#include "trackingCheckpoint.h"
+
+#include <QString>
+#include <functional>
+#include <memory>
+
+class Petrack;
+
+/**
+ * @brief Tracks a whole sequence of the loaded project without the GUI
+ *
+ * Runs the same passes as Petrack::trackAll() (forward with tracking and
+ * recognition, then optionally backward from the largest first frame), but takes
+ * the frames directly from the Animation and processes them with
+ * Petrack::processFrame(). So neither the Player nor the view are updated and no
+ * events are processed per frame. The progress is reported via a callback, which
+ * can also abort the run.
+ *
+ * With setFrameRange() only a segment of the sequence is tracked, e.g. to track
+ * a long video in several processes at once (see SegmentTracking).
+ *
+ * With setCheckpoint() the run writes a TrackingCheckpoint every few frames and when
+ * it is aborted; with setResume() a later run continues at the last checkpoint.
+ */
+class TrackingEngine
+{
+public:
+    /// called after every processed frame; return false to abort
+    using ProgressCallback = std::function<bool(int processed, int total)>;
+
+    explicit TrackingEngine(Petrack &petrack) : mPetrack(petrack) {}
+
+    void setProgressCallback(ProgressCallback callback) { mProgressCallback = std::move(callback); }
+    void setFrameRange(int firstFrame, int lastFrame);
+    void setCheckpoint(const QString &trcFile, int interval);
+    void setResume(bool resume) { mResume = resume; }
+
+    bool run();
+
+private:
+    bool reportProgress();
+    bool restoreCheckpoint(TrackingCheckpoint::State &state);
+    void saveCheckpoint(TrackingCheckpoint::State state, bool force);
+
+    Petrack                            &mPetrack;
+    ProgressCallback                    mProgressCallback;
+    int                                 mProcessed  = 0;
+    int                                 mTotal      = 0;
+    int                                 mFirstFrame = -1; ///< first frame of the segment; -1 for the current frame
+    int                                 mLastFrame  = -1; ///< last frame of the segment; -1 for the end of the sequence
+    std::unique_ptr<TrackingCheckpoint> mCheckpoint;
+    int                                 mCheckpointInterval = 0; ///< frames between two checkpoints
+    bool                                mResume             = false;
+};
+
+#endif // TRACKINGENGINE_H
@@ -0,0 +1,126 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectoryGeometry.h"
+
+#include <cmath>
+#include <opencv2/core.hpp>
+
+namespace geometry
+{
+namespace
+{
+/// row header on the coordinates without copying them
+cv::Mat wrap(const float *values, int count)
+{
+    return cv::Mat(1, count, CV_32F, const_cast<float *>(values)); // NOLINT: the header is only read
+}
+} // namespace
+
+/**
+ * @brief Distances of all points to point
+ *
+ * @param x x-coordinates of the points
+ * @param y y-coordinates of the points
+ * @param count number of points
+ * @param point point to measure the distances to
+ * @return count distances
+ */
+std::vector<float> distances(const float *x, const float *y, int count, const Vec2F &point)
+{
+    if(count <= 0)
+    {
+        return {};
+    }
+    std::vector<float> result(count);
+    cv::Mat            distance(1, count, CV_32F, result.data());
+    cv::magnitude(wrap(x, count) - point.x(), wrap(y, count) - point.y(), distance);
+    return result;
+}
+
+/**
+ * @brief Distances between the points i of two sets, e.g. two trajectories in the same frames
+ *
+ * @return count distances
+ */
+std::vector<float> distances(const float *x1, const float *y1, const float *x2, const float *y2, int count)
+{
+    if(count <= 0)
+    {
+        return {};
+    }
+    std::vector<float> result(count);
+    cv::Mat            distance(1, count, CV_32F, result.data());
+    cv::magnitude(wrap(x1, count) - wrap(x2, count), wrap(y1, count) - wrap(y2, count), distance);
+    return result;
+}
+
+/**
+ * @brief Finds the point nearest to point
+ *
+ * The squared distances are compared, so no square root is taken per point.
+ *
+ * @param distance if not nullptr, set to the distance of the nearest point
+ * @return index of the first of the nearest points; -1, if there is no point
+ */
+int nearest(const float *x, const float *y, int count, const Vec2F &point, double *distance)
+{
+    if(count <= 0)
+    {
+        return -1;
+    }
+    const cv::Mat dx = wrap(x, count) - point.x();
+    const cv::Mat dy = wrap(y, count) - point.y();
+
+    double    minSquared = 0;
+    cv::Point minLoc;
+    cv::minMaxLoc(dx.mul(dx) + dy.mul(dy), &minSquared, nullptr, &minLoc);
+    if(distance != nullptr)
+    {
+        *distance = std::sqrt(minSquared);
+    }
+    return minLoc.x;
+}
+
+/**
+ * @brief Linear interpolation of count points with equal steps from from to to
+ *
+ * Fills the gap of count - 1 skipped frames between from and to, e.g. when a trajectory
+ * is extended by a point several frames ahead. from itself is not part of the result,
+ * the last point is exactly to.
+ *
+ * @param x count x-coordinates to fill
+ * @param y count y-coordinates to fill
+ */
+void interpolate(const Vec2F &from, const Vec2F &to, int count, float *x, float *y)
+{
+    if(count <= 0)
+    {
+        return;
+    }
+    const double stepX = (to.x() - from.x()) / count;
+    const double stepY = (to.y() - from.y()) / count;
+    for(int i = 0; i < count - 1; ++i)
+    {
+        x[i] = static_cast<float>(from.x() + (i + 1) * stepX);
+        y[i] = static_cast<float>(from.y() + (i + 1) * stepY);
+    }
+    x[count - 1] = static_cast<float>(to.x());
+    y[count - 1] = static_cast<float>(to.y());
+}
+} // namespace geometry
@@ -0,0 +1,43 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORYGEOMETRY_H
+#define TRAJECTORYGEOMETRY_H
+
+#include "vector.h"
+
+#include <vector>
+
+/**
+ * @brief Distances and interpolation of points stored as contiguous coordinate arrays
+ *
+ * Like the kernels in trajectoryVelocity.h, these work on whole columns (see
+ * TrackPointColumns::xData) or parts of them with the vectorized array operations of
+ * OpenCV, instead of comparing one Vec2F at a time.
+ */
+namespace geometry
+{
+std::vector<float> distances(const float *x, const float *y, int count, const Vec2F &point);
+std::vector<float> distances(const float *x1, const float *y1, const float *x2, const float *y2, int count);
+
+int nearest(const float *x, const float *y, int count, const Vec2F &point, double *distance = nullptr);
+
+void interpolate(const Vec2F &from, const Vec2F &to, int count, float *x, float *y);
+} // namespace geometry
+
+#endif // TRAJECTORYGEOMETRY_H
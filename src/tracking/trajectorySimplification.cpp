@@ -0,0 +1,143 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectorySimplification.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace simplification
+{
+namespace
+{
+/// squared distance of point i to the segment from point first to point last
+double squaredSegmentDistance(const float *x, const float *y, int i, int first, int last)
+{
+    const double dx       = x[last] - x[first];
+    const double dy       = y[last] - y[first];
+    const double sqLength = dx * dx + dy * dy;
+    double       t        = 0;
+    if(sqLength > 0)
+    {
+        t = std::clamp(((x[i] - x[first]) * dx + (y[i] - y[first]) * dy) / sqLength, 0., 1.);
+    }
+    const double distX = x[i] - (x[first] + t * dx);
+    const double distY = y[i] - (y[first] + t * dy);
+    return distX * distX + distY * distY;
+}
+
+/// appends the kept indices of the points [first, last]; first is skipped, if it is already the last index in kept
+void appendSimplified(const float *x, const float *y, int first, int last, double tolerance, std::vector<int> &kept)
+{
+    std::vector<bool> keep(last - first + 1, false);
+    keep.front() = true;
+    keep.back()  = true;
+
+    // iterative instead of recursive, since trajectories may have hundred thousands of points
+    const double                     sqTolerance = tolerance * tolerance;
+    std::vector<std::pair<int, int>> ranges{{first, last}};
+    while(!ranges.empty())
+    {
+        const auto [begin, end] = ranges.back();
+        ranges.pop_back();
+
+        double maxSqDistance = sqTolerance;
+        int    farthest      = -1;
+        for(int i = begin + 1; i < end; ++i)
+        {
+            const double sqDistance = squaredSegmentDistance(x, y, i, begin, end);
+            if(sqDistance > maxSqDistance)
+            {
+                maxSqDistance = sqDistance;
+                farthest      = i;
+            }
+        }
+        if(farthest != -1)
+        {
+            keep[farthest - first] = true;
+            ranges.emplace_back(begin, farthest);
+            ranges.emplace_back(farthest, end);
+        }
+    }
+
+    for(int i = first; i <= last; ++i)
+    {
+        if(keep[i - first] && (kept.empty() || kept.back() != i))
+        {
+            kept.push_back(i);
+        }
+    }
+}
+} // namespace
+
+/**
+ * @brief Simplifies the polyline through all points of a trajectory
+ *
+ * @param x x-coordinates of the points
+ * @param y y-coordinates of the points
+ * @param count number of points
+ * @param tolerance maximal distance of an omitted point to the simplified polyline
+ * @return indices of the kept points, always including the first and the last one
+ */
+std::vector<int> douglasPeucker(const float *x, const float *y, int count, double tolerance)
+{
+    std::vector<int> kept;
+    if(count > 0)
+    {
+        appendSimplified(x, y, 0, count - 1, tolerance, kept);
+    }
+    return kept;
+}
+
+/**
+ * @brief Simplified polyline through the points [from, to) of a trajectory
+ *
+ * Reuses the simplification of the whole trajectory, so only the pieces from the window
+ * borders to the next kept points have to be simplified again, e.g. while the shown part
+ * of a path moves with the current frame.
+ *
+ * @param kept result of douglasPeucker with the same tolerance
+ * @return indices of the kept points of the window, including from and to - 1; empty, if the window is empty
+ */
+std::vector<int> simplifyWindow(
+    const float            *x,
+    const float            *y,
+    const std::vector<int> &kept,
+    int                     from,
+    int                     to,
+    double                  tolerance)
+{
+    std::vector<int> result;
+    if(from >= to)
+    {
+        return result;
+    }
+    const auto first = std::lower_bound(kept.begin(), kept.end(), from);
+    const auto last  = std::upper_bound(first, kept.end(), to - 1);
+    if(first == last)
+    {
+        // the window lies between two kept points
+        appendSimplified(x, y, from, to - 1, tolerance, result);
+        return result;
+    }
+    appendSimplified(x, y, from, *first, tolerance, result);
+    result.insert(result.end(), first + 1, last);
+    appendSimplified(x, y, *(last - 1), to - 1, tolerance, result);
+    return result;
+}
+} // namespace simplification
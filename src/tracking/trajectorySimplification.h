@@ -0,0 +1,43 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORYSIMPLIFICATION_H
+#define TRAJECTORYSIMPLIFICATION_H
+
+#include <vector>
+
+/**
+ * @brief Douglas-Peucker simplification of trajectories stored as contiguous coordinate arrays
+ *
+ * The simplified polyline consists of the points with the returned (ascending) indices.
+ * Every omitted point lies within the tolerance of the segment replacing it, e.g. half a
+ * screen pixel, so the simplified path looks the same as the complete one.
+ */
+namespace simplification
+{
+std::vector<int> douglasPeucker(const float *x, const float *y, int count, double tolerance);
+std::vector<int> simplifyWindow(
+    const float            *x,
+    const float            *y,
+    const std::vector<int> &kept,
+    int                     from,
+    int                     to,
+    double                  tolerance);
+} // namespace simplification
+
+#endif // TRAJECTORYSIMPLIFICATION_H
@@ -0,0 +1,147 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectorySpillStore.h"
+
+#include "logger.h"
+#include "trackPointColumns.h"
+
+#include <QDir>
+#include <QTemporaryFile>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+
+namespace
+{
+/// alignment of the columns in the file; suffices for all value types of the columns
+constexpr int COLUMN_ALIGNMENT = 16;
+
+/// lets a column read its values from the mapping of a block at base
+using MapColumn = std::function<void(const uchar *base, const std::shared_ptr<const void> &mapping)>;
+
+void pad(QByteArray &block)
+{
+    const int padding = (COLUMN_ALIGNMENT - block.size() % COLUMN_ALIGNMENT) % COLUMN_ALIGNMENT;
+    block.append(padding, '\0');
+}
+} // namespace
+
+/// The file is shared with the mappings, which unmap themselves from any thread
+struct TrajectorySpillStore::File
+{
+    QTemporaryFile file{QDir::temp().filePath("petrack_trajectories_XXXXXX.bin")};
+    std::mutex     mutex;
+};
+
+/**
+ * @brief Moves the points of trajectories into the file
+ *
+ * All columns of the trajectories not mapped yet are written as one block, which is
+ * mapped once. Afterwards the columns read their values from the mapping.
+ *
+ * @return false, if the file could not be written or mapped; the trajectories are unchanged then
+ */
+bool TrajectorySpillStore::spill(const std::vector<TrackPointColumns *> &trajectories)
+{
+    QByteArray             block;
+    std::vector<MapColumn> mapColumns;
+    for(auto *columns : trajectories)
+    {
+        columns->forEachColumn(
+            [&block, &mapColumns](auto &column)
+            {
+                using T = typename std::decay_t<decltype(column)>::value_type;
+                static_assert(std::is_trivially_copyable_v<T>, "columns are written in their binary form");
+                static_assert(alignof(T) <= COLUMN_ALIGNMENT);
+                if(column.empty() || column.isMapped())
+                {
+                    return;
+                }
+                pad(block);
+                const int offset = block.size();
+                block.append(reinterpret_cast<const char *>(column.data()), column.size() * sizeof(T));
+                mapColumns.emplace_back(
+                    [&column, offset](const uchar *base, const std::shared_ptr<const void> &mapping)
+                    { column.setMapped(reinterpret_cast<const T *>(base + offset), mapping); });
+            });
+    }
+    if(mapColumns.empty())
+    {
+        return true;
+    }
+    pad(block); // the next block starts aligned as well
+
+    if(!mFile)
+    {
+        mFile = std::make_shared<File>();
+        if(!mFile->file.open())
+        {
+            SPDLOG_ERROR("Could not create the file for spilling trajectories: {}", mFile->file.errorString());
+            mFile.reset();
+            return false;
+        }
+        SPDLOG_INFO("Spilling finished trajectories to {}.", mFile->file.fileName());
+    }
+
+    uchar *base = nullptr;
+    {
+        std::lock_guard lock(mFile->mutex);
+        if(!mFile->file.seek(mBytes) || mFile->file.write(block) != block.size() || !mFile->file.flush())
+        {
+            SPDLOG_ERROR("Could not spill trajectories to {}: {}", mFile->file.fileName(), mFile->file.errorString());
+            return false;
+        }
+        base = mFile->file.map(mBytes, block.size(), QFileDevice::MapPrivateOption);
+    }
+    if(!base)
+    {
+        SPDLOG_ERROR("Could not map {}: {}", mFile->file.fileName(), mFile->file.errorString());
+        return false;
+    }
+    mBytes += block.size();
+
+    const std::shared_ptr<const void> mapping(
+        base,
+        [file = mFile](const void *data)
+        {
+            std::lock_guard lock(file->mutex);
+            file->file.unmap(static_cast<uchar *>(const_cast<void *>(data)));
+        });
+    for(const auto &mapColumn : mapColumns)
+    {
+        mapColumn(base, mapping);
+    }
+    return true;
+}
+
+/**
+ * @brief Starts a new file for the next spilled trajectories
+ *
+ * The current file stays, until no column maps it anymore.
+ */
+void TrajectorySpillStore::reset()
+{
+    mFile.reset();
+    mBytes = 0;
+}
+
+QString TrajectorySpillStore::getFileName() const
+{
+    return mFile ? mFile->file.fileName() : QString();
+}
@@ -0,0 +1,59 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORYSPILLSTORE_H
+#define TRAJECTORYSPILLSTORE_H
+
+#include <QString>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class TrackPointColumns;
+
+/**
+ * @brief Memory-mapped file, into which the points of finished trajectories are moved
+ *
+ * For very long recordings, the trajectories may not fit into memory. The columns of
+ * trajectories far from the tracked frames are appended to a temporary file in their
+ * binary form and read from a read-only mapping of it afterwards. The operating system
+ * pages them in when they are displayed or exported and can drop them again at any time,
+ * so the memory used by the tracking scales with the persons currently tracked.
+ *
+ * Editing a spilled column copies it back into memory (see TrackPointColumn). Space in
+ * the file is never reused; the file is deleted, when the store and all columns mapping
+ * it are gone.
+ */
+class TrajectorySpillStore
+{
+public:
+    bool spill(const std::vector<TrackPointColumns *> &trajectories);
+    void reset();
+
+    /// bytes written to the file
+    std::size_t bytes() const { return mBytes; }
+    QString     getFileName() const;
+
+private:
+    struct File;
+
+    std::shared_ptr<File> mFile;
+    std::size_t           mBytes = 0;
+};
+
+#endif // TRAJECTORYSPILLSTORE_H
@@ -0,0 +1,129 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectoryVelocity.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+namespace velocity
+{
+namespace
+{
+/// row header on the coordinates without copying them
+cv::Mat wrap(const float *values, int count)
+{
+    return cv::Mat(1, count, CV_32F, const_cast<float *>(values)); // NOLINT: the header is only read
+}
+
+/// values[i + step] - values[i] for all i with a successor
+cv::Mat differences(const float *values, int count, int step)
+{
+    const cv::Mat column = wrap(values, count);
+    return column.colRange(step, count) - column.colRange(0, count - step);
+}
+} // namespace
+
+/**
+ * @brief Distances between the points i and i + step of a trajectory
+ *
+ * @param x x-coordinates of the points of consecutive frames
+ * @param y y-coordinates of the points
+ * @param count number of points
+ * @param step distance of the compared points in frames
+ * @return count - step distances; empty, if the trajectory is not longer than step
+ */
+std::vector<float> stepDistances(const float *x, const float *y, int count, int step)
+{
+    if(count <= step)
+    {
+        return {};
+    }
+    std::vector<float> distances(count - step);
+    cv::Mat            result(1, count - step, CV_32F, distances.data());
+    cv::magnitude(differences(x, count, step), differences(y, count, step), result);
+    return distances;
+}
+
+/// stepDistances in three dimensions, e.g. for world coordinates with the height
+std::vector<float> stepDistances(const float *x, const float *y, const float *z, int count, int step)
+{
+    if(count <= step)
+    {
+        return {};
+    }
+    const cv::Mat dx = differences(x, count, step);
+    const cv::Mat dy = differences(y, count, step);
+    const cv::Mat dz = differences(z, count, step);
+
+    std::vector<float> distances(count - step);
+    cv::Mat            result(1, count - step, CV_32F, distances.data());
+    cv::sqrt(dx.mul(dx) + dy.mul(dy) + dz.mul(dz), result);
+    return distances;
+}
+
+/// values[i + step] - values[i] for all points i with a successor, e.g. the velocity in x only
+std::vector<float> stepDifferences(const float *values, int count, int step)
+{
+    if(count <= step)
+    {
+        return {};
+    }
+    std::vector<float> result(count - step);
+    differences(values, count, step).copyTo(cv::Mat(1, count - step, CV_32F, result.data()));
+    return result;
+}
+
+/**
+ * @brief Finds large variations of the velocity, as checked by plausibility::checkVelocityVariation
+ *
+ * A variation at point j means, that the distance d12 to the next point is
+ * - larger than 1.8 times the mean of the distances d01 before and d23 after it
+ * AND
+ * - larger than 6 px OR the mean of d01 and d23 is larger than 3 px.
+ *
+ * The conditions are evaluated without branches, so the loop is vectorized.
+ *
+ * @param distances distances between consecutive points (stepDistances with step 1)
+ * @return ascending indices j of the points; the first and the two last points are not checked
+ */
+std::vector<int> findVariations(const std::vector<float> &distances)
+{
+    const int                 count = static_cast<int>(distances.size());
+    std::vector<std::uint8_t> varies(std::max(count, 0), 0);
+    for(int j = 1; j < count - 1; ++j)
+    {
+        const float d01  = distances[j - 1];
+        const float d12  = distances[j];
+        const float d23  = distances[j + 1];
+        const float mean = (d01 + d23) / 2.F;
+        varies[j]        = (1.8F * mean < d12) & ((d12 > 6.F) | (mean > 3.F));
+    }
+
+    std::vector<int> variations;
+    for(int j = 1; j < count - 1; ++j)
+    {
+        if(varies[j])
+        {
+            variations.push_back(j);
+        }
+    }
+    return variations;
+}
+} // namespace velocity
@@ -0,0 +1,40 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRAJECTORYVELOCITY_H
+#define TRAJECTORYVELOCITY_H
+
+#include <vector>
+
+/**
+ * @brief Velocities of trajectories stored as contiguous coordinate arrays
+ *
+ * The kernels work on whole columns (see TrackPointColumns::xData) with the vectorized
+ * array operations of OpenCV, instead of assembling a point per frame. Velocities are
+ * given as distances per step; the caller scales them to its unit.
+ */
+namespace velocity
+{
+std::vector<float> stepDistances(const float *x, const float *y, int count, int step = 1);
+std::vector<float> stepDistances(const float *x, const float *y, const float *z, int count, int step = 1);
+std::vector<float> stepDifferences(const float *values, int count, int step = 1);
+
+std::vector<int> findVariations(const std::vector<float> &distances);
+} // namespace velocity
+
+#endif // TRAJECTORYVELOCITY_H
@@ -64,6 +64,10 @@ CodeMarkerWidget::CodeMarkerWidget(QWidget *parent, reco::CodeMarkerOptions &cod
     mUi->dictList->addItem("DICT_ARUCO_ORGINAL"); // 16
     mUi->dictList->addItem("DICT_mip_36h12");     // 17
 
+    mUi->dictList->addItem("DICT_APRILTAG_25h9");  // 18
+    mUi->dictList->addItem("DICT_APRILTAG_36h10"); // 19
+    mUi->dictList->addItem("DICT_APRILTAG_36h11"); // 20
+
     connect(
         &mCodeMarkerOpt, &reco::CodeMarkerOptions::detectorParamsChanged, this, &CodeMarkerWidget::readDetectorParams);
     connect(
@@ -105,6 +109,7 @@ CodeMarkerWidget::CodeMarkerWidget(QWidget *parent, reco::CodeMarkerOptions &cod
     connect(mUi->minCornerDistance, QOverload<double>::of(&QDoubleSpinBox::valueChanged), changedParams);
     connect(mUi->minDistanceToBorder, QOverload<int>::of(&QSpinBox::valueChanged), changedParams);
     connect(mUi->minMarkerDistance, QOverload<double>::of(&QDoubleSpinBox::valueChanged), changedParams);
+    connect(mUi->quadDecimate, QOverload<int>::of(&QSpinBox::valueChanged), changedParams);
 
     connect(mUi->doCornerRefinement, &QGroupBox::clicked, changedParams);
     connect(mUi->cornerRefinementWinSize, QOverload<int>::of(&QSpinBox::valueChanged), changedParams);
@@ -136,6 +141,12 @@ void CodeMarkerWidget::setXml(QDomElement &elem)
 
     subElem = (elem.ownerDocument()).createElement("DICTIONARY");
     subElem.setAttribute("ID", mUi->dictList->currentIndex());
+    QStringList extraDicts;
+    for(int dict : mCodeMarkerOpt.getExtraMarkerDicts())
+    {
+        extraDicts << QString::number(dict);
+    }
+    subElem.setAttribute("EXTRA_IDS", extraDicts.join(','));
     elem.appendChild(subElem);
 
     subElem = (elem.ownerDocument()).createElement("PARAM");
@@ -149,6 +160,7 @@ void CodeMarkerWidget::setXml(QDomElement &elem)
     subElem.setAttribute("MIN_CORNER_DISTANCE", mUi->minCornerDistance->value());
     subElem.setAttribute("MIN_DISTANCE_TO_BORDER", mUi->minDistanceToBorder->value());
     subElem.setAttribute("MIN_MARKER_DISTANCE", mUi->minMarkerDistance->value());
+    subElem.setAttribute("QUAD_DECIMATE", mUi->quadDecimate->value());
     subElem.setAttribute("CORNER_REFINEMENT", mUi->doCornerRefinement->isChecked());
     subElem.setAttribute("CORNER_REFINEMENT_WIN_SIZE", mUi->cornerRefinementWinSize->value());
     subElem.setAttribute("CORNER_REFINEMENT_MAX_ITERATIONS", mUi->cornerRefinementMaxIterations->value());
@@ -175,6 +187,13 @@ void CodeMarkerWidget::getXml(QDomElement &elem)
         if(subElem.tagName() == "DICTIONARY")
         {
             loadActiveIndex(subElem, "ID", mUi->dictList, 0);
+            // further dictionaries detected in the same pass, with ids offset by ArucoDetectorCache::ID_STRIDE
+            std::vector<int> extraDicts;
+            for(const auto &dict : readQString(subElem, "EXTRA_IDS", "").split(',', Qt::SkipEmptyParts))
+            {
+                extraDicts.push_back(dict.toInt());
+            }
+            mCodeMarkerOpt.setExtraMarkerDicts(extraDicts);
         }
 
         if(subElem.tagName() == "PARAM")
@@ -189,6 +208,7 @@ void CodeMarkerWidget::getXml(QDomElement &elem)
             loadDoubleValue(subElem, "MIN_CORNER_DISTANCE", mUi->minCornerDistance);
             loadIntValue(subElem, "MIN_DISTANCE_TO_BORDER", mUi->minDistanceToBorder);
             loadDoubleValue(subElem, "MIN_MARKER_DISTANCE", mUi->minMarkerDistance);
+            loadIntValue(subElem, "QUAD_DECIMATE", mUi->quadDecimate, 1);
             loadBoolValue(subElem, "CORNER_REFINEMENT", mUi->doCornerRefinement);
             loadIntValue(subElem, "CORNER_REFINEMENT_WIN_SIZE", mUi->cornerRefinementWinSize);
             loadIntValue(subElem, "CORNER_REFINEMENT_MAX_ITERATIONS", mUi->cornerRefinementMaxIterations);
@@ -227,6 +247,7 @@ reco::ArucoCodeParams packDetectorParams(const Ui::CodeMarker *ui)
     params.setPerspectiveRemoveIgnoredMarginPerCell(ui->perspectiveRemoveIgnoredMarginPerCell->value());
     params.setPerspectiveRemovePixelPerCell(ui->perspectiveRemovePixelPerCell->value());
     params.setPolygonalApproxAccuracyRate(ui->polygonalApproxAccuracyRate->value());
+    params.setQuadDecimate(ui->quadDecimate->value());
 
     return params;
 }
@@ -268,7 +289,7 @@ void CodeMarkerWidget::notifyChanged()
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -294,6 +315,7 @@ void CodeMarkerWidget::readDetectorParams()
     mUi->perspectiveRemoveIgnoredMarginPerCell->setValue(params.getPerspectiveRemoveIgnoredMarginPerCell());
     mUi->perspectiveRemovePixelPerCell->setValue(params.getPerspectiveRemovePixelPerCell());
     mUi->polygonalApproxAccuracyRate->setValue(params.getPolygonalApproxAccuracyRate());
+    mUi->quadDecimate->setValue(params.getQuadDecimate());
 }
 
 void CodeMarkerWidget::readDictListIndex()
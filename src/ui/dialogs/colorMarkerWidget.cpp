@@ -177,7 +177,7 @@ void ColorMarkerWidget::on_inversHue_stateChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -186,7 +186,7 @@ void ColorMarkerWidget::on_useOpen_stateChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -195,7 +195,7 @@ void ColorMarkerWidget::on_useClose_stateChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -204,7 +204,7 @@ void ColorMarkerWidget::on_closeRadius_valueChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -213,7 +213,7 @@ void ColorMarkerWidget::on_openRadius_valueChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -222,7 +222,7 @@ void ColorMarkerWidget::on_minArea_valueChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -231,7 +231,7 @@ void ColorMarkerWidget::on_maxArea_valueChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -240,7 +240,7 @@ void ColorMarkerWidget::on_maxRatio_valueChanged(double)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -254,7 +254,7 @@ void ColorMarkerWidget::on_fromTriangle_colorChanged(const QColor &col)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 void ColorMarkerWidget::on_toTriangle_colorChanged(const QColor &col)
@@ -267,7 +267,7 @@ void ColorMarkerWidget::on_toTriangle_colorChanged(const QColor &col)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -55,7 +55,7 @@ void ColorRangeWidget::on_inversHue_stateChanged(int i)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
     mColorPlot->replot();
 }
@@ -109,7 +109,7 @@ void ColorRangeWidget::on_fromTriangle_colorChanged(const QColor &col)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 void ColorRangeWidget::on_toTriangle_colorChanged(const QColor &col)
@@ -126,7 +126,7 @@ void ColorRangeWidget::on_toTriangle_colorChanged(const QColor &col)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
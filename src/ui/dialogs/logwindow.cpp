@@ -40,20 +40,17 @@ LogWindow::LogWindow(QWidget *parent, Ui::LogWindow *ui) : QWidget(parent)
     mUi->setupUi(this);
     mUi->logText->setReadOnly(true);
 
-    // extract messages from the ringbuffer_sink
-    auto ringbufferSink = static_cast<spdlog::sinks::ringbuffer_sink_mt *>(spdlog::default_logger()->sinks()[1].get());
-    std::vector<std::string> logMessages = ringbufferSink->last_formatted(10);
+    // extract the messages logged before the window was created from the history
+    std::vector<std::string> logMessages = logger::historySink()->last_formatted();
     for(std::string s : logMessages)
     {
         s.erase(std::remove(s.begin(), s.end(), '\n'), s.cend());
         mUi->logText->appendPlainText(QString::fromStdString(s));
     }
 
-    distSink = std::make_shared<spdlog::sinks::dist_sink_mt>();
-    qtSink   = std::make_shared<spdlog::sinks::qt_sink_mt>(mUi->logText, "appendPlainText");
-    distSink->add_sink(qtSink);
-    spdlog::default_logger()->sinks().push_back(distSink);
-    spdlog::default_logger()->set_pattern(logger::logFormat);
+    qtSink = std::make_shared<spdlog::sinks::qt_sink_mt>(mUi->logText, "appendPlainText");
+    qtSink->set_pattern(logger::logFormat);
+    logger::logWindowSink()->add_sink(qtSink);
     connect(mUi->saveLogButton, &QPushButton::clicked, this, &LogWindow::saveLog);
 }
 void LogWindow::saveLog()
@@ -70,5 +67,5 @@ void LogWindow::saveLog()
 LogWindow::~LogWindow()
 {
     delete mUi;
-    distSink->remove_sink(qtSink);
+    logger::logWindowSink()->remove_sink(qtSink);
 }
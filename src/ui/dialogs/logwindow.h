@@ -21,7 +21,6 @@
 
 #include "spdlog//spdlog.h"
 #include "spdlog/logger.h"
-#include "spdlog/sinks/dist_sink.h"
 #include "spdlog/sinks/qt_sinks.h"
 
 #include <QWidget>
@@ -46,9 +45,8 @@ public:
     LogWindow &operator=(LogWindow &&) = delete;
 
 private:
-    Ui::LogWindow                                        *mUi;
-    std::shared_ptr<spdlog::sinks::dist_sink<std::mutex>> distSink;
-    std::shared_ptr<spdlog::sinks::qt_sink<std::mutex>>   qtSink;
+    Ui::LogWindow                                      *mUi;
+    std::shared_ptr<spdlog::sinks::qt_sink<std::mutex>> qtSink;
 };
 
 #endif // LOGWINDOW_H
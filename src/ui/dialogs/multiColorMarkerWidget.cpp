@@ -119,19 +119,19 @@ void MultiColorMarkerWidget::getXml(QDomElement &elem)
 void MultiColorMarkerWidget::on_useDot_stateChanged(int)
 {
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_dotSize_valueChanged(double)
 {
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_useCodeMarker_stateChanged(int)
 {
     mMainWindow->setRecognitionChanged(true);
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_CodeMarkerParameter_clicked()
@@ -142,31 +142,31 @@ void MultiColorMarkerWidget::on_CodeMarkerParameter_clicked()
 void MultiColorMarkerWidget::on_ignoreWithoutDot_stateChanged(int)
 {
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_useColor_stateChanged(int) // eigentlich nichts noetig, da nur beim Tracing aktiv
 {
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_restrictPosition_stateChanged(int)
 {
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_autoCorrect_stateChanged(int)
 {
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_autoCorrectOnlyExport_stateChanged(int)
 {
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_showMask_stateChanged(int i)
@@ -190,7 +190,7 @@ void MultiColorMarkerWidget::on_useOpen_stateChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -199,7 +199,7 @@ void MultiColorMarkerWidget::on_useClose_stateChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -208,7 +208,7 @@ void MultiColorMarkerWidget::on_closeRadius_valueChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -217,7 +217,7 @@ void MultiColorMarkerWidget::on_openRadius_valueChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -226,7 +226,7 @@ void MultiColorMarkerWidget::on_minArea_valueChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -235,7 +235,7 @@ void MultiColorMarkerWidget::on_maxArea_valueChanged(int)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -275,7 +275,7 @@ void MultiColorMarkerWidget::on_useHeadSize_stateChanged(int i)
     }
 
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
-    mMainWindow->updateImage();
+    mMainWindow->requestUpdateImage();
 }
 
 void MultiColorMarkerWidget::on_maxRatio_valueChanged(double)
@@ -283,7 +283,7 @@ void MultiColorMarkerWidget::on_maxRatio_valueChanged(double)
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -36,6 +36,9 @@ StereoWidget::StereoWidget(QWidget *parent) : QWidget(parent)
     stereoDispAlgo->addItem("ptGrey");
     stereoDispAlgo->addItem("openCV block matching");
     stereoDispAlgo->addItem("openCV semi-global block matching");
+    stereoDispAlgo->addItem("openCV semi-global block matching (3-way)");
+    // always listed, so projects stay loadable; falls back to the CPU without CUDA stereo
+    stereoDispAlgo->addItem("CUDA semi-global matching");
 }
 
 //---------------------------------------
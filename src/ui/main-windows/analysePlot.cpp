@@ -21,9 +21,12 @@
 #include "animation.h"
 #include "control.h"
 #include "petrack.h"
+#include "trajectoryVelocity.h"
 
 #include <QMouseEvent>
 #include <QPainter>
+#include <algorithm>
+#include <opencv2/core.hpp>
 #include <qwt_plot_grid.h>
 #include <qwt_plot_layout.h>
 #include <qwt_plot_zoomer.h>
@@ -31,6 +34,7 @@
 #include <qwt_scale_map.h>
 #include <qwt_symbol.h>
 #include <qwt_text.h>
+#include <vector>
 
 //-----------------------------------------------------------------
 class AnalyseZoomer : public QwtPlotZoomer
@@ -117,6 +121,52 @@ public:
     }
 };
 
+//-----------------------------------------------------------------
+
+namespace
+{
+/**
+ * @brief Velocities of a person between the points j and j + step as shown in the plot
+ *
+ * @return distances (x and y considered) or signed/absolute differences of one coordinate
+ */
+std::vector<float> personVelocities(
+    const TrackPersonReal &person,
+    int                    step,
+    bool                   considerX,
+    bool                   considerY,
+    bool                   considerAbs,
+    bool                   considerRev)
+{
+    const int          count = person.size();
+    std::vector<float> x(count), y(count), z(count);
+    for(int j = 0; j < count; ++j)
+    {
+        x[j] = person.at(j).x();
+        y[j] = person.at(j).y();
+        z[j] = person.at(j).z();
+    }
+
+    if(considerX && considerY)
+    {
+        return velocity::stepDistances(x.data(), y.data(), z.data(), count, step);
+    }
+    auto velocities = velocity::stepDifferences(considerX ? x.data() : y.data(), count, step);
+    for(float &v : velocities)
+    {
+        if(considerAbs)
+        {
+            v = std::fabs(v);
+        }
+        else if(considerRev)
+        {
+            v = -v;
+        }
+    }
+    return velocities;
+}
+} // namespace
+
 //-----------------------------------------------------------------------------------------
 
 // die kreise liegen mgl nicht genau auf kreuz - noch zu testen
@@ -135,7 +185,7 @@ void TrackerRealPlotItem::draw(QPainter *p, const QwtScaleMap &mapX, const QwtSc
         double  sx         = (mapX.p2() - mapX.p1()) / (mapX.s2() - mapX.s1());
         double  sy         = (mapY.p2() - mapY.p1()) / (mapY.s2() - mapY.s1());
         double  circleSize = ((AnalysePlot *) plot())->symbolSize();
-        int     i, j;
+        int     i;
         QPointF point, lastPoint;
 
         p->save();
@@ -198,106 +248,58 @@ void TrackerRealPlotItem::draw(QPainter *p, const QwtScaleMap &mapX, const QwtSc
         ((AnalysePlot *) plot())->setAxisTitle(QwtPlot::xBottom, titleX); //"x"
         ((AnalysePlot *) plot())->setAxisTitle(QwtPlot::yLeft, titleY);   //"y"
 
-        int             step = controlWidget->getAnaStep(); // 1
-        int             frame, animFrame, velVecActIdx = -1;
-        double          vel; // geschwindigkeit
-        int             largestLastFrame = mTrackerReal->largestLastFrame();
-        QVector<int>    velAnzVec(largestLastFrame, 0);
-        QVector<double> velVec(largestLastFrame, 0.);
-        int             actFrame = ((AnalysePlot *) plot())->getActFrame();
-        bool            markAct  = controlWidget->isAnaMarkActChecked();
-        double          fps      = controlWidget->getMainWindow()->getAnimation()->getSequenceFPS();
+        int    step     = controlWidget->getAnaStep(); // 1
+        int    actFrame = ((AnalysePlot *) plot())->getActFrame();
+        bool   markAct  = controlWidget->isAnaMarkActChecked();
+        double fps      = controlWidget->getMainWindow()->getAnimation()->getSequenceFPS();
         if(fps < 0)
         {
             fps = DEFAULT_FPS;
         }
+        const VelocitySeries &series =
+            velocitySeries({step, anaConsiderX, anaConsiderY, anaConsiderAbs, anaConsiderRev, fps});
+        int velVecActIdx = -1;
 
         if(!markAct)
         {
             p->setPen(Qt::green);
             p->setBrush(Qt::green);
         }
-        for(i = 0; i < mTrackerReal->size(); ++i)
+        for(const auto &velocity : series.points)
         {
-            for(j = 0; j < mTrackerReal->at(i).size() - step; ++j) // -step, damit geschwindigkeit ermittelt werden kann
+            if(markAct)
             {
-                frame     = mTrackerReal->at(i).firstFrame() + j;
-                animFrame = mTrackerReal->at(i).at(j).frameNum(); // ohne eingefuegte frames bei auslassungen
-                if(markAct)
+                if(velocity.animFrame == actFrame)
                 {
-                    if(animFrame == actFrame)
-                    {
-                        p->setPen(Qt::red);
-                        p->setBrush(Qt::red);
-                        velVecActIdx = frame;
-                    }
-                    else // if (frame == actFrame+1)
-                    {
-                        p->setPen(Qt::green);
-                        p->setBrush(Qt::green);
-                    }
+                    p->setPen(Qt::red);
+                    p->setBrush(Qt::red);
+                    velVecActIdx = velocity.frame;
                 }
-
-                if(anaConsiderX && anaConsiderY)
+                else // if (frame == actFrame+1)
                 {
-                    vel = (mTrackerReal->at(i).at(j + step).distanceToPoint(mTrackerReal->at(i).at(j)));
+                    p->setPen(Qt::green);
+                    p->setBrush(Qt::green);
                 }
-                else if(anaConsiderX)
-                {
-                    if(anaConsiderAbs)
-                    {
-                        vel = fabs((mTrackerReal->at(i).at(j + step).x() - mTrackerReal->at(i).at(j).x()));
-                    }
-                    else if(anaConsiderRev)
-                    {
-                        vel = (mTrackerReal->at(i).at(j).x() - mTrackerReal->at(i).at(j + step).x());
-                    }
-                    else
-                    {
-                        vel = (mTrackerReal->at(i).at(j + step).x() - mTrackerReal->at(i).at(j).x());
-                    }
-                }
-                else // == if (anaConsiderY)
-                {
-                    if(anaConsiderAbs)
-                    {
-                        vel = fabs((mTrackerReal->at(i).at(j + step).y() - mTrackerReal->at(i).at(j).y()));
-                    }
-                    else if(anaConsiderRev)
-                    {
-                        vel = (mTrackerReal->at(i).at(j).y() - mTrackerReal->at(i).at(j + step).y());
-                    }
-                    else
-                    {
-                        vel = (mTrackerReal->at(i).at(j + step).y() - mTrackerReal->at(i).at(j).y());
-                    }
-                }
-                vel /= ((100. / fps) * step); // m/s, war: 100cm/25frames =4 => vel /=(4.*step);
-
-                point.setX(frame);
-                point.setY(vel);
-                rect.moveLeft(point.x() - sx);
-                rect.moveTop(point.y() - sy);
-                p->drawEllipse(rect);
-
-                // j - j+step, da gegen die x-achse gelaufen wird
-
-                ++velAnzVec[frame];
-                velVec[frame] += vel;
             }
+
+            point.setX(velocity.frame);
+            point.setY(velocity.velocity);
+            rect.moveLeft(point.x() - sx);
+            rect.moveTop(point.y() - sy);
+            p->drawEllipse(rect);
         }
 
         rect.setWidth(2 * rect.width());
         rect.setHeight(2 * rect.height());
         p->setPen(Qt::blue);
         p->setBrush(Qt::blue);
-        for(i = 0; i < velAnzVec.size(); ++i)
+        for(i = 0; i < static_cast<int>(series.counts.size()); ++i)
         {
-            if(velAnzVec[i] != 0)
+            if(series.counts[i] != 0)
             {
                 point.setX(i);
-                point.setY(velVec[i] / velAnzVec[i]);
-                if((i != 0) && (velAnzVec[i - 1] != 0)) // nicht ganz hundertprozentig
+                point.setY(series.means[i]);
+                if((i != 0) && (series.counts[i - 1] != 0)) // nicht ganz hundertprozentig
                 {
                     p->drawLine(lastPoint, point);
                 }
@@ -315,6 +317,75 @@ void TrackerRealPlotItem::draw(QPainter *p, const QwtScaleMap &mapX, const QwtSc
     }
 }
 
+/**
+ * @brief Returns the velocities of all persons and their mean per frame
+ *
+ * They are computed (velocities of the persons in parallel) only if the options or the
+ * persons changed; TrackerReal::calculate() detaches the persons from mSeriesPersons.
+ * So replotting for another frame, e.g. with isAnaMarkActChecked(), draws the cached series.
+ */
+const TrackerRealPlotItem::VelocitySeries &TrackerRealPlotItem::velocitySeries(const VelocityOptions &options) const
+{
+    const QList<TrackPersonReal> &persons = *mTrackerReal;
+    if(mSeriesValid && options == mSeriesOptions && persons.isSharedWith(mSeriesPersons))
+    {
+        return mSeries;
+    }
+
+    // velocities of all persons in the unit of the axis, computed in parallel
+    std::vector<std::vector<float>> velocities(persons.size());
+    cv::parallel_for_(
+        cv::Range(0, persons.size()),
+        [&](const cv::Range &range)
+        {
+            for(int k = range.start; k < range.end; ++k)
+            {
+                velocities[k] = personVelocities(
+                    persons.at(k),
+                    options.step,
+                    options.considerX,
+                    options.considerY,
+                    options.considerAbs,
+                    options.considerRev);
+                for(float &v : velocities[k])
+                {
+                    v /= ((100. / options.fps) * options.step); // m/s, war: 100cm/25frames =4 => vel /=(4.*step);
+                }
+            }
+        });
+
+    const int      largestLastFrame = mTrackerReal->largestLastFrame();
+    VelocitySeries series;
+    series.counts.assign(std::max(largestLastFrame, 0), 0);
+    series.means.assign(series.counts.size(), 0.);
+    for(int i = 0; i < persons.size(); ++i)
+    {
+        const auto &person = persons.at(i);
+        for(int j = 0; j < person.size() - options.step; ++j) // -step, damit geschwindigkeit ermittelt werden kann
+        {
+            // j - j+step, da gegen die x-achse gelaufen wird
+            const int frame = person.firstFrame() + j;
+            // ohne eingefuegte frames bei auslassungen
+            series.points.push_back({frame, person.at(j).frameNum(), velocities[i][j]});
+            ++series.counts[frame];
+            series.means[frame] += velocities[i][j];
+        }
+    }
+    for(std::size_t frame = 0; frame < series.counts.size(); ++frame)
+    {
+        if(series.counts[frame] != 0)
+        {
+            series.means[frame] /= series.counts[frame];
+        }
+    }
+
+    mSeries        = std::move(series);
+    mSeriesOptions = options;
+    mSeriesPersons = persons;
+    mSeriesValid   = true;
+    return mSeries;
+}
+
 void TrackerRealPlotItem::setPen(const QPen &pen)
 {
     mPen = pen;
@@ -323,6 +394,8 @@ void TrackerRealPlotItem::setPen(const QPen &pen)
 void TrackerRealPlotItem::setTrackerReal(TrackerReal *trackerReal)
 {
     mTrackerReal = trackerReal;
+    mSeriesValid = false;
+    mSeriesPersons.clear();
 }
 
 //-----------------------------------------------------------------------------------------
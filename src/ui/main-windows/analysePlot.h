@@ -27,6 +27,7 @@
 #include <qwt_plot.h>
 #include <qwt_plot_item.h>
 #include <qwt_plot_zoomer.h>
+#include <vector>
 
 class Control;
 
@@ -42,8 +43,48 @@ public:
     void setTrackerReal(TrackerReal *trackerReal);
 
 private:
+    /// options of the shown velocities
+    struct VelocityOptions
+    {
+        int    step;
+        bool   considerX;
+        bool   considerY;
+        bool   considerAbs;
+        bool   considerRev;
+        double fps;
+
+        bool operator==(const VelocityOptions &other) const
+        {
+            return step == other.step && considerX == other.considerX && considerY == other.considerY &&
+                   considerAbs == other.considerAbs && considerRev == other.considerRev && fps == other.fps;
+        }
+    };
+
+    /// velocities of all persons and their mean per frame, as shown by the plot
+    struct VelocitySeries
+    {
+        struct Point
+        {
+            int   frame;     ///< frame including inserted missing frames
+            int   animFrame; ///< frame of the animation
+            float velocity;
+        };
+
+        std::vector<Point>  points;
+        std::vector<int>    counts; ///< number of velocities per frame
+        std::vector<double> means;  ///< mean velocity per frame
+    };
+
+    const VelocitySeries &velocitySeries(const VelocityOptions &options) const;
+
     TrackerReal *mTrackerReal;
     QPen         mPen;
+
+    // the series only changes with the options and TrackerReal::calculate(), not with the shown frame
+    mutable VelocitySeries         mSeries;
+    mutable VelocityOptions        mSeriesOptions{};
+    mutable QList<TrackPersonReal> mSeriesPersons; ///< shares the data mSeries was computed from
+    mutable bool                   mSeriesValid = false;
 };
 
 
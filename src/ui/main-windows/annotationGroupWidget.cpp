@@ -41,7 +41,11 @@ AnnotationGroupWidget::AnnotationGroupWidget(
     AnnotationGroupManager &groupManager,
     const Animation        &animation,
     QWidget                *parent) :
-    QWidget(parent), mGroupManager(groupManager), mUi(new Ui::AnnotationGroupUI), mAnimation(animation)
+    QWidget(parent),
+    mGroupManager(groupManager),
+    mUi(new Ui::AnnotationGroupUI),
+    mTreeModel(groupManager),
+    mAnimation(animation)
 {
     mUi->setupUi(this);
 
@@ -58,11 +62,13 @@ AnnotationGroupWidget::AnnotationGroupWidget(
     connect(mUi->btnExport, &QPushButton::pressed, this, &AnnotationGroupWidget::exportData);
     connect(mUi->btnImport, &QPushButton::pressed, this, &AnnotationGroupWidget::importData);
 
+    // assignments only update the affected rows, changed groups rebuild the tree
     connect(
         &mGroupManager,
         &AnnotationGroupManager::trajectoryAssignmentChanged,
-        this,
-        &AnnotationGroupWidget::populateTreeView);
+        &mTreeModel,
+        &AnnotationGroupTreeModel::updateAssignments);
+    connect(&mGroupManager, &AnnotationGroupManager::groupsChanged, this, &AnnotationGroupWidget::populateTreeView);
     connect(mUi->btnAddTrajectories, &QPushButton::pressed, this, &AnnotationGroupWidget::addTrajectories);
 
     // group selection combo box
@@ -81,6 +87,8 @@ AnnotationGroupWidget::AnnotationGroupWidget(
 
     mUi->treeView->setModel(&mTreeModel);
     populateTreeView();
+    // the widget is created when it is shown first, possibly after the groups were loaded
+    updateComboBox();
 }
 
 AnnotationGroupWidget::~AnnotationGroupWidget()
@@ -106,11 +114,7 @@ void AnnotationGroupWidget::addGroup()
     {
         auto group   = dialog.getGroup();
         auto groupId = mGroupManager.createGroup(group);
-        if(groupId >= 0)
-        {
-            populateTreeView();
-        }
-        else
+        if(groupId < 0)
         {
             PWarning(parentWidget(), "Could not create group", "Group create was not successfull due to invalid data");
         }
@@ -136,7 +140,6 @@ void AnnotationGroupWidget::importData()
     }
     auto config = annotationGroups::readConfigurationFromFile(file);
     mGroupManager.loadConfig(config);
-    populateTreeView();
 }
 void AnnotationGroupWidget::comboBoxSelectionChanged()
 {
@@ -176,6 +179,11 @@ void AnnotationGroupWidget::btnEditGroup()
     {
         return;
     }
+    if(!item->isGroup())
+    {
+        // trajectory of a group
+        item = item->parentItem();
+    }
     int  groupId = item->getId();
     auto group   = mGroupManager.getGroup(groupId);
 
@@ -200,7 +208,6 @@ void AnnotationGroupWidget::btnEditGroup()
                 mGroupManager.updateGroup(changed);
             }
         }
-        populateTreeView();
     }
 }
 
@@ -297,30 +304,9 @@ void AnnotationGroupWidget::updateComboBox()
 void AnnotationGroupWidget::populateTreeView()
 {
     mUi->treeView->clearSelection();
-    auto root = std::make_unique<AnnotationGroupTreeItem>();
-    root->setData(0, "key");
-    root->setData(1, "value");
-    for(const auto &tlg : mGroupManager.getTopLevelGroups())
-    {
-        auto tlgElem = std::make_unique<TopLevelGroupTreeItem>(tlg.id, tlg.name, root.get());
+    mTreeModel.rebuild();
 
-        const std::vector<annotationGroups::Group> groups = mGroupManager.getGroupsOfTlg(tlg.id);
-
-        tlgElem->setChildCount((int) groups.size());
-        for(const auto &grp : groups)
-        {
-            auto grpElem = std::make_unique<GroupTreeItem>(grp.id, grp.name, grp.type, tlgElem.get());
-            grpElem->setColor(grp.color);
-            grpElem->setChildCount((int) mGroupManager.getTrajectoriesOfGroup(grp.id).size());
-            tlgElem->appendChild(std::move(grpElem));
-        }
-        root->appendChild(std::move(tlgElem));
-    }
-
-    mTreeModel.setRootItem(std::move(root));
-
-    mUi->treeView->update();
-    mTreeModel.layoutChanged();
-    mUi->treeView->expandAll();
+    // groups stay collapsed, so their trajectories are only fetched when expanded
+    mUi->treeView->expandToDepth(0);
     mUi->treeView->resizeColumnToContents(0);
-}
\ No newline at end of file
+}
@@ -56,7 +56,7 @@ private:
     /**
      * Populates the tree view in the main panel.
      * This reads the group data from the manager and tanslates it into GroupItem instances which are used for the
-     * custom TreeModel.
+     * custom TreeModel. Called whenever the groups change; changed assignments are handled by the model itself.
      */
     void populateTreeView();
 
@@ -25,19 +25,57 @@
 
 #include <QMouseEvent>
 #include <QPainter>
+#include <algorithm>
 #include <iomanip>
+#include <map>
 #include <qwt_plot_layout.h>
 #include <qwt_plot_zoomer.h>
 #include <qwt_scale_engine.h>
 #include <qwt_scale_map.h>
 #include <qwt_symbol.h>
 #include <qwt_text.h>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+/// generated backgrounds kept for switching back to former axes or z values
+constexpr std::size_t MAX_CACHED_IMAGES = 32;
+
+/**
+ * @brief Converts a row of HSV values into RGB values
+ *
+ * Branch-free per pixel, so the compiler can vectorize the loop; gives the colors of
+ * QColor::setHsv() up to rounding.
+ *
+ * @param hue hues in [0, 360)
+ * @param saturation saturations in [0, 255]
+ * @param value values in [0, 255]
+ * @param rgb converted colors
+ * @param count number of pixels
+ */
+void hsvToRgb(const int *hue, const int *saturation, const int *value, QRgb *rgb, int count)
+{
+    for(int i = 0; i < count; ++i)
+    {
+        const float h = static_cast<float>(hue[i]) / 60.F;
+        const float s = static_cast<float>(saturation[i]) / 255.F;
+        const float v = static_cast<float>(value[i]);
+
+        auto channel = [h, s, v](float n)
+        {
+            float k = n + h;
+            k -= k >= 6.F ? 6.F : 0.F;
+            return static_cast<int>(v - v * s * std::clamp(std::min(k, 4.F - k), 0.F, 1.F) + 0.5F);
+        };
+        rgb[i] = qRgb(channel(5.F), channel(3.F), channel(1.F));
+    }
+}
+} // namespace
 
 class ImagePlotItem : public QwtPlotItem
 {
 public:
-    ImagePlotItem() { mImage = new QImage(360, 360, QImage::Format_RGB32); }
-
     /**
      * @brief Draws the mImage at the right position in correct size.
      * @param p
@@ -49,7 +87,7 @@ public:
         p->save();
         p->scale(mx.p2() / (mx.s2() - mx.s1()), my.p1() / (my.s2() - my.s1())); //
         p->translate(-mx.s1(), my.s2() - ((ColorPlot *) plot())->yMax());
-        p->drawImage(0, 0, *mImage);
+        p->drawImage(0, 0, mImage);
         p->restore();
     }
 
@@ -57,7 +95,8 @@ public:
      * @brief Generates the color background or the color plot
      *
      * If x == y, the minimal values for both are used and the other two
-     * dimenions get set with the value of z.
+     * dimenions get set with the value of z. Generated images are cached,
+     * as they only depend on the parameters.
      *
      * @param model
      * @param x First dimension (dimension for x-values) RGB or HSV (e.g. Hue, Value, Red)
@@ -66,43 +105,61 @@ public:
      */
     void generateImage(int model, int x, int y, int z)
     {
-        QColor col;
-        int    i, j;
+        const auto key    = std::make_tuple(model, x, y, z);
+        const auto cached = mCache.find(key);
+        if(cached != mCache.end())
+        {
+            mImage = cached->second;
+            return;
+        }
 
-        if(model == 0) // HSV
+        const int width  = (model == 0 && x == 0) ? 360 : 256;
+        const int height = (model == 0 && y == 0) ? 360 : 256;
+        QImage    image(width, height, QImage::Format_RGB32);
+
+        // value of dimension dim at column i and row value j
+        auto dimension = [x, y](int dim, int i, int j, int other)
+        { return x == dim ? (y == dim ? std::min(i, j) : i) : (y == dim ? j : other); };
+
+        std::vector<int> hsv(3 * static_cast<std::size_t>(width));
+        for(int j = 0; j < height; ++j)
         {
-            for(i = 0; i < (x == 0 ? 360 : 256); ++i)
+            auto *line = reinterpret_cast<QRgb *>(image.scanLine(height - 1 - j));
+            if(model == 0) // HSV
             {
-                for(j = 0; j < (y == 0 ? 360 : 256); ++j)
+                int *hue        = hsv.data();
+                int *saturation = hue + width;
+                int *value      = saturation + width;
+                for(int i = 0; i < width; ++i)
                 {
-                    col.setHsv(
-                        x == 0 ? (y == 0 ? std::min(i, j) : i) : (y == 0 ? j : myRound(z * 360. / 256.)),
-                        x == 1 ? (y == 1 ? std::min(i, j) : i) : (y == 1 ? j : z),
-                        x == 2 ? (y == 2 ? std::min(i, j) : i) : (y == 2 ? j : z));
-                    mImage->setPixel(i, (y == 0 ? 359 : 255) - j, col.rgb());
+                    hue[i]        = dimension(0, i, j, myRound(z * 360. / 256.));
+                    saturation[i] = dimension(1, i, j, z);
+                    value[i]      = dimension(2, i, j, z);
                 }
+                hsvToRgb(hue, saturation, value, line, width);
             }
-        }
-        else // RGB
-        {
-            for(i = 0; i < 256; ++i)
+            else // RGB
             {
-                for(j = 0; j < 256; ++j)
+                for(int i = 0; i < width; ++i)
                 {
-                    col.setRgb(
-                        x == 0 ? (y == 0 ? std::min(i, j) : i) : (y == 0 ? j : z),
-                        x == 1 ? (y == 1 ? std::min(i, j) : i) : (y == 1 ? j : z),
-                        x == 2 ? (y == 2 ? std::min(i, j) : i) : (y == 2 ? j : z));
-                    mImage->setPixel(i, 255 - j, col.rgb());
+                    line[i] = qRgb(dimension(0, i, j, z), dimension(1, i, j, z), dimension(2, i, j, z));
                 }
             }
         }
+
+        if(mCache.size() >= MAX_CACHED_IMAGES)
+        {
+            mCache.clear();
+        }
+        mCache.emplace(key, image);
+        mImage = image;
     }
 
-    inline QImage *getImage() const { return mImage; }
+    inline const QImage &getImage() const { return mImage; }
 
 private:
-    QImage *mImage;
+    QImage                                           mImage;
+    std::map<std::tuple<int, int, int, int>, QImage> mCache; ///< images by model, x, y and z
 };
 
 
@@ -113,61 +170,104 @@ private:
 /**
  * @brief Draws a circle in the colorplot for every color associated with a trackperson.
  *
+ * The circles are rendered into an image, which is reused as long as the circles,
+ * the scales and the pen stay the same, e.g. while recognition settings are tuned.
+ *
  * @param p
  * @param mapX
  * @param mapY
+ * @param re canvas rectangle
  */
-void TrackerPlotItem::draw(QPainter *p, const QwtScaleMap &mapX, const QwtScaleMap &mapY, const QRectF & /*re*/) const
+void TrackerPlotItem::draw(QPainter *p, const QwtScaleMap &mapX, const QwtScaleMap &mapY, const QRectF &re) const
 {
-    QRectF rect;
-    double sx         = mapX.p2() / (mapX.s2() - mapX.s1());
-    double sy         = mapY.p1() / (mapY.s2() - mapY.s1());
-    double yMax       = ((ColorPlot *) plot())->yMax();
-    double circleSize = ((ColorPlot *) plot())->symbolSize();
-    int    z;
-    int    plotZ = ((ColorPlot *) plot())->zValue();
-    double diff;
+    const double sx   = mapX.p2() / (mapX.s2() - mapX.s1());
+    const double sy   = mapY.p1() / (mapY.s2() - mapY.s1());
+    const double yMax = ((ColorPlot *) plot())->yMax();
 
     // TODO ganz leicht verschiebung: eigentlich muessten noch andere werte wie diese einfliessen:
     //         p->scale((mx.p2() - mx.p1())/(mx.s2() - mx.s1()), (my.p1() - my.p2())/(my.s2() - my.s1()));//
     // mx.p1()-mx.s1(), my.s2()+my.p2()-((ColorPlot *) plot())->yMax()
+    QTransform transform;
+    transform.scale(sx, sy);
+    transform.translate(-mapX.s1(), mapY.s2() - yMax);
 
-    p->save();
-    p->scale(sx, sy);
-    p->translate(-mapX.s1(), mapY.s2() - yMax);
+    std::vector<Mark> newMarks = marks();
+
+    // e.g. printing scales the painter, the image would have a too low resolution then
+    if(p->transform().isScaling() || re.isEmpty())
+    {
+        p->save();
+        p->setTransform(transform, true);
+        drawMarks(p, newMarks, sx, sy);
+        p->restore();
+        return;
+    }
 
-    sx = circleSize / sx;
-    sy = circleSize / sy;
+    const qreal ratio = p->device() ? p->device()->devicePixelRatioF() : 1.;
+    const QSize size  = (re.size() * ratio).toSize();
+    transform *= QTransform::fromTranslate(-re.left(), -re.top());
+    if(newMarks != mCachedMarks || transform != mCachedTransform || mPen != mCachedPen || mCachedImage.size() != size)
+    {
+        mCachedImage = QImage(size, QImage::Format_ARGB32_Premultiplied);
+        mCachedImage.setDevicePixelRatio(ratio);
+        mCachedImage.fill(Qt::transparent);
+
+        QPainter painter(&mCachedImage);
+        painter.setRenderHints(p->renderHints());
+        painter.setTransform(transform);
+        drawMarks(&painter, newMarks, sx, sy);
+
+        mCachedMarks     = std::move(newMarks);
+        mCachedTransform = transform;
+        mCachedPen       = mPen;
+    }
+    p->drawImage(re.topLeft(), mCachedImage);
+}
 
-    if(mPersonStorage)
+/// circles of the colors of all persons in plot coordinates
+std::vector<TrackerPlotItem::Mark> TrackerPlotItem::marks() const
+{
+    std::vector<Mark> marks;
+    if(!mPersonStorage)
     {
-        const auto &persons = mPersonStorage->getPersons();
-        for(const auto &person : persons)
-        {
-            if(person.color().isValid()) // insbesondere von hand eingefuegte trackpoint/persons haben keine farbe
-            {
-                QPoint point = ((ColorPlot *) plot())->getPos(person.color(), &z);
-                diff         = (255. - abs(z - plotZ)) / 255.;
-                rect.setWidth(diff * sx);
-                rect.setHeight(diff * sy);
-                rect.moveLeft(point.x() - diff * sx / 2.);
-                rect.moveTop(point.y() - diff * sy / 2.);
-
-                p->setBrush(QBrush(person.color()));
-                if(((ColorPlot *) plot())->isGrey(person.color()))
-                {
-                    p->setPen(Qt::red);
-                }
-                else
-                {
-                    p->setPen(mPen);
-                }
+        return marks;
+    }
 
-                p->drawEllipse(rect);
-            }
+    const auto  *colorPlot  = (ColorPlot *) plot();
+    const double circleSize = colorPlot->symbolSize();
+    const int    plotZ      = colorPlot->zValue();
+    int          z;
+
+    const auto &persons = mPersonStorage->getPersons();
+    marks.reserve(persons.size());
+    for(const auto &person : persons)
+    {
+        if(person.color().isValid()) // insbesondere von hand eingefuegte trackpoint/persons haben keine farbe
+        {
+            const QPoint point = colorPlot->getPos(person.color(), &z);
+            const double diff  = (255. - abs(z - plotZ)) / 255.;
+            marks.push_back({point, diff * circleSize, person.color().rgb(), colorPlot->isGrey(person.color())});
         }
     }
-    p->restore();
+    return marks;
+}
+
+/**
+ * @brief Draws the circles with a painter transformed into plot coordinates
+ *
+ * The size of the circles is given in pixels, so it is scaled back with the scales sx and sy of the plot.
+ */
+void TrackerPlotItem::drawMarks(QPainter *p, const std::vector<Mark> &marks, double sx, double sy) const
+{
+    for(const auto &mark : marks)
+    {
+        QRectF rect(0., 0., mark.size / sx, mark.size / sy);
+        rect.moveCenter(mark.center);
+
+        p->setBrush(QBrush(QColor(mark.color)));
+        p->setPen(mark.grey ? QPen(Qt::red) : mPen);
+        p->drawEllipse(rect);
+    }
 }
 
 void TrackerPlotItem::setPen(const QPen &pen)
@@ -873,11 +973,10 @@ void ColorPlot::generateImage()
 
         // farbe anpassen, damit besser auf bild zu sehen
         // 255 immer genommen, da einfacher und es nicht so genau drauf ankommt
-        int midValue = (QColor(mImageItem->getImage()->pixel(0, 0)).value() +
-                        QColor(mImageItem->getImage()->pixel(255, 0)).value() +
-                        QColor(mImageItem->getImage()->pixel(0, 255)).value() +
-                        QColor(mImageItem->getImage()->pixel(255, 255)).value()) /
-                       4;
+        const QImage &image    = mImageItem->getImage();
+        const int     midValue = (QColor(image.pixel(0, 0)).value() + QColor(image.pixel(255, 0)).value() +
+                              QColor(image.pixel(0, 255)).value() + QColor(image.pixel(255, 255)).value()) /
+                             4;
         if(midValue < 130)
         {
             mZoomer->setTrackerPen(QColor(Qt::white));
@@ -21,8 +21,11 @@
 
 #include "helper.h"
 
+#include <QImage>
 #include <QPen>
+#include <QTransform>
 #include <qwt_plot.h>
+#include <vector>
 
 inline constexpr double DEFAULT_HEIGHT = 180.0;
 
@@ -48,8 +51,31 @@ public:
     void setPersonStorage(const PersonStorage *storage);
 
 private:
+    /// circle of the color of a person
+    struct Mark
+    {
+        QPoint center; ///< in plot coordinates
+        double size;   ///< in pixels
+        QRgb   color;
+        bool   grey;
+
+        bool operator==(const Mark &other) const
+        {
+            return center == other.center && size == other.size && color == other.color && grey == other.grey;
+        }
+    };
+
+    std::vector<Mark> marks() const;
+    void              drawMarks(QPainter *p, const std::vector<Mark> &marks, double sx, double sy) const;
+
     const PersonStorage *mPersonStorage = nullptr;
     QPen                 mPen;
+
+    // the drawn marks only change with the colors of the persons and the plot settings
+    mutable std::vector<Mark> mCachedMarks;
+    mutable QTransform        mCachedTransform;
+    mutable QPen              mCachedPen;
+    mutable QImage            mCachedImage;
 };
 
 
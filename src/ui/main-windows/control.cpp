@@ -221,6 +221,7 @@ Control::Control(
     mUi->recoMethod->addItem("marker Japan", QVariant::fromValue(reco::RecognitionMethod::Japan));
     mUi->recoMethod->addItem("multicolor marker", QVariant::fromValue(reco::RecognitionMethod::MultiColor));
     mUi->recoMethod->addItem("code marker", QVariant::fromValue(reco::RecognitionMethod::Code));
+    mUi->recoMethod->addItem("head detector (DNN)", QVariant::fromValue(reco::RecognitionMethod::Head));
 
     connect(&recognizer, &reco::Recognizer::recoMethodChanged, this, &Control::onRecoMethodChanged);
     connect(this, &Control::userChangedRecoMethod, &recognizer, &reco::Recognizer::userChangedRecoMethod);
@@ -928,7 +929,7 @@ void Control::on_trackOnlineCalc_stateChanged(int i)
         mMainWindow->getTracker()->reset();
         if(!mMainWindow->isLoading())
         {
-            mMainWindow->updateImage();
+            mMainWindow->requestUpdateImage();
         }
     }
 }
@@ -950,7 +951,7 @@ void Control::on_trackReset_clicked()
         mMainWindow->getTracker()->init(size);
         if(!mMainWindow->isLoading())
         {
-            mMainWindow->updateImage();
+            mMainWindow->requestUpdateImage();
         }
     }
 }
@@ -974,7 +975,7 @@ void Control::on_trackPathColorButton_clicked()
     }
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -987,7 +988,7 @@ void Control::on_trackGroundPathColorButton_clicked()
     }
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -1001,7 +1002,7 @@ void Control::on_moCapColorButton_clicked()
     mScene->update();
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -1011,7 +1012,7 @@ void Control::on_trackRegionScale_valueChanged(int /*i*/)
     mMainWindow->getTracker()->reset();
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -1021,7 +1022,7 @@ void Control::on_trackRegionLevels_valueChanged(int /*i*/)
     mMainWindow->getTracker()->reset();
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -1393,7 +1394,7 @@ void Control::on_mapNr_valueChanged(int i)
     if(!isLoading())
     {
         replotColorplot(); // um aktiven gruen anzuzeigen
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -1594,7 +1595,7 @@ void Control::on_performRecognition_stateChanged(int /*i*/)
     mMainWindow->setRecognitionChanged(true); // flag changes of recognition parameters
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -1614,7 +1615,7 @@ void Control::on_markerBrightness_valueChanged(int /*i*/)
     mMainWindow->setRecognitionChanged(true); // flag changes of recognition parameters
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 void Control::on_markerIgnoreWithout_stateChanged(int /*i*/)
@@ -1622,7 +1623,7 @@ void Control::on_markerIgnoreWithout_stateChanged(int /*i*/)
     mMainWindow->setRecognitionChanged(true); // flag changes of recognition parameters
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
@@ -1684,7 +1685,7 @@ void Control::on_intrinsicParamsChanged(IntrinsicCameraParams params)
     mMainWindow->setStatusPosReal();
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
         mCoordSys->updateCoordItem();
     }
     mCoordSys->setMeasuredAltitude();
@@ -2791,7 +2792,7 @@ void Control::saveChange(const QColor &fromColor, const QColor &toColor, RectPlo
     mMainWindow->setRecognitionChanged(true); // flag indicates that changes of recognition parameters happens
     if(!mMainWindow->isLoading())
     {
-        mMainWindow->updateImage();
+        mMainWindow->requestUpdateImage();
     }
 }
 
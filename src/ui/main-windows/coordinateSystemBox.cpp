@@ -26,6 +26,7 @@
 #include "intrinsicBox.h"
 #include "pGroupBox.h"
 #include "ui_coordinateSystemBox.h"
+#include "worldImageSnapshot.h"
 
 #include <opencv2/core/base.hpp>
 
@@ -377,6 +378,31 @@ QPointF CoordinateSystemBox::getPosReal(QPointF pos, double height) const
     return pos;
 }
 
+std::unique_ptr<WorldImageCorrespondence> CoordinateSystemBox::snapshot() const
+{
+    WorldImageSnapshot::Parameters params;
+    params.imageRect  = mImageItem.boundingRect();
+    params.borderSize = mGetBorderSize();
+    params.use3D      = getCalibCoordDimension() == 0;
+    params.camera     = mExtrCalib.getCameraModel();
+
+    const auto &extrParams = mExtrBox.getExtrinsicParameters();
+    params.cameraPosition  = cv::Point3f(
+        -mUi->coord3DTransX->value() - extrParams.trans1,
+        -mUi->coord3DTransY->value() - extrParams.trans2,
+        -mUi->coord3DTransZ->value() - extrParams.trans3);
+
+    const auto camMat         = mIntr.getIntrinsicCameraParams();
+    params.useIntrinsicCenter = isCoordUseIntrinsicChecked();
+    params.principalPoint     = QPointF(camMat.getCx(), camMat.getCy());
+    params.altitude           = mUi->coordAltitude->value();
+    params.coordUnit          = mUi->coordUnit->value();
+
+    const auto borderTransform = QTransform::fromTranslate(-params.borderSize, -params.borderSize);
+    params.imgToWorld          = borderTransform * mCoordTransform.inverted();
+    return std::make_unique<WorldImageSnapshot>(std::move(params));
+}
+
 bool CoordinateSystemBox::getXml(const QDomElement &subSubElem)
 {
     if(subSubElem.tagName() == "EXTRINSIC_PARAMETERS")
@@ -110,6 +110,8 @@ public:
     QPointF getPosImage(QPointF pos, float height = 0.) const override;
     QPointF getPosReal(QPointF pos, double height = 0.) const override;
 
+    std::unique_ptr<WorldImageCorrespondence> snapshot() const override;
+
     bool getXml(const QDomElement &subSubElem);
     void setXml(QDomElement &subSubElem) const;
 
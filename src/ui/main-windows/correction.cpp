@@ -31,9 +31,29 @@
 #include <QFile>
 #include <QFrame>
 #include <QVector>
+#include <algorithm>
+#include <optional>
 #include <regex>
 #include <string>
 
+namespace
+{
+/// person (0-based) an equality check is reported against, taken from its message
+std::optional<size_t> mentionedPerson(const plausibility::FailedCheck &failedCheck)
+{
+    if(failedCheck.type != plausibility::CheckType::Equality)
+    {
+        return std::nullopt;
+    }
+    static const std::regex number("\\d+");
+    if(std::smatch match; std::regex_search(failedCheck.message, match, number))
+    {
+        return std::stoul(match[0].str()) - 1;
+    }
+    return std::nullopt;
+}
+} // namespace
+
 QVariant FailedChecksTableModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if(role == Qt::DisplayRole && orientation == Qt::Horizontal)
@@ -122,6 +142,7 @@ void FailedChecksTableModel::setFailedChecks(std::vector<plausibility::FailedChe
 
     mFailedChecks = failedChecks;
     std::sort(mFailedChecks.begin(), mFailedChecks.end());
+    indexMentions();
     QModelIndex topLeft     = index(0, 0);
     QModelIndex bottomRight = index(rowCount() - 1, columnCount() - 1);
 
@@ -141,6 +162,7 @@ bool FailedChecksTableModel::removeRows(int row, int count, const QModelIndex &p
     {
         mFailedChecks.erase(mFailedChecks.begin() + row);
     }
+    indexMentions();
 
     endRemoveRows();
     return true;
@@ -166,6 +188,109 @@ void FailedChecksTableModel::updateState(const QModelIndex &row, plausibility::C
     emit layoutChanged();
 }
 
+/**
+ * @brief Sets the status of several rows, only the status of these rows is updated in the views
+ */
+void FailedChecksTableModel::updateStates(const std::vector<int> &rows, plausibility::CheckStatus state)
+{
+    for(int row : rows)
+    {
+        mFailedChecks.at(row).status = state;
+        emit dataChanged(index(row, 2), index(row, 2), {Qt::BackgroundRole});
+    }
+}
+
+/**
+ * @brief Returns the rows of the failed checks of persons and of the failed equality checks mentioning them
+ *
+ * @param persons persons (0-based)
+ * @return sorted rows
+ */
+std::vector<int> FailedChecksTableModel::rowsConcerning(const std::vector<size_t> &persons) const
+{
+    std::vector<int> rows;
+    for(size_t person : persons)
+    {
+        // the rows of a person are contiguous, as the checks are sorted by person
+        auto first = std::lower_bound(
+            mFailedChecks.begin(),
+            mFailedChecks.end(),
+            person + 1,
+            [](const plausibility::FailedCheck &failedCheck, size_t pers) { return failedCheck.pers < pers; });
+        for(auto it = first; it != mFailedChecks.end() && it->pers == person + 1; ++it)
+        {
+            rows.push_back(static_cast<int>(it - mFailedChecks.begin()));
+        }
+
+        auto mention = std::lower_bound(mMentions.begin(), mMentions.end(), std::make_pair(person, 0));
+        for(; mention != mMentions.end() && mention->first == person; ++mention)
+        {
+            rows.push_back(mention->second);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    return rows;
+}
+
+/**
+ * @brief Removes the failed checks of deleted persons and renumbers the remaining ones in one pass
+ *
+ * The failed equality checks mentioning a deleted person are removed as well.
+ *
+ * @param persons deleted persons (0-based) in the numbering before the deletion, sorted
+ */
+void FailedChecksTableModel::removePersons(const std::vector<size_t> &persons)
+{
+    if(persons.empty())
+    {
+        return;
+    }
+    auto isDeleted = [&persons](size_t person) { return std::binary_search(persons.begin(), persons.end(), person); };
+    auto newIndex  = [&persons](size_t person)
+    { return person - (std::lower_bound(persons.begin(), persons.end(), person) - persons.begin()); };
+
+    emit layoutAboutToBeChanged();
+
+    mFailedChecks.erase(
+        std::remove_if(
+            mFailedChecks.begin(),
+            mFailedChecks.end(),
+            [&isDeleted](const plausibility::FailedCheck &failedCheck)
+            {
+                auto other = mentionedPerson(failedCheck);
+                return isDeleted(failedCheck.pers - 1) || (other && isDeleted(*other));
+            }),
+        mFailedChecks.end());
+
+    // renumbering keeps the order
+    for(plausibility::FailedCheck &failedCheck : mFailedChecks)
+    {
+        failedCheck.pers = newIndex(failedCheck.pers - 1) + 1;
+        if(auto other = mentionedPerson(failedCheck); other && newIndex(*other) != *other)
+        {
+            failedCheck.message = fmt::format("Trajectory is very close to Person {}!", newIndex(*other) + 1);
+        }
+    }
+    indexMentions();
+
+    emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
+    emit layoutChanged();
+}
+
+void FailedChecksTableModel::indexMentions()
+{
+    mMentions.clear();
+    for(size_t row = 0; row < mFailedChecks.size(); ++row)
+    {
+        if(auto other = mentionedPerson(mFailedChecks[row]))
+        {
+            mMentions.emplace_back(*other, static_cast<int>(row));
+        }
+    }
+    std::sort(mMentions.begin(), mMentions.end());
+}
+
 Correction::Correction(Petrack *petrack, const PersonStorage &personStorage, QWidget *parent) :
     QWidget(parent), mPetrack(petrack), mPersonStorage(personStorage), mUi(new Ui::Correction)
 {
@@ -193,6 +318,9 @@ Correction::Correction(Petrack *petrack, const PersonStorage &personStorage, QWi
     connect(&personStorage, &PersonStorage::deletedPersonFrameRange, this, &Correction::removePersonInFrameRange);
     connect(&personStorage, &PersonStorage::changedPerson, this, &Correction::changePersonState);
     connect(&personStorage, &PersonStorage::splitPersonAtFrame, this, &Correction::splitPerson);
+
+    mUpdateTimer.setSingleShot(true);
+    connect(&mUpdateTimer, &QTimer::timeout, this, &Correction::updateChangedPersons);
 }
 
 bool Correction::getTestEqualChecked() const
@@ -231,6 +359,15 @@ void Correction::setTestInsideChecked(bool testInside)
     mUi->chbInside->setChecked(testInside);
 }
 
+bool Correction::getLiveUpdateChecked() const
+{
+    return mUi->chbLiveUpdate->isChecked();
+}
+void Correction::setLiveUpdateChecked(bool liveUpdate)
+{
+    mUi->chbLiveUpdate->setChecked(liveUpdate);
+}
+
 void Correction::selectedRowChanged()
 {
     if(mUi->tblFailedChecks->selectionModel()->hasSelection())
@@ -294,25 +431,12 @@ void Correction::changePersonState(size_t index)
     {
         return;
     }
-
-    auto failedChecks = mTableModel->getFailedChecks();
-
-    for(auto &failedCheck : failedChecks)
-    {
-        bool person          = failedCheck.pers == (index + 1);
-        bool personMentioned = failedCheck.message.find(std::to_string(index + 1)) != std::string::npos &&
-                               failedCheck.type == plausibility::CheckType::Equality;
-
-        if(person || personMentioned)
-        {
-            failedCheck.status = plausibility::CheckStatus::Changed;
-        }
-    }
-    mTableModel->setFailedChecks(std::move(failedChecks));
+    scheduleUpdate(index);
 }
 
 void Correction::checkButtonClicked()
 {
+    applyDeletedPersons();
     std::vector<plausibility::FailedCheck> failedChecks;
 
     QProgressDialog progress("Check Plausibility", nullptr, 0, 400, mPetrack);
@@ -367,48 +491,60 @@ void Correction::checkButtonClicked()
 
     mTableModel->setFailedChecks(std::move(failedChecks));
     mChecksExecuted = true;
+    mChangedPersons.clear();
+    mDeletedPersons.clear();
+    mUpdateTimer.stop();
 }
 
+/**
+ * Collects the deleted persons; their rows are removed by mUpdateTimer, so deleting many
+ * persons at once (e.g. purge) only renumbers and relayouts the table once.
+ */
 void Correction::removePerson(size_t index)
 {
     if(!mChecksExecuted)
     {
         return;
     }
+    mDeletedPersons.push_back(index);
+    mUpdateTimer.start(0);
 
-    auto failedChecks = mTableModel->getFailedChecks();
-
-    // Delete every row where person == index + 1
-    failedChecks.erase(
-        std::remove_if(
-            failedChecks.begin(),
-            failedChecks.end(),
-            [index](const plausibility::FailedCheck &failedCheck) { return failedCheck.pers == (index + 1); }),
-        failedChecks.end());
-
-    // Update every row where person > index + 1 by decreasing person by one
-    for(plausibility::FailedCheck &failedCheck : failedChecks)
+    // The indices of the persons waiting for an update are shifted as well
+    std::set<size_t> changedPersons;
+    for(size_t changedPerson : mChangedPersons)
     {
-        if(failedCheck.pers > (index + 1))
+        if(changedPerson != index)
         {
-            failedCheck.pers--;
+            changedPersons.insert(changedPerson > index ? changedPerson - 1 : changedPerson);
         }
     }
+    mChangedPersons = std::move(changedPersons);
+}
 
-    // Delete all failed equality checks where the deleted person is mentioned
-    failedChecks.erase(
-        std::remove_if(
-            failedChecks.begin(),
-            failedChecks.end(),
-            [index](const plausibility::FailedCheck &failedCheck)
-            {
-                bool personMentioned = failedCheck.message.find(std::to_string(index + 1)) != std::string::npos;
-                bool checks          = failedCheck.type == plausibility::CheckType::Equality;
-                return personMentioned && checks;
-            }),
-        failedChecks.end());
-
-    mTableModel->setFailedChecks(std::move(failedChecks));
+/**
+ * Removes the rows of all persons deleted since the last call and renumbers the others.
+ *
+ * Has to be called before the table is compared to the person storage.
+ */
+void Correction::applyDeletedPersons()
+{
+    if(mDeletedPersons.empty())
+    {
+        return;
+    }
+    // convert to the indices before the first deletion
+    std::vector<size_t> deleted;
+    for(size_t index : mDeletedPersons)
+    {
+        auto it = deleted.begin();
+        for(; it != deleted.end() && *it <= index; ++it)
+        {
+            ++index;
+        }
+        deleted.insert(it, index);
+    }
+    mDeletedPersons.clear();
+    mTableModel->removePersons(deleted);
 }
 
 void Correction::removePersonInFrameRange(size_t index, int startFrame, int endFrame)
@@ -417,6 +553,12 @@ void Correction::removePersonInFrameRange(size_t index, int startFrame, int endF
     {
         return;
     }
+    applyDeletedPersons();
+    if(mUi->chbLiveUpdate->isChecked())
+    {
+        scheduleUpdate(index);
+        return;
+    }
 
     auto failedChecks = rerunChecks();
 
@@ -457,6 +599,12 @@ void Correction::splitPerson(size_t index, size_t newIndex, int frame)
     {
         return;
     }
+    if(mUi->chbLiveUpdate->isChecked())
+    {
+        // The checks of both parts are re-run by changePersonState, which is emitted afterwards
+        return;
+    }
+    applyDeletedPersons();
     auto failedChecks = rerunChecks();
 
     // Handle equality checks differently as they take too long to be re-run after each removal of a frame range
@@ -508,6 +656,113 @@ void Correction::splitPerson(size_t index, size_t newIndex, int frame)
     mTableModel->setFailedChecks(std::move(failedChecks));
 }
 
+void Correction::scheduleUpdate(size_t index)
+{
+    mChangedPersons.insert(index);
+    // zero timeout: runs once all signals of the current edit or tracking step are handled
+    mUpdateTimer.start(0);
+}
+
+/**
+ * Updates the rows of all persons changed since the last call.
+ *
+ * Without live update, their failed checks (and the failed equality checks of other persons
+ * mentioning them) are only marked as changed. With live update, the enabled checks are
+ * re-run for the changed persons only and replace their rows: a check which fails again
+ * keeps its status, except that resolved checks are marked as changed; checks which do not
+ * fail anymore are removed.
+ */
+void Correction::updateChangedPersons()
+{
+    if(mChecksExecuted)
+    {
+        applyDeletedPersons();
+    }
+    if(!mChecksExecuted || mChangedPersons.empty())
+    {
+        mChangedPersons.clear();
+        return;
+    }
+
+    std::vector<size_t> persons;
+    for(size_t person : mChangedPersons)
+    {
+        if(person < mPersonStorage.nbPersons())
+        {
+            persons.push_back(person);
+        }
+    }
+    mChangedPersons.clear();
+
+    auto isChanged = [&persons](size_t person) { return std::binary_search(persons.begin(), persons.end(), person); };
+    auto concernsChangedPerson = [&isChanged](const plausibility::FailedCheck &failedCheck)
+    {
+        auto other = mentionedPerson(failedCheck);
+        return isChanged(failedCheck.pers - 1) || (other && isChanged(*other));
+    };
+    if(!mUi->chbLiveUpdate->isChecked())
+    {
+        mTableModel->updateStates(mTableModel->rowsConcerning(persons), plausibility::CheckStatus::Changed);
+        return;
+    }
+    auto previousChecks = mTableModel->getFailedChecks();
+
+    std::vector<plausibility::FailedCheck> failedChecks;
+    if(mUi->chbLength->isChecked())
+    {
+        auto failedLengthChecks{plausibility::checkLength(mPersonStorage, persons, mUi->spbxMinFrameLength->value())};
+        failedChecks.insert(failedChecks.end(), failedLengthChecks.begin(), failedLengthChecks.end());
+    }
+
+    if(mUi->chbInside->isChecked())
+    {
+        auto failedInsideChecks{plausibility::checkInside(
+            mPersonStorage,
+            persons,
+            mPetrack->getImageFiltered().size(),
+            mPetrack->getImageBorderSize(),
+            mPetrack->getRecoRoiItem()->rect(),
+            mPetrack->getPlayer()->getFrameInNum(),
+            mPetrack->getPlayer()->getFrameOutNum(),
+            mUi->spbxInsideMargin->value())};
+        failedChecks.insert(failedChecks.end(), failedInsideChecks.begin(), failedInsideChecks.end());
+    }
+
+    if(mUi->chbVelocity->isChecked())
+    {
+        auto failedVelocityChecks{plausibility::checkVelocityVariation(mPersonStorage, persons)};
+        failedChecks.insert(failedChecks.end(), failedVelocityChecks.begin(), failedVelocityChecks.end());
+    }
+
+    if(mUi->chbEqual->isChecked())
+    {
+        auto failedEqualityChecks{
+            plausibility::checkEquality(mPersonStorage, persons, *mPetrack, mUi->spbxEqualityDistance->value())};
+        failedChecks.insert(failedChecks.end(), failedEqualityChecks.begin(), failedEqualityChecks.end());
+    }
+
+    auto affected = std::stable_partition(
+        previousChecks.begin(),
+        previousChecks.end(),
+        [&concernsChangedPerson](const plausibility::FailedCheck &failedCheck)
+        { return !concernsChangedPerson(failedCheck); });
+
+    for(auto &failedCheck : failedChecks)
+    {
+        auto previousCheck = std::find(affected, previousChecks.end(), failedCheck);
+        if(previousCheck != previousChecks.end())
+        {
+            failedCheck.status = previousCheck->status == plausibility::CheckStatus::Resolved ?
+                                     plausibility::CheckStatus::Changed :
+                                     previousCheck->status;
+        }
+    }
+
+    failedChecks.insert(
+        failedChecks.end(), std::make_move_iterator(previousChecks.begin()), std::make_move_iterator(affected));
+    mTableModel->setFailedChecks(std::move(failedChecks));
+}
+
 void Correction::clear()
 {
     auto success = mUi->tblFailedChecks->model()->removeRows(0, mUi->tblFailedChecks->model()->rowCount());
@@ -516,6 +771,9 @@ void Correction::clear()
         PWarning(this, "Correction", "Could not clear table.");
     }
     mChecksExecuted = false;
+    mChangedPersons.clear();
+    mDeletedPersons.clear();
+    mUpdateTimer.stop();
 }
 
 void Correction::setXml(QDomElement &elem) const
@@ -538,6 +796,10 @@ void Correction::setXml(QDomElement &elem) const
     insideElement.setAttribute("ENABLED", mUi->chbInside->isChecked());
     insideElement.setAttribute("MARGIN", mUi->spbxInsideMargin->value());
     elem.appendChild(insideElement);
+
+    auto liveUpdateElement = (elem.ownerDocument()).createElement("LIVE_UPDATE");
+    liveUpdateElement.setAttribute("ENABLED", mUi->chbLiveUpdate->isChecked());
+    elem.appendChild(liveUpdateElement);
 }
 
 bool Correction::getXml(const QDomElement &correctionElem)
@@ -563,6 +825,10 @@ bool Correction::getXml(const QDomElement &correctionElem)
             loadBoolValue(subElem, "ENABLED", mUi->chbInside);
             loadIntValue(subElem, "MARGIN", mUi->spbxInsideMargin);
         }
+        else if(subElem.tagName() == "LIVE_UPDATE")
+        {
+            loadBoolValue(subElem, "ENABLED", mUi->chbLiveUpdate);
+        }
         else
         {
             SPDLOG_WARN("Unknown CORRECTION tag: {}", subElem.tagName().toStdString());
@@ -23,7 +23,11 @@
 
 #include <QAbstractTableModel>
 #include <QDomElement>
+#include <QTimer>
 #include <QWidget>
+#include <set>
+#include <utility>
+#include <vector>
 
 namespace Ui
 {
@@ -34,7 +38,10 @@ class FailedChecksTableModel : public QAbstractTableModel
 {
     Q_OBJECT
 private:
-    std::vector<plausibility::FailedCheck> mFailedChecks;
+    std::vector<plausibility::FailedCheck> mFailedChecks; ///< sorted by person and frame
+    std::vector<std::pair<size_t, int>>    mMentions;     ///< (mentioned person, row) of the equality checks, sorted
+
+    void indexMentions();
 
 public:
     explicit FailedChecksTableModel(QObject *parent) : QAbstractTableModel(parent) {}
@@ -52,6 +59,10 @@ public:
     const plausibility::FailedCheck       &getFailedCheck(const QModelIndex &row);
 
     void updateState(const QModelIndex &row, plausibility::CheckStatus state);
+    void updateStates(const std::vector<int> &rows, plausibility::CheckStatus state);
+
+    std::vector<int> rowsConcerning(const std::vector<size_t> &persons) const;
+    void             removePersons(const std::vector<size_t> &persons);
 };
 
 
@@ -80,6 +91,9 @@ public:
     bool getTestInsideChecked() const;
     void setTestInsideChecked(bool testInside);
 
+    bool getLiveUpdateChecked() const;
+    void setLiveUpdateChecked(bool liveUpdate);
+
     void setXml(QDomElement &elem) const;
     bool getXml(const QDomElement &elem);
 
@@ -92,8 +106,13 @@ private:
     Ui::Correction         *mUi;
     FailedChecksTableModel *mTableModel;
     bool                    mChecksExecuted = false;
+    std::set<size_t>        mChangedPersons; ///< persons whose checks are re-run by mUpdateTimer
+    std::vector<size_t>     mDeletedPersons; ///< deleted persons not yet removed from the table, in order of deletion
+    QTimer                  mUpdateTimer;    ///< collects all changes of one edit or tracking step
 
     std::vector<plausibility::FailedCheck> rerunChecks();
+    void                                   scheduleUpdate(size_t index);
+    void                                   applyDeletedPersons();
 
 private slots:
     void selectedRowChanged();
@@ -104,6 +123,7 @@ private slots:
     void removePerson(size_t index);
     void removePersonInFrameRange(size_t index, int startFrame, int endFrame);
     void splitPerson(size_t, size_t newIndex, int frame);
+    void updateChangedPersons();
 };
 
 #endif // CORRECTION_H
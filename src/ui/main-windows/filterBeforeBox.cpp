@@ -67,6 +67,12 @@ void FilterBeforeBox::setBackgroundItem(BackgroundItem *item)
     mBgItem = item;
 }
 
+/// Petrack samples the frames of the sequence for the background model, which the box does not know
+void FilterBeforeBox::setSampleBackgroundCallback(std::function<void()> callback)
+{
+    mSampleBackgroundCallback = std::move(callback);
+}
+
 void FilterBeforeBox::setFilterSettings(const FilterSettings &settings)
 {
     mUi->filterBrightContrast->setChecked(settings.useBrightContrast);
@@ -122,6 +128,10 @@ bool FilterBeforeBox::getXmlSub(QDomElement &subSubElem)
         loadBoolValue(subSubElem, "SHOW", mUi->filterBgShow, false);
         loadBoolValue(subSubElem, "DELETE", mUi->filterBgDeleteTrj, true);
         loadIntValue(subSubElem, "DELETE_NUMBER", mUi->filterBgDeleteNumber, 3);
+        mBgFilter.setMethod(
+            readQString(subSubElem, "METHOD", "MOG2") == "KNN" ? BackgroundFilter::Method::KNN :
+                                                                 BackgroundFilter::Method::MOG2);
+        mBgFilter.setModelScale(readDouble(subSubElem, "MODEL_SCALE", 1.));
         // control still needs to read file
         return false;
     }
@@ -177,6 +187,8 @@ void FilterBeforeBox::setXml(QDomElement &subElem, QColor bgColor, const QString
     subSubElem.setAttribute("FILE", bgFilename);
     subSubElem.setAttribute("DELETE", mUi->filterBgDeleteTrj->isChecked());
     subSubElem.setAttribute("DELETE_NUMBER", mUi->filterBgDeleteNumber->value());
+    subSubElem.setAttribute("METHOD", mBgFilter.getMethod() == BackgroundFilter::Method::KNN ? "KNN" : "MOG2");
+    subSubElem.setAttribute("MODEL_SCALE", mBgFilter.getModelScale());
     subElem.appendChild(subSubElem);
 }
 
@@ -219,6 +231,7 @@ void FilterBeforeBox::toggleBackgroundUi(Qt::CheckState state)
         mUi->filterBgReset->setEnabled(true);
         mUi->filterBgSave->setEnabled(true);
         mUi->filterBgLoad->setEnabled(true);
+        mUi->filterBgSample->setEnabled(true);
         if(mShowBackgroundCache)
         {
             mUi->filterBgShow->setCheckState(Qt::Checked);
@@ -234,6 +247,7 @@ void FilterBeforeBox::toggleBackgroundUi(Qt::CheckState state)
         mUi->filterBgReset->setEnabled(false);
         mUi->filterBgSave->setEnabled(false);
         mUi->filterBgLoad->setEnabled(false);
+        mUi->filterBgSample->setEnabled(false);
         mShowBackgroundCache = mUi->filterBgShow->isChecked();
         mUi->filterBgShow->setCheckState(Qt::Unchecked);
         mUi->filterBgDeleteNumber->setEnabled(false);
@@ -379,3 +393,11 @@ void FilterBeforeBox::on_filterBgLoad_clicked()
     mBgFilter.load();
     mUpdateImageCallback();
 }
+
+void FilterBeforeBox::on_filterBgSample_clicked()
+{
+    if(mSampleBackgroundCallback)
+    {
+        mSampleBackgroundCallback();
+    }
+}
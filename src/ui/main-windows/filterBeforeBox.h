@@ -61,6 +61,7 @@ public:
     ~FilterBeforeBox() override;
 
     void setBackgroundItem(BackgroundItem *item);
+    void setSampleBackgroundCallback(std::function<void()> callback);
 
     int  getFilterBorderSize() const;
     void setFilterBorderSizeMin(int i);
@@ -89,6 +90,7 @@ private slots:
     void on_filterBgReset_clicked();
     void on_filterBgSave_clicked();
     void on_filterBgLoad_clicked();
+    void on_filterBgSample_clicked();
     void on_filterSwap_stateChanged(int i);
     void on_filterSwapH_stateChanged(int i);
     void on_filterSwapV_stateChanged(int i);
@@ -97,6 +99,7 @@ private:
     Ui::FilterBeforeBox  *mUi;
     bool                  mShowBackgroundCache;
     std::function<void()> mUpdateImageCallback;
+    std::function<void()> mSampleBackgroundCallback; ///< computes the background model from sampled frames
     BackgroundFilter     &mBgFilter;
     BrightContrastFilter &mBrightContrastFilter;
     BorderFilter         &mBorderFilter;
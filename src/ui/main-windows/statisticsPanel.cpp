@@ -0,0 +1,173 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "statisticsPanel.h"
+
+#include "animation.h"
+#include "personStorage.h"
+#include "petrack.h"
+
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QLabel>
+#include <QVBoxLayout>
+
+namespace
+{
+/// update interval of the panel in ms
+constexpr int UPDATE_INTERVAL = 500;
+} // namespace
+
+StatisticsPanel::StatisticsPanel(Petrack &petrack, QWidget *parent) :
+    QDockWidget(tr("Statistics"), parent), mPetrack(petrack)
+{
+    setObjectName("StatisticsPanel");
+
+    auto *content = new QWidget(this);
+    auto *layout  = new QVBoxLayout(content);
+
+    auto *stages       = new QGroupBox(tr("Time per frame"), content);
+    auto *stagesLayout = new QFormLayout(stages);
+    mFps               = addRow(stagesLayout, tr("Frames/s"));
+    mDecode            = addRow(stagesLayout, tr("Decode"));
+    mFilter            = addRow(stagesLayout, tr("Filter"));
+    mTrack             = addRow(stagesLayout, tr("Track"));
+    mRecognize         = addRow(stagesLayout, tr("Recognize"));
+    mRender            = addRow(stagesLayout, tr("Render"));
+    layout->addWidget(stages);
+
+    auto *queues       = new QGroupBox(tr("Queues"), content);
+    auto *queuesLayout = new QFormLayout(queues);
+    mQueued            = addRow(queuesLayout, tr("Decoded frames waiting"));
+    mDropped           = addRow(queuesLayout, tr("Dropped live frames"));
+    layout->addWidget(queues);
+
+    auto *persons       = new QGroupBox(tr("Persons"), content);
+    auto *personsLayout = new QFormLayout(persons);
+    mTracked            = addRow(personsLayout, tr("Tracked per frame"));
+    mRecognized         = addRow(personsLayout, tr("Recognized per frame"));
+    mPersons            = addRow(personsLayout, tr("Trajectories"));
+    layout->addWidget(persons);
+
+    auto *memory       = new QGroupBox(tr("Memory"), content);
+    auto *memoryLayout = new QFormLayout(memory);
+    for(const auto &[name, bytes] : mPetrack.getMemoryUsage())
+    {
+        mMemory.push_back(addRow(memoryLayout, name));
+    }
+    layout->addWidget(memory);
+
+    layout->addStretch();
+    setWidget(content);
+
+    mTimer.setInterval(UPDATE_INTERVAL);
+    connect(&mTimer, &QTimer::timeout, this, &StatisticsPanel::updateStatistics);
+}
+
+/**
+ * @brief Returns the time per frame of a stage, which took seconds for frames frames
+ */
+QString StatisticsPanel::formatStage(double seconds, long long frames)
+{
+    if(frames <= 0)
+    {
+        return "-";
+    }
+    return QString("%1 ms").arg(1000. * seconds / static_cast<double>(frames), 0, 'f', 1);
+}
+
+/// Returns bytes in B, kB, MB or GB
+QString StatisticsPanel::formatBytes(std::size_t bytes)
+{
+    const QStringList units{"B", "kB", "MB", "GB"};
+    double            value = static_cast<double>(bytes);
+    int               unit  = 0;
+    while(value >= 1024. && unit < units.size() - 1)
+    {
+        value /= 1024.;
+        ++unit;
+    }
+    return QString("%1 %2").arg(value, 0, 'f', unit == 0 ? 0 : 1).arg(units[unit]);
+}
+
+void StatisticsPanel::showEvent(QShowEvent *event)
+{
+    QDockWidget::showEvent(event);
+    mLast = mPetrack.getPipelineStatistics();
+    mClock.start();
+    updateStatistics();
+    mTimer.start();
+}
+
+void StatisticsPanel::hideEvent(QHideEvent *event)
+{
+    mTimer.stop();
+    QDockWidget::hideEvent(event);
+}
+
+QLabel *StatisticsPanel::addRow(QFormLayout *layout, const QString &name)
+{
+    auto *value = new QLabel("-", layout->parentWidget());
+    value->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    layout->addRow(name, value);
+    return value;
+}
+
+/**
+ * @brief Shows the statistics of the frames processed since the last update
+ */
+void StatisticsPanel::updateStatistics()
+{
+    const PipelineStatistics &current = mPetrack.getPipelineStatistics();
+    if(current.frames < mLast.frames)
+    {
+        // the statistics were reset, e.g. by a new tracking run
+        mLast = PipelineStatistics();
+    }
+    const PipelineStatistics interval = current.since(mLast);
+    const double             seconds  = mClock.restart() / 1000.;
+    mLast                             = current;
+
+    mFps->setText(seconds > 0 ? QString::number(interval.frames / seconds, 'f', 1) : QString("-"));
+    mDecode->setText(formatStage(interval.decode, interval.frames));
+    mFilter->setText(formatStage(interval.filter, interval.frames));
+    mTrack->setText(formatStage(interval.track, interval.frames));
+    mRecognize->setText(formatStage(interval.recognize, interval.frames));
+    mRender->setText(formatStage(interval.render, interval.frames));
+
+    Animation &animation = *mPetrack.getAnimation();
+    mQueued->setText(QString::number(animation.getQueuedFrames()));
+    mDropped->setText(
+        animation.isCameraLiveStream() ? QString::number(animation.getDroppedLiveFrames()) : QString("-"));
+
+    const auto perFrame = [&interval](long long count)
+    {
+        return interval.frames > 0 ? QString::number(static_cast<double>(count) / interval.frames, 'f', 1) :
+                                     QString("-");
+    };
+    const PersonStorage &storage = mPetrack.getPersonStorage();
+    mTracked->setText(perFrame(interval.tracked));
+    mRecognized->setText(perFrame(interval.recognized));
+    mPersons->setText(QString::number(storage.nbPersons()));
+
+    const MemoryUsage memory = mPetrack.getMemoryUsage();
+    for(std::size_t i = 0; i < memory.size() && i < mMemory.size(); ++i)
+    {
+        mMemory[i]->setText(formatBytes(memory[i].second));
+    }
+}
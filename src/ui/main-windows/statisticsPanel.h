@@ -0,0 +1,81 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATISTICSPANEL_H
+#define STATISTICSPANEL_H
+
+#include "pipelineStatistics.h"
+
+#include <QDockWidget>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <cstddef>
+#include <vector>
+
+class Petrack;
+class QFormLayout;
+class QLabel;
+
+/**
+ * @brief Dock showing where the time of the processing goes while playing or tracking
+ *
+ * Twice per second, the panel shows the time per frame of every stage since the last
+ * update (from Petrack::getPipelineStatistics()), the decoded frames waiting to be
+ * processed, the tracked and recognized persons per frame and the memory used per
+ * subsystem (from Petrack::getMemoryUsage()). It is only updated while visible.
+ */
+class StatisticsPanel : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StatisticsPanel(Petrack &petrack, QWidget *parent = nullptr);
+
+    static QString formatStage(double seconds, long long frames);
+    static QString formatBytes(std::size_t bytes);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void updateStatistics();
+
+private:
+    QLabel *addRow(QFormLayout *layout, const QString &name);
+
+    Petrack           &mPetrack;
+    QTimer             mTimer;
+    QElapsedTimer      mClock;
+    PipelineStatistics mLast; ///< statistics at the last update
+
+    QLabel *mFps;
+    QLabel *mDecode;
+    QLabel *mFilter;
+    QLabel *mTrack;
+    QLabel *mRecognize;
+    QLabel *mRender;
+    QLabel *mQueued;
+    QLabel *mDropped;
+    QLabel *mTracked;
+    QLabel *mRecognized;
+    QLabel *mPersons;
+    std::vector<QLabel *> mMemory; ///< one row per entry of Petrack::getMemoryUsage()
+};
+
+#endif // STATISTICSPANEL_H
@@ -0,0 +1,176 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "timelineStrip.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPainterPath>
+#include <algorithm>
+#include <cmath>
+
+TimelineStrip::TimelineStrip(QWidget *parent) : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    setMinimumWidth(100);
+    setToolTip("Thumbnails of the video and number of persons per frame; click to go to the frame");
+}
+
+QSize TimelineStrip::sizeHint() const
+{
+    return QSize(400, ThumbnailStrip::HEIGHT + 4);
+}
+
+/// Sets the frames shown from the left to the right border
+void TimelineStrip::setRange(int first, int last)
+{
+    if(first == mFirst && last == mLast)
+    {
+        return;
+    }
+    mFirst = first;
+    mLast  = std::max(first, last);
+    mCounts.clear();
+    update();
+}
+
+void TimelineStrip::setCurrentFrame(int frame)
+{
+    if(frame != mCurrent)
+    {
+        mCurrent = frame;
+        update();
+    }
+}
+
+/// Sets the thumbnails in ascending order of their frames
+void TimelineStrip::setThumbnails(std::vector<Thumbnail> thumbnails)
+{
+    mThumbnails = std::move(thumbnails);
+    update();
+}
+
+/// Sets the number of persons at the frames returned by countFrames()
+void TimelineStrip::setCounts(std::vector<int> counts)
+{
+    if(counts != mCounts)
+    {
+        mCounts = std::move(counts);
+        update();
+    }
+}
+
+/// Returns the frames the persons should be counted at, spread evenly over the range
+std::vector<int> TimelineStrip::countFrames() const
+{
+    const int        samples = std::min(COUNT_SAMPLES, mLast - mFirst + 1);
+    std::vector<int> frames(samples);
+    for(int k = 0; k < samples; ++k)
+    {
+        frames[k] = mFirst + static_cast<int>(static_cast<long long>(k) * (mLast - mFirst) / std::max(1, samples - 1));
+    }
+    return frames;
+}
+
+int TimelineStrip::frameAt(int x) const
+{
+    const int frame = mFirst + static_cast<int>(std::lround(static_cast<double>(x) / std::max(1, width() - 1) *
+                                                             (mLast - mFirst)));
+    return std::clamp(frame, mFirst, mLast);
+}
+
+double TimelineStrip::xAt(double frame) const
+{
+    return mLast > mFirst ? (frame - mFirst) / (mLast - mFirst) * (width() - 1) : 0.;
+}
+
+void TimelineStrip::paintEvent(QPaintEvent * /*event*/)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+
+    // thumbnails side by side, each showing the sampled frame nearest to its center
+    if(!mThumbnails.empty())
+    {
+        const int thumbWidth = std::max(1, mThumbnails.front().image.width());
+        const int top        = (height() - ThumbnailStrip::HEIGHT) / 2;
+        for(int x = 0; x < width(); x += thumbWidth)
+        {
+            const int  frame = frameAt(x + thumbWidth / 2);
+            const auto next  = std::lower_bound(
+                mThumbnails.begin(),
+                mThumbnails.end(),
+                frame,
+                [](const Thumbnail &thumbnail, int f) { return thumbnail.frame < f; });
+            auto nearest = next == mThumbnails.end() ? next - 1 : next;
+            if(next != mThumbnails.begin() && next != mThumbnails.end() &&
+               frame - (next - 1)->frame < next->frame - frame)
+            {
+                nearest = next - 1;
+            }
+            painter.drawImage(x, top, nearest->image);
+        }
+    }
+
+    // sparkline of the number of persons
+    const int maxCount = mCounts.empty() ? 0 : *std::max_element(mCounts.begin(), mCounts.end());
+    if(maxCount > 0)
+    {
+        const auto   frames = countFrames();
+        const double scale  = (height() - 4.) / maxCount;
+        QPainterPath path;
+        for(size_t k = 0; k < mCounts.size() && k < frames.size(); ++k)
+        {
+            const QPointF point(xAt(frames[k]), height() - 2. - mCounts[k] * scale);
+            if(k == 0)
+            {
+                path.moveTo(point);
+            }
+            else
+            {
+                path.lineTo(point);
+            }
+        }
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(QColor(255, 255, 0, 220), 1.5));
+        painter.drawPath(path);
+        painter.setPen(Qt::yellow);
+        painter.drawText(rect().adjusted(2, 0, -2, 0), Qt::AlignRight | Qt::AlignTop, QString::number(maxCount));
+    }
+
+    // current frame
+    painter.setPen(QPen(Qt::red, 2));
+    const double x = xAt(mCurrent);
+    painter.drawLine(QPointF(x, 0), QPointF(x, height()));
+}
+
+void TimelineStrip::mousePressEvent(QMouseEvent *event)
+{
+    if(event->button() == Qt::LeftButton)
+    {
+        emit frameSelected(frameAt(event->pos().x()));
+    }
+}
+
+void TimelineStrip::mouseMoveEvent(QMouseEvent *event)
+{
+    if(event->buttons() & Qt::LeftButton)
+    {
+        emit frameSelected(frameAt(event->pos().x()));
+    }
+}
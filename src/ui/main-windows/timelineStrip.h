@@ -0,0 +1,74 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMELINESTRIP_H
+#define TIMELINESTRIP_H
+
+#include "thumbnailStrip.h"
+
+#include <QWidget>
+#include <vector>
+
+/**
+ * @brief Timeline of the player showing thumbnails and the number of persons per frame
+ *
+ * The strip shows the thumbnails of the video (from ThumbnailStrip) side by side over
+ * the frames between in and out frame. On top, a sparkline shows the number of persons
+ * with a trajectory at the frames. Clicking or dragging selects the frame under the
+ * mouse, so events and gaps of the tracking can be found without decoding full frames.
+ */
+class TimelineStrip : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int COUNT_SAMPLES = 300; ///< frames the persons are counted at
+
+    explicit TimelineStrip(QWidget *parent = nullptr);
+
+    void setRange(int first, int last);
+    int  getFirstFrame() const { return mFirst; }
+    int  getLastFrame() const { return mLast; }
+    void setCurrentFrame(int frame);
+    void setThumbnails(std::vector<Thumbnail> thumbnails);
+    void setCounts(std::vector<int> counts);
+
+    std::vector<int> countFrames() const;
+
+    QSize sizeHint() const override;
+
+signals:
+    void frameSelected(int frame);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    int    frameAt(int x) const;
+    double xAt(double frame) const;
+
+    int                    mFirst   = 0;
+    int                    mLast    = 0;
+    int                    mCurrent = 0;
+    std::vector<Thumbnail> mThumbnails;
+    std::vector<int>       mCounts; ///< persons at the frames of countFrames()
+};
+
+#endif // TIMELINESTRIP_H
@@ -62,26 +62,23 @@ void AnnotationGroupItem::paint(QPainter *painter, const QStyleOptionGraphicsIte
     pen.setColor(Qt::black);
     pen.setBrush(brush);
 
-    const int currentFrame = mAnimation.getCurrentFrameNum();
+    const int          currentFrame = mAnimation.getCurrentFrameNum();
+    const unsigned int radius       = mGroupManager.getVisualizationRadius();
 
-    for(size_t i = 0; i < mPersonStorage.nbPersons(); i++)
+    // only the trajectories assigned to a group; unassigned ones would be drawn transparent anyway
+    for(const auto &group : mGroupManager.getGroups())
     {
-        const auto &groups = mPersonStorage.getGroupList(i);
+        brush.setColor(group.color);
+        pen.setBrush(brush);
+        pen.setColor(group.color);
+        painter->setPen(pen);
+        painter->setBrush(brush);
 
-        if(groups.contains(currentFrame))
+        for(const size_t i : mGroupManager.getTrajectoriesOfGroupAtFrame(group.id, currentFrame))
         {
             const auto &trajectory = mPersonStorage.at(i);
             if(trajectory.trackPointExist(currentFrame))
             {
-                const auto   group = mGroupManager.getGroup(groups.getValue(currentFrame));
-                const QColor color = group.color;
-
-                brush.setColor(color);
-                pen.setBrush(brush);
-                pen.setColor(color);
-                unsigned int radius = mGroupManager.getVisualizationRadius();
-                painter->setPen(pen);
-                painter->setBrush(brush);
                 painter->drawEllipse(trajectory.trackPointAt(currentFrame).toQPointF(), radius, radius);
             }
         }
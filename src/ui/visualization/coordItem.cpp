@@ -178,6 +178,54 @@ void CoordItem::updateData()
 }
 
 void CoordItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*option*/, QWidget * /*widget*/)
+{
+    // the points are only projected again, if the calibration or the coordinate system changed
+    mCache.paint(painter, cacheKey(), [this](QPainter *recorder) { drawOverlay(recorder); });
+}
+
+/**
+ * @brief Returns everything the painting of the calibration points and the axes depends on
+ */
+PaintCache::Key CoordItem::cacheKey() const
+{
+    const auto swap  = mCoordSys->getSwap3D();
+    const auto trans = mCoordSys->getCoordTrans3D();
+
+    PaintCache::Key key{
+        mCoordSys->getCalibExtrCalibPointsShow() ? 1. : 0.,
+        mCoordSys->getCalibCoordShow() ? 1. : 0.,
+        static_cast<double>(mCoordSys->getCalibCoordDimension()),
+        static_cast<double>(mCoordSys->getCoord3DAxeLen()),
+        mControlWidget->isTrackNumberBoldChecked() ? 1. : 0.,
+        static_cast<double>(mControlWidget->getTrackNumberSize()),
+        swap.x ? -1. : 1.,
+        swap.y ? -1. : 1.,
+        swap.z ? -1. : 1.,
+        trans.x(),
+        trans.y(),
+        trans.z()};
+
+    const auto projection = extCalib->getProjectionState();
+    key.insert(key.end(), projection.begin(), projection.end());
+    for(const auto &axis : {x3D, y3D, z3D})
+    {
+        key.insert(key.end(), {axis.x, axis.y, axis.z});
+    }
+    for(const auto &point : extCalib->get2DList())
+    {
+        key.insert(key.end(), {point.x, point.y});
+    }
+    for(const auto &point : extCalib->get3DList())
+    {
+        key.insert(key.end(), {point.x, point.y, point.z});
+    }
+    return key;
+}
+
+/**
+ * @brief Draws the calibration points and the coordinate system
+ */
+void CoordItem::drawOverlay(QPainter *painter)
 {
     ////////////////////////////////
     // Drawing Calibration Points //
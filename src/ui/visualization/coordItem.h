@@ -19,6 +19,8 @@
 #ifndef COORDITEM_H
 #define COORDITEM_H
 
+#include "paintCache.h"
+
 #include <QGraphicsItem>
 #include <QtWidgets>
 #include <opencv2/core/types.hpp>
@@ -41,6 +43,7 @@ private:
     float                mouse_x, mouse_y;
     int                  coordTrans_x, coordTrans_y;
     int                  coordDimension;
+    PaintCache           mCache; ///< projected calibration points and axes
 
 public:
     inline void setCoordDimension(int dim) { this->coordDimension = dim; }
@@ -61,6 +64,10 @@ public:
 private slots:
     // Update the transformation matrix
     void updateData();
+
+private:
+    PaintCache::Key cacheKey() const;
+    void            drawOverlay(QPainter *painter);
 };
 
 #endif
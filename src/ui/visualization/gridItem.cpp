@@ -322,6 +322,47 @@ void GridItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*optio
         setFlag(ItemIsMovable, false);
     }
 
+    // the grid is only projected again, if the calibration or the grid changed
+    mCache.paint(painter, cacheKey(), [this](QPainter *recorder) { drawOverlay(recorder); });
+}
+
+/**
+ * @brief Returns everything the painting of the grid and the vanishing points depends on
+ */
+PaintCache::Key GridItem::cacheKey() const
+{
+    const QImage *img = mMainWindow->getImage();
+
+    PaintCache::Key key{
+        img ? 1. : 0.,
+        img ? static_cast<double>(img->width()) : mMainWindow->getScene()->width(),
+        img ? static_cast<double>(img->height()) : mMainWindow->getScene()->height(),
+        static_cast<double>(mMainWindow->getImageBorderSize()),
+        mGridBox->isShow() ? 1. : 0.,
+        mCoordSys->getCalibExtrVanishPointsShow() ? 1. : 0.};
+
+    const auto projection = mExtrCalib->getProjectionState();
+    key.insert(key.end(), projection.begin(), projection.end());
+
+    const auto &swap       = mCoordSys->getSwap3D();
+    const auto  coordTrans = mCoordSys->getCoordTrans3D();
+    key.insert(key.end(), {swap.x ? -1. : 1., swap.y ? -1. : 1., coordTrans.x(), coordTrans.y(), coordTrans.z()});
+
+    std::visit(
+        overload{
+            [&](const Grid2D &grid)
+            { key.insert(key.end(), {2., grid.trans.x(), grid.trans.y(), 1. * grid.angle, 1. * grid.scale}); },
+            [&](const Grid3D &grid)
+            { key.insert(key.end(), {3., grid.trans.x(), grid.trans.y(), grid.trans.z(), 1. * grid.resolution}); }},
+        mGridBox->getGridParameters());
+    return key;
+}
+
+/**
+ * @brief Draws the vanishing points and the grid
+ */
+void GridItem::drawOverlay(QPainter *painter)
+{
     // confirmation prompt if the vanish points are inside the image
     bool        vanishPointYIsInsideImage = false;
     bool        vanishPointXIsInsideImage = false;
@@ -26,6 +26,7 @@ struct Grid2D;
 struct Grid3D;
 
 #include "extrCalibration.h"
+#include "paintCache.h"
 
 #include <QGraphicsItem>
 #include <utility>
@@ -41,6 +42,7 @@ private:
     float                mMouseX, mMouseY;
     int                  mGridTransX, mGridTransY;
     int                  mGridDimension;
+    PaintCache           mCache; ///< projected grid and vanishing points
 
 public:
     inline void setGridDimension(int gDimension) { this->mGridDimension = gDimension; }
@@ -53,6 +55,9 @@ public:
     void   paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
 
 private:
+    PaintCache::Key cacheKey() const;
+    void            drawOverlay(QPainter *painter);
+
     void draw2DGrid(QPainter *painter, const Grid2D &params, int imageHeight, int imageWidth, int borderSize);
     void draw3DGrid(
         QPainter     *painter,
@@ -23,10 +23,16 @@
 #include "importHelper.h"
 #include "logger.h"
 #include "moCapPerson.h"
+#include "pMessageBox.h"
+#include "sessionSnapshot.h"
 
 #include <QDomElement>
 #include <QMessageBox>
+#include <QtConcurrent>
+#include <limits>
 #include <opencv2/opencv.hpp>
+#include <utility>
+#include <variant>
 
 
 bool operator==(const SegmentRenderData &lhs, const SegmentRenderData &rhs)
@@ -38,130 +44,112 @@ bool operator==(const SegmentRenderData &lhs, const SegmentRenderData &rhs)
 /**
  * @brief Transforms the skeleton of a given Person into SegmentRenderData
  *
- * This function takes a person and a timepoint (given as frame and framerate)
+ * This function takes a person and a timepoint (in seconds of the video)
  * as input, and transforms the skeleton of the person at the given timepoint
  * into a list of lines (and one arrow for the head direction) to be drawn.
  *
  * If there is no sample for the given timepoint, it is inerpolated. Never
- * extrapolated.
+ * extrapolated. The bones are read from the flattened samples of the person
+ * and all points are projected at once.
  *
  * @param [in]person Person whose skeleton to transform into SegmentRenderDAta
- * @param [in]framerate Framerate of the video (NOT the mocap-recording)
- * @param [in]currentFrame current frame of the video
+ * @param [in]currentTime time of the current frame since the start of the video in seconds
  * @param [out]renderData array of SegmentRenderData, to which to append the result
  */
 void MoCapController::transformPersonSkeleton(
     const MoCapPerson              &person,
-    double                          framerate,
-    int                             currentFrame,
+    double                          currentTime,
     std::vector<SegmentRenderData> &renderData) const
 {
-    double currentTime = currentFrame / framerate;
     double sampleIndex = person.getSampleIndex(currentTime);
     bool   hasPre      = person.hasSample(std::floor(sampleIndex));
     bool   hasPost     = person.hasSample(std::ceil(sampleIndex));
 
+    // called for every shown frame, so only logged for debugging
     if(!hasPre && !hasPost)
     {
         return;
     }
     else if(!hasPre)
     {
-        SPDLOG_INFO("Start of XSens recording reached for file '{}'", person.getFilename());
+        SPDLOG_DEBUG("Start of XSens recording reached for file '{}'", person.getFilename());
         return;
     }
     else if(!hasPost)
     {
-        SPDLOG_INFO("End of XSens recording reached for file '{}'", person.getFilename());
+        SPDLOG_DEBUG("End of XSens recording reached for file '{}'", person.getFilename());
 
         return;
     }
 
-    const SkeletonTree &preSample  = person.getSample(std::floor(sampleIndex));
-    const SkeletonTree &postSample = person.getSample(std::ceil(sampleIndex));
-    double              intpart    = 0.0;
-    double              weight     = modf(sampleIndex, &intpart);
-
-    const auto prePairs  = preSample.getLines();
-    const auto postPairs = postSample.getLines();
-
-    const std::vector<SkeletonLine> interpolatedPairs = interpolate(prePairs, postPairs, weight);
-
-    std::vector<std::pair<cv::Point2f, cv::Point2f>> projectedPairs;
-    projectedPairs.reserve(prePairs.size());
-
-    SkeletonLine neckToHead;
-    Vec3F        neckToHead3D;
+    std::vector<cv::Point3f> preJoints;
+    std::vector<cv::Point3f> postJoints;
+    cv::Vec3f                preHeadDir;
+    cv::Vec3f                postHeadDir;
+    person.getSampleBones(std::floor(sampleIndex), preJoints, preHeadDir);
+    person.getSampleBones(std::ceil(sampleIndex), postJoints, postHeadDir);
+    double intpart = 0.0;
+    double weight  = modf(sampleIndex, &intpart);
+
+    // interpolated start and end of every bone, followed by the base and the head of the arrow
+    std::vector<cv::Point3f> joints;
+    joints.reserve(preJoints.size() + 2);
+    for(size_t i = 0; i < preJoints.size(); ++i)
+    {
+        joints.push_back(preJoints[i] * (1 - weight) + postJoints[i] * weight);
+    }
 
-    for(const auto &pair : interpolatedPairs)
+    const int neckToHead = person.getNeckToHeadBone();
+    if(neckToHead >= 0)
     {
-        projectedPairs.emplace_back(mExtrCalib.getImagePoint(pair.start), mExtrCalib.getImagePoint(pair.end));
-        if(pair.start_id == 19 && pair.end_id == 2)
-        {
-            neckToHead   = pair;
-            neckToHead3D = Vec3F(pair.end - pair.start);
-        }
+        const cv::Point3f neckStart = joints[2 * neckToHead];
+        const cv::Point3f neckEnd   = joints[2 * neckToHead + 1];
+
+        // Head Direction Arrow
+        cv::Vec3f headDir_v = preHeadDir * (1 - weight) + postHeadDir * weight;
+        headDir_v           = cv::normalize(headDir_v);
+        cv::Point3f headDir = cv::Point3f(headDir_v);
+        headDir *= Vec3F(neckEnd - neckStart).length();
+
+        // Start arrow at 75% the way from C7 to top of head
+        auto arrowBase = neckStart + (neckEnd - neckStart) * 0.75;
+        joints.push_back(arrowBase);
+        joints.push_back(arrowBase + headDir);
     }
 
-    for(const auto &pair : projectedPairs)
+    const std::vector<cv::Point2f> projected = mExtrCalib.getImagePoint(joints);
+    for(size_t i = 0; i + 1 < projected.size(); i += 2)
     {
         renderData.push_back(
-            {/*.mLine =*/QLine(pair.first.x, pair.first.y, pair.second.x, pair.second.y),
+            {/*.mLine =*/QLine(projected[i].x, projected[i].y, projected[i + 1].x, projected[i + 1].y),
              /*.mColor =*/mColor,
              /*.mThickness =*/mThickness,
-             /*.mDirected =*/false});
+             /*.mDirected =*/i >= preJoints.size()});
     }
-
-    // Head Direction Arrow
-    cv::Vec3f headDir_v = preSample.getHeadDir() * (1 - weight) + postSample.getHeadDir() * weight;
-    headDir_v           = cv::normalize(headDir_v);
-    cv::Point3f headDir = cv::Point3f(headDir_v);
-    headDir *= neckToHead3D.length();
-
-    // Start arrow at 75% the way from C7 to top of head
-    auto        arrowBase   = neckToHead.start + (neckToHead.end - neckToHead.start) * 0.75;
-    cv::Point2f arrowHead   = mExtrCalib.getImagePoint(arrowBase + headDir);
-    auto        arrowBase2D = mExtrCalib.getImagePoint(arrowBase);
-
-    renderData.push_back(
-        {/*.mLine =*/QLine(arrowBase2D.x, arrowBase2D.y, arrowHead.x, arrowHead.y),
-         /*.mColor =*/mColor,
-         /*.mThickness =*/mThickness,
-         /*.mDirected =*/true});
 }
 
-std::vector<SegmentRenderData> MoCapController::getRenderData(int currentFrame, double framerate) const
+/**
+ * @brief Returns the skeletons of all visible persons at currentTime (in seconds of the video)
+ *
+ * With a variable frame rate the time of a frame is taken from Animation::getFrameTime().
+ */
+std::vector<SegmentRenderData> MoCapController::getRenderData(double currentTime) const
 {
     std::vector<SegmentRenderData> renderData;
     for(const auto &person : mStorage.getPersons())
     {
         if(person.isVisible())
         {
-            transformPersonSkeleton(person, framerate, currentFrame, renderData);
+            transformPersonSkeleton(person, currentTime, renderData);
         }
     }
     return renderData;
 }
 
-std::vector<SkeletonLine> MoCapController::interpolate(
-    const std::vector<SkeletonLine> &prePairs,
-    const std::vector<SkeletonLine> &postPairs,
-    double                           weight)
+/// Returns the skeletons at currentFrame of a video with constant framerate
+std::vector<SegmentRenderData> MoCapController::getRenderData(int currentFrame, double framerate) const
 {
-    // Needs: prePairs.size() == postPairs.size()
-    // Needs: prePair and postPair be EXACTLY one sample away from each other
-    std::vector<SkeletonLine> interpolatedPairs;
-    interpolatedPairs.reserve(prePairs.size());
-
-    for(size_t i = 0; i < prePairs.size(); ++i)
-    {
-        interpolatedPairs.push_back(
-            {/*.start =*/prePairs[i].start * (1 - weight) + postPairs[i].start * weight,
-             /*.start_id =*/prePairs[i].start_id,
-             /*.end =*/prePairs[i].end * (1 - weight) + postPairs[i].end * weight,
-             /*.end_id =*/prePairs[i].end_id});
-    }
-    return interpolatedPairs;
+    return getRenderData(currentFrame / framerate);
 }
 
 /**
@@ -249,13 +237,13 @@ std::vector<MoCapPersonMetadata> MoCapController::getAllMoCapPersonMetadata() co
 /**
  * @brief Reads those MoCapFiles whose new MoCapMetadata is different from the saved (and already read) Metadata.
  *
- * This method deletes every person from the storage whose metadata does not occur in the newMetadata and calls
- * the IO::readMoCapC3D-method for every new Metadata.
+ * This method deletes every person from the storage whose metadata does not occur in the newMetadata and
+ * loads the files of every new Metadata in parallel.
  */
 void MoCapController::readMoCapFiles(const std::vector<MoCapPersonMetadata> &newMetadata)
 {
     std::vector<MoCapPerson> &persons    = mStorage.getPersons();
-    auto                      unselected = [&](MoCapPerson person)
+    auto                      unselected = [&](const MoCapPerson &person)
     {
         return std::find_if(
                    newMetadata.cbegin(),
@@ -265,6 +253,7 @@ void MoCapController::readMoCapFiles(const std::vector<MoCapPersonMetadata> &new
     };
     persons.erase(std::remove_if(persons.begin(), persons.end(), unselected), persons.end());
     std::vector<MoCapPersonMetadata> currentMetadata = getAllMoCapPersonMetadata();
+    std::vector<MoCapPersonMetadata> toLoad;
     for(const MoCapPersonMetadata &md : newMetadata)
     {
         const auto isCurrentMD = [&md](const MoCapPersonMetadata &lhs) { return readsTheSame(lhs, md); };
@@ -272,9 +261,104 @@ void MoCapController::readMoCapFiles(const std::vector<MoCapPersonMetadata> &new
             std::find_if(currentMetadata.cbegin(), currentMetadata.cend(), isCurrentMD) == currentMetadata.cend();
         if(isNewMd)
         {
-            IO::readMoCapC3D(mStorage, md);
+            toLoad.push_back(md);
+        }
+    }
+
+    for(auto &person : loadPersons(toLoad, mVideoDuration))
+    {
+        if(person)
+        {
+            mStorage.addPerson(std::move(*person));
+        }
+    }
+}
+
+/**
+ * @brief Sets the duration of the video the MoCap data is shown on
+ *
+ * Only the samples overlapping the video are stored, when a file is read. Persons which miss samples for
+ * the new duration are reloaded.
+ *
+ * @param duration duration in seconds; -1 if unknown, then all samples are stored
+ */
+void MoCapController::setVideoDuration(double duration)
+{
+    mVideoDuration = duration;
+    reloadMissingSamples();
+}
+
+/**
+ * @brief Reloads the persons which miss samples shown in the video, e.g. after their time offset changed
+ *
+ * The whole recording is reloaded, so further changes of the offset do not read the file again.
+ */
+void MoCapController::reloadMissingSamples()
+{
+    constexpr double                 infinity = std::numeric_limits<double>::infinity();
+    const double                     start    = mVideoDuration < 0 ? -infinity : 0;
+    const double                     end      = mVideoDuration < 0 ? infinity : mVideoDuration;
+    std::vector<MoCapPerson *>       incomplete;
+    std::vector<MoCapPersonMetadata> metadata;
+    for(MoCapPerson &person : mStorage.getPersons())
+    {
+        if(!person.storesSamplesFor(start, end))
+        {
+            incomplete.push_back(&person);
+            metadata.push_back(person.getMetadata());
+        }
+    }
+
+    auto reloaded = loadPersons(metadata, -1);
+    for(size_t i = 0; i < reloaded.size(); ++i)
+    {
+        if(reloaded[i])
+        {
+            *incomplete[i] = std::move(*reloaded[i]);
+        }
+    }
+}
+
+/**
+ * @brief Loads the c3d files of the given metadata in parallel
+ *
+ * Persons in the session snapshot (see setSnapshot()) are taken from it.
+ * Errors are shown to the user after all files are loaded.
+ *
+ * @param metadata metadata of the persons to load
+ * @param videoDuration duration of the video in seconds; -1 to store all samples
+ * @return the loaded persons in the order of metadata; empty if the file could not be loaded
+ */
+std::vector<std::optional<MoCapPerson>> MoCapController::loadPersons(
+    const std::vector<MoCapPersonMetadata> &metadata,
+    double                                  videoDuration) const
+{
+    std::vector<std::optional<MoCapPerson>> persons(metadata.size());
+
+    std::vector<std::pair<size_t, QFuture<std::variant<MoCapPerson, std::string>>>> loads;
+    for(size_t i = 0; i < metadata.size(); ++i)
+    {
+        if(mSnapshot && (persons[i] = mSnapshot->findMoCapPerson(metadata[i], videoDuration)))
+        {
+            continue;
+        }
+        loads.emplace_back(
+            i, QtConcurrent::run([md = metadata[i], videoDuration]() { return IO::loadMoCapC3D(md, videoDuration); }));
+    }
+
+    for(auto &[i, load] : loads)
+    {
+        auto result = load.result();
+        if(std::holds_alternative<std::string>(result))
+        {
+            PCritical(nullptr, "Error: Cannot load C3D File", std::get<std::string>(result).c_str());
+        }
+        else
+        {
+            persons[i] = std::move(std::get<MoCapPerson>(result));
         }
     }
+    return persons;
 }
 
 
@@ -24,10 +24,17 @@
 #include <QColor>
 #include <QLine>
 #include <QObject>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
-struct SkeletonLine;
 class QDomElement;
+class MoCapPerson;
+namespace IO
+{
+class SessionSnapshot;
+}
 
 struct SegmentRenderData
 {
@@ -55,9 +62,9 @@ public:
 
     void transformPersonSkeleton(
         const MoCapPerson              &person,
-        double                          framerate,
-        int                             currentFrame,
+        double                          currentTime,
         std::vector<SegmentRenderData> &renderData) const;
+    std::vector<SegmentRenderData>   getRenderData(double currentTime) const;
     std::vector<SegmentRenderData>   getRenderData(int currentFrame, double framerate) const;
     bool                             getShowMoCap() const { return mShowMoCap; };
     void                             setShowMoCap(bool visibility);
@@ -66,6 +73,11 @@ public:
     void                             notifyAllObserver();
     std::vector<MoCapPersonMetadata> getAllMoCapPersonMetadata() const;
     void                             readMoCapFiles(const std::vector<MoCapPersonMetadata> &newMetadata);
+    void                             setVideoDuration(double duration);
+    void                             reloadMissingSamples();
+
+    /// persons found in snapshot are taken from it instead of reading their c3d files; nullptr reads all
+    void setSnapshot(std::shared_ptr<const IO::SessionSnapshot> snapshot) { mSnapshot = std::move(snapshot); }
 
     void setXml(QDomElement &elem);
     void getXml(const QDomElement &elem);
@@ -76,15 +88,18 @@ signals:
     void thicknessChanged(int thickness);
 
 private:
-    static std::vector<SkeletonLine>
-    interpolate(const std::vector<SkeletonLine> &prePairs, const std::vector<SkeletonLine> &postPairs, double weight);
-
+    std::vector<std::optional<MoCapPerson>> loadPersons(
+        const std::vector<MoCapPersonMetadata> &metadata,
+        double                                  videoDuration) const;
 
     MoCapStorage    &mStorage;
-    bool             mShowMoCap = false;
-    QColor           mColor     = QColor(255, 255, 55);
-    int              mThickness = 2;
+    bool             mShowMoCap     = false;
+    QColor           mColor         = QColor(255, 255, 55);
+    int              mThickness     = 2;
+    double           mVideoDuration = -1; ///< duration of the video in seconds; -1 if unknown
     ExtrCalibration &mExtrCalib;
+
+    std::shared_ptr<const IO::SessionSnapshot> mSnapshot;
 };
 
 #endif // MOCAPCONTROLLER_H
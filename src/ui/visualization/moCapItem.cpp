@@ -24,6 +24,7 @@
 
 #include <QPainter>
 #include <QtMath> // for M_PI
+#include <map>
 
 
 /**
@@ -56,7 +57,13 @@ void MoCapItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /* opt
     if(mController.getShowMoCap())
     {
         std::vector<SegmentRenderData> allRenderData =
-            mController.getRenderData(mAnimation.getCurrentFrameNum(), mAnimation.getSequenceFPS());
+            mController.getRenderData(mAnimation.getFrameTime(mAnimation.getCurrentFrameNum()));
+        if(mRenderer.begin(painter))
+        {
+            render(allRenderData);
+            mRenderer.end();
+            return;
+        }
         for(SegmentRenderData &renderData : allRenderData)
         {
             drawLine(painter, renderData);
@@ -89,9 +96,19 @@ void MoCapItem::drawLine(QPainter *painter, SegmentRenderData &renderData)
  * @param renderData
  */
 void MoCapItem::drawArrowHead(QPainter *painter, SegmentRenderData &renderData)
+{
+    painter->drawPolygon(arrowHead(renderData.mLine));
+}
+
+/**
+ * @brief Returns the triangle of the arrowhead at point p2 of the line
+ *
+ * Point p2 is the top, the triangle sides' length is 1/5 of the arrow length.
+ */
+QPolygonF MoCapItem::arrowHead(const QLineF &line)
 {
     QPolygonF arrowHead;
-    auto      lineItem = QGraphicsLineItem(renderData.mLine);
+    auto      lineItem = QGraphicsLineItem(line);
     double angle = std::atan2(-lineItem.line().dy(), lineItem.line().dx()); // angle between x-axis and line in radians
     qreal  arrowLength              = QLineF(lineItem.line()).length() / 5;
     constexpr double arrowHeadAngle = M_PI / 3;
@@ -105,5 +122,37 @@ void MoCapItem::drawArrowHead(QPainter *painter, SegmentRenderData &renderData)
         lineItem.line().p2() -
         QPointF(sin(angle + 2 * arrowHeadAngle) * arrowLength, cos(angle + 2 * arrowHeadAngle) * arrowLength);
     arrowHead << lineItem.line().p2() << arrowHeadRight << arrowHeadLeft;
-    painter->drawPolygon(arrowHead);
+    return arrowHead;
+}
+
+/**
+ * @brief Draws all segments and arrowheads with OpenGL
+ *
+ * The lines are batched per color and thickness, so a frame needs one draw call per
+ * combination instead of one per segment.
+ *
+ * @param allRenderData
+ */
+void MoCapItem::render(const std::vector<SegmentRenderData> &allRenderData)
+{
+    std::map<std::pair<QRgb, int>, std::vector<QPointF>> batches;
+    for(const SegmentRenderData &renderData : allRenderData)
+    {
+        auto &vertices = batches[{renderData.mColor.rgba(), renderData.mThickness}];
+        vertices.push_back(renderData.mLine.p1());
+        vertices.push_back(renderData.mLine.p2());
+        if(renderData.mDirected)
+        {
+            const QPolygonF triangle = arrowHead(renderData.mLine);
+            for(int i = 0; i < triangle.size(); ++i)
+            {
+                vertices.push_back(triangle[i]);
+                vertices.push_back(triangle[(i + 1) % triangle.size()]);
+            }
+        }
+    }
+    for(const auto &[style, vertices] : batches)
+    {
+        mRenderer.drawLines(vertices, QColor::fromRgba(style.first), static_cast<float>(style.second));
+    }
 }
@@ -18,7 +18,10 @@
 #ifndef MOCAPITEM_H
 #define MOCAPITEM_H
 
+#include "overlayRenderer.h"
+
 #include <QGraphicsItem>
+#include <vector>
 
 class MoCapController;
 class Animation;
@@ -48,8 +51,11 @@ private:
     Petrack         &mMainWindow;
     Animation       &mAnimation;
     MoCapController &mController;
+    OverlayRenderer  mRenderer;
     static void      drawLine(QPainter *painter, SegmentRenderData &renderData);
     static void      drawArrowHead(QPainter *painter, SegmentRenderData &renderData);
+    static QPolygonF arrowHead(const QLineF &line);
+    void             render(const std::vector<SegmentRenderData> &allRenderData);
 };
 
 #endif // MOCAPITEM_H
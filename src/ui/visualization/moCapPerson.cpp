@@ -21,7 +21,12 @@
 #include "helper.h"
 
 #include <QDomElement>
+#include <algorithm>
+#include <cmath>
 #include <exception>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 /**
  * @brief Gets index of sample at given time
@@ -34,9 +39,102 @@ double MoCapPerson::getSampleIndex(double time) const
     return mMetadata.getSamplerate() * (time + mMetadata.getOffset());
 }
 
+/**
+ * @brief Returns whether the sample with the given index in the recording is stored
+ */
+bool MoCapPerson::hasSample(size_t index) const
+{
+    return index >= mFirstSample && index - mFirstSample < mHeadDirs.size();
+}
+
+/**
+ * @brief Gets the samples needed to show the recording between two points in time
+ *
+ * Includes the neighbouring samples used for interpolation and one more on each side against rounding errors.
+ *
+ * @param startTime first point in time in seconds
+ * @param endTime last point in time in seconds
+ * @param recordingLength number of samples in the recording
+ * @return first index and index after the last sample; both are equal if no sample is needed
+ */
+std::pair<size_t, size_t> MoCapPerson::getSampleRange(double startTime, double endTime, size_t recordingLength) const
+{
+    const double length = static_cast<double>(recordingLength);
+    const double first  = std::clamp(std::floor(getSampleIndex(startTime)) - 1, 0., length);
+    const double last   = std::clamp(std::ceil(getSampleIndex(endTime)) + 2, 0., length);
+    if(first >= last)
+    {
+        return {0, 0};
+    }
+    return {static_cast<size_t>(first), static_cast<size_t>(last)};
+}
+
+/**
+ * @brief Returns whether all samples needed between two points in time are stored
+ *
+ * Can become false, if only a part of the recording was loaded and the time offset or video changes.
+ */
+bool MoCapPerson::storesSamplesFor(double startTime, double endTime) const
+{
+    const auto [first, last] = getSampleRange(startTime, endTime, mRecordingLength);
+    return first == last || (first >= mFirstSample && last <= mFirstSample + mHeadDirs.size());
+}
+
+/**
+ * @brief Sets which part of the recording is stored
+ *
+ * @param firstSample index of the first added sample in the recording
+ * @param recordingLength number of samples in the recording
+ */
+void MoCapPerson::setStoredRange(size_t firstSample, size_t recordingLength)
+{
+    mFirstSample     = firstSample;
+    mRecordingLength = recordingLength;
+}
+
+/**
+ * @brief Returns the skeleton of a sample transformed by the rotation and translation of the metadata
+ *
+ * @param sample index of the sample in the recording
+ */
 SkeletonTree MoCapPerson::getSample(size_t sample) const
 {
-    return mSkeletons.at(sample).transformed(mMetadata.getRotation(), mMetadata.getTranslation());
+    return getSkeleton(sample).transformed(mMetadata.getRotation(), mMetadata.getTranslation());
+}
+
+/**
+ * @brief Rebuilds the skeleton of a sample from the stored node positions
+ *
+ * @param sample index of the sample in the recording
+ * @throw std::out_of_range if the sample is not stored
+ */
+SkeletonTree MoCapPerson::getSkeleton(size_t sample) const
+{
+    if(!hasSample(sample))
+    {
+        throw std::out_of_range("MoCap sample " + std::to_string(sample) + " is not loaded");
+    }
+    std::vector<std::vector<size_t>> children(mNodeIds.size());
+    for(size_t node = 1; node < mNodeIds.size(); ++node)
+    {
+        children[mNodeParents[node]].push_back(node);
+    }
+    const size_t index = sample - mFirstSample;
+    return SkeletonTree(buildNode(index, 0, children), mHeadDirs[index], mRotationCenters[index]);
+}
+
+/// builds the node with the given index of the stored sample index and all its descendants
+SkeletonNode MoCapPerson::buildNode(
+    size_t                                  index,
+    size_t                                  node,
+    const std::vector<std::vector<size_t>> &children) const
+{
+    SkeletonNode result{mNodeIds[node], mNodes[index * mNodeIds.size() + node]};
+    for(size_t child : children[node])
+    {
+        result.addChild(buildNode(index, child, children));
+    }
+    return result;
 }
 
 void MoCapPerson::setSamplerate(double samplerate)
@@ -65,14 +163,132 @@ void MoCapPerson::setRotation(double angle)
     mMetadata.setAngle(angle);
 }
 
+namespace
+{
+/// appends the ids, parents and positions of node and its descendants in the order of SkeletonTree::getLines()
+void flattenNode(
+    const SkeletonNode       &node,
+    int                       parent,
+    std::vector<uint8_t>     &ids,
+    std::vector<int>         &parents,
+    std::vector<cv::Point3f> &positions)
+{
+    const int index = static_cast<int>(ids.size());
+    ids.push_back(node.getId());
+    parents.push_back(parent);
+    positions.push_back(node.getPos());
+    for(const SkeletonNode &child : node.getChildren())
+    {
+        flattenNode(child, index, ids, parents, positions);
+    }
+}
+} // namespace
+
+/**
+ * @brief Appends a sample
+ *
+ * Only the node positions are stored. All samples need the nodes of the first sample,
+ * as samples are interpolated bone by bone.
+ *
+ * @param skeleton skeleton of the next sample
+ * @throw std::invalid_argument if the skeleton has other nodes than the first one
+ */
 void MoCapPerson::addSkeleton(const SkeletonTree &skeleton)
 {
-    mSkeletons.push_back(skeleton);
+    std::vector<uint8_t> ids;
+    std::vector<int>     parents;
+    flattenNode(skeleton.getRoot(), -1, ids, parents, mNodes);
+
+    if(mHeadDirs.empty())
+    {
+        mNodeIds     = std::move(ids);
+        mNodeParents = std::move(parents);
+        for(size_t node = 1; node < mNodeIds.size(); ++node)
+        {
+            if(mNodeIds[mNodeParents[node]] == 19 && mNodeIds[node] == 2)
+            {
+                mNeckToHeadBone = static_cast<int>(node) - 1;
+            }
+        }
+    }
+    else if(ids != mNodeIds || parents != mNodeParents)
+    {
+        mNodes.resize(mNodes.size() - ids.size());
+        throw std::invalid_argument("All skeletons of a MoCap recording need the same bones.");
+    }
+    mHeadDirs.push_back(skeleton.getHeadDir());
+    mRotationCenters.push_back(skeleton.getRotationCenter());
 }
 
-const SkeletonTree &MoCapPerson::getSkeleton(size_t sample) const
+/**
+ * @brief Replaces all stored samples, e.g. by the ones of a session snapshot
+ *
+ * The samples have to be in the form of addSkeleton(); the stored range is kept.
+ *
+ * @throw std::invalid_argument if the sizes of the arrays do not fit together
+ */
+void MoCapPerson::setSamples(
+    std::vector<uint8_t>     nodeIds,
+    std::vector<int>         nodeParents,
+    std::vector<cv::Point3f> nodes,
+    std::vector<cv::Vec3f>   headDirs,
+    std::vector<cv::Point3f> rotationCenters)
+{
+    if(nodeParents.size() != nodeIds.size() || rotationCenters.size() != headDirs.size() ||
+       nodes.size() != nodeIds.size() * headDirs.size())
+    {
+        throw std::invalid_argument("The samples of a MoCap recording do not fit together.");
+    }
+    for(size_t node = 0; node < nodeIds.size(); ++node)
+    {
+        // parents precede their children, as in addSkeleton()
+        if(nodeParents[node] >= static_cast<int>(node) || (node > 0 && nodeParents[node] < 0))
+        {
+            throw std::invalid_argument("The bones of a MoCap recording are invalid.");
+        }
+    }
+
+    mNodeIds         = std::move(nodeIds);
+    mNodeParents     = std::move(nodeParents);
+    mNodes           = std::move(nodes);
+    mHeadDirs        = std::move(headDirs);
+    mRotationCenters = std::move(rotationCenters);
+    mNeckToHeadBone  = -1;
+    for(size_t node = 1; node < mNodeIds.size(); ++node)
+    {
+        if(mNodeIds[mNodeParents[node]] == 19 && mNodeIds[node] == 2)
+        {
+            mNeckToHeadBone = static_cast<int>(node) - 1;
+        }
+    }
+}
+
+/**
+ * @brief Gets the bones of a sample transformed like getSample()
+ *
+ * Reads the stored node positions instead of building and walking the skeleton.
+ *
+ * @param sample index of the sample in the recording
+ * @param [out]joints start and end of every bone, in the order of SkeletonTree::getLines()
+ * @param [out]headDir direction of the head
+ */
+void MoCapPerson::getSampleBones(size_t sample, std::vector<cv::Point3f> &joints, cv::Vec3f &headDir) const
 {
-    return mSkeletons.at(sample);
+    const size_t       index     = sample - mFirstSample;
+    const cv::Affine3f transform = SkeletonTree::transformation(
+        mRotationCenters.at(index), mMetadata.getRotation(), mMetadata.getTranslation());
+
+    const size_t       nodeCount = mNodeIds.size();
+    const cv::Point3f *nodes     = mNodes.data() + index * nodeCount;
+    joints.resize(2 * (nodeCount > 0 ? nodeCount - 1 : 0));
+    for(size_t node = 1; node < nodeCount; ++node)
+    {
+        joints[2 * (node - 1)]     = transform * nodes[mNodeParents[node]];
+        joints[2 * (node - 1) + 1] = transform * nodes[node];
+    }
+
+    const cv::Matx33f rot = transform.rotation();
+    headDir               = rot * mHeadDirs[index];
 }
 
 const std::string &MoCapPerson::getFilename() const
@@ -21,6 +21,8 @@
 #include "moCapPersonMetadata.h"
 #include "skeletonTree.h"
 
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 
@@ -38,8 +40,9 @@ class MoCapPerson
 {
 public:
     double       getSampleIndex(double time) const;
-    inline bool  hasSample(size_t index) const { return index < mSkeletons.size(); }
+    bool         hasSample(size_t index) const;
     SkeletonTree getSample(size_t sample) const;
+    SkeletonTree getSkeleton(size_t sample) const;
 
     void                       setSamplerate(double samplerate);
     void                       setUserTimeOffset(double timeOffset);
@@ -48,18 +51,51 @@ public:
     void                       setRotation(double angle);
     void                       setMetadata(const MoCapPersonMetadata &metadata);
     void                       addSkeleton(const SkeletonTree &skeleton);
-    const SkeletonTree        &getSkeleton(size_t samples) const;
     const std::string         &getFilename() const;
     const MoCapPersonMetadata &getMetadata() const;
     bool                       isVisible() const;
     void                       setVisible(bool visible);
 
+    std::pair<size_t, size_t> getSampleRange(double startTime, double endTime, size_t recordingLength) const;
+    bool                      storesSamplesFor(double startTime, double endTime) const;
+    void                      setStoredRange(size_t firstSample, size_t recordingLength);
+    inline size_t             getFirstSample() const { return mFirstSample; }
+
+    void       getSampleBones(size_t sample, std::vector<cv::Point3f> &joints, cv::Vec3f &headDir) const;
+    inline int getNeckToHeadBone() const { return mNeckToHeadBone; }
+
+    // the stored samples in their contiguous form, e.g. for IO::writeSessionSnapshot()
+    inline size_t                   getRecordingLength() const { return mRecordingLength; }
+    const std::vector<uint8_t>     &getNodeIds() const { return mNodeIds; }
+    const std::vector<int>         &getNodeParents() const { return mNodeParents; }
+    const std::vector<cv::Point3f> &getNodes() const { return mNodes; }
+    const std::vector<cv::Vec3f>   &getHeadDirs() const { return mHeadDirs; }
+    const std::vector<cv::Point3f> &getRotationCenters() const { return mRotationCenters; }
+
+    void setSamples(
+        std::vector<uint8_t>     nodeIds,
+        std::vector<int>         nodeParents,
+        std::vector<cv::Point3f> nodes,
+        std::vector<cv::Vec3f>   headDirs,
+        std::vector<cv::Point3f> rotationCenters);
+
 
     void setXml(QDomElement &elem) const;
 
 private:
-    std::vector<SkeletonTree> mSkeletons;
-    MoCapPersonMetadata       mMetadata;
+    SkeletonNode buildNode(size_t index, size_t node, const std::vector<std::vector<size_t>> &children) const;
+
+    MoCapPersonMetadata mMetadata;
+
+    // the samples in contiguous memory; all skeletons have the nodes of the first one, so bone k ends at node k + 1
+    std::vector<uint8_t>     mNodeIds;              ///< ids of the nodes in the order of SkeletonTree::getLines()
+    std::vector<int>         mNodeParents;          ///< index of the parent of every node; -1 for the root
+    int                      mNeckToHeadBone  = -1; ///< bone from C7 (id 19) to the top of the head (id 2)
+    size_t                   mFirstSample     = 0;  ///< index of the first stored sample in the recording
+    size_t                   mRecordingLength = 0;  ///< number of samples in the recording
+    std::vector<cv::Point3f> mNodes;                ///< positions of the nodes of all stored samples
+    std::vector<cv::Vec3f>   mHeadDirs;
+    std::vector<cv::Point3f> mRotationCenters;
 };
 
 class MoCapStorage
@@ -0,0 +1,238 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "overlayRenderer.h"
+
+#include "logger.h"
+
+#include <QMatrix4x4>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPaintEngine>
+#include <QPainter>
+#include <algorithm>
+
+namespace
+{
+constexpr int POSITION_LOCATION = 0;
+
+// GLSL 1.00 (ES) / 1.10 (desktop); Qt defines the precision qualifiers away on desktop OpenGL
+const char *VERTEX_SHADER = R"(
+attribute highp vec2 position;
+uniform highp mat4 matrix;
+void main()
+{
+    gl_Position = matrix * vec4(position, 0.0, 1.0);
+}
+)";
+
+const char *FRAGMENT_SHADER = R"(
+uniform lowp vec4 color;
+void main()
+{
+    gl_FragColor = color;
+}
+)";
+} // namespace
+
+OverlayRenderer::~OverlayRenderer()
+{
+    QObject::disconnect(mContextConnection);
+}
+
+/// true, if the painter paints with OpenGL, e.g. on the OpenGL viewport of the view
+bool OverlayRenderer::isSupported(const QPainter *painter)
+{
+    return painter->paintEngine() && painter->paintEngine()->type() == QPaintEngine::OpenGL2;
+}
+
+/**
+ * @brief Starts the native painting with the transformation of the painter
+ *
+ * @return false, if OpenGL cannot be used; the item has to paint with the painter then
+ */
+bool OverlayRenderer::begin(QPainter *painter)
+{
+    if(!isSupported(painter))
+    {
+        return false;
+    }
+    painter->beginNativePainting();
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if(context != mContext)
+    {
+        releaseResources();
+        QObject::disconnect(mContextConnection);
+        mContext = context;
+        mFailed  = false;
+        if(context)
+        {
+            // the buffers are gone with the context, e.g. when the viewport is replaced
+            mContextConnection = QObject::connect(
+                context,
+                &QOpenGLContext::aboutToBeDestroyed,
+                [this]()
+                {
+                    releaseResources();
+                    mContext = nullptr;
+                });
+        }
+    }
+    if(!mContext || mFailed)
+    {
+        painter->endNativePainting();
+        return false;
+    }
+
+    if(!mProgram)
+    {
+        mProgram = std::make_unique<QOpenGLShaderProgram>();
+        mProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, VERTEX_SHADER);
+        mProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, FRAGMENT_SHADER);
+        mProgram->bindAttributeLocation("position", POSITION_LOCATION);
+        if(!mProgram->link())
+        {
+            SPDLOG_WARN("OpenGL overlay not available, painting without: {}", mProgram->log());
+            mProgram.reset();
+            mFailed = true;
+            painter->endNativePainting();
+            return false;
+        }
+        mStream = std::make_unique<QOpenGLBuffer>(QOpenGLBuffer::VertexBuffer);
+        mStream->setUsagePattern(QOpenGLBuffer::StreamDraw);
+        mStream->create();
+    }
+
+    // item coordinates -> device pixels -> normalized device coordinates
+    const QPaintDevice *device = painter->device();
+    QMatrix4x4          matrix;
+    matrix.ortho(0, device->width(), device->height(), 0, -1, 1);
+    matrix *= QMatrix4x4(painter->combinedTransform());
+
+    mProgram->bind();
+    mProgram->setUniformValue("matrix", matrix);
+    mProgram->enableAttributeArray(POSITION_LOCATION);
+
+    QOpenGLFunctions *functions = mContext->functions();
+    functions->glEnable(GL_BLEND);
+    functions->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    mPainter = painter;
+    return true;
+}
+
+void OverlayRenderer::end()
+{
+    if(mPainter)
+    {
+        mProgram->disableAttributeArray(POSITION_LOCATION);
+        mProgram->release();
+        mPainter->endNativePainting();
+        mPainter = nullptr;
+    }
+}
+
+/**
+ * @brief Uploads the polyline through the points (x[i], y[i]) as strip with the given key
+ *
+ * Replaces a strip with the same key; only possible between begin and end.
+ */
+void OverlayRenderer::uploadStrip(size_t key, const float *x, const float *y, int count)
+{
+    if(!mPainter)
+    {
+        return;
+    }
+    std::vector<float> vertices(2 * static_cast<size_t>(count));
+    for(int i = 0; i < count; ++i)
+    {
+        vertices[2 * i]     = x[i];
+        vertices[2 * i + 1] = y[i];
+    }
+
+    Strip &strip = mStrips[key];
+    if(!strip.buffer)
+    {
+        strip.buffer = std::make_unique<QOpenGLBuffer>(QOpenGLBuffer::VertexBuffer);
+        strip.buffer->create();
+    }
+    strip.buffer->bind();
+    strip.buffer->allocate(vertices.data(), static_cast<int>(vertices.size() * sizeof(float)));
+    strip.buffer->release();
+    strip.count = count;
+}
+
+void OverlayRenderer::removeStrip(size_t key)
+{
+    mStrips.erase(key);
+}
+
+/// draws the vertices [first, first + count) of the strip with the given key
+void OverlayRenderer::drawStrip(size_t key, int first, int count, const QColor &color, float width)
+{
+    const auto it = mStrips.find(key);
+    if(mPainter && it != mStrips.end() && first >= 0 && count > 1 && first + count <= it->second.count)
+    {
+        draw(*it->second.buffer, GL_LINE_STRIP, first, count, color, width);
+    }
+}
+
+/// draws a line between every two consecutive vertices
+void OverlayRenderer::drawLines(const std::vector<QPointF> &vertices, const QColor &color, float width)
+{
+    if(!mPainter || vertices.size() < 2)
+    {
+        return;
+    }
+    std::vector<float> data;
+    data.reserve(2 * vertices.size());
+    for(const auto &vertex : vertices)
+    {
+        data.push_back(static_cast<float>(vertex.x()));
+        data.push_back(static_cast<float>(vertex.y()));
+    }
+    mStream->bind();
+    mStream->allocate(data.data(), static_cast<int>(data.size() * sizeof(float)));
+    mStream->release();
+    draw(*mStream, GL_LINES, 0, static_cast<int>(vertices.size()), color, width);
+}
+
+void OverlayRenderer::draw(
+    QOpenGLBuffer &buffer,
+    unsigned int   mode,
+    int            first,
+    int            count,
+    const QColor  &color,
+    float          width)
+{
+    QOpenGLFunctions *functions = mContext->functions();
+    buffer.bind();
+    mProgram->setAttributeBuffer(POSITION_LOCATION, GL_FLOAT, 0, 2);
+    mProgram->setUniformValue("color", color);
+    // wide lines are clamped to the maximal width of the implementation
+    functions->glLineWidth(std::max(width, 1.F));
+    functions->glDrawArrays(mode, first, count);
+    buffer.release();
+}
+
+void OverlayRenderer::releaseResources()
+{
+    mStrips.clear();
+    mStream.reset();
+    mProgram.reset();
+}
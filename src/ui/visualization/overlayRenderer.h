@@ -0,0 +1,85 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef OVERLAYRENDERER_H
+#define OVERLAYRENDERER_H
+
+#include <QColor>
+#include <QMetaObject>
+#include <QOpenGLBuffer>
+#include <QOpenGLShaderProgram>
+#include <QPointF>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class QOpenGLContext;
+class QPainter;
+
+/**
+ * @brief Draws lines of a QGraphicsItem directly with OpenGL, if the view uses an OpenGL viewport
+ *
+ * Polylines which rarely change (e.g. the paths of the trajectories) are uploaded once
+ * as strips into GPU buffers and drawn per frame with an arbitrary range of their
+ * vertices. Lines which change every frame are streamed. Everything drawn between
+ * begin and end uses native painting, so the item must not use the painter meanwhile.
+ *
+ * The buffers belong to the OpenGL context of the viewport; if the viewport is
+ * replaced (see Petrack::opengl), all strips are dropped and have to be uploaded again.
+ */
+class OverlayRenderer
+{
+public:
+    OverlayRenderer() = default;
+    ~OverlayRenderer();
+    OverlayRenderer(const OverlayRenderer &)            = delete;
+    OverlayRenderer &operator=(const OverlayRenderer &) = delete;
+
+    static bool isSupported(const QPainter *painter);
+
+    bool begin(QPainter *painter);
+    void end();
+
+    bool hasStrip(size_t key) const { return mStrips.find(key) != mStrips.end(); }
+    void uploadStrip(size_t key, const float *x, const float *y, int count);
+    void removeStrip(size_t key);
+    void clearStrips() { mStrips.clear(); }
+    void drawStrip(size_t key, int first, int count, const QColor &color, float width);
+
+    void drawLines(const std::vector<QPointF> &vertices, const QColor &color, float width);
+
+private:
+    struct Strip
+    {
+        std::unique_ptr<QOpenGLBuffer> buffer;
+        int                            count = 0;
+    };
+
+    void releaseResources();
+    void draw(QOpenGLBuffer &buffer, unsigned int mode, int first, int count, const QColor &color, float width);
+
+    QPainter                             *mPainter = nullptr; ///< between begin and end
+    QOpenGLContext                       *mContext = nullptr; ///< the resources belong to
+    QMetaObject::Connection               mContextConnection;
+    bool                                  mFailed = false; ///< shader could not be built for mContext
+    std::unique_ptr<QOpenGLShaderProgram> mProgram;
+    std::unique_ptr<QOpenGLBuffer>        mStream;
+    std::unordered_map<size_t, Strip>     mStrips;
+};
+
+#endif // OVERLAYRENDERER_H
@@ -0,0 +1,41 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "paintCache.h"
+
+#include <QPainter>
+
+/**
+ * @brief Paints the overlay with painter
+ *
+ * @param painter painter of the QGraphicsItem
+ * @param key everything the painting depends on
+ * @param draw paints the overlay; only called if key changed since the last paint
+ */
+void PaintCache::paint(QPainter *painter, const Key &key, const std::function<void(QPainter *)> &draw)
+{
+    if(!isValid(key))
+    {
+        mPicture = QPicture();
+        QPainter recorder(&mPicture);
+        draw(&recorder);
+        recorder.end();
+        mKey = key;
+    }
+    painter->drawPicture(0, 0, mPicture);
+}
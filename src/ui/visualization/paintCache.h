@@ -0,0 +1,51 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAINTCACHE_H
+#define PAINTCACHE_H
+
+#include <QPicture>
+#include <functional>
+#include <optional>
+#include <vector>
+
+class QPainter;
+
+/**
+ * @brief Recorded painting of an overlay, replayed as long as its inputs do not change
+ *
+ * Overlays like the alignment grid project many points through the calibration, but
+ * only change with the calibration or their own parameters. The painting is recorded
+ * in a QPicture together with a key of everything it depends on; the next paints with
+ * the same key just replay the picture instead of projecting all points again.
+ */
+class PaintCache
+{
+public:
+    using Key = std::vector<double>;
+
+    void paint(QPainter *painter, const Key &key, const std::function<void(QPainter *)> &draw);
+    void invalidate() { mKey.reset(); }
+    bool isValid(const Key &key) const { return mKey && *mKey == key; }
+
+private:
+    std::optional<Key> mKey; ///< inputs of mPicture
+    QPicture           mPicture;
+};
+
+#endif // PAINTCACHE_H
@@ -19,17 +19,66 @@
 #include "trackerItem.h"
 
 #include "animation.h"
+#include "colorPlot.h"
 #include "control.h"
 #include "logger.h"
 #include "personStorage.h"
 #include "petrack.h"
+#include "player.h"
 #include "roiItem.h"
 #include "tracker.h"
+#include "trajectorySimplification.h"
 #include "view.h"
 #include "worldImageCorrespondence.h"
 
 #include <QInputDialog>
 #include <QtWidgets>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace
+{
+/// true, if point lies within reach of the rect
+bool isExposed(const QRectF &rect, const QPointF &point, double reach)
+{
+    return point.x() >= rect.left() - reach && point.x() <= rect.right() + reach && point.y() >= rect.top() - reach &&
+           point.y() <= rect.bottom() + reach;
+}
+
+/// true, if the bounding box of the line from p1 to p2 lies within reach of the rect
+bool isExposed(const QRectF &rect, const QPointF &p1, const QPointF &p2, double reach)
+{
+    return std::max(p1.x(), p2.x()) >= rect.left() - reach && std::min(p1.x(), p2.x()) <= rect.right() + reach &&
+           std::max(p1.y(), p2.y()) >= rect.top() - reach && std::min(p1.y(), p2.y()) <= rect.bottom() + reach;
+}
+
+/// maximal deviation of a simplified path in pixels of the view
+constexpr double PATH_TOLERANCE = 0.5;
+
+/// frames, whose Voronoi cells are computed in advance while playing
+constexpr int VORONOI_PREFETCH_FRAMES = 8;
+
+/// position of the head of the person in 3D, i.e. above its ground position
+cv::Point3f groundPosition(
+    const ExtrCalibration &extrCalibration,
+    const ColorPlot       &colorPlot,
+    double                 trans3,
+    const TrackPerson     &person,
+    const TrackPoint      &tp)
+{
+    if(person.height() < MIN_HEIGHT + 1)
+    {
+        return extrCalibration.get3DPoint(cv::Point2f(tp.x(), tp.y()), colorPlot.map(person.color()));
+    }
+    if(tp.sp().z() > 0)
+    {
+        return extrCalibration.get3DPoint(cv::Point2f(tp.x(), tp.y()), -trans3 - tp.sp().z());
+    }
+    return extrCalibration.get3DPoint(
+        cv::Point2f(tp.x(), tp.y()), person.height() /*mControlWidget->mapDefaultHeight->value()*/);
+}
+} // namespace
 
 // in x und y gleichermassen skaliertes koordinatensystem,
 // da von einer vorherigen intrinsischen kamerakalibrierung ausgegenagen wird,
@@ -39,6 +88,103 @@ TrackerItem::TrackerItem(QWidget *wParent, PersonStorage &storage, QGraphicsItem
 {
     mMainWindow    = (class Petrack *) wParent;
     mControlWidget = mMainWindow->getControlWidget();
+    // paint gets the exposed rect instead of the bounding rect, see paint
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+
+    // indices of the following persons change, when a person is deleted
+    auto clearCache = [this]()
+    {
+        mPathCache.clear();
+        mUploadedPaths.clear();
+    };
+    auto eraseCache = [this](size_t index)
+    {
+        mPathCache.erase(index);
+        mUploadedPaths.erase(index);
+    };
+    mConnections.push_back(QObject::connect(&mPersonStorage, &PersonStorage::deletedPerson, clearCache));
+    mConnections.push_back(QObject::connect(&mPersonStorage, &PersonStorage::changedPerson, eraseCache));
+    mConnections.push_back(QObject::connect(&mPersonStorage, &PersonStorage::deletedPersonFrameRange, eraseCache));
+    mConnections.push_back(QObject::connect(&mPersonStorage, &PersonStorage::splitPersonAtFrame, clearCache));
+}
+
+TrackerItem::~TrackerItem()
+{
+    for(const auto &connection : mConnections)
+    {
+        QObject::disconnect(connection);
+    }
+}
+
+/**
+ * @brief Path through the points [from, to) of a person, simplified with the given tolerance
+ *
+ * The simplification of the whole trajectory is kept until the person is changed or the
+ * zoom crosses a power of two, the path until the window changes as well. Besides the
+ * signals of PersonStorage, changes are detected by the snapshot of the points, since
+ * loading, undo or clearing the trajectories do not emit a signal per person.
+ */
+const QPainterPath &TrackerItem::simplifiedPath(size_t person, int from, int to, double tolerance)
+{
+    const auto &points = mPersonStorage.at(person).columns();
+    auto       &cached = mPathCache[person];
+    if(!cached.points.isSharedWith(points) || cached.tolerance != tolerance)
+    {
+        cached.points    = points;
+        cached.tolerance = tolerance;
+        cached.kept      = simplification::douglasPeucker(points.xData(), points.yData(), points.size(), tolerance);
+        cached.to        = -1;
+    }
+    if(cached.from != from || cached.to != to)
+    {
+        const auto window =
+            simplification::simplifyWindow(points.xData(), points.yData(), cached.kept, from, to, tolerance);
+        cached.path = QPainterPath();
+        for(int i : window)
+        {
+            const QPointF point(points.x(i), points.y(i));
+            if(cached.path.elementCount() == 0)
+            {
+                cached.path.moveTo(point);
+            }
+            else if(point != cached.path.currentPosition())
+            {
+                cached.path.lineTo(point);
+            }
+        }
+        cached.from = from;
+        cached.to   = to;
+    }
+    return cached.path;
+}
+
+/**
+ * @brief Ground positions of the ROI and the (selected) persons in the frame, of which the Voronoi cells are built
+ */
+VoronoiInput TrackerItem::voronoiInput(
+    int                    frame,
+    const QRectF          &roi,
+    const QSet<size_t>    &selection,
+    const ExtrCalibration &extrCalibration,
+    const ColorPlot       &colorPlot,
+    double                 trans3) const
+{
+    VoronoiInput input;
+    const auto   leftTop     = extrCalibration.get3DPoint(cv::Point2f(roi.left(), roi.top()), 0);
+    const auto   rightBottom = extrCalibration.get3DPoint(cv::Point2f(roi.right(), roi.bottom()), 0);
+    input.roiCorner1         = cv::Point2f(leftTop.x, leftTop.y);
+    input.roiCorner2         = cv::Point2f(rightBottom.x, rightBottom.y);
+    for(size_t i : mPersonStorage.activePersons(frame))
+    {
+        const auto &person = mPersonStorage.at(i);
+        if((selection.empty() || selection.contains(i)) && person.trackPointExist(frame))
+        {
+            const auto position =
+                groundPosition(extrCalibration, colorPlot, trans3, person, person.trackPointAt(frame));
+            input.positions.emplace_back(position.x, position.y);
+        }
+    }
+    return input;
 }
 
 /**
@@ -330,14 +476,13 @@ void TrackerItem::contextMenuEvent(QGraphicsSceneContextMenuEvent *event)
     mMainWindow->getScene()->update();
 }
 
-void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*option*/, QWidget * /*widget*/)
+void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget * /*widget*/)
 {
     int          from, to;
     int          curFrame = mMainWindow->getAnimation()->getCurrentFrameNum();
     QPen         ellipsePen;
     QRectF       rect;
     Vec2F        normalVector;
-    cv::Subdiv2D subdiv;
     QPen         linePen;
     QPen         numberPen;
     QPen         groundPositionPen;
@@ -355,10 +500,34 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
     QColor pGPC = mControlWidget->getTrackGroundPathColor();
     QColor pTPC = mControlWidget->getTrackPathColor();
     QFont  font, heightFont;
-    float  x_offset = 0, y_offset = 0;
-    float  y_switch = 0, x_switch = 0;
     double hS;
 
+    // the settings are read once instead of for every person and track point
+    const bool             headSized            = mControlWidget->isTrackHeadSizedChecked();
+    const bool             showCurrentPoint     = mControlWidget->isTrackShowCurrentPointChecked();
+    const bool             showSearchSize       = mControlWidget->isTrackShowSearchSizeChecked();
+    const int              regionLevels         = mControlWidget->getTrackRegionLevels();
+    const bool             showColorMarker      = mControlWidget->isTrackShowColorMarkerChecked();
+    const int              colorMarkerLineWidth = mControlWidget->getTrackColorMarkerLineWidth();
+    const bool             showColColor         = mControlWidget->isTrackShowColColorChecked();
+    const bool             showNumber           = mControlWidget->isTrackShowNumberChecked();
+    const bool             showHeightIndividual = mControlWidget->isTrackShowHeightIndividualChecked();
+    const bool             showGroundPosition   = mControlWidget->isTrackShowGroundPositionChecked();
+    const bool             showVoronoiCells     = mControlWidget->isShowVoronoiCellsChecked();
+    const bool             showPath             = mControlWidget->isTrackShowPathChecked();
+    const bool             showGroundPath       = mControlWidget->isTrackShowGroundPathChecked();
+    const bool             showPoints           = mControlWidget->isTrackShowPointsChecked();
+    const bool             showPointsColored    = mControlWidget->isTrackShowPointsColoredChecked();
+    const int              pointsLineWidth      = mControlWidget->getTrackShowPointsLineWidth();
+    const int              showBefore           = mControlWidget->getTrackShowBefore();
+    const int              showAfter            = mControlWidget->getTrackShowAfter();
+    const bool             showComplPath        = mControlWidget->isTrackShowComplPathChecked();
+    const bool             is3D                 = mControlWidget->getCalibCoordDimension() == 0;
+    const double           trans3               = mControlWidget->getExtrinsicParameters().trans3;
+    const double           cameraAltitude       = mControlWidget->getCameraAltitude();
+    const ColorPlot       *colorPlot            = mControlWidget->getColorPlot();
+    const ExtrCalibration *extrCalibration      = mMainWindow->getExtrCalibration();
+
     painter->drawRect(boundingRect());
 
     linePen.setColor(pTPC);
@@ -384,39 +553,100 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
     groundPathPen.setWidth(pSGP);
 
 
-    if(mControlWidget->isShowVoronoiCellsChecked() && mPersonStorage.nbPersons() != 0)
+    const auto &pedestrianToPaint = mMainWindow->getPedestrianUserSelection();
+    const auto &persons           = mPersonStorage.getPersons();
+
+    const bool showPathLike       = showPoints || showPath || showGroundPath;
+    const bool drawOnlyVisible    = mControlWidget->isTrackShowOnlyVisibleChecked();
+    const bool hasActiveSelection = !pedestrianToPaint.empty();
+    // frames of the paths around the current frame; -1 for the whole path
+    const int pathBefore = (showBefore == -1 || (showComplPath && hasActiveSelection)) ? -1 : showBefore;
+    const int pathAfter  = (showAfter == -1 || (showComplPath && hasActiveSelection)) ? -1 : showAfter;
+
+    // without paths of invisible persons, only the persons in the current frame are painted;
+    // otherwise only the persons with a path in the shown frame range
+    std::vector<size_t> personsToPaint;
+    if(showPathLike && !drawOnlyVisible)
     {
-        // ToDo: adjust subdiv rect to correct area
-        QRectF qrect = mMainWindow->getRecoRoiItem()->rect();
-
-        cv::Point3f leftTop = mMainWindow->getExtrCalibration()->get3DPoint(cv::Point2f(qrect.left(), qrect.top()), 0);
-        cv::Point3f rightBottom =
-            mMainWindow->getExtrCalibration()->get3DPoint(cv::Point2f(qrect.right(), qrect.bottom()), 0);
-
-        x_offset = -std::min(leftTop.x, rightBottom.x);
-        y_offset = -std::min(leftTop.y, rightBottom.y);
-        x_switch = rightBottom.x < leftTop.x ? abs(rightBottom.x - leftTop.x) : 0;
-        y_switch = rightBottom.y < leftTop.y ? abs(leftTop.y - rightBottom.y) : 0;
-        SPDLOG_INFO("x_offset: {}, y_offset: {}, x_switch: {}, y_switch: {}", x_offset, y_offset, x_switch, y_switch);
-
-        cv::Rect delaunyROI(
-            leftTop.x + x_offset,
-            leftTop.y + y_offset,
-            x_switch > 0 ? x_switch : (rightBottom.x - leftTop.x),
-            y_switch > 0 ? y_switch : (rightBottom.y - leftTop.y));
-        SPDLOG_INFO(
-            "Rect size: P({}, {}), width: {}, height: {}",
-            delaunyROI.x,
-            delaunyROI.y,
-            delaunyROI.width,
-            delaunyROI.height);
-
-        subdiv.initDelaunay(delaunyROI);
+        personsToPaint.reserve(persons.size());
+        for(size_t i = 0; i < persons.size(); ++i)
+        {
+            if((pathBefore == -1 || persons[i].lastFrame() >= curFrame - pathBefore) &&
+               (pathAfter == -1 || persons[i].firstFrame() <= curFrame + pathAfter))
+            {
+                personsToPaint.push_back(i);
+            }
+        }
+    }
+    else
+    {
+        personsToPaint = mPersonStorage.activePersons(curFrame);
     }
 
-    auto        pedestrianToPaint = mMainWindow->getPedestrianUserSelection();
-    const auto &persons           = mPersonStorage.getPersons();
-    for(size_t i = 0; i < persons.size(); ++i) // ueber TrackPerson
+    // only the parts in the exposed rect of the scene are painted (needs ItemUsesExtendedStyleOption)
+    const QRectF exposedRect = option->exposedRect;
+
+    // paths are simplified to the zoom, in powers of two to keep the cache while zooming a bit
+    const double levelOfDetail = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const double pathTolerance =
+        levelOfDetail > 0 ? std::exp2(std::floor(std::log2(PATH_TOLERANCE / levelOfDetail))) : PATH_TOLERANCE;
+    if(!showPath)
+    {
+        mPathCache.clear();
+        mUploadedPaths.clear();
+        mRenderer.clearStrips();
+    }
+    // persons removed without a signal, e.g. by loading other trajectories
+    for(auto it = mPathCache.begin(); it != mPathCache.end();)
+    {
+        it = it->first < persons.size() ? std::next(it) : mPathCache.erase(it);
+    }
+    for(auto it = mUploadedPaths.begin(); it != mUploadedPaths.end();)
+    {
+        if(it->first < persons.size())
+        {
+            ++it;
+            continue;
+        }
+        mRenderer.removeStrip(it->first);
+        it = mUploadedPaths.erase(it);
+    }
+
+    // window [from, to) of the points of a person shown as path
+    auto pathWindow = [&](const TrackPerson &person)
+    {
+        return std::make_pair(
+            pathBefore == -1 ? 0 : std::max(curFrame - person.firstFrame() - pathBefore, 0),
+            pathAfter == -1 ? person.size() : std::min(curFrame - person.firstFrame() + pathAfter + 1, person.size()));
+    };
+
+    // with an OpenGL viewport the paths are drawn from GPU buffers, which are only uploaded for changed persons;
+    // the current points, numbers etc. are still painted below
+    bool pathsRendered = false;
+    if(showPath && mRenderer.begin(painter))
+    {
+        for(size_t i : personsToPaint)
+        {
+            const auto &person = persons[i];
+            if((hasActiveSelection && !pedestrianToPaint.contains(i)) ||
+               (drawOnlyVisible && !person.trackPointExist(curFrame)))
+            {
+                continue;
+            }
+            const auto &points   = person.columns();
+            auto       &uploaded = mUploadedPaths[i];
+            if(!mRenderer.hasStrip(i) || !uploaded.isSharedWith(points))
+            {
+                mRenderer.uploadStrip(i, points.xData(), points.yData(), points.size());
+                uploaded = points;
+            }
+            std::tie(from, to) = pathWindow(person);
+            mRenderer.drawStrip(i, from, to - from, pTPC, static_cast<float>(linePen.widthF()));
+        }
+        mRenderer.end();
+        pathsRendered = true;
+    }
+    for(size_t i : personsToPaint) // ueber TrackPerson
     {
         const auto &person = persons[i];
         // show current frame
@@ -424,12 +654,33 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
         {
             if(person.trackPointExist(curFrame))
             {
-                if(mControlWidget->isTrackHeadSizedChecked())
+                if(headSized)
                 {
                     pSP = mMainWindow->getHeadSize(nullptr, static_cast<int>(i), curFrame);
                 }
                 const TrackPoint &tp = person.trackPointAt(curFrame);
-                if(mControlWidget->isTrackShowCurrentPointChecked())
+                if(showSearchSize)
+                {
+                    hS = mMainWindow->winSize(nullptr, static_cast<int>(i), curFrame);
+                    if(hS < 2)
+                    {
+                        hS = 2; // entspricht Vorgehen in tracker.cpp
+                    }
+                }
+
+                // the ground position may lie anywhere in the image, hence it is never culled
+                double reach = 10. + 16. * std::max({pSP, pSM, pSC, pSN});
+                if(showSearchSize)
+                {
+                    reach += hS * std::pow(2., regionLevels);
+                }
+                if(tp.color().isValid())
+                {
+                    reach += (tp - tp.colPoint()).length();
+                }
+                const bool drawCurrent = showGroundPosition || isExposed(exposedRect, tp.toQPointF(), reach);
+
+                if(drawCurrent && showCurrentPoint)
                 {
                     painter->setBrush(Qt::NoBrush);
                     if(person.newReco())
@@ -445,16 +696,11 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                     painter->drawEllipse(rect); // direkt waere nur int erlaubt tp.x()-5., tp.y()-5., 10., 10.
                 }
 
-                if(mControlWidget->isTrackShowSearchSizeChecked())
+                if(drawCurrent && showSearchSize)
                 {
                     painter->setBrush(Qt::NoBrush);
                     painter->setPen(Qt::yellow);
-                    hS = mMainWindow->winSize(nullptr, static_cast<int>(i), curFrame);
-                    if(hS < 2)
-                    {
-                        hS = 2; // entspricht Vorgehen in tracker.cpp
-                    }
-                    for(int j = 0; j <= mControlWidget->getTrackRegionLevels(); ++j)
+                    for(int j = 0; j <= regionLevels; ++j)
                     {
                         rect.setRect(tp.x() - hS / 2., tp.y() - hS / 2., hS, hS);
                         painter->drawRect(rect);
@@ -462,28 +708,28 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                     }
                 }
 
-                if(mControlWidget->isTrackShowColorMarkerChecked())
+                if(drawCurrent && showColorMarker)
                 {
                     // farbe des trackpoints
                     if(tp.color().isValid())
                     {
                         painter->setBrush(Qt::NoBrush);
                         ellipsePen.setColor(tp.color());
-                        ellipsePen.setWidth(mControlWidget->getTrackColorMarkerLineWidth());
+                        ellipsePen.setWidth(colorMarkerLineWidth);
                         painter->setPen(ellipsePen);
                         rect.setRect(tp.colPoint().x() - pSM / 2., tp.colPoint().y() - pSM / 2., pSM, pSM);
                         painter->drawEllipse(rect);
                     }
                 }
 
+                const bool drawColColor = drawCurrent && showColColor;
+                const bool drawNumber   = drawCurrent && showNumber;
+
                 // berechnung der normalen, die zur positionierung der nummerieung und der gesamtfarbe dient
-                if(((mControlWidget->isTrackShowColColorChecked()) && (person.color().isValid())) ||
-                   (mControlWidget->isTrackShowNumberChecked()) ||
-                   ((mControlWidget->isTrackShowColColorChecked()) &&
+                if(((drawColColor) && (person.color().isValid())) || (drawNumber) ||
+                   ((drawColColor) &&
                     ((person.height() > MIN_HEIGHT) ||
-                     ((tp.sp().z() > 0.) &&
-                      (mControlWidget
-                           ->isTrackShowHeightIndividualChecked()))))) //  Hoehe kann auf Treppen auch negativ werden,
+                     ((tp.sp().z() > 0.) && (showHeightIndividual))))) //  Hoehe kann auf Treppen auch negativ werden,
                                                                        //  wenn koord weiter oben angesetzt wird
                 {
                     if(tp.color().isValid())
@@ -528,7 +774,7 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
 
                 // farbe der gesamten trackperson
                 double height = person.height();
-                if(mControlWidget->isTrackShowColColorChecked())
+                if(drawColColor)
                 {
                     painter->setPen(numberPen);
                     painter->setBrush(Qt::NoBrush);
@@ -544,7 +790,7 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                     }
                 }
 
-                if((mControlWidget->isTrackShowColColorChecked()) && (person.color().isValid()))
+                if((drawColColor) && (person.color().isValid()))
                 {
                     painter->setPen(Qt::NoPen);
                     painter->setBrush(QBrush(person.color()));
@@ -556,17 +802,14 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                     painter->drawEllipse(rect);
                 }
                 else if(
-                    (mControlWidget->isTrackShowColColorChecked()) &&
+                    (drawColColor) &&
                     ((height > MIN_HEIGHT) ||
-                     ((tp.sp().z() > 0.) &&
-                      (mControlWidget
-                           ->isTrackShowHeightIndividualChecked())))) // Hoehe  && (person.height() > 0.) Hoehe
+                     ((tp.sp().z() > 0.) && (showHeightIndividual)))) // Hoehe  && (person.height() > 0.) Hoehe
                                                                       // kann auf Treppen auch negativ werden,
                                                                       // wenn koord weiter oben angesetzt wird
                 {
                     painter->setFont(heightFont);
-                    if((mControlWidget->isTrackShowHeightIndividualChecked()) &&
-                       (tp.sp().z() > 0.)) // Hoehe incl individual fuer jeden trackpoint
+                    if((showHeightIndividual) && (tp.sp().z() > 0.)) // Hoehe incl individual fuer jeden trackpoint
                     {
                         painter->setPen(numberPen);
                         painter->setBrush(Qt::NoBrush);
@@ -577,33 +820,31 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                             2.5 * pSC); // 11
                         if(height < MIN_HEIGHT + 1)
                         {
-                            if(mControlWidget->getCalibCoordDimension() == 0) // 3D
+                            if(is3D) // 3D
                             {
                                 painter->drawText(
                                     rect,
                                     Qt::AlignHCenter,
-                                    QString("-\n%2").arg(
-                                        -mControlWidget->getExtrinsicParameters().trans3 - tp.sp().z(), 6, 'f', 1));
+                                    QString("-\n%2").arg(-trans3 - tp.sp().z(), 6, 'f', 1));
                             }
                             else
                             {
                                 painter->drawText(
                                     rect,
                                     Qt::AlignHCenter,
-                                    QString("-\n%2").arg(mControlWidget->getCameraAltitude() - tp.sp().z(), 6, 'f', 1));
+                                    QString("-\n%2").arg(cameraAltitude - tp.sp().z(), 6, 'f', 1));
                             }
                         }
                         else
                         {
-                            if(mControlWidget->getCalibCoordDimension() == 0) // 3D
+                            if(is3D) // 3D
                             {
                                 painter->drawText(
                                     rect,
                                     Qt::AlignHCenter,
                                     QString("%1\n%2")
                                         .arg(height, 6, 'f', 1)
-                                        .arg(
-                                            -mControlWidget->getExtrinsicParameters().trans3 - tp.sp().z(), 6, 'f', 1));
+                                        .arg(-trans3 - tp.sp().z(), 6, 'f', 1));
                             }
                             else
                             {
@@ -612,7 +853,7 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                                     Qt::AlignHCenter,
                                     QString("%1\n%2")
                                         .arg(height, 6, 'f', 1)
-                                        .arg(mControlWidget->getCameraAltitude() - tp.sp().z(), 6, 'f', 1));
+                                        .arg(cameraAltitude - tp.sp().z(), 6, 'f', 1));
                             }
                         }
                     }
@@ -629,7 +870,7 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                     }
                     painter->setFont(font);
                 }
-                if(mControlWidget->isTrackShowNumberChecked())
+                if(drawNumber)
                 {
                     // listennummer
                     painter->setPen(numberPen);
@@ -641,36 +882,17 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                         pSN); // 11
                     painter->drawText(rect, Qt::AlignHCenter, QString("%1").arg(i + 1));
                 }
-                if(mControlWidget->isTrackShowGroundPositionChecked())
+                if(showGroundPosition)
                 {
                     // ground position
                     painter->setPen(groundPositionPen);
                     painter->setBrush(Qt::NoBrush);
-                    if(mControlWidget->getCalibCoordDimension() == 0) // 3D
+                    if(is3D) // 3D
                     {
                         double      cross_size = 15 + pSG * 0.25;
-                        cv::Point3f p3d_height;
-                        if(height < MIN_HEIGHT + 1)
-                        {
-                            p3d_height = mMainWindow->getExtrCalibration()->get3DPoint(
-                                cv::Point2f(tp.x(), tp.y()), mControlWidget->getColorPlot()->map(person.color()));
-                        }
-                        else
-                        {
-                            if(tp.sp().z() > 0)
-                            {
-                                p3d_height = mMainWindow->getExtrCalibration()->get3DPoint(
-                                    cv::Point2f(tp.x(), tp.y()),
-                                    -mControlWidget->getExtrinsicParameters().trans3 - tp.sp().z());
-                            }
-                            else
-                            {
-                                p3d_height = mMainWindow->getExtrCalibration()->get3DPoint(
-                                    cv::Point2f(tp.x(), tp.y()), height /*mControlWidget->mapDefaultHeight->value()*/);
-                            }
-                        }
+                        cv::Point3f p3d_height = groundPosition(*extrCalibration, *colorPlot, trans3, person, tp);
                         p3d_height.z           = 0;
-                        cv::Point2f p2d_ground = mMainWindow->getExtrCalibration()->getImagePoint(p3d_height);
+                        cv::Point2f p2d_ground = extrCalibration->getImagePoint(p3d_height);
                         QPointF     axis =
                             mMainWindow->getWorldImageCorrespondence().getCmPerPixel(p2d_ground.x, p2d_ground.y, 0);
                         painter->drawLine(QLineF(
@@ -689,155 +911,102 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                     {
                     }
                 }
-                if(mControlWidget->isShowVoronoiCellsChecked())
+            }
+
+            const bool isVisible    = person.trackPointExist(curFrame);
+            const bool personToDraw = !drawOnlyVisible || isVisible;
+            if(showPathLike && personToDraw)
+            {
+                std::tie(from, to) = pathWindow(person);
+
+                const double pathReach       = std::max(linePen.widthF(), 1.);
+                const double groundPathReach = std::max(pSGP, 1.);
+                const double pointReach      = pS / 2. + pointsLineWidth;
+
+                // path
+                if(showPath && !pathsRendered && to - from > 1)
                 {
-                    if(mControlWidget->getCalibCoordDimension() == 0) // 3D
+                    const QPainterPath &path   = simplifiedPath(i, from, to, pathTolerance);
+                    const QRectF        bounds = path.controlPointRect();
+                    if(isExposed(exposedRect, bounds.topLeft(), bounds.bottomRight(), pathReach))
                     {
-                        cv::Point3f p3d_height;
-                        if(height < MIN_HEIGHT + 1)
+                        painter->setPen(linePen);
+                        painter->setBrush(Qt::NoBrush);
+
+                        // nur Linie zeichnen, wenn x oder y sich unterscheidet, sonst Punkt
+                        // die Unterscheidung ist noetig, da Qt sonst grosses quadrat beim ranzoomen zeichnet
+                        if(path.elementCount() > 1)
                         {
-                            p3d_height = mMainWindow->getExtrCalibration()->get3DPoint(
-                                cv::Point2f(tp.x(), tp.y()), mControlWidget->getColorPlot()->map(person.color()));
+                            painter->drawPath(path);
                         }
                         else
                         {
-                            if(tp.sp().z() > 0)
-                            {
-                                p3d_height = mMainWindow->getExtrCalibration()->get3DPoint(
-                                    cv::Point2f(tp.x(), tp.y()),
-                                    -mControlWidget->getExtrinsicParameters().trans3 - tp.sp().z());
-                            }
-                            else
-                            {
-                                p3d_height = mMainWindow->getExtrCalibration()->get3DPoint(
-                                    cv::Point2f(tp.x(), tp.y()), height /*mControlWidget->mapDefaultHeight->value()*/);
-                            }
+                            painter->drawPoint(path.currentPosition());
                         }
-
-                        SPDLOG_INFO("insert P({}, {}) to subdiv", p3d_height.x + x_offset, p3d_height.y + y_offset);
-
-                        subdiv.insert(cv::Point2f(
-                            x_switch > 0 ? x_switch - p3d_height.x + x_offset : p3d_height.x + x_offset,
-                            y_switch > 0 ? y_switch - p3d_height.y + y_offset :
-                                           p3d_height.y + y_offset)); // p2d_ground);
                     }
                 }
-            }
 
-            const bool showPathLike = mControlWidget->isTrackShowPointsChecked() ||
-                                      mControlWidget->isTrackShowPathChecked() ||
-                                      mControlWidget->isTrackShowGroundPathChecked();
-            const bool isVisible       = person.trackPointExist(curFrame);
-            const bool drawOnlyVisible = mControlWidget->isTrackShowOnlyVisibleChecked();
-            const bool personToDraw    = !drawOnlyVisible || isVisible;
-            if(showPathLike && personToDraw)
-            {
-                const bool hasActiveSelection = !pedestrianToPaint.empty();
-                if(mControlWidget->getTrackShowBefore() == -1 ||
-                   (mControlWidget->isTrackShowComplPathChecked() && hasActiveSelection))
-                {
-                    from = 0;
-                }
-                else
-                {
-                    from = curFrame - person.firstFrame() - mControlWidget->getTrackShowBefore();
-                    if(from < 0)
-                    {
-                        from = 0;
-                    }
-                }
-                if(mControlWidget->getTrackShowAfter() == -1 ||
-                   (mControlWidget->isTrackShowComplPathChecked() && hasActiveSelection))
-                {
-                    to = person.size();
-                }
-                else
-                {
-                    to = curFrame - person.firstFrame() + mControlWidget->getTrackShowAfter() + 1;
-                    if(to > person.size())
-                    {
-                        to = person.size();
-                    }
-                }
-                for(int j = from; j < to; ++j) // ueber TrackPoint
+                TrackPoint previous;
+                for(int j = from; j < to && (showGroundPath || showPoints); ++j) // ueber TrackPoint
                 {
-                    // path
-                    if(mControlWidget->isTrackShowPathChecked())
-                    {
-                        if(j != from) // autom. > 0
-                        {
-                            painter->setPen(linePen);
-                            painter->setBrush(Qt::NoBrush);
-
-                            // nur Linie zeichnen, wenn x oder y sich unterscheidet, sonst Punkt
-                            // die Unterscheidung ist noetig, da Qt sonst grosses quadrat beim ranzoomen zeichnet
-                            if((person.at(j - 1).toQPointF().x() != person.at(j).toQPointF().x()) ||
-                               (person.at(j - 1).toQPointF().y() != person.at(j).toQPointF().y()))
-                            {
-                                painter->drawLine(person.at(j - 1).toQPointF(), person.at(j).toQPointF());
-                            }
-                            else
-                            {
-                                painter->drawPoint(person.at(j - 1).toQPointF());
-                            }
-                        }
-                    }
+                    const TrackPoint current = person.at(j);
                     // path on ground
-                    if(mControlWidget->isTrackShowGroundPathChecked())
+                    if(showGroundPath)
                     {
                         if(j != from)
                         {
-                            // ground position
-                            painter->setPen(groundPathPen);
-                            painter->setBrush(Qt::NoBrush);
-                            if(mControlWidget->getCalibCoordDimension() == 0) // 3D
+                            if(is3D) // 3D
                             {
                                 cv::Point3f p3d_height_p1, p3d_height_p2;
                                 if(person.height() < MIN_HEIGHT + 1)
                                 {
-                                    p3d_height_p1 = mMainWindow->getExtrCalibration()->get3DPoint(
-                                        cv::Point2f(person.at(j - 1).x(), person.at(j - 1).y()),
-                                        mControlWidget->getColorPlot()->map(person.color()));
-                                    p3d_height_p2 = mMainWindow->getExtrCalibration()->get3DPoint(
-                                        cv::Point2f(person.at(j).x(), person.at(j).y()),
-                                        mControlWidget->getColorPlot()->map(person.color()));
+                                    p3d_height_p1 = extrCalibration->get3DPoint(
+                                        cv::Point2f(previous.x(), previous.y()), colorPlot->map(person.color()));
+                                    p3d_height_p2 = extrCalibration->get3DPoint(
+                                        cv::Point2f(current.x(), current.y()), colorPlot->map(person.color()));
                                 }
                                 else
                                 {
-                                    if(person.at(j - 1).sp().z() > 0 && person.at(j).sp().z() > 0)
+                                    if(previous.sp().z() > 0 && current.sp().z() > 0)
                                     {
-                                        p3d_height_p1 = mMainWindow->getExtrCalibration()->get3DPoint(
-                                            cv::Point2f(person.at(j - 1).x(), person.at(j - 1).y()),
-                                            -mControlWidget->getExtrinsicParameters().trans3 -
-                                                person.at(j - 1).sp().z());
-                                        p3d_height_p2 = mMainWindow->getExtrCalibration()->get3DPoint(
-                                            cv::Point2f(person.at(j).x(), person.at(j).y()),
-                                            -mControlWidget->getExtrinsicParameters().trans3 - person.at(j).sp().z());
+                                        p3d_height_p1 = extrCalibration->get3DPoint(
+                                            cv::Point2f(previous.x(), previous.y()), -trans3 - previous.sp().z());
+                                        p3d_height_p2 = extrCalibration->get3DPoint(
+                                            cv::Point2f(current.x(), current.y()), -trans3 - current.sp().z());
                                     }
                                     else
                                     {
-                                        p3d_height_p1 = mMainWindow->getExtrCalibration()->get3DPoint(
-                                            cv::Point2f(person.at(j - 1).x(), person.at(j - 1).y()), person.height());
-                                        p3d_height_p2 = mMainWindow->getExtrCalibration()->get3DPoint(
-                                            cv::Point2f(person.at(j).x(), person.at(j).y()), person.height());
+                                        p3d_height_p1 = extrCalibration->get3DPoint(
+                                            cv::Point2f(previous.x(), previous.y()), person.height());
+                                        p3d_height_p2 = extrCalibration->get3DPoint(
+                                            cv::Point2f(current.x(), current.y()), person.height());
                                     }
                                 }
-                                p3d_height_p1.z = 0;
-                                p3d_height_p2.z = 0;
-                                cv::Point2f p2d_ground_p1 =
-                                    mMainWindow->getExtrCalibration()->getImagePoint(p3d_height_p1);
-                                cv::Point2f p2d_ground_p2 =
-                                    mMainWindow->getExtrCalibration()->getImagePoint(p3d_height_p2);
-                                // nur Linie zeichnen, wenn x oder y sich unterscheidet, sonst Punkt
-                                // die Unterscheidung ist noetig, da Qt sonst grosses quadrat beim ranzoomen zeichnet
-                                if(p2d_ground_p1.x != p2d_ground_p2.x || p2d_ground_p1.y != p2d_ground_p2.y)
+                                p3d_height_p1.z           = 0;
+                                p3d_height_p2.z           = 0;
+                                cv::Point2f p2d_ground_p1 = extrCalibration->getImagePoint(p3d_height_p1);
+                                cv::Point2f p2d_ground_p2 = extrCalibration->getImagePoint(p3d_height_p2);
+                                if(isExposed(
+                                       exposedRect,
+                                       QPointF(p2d_ground_p1.x, p2d_ground_p1.y),
+                                       QPointF(p2d_ground_p2.x, p2d_ground_p2.y),
+                                       groundPathReach))
                                 {
-                                    painter->drawLine(
-                                        QLineF(p2d_ground_p1.x, p2d_ground_p1.y, p2d_ground_p2.x, p2d_ground_p2.y));
-                                }
-                                else
-                                {
-                                    painter->drawPoint(p2d_ground_p1.x, p2d_ground_p1.y);
+                                    // ground position
+                                    painter->setPen(groundPathPen);
+                                    painter->setBrush(Qt::NoBrush);
+                                    // nur Linie zeichnen, wenn x oder y sich unterscheidet, sonst Punkt
+                                    // die Unterscheidung ist noetig, da Qt sonst grosses quadrat beim ranzoomen
+                                    // zeichnet
+                                    if(p2d_ground_p1.x != p2d_ground_p2.x || p2d_ground_p1.y != p2d_ground_p2.y)
+                                    {
+                                        painter->drawLine(
+                                            QLineF(p2d_ground_p1.x, p2d_ground_p1.y, p2d_ground_p2.x, p2d_ground_p2.y));
+                                    }
+                                    else
+                                    {
+                                        painter->drawPoint(p2d_ground_p1.x, p2d_ground_p1.y);
+                                    }
                                 }
                             }
                             else // 2D
@@ -847,188 +1016,87 @@ void TrackerItem::paint(QPainter *painter, const QStyleOptionGraphicsItem * /*op
                     }
 
                     // points before and after
-                    if(mControlWidget->isTrackShowPointsChecked())
+                    if(showPoints)
                     {
-                        if(person.firstFrame() + j != curFrame)
+                        if(person.firstFrame() + j != curFrame &&
+                           isExposed(exposedRect, current.toQPointF(), pointReach))
                         {
-                            if((mControlWidget->isTrackShowPointsColoredChecked()) && (person.at(j).color().isValid()))
+                            if((showPointsColored) && (current.color().isValid()))
                             {
                                 painter->setPen(Qt::NoPen);
-                                painter->setBrush(QBrush(person.at(j).color()));
-                                rect.setRect(person.at(j).x() - pS / 2., person.at(j).y() - pS / 2., pS,
-                                             pS); // 7
+                                painter->setBrush(QBrush(current.color()));
+                                rect.setRect(current.x() - pS / 2., current.y() - pS / 2., pS, pS); // 7
                             }
                             else
                             {
                                 trackPointLineWidthPen.setColor(Qt::red);
-                                trackPointLineWidthPen.setWidth(mControlWidget->getTrackShowPointsLineWidth());
+                                trackPointLineWidthPen.setWidth(pointsLineWidth);
                                 painter->setPen(trackPointLineWidthPen);
 
                                 painter->setBrush(Qt::NoBrush);
-                                rect.setRect(person.at(j).x() - pS / 2., person.at(j).y() - pS / 2., pS, pS);
+                                rect.setRect(current.x() - pS / 2., current.y() - pS / 2., pS, pS);
                             }
                             painter->drawEllipse(rect);
                         }
                     }
+                    previous = current;
                 }
             }
         }
     }
 
-    // Mat& img, Subdiv2D& subdiv )
-    if(mControlWidget->isShowVoronoiCellsChecked() && !mPersonStorage.getPersons().empty())
+    if(showVoronoiCells && is3D && !persons.empty())
     {
-        std::vector<std::vector<cv::Point2f>> facets3D;
-        std::vector<cv::Point2f>              centers3D;
-
-        // get Voronoi cell info from subDiv in 3D coordinates on ground (z=0)
-        subdiv.getVoronoiFacetList(std::vector<int>(), facets3D, centers3D);
-
-        painter->setClipRect(mMainWindow->getRecoRoiItem()
-                                 ->rect()); // 0,0,mMainWindow->getImage()->width(),mMainWindow->getImage()->height());
+        // ToDo: adjust subdiv rect to correct area
+        const QRectF roi   = mMainWindow->getRecoRoiItem()->rect();
+        const auto   input = voronoiInput(curFrame, roi, pedestrianToPaint, *extrCalibration, *colorPlot, trans3);
+        const auto  &cells = mVoronoiCache.cells(curFrame, input);
 
-        // cell by cell
-        for(size_t i = 0; i < facets3D.size(); i++)
+        // while playing, the cells of the next frames are triangulated by worker threads meanwhile
+        const PlayerState playerState = mMainWindow->getPlayer()->getState();
+        if(playerState != PlayerState::PAUSE)
         {
-            centers3D.at(i).x = x_switch > 0 ? x_switch - centers3D.at(i).x - x_offset : centers3D.at(i).x - x_offset;
-            centers3D.at(i).y = y_switch > 0 ? y_switch - centers3D.at(i).y - y_offset : centers3D.at(i).y - y_offset;
-            // voronoi cell center in 2D
-            cv::Point2f center2D =
-                mMainWindow->getExtrCalibration()->getImagePoint(cv::Point3f(centers3D.at(i).x, centers3D.at(i).y, 0));
-
-            std::vector<QPointF> ifacet2D;
-            QPointF              circleStart, circleEnd;
-            float                area = 0;
-            float                r = 50, m = 0, n = 0, s1_x = 0, s2_x = 0, s1_y = 0, s2_y = 0;
-            bool                 circleStarted = false;
-            for(size_t j = 0; j < facets3D[i].size(); j++)
+            const int step = playerState == PlayerState::FORWARD ? 1 : -1;
+            for(int frame = curFrame + step; std::abs(frame - curFrame) <= VORONOI_PREFETCH_FRAMES; frame += step)
             {
-                facets3D.at(i).at(j).x =
-                    x_switch > 0 ? x_switch - facets3D.at(i).at(j).x - x_offset : facets3D.at(i).at(j).x - x_offset;
-                facets3D.at(i).at(j).y =
-                    y_switch > 0 ? y_switch - facets3D.at(i).at(j).y - y_offset : facets3D.at(i).at(j).y - y_offset;
-
-                cv::Point2f point2D = mMainWindow->getExtrCalibration()->getImagePoint(
-                    cv::Point3f(facets3D.at(i).at(j).x, facets3D.at(i).at(j).y, 0));
-
-                SPDLOG_INFO(
-                    "facets3D.at({}).at({}).x = {}, .y = {}", i, j, facets3D.at(i).at(j).x, facets3D.at(i).at(j).y);
-                SPDLOG_INFO("point2D.x = {}, .y = {}", point2D.x, point2D.y);
-
-                if constexpr(
-                    false && sqrt(
-                                 pow((facets3D.at(i).at(j).x - centers3D.at(i).x), 2) +
-                                 pow((facets3D.at(i).at(j).y - centers3D.at(i).y), 2)) > r)
+                if(frame >= 0 && frame < mMainWindow->getAnimation()->getNumFrames() && !mVoronoiCache.contains(frame))
                 {
-                    if(circleStarted)
-                    {
-                        m = (facets3D.at(i).at(j).y - facets3D.at(i).at((j - 1) % facets3D.at(i).size()).y) /
-                            (facets3D.at(i).at(j).x - facets3D.at(i).at((j - 1) % facets3D.at(i).size()).x);
-
-                        // End punkt berechnen (Schnittpunkt Gerade-Kreis)
-                        // Steigung der Geraden
-                        m = (facets3D.at(i).at(j).y - facets3D.at(i).at((j + 1) % facets3D.at(i).size()).y) /
-                            (facets3D.at(i).at(j).x - facets3D.at(i).at((j + 1) % facets3D.at(i).size()).x);
-                        // Achsenabschnitt der Geraden
-                        n = facets3D.at(i).at(j).y - m * facets3D.at(i).at(j).x;
-
-                        float p = -((m * n - m * centers3D.at(i).y - centers3D.at(i).x) / (1 + pow(m, 2)));
-                        float q = sqrt(
-                            (pow(r, 2) - pow(centers3D.at(i).x, 2) - pow(centers3D.at(i).y, 2) - pow(n, 2) -
-                             2 * n * centers3D.at(i).y) /
-                                (1 + pow(m, 2)) +
-                            pow((m * n - m * centers3D.at(i).y - centers3D.at(i).x) / (1 + pow(m, 2)), 2));
-                        // Schnittpunkte mit Kreis
-                        s1_x = p + q;
-                        s1_y = m * s1_x + n;
-
-                        s2_x = p - q;
-                        s2_y = m * s2_x + n;
-
-                        facets3D[i][j] = cv::Point2f(s1_x, s1_y);
-
-                        point2D   = mMainWindow->getExtrCalibration()->getImagePoint(cv::Point3f(s1_x, s1_y, 0));
-                        circleEnd = QPointF(point2D.x, point2D.y);
-
-                        ifacet2D.push_back(QPointF(center2D.x, center2D.y));
-                        ifacet2D.push_back(QPointF(point2D.x, point2D.y));
-
-                        SPDLOG_INFO("End point: ({}, {})", s1_x, s1_y);
-                    }
-                    else
-                    {
-                        // start punkt berechnen
-
-                        m = (facets3D.at(i).at(j).y - facets3D.at(i).at((j - 1) % facets3D.at(i).size()).y) /
-                            (facets3D.at(i).at(j).x - facets3D.at(i).at((j - 1) % facets3D.at(i).size()).x);
-
-                        n = facets3D.at(i).at(j).y - m * facets3D.at(i).at(j).x;
-
-                        float p = -((m * n - m * centers3D.at(i).y - centers3D.at(i).x) / (1 + pow(m, 2)));
-                        float q = sqrt(
-                            (pow(r, 2) - pow(centers3D.at(i).x, 2) - pow(centers3D.at(i).y, 2) - pow(n, 2) -
-                             2 * n * centers3D.at(i).y) /
-                                (1 + pow(m, 2)) +
-                            pow((m * n - m * centers3D.at(i).y - centers3D.at(i).x) / (1 + pow(m, 2)), 2));
-
-                        // Schnittpunkte mit Kreis
-                        s1_x = p + q;
-                        s1_y = m * s1_x + n;
-
-                        s2_x = p - q;
-                        s2_y = m * s2_x + n;
-
-                        SPDLOG_INFO(
-                            "x={} G(x)={} K(x)={} = {}",
-                            s1_x,
-                            (m * s1_x + n),
-                            pow(s1_x - centers3D.at(i).x, 2) + pow(s1_y - centers3D.at(i).y, 2),
-                            pow(r, 2));
-                        SPDLOG_INFO(
-                            "x={} G(x)={} K(x)={} = {}",
-                            s2_x,
-                            (m * s2_x + n),
-                            pow(s2_x - centers3D.at(i).x, 2) + pow(s2_y - centers3D.at(i).y, 2),
-                            pow(r, 2));
-
-                        facets3D[i][j] = cv::Point2f(s1_x, s1_y);
-
-                        point2D = mMainWindow->getExtrCalibration()->getImagePoint(cv::Point3f(s1_x, s1_y, 0));
-                        ifacet2D.push_back(QPointF(point2D.x, point2D.y));
-                        circleStart   = QPointF(point2D.x, point2D.y);
-                        circleStarted = true;
-
-                        SPDLOG_INFO("Start point: ({}, {})", s1_x, s1_y);
-                    }
-                }
-                else
-                {
-                    ifacet2D.push_back(QPointF(point2D.x, point2D.y));
-                    area += (facets3D.at(i).at(j).x * facets3D.at(i).at((j + 1) % facets3D[i].size()).y);
-                    area -= (facets3D.at(i).at((j + 1) % facets3D[i].size()).x * facets3D.at(i).at(j).y);
+                    mVoronoiCache.prefetch(
+                        frame, voronoiInput(frame, roi, pedestrianToPaint, *extrCalibration, *colorPlot, trans3));
                 }
             }
-            area *= 0.5;
-            area = 1.0 / area;
-            area *= 10000;
+        }
 
-            QColor color;
+        painter->setClipRect(roi); // 0,0,mMainWindow->getImage()->width(),mMainWindow->getImage()->height());
 
-            color.setHsv((255 - area * 25.5) < 0 ? 0 : (255 - area * 25.5), 255, 255, 128);
+        // cell by cell
+        for(const auto &cell : cells)
+        {
+            // voronoi cell center in 2D
+            const cv::Point2f center2D = extrCalibration->getImagePoint(cv::Point3f(cell.center.x, cell.center.y, 0));
 
-            QVector<QPointF> ifacet_vec;
-            for(size_t i = 0; i < ifacet2D.size(); i++)
+            std::vector<cv::Point3f> facet3D;
+            facet3D.reserve(cell.facet.size());
+            for(const auto &corner : cell.facet)
+            {
+                facet3D.emplace_back(corner.x, corner.y, 0);
+            }
+            QPolygonF facet2D;
+            for(const auto &corner : extrCalibration->getImagePoint(facet3D))
             {
-                ifacet_vec.append(ifacet2D.at(i));
+                facet2D.append(QPointF(corner.x, corner.y));
             }
 
+            QColor color;
+            color.setHsv((255 - cell.density * 25.5) < 0 ? 0 : (255 - cell.density * 25.5), 255, 255, 128);
+
             painter->setBrush(color);
             painter->setPen(Qt::black);
-            if(ifacet2D.size() == 0)
+            if(facet2D.empty())
             {
                 painter->drawEllipse(QPointF(center2D.x, center2D.y), 100, 100);
             }
-            painter->drawConvexPolygon(QPolygonF(ifacet_vec));
+            painter->drawConvexPolygon(facet2D);
 
             // voronoi cell point
             painter->setBrush(Qt::black);
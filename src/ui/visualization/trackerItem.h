@@ -19,21 +19,60 @@
 #ifndef TRACKERITEM_H
 #define TRACKERITEM_H
 
+#include "overlayRenderer.h"
+#include "trackPointColumns.h"
+#include "voronoiCells.h"
+
 #include <QGraphicsItem>
+#include <QMetaObject>
+#include <QPainterPath>
+#include <QSet>
+#include <unordered_map>
+#include <vector>
 
 class Petrack;
 class Control;
 class PersonStorage;
+class ExtrCalibration;
+class ColorPlot;
 
 class TrackerItem : public QGraphicsItem
 {
 private:
+    /// simplified path of a person for the current zoom, see simplifiedPath
+    struct CachedPath
+    {
+        TrackPointColumns points;         ///< snapshot to detect changes without signal (e.g. loading, undo)
+        double            tolerance = -1; ///< of the simplification in scene coordinates
+        std::vector<int>  kept;           ///< indices of the kept points of the whole trajectory
+        int               from = 0;       ///< window [from, to) of path
+        int               to   = 0;
+        QPainterPath      path;
+    };
+
     Petrack       *mMainWindow;
     Control       *mControlWidget;
     PersonStorage &mPersonStorage;
 
+    std::unordered_map<size_t, CachedPath>        mPathCache;
+    OverlayRenderer                               mRenderer;
+    std::unordered_map<size_t, TrackPointColumns> mUploadedPaths; ///< points of the strips in mRenderer
+    VoronoiCache                                  mVoronoiCache;
+    std::vector<QMetaObject::Connection>          mConnections;
+
+    const QPainterPath &simplifiedPath(size_t person, int from, int to, double tolerance);
+
+    VoronoiInput voronoiInput(
+        int                    frame,
+        const QRectF          &roi,
+        const QSet<size_t>    &selection,
+        const ExtrCalibration &extrCalibration,
+        const ColorPlot       &colorPlot,
+        double                 trans3) const;
+
 public:
     TrackerItem(QWidget *wParent, PersonStorage &tracker, QGraphicsItem *parent = nullptr);
+    ~TrackerItem();
     void   contextMenuEvent(QGraphicsSceneContextMenuEvent *event);
     QRectF boundingRect() const;
     void   paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
@@ -0,0 +1,139 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "voronoiCells.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <opencv2/imgproc.hpp>
+
+/**
+ * @brief Computes the Voronoi cells of the persons inside of the recognition ROI
+ *
+ * Positions outside of the ROI are skipped, since the triangulation cannot contain them.
+ *
+ * @param input ground positions in cm
+ * @return cells in cm, in the order of the Voronoi facets of cv::Subdiv2D
+ */
+std::vector<VoronoiCell> computeVoronoiCells(const VoronoiInput &input)
+{
+    const cv::Point2f &leftTop     = input.roiCorner1;
+    const cv::Point2f &rightBottom = input.roiCorner2;
+
+    // cv::Subdiv2D needs positive coordinates; the corners may be swapped on the ground plane
+    const cv::Point2f offset(-std::min(leftTop.x, rightBottom.x), -std::min(leftTop.y, rightBottom.y));
+    const cv::Rect    delaunayROI(
+        0,
+        0,
+        static_cast<int>(std::abs(rightBottom.x - leftTop.x)),
+        static_cast<int>(std::abs(rightBottom.y - leftTop.y)));
+    cv::Subdiv2D subdiv(delaunayROI);
+
+    for(const auto &position : input.positions)
+    {
+        const cv::Point2f point = position + offset;
+        if(point.x >= 0 && point.y >= 0 && point.x < delaunayROI.width && point.y < delaunayROI.height)
+        {
+            subdiv.insert(point);
+        }
+    }
+
+    std::vector<std::vector<cv::Point2f>> facets;
+    std::vector<cv::Point2f>              centers;
+    subdiv.getVoronoiFacetList(std::vector<int>(), facets, centers);
+
+    auto toGround = [&offset](const cv::Point2f &point) { return point - offset; };
+
+    std::vector<VoronoiCell> cells(facets.size());
+    for(size_t i = 0; i < facets.size(); ++i)
+    {
+        VoronoiCell &cell = cells[i];
+        cell.center       = toGround(centers[i]);
+        cell.facet.reserve(facets[i].size());
+        std::transform(facets[i].begin(), facets[i].end(), std::back_inserter(cell.facet), toGround);
+
+        // shoelace formula
+        float area = 0;
+        for(size_t j = 0; j < cell.facet.size(); ++j)
+        {
+            const cv::Point2f &next = cell.facet[(j + 1) % cell.facet.size()];
+            area += cell.facet[j].x * next.y - next.x * cell.facet[j].y;
+        }
+        cell.density = 10000.F / (0.5F * area);
+    }
+    return cells;
+}
+
+/**
+ * @brief Returns the cells of the frame for the given input
+ *
+ * Waits for a computation in advance, if it is still running; computes the cells, if they
+ * were computed for another input or not at all.
+ */
+const std::vector<VoronoiCell> &VoronoiCache::cells(int frame, const VoronoiInput &input)
+{
+    auto it = mFrames.find(frame);
+    if(it == mFrames.end() || !(it->second.input == input))
+    {
+        limitFrames(frame);
+        Entry entry;
+        entry.input    = input;
+        entry.cells    = computeVoronoiCells(input);
+        entry.computed = true;
+        it             = mFrames.insert_or_assign(frame, std::move(entry)).first;
+    }
+    Entry &entry = it->second;
+    if(!entry.computed)
+    {
+        entry.cells    = entry.pending.result();
+        entry.pending  = {};
+        entry.computed = true;
+    }
+    return entry.cells;
+}
+
+/// computes the cells of the frame in a worker thread, if they are not known for this input yet
+void VoronoiCache::prefetch(int frame, const VoronoiInput &input)
+{
+    const auto it = mFrames.find(frame);
+    if(it != mFrames.end() && it->second.input == input)
+    {
+        return;
+    }
+    limitFrames(frame);
+    Entry entry;
+    entry.input   = input;
+    entry.pending = QtConcurrent::run(computeVoronoiCells, input);
+    mFrames.insert_or_assign(frame, std::move(entry));
+}
+
+void VoronoiCache::limitFrames(int frame)
+{
+    while(mFrames.size() >= MAX_FRAMES)
+    {
+        const auto farthest = std::max_element(
+            mFrames.begin(),
+            mFrames.end(),
+            [frame](const auto &lhs, const auto &rhs)
+            { return std::abs(lhs.first - frame) < std::abs(rhs.first - frame); });
+        // a running computation continues on its own copy of the input
+        mFrames.erase(farthest);
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef VORONOICELLS_H
+#define VORONOICELLS_H
+
+#include <QFuture>
+#include <opencv2/core.hpp>
+#include <unordered_map>
+#include <vector>
+
+/// positions on the ground plane (z = 0) in cm, from which the Voronoi cells are computed
+struct VoronoiInput
+{
+    cv::Point2f              roiCorner1; ///< ground position of the left top corner of the recognition ROI
+    cv::Point2f              roiCorner2; ///< ground position of the right bottom corner
+    std::vector<cv::Point2f> positions;  ///< ground positions of the persons
+
+    friend bool operator==(const VoronoiInput &lhs, const VoronoiInput &rhs)
+    {
+        return lhs.roiCorner1 == rhs.roiCorner1 && lhs.roiCorner2 == rhs.roiCorner2 && lhs.positions == rhs.positions;
+    }
+};
+
+/// Voronoi cell of a person on the ground plane
+struct VoronoiCell
+{
+    std::vector<cv::Point2f> facet;   ///< corners in cm
+    cv::Point2f              center;  ///< position of the person in cm
+    float                    density; ///< 10000 / area of the facet, i.e. persons per m^2
+};
+
+std::vector<VoronoiCell> computeVoronoiCells(const VoronoiInput &input);
+
+/**
+ * @brief Voronoi cells per frame for the Voronoi overlay of TrackerItem
+ *
+ * The cells of a frame are only computed again if its input changed, e.g. when a
+ * trajectory is edited, so repainting for pans and zooms does not triangulate again.
+ * While playing, the cells of the next frames are computed in advance by worker threads.
+ */
+class VoronoiCache
+{
+public:
+    const std::vector<VoronoiCell> &cells(int frame, const VoronoiInput &input);
+    void                            prefetch(int frame, const VoronoiInput &input);
+    bool                            contains(int frame) const { return mFrames.find(frame) != mFrames.end(); }
+    void                            clear() { mFrames.clear(); }
+
+private:
+    /// frames kept at most; the ones farthest from the requested frame are dropped first
+    static constexpr std::size_t MAX_FRAMES = 256;
+
+    struct Entry
+    {
+        VoronoiInput                      input;
+        QFuture<std::vector<VoronoiCell>> pending; ///< computation in a worker thread, if not computed yet
+        std::vector<VoronoiCell>          cells;
+        bool                              computed = false;
+    };
+
+    void limitFrames(int frame);
+
+    std::unordered_map<int, Entry> mFrames;
+};
+
+#endif // VORONOICELLS_H
@@ -0,0 +1,84 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bufferedTextWriter.h"
+
+#include <QIODevice>
+#include <utility>
+
+/**
+ * @param device opened device, which has to outlive the writer
+ * @param blockSize the buffer is written to the device, when it reaches this size
+ */
+BufferedTextWriter::BufferedTextWriter(QIODevice &device, std::size_t blockSize) :
+    mDevice(device), mBlockSize(blockSize)
+{
+    mBuffer.reserve(blockSize + 4096);
+}
+
+BufferedTextWriter::~BufferedTextWriter()
+{
+    flush();
+}
+
+void BufferedTextWriter::printColor(const QColor &color)
+{
+    if(color.isValid())
+    {
+        print("{} {} {}", color.red(), color.green(), color.blue());
+    }
+    else
+    {
+        print("-1 -1 -1");
+    }
+}
+
+bool BufferedTextWriter::flush()
+{
+    if(mBuffer.size() > 0 && !mFailed)
+    {
+        const auto size = static_cast<qint64>(mBuffer.size());
+        mFailed         = mDevice.write(mBuffer.data(), size) != size;
+    }
+    mBuffer.clear();
+    return !mFailed;
+}
+
+/**
+ * @param callback receives the number of finished and of all steps
+ * @param total number of all steps
+ * @param interval minimal time between two calls of callback
+ */
+ThrottledProgress::ThrottledProgress(Callback callback, int total, std::chrono::milliseconds interval) :
+    mCallback(std::move(callback)), mTotal(total), mInterval(interval)
+{
+}
+
+void ThrottledProgress::update(int done)
+{
+    if(!mCallback)
+    {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if(done >= mTotal || now - mLastCall >= mInterval)
+    {
+        mLastCall = now;
+        mCallback(done, mTotal);
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUFFEREDTEXTWRITER_H
+#define BUFFEREDTEXTWRITER_H
+
+#include <QColor>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <spdlog/fmt/bundled/format.h>
+
+class QIODevice;
+
+/**
+ * @brief Formats text with fmt into a large buffer, which is written to a device in big blocks
+ *
+ * Used by the text exports of trajectories instead of QTextStream, which formats
+ * and converts every field on its own. Write numbers with "{:g}" to get the same
+ * text as QTextStream with its default settings (six significant digits).
+ *
+ * The writer does not touch any widget, so it can be used from a worker thread.
+ */
+class BufferedTextWriter
+{
+public:
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1 << 22;
+
+    explicit BufferedTextWriter(QIODevice &device, std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+    ~BufferedTextWriter();
+
+    BufferedTextWriter(const BufferedTextWriter &)            = delete;
+    BufferedTextWriter &operator=(const BufferedTextWriter &) = delete;
+
+    template <typename Format, typename... Args>
+    void print(const Format &format, const Args &...args)
+    {
+        fmt::format_to(std::back_inserter(mBuffer), format, args...);
+        if(mBuffer.size() >= mBlockSize)
+        {
+            flush();
+        }
+    }
+
+    /// same text as operator<<(QTextStream &, const QColor &)
+    void printColor(const QColor &color);
+
+    /// writes the buffer to the device; returns false, if any write failed so far
+    bool flush();
+    bool hasFailed() const { return mFailed; }
+
+private:
+    QIODevice         &mDevice;
+    const std::size_t  mBlockSize;
+    fmt::memory_buffer mBuffer;
+    bool               mFailed = false;
+};
+
+/**
+ * @brief Forwards the progress of a long operation at most once per interval
+ *
+ * The callback is called from the thread calling update(), e.g. an export running
+ * on a worker thread, and should only store the value for the GUI.
+ */
+class ThrottledProgress
+{
+public:
+    using Callback = std::function<void(int done, int total)>;
+
+    ThrottledProgress(Callback callback, int total, std::chrono::milliseconds interval = std::chrono::milliseconds(100));
+
+    /// the last step (done == total) is always forwarded
+    void update(int done);
+
+private:
+    Callback                              mCallback;
+    int                                   mTotal;
+    std::chrono::milliseconds             mInterval;
+    std::chrono::steady_clock::time_point mLastCall;
+};
+
+#endif // BUFFEREDTEXTWRITER_H
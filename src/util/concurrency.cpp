@@ -0,0 +1,161 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "concurrency.h"
+
+#include "logger.h"
+
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <opencv2/core.hpp>
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace
+{
+std::atomic<int>  threads{0};            ///< 0 until setThreadCount() or setProjectThreadCount() was called
+std::atomic<bool> commandLineSet{false}; ///< setThreadCount() was called with a count
+
+using concurrency::Pool;
+
+constexpr Pool POOLS[] = {Pool::Recognition, Pool::Tiles, Pool::Stages};
+
+void apply(int count)
+{
+    count = count > 0 ? count : concurrency::availableCores();
+    if(threads.exchange(count) == count)
+    {
+        return;
+    }
+    cv::setNumThreads(count);
+    QThreadPool::globalInstance()->setMaxThreadCount(count);
+    for(const auto which : POOLS)
+    {
+        concurrency::pool(which).setMaxThreadCount(count);
+    }
+    SPDLOG_INFO("Using {} threads.", count);
+}
+} // namespace
+
+/**
+ * @brief Number of cores this process may run on
+ *
+ * Less than the cores of the machine, if the process was pinned to some of them,
+ * e.g. by pin() or taskset.
+ */
+int concurrency::availableCores()
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    if(sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        return std::max(1, CPU_COUNT(&set));
+    }
+#endif
+    return std::max(1, QThread::idealThreadCount());
+}
+
+/**
+ * @brief Sets the number of threads given on the command line
+ *
+ * @param threads number of threads; 0 for all available cores, which projects may then change
+ */
+void concurrency::setThreadCount(int threads)
+{
+    commandLineSet = threads > 0;
+    apply(threads);
+}
+
+/**
+ * @brief Sets the number of threads of a loaded project, unless one was given on the command line
+ */
+void concurrency::setProjectThreadCount(int threads)
+{
+    if(!commandLineSet)
+    {
+        apply(threads);
+    }
+}
+
+int concurrency::threadCount()
+{
+    const int count = threads;
+    return count > 0 ? count : availableCores();
+}
+
+QThreadPool &concurrency::pool(Pool which)
+{
+    static QThreadPool                pools[std::size(POOLS)];
+    [[maybe_unused]] static const bool limited = []
+    {
+        for(auto &pool : pools)
+        {
+            pool.setMaxThreadCount(threadCount());
+        }
+        return true;
+    }();
+    return pools[static_cast<int>(which)];
+}
+
+/**
+ * @brief Restricts this process to the cores firstCpu to firstCpu + count - 1
+ *
+ * Must be called before any threads are started, as only threads started afterwards
+ * inherit the restriction on Linux. On NUMA servers, consecutive cores usually belong
+ * to the same node, so pinned processes keep their memory local.
+ *
+ * @return false, if pinning is not supported or failed
+ */
+bool concurrency::pin(int firstCpu, int count)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int cpu = firstCpu; cpu < firstCpu + count && cpu < CPU_SETSIZE; ++cpu)
+    {
+        CPU_SET(cpu, &set);
+    }
+    if(sched_setaffinity(0, sizeof(set), &set) != 0)
+    {
+        SPDLOG_WARN("Could not pin PeTrack to the cores {} to {}.", firstCpu, firstCpu + count - 1);
+        return false;
+    }
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for(int cpu = firstCpu; cpu < firstCpu + count && cpu < 8 * static_cast<int>(sizeof(mask)); ++cpu)
+    {
+        mask |= DWORD_PTR(1) << cpu;
+    }
+    if(mask == 0 || !SetProcessAffinityMask(GetCurrentProcess(), mask))
+    {
+        SPDLOG_WARN("Could not pin PeTrack to the cores {} to {}.", firstCpu, firstCpu + count - 1);
+        return false;
+    }
+#else
+    SPDLOG_WARN("Pinning PeTrack to cores is not supported on this system.");
+    return false;
+#endif
+    SPDLOG_INFO("Pinned PeTrack to the cores {} to {}.", firstCpu, firstCpu + count - 1);
+    return true;
+}
@@ -0,0 +1,54 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONCURRENCY_H
+#define CONCURRENCY_H
+
+class QThreadPool;
+
+/**
+ * @brief One thread count for OpenCV, Qt and the thread pools of PeTrack
+ *
+ * OpenCV (cv::parallel_for_), the global QThreadPool and the pools of PeTrack would
+ * each use all cores by default and oversubscribe them when running at the same time.
+ * setThreadCount() limits all of them to the same number of threads, given by
+ * -threads on the command line or the attribute THREADS of the project; the command
+ * line takes precedence.
+ *
+ * Work which waits for other parallel work runs in a pool of its own (see Pool), so
+ * the waiting tasks can never occupy all threads the awaited tasks need.
+ */
+namespace concurrency
+{
+/// pools for work which may run while work of another pool waits for it
+enum class Pool
+{
+    Recognition, ///< markers of several regions of a frame
+    Tiles,       ///< code markers of the tiles of a region
+    Stages,      ///< custom stages of the FramePipeline
+};
+
+int          availableCores();
+void         setThreadCount(int threads);
+void         setProjectThreadCount(int threads);
+int          threadCount();
+QThreadPool &pool(Pool which);
+bool         pin(int firstCpu, int count);
+} // namespace concurrency
+
+#endif // CONCURRENCY_H
@@ -39,7 +39,69 @@ const QString commandLineOptionsString = []() -> QString
          "ends after finishing the work"},
         {"-autoTrack|-autotrack trackerFile",
          "calculates automatically the trajectories of marked pedestrians and stores the result to "
-         "<kbd>trackerFile</kbd>"},
+         "<kbd>trackerFile</kbd>; a <kbd>trackerFile</kbd> ending with <kbd>.zst</kbd>, e.g. "
+         "<kbd>trajectories.trc.zst</kbd>, is compressed"},
+        {"-segments count",
+         "with <kbd>-autoTrack</kbd>: splits the sequence into <kbd>count</kbd> overlapping segments, which are "
+         "tracked by parallel <kbd>PeTrack</kbd> processes; the trajectories are joined in the overlapping frames"},
+        {"-segmentOverlap|-segmentoverlap frames",
+         "number of frames tracked by two neighboring segments (default 50)"},
+        {"-frameRange|-framerange first last",
+         "with <kbd>-autoTrack</kbd>: only tracks the frames from <kbd>first</kbd> to <kbd>last</kbd> and writes "
+         "the frame range next to <kbd>trackerFile</kbd> as partial result for <kbd>-merge</kbd>"},
+        {"-checkpoint frames",
+         "with <kbd>-autoTrack</kbd>: writes a checkpoint of the tracking next to <kbd>trackerFile</kbd> every "
+         "<kbd>frames</kbd> tracked frames (default 1000, 0 disables it); removed when the tracking is finished"},
+        {"-resume",
+         "with <kbd>-autoTrack</kbd>: continues an aborted run with the same <kbd>trackerFile</kbd> after the frame "
+         "of its last checkpoint instead of tracking from the start"},
+        {"-merge|--merge trackerFile partial.trc ...",
+         "stitches the partial results of <kbd>-autoTrack</kbd> runs with <kbd>-frameRange</kbd> (e.g. tracked on "
+         "different machines, best with <kbd>-noTrajectories</kbd>) in their overlapping frames to the trajectories "
+         "of the project and stores them to <kbd>trackerFile</kbd>"},
+        {"-sweep sweepFile report.csv",
+         "tracks the sequence of the project with every combination of the parameter values in the JSON file "
+         "<kbd>sweepFile</kbd> in parallel <kbd>PeTrack</kbd> processes and writes the number, average length and "
+         "failed plausibility checks of the trajectories per combination to <kbd>report.csv</kbd>"},
+        {"-batch jobFile report.csv",
+         "processes the projects listed with their action (<kbd>track</kbd>, <kbd>play</kbd>, <kbd>save</kbd> or "
+         "<kbd>exportView</kbd>) and output in the JSON file <kbd>jobFile</kbd> in parallel headless "
+         "<kbd>PeTrack</kbd> processes and writes the result and duration of every job to <kbd>report.csv</kbd>"},
+        {"-cameras cameraFile trackerFile",
+         "tracks the overlapping camera views listed with their project in the JSON file <kbd>cameraFile</kbd> at once "
+         "in parallel headless <kbd>PeTrack</kbd> processes, merges the trajectories of the same persons in different "
+         "views in world coordinates and stores them to the txt file <kbd>trackerFile</kbd>"},
+        {"-serve name",
+         "waits for jobs (one JSON object per line like in the job file of <kbd>-batch</kbd>, optionally with a "
+         "<kbd>priority</kbd>) on the local socket <kbd>name</kbd>, runs them in parallel headless <kbd>PeTrack</kbd> "
+         "processes, highest priority first, and streams their state and log back to the client"},
+        {"-jobs count",
+         "with <kbd>-sweep</kbd>, <kbd>-batch</kbd> or <kbd>-serve</kbd>: maximum number of processes running at once "
+         "(default: number of cores)"},
+        {"-threads count",
+         "number of threads used by OpenCV, Qt and PeTrack (default: number of cores or <kbd>THREADS</kbd> of the "
+         "project); with <kbd>-batch</kbd>: threads of each job (default: cores divided by <kbd>-jobs</kbd>)"},
+        {"-pin firstCore",
+         "runs PeTrack only on the cores from <kbd>firstCore</kbd> on (as many as <kbd>-threads</kbd>, Linux and "
+         "Windows); with <kbd>-batch</kbd>: pins each of the parallel jobs to its own consecutive cores, e.g. to keep "
+         "them on one NUMA node"},
+        {"-readOnlyCaches|-readonlycaches",
+         "uses the filtered frame store and the detection cache of the project without writing to them"},
+        {"-noTrajectories",
+         "opens the project without its trajectory file, so that only newly tracked trajectories are exported (used "
+         "by the processes of <kbd>-segments</kbd> and <kbd>-sweep</kbd>)"},
+        {"-headless",
+         "runs without showing the main window and without painting the frames (e.g. on machines without a display); "
+         "uses the <kbd>offscreen</kbd> platform, if <kbd>QT_QPA_PLATFORM</kbd> is not set"},
+        {"-trace traceFile",
+         "records where the time of the run goes and writes it as Chrome trace to <kbd>traceFile</kbd> when PeTrack "
+         "ends; open it in Perfetto or chrome://tracing (needs a build with the CMake option <kbd>TRACING</kbd>)"},
+        {"-python script.py",
+         "runs the Python script after loading the project (with <kbd>-autoTrack</kbd>: after tracking, before "
+         "exporting); <kbd>import petrack</kbd> gives the trajectories as numpy arrays and the calibration "
+         "transforms without exporting (needs a build with the CMake option <kbd>PYTHON</kbd>)"},
+        {"-profileStartup",
+         "logs how long the single steps of the startup take, from creating the main window to opening the sequence"},
         {"-autoReadMarkerID|-autoreadmarkerid markerIdFile",
          "automatically reads the <kbd>txt-file</kbd> including personID and markerID and applies the markerIDs to the "
          "corresponding person. If -autoTrack is not used, saving trackerFiles using -autoSaveTracker is recommended."},
@@ -52,6 +114,12 @@ const QString commandLineOptionsString = []() -> QString
         {"-autoExportView|-autoexportview outputFile",
          "exports the view, e.g., the undistorted video "
          "or the video with trajectories, to <kbd>outputFile</kbd>"},
+        {"-filterStatistics|-filterstatistics statisticsFile",
+         "with <kbd>-autoTrack</kbd> or <kbd>-autoPlay</kbd>: writes run time, reuse and allocation counters of the "
+         "filter pipeline to <kbd>statisticsFile</kbd> (JSON for <kbd>.json</kbd>, otherwise CSV)"},
+        {"-stageStatistics|-stagestatistics statisticsFile",
+         "with <kbd>-autoTrack</kbd>: writes the number of frames, frames/s and the run time of the stages decode, "
+         "filter, track, recognize and export as JSON to <kbd>statisticsFile</kbd>"},
         {"-autoIntrinsic | -autointrinsic calibDir",
          "performs intrinsic calibration with the files in <kbd>calibDir</kbd>. Saving the pet-file with "
          "<kbd>-autoSave</kbd> is recommended, since else the calculated parameters will be lost."}};
@@ -120,6 +188,49 @@ void copyToQImage(QImage &qImg, cv::Mat &img) // war static functin in animatiol
     }
 }
 
+/**
+ * @brief Lets qImg show img without copying its pixels
+ *
+ * Unlike copyToQImage, the QImage refers to the data of img. It holds a reference to it
+ * like a copy of the cv::Mat, which is released when the last copy of the QImage is
+ * destroyed, so the data outlives img. The QImage is read-only; modifying it makes a deep
+ * copy first.
+ *
+ * OpenCV writes into the existing data of a cv::Mat of the same size and type (e.g. the
+ * output of a filter), even if it is shared. So the data of img should only be
+ * overwritten by the next frame, which replaces qImg anyway.
+ *
+ * @param qImg image sharing the data of img afterwards; unchanged, if img has an unsupported number of channels
+ * @param img 8 bit image with 3 (BGR) or 1 channel(s)
+ */
+void shareToQImage(QImage &qImg, const cv::Mat &img)
+{
+    QImage::Format format;
+    switch(img.channels())
+    {
+        case 3:
+            format = QImage::Format_BGR888;
+            break;
+        case 1:
+            format = QImage::Format_Grayscale8;
+            break;
+        default:
+            SPDLOG_ERROR("{} channels are not supported!", img.channels());
+            return;
+    }
+
+    auto *reference = new cv::Mat(img);
+    // const data, so the QImage never writes into the cv::Mat; the cleanup function releases the reference
+    qImg = QImage(
+               static_cast<const uchar *>(reference->data),
+               reference->cols,
+               reference->rows,
+               static_cast<int>(reference->step),
+               format,
+               [](void *info) { delete static_cast<cv::Mat *>(info); },
+               reference);
+}
+
 
 /**
  * Create an opencv Rect from a given QRect
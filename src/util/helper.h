@@ -67,6 +67,7 @@ inline constexpr double PI = 3.141592654;
 // If the images are not the same size, a new qImg will be created with the same size as the iplImg.
 #include <QImage>
 void copyToQImage(QImage &qImg, cv::Mat &img);
+void shareToQImage(QImage &qImg, const cv::Mat &img);
 
 cv::Rect qRectToCvRect(const QRect &roi, const cv::Mat &img, bool evenPixelNumber = true);
 cv::Mat  getRoi(cv::Mat &img, const QRect &roi, cv::Rect &rect, bool evenPixelNumber = true);
@@ -21,6 +21,7 @@
 
 #include "util/logger.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <list>
 #include <string>
@@ -37,6 +38,9 @@
  * A value for an empty entry is needed for easy deletion and emptiness-checking of the structure.
  * In case of emptiness, the underlying container contains a single "empty" entry.
  *
+ * The entries are sorted by their start, so lookups are binary searches (O(log n)). Many
+ * changes at once should be done with assign or insertRange, which compact only once.
+ *
  * @tparam T the data type that shall be stored into key frames.
  */
 template <typename T>
@@ -91,29 +95,83 @@ public:
             mEntries.push_back({pos, value});
             return;
         }
-        for(auto it = mEntries.begin(); it != mEntries.end(); it++)
+        compactAround(set(pos, value));
+    }
+
+    /**
+     * Inserts several values at once, as if insert was called for every entry in the given order.
+     * The list is only compacted once at the end.
+     *
+     * @param entries start and value of the entries; they need not be sorted
+     */
+    void assign(std::vector<Entry> entries)
+    {
+        if(entries.empty())
         {
-            if(pos == it->start)
+            return;
+        }
+        if(this->empty())
+        {
+            mEntries.clear();
+        }
+        // of entries with the same start the last one wins, as for consecutive inserts
+        std::stable_sort(
+            entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.start < b.start; });
+        std::vector<Entry> merged;
+        merged.reserve(mEntries.size() + entries.size());
+        auto existing = mEntries.begin();
+        for(auto entry = entries.begin(); entry != entries.end(); ++entry)
+        {
+            if(std::next(entry) != entries.end() && std::next(entry)->start == entry->start)
             {
-                it->data = value;
-                break;
+                continue;
             }
-
-            if(pos < it->start)
+            for(; existing != mEntries.end() && existing->start < entry->start; ++existing)
             {
-                mEntries.insert(it, {pos, value});
-                break;
+                merged.push_back(*existing);
             }
-            // append if position is behind start of last entry
-            if(it == mEntries.end() - 1)
+            if(existing != mEntries.end() && existing->start == entry->start)
             {
-                mEntries.push_back({pos, value});
-                break;
+                ++existing;
             }
+            merged.push_back(*entry);
         }
+        merged.insert(merged.end(), existing, mEntries.end());
+        mEntries = std::move(merged);
         compact();
     }
 
+    /**
+     * Sets value for all positions from first to last (both inclusive); the values behind last stay unchanged.
+     *
+     * @param first first position of the range
+     * @param last last position of the range
+     * @param value data value
+     */
+    void insertRange(int first, int last, const T &value)
+    {
+        if(last < first)
+        {
+            return;
+        }
+        const T behind = getValue(last + 1);
+        // drop the entries inside the range, they are overwritten
+        const auto begin = std::upper_bound(
+            mEntries.begin(), mEntries.end(), first, [](int pos, const Entry &entry) { return pos < entry.start; });
+        const auto end = std::upper_bound(
+            mEntries.begin(), mEntries.end(), last + 1, [](int pos, const Entry &entry) { return pos < entry.start; });
+        if(begin < end)
+        {
+            mEntries.erase(begin, end);
+        }
+        if(mEntries.empty())
+        {
+            mEntries.push_back({0, mUndefinedValue});
+        }
+        // behind is the undefined value, if the list was empty or ended before, so this keeps it that way
+        assign({{first, value}, {last + 1, behind}});
+    }
+
     /**
      * Remove an interval (i.e. assign the undefinedValue for this part).
      * Works similar insert with the undefinedValue.
@@ -155,18 +213,12 @@ public:
      */
     int indexOf(int position) const
     {
-        if(position < mEntries.front().start)
-        {
-            return -1;
-        }
-        for(int i = 1; i < (int) mEntries.size(); ++i)
-        {
-            if(position < mEntries.at(i).start)
-            {
-                return i - 1;
-            }
-        }
-        return mEntries.size() - 1;
+        const auto behind = std::upper_bound(
+            mEntries.begin(),
+            mEntries.end(),
+            position,
+            [](int pos, const Entry &entry) { return pos < entry.start; });
+        return static_cast<int>(behind - mEntries.begin()) - 1;
     }
 
     /**
@@ -263,6 +315,43 @@ public:
      */
     bool empty() const { return this->size() == 0; }
 
+private:
+    /**
+     * Sets value at pos by replacing the entry starting at pos or inserting a new one.
+     * @return the index of the entry
+     */
+    size_t set(int pos, const T &value)
+    {
+        auto it = std::lower_bound(
+            mEntries.begin(), mEntries.end(), pos, [](const Entry &entry, int p) { return entry.start < p; });
+        if(it != mEntries.end() && it->start == pos)
+        {
+            it->data = value;
+        }
+        else
+        {
+            it = mEntries.insert(it, {pos, value});
+        }
+        return static_cast<size_t>(it - mEntries.begin());
+    }
+
+    /**
+     * Compacts the list after the entry at index was changed, assuming it was compact before.
+     */
+    void compactAround(size_t index)
+    {
+        if(index + 1 < mEntries.size() && mEntries[index + 1].data == mEntries[index].data)
+        {
+            mEntries.erase(mEntries.begin() + index + 1);
+        }
+        if(index > 0 && mEntries[index - 1].data == mEntries[index].data)
+        {
+            mEntries.erase(mEntries.begin() + index);
+        }
+    }
+
+public:
+
     /**
      *
      * @param value_tostring optional, custom to_string function to cast the value template parameter to a string.
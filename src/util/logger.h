@@ -21,9 +21,15 @@
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
 
 #include <QString>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <spdlog/async.h>
 #include <spdlog/fmt/bundled/format.h>
 #include <spdlog/fmt/ostr.h>
+#include <spdlog/sinks/dist_sink.h>
 #include <spdlog/sinks/ringbuffer_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/stdout_sinks.h>
 #include <spdlog/spdlog.h>
 
@@ -34,11 +40,42 @@ const std::string logFormat            = "[%s:%#:%!][%l] %v";
 const std::string messageBoxLoggerName = "pMessageBox";
 const std::string messageBoxLogFormat  = "[{}:{}:{}][{}] {}";
 
+/// number of messages kept for the log window, which is only created when it is opened
+constexpr std::size_t logHistorySize = 1000;
+/// number of messages queued for the logging thread; the oldest are dropped, if the queue is full
+constexpr std::size_t logQueueSize = 8192;
+
+/// messages logged before the log window was opened
+inline std::shared_ptr<spdlog::sinks::ringbuffer_sink_mt> &historySink()
+{
+    static auto sink = std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(logHistorySize);
+    return sink;
+}
+
+/// the log window adds its sink here; the sinks of the (asynchronous) default logger are never changed
+inline std::shared_ptr<spdlog::sinks::dist_sink_mt> &logWindowSink()
+{
+    static auto sink = std::make_shared<spdlog::sinks::dist_sink_mt>();
+    return sink;
+}
+
+/**
+ * @brief Sets up the default logger
+ *
+ * The default logger is asynchronous: the messages are formatted and written to the
+ * command line, the history and the log window by a separate thread, so logging in
+ * the tracking and recognition does not wait for the console or the GUI.
+ */
 inline void setupLogger()
 {
-    // add ringbuffer_sink to default logger to store messages for logwindow
-    auto ringbufferSink = std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(10);
-    spdlog::default_logger()->sinks().push_back(ringbufferSink);
+    spdlog::init_thread_pool(logQueueSize, 1);
+    std::vector<spdlog::sink_ptr> sinks{
+        std::make_shared<spdlog::sinks::stdout_color_sink_mt>(), historySink(), logWindowSink()};
+    auto defaultLogger = std::make_shared<spdlog::async_logger>(
+        "petrack", sinks.begin(), sinks.end(), spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+    spdlog::set_default_logger(defaultLogger);
+    // write the queued messages before exiting
+    std::atexit([]() { spdlog::shutdown(); });
 
     // setup global logger, which should be used to display message on the command line only
     spdlog::set_level(spdlog::level::trace);
@@ -49,8 +86,74 @@ inline void setupLogger()
     auto messageBoxLogger = spdlog::stdout_logger_mt("pMessageBox");
     messageBoxLogger->set_pattern("%v");
 }
+
+/**
+ * @brief Lets at most a number of messages per interval pass, for messages logged per frame or per person
+ *
+ * Used by the LOG_*_LIMITED macros with one RateLimit per call site.
+ */
+class RateLimit
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RateLimit(int maxMessages = 10, Clock::duration interval = std::chrono::seconds(1)) :
+        mMaxMessages(maxMessages), mInterval(interval)
+    {
+    }
+
+    /**
+     * @brief Checks if a message may be logged now
+     *
+     * @return -1, if the message is suppressed, otherwise the number of messages suppressed since the last one
+     */
+    int pass(Clock::time_point now = Clock::now())
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(now - mIntervalStart >= mInterval)
+        {
+            mIntervalStart = now;
+            mMessages      = 0;
+        }
+        if(mMessages >= mMaxMessages)
+        {
+            ++mSuppressed;
+            return -1;
+        }
+        ++mMessages;
+        const int suppressed = mSuppressed;
+        mSuppressed          = 0;
+        return suppressed;
+    }
+
+private:
+    std::mutex        mMutex;
+    int               mMaxMessages;
+    Clock::duration   mInterval;
+    Clock::time_point mIntervalStart;
+    int               mMessages   = 0;
+    int               mSuppressed = 0;
+};
 } // namespace logger
 
+/// logs at most 10 messages per second from this line and how many were suppressed in between
+#define LOG_LIMITED(level, ...)                                                                                        \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        static logger::RateLimit rateLimit;                                                                            \
+        if(const int suppressed = rateLimit.pass(); suppressed >= 0)                                                   \
+        {                                                                                                              \
+            if(suppressed > 0)                                                                                         \
+            {                                                                                                          \
+                SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), level, "({} messages suppressed)", suppressed);       \
+            }                                                                                                          \
+            SPDLOG_LOGGER_CALL(spdlog::default_logger_raw(), level, __VA_ARGS__);                                      \
+        }                                                                                                              \
+    } while(false)
+
+#define LOG_INFO_LIMITED(...) LOG_LIMITED(spdlog::level::info, __VA_ARGS__)
+#define LOG_WARN_LIMITED(...) LOG_LIMITED(spdlog::level::warn, __VA_ARGS__)
+
 template <>
 struct fmt::formatter<QString>
 {
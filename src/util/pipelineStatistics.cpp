@@ -0,0 +1,114 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pipelineStatistics.h"
+
+#include "logger.h"
+
+#include <QFile>
+#include <QJsonDocument>
+
+/**
+ * @brief Returns the statistics of the frames processed after earlier was taken
+ *
+ * @param earlier copy of these statistics taken before
+ */
+PipelineStatistics PipelineStatistics::since(const PipelineStatistics &earlier) const
+{
+    PipelineStatistics difference;
+    difference.frames     = frames - earlier.frames;
+    difference.tracked    = tracked - earlier.tracked;
+    difference.recognized = recognized - earlier.recognized;
+    difference.seconds    = seconds - earlier.seconds;
+    difference.decode     = decode - earlier.decode;
+    difference.filter     = filter - earlier.filter;
+    difference.track      = track - earlier.track;
+    difference.recognize  = recognize - earlier.recognize;
+    difference.render     = render - earlier.render;
+    difference.output     = output - earlier.output;
+    difference.memory     = memory;
+    return difference;
+}
+
+/**
+ * @brief Returns the statistics as JSON object; all times in s, the memory in bytes
+ *
+ *     {"frames": 100, "seconds": 2.5, "framesPerSecond": 40,
+ *      "stages": {"decode": 0.4, "filter": 0.6, "track": 0.8, "recognize": 0.5, "render": 0, "export": 0.05},
+ *      "memory": {"Trajectories": 1048576, "Undo history": 0}}
+ */
+QJsonObject PipelineStatistics::toJson() const
+{
+    const QJsonObject stages{
+        {"decode", decode},
+        {"filter", filter},
+        {"track", track},
+        {"recognize", recognize},
+        {"render", render},
+        {"export", output}};
+    QJsonObject memoryJson;
+    for(const auto &[name, bytes] : memory)
+    {
+        memoryJson[name] = static_cast<qint64>(bytes);
+    }
+    return QJsonObject{
+        {"frames", frames},
+        {"seconds", seconds},
+        {"framesPerSecond", framesPerSecond()},
+        {"stages", stages},
+        {"memory", memoryJson}};
+}
+
+/**
+ * @brief Writes the statistics to the log (window)
+ */
+void PipelineStatistics::log() const
+{
+    SPDLOG_INFO(
+        "Pipeline: {} frames in {:.2f} s ({:.1f} frames/s); decode {:.2f} s, filter {:.2f} s, track {:.2f} s, "
+        "recognize {:.2f} s, export {:.2f} s",
+        frames,
+        seconds,
+        framesPerSecond(),
+        decode,
+        filter,
+        track,
+        recognize,
+        output);
+    for(const auto &[name, bytes] : memory)
+    {
+        SPDLOG_INFO("Memory {:<16} {:>10.1f} MB", name, bytes / (1024. * 1024.));
+    }
+}
+
+/**
+ * @brief Writes the statistics as JSON to fileName
+ *
+ * @return true, if the file could be written
+ */
+bool PipelineStatistics::write(const QString &fileName) const
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not write stage statistics to {}.", fileName);
+        return false;
+    }
+    const QByteArray json = QJsonDocument(toJson()).toJson();
+    return file.write(json) == json.size();
+}
@@ -0,0 +1,78 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PIPELINESTATISTICS_H
+#define PIPELINESTATISTICS_H
+
+#include <QJsonObject>
+#include <QString>
+#include <chrono>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/// Memory used per subsystem in bytes, e.g. {"Undo history", 1048576}
+using MemoryUsage = std::vector<std::pair<QString, std::size_t>>;
+
+/**
+ * @brief Wall time of the stages of processing a sequence
+ *
+ * Written by -stageStatistics, e.g. to compare the run time of the regression tests
+ * with a baseline, and shown per frame by the StatisticsPanel. The recognition runs
+ * on a worker while the frame is tracked, so recognize only contains the time the
+ * main thread waited for it and the matching of the detections with the tracked persons.
+ */
+struct PipelineStatistics
+{
+    long long   frames     = 0;  ///< processed frames
+    long long   tracked    = 0;  ///< persons tracked, summed over the frames
+    long long   recognized = 0;  ///< persons recognized, summed over the frames
+    double      seconds    = 0.; ///< wall time of the whole run including stages not listed
+    double      decode     = 0.; ///< reading and decoding the frames
+    double      filter     = 0.;
+    double      track      = 0.;
+    double      recognize  = 0.;
+    double      render     = 0.; ///< showing the frames in the view
+    double      output     = 0.; ///< export of the trajectories
+    MemoryUsage memory;          ///< used at the end of the run
+
+    double             framesPerSecond() const { return seconds > 0. ? frames / seconds : 0.; }
+    PipelineStatistics since(const PipelineStatistics &earlier) const;
+    QJsonObject        toJson() const;
+    void               log() const;
+    bool               write(const QString &fileName) const;
+};
+
+/**
+ * @brief Adds the wall time between its construction and its destruction to seconds
+ */
+class StageTimer
+{
+public:
+    explicit StageTimer(double &seconds) : mSeconds(seconds), mStart(std::chrono::steady_clock::now()) {}
+    ~StageTimer() { mSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count(); }
+
+    StageTimer(const StageTimer &)            = delete;
+    StageTimer &operator=(const StageTimer &) = delete;
+
+private:
+    double                               &mSeconds;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+#endif // PIPELINESTATISTICS_H
@@ -0,0 +1,168 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+
+#include "bufferedTextWriter.h"
+#include "logger.h"
+
+#include <QFile>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Event
+{
+    const char *name;
+    double      start;    ///< in µs since the start of the recording
+    double      duration; ///< in µs
+    int         thread;
+};
+
+std::atomic<bool>  recording{false};
+std::mutex         eventsMutex;
+std::vector<Event> events;
+Clock::time_point  recordingStart;
+
+/// Small number of the calling thread, in the order the threads recorded their first zone
+int threadNumber()
+{
+    static std::atomic<int> nextNumber{0};
+    thread_local const int  number = nextNumber++;
+    return number;
+}
+
+double microseconds(Clock::duration duration)
+{
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+} // namespace
+
+namespace trace
+{
+/**
+ * @brief Starts recording the zones; zones recorded before are discarded
+ *
+ * @return false, if already recording
+ */
+bool start()
+{
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    if(recording)
+    {
+        return false;
+    }
+    events.clear();
+    recordingStart = Clock::now();
+    recording      = true;
+    return true;
+}
+
+/**
+ * @brief Stops recording and writes the recorded zones to fileName in the Chrome trace event format
+ *
+ * @return false, if not recording or the file could not be written
+ */
+bool stop(const QString &fileName)
+{
+    std::vector<Event> recorded;
+    {
+        std::lock_guard<std::mutex> lock(eventsMutex);
+        if(!recording)
+        {
+            return false;
+        }
+        recording = false;
+        recorded.swap(events);
+    }
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        SPDLOG_ERROR("Could not write the trace to {}.", fileName);
+        return false;
+    }
+    BufferedTextWriter out(file);
+    out.print("{{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for(size_t i = 0; i < recorded.size(); ++i)
+    {
+        const Event &event = recorded[i];
+        out.print(
+            "{{\"name\": \"{}\", \"ph\": \"X\", \"ts\": {:.3f}, \"dur\": {:.3f}, \"pid\": 1, \"tid\": {}}}{}\n",
+            event.name,
+            event.start,
+            event.duration,
+            event.thread,
+            i + 1 < recorded.size() ? "," : "");
+    }
+    out.print("]}}\n");
+    if(!out.flush())
+    {
+        SPDLOG_ERROR("Could not write the trace to {}.", fileName);
+        return false;
+    }
+    SPDLOG_INFO("Wrote {} zones to {}.", recorded.size(), fileName);
+    return true;
+}
+
+bool isRecording()
+{
+    return recording;
+}
+
+Zone::Zone(const char *name) : mName(recording ? name : nullptr)
+{
+    if(mName)
+    {
+        mStart = Clock::now();
+    }
+}
+
+Zone::~Zone()
+{
+    if(!mName)
+    {
+        return;
+    }
+    const auto                  end = Clock::now();
+    std::lock_guard<std::mutex> lock(eventsMutex);
+    // zones ending after stop() or after a restart are dropped
+    if(recording && mStart >= recordingStart)
+    {
+        events.push_back({mName, microseconds(mStart - recordingStart), microseconds(end - mStart), threadNumber()});
+    }
+}
+
+Session::Session(QString fileName) : mFileName(std::move(fileName))
+{
+#ifndef TRACING
+    SPDLOG_WARN("PeTrack was built without TRACING, the trace {} will not contain any zones.", mFileName);
+#endif
+    start();
+}
+
+Session::~Session()
+{
+    stop(mFileName);
+}
+} // namespace trace
@@ -0,0 +1,82 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+#include <chrono>
+
+/**
+ * @brief Scoped zones recorded as Chrome trace, e.g. to see where the time of a tracking run goes
+ *
+ * Put TRACE_ZONE("Class::function") at the start of a scope; the time until the end of the
+ * scope is recorded as one zone of the calling thread. The zones are only compiled in with
+ * the CMake option TRACING, otherwise TRACE_ZONE expands to nothing.
+ *
+ * The recording is started by a Session (petrack -trace file.json) and written when the
+ * session ends. The file can be opened in https://ui.perfetto.dev or chrome://tracing.
+ * Zones are meant for steps taking at least some microseconds, like a filter or a
+ * recognition, not for inner loops: every recorded zone takes a lock.
+ */
+namespace trace
+{
+bool start();
+bool stop(const QString &fileName);
+bool isRecording();
+
+/// Records the time between its construction and its destruction, if recording
+class Zone
+{
+public:
+    explicit Zone(const char *name);
+    ~Zone();
+
+    Zone(const Zone &)            = delete;
+    Zone &operator=(const Zone &) = delete;
+
+private:
+    const char                           *mName; ///< nullptr, if not recording; has to outlive the recording
+    std::chrono::steady_clock::time_point mStart;
+};
+
+/// Records from its construction to its destruction and writes the zones to fileName then
+class Session
+{
+public:
+    explicit Session(QString fileName);
+    ~Session();
+
+    Session(const Session &)            = delete;
+    Session &operator=(const Session &) = delete;
+
+private:
+    QString mFileName;
+};
+} // namespace trace
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b)      TRACE_CONCAT_IMPL(a, b)
+
+#ifdef TRACING
+#define TRACE_ZONE(name) trace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#else
+#define TRACE_ZONE(name)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,42 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+
+/**
+ * @brief Counts the allocations of all threads since its construction
+ *
+ * The benchmarks replace the global operator new, so every allocation of the C++ containers
+ * (also inside of OpenCV) is counted. Memory allocated with malloc directly, e.g. the data of
+ * a cv::Mat or of the Qt containers, is not counted.
+ */
+class AllocationCounter
+{
+public:
+    AllocationCounter();
+
+    std::size_t allocations() const;
+
+private:
+    std::size_t mStart;
+};
+
+#endif // ALLOCATIONCOUNTER_H
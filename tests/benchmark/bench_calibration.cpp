@@ -0,0 +1,63 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "control.h"
+#include "extrCalibration.h"
+#include "petrack.h"
+
+#include <QDomDocument>
+#include <catch2/catch.hpp>
+
+TEST_CASE("Back projection", "[benchmark][calibration]")
+{
+    Petrack          petrack{"Unknown"};
+    ExtrCalibration *calib = petrack.getExtrCalibration();
+
+    QDomDocument doc;
+    doc.setContent(QString(R"(<CONTROL>
+            <CALIBRATION>
+                <EXTRINSIC_PARAMETERS EXTR_ROT_1="0.1" EXTR_ROT_2="-0.2" EXTR_ROT_3="0.3" EXTR_TRANS_1="10" EXTR_TRANS_2="-20" EXTR_TRANS_3="-500" />
+            </CALIBRATION>
+        </CONTROL>)"));
+    petrack.getControlWidget()->getXml(doc.documentElement(), QString("0.10.0"));
+
+    // one point every 16 pixel of a full HD frame
+    std::vector<cv::Point2f> points;
+    for(int y = 0; y < 1080; y += 16)
+    {
+        for(int x = 0; x < 1920; x += 16)
+        {
+            points.emplace_back(x, y);
+        }
+    }
+
+    const std::string count = std::to_string(points.size()) + " points";
+    BENCHMARK("get3DPoint, " + count)
+    {
+        cv::Point3f sum;
+        for(const auto &point : points)
+        {
+            sum += calib->get3DPoint(point, 180);
+        }
+        return sum;
+    };
+    BENCHMARK("get3DPoint batch, " + count)
+    {
+        return calib->get3DPoint(points, 180);
+    };
+}
@@ -0,0 +1,71 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "benchmarkData.h"
+#include "borderFilter.h"
+#include "brightContrastFilter.h"
+#include "calibFilter.h"
+#include "fusedPreprocessor.h"
+#include "swapFilter.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Filters", "[benchmark][filter]")
+{
+    cv::Mat img = texturedFrame();
+
+    SwapFilter swap;
+    swap.getSwapHorizontally().setValue(true);
+    BrightContrastFilter brightContrast;
+    brightContrast.getBrightness().setValue(20.);
+    brightContrast.getContrast().setValue(-30.);
+    BorderFilter border;
+    border.getBorderSize().setValue(50);
+    CalibFilter calib;
+    calib.setEnabled(true);
+
+    BENCHMARK("SwapFilter")
+    {
+        return swap.apply(img);
+    };
+    BENCHMARK("BrightContrastFilter")
+    {
+        return brightContrast.apply(img);
+    };
+    BENCHMARK("BorderFilter")
+    {
+        return border.apply(img);
+    };
+    BENCHMARK("CalibFilter")
+    {
+        return calib.apply(img);
+    };
+    BENCHMARK("filter chain")
+    {
+        cv::Mat res = swap.apply(img);
+        res         = brightContrast.apply(res);
+        res         = border.apply(res);
+        return calib.apply(res);
+    };
+
+    FusedPreprocessor fused;
+    BENCHMARK("FusedPreprocessor")
+    {
+        return fused.apply(img, swap, brightContrast, border, calib);
+    };
+}
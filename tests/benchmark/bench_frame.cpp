@@ -0,0 +1,75 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "animation.h"
+#include "benchmarkData.h"
+#include "control.h"
+#include "petrack.h"
+#include "player.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <catch2/catch.hpp>
+
+namespace
+{
+/// shows the next frame of the sequence, starting again at the first one after the last
+bool nextFrame(Player *player)
+{
+    return player->frameForward() || player->skipToFrame(0);
+}
+} // namespace
+
+TEST_CASE("Processing the frames of the regression videos", "[benchmark][frame]")
+{
+    const QString project = benchmarkData(GENERATE(
+        as<QString>{},
+        "markerCasern.pet",
+        "markerJapan.pet",
+        "blackdotMarker.pet",
+        "multicolor.pet",
+        "codeMarker.pet"));
+    if(!QFile::exists(project))
+    {
+        WARN("Missing benchmark data " << project.toStdString());
+        return;
+    }
+
+    Petrack petrack{"Unknown"};
+    petrack.setHeadless(true);
+    petrack.openProject(project);
+    REQUIRE(petrack.getAnimation()->getNumFrames() > 0);
+
+    Control   *control = petrack.getControlWidget();
+    Player    *player  = petrack.getPlayer();
+    const auto name    = QFileInfo(project).completeBaseName().toStdString();
+
+    control->setOnlineTrackingChecked(false);
+    control->setPerformRecognitionChecked(false);
+    BENCHMARK("filters per frame, " + name)
+    {
+        return nextFrame(player);
+    };
+
+    control->setOnlineTrackingChecked(true);
+    control->setPerformRecognitionChecked(true);
+    BENCHMARK("recognition and tracking per frame, " + name)
+    {
+        return nextFrame(player);
+    };
+}
@@ -0,0 +1,57 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "benchmarkData.h"
+#include "tracker.h"
+#include "trcReader.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
+#include <catch2/catch.hpp>
+
+TEST_CASE("Trajectory files", "[benchmark][IO]")
+{
+    const QString fileName = benchmarkData(GENERATE(as<QString>{}, "markerCasern_truth.trc", "multicolor_truth.trc"));
+    if(!QFile::exists(fileName))
+    {
+        WARN("Missing benchmark data " << fileName.toStdString());
+        return;
+    }
+
+    const auto read = IO::readTrc(fileName);
+    REQUIRE(std::holds_alternative<IO::TrcData>(read));
+    const auto &persons = std::get<IO::TrcData>(read).persons;
+
+    const std::string name = QFileInfo(fileName).fileName().toStdString();
+    BENCHMARK("readTrc " + name)
+    {
+        return IO::readTrc(fileName);
+    };
+    BENCHMARK("readTrc sequential " + name)
+    {
+        return IO::readTrc(fileName, false);
+    };
+    BENCHMARK("writeTrc " + name)
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        writeTrc(buffer, persons);
+        return buffer.size();
+    };
+}
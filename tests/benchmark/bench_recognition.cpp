@@ -0,0 +1,141 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "benchmarkData.h"
+#include "intrinsicCameraParams.h"
+#include "recognition.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/objdetect/aruco_dictionary.hpp>
+
+using namespace reco;
+
+TEST_CASE("Color thresholding", "[benchmark][recognition]")
+{
+    cv::Mat hsv;
+    cv::cvtColor(texturedFrame(), hsv, cv::COLOR_BGR2HSV);
+    detail::ColorParameters param;
+    param.h_low  = 40;
+    param.h_high = 80;
+    param.s_low  = 50;
+    param.v_low  = 50;
+
+    cv::Mat bin;
+    BENCHMARK("thresholdHSV")
+    {
+        detail::thresholdHSV(hsv, bin, param);
+        return bin.data;
+    };
+    param.inversHue = true;
+    BENCHMARK("thresholdHSV inverted hue")
+    {
+        detail::thresholdHSV(hsv, bin, param);
+        return bin.data;
+    };
+}
+
+TEST_CASE("Color blob extraction", "[benchmark][recognition]")
+{
+    cv::Mat hsv;
+    cv::cvtColor(texturedFrame(), hsv, cv::COLOR_BGR2HSV);
+    detail::ColorParameters param;
+    param.h_low  = 40;
+    param.h_high = 80;
+    param.s_low  = 50;
+    param.v_low  = 50;
+    cv::Mat mask;
+    detail::thresholdHSV(hsv, mask, param);
+
+    cv::Mat bin;
+    for(int radius : {5, 10})
+    {
+        BENCHMARK("morphologyDisk radius " + std::to_string(radius))
+        {
+            mask.copyTo(bin);
+            detail::morphologyDisk(bin, cv::MORPH_OPEN, radius);
+            return bin.data;
+        };
+    }
+    BENCHMARK("findBlobContours")
+    {
+        return detail::findBlobContours(mask, 1000).size();
+    };
+}
+
+TEST_CASE("Code marker detection", "[benchmark][recognition]")
+{
+    // 144 markers of 40 pixel (10 cm) on a full HD frame
+    constexpr int markerSize = 40;
+    const auto    dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_ARUCO_ORIGINAL);
+    cv::Mat       gray(1080, 1920, CV_8UC1, cv::Scalar(255));
+    int           id = 0;
+    for(int y = markerSize; y + markerSize < gray.rows; y += 3 * markerSize)
+    {
+        for(int x = markerSize; x + markerSize < gray.cols; x += 3 * markerSize)
+        {
+            cv::Mat marker;
+            cv::aruco::generateImageMarker(dictionary, id++, markerSize, marker, 1);
+            marker.copyTo(gray(cv::Rect(x, y, markerSize, markerSize)));
+        }
+    }
+    cv::Mat img;
+    cv::cvtColor(gray, img, cv::COLOR_GRAY2BGR);
+
+    CodeMarkerSettings settings;
+    settings.indexOfMarkerDict   = cv::aruco::DICT_ARUCO_ORIGINAL;
+    settings.cmPerPixelMin       = 0.25;
+    settings.cmPerPixelMax       = 0.25;
+    settings.imageLength         = img.cols;
+    settings.roiLength           = img.cols;
+    settings.estimateOrientation = false;
+
+    settings.detectors = std::make_shared<ArucoDetectorCache>(settings.detectorParams, settings.indexOfMarkerDict);
+    const IntrinsicCameraParams    intrinsic;
+    std::vector<CodeMarkerOverlay> overlays;
+
+    BENCHMARK("findCodeMarker")
+    {
+        overlays.clear();
+        return detail::findCodeMarker(img, RecognitionMethod::Code, settings, intrinsic, overlays).size();
+    };
+
+    settings.tileSize = 512;
+    BENCHMARK("findCodeMarker in tiles")
+    {
+        overlays.clear();
+        return detail::findCodeMarker(img, RecognitionMethod::Code, settings, intrinsic, overlays).size();
+    };
+
+    // candidates from a downscaled frame, decoded at full resolution; all markers have to be found as before
+    settings.tileSize = 0;
+    for(int decimate : {2, 3})
+    {
+        settings.detectorParams.setQuadDecimate(decimate);
+        settings.detectors = std::make_shared<ArucoDetectorCache>(settings.detectorParams, settings.indexOfMarkerDict);
+
+        overlays.clear();
+        const auto found = detail::findCodeMarker(img, RecognitionMethod::Code, settings, intrinsic, overlays);
+        CHECK(found.size() == id);
+
+        BENCHMARK("findCodeMarker decimated by " + std::to_string(decimate))
+        {
+            overlays.clear();
+            return detail::findCodeMarker(img, RecognitionMethod::Code, settings, intrinsic, overlays).size();
+        };
+    }
+}
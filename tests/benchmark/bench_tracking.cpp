@@ -0,0 +1,163 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "allocationCounter.h"
+#include "benchmarkData.h"
+#include "frameContext.h"
+#include "personStorage.h"
+#include "petrack.h"
+#include "tracker.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+constexpr int GRID_STEP = 40; ///< distance of the persons in pixel
+
+/// adds one person every GRID_STEP pixel in frame 0
+void addPersonGrid(PersonStorage &storage, cv::Size size)
+{
+    int nr = 0;
+    for(int y = GRID_STEP; y < size.height - GRID_STEP; y += GRID_STEP)
+    {
+        for(int x = GRID_STEP; x < size.width - GRID_STEP; x += GRID_STEP)
+        {
+            storage.addPerson({++nr, 0, TrackPoint{Vec2F(x, y)}});
+        }
+    }
+}
+} // namespace
+
+TEST_CASE("Optical flow tracking", "[benchmark][tracking]")
+{
+    Petrack  petrack{"Unknown"};
+    Tracker *tracker = petrack.getTracker();
+
+    // the persons move by 3 pixel from frame to frame
+    const cv::Mat first = texturedFrame();
+    cv::Mat       second;
+    cv::warpAffine(first, second, cv::Mat(cv::Matx23d(1, 0, 3, 0, 1, 2)), first.size(), cv::INTER_LINEAR);
+    const FrameContext even{first};
+    const FrameContext odd{second};
+
+    cv::Rect rect(0, 0, first.cols, first.rows);
+    tracker->init(first.size());
+    addPersonGrid(petrack.getPersonStorage(), first.size());
+    tracker->track(even, rect, cv::Mat(), 0, false, 0, 0, reco::RecognitionMethod::Casern);
+
+    int frame = 0;
+    BENCHMARK(QString("Tracker::track, %1 persons").arg(petrack.getPersonStorage().nbPersons()).toStdString())
+    {
+        ++frame;
+        return tracker->track(
+            frame % 2 == 0 ? even : odd, rect, cv::Mat(), frame, false, 0, 0, reco::RecognitionMethod::Casern);
+    };
+}
+
+TEST_CASE("Allocations of the tracking loop", "[benchmark][tracking]")
+{
+    Petrack  petrack{"Unknown"};
+    Tracker *tracker = petrack.getTracker();
+
+    const cv::Mat first = texturedFrame();
+    cv::Mat       second;
+    cv::warpAffine(first, second, cv::Mat(cv::Matx23d(1, 0, 3, 0, 1, 2)), first.size(), cv::INTER_LINEAR);
+    const FrameContext even{first};
+    const FrameContext odd{second};
+
+    cv::Rect rect(0, 0, first.cols, first.rows);
+    tracker->init(first.size());
+    addPersonGrid(petrack.getPersonStorage(), first.size());
+
+    QSet<size_t> half;
+    for(size_t i = 0; i < petrack.getPersonStorage().nbPersons(); i += 2)
+    {
+        half.insert(i);
+    }
+
+    // frame 1 and 0 are tracked alternately with reTrack, so no trajectory grows (steady state);
+    // OpenCV runs sequentially, so its own allocations do not depend on the split into threads
+    const int numThreads = cv::getNumThreads();
+    cv::setNumThreads(0);
+    int        frame       = 0;
+    const auto trackFrames = [&](int count, const QSet<size_t> &onlyVisible)
+    {
+        AllocationCounter counter;
+        for(int i = 0; i < count; ++i)
+        {
+            frame = 1 - frame;
+            tracker->track(
+                frame == 0 ? even : odd,
+                rect,
+                cv::Mat(),
+                frame,
+                true,
+                0,
+                0,
+                reco::RecognitionMethod::Casern,
+                3,
+                onlyVisible);
+        }
+        return counter.allocations();
+    };
+    // the buffers of the tracker grow in the first frames
+    trackFrames(4, {});
+
+    constexpr int frames          = 10;
+    const auto    allocationsAll  = trackFrames(frames, {});
+    const auto    allocationsHalf = trackFrames(frames, half);
+    cv::setNumThreads(numThreads);
+
+    INFO("allocations per frame: " << allocationsAll / frames);
+    // all allocations left are per call of OpenCV, none per person
+    CHECK(allocationsAll <= allocationsHalf);
+}
+
+TEST_CASE("Adding recognized points", "[benchmark][tracking]")
+{
+    Petrack        petrack{"Unknown"};
+    PersonStorage &storage = petrack.getPersonStorage();
+    const cv::Size size(1920, 1080);
+    addPersonGrid(storage, size);
+
+    // the recognition finds every person again, slightly moved
+    QList<TrackPoint> recognized;
+    for(const auto &person : storage.getPersons())
+    {
+        recognized.append(TrackPoint(person.at(0) + Vec2F(2, 1), 80));
+    }
+
+    const std::string persons = std::to_string(storage.nbPersons()) + " persons";
+    BENCHMARK("PersonStorage::addPoint, " + persons)
+    {
+        for(auto point : recognized)
+        {
+            storage.addPoint(point, 0, {}, reco::RecognitionMethod::Casern);
+        }
+        return storage.nbPersons();
+    };
+    BENCHMARK("PersonStorage::addPoint with point grid, " + persons)
+    {
+        TrackPointGrid grid = storage.buildPointGrid(0);
+        for(auto point : recognized)
+        {
+            storage.addPoint(point, 0, {}, reco::RecognitionMethod::Casern, nullptr, &grid);
+        }
+        return storage.nbPersons();
+    };
+}
@@ -0,0 +1,41 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARKDATA_H
+#define BENCHMARKDATA_H
+
+#include <QDir>
+#include <QString>
+#include <opencv2/opencv.hpp>
+
+/// Path of a file of the regression test data, e.g. a video processed by the end-to-end benchmarks
+inline QString benchmarkData(const QString &fileName)
+{
+    return QDir(BENCHMARK_DATA_DIR).filePath(fileName);
+}
+
+/// Full HD frame with a smooth random texture, so the optical flow finds structure everywhere
+inline cv::Mat texturedFrame(int type = CV_8UC3, cv::Size size = {1920, 1080})
+{
+    cv::Mat frame(size, type);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::GaussianBlur(frame, frame, {0, 0}, 3);
+    return frame;
+}
+
+#endif // BENCHMARKDATA_H
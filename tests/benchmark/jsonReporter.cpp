@@ -0,0 +1,93 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <catch2/catch.hpp>
+#include <chrono>
+
+namespace
+{
+/// nanoseconds of a duration measured by Catch2
+template <typename Duration>
+double toNanoseconds(const Duration &duration)
+{
+    return std::chrono::duration<double, std::nano>(duration).count();
+}
+
+/**
+ * @brief Writes the results of all benchmarks as one JSON document
+ *
+ * Select it with -r json; together with -o the results can be compared between commits:
+ *
+ *     {
+ *         "version": "0.10.5",
+ *         "benchmarks": [
+ *             {"testCase": "Filters", "name": "CalibFilter 1920x1080", "samples": 100, "iterations": 1,
+ *              "mean": 1234567.0, "meanLow": ..., "meanHigh": ..., "standardDeviation": ..., "outlierVariance": ...}
+ *         ]
+ *     }
+ *
+ * All times are in ns per run of the benchmark.
+ */
+class JsonReporter : public Catch::StreamingReporterBase<JsonReporter>
+{
+public:
+    using StreamingReporterBase::StreamingReporterBase;
+
+    static std::string getDescription() { return "Reports the results of the benchmarks as JSON"; }
+
+    void assertionStarting(const Catch::AssertionInfo &) override {}
+    bool assertionEnded(const Catch::AssertionStats &) override { return true; }
+
+    void benchmarkEnded(const Catch::BenchmarkStats<> &stats) override
+    {
+        mBenchmarks.append(QJsonObject{
+            {"testCase", QString::fromStdString(currentTestCaseInfo->name)},
+            {"name", QString::fromStdString(stats.info.name)},
+            {"samples", static_cast<int>(stats.samples.size())},
+            {"iterations", stats.info.iterations},
+            {"mean", toNanoseconds(stats.mean.point)},
+            {"meanLow", toNanoseconds(stats.mean.lower_bound)},
+            {"meanHigh", toNanoseconds(stats.mean.upper_bound)},
+            {"standardDeviation", toNanoseconds(stats.standardDeviation.point)},
+            {"outlierVariance", stats.outlierVariance}});
+    }
+
+    void benchmarkFailed(const std::string &error) override
+    {
+        mBenchmarks.append(QJsonObject{
+            {"testCase", QString::fromStdString(currentTestCaseInfo->name)},
+            {"error", QString::fromStdString(error)}});
+    }
+
+    void testRunEnded(const Catch::TestRunStats &stats) override
+    {
+        const QJsonObject json{{"version", PETRACK_VERSION}, {"benchmarks", mBenchmarks}};
+        stream << QJsonDocument(json).toJson().toStdString();
+        StreamingReporterBase::testRunEnded(stats);
+    }
+
+private:
+    QJsonArray mBenchmarks;
+};
+} // namespace
+
+CATCH_REGISTER_REPORTER("json", JsonReporter)
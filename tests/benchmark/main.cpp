@@ -0,0 +1,55 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define CATCH_CONFIG_RUNNER
+#include "logger.h"
+
+#include <QApplication>
+#include <catch2/catch.hpp>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+    // like the unit tests, always run offscreen unless another platform is given
+    bool platformAlreadyGiven = false;
+    for(int i = 0; i < argc; ++i)
+    {
+        if(qstrcmp("-platform", argv[i]) == 0)
+        {
+            platformAlreadyGiven = true;
+        }
+    }
+    auto args = std::vector<const char *>(argv, argv + argc);
+    if(!platformAlreadyGiven)
+    {
+        args.push_back("-platform");
+        args.push_back("offscreen");
+    }
+    int    argc2 = static_cast<int>(args.size());
+    char **argv2 = const_cast<char **>(args.data());
+
+    logger::setupLogger();
+    // the log of the processed frames would distort the measured times
+    spdlog::set_level(spdlog::level::warn);
+
+    QApplication a(argc2, argv2);
+
+    const int result = Catch::Session().run(argc2, argv2);
+
+    return (result < 0xff ? result : 0xff);
+}
@@ -18,9 +18,31 @@
 import pytest
 import subprocess
 
+import timing
+
 
 def pytest_addoption(parser):
     parser.addoption("--path", action="store", default="../../../build/petrack.exe")
+    parser.addoption("--benchmark", action="store_true", default=False, help="run the (slow) tracking benchmarks")
+    parser.addoption(
+        "--timing-baseline",
+        action="store",
+        default="timing_baseline.json",
+        help="stage timings the runs are compared with; without this file the timings are only reported",
+    )
+    parser.addoption(
+        "--timing-tolerance",
+        action="store",
+        type=float,
+        default=0.5,
+        help="allowed relative slowdown of a stage or of the frames/s compared with the baseline",
+    )
+    parser.addoption(
+        "--update-timing-baseline",
+        action="store_true",
+        default=False,
+        help="write the timings of this run to the baseline file instead of comparing",
+    )
 
 
 # "codeMarker"
@@ -54,8 +76,23 @@ def petrack_on_testdata(request, pytestconfig):
             output,
             "-platform",
             "offscreen",
+            "-stageStatistics",
+            timing.stats_file(test_path),
         ],
         check=True,
     )
 
     yield test_path, truth_path
+
+
+def pytest_sessionfinish(session):
+    config = session.config
+    if config.getoption("update_timing_baseline") and timing.RESULTS:
+        timing.write_baseline(config.getoption("timing_baseline"), timing.RESULTS)
+
+
+def pytest_terminal_summary(terminalreporter, config):
+    if timing.RESULTS:
+        terminalreporter.section("stage timings")
+        for line in timing.summary(timing.RESULTS):
+            terminalreporter.write_line(line)
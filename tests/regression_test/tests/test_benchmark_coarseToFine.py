@@ -0,0 +1,97 @@
+#
+# PeTrack - Software for tracking pedestrians movement in videos
+# Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+import os
+import subprocess
+import time
+import xml.etree.ElementTree as ElementTree
+
+import pytest
+from test_tracker_txt import TestTrackerTxt
+
+# Compares the coarse-to-fine tracking mode (COARSE_TO_FINE_TRACKING) with the normal mode
+# regarding runtime and deviation of the trajectories. Only run with --benchmark, e.g.
+#   python3 -m pytest --path=../../../build/petrack --benchmark -s test_benchmark_coarseToFine.py
+
+DATASETS = [
+    "markerCasern",
+    "multicolor",
+    "markerJapan",
+    "multiColorMarkerWithAruco",
+    "blackdotMarker",
+    "correct_perspective",
+]
+
+
+def run_petrack(petrack_path, project, output):
+    start = time.perf_counter()
+    subprocess.run(
+        [petrack_path, "-project", project, "-autotrack", output, "-platform", "offscreen"],
+        check=True,
+    )
+    return time.perf_counter() - start
+
+
+def write_coarse_to_fine_project(project, destination):
+    tree = ElementTree.parse(project)
+    tree.getroot().find("PLAYER").set("COARSE_TO_FINE_TRACKING", "1")
+    tree.write(destination)
+
+
+def mean_deviation(comparer, normal, coarse_to_fine):
+    """Mean deviation of matching points of matching trajectories (unit of the txt files)"""
+    pairs = comparer.get_list_indices(list(normal), list(coarse_to_fine))
+    diff = 0
+    count = 0
+    for normal_index, coarse_index in pairs:
+        for normal_point, coarse_point in zip(normal[normal_index].points, coarse_to_fine[coarse_index].points):
+            if normal_point.frame == coarse_point.frame:
+                diff += sum(abs(a - b) for a, b in zip(normal_point.coordinates, coarse_point.coordinates))
+                count += 1
+    return diff / count if count else float("nan"), len(pairs)
+
+
+@pytest.mark.parametrize("dataset", DATASETS)
+def test_benchmark_coarse_to_fine(dataset, pytestconfig):
+    if not pytestconfig.getoption("benchmark"):
+        pytest.skip("benchmarks only run with --benchmark")
+    petrack_path = pytestconfig.getoption("path")
+
+    project = "../data/" + dataset + ".pet"
+    coarse_project = "../data/" + dataset + "_coarseToFine.pet"
+    normal_output = "../data/" + dataset + "_benchmarkNormal"
+    coarse_output = "../data/" + dataset + "_benchmarkCoarseToFine"
+
+    write_coarse_to_fine_project(project, coarse_project)
+    try:
+        normal_time = run_petrack(petrack_path, project, normal_output)
+        coarse_time = run_petrack(petrack_path, coarse_project, coarse_output)
+    finally:
+        os.remove(coarse_project)
+
+    comparer = TestTrackerTxt()
+    comparer.error_message = []
+    normal = comparer.parse_txt(normal_output + ".txt")
+    coarse_to_fine = comparer.parse_txt(coarse_output + ".txt")
+    deviation, matched = mean_deviation(comparer, normal, coarse_to_fine)
+
+    print(
+        f"\n{dataset}: normal {normal_time:.2f} s, coarse-to-fine {coarse_time:.2f} s "
+        f"(speedup {normal_time / coarse_time:.2f}), trajectories {len(normal)} / {len(coarse_to_fine)}, "
+        f"matched {matched}, mean deviation {deviation:.4f}"
+    )
+    assert matched > 0
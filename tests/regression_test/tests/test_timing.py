@@ -0,0 +1,42 @@
+#
+# PeTrack - Software for tracking pedestrians movement in videos
+# Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+import pytest
+
+import timing
+
+# Compares the stage timings of the regression runs (see conftest.py) with the baseline
+# given by --timing-baseline. The frames/s per dataset are reported in the summary of every run.
+
+
+def test_stage_timings(petrack_on_testdata, pytestconfig):
+    test_path, _ = petrack_on_testdata
+    dataset = timing.dataset_name(test_path)
+    stats = timing.load_stats(test_path)
+    timing.RESULTS[dataset] = stats
+
+    assert stats["frames"] > 0
+    assert set(timing.STAGES) <= set(stats["stages"])
+
+    if pytestconfig.getoption("update_timing_baseline"):
+        return
+    baseline = timing.load_baseline(pytestconfig.getoption("timing_baseline")).get(dataset)
+    if baseline is None:
+        pytest.skip(f"no timing baseline for {dataset}")
+
+    regressions = timing.compare(stats, baseline, pytestconfig.getoption("timing_tolerance"))
+    assert not regressions, f"{dataset}: " + "; ".join(regressions)
@@ -0,0 +1,88 @@
+#
+# PeTrack - Software for tracking pedestrians movement in videos
+# Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#
+import json
+import os
+
+# Stage timings of the regression runs, as written by petrack -stageStatistics:
+#   {"frames": 100, "seconds": 2.5, "framesPerSecond": 40,
+#    "stages": {"decode": 0.4, "filter": 0.6, "track": 0.8, "recognize": 0.5, "export": 0.05}}
+# The baseline maps the dataset to such an object. Baselines depend on the machine, so record
+# them on the machine running the comparison, e.g.
+#   python3 -m pytest --path=../../../build/petrack --update-timing-baseline test_timing.py
+
+STAGES = ["decode", "filter", "track", "recognize", "export"]
+
+# stages faster than this (in s per run) are not compared, as their relative jitter is too large
+MIN_SECONDS = 0.05
+
+# statistics of the datasets run in this session, by dataset
+RESULTS = {}
+
+
+def stats_file(test_path):
+    return test_path + "_stages.json"
+
+
+def dataset_name(test_path):
+    name = os.path.basename(test_path)
+    return name[: -len("_test")] if name.endswith("_test") else name
+
+
+def load_stats(test_path):
+    with open(stats_file(test_path)) as file:
+        return json.load(file)
+
+
+def load_baseline(filename):
+    if not os.path.exists(filename):
+        return {}
+    with open(filename) as file:
+        return json.load(file)
+
+
+def write_baseline(filename, results):
+    baseline = load_baseline(filename)
+    baseline.update(results)
+    with open(filename, "w") as file:
+        json.dump(baseline, file, indent=4, sort_keys=True)
+        file.write("\n")
+
+
+def compare(stats, baseline, tolerance):
+    """Returns the regressions of stats compared with baseline, each as one line of text"""
+    regressions = []
+    limit = 1 + tolerance
+    if stats["framesPerSecond"] * limit < baseline["framesPerSecond"]:
+        regressions.append(
+            f"frames/s {stats['framesPerSecond']:.1f} below baseline {baseline['framesPerSecond']:.1f}"
+        )
+    for stage in STAGES:
+        seconds = stats["stages"][stage]
+        reference = baseline["stages"].get(stage, 0)
+        if max(seconds, reference) >= MIN_SECONDS and seconds > reference * limit:
+            regressions.append(f"{stage} {seconds:.3f} s above baseline {reference:.3f} s")
+    return regressions
+
+
+def summary(results):
+    """Returns one line with frames/s and stage timings per dataset"""
+    lines = [f"{'dataset':<40} {'frames':>6} {'frames/s':>9} " + " ".join(f"{stage:>9}" for stage in STAGES)]
+    for dataset, stats in sorted(results.items()):
+        stages = " ".join(f"{stats['stages'][stage]:>9.3f}" for stage in STAGES)
+        lines.append(f"{dataset:<40} {stats['frames']:>6} {stats['framesPerSecond']:>9.1f} {stages}")
+    return lines
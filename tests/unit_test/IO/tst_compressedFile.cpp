@@ -0,0 +1,141 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "compressedFile.h"
+
+#include <QBuffer>
+#include <catch2/catch.hpp>
+#include <optional>
+
+namespace
+{
+QByteArray createContent()
+{
+    QByteArray content;
+    for(int i = 0; i < 100000; ++i)
+    {
+        content.append(QByteArray::number(i % 977)).append(' ').append(QByteArray::number(0.5 * i)).append('\n');
+    }
+    return content;
+}
+
+QByteArray write(const QByteArray &content, bool compress)
+{
+    QBuffer target;
+    target.open(QIODevice::WriteOnly);
+    compression::Writer writer(target, compress);
+    REQUIRE(writer.open(QIODevice::WriteOnly));
+    // several writes, as the exports do
+    for(int pos = 0; pos < content.size(); pos += 10000)
+    {
+        REQUIRE(writer.write(content.mid(pos, 10000)) == content.mid(pos, 10000).size());
+    }
+    REQUIRE(writer.finish());
+    writer.close();
+    return target.data();
+}
+
+/// returns the read content or nothing, if reading failed
+std::optional<QByteArray> read(QByteArray data, bool compressed)
+{
+    QBuffer source(&data);
+    source.open(QIODevice::ReadOnly);
+    compression::Reader reader(source, compressed);
+    REQUIRE(reader.open(QIODevice::ReadOnly));
+    QByteArray content;
+    char       block[4096];
+    qint64     numRead;
+    while((numRead = reader.read(block, sizeof(block))) > 0)
+    {
+        content.append(block, static_cast<int>(numRead));
+    }
+    if(numRead < 0)
+    {
+        return std::nullopt;
+    }
+    return content;
+}
+} // namespace
+
+TEST_CASE("compression::isCompressed and uncompressedName", "[IO][compression]")
+{
+    CHECK(compression::isCompressed("trajectories.trc.zst"));
+    CHECK(compression::isCompressed("TRAJECTORIES.TXT.ZST"));
+    CHECK_FALSE(compression::isCompressed("trajectories.trc"));
+    CHECK_FALSE(compression::isCompressed("zst.trc"));
+
+    CHECK(compression::uncompressedName("dir/trajectories.trc.zst") == "dir/trajectories.trc");
+    CHECK(compression::uncompressedName("dir/trajectories.trc") == "dir/trajectories.trc");
+}
+
+TEST_CASE("compression::Writer and Reader pass uncompressed files through", "[IO][compression]")
+{
+    const QByteArray content = createContent();
+    const QByteArray written = write(content, false);
+    CHECK(written == content);
+    CHECK(read(written, false) == content);
+}
+
+TEST_CASE("compression::Writer and Reader only support their direction", "[IO][compression]")
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    compression::Writer writer(buffer, false);
+    CHECK_FALSE(writer.open(QIODevice::ReadOnly));
+    compression::Reader reader(buffer, false);
+    CHECK_FALSE(reader.open(QIODevice::WriteOnly));
+}
+
+#ifdef ZSTD
+TEST_CASE("compression::Writer and Reader compress and decompress", "[IO][compression]")
+{
+    CHECK(compression::isSupported());
+
+    const QByteArray content    = createContent();
+    const QByteArray compressed = write(content, true);
+    CHECK(compressed.size() < content.size() / 2);
+    CHECK(read(compressed, true) == content);
+
+    SECTION("an empty file")
+    {
+        CHECK(read(write({}, true), true) == QByteArray());
+    }
+
+    SECTION("a truncated file is an error")
+    {
+        CHECK_FALSE(read(compressed.left(compressed.size() - 10), true).has_value());
+    }
+
+    SECTION("an uncompressed file is an error")
+    {
+        CHECK_FALSE(read(content, true).has_value());
+    }
+}
+#else
+TEST_CASE("compression::Writer and Reader fail for compressed files without zstd", "[IO][compression]")
+{
+    CHECK_FALSE(compression::isSupported());
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    compression::Writer writer(buffer, true);
+    CHECK_FALSE(writer.open(QIODevice::WriteOnly));
+    compression::Reader reader(buffer, true);
+    CHECK_FALSE(reader.open(QIODevice::ReadOnly));
+}
+#endif
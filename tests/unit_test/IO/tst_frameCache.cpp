@@ -0,0 +1,87 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameCache.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("FrameCache")
+{
+    const cv::Mat     img(10, 10, CV_8UC3, cv::Scalar(1, 2, 3));
+    const std::size_t imgBytes = 10 * 10 * 3;
+    FrameCache        cache(3 * imgBytes);
+
+    CHECK(cache.capacityFor(img) == 3);
+
+    SECTION("Insert and get")
+    {
+        cache.insert(5, img);
+        cv::Mat result;
+        REQUIRE(cache.get(5, result));
+        CHECK(result.data == img.data);
+        CHECK_FALSE(cache.get(4, result));
+        CHECK(cache.bytes() == imgBytes);
+
+        // replace does not count twice
+        cache.insert(5, img.clone());
+        CHECK(cache.size() == 1);
+        CHECK(cache.bytes() == imgBytes);
+    }
+
+    SECTION("Evicts least recently used frame")
+    {
+        cache.insert(1, img.clone());
+        cache.insert(2, img.clone());
+        cache.insert(3, img.clone());
+        cv::Mat result;
+        REQUIRE(cache.get(1, result));
+        cache.insert(4, img.clone());
+
+        CHECK(cache.size() == 3);
+        CHECK(cache.contains(1));
+        CHECK_FALSE(cache.contains(2));
+        CHECK(cache.contains(3));
+        CHECK(cache.contains(4));
+    }
+
+    SECTION("Memory limit")
+    {
+        cache.insert(1, cv::Mat(100, 100, CV_8UC3));
+        CHECK(cache.size() == 0);
+        cache.insert(1, cv::Mat());
+        CHECK(cache.size() == 0);
+
+        cache.insert(1, img.clone());
+        cache.insert(2, img.clone());
+        cache.setMaxBytes(imgBytes);
+        CHECK(cache.size() == 1);
+        CHECK(cache.contains(2));
+
+        cache.setMaxBytes(0);
+        CHECK_FALSE(cache.isEnabled());
+        CHECK(cache.size() == 0);
+    }
+
+    SECTION("Clear")
+    {
+        cache.insert(1, img);
+        cache.clear();
+        CHECK(cache.size() == 0);
+        CHECK(cache.bytes() == 0);
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameSampler.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("frameSampler spreads the samples over the range", "[IO][frameSampler]")
+{
+    SECTION("Middle of equal parts")
+    {
+        CHECK(frameSampler::sampleFrames(0, 99, 4, {}) == std::vector<int>{12, 37, 62, 87});
+        CHECK(frameSampler::sampleFrames(10, 19, 2, {}) == std::vector<int>{12, 17});
+    }
+
+    SECTION("Short or empty range")
+    {
+        CHECK(frameSampler::sampleFrames(0, 2, 10, {}) == std::vector<int>{0, 1, 2});
+        CHECK(frameSampler::sampleFrames(5, 4, 10, {}).empty());
+        CHECK(frameSampler::sampleFrames(0, 99, 0, {}).empty());
+    }
+
+    SECTION("Samples are moved onto the keyframe before them, unless it is taken already")
+    {
+        const std::vector<int> keyFrames{0, 30, 60, 90};
+        CHECK(frameSampler::sampleFrames(0, 99, 4, keyFrames) == std::vector<int>{0, 30, 60, 87});
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameTimes.h"
+
+#include <QDateTime>
+#include <catch2/catch.hpp>
+
+TEST_CASE("FrameTimes follows the frame rate without table", "[IO][FrameTimes]")
+{
+    FrameTimes times;
+    times.setFps(25);
+    CHECK_FALSE(times.hasTimes());
+    CHECK(times.seconds(0) == Approx(0));
+    CHECK(times.seconds(50) == Approx(2));
+    CHECK(times.toString(51) == "00:00:02.0400");
+}
+
+TEST_CASE("FrameTimes looks up the times of a variable frame rate", "[IO][FrameTimes]")
+{
+    FrameTimes times;
+    times.setFps(10);
+    times.setTimes({0., 0.1, 0.3, 0.35});
+    REQUIRE(times.hasTimes());
+
+    CHECK(times.seconds(2) == Approx(0.3));
+    CHECK(times.seconds(3) == Approx(0.35));
+    // continued with the frame rate after the end of the table
+    CHECK(times.seconds(5) == Approx(0.55));
+    CHECK(times.toString(2) == "00:00:00.3000");
+
+    SECTION("The start of the recording gives the time of day")
+    {
+        times.setStart(QDateTime(QDate(2024, 5, 3), QTime(12, 30, 15, 500)).toMSecsSinceEpoch() * 1000);
+        CHECK(times.toString(2) == "03.05.2024 12:30:15.8000");
+    }
+
+    SECTION("Clearing keeps the frame rate")
+    {
+        times.clear();
+        CHECK_FALSE(times.hasTimes());
+        CHECK(times.getStart() == -1);
+        CHECK(times.seconds(5) == Approx(0.5));
+    }
+}
+
+TEST_CASE("FrameTimes detects variable frame rates", "[IO][FrameTimes]")
+{
+    CHECK_FALSE(FrameTimes::isVariable({}));
+    CHECK_FALSE(FrameTimes::isVariable({0., 0.04, 0.08, 0.12, 0.16}));
+    CHECK_FALSE(FrameTimes::isVariable({0., 0.041, 0.079, 0.12, 0.16}));
+    CHECK(FrameTimes::isVariable({0., 0.02, 0.04, 0.12, 0.16}));
+}
@@ -0,0 +1,104 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "imageSequenceIndex.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+TEST_CASE("ImageSequenceIndex lists the images of a sequence", "[IO][ImageSequenceIndex]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    const QDir    dir(tmp.path());
+    const cv::Mat gray(6, 8, CV_8UC1, cv::Scalar(100));
+    for(const char *name : {"seq_0003.png", "seq_0001.png", "seq_0002.png", "seq_0002-left.png", "other_0001.png"})
+    {
+        REQUIRE(cv::imwrite(dir.filePath(name).toStdString(), gray));
+    }
+    REQUIRE(cv::imwrite(dir.filePath("seq_0004.bmp").toStdString(), gray));
+
+    const QString fileName = dir.filePath("seq_0002.png");
+    QString       front, back;
+    REQUIRE(ImageSequenceIndex::splitName("series1_0002-left", front, back));
+    CHECK(front == "series1_");
+    CHECK(back == "-left");
+
+    const ImageSequenceIndex index = ImageSequenceIndex::create(fileName);
+    REQUIRE_FALSE(index.isEmpty());
+    CHECK(
+        index.getFiles() ==
+        QStringList{dir.filePath("seq_0001.png"), dir.filePath("seq_0002.png"), dir.filePath("seq_0003.png")});
+    CHECK(index.getFileBase() == "seq_");
+    CHECK(index.getSize() == cv::Size(8, 6));
+    CHECK(index.getChannels() == 1);
+    CHECK(index.getDepth() == CV_8U);
+    REQUIRE(QFile::exists(ImageSequenceIndex::sidecarName(fileName)));
+
+    SECTION("The sidecar is used for all images of the sequence")
+    {
+        ImageSequenceIndex loaded;
+        REQUIRE(loaded.load(dir.filePath("seq_0003.png")));
+        CHECK(loaded.getFiles() == index.getFiles());
+        CHECK(loaded.getFileBase() == "seq_");
+        CHECK(loaded.getSize() == cv::Size(8, 6));
+        CHECK(loaded.getChannels() == 1);
+        CHECK_FALSE(loaded.load(dir.filePath("seq_0002-left.png")));
+    }
+
+    SECTION("An outdated sidecar is not used")
+    {
+        REQUIRE(QFile::remove(dir.filePath("seq_0001.png")));
+        ImageSequenceIndex loaded;
+        CHECK_FALSE(loaded.load(fileName));
+        CHECK(loaded.isEmpty());
+
+        const ImageSequenceIndex rebuilt = ImageSequenceIndex::create(fileName);
+        CHECK(rebuilt.getFiles() == QStringList{dir.filePath("seq_0002.png"), dir.filePath("seq_0003.png")});
+    }
+}
+
+TEST_CASE("ImageSequenceIndex reads the format of an image", "[IO][ImageSequenceIndex]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    const QString fileName = QDir(tmp.path()).filePath("image.png");
+
+    cv::Size size;
+    int      channels = 0;
+    int      depth    = -1;
+    CHECK_FALSE(ImageSequenceIndex::readHeader(fileName, size, channels, depth));
+
+    REQUIRE(cv::imwrite(fileName.toStdString(), cv::Mat(20, 30, CV_8UC3, cv::Scalar(1, 2, 3))));
+    REQUIRE(ImageSequenceIndex::readHeader(fileName, size, channels, depth));
+    CHECK(size == cv::Size(30, 20));
+    CHECK(channels == 3);
+    CHECK(depth == CV_8U);
+
+    REQUIRE(cv::imwrite(fileName.toStdString(), cv::Mat(20, 30, CV_8UC4, cv::Scalar(1, 2, 3, 4))));
+    REQUIRE(ImageSequenceIndex::readHeader(fileName, size, channels, depth));
+    CHECK(channels == 4);
+
+    REQUIRE(cv::imwrite(fileName.toStdString(), cv::Mat(20, 30, CV_16UC1, cv::Scalar(1000))));
+    REQUIRE(ImageSequenceIndex::readHeader(fileName, size, channels, depth));
+    CHECK(channels == 1);
+    CHECK(depth == CV_16U);
+}
@@ -0,0 +1,54 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "imageSequenceLoader.h"
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+TEST_CASE("ImageSequenceLoader decodes images at reduced size", "[IO][ImageSequenceLoader]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    const QDir    dir(tmp.path());
+    const cv::Mat color(64, 96, CV_8UC3, cv::Scalar(20, 120, 220));
+    QStringList   files;
+    for(const char *name : {"seq_0001.jpg", "seq_0002.jpg"})
+    {
+        files << dir.filePath(name);
+        REQUIRE(cv::imwrite(files.last().toStdString(), color));
+    }
+
+    CHECK(ImageSequenceLoader::readImage(files[0], false).size() == cv::Size(96, 64));
+    const cv::Mat reduced = ImageSequenceLoader::readImage(files[0], true, 4);
+    CHECK(reduced.size() == cv::Size(24, 16));
+    CHECK(reduced.channels() == 1);
+
+    ImageSequenceLoader loader;
+    loader.setFiles(files);
+    loader.setDepth(2);
+    loader.setScale(3);
+    CHECK(loader.getScale() == 2);
+    CHECK(loader.load(0, 1, 0, 1).size() == cv::Size(48, 32));
+    CHECK(loader.load(1, 1, 0, 1).size() == cv::Size(48, 32));
+
+    loader.setScale(1);
+    CHECK(loader.load(1, 1, 0, 1).size() == cv::Size(96, 64));
+}
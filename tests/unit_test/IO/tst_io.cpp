@@ -554,6 +554,35 @@ TEST_CASE("src/IO", "[tracking][io]")
     }
 }
 
+TEST_CASE("Parsing height and markerID files from memory", "[io]")
+{
+    SECTION("heights with tabs, CRLF line breaks and a line without line break")
+    {
+        const auto ret = IO::parseHeights("# id z/m\r\n987\t1.84\r\n\r\n  988 1.79");
+        REQUIRE(std::holds_alternative<std::unordered_map<int, float>>(ret));
+        const auto &heights = std::get<std::unordered_map<int, float>>(ret);
+        REQUIRE(heights.size() == 2);
+        CHECK(heights.at(987) == Approx(184));
+        CHECK(heights.at(988) == Approx(179));
+    }
+
+    SECTION("markerIDs")
+    {
+        const auto ret = IO::parseMarkerIDs("# id markerID\n1 995\n2\t999\n# 3 998\n");
+        REQUIRE(std::holds_alternative<std::unordered_map<int, int>>(ret));
+        const auto &markerIDs = std::get<std::unordered_map<int, int>>(ret);
+        REQUIRE(markerIDs.size() == 2);
+        CHECK(markerIDs.at(1) == 995);
+        CHECK(markerIDs.at(2) == 999);
+    }
+
+    SECTION("numbers followed by garbage")
+    {
+        CHECK(std::holds_alternative<std::string>(IO::parseMarkerIDs("1 995x\n")));
+        CHECK(std::holds_alternative<std::string>(IO::parseHeights("1 1.8.4\n")));
+    }
+}
+
 SCENARIO("I want to read a XSens c3d file", "[io]")
 {
     ezc3d::c3d c3d;
@@ -616,5 +645,33 @@ SCENARIO("I want to read a XSens c3d file", "[io]")
                 REQUIRE(root.getChildById(1).getPos() == cv::Point3f(15, 15, 15)); // pC7SpinalProcess point[15]
             }
         }
+
+        AND_GIVEN("I read only the samples overlapping a video of 0.2s, which starts 0.5s into the recording")
+        {
+            MoCapPerson person;
+            person.setSamplerate(10);
+            person.setUserTimeOffset(-0.5);
+            auto c3dToPoint3f = [](ezc3d::DataNS::Points3dNS::Point point)
+            {
+                return cv::Point3f{
+                    static_cast<float>(point.x()), static_cast<float>(point.y()), static_cast<float>(point.z())};
+            };
+            IO::readSkeletonC3D_XSENS(c3d, person, c3dToPoint3f, 0.2);
+
+            THEN("The samples from one before the video start to the end of the recording are stored")
+            {
+                CHECK(person.getFirstSample() == 4);
+                CHECK_FALSE(person.hasSample(3));
+                CHECK(person.hasSample(4));
+                CHECK(person.hasSample(9));
+                CHECK_FALSE(person.hasSample(10));
+                CHECK(person.getSkeleton(4).getRoot().getPos() == cv::Point3f{0, 0, 0});
+                CHECK_THROWS_AS(person.getSkeleton(3), std::out_of_range);
+
+                CHECK(person.storesSamplesFor(0, 0.2));
+                CHECK(person.storesSamplesFor(0, 10));
+                CHECK_FALSE(person.storesSamplesFor(-0.3, 0.2));
+            }
+        }
     }
 }
@@ -0,0 +1,60 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "livePublisher.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <catch2/catch.hpp>
+
+TEST_CASE("LivePublisher reads the target as host:port", "[IO][LivePublisher]")
+{
+    const auto target = LivePublisher::parseTarget("192.168.0.5:5000");
+    REQUIRE(target);
+    CHECK(target->first == "192.168.0.5");
+    CHECK(target->second == 5000);
+
+    const auto ipv6 = LivePublisher::parseTarget("[::1]:6000");
+    REQUIRE(ipv6);
+    CHECK(ipv6->first == "::1");
+    CHECK(ipv6->second == 6000);
+
+    CHECK_FALSE(LivePublisher::parseTarget("localhost"));
+    CHECK_FALSE(LivePublisher::parseTarget(":5000"));
+    CHECK_FALSE(LivePublisher::parseTarget("localhost:0"));
+    CHECK_FALSE(LivePublisher::parseTarget("localhost:70000"));
+}
+
+TEST_CASE("LivePublisher sends one JSON object per frame", "[IO][LivePublisher]")
+{
+    const std::vector<LivePosition> positions{{1, {640, 380}, {120.5, -33}}, {4, {10, 20}, {-500, 250}}};
+
+    const auto json = QJsonDocument::fromJson(LivePublisher::datagram(42, 23.5, positions)).object();
+    CHECK(json["frame"].toInt() == 42);
+    CHECK(json["latency"].toDouble() == 23.5);
+
+    const auto persons = json["persons"].toArray();
+    REQUIRE(persons.size() == 2);
+    CHECK(persons[0].toObject()["id"].toInt() == 1);
+    CHECK(persons[0].toObject()["x"].toDouble() == 120.5);
+    CHECK(persons[0].toObject()["y"].toDouble() == -33);
+    CHECK(persons[0].toObject()["px"].toDouble() == 640);
+    CHECK(persons[0].toObject()["py"].toDouble() == 380);
+    CHECK(persons[1].toObject()["id"].toInt() == 4);
+}
@@ -0,0 +1,81 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "liveSharedMemory.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+TEST_CASE("LiveSharedMemory writes the frames into a ring buffer readable by other processes", "[IO][LiveSharedMemory]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString fileName = dir.filePath("petrack_live");
+
+    LiveSharedMemory memory;
+    REQUIRE(memory.open(fileName, 4, 2));
+    REQUIRE(memory.isEnabled());
+
+    // a reader maps the file on its own
+    QFile reader(fileName);
+    REQUIRE(reader.open(QIODevice::ReadOnly));
+    const uchar *mapped = reader.map(0, reader.size());
+    REQUIRE(mapped);
+    CHECK(reader.size() == 64 + 4 * 64);
+    CHECK_FALSE(LiveSharedMemory::readLatest(mapped));
+
+    memory.publish(7, 12.5, {{1, {640, 380}, {120.5, -33}}});
+    auto frame = LiveSharedMemory::readLatest(mapped);
+    REQUIRE(frame);
+    CHECK(frame->frame == 7);
+    CHECK(frame->latency == 12.5);
+    REQUIRE(frame->positions.size() == 1);
+    CHECK(frame->positions[0].id == 1);
+    CHECK(frame->positions[0].pixel == QPointF(640, 380));
+    CHECK(frame->positions[0].world == QPointF(120.5, -33));
+
+    SECTION("The newest frame is read after the buffer wrapped around")
+    {
+        for(int i = 8; i < 20; ++i)
+        {
+            memory.publish(i, 0, {{1, {0, 0}, {0, 0}}, {2, {1, 1}, {1, 1}}});
+        }
+        frame = LiveSharedMemory::readLatest(mapped);
+        REQUIRE(frame);
+        CHECK(frame->frame == 19);
+        CHECK(frame->positions.size() == 2);
+    }
+
+    SECTION("Persons beyond the maximum are left out")
+    {
+        memory.publish(8, 0, {{1, {0, 0}, {0, 0}}, {2, {1, 1}, {1, 1}}, {3, {2, 2}, {2, 2}}});
+        frame = LiveSharedMemory::readLatest(mapped);
+        REQUIRE(frame);
+        REQUIRE(frame->positions.size() == 2);
+        CHECK(frame->positions[1].id == 2);
+    }
+
+    SECTION("Without file nothing is published")
+    {
+        REQUIRE(memory.open(""));
+        CHECK_FALSE(memory.isEnabled());
+        memory.publish(8, 0, {});
+        CHECK(LiveSharedMemory::readLatest(mapped)->frame == 7);
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mezzanineVideo.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+#include <catch2/catch.hpp>
+#include <opencv2/videoio.hpp>
+
+TEST_CASE("MezzanineVideo splits the working range into chunks", "[IO][MezzanineVideo]")
+{
+    using Chunks = std::vector<std::pair<int, int>>;
+
+    CHECK(MezzanineVideo::chunks(0, 999, 8) == Chunks{{0, 249}, {250, 499}, {500, 749}, {750, 999}});
+    CHECK(MezzanineVideo::chunks(100, 1099, 2) == Chunks{{100, 599}, {600, 1099}});
+    CHECK(MezzanineVideo::chunks(10, 20, 8) == Chunks{{10, 20}});
+    CHECK(MezzanineVideo::chunks(10, 9, 8).empty());
+}
+
+TEST_CASE("MezzanineVideo copies the working range of a video", "[IO][MezzanineVideo]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString   videoFile = dir.filePath("video.avi");
+    cv::VideoWriter writer(videoFile.toStdString(), cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 25, cv::Size(64, 48));
+    if(!writer.isOpened())
+    {
+        WARN("No MJPG encoder available");
+        return;
+    }
+    for(int i = 0; i < 30; ++i)
+    {
+        writer.write(cv::Mat(48, 64, CV_8UC3, cv::Scalar::all(5 * i)));
+    }
+    writer.release();
+
+    const cv::Rect crop(8, 8, 32, 24);
+    MezzanineVideo mezzanine;
+    mezzanine.start(videoFile, 5, 24, crop, cv::VIDEO_ACCELERATION_NONE);
+    for(int i = 0; i < 500 && !mezzanine.isReady(); ++i)
+    {
+        QThread::msleep(10);
+    }
+    REQUIRE(mezzanine.isReady());
+    CHECK(QFile::exists(MezzanineVideo::listName(videoFile)));
+
+    cv::Mat img;
+    REQUIRE(mezzanine.read(20, img, cv::Size(64, 48)));
+    REQUIRE(img.size() == cv::Size(64, 48));
+    CHECK(img.at<cv::Vec3b>(20, 20)[0] == Approx(100).margin(3));
+    CHECK(img.at<cv::Vec3b>(2, 2)[0] == 0);
+    REQUIRE(mezzanine.read(6, img, cv::Size(64, 48)));
+    CHECK(img.at<cv::Vec3b>(20, 20)[0] == Approx(30).margin(3));
+    CHECK_FALSE(mezzanine.read(4, img, cv::Size(64, 48)));
+    CHECK_FALSE(mezzanine.read(25, img, cv::Size(64, 48)));
+
+    SECTION("The copy is used again for the same frames and crop, but not for others")
+    {
+        MezzanineVideo again;
+        again.start(videoFile, 5, 24, crop, cv::VIDEO_ACCELERATION_NONE);
+        CHECK(again.isReady());
+
+        MezzanineVideo other;
+        other.start(videoFile, 0, 24, crop, cv::VIDEO_ACCELERATION_NONE);
+        CHECK_FALSE(other.isReady());
+    }
+}
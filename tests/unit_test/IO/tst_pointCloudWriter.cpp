@@ -0,0 +1,71 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pointCloudWriter.h"
+
+#include <QTemporaryDir>
+#include <QtEndian>
+#include <catch2/catch.hpp>
+#include <cstring>
+
+TEST_CASE("PointCloudWriter writes a binary PLY of all frames", "[IO][PointCloudWriter]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString fileName = dir.filePath("cloud.ply");
+
+    {
+        PointCloudWriter writer(1);
+        REQUIRE(writer.open(fileName));
+        CHECK(writer.write(7, {{1.f, 2.f, 3.f, 10}, {4.f, 5.f, 6.f, 20}}));
+        CHECK(writer.write(8, {}));
+        CHECK(writer.write(9, {{-1.5f, 0.f, 2.25f, 255}}));
+        REQUIRE(writer.finish());
+        CHECK(writer.getNumPoints() == 3);
+        CHECK_FALSE(writer.write(10, {{0.f, 0.f, 0.f, 0}}));
+    }
+
+    QFile file(fileName);
+    REQUIRE(file.open(QIODevice::ReadOnly));
+    const QByteArray content   = file.readAll();
+    const int        headerEnd = content.indexOf("end_header\n");
+    REQUIRE(headerEnd > 0);
+    const QByteArray header = content.left(headerEnd);
+    CHECK(header.startsWith("ply\nformat binary_little_endian 1.0\n"));
+    CHECK(header.contains("\nelement vertex 00000000000000000003\n"));
+    CHECK(header.contains("property uchar intensity\nproperty int frame\n"));
+
+    const char *data = content.constData() + headerEnd + static_cast<int>(std::strlen("end_header\n"));
+    REQUIRE(content.constData() + content.size() - data == 3 * 17);
+
+    auto readFloat = [](const char *bytes)
+    {
+        const quint32 bits = qFromLittleEndian<quint32>(bytes);
+        float         value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    };
+    CHECK(readFloat(data) == 1.f);
+    CHECK(readFloat(data + 8) == 3.f);
+    CHECK(static_cast<unsigned char>(data[12]) == 10);
+    CHECK(qFromLittleEndian<qint32>(data + 13) == 7);
+    CHECK(readFloat(data + 17 + 4) == 5.f);
+    CHECK(readFloat(data + 34) == -1.5f);
+    CHECK(static_cast<unsigned char>(data[34 + 12]) == 255);
+    CHECK(qFromLittleEndian<qint32>(data + 34 + 13) == 9);
+}
@@ -0,0 +1,74 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pythonBridge.h"
+
+#include "personStorage.h"
+#include "petrack.h"
+
+#include <catch2/catch.hpp>
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+
+namespace py = pybind11;
+
+TEST_CASE("pythonBridge builds the pixel columns of all persons", "[IO][pythonBridge]")
+{
+    Petrack        petrack{"pythonBridge Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+    storage.addPerson({0, 10, {{1, 2}}});
+    storage.addPerson({0, 3, {{5, 6}}});
+    storage.insertFeaturePoint(0, 11, TrackPoint{{3, 4}}, 0, false, -1, 0);
+
+    const TrajectoryColumns columns = pythonBridge::pixelColumns(storage);
+    CHECK(columns.id == std::vector<int>{1, 1, 2});
+    CHECK(columns.frame == std::vector<int>{10, 11, 3});
+    CHECK(columns.x == std::vector<float>{1, 3, 5});
+    CHECK(columns.y == std::vector<float>{2, 4, 6});
+    CHECK(columns.z.empty());
+}
+
+TEST_CASE("pythonBridge shares the columns with numpy without copying", "[IO][pythonBridge]")
+{
+    if(!Py_IsInitialized())
+    {
+        py::initialize_interpreter();
+    }
+
+    auto columns = std::make_shared<TrajectoryColumns>();
+    columns->id    = {1, 1, 2};
+    columns->frame = {0, 1, 0};
+    columns->x     = {10.f, 11.f, 20.f};
+    columns->y     = {-1.f, -2.f, 5.f};
+
+    const TrajectoryColumns *data = columns.get();
+
+    py::dict arrays = pythonBridge::toArrays(std::move(columns));
+    CHECK(arrays.size() == 4);
+    CHECK_FALSE(arrays.contains("z"));
+
+    const auto x = arrays["x"].cast<py::array_t<float>>();
+    REQUIRE(x.size() == 3);
+    CHECK(x.data() == data->x.data());
+    CHECK(x.at(2) == 20.f);
+    CHECK(arrays["id"].cast<py::array_t<int>>().data() == data->id.data());
+
+    // the columns stay alive as long as one of the arrays
+    arrays.clear();
+    CHECK(x.at(1) == 11.f);
+}
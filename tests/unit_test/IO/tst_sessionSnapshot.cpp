@@ -0,0 +1,110 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "sessionSnapshot.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+namespace
+{
+void writeFile(const QString &fileName, const QByteArray &content)
+{
+    QFile file(fileName);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    REQUIRE(file.write(content) == content.size());
+}
+
+MoCapPerson createPerson(const std::string &c3dFile)
+{
+    MoCapPersonMetadata metadata(c3dFile, XSensC3D, 60, 0, 0.25);
+    MoCapPerson         person;
+    person.setMetadata(metadata);
+    for(int sample = 0; sample < 5; ++sample)
+    {
+        const float   z = static_cast<float>(sample);
+        SkeletonNode  root{0, cv::Point3f{100, 100, z}};
+        SkeletonNode &neck = root.addChild({19, cv::Point3f{200, 100, 69 + z}});
+        neck.addChild({2, cv::Point3f{150, 150, 1337 + z}});
+        root.addChild({5, cv::Point3f{80, 120, 10 - z}});
+        person.addSkeleton({root, cv::Vec3f{1, 0, z}, {150, 150, z}});
+    }
+    person.setStoredRange(2, 10);
+    return person;
+}
+} // namespace
+
+TEST_CASE("IO::SessionSnapshot stores the samples of the MoCap persons", "[IO][SessionSnapshot]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString project = dir.filePath("project.pet");
+    const QString c3dFile = dir.filePath("recording.c3d");
+    writeFile(c3dFile, "c3d content");
+
+    CHECK_FALSE(IO::SessionSnapshot::read(project));
+
+    const MoCapPerson person = createPerson(c3dFile.toStdString());
+    REQUIRE(IO::writeSessionSnapshot(project, {person}));
+    auto snapshot = IO::SessionSnapshot::read(project);
+    REQUIRE(snapshot);
+    REQUIRE(snapshot->numMoCapPersons() == 1);
+
+    // the settings of the project are kept, only the samples are taken from the snapshot
+    // samples 2 to 6 are stored, which show the first 0.03 s of the video with this offset
+    MoCapPersonMetadata metadata(c3dFile.toStdString(), XSensC3D, 60, 0.2, 0);
+    metadata.setAngle(30);
+
+    SECTION("Persons of unchanged files are found")
+    {
+        auto read = snapshot->findMoCapPerson(metadata, 0.03);
+        REQUIRE(read);
+        CHECK(read->getMetadata().getUserTimeOffset() == Approx(0.2));
+        CHECK(read->getMetadata().getFileTimeOffset() == Approx(0.25));
+        CHECK(read->getMetadata().getAngle() == Approx(30));
+        CHECK(read->getFirstSample() == 2);
+        CHECK(read->getRecordingLength() == 10);
+        CHECK(read->getNodeIds() == person.getNodeIds());
+        CHECK(read->getNodeParents() == person.getNodeParents());
+        CHECK(read->getNodes() == person.getNodes());
+        CHECK(read->getHeadDirs() == person.getHeadDirs());
+        CHECK(read->getRotationCenters() == person.getRotationCenters());
+        CHECK(read->getNeckToHeadBone() == person.getNeckToHeadBone());
+        CHECK(read->getSkeleton(4).getLines().size() == person.getSkeleton(4).getLines().size());
+    }
+
+    SECTION("Persons read with other settings or missing samples are not found")
+    {
+        MoCapPersonMetadata otherRate(metadata);
+        otherRate.setSamplerate(100);
+        CHECK_FALSE(snapshot->findMoCapPerson(otherRate, 0.03));
+        CHECK_FALSE(snapshot->findMoCapPerson(metadata, 0.1));
+        // the whole recording is needed
+        CHECK_FALSE(snapshot->findMoCapPerson(metadata, -1));
+    }
+
+    SECTION("Persons of changed files are read again")
+    {
+        writeFile(c3dFile, "changed c3d content");
+        snapshot = IO::SessionSnapshot::read(project);
+        REQUIRE(snapshot);
+        CHECK(snapshot->numMoCapPersons() == 0);
+        CHECK_FALSE(snapshot->findMoCapPerson(metadata, 0.03));
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "thumbnailStrip.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("ThumbnailStrip samples every n-th frame", "[IO][ThumbnailStrip]")
+{
+    CHECK(ThumbnailStrip::sampleFrames(10, 5, {}) == std::vector<int>{0, 2, 4, 6, 8});
+    CHECK(ThumbnailStrip::sampleFrames(3, 5, {}) == std::vector<int>{0, 1, 2});
+    CHECK(ThumbnailStrip::sampleFrames(0, 5, {}).empty());
+}
+
+TEST_CASE("ThumbnailStrip moves the sampled frames to keyframes", "[IO][ThumbnailStrip]")
+{
+    std::vector<int> keyFrames;
+    for(int frame = 0; frame < 1000; frame += 100)
+    {
+        keyFrames.push_back(frame);
+    }
+    CHECK(ThumbnailStrip::sampleFrames(1000, 4, keyFrames) == std::vector<int>{0, 200, 500, 700});
+
+    // keyframes too far apart are not used
+    CHECK(ThumbnailStrip::sampleFrames(1000, 4, {0}) == std::vector<int>{0, 250, 500, 750});
+}
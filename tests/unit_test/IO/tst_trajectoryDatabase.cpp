@@ -0,0 +1,112 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectoryDatabase.h"
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QVariant>
+#include <catch2/catch.hpp>
+
+TEST_CASE("trajectoryDatabase queries the track points by area and frame", "[IO][trajectoryDatabase]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+
+    // person id walks along x = 100 * frame at y = 50 * id, id 2 is in group 7 from frame 5 on
+    TrajectoryColumns columns;
+    std::vector<int>  groups;
+    for(int id = 1; id <= 3; ++id)
+    {
+        for(int frame = 0; frame < 10; ++frame)
+        {
+            columns.id.push_back(id);
+            columns.frame.push_back(frame);
+            columns.x.push_back(100.f * static_cast<float>(frame));
+            columns.y.push_back(50.f * static_cast<float>(id));
+            columns.z.push_back(170.f + static_cast<float>(id));
+            columns.markerID.push_back(id * 10);
+            columns.viewDirX.push_back(1.f);
+            columns.viewDirY.push_back(0.f);
+            groups.push_back(id == 2 && frame >= 5 ? 7 : -1);
+        }
+    }
+    const QString fileName = dir.filePath("trajectories.sqlite");
+    trajectoryDatabase::write(fileName, columns, groups, {annotationGroups::Group(7, "family", "social")}, 25.);
+
+    SECTION("area and frame range")
+    {
+        // x from 150 to 450 are the frames 2 to 4, y from 75 to 175 the persons 2 and 3
+        const auto result = trajectoryDatabase::query(fileName, QRectF(150, 75, 300, 100), 3, 8);
+        CHECK(result.id == std::vector<int>{2, 2, 3, 3});
+        CHECK(result.frame == std::vector<int>{3, 4, 3, 4});
+        CHECK(result.x == std::vector<float>{300.f, 400.f, 300.f, 400.f});
+        CHECK(result.y == std::vector<float>{100.f, 100.f, 150.f, 150.f});
+        CHECK(result.z == std::vector<float>{172.f, 172.f, 173.f, 173.f});
+        CHECK(result.markerID == std::vector<int>{20, 20, 30, 30});
+    }
+
+    SECTION("borders are inclusive")
+    {
+        const auto result = trajectoryDatabase::query(fileName, QRectF(0, 50, 100, 50), 0, 0);
+        CHECK(result.id == std::vector<int>{1, 2});
+        CHECK(result.frame == std::vector<int>{0, 0});
+    }
+
+    SECTION("empty result")
+    {
+        CHECK(trajectoryDatabase::query(fileName, QRectF(-100, -100, 50, 50), 0, 9).size() == 0);
+        CHECK(trajectoryDatabase::query(fileName, QRectF(0, 0, 1000, 1000), 20, 30).size() == 0);
+    }
+
+    SECTION("persons and groups")
+    {
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "tst_trajectoryDatabase");
+            db.setDatabaseName(fileName);
+            REQUIRE(db.open());
+            QSqlQuery query(db);
+
+            REQUIRE(query.exec("SELECT markerID, first_frame, last_frame FROM persons WHERE id = 3"));
+            REQUIRE(query.next());
+            CHECK(query.value(0).toInt() == 30);
+            CHECK(query.value(1).toInt() == 0);
+            CHECK(query.value(2).toInt() == 9);
+
+            REQUIRE(query.exec("SELECT person, frame FROM points JOIN groups ON groups.id = points.group_id "
+                               "WHERE groups.name = 'family' ORDER BY frame"));
+            std::vector<int> frames;
+            while(query.next())
+            {
+                CHECK(query.value(0).toInt() == 2);
+                frames.push_back(query.value(1).toInt());
+            }
+            CHECK(frames == std::vector<int>{5, 6, 7, 8, 9});
+        }
+        QSqlDatabase::removeDatabase("tst_trajectoryDatabase");
+    }
+
+    SECTION("mismatching groups and missing files")
+    {
+        CHECK_THROWS_AS(
+            trajectoryDatabase::write(dir.filePath("invalid.sqlite"), columns, {}, {}, 25.), std::runtime_error);
+        CHECK_THROWS_AS(
+            trajectoryDatabase::query(dir.filePath("missing.sqlite"), QRectF(0, 0, 1, 1), 0, 1), std::runtime_error);
+    }
+}
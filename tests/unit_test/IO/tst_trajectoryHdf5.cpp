@@ -0,0 +1,72 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectoryHdf5.h"
+
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+TEST_CASE("trajectoryHdf5 writes and reads the trajectory columns", "[IO][trajectoryHdf5]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+
+    TrajectoryColumns columns;
+    // more rows than one chunk
+    const int rows = static_cast<int>(trajectoryHdf5::CHUNK_ROWS) + 17;
+    columns.reserve(rows);
+    for(int i = 0; i < rows; ++i)
+    {
+        columns.id.push_back(i / 100 + 1);
+        columns.frame.push_back(i % 100);
+        columns.x.push_back(static_cast<float>(i) * 0.5f);
+        columns.y.push_back(-static_cast<float>(i));
+        columns.z.push_back(175.f);
+        columns.markerID.push_back(i / 100 % 7 - 1);
+        columns.viewDirX.push_back(0.6f);
+        columns.viewDirY.push_back(-0.8f);
+    }
+
+    SECTION("round trip")
+    {
+        const QString fileName = dir.filePath("trajectories.h5");
+        trajectoryHdf5::writeColumns(fileName, columns, 25.);
+        const TrajectoryColumns read = trajectoryHdf5::readColumns(fileName);
+
+        CHECK(read.id == columns.id);
+        CHECK(read.frame == columns.frame);
+        CHECK(read.x == columns.x);
+        CHECK(read.y == columns.y);
+        CHECK(read.z == columns.z);
+        CHECK(read.markerID == columns.markerID);
+        CHECK(read.viewDirX == columns.viewDirX);
+        CHECK(read.viewDirY == columns.viewDirY);
+    }
+
+    SECTION("empty file")
+    {
+        const QString fileName = dir.filePath("empty.h5");
+        trajectoryHdf5::writeColumns(fileName, TrajectoryColumns{}, 25.);
+        CHECK(trajectoryHdf5::readColumns(fileName).size() == 0);
+    }
+
+    SECTION("missing file")
+    {
+        CHECK_THROWS_AS(trajectoryHdf5::readColumns(dir.filePath("missing.h5")), std::runtime_error);
+    }
+}
@@ -0,0 +1,155 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "petrack.h"
+#include "tracker.h"
+#include "trcIndex.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+namespace
+{
+std::vector<TrackPerson> createPersons()
+{
+    std::vector<TrackPerson> persons;
+    for(int nr = 1; nr <= 3; ++nr)
+    {
+        TrackPoint first({1.5 * nr, 2.25}, 100, Vec2F(3., 4.), QColor(10, 20, 30));
+        first.setMarkerID(nr);
+        TrackPerson person(nr, 10 * nr, first);
+        person.setHeight(170.5);
+        person.setColCount(3);
+        person.setColor(QColor(40, 50, 60));
+        person.setMarkerID(nr);
+        person.setComment(nr == 2 ? "first line\nsecond line" : "");
+        for(int i = 1; i < 100 * nr; ++i)
+        {
+            person.append(TrackPoint({0.125 * i, -1. * i}, i % 101));
+        }
+        persons.push_back(person);
+    }
+    return persons;
+}
+
+void writeTrcFile(const QString &fileName, const std::vector<TrackPerson> &persons)
+{
+    Petrack::trcVersion = 4;
+    QFile file(fileName);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    REQUIRE(writeTrc(file, persons));
+    Petrack::trcVersion = 0;
+}
+} // namespace
+
+TEST_CASE("IO::readTrcIndex maps the points of the persons from the index", "[IO][trcIndex]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString trcFile = dir.filePath("trajectories.trc");
+    const auto    persons = createPersons();
+    writeTrcFile(trcFile, persons);
+
+    CHECK_FALSE(IO::readTrcIndex(trcFile));
+    REQUIRE(IO::writeTrcIndex(trcFile, 4, persons));
+
+    auto data = IO::readTrcIndex(trcFile);
+    REQUIRE(data);
+    CHECK(data->version == 4);
+    REQUIRE(data->persons.size() == persons.size());
+    for(std::size_t i = 0; i < persons.size(); ++i)
+    {
+        const TrackPerson &expected = persons[i];
+        const TrackPerson &read     = data->persons[i];
+        CHECK(read.nr() == expected.nr());
+        CHECK(read.firstFrame() == expected.firstFrame());
+        CHECK(read.lastFrame() == expected.lastFrame());
+        CHECK(read.height() == expected.height());
+        CHECK(read.colCount() == expected.colCount());
+        CHECK(read.color() == expected.color());
+        CHECK(read.getMarkerID() == expected.getMarkerID());
+        CHECK(read.comment() == expected.comment());
+        CHECK(read.columns().isMapped());
+        REQUIRE(read.size() == expected.size());
+
+        CHECK(read.at(0).getMarkerID() == expected.at(0).getMarkerID());
+        CHECK(read.at(0).color() == expected.at(0).color());
+        CHECK(read.at(0).colPoint() == expected.at(0).colPoint());
+        int differentPoints = 0;
+        for(int j = 0; j < read.size(); ++j)
+        {
+            if(read.at(j).x() != expected.at(j).x() || read.at(j).y() != expected.at(j).y() ||
+               read.at(j).qual() != expected.at(j).qual())
+            {
+                ++differentPoints;
+            }
+        }
+        CHECK(differentPoints == 0);
+    }
+
+    SECTION("Editing a person copies its points into memory")
+    {
+        TrackPerson &person = data->persons[1];
+        person.replaceTrackPoint(person.firstFrame() + 5, TrackPoint({7., 8.}, 50));
+        CHECK_FALSE(person.columns().isMapped());
+        CHECK(person.trackPointAt(person.firstFrame() + 5).x() == 7.);
+        CHECK(person.size() == persons[1].size());
+    }
+
+    SECTION("The index is not used after the trc file changed")
+    {
+        auto changed = persons;
+        changed.pop_back();
+        writeTrcFile(trcFile, changed);
+        QFile::resize(trcFile, QFile(trcFile).size() + 1);
+        CHECK_FALSE(IO::readTrcIndex(trcFile));
+    }
+}
+
+TEST_CASE("IO::readIndexedTrc writes the index of large files", "[IO][trcIndex]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString trcFile = dir.filePath("trajectories.trc");
+    const auto    persons = createPersons();
+    writeTrcFile(trcFile, persons);
+
+    SECTION("Small files are only read")
+    {
+        auto result = IO::readIndexedTrc(trcFile);
+        REQUIRE(std::holds_alternative<IO::TrcData>(result));
+        CHECK(std::get<IO::TrcData>(result).persons.size() == persons.size());
+        CHECK_FALSE(QFile::exists(IO::trcIndexName(trcFile)));
+    }
+
+    SECTION("Large files get an index, which is used on the next reading")
+    {
+        auto result = IO::readIndexedTrc(trcFile, 0);
+        REQUIRE(std::holds_alternative<IO::TrcData>(result));
+        CHECK(QFile::exists(IO::trcIndexName(trcFile)));
+        const auto &data = std::get<IO::TrcData>(result);
+        REQUIRE(data.persons.size() == persons.size());
+        CHECK(data.persons[2].columns().isMapped());
+        CHECK(data.persons[2].size() == persons[2].size());
+
+        auto again = IO::readIndexedTrc(trcFile, 0);
+        REQUIRE(std::holds_alternative<IO::TrcData>(again));
+        CHECK(std::get<IO::TrcData>(again).persons.size() == persons.size());
+    }
+}
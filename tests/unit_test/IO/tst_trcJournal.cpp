@@ -0,0 +1,128 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "petrack.h"
+#include "tracker.h"
+#include "trcJournal.h"
+
+#include <QBuffer>
+#include <catch2/catch.hpp>
+
+namespace
+{
+TrackPerson createPerson(int nr, int numPoints)
+{
+    TrackPerson person(nr, 10 * nr, TrackPoint({1.5 * nr, 2.25}, 100));
+    person.setHeight(170.5);
+    person.setMarkerID(nr);
+    person.setComment(nr % 2 ? "first line\nsecond line" : "");
+    for(int i = 1; i < numPoints; ++i)
+    {
+        person.append(TrackPoint({0.125 * i, -1. * i}, i % 101));
+    }
+    return person;
+}
+
+void checkEqual(const std::vector<TrackPerson> &actual, const std::vector<TrackPerson> &expected)
+{
+    REQUIRE(actual.size() == expected.size());
+    for(std::size_t i = 0; i < actual.size(); ++i)
+    {
+        CHECK(actual[i].nr() == expected[i].nr());
+        CHECK(actual[i].firstFrame() == expected[i].firstFrame());
+        CHECK(actual[i].size() == expected[i].size());
+        CHECK(actual[i].comment() == expected[i].comment());
+        CHECK(actual[i].last().x() == Approx(expected[i].last().x()));
+    }
+}
+} // namespace
+
+TEST_CASE("IO::applyTrcJournal replays the appended changes", "[IO][trcJournal]")
+{
+    Petrack::trcVersion = 4;
+    std::vector<TrackPerson> saved;
+    for(int nr = 1; nr <= 5; ++nr)
+    {
+        saved.push_back(createPerson(nr, 20));
+    }
+
+    // delete the persons 2 and 4, change person 3 and add person 6
+    std::vector<TrackPerson> current = saved;
+    current.erase(current.begin() + 1);
+    current.erase(current.begin() + 2);
+    current[1].append(TrackPoint({7., 8.}, 50));
+    current.push_back(createPerson(6, 3));
+
+    CHECK(current[0].hasSameTrcData(saved[0]));
+    CHECK_FALSE(current[1].hasSameTrcData(saved[2]));
+    CHECK(current[2].hasSameTrcData(saved[4]));
+
+    IO::TrcJournalEntry first;
+    first.numPersons = current.size();
+    first.deleted    = {1, 2};
+    first.changed    = {{1, current[1]}, {3, current[3]}};
+
+    // only the comment of the first person changes
+    auto latest = current;
+    latest[0].setComment("changed");
+    CHECK_FALSE(latest[0].hasSameTrcData(current[0]));
+    IO::TrcJournalEntry second;
+    second.numPersons = latest.size();
+    second.changed    = {{0, latest[0]}};
+
+    QBuffer journal;
+    journal.open(QIODevice::WriteOnly);
+    REQUIRE(IO::appendTrcJournal(journal, first));
+    const std::size_t firstSize = journal.data().size();
+    REQUIRE(IO::appendTrcJournal(journal, second));
+    const std::string content = journal.data().toStdString();
+
+    SECTION("all entries")
+    {
+        auto persons = saved;
+        auto result  = IO::applyTrcJournal(content, persons);
+        REQUIRE(std::holds_alternative<int>(result));
+        CHECK(std::get<int>(result) == 2);
+        checkEqual(persons, latest);
+    }
+
+    SECTION("an interrupted last entry is ignored")
+    {
+        const std::size_t cut     = GENERATE_COPY(firstSize + 1, firstSize + 40, content.size() - 2);
+        auto              persons = saved;
+        auto              result  = IO::applyTrcJournal(std::string_view(content).substr(0, cut), persons);
+        REQUIRE(std::holds_alternative<int>(result));
+        CHECK(std::get<int>(result) == 1);
+        checkEqual(persons, current);
+    }
+
+    SECTION("entries not fitting to the trajectories are ignored")
+    {
+        std::vector<TrackPerson> persons{saved[0]};
+        auto                     result = IO::applyTrcJournal(content, persons);
+        REQUIRE(std::holds_alternative<int>(result));
+        CHECK(std::get<int>(result) == 0);
+        CHECK(persons.size() == 1);
+    }
+
+    SECTION("other files are rejected")
+    {
+        auto persons = saved;
+        CHECK(std::holds_alternative<std::string>(IO::applyTrcJournal("version 4\n0\n", persons)));
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "petrack.h"
+#include "tracker.h"
+#include "trcReader.h"
+
+#include <QTextStream>
+#include <catch2/catch.hpp>
+
+namespace
+{
+/// writes the persons like Petrack::exportTracker
+std::string writeTrc(const std::vector<TrackPerson> &persons, int version)
+{
+    Petrack::trcVersion = version;
+    QString     content;
+    QTextStream out(&content);
+    if(version > 1)
+    {
+        out << "version " << version << Qt::endl;
+    }
+    out << persons.size() << Qt::endl;
+    for(const auto &person : persons)
+    {
+        out << person << Qt::endl;
+    }
+    return content.toStdString();
+}
+
+/// comments are only read since version 3
+std::vector<TrackPerson> createPersons(int numPersons, int numPoints, bool withComment)
+{
+    std::vector<TrackPerson> persons;
+    for(int nr = 1; nr <= numPersons; ++nr)
+    {
+        TrackPoint first({1.5 * nr, 2.25}, 100, Vec2F(3., 4.), QColor(10, 20, 30));
+        first.setSp(5., 6., 7.);
+        first.setMarkerID(nr);
+        TrackPerson person(nr, 10 * nr, first);
+        person.setHeight(170.5);
+        person.setColCount(3);
+        person.setColor(QColor(40, 50, 60));
+        person.setMarkerID(nr);
+        person.setComment(withComment && nr % 2 ? "first line\nsecond line" : "");
+        for(int i = 1; i < numPoints; ++i)
+        {
+            person.append(TrackPoint({0.125 * i, -1. * i}, i % 101));
+        }
+        persons.push_back(person);
+    }
+    return persons;
+}
+} // namespace
+
+TEST_CASE("IO::parseTrc reads the trc files written by PeTrack", "[IO][trcReader]")
+{
+    const int version  = GENERATE(1, 2, 3, 4);
+    const bool parallel = GENERATE(false, true);
+    const auto persons  = createPersons(5, 7000, version > 2);
+
+    auto result = IO::parseTrc(writeTrc(persons, version), parallel);
+    REQUIRE(std::holds_alternative<IO::TrcData>(result));
+    const auto &data = std::get<IO::TrcData>(result);
+    CHECK(data.version == version);
+    REQUIRE(data.persons.size() == persons.size());
+
+    for(std::size_t i = 0; i < persons.size(); ++i)
+    {
+        const TrackPerson &expected = persons[i];
+        const TrackPerson &read     = data.persons[i];
+        CHECK(read.nr() == expected.nr());
+        CHECK(read.firstFrame() == expected.firstFrame());
+        CHECK(read.height() == Approx(expected.height()));
+        CHECK(read.colCount() == expected.colCount());
+        CHECK(read.color() == expected.color());
+        CHECK(read.getMarkerID() == (version > 3 ? expected.getMarkerID() : -1));
+        CHECK(read.comment() == expected.comment());
+        REQUIRE(read.size() == expected.size());
+
+        CHECK(read.at(0).sp() == (version > 1 ? Vec3F(5., 6., 7.) : Vec3F(-1., -1., -1.)));
+        CHECK(read.at(0).getMarkerID() == (version > 2 ? expected.at(0).getMarkerID() : -1));
+        CHECK(read.at(0).color() == expected.at(0).color());
+        CHECK(read.at(0).colPoint() == expected.at(0).colPoint());
+        int differentPoints = 0;
+        for(int j = 0; j < read.size(); ++j)
+        {
+            if(read.at(j).x() != Approx(expected.at(j).x()) || read.at(j).y() != Approx(expected.at(j).y()) ||
+               read.at(j).qual() != expected.at(j).qual())
+            {
+                ++differentPoints;
+            }
+        }
+        CHECK(differentPoints == 0);
+    }
+    Petrack::trcVersion = 0;
+}
+
+TEST_CASE("IO::parseTrc reports broken trc files", "[IO][trcReader]")
+{
+    CHECK(std::holds_alternative<std::string>(IO::parseTrc("")));
+    CHECK(std::holds_alternative<std::string>(IO::parseTrc("version 5\n1\n")));
+
+    const std::string complete = writeTrc(createPersons(2, 3, true), 4);
+    Petrack::trcVersion        = 0;
+    REQUIRE(std::holds_alternative<IO::TrcData>(IO::parseTrc(complete)));
+
+    SECTION("missing person")
+    {
+        const std::string truncated = complete.substr(0, complete.find("\n2 "));
+        CHECK(std::holds_alternative<std::string>(IO::parseTrc(truncated)));
+    }
+
+    SECTION("invalid number in track point")
+    {
+        std::string broken = complete;
+        broken.replace(broken.rfind("0.25"), 4, "0.2x");
+        CHECK(std::holds_alternative<std::string>(IO::parseTrc(broken)));
+    }
+}
+
+TEST_CASE("IO::readTrc reports missing files", "[IO][trcReader]")
+{
+    auto result = IO::readTrc("not_existing_file.trc");
+    REQUIRE(std::holds_alternative<std::string>(result));
+    CHECK(std::get<std::string>(result) == "Could not open not_existing_file.trc");
+}
@@ -0,0 +1,112 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "videoSegments.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <catch2/catch.hpp>
+#include <opencv2/videoio.hpp>
+
+namespace
+{
+/// Writes a video whose frames are filled with the gray values firstValue, firstValue + 1, ...
+bool writeVideo(const QString &fileName, int numFrames, double fps, int firstValue)
+{
+    cv::VideoWriter writer(
+        fileName.toStdString(), cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fps, cv::Size(64, 48), true);
+    if(!writer.isOpened())
+    {
+        return false;
+    }
+    for(int i = 0; i < numFrames; ++i)
+    {
+        writer.write(cv::Mat(48, 64, CV_8UC3, cv::Scalar::all(firstValue + i)));
+    }
+    return true;
+}
+
+void writeList(const QString &fileName, const QString &content)
+{
+    QFile file(fileName);
+    REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    QTextStream(&file) << content;
+}
+} // namespace
+
+TEST_CASE("VideoSegments reads the files of a video list", "[IO][VideoSegments]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+
+    SECTION("Paths are relative to the list, comments and empty lines are skipped")
+    {
+        writeList(dir.filePath("rec.vlist"), "# camera 1\npart1.avi\n\n  sub/part2.avi  \n");
+        const auto files = VideoSegments::readList(dir.filePath("rec.vlist"));
+        REQUIRE(files);
+        CHECK(*files == QStringList{dir.filePath("part1.avi"), dir.filePath("sub/part2.avi")});
+    }
+
+    SECTION("A list without files is invalid")
+    {
+        writeList(dir.filePath("empty.vlist"), "# nothing\n\n");
+        CHECK_FALSE(VideoSegments::readList(dir.filePath("empty.vlist")));
+        CHECK_FALSE(VideoSegments::readList(dir.filePath("missing.vlist")));
+    }
+}
+
+TEST_CASE("VideoSegments numbers the frames of all files continuously", "[IO][VideoSegments]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    if(!writeVideo(dir.filePath("a.avi"), 10, 25, 0) || !writeVideo(dir.filePath("b.avi"), 5, 50, 100))
+    {
+        WARN("No MJPG encoder available");
+        return;
+    }
+
+    VideoSegments segments;
+    REQUIRE(segments.open({dir.filePath("a.avi"), dir.filePath("b.avi")}, cv::VIDEO_ACCELERATION_NONE));
+    REQUIRE(segments.getSegments().size() == 2);
+    CHECK(segments.getNumFrames() == 15);
+    CHECK(segments.getSize() == cv::Size(64, 48));
+    CHECK(segments.segmentOf(9) == 0);
+    CHECK(segments.segmentOf(10) == 1);
+    CHECK(segments.segmentOf(15) == -1);
+
+    REQUIRE(segments.hasVariableFps());
+    const auto times = segments.frameTimes();
+    REQUIRE(times.size() == 15);
+    CHECK(times[9] == Approx(0.36));
+    CHECK(times[10] == Approx(0.4));
+    CHECK(times[11] == Approx(0.42));
+
+    cv::Mat img;
+    REQUIRE(segments.read(9, img));
+    CHECK(img.at<cv::Vec3b>(24, 32)[0] == Approx(9).margin(3));
+    REQUIRE(segments.read(10, img));
+    CHECK(img.at<cv::Vec3b>(24, 32)[0] == Approx(100).margin(3));
+    CHECK_FALSE(segments.read(15, img));
+
+    const auto images = segments.readFrames({2, 12, 3});
+    REQUIRE(images.size() == 3);
+    CHECK(images[0].at<cv::Vec3b>(24, 32)[0] == Approx(2).margin(3));
+    CHECK(images[1].at<cv::Vec3b>(24, 32)[0] == Approx(102).margin(3));
+    CHECK(images[2].at<cv::Vec3b>(24, 32)[0] == Approx(3).margin(3));
+}
@@ -0,0 +1,118 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "annotationGroupManager.h"
+#include "annotationGroupTreeModel.h"
+#include "annotationGrouping.h"
+#include "petrack.h"
+
+#include <QSignalSpy>
+#include <catch2/catch.hpp>
+
+using namespace annotationGroups;
+
+TEST_CASE("AnnotationGroupTreeModel fetches trajectories on demand", "[grouping]")
+{
+    Petrack                petrack{"grouping Test"};
+    AnnotationGroupManager manager{petrack, *petrack.getAnimation(), petrack.getPersonStorage()};
+
+    constexpr int                                    numPersons = 450;
+    std::map<int, std::vector<std::tuple<int, int>>> trajectories;
+    for(int i = 0; i < numPersons; ++i)
+    {
+        petrack.getPersonStorage().addPerson({i, 0, {{0, 0}}});
+        trajectories[i] = {{0, 1}};
+    }
+    const GroupConfiguration config{"0.2", {{1, "one", "type", 0}, {2, "two", "type", 0}}, {{0, "LAG"}}, trajectories};
+    manager.loadConfig(config);
+
+    AnnotationGroupTreeModel model{manager};
+    model.rebuild();
+
+    REQUIRE(model.rowCount() == 1);
+    const QModelIndex tlg = model.index(0, 0);
+    REQUIRE(model.rowCount(tlg) == 2);
+    const QModelIndex one = model.index(0, 0, tlg);
+    const QModelIndex two = model.index(1, 0, tlg);
+
+    CHECK(model.hasChildren(one));
+    CHECK(model.rowCount(one) == 0);
+    CHECK(model.canFetchMore(one));
+    CHECK_FALSE(model.hasChildren(two));
+    CHECK_FALSE(model.canFetchMore(two));
+
+    model.fetchMore(one);
+    CHECK(model.rowCount(one) == AnnotationGroupTreeModel::FETCH_BATCH_SIZE);
+    CHECK(model.data(model.index(0, 0, one), Qt::DisplayRole).toString() == "Trajectory 1");
+    CHECK(model.data(model.index(0, 1, one), Qt::DisplayRole).toString() == "0 - end");
+    CHECK(model.parent(model.index(5, 0, one)) == one);
+
+    QSignalSpy reset(&model, &AnnotationGroupTreeModel::modelReset);
+    QSignalSpy inserted(&model, &AnnotationGroupTreeModel::rowsInserted);
+    QSignalSpy removed(&model, &AnnotationGroupTreeModel::rowsRemoved);
+
+    SECTION("Assignments behind the fetched trajectories only change the count")
+    {
+        manager.addTrajectoryToGroup(300, 2, 0);
+        model.updateAssignments();
+
+        CHECK(model.rowCount(one) == AnnotationGroupTreeModel::FETCH_BATCH_SIZE);
+        CHECK(removed.isEmpty());
+        // the empty group was complete, so its new trajectory is added right away
+        CHECK(model.rowCount(two) == 1);
+        CHECK(inserted.size() == 1);
+
+        while(model.canFetchMore(one))
+        {
+            model.fetchMore(one);
+        }
+        CHECK(model.rowCount(one) == numPersons - 1);
+    }
+
+    SECTION("Fetched trajectories are inserted and removed row by row")
+    {
+        manager.addTrajectoryToGroup(5, 2, 0);
+        model.updateAssignments();
+
+        CHECK(model.rowCount(one) == AnnotationGroupTreeModel::FETCH_BATCH_SIZE - 1);
+        CHECK(model.data(model.index(5, 0, one), Qt::DisplayRole).toString() == "Trajectory 7");
+        REQUIRE(removed.size() == 1);
+        CHECK(removed.front().at(1).toInt() == 5);
+        CHECK(model.canFetchMore(one));
+
+        manager.addTrajectoryToGroup(5, 1, 0);
+        model.updateAssignments();
+
+        CHECK(model.rowCount(one) == AnnotationGroupTreeModel::FETCH_BATCH_SIZE);
+        CHECK(model.data(model.index(5, 0, one), Qt::DisplayRole).toString() == "Trajectory 6");
+        CHECK(model.rowCount(two) == 0);
+        CHECK_FALSE(model.hasChildren(two));
+    }
+
+    SECTION("Changed intervals update the rows in place")
+    {
+        manager.addTrajectoryToGroup(0, 2, 10);
+        model.updateAssignments();
+
+        CHECK(model.data(model.index(0, 1, one), Qt::DisplayRole).toString() == "0 - 9");
+        CHECK(model.data(model.index(0, 1, two), Qt::DisplayRole).toString() == "10 - end");
+        CHECK(removed.isEmpty());
+    }
+
+    CHECK(reset.isEmpty());
+}
@@ -318,4 +318,74 @@ TEST_CASE("deleting group cleans up assignments", "[grouping]")
     manager.deleteGroup(groupOne.id);
     CHECK(0 == manager.getGroupsOfTlg(0).size());
     CHECK(NO_GROUP.id == petrack.getPersonStorage().getGroupList(0).getValue(0));
-}
\ No newline at end of file
+}
+TEST_CASE("group index follows the assignments", "[grouping]")
+{
+    Petrack                petrack{"grouping Test"};
+    AnnotationGroupManager manager{petrack, *petrack.getAnimation(), petrack.getPersonStorage()};
+    auto                  &personStorage = petrack.getPersonStorage();
+
+    auto groupOneId = manager.createGroup({"one", "type 1"});
+    auto groupTwoId = manager.createGroup({"two", "type 2"});
+    manager.addGroupToTopLevelGroup(groupOneId, 0);
+    manager.addGroupToTopLevelGroup(groupTwoId, 1);
+
+    for(int i = 0; i < 3; ++i)
+    {
+        TrackPerson person(i + 1, 0, {{0., 0.}});
+        REQUIRE(person.insertAtFrame(20, {{20., 20.}}, 0, true));
+        personStorage.addPerson(person);
+    }
+
+    // build the index before the assignments, so it is updated incrementally
+    REQUIRE(manager.getTrajectoriesOfGroup(groupOneId).empty());
+
+    REQUIRE(manager.addTrajectoryToGroup(2, groupOneId, 0));
+    REQUIRE(manager.addTrajectoryToGroup(0, groupOneId, 5));
+    REQUIRE(manager.addTrajectoryToGroup(0, groupTwoId, 10));
+    REQUIRE(manager.removeTrajectoryAssignment(2, 15));
+
+    const auto checkIndex = [&]()
+    {
+        const auto one = manager.getTrajectoriesOfGroup(groupOneId);
+        REQUIRE(2 == one.size());
+        CHECK(0 == one[0].trackPersonId);
+        CHECK(5 == one[0].frameBegin);
+        CHECK(9 == one[0].frameEnd);
+        CHECK(2 == one[1].trackPersonId);
+        CHECK(0 == one[1].frameBegin);
+        CHECK(14 == one[1].frameEnd);
+
+        const auto two = manager.getTrajectoriesOfGroup(groupTwoId);
+        REQUIRE(1 == two.size());
+        CHECK(-1 == two[0].frameEnd);
+
+        CHECK(std::vector<size_t>{0, 2} == manager.getTrajectoriesOfGroupAtFrame(groupOneId, 7));
+        CHECK(std::vector<size_t>{2} == manager.getTrajectoriesOfGroupAtFrame(groupOneId, 12));
+        CHECK(manager.getTrajectoriesOfGroupAtFrame(groupOneId, 15).empty());
+        CHECK(std::vector<size_t>{0} == manager.getTrajectoriesOfGroupAtFrame(groupTwoId, 1000));
+
+        CHECK(2 == manager.getTrajectoriesOfTopLevelGroup(0).size());
+        CHECK(1 == manager.getTrajectoriesOfTopLevelGroup(1).size());
+        CHECK(manager.getTrajectoriesOfTopLevelGroup(2).empty());
+    };
+
+    SECTION("incremental updates")
+    {
+        checkIndex();
+    }
+
+    SECTION("rebuilt index")
+    {
+        manager.invalidateGroupIndex();
+        checkIndex();
+    }
+
+    SECTION("deleting a trajectory")
+    {
+        personStorage.delPersons({1});
+        const auto one = manager.getTrajectoriesOfGroup(groupOneId);
+        REQUIRE(2 == one.size());
+        CHECK(1 == one[1].trackPersonId);
+    }
+}
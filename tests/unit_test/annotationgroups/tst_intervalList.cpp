@@ -265,4 +265,68 @@ TEST_CASE("src/groups/intervalList", "[groups]")
         // accessing invalid position
         REQUIRE_THROWS(list.getEntry(0));
     }
+    SECTION("Assign several entries at once")
+    {
+        list.insert(0, 10);
+        list.insert(20, 20);
+
+        const std::vector<IntervalList<int>::Entry> entries{{30, 40}, {5, 10}, {10, 30}, {20, 50}, {10, 20}, {25, 0}};
+        IntervalList<int>                           sequential{undefValue};
+        sequential.insert(0, 10);
+        sequential.insert(20, 20);
+        for(const auto &entry : entries)
+        {
+            sequential.insert(entry.start, entry.data);
+        }
+
+        list.assign(entries);
+        SPDLOG_DEBUG("list: {}", list.toString());
+        CHECK(list.toString() == sequential.toString());
+        CHECK(10 == list.getValue(9));
+        CHECK(20 == list.getValue(10));
+        CHECK(50 == list.getValue(24));
+        CHECK(undefValue == list.getValue(29));
+        CHECK(40 == list.getValue(1000));
+    }
+    SECTION("Insert a range")
+    {
+        list.insertRange(5, 9, 10);
+        CHECK(undefValue == list.getValue(4));
+        CHECK(10 == list.getValue(5));
+        CHECK(10 == list.getValue(9));
+        CHECK(undefValue == list.getValue(10));
+        CHECK(2 == list.size());
+
+        list.insert(20, 30);
+        list.insertRange(8, 25, 20);
+        CHECK(10 == list.getValue(7));
+        CHECK(20 == list.getValue(8));
+        CHECK(20 == list.getValue(25));
+        CHECK(30 == list.getValue(26));
+        CHECK(3 == list.size());
+
+        // the same value as before merges with the neighbours
+        list.insertRange(0, 7, 10);
+        CHECK(0 == list.getMinimum());
+        CHECK(3 == list.size());
+
+        list.insertRange(-10, 100, 40);
+        CHECK(-10 == list.getMinimum());
+        CHECK(40 == list.getValue(100));
+        CHECK(30 == list.getValue(101));
+        CHECK(2 == list.size());
+    }
+    SECTION("Lookups in a long list")
+    {
+        for(int i = 0; i < 1000; ++i)
+        {
+            list.insert(10 * i, i % 2 == 0 ? 1 : 2);
+        }
+        REQUIRE(1000 == list.size());
+        CHECK(-1 == list.indexOf(-1));
+        CHECK(0 == list.indexOf(9));
+        CHECK(500 == list.indexOf(5005));
+        CHECK(999 == list.indexOf(100000));
+        CHECK(2 == list.getValue(5019));
+    }
 }
\ No newline at end of file
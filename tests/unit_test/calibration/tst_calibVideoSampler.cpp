@@ -0,0 +1,112 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "calibVideoSampler.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+/// inner corners of a board with the given outer corners, interpolated row by row
+std::vector<cv::Point2f> boardCorners(cv::Size boardSize, cv::Point2f topLeft, float width, float height)
+{
+    std::vector<cv::Point2f> corners;
+    for(int row = 0; row < boardSize.height; ++row)
+    {
+        for(int col = 0; col < boardSize.width; ++col)
+        {
+            corners.emplace_back(
+                topLeft.x + width * col / (boardSize.width - 1), topLeft.y + height * row / (boardSize.height - 1));
+        }
+    }
+    return corners;
+}
+} // namespace
+
+TEST_CASE("CalibVideoSampler selects still frames", "[calibration][CalibVideoSampler]")
+{
+    CalibVideoSampler::Options options;
+    options.minFrameGap = 3;
+    CalibVideoSampler sampler(options);
+
+    cv::Mat still(240, 320, CV_8UC3, cv::Scalar(100, 100, 100));
+    cv::rectangle(still, cv::Rect(40, 40, 100, 80), cv::Scalar(255, 255, 255), cv::FILLED);
+
+    SECTION("The first frame has no predecessor and is never a candidate")
+    {
+        REQUIRE_FALSE(sampler.isCandidate(0, still));
+    }
+
+    SECTION("Still frames are candidates, if they are far enough apart")
+    {
+        REQUIRE_FALSE(sampler.isCandidate(0, still));
+        REQUIRE(sampler.isCandidate(1, still));
+        REQUIRE_FALSE(sampler.isCandidate(2, still));
+        REQUIRE_FALSE(sampler.isCandidate(3, still));
+        REQUIRE(sampler.isCandidate(4, still));
+    }
+
+    SECTION("Moving frames are no candidates")
+    {
+        REQUIRE_FALSE(sampler.isCandidate(0, still));
+        cv::Mat moved(still.size(), still.type(), cv::Scalar(100, 100, 100));
+        cv::rectangle(moved, cv::Rect(160, 120, 100, 80), cv::Scalar(255, 255, 255), cv::FILLED);
+        REQUIRE_FALSE(sampler.isCandidate(1, moved));
+        // still again compared to the moved frame
+        REQUIRE(sampler.isCandidate(2, moved));
+    }
+
+    SECTION("Empty frames are ignored")
+    {
+        REQUIRE_FALSE(sampler.isCandidate(0, cv::Mat()));
+    }
+}
+
+TEST_CASE("CalibVideoSampler accepts only diverse poses", "[calibration][CalibVideoSampler]")
+{
+    const cv::Size boardSize(6, 4);
+    const cv::Size imageSize(1000, 500);
+
+    SECTION("The pose is normalized by the image size")
+    {
+        const auto pose = CalibVideoSampler::toPose(boardCorners(boardSize, {100, 50}, 500, 250), boardSize, imageSize);
+        const CalibVideoSampler::Pose expected{0.1f, 0.1f, 0.6f, 0.1f, 0.1f, 0.6f, 0.6f, 0.6f};
+        for(size_t k = 0; k < pose.size(); ++k)
+        {
+            REQUIRE(pose[k] == Approx(expected[k]));
+        }
+        REQUIRE(CalibVideoSampler::distance(pose, pose) == Approx(0.));
+    }
+
+    CalibVideoSampler::Options options;
+    options.maxFrames       = 2;
+    options.minPoseDistance = 0.05;
+    CalibVideoSampler sampler(options);
+
+    REQUIRE(sampler.addDetection(boardCorners(boardSize, {100, 50}, 500, 250), boardSize, imageSize));
+    // shifted by 1 % of the image size
+    REQUIRE_FALSE(sampler.addDetection(boardCorners(boardSize, {110, 55}, 500, 250), boardSize, imageSize));
+    // incomplete detection
+    REQUIRE_FALSE(sampler.addDetection({{0, 0}, {1, 1}}, boardSize, imageSize));
+    REQUIRE(sampler.numAccepted() == 1);
+    REQUIRE_FALSE(sampler.isFull());
+
+    REQUIRE(sampler.addDetection(boardCorners(boardSize, {400, 200}, 300, 150), boardSize, imageSize));
+    REQUIRE(sampler.isFull());
+    REQUIRE_FALSE(sampler.addDetection(boardCorners(boardSize, {0, 0}, 900, 450), boardSize, imageSize));
+    REQUIRE(sampler.numAccepted() == 2);
+}
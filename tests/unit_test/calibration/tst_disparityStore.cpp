@@ -0,0 +1,84 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "disparityStore.h"
+
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+#include <climits>
+
+TEST_CASE("DisparityStore returns stored disparities", "[calibration][DisparityStore]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString fileName = dir.filePath("video.avi.0123456789abcdef.pds");
+
+    cv::Mat disparity(96, 128, CV_16S, cv::Scalar::all(static_cast<short>(0xFF00)));
+    cv::randu(disparity.rowRange(20, 60), cv::Scalar::all(0), cv::Scalar::all(SHRT_MAX));
+
+    {
+        DisparityStore store;
+        REQUIRE(store.open(fileName));
+        store.put(3, disparity);
+        store.put(4, disparity.colRange(0, 64));
+        cv::Mat stored;
+        REQUIRE(store.get(3, stored));
+        CHECK(cv::countNonZero(stored != disparity) == 0);
+    }
+
+    DisparityStore store;
+    REQUIRE(store.open(fileName));
+    CHECK(store.size() == 2);
+
+    cv::Mat stored;
+    CHECK_FALSE(store.get(5, stored));
+    CHECK(stored.empty());
+    REQUIRE(store.get(4, stored));
+    CHECK(stored.size() == cv::Size(64, 96));
+    CHECK(cv::countNonZero(stored != disparity.colRange(0, 64)) == 0);
+    REQUIRE(store.get(3, stored));
+    CHECK(stored.type() == CV_16S);
+    CHECK(cv::countNonZero(stored != disparity) == 0);
+
+    SECTION("An incomplete chunk at the end is discarded")
+    {
+        store.close();
+        QFile file(fileName);
+        REQUIRE(file.open(QIODevice::Append));
+        file.write("\x05\x00\x00\x00\x60\x00", 6);
+        file.close();
+
+        REQUIRE(store.open(fileName));
+        CHECK(store.size() == 2);
+        store.put(6, disparity);
+        store.close();
+
+        REQUIRE(store.open(fileName));
+        CHECK(store.size() == 3);
+        CHECK(store.get(6, stored));
+    }
+
+    SECTION("A read-only store is never written")
+    {
+        store.close();
+        REQUIRE(store.open(fileName, true));
+        store.put(7, disparity);
+        CHECK_FALSE(store.contains(7));
+        CHECK(store.get(3, stored));
+    }
+}
@@ -139,3 +139,105 @@ TEST_CASE("src/extrCalibration/camToWorldRotation", "[extrCalibration]")
             Approx(0).margin(VEC_MARGIN));
     }
 }
+
+TEST_CASE("src/extrCalibration/batch projection", "[extrCalibration]")
+{
+    Petrack  petrack{"Unknown"};
+    auto    *calib   = petrack.getExtrCalibration();
+    Control *control = petrack.getControlWidget();
+
+    const QString testConfig{
+        R"(<CONTROL>
+                <CALIBRATION>
+                    <EXTRINSIC_PARAMETERS EXTR_ROT_1="%1" EXTR_ROT_2="%2" EXTR_ROT_3="%3" EXTR_TRANS_1="10" EXTR_TRANS_2="-20" EXTR_TRANS_3="-500" />
+                </CALIBRATION>
+            </CONTROL>)"};
+
+    QDomDocument doc;
+    doc.setContent(testConfig.arg("0.1", "-0.2", "0.3"));
+    control->getXml(doc.documentElement(), QString("0.10.0"));
+
+    const std::vector<cv::Point3f> points3D{{0, 0, 0}, {100, 50, 0}, {-30, 70, 0}, {12.5, -80, 0}};
+
+    SECTION("Batch results equal single point results")
+    {
+        const auto points2D = calib->getImagePoint(points3D);
+        REQUIRE(points2D.size() == points3D.size());
+        for(size_t i = 0; i < points3D.size(); ++i)
+        {
+            REQUIRE(points2D[i] == calib->getImagePoint(points3D[i]));
+        }
+
+        const auto backProjected = calib->get3DPoint(points2D, 0);
+        REQUIRE(backProjected.size() == points2D.size());
+        for(size_t i = 0; i < points2D.size(); ++i)
+        {
+            REQUIRE(backProjected[i] == calib->get3DPoint(points2D[i], 0));
+            REQUIRE(cv::norm(backProjected[i] - points3D[i]) == Approx(0).margin(VEC_MARGIN));
+        }
+    }
+
+    SECTION("Changed extrinsic parameters are used")
+    {
+        const auto before = calib->getImagePoint(points3D);
+
+        doc.setContent(testConfig.arg("0.1", "-0.2", "0.5"));
+        control->getXml(doc.documentElement(), QString("0.10.0"));
+        const auto after = calib->getImagePoint(points3D);
+
+        REQUIRE(before[1] != after[1]);
+        REQUIRE(cv::norm(calib->get3DPoint(after[1], 0) - points3D[1]) == Approx(0).margin(VEC_MARGIN));
+    }
+
+    SECTION("Rotation matrix equals camToWorldRotation")
+    {
+        const auto      rotation = calib->getCamToWorldRotation();
+        const cv::Vec3d camVec{0.3, -0.7, 0.2};
+        REQUIRE(rotation * camVec == calib->camToWorldRotation(camVec));
+    }
+}
+
+TEST_CASE("src/extrCalibration/reprojection error", "[extrCalibration]")
+{
+    Petrack  petrack{"Unknown"};
+    auto    *calib   = petrack.getExtrCalibration();
+    Control *control = petrack.getControlWidget();
+
+    const QString testConfig{
+        R"(<CONTROL>
+                <CALIBRATION>
+                    <EXTRINSIC_PARAMETERS EXTR_ROT_1="0.1" EXTR_ROT_2="-0.2" EXTR_ROT_3="0.3" EXTR_TRANS_1="10" EXTR_TRANS_2="-20" EXTR_TRANS_3="-500" />
+                </CALIBRATION>
+            </CONTROL>)"};
+
+    QDomDocument doc;
+    doc.setContent(testConfig);
+    control->getXml(doc.documentElement(), QString("0.10.0"));
+
+    const std::vector<cv::Point3f> points3D{{0, 0, 0}, {100, 50, 0}, {-30, 70, 0}, {12.5, -80, 0}};
+    auto                           points2D = calib->getImagePoint(points3D);
+    calib->set3DList(points3D);
+    calib->set2DList(points2D);
+
+    REQUIRE(calib->calcReprojectionError(control->getExtrinsicParameters()));
+    const auto exact = calib->getReprojectionError();
+    REQUIRE(exact.isValid());
+    REQUIRE(exact.pixelAvg() == Approx(0).margin(1e-3));
+    REQUIRE(exact.pointHeightMax() == Approx(0).margin(1e-2));
+
+    SECTION("Unchanged inputs give the same error")
+    {
+        REQUIRE(calib->calcReprojectionError(control->getExtrinsicParameters()));
+        REQUIRE(calib->getReprojectionError().getData() == exact.getData());
+    }
+
+    SECTION("Changed points are taken into account")
+    {
+        points2D[2] += cv::Point2f(3, 4);
+        calib->set2DList(points2D);
+        REQUIRE(calib->calcReprojectionError(control->getExtrinsicParameters()));
+        const auto moved = calib->getReprojectionError();
+        REQUIRE(moved.pixelMax() == Approx(5).margin(1e-3));
+        REQUIRE(moved.pixelAvg() == Approx(5. / points2D.size()).margin(1e-3));
+    }
+}
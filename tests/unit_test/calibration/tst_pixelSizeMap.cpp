@@ -0,0 +1,82 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "pixelSizeMap.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+PixelSizeMap::Sample linearSample(const cv::Point2f &p)
+{
+    return {10.f + 0.5f * p.x - 0.25f * p.y, 2.f + 0.01f * p.x, 3.f - 0.02f * p.y};
+}
+} // namespace
+
+TEST_CASE("PixelSizeMap interpolates between its grid nodes", "[calibration][PixelSizeMap]")
+{
+    PixelSizeMap map;
+    REQUIRE(map.isEmpty());
+    REQUIRE_FALSE(map.contains(cv::Point2f(0, 0)));
+
+    size_t numNodes = 0;
+    map.build(
+        cv::Rect(-10, -10, 100, 70),
+        32,
+        [&numNodes](const std::vector<cv::Point2f> &nodes)
+        {
+            numNodes = nodes.size();
+            std::vector<PixelSizeMap::Sample> samples;
+            for(const auto &node : nodes)
+            {
+                samples.push_back(linearSample(node));
+            }
+            return samples;
+        });
+
+    REQUIRE_FALSE(map.isEmpty());
+    // ceil(100 / 32) + 1 nodes in x and ceil(70 / 32) + 1 nodes in y direction
+    REQUIRE(numNodes == 5 * 4);
+
+    SECTION("Linear values are reproduced")
+    {
+        for(const auto &p : {cv::Point2f(-10, -10), cv::Point2f(0, 0), cv::Point2f(45.5f, 17.25f), cv::Point2f(90, 60)})
+        {
+            REQUIRE(map.contains(p));
+            const auto expected = linearSample(p);
+            const auto sample   = map.at(p);
+            REQUIRE(sample.headSize == Approx(expected.headSize));
+            REQUIRE(sample.cmPerPixelX == Approx(expected.cmPerPixelX));
+            REQUIRE(sample.cmPerPixelY == Approx(expected.cmPerPixelY));
+        }
+    }
+
+    SECTION("Points outside of the area")
+    {
+        REQUIRE_FALSE(map.contains(cv::Point2f(-11, 0)));
+        REQUIRE_FALSE(map.contains(cv::Point2f(0, 61)));
+        // clamped to the grid
+        REQUIRE(map.at(cv::Point2f(-1000, -10)).headSize == Approx(linearSample(cv::Point2f(-10, -10)).headSize));
+    }
+
+    SECTION("Clear")
+    {
+        map.clear();
+        REQUIRE(map.isEmpty());
+        REQUIRE_FALSE(map.contains(cv::Point2f(0, 0)));
+    }
+}
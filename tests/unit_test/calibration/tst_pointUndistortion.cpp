@@ -0,0 +1,75 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pointUndistortion.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+IntrinsicCameraParams distortedCamera()
+{
+    IntrinsicCameraParams params;
+    params.setR2(-0.25F);
+    params.setR4(0.05F);
+    params.setTx(0.001F);
+    return params;
+}
+} // namespace
+
+TEST_CASE("PointUndistortion without distortion keeps the points", "[calibration][PointUndistortion]")
+{
+    PointUndistortion undistortion;
+    undistortion.setCamera(IntrinsicCameraParams());
+
+    const cv::Point2f point(100.F, 700.F);
+    CHECK(undistortion.distort(point).x == Approx(point.x));
+    CHECK(undistortion.distort(point).y == Approx(point.y));
+    CHECK(undistortion.undistort(point).x == Approx(point.x));
+    CHECK(undistortion.undistort(point).y == Approx(point.y));
+    CHECK(undistortion.scale(point) == Approx(1.));
+}
+
+TEST_CASE("PointUndistortion inverts the distortion", "[calibration][PointUndistortion]")
+{
+    const IntrinsicCameraParams params = distortedCamera();
+    PointUndistortion           undistortion;
+    undistortion.setCamera(params);
+
+    std::vector<cv::Point2f> points{{100.F, 80.F}, {551.5F, 383.5F}, {1000.F, 700.F}, {300.F, 600.F}};
+    const auto               original = points;
+
+    undistortion.distort(points);
+    // barrel distortion moves the corners towards the principal point
+    CHECK(points[0].x > original[0].x);
+    CHECK(points[0].y > original[0].y);
+    CHECK(points[1].x == Approx(params.getCx()));
+    CHECK(points[1].y == Approx(params.getCy()));
+
+    undistortion.undistort(points);
+    for(size_t i = 0; i < points.size(); ++i)
+    {
+        CHECK(points[i].x == Approx(original[i].x).margin(0.01));
+        CHECK(points[i].y == Approx(original[i].y).margin(0.01));
+    }
+
+    // pixels shrink towards the corners of the distorted frame
+    const cv::Point2f center(static_cast<float>(params.getCx()), static_cast<float>(params.getCy()));
+    CHECK(undistortion.scale(center) == Approx(1.).margin(0.01));
+    CHECK(undistortion.scale(cv::Point2f(100.F, 80.F)) < 1.);
+}
@@ -0,0 +1,110 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "stereoRectification.h"
+
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace
+{
+const cv::Size imageSize(640, 480);
+const cv::Mat  cameraMatrix = (cv::Mat_<double>(3, 3) << 800, 0, 320, 0, 800, 240, 0, 0, 1);
+const cv::Mat  distCoeffs   = cv::Mat::zeros(1, 5, CV_64F);
+const cv::Mat  rotation     = cv::Mat::eye(3, 3, CV_64F);
+const cv::Mat  translation  = (cv::Mat_<double>(3, 1) << -0.2, 0, 0);
+} // namespace
+
+TEST_CASE("StereoRectification rectifies a stereo pair", "[calibration][StereoRectification]")
+{
+    StereoRectification rectification;
+    CHECK_FALSE(rectification.isValid());
+    rectification.setCalibration(imageSize, cameraMatrix, distCoeffs, cameraMatrix, distCoeffs, rotation, translation);
+    REQUIRE(rectification.isValid());
+    CHECK(rectification.getImageSize() == imageSize);
+    CHECK(rectification.getBaseline() == Approx(0.2));
+    CHECK(rectification.getFocalLength() == Approx(800).epsilon(0.01));
+
+    SECTION("Already rectified images stay the same, but become gray")
+    {
+        cv::Mat gray(imageSize, CV_8UC1);
+        for(int row = 0; row < gray.rows; ++row)
+        {
+            for(int col = 0; col < gray.cols; ++col)
+            {
+                gray.at<uchar>(row, col) = static_cast<uchar>((col + row) / 5);
+            }
+        }
+        cv::Mat color;
+        cv::cvtColor(gray, color, cv::COLOR_GRAY2BGR);
+
+        cv::Mat rectLeft, rectRight;
+        rectification.rectify(color, gray, rectLeft, rectRight);
+        REQUIRE(rectLeft.size() == imageSize);
+        REQUIRE(rectRight.size() == imageSize);
+        CHECK(rectLeft.type() == CV_8UC1);
+        const cv::Rect inner(20, 20, imageSize.width - 40, imageSize.height - 40);
+        CHECK(cv::norm(rectLeft(inner), gray(inner), cv::NORM_INF) <= 2);
+        CHECK(cv::norm(rectRight(inner), gray(inner), cv::NORM_INF) <= 2);
+    }
+
+    SECTION("Disparities are converted to 3D points in the right camera")
+    {
+        const double         focal = rectification.getFocalLength();
+        const unsigned short disp  = 16 * 256;
+        CHECK(rectification.getZ(disp) == Approx(focal * 0.2 / 16));
+        CHECK(rectification.getZ(0) == -1.f);
+
+        float x1, y1, z1, x2, y2, z2;
+        rectification.toXYZ(240, 320, disp, &x1, &y1, &z1);
+        rectification.toXYZ(250, 330, disp, &x2, &y2, &z2);
+        CHECK(z1 == Approx(rectification.getZ(disp)));
+        CHECK(z2 == Approx(z1));
+        CHECK(x2 - x1 == Approx(10 * z1 / focal));
+        CHECK(y2 - y1 == Approx(10 * z1 / focal));
+    }
+}
+
+TEST_CASE("StereoRectification reads the calibration from a file", "[calibration][StereoRectification]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString fileName = dir.filePath("cam1_stereo.yml");
+
+    StereoRectification rectification;
+    CHECK_FALSE(rectification.load(fileName));
+
+    {
+        cv::FileStorage file(fileName.toStdString(), cv::FileStorage::WRITE);
+        file << "image_size" << imageSize << "M1" << cameraMatrix << "D1" << distCoeffs << "M2" << cameraMatrix
+             << "D2" << distCoeffs << "R" << rotation;
+    }
+    CHECK_FALSE(rectification.load(fileName));
+    CHECK_FALSE(rectification.isValid());
+
+    {
+        cv::FileStorage file(fileName.toStdString(), cv::FileStorage::WRITE);
+        file << "image_size" << imageSize << "M1" << cameraMatrix << "D1" << distCoeffs << "M2" << cameraMatrix
+             << "D2" << distCoeffs << "R" << rotation << "T" << translation;
+    }
+    REQUIRE(rectification.load(fileName));
+    CHECK(rectification.isValid());
+    CHECK(rectification.getImageSize() == imageSize);
+    CHECK(rectification.getBaseline() == Approx(0.2));
+}
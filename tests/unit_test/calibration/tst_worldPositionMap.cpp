@@ -0,0 +1,68 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "worldPositionMap.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+// world position of a camera looking straight down from 500cm; points at height h are scaled by (500 - h) / 500
+QPointF pinholePosition(const QPointF &pos, double height)
+{
+    return (pos - QPointF(320, 240)) * 0.5 * (500. - height) / 500.;
+}
+} // namespace
+
+TEST_CASE("WorldPositionMap interpolates the world positions", "[calibration][WorldPositionMap]")
+{
+    WorldPositionMap map;
+    REQUIRE(map.isEmpty());
+    REQUIRE_FALSE(map.contains(QPointF(0, 0), 0));
+
+    map.build(cv::Rect(0, 0, 640, 480), 16, {200., 0., 100.}, pinholePosition);
+    REQUIRE_FALSE(map.isEmpty());
+
+    SECTION("Positions between the grid nodes and reference heights")
+    {
+        for(const auto &pos : {QPointF(0, 0), QPointF(17.5, 301.25), QPointF(639.9, 3), QPointF(640, 480)})
+        {
+            for(const double height : {0., 42., 100., 180.5, 200.})
+            {
+                REQUIRE(map.contains(pos, height));
+                const auto expected = pinholePosition(pos, height);
+                const auto result   = map.at(pos, height);
+                REQUIRE(result.x() == Approx(expected.x()).margin(1e-9));
+                REQUIRE(result.y() == Approx(expected.y()).margin(1e-9));
+            }
+        }
+    }
+
+    SECTION("Outside of the sampled area or heights")
+    {
+        REQUIRE_FALSE(map.contains(QPointF(-0.5, 10), 100));
+        REQUIRE_FALSE(map.contains(QPointF(10, 480.5), 100));
+        REQUIRE_FALSE(map.contains(QPointF(10, 10), -1));
+        REQUIRE_FALSE(map.contains(QPointF(10, 10), 200.5));
+    }
+
+    SECTION("At least two reference heights are needed")
+    {
+        map.build(cv::Rect(0, 0, 640, 480), 16, {100., 100.}, pinholePosition);
+        REQUIRE(map.isEmpty());
+    }
+}
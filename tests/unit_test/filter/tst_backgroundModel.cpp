@@ -0,0 +1,86 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "backgroundModel.h"
+
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+TEST_CASE("BackgroundModel computes the per-pixel median of the frames", "[filter][BackgroundModel]")
+{
+    // background of 100 and a person passing by in 2 of 5 frames
+    std::vector<cv::Mat> frames;
+    for(int i = 0; i < 3; ++i)
+    {
+        frames.emplace_back(37, 20, CV_8UC3, cv::Scalar::all(100));
+    }
+    for(int i = 0; i < 2; ++i)
+    {
+        cv::Mat person(37, 20, CV_8UC3, cv::Scalar::all(100));
+        person(cv::Rect(5, 5, 10, 30)).setTo(cv::Scalar::all(250));
+        frames.push_back(person);
+    }
+    frames.emplace_back(); // e.g. not decodable
+
+    BackgroundModel model;
+    REQUIRE(model.compute(frames));
+    CHECK(model.getSamples() == 5);
+    CHECK(cv::countNonZero(model.getMedian().reshape(1) != 100) == 0);
+    CHECK(model.getSpread().at<cv::Vec3b>(0, 0) == cv::Vec3b(0, 0, 0));
+    CHECK(model.getSpread().at<cv::Vec3b>(10, 10) == cv::Vec3b(0, 0, 0));
+
+    SECTION("Spread of the noise")
+    {
+        frames.clear();
+        for(int value : {98, 100, 102})
+        {
+            frames.emplace_back(37, 20, CV_8UC3, cv::Scalar::all(value));
+        }
+        REQUIRE(model.compute(frames));
+        CHECK(cv::countNonZero(model.getMedian().reshape(1) != 100) == 0);
+        CHECK(model.getSpread().at<cv::Vec3b>(36, 19) == cv::Vec3b(2, 2, 2));
+        CHECK(model.getNoise() == Approx(1.4826 * 2));
+    }
+
+    SECTION("Frames of different size are rejected")
+    {
+        BackgroundModel other;
+        frames.emplace_back(10, 10, CV_8UC3, cv::Scalar::all(0));
+        CHECK_FALSE(other.compute(frames));
+        CHECK(other.isEmpty());
+    }
+
+    SECTION("The model is saved without loss")
+    {
+        QTemporaryDir dir;
+        REQUIRE(dir.isValid());
+        const QString file = dir.filePath(QString("background") + BackgroundModel::FILE_SUFFIX);
+        CHECK(BackgroundModel::isModelFile(file));
+        REQUIRE(model.save(file));
+
+        BackgroundModel loaded;
+        REQUIRE(loaded.load(file));
+        CHECK(loaded.getSamples() == model.getSamples());
+        CHECK(loaded.getMedian().type() == model.getMedian().type());
+        CHECK(cv::norm(loaded.getMedian(), model.getMedian(), cv::NORM_INF) == 0);
+        CHECK(cv::norm(loaded.getSpread(), model.getSpread(), cv::NORM_INF) == 0);
+
+        CHECK_FALSE(loaded.load(dir.filePath("missing.pbg")));
+        CHECK_FALSE(loaded.isEmpty());
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "brightContrastFilter.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/core.hpp>
+
+TEST_CASE("BrightContrastFilter maps the pixels linearly", "[filter]")
+{
+    BrightContrastFilter filter;
+    filter.getBrightness().setValue(GENERATE(-40., 0., 25.));
+    filter.getContrast().setValue(GENERATE(-60., 0., 35.));
+
+    cv::Mat img(60, 80, CV_8UC(GENERATE(1, 3)));
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    double a, b;
+    filter.getLinearTransform(a, b);
+    cv::Mat expected;
+    img.convertTo(expected, -1, a, b);
+
+    const cv::Mat result = filter.apply(img);
+    REQUIRE(result.size() == expected.size());
+    REQUIRE(result.type() == expected.type());
+    // convertTo may compute in single precision and round differently at .5
+    CHECK(cv::norm(result, expected, cv::NORM_INF) <= 1.);
+
+    SECTION("the lookup table is only rebuilt on changed parameters")
+    {
+        const uchar *lut = filter.getLut().data;
+        filter.apply(img);
+        CHECK(filter.getLut().data == lut);
+
+        filter.getBrightness().setValue(filter.getBrightness().getValue() + 10.);
+        filter.apply(img);
+        filter.getLinearTransform(a, b);
+        CHECK(filter.getLut().at<uchar>(100) == cv::saturate_cast<uchar>(a * 100 + b));
+    }
+}
+
+TEST_CASE("BrightContrastFilter benchmark", "[.][benchmark]")
+{
+    BrightContrastFilter filter;
+    filter.getBrightness().setValue(20.);
+    filter.getContrast().setValue(-30.);
+
+    cv::Mat img(1080, 1920, CV_8UC3);
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(256));
+    double a, b;
+    filter.getLinearTransform(a, b);
+
+    BENCHMARK("convertTo (former implementation)")
+    {
+        cv::Mat res;
+        img.convertTo(res, -1, a, b);
+        return res;
+    };
+    BENCHMARK("lookup table")
+    {
+        return filter.apply(img);
+    };
+}
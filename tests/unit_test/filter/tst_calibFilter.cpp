@@ -0,0 +1,65 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "calibFilter.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/core.hpp>
+
+TEST_CASE("CalibFilter reuses undistortion maps of equal camera parameters", "[filter]")
+{
+    IntrinsicCameraParams params;
+    params.distortionCoeffs.at<float>(0) = -0.2F;
+
+    CalibFilter first;
+    first.getCamParams().setValue(params);
+    first.updateMaps(cv::Size(160, 120));
+    REQUIRE(first.getMap1().type() == CV_16SC2);
+
+    SECTION("the same parameters and size share the maps")
+    {
+        CalibFilter second;
+        second.getCamParams().setValue(params);
+        second.updateMaps(cv::Size(160, 120));
+        CHECK(second.getMap1().data == first.getMap1().data);
+        CHECK(second.getMap2().data == first.getMap2().data);
+    }
+
+    SECTION("another size gets own maps")
+    {
+        CalibFilter second;
+        second.getCamParams().setValue(params);
+        second.updateMaps(cv::Size(80, 60));
+        CHECK(second.getMap1().size() == cv::Size(80, 60));
+        CHECK(second.getMap1().data != first.getMap1().data);
+    }
+
+    SECTION("changed parameters do not overwrite the cached maps")
+    {
+        const cv::Mat cached = first.getMap1().clone();
+        params.distortionCoeffs.at<float>(0) = 0.1F;
+        first.getCamParams().setValue(params);
+        first.updateMaps(cv::Size(160, 120));
+
+        CalibFilter second;
+        params.distortionCoeffs.at<float>(0) = -0.2F;
+        second.getCamParams().setValue(params);
+        second.updateMaps(cv::Size(160, 120));
+        CHECK(cv::norm(second.getMap1(), cached, cv::NORM_INF) == 0);
+    }
+}
@@ -124,3 +124,43 @@ SCENARIO("I use a Parameter-Object to save a parameter")
         }
     }
 }
+
+class CopyFilter : public Filter
+{
+private:
+    cv::Mat act(cv::Mat &img, cv::Mat &res) override
+    {
+        img.copyTo(res);
+        return res;
+    }
+};
+
+TEST_CASE("Filter results are written into pooled buffers", "[filter]")
+{
+    CopyFilter filter;
+    cv::Mat    img(20, 30, CV_8UC3, cv::Scalar(1, 2, 3));
+
+    const uchar *first = filter.apply(img).data;
+    filter.apply(img);
+    // the first buffer is only referenced by the pool now
+    const cv::Mat third = filter.apply(img);
+    CHECK(third.data == first);
+    CHECK(cv::countNonZero(third.reshape(1) != img.reshape(1)) == 0);
+
+    SECTION("a held result is not overwritten")
+    {
+        const cv::Mat fourth = filter.apply(img);
+        const cv::Mat fifth  = filter.apply(img);
+        CHECK(fourth.data != third.data);
+        CHECK(fifth.data != third.data);
+        CHECK(fifth.data != fourth.data);
+    }
+
+    SECTION("another input size gets a buffer of its size")
+    {
+        cv::Mat       smaller(10, 15, CV_8UC3, cv::Scalar(4, 5, 6));
+        const cv::Mat res = filter.apply(smaller);
+        CHECK(res.size() == smaller.size());
+        CHECK(cv::countNonZero(res.reshape(1) != smaller.reshape(1)) == 0);
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameContext.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/imgproc.hpp>
+
+TEST_CASE("FrameContext computes the derived views once", "[filter][FrameContext]")
+{
+    cv::Mat img(20, 30, CV_8UC3);
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    SECTION("color image")
+    {
+        const FrameContext frame(img);
+
+        cv::Mat gray;
+        cv::Mat hsv;
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+        cv::cvtColor(img, hsv, cv::COLOR_BGR2HSV);
+        REQUIRE(cv::norm(frame.gray(), gray, cv::NORM_INF) == 0);
+        REQUIRE(cv::norm(frame.hsv(), hsv, cv::NORM_INF) == 0);
+
+        // the same views are returned again
+        REQUIRE(frame.gray().data == frame.gray().data);
+        REQUIRE(frame.hsv().data == frame.hsv().data);
+    }
+
+    SECTION("gray image")
+    {
+        cv::Mat gray;
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+        const FrameContext frame(gray);
+
+        REQUIRE(frame.gray().data == gray.data);
+        REQUIRE(frame.hsv().empty());
+    }
+
+    SECTION("region")
+    {
+        const cv::Rect     roi(5, 4, 10, 8);
+        const FrameContext frame(img, roi);
+
+        cv::Mat gray;
+        cv::cvtColor(img(roi), gray, cv::COLOR_BGR2GRAY);
+        REQUIRE(frame.gray().size() == img.size());
+        REQUIRE(cv::norm(frame.gray()(roi), gray, cv::NORM_INF) == 0);
+        REQUIRE(cv::countNonZero(frame.gray()) == cv::countNonZero(gray));
+        REQUIRE(frame.hsv().size() == img.size());
+    }
+}
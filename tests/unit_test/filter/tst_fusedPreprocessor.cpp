@@ -0,0 +1,123 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "borderFilter.h"
+#include "brightContrastFilter.h"
+#include "calibFilter.h"
+#include "fusedPreprocessor.h"
+#include "swapFilter.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/core.hpp>
+
+namespace
+{
+cv::Mat applyReference(
+    const cv::Mat        &img,
+    SwapFilter           &swap,
+    BrightContrastFilter &brightContrast,
+    BorderFilter         &border,
+    CalibFilter          &calib)
+{
+    cv::Mat res = img.clone();
+    res         = swap.apply(res);
+    res         = brightContrast.apply(res);
+    res         = border.apply(res);
+    return calib.apply(res);
+}
+
+double maxDifference(const cv::Mat &lhs, const cv::Mat &rhs)
+{
+    double maxDiff = 0;
+    cv::minMaxLoc(cv::abs(lhs.reshape(1) - rhs.reshape(1)), nullptr, &maxDiff);
+    return maxDiff;
+}
+} // namespace
+
+TEST_CASE("FusedPreprocessor gives the same result as the filter chain", "[filter]")
+{
+    SwapFilter           swap;
+    BrightContrastFilter brightContrast;
+    BorderFilter         border;
+    CalibFilter          calib;
+    FusedPreprocessor    fused;
+
+    const int channels = GENERATE(1, 3);
+    cv::Mat   img(120, 160, CV_8UC(channels));
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    swap.getSwapHorizontally().setValue(GENERATE(false, true));
+    swap.getSwapVertically().setValue(GENERATE(false, true));
+    brightContrast.getBrightness().setValue(20.);
+    brightContrast.getContrast().setValue(-30.);
+    border.getBorderSize().setValue(GENERATE(0, 10));
+    border.getBorderColR().setValue(200);
+    border.getBorderColG().setValue(100);
+    border.getBorderColB().setValue(50);
+    calib.setEnabled(GENERATE(false, true));
+
+    const cv::Mat expected = applyReference(img, swap, brightContrast, border, calib);
+    const cv::Mat result   = fused.apply(img, swap, brightContrast, border, calib);
+
+    REQUIRE(result.size() == expected.size());
+    REQUIRE(result.type() == expected.type());
+    // fixed-point maps of the flipped coordinates may round differently by one intensity step
+    CHECK(maxDifference(result, expected) <= 1.);
+
+    SECTION("resets the changed flags of the filters")
+    {
+        CHECK_FALSE(swap.changed());
+        CHECK_FALSE(brightContrast.changed());
+        CHECK_FALSE(border.changed());
+        CHECK_FALSE(calib.changed());
+    }
+
+    SECTION("returns a new buffer for every frame")
+    {
+        const cv::Mat next = fused.apply(img, swap, brightContrast, border, calib);
+        CHECK(next.data != result.data);
+        CHECK(maxDifference(next, result) == 0.);
+    }
+}
+
+TEST_CASE("FusedPreprocessor gives the same result on OpenCL", "[filter]")
+{
+    SwapFilter           swap;
+    BrightContrastFilter brightContrast;
+    BorderFilter         border;
+    CalibFilter          calib;
+    FusedPreprocessor    cpu;
+    FusedPreprocessor    openCL;
+    if(!openCL.setUseOpenCL(true))
+    {
+        WARN("OpenCL not available");
+        return;
+    }
+
+    cv::Mat img(120, 160, CV_8UC3);
+    cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(256));
+    swap.getSwapHorizontally().setValue(true);
+    brightContrast.getBrightness().setValue(20.);
+    border.getBorderSize().setValue(10);
+
+    const cv::Mat expected = cpu.apply(img, swap, brightContrast, border, calib);
+    const cv::Mat result   = openCL.apply(img, swap, brightContrast, border, calib);
+    REQUIRE(result.size() == expected.size());
+    REQUIRE(result.type() == expected.type());
+    CHECK(maxDifference(result, expected) <= 1.);
+}
@@ -0,0 +1,100 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "borderFilter.h"
+#include "virtualBorder.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/core.hpp>
+
+TEST_CASE("VirtualBorder adds the border without copying the frame", "[filter][VirtualBorder]")
+{
+    VirtualBorder virtualBorder;
+    BorderFilter  border;
+    border.setVirtualBorder(&virtualBorder);
+    border.getBorderSize().setValue(10);
+    border.getBorderColR().setValue(200);
+    border.getBorderColG().setValue(100);
+    border.getBorderColB().setValue(50);
+    const cv::Scalar color(50, 100, 200);
+    virtualBorder.setBorder(10, color);
+
+    cv::Mat decoded(60, 80, CV_8UC3);
+    cv::randu(decoded, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat expected;
+    cv::copyMakeBorder(decoded, expected, 10, 10, 10, 10, cv::BORDER_CONSTANT, color);
+
+    const cv::Mat frame    = virtualBorder.frame(decoded.size(), decoded.type());
+    const uchar  *interior = frame.data;
+    decoded.copyTo(frame);
+    REQUIRE(frame.data == interior);
+
+    SECTION("Frames decoded into a buffer are only widened")
+    {
+        cv::Mat       input  = frame;
+        const cv::Mat result = border.apply(input);
+        REQUIRE(result.size() == expected.size());
+        CHECK(cv::norm(result, expected, cv::NORM_INF) == 0.);
+        CHECK(result.ptr(10, 10) == interior);
+    }
+
+    SECTION("Other frames are copied")
+    {
+        cv::Mat       input  = decoded.clone();
+        const uchar  *data   = input.data;
+        const cv::Mat result = border.apply(input);
+        CHECK(cv::norm(result, expected, cv::NORM_INF) == 0.);
+        CHECK(result.ptr(10, 10) != data);
+    }
+
+    SECTION("Frames are copied, if the border of the filter differs")
+    {
+        border.getBorderColR().setValue(0);
+        CHECK(border.withVirtualBorder(frame).empty());
+    }
+
+    SECTION("Buffers of another border are given up")
+    {
+        virtualBorder.setBorder(10, cv::Scalar(0, 0, 0));
+        CHECK(virtualBorder.expand(frame, 10, cv::Scalar(0, 0, 0)).empty());
+    }
+}
+
+TEST_CASE("VirtualBorder reuses buffers no one refers to", "[filter][VirtualBorder]")
+{
+    VirtualBorder virtualBorder;
+    virtualBorder.setBorder(4, cv::Scalar(1, 2, 3));
+    const cv::Size size(20, 10);
+
+    const uchar *first = nullptr;
+    {
+        const cv::Mat frame = virtualBorder.frame(size, CV_8UC3);
+        first               = frame.data;
+        CHECK(virtualBorder.frame(size, CV_8UC3).data != first);
+    }
+    const cv::Mat reused = virtualBorder.frame(size, CV_8UC3);
+    CHECK(reused.data == first);
+    // the border is still painted
+    const cv::Mat bordered = virtualBorder.expand(reused, 4, cv::Scalar(1, 2, 3));
+    REQUIRE(bordered.size() == cv::Size(28, 18));
+    CHECK(bordered.at<cv::Vec3b>(0, 0) == cv::Vec3b(1, 2, 3));
+
+    virtualBorder.setBorder(0, cv::Scalar());
+    CHECK_FALSE(virtualBorder.isEnabled());
+    CHECK(virtualBorder.frame(size, CV_8UC3).isContinuous());
+}
@@ -0,0 +1,104 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "aprilTagDetector.h"
+#include "recognition.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <limits>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/objdetect/aruco_detector.hpp>
+
+using namespace reco;
+
+namespace
+{
+/// Draws the first markers of dictionary with a side length of 80 pixels at positions
+cv::Mat drawMarkers(const cv::aruco::Dictionary &dictionary, const std::vector<cv::Point> &positions)
+{
+    cv::Mat img(600, 800, CV_8UC3, cv::Scalar(255, 255, 255));
+    for(std::size_t i = 0; i < positions.size(); ++i)
+    {
+        cv::Mat marker;
+        cv::aruco::generateImageMarker(dictionary, static_cast<int>(i), 80, marker);
+        cv::cvtColor(marker, marker, cv::COLOR_GRAY2BGR);
+        marker.copyTo(img(cv::Rect(positions[i], marker.size())));
+    }
+    return img;
+}
+} // namespace
+
+SCENARIO("I detect code markers with AprilTag")
+{
+    const std::vector<cv::Point> positions{{20, 20}, {200, 150}, {450, 380}, {680, 480}};
+
+    std::vector<std::vector<cv::Point2f>> corners;
+    std::vector<int>                      ids;
+
+    GIVEN("a dictionary without AprilTag family")
+    {
+        THEN("it is not supported")
+        {
+            REQUIRE_FALSE(AprilTagDetector::supports(cv::aruco::DICT_4X4_50));
+            REQUIRE_FALSE(AprilTagDetector::supports(cv::aruco::DICT_ARUCO_ORIGINAL));
+            REQUIRE(AprilTagDetector::supports(cv::aruco::DICT_APRILTAG_36h11));
+            REQUIRE(AprilTagDetector::supports(17));
+        }
+    }
+
+    GIVEN("markers of DICT_APRILTAG_36h11 and DICT_mip_36h12")
+    {
+        const auto dictIdx = GENERATE(static_cast<int>(cv::aruco::DICT_APRILTAG_36h11), 17);
+        const auto dictionary =
+            dictIdx == 17 ? detail::getDictMip36h12() : cv::aruco::getPredefinedDictionary(dictIdx);
+        const cv::Mat img = drawMarkers(dictionary, positions);
+
+        const AprilTagDetector detector(ArucoCodeParams(), dictIdx);
+        detector.detect(img, std::numeric_limits<double>::quiet_NaN(), 4, corners, ids);
+
+        THEN("every marker is found with the id and corners ArUco reports")
+        {
+            cv::aruco::ArucoDetector              aruco(dictionary);
+            std::vector<std::vector<cv::Point2f>> arucoCorners;
+            std::vector<int>                      arucoIds;
+            aruco.detectMarkers(img, arucoCorners, arucoIds);
+
+            REQUIRE(ids.size() == positions.size());
+            REQUIRE(arucoIds.size() == positions.size());
+            for(std::size_t i = 0; i < ids.size(); ++i)
+            {
+                const auto match = std::find(arucoIds.begin(), arucoIds.end(), ids[i]);
+                REQUIRE(match != arucoIds.end());
+                const auto &expected = arucoCorners[std::distance(arucoIds.begin(), match)];
+                for(std::size_t c = 0; c < 4; ++c)
+                {
+                    REQUIRE(corners[i][c].x == Approx(expected[c].x).margin(1.5));
+                    REQUIRE(corners[i][c].y == Approx(expected[c].y).margin(1.5));
+                }
+            }
+        }
+
+        THEN("markers smaller than the minimal perimeter are dropped")
+        {
+            detector.detect(img, 2 * 4 * 100. / 800, 4, corners, ids);
+            REQUIRE(ids.empty());
+            REQUIRE(corners.empty());
+        }
+    }
+}
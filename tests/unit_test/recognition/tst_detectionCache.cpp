@@ -0,0 +1,85 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "detectionCache.h"
+#include "tracker.h"
+
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+TEST_CASE("DetectionCache replays stored detections", "[recognition][DetectionCache]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString fileName = dir.filePath("video.mp4.0123456789abcdef.pdc");
+
+    TrackPoint marker({10.5, 20.25}, 100, 42);
+    marker.setColPoint(Vec2F(11., 21.));
+    marker.setCol(QColor(255, 0, 0));
+    marker.setOrientation({0., 1., 0.});
+    const QList<TrackPoint> detections{marker, TrackPoint({30., 40.}, 80)};
+
+    {
+        DetectionCache cache;
+        REQUIRE(cache.open(fileName));
+        cache.put(3, detections);
+        cache.put(4, {});
+        QList<TrackPoint> points;
+        REQUIRE(cache.get(3, points));
+        CHECK(points.size() == 2);
+    }
+
+    DetectionCache cache;
+    REQUIRE(cache.open(fileName));
+    CHECK(cache.size() == 2);
+
+    QList<TrackPoint> points;
+    CHECK_FALSE(cache.get(5, points));
+    REQUIRE(cache.get(4, points));
+    CHECK(points.isEmpty());
+    REQUIRE(cache.get(3, points));
+    REQUIRE(points.size() == 2);
+    CHECK(points[0].x() == Approx(10.5));
+    CHECK(points[0].y() == Approx(20.25));
+    CHECK(points[0].qual() == 100);
+    CHECK(points[0].getMarkerID() == 42);
+    CHECK(points[0].colPoint() == Vec2F(11., 21.));
+    CHECK(points[0].color() == QColor(255, 0, 0));
+    CHECK(points[0].getOrientation() == cv::Vec3d(0., 1., 0.));
+    CHECK(points[0].sp() == marker.sp());
+    CHECK_FALSE(points[1].color().isValid());
+    CHECK(points[1].getMarkerID() == -1);
+
+    SECTION("An incomplete record at the end is discarded")
+    {
+        cache.close();
+        QFile file(fileName);
+        REQUIRE(file.open(QIODevice::Append));
+        file.write("\x05\x00\x00\x00\x02\x00", 6);
+        file.close();
+
+        REQUIRE(cache.open(fileName));
+        CHECK(cache.size() == 2);
+        cache.put(6, detections);
+        cache.close();
+
+        REQUIRE(cache.open(fileName));
+        CHECK(cache.size() == 3);
+        CHECK(cache.get(6, points));
+    }
+}
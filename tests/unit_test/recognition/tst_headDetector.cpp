@@ -0,0 +1,73 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "headDetector.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/core.hpp>
+
+using namespace reco;
+
+TEST_CASE("Head detection tiles cover the image", "[recognition][HeadDetector]")
+{
+    SECTION("image smaller than a tile")
+    {
+        const auto tiles = detail::headDetectionTiles(cv::Size(300, 200), 640, 80);
+        REQUIRE(tiles.size() == 1);
+        REQUIRE(tiles.front() == cv::Rect(0, 0, 300, 200));
+    }
+
+    SECTION("image larger than a tile")
+    {
+        const cv::Size size(1500, 700);
+        const auto     tiles = detail::headDetectionTiles(size, 640, 80);
+        REQUIRE(tiles.size() == 6);
+        cv::Mat covered(size, CV_8UC1, cv::Scalar(0));
+        for(const auto &tile : tiles)
+        {
+            REQUIRE(tile.width <= 640);
+            REQUIRE(tile.height <= 640);
+            REQUIRE((tile & cv::Rect(cv::Point(0, 0), size)) == tile);
+            covered(tile).setTo(255);
+        }
+        REQUIRE(cv::countNonZero(covered) == size.area());
+    }
+}
+
+TEST_CASE("Head detections are decoded from the output of the network", "[recognition][HeadDetector]")
+{
+    // two anchors with (center x, center y, width, height, score) in columns, as exported by YOLOv8
+    cv::Mat output = (cv::Mat_<float>(5, 2) << 100, 50, 200, 60, 20, 10, 30, 10, 0.9, 0.2);
+
+    std::vector<HeadDetection> detections;
+    detail::decodeHeadDetections(output, cv::Point2f(10, 20), 0.5f, detections);
+    REQUIRE(detections.size() == 1);
+    REQUIRE(detections.front().score == Approx(0.9));
+    REQUIRE(detections.front().box.x == Approx(100 - 10 + 10));
+    REQUIRE(detections.front().box.y == Approx(200 - 15 + 20));
+    REQUIRE(detections.front().box.width == Approx(20));
+    REQUIRE(detections.front().box.height == Approx(30));
+
+    SECTION("anchors in rows")
+    {
+        std::vector<HeadDetection> rowDetections;
+        detail::decodeHeadDetections(output.t(), cv::Point2f(10, 20), 0.5f, rowDetections);
+        REQUIRE(rowDetections.size() == 1);
+        REQUIRE(rowDetections.front().box.x == Approx(detections.front().box.x));
+    }
+}
@@ -18,6 +18,7 @@
 
 #include "petrack.h"
 #include "recognition.h"
+#include "recognitionResult.h"
 
 #include <QSignalSpy>
 #include <catch2/catch.hpp>
@@ -65,6 +66,20 @@ SCENARIO("I change Aruco parameters (via UI)")
             REQUIRE(spy.count() == 1);
         }
     }
+
+    GIVEN("I use the detectors of the options")
+    {
+        const auto cache = options.getDetectorCache();
+        THEN("They are reused until a parameter changes")
+        {
+            REQUIRE(options.getDetectorCache() == cache);
+            REQUIRE(cache->get(0.1, 0.5) == cache->get(0.1, 0.5));
+            REQUIRE(cache->get(0.1, 0.5) != cache->get(0.2, 0.5));
+
+            options.setIndexOfMarkerDict(17);
+            REQUIRE(options.getDetectorCache() != cache);
+        }
+    }
 }
 
 SCENARIO("I use the setter/getter of ArucoCodeParams")
@@ -100,6 +115,15 @@ SCENARIO("I use the setter/getter of ArucoCodeParams")
         }
     }
 
+    GIVEN("A quadDecimate less than 1")
+    {
+        THEN("An exception is thrown and value isn't changed")
+        {
+            REQUIRE_THROWS(params.setQuadDecimate(0));
+            REQUIRE(params.getQuadDecimate() == 1);
+        }
+    }
+
     GIVEN("A cornerRefinementWinSize less than 1")
     {
         constexpr int newCornerRefinementWinSize = -2;
@@ -243,3 +267,444 @@ SCENARIO("I use the setter/getter of ArucoCodeParams")
         }
     }
 }
+
+SCENARIO("I detect color markers without any widget")
+{
+    cv::Mat img(200, 200, CV_8UC3, cv::Scalar(0, 0, 0));
+    cv::circle(img, cv::Point(120, 80), 25, cv::Scalar(0, 255, 0), cv::FILLED);
+
+    RecognitionOptions options;
+    options.method                      = RecognitionMethod::Color;
+    options.roi                         = QRect(0, 0, 200, 200);
+    options.colorMarker.range.fromColor = QColor::fromHsv(100, 200, 200);
+    options.colorMarker.range.toColor   = QColor::fromHsv(140, 255, 255);
+
+    GIVEN("a ROI containing the marker")
+    {
+        const RecognitionResult result = findMarkers(img, options);
+        THEN("the marker is found and the mask is returned")
+        {
+            REQUIRE(result.method == RecognitionMethod::Color);
+            REQUIRE(result.points.size() == 1);
+            REQUIRE(result.points.front().x() == Approx(120).margin(1));
+            REQUIRE(result.points.front().y() == Approx(80).margin(1));
+            REQUIRE(result.mask.size() == img.size());
+        }
+    }
+
+    GIVEN("a ROI not containing the marker")
+    {
+        options.roi                    = QRect(0, 120, 200, 80);
+        const RecognitionResult result = findMarkers(img, options);
+        THEN("nothing is found and the offset of the ROI is reported")
+        {
+            REQUIRE(result.points.isEmpty());
+            REQUIRE(result.offset.y() == Approx(120));
+        }
+    }
+
+    GIVEN("overlapping search windows around the marker")
+    {
+        options.headSize               = 40;
+        options.searchWindows          = {QRect(60, 20, 120, 120), QRect(70, 30, 120, 120)};
+        const RecognitionResult result = findMarkers(img, options);
+        THEN("the marker is found once and the mask covers the whole ROI")
+        {
+            REQUIRE(result.points.size() == 1);
+            REQUIRE(result.points.front().x() == Approx(120).margin(1));
+            REQUIRE(result.mask.size() == img.size());
+        }
+    }
+
+    GIVEN("an inverted hue range around red")
+    {
+        cv::Mat redImg = img.clone();
+        cv::circle(redImg, cv::Point(60, 140), 25, cv::Scalar(0, 0, 255), cv::FILLED);
+        options.colorMarker.range.fromColor = QColor::fromHsv(30, 200, 200);
+        options.colorMarker.range.toColor   = QColor::fromHsv(330, 255, 255);
+        options.colorMarker.range.invHue    = true;
+        const RecognitionResult result      = findMarkers(redImg, options);
+        THEN("only the red marker is found")
+        {
+            REQUIRE(result.points.size() == 1);
+            REQUIRE(result.points.front().x() == Approx(60).margin(1));
+            REQUIRE(result.points.front().y() == Approx(140).margin(1));
+        }
+    }
+
+    GIVEN("a search window away from the marker")
+    {
+        options.searchWindows          = {QRect(0, 120, 80, 80)};
+        const RecognitionResult result = findMarkers(img, options);
+        THEN("nothing is found")
+        {
+            REQUIRE(result.points.isEmpty());
+        }
+    }
+}
+
+SCENARIO("I extract color blobs from a mask")
+{
+    cv::Mat mask(200, 300, CV_8UC1, cv::Scalar(0));
+    cv::circle(mask, cv::Point(60, 60), 30, cv::Scalar(255), cv::FILLED);
+    cv::rectangle(mask, cv::Rect(150, 30, 80, 70), cv::Scalar(255), cv::FILLED);
+    cv::rectangle(mask, cv::Rect(180, 60, 20, 10), cv::Scalar(0), cv::FILLED);  // hole
+    cv::circle(mask, cv::Point(240, 160), 3, cv::Scalar(255), cv::FILLED);      // too small
+    cv::rectangle(mask, cv::Rect(0, 120, 50, 50), cv::Scalar(255), cv::FILLED); // at the edge
+
+    GIVEN("a minimal area")
+    {
+        const auto contours = detail::findBlobContours(mask, 100);
+        THEN("only the blobs away from the edge and large enough are returned with their outer contour")
+        {
+            std::vector<std::vector<cv::Point>> expected;
+            cv::findContours(mask, expected, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+            expected.erase(
+                std::remove_if(
+                    expected.begin(),
+                    expected.end(),
+                    [](const auto &contour)
+                    {
+                        const auto bounds = cv::boundingRect(contour);
+                        return cv::contourArea(contour) < 100 || bounds.x <= 1;
+                    }),
+                expected.end());
+
+            REQUIRE(contours.size() == 2);
+            REQUIRE(expected.size() == 2);
+            for(const auto &contour : contours)
+            {
+                REQUIRE(std::find(expected.begin(), expected.end(), contour) != expected.end());
+            }
+        }
+    }
+
+    GIVEN("a small disk")
+    {
+        cv::Mat expected;
+        cv::morphologyEx(
+            mask, expected, cv::MORPH_OPEN, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(9, 9)));
+        detail::morphologyDisk(mask, cv::MORPH_OPEN, 4);
+        THEN("the elliptic structuring element is used")
+        {
+            REQUIRE(cv::countNonZero(mask != expected) == 0);
+        }
+    }
+
+    GIVEN("a large disk")
+    {
+        cv::Mat expected;
+        cv::morphologyEx(
+            mask, expected, cv::MORPH_OPEN, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(21, 21)));
+        detail::morphologyDisk(mask, cv::MORPH_OPEN, 10);
+        THEN("the result differs only at the outline of the blobs")
+        {
+            REQUIRE(cv::countNonZero(mask != expected) < 0.02 * cv::countNonZero(expected));
+            // the small blob is removed, the others are kept
+            REQUIRE(detail::findBlobContours(mask, 0).size() == 2);
+        }
+    }
+}
+
+SCENARIO("I detect code markers in tiles")
+{
+    const auto dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    cv::Mat    img(600, 800, CV_8UC1, cv::Scalar(255));
+    // the second marker lies on the seam of the first two tiles
+    const std::vector<cv::Point> positions{{20, 20}, {130, 200}, {400, 400}, {700, 500}};
+    for(std::size_t i = 0; i < positions.size(); ++i)
+    {
+        cv::Mat marker;
+        cv::aruco::generateImageMarker(dictionary, static_cast<int>(i), 60, marker);
+        marker.copyTo(img(cv::Rect(positions[i], marker.size())));
+    }
+
+    ArucoDetectorCache                    detectors(ArucoCodeParams(), cv::aruco::DICT_4X4_50);
+    std::vector<std::vector<cv::Point2f>> corners;
+    std::vector<int>                      ids;
+    std::vector<std::vector<cv::Point2f>> rejected;
+
+    GIVEN("tiles smaller than the image")
+    {
+        detail::detectMarkersTiled(img, detectors, 300, 0.05, 0.5, corners, ids, rejected);
+        THEN("every marker is found once at its position in the image")
+        {
+            REQUIRE(ids.size() == positions.size());
+            for(std::size_t i = 0; i < ids.size(); ++i)
+            {
+                const auto &pos    = positions.at(ids[i]);
+                const auto  center = (corners[i][0] + corners[i][2]) / 2.f;
+                REQUIRE(center.x == Approx(pos.x + 30).margin(2));
+                REQUIRE(center.y == Approx(pos.y + 30).margin(2));
+            }
+        }
+    }
+
+    GIVEN("tiles too small for the largest markers")
+    {
+        detail::detectMarkersTiled(img, detectors, 100, 0.05, 0.5, corners, ids, rejected);
+        THEN("the whole image is searched at once")
+        {
+            REQUIRE(ids.size() == positions.size());
+        }
+    }
+}
+
+SCENARIO("I detect code markers in a downscaled image")
+{
+    const auto dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    cv::Mat    img(600, 800, CV_8UC1, cv::Scalar(255));
+    const std::vector<cv::Point> positions{{20, 20}, {130, 200}, {400, 400}, {700, 500}};
+    for(std::size_t i = 0; i < positions.size(); ++i)
+    {
+        cv::Mat marker;
+        cv::aruco::generateImageMarker(dictionary, static_cast<int>(i), 60, marker);
+        marker.copyTo(img(cv::Rect(positions[i], marker.size())));
+    }
+
+    ArucoDetectorCache                    detectors(ArucoCodeParams(), cv::aruco::DICT_4X4_50);
+    std::vector<std::vector<cv::Point2f>> corners;
+    std::vector<int>                      ids;
+    std::vector<std::vector<cv::Point2f>> rejected;
+
+    GIVEN("markers large enough for the decimation")
+    {
+        detail::detectMarkersDecimated(img, detectors, 2, 0, 0.05, 0.5, corners, ids, rejected);
+        THEN("every marker is found once with its corners at full resolution")
+        {
+            REQUIRE(ids.size() == positions.size());
+            for(std::size_t i = 0; i < ids.size(); ++i)
+            {
+                const auto &pos = positions.at(ids[i]);
+                const auto &tl  = corners[i][0];
+                REQUIRE(tl.x == Approx(pos.x).margin(1));
+                REQUIRE(tl.y == Approx(pos.y).margin(1));
+                const auto center = (corners[i][0] + corners[i][2]) / 2.f;
+                REQUIRE(center.x == Approx(pos.x + 30).margin(1));
+                REQUIRE(center.y == Approx(pos.y + 30).margin(1));
+            }
+        }
+    }
+
+    GIVEN("patches as large as the image")
+    {
+        detail::detectMarkersDecimated(img, detectors, 2, 0, 0.05, 4, corners, ids, rejected);
+        THEN("the whole image is searched at full resolution")
+        {
+            REQUIRE(ids.size() == positions.size());
+        }
+    }
+}
+
+SCENARIO("I detect code markers of several dictionaries in one pass")
+{
+    const auto dict4x4 = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    const auto dict5x5 = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_5X5_50);
+    cv::Mat    img(600, 800, CV_8UC1, cv::Scalar(255));
+    const std::vector<cv::Point> positions{{20, 20}, {200, 150}, {450, 380}, {680, 480}};
+    for(std::size_t i = 0; i < positions.size(); ++i)
+    {
+        // even markers of DICT_4X4_50, odd ones of DICT_5X5_50, each with id i
+        cv::Mat marker;
+        cv::aruco::generateImageMarker(i % 2 == 0 ? dict4x4 : dict5x5, static_cast<int>(i), 70, marker);
+        marker.copyTo(img(cv::Rect(positions[i], marker.size())));
+    }
+
+    std::vector<std::vector<cv::Point2f>> corners;
+    std::vector<int>                      ids;
+    std::vector<std::vector<cv::Point2f>> rejected;
+
+    GIVEN("DICT_5X5_50 as extra dictionary")
+    {
+        ArucoDetectorCache detectors(ArucoCodeParams(), cv::aruco::DICT_4X4_50, {cv::aruco::DICT_5X5_50});
+        detectors.get(0.05, 0.5)->detectMarkers(img, corners, ids, rejected);
+        const auto rejectedBefore = rejected.size();
+        detail::identifyExtraMarkers(img, detectors, corners, ids, rejected);
+
+        THEN("the markers of both dictionaries are found, the ids of the extra one are offset")
+        {
+            REQUIRE(ids.size() == positions.size());
+            REQUIRE(rejected.size() == rejectedBefore - 2);
+            for(std::size_t i = 0; i < ids.size(); ++i)
+            {
+                const int   index = ids[i] % ArucoDetectorCache::ID_STRIDE;
+                const auto &pos   = positions.at(index);
+                REQUIRE(ids[i] / ArucoDetectorCache::ID_STRIDE == index % 2);
+                // the first corner is the top left one of the code, as for ArUco
+                REQUIRE(corners[i][0].x == Approx(pos.x).margin(1));
+                REQUIRE(corners[i][0].y == Approx(pos.y).margin(1));
+            }
+        }
+    }
+
+    GIVEN("no extra dictionary")
+    {
+        ArucoDetectorCache detectors(ArucoCodeParams(), cv::aruco::DICT_4X4_50);
+        detectors.get(0.05, 0.5)->detectMarkers(img, corners, ids, rejected);
+        detail::identifyExtraMarkers(img, detectors, corners, ids, rejected);
+
+        THEN("only the markers of the first dictionary are found")
+        {
+            REQUIRE(ids.size() == 2);
+        }
+    }
+
+    GIVEN("the options of the code marker widget")
+    {
+        CodeMarkerOptions options;
+        options.setIndexOfMarkerDict(cv::aruco::DICT_4X4_50);
+        QSignalSpy spy{&options, &CodeMarkerOptions::indexOfMarkerDictChanged};
+        options.setExtraMarkerDicts({cv::aruco::DICT_5X5_50, cv::aruco::DICT_4X4_50, cv::aruco::DICT_5X5_50});
+
+        THEN("the first dictionary and duplicates are dropped")
+        {
+            REQUIRE(options.getExtraMarkerDicts() == std::vector<int>{cv::aruco::DICT_5X5_50});
+            REQUIRE(spy.count() == 1);
+            REQUIRE(options.getDetectorCache()->getExtraDictionaries().size() == 1);
+        }
+    }
+}
+
+SCENARIO("I detect multicolor markers with codes")
+{
+    const auto dictionary = cv::aruco::getPredefinedDictionary(cv::aruco::DICT_4X4_50);
+    cv::Mat    img(400, 400, CV_8UC3, cv::Scalar(0, 0, 0));
+
+    const std::vector<cv::Point> centers{{100, 100}, {300, 100}, {100, 300}, {300, 300}};
+    for(std::size_t i = 0; i < centers.size(); ++i)
+    {
+        cv::rectangle(
+            img, cv::Rect(centers[i] - cv::Point(40, 40), cv::Size(80, 80)), cv::Scalar(0, 255, 0), cv::FILLED);
+        cv::Mat marker;
+        cv::aruco::generateImageMarker(dictionary, static_cast<int>(i), 40, marker);
+        cv::cvtColor(marker, marker, cv::COLOR_GRAY2BGR);
+        marker.copyTo(img(cv::Rect(centers[i] - cv::Point(20, 20), marker.size())));
+    }
+
+    RecognitionOptions options;
+    options.method = RecognitionMethod::MultiColor;
+    options.roi    = QRect(0, 0, 400, 400);
+    options.multiColorMarker.maps.push_back({QColor::fromHsv(100, 200, 200), QColor::fromHsv(140, 255, 255)});
+    options.multiColorMarker.minArea       = 1000;
+    options.multiColorMarker.maxArea       = 10000;
+    options.multiColorMarker.useCodeMarker = true;
+    options.codeMarker.indexOfMarkerDict   = cv::aruco::DICT_4X4_50;
+    options.codeMarker.cmPerPixelMin       = 0.25;
+    options.codeMarker.cmPerPixelMax       = 0.25;
+    options.codeMarker.imageLength         = 248; // side of the sub images around the blobs
+
+    GIVEN("several blobs with a code each")
+    {
+        const RecognitionResult result = findMarkers(img, options);
+        THEN("every blob gets the code inside of it")
+        {
+            REQUIRE(result.points.size() == static_cast<int>(centers.size()));
+            REQUIRE(result.codeMarkers.size() == centers.size());
+            for(const auto &point : result.points)
+            {
+                REQUIRE(point.getMarkerID() >= 0);
+                const auto &center = centers.at(point.getMarkerID());
+                REQUIRE(point.x() == Approx(center.x).margin(2));
+                REQUIRE(point.y() == Approx(center.y).margin(2));
+            }
+        }
+        THEN("the result does not depend on the scheduling of the blobs")
+        {
+            const RecognitionResult again = findMarkers(img, options);
+            REQUIRE(again.points.size() == result.points.size());
+            for(int i = 0; i < result.points.size(); ++i)
+            {
+                REQUIRE(again.points[i].getMarkerID() == result.points[i].getMarkerID());
+            }
+        }
+    }
+}
+
+SCENARIO("I estimate the pose of several code markers")
+{
+    const cv::Mat   cameraMatrix = (cv::Mat_<double>(3, 3) << 1000, 0, 500, 0, 1000, 500, 0, 0, 1);
+    const cv::Mat   distCoeff    = cv::Mat::zeros(cv::Size(1, 5), CV_32F);
+    constexpr float markerLength = 10;
+
+    // markers facing the camera at a distance of 200
+    std::vector<std::vector<cv::Point2f>> corners;
+    for(const float x : {-50.f, 0.f, 50.f})
+    {
+        const std::vector<cv::Point3f> model{{x - 5, 5, 200}, {x + 5, 5, 200}, {x + 5, -5, 200}, {x - 5, -5, 200}};
+        std::vector<cv::Point2f> projected;
+        cv::projectPoints(model, cv::Vec3d(), cv::Vec3d(), cameraMatrix, distCoeff, projected);
+        corners.push_back(projected);
+    }
+
+    std::vector<cv::Vec3d> rotationVectors;
+    std::vector<cv::Vec3d> translationVectors;
+    detail::estimatePoseSingleMarkers(
+        corners, markerLength, cameraMatrix, distCoeff, rotationVectors, translationVectors);
+
+    THEN("every marker gets its pose in the order of the corners")
+    {
+        REQUIRE(rotationVectors.size() == corners.size());
+        REQUIRE(translationVectors.size() == corners.size());
+        REQUIRE(translationVectors[0][0] == Approx(-50).margin(0.1));
+        REQUIRE(translationVectors[1][0] == Approx(0).margin(0.1));
+        REQUIRE(translationVectors[2][0] == Approx(50).margin(0.1));
+        for(const auto &translation : translationVectors)
+        {
+            REQUIRE(translation[2] == Approx(200).margin(0.1));
+        }
+    }
+}
+
+SCENARIO("I threshold an HSV image")
+{
+    cv::Mat hsv(64, 97, CV_8UC3);
+    cv::randu(hsv, cv::Scalar::all(0), cv::Scalar::all(256));
+
+    detail::ColorParameters param;
+    param.h_low  = 40;
+    param.h_high = 90;
+    param.s_low  = 60;
+    param.s_high = 255;
+    param.v_low  = 30;
+    param.v_high = 200;
+
+    cv::Mat expectedHue;
+    cv::inRange(hsv, cv::Scalar(param.h_low, 0, 0), cv::Scalar(param.h_high, 255, 255), expectedHue);
+    cv::Mat expectedSatVal;
+    cv::inRange(
+        hsv, cv::Scalar(0, param.s_low, param.v_low), cv::Scalar(255, param.s_high, param.v_high), expectedSatVal);
+
+    cv::Mat bin;
+    WHEN("the hue range is not inverted")
+    {
+        detail::thresholdHSV(hsv, bin, param);
+        THEN("the result is the same as with cv::inRange")
+        {
+            const cv::Mat expected = expectedHue & expectedSatVal;
+            REQUIRE(bin.type() == CV_8UC1);
+            REQUIRE(cv::countNonZero(bin != expected) == 0);
+        }
+    }
+
+    WHEN("the hue range is inverted")
+    {
+        param.inversHue = true;
+        detail::thresholdHSV(hsv, bin, param);
+        THEN("the hue has to be outside of the range")
+        {
+            const cv::Mat expected = ~expectedHue & expectedSatVal;
+            REQUIRE(cv::countNonZero(bin != expected) == 0);
+        }
+    }
+
+    WHEN("a range is empty")
+    {
+        param.v_low  = 200;
+        param.v_high = 100;
+        detail::thresholdHSV(hsv, bin, param);
+        THEN("no pixel is inside")
+        {
+            REQUIRE(cv::countNonZero(bin) == 0);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "batchJobs.h"
+
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <catch2/catch.hpp>
+
+TEST_CASE("BatchJobs reads the job list", "[tracking][BatchJobs]")
+{
+    const QDir base("/data/experiments");
+
+    SECTION("Relative paths refer to the job file, arguments keep their order")
+    {
+        const auto json = QJsonDocument::fromJson(R"({"jobs": [
+            {"project": "exp1.pet", "action": "track", "output": "out/exp1.trc", "arguments": ["-frameRange", 0, 99]},
+            {"project": "/other/exp2.pet", "action": "save", "output": "/other/exp2.txt"}
+        ]})");
+        const auto jobs = BatchJobs::parseJobs(json.object(), base);
+        REQUIRE(jobs);
+        REQUIRE(jobs->size() == 2);
+        CHECK(jobs->at(0).project == "/data/experiments/exp1.pet");
+        CHECK(jobs->at(0).output == "/data/experiments/out/exp1.trc");
+        CHECK(jobs->at(0).arguments == QStringList{"-frameRange", "0", "99"});
+        CHECK(jobs->at(1).project == "/other/exp2.pet");
+        CHECK(jobs->at(1).output == "/other/exp2.txt");
+    }
+
+    SECTION("Jobs without project, output or a known action are rejected")
+    {
+        const auto parse = [&](const char *jobs)
+        { return BatchJobs::parseJobs(QJsonDocument::fromJson(jobs).object(), base); };
+        CHECK_FALSE(parse(R"({"jobs": [{"action": "track", "output": "a.trc"}]})"));
+        CHECK_FALSE(parse(R"({"jobs": [{"project": "a.pet", "action": "track"}]})"));
+        CHECK_FALSE(parse(R"({"jobs": [{"project": "a.pet", "action": "recognize", "output": "a.trc"}]})"));
+    }
+}
+
+TEST_CASE("BatchJobs runs the action of a job as option of a headless process", "[tracking][BatchJobs]")
+{
+    const BatchJob job{"/data/exp1.pet", "exportView", "/data/exp1.mp4", {"-sequence", "/data/exp1.avi"}};
+    const auto     arguments = BatchJobs::commandLine(job);
+    REQUIRE(arguments);
+    CHECK(
+        *arguments ==
+        QStringList{"/data/exp1.pet", "-sequence", "/data/exp1.avi", "-autoExportView", "/data/exp1.mp4", "-headless"});
+}
+
+TEST_CASE("BatchJobs gives each process its share of the cores", "[tracking][BatchJobs]")
+{
+    CHECK(BatchJobs::resourceArguments(0, 4, -1) == QStringList{"-threads", "4"});
+    CHECK(BatchJobs::resourceArguments(0, 4, 0) == QStringList{"-threads", "4", "-pin", "0"});
+    CHECK(BatchJobs::resourceArguments(3, 4, 8) == QStringList{"-threads", "4", "-pin", "20"});
+}
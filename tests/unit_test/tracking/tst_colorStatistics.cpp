@@ -0,0 +1,125 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "colorStatistics.h"
+#include "tracker.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+const Vec2F LEFT(-1., 0.);
+const Vec2F RIGHT(1., 0.);
+} // namespace
+
+TEST_CASE("ColorStatistics counts the colors per side of the head", "[tracking][ColorStatistics]")
+{
+    ColorStatistics statistics;
+    CHECK(statistics.count(ColorStatistics::BOTH_SIDES) == 0);
+    CHECK_FALSE(statistics.median(ColorStatistics::BOTH_SIDES).isValid());
+
+    statistics.pushBack(QColor(10, 20, 30), RIGHT);
+    statistics.pushBack(QColor(), LEFT); // ignored
+    statistics.pushBack(QColor(30, 10, 50), RIGHT);
+    statistics.pushBack(QColor(200, 200, 200), LEFT);
+    statistics.pushBack(QColor(20, 40, 10), RIGHT);
+
+    CHECK(statistics.count(0) == 3);
+    CHECK(statistics.count(1) == 1);
+    CHECK(statistics.median(0) == QColor(20, 20, 30));
+    CHECK(statistics.median(1) == QColor(200, 200, 200));
+    // lower middle value for an even number of colors
+    CHECK(statistics.median(ColorStatistics::BOTH_SIDES) == QColor(20, 20, 30));
+
+    SECTION("A color added in front becomes the reference side")
+    {
+        statistics.pushFront(QColor(210, 210, 210), LEFT);
+        CHECK(statistics.count(0) == 2);
+        CHECK(statistics.count(1) == 3);
+    }
+
+    SECTION("Colors at the ends can be replaced")
+    {
+        statistics.popBack(QColor(20, 40, 10));
+        statistics.pushBack(QColor(40, 50, 60), LEFT);
+        CHECK(statistics.count(0) == 2);
+        CHECK(statistics.count(1) == 2);
+
+        statistics.popFront(QColor(10, 20, 30));
+        statistics.pushFront(QColor(0, 0, 0), RIGHT);
+        CHECK(statistics.isValid());
+        CHECK(statistics.median(0) == QColor(0, 0, 0));
+    }
+
+    SECTION("Removing two colors at one end invalidates the statistics")
+    {
+        statistics.popBack(QColor(20, 40, 10));
+        statistics.popBack(QColor(200, 200, 200));
+        CHECK_FALSE(statistics.isValid());
+        statistics.clear();
+        CHECK(statistics.isValid());
+        CHECK(statistics.count(ColorStatistics::BOTH_SIDES) == 0);
+    }
+
+    SECTION("Copies share the histograms until one of them changes")
+    {
+        const ColorStatistics copy = statistics;
+        statistics.pushBack(QColor(250, 250, 250), RIGHT);
+        CHECK(copy.count(0) == 3);
+        CHECK(copy.median(0) == QColor(20, 20, 30));
+        CHECK(statistics.count(0) == 4);
+    }
+}
+
+TEST_CASE("TrackPerson::optimizeColor deletes the colors of the side seen less often", "[tracking][ColorStatistics]")
+{
+    const Vec2F pos(100., 100.);
+    const auto  point = [&pos](const Vec2F &direction, const QColor &color)
+    { return TrackPoint(pos, 100, pos + direction, color); };
+
+    TrackPerson person(0, 10, point(RIGHT, QColor(10, 10, 10)));
+    person.append(point(RIGHT, QColor(30, 30, 30)));
+    person.append(point(LEFT, QColor(200, 0, 0)));
+    person.append(point(LEFT, QColor(220, 0, 0)));
+    person.append(point(RIGHT, QColor(20, 20, 20)));
+    person.append(point(RIGHT, QColor()));
+
+    person.optimizeColor();
+    CHECK(person.color() == QColor(20, 20, 20));
+    CHECK(person.at(0).color().isValid());
+    CHECK_FALSE(person.at(2).color().isValid());
+    CHECK_FALSE(person.at(3).color().isValid());
+    CHECK(person.at(4).color().isValid());
+
+    SECTION("A new color at the end is taken into account")
+    {
+        REQUIRE(person.insertAtFrame(16, point(RIGHT, QColor(40, 40, 40)), 0, false));
+        REQUIRE(person.insertAtFrame(17, point(RIGHT, QColor(50, 50, 50)), 0, false));
+        person.optimizeColor();
+        CHECK(person.color() == QColor(30, 30, 30));
+    }
+
+    SECTION("With the same number of colors on both sides, all colors are kept")
+    {
+        TrackPerson tie(0, 10, point(RIGHT, QColor(10, 10, 10)));
+        tie.append(point(LEFT, QColor(200, 200, 200)));
+        tie.optimizeColor();
+        CHECK(tie.color() == QColor(10, 10, 10));
+        CHECK(tie.at(1).color().isValid());
+    }
+}
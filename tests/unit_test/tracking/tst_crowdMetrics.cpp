@@ -0,0 +1,124 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "crowdMetrics.h"
+
+#include <QDomDocument>
+#include <QFile>
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+namespace
+{
+LivePosition at(int id, double x, double y)
+{
+    return {id, QPointF(), QPointF(x, y)};
+}
+
+CrowdMetrics createMetrics(const QString &fileName)
+{
+    CrowdMetrics metrics;
+    metrics.setFileName(fileName);
+    metrics.setAreas({{"room", QPolygonF({{0, 0}, {200, 0}, {200, 200}, {0, 200}})}});
+    metrics.setLines({{"door", QLineF(100, -100, 100, 300)}});
+    metrics.setGridCellSize(100);
+    return metrics;
+}
+} // namespace
+
+TEST_CASE("CrowdMetrics measures areas, lines and the density per frame", "[tracking][CrowdMetrics]")
+{
+    CrowdMetrics metrics = createMetrics("metrics.csv");
+    REQUIRE(metrics.isEnabled());
+    metrics.start();
+    REQUIRE(metrics.isRunning());
+
+    const std::vector<LivePosition> positions{at(1, 50, 50), at(2, 150, 50), at(3, 500, 50)};
+    metrics.setFrame(10, positions, {});
+    metrics.setFrame(11, {at(1, 150, 60), at(2, 50, 60), at(3, 150, 50)}, positions);
+
+    const auto &first = metrics.at(10);
+    CHECK(first.persons == 3);
+    CHECK(first.areaCounts == std::vector<int>{2});
+    CHECK(first.forward == std::vector<int>{0});
+    CHECK(first.backward == std::vector<int>{0});
+    REQUIRE(first.cells.size() == 3);
+    CHECK(first.cells[0].column == 0);
+    CHECK(first.cells[0].row == 0);
+    CHECK(first.cells[0].count == 1);
+
+    // person 1 crosses the door from left to right (with the y-axis up), person 2 the other way round
+    const auto &second = metrics.at(11);
+    CHECK(second.areaCounts == std::vector<int>{3});
+    CHECK(second.forward == std::vector<int>{1});
+    CHECK(second.backward == std::vector<int>{1});
+    REQUIRE(second.cells.size() == 2);
+    CHECK(second.cells[1].column == 1);
+    CHECK(second.cells[1].count == 2);
+
+    SECTION("Measuring a frame again replaces its values")
+    {
+        metrics.setFrame(11, {at(1, 150, 60)}, {at(1, 150, 50)});
+        CHECK(metrics.at(11).persons == 1);
+        CHECK(metrics.at(11).forward == std::vector<int>{0});
+        CHECK(metrics.at(11).backward == std::vector<int>{0});
+    }
+}
+
+TEST_CASE("CrowdMetrics writes compact time series", "[tracking][CrowdMetrics]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString fileName = dir.filePath("metrics.csv");
+
+    CrowdMetrics metrics = createMetrics(fileName);
+    metrics.start();
+    metrics.setFrame(0, {at(1, 50, 50)}, {});
+    metrics.setFrame(1, {at(1, 150, 50)}, {at(1, 50, 50)});
+    REQUIRE(metrics.finish());
+    CHECK_FALSE(metrics.isRunning());
+
+    QFile file(fileName);
+    REQUIRE(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    CHECK(file.readAll() == "frame,persons,room,door_forward,door_backward\n0,1,1,0,0\n1,1,1,1,0\n");
+
+    QFile gridFile(CrowdMetrics::gridFileName(fileName));
+    REQUIRE(gridFile.open(QIODevice::ReadOnly | QIODevice::Text));
+    CHECK(gridFile.readAll() == "frame,x,y,density\n0,0,0,1\n1,100,0,1\n");
+}
+
+TEST_CASE("CrowdMetrics keeps its geometry in the project", "[tracking][CrowdMetrics]")
+{
+    const CrowdMetrics metrics = createMetrics("metrics.csv");
+
+    QDomDocument doc;
+    QDomElement  elem = doc.createElement("CROWD_METRICS");
+    doc.appendChild(elem);
+    metrics.setXml(elem);
+
+    CrowdMetrics read;
+    read.getXml(elem);
+    CHECK(read.getFileName() == "metrics.csv");
+    CHECK(read.getGridCellSize() == Approx(100));
+    REQUIRE(read.getAreas().size() == 1);
+    CHECK(read.getAreas()[0].name == "room");
+    CHECK(read.getAreas()[0].polygon == metrics.getAreas()[0].polygon);
+    REQUIRE(read.getLines().size() == 1);
+    CHECK(read.getLines()[0].line == metrics.getLines()[0].line);
+    CHECK_FALSE(read.isRunning());
+}
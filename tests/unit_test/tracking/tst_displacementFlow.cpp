@@ -0,0 +1,156 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "displacementFlow.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace
+{
+/// frame with textured blobs at centers shifted by index * shift
+cv::Mat createFrame(int index, const std::vector<cv::Point2f> &centers, cv::Point2f shift)
+{
+    cv::Mat frame(240, 320, CV_8UC3, cv::Scalar(40, 40, 40));
+    for(const auto &center : centers)
+    {
+        const cv::Point2f pos = center + static_cast<float>(index) * shift;
+        cv::circle(frame, pos, 12, cv::Scalar(200, 200, 200), cv::FILLED, cv::LINE_AA);
+        cv::circle(frame, pos + cv::Point2f(-4, -3), 4, cv::Scalar(20, 20, 20), cv::FILLED, cv::LINE_AA);
+        cv::rectangle(frame, cv::Rect(cv::Point(pos) + cv::Point(3, 2), cv::Size(5, 4)), cv::Scalar(90, 90, 90), 2);
+    }
+    return frame;
+}
+} // namespace
+
+TEST_CASE("DisplacementCache stores flows per frame and point", "[tracking][displacementFlow]")
+{
+    DisplacementCache cache;
+    cache.setKey("settings");
+    cache.insert(5, {{10.5F, 20.F}, {12.F, 21.F}, true});
+    cache.insert(5, {{3.F, 4.F}, {}, false});
+    cache.insert(6, {{10.5F, 20.F}, {11.F, 20.F}, true});
+
+    REQUIRE(cache.find(5, {10.5F, 20.F}));
+    CHECK(cache.find(5, {10.5F, 20.F})->next == cv::Point2f(12.F, 21.F));
+    CHECK_FALSE(cache.find(5, {3.F, 4.F})->found);
+    CHECK_FALSE(cache.find(5, {10.F, 20.F}));
+    CHECK_FALSE(cache.find(7, {10.5F, 20.F}));
+
+    SECTION("Inserting a point again replaces its flow")
+    {
+        cache.insert(5, {{3.F, 4.F}, {5.F, 6.F}, true});
+        CHECK(cache.find(5, {3.F, 4.F})->found);
+    }
+
+    SECTION("Serialization keeps all flows exactly")
+    {
+        DisplacementCache loaded;
+        REQUIRE(loaded.deserialize(cache.serialize()));
+        REQUIRE(loaded.find(6, {10.5F, 20.F}));
+        CHECK(loaded.find(6, {10.5F, 20.F})->next == cv::Point2f(11.F, 20.F));
+        CHECK(loaded.find(5, {3.F, 4.F}));
+        CHECK(loaded.serialize() == cache.serialize());
+
+        CHECK_FALSE(loaded.deserialize(cache.serialize().left(20)));
+        CHECK(loaded.isEmpty());
+    }
+
+    SECTION("Another key discards the flows")
+    {
+        cache.setKey("settings");
+        CHECK_FALSE(cache.isEmpty());
+        cache.setKey("other settings");
+        CHECK(cache.isEmpty());
+    }
+}
+
+TEST_CASE("FilterGeometry filters regions like swap and border filter", "[tracking][displacementFlow]")
+{
+    cv::Mat frame(60, 80, CV_8UC1);
+    cv::randu(frame, 0, 256);
+    const int  border = 7;
+    const bool flipH  = GENERATE(false, true);
+    const bool flipV  = GENERATE(false, true);
+
+    cv::Mat filtered = frame.clone();
+    if(flipH || flipV)
+    {
+        cv::flip(frame, filtered, flipH && flipV ? -1 : (flipH ? 1 : 0));
+    }
+    cv::copyMakeBorder(filtered, filtered, border, border, border, border, cv::BORDER_CONSTANT, cv::Scalar(0));
+
+    const FilterGeometry geometry(frame.size(), border, flipH, flipV);
+    CHECK(geometry.getFilteredSize() == filtered.size());
+
+    const cv::Rect region(3, 5, 40, 30);
+    const cv::Mat  res = geometry.remapRegion(frame, region);
+    CHECK(cv::norm(res, filtered(region), cv::NORM_INF) == 0);
+}
+
+TEST_CASE("computePointFlows tracks the points in regions of the frames", "[tracking][displacementFlow]")
+{
+    const std::vector<cv::Point2f> centers{{60.F, 60.F}, {200.F, 150.F}};
+    const cv::Point2f              shift(3.F, 2.F);
+    const int                      border = GENERATE(0, 10);
+    const bool                     flipH  = GENERATE(false, true);
+
+    int         numRead = 0;
+    FrameSource source;
+    source.readFrame = [&](int index)
+    {
+        ++numRead;
+        return createFrame(index, centers, shift);
+    };
+    const FilterGeometry geometry(cv::Size(320, 240), border, flipH, false);
+
+    // positions of the centers in the filtered image
+    auto toFiltered = [&](const cv::Point2f &p)
+    { return cv::Point2f(flipH ? 319.F - p.x : p.x, p.y) + cv::Point2f(border, border); };
+    const cv::Point2f filteredShift(flipH ? -shift.x : shift.x, shift.y);
+
+    std::vector<FlowJob> jobs;
+    for(int frame : {1, 2, 3, 10})
+    {
+        FlowJob job{frame, {}};
+        for(const auto &center : centers)
+        {
+            job.points.push_back(toFiltered(center + static_cast<float>(frame - 1) * shift));
+        }
+        jobs.push_back(job);
+    }
+    // a point outside of the image is not found
+    jobs.back().points.emplace_back(-50.F, 10.F);
+
+    const auto flows = computePointFlows(source, geometry, jobs, cv::Size(21, 21), 2);
+    REQUIRE(flows.size() == jobs.size());
+    // consecutive frames are only read once
+    CHECK(numRead == 6);
+    for(size_t i = 0; i < jobs.size(); ++i)
+    {
+        for(size_t j = 0; j < centers.size(); ++j)
+        {
+            const PointFlow &flow = flows[i][j];
+            CHECK(flow.point == jobs[i].points[j]);
+            REQUIRE(flow.found);
+            CHECK(flow.next.x == Approx(flow.point.x + filteredShift.x).margin(0.3));
+            CHECK(flow.next.y == Approx(flow.point.y + filteredShift.y).margin(0.3));
+        }
+    }
+    CHECK_FALSE(flows.back().back().found);
+}
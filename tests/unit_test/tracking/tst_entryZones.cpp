@@ -0,0 +1,73 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "entryZones.h"
+#include "tracker.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("EntryZones learns where trajectories start", "[tracking][EntryZones]")
+{
+    constexpr int cellSize = 40;
+
+    std::vector<TrackPerson> persons;
+    // present from the first frame on, so they did not enter
+    for(int i = 0; i < 5; ++i)
+    {
+        persons.emplace_back(i + 1, 0, TrackPoint(Vec2F(300, 300)));
+    }
+    // entering at the left border
+    for(int i = 0; i < 5; ++i)
+    {
+        persons.emplace_back(i + 6, 10 + i, TrackPoint(Vec2F(10 + i, 100 + i)));
+    }
+
+    EntryZones zones;
+    zones.setEnabled(true);
+
+    SECTION("Few starts are not enough to learn the zones")
+    {
+        zones.learn(persons, 0, cellSize);
+        CHECK_FALSE(zones.isLearned());
+    }
+
+    SECTION("Cells with several starts and their neighbours are entry zones")
+    {
+        // single starts spread over the image
+        for(int i = 0; i < 5; ++i)
+        {
+            persons.emplace_back(i + 11, 20, TrackPoint(Vec2F(200 + 80 * i, 500)));
+        }
+        zones.learn(persons, 0, cellSize);
+        REQUIRE(zones.isLearned());
+
+        const std::vector<QRect> expected{
+            QRect(-cellSize, cellSize, 3 * cellSize, cellSize),
+            QRect(-cellSize, 2 * cellSize, 3 * cellSize, cellSize),
+            QRect(-cellSize, 3 * cellSize, 3 * cellSize, cellSize)};
+        CHECK(zones.getZones() == expected);
+    }
+
+    SECTION("Disabled, nothing is learned")
+    {
+        zones.setEnabled(false);
+        zones.learn(persons, 0, cellSize);
+        CHECK_FALSE(zones.isLearned());
+        CHECK(zones.getZones().empty());
+    }
+}
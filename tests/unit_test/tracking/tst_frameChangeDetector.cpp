@@ -0,0 +1,75 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "frameChangeDetector.h"
+
+#include <catch2/catch.hpp>
+#include <opencv2/imgproc.hpp>
+
+TEST_CASE("FrameChangeDetector classifies consecutive frames", "[tracking][FrameChangeDetector]")
+{
+    using Change = FrameChangeDetector::Change;
+
+    cv::Mat frame(480, 640, CV_8UC1);
+    cv::randu(frame, cv::Scalar(0), cv::Scalar(256));
+    frame.at<uchar>(100, 100) = 0;
+    // cells of 10 x 7 pixel
+    const cv::Rect region(0, 0, 640, 448);
+
+    FrameChangeDetector detector;
+    CHECK(detector.update(0, frame, region) == Change::Changed);
+
+    detector.setEnabled(true);
+    CHECK(detector.update(0, frame, region) == Change::Changed);
+    CHECK(detector.update(1, frame, region) == Change::Duplicate);
+    CHECK(detector.getDuplicateFrames() == std::vector<int>{1});
+
+    SECTION("A moving head changes the frame")
+    {
+        cv::Mat moved = frame.clone();
+        cv::circle(moved, {200, 200}, 10, cv::Scalar(0), cv::FILLED);
+        CHECK(detector.update(2, moved, region) == Change::Changed);
+    }
+
+    SECTION("Slight noise leaves the frame static")
+    {
+        cv::Mat noisy             = frame.clone();
+        noisy.at<uchar>(100, 100) = 100;
+        CHECK(detector.update(2, noisy, region) == Change::Static);
+    }
+
+    SECTION("Changes outside of the region are ignored")
+    {
+        cv::Mat moved = frame.clone();
+        cv::circle(moved, {600, 465}, 10, cv::Scalar(0), cv::FILLED);
+        CHECK(detector.update(2, moved, region) == Change::Duplicate);
+    }
+
+    SECTION("Only directly following frames are compared")
+    {
+        CHECK(detector.update(5, frame, region) == Change::Changed);
+        CHECK(detector.update(4, frame, region) == Change::Duplicate);
+    }
+
+    SECTION("Reset forgets the last frame and the duplicates")
+    {
+        detector.reset();
+        CHECK(detector.getDuplicateFrames().empty());
+        CHECK(detector.update(2, frame, region) == Change::Changed);
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "framePipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <thread>
+
+TEST_CASE("FramePipeline runs the stages as soon as their inputs are available", "[tracking][FramePipeline]")
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(2);
+    FramePipeline pipeline(pool);
+
+    std::atomic<int> sum{0};
+    REQUIRE(pipeline.addStage(
+        "mean",
+        {FramePipeline::IMAGE},
+        {"mean"},
+        [](FrameData &data) { data.set("mean", cv::mean(data.get<cv::Mat>(FramePipeline::IMAGE))[0]); }));
+    REQUIRE(pipeline.addStage(
+        "count",
+        {"mean", FramePipeline::TRAJECTORIES},
+        {},
+        [&sum](FrameData &data)
+        {
+            const auto &positions = data.get<std::vector<PersonPosition>>(FramePipeline::TRAJECTORIES);
+            sum += static_cast<int>(data.get<double>("mean")) + static_cast<int>(positions.size());
+        }));
+
+    SECTION("The images are shared, not copied")
+    {
+        const cv::Mat     image(4, 4, CV_8UC1, cv::Scalar(10));
+        std::atomic<bool> shared{false};
+        REQUIRE(pipeline.addStage(
+            "share",
+            {FramePipeline::IMAGE},
+            {},
+            [&](FrameData &data) { shared = data.get<cv::Mat>(FramePipeline::IMAGE).data == image.data; }));
+        pipeline.begin(0);
+        pipeline.provide(FramePipeline::IMAGE, image);
+        pipeline.finish();
+        CHECK(shared);
+    }
+
+    SECTION("A stage waits for all of its inputs")
+    {
+        pipeline.begin(7);
+        pipeline.provide(FramePipeline::IMAGE, cv::Mat(4, 4, CV_8UC1, cv::Scalar(10)));
+        pipeline.provide(FramePipeline::TRAJECTORIES, std::vector<PersonPosition>{{1, {1, 2}}, {2, {3, 4}}});
+        pipeline.finish();
+        CHECK(sum == 12);
+    }
+
+    SECTION("Stages without their inputs are skipped")
+    {
+        pipeline.begin(8);
+        pipeline.provide(FramePipeline::IMAGE, cv::Mat(4, 4, CV_8UC1, cv::Scalar(10)));
+        pipeline.finish();
+        CHECK(sum == 0);
+
+        // the next frame starts with no data
+        pipeline.begin(9);
+        pipeline.provide(FramePipeline::TRAJECTORIES, std::vector<PersonPosition>{});
+        pipeline.finish();
+        CHECK(sum == 0);
+    }
+
+    SECTION("Independent stages run at the same time")
+    {
+        std::atomic<int> running{0};
+        std::atomic<int> maxRunning{0};
+        const auto       wait = [&](FrameData &)
+        {
+            maxRunning = std::max(maxRunning.load(), ++running);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            --running;
+        };
+        REQUIRE(pipeline.addStage("a", {FramePipeline::FILTERED}, {}, wait));
+        REQUIRE(pipeline.addStage("b", {FramePipeline::FILTERED}, {}, wait));
+        pipeline.begin(0);
+        pipeline.provide(FramePipeline::FILTERED, 0);
+        pipeline.finish();
+        CHECK(maxRunning == 2);
+    }
+
+    SECTION("Invalid stages are rejected")
+    {
+        CHECK_FALSE(pipeline.addStage("mean", {FramePipeline::IMAGE}, {"other"}, [](FrameData &) {}));
+        CHECK_FALSE(pipeline.addStage("unknown", {"unknown"}, {}, [](FrameData &) {}));
+        CHECK_FALSE(pipeline.addStage("image", {}, {FramePipeline::IMAGE}, [](FrameData &) {}));
+        CHECK_FALSE(pipeline.addStage("twice", {}, {"mean"}, [](FrameData &) {}));
+
+        CHECK_FALSE(pipeline.removeStage("mean"));
+        CHECK(pipeline.removeStage("count"));
+        CHECK(pipeline.removeStage("mean"));
+        CHECK_FALSE(pipeline.removeStage("mean"));
+        CHECK(pipeline.isEmpty());
+    }
+}
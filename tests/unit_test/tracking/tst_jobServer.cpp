@@ -0,0 +1,82 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "jobServer.h"
+
+#include <QDir>
+#include <QJsonDocument>
+#include <catch2/catch.hpp>
+
+TEST_CASE("JobServer reads one job per request", "[tracking][JobServer]")
+{
+    SECTION("Valid job with priority")
+    {
+        const auto job = JobServer::parseRequest(
+            R"({"project": "/data/exp1.pet", "action": "track", "output": "/data/exp1.trc", "priority": 3})", 7);
+        REQUIRE(job);
+        CHECK(job->id == 7);
+        CHECK(job->priority == 3);
+        CHECK(job->job.project == "/data/exp1.pet");
+        CHECK(job->job.action == "track");
+        CHECK(job->job.output == "/data/exp1.trc");
+    }
+
+    SECTION("Relative paths refer to the working directory, the priority defaults to 0")
+    {
+        const auto job = JobServer::parseRequest(R"({"project": "exp1.pet", "action": "save", "output": "a.txt"})", 0);
+        REQUIRE(job);
+        CHECK(job->priority == 0);
+        CHECK(job->job.project == QDir::current().absoluteFilePath("exp1.pet"));
+    }
+
+    SECTION("Invalid requests are rejected")
+    {
+        CHECK_FALSE(JobServer::parseRequest("no json", 0));
+        CHECK_FALSE(JobServer::parseRequest("[1, 2]", 0));
+        CHECK_FALSE(JobServer::parseRequest(R"({"project": "a.pet", "action": "recognize", "output": "a.trc"})", 0));
+    }
+}
+
+TEST_CASE("JobServer starts the job with the highest priority submitted first", "[tracking][JobServer]")
+{
+    std::vector<ServerJob> queue;
+    queue.push_back({0, 0, {}, nullptr});
+    queue.push_back({1, 2, {}, nullptr});
+    queue.push_back({2, 5, {}, nullptr});
+    queue.push_back({3, 5, {}, nullptr});
+    CHECK(JobServer::nextJob(queue) == 2);
+
+    queue.erase(queue.begin() + 2);
+    CHECK(JobServer::nextJob(queue) == 2);
+    queue.erase(queue.begin() + 2);
+    CHECK(JobServer::nextJob(queue) == 1);
+    queue.erase(queue.begin() + 1);
+    CHECK(JobServer::nextJob(queue) == 0);
+}
+
+TEST_CASE("JobServer answers with one JSON object per line", "[tracking][JobServer]")
+{
+    const QByteArray line = JobServer::message(4, "succeeded", {{"seconds", 1.5}});
+    REQUIRE(line.endsWith('\n'));
+    CHECK(line.count('\n') == 1);
+
+    const auto json = QJsonDocument::fromJson(line).object();
+    CHECK(json["id"].toInt() == 4);
+    CHECK(json["state"].toString() == "succeeded");
+    CHECK(json["seconds"].toDouble() == 1.5);
+}
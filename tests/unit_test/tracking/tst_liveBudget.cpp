@@ -0,0 +1,83 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "liveBudget.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+void addFrames(LiveBudget &budget, double latency, int frames)
+{
+    for(int i = 0; i < frames; ++i)
+    {
+        budget.addLatency(latency);
+    }
+}
+} // namespace
+
+TEST_CASE("LiveBudget adapts the load level to the latency", "[tracking][LiveBudget]")
+{
+    LiveBudget budget;
+    budget.setBudget(40);
+    REQUIRE(budget.isEnabled());
+
+    SECTION("Within the budget, every frame is processed with the parameters of the project")
+    {
+        addFrames(budget, 30, 100);
+        CHECK(budget.getLevel() == 0);
+        CHECK(budget.recoStep(5) == 1);
+        CHECK(budget.trackRegionLevels(3) == 3);
+        CHECK(budget.trackRegionScale(16) == 16);
+    }
+
+    SECTION("Over the budget, the level rises once per settling period up to the maximum")
+    {
+        addFrames(budget, 80, LiveBudget::SETTLE_FRAMES);
+        CHECK(budget.getLevel() == 1);
+        addFrames(budget, 80, LiveBudget::SETTLE_FRAMES - 1);
+        CHECK(budget.getLevel() == 1);
+        addFrames(budget, 80, 10 * LiveBudget::SETTLE_FRAMES);
+        CHECK(budget.getLevel() == LiveBudget::MAX_LEVEL);
+
+        CHECK(budget.recoStep(1) == 8);
+        CHECK(budget.recoStep(5) == 20);
+        CHECK(budget.trackRegionLevels(3) == 1);
+        CHECK(budget.trackRegionLevels(0) == 0);
+        CHECK(budget.trackRegionScale(20) == 14);
+    }
+
+    SECTION("Well below the budget, the level drops again")
+    {
+        addFrames(budget, 80, 2 * LiveBudget::SETTLE_FRAMES);
+        REQUIRE(budget.getLevel() == 2);
+        addFrames(budget, 30, 10 * LiveBudget::SETTLE_FRAMES);
+        CHECK(budget.getLevel() == 2);
+        addFrames(budget, 10, 10 * LiveBudget::SETTLE_FRAMES);
+        CHECK(budget.getLevel() == 0);
+    }
+
+    SECTION("Without budget the level stays 0")
+    {
+        budget.setBudget(0);
+        addFrames(budget, 1000, 100);
+        CHECK_FALSE(budget.isEnabled());
+        CHECK(budget.getLevel() == 0);
+        CHECK(budget.getLatency() == Approx(1000));
+    }
+}
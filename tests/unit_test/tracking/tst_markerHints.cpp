@@ -0,0 +1,72 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "markerHints.h"
+#include "recognitionResult.h"
+#include "tracker.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("MarkerHints anchors lost trajectories at rejected code markers", "[tracking][MarkerHints]")
+{
+    std::vector<TrackPerson> persons;
+    // lost after frame 10
+    persons.emplace_back(1, 0, TrackPoint(Vec2F(100, 100)));
+    for(int frame = 1; frame <= 10; ++frame)
+    {
+        persons.back().insertAtFrame(frame, TrackPoint(Vec2F(100 + 2 * frame, 100)), 0, false);
+    }
+    // tracked into frame 11, without and with marker ID
+    persons.emplace_back(2, 11, TrackPoint(Vec2F(300, 300)));
+    persons.emplace_back(3, 11, TrackPoint(Vec2F(500, 500), 100, 5), 5);
+
+    const std::vector<Vec2F> candidates{{123, 101}, {305, 300}, {502, 500}, {800, 800}};
+
+    MarkerHints hints;
+    hints.setEnabled(true);
+    const auto anchors = hints.update(11, candidates, persons, 20);
+    REQUIRE(anchors.size() == 1);
+    CHECK(anchors[0].person == 0);
+    CHECK(anchors[0].position == Vec2F(123, 101));
+
+    const auto next = hints.getHints(12);
+    REQUIRE(next.size() == 2);
+    CHECK(next[0] == Vec2F(123, 101));
+    CHECK(next[1] == Vec2F(305, 300));
+    CHECK(hints.getHints(10).size() == 2);
+    CHECK(hints.getHints(11).empty());
+    CHECK(hints.getHints(13).empty());
+
+    SECTION("Disabled, nothing is anchored or searched again")
+    {
+        hints.setEnabled(false);
+        CHECK(hints.update(11, candidates, persons, 20).empty());
+        CHECK(hints.getHints(12).empty());
+    }
+}
+
+TEST_CASE("MarkerHints takes the centers of the rejected candidates", "[tracking][MarkerHints]")
+{
+    reco::RecognitionResult result;
+    result.offset = Vec2F(10, 20);
+    result.codeMarkers.push_back({{}, {}, {{{0, 0}, {10, 0}, {10, 10}, {0, 10}}}, Vec2F(5, 5)});
+
+    const auto candidates = MarkerHints::candidates(result);
+    REQUIRE(candidates.size() == 1);
+    CHECK(candidates[0] == Vec2F(20, 30));
+}
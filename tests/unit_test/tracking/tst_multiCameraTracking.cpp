@@ -0,0 +1,128 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "multiCameraTracking.h"
+
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <catch2/catch.hpp>
+
+namespace
+{
+/// Trajectory of camera, walking along x with 10 cm per frame from x0 at frame first
+WorldTrajectory walk(int camera, int id, int first, int frames, double x0, double y)
+{
+    WorldTrajectory trajectory{camera, id, first, {}};
+    for(int j = 0; j < frames; ++j)
+    {
+        trajectory.points.emplace_back(x0 + 10. * j, y, 170.);
+    }
+    return trajectory;
+}
+} // namespace
+
+TEST_CASE("MultiCameraTracking reads the camera views", "[tracking][MultiCameraTracking]")
+{
+    const auto json    = QJsonDocument::fromJson(R"({"cameras": [
+        {"project": "left.pet"},
+        {"project": "/other/right.pet", "frameOffset": -12}
+    ]})");
+    const auto cameras = MultiCameraTracking::parseCameras(json.object(), QDir("/data/experiments"));
+    REQUIRE(cameras);
+    REQUIRE(cameras->size() == 2);
+    CHECK(cameras->at(0).project == "/data/experiments/left.pet");
+    CHECK(cameras->at(0).frameOffset == 0);
+    CHECK(cameras->at(1).project == "/other/right.pet");
+    CHECK(cameras->at(1).frameOffset == -12);
+
+    CHECK_FALSE(MultiCameraTracking::parseCameras(
+        QJsonDocument::fromJson(R"({"cameras": [{"frameOffset": 3}]})").object(), QDir("/data")));
+}
+
+TEST_CASE("MultiCameraTracking reads the txt export of a camera view", "[tracking][MultiCameraTracking]")
+{
+    QString     text = "# z: can be 3d position or height of person (alternating or not)\n"
+                       "# id frame x/m y/m z/m markerID\n"
+                       "1 10 1.5 -2 1.75 7\n"
+                       "1 11 1.6 -2 1.75 7\n"
+                       "1 13 1.8 -2 1.75 7\n"
+                       "2 10 0 0 1.6 -1\n";
+    QTextStream in(&text);
+
+    const auto trajectories = MultiCameraTracking::readTrajectories(in, 1, 5);
+    REQUIRE(trajectories.size() == 3);
+    CHECK(trajectories[0].camera == 1);
+    CHECK(trajectories[0].id == 1);
+    CHECK(trajectories[0].firstFrame == 15);
+    REQUIRE(trajectories[0].points.size() == 2);
+    CHECK(trajectories[0].points[1].x() == Approx(160));
+    CHECK(trajectories[0].points[1].y() == Approx(-200));
+    CHECK(trajectories[0].points[1].z() == Approx(175));
+    // missing frames split the trajectory
+    CHECK(trajectories[1].id == 1);
+    CHECK(trajectories[1].firstFrame == 18);
+    CHECK(trajectories[2].id == 2);
+}
+
+TEST_CASE("MultiCameraTracking merges the persons seen by several cameras", "[tracking][MultiCameraTracking]")
+{
+    // person A walks from camera 0 into camera 1 and is seen by both in frames 20 to 39,
+    // person B is only seen by camera 1 and walks nearby
+    const std::vector<WorldTrajectory> trajectories{
+        walk(0, 1, 0, 40, 0, 0),
+        walk(1, 1, 20, 40, 203, 0),
+        walk(1, 2, 20, 40, 200, 60),
+        walk(0, 2, 0, 10, 1000, 1000)};
+
+    const auto merged = MultiCameraTracking::associate(trajectories, 40, 10);
+    REQUIRE(merged.size() == 3);
+
+    const auto &a = merged[0];
+    CHECK(a.camera == -1);
+    CHECK(a.firstFrame == 0);
+    CHECK(a.lastFrame() == 59);
+    CHECK(a.points[10].x() == Approx(100));
+    CHECK(a.points[30].x() == Approx(301.5));
+    CHECK(a.points[50].x() == Approx(503));
+
+    CHECK(merged[1].camera == 1);
+    CHECK(merged[1].id == 2);
+    CHECK(merged[2].camera == 0);
+
+    SECTION("Too short overlaps are not associated")
+    {
+        CHECK(MultiCameraTracking::associate(trajectories, 40, 21).size() == 4);
+    }
+
+    SECTION("Trajectories of the same camera are never merged")
+    {
+        const std::vector<WorldTrajectory> sameView{walk(0, 1, 0, 20, 0, 0), walk(0, 2, 0, 20, 5, 0)};
+        CHECK(MultiCameraTracking::associate(sameView, 40, 10).size() == 2);
+    }
+
+    SECTION("The merged trajectories are written like the txt export")
+    {
+        QString     text;
+        QTextStream out(&text);
+        MultiCameraTracking::writeTrajectories(out, {walk(0, 7, 3, 2, 10, 20)});
+        out.flush();
+        CHECK(text == "# id frame x/cm y/cm z/cm\n1 3 10 20 170\n1 4 20 20 170\n");
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "parameterSweep.h"
+
+#include <QDomDocument>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <catch2/catch.hpp>
+
+TEST_CASE("ParameterSweep builds the grid of configurations", "[tracking][ParameterSweep]")
+{
+    SECTION("All combinations, the last parameter changes fastest")
+    {
+        const auto configurations = ParameterSweep::grid({{"A/X", {"1", "2"}}, {"B/Y", {"a", "b", "c"}}});
+        REQUIRE(configurations.size() == 6);
+        CHECK(configurations[0] == SweepConfiguration{{"A/X", "1"}, {"B/Y", "a"}});
+        CHECK(configurations[1] == SweepConfiguration{{"A/X", "1"}, {"B/Y", "b"}});
+        CHECK(configurations[3] == SweepConfiguration{{"A/X", "2"}, {"B/Y", "a"}});
+        CHECK(configurations[5] == SweepConfiguration{{"A/X", "2"}, {"B/Y", "c"}});
+    }
+
+    SECTION("Parameters are read from JSON")
+    {
+        const auto json       = QJsonDocument::fromJson(R"({"CONTROL/TRACKING/LEVEL": [2, 3], "MAIN/X": ["a"]})");
+        const auto parameters = ParameterSweep::parseParameters(json.object());
+        REQUIRE(parameters);
+        REQUIRE(parameters->size() == 2);
+        CHECK(parameters->at(0).path == "CONTROL/TRACKING/LEVEL");
+        CHECK(parameters->at(0).values == QStringList{"2", "3"});
+        CHECK(parameters->at(1).values == QStringList{"a"});
+    }
+
+    SECTION("Parameters without values or element are rejected")
+    {
+        CHECK_FALSE(ParameterSweep::parseParameters(QJsonDocument::fromJson(R"({"MAIN/X": []})").object()));
+        CHECK_FALSE(ParameterSweep::parseParameters(QJsonDocument::fromJson(R"({"X": [1]})").object()));
+    }
+}
+
+TEST_CASE("ParameterSweep applies a configuration to the project", "[tracking][ParameterSweep]")
+{
+    QDomDocument doc;
+    doc.setContent(QString(R"(<PETRACK><CONTROL><TRACKING><SEARCH_REGION LEVEL="3"/></TRACKING></CONTROL></PETRACK>)"));
+
+    SECTION("Attributes are set")
+    {
+        REQUIRE(ParameterSweep::apply(doc, {{"CONTROL/TRACKING/SEARCH_REGION/LEVEL", "5"}, {"CONTROL/NEW", "x"}}));
+        const auto control = doc.firstChildElement("PETRACK").firstChildElement("CONTROL");
+        CHECK(control.firstChildElement("TRACKING").firstChildElement("SEARCH_REGION").attribute("LEVEL") == "5");
+        CHECK(control.attribute("NEW") == "x");
+    }
+
+    SECTION("Missing elements are an error")
+    {
+        CHECK_FALSE(ParameterSweep::apply(doc, {{"CONTROL/RECOGNITION/METHOD", "1"}}));
+    }
+}
@@ -0,0 +1,441 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "personStorage.h"
+#include "petrack.h"
+
+#include <QSignalSpy>
+#include <catch2/catch.hpp>
+#include <tuple>
+
+TEST_CASE("PersonStorage returns the persons active in a frame", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"activePersons Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    storage.addPerson({0, 10, {{0, 0}}});
+    storage.addPerson({0, 100, {{50, 50}}});
+    storage.addPerson({0, 0, {{100, 100}}});
+
+    CHECK(storage.activePersons(10) == std::vector<size_t>{0});
+    CHECK(storage.activePersons(100) == std::vector<size_t>{1});
+    CHECK(storage.activePersons(0) == std::vector<size_t>{2});
+    CHECK(storage.activePersons(1).empty());
+    CHECK(storage.activePersons(1000).empty());
+
+    std::vector<size_t> persons{7, 8, 9};
+    storage.activePersons(100, persons);
+    CHECK(persons == std::vector<size_t>{1});
+
+    SECTION("Extended trajectories are found in the new frames")
+    {
+        for(int frame = 11; frame <= 130; ++frame)
+        {
+            storage.insertFeaturePoint(0, frame, TrackPoint{{0, 0}}, 0, false, -1, 0);
+        }
+        CHECK(storage.activePersons(70) == std::vector<size_t>{0});
+        CHECK(storage.activePersons(100) == std::vector<size_t>{0, 1});
+        CHECK(storage.activePersons(130) == std::vector<size_t>{0});
+        CHECK(storage.visible(100) == 2);
+    }
+
+    SECTION("Indices are updated after deleting a person")
+    {
+        storage.delPointOf(0, PersonStorage::TrajectorySegment::Whole, -1);
+        CHECK(storage.activePersons(10).empty());
+        CHECK(storage.activePersons(100) == std::vector<size_t>{0});
+        CHECK(storage.activePersons(0) == std::vector<size_t>{1});
+    }
+
+    SECTION("Shortened trajectories are not returned for the deleted frames")
+    {
+        storage.insertFeaturePoint(2, 1, TrackPoint{{100, 100}}, 2, false, -1, 0);
+        CHECK(storage.activePersons(1) == std::vector<size_t>{2});
+        storage.delPointOf(2, PersonStorage::TrajectorySegment::Following, 0);
+        CHECK(storage.activePersons(1).empty());
+        CHECK(storage.activePersons(0) == std::vector<size_t>{2});
+    }
+}
+
+TEST_CASE("PersonStorage hit tests only the persons active in the frame range", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"hit test Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    storage.addPerson({0, 10, {{0, 0}}});
+    storage.addPerson({0, 200, {{0, 300}}});
+    storage.addPerson({0, 20, {{1000, 1000}}});
+    for(int frame = 11; frame <= 100; ++frame)
+    {
+        storage.insertFeaturePoint(0, frame, TrackPoint{{static_cast<float>(frame), 0}}, 0, false, -1, 0);
+    }
+
+    CHECK(storage.activePersons(0, 9).empty());
+    CHECK(storage.activePersons(0, 300) == std::vector<size_t>{0, 1, 2});
+    CHECK(storage.activePersons(90, 199) == std::vector<size_t>{0});
+    CHECK(storage.activePersons(101, 199).empty());
+
+    const auto proximal = storage.getProximalPersons(QPointF{50, 0}, {}, FrameRange{100, 100, 100});
+    REQUIRE(proximal.size() == 1);
+    CHECK(proximal.front().personID == 0);
+    CHECK(proximal.front().frame == 50);
+
+    CHECK(storage.getProximalPersons(QPointF{50, 0}, {1, 2}, FrameRange{100, 100, 100}).empty());
+    CHECK(storage.getProximalPersons(QPointF{0, 300}, {}, FrameRange{0, 0, 200}).size() == 1);
+}
+
+TEST_CASE("PersonStorage stitches the trajectories of overlapping segments", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"stitch Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    // first segment: frames 0 to 20
+    storage.addPerson({0, 0, {{0, 0}}});
+    storage.addPerson({0, 0, {{100, 0}}});
+    for(int frame = 1; frame <= 20; ++frame)
+    {
+        storage.insertFeaturePoint(0, frame, TrackPoint{{0, 0}}, 0, false, -1, 0);
+        storage.insertFeaturePoint(1, frame, TrackPoint{{100, 0}}, 1, false, -1, 0);
+    }
+    // second segment: frames 10 to 30, tracked in a different order
+    storage.addPerson({0, 10, {{101, 0}}});
+    storage.addPerson({0, 10, {{1, 0}}});
+    storage.addPerson({0, 10, {{300, 0}}});
+    for(int frame = 11; frame <= 30; ++frame)
+    {
+        storage.insertFeaturePoint(2, frame, TrackPoint{{101, 0}}, 2, false, -1, 0);
+        storage.insertFeaturePoint(3, frame, TrackPoint{{1, 0}}, 3, false, -1, 0);
+        storage.insertFeaturePoint(4, frame, TrackPoint{{300, 0}}, 4, false, -1, 0);
+    }
+
+    CHECK(storage.stitch(2, 10, 20, 5) == 2);
+    REQUIRE(storage.nbPersons() == 3);
+    CHECK(storage.at(0).firstFrame() == 0);
+    CHECK(storage.at(0).lastFrame() == 30);
+    CHECK(storage.at(0).trackPointAt(30).x() == Approx(1));
+    CHECK(storage.at(1).firstFrame() == 0);
+    CHECK(storage.at(1).lastFrame() == 30);
+    CHECK(storage.at(1).trackPointAt(30).x() == Approx(101));
+    CHECK(storage.at(2).firstFrame() == 10);
+    CHECK(storage.at(2).trackPointAt(30).x() == Approx(300));
+}
+
+TEST_CASE("PersonStorage merges duplicate trajectories in one undo step", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"mergeDuplicates Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    // first frame, last frame and x of each person
+    const std::vector<std::tuple<int, int, double>> persons{
+        {0, 20, 0}, {5, 25, 1}, {0, 20, 100}, {10, 20, 2}, {15, 30, 101}};
+    for(size_t person = 0; person < persons.size(); ++person)
+    {
+        const auto [first, last, x] = persons[person];
+        storage.addPerson({0, first, {{x, 0}}});
+        for(int frame = first + 1; frame <= last; ++frame)
+        {
+            storage.insertFeaturePoint(person, frame, TrackPoint{{x, 0}}, static_cast<int>(person), false, -1, 0);
+        }
+    }
+
+    // person 0 is merged once only
+    CHECK(storage.mergeDuplicates({{0, 1}, {0, 3}, {2, 4}}) == 2);
+    REQUIRE(storage.nbPersons() == 3);
+    CHECK(storage.at(0).firstFrame() == 0);
+    CHECK(storage.at(0).lastFrame() == 25);
+    CHECK(storage.at(1).firstFrame() == 0);
+    CHECK(storage.at(1).lastFrame() == 30);
+    CHECK(storage.at(2).firstFrame() == 10);
+
+    storage.undo();
+    REQUIRE(storage.nbPersons() == 5);
+    CHECK(storage.at(1).firstFrame() == 5);
+    CHECK(storage.at(4).trackPointAt(30).x() == Approx(101));
+}
+
+TEST_CASE("PersonStorage undoes and redoes manual actions", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"undo Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    for(int person = 0; person < 3; ++person)
+    {
+        storage.addPerson({0, 0, {{100. * person, 0}}});
+        for(int frame = 1; frame <= 10; ++frame)
+        {
+            storage.insertFeaturePoint(person, frame, TrackPoint{{100. * person, 1. * frame}}, person, false, -1, 0);
+        }
+    }
+
+    SECTION("Deleting a person")
+    {
+        storage.delPointOf(1, PersonStorage::TrajectorySegment::Whole, -1);
+        REQUIRE(storage.nbPersons() == 2);
+        CHECK(storage.at(1).first().x() == Approx(200));
+
+        storage.undo();
+        REQUIRE(storage.nbPersons() == 3);
+        CHECK(storage.at(1).first().x() == Approx(100));
+        CHECK(storage.at(1).lastFrame() == 10);
+        CHECK(storage.activePersons(5) == std::vector<size_t>{0, 1, 2});
+
+        storage.redo();
+        REQUIRE(storage.nbPersons() == 2);
+        CHECK(storage.at(1).first().x() == Approx(200));
+    }
+
+    SECTION("Splitting and deleting parts of persons")
+    {
+        storage.splitPerson(0, 5);
+        storage.delPointOf(2, PersonStorage::TrajectorySegment::Following, 7);
+        REQUIRE(storage.nbPersons() == 4);
+        CHECK(storage.at(0).lastFrame() == 4);
+        CHECK(storage.at(2).lastFrame() == 7);
+        CHECK(storage.at(3).firstFrame() == 5);
+
+        storage.undo();
+        REQUIRE(storage.nbPersons() == 4);
+        CHECK(storage.at(2).lastFrame() == 10);
+
+        storage.undo();
+        REQUIRE(storage.nbPersons() == 3);
+        CHECK(storage.at(0).lastFrame() == 10);
+
+        storage.redo();
+        storage.redo();
+        REQUIRE(storage.nbPersons() == 4);
+        CHECK(storage.at(0).lastFrame() == 4);
+        CHECK(storage.at(2).lastFrame() == 7);
+        CHECK(storage.at(3).firstFrame() == 5);
+    }
+}
+
+TEST_CASE("PersonStorage drops the oldest undo steps beyond its memory limit", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"undo memory Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    for(int person = 0; person < 4; ++person)
+    {
+        storage.addPerson({0, 0, {{100. * person, 0}}});
+        for(int frame = 1; frame <= 10; ++frame)
+        {
+            storage.insertFeaturePoint(person, frame, TrackPoint{{100. * person, 1. * frame}}, person, false, -1, 0);
+        }
+    }
+    REQUIRE(storage.undoMemoryUsage() == 0);
+
+    // the step of an action is stored, when the next action starts
+    storage.delPointOf(3, PersonStorage::TrajectorySegment::Whole, -1);
+    storage.delPointOf(2, PersonStorage::TrajectorySegment::Whole, -1);
+    const std::size_t oneStep = storage.undoMemoryUsage();
+    CHECK(oneStep > 0);
+    storage.delPointOf(1, PersonStorage::TrajectorySegment::Whole, -1);
+    storage.undo();
+    REQUIRE(storage.nbPersons() == 2);
+    CHECK(storage.undoMemoryUsage() > oneStep); // two undo and one redo step
+
+    // the last step is always kept
+    storage.setUndoMemoryLimit(1);
+    CHECK(storage.getUndoMemoryLimit() == 1);
+    CHECK(storage.undoMemoryUsage() < 2 * oneStep);
+
+    storage.undo();
+    CHECK(storage.nbPersons() == 3);
+    storage.undo();
+    CHECK(storage.nbPersons() == 3);
+
+    storage.redo();
+    CHECK(storage.nbPersons() == 2);
+}
+
+TEST_CASE("PersonStorage spills the trajectories far from the tracked frame", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"spill Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    // person 0 in frames 0-10, person 1 in frames 500-510
+    for(int person = 0; person < 2; ++person)
+    {
+        storage.addPerson({0, 500 * person, {{100. * person, 0}}});
+        for(int frame = 1; frame <= 10; ++frame)
+        {
+            storage.insertFeaturePoint(
+                person, 500 * person + frame, TrackPoint{{100. * person, 1. * frame}}, person, false, -1, 0);
+        }
+    }
+
+    storage.spillFinished(505);
+    CHECK(storage.spilledBytes() == 0);
+
+    storage.setSpillDistance(100);
+    storage.spillFinished(505);
+    CHECK(storage.spilledBytes() > 0);
+    CHECK(storage.at(0).columns().isMapped());
+    CHECK_FALSE(storage.at(1).columns().isMapped());
+    CHECK(storage.at(0).trackPointAt(7).y() == Approx(7));
+    CHECK(storage.activePersons(5) == std::vector<size_t>{0});
+
+    storage.moveTrackPoint(0, 7, {5, 5});
+    CHECK_FALSE(storage.at(0).columns().isMapped());
+    CHECK(storage.at(0).trackPointAt(7).y() == Approx(5));
+}
+
+TEST_CASE("PersonStorage compresses the trajectories far from the tracked frame", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"compress Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    // person 0 in frames 0-10, person 1 in frames 500-510
+    for(int person = 0; person < 2; ++person)
+    {
+        storage.addPerson({0, 500 * person, {{100. * person, 0}}});
+        for(int frame = 1; frame <= 10; ++frame)
+        {
+            storage.insertFeaturePoint(
+                person, 500 * person + frame, TrackPoint{{100. * person, 1. * frame}}, person, false, -1, 0);
+        }
+    }
+
+    storage.compressFinished(505);
+    CHECK_FALSE(storage.at(0).columns().isCompressed());
+
+    storage.setCompressDistance(100);
+    storage.compressFinished(505);
+    CHECK(storage.at(0).columns().isCompressed());
+    CHECK_FALSE(storage.at(1).columns().isCompressed());
+    CHECK(storage.at(0).trackPointAt(7).y() == Approx(7));
+    CHECK(storage.at(0).columns().lastUse() > 0);
+
+    storage.moveTrackPoint(0, 7, {5, 5});
+    CHECK_FALSE(storage.at(0).columns().isCompressed());
+    CHECK(storage.at(0).trackPointAt(7).y() == Approx(5));
+}
+
+TEST_CASE("PersonStorage deletes several persons at once", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"delPersons Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    for(int person = 0; person < 6; ++person)
+    {
+        storage.addPerson({0, 0, {{100. * person, 0}}});
+    }
+
+    QSignalSpy deleted(&storage, &PersonStorage::deletedPerson);
+    storage.delPersons({4, 1, 2, 4});
+
+    REQUIRE(storage.nbPersons() == 3);
+    CHECK(storage.at(0).first().x() == Approx(0));
+    CHECK(storage.at(1).first().x() == Approx(300));
+    CHECK(storage.at(2).first().x() == Approx(500));
+    CHECK(storage.activePersons(0) == std::vector<size_t>{0, 1, 2});
+
+    // highest index first, so the receivers can remove them one after the other
+    REQUIRE(deleted.size() == 3);
+    CHECK(deleted[0][0].value<size_t>() == 4);
+    CHECK(deleted[1][0].value<size_t>() == 2);
+    CHECK(deleted[2][0].value<size_t>() == 1);
+
+    storage.undo();
+    REQUIRE(storage.nbPersons() == 6);
+    CHECK(storage.at(2).first().x() == Approx(200));
+    CHECK(storage.at(4).first().x() == Approx(400));
+}
+
+TEST_CASE("PersonStorage sets marker IDs and heights of all persons", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"bulk Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    constexpr int count = 200;
+    for(int person = 0; person < count; ++person)
+    {
+        storage.addPerson({0, 0, {{1. * person, 0}}});
+        for(int frame = 1; frame <= 20; ++frame)
+        {
+            storage.insertFeaturePoint(person, frame, TrackPoint{{1. * person, 1. * frame}}, person, false, -1, 0);
+        }
+    }
+
+    std::unordered_map<int, int>   markerIDs;
+    std::unordered_map<int, float> heights;
+    for(int person = 0; person < count; person += 2)
+    {
+        markerIDs[person + 1]  = 1000 + person;
+        heights[1000 + person] = 150.f + static_cast<float>(person % 50);
+    }
+    storage.setMarkerIDs(markerIDs);
+    storage.setMarkerHeights(heights);
+
+    for(int person = 0; person < count; ++person)
+    {
+        INFO("person " << person);
+        if(person % 2 == 0)
+        {
+            CHECK(storage.at(person).getMarkerID() == 1000 + person);
+            CHECK(storage.at(person).trackPointAt(10).getMarkerID() == 1000 + person);
+            CHECK(storage.at(person).height() == Approx(150 + person % 50));
+        }
+        else
+        {
+            CHECK(storage.at(person).getMarkerID() == -1);
+            CHECK(storage.at(person).height() == Approx(MIN_HEIGHT));
+        }
+    }
+
+    storage.resetHeight();
+    CHECK(storage.at(0).height() == Approx(MIN_HEIGHT));
+
+    storage.undo();
+    CHECK(storage.at(0).height() == Approx(150));
+}
+
+TEST_CASE("PersonStorage smooths the heights of the trajectories", "[tracking][PersonStorage]")
+{
+    Petrack        petrack{"smoothHeights Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    auto pointWithHeight = [](int frame, float z)
+    {
+        TrackPoint point{{0., 1. * frame}};
+        point.setSp(0, 0, z);
+        return point;
+    };
+
+    // frames 10-15; no height in frame 12 and an outlier in frame 13
+    const std::vector<float> heights{170, 170, -1, 300, 175, 170};
+    storage.addPerson({0, 10, pointWithHeight(10, heights[0])});
+    for(int j = 1; j < static_cast<int>(heights.size()); ++j)
+    {
+        storage.insertFeaturePoint(0, 10 + j, pointWithHeight(10 + j, heights[j]), 0, false, -1, 0);
+    }
+
+    storage.smoothHeights();
+    CHECK(storage.at(0).trackPointAt(11).sp().z() == Approx(170));
+    CHECK(storage.at(0).trackPointAt(12).sp().z() == Approx(-1));
+    CHECK(storage.at(0).trackPointAt(13).sp().z() == Approx(175));
+    CHECK(storage.at(0).trackPointAt(14).sp().z() == Approx(175));
+
+    // unchanged persons are not smoothed again, changed ones are
+    storage.smoothHeights();
+    CHECK(storage.at(0).trackPointAt(13).sp().z() == Approx(175));
+    storage.insertFeaturePoint(0, 16, pointWithHeight(16, 400), 0, false, -1, 0);
+    storage.smoothHeights();
+    CHECK(storage.at(0).trackPointAt(16).sp().z() == Approx(170));
+}
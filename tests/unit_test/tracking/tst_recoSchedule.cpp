@@ -0,0 +1,112 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "recoSchedule.h"
+
+#include <catch2/catch.hpp>
+
+namespace
+{
+/// Tracks frames first to first + count - 1 with the given outcome
+int addFrames(RecoSchedule &schedule, int first, int count, RecoSchedule::Observation observation)
+{
+    for(int frame = first; frame < first + count; ++frame)
+    {
+        observation.frame = frame;
+        schedule.addTracking(observation);
+    }
+    return first + count;
+}
+} // namespace
+
+TEST_CASE("RecoSchedule adapts the recognition step to the tracking", "[tracking][RecoSchedule]")
+{
+    RecoSchedule schedule;
+    schedule.setEnabled(true);
+    REQUIRE(schedule.isEnabled());
+
+    RecoSchedule::Observation calm;
+    calm.tracked = 10;
+
+    SECTION("Persons tracked well for a while stretch the step")
+    {
+        int frame = addFrames(schedule, 0, RecoSchedule::CALM_FRAMES - 1, calm);
+        CHECK(schedule.recoStep(3, frame) == 3);
+        frame = addFrames(schedule, frame, 1, calm);
+        CHECK(schedule.recoStep(3, frame) == 6);
+        frame = addFrames(schedule, frame, 10 * RecoSchedule::CALM_FRAMES, calm);
+        CHECK(schedule.recoStep(3, frame) == 3 << RecoSchedule::MAX_STRETCH);
+        CHECK(schedule.recoStep(1, frame) == 1 << RecoSchedule::MAX_STRETCH);
+
+        schedule.addRecognition(1);
+        CHECK(schedule.recoStep(3, frame) == 3);
+    }
+
+    SECTION("Lost or uncertain persons are recognized every frame for a while")
+    {
+        int frame = addFrames(schedule, 0, 3 * RecoSchedule::CALM_FRAMES, calm);
+
+        auto lost = calm;
+        lost.lost = 1;
+        frame     = addFrames(schedule, frame, 1, lost);
+        CHECK(schedule.recoStep(5, frame) == 1);
+        frame = addFrames(schedule, frame, RecoSchedule::URGENT_FRAMES - 1, calm);
+        CHECK(schedule.recoStep(5, frame) == 1);
+        frame = addFrames(schedule, frame, 1, calm);
+        CHECK(schedule.recoStep(5, frame) == 5);
+
+        auto uncertain      = calm;
+        uncertain.uncertain = 2;
+        frame               = addFrames(schedule, frame, 1, uncertain);
+        CHECK(schedule.recoStep(5, frame) == 1);
+    }
+
+    SECTION("Persons near the border of the ROI halve the step")
+    {
+        auto border       = calm;
+        border.nearBorder = 1;
+        int frame         = addFrames(schedule, 0, 3 * RecoSchedule::CALM_FRAMES, border);
+        CHECK(schedule.recoStep(4, frame) == 2);
+        CHECK(schedule.recoStep(1, frame) == 1);
+    }
+
+    SECTION("Without tracked persons the step of the project is kept")
+    {
+        int frame = addFrames(schedule, 0, 3 * RecoSchedule::CALM_FRAMES, RecoSchedule::Observation());
+        CHECK(schedule.recoStep(4, frame) == 4);
+    }
+
+    SECTION("Observations are only used for the neighbouring frames")
+    {
+        int frame = addFrames(schedule, 100, 3 * RecoSchedule::CALM_FRAMES, calm);
+        CHECK(schedule.recoStep(2, frame) == 2 << RecoSchedule::MAX_STRETCH);
+        CHECK(schedule.recoStep(2, frame - 2) == 2 << RecoSchedule::MAX_STRETCH);
+        CHECK(schedule.recoStep(2, frame + 5) == 2);
+
+        addFrames(schedule, frame + 5, 1, calm);
+        CHECK(schedule.recoStep(2, frame + 6) == 2);
+    }
+
+    SECTION("Disabled, the step of the project is used")
+    {
+        int frame = addFrames(schedule, 0, 3 * RecoSchedule::CALM_FRAMES, calm);
+        schedule.setEnabled(false);
+        frame = addFrames(schedule, frame, 3 * RecoSchedule::CALM_FRAMES, calm);
+        CHECK(schedule.recoStep(2, frame) == 2);
+    }
+}
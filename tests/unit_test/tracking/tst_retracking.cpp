@@ -0,0 +1,55 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "personStorage.h"
+#include "petrack.h"
+#include "retracking.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Retracking processes the patch around the selected persons", "[tracking][Retracking]")
+{
+    Petrack        petrack{"Retracking Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+
+    storage.addPerson({0, 10, {{100, 50}}});
+    storage.addPerson({0, 10, {{200, 80}}});
+    storage.addPerson({0, 20, {{400, 400}}});
+
+    SECTION("The patch encloses the persons in the frame with the margin")
+    {
+        const cv::Rect patch = Retracking::patch(storage, {0, 1}, 10, 20, 5);
+        CHECK(patch == cv::Rect(85, 35, 141, 71));
+
+        CHECK(Retracking::patch(storage, {0}, 10, 20, 0) == cv::Rect(80, 30, 41, 41));
+    }
+
+    SECTION("Persons without a point in the frame are left out")
+    {
+        CHECK(Retracking::patch(storage, {0, 2}, 10, 20, 0) == cv::Rect(80, 30, 41, 41));
+        CHECK(Retracking::patch(storage, {2}, 10, 20, 0).empty());
+        CHECK(Retracking::patch(storage, {7}, 10, 20, 0).empty());
+    }
+
+    SECTION("Without persons nothing is tracked")
+    {
+        Retracking retracking(petrack);
+        retracking.setFrameRange(10, 20);
+        CHECK_FALSE(retracking.run());
+    }
+}
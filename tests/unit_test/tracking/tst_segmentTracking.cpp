@@ -0,0 +1,78 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "segmentTracking.h"
+
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+TEST_CASE("SegmentTracking splits the frames into overlapping segments", "[tracking][SegmentTracking]")
+{
+    SECTION("Segments of equal length")
+    {
+        const auto segments = SegmentTracking::split(0, 99, 4, 10);
+        REQUIRE(segments.size() == 4);
+        CHECK(segments[0].firstFrame == 0);
+        CHECK(segments[0].lastFrame == 34);
+        CHECK(segments[1].firstFrame == 25);
+        CHECK(segments[1].lastFrame == 59);
+        CHECK(segments[2].firstFrame == 50);
+        CHECK(segments[2].lastFrame == 84);
+        CHECK(segments[3].firstFrame == 75);
+        CHECK(segments[3].lastFrame == 99);
+    }
+
+    SECTION("The last segment ends at the last frame")
+    {
+        const auto segments = SegmentTracking::split(10, 20, 3, 100);
+        REQUIRE(segments.size() == 3);
+        CHECK(segments[0].firstFrame == 10);
+        CHECK(segments[1].firstFrame == 13);
+        CHECK(segments[2].firstFrame == 17);
+        for(const auto &segment : segments)
+        {
+            CHECK(segment.lastFrame == 20);
+        }
+    }
+
+    SECTION("Not more segments than frames")
+    {
+        const auto segments = SegmentTracking::split(0, 1, 8, 0);
+        REQUIRE(segments.size() == 2);
+        CHECK(segments[0].firstFrame == 0);
+        CHECK(segments[0].lastFrame == 0);
+        CHECK(segments[1].firstFrame == 1);
+        CHECK(segments[1].lastFrame == 1);
+    }
+}
+
+TEST_CASE("SegmentTracking stores the frame range of partial results", "[tracking][SegmentTracking]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString trcFile = dir.filePath("part1.trc");
+
+    CHECK(SegmentTracking::segmentInfoFile(trcFile) == dir.filePath("part1.segment.json"));
+    CHECK_FALSE(SegmentTracking::readSegmentInfo(trcFile).has_value());
+
+    REQUIRE(SegmentTracking::writeSegmentInfo(trcFile, {100, 250}));
+    const auto segment = SegmentTracking::readSegmentInfo(trcFile);
+    REQUIRE(segment.has_value());
+    CHECK(segment->firstFrame == 100);
+    CHECK(segment->lastFrame == 250);
+}
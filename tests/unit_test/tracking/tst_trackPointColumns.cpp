@@ -0,0 +1,212 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackPointColumns.h"
+#include "tracker.h"
+
+#include <catch2/catch.hpp>
+#include <limits>
+
+TEST_CASE("TrackPointColumns stores TrackPoints column-wise", "[tracking][TrackPointColumns]")
+{
+    TrackPointColumns columns;
+    for(int i = 0; i < 5; ++i)
+    {
+        columns.append(TrackPoint({1. * i, 2. * i}, 10 * i));
+    }
+    REQUIRE(columns.size() == 5);
+    CHECK(columns.at(3).x() == Approx(3));
+    CHECK(columns.at(3).y() == Approx(6));
+    CHECK(columns.at(3).qual() == 30);
+    CHECK(columns.at(3).getMarkerID() == -1);
+    CHECK(columns.at(3).sp() == Vec3F(-1., -1., -1.));
+    CHECK_FALSE(columns.at(3).color().isValid());
+
+    SECTION("Rarely used attributes are kept for single points")
+    {
+        TrackPoint point({7., 8.}, 100, Vec2F(9., 10.), QColor(255, 0, 0));
+        point.setSp(1., 2., 3.);
+        point.setMarkerID(42);
+        point.setOrientation({0., 1., 0.});
+        columns.replace(2, point);
+
+        const TrackPoint stored = columns.at(2);
+        CHECK(stored.x() == Approx(7));
+        CHECK(stored.colPoint() == Vec2F(9., 10.));
+        CHECK(stored.color() == QColor(255, 0, 0));
+        CHECK(stored.sp() == Vec3F(1., 2., 3.));
+        CHECK(stored.getMarkerID() == 42);
+        CHECK(stored.getOrientation() == cv::Vec3d(0., 1., 0.));
+
+        CHECK(columns.at(1).getMarkerID() == -1);
+        CHECK(columns.at(1).sp() == Vec3F(-1., -1., -1.));
+        CHECK_FALSE(columns.at(1).color().isValid());
+    }
+
+    SECTION("Points can be prepended and removed")
+    {
+        for(int i = 1; i <= 40; ++i)
+        {
+            columns.prepend(TrackPoint({-1. * i, 0.}, 0, i));
+        }
+        REQUIRE(columns.size() == 45);
+        CHECK(columns.first().x() == Approx(-40));
+        CHECK(columns.first().getMarkerID() == 40);
+        CHECK(columns.at(40).x() == Approx(0));
+        CHECK(columns.at(40).getMarkerID() == -1);
+        CHECK(columns.last().x() == Approx(4));
+
+        columns.remove(0, 40);
+        REQUIRE(columns.size() == 5);
+        CHECK(columns.first().x() == Approx(0));
+        CHECK(columns.xData()[4] == Approx(4));
+
+        int i = 0;
+        for(auto it = columns.cbegin(); it != columns.cend(); ++it, ++i)
+        {
+            CHECK((*it).y() == Approx(2 * i));
+        }
+        CHECK(i == 5);
+    }
+}
+
+TEST_CASE("TrackPointColumns copies share the points until modified", "[tracking][TrackPointColumns]")
+{
+    TrackPointColumns columns;
+    for(int i = 0; i < 5; ++i)
+    {
+        columns.append(TrackPoint({1. * i, 2. * i}, 10 * i));
+    }
+    const TrackPointColumns snapshot = columns;
+    CHECK(snapshot.xData() == columns.xData());
+
+    SECTION("Modifying the original keeps the snapshot")
+    {
+        columns.setQual(1, 100);
+        columns.append(TrackPoint({5., 10.}, 50));
+        columns.prepend(TrackPoint({-1., -2.}, 0));
+
+        REQUIRE(snapshot.size() == 5);
+        CHECK(snapshot.qual(1) == 10);
+        CHECK(snapshot.first().x() == Approx(0));
+        CHECK(columns.size() == 7);
+        CHECK(columns.qual(2) == 100);
+    }
+
+    SECTION("Only modified columns are copied")
+    {
+        columns.setQual(1, 100);
+        CHECK(snapshot.xData() == columns.xData());
+        CHECK(snapshot.qual(1) == 10);
+
+        TrackPoint moved = columns.at(3);
+        moved.setX(42.);
+        columns.replace(3, moved);
+        CHECK(snapshot.xData() != columns.xData());
+        CHECK(snapshot.x(3) == Approx(3));
+        CHECK(columns.x(3) == Approx(42));
+    }
+}
+
+TEST_CASE("TrackPointColumns are split and joined without copying each point", "[tracking][TrackPointColumns]")
+{
+    TrackPointColumns columns;
+    for(int i = 0; i < 10; ++i)
+    {
+        columns.append(TrackPoint({1. * i, 2. * i}, 10 * i));
+    }
+
+    SECTION("Slices share the points")
+    {
+        const TrackPointColumns head = columns.slice(0, 4);
+        const TrackPointColumns tail = columns.slice(4, 10);
+        REQUIRE(head.size() == 4);
+        REQUIRE(tail.size() == 6);
+        CHECK(head.xData() == columns.xData());
+        CHECK(tail.xData() == columns.xData() + 4);
+        CHECK(tail.first().x() == Approx(4));
+        CHECK(tail.qual(5) == 90);
+
+        // appending to a slice does not overwrite the points behind it
+        TrackPointColumns extended = head;
+        extended.append(TrackPoint({-1., -1.}, 0));
+        CHECK(extended.size() == 5);
+        CHECK(extended.x(4) == Approx(-1));
+        CHECK(columns.x(4) == Approx(4));
+        CHECK(tail.x(0) == Approx(4));
+    }
+
+    SECTION("Removing points at the ends keeps the shared points")
+    {
+        const TrackPointColumns snapshot = columns;
+        columns.remove(7, 10);
+        columns.remove(0, 2);
+        REQUIRE(columns.size() == 5);
+        CHECK(columns.xData() == snapshot.xData() + 2);
+        CHECK(columns.last().x() == Approx(6));
+        CHECK(snapshot.size() == 10);
+
+        columns.append(TrackPoint({42., 0.}, 0));
+        CHECK(columns.x(5) == Approx(42));
+        CHECK(snapshot.x(7) == Approx(7));
+    }
+
+    SECTION("Points are appended and prepended at once")
+    {
+        TrackPointColumns other;
+        TrackPoint        marked({100., 0.}, 100);
+        marked.setMarkerID(7);
+        other.append(marked);
+        other.append(TrackPoint({101., 0.}, 100));
+
+        TrackPointColumns appended = columns;
+        appended.append(other);
+        REQUIRE(appended.size() == 12);
+        CHECK(appended.x(10) == Approx(100));
+        CHECK(appended.markerID(10) == 7);
+        CHECK(appended.markerID(11) == -1);
+        CHECK(appended.markerID(0) == -1);
+
+        TrackPointColumns prepended = columns;
+        prepended.prepend(other);
+        REQUIRE(prepended.size() == 12);
+        CHECK(prepended.x(0) == Approx(100));
+        CHECK(prepended.markerID(0) == 7);
+        CHECK(prepended.x(2) == Approx(0));
+        CHECK(prepended.markerID(11) == -1);
+
+        other.prepend(columns);
+        CHECK(other.size() == 12);
+        CHECK(other.markerID(10) == 7);
+        CHECK(other.markerID(0) == -1);
+    }
+}
+
+TEST_CASE("TrackPointColumns stores compact values", "[tracking][TrackPointColumns]")
+{
+    TrackPointColumns columns;
+    columns.append(TrackPoint({1234.5678, 0.1}, 100000));
+    columns.append(TrackPoint({0., 0.}, 50, Vec2F(1., 1.), QColor(10, 20, 30)));
+    columns.setColor(0, QColor());
+
+    CHECK(columns.x(0) == Approx(1234.5678).epsilon(1e-6));
+    CHECK(columns.y(0) == Approx(0.1).epsilon(1e-6));
+    CHECK(columns.qual(0) == std::numeric_limits<std::int16_t>::max());
+    CHECK_FALSE(columns.color(0).isValid());
+    CHECK(columns.color(1) == QColor(10, 20, 30));
+}
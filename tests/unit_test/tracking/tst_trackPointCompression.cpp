@@ -0,0 +1,117 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackPointColumns.h"
+#include "trackPointCompression.h"
+#include "tracker.h"
+
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+TEST_CASE("trackPointCompression restores the positions bit by bit", "[tracking][trackPointCompression]")
+{
+    std::vector<float> positions;
+    for(int i = 0; i < 1000; ++i)
+    {
+        positions.push_back(800.f + 0.37f * i + 0.01f * std::sin(0.1f * i));
+    }
+    positions[10] = std::numeric_limits<float>::quiet_NaN();
+    positions[11] = -0.f;
+    positions[12] = 1e20f;
+    positions[13] = -std::numeric_limits<float>::infinity();
+
+    const auto bytes = trackPointCompression::encode(positions.data(), static_cast<int>(positions.size()));
+    CHECK(bytes.size() < positions.size() * sizeof(float));
+
+    const auto decoded = trackPointCompression::decode<float>(bytes, static_cast<int>(positions.size()));
+    REQUIRE(decoded.size() == positions.size());
+    CHECK(std::memcmp(decoded.data(), positions.data(), positions.size() * sizeof(float)) == 0);
+}
+
+TEST_CASE("trackPointCompression stores runs of equal values", "[tracking][trackPointCompression]")
+{
+    std::vector<std::int16_t> qualities(1000, 90);
+    std::fill(qualities.begin() + 200, qualities.begin() + 300, 100);
+
+    const auto bytes = trackPointCompression::encode(qualities.data(), static_cast<int>(qualities.size()));
+    CHECK(bytes.size() <= 3 * (2 + sizeof(std::int16_t)));
+    CHECK(trackPointCompression::decode<std::int16_t>(bytes, static_cast<int>(qualities.size())) == qualities);
+}
+
+TEST_CASE("TrackPointColumns are decoded on access after compressing", "[tracking][TrackPointColumns]")
+{
+    TrackPointColumns columns;
+    for(int i = 0; i < 500; ++i)
+    {
+        columns.append(TrackPoint({100. + 0.5 * i, 200. - 0.25 * i}, 100));
+    }
+    TrackPoint special({7., 8.}, 50, Vec2F(9., 10.), QColor(255, 0, 0));
+    special.setMarkerID(42);
+    columns.replace(250, special);
+    const std::size_t uncompressed = columns.memoryUsage();
+
+    columns.compress();
+    REQUIRE(columns.isCompressed());
+    CHECK(columns.lastUse() == 0);
+    CHECK(columns.memoryUsage() < uncompressed / 2);
+    CHECK(columns.size() == 500);
+
+    CHECK(columns.at(10).x() == Approx(105));
+    CHECK(columns.at(10).y() == Approx(197.5));
+    CHECK(columns.at(10).qual() == 100);
+    CHECK(columns.at(250).colPoint() == Vec2F(9., 10.));
+    CHECK(columns.at(250).color() == QColor(255, 0, 0));
+    CHECK(columns.at(250).getMarkerID() == 42);
+    CHECK(columns.at(251).getMarkerID() == -1);
+    CHECK(columns.lastUse() > 0);
+
+    SECTION("Releasing frees the decoded values, which are decoded again on the next access")
+    {
+        const std::uint64_t lastUse = columns.lastUse();
+        columns.releaseDecoded();
+        CHECK(columns.lastUse() == 0);
+        CHECK(columns.xData()[499] == Approx(349.5));
+        CHECK(columns.lastUse() > lastUse);
+    }
+
+    SECTION("Editing copies the points back into memory, copies stay compressed")
+    {
+        const TrackPointColumns copy = columns;
+        columns.replace(10, TrackPoint({-5., -6.}, 1));
+        columns.append(TrackPoint({1., 2.}, 2));
+
+        CHECK_FALSE(columns.isCompressed());
+        CHECK(columns.size() == 501);
+        CHECK(columns.at(10).x() == Approx(-5));
+        CHECK(columns.at(11).x() == Approx(105.5));
+        CHECK(columns.at(500).y() == Approx(2));
+
+        CHECK(copy.isCompressed());
+        CHECK(copy.at(10).x() == Approx(105));
+    }
+
+    SECTION("Slices of compressed points hold their own values")
+    {
+        const TrackPointColumns part = columns.slice(100, 200);
+        CHECK(part.size() == 100);
+        CHECK(part.at(0).x() == Approx(150));
+        CHECK(columns.isCompressed());
+    }
+}
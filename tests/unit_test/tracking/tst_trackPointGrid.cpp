@@ -0,0 +1,63 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackPointGrid.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("TrackPointGrid finds the persons near a point", "[tracking][TrackPointGrid]")
+{
+    TrackPointGrid grid(20.);
+    grid.set(0, {10., 10.}, 20.);
+    grid.set(1, {35., 10.}, 20.);
+    grid.set(2, {-15., -5.}, 30.);
+    grid.set(3, {200., 200.}, 20.);
+
+    CHECK(grid.maxHeadSize() == Approx(30.));
+
+    SECTION("Only points inside the radius are returned in ascending order")
+    {
+        CHECK(grid.query({12., 10.}, 31.) == std::vector<size_t>{0, 1, 2});
+        CHECK(grid.query({12., 10.}, 5.) == std::vector<size_t>{0});
+        CHECK(grid.query({100., 100.}, 10.).empty());
+    }
+
+    SECTION("Points in neighbouring cells are found")
+    {
+        CHECK(grid.query({0., 0.}, 15.) == std::vector<size_t>{0});
+        CHECK(grid.query({-1., -1.}, 15.) == std::vector<size_t>{2});
+    }
+
+    SECTION("Moving and removing points")
+    {
+        grid.set(0, {195., 200.}, 20.);
+        CHECK(grid.query({12., 10.}, 5.).empty());
+        CHECK(grid.query({200., 200.}, 10.) == std::vector<size_t>{0, 3});
+
+        grid.remove(3);
+        grid.remove(3);
+        CHECK(grid.query({200., 200.}, 10.) == std::vector<size_t>{0});
+    }
+
+    SECTION("Clear")
+    {
+        grid.clear();
+        CHECK(grid.query({12., 10.}, 100.).empty());
+        CHECK(grid.maxHeadSize() == Approx(0.));
+    }
+}
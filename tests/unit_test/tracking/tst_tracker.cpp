@@ -167,4 +167,122 @@ TEST_CASE("TrackPerson insertion, [TrackPerson]")
             }
         }
     }
-}
\ No newline at end of file
+}
+TEST_CASE("TrackPerson inserts the points of another trajectory", "[TrackPerson]")
+{
+    const auto makePerson = [](int first, int last, double y, int qual)
+    {
+        TrackPerson person(1, first, TrackPoint({1. * first, y}, qual));
+        for(int frame = first + 1; frame <= last; ++frame)
+        {
+            person.append(TrackPoint({1. * frame, y}, qual));
+        }
+        return person;
+    };
+    // inserting point by point gives the reference result
+    const auto insertSingly = [](TrackPerson person, const TrackPerson &other)
+    {
+        if(other.firstFrame() < person.firstFrame())
+        {
+            for(int k = other.size() - 1; k >= 0; --k)
+            {
+                person.insertAtFrame(other.firstFrame() + k, other.at(k), 1, false);
+            }
+        }
+        else
+        {
+            for(int k = 0; k < other.size(); ++k)
+            {
+                person.insertAtFrame(other.firstFrame() + k, other.at(k), 1, false);
+            }
+        }
+        return person;
+    };
+    const auto checkEqual = [](const TrackPerson &actual, const TrackPerson &expected)
+    {
+        REQUIRE(actual.firstFrame() == expected.firstFrame());
+        REQUIRE(actual.lastFrame() == expected.lastFrame());
+        for(int frame = actual.firstFrame(); frame <= actual.lastFrame(); ++frame)
+        {
+            CHECK(actual.trackPointAt(frame) == expected.trackPointAt(frame));
+            CHECK(actual.trackPointAt(frame).qual() == expected.trackPointAt(frame).qual());
+        }
+    };
+
+    const TrackPerson person = makePerson(100, 200, 0., 50);
+
+    SECTION("Overlapping at the end")
+    {
+        const TrackPerson other  = makePerson(180, 300, 5., 80);
+        TrackPerson       merged = person;
+        merged.insertPointsOf(other, 1, false);
+        checkEqual(merged, insertSingly(person, other));
+        CHECK(merged.trackPointAt(190).y() == Approx(5.));
+        CHECK(merged.trackPointAt(300).y() == Approx(5.));
+    }
+
+    SECTION("With a gap in front")
+    {
+        const TrackPerson other  = makePerson(0, 89, 5., 80);
+        TrackPerson       merged = person;
+        merged.insertPointsOf(other, 1, false);
+        checkEqual(merged, insertSingly(person, other));
+        CHECK(merged.firstFrame() == 0);
+    }
+
+    SECTION("Adjacent at the end")
+    {
+        const TrackPerson other  = makePerson(201, 250, 5., 80);
+        TrackPerson       merged = person;
+        merged.insertPointsOf(other, 1, false);
+        checkEqual(merged, insertSingly(person, other));
+    }
+
+    SECTION("Enclosed")
+    {
+        const TrackPerson other  = makePerson(120, 150, 5., 80);
+        TrackPerson       merged = person;
+        merged.insertPointsOf(other, 1, false);
+        checkEqual(merged, insertSingly(person, other));
+
+        TrackPerson enclosed = other;
+        CHECK_THROWS(enclosed.insertPointsOf(person, 1, false));
+    }
+}
+
+TEST_CASE("TrackPerson predicts positions with constant velocity", "[TrackPerson]")
+{
+    TrackPerson person(1, 10, TrackPoint({0., 0.}));
+
+    SECTION("No prediction without known motion")
+    {
+        CHECK_FALSE(person.predictPosition(10, 11).has_value());
+        CHECK_FALSE(person.predictPosition(10, 9).has_value());
+    }
+
+    person.append(TrackPoint({2., 0.}));
+    person.append(TrackPoint({4., 1.}));
+
+    SECTION("Forward")
+    {
+        const auto prediction = person.predictPosition(12, 13);
+        REQUIRE(prediction.has_value());
+        CHECK(prediction->position.x() == Approx(6));
+        CHECK(prediction->position.y() == Approx(2));
+        CHECK(prediction->uncertainty == Approx(1));
+
+        const auto skipped = person.predictPosition(12, 14);
+        REQUIRE(skipped.has_value());
+        CHECK(skipped->position.x() == Approx(8));
+        CHECK(skipped->uncertainty == Approx(4));
+    }
+
+    SECTION("Backward")
+    {
+        const auto prediction = person.predictPosition(10, 9);
+        REQUIRE(prediction.has_value());
+        CHECK(prediction->position.x() == Approx(-2));
+        CHECK(prediction->position.y() == Approx(0));
+        CHECK(prediction->uncertainty == Approx(1));
+    }
+}
@@ -0,0 +1,99 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackingCheckpoint.h"
+
+#include "personStorage.h"
+#include "petrack.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+
+TEST_CASE("TrackingCheckpoint restores the trajectories and the position of the run", "[tracking][TrackingCheckpoint]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString trcFile = dir.filePath("trajectories.trc");
+
+    Petrack        petrack{"TrackingCheckpoint Test"};
+    PersonStorage &storage = petrack.getPersonStorage();
+    storage.addPerson({0, 10, {{1, 2}}});
+    storage.addPerson({0, 12, {{5, 6}}});
+
+    TrackingCheckpoint checkpoint(trcFile, storage);
+    REQUIRE(checkpoint.write({TrackingCheckpoint::Phase::Forward, 12, 10, false, 2, 100}, storage.getPersons()));
+
+    // only the changes are appended to the journal
+    storage.insertFeaturePoint(1, 13, TrackPoint{{7, 8}}, 1, false, -1, 0);
+    storage.delPersons({0});
+    storage.addPerson({0, 13, {{9, 9}}});
+    REQUIRE(checkpoint.write({TrackingCheckpoint::Phase::Backward, 13, 10, true, 3, 100}, storage.getPersons()));
+    CHECK(QFile::exists(trcFile + ".checkpoint.1.journal"));
+
+    std::vector<TrackPerson>                 persons;
+    TrackingCheckpoint                       restored(trcFile, storage);
+    std::optional<TrackingCheckpoint::State> state;
+
+    SECTION("The last checkpoint is read")
+    {
+        state = restored.read(persons);
+        REQUIRE(state);
+        CHECK(state->phase == TrackingCheckpoint::Phase::Backward);
+        CHECK(state->frame == 13);
+        CHECK(state->startFrame == 10);
+        CHECK(state->recognize);
+        CHECK(state->processed == 3);
+        CHECK(state->total == 100);
+
+        REQUIRE(persons.size() == 2);
+        CHECK(persons[0].firstFrame() == 12);
+        CHECK(persons[0].lastFrame() == 13);
+        CHECK(persons[0].trackPointAt(13).x() == 7);
+        CHECK(persons[1].firstFrame() == 13);
+        CHECK(persons[1].trackPointAt(13).y() == 9);
+    }
+
+    SECTION("A journal entry written after the last checkpoint is ignored")
+    {
+        QFile journal(trcFile + ".checkpoint.1.journal");
+        REQUIRE(journal.open(QIODevice::WriteOnly | QIODevice::Append));
+        journal.write("entry 5 0 0 0\n\nend\n");
+        journal.close();
+
+        state = restored.read(persons);
+        REQUIRE(state);
+        CHECK(persons.size() == 2);
+    }
+
+    SECTION("Removing the checkpoint removes all files")
+    {
+        checkpoint.remove();
+        CHECK_FALSE(restored.read(persons));
+        CHECK(QDir(dir.path()).isEmpty());
+    }
+
+    SECTION("A run after resuming starts a new generation")
+    {
+        REQUIRE(restored.read(persons));
+        REQUIRE(restored.write({TrackingCheckpoint::Phase::Backward, 12, 10, true, 4, 100}, persons));
+        CHECK(QFile::exists(trcFile + ".checkpoint.2.trc"));
+        CHECK_FALSE(QFile::exists(trcFile + ".checkpoint.1.trc"));
+        CHECK_FALSE(QFile::exists(trcFile + ".checkpoint.1.journal"));
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectoryGeometry.h"
+
+#include <catch2/catch.hpp>
+#include <cmath>
+
+TEST_CASE("geometry::distances", "[tracking][geometry]")
+{
+    const std::vector<float> x{0.F, 3.F, 3.F, 10.F};
+    const std::vector<float> y{0.F, 4.F, 4.F, 4.F};
+    const int                count = static_cast<int>(x.size());
+
+    CHECK(geometry::distances(x.data(), y.data(), count, Vec2F(3, 0)) == std::vector<float>{3.F, 4.F, 4.F, 8.F});
+
+    const std::vector<float> otherX{3.F, 3.F, 0.F, 10.F};
+    const std::vector<float> otherY{4.F, 4.F, 0.F, 0.F};
+    CHECK(
+        geometry::distances(x.data(), y.data(), otherX.data(), otherY.data(), count) ==
+        std::vector<float>{5.F, 0.F, 5.F, 4.F});
+
+    CHECK(geometry::distances(nullptr, nullptr, 0, Vec2F(0, 0)).empty());
+}
+
+TEST_CASE("geometry::nearest", "[tracking][geometry]")
+{
+    const std::vector<float> x{0.F, 3.F, 9.F, 3.F};
+    const std::vector<float> y{0.F, 4.F, 9.F, 4.F};
+    const int                count = static_cast<int>(x.size());
+
+    double distance = 0;
+    CHECK(geometry::nearest(x.data(), y.data(), count, Vec2F(4, 4), &distance) == 1);
+    CHECK(distance == Approx(1));
+    CHECK(geometry::nearest(x.data(), y.data(), count, Vec2F(10, 10)) == 2);
+    // a part of a column, e.g. some frames of a trajectory
+    CHECK(geometry::nearest(x.data() + 2, y.data() + 2, 2, Vec2F(0, 0), &distance) == 1);
+    CHECK(distance == Approx(5));
+    CHECK(geometry::nearest(x.data(), y.data(), 0, Vec2F(0, 0)) == -1);
+}
+
+TEST_CASE("geometry::interpolate", "[tracking][geometry]")
+{
+    std::vector<float> x(4);
+    std::vector<float> y(4);
+    geometry::interpolate(Vec2F(0, 10), Vec2F(4, 2), 4, x.data(), y.data());
+    CHECK(x == std::vector<float>{1.F, 2.F, 3.F, 4.F});
+    CHECK(y == std::vector<float>{8.F, 6.F, 4.F, 2.F});
+
+    // the last point is exactly the target, even if the steps are not representable
+    geometry::interpolate(Vec2F(0, 0), Vec2F(1, 0.1), 3, x.data(), y.data());
+    CHECK(x[0] == Approx(1. / 3));
+    CHECK(x[2] == 1.F);
+    CHECK(y[2] == 0.1F);
+}
@@ -0,0 +1,85 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectorySimplification.h"
+
+#include <catch2/catch.hpp>
+#include <cmath>
+
+TEST_CASE("simplification::douglasPeucker", "[tracking][simplification]")
+{
+    // straight walk with a small wobble, a corner at index 5 and a turn back at index 8
+    const std::vector<float> x{0.F, 1.F, 2.F, 3.F, 4.F, 5.F, 5.F, 5.F, 5.F, 5.F};
+    const std::vector<float> y{0.F, 0.1F, -0.1F, 0.F, 0.1F, 0.F, 1.F, 2.F, 3.F, 1.F};
+    const int                count = static_cast<int>(x.size());
+
+    CHECK(simplification::douglasPeucker(x.data(), y.data(), count, 0.5) == std::vector<int>{0, 5, 8, 9});
+    // points exactly on a segment are omitted even with a tiny tolerance
+    CHECK(simplification::douglasPeucker(x.data(), y.data(), count, 0.01) == std::vector<int>{0, 1, 2, 4, 5, 8, 9});
+
+    SECTION("Short trajectories are kept")
+    {
+        CHECK(simplification::douglasPeucker(x.data(), y.data(), 1, 0.5) == std::vector<int>{0});
+        CHECK(simplification::douglasPeucker(x.data(), y.data(), 2, 10.) == std::vector<int>{0, 1});
+        CHECK(simplification::douglasPeucker(nullptr, nullptr, 0, 0.5).empty());
+    }
+
+    SECTION("A standing person is one segment")
+    {
+        const std::vector<float> same(100, 7.F);
+        CHECK(simplification::douglasPeucker(same.data(), same.data(), 100, 0.5) == std::vector<int>{0, 99});
+    }
+}
+
+TEST_CASE("simplification::simplifyWindow", "[tracking][simplification]")
+{
+    // zigzag with a long straight piece in the middle
+    std::vector<float> x;
+    std::vector<float> y;
+    for(int i = 0; i < 100; ++i)
+    {
+        x.push_back(static_cast<float>(i));
+        y.push_back(i < 20 || i >= 80 ? static_cast<float>(i % 2) * 3.F : 0.F);
+    }
+    const int    count     = static_cast<int>(x.size());
+    const double tolerance = 0.5;
+    const auto   kept      = simplification::douglasPeucker(x.data(), y.data(), count, tolerance);
+
+    CHECK(simplification::simplifyWindow(x.data(), y.data(), kept, 0, count, tolerance) == kept);
+    CHECK(simplification::simplifyWindow(x.data(), y.data(), kept, 30, 30, tolerance).empty());
+    CHECK(simplification::simplifyWindow(x.data(), y.data(), kept, 30, 31, tolerance) == std::vector<int>{30});
+    CHECK(simplification::simplifyWindow(x.data(), y.data(), kept, 30, 60, tolerance) == std::vector<int>{30, 59});
+
+    // every point of the window lies within the tolerance of the simplified window
+    const int  from   = GENERATE(0, 10, 19, 20, 25);
+    const int  to     = GENERATE(60, 79, 85, 100);
+    const auto window = simplification::simplifyWindow(x.data(), y.data(), kept, from, to, tolerance);
+    REQUIRE(window.front() == from);
+    REQUIRE(window.back() == to - 1);
+    for(size_t k = 1; k < window.size(); ++k)
+    {
+        REQUIRE(window[k - 1] < window[k]);
+        for(int i = window[k - 1]; i <= window[k]; ++i)
+        {
+            // the segments are horizontal or have the points as ends
+            const bool onSegment = i == window[k - 1] || i == window[k] ||
+                                   (y[window[k - 1]] == y[window[k]] && std::abs(y[i] - y[window[k]]) <= tolerance);
+            CHECK(onSegment);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trackPointColumns.h"
+#include "tracker.h"
+#include "trajectorySpillStore.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("TrajectorySpillStore moves the points into a mapped file", "[tracking][TrajectorySpillStore]")
+{
+    TrackPointColumns first;
+    TrackPointColumns second;
+    for(int i = 0; i < 100; ++i)
+    {
+        first.append(TrackPoint({1. * i, 2. * i}, i));
+        second.append(TrackPoint({-1. * i, 0.5 * i}, 100 - i));
+    }
+    TrackPoint special({7., 8.}, 100, Vec2F(9., 10.), QColor(255, 0, 0));
+    special.setSp(1., 2., 3.);
+    special.setMarkerID(42);
+    second.replace(50, special);
+
+    TrajectorySpillStore store;
+    REQUIRE(store.spill({&first, &second}));
+    CHECK(store.bytes() >= first.size() * (2 * sizeof(float) + sizeof(std::int16_t)));
+    CHECK_FALSE(store.getFileName().isEmpty());
+
+    CHECK(first.isMapped());
+    CHECK(second.isMapped());
+    CHECK(first.memoryUsage() == 0);
+    CHECK(second.memoryUsage() == 0);
+    CHECK(first.at(30).x() == Approx(30));
+    CHECK(first.at(30).y() == Approx(60));
+    CHECK(first.at(30).qual() == 30);
+    CHECK(second.at(50).colPoint() == Vec2F(9., 10.));
+    CHECK(second.at(50).color() == QColor(255, 0, 0));
+    CHECK(second.at(50).sp() == Vec3F(1., 2., 3.));
+    CHECK(second.at(50).getMarkerID() == 42);
+    CHECK(second.at(51).getMarkerID() == -1);
+
+    SECTION("Spilling again writes nothing")
+    {
+        const auto bytes = store.bytes();
+        REQUIRE(store.spill({&first, &second}));
+        CHECK(store.bytes() == bytes);
+    }
+
+    SECTION("Editing copies the points back into memory, copies keep reading the file")
+    {
+        const TrackPointColumns copy = first;
+        first.replace(10, TrackPoint({-5., -6.}, 1));
+        first.append(TrackPoint({100., 200.}, 2));
+
+        CHECK_FALSE(first.isMapped());
+        CHECK(first.memoryUsage() > 0);
+        CHECK(first.size() == 101);
+        CHECK(first.at(10).x() == Approx(-5));
+        CHECK(first.at(11).x() == Approx(11));
+        CHECK(first.at(100).y() == Approx(200));
+
+        CHECK(copy.isMapped());
+        CHECK(copy.at(10).x() == Approx(10));
+    }
+
+    SECTION("Mapped points outlive the store")
+    {
+        store.reset();
+        CHECK(store.bytes() == 0);
+        CHECK(first.at(99).x() == Approx(99));
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trajectoryVelocity.h"
+
+#include <catch2/catch.hpp>
+#include <cmath>
+
+TEST_CASE("velocity::stepDistances and stepDifferences", "[tracking][velocity]")
+{
+    const std::vector<float> x{0.F, 3.F, 3.F, 10.F, 4.F};
+    const std::vector<float> y{0.F, 4.F, 4.F, 4.F, 12.F};
+    const std::vector<float> z{1.F, 1.F, 3.F, 3.F, 3.F};
+    const int                count = static_cast<int>(x.size());
+
+    CHECK(velocity::stepDistances(x.data(), y.data(), count) == std::vector<float>{5.F, 0.F, 7.F, 10.F});
+    const auto twoSteps = velocity::stepDistances(x.data(), y.data(), count, 2);
+    REQUIRE(twoSteps.size() == 3);
+    CHECK(twoSteps[0] == 5.F);
+    CHECK(twoSteps[1] == 7.F);
+    CHECK(twoSteps[2] == Approx(std::sqrt(65.F)));
+    CHECK(velocity::stepDistances(x.data(), y.data(), z.data(), count) == std::vector<float>{5.F, 2.F, 7.F, 10.F});
+    CHECK(velocity::stepDifferences(x.data(), count) == std::vector<float>{3.F, 0.F, 7.F, -6.F});
+    CHECK(velocity::stepDifferences(y.data(), count, 3) == std::vector<float>{4.F, 8.F});
+
+    SECTION("Trajectories not longer than step have no velocities")
+    {
+        CHECK(velocity::stepDistances(x.data(), y.data(), count, count).empty());
+        CHECK(velocity::stepDifferences(x.data(), 1).empty());
+        CHECK(velocity::stepDistances(nullptr, nullptr, 0).empty());
+    }
+}
+
+TEST_CASE("velocity::findVariations", "[tracking][velocity]")
+{
+    // distance d12 of index j compared to the mean of its neighbors
+    const std::vector<float> distances{2.F, 2.F, 10.F, 2.F, 2.F, 2.F, 5.F, 2.F, 4.F, 8.F, 4.F};
+    // 10 > 1.8 * 2 and > 6; 5 > 1.8 * 2 but neither > 6 nor mean > 3; 8 > 1.8 * 4 and mean > 3
+    CHECK(velocity::findVariations(distances) == std::vector<int>{2, 9});
+
+    // neither the first nor the last distance has both neighbors
+    CHECK(velocity::findVariations({20.F, 1.F, 1.F, 20.F}).empty());
+    CHECK(velocity::findVariations({}).empty());
+}
@@ -178,3 +178,29 @@ SCENARIO("Getting the IDs of the pedestrian from user input", "[petrack][util]")
         }
     }
 }
+
+TEST_CASE("Serializing a project", "[petrack]")
+{
+    QDomDocument doc("PETRACK");
+    QDomElement  root = doc.createElement("PETRACK");
+    root.setAttribute("VERSION", "1.0");
+    doc.appendChild(root);
+    QDomElement player = doc.createElement("PLAYER");
+    player.setAttribute("SOURCE_FRAME_IN", 3);
+    player.setAttribute("FRAME", 42);
+    root.appendChild(player);
+    QDomElement displacements = doc.createElement("DISPLACEMENTS");
+    displacements.appendChild(doc.createTextNode("AAEC"));
+    root.appendChild(displacements);
+
+    const QByteArray xml = Petrack::projectXml(doc);
+
+    // the attributes are sorted for a canonical XML
+    CHECK(xml.contains(R"(<PLAYER FRAME="42" SOURCE_FRAME_IN="3"/>)"));
+    CHECK(xml.contains("<DISPLACEMENTS>AAEC</DISPLACEMENTS>"));
+
+    QDomDocument reread;
+    REQUIRE(reread.setContent(xml));
+    CHECK(reread.documentElement().attribute("VERSION") == "1.0");
+    CHECK(reread.documentElement().firstChildElement("DISPLACEMENTS").text() == "AAEC");
+}
@@ -25,6 +25,7 @@
 
 #include <QGraphicsScene>
 #include <QSignalSpy>
+#include <QTest>
 #include <QTestEventList>
 #include <catch2/catch.hpp>
 #include <iostream>
@@ -384,3 +385,22 @@ SCENARIO("Change the show only people list", "[ui][config][tracking][path]")
         }
     }
 }
+
+TEST_CASE("Parameter edits in a row update the image once", "[ui][control]")
+{
+    Petrack pet{"Unknown"};
+    cv::Mat testImage{cv::Size(50, 50), CV_8UC3, cv::Scalar(179, 255, 200)};
+    cv::imwrite("TESTBILD_DELETE_ME.png", testImage);
+    pet.openSequence("TESTBILD_DELETE_ME.png");
+    QTest::qWait(200);
+    const long long frames = pet.getPipelineStatistics().frames;
+
+    for(int i = 0; i < 10; ++i)
+    {
+        pet.requestUpdateImage();
+    }
+    CHECK(pet.getPipelineStatistics().frames == frames);
+
+    QTest::qWait(200);
+    CHECK(pet.getPipelineStatistics().frames == frames + 1);
+}
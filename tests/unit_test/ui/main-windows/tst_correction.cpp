@@ -29,3 +29,72 @@ SCENARIO("Verify FailedChecksTableModel", "[correction]")
     FailedChecksTableModel *model = new FailedChecksTableModel(&pet);
     new QAbstractItemModelTester(model, QAbstractItemModelTester::FailureReportingMode::Fatal, &pet);
 }
+
+SCENARIO("FailedChecksTableModel removes the checks of deleted persons", "[correction]")
+{
+    Petrack pet{"Unknown"};
+
+    FailedChecksTableModel model(&pet);
+    using plausibility::CheckType;
+    model.setFailedChecks({
+        {1, 10, "Trajectory is too short!", CheckType::Length},
+        {2, 20, "Trajectory is very close to Person 4!", CheckType::Equality},
+        {3, 30, "Trajectory is very close to Person 2!", CheckType::Equality},
+        {4, 40, "Trajectory is very close to Person 5!", CheckType::Equality},
+        {5, 50, "Trajectory is too short!", CheckType::Length},
+    });
+
+    GIVEN("Some failed checks")
+    {
+        THEN("The rows concerning a person are found by the person and by the mentions")
+        {
+            CHECK(model.rowsConcerning({1}) == std::vector<int>{1, 2});
+            CHECK(model.rowsConcerning({3, 4}) == std::vector<int>{1, 3, 4});
+            CHECK(model.rowsConcerning({5}).empty());
+        }
+
+        WHEN("Persons 2 and 4 (1-based) are deleted")
+        {
+            model.removePersons({1, 3});
+
+            THEN("Their checks and the checks mentioning them are removed and the others renumbered")
+            {
+                const auto failedChecks = model.getFailedChecks();
+                REQUIRE(failedChecks.size() == 2);
+                CHECK(failedChecks[0].pers == 1);
+                CHECK(failedChecks[0].frame == 10);
+                CHECK(failedChecks[1].pers == 3);
+                CHECK(failedChecks[1].frame == 50);
+                CHECK(model.rowsConcerning({2}) == std::vector<int>{1});
+            }
+        }
+
+        WHEN("Persons mentioned in other checks are renumbered")
+        {
+            model.removePersons({0});
+
+            THEN("The messages name the new numbers")
+            {
+                const auto failedChecks = model.getFailedChecks();
+                REQUIRE(failedChecks.size() == 4);
+                CHECK(failedChecks[0].pers == 1);
+                CHECK(failedChecks[0].message == "Trajectory is very close to Person 3!");
+                CHECK(failedChecks[2].message == "Trajectory is very close to Person 4!");
+                CHECK(model.rowsConcerning({3}) == std::vector<int>{2, 3});
+            }
+        }
+
+        WHEN("The status of rows is changed")
+        {
+            model.updateStates({0, 4}, plausibility::CheckStatus::Changed);
+
+            THEN("Only these rows are changed")
+            {
+                const auto failedChecks = model.getFailedChecks();
+                CHECK(failedChecks[0].status == plausibility::CheckStatus::Changed);
+                CHECK(failedChecks[1].status == plausibility::CheckStatus::New);
+                CHECK(failedChecks[4].status == plausibility::CheckStatus::Changed);
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "petrack.h"
+#include "statisticsPanel.h"
+
+#include <QLabel>
+#include <algorithm>
+#include <catch2/catch.hpp>
+
+TEST_CASE("StatisticsPanel formats times per frame and memory", "[ui][StatisticsPanel]")
+{
+    CHECK(StatisticsPanel::formatStage(0.5, 100) == "5.0 ms");
+    CHECK(StatisticsPanel::formatStage(0.5, 0) == "-");
+
+    CHECK(StatisticsPanel::formatBytes(512) == "512 B");
+    CHECK(StatisticsPanel::formatBytes(1536) == "1.5 kB");
+    CHECK(StatisticsPanel::formatBytes(3 * 1024 * 1024) == "3.0 MB");
+    CHECK(StatisticsPanel::formatBytes(std::size_t(5) * 1024 * 1024 * 1024 * 1024) == "5120.0 GB");
+}
+
+TEST_CASE("StatisticsPanel shows the processed frames", "[ui][StatisticsPanel]")
+{
+    Petrack petrack{"Unknown"};
+    QMetaObject::invokeMethod(&petrack, "showStatisticsPanel");
+
+    auto *panel = petrack.findChild<StatisticsPanel *>();
+    REQUIRE(panel);
+    CHECK_FALSE(panel->isHidden());
+
+    petrack.getPipelineStatistics().frames += 10;
+    petrack.getPipelineStatistics().filter += 0.2;
+    QMetaObject::invokeMethod(panel, "updateStatistics");
+
+    const auto labels = panel->findChildren<QLabel *>();
+    const bool shown  = std::any_of(
+        labels.begin(), labels.end(), [](const QLabel *label) { return label->text() == "20.0 ms"; });
+    CHECK(shown);
+}
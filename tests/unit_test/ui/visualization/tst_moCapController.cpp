@@ -31,8 +31,23 @@ class ExtrCalibMock : public trompeloeil::mock_interface<ExtrCalibration>
 public:
     ExtrCalibMock(PersonStorage &storage) : trompeloeil::mock_interface<ExtrCalibration>(storage) {}
     MAKE_CONST_MOCK1(getImagePoint, cv::Point2f(cv::Point3f), override);
+    MAKE_CONST_MOCK1(getImagePoint, std::vector<cv::Point2f>(const std::vector<cv::Point3f> &), override);
 };
 
+namespace
+{
+/// projection of the mock: just the x and y coordinate
+std::vector<cv::Point2f> dropZ(const std::vector<cv::Point3f> &points)
+{
+    std::vector<cv::Point2f> projected;
+    for(const auto &point : points)
+    {
+        projected.emplace_back(point.x, point.y);
+    }
+    return projected;
+}
+} // namespace
+
 SCENARIO("I want to get the render data with one person loaded", "[ui]")
 {
     MoCapStorage storage;
@@ -70,6 +85,7 @@ SCENARIO("I want to get the render data with one person loaded", "[ui]")
      * 3D to 2D due to different settings
      */
     ALLOW_CALL(extrCalib, getImagePoint(ANY(cv::Point3f))).RETURN(cv::Point2f(_1.x, _1.y));
+    ALLOW_CALL(extrCalib, getImagePoint(ANY(std::vector<cv::Point3f>))).RETURN(dropZ(_1));
 
     MoCapController moCapController{storage, extrCalib};
 
@@ -196,3 +212,34 @@ SCENARIO("I want to get the render data with one person loaded", "[ui]")
         }
     }
 }
+
+TEST_CASE("MoCapPerson::getSampleBones matches the transformed skeleton", "[ui]")
+{
+    SkeletonNode  root{0, cv::Point3f{100, 100, 0}};
+    SkeletonNode &neck = root.addChild({19, cv::Point3f{200, 100, 69}});
+    neck.addChild({2, cv::Point3f{150, 150, 1337}});
+    root.addChild({5, cv::Point3f{80, 120, 10}});
+
+    MoCapPerson person;
+    person.addSkeleton({root, cv::Vec3f{1, 0, 0}, {150, 150, 1337}});
+    person.setRotation(30);
+    person.setTranslation({10, -20, 5});
+
+    std::vector<cv::Point3f> joints;
+    cv::Vec3f                headDir;
+    person.getSampleBones(0, joints, headDir);
+
+    const SkeletonTree sample = person.getSample(0);
+    const auto         lines  = sample.getLines();
+    REQUIRE(joints.size() == 2 * lines.size());
+    for(size_t i = 0; i < lines.size(); ++i)
+    {
+        CHECK(joints[2 * i] == lines[i].start);
+        CHECK(joints[2 * i + 1] == lines[i].end);
+    }
+    CHECK(headDir == sample.getHeadDir());
+    CHECK(person.getNeckToHeadBone() == 1);
+
+    SkeletonNode other{0, cv::Point3f{100, 100, 0}};
+    CHECK_THROWS_AS(person.addSkeleton({other, cv::Vec3f{1, 0, 0}, {0, 0, 0}}), std::invalid_argument);
+}
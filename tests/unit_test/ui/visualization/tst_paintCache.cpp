@@ -0,0 +1,65 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "paintCache.h"
+
+#include <QImage>
+#include <QPainter>
+#include <catch2/catch.hpp>
+
+namespace
+{
+QImage paintWith(PaintCache &cache, const PaintCache::Key &key, int &calls)
+{
+    QImage img(20, 20, QImage::Format_RGB32);
+    img.fill(Qt::white);
+    QPainter painter(&img);
+    cache.paint(
+        &painter,
+        key,
+        [&calls](QPainter *recorder)
+        {
+            ++calls;
+            recorder->fillRect(QRect(2, 2, 5, 5), Qt::red);
+        });
+    painter.end();
+    return img;
+}
+} // namespace
+
+TEST_CASE("PaintCache replays the painting while the key is unchanged", "[ui][PaintCache]")
+{
+    PaintCache cache;
+    int        calls = 0;
+
+    const QImage first = paintWith(cache, {1., 2.}, calls);
+    CHECK(calls == 1);
+    CHECK(first.pixelColor(3, 3) == QColor(Qt::red));
+    CHECK(first.pixelColor(10, 10) == QColor(Qt::white));
+
+    const QImage replayed = paintWith(cache, {1., 2.}, calls);
+    CHECK(calls == 1);
+    CHECK(replayed == first);
+
+    paintWith(cache, {1., 3.}, calls);
+    CHECK(calls == 2);
+
+    cache.invalidate();
+    paintWith(cache, {1., 3.}, calls);
+    CHECK(calls == 3);
+}
@@ -0,0 +1,82 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "voronoiCells.h"
+
+#include <catch2/catch.hpp>
+#include <cmath>
+
+TEST_CASE("computeVoronoiCells has a cell per person inside of the ROI", "[ui][voronoi]")
+{
+    VoronoiInput input;
+    input.positions = {{-100.F, 50.F}, {100.F, 50.F}, {0.F, 150.F}, {500.F, 50.F}};
+
+    // the ROI corners may be swapped on the ground plane, depending on the coordinate system
+    const bool swapped = GENERATE(false, true);
+    input.roiCorner1   = swapped ? cv::Point2f(200.F, 200.F) : cv::Point2f(-200.F, -100.F);
+    input.roiCorner2   = swapped ? cv::Point2f(-200.F, -100.F) : cv::Point2f(200.F, 200.F);
+
+    const auto cells = computeVoronoiCells(input);
+    // the last person is outside of the ROI
+    REQUIRE(cells.size() == 3);
+    for(size_t i = 0; i < cells.size(); ++i)
+    {
+        CHECK(cells[i].center.x == Approx(input.positions[i].x));
+        CHECK(cells[i].center.y == Approx(input.positions[i].y));
+        CHECK(cells[i].facet.size() >= 3);
+        CHECK(std::isfinite(cells[i].density));
+    }
+
+    // the cells of the two lower persons are mirrored at x = 0
+    for(const auto &corner : cells[0].facet)
+    {
+        CHECK(corner.x <= Approx(0.F).margin(1e-3));
+    }
+    for(const auto &corner : cells[1].facet)
+    {
+        CHECK(corner.x >= Approx(0.F).margin(1e-3));
+    }
+}
+
+TEST_CASE("VoronoiCache computes the cells of a frame only for a new input", "[ui][voronoi]")
+{
+    VoronoiInput input;
+    input.roiCorner1 = {0.F, 0.F};
+    input.roiCorner2 = {400.F, 400.F};
+    input.positions  = {{100.F, 100.F}, {300.F, 300.F}};
+
+    VoronoiCache cache;
+    const auto  &cells = cache.cells(3, input);
+    REQUIRE(cells.size() == 2);
+    CHECK(&cache.cells(3, input) == &cells);
+    CHECK(cache.contains(3));
+    CHECK_FALSE(cache.contains(4));
+
+    SECTION("Another input replaces the cells")
+    {
+        input.positions.push_back({200.F, 50.F});
+        CHECK(cache.cells(3, input).size() == 3);
+    }
+
+    SECTION("Cells computed in advance")
+    {
+        cache.prefetch(4, input);
+        CHECK(cache.contains(4));
+        CHECK(cache.cells(4, input).size() == 2);
+    }
+}
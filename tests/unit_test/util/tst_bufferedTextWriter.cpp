@@ -0,0 +1,95 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bufferedTextWriter.h"
+#include "petrack.h"
+#include "tracker.h"
+
+#include <QBuffer>
+#include <QTextStream>
+#include <catch2/catch.hpp>
+
+TEST_CASE("BufferedTextWriter formats numbers like QTextStream", "[util][BufferedTextWriter]")
+{
+    const std::vector<double> values{0., -0.5, 1. / 3., 123456789., 1e-5, 2.5e17, 176.25};
+
+    QByteArray expected;
+    {
+        QTextStream out(&expected);
+        for(double value : values)
+        {
+            out << value << " ";
+        }
+        out << QColor(1, 2, 3) << " " << QColor() << Qt::endl;
+    }
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    {
+        // small blocks to test writing in between
+        BufferedTextWriter writer(buffer, 8);
+        for(double value : values)
+        {
+            writer.print("{:g} ", value);
+        }
+        writer.printColor(QColor(1, 2, 3));
+        writer.print(" ");
+        writer.printColor(QColor());
+        writer.print("\n");
+        CHECK(writer.flush());
+    }
+    CHECK(buffer.data() == expected);
+}
+
+TEST_CASE("writeTrc writes the same text as operator<<", "[util][BufferedTextWriter]")
+{
+    TrackPoint first({1.5, 2.25}, 100, Vec2F(3.125, 4.), QColor(10, 20, 30));
+    first.setSp(5., 6., 1e-6);
+    first.setMarkerID(12);
+    TrackPerson person(3, 17, first);
+    person.setHeight(178.123456);
+    person.setColCount(4);
+    person.setColor(QColor(40, 50, 60));
+    person.setMarkerID(12);
+    person.setComment("first\nsecond");
+    person.append(TrackPoint({1000000.5, -0.001}, 90));
+    const std::vector<TrackPerson> persons{person, person};
+
+    const int version = GENERATE(1, 2, 3, 4);
+    Petrack::trcVersion = version;
+
+    QByteArray expected;
+    {
+        QTextStream out(&expected);
+        out << "version " << version << Qt::endl;
+        out << persons.size() << Qt::endl;
+        for(const auto &p : persons)
+        {
+            out << p << Qt::endl;
+        }
+    }
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    int lastProgress = 0;
+    CHECK(writeTrc(buffer, persons, [&lastProgress](int done, int) { lastProgress = done; }));
+    CHECK(buffer.data() == expected);
+    CHECK(lastProgress == 2);
+
+    Petrack::trcVersion = 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "concurrency.h"
+
+#include <QThreadPool>
+#include <catch2/catch.hpp>
+#include <opencv2/core.hpp>
+
+TEST_CASE("concurrency limits OpenCV, Qt and the pools to the same thread count", "[util][concurrency]")
+{
+    REQUIRE(concurrency::availableCores() >= 1);
+
+    SECTION("The command line sets the thread count of all")
+    {
+        concurrency::setThreadCount(3);
+        CHECK(concurrency::threadCount() == 3);
+        CHECK(cv::getNumThreads() == 3);
+        CHECK(QThreadPool::globalInstance()->maxThreadCount() == 3);
+        CHECK(concurrency::pool(concurrency::Pool::Recognition).maxThreadCount() == 3);
+        CHECK(concurrency::pool(concurrency::Pool::Stages).maxThreadCount() == 3);
+
+        // the command line takes precedence over the project
+        concurrency::setProjectThreadCount(5);
+        CHECK(concurrency::threadCount() == 3);
+    }
+
+    SECTION("Without a count on the command line, the project sets it")
+    {
+        concurrency::setThreadCount(0);
+        CHECK(concurrency::threadCount() == concurrency::availableCores());
+        concurrency::setProjectThreadCount(5);
+        CHECK(concurrency::threadCount() == 5);
+        CHECK(concurrency::pool(concurrency::Pool::Tiles).maxThreadCount() == 5);
+    }
+
+    concurrency::setThreadCount(0);
+}
@@ -264,4 +264,42 @@ TEST_CASE("Test split compact string", "[helper][grouping]")
 
     input = "1 - 3, 4,";
     CHECK_THROWS_AS(splitCompactString(input), std::invalid_argument);
-}
\ No newline at end of file
+}
+TEST_CASE("shareToQImage shows a cv::Mat without copying it", "[helper]")
+{
+    cv::Mat image(20, 30, CV_8UC3);
+    cv::randu(image, 0, 256);
+    const cv::Mat original = image.clone();
+
+    QImage qImage;
+    shareToQImage(qImage, image);
+    REQUIRE(qImage.format() == QImage::Format_BGR888);
+    CHECK(qImage.size() == QSize(30, 20));
+    CHECK(qImage.constBits() == image.data);
+    const cv::Vec3b pixel = original.at<cv::Vec3b>(4, 7);
+    CHECK(qImage.pixelColor(7, 4) == QColor(pixel[2], pixel[1], pixel[0]));
+
+    SECTION("The data outlives the cv::Mat")
+    {
+        image.release();
+        CHECK(qImage.pixelColor(7, 4) == QColor(pixel[2], pixel[1], pixel[0]));
+    }
+
+    SECTION("Modifying the QImage does not modify the cv::Mat")
+    {
+        qImage.setPixelColor(7, 4, Qt::white);
+        CHECK(qImage.constBits() != image.data);
+        CHECK(cv::norm(image, original, cv::NORM_INF) == 0);
+    }
+
+    SECTION("Gray images and unsupported channels")
+    {
+        const cv::Mat gray(5, 5, CV_8UC1, cv::Scalar(17));
+        shareToQImage(qImage, gray);
+        CHECK(qImage.format() == QImage::Format_Grayscale8);
+        CHECK(qGray(qImage.pixel(2, 2)) == 17);
+
+        shareToQImage(qImage, cv::Mat(5, 5, CV_8UC2));
+        CHECK(qImage.format() == QImage::Format_Grayscale8);
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "logger.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("RateLimit lets a number of messages per interval pass", "[util][logger]")
+{
+    using namespace std::chrono_literals;
+
+    logger::RateLimit                          rateLimit(3, 1s);
+    const logger::RateLimit::Clock::time_point start{10s};
+
+    CHECK(rateLimit.pass(start) == 0);
+    CHECK(rateLimit.pass(start + 100ms) == 0);
+    CHECK(rateLimit.pass(start + 200ms) == 0);
+    CHECK(rateLimit.pass(start + 300ms) == -1);
+    CHECK(rateLimit.pass(start + 400ms) == -1);
+
+    // the next passed message reports the suppressed ones once
+    CHECK(rateLimit.pass(start + 1s) == 2);
+    CHECK(rateLimit.pass(start + 1100ms) == 0);
+}
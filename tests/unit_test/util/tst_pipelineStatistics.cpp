@@ -0,0 +1,92 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pipelineStatistics.h"
+
+#include <QJsonObject>
+#include <catch2/catch.hpp>
+#include <thread>
+
+TEST_CASE("PipelineStatistics are written as JSON", "[util][PipelineStatistics]")
+{
+    PipelineStatistics statistics;
+    statistics.frames    = 50;
+    statistics.seconds   = 2;
+    statistics.decode    = 0.25;
+    statistics.filter    = 0.5;
+    statistics.track     = 0.75;
+    statistics.recognize = 0.125;
+    statistics.render    = 0.375;
+    statistics.output    = 0.0625;
+
+    const auto json = statistics.toJson();
+    CHECK(json["frames"].toInt() == 50);
+    CHECK(json["seconds"].toDouble() == 2);
+    CHECK(json["framesPerSecond"].toDouble() == 25);
+
+    const auto stages = json["stages"].toObject();
+    CHECK(stages["decode"].toDouble() == 0.25);
+    CHECK(stages["filter"].toDouble() == 0.5);
+    CHECK(stages["track"].toDouble() == 0.75);
+    CHECK(stages["recognize"].toDouble() == 0.125);
+    CHECK(stages["render"].toDouble() == 0.375);
+    CHECK(stages["export"].toDouble() == 0.0625);
+
+    statistics.memory = {{"Trajectories", 1024}, {"Undo history", 0}};
+    const auto memory = statistics.toJson()["memory"].toObject();
+    CHECK(memory.size() == 2);
+    CHECK(memory["Trajectories"].toInt() == 1024);
+    CHECK(memory["Undo history"].toInt() == 0);
+
+    CHECK(PipelineStatistics().framesPerSecond() == 0);
+}
+
+TEST_CASE("PipelineStatistics since an earlier copy cover the frames in between", "[util][PipelineStatistics]")
+{
+    PipelineStatistics earlier;
+    earlier.frames     = 10;
+    earlier.tracked    = 30;
+    earlier.recognized = 5;
+    earlier.filter     = 0.5;
+    earlier.render     = 0.25;
+
+    PipelineStatistics current = earlier;
+    current.frames += 5;
+    current.tracked += 15;
+    current.filter += 0.25;
+    current.render += 0.5;
+
+    const auto interval = current.since(earlier);
+    CHECK(interval.frames == 5);
+    CHECK(interval.tracked == 15);
+    CHECK(interval.recognized == 0);
+    CHECK(interval.filter == 0.25);
+    CHECK(interval.render == 0.5);
+    CHECK(interval.decode == 0);
+}
+
+TEST_CASE("StageTimer adds its lifetime", "[util][PipelineStatistics]")
+{
+    double seconds = 1;
+    {
+        StageTimer timer(seconds);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    CHECK(seconds >= 1.02);
+    CHECK(seconds < 2);
+}
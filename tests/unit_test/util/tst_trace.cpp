@@ -0,0 +1,88 @@
+/*
+ * PeTrack - Software for tracking pedestrians movement in videos
+ * Copyright (C) 2024 Forschungszentrum Jülich GmbH, IAS-7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <catch2/catch.hpp>
+#include <thread>
+
+namespace
+{
+QJsonArray readEvents(const QString &fileName)
+{
+    QFile file(fileName);
+    REQUIRE(file.open(QIODevice::ReadOnly));
+    const auto json = QJsonDocument::fromJson(file.readAll());
+    REQUIRE(json.isObject());
+    return json.object()["traceEvents"].toArray();
+}
+} // namespace
+
+TEST_CASE("Zones are written as Chrome trace", "[util][trace]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString fileName = dir.filePath("trace.json");
+
+    {
+        trace::Zone zone("before");
+    }
+    REQUIRE(trace::start());
+    CHECK(trace::isRecording());
+    CHECK_FALSE(trace::start());
+    {
+        trace::Zone outer("outer");
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::thread([] { trace::Zone inner("worker"); }).join();
+    }
+    REQUIRE(trace::stop(fileName));
+    CHECK_FALSE(trace::isRecording());
+    CHECK_FALSE(trace::stop(fileName));
+    {
+        trace::Zone zone("after");
+    }
+
+    const auto events = readEvents(fileName);
+    REQUIRE(events.size() == 2);
+    const auto worker = events[0].toObject();
+    const auto outer  = events[1].toObject();
+    CHECK(worker["name"].toString() == "worker");
+    CHECK(outer["name"].toString() == "outer");
+    CHECK(outer["ph"].toString() == "X");
+    CHECK(outer["dur"].toDouble() >= 5000);
+    CHECK(worker["ts"].toDouble() >= outer["ts"].toDouble());
+    CHECK(worker["tid"].toInt() != outer["tid"].toInt());
+}
+
+TEST_CASE("A session writes an empty trace without zones", "[util][trace]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString fileName = dir.filePath("empty.json");
+    {
+        trace::Session session(fileName);
+        CHECK(trace::isRecording());
+    }
+    CHECK_FALSE(trace::isRecording());
+    CHECK(readEvents(fileName).isEmpty());
+}